@@ -0,0 +1,122 @@
+#include "transport/LRUCache.hpp"
+#include "transport/mcp_cache.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using namespace mcp::cache;
+using Astra::datastructures::LRUCache;
+
+namespace {
+    nlohmann::json stream_event(int event_id) {
+        return {{"jsonrpc", "2.0"}, {"method", "notifications/progress"}, {"params", {{"progress", event_id}, {"message", "chunk " + std::to_string(event_id)}}}};
+    }
+
+    McpCache *fresh_cache() {
+        auto *cache = McpCache::GetInstance();
+        cache->Init(1000, 500, std::chrono::hours(1));
+        return cache;
+    }
+}// namespace
+
+// Cache one event a call, as a streaming tool does for every chunk it sends
+static void BM_CacheStreamData(benchmark::State &state) {
+    auto *cache = fresh_cache();
+    auto event = stream_event(1);
+    int event_id = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(cache->CacheStreamData("bench_stream", ++event_id, event));
+    }
+    cache->CleanupSession("bench_stream");
+}
+BENCHMARK(BM_CacheStreamData);
+
+// Cache a batch of pre-serialized events under one lock
+static void BM_CacheStreamBatch(benchmark::State &state) {
+    auto *cache = fresh_cache();
+    std::vector<std::pair<int, std::string>> batch(static_cast<size_t>(state.range(0)));
+    int event_id = 0;
+    for (auto _: state) {
+        for (auto &[id, data]: batch) {
+            id = ++event_id;
+            data = stream_event(id).dump();
+        }
+        benchmark::DoNotOptimize(cache->CacheStreamBatch("bench_batch", batch));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch.size()));
+    cache->CleanupSession("bench_batch");
+}
+BENCHMARK(BM_CacheStreamBatch)->Arg(1)->Arg(16)->Arg(64);
+
+// Replay the events a client missed, from the middle of a full session
+static void BM_GetReconnectData(benchmark::State &state) {
+    auto *cache = fresh_cache();
+    const int events = 500;
+    for (int event_id = 1; event_id <= events; ++event_id) {
+        cache->CacheStreamData("bench_reconnect", event_id, stream_event(event_id));
+    }
+    const int missed = static_cast<int>(state.range(0));
+    for (auto _: state) {
+        auto data = cache->GetReconnectData("bench_reconnect", events - missed);
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * missed));
+    cache->CleanupSession("bench_reconnect");
+}
+BENCHMARK(BM_GetReconnectData)->Arg(1)->Arg(50)->Arg(499);
+
+// Same replay as rendered frames, without parsing the events
+static void BM_GetReconnectFrames(benchmark::State &state) {
+    auto *cache = fresh_cache();
+    const int events = 500;
+    for (int event_id = 1; event_id <= events; ++event_id) {
+        cache->CacheStreamData("bench_frames", event_id, stream_event(event_id));
+    }
+    const int missed = static_cast<int>(state.range(0));
+    for (auto _: state) {
+        auto frames = cache->GetReconnectFrames("bench_frames", events - missed);
+        benchmark::DoNotOptimize(frames);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * missed));
+    cache->CleanupSession("bench_frames");
+}
+BENCHMARK(BM_GetReconnectFrames)->Arg(1)->Arg(50)->Arg(499);
+
+// Hot keys: every thread reads and writes the same small key set of one shared cache
+static void BM_LRUCacheContended(benchmark::State &state) {
+    static LRUCache<std::string, std::string> cache(1024);
+    static const std::vector<std::string> keys = []() {
+        std::vector<std::string> keys;
+        for (int i = 0; i < 256; ++i) {
+            keys.push_back("tool:" + std::to_string(i));
+        }
+        return keys;
+    }();
+    const std::string value(128, 'v');
+    const int writes_per_256 = static_cast<int>(state.range(0));
+    size_t i = static_cast<size_t>(state.thread_index()) * 37;
+    for (auto _: state) {
+        const auto &key = keys[i++ & 255];
+        if (static_cast<int>(i & 255) < writes_per_256) {
+            cache.Put(key, value);
+        } else {
+            benchmark::DoNotOptimize(cache.Get(key));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+// Read-mostly (about 1 write in 256) and write-heavy (1 in 4)
+BENCHMARK(BM_LRUCacheContended)->Arg(1)->Arg(64)->ThreadRange(1, 8)->UseRealTime();
+
+// Evicting: many more keys than slots, every Put on a full cache drops the oldest entry
+static void BM_LRUCacheEvicting(benchmark::State &state) {
+    LRUCache<int, std::string> cache(1024);
+    const std::string value(64, 'v');
+    int key = 0;
+    for (auto _: state) {
+        cache.Put(++key, value);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_LRUCacheEvicting);
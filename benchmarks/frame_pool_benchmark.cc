@@ -0,0 +1,51 @@
+#include "core/frame_pool.hpp"
+#include "support/hot_path_harness.h"
+#include <benchmark/benchmark.h>
+
+using namespace mcp::core;
+using mcp::harness::HotPathCost;
+using mcp::harness::HotPathCounters;
+
+namespace {
+    // The asynchronous steps of one request on a session: wait for input, read, hand over, write
+    template<typename Token>
+    asio::awaitable<void> handle_request(Token token) {
+        auto executor = co_await asio::this_coro::executor;
+        asio::steady_timer readable(executor, asio::steady_timer::time_point::min());
+        co_await readable.async_wait(token);
+        co_await asio::post(executor, token);
+        asio::steady_timer written(executor, asio::steady_timer::time_point::min());
+        co_await written.async_wait(token);
+    }
+
+    // Time the requests, then run more under the counters and report heap allocations per request
+    template<typename Token>
+    void run_requests(benchmark::State &state, Token token) {
+        constexpr uint64_t kMeasured = 1000;
+        asio::io_context io;
+        HotPathCounters counters;
+        HotPathCost cost;
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            for (auto _: state) {
+                co_await handle_request(token);
+            }
+            counters.start();
+            for (uint64_t i = 0; i < kMeasured; ++i) {
+                co_await handle_request(token);
+            }
+            cost = counters.stop(kMeasured); }, asio::detached);
+        io.run();
+        state.counters["allocs"] = cost.allocations;
+        state.counters["alloc_bytes"] = cost.allocated_bytes;
+    }
+}// namespace
+
+static void BM_RequestUseAwaitable(benchmark::State &state) {
+    run_requests(state, asio::use_awaitable);
+}
+BENCHMARK(BM_RequestUseAwaitable);
+
+static void BM_RequestPooled(benchmark::State &state) {
+    run_requests(state, pooled(asio::use_awaitable));
+}
+BENCHMARK(BM_RequestPooled);
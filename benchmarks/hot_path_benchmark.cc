@@ -0,0 +1,49 @@
+#include "support/hot_path_harness.h"
+#include <benchmark/benchmark.h>
+
+using namespace mcp::harness;
+
+namespace {
+    // Time one flow, then run it once more under the counters and report its cost per request
+    void run_flow(benchmark::State &state, void (HotPaths::*flow)()) {
+        HotPaths paths;
+        for (auto _: state) {
+            (paths.*flow)();
+            benchmark::DoNotOptimize(paths.last_response());
+        }
+
+        HotPathCost cost = paths.measure(flow, 1000);
+        state.counters["allocs"] = cost.allocations;
+        state.counters["alloc_bytes"] = cost.allocated_bytes;
+        if (cost.instructions) {
+            state.counters["instructions"] = *cost.instructions;
+        }
+        if (cost.cache_misses) {
+            state.counters["cache_misses"] = *cost.cache_misses;
+        }
+        if (cost.branch_misses) {
+            state.counters["branch_misses"] = *cost.branch_misses;
+        }
+    }
+}// namespace
+
+static void BM_HotPathPing(benchmark::State &state) {
+    run_flow(state, &HotPaths::ping);
+}
+BENCHMARK(BM_HotPathPing);
+
+static void BM_HotPathToolsList(benchmark::State &state) {
+    run_flow(state, &HotPaths::tools_list);
+}
+BENCHMARK(BM_HotPathToolsList);
+
+static void BM_HotPathEchoCall(benchmark::State &state) {
+    run_flow(state, &HotPaths::echo_call);
+}
+BENCHMARK(BM_HotPathEchoCall);
+
+// One event of a stream: checked, cached for reconnects and framed for the send queue
+static void BM_HotPathStreamEvent(benchmark::State &state) {
+    run_flow(state, &HotPaths::stream_event);
+}
+BENCHMARK(BM_HotPathStreamEvent);
@@ -0,0 +1,70 @@
+#include "protocol/json_rpc.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace mcp::protocol;
+
+namespace {
+    const std::string kToolsCall = R"({"jsonrpc":"2.0","id":42,"method":"tools/call","params":{"name":"echo","arguments":{"text":"hello world"}}})";
+
+    // A tools/call whose arguments carry a string of the given size
+    std::string tools_call_with_payload(size_t size) {
+        return R"({"jsonrpc":"2.0","id":7,"method":"tools/call","params":{"name":"summarize","arguments":{"text":")" +
+               std::string(size, 'x') + R"("}}})";
+    }
+}// namespace
+
+// Parse a small tools/call request
+static void BM_ParseRequest(benchmark::State &state) {
+    for (auto _: state) {
+        auto parsed = parse_request(kToolsCall);
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kToolsCall.size()));
+}
+BENCHMARK(BM_ParseRequest);
+
+// Parse requests with growing arguments, where the params DOM dominates
+static void BM_ParseRequestLargeParams(benchmark::State &state) {
+    const std::string text = tools_call_with_payload(static_cast<size_t>(state.range(0)));
+    for (auto _: state) {
+        auto parsed = parse_request(text);
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_ParseRequestLargeParams)->Range(64, 64 << 10);
+
+// Scan the envelope only, as the transports do before dispatch
+static void BM_ScanRequestEnvelope(benchmark::State &state) {
+    for (auto _: state) {
+        auto envelope = scan_request_envelope(kToolsCall);
+        benchmark::DoNotOptimize(envelope);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kToolsCall.size()));
+}
+BENCHMARK(BM_ScanRequestEnvelope);
+
+// Serialize a tools/call result
+static void BM_MakeResponse(benchmark::State &state) {
+    nlohmann::json result = {{"content", {{{"type", "text"}, {"text", std::string(static_cast<size_t>(state.range(0)), 'y')}}}}};
+    nlohmann::json id = 42;
+    for (auto _: state) {
+        auto text = make_response(result, id);
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_MakeResponse)->Range(16, 64 << 10);
+
+// Serialize a response whose result is already JSON text, as plugin results are
+static void BM_MakeResponseRawResult(benchmark::State &state) {
+    Response response;
+    response.id = 42;
+    response.raw_result = std::make_shared<const std::string>(
+            R"({"content":[{"type":"text","text":")" + std::string(static_cast<size_t>(state.range(0)), 'y') + R"("}]})");
+    for (auto _: state) {
+        auto text = make_response(response);
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_MakeResponseRawResult)->Range(16, 64 << 10);
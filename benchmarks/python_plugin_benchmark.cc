@@ -0,0 +1,271 @@
+// Calls of plugins/official/python_example_plugin through its plugin ABI, as the server makes them.
+// The execution mode comes from the MCP_PYTHON_* variables the server would export (see
+// PythonExecutionOptions): run_benchmarks runs this once in process, once with sub-interpreters
+// and once with worker processes. MCP_BENCH_PYTHON_PLUGIN overrides the plugin path.
+#include "mcp_plugin.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct PythonPlugin {
+        bool loaded = false;
+        std::string error;
+        call_tool_func call_tool = nullptr;
+        call_tool_v2_func call_tool_v2 = nullptr;
+        free_result_func free_result = nullptr;
+        StreamGeneratorNext next = nullptr;
+        StreamGeneratorWait wait = nullptr;
+        StreamGeneratorCancel cancel = nullptr;
+        StreamGeneratorFree free = nullptr;
+    };
+
+    template<typename Function>
+    Function symbol(void *library, const char *name) {
+#ifdef _WIN32
+        return reinterpret_cast<Function>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+        return reinterpret_cast<Function>(dlsym(library, name));
+#endif
+    }
+
+    // Loaded once and kept for the process, like the server keeps its plugins
+    const PythonPlugin &python_plugin() {
+        static const PythonPlugin plugin = [] {
+            PythonPlugin plugin;
+            const char *path = std::getenv("MCP_BENCH_PYTHON_PLUGIN");
+            path = path && *path ? path : MCP_PYTHON_EXAMPLE_PLUGIN;
+#ifdef _WIN32
+            void *library = LoadLibraryA(path);
+#else
+            void *library = dlopen(path, RTLD_LAZY);
+#endif
+            auto initialize = library ? symbol<initialize_plugin_func>(library, "initialize_plugin") : nullptr;
+            if (!initialize || !initialize(path)) {
+                plugin.error = std::string("cannot load ") + path;
+                return plugin;
+            }
+            plugin.call_tool = symbol<call_tool_func>(library, "call_tool");
+            plugin.call_tool_v2 = symbol<call_tool_v2_func>(library, "call_tool_v2");
+            plugin.free_result = symbol<free_result_func>(library, "free_result");
+            plugin.next = symbol<get_stream_next_func>(library, "get_stream_next")();
+            plugin.wait = symbol<get_stream_wait_func>(library, "get_stream_wait")();
+            plugin.cancel = symbol<get_stream_cancel_func>(library, "get_stream_cancel")();
+            plugin.free = symbol<get_stream_free_func>(library, "get_stream_free")();
+            plugin.loaded = plugin.call_tool && plugin.call_tool_v2;
+            return plugin;
+        }();
+        return plugin;
+    }
+
+    const char *execution_mode() {
+        auto set = [](const char *name) {
+            const char *value = std::getenv(name);
+            return value && std::atoi(value) > 0;
+        };
+        return set("MCP_PYTHON_WORKERS") ? "workers" : set("MCP_PYTHON_INTERPRETERS") ? "interpreters" : "in_process";
+    }
+
+    /**
+     * @brief Latencies of all threads of a run, 16 buckets per power of two of nanoseconds.
+     *
+     * Threads record into shared atomic counters, which costs little next to a Python call;
+     * thread 0 resets it before the run and reads it after, when the others have stopped.
+     */
+    class SharedLatencies {
+    public:
+        void reset() {
+            for (auto &count: counts_) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void record(Clock::duration elapsed) {
+            auto ns = static_cast<uint64_t>(std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            counts_[index_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Upper bound of the bucket holding the percentile, in microseconds
+        double percentile_us(double percentile) const {
+            uint64_t total = 0;
+            for (const auto &count: counts_) {
+                total += count.load(std::memory_order_relaxed);
+            }
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total)));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < counts_.size(); ++i) {
+                seen += counts_[i].load(std::memory_order_relaxed);
+                if (seen >= rank) {
+                    return static_cast<double>(highest_of(i)) / 1000.0;
+                }
+            }
+            return 0;
+        }
+
+    private:
+        static constexpr int kSubBits = 4;
+
+        static size_t index_of(uint64_t ns) {
+            int exponent = std::max(0, static_cast<int>(std::bit_width(ns)) - kSubBits);
+            return (static_cast<size_t>(exponent) << kSubBits) + static_cast<size_t>((ns >> exponent) & ((1u << kSubBits) - 1));
+        }
+
+        static uint64_t highest_of(size_t index) {
+            // The sub-bucket keeps the top bit of the value, so it scales back by the exponent alone
+            int exponent = static_cast<int>(index >> kSubBits);
+            uint64_t sub = index & ((1u << kSubBits) - 1);
+            return ((sub + 1) << exponent) - 1;
+        }
+
+        std::array<std::atomic<uint64_t>, 64 << kSubBits> counts_{};
+    };
+
+    SharedLatencies &latencies() {
+        static SharedLatencies shared;
+        return shared;
+    }
+
+    // Plugin output into a string reused by the thread
+    struct StringOutput {
+        std::string result;
+        size_t size = 0;///< Bytes of result written, the rest is reserved
+        MCPOutput output{this, 0, &StringOutput::write, &StringOutput::reserve, &StringOutput::commit};
+
+        void clear() {
+            size = 0;
+            output.flags = 0;
+        }
+
+        static bool write(void *context, const char *data, size_t size) {
+            auto *self = static_cast<StringOutput *>(context);
+            self->result.resize(self->size);
+            self->result.append(data, size);
+            self->size += size;
+            return true;
+        }
+
+        static char *reserve(void *context, size_t capacity) {
+            auto *self = static_cast<StringOutput *>(context);
+            self->result.resize(self->size + capacity);
+            return self->result.data() + self->size;
+        }
+
+        static void commit(void *context, size_t size) {
+            static_cast<StringOutput *>(context)->size += size;
+        }
+    };
+
+    // Signalled by the plugin's stream loop when next() can make progress
+    struct Wakeup {
+        std::mutex mutex;
+        std::condition_variable ready;
+        bool woken = false;
+
+        static void wake(void *context) {
+            auto *wakeup = static_cast<Wakeup *>(context);
+            std::lock_guard<std::mutex> lock(wakeup->mutex);
+            wakeup->woken = true;
+            wakeup->ready.notify_one();
+        }
+
+        void wait_for_wake() {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait_for(lock, std::chrono::milliseconds(100), [this] { return woken; });
+            woken = false;
+        }
+    };
+
+    void report_percentiles(benchmark::State &state) {
+        state.SetLabel(execution_mode());
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+        if (state.thread_index() == 0) {
+            state.counters["p50_us"] = latencies().percentile_us(50);
+            state.counters["p99_us"] = latencies().percentile_us(99);
+        }
+    }
+}// namespace
+
+// python_echo from 1 to 64 callers at once; the GIL serializes them in process
+static void BM_PythonEchoCall(benchmark::State &state) {
+    const auto &plugin = python_plugin();
+    if (!plugin.loaded) {
+        state.SkipWithError(plugin.error.c_str());
+        return;
+    }
+    if (state.thread_index() == 0) {
+        latencies().reset();
+    }
+    static const std::string args = R"({"text":"hello"})";
+    StringOutput output;
+    for (auto _: state) {
+        output.clear();
+        MCPError error{};
+        Clock::time_point started = Clock::now();
+        int status = plugin.call_tool_v2("python_echo", MCPBuffer{args.data(), args.size()}, &output.output, &error);
+        latencies().record(Clock::now() - started);
+        if (status != 0) {
+            state.SkipWithError(error.message ? error.message : "python_echo failed");
+            break;
+        }
+        benchmark::DoNotOptimize(output.result.data());
+    }
+    report_percentiles(state);
+}
+BENCHMARK(BM_PythonEchoCall)->Threads(1)->Threads(4)->Threads(16)->Threads(64)->UseRealTime();
+
+// Call of the streaming python_count until its first event; streams run in the main
+// interpreter whatever the mode
+static void BM_PythonStreamFirstEvent(benchmark::State &state) {
+    const auto &plugin = python_plugin();
+    if (!plugin.loaded || !plugin.next || !plugin.wait) {
+        state.SkipWithError(plugin.loaded ? "plugin has no non-blocking streams" : plugin.error.c_str());
+        return;
+    }
+    if (state.thread_index() == 0) {
+        latencies().reset();
+    }
+    Wakeup wakeup;
+    for (auto _: state) {
+        MCPError error{};
+        Clock::time_point started = Clock::now();
+        auto generator = reinterpret_cast<StreamGenerator>(const_cast<char *>(plugin.call_tool("python_count", R"({"count":3})", &error)));
+        if (!generator) {
+            state.SkipWithError(error.message ? error.message : "python_count failed");
+            break;
+        }
+        int status;
+        const char *event = nullptr;
+        while ((status = plugin.next(generator, &event, &error)) == MCP_STREAM_WOULD_BLOCK) {
+            plugin.wait(generator, &Wakeup::wake, &wakeup);
+            wakeup.wait_for_wake();
+        }
+        latencies().record(Clock::now() - started);
+        benchmark::DoNotOptimize(event);
+        if (plugin.cancel) {
+            plugin.cancel(generator);
+        }
+        plugin.free(generator);
+        if (status != 0) {
+            state.SkipWithError("python_count ended without an event");
+            break;
+        }
+    }
+    report_percentiles(state);
+}
+BENCHMARK(BM_PythonStreamFirstEvent)->Threads(1)->Threads(4)->Threads(16)->Threads(64)->UseRealTime();
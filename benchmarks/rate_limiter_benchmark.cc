@@ -0,0 +1,85 @@
+#include "metrics/rate_limiter.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mcp::metrics;
+
+namespace {
+    // Limits far above the benchmark's rate, so every check takes the allowing path; set once,
+    // before the first thread checks
+    std::shared_ptr<RateLimiter> unlimited_limiter() {
+        static const auto limiter = []() {
+            auto limiter = RateLimiter::getInstance();
+            RateLimitConfig config;
+            config.max_requests_per_second = 1000000000;
+            config.max_concurrent_requests = 1000000;
+            limiter->set_config(config);
+            return limiter;
+        }();
+        return limiter;
+    }
+
+    TrackedHttpRequest tracked_request() {
+        static const std::string body = R"({"jsonrpc":"2.0","id":1,"method":"tools/list"})";
+        TrackedHttpRequest request;
+        request.method = "POST";
+        request.target = "/mcp";
+        request.version = "HTTP/1.1";
+        request.body = body;
+        request.request_size = body.size() + 128;
+        return request;
+    }
+}// namespace
+
+// One session per thread, as with independent clients
+static void BM_CheckRequestAllowed(benchmark::State &state) {
+    auto limiter = unlimited_limiter();
+    const auto request = tracked_request();
+    const std::string session_id = "session-" + std::to_string(state.thread_index());
+    for (auto _: state) {
+        benchmark::DoNotOptimize(limiter->check_request_allowed(request, session_id));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CheckRequestAllowed)->ThreadRange(1, 8)->UseRealTime();
+
+// All threads on one session, the compare-and-swap of its bucket contended
+static void BM_CheckRequestAllowedSharedSession(benchmark::State &state) {
+    auto limiter = unlimited_limiter();
+    const auto request = tracked_request();
+    const std::string session_id = "shared-session";
+    for (auto _: state) {
+        benchmark::DoNotOptimize(limiter->check_request_allowed(request, session_id));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CheckRequestAllowedSharedSession)->ThreadRange(1, 8)->UseRealTime();
+
+// Many sessions, each check likely to miss the cache lines of the last one
+static void BM_CheckRequestAllowedManySessions(benchmark::State &state) {
+    auto limiter = unlimited_limiter();
+    const auto request = tracked_request();
+    std::vector<std::string> sessions;
+    for (int i = 0; i < 10000; ++i) {
+        sessions.push_back("client-" + std::to_string(i));
+    }
+    size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(limiter->check_request_allowed(request, sessions[i++ % sessions.size()]));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_CheckRequestAllowedManySessions);
+
+// The started/completed pair every request reports around its check
+static void BM_ReportRequestStartedCompleted(benchmark::State &state) {
+    auto limiter = unlimited_limiter();
+    const std::string session_id = "session-" + std::to_string(state.thread_index());
+    for (auto _: state) {
+        limiter->report_request_started(session_id);
+        limiter->report_request_completed(session_id);
+    }
+}
+BENCHMARK(BM_ReportRequestStartedCompleted)->ThreadRange(1, 8)->UseRealTime();
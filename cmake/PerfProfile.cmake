@@ -0,0 +1,110 @@
+# Build options for the fastest server binary, applied to the internal libraries and mcp-server++
+#
+#   MCP_PERF_PROFILE=ON    -O3 and link time optimization across all internal targets
+#   MCP_PGO=GENERATE|USE   profile guided optimization, see scripts/pgo_build.sh
+#   MCP_MARCH=<arch>       -march for the build machine (native) or a baseline (x86-64-v3)
+#   MCP_ALLOCATOR=<name>   system, mimalloc or jemalloc linked into mcp-server++
+#
+# Plugins are left alone: they are built against the plugin ABI, not for the server's CPU.
+
+include_guard(GLOBAL)
+
+option(MCP_PERF_PROFILE "Build the internal libraries with -O3 and link time optimization" OFF)
+set(MCP_PGO "" CACHE STRING "Profile guided optimization: GENERATE an instrumented build, or USE its profiles")
+set_property(CACHE MCP_PGO PROPERTY STRINGS "" GENERATE USE)
+set(MCP_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Where the instrumented build writes its profiles")
+set(MCP_MARCH "" CACHE STRING "Target CPU for -march, e.g. native or x86-64-v3; empty for the compiler default")
+set(MCP_ALLOCATOR "system" CACHE STRING "Allocator linked into mcp-server++: system, mimalloc or jemalloc")
+set_property(CACHE MCP_ALLOCATOR PROPERTY STRINGS system mimalloc jemalloc)
+
+# Merged profile of a clang training run; GCC reads the .gcda files of MCP_PGO_DIR directly
+set(MCP_PGO_PROFDATA "${MCP_PGO_DIR}/mcp.profdata")
+
+# Apply the options above to internal targets
+function(mcp_apply_perf_profile)
+    if(MCP_PERF_PROFILE)
+        include(CheckIPOSupported)
+        check_ipo_supported(RESULT ipo_supported OUTPUT ipo_error LANGUAGES CXX)
+        if(NOT ipo_supported)
+            message(WARNING "MCP_PERF_PROFILE: link time optimization is not supported: ${ipo_error}")
+        endif()
+    endif()
+
+    set(pgo_flags "")
+    if(MCP_PGO STREQUAL "GENERATE")
+        set(pgo_flags -fprofile-generate=${MCP_PGO_DIR})
+        if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+            list(APPEND pgo_flags -fprofile-update=atomic)# The server counts from many threads
+        endif()
+    elseif(MCP_PGO STREQUAL "USE")
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            if(NOT EXISTS ${MCP_PGO_PROFDATA})
+                message(FATAL_ERROR "MCP_PGO=USE: ${MCP_PGO_PROFDATA} not found, run the training first")
+            endif()
+            set(pgo_flags -fprofile-use=${MCP_PGO_PROFDATA} -Wno-profile-instr-unprofiled)
+        else()
+            # Functions the training did not reach keep their usual optimization
+            set(pgo_flags -fprofile-use=${MCP_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+        endif()
+    elseif(MCP_PGO)
+        message(FATAL_ERROR "MCP_PGO must be empty, GENERATE or USE, not ${MCP_PGO}")
+    endif()
+    if(pgo_flags AND MSVC)
+        message(FATAL_ERROR "MCP_PGO supports GCC and clang")
+    endif()
+
+    foreach(target ${ARGN})
+        if(NOT TARGET ${target})
+            continue()
+        endif()
+        if(MCP_PERF_PROFILE)
+            if(ipo_supported)
+                set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION ON)
+            endif()
+            if(NOT MSVC)
+                target_compile_options(${target} PRIVATE -O3)
+            endif()
+        endif()
+        if(MCP_MARCH AND NOT MSVC)
+            target_compile_options(${target} PRIVATE -march=${MCP_MARCH})
+        endif()
+        if(pgo_flags)
+            target_compile_options(${target} PRIVATE ${pgo_flags})
+            target_link_options(${target} PRIVATE ${pgo_flags})
+        endif()
+    endforeach()
+endfunction()
+
+# Link the allocator chosen with MCP_ALLOCATOR into an executable; it replaces malloc for the
+# whole process, plugins included
+function(mcp_link_allocator target)
+    if(MCP_ALLOCATOR STREQUAL "system")
+        return()
+    elseif(MCP_ALLOCATOR STREQUAL "mimalloc")
+        find_package(mimalloc CONFIG QUIET)
+        if(TARGET mimalloc)
+            target_link_libraries(${target} PRIVATE mimalloc)
+        elseif(TARGET mimalloc-static)
+            target_link_libraries(${target} PRIVATE mimalloc-static)
+        else()
+            message(FATAL_ERROR "MCP_ALLOCATOR=mimalloc: mimalloc not found, install it or set mimalloc_DIR")
+        endif()
+    elseif(MCP_ALLOCATOR STREQUAL "jemalloc")
+        find_package(PkgConfig QUIET)
+        if(PKG_CONFIG_FOUND)
+            pkg_check_modules(JEMALLOC IMPORTED_TARGET jemalloc)
+        endif()
+        if(TARGET PkgConfig::JEMALLOC)
+            target_link_libraries(${target} PRIVATE PkgConfig::JEMALLOC)
+        else()
+            find_library(JEMALLOC_LIBRARY jemalloc)
+            if(NOT JEMALLOC_LIBRARY)
+                message(FATAL_ERROR "MCP_ALLOCATOR=jemalloc: libjemalloc not found")
+            endif()
+            target_link_libraries(${target} PRIVATE ${JEMALLOC_LIBRARY})
+        endif()
+    else()
+        message(FATAL_ERROR "MCP_ALLOCATOR must be system, mimalloc or jemalloc, not ${MCP_ALLOCATOR}")
+    endif()
+    message(STATUS "Linking ${MCP_ALLOCATOR} into ${target}")
+endfunction()
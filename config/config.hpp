@@ -3,14 +3,17 @@
 
 #include "config_observer.hpp"
 #include "core/executable_path.h"
+#include "core/housekeeping.h"
 #include "core/logger.h"
 #include "inicpp.hpp"
 #include <algorithm>
 #include <atomic>
 #include <filesystem>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 
@@ -56,13 +59,55 @@ namespace mcp {
             std::string log_path;
             std::string log_pattern;
             std::string plugin_dir;
+            bool plugin_lazy_load;
+            size_t plugin_idle_unload_s;
+            std::string plugin_isolation;
+            size_t plugin_host_channels;
+            size_t plugin_host_buffer_kb;
+            size_t plugin_cpu_quota_ms;
+            size_t plugin_alloc_quota_mb;
+            size_t plugin_quota_window_s;
+            std::string plugin_quota_action;
+            size_t list_page_size;
+            bool tools_list_delta;
+            size_t tools_list_delta_max;
+            bool validate_passthrough_results;
+            bool validate_tool_arguments;
+            size_t stream_batch_max_items;
+            size_t stream_batch_max_delay_us;
+            size_t stream_queue_high_watermark;
+            size_t stream_queue_low_watermark;
+            std::string stream_slow_consumer_policy;
+            size_t stream_heartbeat_interval_ms;
+            size_t stream_heartbeat_jitter_ms;
             std::string ssl_cert_file;
             std::string ssl_key_file;
             std::string ssl_dh_params_file;
+            size_t ssl_session_cache_size;
+            size_t ssl_session_timeout_s;
+            size_t ssl_ticket_rotation_s;
             std::string auth_type;
             std::string auth_env_file;
+            std::string jwt_issuer;
+            std::string jwt_audience;
+            std::string jwt_jwks_url;
+            size_t jwt_refresh_s;
+            size_t jwt_leeway_s;
+            size_t jwt_cache_size;
+            std::string io_thread_name;
+            std::string io_cpu_affinity;
+            size_t io_lag_probe_ms;
+            size_t io_busy_poll_us;
+            std::string pool_huge_pages;
+            bool pool_numa;
+            std::string https_io_cpu_affinity;
             size_t max_file_size;
             size_t max_files;
+            size_t log_payload_limit;
+            bool log_binary;
+            std::string log_format;
+            std::string log_overflow;
+            size_t log_ring_bytes;
             unsigned short port;
             unsigned short http_port;
             unsigned short https_port;
@@ -70,10 +115,75 @@ namespace mcp {
             bool enable_http;
             bool enable_https;
             bool enable_auth;
+            bool reuse_port;
+            bool shared_nothing;
             size_t max_requests_per_second;
             size_t max_concurrent_requests;
+            size_t rate_limit_burst;
+            size_t tenant_requests_per_second;
+            size_t tenant_rate_limit_burst;
+            std::string tenant_rate_limits;
             size_t max_request_size;
             size_t max_response_size;
+            size_t io_threads;
+            size_t https_io_threads;
+            size_t https_handshake_threads;
+            bool http2;
+            size_t http2_max_concurrent_streams;
+            size_t http2_initial_window_size;
+            bool websocket;
+            size_t websocket_max_message_size;
+            size_t websocket_max_in_flight;
+            std::string unix_socket;
+            bool unix_socket_peer_auth;
+            std::string unix_socket_allowed_uids;
+            size_t unix_memfd_min_size;
+            size_t stdio_read_buffer_size;
+            size_t stdio_max_in_flight;
+            bool compression;
+            size_t compression_min_size;
+            int compression_level;
+            size_t compression_offload_size;
+            bool compression_streaming;
+            bool request_decompression;
+            size_t max_decompressed_request_size;
+            size_t header_timeout_ms;
+            size_t body_timeout_ms;
+            size_t keepalive_timeout_ms;
+            bool metrics_endpoint;
+            std::string metrics_path;
+            size_t trace_sample_every;
+            std::string otlp_endpoint;
+            std::string otlp_service_name;
+            size_t otlp_sample_every;
+            size_t otlp_batch_size;
+            size_t otlp_export_interval_ms;
+            std::string metrics_statsd_endpoint;
+            std::string metrics_statsd_prefix;
+            std::string metrics_otlp_endpoint;
+            size_t metrics_push_interval_ms;
+            size_t metrics_push_buffer_bytes;
+            bool debug_endpoints;
+            bool admin_stats_endpoint;
+            std::string admin_token;
+            std::string access_log_path;
+            size_t access_log_error_sample_every;
+            size_t access_log_success_sample_every;
+            size_t access_log_batch_size;
+            size_t access_log_flush_ms;
+            std::string audit_log_dir;
+            size_t audit_segment_bytes;
+            size_t audit_sync_interval_ms;
+            size_t audit_ring_bytes;
+            std::string capture_path;
+            std::string capture_redact_fields;
+            size_t max_profile_seconds;
+            size_t drain_timeout_ms;
+            size_t drain_stream_spread_ms;
+            std::string hot_restart_socket;
+            bool background_tool_loading;
+            std::string ready_path;
+            bool startup_timeline;
 
             static ServerConfig load(inicpp::IniManager &ini) {
                 try {
@@ -85,23 +195,131 @@ namespace mcp {
                     config.log_path = server_section["log_path"].String().empty() ? "logs/mcp_server.log" : server_section["log_path"].String();
                     config.log_pattern = server_section["log_pattern"].String();
                     config.plugin_dir = server_section["plugin_dir"].String().empty() ? "plugins" : server_section["plugin_dir"].String();
+                    config.plugin_lazy_load = server_section["plugin_lazy_load"].String().empty() ? false : static_cast<bool>(server_section["plugin_lazy_load"]);
+                    config.plugin_idle_unload_s = server_section["plugin_idle_unload_s"].String().empty() ? 0 : static_cast<size_t>(server_section["plugin_idle_unload_s"]);
+                    config.plugin_isolation = server_section["plugin_isolation"].String();
+                    config.plugin_host_channels = server_section["plugin_host_channels"].String().empty() ? 2 : static_cast<size_t>(server_section["plugin_host_channels"]);
+                    config.plugin_host_buffer_kb = server_section["plugin_host_buffer_kb"].String().empty() ? 256 : static_cast<size_t>(server_section["plugin_host_buffer_kb"]);
+                    config.plugin_cpu_quota_ms = server_section["plugin_cpu_quota_ms"].String().empty() ? 0 : static_cast<size_t>(server_section["plugin_cpu_quota_ms"]);
+                    config.plugin_alloc_quota_mb = server_section["plugin_alloc_quota_mb"].String().empty() ? 0 : static_cast<size_t>(server_section["plugin_alloc_quota_mb"]);
+                    config.plugin_quota_window_s = server_section["plugin_quota_window_s"].String().empty() ? 60 : static_cast<size_t>(server_section["plugin_quota_window_s"]);
+                    config.plugin_quota_action = server_section["plugin_quota_action"].String().empty() ? "throttle" : server_section["plugin_quota_action"].String();
+                    config.list_page_size = server_section["list_page_size"].String().empty() ? 0 : static_cast<size_t>(server_section["list_page_size"]);
+                    config.tools_list_delta = server_section["tools_list_delta"].String().empty() ? false : static_cast<bool>(server_section["tools_list_delta"]);
+                    config.tools_list_delta_max = server_section["tools_list_delta_max"].String().empty() ? 256 : static_cast<size_t>(server_section["tools_list_delta_max"]);
+                    config.validate_passthrough_results = server_section["validate_passthrough_results"].String().empty() ? true : static_cast<bool>(server_section["validate_passthrough_results"]);
+                    config.validate_tool_arguments = server_section["validate_tool_arguments"].String().empty() ? true : static_cast<bool>(server_section["validate_tool_arguments"]);
+                    config.stream_batch_max_items = server_section["stream_batch_max_items"].String().empty() ? 1 : static_cast<size_t>(server_section["stream_batch_max_items"]);
+                    config.stream_batch_max_delay_us = server_section["stream_batch_max_delay_us"].String().empty() ? 0 : static_cast<size_t>(server_section["stream_batch_max_delay_us"]);
+                    config.stream_queue_high_watermark = server_section["stream_queue_high_watermark"].String().empty() ? 1048576 : static_cast<size_t>(server_section["stream_queue_high_watermark"]);
+                    config.stream_queue_low_watermark = server_section["stream_queue_low_watermark"].String().empty() ? 262144 : static_cast<size_t>(server_section["stream_queue_low_watermark"]);
+                    config.stream_slow_consumer_policy = server_section["stream_slow_consumer_policy"].String().empty() ? "block" : server_section["stream_slow_consumer_policy"].String();
+                    config.stream_heartbeat_interval_ms = server_section["stream_heartbeat_interval_ms"].String().empty() ? 15000 : static_cast<size_t>(server_section["stream_heartbeat_interval_ms"]);
+                    config.stream_heartbeat_jitter_ms = server_section["stream_heartbeat_jitter_ms"].String().empty() ? 2000 : static_cast<size_t>(server_section["stream_heartbeat_jitter_ms"]);
                     config.ssl_cert_file = server_section["ssl_cert_file"].String().empty() ? "certs/server.crt" : server_section["ssl_cert_file"].String();
                     config.ssl_key_file = server_section["ssl_key_file"].String().empty() ? "certs/server.key" : server_section["ssl_key_file"].String();
                     config.ssl_dh_params_file = server_section["ssl_dh_params_file"].String().empty() ? "certs/dh2048.pem" : server_section["ssl_dh_params_file"].String();
+                    config.ssl_session_cache_size = server_section["ssl_session_cache_size"].String().empty() ? 20480 : static_cast<size_t>(server_section["ssl_session_cache_size"]);
+                    config.ssl_session_timeout_s = server_section["ssl_session_timeout_s"].String().empty() ? 7200 : static_cast<size_t>(server_section["ssl_session_timeout_s"]);
+                    config.ssl_ticket_rotation_s = server_section["ssl_ticket_rotation_s"].String().empty() ? 3600 : static_cast<size_t>(server_section["ssl_ticket_rotation_s"]);
                     config.auth_type = server_section["auth_type"].String().empty() ? "X-API-Key" : server_section["auth_type"].String();
                     config.auth_env_file = server_section["auth_env_file"].String().empty() ? ".env.auth" : server_section["auth_env_file"].String();
+                    config.jwt_issuer = server_section["jwt_issuer"].String();
+                    config.jwt_audience = server_section["jwt_audience"].String();
+                    config.jwt_jwks_url = server_section["jwt_jwks_url"].String();
+                    config.jwt_refresh_s = server_section["jwt_refresh_s"].String().empty() ? 300 : static_cast<size_t>(server_section["jwt_refresh_s"]);
+                    config.jwt_leeway_s = server_section["jwt_leeway_s"].String().empty() ? 60 : static_cast<size_t>(server_section["jwt_leeway_s"]);
+                    config.jwt_cache_size = server_section["jwt_cache_size"].String().empty() ? 10000 : static_cast<size_t>(server_section["jwt_cache_size"]);
 
                     config.max_file_size = server_section["max_file_size"].String().empty() ? 10485760 : static_cast<size_t>(server_section["max_file_size"]);
                     config.max_files = server_section["max_files"].String().empty() ? 10 : static_cast<size_t>(server_section["max_files"]);
+                    config.log_payload_limit = server_section["log_payload_limit"].String().empty() ? 2048 : static_cast<size_t>(server_section["log_payload_limit"]);
+                    config.log_binary = server_section["log_binary"].String().empty() ? false : static_cast<bool>(server_section["log_binary"]);
+                    config.log_format = server_section["log_format"].String().empty() ? "text" : server_section["log_format"].String();
+                    config.log_overflow = server_section["log_overflow"].String().empty() ? "drop" : server_section["log_overflow"].String();
+                    config.log_ring_bytes = server_section["log_ring_bytes"].String().empty() ? 262144 : static_cast<size_t>(server_section["log_ring_bytes"]);
                     config.port = server_section["port"].String().empty() ? 6666 : static_cast<unsigned short>(server_section["port"]);
                     config.http_port = server_section["http_port"].String().empty() ? 6666 : static_cast<unsigned short>(server_section["http_port"]);
                     config.https_port = server_section["https_port"].String().empty() ? 6667 : static_cast<unsigned short>(server_section["https_port"]);
 
                     config.max_requests_per_second = server_section["max_requests_per_second"].String().empty() ? 100 : static_cast<size_t>(server_section["max_requests_per_second"]);
                     config.max_concurrent_requests = server_section["max_concurrent_requests"].String().empty() ? 1000 : static_cast<size_t>(server_section["max_concurrent_requests"]);
+                    config.rate_limit_burst = server_section["rate_limit_burst"].String().empty() ? 0 : static_cast<size_t>(server_section["rate_limit_burst"]);
+                    config.tenant_requests_per_second = server_section["tenant_requests_per_second"].String().empty() ? 0 : static_cast<size_t>(server_section["tenant_requests_per_second"]);
+                    config.tenant_rate_limit_burst = server_section["tenant_rate_limit_burst"].String().empty() ? 0 : static_cast<size_t>(server_section["tenant_rate_limit_burst"]);
+                    config.tenant_rate_limits = server_section["tenant_rate_limits"].String();
                     config.max_request_size = server_section["max_request_size"].String().empty() ? 1024 * 1024 : static_cast<size_t>(server_section["max_request_size"]);
                     config.max_response_size = server_section["max_response_size"].String().empty() ? 10 * 1024 * 1024 : static_cast<size_t>(server_section["max_response_size"]);
 
+                    config.io_threads = server_section["io_threads"].String().empty() ? 0 : static_cast<size_t>(server_section["io_threads"]);
+                    config.io_thread_name = server_section["io_thread_name"].String().empty() ? "mcp-io" : server_section["io_thread_name"].String();
+                    config.io_cpu_affinity = server_section["io_cpu_affinity"].String();
+                    config.io_lag_probe_ms = server_section["io_lag_probe_ms"].String().empty() ? 100 : static_cast<size_t>(server_section["io_lag_probe_ms"]);
+                    config.io_busy_poll_us = server_section["io_busy_poll_us"].String().empty() ? 0 : static_cast<size_t>(server_section["io_busy_poll_us"]);
+                    config.pool_huge_pages = server_section["pool_huge_pages"].String().empty() ? "off" : server_section["pool_huge_pages"].String();
+                    config.pool_numa = server_section["pool_numa"].String().empty() ? false : static_cast<bool>(server_section["pool_numa"]);
+                    config.https_io_threads = server_section["https_io_threads"].String().empty() ? 0 : static_cast<size_t>(server_section["https_io_threads"]);
+                    config.https_io_cpu_affinity = server_section["https_io_cpu_affinity"].String();
+                    config.https_handshake_threads = server_section["https_handshake_threads"].String().empty() ? 0 : static_cast<size_t>(server_section["https_handshake_threads"]);
+                    config.http2 = server_section["http2"].String().empty() ? false : static_cast<bool>(server_section["http2"]);
+                    config.http2_max_concurrent_streams = server_section["http2_max_concurrent_streams"].String().empty() ? 100 : static_cast<size_t>(server_section["http2_max_concurrent_streams"]);
+                    config.http2_initial_window_size = server_section["http2_initial_window_size"].String().empty() ? 1048576 : static_cast<size_t>(server_section["http2_initial_window_size"]);
+                    config.websocket = server_section["websocket"].String().empty() ? false : static_cast<bool>(server_section["websocket"]);
+                    config.websocket_max_message_size = server_section["websocket_max_message_size"].String().empty() ? 16777216 : static_cast<size_t>(server_section["websocket_max_message_size"]);
+                    config.websocket_max_in_flight = server_section["websocket_max_in_flight"].String().empty() ? 32 : static_cast<size_t>(server_section["websocket_max_in_flight"]);
+                    config.unix_socket = server_section["unix_socket"].String();
+                    config.unix_socket_peer_auth = server_section["unix_socket_peer_auth"].String().empty() ? false : static_cast<bool>(server_section["unix_socket_peer_auth"]);
+                    config.unix_socket_allowed_uids = server_section["unix_socket_allowed_uids"].String();
+                    config.unix_memfd_min_size = server_section["unix_memfd_min_size"].String().empty() ? 1048576 : static_cast<size_t>(server_section["unix_memfd_min_size"]);
+                    config.stdio_read_buffer_size = server_section["stdio_read_buffer_size"].String().empty() ? 65536 : static_cast<size_t>(server_section["stdio_read_buffer_size"]);
+                    config.stdio_max_in_flight = server_section["stdio_max_in_flight"].String().empty() ? 64 : static_cast<size_t>(server_section["stdio_max_in_flight"]);
+                    config.compression = server_section["compression"].String().empty() ? false : static_cast<bool>(server_section["compression"]);
+                    config.compression_min_size = server_section["compression_min_size"].String().empty() ? 1024 : static_cast<size_t>(server_section["compression_min_size"]);
+                    config.compression_level = server_section["compression_level"].String().empty() ? 6 : static_cast<int>(server_section["compression_level"]);
+                    config.compression_offload_size = server_section["compression_offload_size"].String().empty() ? 65536 : static_cast<size_t>(server_section["compression_offload_size"]);
+                    config.compression_streaming = server_section["compression_streaming"].String().empty() ? true : static_cast<bool>(server_section["compression_streaming"]);
+                    config.request_decompression = server_section["request_decompression"].String().empty() ? true : static_cast<bool>(server_section["request_decompression"]);
+                    config.max_decompressed_request_size = server_section["max_decompressed_request_size"].String().empty() ? 16777216 : static_cast<size_t>(server_section["max_decompressed_request_size"]);
+                    config.header_timeout_ms = server_section["header_timeout_ms"].String().empty() ? 10000 : static_cast<size_t>(server_section["header_timeout_ms"]);
+                    config.body_timeout_ms = server_section["body_timeout_ms"].String().empty() ? 30000 : static_cast<size_t>(server_section["body_timeout_ms"]);
+                    config.keepalive_timeout_ms = server_section["keepalive_timeout_ms"].String().empty() ? 60000 : static_cast<size_t>(server_section["keepalive_timeout_ms"]);
+                    config.metrics_endpoint = server_section["metrics_endpoint"].String().empty() ? true : static_cast<bool>(server_section["metrics_endpoint"]);
+                    config.metrics_path = server_section["metrics_path"].String().empty() ? "/metrics" : server_section["metrics_path"].String();
+                    config.trace_sample_every = server_section["trace_sample_every"].String().empty() ? 0 : static_cast<size_t>(server_section["trace_sample_every"]);
+                    config.otlp_endpoint = server_section["otlp_endpoint"].String();
+                    config.otlp_service_name = server_section["otlp_service_name"].String().empty() ? "mcp-server" : server_section["otlp_service_name"].String();
+                    config.otlp_sample_every = server_section["otlp_sample_every"].String().empty() ? 1 : static_cast<size_t>(server_section["otlp_sample_every"]);
+                    config.otlp_batch_size = server_section["otlp_batch_size"].String().empty() ? 512 : static_cast<size_t>(server_section["otlp_batch_size"]);
+                    config.otlp_export_interval_ms = server_section["otlp_export_interval_ms"].String().empty() ? 5000 : static_cast<size_t>(server_section["otlp_export_interval_ms"]);
+                    config.metrics_statsd_endpoint = server_section["metrics_statsd_endpoint"].String();
+                    config.metrics_statsd_prefix = server_section["metrics_statsd_prefix"].String().empty() ? "mcp." : server_section["metrics_statsd_prefix"].String();
+                    config.metrics_otlp_endpoint = server_section["metrics_otlp_endpoint"].String();
+                    config.metrics_push_interval_ms = server_section["metrics_push_interval_ms"].String().empty() ? 10000 : static_cast<size_t>(server_section["metrics_push_interval_ms"]);
+                    config.metrics_push_buffer_bytes = server_section["metrics_push_buffer_bytes"].String().empty() ? 1048576 : static_cast<size_t>(server_section["metrics_push_buffer_bytes"]);
+                    config.debug_endpoints = server_section["debug_endpoints"].String().empty() ? false : static_cast<bool>(server_section["debug_endpoints"]);
+                    config.max_profile_seconds = server_section["max_profile_seconds"].String().empty() ? 60 : static_cast<size_t>(server_section["max_profile_seconds"]);
+                    config.admin_stats_endpoint = server_section["admin_stats_endpoint"].String().empty() ? false : static_cast<bool>(server_section["admin_stats_endpoint"]);
+                    config.admin_token = server_section["admin_token"].String();
+                    config.access_log_path = server_section["access_log_path"].String();
+                    config.access_log_error_sample_every = server_section["access_log_error_sample_every"].String().empty() ? 1 : static_cast<size_t>(server_section["access_log_error_sample_every"]);
+                    config.access_log_success_sample_every = server_section["access_log_success_sample_every"].String().empty() ? 100 : static_cast<size_t>(server_section["access_log_success_sample_every"]);
+                    config.access_log_batch_size = server_section["access_log_batch_size"].String().empty() ? 256 : static_cast<size_t>(server_section["access_log_batch_size"]);
+                    config.access_log_flush_ms = server_section["access_log_flush_ms"].String().empty() ? 1000 : static_cast<size_t>(server_section["access_log_flush_ms"]);
+                    config.audit_log_dir = server_section["audit_log_dir"].String();
+                    config.audit_segment_bytes = server_section["audit_segment_bytes"].String().empty() ? 67108864 : static_cast<size_t>(server_section["audit_segment_bytes"]);
+                    config.audit_sync_interval_ms = server_section["audit_sync_interval_ms"].String().empty() ? 100 : static_cast<size_t>(server_section["audit_sync_interval_ms"]);
+                    config.audit_ring_bytes = server_section["audit_ring_bytes"].String().empty() ? 262144 : static_cast<size_t>(server_section["audit_ring_bytes"]);
+                    config.capture_path = server_section["capture_path"].String();
+                    config.capture_redact_fields = server_section["capture_redact_fields"].String().empty() ? "password,token,secret,api_key,apiKey,authorization,access_token" : server_section["capture_redact_fields"].String();
+                    config.reuse_port = server_section["reuse_port"].String().empty() ? false : static_cast<bool>(server_section["reuse_port"]);
+                    config.shared_nothing = server_section["shared_nothing"].String().empty() ? false : static_cast<bool>(server_section["shared_nothing"]);
+                    config.drain_timeout_ms = server_section["drain_timeout_ms"].String().empty() ? 30000 : static_cast<size_t>(server_section["drain_timeout_ms"]);
+                    config.drain_stream_spread_ms = server_section["drain_stream_spread_ms"].String().empty() ? 10000 : static_cast<size_t>(server_section["drain_stream_spread_ms"]);
+                    config.hot_restart_socket = server_section["hot_restart_socket"].String();
+                    config.background_tool_loading = server_section["background_tool_loading"].String().empty() ? true : static_cast<bool>(server_section["background_tool_loading"]);
+                    config.ready_path = server_section["ready_path"].String();
+                    config.startup_timeline = server_section["startup_timeline"].String().empty() ? false : static_cast<bool>(server_section["startup_timeline"]);
+
                     config.enable_stdio = server_section["enable_stdio"].String().empty() ? true : static_cast<bool>(server_section["enable_stdio"]);
                     config.enable_http = server_section["enable_http"].String().empty() ? false : static_cast<bool>(server_section["enable_http"]);
                     config.enable_https = server_section["enable_https"].String().empty() ? false : static_cast<bool>(server_section["enable_https"]);
@@ -115,6 +333,255 @@ namespace mcp {
             }
         };
 
+        /**
+ * Transport (TCP socket tuning) configuration
+ */
+        struct TransportConfig {
+            bool tcp_nodelay;
+            bool tcp_quickack;
+            bool tcp_keepalive;
+            int send_buffer_size;
+            int receive_buffer_size;
+            int listen_backlog;
+            int tcp_fastopen;
+            std::string tcp_congestion;
+            int tcp_notsent_lowat;
+            int tcp_user_timeout_ms;
+            size_t resource_stream_threshold;
+            size_t resource_stream_window;
+            size_t resource_read_max_uris;
+            size_t resource_read_concurrency;
+            size_t result_stream_threshold;
+            size_t result_stream_chunk;
+            size_t upload_stream_threshold;
+            size_t upload_max_size;
+            int resource_notify_debounce_ms;
+            bool resource_watch_files;
+
+            static TransportConfig load(inicpp::IniManager &ini) {
+                try {
+                    TransportConfig config;
+                    auto section = ini["transport"];
+                    config.tcp_nodelay = section["tcp_nodelay"].String().empty() ? true : static_cast<bool>(section["tcp_nodelay"]);
+                    config.tcp_quickack = section["tcp_quickack"].String().empty() ? false : static_cast<bool>(section["tcp_quickack"]);
+                    config.tcp_keepalive = section["tcp_keepalive"].String().empty() ? false : static_cast<bool>(section["tcp_keepalive"]);
+                    config.send_buffer_size = section["send_buffer_size"].String().empty() ? 0 : static_cast<int>(section["send_buffer_size"]);
+                    config.receive_buffer_size = section["receive_buffer_size"].String().empty() ? 0 : static_cast<int>(section["receive_buffer_size"]);
+                    config.listen_backlog = section["listen_backlog"].String().empty() ? 0 : static_cast<int>(section["listen_backlog"]);
+                    config.tcp_fastopen = section["tcp_fastopen"].String().empty() ? 0 : static_cast<int>(section["tcp_fastopen"]);
+                    config.tcp_congestion = section["tcp_congestion"].String();
+                    config.tcp_notsent_lowat = section["tcp_notsent_lowat"].String().empty() ? 0 : static_cast<int>(section["tcp_notsent_lowat"]);
+                    config.tcp_user_timeout_ms = section["tcp_user_timeout_ms"].String().empty() ? 0 : static_cast<int>(section["tcp_user_timeout_ms"]);
+                    config.resource_stream_threshold = section["resource_stream_threshold"].String().empty() ? 8388608 : static_cast<size_t>(section["resource_stream_threshold"]);
+                    config.resource_stream_window = section["resource_stream_window"].String().empty() ? 1048576 : static_cast<size_t>(section["resource_stream_window"]);
+                    config.resource_read_max_uris = section["resource_read_max_uris"].String().empty() ? 64 : static_cast<size_t>(section["resource_read_max_uris"]);
+                    config.resource_read_concurrency = section["resource_read_concurrency"].String().empty() ? 8 : static_cast<size_t>(section["resource_read_concurrency"]);
+                    config.result_stream_threshold = section["result_stream_threshold"].String().empty() ? 1048576 : static_cast<size_t>(section["result_stream_threshold"]);
+                    config.result_stream_chunk = section["result_stream_chunk"].String().empty() ? 65536 : static_cast<size_t>(section["result_stream_chunk"]);
+                    config.upload_stream_threshold = section["upload_stream_threshold"].String().empty() ? 16777216 : static_cast<size_t>(section["upload_stream_threshold"]);
+                    config.upload_max_size = section["upload_max_size"].String().empty() ? 268435456 : static_cast<size_t>(section["upload_max_size"]);
+                    config.resource_notify_debounce_ms = section["resource_notify_debounce_ms"].String().empty() ? 100 : static_cast<int>(section["resource_notify_debounce_ms"]);
+                    config.resource_watch_files = section["resource_watch_files"].String().empty() ? true : static_cast<bool>(section["resource_watch_files"]);
+                    return config;
+                } catch (const std::exception &e) {
+                    MCP_ERROR("Failed to load transport config: {}", e.what());
+                    throw;
+                }
+            }
+        };
+
+        /**
+ * Tool call concurrency configuration
+ */
+        struct ConcurrencyConfig {
+            size_t tool_threads;
+            size_t tool_threads_max;
+            size_t tool_blocked_cpu_percent;
+            size_t max_in_flight;
+            std::string tool_limits;
+            size_t queue_size;
+            size_t queue_timeout_ms;
+            size_t overload_lag_ms;
+            size_t overload_retry_after_s;
+            size_t control_threads;
+            std::string control_plane_methods;
+            std::string control_plane_tools;
+            size_t stream_pump_threads;
+            size_t stream_pump_queue;
+            size_t max_batch_size;
+            size_t batch_deadline_ms;
+            size_t tool_timeout_ms;
+            std::string tool_timeouts;
+            size_t progress_max_per_second;
+            size_t tool_batch_window_us;
+            size_t tool_batch_max;
+            std::string fair_scheduling;
+            std::string fair_weights;
+            size_t fair_slots;
+            std::string tenants;
+            std::string tenant_tool_slots;
+
+            static ConcurrencyConfig load(inicpp::IniManager &ini) {
+                try {
+                    ConcurrencyConfig config;
+                    auto section = ini["concurrency"];
+                    config.tool_threads = section["tool_threads"].String().empty() ? 0 : static_cast<size_t>(section["tool_threads"]);
+                    config.tool_threads_max = section["tool_threads_max"].String().empty() ? 0 : static_cast<size_t>(section["tool_threads_max"]);
+                    config.tool_blocked_cpu_percent = section["tool_blocked_cpu_percent"].String().empty() ? 50 : static_cast<size_t>(section["tool_blocked_cpu_percent"]);
+                    config.max_in_flight = section["max_in_flight"].String().empty() ? 0 : static_cast<size_t>(section["max_in_flight"]);
+                    config.tool_limits = section["tool_limits"].String();
+                    config.queue_size = section["queue_size"].String().empty() ? 64 : static_cast<size_t>(section["queue_size"]);
+                    config.queue_timeout_ms = section["queue_timeout_ms"].String().empty() ? 5000 : static_cast<size_t>(section["queue_timeout_ms"]);
+                    config.overload_lag_ms = section["overload_lag_ms"].String().empty() ? 0 : static_cast<size_t>(section["overload_lag_ms"]);
+                    config.overload_retry_after_s = section["overload_retry_after_s"].String().empty() ? 1 : static_cast<size_t>(section["overload_retry_after_s"]);
+                    config.control_threads = section["control_threads"].String().empty() ? 1 : static_cast<size_t>(section["control_threads"]);
+                    config.control_plane_methods = section["control_plane_methods"].String().empty() ? "initialize,ping,tools/list,notifications/initialized,notifications/cancelled" : section["control_plane_methods"].String();
+                    config.control_plane_tools = section["control_plane_tools"].String();
+                    config.stream_pump_threads = section["stream_pump_threads"].String().empty() ? 0 : static_cast<size_t>(section["stream_pump_threads"]);
+                    config.stream_pump_queue = section["stream_pump_queue"].String().empty() ? 64 : static_cast<size_t>(section["stream_pump_queue"]);
+                    config.max_batch_size = section["max_batch_size"].String().empty() ? 64 : static_cast<size_t>(section["max_batch_size"]);
+                    config.batch_deadline_ms = section["batch_deadline_ms"].String().empty() ? 30000 : static_cast<size_t>(section["batch_deadline_ms"]);
+                    config.tool_timeout_ms = section["tool_timeout_ms"].String().empty() ? 0 : static_cast<size_t>(section["tool_timeout_ms"]);
+                    config.tool_timeouts = section["tool_timeouts"].String();
+                    config.progress_max_per_second = section["progress_max_per_second"].String().empty() ? 10 : static_cast<size_t>(section["progress_max_per_second"]);
+                    config.tool_batch_window_us = section["tool_batch_window_us"].String().empty() ? 0 : static_cast<size_t>(section["tool_batch_window_us"]);
+                    config.tool_batch_max = section["tool_batch_max"].String().empty() ? 32 : static_cast<size_t>(section["tool_batch_max"]);
+                    config.fair_scheduling = section["fair_scheduling"].String().empty() ? "off" : section["fair_scheduling"].String();
+                    config.fair_weights = section["fair_weights"].String();
+                    config.fair_slots = section["fair_slots"].String().empty() ? 0 : static_cast<size_t>(section["fair_slots"]);
+                    config.tenants = section["tenants"].String();
+                    config.tenant_tool_slots = section["tenant_tool_slots"].String();
+                    return config;
+                } catch (const std::exception &e) {
+                    MCP_ERROR("Failed to load concurrency config: {}", e.what());
+                    throw;
+                }
+            }
+        };
+
+        /**
+ * Cluster (session ownership across replicas) configuration
+ */
+        struct ClusterConfig {
+            bool enabled;
+            std::string node_id;
+            std::string bind;
+            std::string advertise;
+            std::string seeds;
+            std::string secret;
+            size_t gossip_interval_ms;
+            size_t suspect_after_ms;
+            size_t virtual_nodes;
+            size_t forward_timeout_ms;
+
+            static ClusterConfig load(inicpp::IniManager &ini) {
+                try {
+                    ClusterConfig config;
+                    auto section = ini["cluster"];
+                    config.enabled = section["enabled"].String().empty() ? false : static_cast<bool>(section["enabled"]);
+                    config.node_id = section["node_id"].String();
+                    config.bind = section["bind"].String().empty() ? "0.0.0.0:7946" : section["bind"].String();
+                    config.advertise = section["advertise"].String();
+                    config.seeds = section["seeds"].String();
+                    config.secret = section["secret"].String();
+                    config.gossip_interval_ms = section["gossip_interval_ms"].String().empty() ? 1000 : static_cast<size_t>(section["gossip_interval_ms"]);
+                    config.suspect_after_ms = section["suspect_after_ms"].String().empty() ? 5000 : static_cast<size_t>(section["suspect_after_ms"]);
+                    config.virtual_nodes = section["virtual_nodes"].String().empty() ? 64 : static_cast<size_t>(section["virtual_nodes"]);
+                    config.forward_timeout_ms = section["forward_timeout_ms"].String().empty() ? 5000 : static_cast<size_t>(section["forward_timeout_ms"]);
+                    return config;
+                } catch (const std::exception &e) {
+                    MCP_ERROR("Failed to load cluster config: {}", e.what());
+                    throw;
+                }
+            }
+        };
+
+        /**
+ * Federation (tools of upstream MCP servers) configuration
+ */
+        struct FederationConfig {
+            std::string upstreams;
+            bool prefix_tools;
+            std::string token;
+            size_t max_idle_connections;
+            size_t call_timeout_ms;
+            size_t health_interval_ms;
+            size_t refresh_interval_s;
+
+            static FederationConfig load(inicpp::IniManager &ini) {
+                try {
+                    FederationConfig config;
+                    auto section = ini["federation"];
+                    config.upstreams = section["upstreams"].String();
+                    config.prefix_tools = section["prefix_tools"].String().empty() ? true : static_cast<bool>(section["prefix_tools"]);
+                    config.token = section["token"].String();
+                    config.max_idle_connections = section["max_idle_connections"].String().empty() ? 8 : static_cast<size_t>(section["max_idle_connections"]);
+                    config.call_timeout_ms = section["call_timeout_ms"].String().empty() ? 30000 : static_cast<size_t>(section["call_timeout_ms"]);
+                    config.health_interval_ms = section["health_interval_ms"].String().empty() ? 5000 : static_cast<size_t>(section["health_interval_ms"]);
+                    config.refresh_interval_s = section["refresh_interval_s"].String().empty() ? 60 : static_cast<size_t>(section["refresh_interval_s"]);
+                    return config;
+                } catch (const std::exception &e) {
+                    MCP_ERROR("Failed to load federation config: {}", e.what());
+                    throw;
+                }
+            }
+        };
+
+        /**
+ * Reconnect cache configuration
+ */
+        struct CacheConfig {
+            size_t max_sessions;
+            size_t max_events_per_session;
+            size_t ttl_s;
+            size_t max_bytes;
+            size_t shards;
+            std::string tool_ttls;
+            std::string result_cache_tools;
+            size_t result_cache_max_bytes;
+            size_t result_cache_max_result_bytes;
+            size_t idempotency_ttl_s;
+            size_t idempotency_max_bytes;
+            size_t resource_cache_ttl_s;
+            size_t resource_cache_max_bytes;
+            size_t prompt_cache_max_bytes;
+            std::string persistence;
+            std::string persistence_dir;
+            size_t persistence_flush_ms;
+            std::string stream_state_commit;
+            size_t stream_state_commit_interval_ms;
+
+            static CacheConfig load(inicpp::IniManager &ini) {
+                try {
+                    CacheConfig config;
+                    auto section = ini["cache"];
+                    config.max_sessions = section["max_sessions"].String().empty() ? 1000 : static_cast<size_t>(section["max_sessions"]);
+                    config.max_events_per_session = section["max_events_per_session"].String().empty() ? 500 : static_cast<size_t>(section["max_events_per_session"]);
+                    config.ttl_s = section["ttl_s"].String().empty() ? 86400 : static_cast<size_t>(section["ttl_s"]);
+                    config.max_bytes = section["max_bytes"].String().empty() ? 268435456 : static_cast<size_t>(section["max_bytes"]);
+                    config.shards = section["shards"].String().empty() ? 0 : static_cast<size_t>(section["shards"]);
+                    config.tool_ttls = section["tool_ttls"].String();
+                    config.result_cache_tools = section["result_cache_tools"].String();
+                    config.result_cache_max_bytes = section["result_cache_max_bytes"].String().empty() ? 67108864 : static_cast<size_t>(section["result_cache_max_bytes"]);
+                    config.resource_cache_ttl_s = section["resource_cache_ttl_s"].String().empty() ? 0 : static_cast<size_t>(section["resource_cache_ttl_s"]);
+                    config.resource_cache_max_bytes = section["resource_cache_max_bytes"].String().empty() ? 67108864 : static_cast<size_t>(section["resource_cache_max_bytes"]);
+                    config.prompt_cache_max_bytes = section["prompt_cache_max_bytes"].String().empty() ? 8388608 : static_cast<size_t>(section["prompt_cache_max_bytes"]);
+                    config.result_cache_max_result_bytes = section["result_cache_max_result_bytes"].String().empty() ? 1048576 : static_cast<size_t>(section["result_cache_max_result_bytes"]);
+                    config.idempotency_ttl_s = section["idempotency_ttl_s"].String().empty() ? 300 : static_cast<size_t>(section["idempotency_ttl_s"]);
+                    config.idempotency_max_bytes = section["idempotency_max_bytes"].String().empty() ? 16777216 : static_cast<size_t>(section["idempotency_max_bytes"]);
+                    config.persistence = section["persistence"].String().empty() ? "none" : section["persistence"].String();
+                    config.persistence_dir = section["persistence_dir"].String().empty() ? "cache" : section["persistence_dir"].String();
+                    config.persistence_flush_ms = section["persistence_flush_ms"].String().empty() ? 50 : static_cast<size_t>(section["persistence_flush_ms"]);
+                    config.stream_state_commit = section["stream_state_commit"].String().empty() ? "interval" : section["stream_state_commit"].String();
+                    config.stream_state_commit_interval_ms = section["stream_state_commit_interval_ms"].String().empty() ? 1000 : static_cast<size_t>(section["stream_state_commit_interval_ms"]);
+                    return config;
+                } catch (const std::exception &e) {
+                    MCP_ERROR("Failed to load cache config: {}", e.what());
+                    throw;
+                }
+            }
+        };
+
         /**
  * PluginHub configuration
  */
@@ -127,6 +594,8 @@ namespace mcp {
             std::string plugin_enable_dir;
             std::string tools_install_dir;
             std::string tools_enable_dir;
+            std::string plugin_cache_dir;
+            size_t download_jobs;
 
             static PluginHubConfig load(inicpp::IniManager &ini) {
                 try {
@@ -140,6 +609,8 @@ namespace mcp {
                     config.plugin_enable_dir = section["plugin_enable_dir"].String().empty() ? "plugins" : section["plugin_enable_dir"].String();
                     config.tools_install_dir = section["tools_install_dir"].String().empty() ? "plugins_install" : section["tools_install_dir"].String();
                     config.tools_enable_dir = section["tools_enable_dir"].String().empty() ? "configs" : section["tools_enable_dir"].String();
+                    config.plugin_cache_dir = section["plugin_cache_dir"].String().empty() ? "plugins_cache" : section["plugin_cache_dir"].String();
+                    config.download_jobs = section["download_jobs"].String().empty() ? 4 : static_cast<size_t>(section["download_jobs"]);
                     return config;
                 } catch (const std::exception &e) {
                     MCP_ERROR("Failed to load plugin hub config: {}", e.what());
@@ -155,6 +626,14 @@ namespace mcp {
             std::string default_env;
             std::string conda_prefix;
             std::string uv_venv_path;
+            size_t interpreters;
+            size_t workers;
+            std::string worker_executable;
+            size_t worker_buffer_kb;
+            size_t worker_max_calls;
+            size_t worker_max_rss_mb;
+            std::string bytecode_cache_dir;
+            std::string preload_modules;
 
             static PythonEnvConfig load(inicpp::IniManager &ini) {
                 try {
@@ -163,6 +642,14 @@ namespace mcp {
                     config.default_env = section["default"].String().empty() ? "system" : section["default"].String();
                     config.conda_prefix = section["conda_prefix"].String().empty() ? "/opt/conda" : section["conda_prefix"].String();
                     config.uv_venv_path = section["uv_venv_path"].String().empty() ? "./venv" : section["uv_venv_path"].String();
+                    config.interpreters = section["interpreters"].String().empty() ? 0 : static_cast<size_t>(section["interpreters"]);
+                    config.workers = section["workers"].String().empty() ? 0 : static_cast<size_t>(section["workers"]);
+                    config.worker_executable = section["worker_executable"].String().empty() ? "python3" : section["worker_executable"].String();
+                    config.worker_buffer_kb = section["worker_buffer_kb"].String().empty() ? 1024 : static_cast<size_t>(section["worker_buffer_kb"]);
+                    config.worker_max_calls = section["worker_max_calls"].String().empty() ? 0 : static_cast<size_t>(section["worker_max_calls"]);
+                    config.worker_max_rss_mb = section["worker_max_rss_mb"].String().empty() ? 0 : static_cast<size_t>(section["worker_max_rss_mb"]);
+                    config.bytecode_cache_dir = section["bytecode_cache_dir"].String();
+                    config.preload_modules = section["preload_modules"].String();
                     return config;
                 } catch (const std::exception &e) {
                     MCP_ERROR("Failed to load Python env config: {}", e.what());
@@ -177,6 +664,11 @@ namespace mcp {
         struct GlobalConfig {
             std::string title;
             ServerConfig server;
+            TransportConfig transport;
+            ConcurrencyConfig concurrency;
+            ClusterConfig cluster;
+            FederationConfig federation;
+            CacheConfig cache;
             PluginHubConfig plugin_hub;
             PythonEnvConfig python_env;
 
@@ -188,6 +680,11 @@ namespace mcp {
                     GlobalConfig config;
                     config.title = ini[""]["title"].String().empty() ? "MCP Server Configuration" : ini[""]["title"].String();
                     config.server = ServerConfig::load(ini);
+                    config.transport = TransportConfig::load(ini);
+                    config.concurrency = ConcurrencyConfig::load(ini);
+                    config.cluster = ClusterConfig::load(ini);
+                    config.federation = FederationConfig::load(ini);
+                    config.cache = CacheConfig::load(ini);
                     config.plugin_hub = PluginHubConfig::load(ini);
                     config.python_env = PythonEnvConfig::load(ini);
                     return config;
@@ -203,18 +700,26 @@ namespace mcp {
 
         // Global state (managed by loader)
         inline std::unique_ptr<ConfigLoader> g_config_loader;
-        inline std::unique_ptr<GlobalConfig> g_current_config;
+        inline std::atomic<std::shared_ptr<const GlobalConfig>> g_current_config;///< Immutable; replaced whole on reload
+        inline std::atomic<uint64_t> g_config_version{0};
         inline std::mutex g_config_mutex;
         inline std::atomic<bool> g_config_initialized{false};
 
+        /**
+ * Make a config current; readers holding the previous one keep it until they drop it
+ */
+        inline void publish_config(std::shared_ptr<const GlobalConfig> config) {
+            g_current_config.store(std::move(config), std::memory_order_release);
+            g_config_version.fetch_add(1, std::memory_order_acq_rel);
+        }
+
         /**
  * Abstract base class using Template Method and Observer patterns
  */
         class ConfigLoader {
         protected:
             std::vector<ConfigObserver *> observers_;
-            std::atomic<bool> monitoring_active{false};
-            std::thread monitor_thread;
+            uint64_t monitor_task_ = 0;///< Housekeeping task polling the config file
 
             virtual std::unique_ptr<GlobalConfig> createDefaultConfig() = 0;
 
@@ -222,35 +727,28 @@ namespace mcp {
                 return std::make_unique<GlobalConfig>(GlobalConfig::load());
             }
 
-            virtual void startMonitoring(GlobalConfig *config) {
-                if (monitoring_active.load()) return;
-                monitoring_active = true;
-
-                monitor_thread = std::thread([this, config]() {
-                    std::filesystem::file_time_type last_write = {};
-                    while (monitoring_active.load()) {
-                        try {
-                            auto path = std::filesystem::path(get_config_file_path());
-                            if (std::filesystem::exists(path)) {
-                                auto curr_time = std::filesystem::last_write_time(path);
-                                if (curr_time != last_write) {
-                                    MCP_INFO("Config file changed, reloading...");
-                                    auto newConfig = loadFromStaticFile();
-                                    if (newConfig) {
-                                        std::lock_guard<std::mutex> lock(g_config_mutex);
-                                        *config = *newConfig;
-                                        notifyObservers(*config);
-                                        last_write = curr_time;
-                                    }
+            virtual void startMonitoring() {
+                if (monitor_task_ != 0) return;
+
+                monitor_task_ = core::Housekeeping::instance().every(std::chrono::seconds(2), [this, last_write = std::filesystem::file_time_type{}]() mutable {
+                    try {
+                        auto path = std::filesystem::path(get_config_file_path());
+                        if (std::filesystem::exists(path)) {
+                            auto curr_time = std::filesystem::last_write_time(path);
+                            if (curr_time != last_write) {
+                                MCP_INFO("Config file changed, reloading...");
+                                auto newConfig = loadFromStaticFile();
+                                if (newConfig) {
+                                    std::shared_ptr<const GlobalConfig> config = std::move(newConfig);
+                                    std::lock_guard<std::mutex> lock(g_config_mutex);
+                                    publish_config(config);
+                                    notifyObservers(*config);
+                                    last_write = curr_time;
                                 }
                             }
-                            std::this_thread::sleep_for(std::chrono::seconds(2));
-                        } catch (...) {
-                            if (monitoring_active.load()) {
-                                MCP_ERROR("Error monitoring config file");
-                            }
-                            break;
                         }
+                    } catch (...) {
+                        MCP_ERROR("Error monitoring config file");
                     }
                 });
             }
@@ -267,10 +765,7 @@ namespace mcp {
 
         public:
             virtual ~ConfigLoader() {
-                monitoring_active = false;
-                if (monitor_thread.joinable()) {
-                    monitor_thread.join();
-                }
+                core::Housekeeping::instance().cancel(std::exchange(monitor_task_, 0));
             }
 
             void addObserver(ConfigObserver *obs) {
@@ -282,6 +777,15 @@ namespace mcp {
                 }
             }
 
+            /**
+             * @brief Make a config current and notify the observers, as a reload of the file does.
+             */
+            void publish(std::shared_ptr<const GlobalConfig> config) {
+                std::lock_guard<std::mutex> lock(g_config_mutex);
+                publish_config(config);
+                notifyObservers(*config);
+            }
+
             void removeObserver(ConfigObserver *obs) {
                 std::lock_guard<std::mutex> lock(g_config_mutex);
                 observers_.erase(
@@ -306,7 +810,7 @@ namespace mcp {
                         break;
                     case ConfigMode::DYNAMIC:
                         config = loadFromStaticFile();
-                        startMonitoring(config.get());
+                        startMonitoring();
                         break;
                     default:
                         config = createDefaultConfig();
@@ -330,16 +834,206 @@ namespace mcp {
                 config->server.http_port = 6666;
                 config->server.https_port = 0;
                 config->server.log_level = "info";
+                config->server.log_payload_limit = 2048;
+                config->server.log_binary = false;
+                config->server.log_format = "text";
+                config->server.log_overflow = "drop";
+                config->server.log_ring_bytes = 262144;
                 config->server.plugin_dir = "plugins";
+                config->server.plugin_lazy_load = false;
+                config->server.plugin_idle_unload_s = 0;
+                config->server.plugin_isolation = "";
+                config->server.plugin_host_channels = 2;
+                config->server.plugin_host_buffer_kb = 256;
+                config->server.plugin_cpu_quota_ms = 0;
+                config->server.plugin_alloc_quota_mb = 0;
+                config->server.plugin_quota_window_s = 60;
+                config->server.plugin_quota_action = "throttle";
+                config->server.list_page_size = 0;
+                config->server.tools_list_delta = false;
+                config->server.tools_list_delta_max = 256;
+                config->server.validate_passthrough_results = true;
+                config->server.validate_tool_arguments = true;
+                config->server.stream_batch_max_items = 1;
+                config->server.stream_batch_max_delay_us = 0;
+                config->server.stream_queue_high_watermark = 1048576;
+                config->server.stream_queue_low_watermark = 262144;
+                config->server.stream_slow_consumer_policy = "block";
+                config->server.stream_heartbeat_interval_ms = 15000;
+                config->server.stream_heartbeat_jitter_ms = 2000;
                 config->server.enable_stdio = true;
                 config->server.enable_http = true;
                 config->server.enable_https = false;
                 config->server.enable_auth = false;
+                config->server.jwt_issuer = "";
+                config->server.jwt_audience = "";
+                config->server.jwt_jwks_url = "";
+                config->server.jwt_refresh_s = 300;
+                config->server.jwt_leeway_s = 60;
+                config->server.jwt_cache_size = 10000;
+                config->server.io_threads = 0;
+                config->server.io_thread_name = "mcp-io";
+                config->server.https_io_threads = 0;
+                config->server.https_handshake_threads = 0;
+                config->server.http2 = false;
+                config->server.http2_max_concurrent_streams = 100;
+                config->server.http2_initial_window_size = 1048576;
+                config->server.websocket = false;
+                config->server.websocket_max_message_size = 16777216;
+                config->server.websocket_max_in_flight = 32;
+                config->server.unix_socket = "";
+                config->server.unix_socket_peer_auth = false;
+                config->server.unix_socket_allowed_uids = "";
+                config->server.unix_memfd_min_size = 1048576;
+                config->server.stdio_read_buffer_size = 65536;
+                config->server.stdio_max_in_flight = 64;
+                config->server.compression = false;
+                config->server.compression_min_size = 1024;
+                config->server.compression_level = 6;
+                config->server.compression_offload_size = 65536;
+                config->server.compression_streaming = true;
+                config->server.request_decompression = true;
+                config->server.max_decompressed_request_size = 16777216;
+                config->server.header_timeout_ms = 10000;
+                config->server.body_timeout_ms = 30000;
+                config->server.keepalive_timeout_ms = 60000;
+                config->server.metrics_endpoint = true;
+                config->server.metrics_path = "/metrics";
+                config->server.trace_sample_every = 0;
+                config->server.otlp_endpoint = "";
+                config->server.otlp_service_name = "mcp-server";
+                config->server.otlp_sample_every = 1;
+                config->server.otlp_batch_size = 512;
+                config->server.otlp_export_interval_ms = 5000;
+                config->server.metrics_statsd_endpoint = "";
+                config->server.metrics_statsd_prefix = "mcp.";
+                config->server.metrics_otlp_endpoint = "";
+                config->server.metrics_push_interval_ms = 10000;
+                config->server.metrics_push_buffer_bytes = 1048576;
+                config->server.debug_endpoints = false;
+                config->server.max_profile_seconds = 60;
+                config->server.admin_stats_endpoint = false;
+                config->server.admin_token = "";
+                config->server.access_log_path = "";
+                config->server.access_log_error_sample_every = 1;
+                config->server.access_log_success_sample_every = 100;
+                config->server.access_log_batch_size = 256;
+                config->server.access_log_flush_ms = 1000;
+                config->server.audit_log_dir = "";
+                config->server.audit_segment_bytes = 67108864;
+                config->server.audit_sync_interval_ms = 100;
+                config->server.audit_ring_bytes = 262144;
+                config->server.capture_path = "";
+                config->server.capture_redact_fields = "password,token,secret,api_key,apiKey,authorization,access_token";
+                config->server.reuse_port = false;
+                config->server.shared_nothing = false;
+                config->server.drain_timeout_ms = 30000;
+                config->server.drain_stream_spread_ms = 10000;
+                config->server.hot_restart_socket = "";
+                config->server.background_tool_loading = true;
+                config->server.ready_path = "/readyz";
+                config->server.startup_timeline = false;
+                config->server.rate_limit_burst = 0;
+                config->server.tenant_requests_per_second = 0;
+                config->server.tenant_rate_limit_burst = 0;
+                config->server.tenant_rate_limits = "";
+                config->server.io_lag_probe_ms = 100;
+                config->server.io_busy_poll_us = 0;
+                config->server.pool_huge_pages = "off";
+                config->server.pool_numa = false;
+                config->transport.tcp_nodelay = true;
+                config->transport.tcp_quickack = false;
+                config->transport.tcp_keepalive = false;
+                config->transport.send_buffer_size = 0;
+                config->transport.receive_buffer_size = 0;
+                config->transport.listen_backlog = 0;
+                config->transport.tcp_fastopen = 0;
+                config->transport.tcp_congestion = "";
+                config->transport.tcp_notsent_lowat = 0;
+                config->transport.tcp_user_timeout_ms = 0;
+                config->transport.resource_stream_threshold = 8388608;
+                config->transport.resource_stream_window = 1048576;
+                config->transport.resource_read_max_uris = 64;
+                config->transport.resource_read_concurrency = 8;
+                config->transport.result_stream_threshold = 1048576;
+                config->transport.result_stream_chunk = 65536;
+                config->transport.upload_stream_threshold = 16777216;
+                config->transport.upload_max_size = 268435456;
+                config->transport.resource_notify_debounce_ms = 100;
+                config->transport.resource_watch_files = true;
+                config->concurrency.tool_threads = 0;
+                config->concurrency.tool_threads_max = 0;
+                config->concurrency.tool_blocked_cpu_percent = 50;
+                config->concurrency.max_in_flight = 0;
+                config->concurrency.queue_size = 64;
+                config->concurrency.queue_timeout_ms = 5000;
+                config->concurrency.overload_lag_ms = 0;
+                config->concurrency.overload_retry_after_s = 1;
+                config->concurrency.control_threads = 1;
+                config->concurrency.control_plane_methods = "initialize,ping,tools/list,notifications/initialized,notifications/cancelled";
+                config->concurrency.control_plane_tools = "";
+                config->concurrency.stream_pump_threads = 0;
+                config->concurrency.stream_pump_queue = 64;
+                config->concurrency.max_batch_size = 64;
+                config->concurrency.batch_deadline_ms = 30000;
+                config->concurrency.tool_timeout_ms = 0;
+                config->concurrency.progress_max_per_second = 10;
+                config->concurrency.tool_batch_window_us = 0;
+                config->concurrency.tool_batch_max = 32;
+                config->concurrency.fair_scheduling = "off";
+                config->concurrency.fair_weights = "";
+                config->concurrency.fair_slots = 0;
+                config->concurrency.tenants = "";
+                config->concurrency.tenant_tool_slots = "";
+                config->cluster.enabled = false;
+                config->cluster.node_id = "";
+                config->cluster.bind = "0.0.0.0:7946";
+                config->cluster.advertise = "";
+                config->cluster.seeds = "";
+                config->cluster.secret = "";
+                config->cluster.gossip_interval_ms = 1000;
+                config->cluster.suspect_after_ms = 5000;
+                config->cluster.virtual_nodes = 64;
+                config->cluster.forward_timeout_ms = 5000;
+                config->federation.upstreams = "";
+                config->federation.prefix_tools = true;
+                config->federation.token = "";
+                config->federation.max_idle_connections = 8;
+                config->federation.call_timeout_ms = 30000;
+                config->federation.health_interval_ms = 5000;
+                config->federation.refresh_interval_s = 60;
+                config->cache.max_sessions = 1000;
+                config->cache.max_events_per_session = 500;
+                config->cache.ttl_s = 86400;
+                config->cache.max_bytes = 268435456;
+                config->cache.shards = 0;
+                config->cache.result_cache_max_bytes = 67108864;
+                config->cache.result_cache_max_result_bytes = 1048576;
+                config->cache.idempotency_ttl_s = 300;
+                config->cache.idempotency_max_bytes = 16777216;
+                config->cache.resource_cache_ttl_s = 0;
+                config->cache.resource_cache_max_bytes = 67108864;
+                config->cache.prompt_cache_max_bytes = 8388608;
+                config->cache.persistence = "none";
+                config->cache.persistence_dir = "cache";
+                config->cache.persistence_flush_ms = 50;
+                config->cache.stream_state_commit = "interval";
+                config->cache.stream_state_commit_interval_ms = 1000;
                 config->plugin_hub.plugin_server_baseurl = "http://47.120.50.122";
                 config->plugin_hub.plugin_server_port = 6680;
+                config->plugin_hub.plugin_cache_dir = "plugins_cache";
+                config->plugin_hub.download_jobs = 4;
                 config->python_env.default_env = "system";
                 config->python_env.conda_prefix = "/opt/conda";
                 config->python_env.uv_venv_path = "./venv";
+                config->python_env.interpreters = 0;
+                config->python_env.workers = 0;
+                config->python_env.worker_executable = "python3";
+                config->python_env.worker_buffer_kb = 1024;
+                config->python_env.worker_max_calls = 0;
+                config->python_env.worker_max_rss_mb = 0;
+                config->python_env.bytecode_cache_dir = "";
+                config->python_env.preload_modules = "";
                 return config;
             }
         };
@@ -367,20 +1061,219 @@ namespace mcp {
                 ini.set("server", "log_path", "logs/mcp_server.log");
                 ini.set("server", "max_file_size", 10485760);
                 ini.set("server", "max_files", 10);
+                ini.set("server", "log_payload_limit", 2048);
+                ini.set("server", "log_binary", 0);
+                ini.set("server", "log_format", "text");
+                ini.set("server", "log_overflow", "drop");
+                ini.set("server", "log_ring_bytes", 262144);
                 ini.set("server", "plugin_dir", "plugins");
+                ini.set("server", "plugin_lazy_load", 0);
+                ini.set("server", "plugin_idle_unload_s", 0);
+                ini.set("server", "plugin_isolation", "");
+                ini.set("server", "plugin_host_channels", 2);
+                ini.set("server", "plugin_host_buffer_kb", 256);
+                ini.set("server", "plugin_cpu_quota_ms", 0);
+                ini.set("server", "plugin_alloc_quota_mb", 0);
+                ini.set("server", "plugin_quota_window_s", 60);
+                ini.set("server", "plugin_quota_action", "throttle");
+                ini.set("server", "list_page_size", 0);
+                ini.set("server", "tools_list_delta", 0);
+                ini.set("server", "tools_list_delta_max", 256);
+                ini.set("server", "validate_passthrough_results", 1);
+                ini.set("server", "validate_tool_arguments", 1);
+                ini.set("server", "stream_batch_max_items", 1);
+                ini.set("server", "stream_batch_max_delay_us", 0);
+                ini.set("server", "stream_queue_high_watermark", 1048576);
+                ini.set("server", "stream_queue_low_watermark", 262144);
+                ini.set("server", "stream_slow_consumer_policy", "block");
+                ini.set("server", "stream_heartbeat_interval_ms", 15000);
+                ini.set("server", "stream_heartbeat_jitter_ms", 2000);
                 ini.set("server", "enable_stdio", 1);
                 ini.set("server", "enable_http", 1);
                 ini.set("server", "enable_https", 0);
                 ini.set("server", "enable_auth", 0);
                 ini.set("server", "auth_type", "X-API-Key");
                 ini.set("server", "auth_env_file", ".env.auth");
+                ini.set("server", "jwt_issuer", "");
+                ini.set("server", "jwt_audience", "");
+                ini.set("server", "jwt_jwks_url", "");
+                ini.set("server", "jwt_refresh_s", 300);
+                ini.set("server", "jwt_leeway_s", 60);
+                ini.set("server", "jwt_cache_size", 10000);
                 ini.set("server", "ssl_cert_file", "certs/server.crt");
                 ini.set("server", "ssl_key_file", "certs/server.key");
                 ini.set("server", "ssl_dh_params_file", "certs/dh2048.pem");
+                ini.set("server", "ssl_session_cache_size", 20480);
+                ini.set("server", "ssl_session_timeout_s", 7200);
+                ini.set("server", "ssl_ticket_rotation_s", 3600);
                 ini.set("server", "max_requests_per_second", 100);
                 ini.set("server", "max_concurrent_requests", 1000);
+                ini.set("server", "rate_limit_burst", 0);
+                ini.set("server", "tenant_requests_per_second", 0);
+                ini.set("server", "tenant_rate_limit_burst", 0);
+                ini.set("server", "tenant_rate_limits", "");
                 ini.set("server", "max_request_size", 1024 * 1024);
                 ini.set("server", "max_response_size", 10 * 1024 * 1024);
+                ini.set("server", "io_threads", 0);
+                ini.set("server", "io_thread_name", "mcp-io");
+                ini.set("server", "io_cpu_affinity", "");
+                ini.set("server", "io_lag_probe_ms", 100);
+                ini.set("server", "io_busy_poll_us", 0);
+                ini.set("server", "pool_huge_pages", "off");
+                ini.set("server", "pool_numa", 0);
+                ini.set("server", "https_io_threads", 0);
+                ini.set("server", "https_io_cpu_affinity", "");
+                ini.set("server", "https_handshake_threads", 0);
+                ini.set("server", "http2", 0);
+                ini.set("server", "http2_max_concurrent_streams", 100);
+                ini.set("server", "http2_initial_window_size", 1048576);
+                ini.set("server", "websocket", 0);
+                ini.set("server", "websocket_max_message_size", 16777216);
+                ini.set("server", "websocket_max_in_flight", 32);
+                ini.set("server", "unix_socket", "");
+                ini.set("server", "unix_socket_peer_auth", 0);
+                ini.set("server", "unix_socket_allowed_uids", "");
+                ini.set("server", "unix_memfd_min_size", 1048576);
+                ini.set("server", "stdio_read_buffer_size", 65536);
+                ini.set("server", "stdio_max_in_flight", 64);
+                ini.set("server", "compression", 0);
+                ini.set("server", "compression_min_size", 1024);
+                ini.set("server", "compression_level", 6);
+                ini.set("server", "compression_offload_size", 65536);
+                ini.set("server", "compression_streaming", 1);
+                ini.set("server", "request_decompression", 1);
+                ini.set("server", "max_decompressed_request_size", 16777216);
+                ini.set("server", "header_timeout_ms", 10000);
+                ini.set("server", "body_timeout_ms", 30000);
+                ini.set("server", "keepalive_timeout_ms", 60000);
+                ini.set("server", "metrics_endpoint", 1);
+                ini.set("server", "metrics_path", "/metrics");
+                ini.set("server", "trace_sample_every", 0);
+                ini.set("server", "otlp_endpoint", "");
+                ini.set("server", "otlp_service_name", "mcp-server");
+                ini.set("server", "otlp_sample_every", 1);
+                ini.set("server", "otlp_batch_size", 512);
+                ini.set("server", "otlp_export_interval_ms", 5000);
+                ini.set("server", "metrics_statsd_endpoint", "");
+                ini.set("server", "metrics_statsd_prefix", "mcp.");
+                ini.set("server", "metrics_otlp_endpoint", "");
+                ini.set("server", "metrics_push_interval_ms", 10000);
+                ini.set("server", "metrics_push_buffer_bytes", 1048576);
+                ini.set("server", "debug_endpoints", 0);
+                ini.set("server", "max_profile_seconds", 60);
+                ini.set("server", "admin_stats_endpoint", 0);
+                ini.set("server", "admin_token", "");
+                ini.set("server", "access_log_path", "");
+                ini.set("server", "access_log_error_sample_every", 1);
+                ini.set("server", "access_log_success_sample_every", 100);
+                ini.set("server", "access_log_batch_size", 256);
+                ini.set("server", "access_log_flush_ms", 1000);
+                ini.set("server", "audit_log_dir", "");
+                ini.set("server", "audit_segment_bytes", 67108864);
+                ini.set("server", "audit_sync_interval_ms", 100);
+                ini.set("server", "audit_ring_bytes", 262144);
+                ini.set("server", "capture_path", "");
+                ini.set("server", "capture_redact_fields", "password,token,secret,api_key,apiKey,authorization,access_token");
+                ini.set("server", "reuse_port", 0);
+                ini.set("server", "shared_nothing", 0);
+                ini.set("server", "drain_timeout_ms", 30000);
+                ini.set("server", "drain_stream_spread_ms", 10000);
+                ini.set("server", "hot_restart_socket", "");
+                ini.set("server", "background_tool_loading", 1);
+                ini.set("server", "ready_path", "/readyz");
+                ini.set("server", "startup_timeline", 0);
+
+                // [transport]
+                ini.set("transport", "tcp_nodelay", 1);
+                ini.set("transport", "tcp_quickack", 0);
+                ini.set("transport", "tcp_keepalive", 0);
+                ini.set("transport", "send_buffer_size", 0);
+                ini.set("transport", "receive_buffer_size", 0);
+                ini.set("transport", "listen_backlog", 0);
+                ini.set("transport", "tcp_fastopen", 0);
+                ini.set("transport", "tcp_congestion", "");
+                ini.set("transport", "tcp_notsent_lowat", 0);
+                ini.set("transport", "tcp_user_timeout_ms", 0);
+                ini.set("transport", "resource_stream_threshold", 8388608);
+                ini.set("transport", "resource_stream_window", 1048576);
+                ini.set("transport", "resource_read_max_uris", 64);
+                ini.set("transport", "resource_read_concurrency", 8);
+                ini.set("transport", "result_stream_threshold", 1048576);
+                ini.set("transport", "result_stream_chunk", 65536);
+                ini.set("transport", "upload_stream_threshold", 16777216);
+                ini.set("transport", "upload_max_size", 268435456);
+                ini.set("transport", "resource_notify_debounce_ms", 100);
+                ini.set("transport", "resource_watch_files", 1);
+
+                // [concurrency]
+                ini.set("concurrency", "tool_threads", 0);
+                ini.set("concurrency", "tool_threads_max", 0);
+                ini.set("concurrency", "tool_blocked_cpu_percent", 50);
+                ini.set("concurrency", "max_in_flight", 0);
+                ini.set("concurrency", "tool_limits", "");
+                ini.set("concurrency", "queue_size", 64);
+                ini.set("concurrency", "queue_timeout_ms", 5000);
+                ini.set("concurrency", "overload_lag_ms", 0);
+                ini.set("concurrency", "overload_retry_after_s", 1);
+                ini.set("concurrency", "control_threads", 1);
+                ini.set("concurrency", "control_plane_methods", "initialize,ping,tools/list,notifications/initialized,notifications/cancelled");
+                ini.set("concurrency", "control_plane_tools", "");
+                ini.set("concurrency", "stream_pump_threads", 0);
+                ini.set("concurrency", "stream_pump_queue", 64);
+                ini.set("concurrency", "max_batch_size", 64);
+                ini.set("concurrency", "batch_deadline_ms", 30000);
+                ini.set("concurrency", "tool_timeout_ms", 0);
+                ini.set("concurrency", "tool_timeouts", "");
+                ini.set("concurrency", "progress_max_per_second", 10);
+                ini.set("concurrency", "tool_batch_window_us", 0);
+                ini.set("concurrency", "tool_batch_max", 32);
+                ini.set("concurrency", "fair_scheduling", "off");
+                ini.set("concurrency", "fair_weights", "");
+                ini.set("concurrency", "fair_slots", 0);
+                ini.set("concurrency", "tenants", "");
+                ini.set("concurrency", "tenant_tool_slots", "");
+
+                // [cluster]
+                ini.set("cluster", "enabled", 0);
+                ini.set("cluster", "node_id", "");
+                ini.set("cluster", "bind", "0.0.0.0:7946");
+                ini.set("cluster", "advertise", "");
+                ini.set("cluster", "seeds", "");
+                ini.set("cluster", "secret", "");
+                ini.set("cluster", "gossip_interval_ms", 1000);
+                ini.set("cluster", "suspect_after_ms", 5000);
+                ini.set("cluster", "virtual_nodes", 64);
+                ini.set("cluster", "forward_timeout_ms", 5000);
+
+                // [federation]
+                ini.set("federation", "upstreams", "");
+                ini.set("federation", "prefix_tools", 1);
+                ini.set("federation", "token", "");
+                ini.set("federation", "max_idle_connections", 8);
+                ini.set("federation", "call_timeout_ms", 30000);
+                ini.set("federation", "health_interval_ms", 5000);
+                ini.set("federation", "refresh_interval_s", 60);
+
+                // [cache]
+                ini.set("cache", "max_sessions", 1000);
+                ini.set("cache", "max_events_per_session", 500);
+                ini.set("cache", "ttl_s", 86400);
+                ini.set("cache", "max_bytes", 268435456);
+                ini.set("cache", "shards", 0);
+                ini.set("cache", "tool_ttls", "");
+                ini.set("cache", "result_cache_tools", "");
+                ini.set("cache", "result_cache_max_bytes", 67108864);
+                ini.set("cache", "result_cache_max_result_bytes", 1048576);
+                ini.set("cache", "idempotency_ttl_s", 300);
+                ini.set("cache", "idempotency_max_bytes", 16777216);
+                ini.set("cache", "resource_cache_ttl_s", 0);
+                ini.set("cache", "resource_cache_max_bytes", 67108864);
+                ini.set("cache", "prompt_cache_max_bytes", 8388608);
+                ini.set("cache", "persistence", "none");
+                ini.set("cache", "persistence_dir", "cache");
+                ini.set("cache", "persistence_flush_ms", 50);
+                ini.set("cache", "stream_state_commit", "interval");
+                ini.set("cache", "stream_state_commit_interval_ms", 1000);
 
                 // [plugin_hub]
                 ini.set("plugin_hub", "plugin_server_baseurl", "http://47.120.50.122");
@@ -391,6 +1284,8 @@ namespace mcp {
                 ini.set("plugin_hub", "plugin_enable_dir", "plugins");
                 ini.set("plugin_hub", "tools_install_dir", "plugins_install");
                 ini.set("plugin_hub", "tools_enable_dir", "configs");
+                ini.set("plugin_hub", "plugin_cache_dir", "plugins_cache");
+                ini.set("plugin_hub", "download_jobs", 4);
 
                 // Add comments for server section
                 ini.setComment("server", "ip", "IP address the server binds to");
@@ -401,21 +1296,221 @@ namespace mcp {
                 ini.setComment("server", "log_path", "Filesystem path for log storage");
                 ini.setComment("server", "max_file_size", "Maximum size per log file in bytes");
                 ini.setComment("server", "max_files", "Maximum number of rotated log files");
+                ini.setComment("server", "log_payload_limit", "Longest request or response body written to a debug log line in bytes, longer ones are cut (0=no limit)");
+                ini.setComment("server", "log_binary", "Queue log lines in per-thread ring buffers and format them on a backend thread (1=enable, 0=disable)");
+                ini.setComment("server", "log_format", "Line format of the binary log mode (text, json)");
+                ini.setComment("server", "log_overflow", "When a thread's log ring buffer is full: drop and count the line, or block until there is room (drop, block)");
+                ini.setComment("server", "log_ring_bytes", "Log ring buffer size per logging thread in bytes, rounded up to a power of two");
                 ini.setComment("server", "plugin_dir", "Directory containing plugin modules");
+                ini.setComment("server", "plugin_lazy_load", "Load plugins listed in plugins.manifest.json on first call (1=enable, 0=disable)");
+                ini.setComment("server", "plugin_idle_unload_s", "Unload lazily loaded plugins after this many seconds without calls (0 = keep loaded)");
+                ini.setComment("server", "plugin_isolation", "Comma-separated plugin file names or stems to run in a child process each, * for all (Linux only, empty = in process)");
+                ini.setComment("server", "plugin_host_channels", "Calls an isolated plugin's child process runs at the same time");
+                ini.setComment("server", "plugin_host_buffer_kb", "Shared memory per call channel of an isolated plugin in KiB; larger messages are passed in chunks");
+                ini.setComment("server", "plugin_cpu_quota_ms", "CPU time a plugin's calls and streams may use per quota window, in milliseconds (0 = unlimited)");
+                ini.setComment("server", "plugin_alloc_quota_mb", "Memory a plugin may allocate through the host allocator per quota window, in MiB (0 = unlimited)");
+                ini.setComment("server", "plugin_quota_window_s", "Length of the plugin quota window in seconds");
+                ini.setComment("server", "plugin_quota_action", "What happens to a plugin over its quota: throttle (refused until the window ends) or disable (refused until it is reloaded)");
+                ini.setComment("server", "list_page_size", "Tools, resources or prompts per page of a list result, the rest behind nextCursor (0 = no paging)");
+                ini.setComment("server", "tools_list_delta", "Send the tools added and removed with notifications/tools/list_changed (1=enable, 0=clients list again)");
+                ini.setComment("server", "tools_list_delta_max", "Changes of more tools than this are announced without a delta");
+                ini.setComment("server", "validate_passthrough_results", "Check plugin results marked as passthrough before sending them unparsed (1=enable, 0=trust the plugin)");
+                ini.setComment("server", "validate_tool_arguments", "Check tool arguments against the tool's parameters schema before calling the plugin (1=enable, 0=leave it to the plugin)");
+                ini.setComment("server", "stream_batch_max_items", "Send up to this many stream events per write (1 = one write per event)");
+                ini.setComment("server", "stream_batch_max_delay_us", "Keep pulling stream events into a batch for up to this many microseconds");
+                ini.setComment("server", "stream_queue_high_watermark", "Bytes queued for a slow stream client before the slow consumer policy applies");
+                ini.setComment("server", "stream_queue_low_watermark", "Bytes a paused or dropping stream drains down to before it resumes");
+                ini.setComment("server", "stream_slow_consumer_policy", "Slow stream client handling: block (pause the generator), drop_oldest or disconnect");
+                ini.setComment("server", "stream_heartbeat_interval_ms", "Send a keep-alive comment on a stream that wrote nothing for this long, so proxies keep it open (0=disable)");
+                ini.setComment("server", "stream_heartbeat_jitter_ms", "Spread the heartbeats of streams by up to this much, so they are not all due at once");
                 ini.setComment("server", "enable_stdio", "Enable stdio transport (1=enable, 0=disable)");
                 ini.setComment("server", "enable_http", "Enable HTTP transport (1=enable, 0=disable)");
                 ini.setComment("server", "enable_https", "Enable HTTPS transport (1=enable, 0=disable)");
                 ini.setComment("server", "enable_auth", "Enable authentication (1=enable, 0=disable)");
-                ini.setComment("server", "auth_type", "Authentication type (X-API-Key, Bearer)");
+                ini.setComment("server", "auth_type", "Authentication type (X-API-Key, Bearer, JWT)");
                 ini.setComment("server", "auth_env_file", "Authentication environment file path");
+                ini.setComment("server", "jwt_issuer", "JWT: required issuer (iss); without jwt_jwks_url the keys are found through its OpenID discovery document");
+                ini.setComment("server", "jwt_audience", "JWT: required audience (aud), empty=not checked");
+                ini.setComment("server", "jwt_jwks_url", "JWT: JWKS location, an http(s) URL or a file path (empty=discovered from jwt_issuer)");
+                ini.setComment("server", "jwt_refresh_s", "JWT: seconds between JWKS refreshes");
+                ini.setComment("server", "jwt_leeway_s", "JWT: clock skew allowed for exp and nbf, in seconds");
+                ini.setComment("server", "jwt_cache_size", "JWT: verified tokens remembered until they expire");
                 ini.setComment("server", "ssl_cert_file", "SSL certificate file path (required for HTTPS)");
                 ini.setComment("server", "ssl_key_file", "SSL private key file path (required for HTTPS)");
                 ini.setComment("server", "ssl_dh_params_file", "SSL Diffie-Hellman parameters file path (required for HTTPS)");
+                ini.setComment("server", "ssl_session_cache_size", "TLS sessions cached for resumption by reconnecting clients (0 = no cache)");
+                ini.setComment("server", "ssl_session_timeout_s", "Seconds a cached TLS session or session ticket can be resumed");
+                ini.setComment("server", "ssl_ticket_rotation_s", "Seconds a TLS session ticket key is used before it is replaced (0 = no tickets)");
                 // Rate limiter configuration comments
                 ini.setComment("server", "max_requests_per_second", "Rate limiter: maximum requests allowed per second");
                 ini.setComment("server", "max_concurrent_requests", "Rate limiter: maximum concurrent requests");
+                ini.setComment("server", "rate_limit_burst", "Rate limiter: requests a session may send in a burst (0 = max_requests_per_second)");
+                ini.setComment("server", "tenant_requests_per_second", "Rate limiter: requests per second of each API key or token, over all cluster nodes together (0 = no tenant limit)");
+                ini.setComment("server", "tenant_rate_limit_burst", "Rate limiter: requests a tenant may send in a burst (0 = tenant_requests_per_second)");
+                ini.setComment("server", "tenant_rate_limits", "Rate limiter: requests per second of named tenants, override tenant_requests_per_second, e.g. batch=50,ide=500");
                 ini.setComment("server", "max_request_size", "Rate limiter: maximum request size in bytes");
                 ini.setComment("server", "max_response_size", "Rate limiter: maximum response size in bytes");
+                // IO thread pool configuration comments
+                ini.setComment("server", "io_threads", "IO thread pool: number of io_context threads (0 = one per CPU)");
+                ini.setComment("server", "io_thread_name", "IO thread pool: thread name prefix, the thread index is appended");
+                ini.setComment("server", "io_cpu_affinity", "IO thread pool: CPUs to pin threads to, e.g. 0-15,32-47 (empty = no pinning)");
+                ini.setComment("server", "io_lag_probe_ms", "Period in milliseconds of the scheduling lag probe of each IO thread, exported as mcp_io_lag_seconds (0=no probe)");
+                ini.setComment("server", "pool_huge_pages", "Pages of the read buffer pools and cache tables: off, transparent (MADV_HUGEPAGE) or explicit (vm.nr_hugepages, transparent when used up); Linux only");
+                ini.setComment("server", "pool_numa", "Bind read buffer pools to the NUMA node of their io thread and interleave cache tables over all nodes; Linux only (1=enable, 0=disable)");
+                ini.setComment("server", "io_busy_poll_us", "Microseconds an IO thread polls for work before sleeping, also set as SO_BUSY_POLL on sockets; burns CPU, pin with io_cpu_affinity (0=off)");
+                ini.setComment("server", "https_io_threads", "HTTPS thread pool: dedicated threads for TLS sessions (0 = share the IO thread pool)");
+                ini.setComment("server", "https_io_cpu_affinity", "HTTPS thread pool: CPUs to pin threads to (empty = no pinning)");
+                ini.setComment("server", "https_handshake_threads", "HTTPS handshake pool: threads that run TLS handshakes before sessions move to the HTTPS pool (0 = handshake on the HTTPS pool)");
+                ini.setComment("server", "http2", "Offer HTTP/2 to HTTPS clients through ALPN (1=enable, 0=HTTP/1.1 only)");
+                ini.setComment("server", "http2_max_concurrent_streams", "HTTP/2: requests a client may have in flight per connection");
+                ini.setComment("server", "http2_initial_window_size", "HTTP/2: receive window in bytes announced per stream and for the connection");
+                ini.setComment("server", "websocket", "Accept WebSocket upgrades on the MCP endpoints of the HTTP and HTTPS listeners (1=enable, 0=disable)");
+                ini.setComment("server", "websocket_max_message_size", "WebSocket: largest message in bytes, larger ones close the connection");
+                ini.setComment("server", "websocket_max_in_flight", "WebSocket: messages handled at once per connection, reading pauses beyond");
+                ini.setComment("server", "unix_socket", "Serve HTTP on this Unix domain socket as well, '@name' for the abstract namespace (empty=disable)");
+                ini.setComment("server", "unix_socket_peer_auth", "Unix socket: authenticate clients by their user id (SO_PEERCRED) instead of auth headers (1=enable, 0=disable)");
+                ini.setComment("server", "unix_socket_allowed_uids", "Unix socket: comma separated user ids allowed with peer auth (empty=the server's own user)");
+                ini.setComment("server", "unix_memfd_min_size", "Unix socket: responses of at least this many bytes go in a sealed memfd to clients sending X-MCP-Accept-Memfd (0=never)");
+                ini.setComment("server", "stdio_read_buffer_size", "STDIO: bytes read from stdin at once, longer lines grow the buffer");
+                ini.setComment("server", "stdio_max_in_flight", "STDIO: messages handled at once, answers still go out in order (1=one by one)");
+                ini.setComment("server", "compression", "Compress responses for clients that send Accept-Encoding: zstd, gzip or deflate (1=enable, 0=disable)");
+                ini.setComment("server", "compression_min_size", "Compression: smallest body in bytes worth compressing");
+                ini.setComment("server", "compression_level", "Compression: level from 1 (fastest) to 9 (smallest)");
+                ini.setComment("server", "compression_offload_size", "Compression: bodies of at least this many bytes are compressed on the tool pool instead of the IO thread");
+                ini.setComment("server", "compression_streaming", "Compression: compress event streams and chunked resource reads as well (1=enable, 0=disable)");
+                ini.setComment("server", "request_decompression", "Accept POST bodies sent with Content-Encoding gzip, deflate or zstd (1=enable, 0=reject with 415)");
+                ini.setComment("server", "max_decompressed_request_size", "Largest size a compressed POST body may expand to, in bytes; max_request_size limits the compressed size");
+                ini.setComment("server", "header_timeout_ms", "Close HTTP/1.1 connections whose request headers take longer than this many milliseconds, counted from the connection or the first byte of the request (0=no limit)");
+                ini.setComment("server", "body_timeout_ms", "Close HTTP/1.1 connections whose request body takes longer than this many milliseconds after the headers (0=no limit)");
+                ini.setComment("server", "keepalive_timeout_ms", "Close kept-alive HTTP/1.1 connections after this many milliseconds without a new request (0=no limit)");
+                ini.setComment("server", "metrics_endpoint", "Serve the built-in metrics in Prometheus text format on the HTTP listeners, behind the same authentication as /mcp (1=enable, 0=disable)");
+                ini.setComment("server", "metrics_path", "GET path of the metrics endpoint");
+                ini.setComment("server", "trace_sample_every", "Break one in this many JSON-RPC requests down into per-stage latency histograms on the metrics endpoint (0=off, 1=every request)");
+                ini.setComment("server", "otlp_endpoint", "OTLP/HTTP collector that tracing spans are exported to, such as http://localhost:4318 (empty=tracing off)");
+                ini.setComment("server", "otlp_service_name", "service.name of the exported spans");
+                ini.setComment("server", "otlp_sample_every", "Trace one in this many requests that arrive without a traceparent header; requests with one follow the caller's sampling");
+                ini.setComment("server", "otlp_batch_size", "Spans per export request; up to four batches are queued, further spans are dropped");
+                ini.setComment("server", "otlp_export_interval_ms", "Longest time in milliseconds a span waits to be exported");
+                ini.setComment("server", "metrics_statsd_endpoint", "StatsD server (host:port, UDP) the built-in metrics are pushed to, for hosts that are not scraped (empty=off)");
+                ini.setComment("server", "metrics_statsd_prefix", "Put before every metric name pushed to StatsD");
+                ini.setComment("server", "metrics_otlp_endpoint", "OTLP/HTTP collector the built-in metrics are pushed to, such as http://localhost:4318 (empty=off)");
+                ini.setComment("server", "metrics_push_interval_ms", "Time in milliseconds between two metrics pushes");
+                ini.setComment("server", "metrics_push_buffer_bytes", "Pushes kept per exporter while its collector is unreachable, in bytes; the oldest are dropped beyond");
+                ini.setComment("server", "debug_endpoints", "Serve CPU and heap profiles under /debug/pprof/ on the HTTP listeners, behind the same authentication as /mcp (1=enable, 0=disable)");
+                ini.setComment("server", "max_profile_seconds", "Longest CPU profile in seconds that /debug/pprof/profile takes");
+                ini.setComment("server", "admin_stats_endpoint", "Serve live session, stream, cache and io_context counts as JSON on /admin/stats, behind the same authentication as /mcp (1=enable, 0=disable)");
+                ini.setComment("server", "admin_token", "Secret sent in X-Admin-Token to read and change pool sizes, limits and the log level on /admin/config while the server runs (empty=endpoint off)");
+                ini.setComment("server", "access_log_path", "File the built-in access log is appended to, one JSON line per request (empty=access log off)");
+                ini.setComment("server", "access_log_error_sample_every", "Log one in this many failed requests (HTTP status 400 or above, or a JSON-RPC error) of each IO thread (0=none)");
+                ini.setComment("server", "access_log_success_sample_every", "Log one in this many successful requests of each IO thread (0=none)");
+                ini.setComment("server", "access_log_batch_size", "Access log lines per write; up to four batches are queued, further lines are dropped");
+                ini.setComment("server", "access_log_flush_ms", "Longest time in milliseconds an access log line waits to be written");
+                ini.setComment("server", "audit_log_dir", "Directory of the audit log recording every tools/call, read with mcp_audit (empty=off)");
+                ini.setComment("server", "audit_segment_bytes", "Size of an audit log segment file; a new one is started when it is full");
+                ini.setComment("server", "audit_sync_interval_ms", "Longest time in milliseconds an audit record waits to be synced to disk");
+                ini.setComment("server", "audit_ring_bytes", "Audit buffer of each thread, in bytes; records that find it full are dropped");
+                ini.setComment("server", "capture_path", "File the requests served are captured to, for replay with mcp_replay (empty=no capture)");
+                ini.setComment("server", "capture_redact_fields", "JSON members whose values are blanked in captured requests, at any depth");
+                ini.setComment("server", "reuse_port", "Run one SO_REUSEPORT acceptor per IO thread instead of a single accept loop (1=enable, 0=disable)");
+                ini.setComment("server", "shared_nothing", "Serve shared-nothing: one acceptor and CPU per IO thread, per-thread request limits and tool lookups (1=enable, 0=disable)");
+                ini.setComment("server", "drain_timeout_ms", "On SIGTERM, longest time in milliseconds in-flight requests and open streams get to finish before the server stops");
+                ini.setComment("server", "drain_stream_spread_ms", "On SIGTERM, open streams are ended at random points over this many milliseconds, so their clients do not all reconnect at once");
+                ini.setComment("server", "hot_restart_socket", "Unix socket path a newly started server takes the listeners and sessions of this one over through (empty=disable)");
+                ini.setComment("server", "background_tool_loading", "Bind the listeners first and load plugins while they accept; stdio starts once the tools are in (1=enable, 0=disable)");
+                ini.setComment("server", "ready_path", "GET path answering 200 once the tools are registered and 503 before that or while draining, without authentication (empty=disable)");
+                ini.setComment("server", "startup_timeline", "Log how long each startup phase took once the server is ready (1=enable, 0=disable)");
+
+                // Add comments for transport section
+                ini.setComment("transport", "tcp_nodelay", "Disable Nagle's algorithm on accepted sockets (1=enable, 0=disable)");
+                ini.setComment("transport", "tcp_quickack", "Send ACKs immediately, Linux only (1=enable, 0=disable)");
+                ini.setComment("transport", "tcp_keepalive", "Enable TCP keep-alive probes (1=enable, 0=disable)");
+                ini.setComment("transport", "send_buffer_size", "SO_SNDBUF in bytes (0 = OS default)");
+                ini.setComment("transport", "receive_buffer_size", "SO_RCVBUF in bytes (0 = OS default)");
+                ini.setComment("transport", "listen_backlog", "Listen backlog (0 = SOMAXCONN)");
+                ini.setComment("transport", "tcp_fastopen", "TCP Fast Open queue length on listeners (0 = disabled)");
+                ini.setComment("transport", "tcp_congestion", "TCP congestion control of accepted sockets, Linux only, e.g. bbr for lossy long-haul links (empty = OS default)");
+                ini.setComment("transport", "tcp_notsent_lowat", "Unsent bytes a socket queues before it stops accepting writes, Linux and macOS (0 = OS default)");
+                ini.setComment("transport", "tcp_user_timeout_ms", "Close a connection whose sent data stays unacknowledged this long, Linux only (0 = OS default)");
+                ini.setComment("transport", "resource_stream_threshold", "Larger file resource reads are sent as chunked responses, in bytes (0 = never)");
+                ini.setComment("transport", "resource_stream_window", "File bytes encoded and sent per chunk of a streamed resource read");
+                ini.setComment("transport", "resource_read_max_uris", "Most resources one resources/read may list in 'uris'");
+                ini.setComment("transport", "resource_read_concurrency", "Resources of one bulk resources/read being read at a time");
+                ini.setComment("transport", "result_stream_threshold", "Larger tool results are sent as chunked responses while they are serialized, in bytes (0 = never)");
+                ini.setComment("transport", "result_stream_chunk", "Result bytes serialized and sent per chunk of a streamed tool result");
+                ini.setComment("transport", "upload_stream_threshold", "Larger tools/call bodies are read by plugins that stream an argument while they arrive, in bytes (0 = never)");
+                ini.setComment("transport", "upload_max_size", "Largest tools/call body streamed into a plugin, in bytes (0 = no limit); max_request_size limits the others");
+                ini.setComment("transport", "resource_notify_debounce_ms", "Updates of a subscribed resource within this window are sent as one notification, in milliseconds");
+                ini.setComment("transport", "resource_watch_files", "Watch subscribed file resources for changes, inotify on Linux (1=enable, 0=disable)");
+
+                // Add comments for concurrency section
+                ini.setComment("concurrency", "tool_threads", "Threads that run tool calls off the IO threads (0 = one per CPU)");
+                ini.setComment("concurrency", "tool_threads_max", "Tool threads the pool may grow to while its threads block on I/O (0 = fixed at tool_threads)");
+                ini.setComment("concurrency", "tool_blocked_cpu_percent", "Busy tool threads using less of their time on the CPU than this count as blocked");
+                ini.setComment("concurrency", "max_in_flight", "Tool calls running at once across all tools (0 = unlimited)");
+                ini.setComment("concurrency", "tool_limits", "Per-tool in-flight limits, e.g. safe_system_plugin=2,search=8");
+                ini.setComment("concurrency", "queue_size", "Tool calls waiting per limit before new ones get 503");
+                ini.setComment("concurrency", "queue_timeout_ms", "Longest time a tool call waits for a slot before it gets 503");
+                ini.setComment("concurrency", "overload_lag_ms", "Answer new JSON-RPC requests 503 while the smoothed lag of their IO thread is above this many milliseconds (0=never shed)");
+                ini.setComment("concurrency", "overload_retry_after_s", "Retry-After in seconds of the 503 sent while shedding");
+                ini.setComment("concurrency", "control_threads", "Tool threads reserved for control-plane requests (0 = they share the tool pool)");
+                ini.setComment("concurrency", "control_plane_methods", "JSON-RPC methods that skip load shedding and admission queues");
+                ini.setComment("concurrency", "control_plane_tools", "Tools whose calls are control plane too and run on the reserved threads, e.g. health");
+                ini.setComment("concurrency", "stream_pump_threads", "Threads that pull from blocking stream generators off the IO threads (0 = one per CPU)");
+                ini.setComment("concurrency", "stream_pump_queue", "Events buffered per stream before a blocking generator is paused");
+                ini.setComment("concurrency", "max_batch_size", "Requests per JSON-RPC batch, larger batches are rejected (0 = unlimited)");
+                ini.setComment("concurrency", "batch_deadline_ms", "Batch entries still running after this get a timeout error (0 = no deadline)");
+                ini.setComment("concurrency", "tool_timeout_ms", "Synchronous tool calls still running after this get a timeout error, in milliseconds (0 = no deadline)");
+                ini.setComment("concurrency", "tool_timeouts", "Per-tool deadlines in milliseconds, override tool_timeout_ms, e.g. http_get=10000,search=30000");
+                ini.setComment("concurrency", "progress_max_per_second", "notifications/progress sent per tool call and second at most, further reports are coalesced (0 = no progress)");
+                ini.setComment("concurrency", "tool_batch_window_us", "Calls of a tool whose plugin exports call_tools_batch are collected this long and run as one batch, in microseconds (0 = no batching)");
+                ini.setComment("concurrency", "tool_batch_max", "Calls per plugin batch at most, a full batch runs at once");
+                ini.setComment("concurrency", "fair_scheduling", "Share the tool pool fairly between clients: off, session or api_key (by X-API-Key)");
+                ini.setComment("concurrency", "fair_weights", "Calls per round for weighted sessions, API keys or named tenants, 1 for the rest, e.g. ide-key=4,batch-key=1");
+                ini.setComment("concurrency", "fair_slots", "Tool calls on the pool at once while fair scheduling is on (0 = one per tool thread)");
+                ini.setComment("concurrency", "tenants", "Named tenants, each a group of API keys or bearer tokens sharing weights and limits, e.g. batch=key-1|key-2,ide=key-3");
+                ini.setComment("concurrency", "tenant_tool_slots", "Tool calls a named tenant may have on the pool at once while fair scheduling is on, e.g. batch=2 (no cap for tenants not listed)");
+
+                // Add comments for cluster section
+                ini.setComment("cluster", "enabled", "Share sessions between replicas, requests for a session another node owns are forwarded there (1=enable, 0=disable)");
+                ini.setComment("cluster", "node_id", "Name of this node, unique in the cluster (empty = random)");
+                ini.setComment("cluster", "bind", "UDP address gossip is received on");
+                ini.setComment("cluster", "advertise", "host:port of the HTTP listener other nodes forward to (empty = this host and http_port)");
+                ini.setComment("cluster", "seeds", "Gossip addresses of nodes to join through, e.g. 10.0.0.2:7946,10.0.0.3:7946");
+                ini.setComment("cluster", "secret", "Key gossip is signed with (HMAC-SHA256), the same on every node (empty = unsigned)");
+                ini.setComment("cluster", "gossip_interval_ms", "Time between gossip rounds in milliseconds");
+                ini.setComment("cluster", "suspect_after_ms", "A node silent this long leaves the ring, in milliseconds");
+                ini.setComment("cluster", "virtual_nodes", "Points per node on the consistent-hash ring");
+                ini.setComment("cluster", "forward_timeout_ms", "Longest wait for the owning node to answer a forwarded request, in milliseconds");
+
+                // Add comments for federation section
+                ini.setComment("federation", "upstreams", "Upstream MCP servers whose tools are served here, e.g. search=http://10.0.0.5:8080/mcp|http://10.0.0.6:8080/mcp,docs=http://10.0.0.7:9000/mcp");
+                ini.setComment("federation", "prefix_tools", "Publish upstream tools as <upstream>_<tool> (1=enable, 0=disable)");
+                ini.setComment("federation", "token", "Bearer token sent to the upstreams (empty = none)");
+                ini.setComment("federation", "max_idle_connections", "Kept-alive connections per upstream replica");
+                ini.setComment("federation", "call_timeout_ms", "Longest a forwarded tool call may take, in milliseconds");
+                ini.setComment("federation", "health_interval_ms", "Time between pings of each upstream replica, in milliseconds");
+                ini.setComment("federation", "refresh_interval_s", "Time between tools/list of each upstream, in seconds");
+
+                // Add comments for cache section
+                ini.setComment("cache", "max_sessions", "Stream sessions kept for reconnects");
+                ini.setComment("cache", "max_events_per_session", "Events kept per session for replay on reconnect");
+                ini.setComment("cache", "ttl_s", "Seconds a session is kept after its last event");
+                ini.setComment("cache", "max_bytes", "Memory budget of all cached sessions in bytes (0 = unlimited)");
+                ini.setComment("cache", "shards", "Lock stripes of the cache (0 = derived from the CPU count)");
+                ini.setComment("cache", "tool_ttls", "Per-tool TTL overrides in seconds, e.g. search=300,read_file=3600 (0 = not kept)");
+                ini.setComment("cache", "result_cache_tools", "Idempotent tools whose results are memoized, with their TTL in seconds, e.g. read_file=60,http_get=300");
+                ini.setComment("cache", "result_cache_max_bytes", "Memory budget of memoized tool results in bytes");
+                ini.setComment("cache", "result_cache_max_result_bytes", "Tool results larger than this many bytes are not memoized");
+                ini.setComment("cache", "idempotency_ttl_s", "Seconds the result of a tools/call with an Idempotency-Key answers its retries (0 = only calls in flight are joined)");
+                ini.setComment("cache", "idempotency_max_bytes", "Memory budget of results kept for idempotency keys in bytes");
+                ini.setComment("cache", "resource_cache_ttl_s", "Seconds resources/read contents are reused (0 = only shared by concurrent reads)");
+                ini.setComment("cache", "resource_cache_max_bytes", "Memory budget of cached resource contents in bytes");
+                ini.setComment("cache", "prompt_cache_max_bytes", "Memory budget of memoized prompts/get results in bytes (0 = render every time)");
+                ini.setComment("cache", "persistence", "Keep reconnect sessions across restarts: none or segment (append-only log files)");
+                ini.setComment("cache", "persistence_dir", "Directory of the cache segment files");
+                ini.setComment("cache", "persistence_flush_ms", "Longest time a cache write waits before it is written to disk");
+                ini.setComment("cache", "stream_state_commit", "When a running stream's last event and checkpoint are saved: batch (every batch), interval or end (when it stops)");
+                ini.setComment("cache", "stream_state_commit_interval_ms", "Longest time between state saves of a running stream with stream_state_commit=interval");
 
                 // Add comments for plugin_hub section
                 ini.setComment("plugin_hub", "plugin_server_baseurl", "Base URL for plugin server");
@@ -424,11 +1519,21 @@ namespace mcp {
                 ini.setComment("plugin_hub", "download_route", "Route for downloading plugin");
                 ini.setComment("plugin_hub", "plugin_install_dir", "Directory for installing plugins");
                 ini.setComment("plugin_hub", "plugin_enable_dir", "Directory for enabling plugins");
+                ini.setComment("plugin_hub", "plugin_cache_dir", "Downloaded archives by SHA-256, may be shared by several nodes");
+                ini.setComment("plugin_hub", "download_jobs", "Plugins downloaded and extracted at once by a multi-plugin install");
 
                 // Add coments for PythonEnvConfig
                 ini.setComment("PythonEnvConfig", "default_env", "Default environment interpreter to use for Python plugins");
                 ini.setComment("PythonEnvConfig", "conda_prefix", "Path to conda prefix");
                 ini.setComment("PythonEnvConfig", "uv_venv_path", "Path to uv_venv");
+                ini.setComment("PythonEnvConfig", "interpreters", "Sub-interpreters per Python plugin, each with its own GIL (0 = all plugins share the main interpreter, needs Python 3.12+)");
+                ini.setComment("PythonEnvConfig", "workers", "Worker processes per Python plugin, tool calls run out of process (0 = in process, Linux only)");
+                ini.setComment("PythonEnvConfig", "worker_executable", "Python interpreter the worker processes are started with");
+                ini.setComment("PythonEnvConfig", "worker_buffer_kb", "Shared memory of each worker for a request and for a response, larger ones are passed in chunks");
+                ini.setComment("PythonEnvConfig", "worker_max_calls", "Replace a worker after this many calls (0 = never)");
+                ini.setComment("PythonEnvConfig", "worker_max_rss_mb", "Replace a worker once its peak RSS reaches this many MiB (0 = never)");
+                ini.setComment("PythonEnvConfig", "bytecode_cache_dir", "Directory Python plugins are precompiled into and all bytecode is cached in (empty = next to the sources)");
+                ini.setComment("PythonEnvConfig", "preload_modules", "Comma separated modules imported in the background once the server listens, e.g. numpy,requests");
 
 
                 // Root section configuration
@@ -453,8 +1558,52 @@ namespace mcp {
             MCP_DEBUG("HTTPS Port: {}", config.server.https_port);
             MCP_DEBUG("Log Level: {}", config.server.log_level);
             MCP_DEBUG("Plugin Dir: {}", config.server.plugin_dir);
+            MCP_DEBUG("Plugin Lazy Load: {} (idle unload: {}s)", config.server.plugin_lazy_load, config.server.plugin_idle_unload_s);
+            MCP_DEBUG("Plugin Isolation: '{}' ({} channels, {} KiB)", config.server.plugin_isolation, config.server.plugin_host_channels, config.server.plugin_host_buffer_kb);
+            MCP_DEBUG("Plugin Quotas: {} ms CPU, {} MiB per {}s, then {}", config.server.plugin_cpu_quota_ms, config.server.plugin_alloc_quota_mb,
+                      config.server.plugin_quota_window_s, config.server.plugin_quota_action);
+            MCP_DEBUG("List Page Size: {}", config.server.list_page_size);
+            MCP_DEBUG("Tools List Delta: {} (up to {} tools)", config.server.tools_list_delta, config.server.tools_list_delta_max);
+            MCP_DEBUG("Unix Socket Memfd Min Size: {}", config.server.unix_memfd_min_size);
+            MCP_DEBUG("Reuse Port: {}, Shared Nothing: {}", config.server.reuse_port, config.server.shared_nothing);
+            MCP_DEBUG("Traffic Capture: '{}' (redacting {})", config.server.capture_path, config.server.capture_redact_fields);
+            MCP_DEBUG("Validate Passthrough Results: {}", config.server.validate_passthrough_results);
+            MCP_DEBUG("Validate Tool Arguments: {}", config.server.validate_tool_arguments);
+            MCP_DEBUG("Stream Batch: {} events / {}us", config.server.stream_batch_max_items, config.server.stream_batch_max_delay_us);
+            MCP_DEBUG("Stream Queue: {}/{} bytes, policy: {}", config.server.stream_queue_high_watermark, config.server.stream_queue_low_watermark, config.server.stream_slow_consumer_policy);
             MCP_DEBUG("Auth Enabled: {}", config.server.enable_auth ? "Yes" : "No");
+            MCP_DEBUG("JWT: issuer '{}', audience '{}', JWKS '{}' (refresh {}s, leeway {}s, cache {})", config.server.jwt_issuer, config.server.jwt_audience, config.server.jwt_jwks_url, config.server.jwt_refresh_s, config.server.jwt_leeway_s, config.server.jwt_cache_size);
             MCP_DEBUG("Max Requests/sec: {}", config.server.max_requests_per_second);
+            MCP_DEBUG("Tenant Requests/sec: {} (burst {})", config.server.tenant_requests_per_second, config.server.tenant_rate_limit_burst);
+            MCP_DEBUG("Named Tenant Requests/sec: {}", config.server.tenant_rate_limits);
+            MCP_DEBUG("IO Threads: {} (HTTPS: {})", config.server.io_threads, config.server.https_io_threads);
+            MCP_DEBUG("IO Busy Poll: {}us", config.server.io_busy_poll_us);
+            MCP_DEBUG("Admin Config Endpoint: {}", config.server.admin_token.empty() ? "No" : "Yes");
+            MCP_DEBUG("Pool Pages: huge {}, NUMA {}", config.server.pool_huge_pages, config.server.pool_numa ? "on" : "off");
+            MCP_DEBUG("Tool Threads: {} (up to {} while blocked)", config.concurrency.tool_threads, config.concurrency.tool_threads_max);
+            MCP_DEBUG("Stream Pump Threads: {} (queue: {})", config.concurrency.stream_pump_threads, config.concurrency.stream_pump_queue);
+            MCP_DEBUG("Batches: {} requests, deadline {}ms", config.concurrency.max_batch_size, config.concurrency.batch_deadline_ms);
+            MCP_DEBUG("Plugin Batches: {} calls, window {}us", config.concurrency.tool_batch_max, config.concurrency.tool_batch_window_us);
+            MCP_DEBUG("Fair Scheduling: {} ({} slots)", config.concurrency.fair_scheduling, config.concurrency.fair_slots);
+            MCP_DEBUG("Tenant Tool Slots: {}", config.concurrency.tenant_tool_slots);
+            MCP_DEBUG("Audit Log: '{}' ({} byte segments, sync every {}ms)", config.server.audit_log_dir, config.server.audit_segment_bytes, config.server.audit_sync_interval_ms);
+            MCP_DEBUG("Metrics Push: StatsD '{}', OTLP '{}', every {}ms", config.server.metrics_statsd_endpoint, config.server.metrics_otlp_endpoint, config.server.metrics_push_interval_ms);
+            MCP_DEBUG("Cache: {} sessions x {} events, {} bytes, ttl {}s", config.cache.max_sessions, config.cache.max_events_per_session, config.cache.max_bytes, config.cache.ttl_s);
+            MCP_DEBUG("Tool Result Cache: {} ({} bytes)", config.cache.result_cache_tools, config.cache.result_cache_max_bytes);
+            MCP_DEBUG("Idempotency Keys: {}s ({} bytes)", config.cache.idempotency_ttl_s, config.cache.idempotency_max_bytes);
+            MCP_DEBUG("Resource Cache: {}s ({} bytes)", config.cache.resource_cache_ttl_s, config.cache.resource_cache_max_bytes);
+            MCP_DEBUG("Prompt Cache: {} bytes", config.cache.prompt_cache_max_bytes);
+            MCP_DEBUG("Cache Persistence: {} ({})", config.cache.persistence, config.cache.persistence_dir);
+            MCP_DEBUG("TCP_NODELAY: {}", config.transport.tcp_nodelay ? "Yes" : "No");
+            MCP_DEBUG("TCP Congestion Control: {}", config.transport.tcp_congestion.empty() ? "default" : config.transport.tcp_congestion);
+            MCP_DEBUG("TCP Lossy Links: notsent_lowat {} bytes, user timeout {}ms", config.transport.tcp_notsent_lowat, config.transport.tcp_user_timeout_ms);
+            MCP_DEBUG("Resource Streaming: above {} bytes, {} bytes per chunk", config.transport.resource_stream_threshold, config.transport.resource_stream_window);
+            MCP_DEBUG("Bulk Resource Reads: up to {} URIs, {} at a time", config.transport.resource_read_max_uris, config.transport.resource_read_concurrency);
+            MCP_DEBUG("Result Streaming: above {} bytes, {} bytes per chunk", config.transport.result_stream_threshold, config.transport.result_stream_chunk);
+            MCP_DEBUG("Upload Streaming: above {} bytes, at most {} bytes", config.transport.upload_stream_threshold, config.transport.upload_max_size);
+            MCP_DEBUG("Resource Updates: {}ms debounce, file watching: {}", config.transport.resource_notify_debounce_ms, config.transport.resource_watch_files ? "Yes" : "No");
+            MCP_DEBUG("Cluster: {} (node {}, gossip on {})", config.cluster.enabled ? "Yes" : "No", config.cluster.node_id, config.cluster.bind);
+            MCP_DEBUG("Federation: {}", config.federation.upstreams.empty() ? "No" : config.federation.upstreams);
             MCP_DEBUG("Plugin Server: {}:{}", config.plugin_hub.plugin_server_baseurl, config.plugin_hub.plugin_server_port);
             MCP_DEBUG("Python Env: {}", config.python_env.default_env);
             MCP_DEBUG("=============================");
@@ -486,17 +1635,33 @@ namespace mcp {
             g_config_loader = std::make_unique<DefaultConfigLoader>();
             {
                 std::lock_guard<std::mutex> lock(g_config_mutex);
-                g_current_config = g_config_loader->load(mode);
+                auto config = g_config_loader->load(mode);
+                if (!g_current_config.load()) {
+                    publish_config(std::move(config));// A reload may already have published a newer one
+                }
             }
             g_config_initialized = true;
         }
 
         /**
- * Get current config (thread-safe)
+ * Get the current config snapshot (lock-free); it never changes, a reload publishes a new one
+ */
+        inline std::shared_ptr<const GlobalConfig> current_config() {
+            return g_current_config.load(std::memory_order_acquire);
+        }
+
+        /**
+ * Number of configs published so far, for callers that cache values derived from one
+ */
+        inline uint64_t config_version() {
+            return g_config_version.load(std::memory_order_acquire);
+        }
+
+        /**
+ * Get a copy of the current config (thread-safe)
  */
         inline GlobalConfig get_current_config() {
-            std::lock_guard<std::mutex> lock(g_config_mutex);
-            return *g_current_config;
+            return *current_config();
         }
 
         /**
@@ -504,7 +1669,20 @@ namespace mcp {
  */
         inline void update_current_config(const GlobalConfig &newConfig) {
             std::lock_guard<std::mutex> lock(g_config_mutex);
-            *g_current_config = newConfig;
+            publish_config(std::make_shared<const GlobalConfig>(newConfig));
+        }
+
+        /**
+ * Apply settings changed while the server runs (the admin endpoint): publish them and notify the
+ * observers like a reload. The file is not rewritten, in DYNAMIC mode its next change wins.
+ */
+        inline void apply_runtime_config(GlobalConfig config) {
+            auto published = std::make_shared<const GlobalConfig>(std::move(config));
+            if (g_config_loader) {
+                g_config_loader->publish(std::move(published));
+            } else {
+                update_current_config(*published);
+            }
         }
 
     }// namespace config
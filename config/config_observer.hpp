@@ -1,4 +1,6 @@
 #pragma once
+#include <functional>
+#include <utility>
 
 namespace mcp {
     namespace config {
@@ -8,5 +10,39 @@ namespace mcp {
             virtual ~ConfigObserver() = default;
             virtual void onConfigReloaded(const mcp::config::GlobalConfig &newConfig) = 0;
         };
+
+        /**
+         * @brief Observer of one part of the config: apply runs only when a reload changes what
+         *        select takes from it, so components are not reconfigured for unrelated edits.
+         * @tparam Part Value taken from the config, compared with operator==
+         */
+        template<typename Part>
+        class ConfigSubscription : public ConfigObserver {
+        public:
+            using Select = std::function<Part(const GlobalConfig &)>;
+            using Apply = std::function<void(const Part &)>;
+
+            /**
+             * @param current Config the component was set up from
+             * @param select Takes the part from a config
+             * @param apply Pushes a changed part to the component
+             */
+            ConfigSubscription(const GlobalConfig &current, Select select, Apply apply)
+                : select_(std::move(select)), apply_(std::move(apply)), last_(select_(current)) {}
+
+            void onConfigReloaded(const GlobalConfig &newConfig) override {
+                Part part = select_(newConfig);
+                if (part == last_) {
+                    return;
+                }
+                apply_(part);
+                last_ = std::move(part);
+            }
+
+        private:
+            Select select_;
+            Apply apply_;
+            Part last_;
+        };
     }// namespace config
-}// namespace mcp
\ No newline at end of file
+}// namespace mcp
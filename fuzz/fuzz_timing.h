@@ -0,0 +1,56 @@
+// fuzz/fuzz_timing.h
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+namespace mcp::fuzz {
+
+    /**
+     * @brief Times each fuzz input and aborts when parsing it took superlinear time.
+     *
+     * An input may take MCP_FUZZ_FIXED_US microseconds plus MCP_FUZZ_NS_PER_BYTE nanoseconds per
+     * byte (defaults 20000 and 2000, room enough for sanitizer builds). A slower input aborts the
+     * run, so libFuzzer saves it as a crash input the way it does for a crash. The slowest input per
+     * byte seen so far is printed, which shows how close the parser comes to the budget.
+     */
+    class ParseTimer {
+    public:
+        explicit ParseTimer(size_t size) : size_(size), start_(std::chrono::steady_clock::now()) {}
+
+        ~ParseTimer() {
+            static const double fixed_ns = budget("MCP_FUZZ_FIXED_US", 20000) * 1000.0;
+            static const double per_byte_ns = budget("MCP_FUZZ_NS_PER_BYTE", 2000);
+            static double worst_per_byte = 0;
+
+            double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_).count();
+            if (elapsed > fixed_ns + per_byte_ns * static_cast<double>(size_)) {
+                std::fprintf(stderr, "Parsing %zu bytes took %.0f us, above the budget of %.0f us\n", size_, elapsed / 1000.0,
+                             (fixed_ns + per_byte_ns * static_cast<double>(size_)) / 1000.0);
+                std::abort();
+            }
+            // Small inputs are dominated by fixed costs and timer noise
+            if (size_ >= kMinReportedSize && elapsed / static_cast<double>(size_) > worst_per_byte) {
+                worst_per_byte = elapsed / static_cast<double>(size_);
+                std::fprintf(stderr, "Slowest input so far: %.1f ns per byte over %zu bytes\n", worst_per_byte, size_);
+            }
+        }
+
+        ParseTimer(const ParseTimer &) = delete;
+        ParseTimer &operator=(const ParseTimer &) = delete;
+
+    private:
+        static constexpr size_t kMinReportedSize = 1024;
+
+        static double budget(const char *name, double fallback) {
+            const char *value = std::getenv(name);
+            return value ? std::atof(value) : fallback;
+        }
+
+        size_t size_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+}// namespace mcp::fuzz
@@ -0,0 +1,59 @@
+// fuzz/http_framer_fuzzer.cc
+// Feeds the input to HttpRequestFramer in reads of varying size, as a connection would, and
+// parses it once more in one piece with the read-only parser.
+#include "fuzz_timing.h"
+#include "transport/http_framer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+using namespace mcp::transport;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    mcp::fuzz::ParseTimer timer(size);
+
+    // The first byte picks the read size, from single bytes to whole segments
+    const size_t read_size = static_cast<size_t>(data[0]) * 16 + 1;
+    const char *input = reinterpret_cast<const char *>(data + 1);
+    const size_t input_size = size - 1;
+
+    HttpRequestFramer framer;
+    size_t fed = 0;
+    size_t framed = 0;
+    bool failed = false;
+    while (fed < input_size && !failed) {
+        auto buffer = framer.prepare();
+        size_t n = std::min({read_size, input_size - fed, buffer.size()});
+        std::memcpy(buffer.data(), input + fed, n);
+        framer.commit(n);
+        fed += n;
+
+        for (;;) {
+            auto status = framer.next();
+            if (status == HttpRequestParser::Status::Error) {
+                failed = true;
+                break;
+            }
+            if (status == HttpRequestParser::Status::Incomplete) {
+                break;
+            }
+            const auto &request = framer.request();
+            framed += framer.request_size();
+            // A request cannot span more than was received, nor a body more than its request
+            if (framed > fed || request.body.size() > framer.request_size()) {
+                std::abort();
+            }
+            (void) request.get_header("content-length");
+            framer.consume();
+        }
+    }
+
+    HttpRequestParser parser;
+    (void) parser.parse(std::string_view(input, input_size));
+    return 0;
+}
@@ -0,0 +1,39 @@
+// fuzz/json_rpc_fuzzer.cc
+// Runs a message through the JSON-RPC entry points of the transports: the batch split, the
+// envelope scan and the full parse, then answers a request that parsed.
+#include "fuzz_timing.h"
+#include "protocol/json_rpc.h"
+#include <cstdint>
+#include <string_view>
+
+using namespace mcp::protocol;
+
+namespace {
+    void handle(std::string_view message) {
+        if (auto envelope = scan_request_envelope(message)) {
+            (void) find_member(envelope->params, "name");
+        }
+        auto [request, error] = parse_request(message);
+        if (request) {
+            Response response;
+            response.id = request->id.value_or(nullptr);
+            response.result = request->params;
+            (void) make_response(response);
+        } else if (error) {
+            (void) make_error(*error);
+        }
+    }
+}// namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    mcp::fuzz::ParseTimer timer(size);
+    std::string_view message(reinterpret_cast<const char *>(data), size);
+    if (auto batch = scan_batch(message)) {
+        for (auto entry: *batch) {
+            handle(entry);
+        }
+    } else {
+        handle(message);
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+// fuzz/replay_main.cc
+// Entry point for compilers without libFuzzer: runs the fuzz target once on every file given,
+// or on every file of every directory given, e.g. the seed corpus and saved crash inputs.
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+namespace {
+    void run_file(const std::filesystem::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+}// namespace
+
+int main(int argc, char **argv) {
+    size_t inputs = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] == '-') {
+            continue;// libFuzzer flags such as -runs=0, so both builds take the same command line
+        }
+        std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path)) {
+            for (const auto &entry: std::filesystem::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file()) {
+                    run_file(entry.path());
+                    ++inputs;
+                }
+            }
+        } else {
+            run_file(path);
+            ++inputs;
+        }
+    }
+    std::printf("Ran %zu inputs\n", inputs);
+    return 0;
+}
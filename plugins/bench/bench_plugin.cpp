@@ -0,0 +1,353 @@
+// plugins/bench/bench_plugin.cpp
+// Tools of known, configurable cost for measuring the server's own overhead with mcp_bench.
+// Results are written as complete tools/call results (MCP_OUTPUT_PASSTHROUGH), so the plugin side
+// of a call costs next to nothing beyond what its arguments ask for.
+#include "core/mcpserver_api.h"
+#include "mcp_plugin.h"
+#include "mcp_tools.h"
+#include "protocol/json_rpc.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+// Paced streams wait on a timerfd instead of sleeping in next()
+#define BENCH_STREAM_NONBLOCKING 1
+#endif
+
+// Compiled in, so loading the plugin reads no file and measurements start from the same state everywhere
+constinit static ToolInfo g_tools[] = {
+        mcp::sdk::tool("bench_noop", "Returns an empty text right away, for measuring the cost of a call itself",
+                       R"json({"type": "object", "properties": {}, "required": []})json"),
+        mcp::sdk::tool("bench_payload", "Returns a text of the given number of bytes",
+                       R"json({"type": "object",
+                           "properties": {"bytes": {"type": "integer", "description": "Size of the text (default 1024)",
+                                                    "minimum": 0, "maximum": 67108864}},
+                           "required": []})json"),
+        mcp::sdk::tool("bench_spin", "Keeps a CPU busy for the given number of microseconds, then returns an empty text",
+                       R"json({"type": "object",
+                           "properties": {"us": {"type": "integer", "description": "Busy time in microseconds (default 100)",
+                                                 "minimum": 0, "maximum": 10000000}},
+                           "required": []})json"),
+        mcp::sdk::tool("bench_sleep", "Sleeps for the given number of milliseconds, then returns an empty text",
+                       R"json({"type": "object",
+                           "properties": {"ms": {"type": "integer", "description": "Sleep time in milliseconds (default 10)",
+                                                 "minimum": 0, "maximum": 600000}},
+                           "required": []})json"),
+        mcp::sdk::streaming_tool("bench_stream",
+                                 "Streams count events of size bytes each, rate events per second or as fast as possible if rate is 0",
+                                 R"json({"type": "object",
+                                     "properties": {
+                                       "count": {"type": "integer", "description": "Number of events (default 100)",
+                                                 "minimum": 0, "maximum": 10000000},
+                                       "size": {"type": "integer", "description": "Filler bytes per event (default 64)",
+                                                "minimum": 0, "maximum": 67108864},
+                                       "rate": {"type": "integer", "description": "Events per second, 0 for no pacing (default 0)",
+                                                "minimum": 0, "maximum": 1000000}},
+                                     "required": []})json"),
+};
+
+// Keeps a mistyped argument from tying up a pool thread or the memory of the server
+static constexpr uint64_t kMaxBytes = 64 * 1024 * 1024;
+static constexpr uint64_t kMaxSpinMicros = 10 * 1000 * 1000;
+static constexpr uint64_t kMaxSleepMillis = 10 * 60 * 1000;
+static constexpr uint64_t kMaxEvents = 10 * 1000 * 1000;
+
+static constexpr std::string_view kTextPrefix = R"({"content":[{"type":"text","text":")";
+static constexpr std::string_view kTextSuffix = R"("}]})";
+
+static uint64_t get_count(const nlohmann::json &args, const char *key, uint64_t fallback, uint64_t limit) {
+    auto it = args.find(key);
+    if (it == args.end() || !it->is_number()) {
+        return fallback;
+    }
+    double value = it->get<double>();
+    return value <= 0 ? 0 : std::min(static_cast<uint64_t>(value), limit);
+}
+
+/**
+ * @brief Append a text result of size bytes of filler to the output.
+ */
+static bool write_text(MCPOutput *output, uint64_t size) {
+    char *data = output->reserve(output->context, kTextPrefix.size() + size + kTextSuffix.size());
+    if (!data) {
+        return false;
+    }
+    std::memcpy(data, kTextPrefix.data(), kTextPrefix.size());
+    std::memset(data + kTextPrefix.size(), 'x', size);
+    std::memcpy(data + kTextPrefix.size() + size, kTextSuffix.data(), kTextSuffix.size());
+    output->commit(output->context, kTextPrefix.size() + size + kTextSuffix.size());
+    output->flags |= MCP_OUTPUT_PASSTHROUGH;
+    return true;
+}
+
+// Busy-wait so the call costs CPU time on the tool pool thread, not just wall time
+static bool spin_cancellable(std::chrono::microseconds duration, const MCPCancelToken *cancel) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    uint32_t rounds = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        if ((++rounds & 1023) == 0 && cancel->is_cancelled(cancel->context)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sleep in slices so a cancelled call returns within a millisecond
+static bool sleep_cancellable(std::chrono::milliseconds duration, const MCPCancelToken *cancel) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    for (auto now = std::chrono::steady_clock::now(); now < end; now = std::chrono::steady_clock::now()) {
+        if (cancel->is_cancelled(cancel->context)) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(end - now, std::chrono::milliseconds(1)));
+    }
+    return true;
+}
+
+/**
+ * Generator state of bench_stream
+ *
+ * Emits count events of size bytes of filler, rate events per second or as fast as the server
+ * asks for them if rate is 0.
+ */
+struct BenchStream {
+    uint64_t count = 0;
+    uint64_t sent = 0;
+    std::string filler;
+    std::chrono::steady_clock::duration interval{};
+    std::chrono::steady_clock::time_point next_due;
+    std::atomic<bool> running{true};
+    int timer_fd = -1;// Armed for the next event by bench_stream_wait
+
+    ~BenchStream() {
+#if defined(BENCH_STREAM_NONBLOCKING)
+        if (timer_fd >= 0) {
+            close(timer_fd);
+        }
+#endif
+    }
+};
+
+/**
+ * @brief Produce the next event
+ * @return 0 with an event, 1 at the end, MCP_STREAM_WOULD_BLOCK before the next event is due
+ */
+static int bench_stream_next(StreamGenerator generator, const char **result_json, MCPError * /*error*/) {
+    auto *stream = static_cast<BenchStream *>(generator);
+    *result_json = nullptr;
+    if (!stream || !stream->running || stream->sent >= stream->count) {
+        return 1;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (stream->interval.count() > 0 && now < stream->next_due) {
+#if defined(BENCH_STREAM_NONBLOCKING)
+        return MCP_STREAM_WOULD_BLOCK;
+#else
+        std::this_thread::sleep_until(stream->next_due);
+#endif
+    }
+    // Due times advance by the interval, so a late event does not push back the ones after it
+    stream->next_due += stream->interval;
+
+    static thread_local std::string buffer;
+    buffer.assign(R"({"result":{"seq":)");
+    buffer += std::to_string(stream->sent++);
+    buffer += R"(,"data":")";
+    buffer += stream->filler;
+    buffer += "\"}}";
+    *result_json = buffer.c_str();
+    return 0;
+}
+
+#if defined(BENCH_STREAM_NONBLOCKING)
+/**
+ * @brief Tells the server when the next event is due
+ * @return Timer descriptor that becomes readable when the event is due, -1 to be polled
+ */
+static int bench_stream_wait(StreamGenerator generator, MCPStreamWakeup /*wakeup*/, void * /*context*/) {
+    auto *stream = static_cast<BenchStream *>(generator);
+    if (stream->timer_fd < 0) {
+        stream->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (stream->timer_fd < 0) {
+            return -1;
+        }
+    }
+
+    auto remaining = std::max<std::chrono::nanoseconds::rep>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stream->next_due - std::chrono::steady_clock::now()).count(), 1);
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(remaining / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(remaining % 1000000000);
+    if (timerfd_settime(stream->timer_fd, 0, &spec, nullptr) != 0) {
+        return -1;
+    }
+    return stream->timer_fd;
+}
+#endif
+
+static void bench_stream_cancel(StreamGenerator generator) {
+    if (generator) {
+        static_cast<BenchStream *>(generator)->running = false;
+    }
+}
+
+static void bench_stream_free(StreamGenerator generator) {
+    delete static_cast<BenchStream *>(generator);
+}
+
+extern "C" MCP_API ToolInfo *get_tools(int *count) {
+    return mcp::sdk::tool_list(g_tools, count);
+}
+
+extern "C" MCP_API int mcp_plugin_abi_version() {
+    return MCP_PLUGIN_ABI_VERSION;
+}
+
+/**
+ * @brief Run one of the synchronous tools
+ *
+ * bench_noop returns an empty text, bench_payload {"bytes"} bytes of text, bench_spin busy-waits
+ * {"us"} microseconds and bench_sleep sleeps {"ms"} milliseconds.
+ */
+extern "C" MCP_API int call_tool_cancellable(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error,
+                                             const MCPCancelToken *cancel) {
+    try {
+        std::string_view tool = name;
+        nlohmann::json args = args_json.size == 0 ? nlohmann::json::object()
+                                                  : nlohmann::json::parse(args_json.data, args_json.data + args_json.size);
+        uint64_t size = 0;
+        if (tool == "bench_payload") {
+            size = get_count(args, "bytes", 1024, kMaxBytes);
+        } else if (tool == "bench_spin") {
+            if (!spin_cancellable(std::chrono::microseconds(get_count(args, "us", 100, kMaxSpinMicros)), cancel)) {
+                error->code = mcp::protocol::error_code::REQUEST_CANCELLED;
+                error->message = "Request cancelled";
+                return 1;
+            }
+        } else if (tool == "bench_sleep") {
+            if (!sleep_cancellable(std::chrono::milliseconds(get_count(args, "ms", 10, kMaxSleepMillis)), cancel)) {
+                error->code = mcp::protocol::error_code::REQUEST_CANCELLED;
+                error->message = "Request cancelled";
+                return 1;
+            }
+        } else if (tool != "bench_noop") {
+            error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
+            error->message = "Unknown tool";
+            return 1;
+        }
+
+        if (!write_text(output, size)) {
+            error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+            error->message = "Out of memory writing result";
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception &) {
+        error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+        error->message = "Invalid arguments";
+        return 1;
+    }
+}
+
+/**
+ * @brief Run a batch of synchronous calls
+ *
+ * Stands in for a backend that answers many queries in one round trip: the bench_sleep calls of a
+ * batch share one sleep, as long as the longest of them, and the other tools run one by one.
+ */
+extern "C" MCP_API void call_tools_batch(const char *name, MCPBatchCall *calls, size_t count) {
+    static const MCPCancelToken kNever = {nullptr, [](void *) { return false; }};
+    if (std::string_view(name) != "bench_sleep") {
+        for (size_t i = 0; i < count; ++i) {
+            calls[i].status = call_tool_cancellable(name, calls[i].args_json, calls[i].output, &calls[i].error, &kNever);
+        }
+        return;
+    }
+
+    uint64_t longest = 0;
+    for (size_t i = 0; i < count; ++i) {
+        try {
+            const MCPBuffer &args_json = calls[i].args_json;
+            nlohmann::json args = args_json.size == 0 ? nlohmann::json::object()
+                                                      : nlohmann::json::parse(args_json.data, args_json.data + args_json.size);
+            longest = std::max(longest, get_count(args, "ms", 10, kMaxSleepMillis));
+            calls[i].status = 0;
+        } catch (const std::exception &) {
+            calls[i].error.code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            calls[i].error.message = "Invalid arguments";
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(longest));
+    for (size_t i = 0; i < count; ++i) {
+        if (calls[i].status == 0 && !write_text(calls[i].output, 0)) {
+            calls[i].status = 1;
+            calls[i].error.code = mcp::protocol::error_code::INTERNAL_ERROR;
+            calls[i].error.message = "Out of memory writing result";
+        }
+    }
+}
+
+/**
+ * @brief Start bench_stream: {"count", "size", "rate"}
+ *
+ * Synchronous tools go through call_tool_cancellable; this entry point only starts streams.
+ */
+extern "C" MCP_API const char *call_tool(const char *name, const char *args_json, MCPError *error) {
+    try {
+        if (std::strcmp(name, "bench_stream") != 0) {
+            error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
+            error->message = "Unknown tool";
+            return nullptr;
+        }
+        nlohmann::json args = args_json ? nlohmann::json::parse(args_json) : nlohmann::json::object();
+
+        auto *stream = new BenchStream();
+        stream->count = get_count(args, "count", 100, kMaxEvents);
+        stream->filler.assign(get_count(args, "size", 64, kMaxBytes), 'x');
+        uint64_t rate = get_count(args, "rate", 0, 1000 * 1000);
+        if (rate > 0) {
+            stream->interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(1000000000 / rate));
+        }
+        stream->next_due = std::chrono::steady_clock::now();
+        return reinterpret_cast<const char *>(stream);
+    } catch (const std::exception &) {
+        error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+        error->message = "Invalid arguments";
+        return nullptr;
+    }
+}
+
+extern "C" MCP_API void free_result(const char *result) {
+    if (result) {
+        std::free(const_cast<char *>(result));
+    }
+}
+
+extern "C" MCP_API StreamGeneratorNext get_stream_next() {
+    return bench_stream_next;
+}
+
+extern "C" MCP_API StreamGeneratorFree get_stream_free() {
+    return bench_stream_free;
+}
+
+extern "C" MCP_API StreamGeneratorCancel get_stream_cancel() {
+    return bench_stream_cancel;
+}
+
+#if defined(BENCH_STREAM_NONBLOCKING)
+extern "C" MCP_API StreamGeneratorWait get_stream_wait() {
+    return bench_stream_wait;
+}
+#endif
@@ -1,105 +1,52 @@
 #include "core/mcpserver_api.h"
 #include "mcp_plugin.h"
-#include "tool_info_parser.h"
-#include <atomic>
+#include "mcp_stream.h"
+#include "mcp_tools.h"
 #include <chrono>
 #include <nlohmann/json.hpp>
 #include <protocol/json_rpc.h>
-#include <thread>
 #include <vector>
 
 
 /**
- * Generator state for sequential number streaming
- * 
- * Tracks:
- * - Current number in sequence
- * - Streaming control flag
- * - Timing for rate control
- * - Event sequence counter
- */
-struct NumberGenerator {
-    std::atomic<int> current_num{1};// Current number being generated
-    std::atomic<bool> running{true};// Controls stream termination
-    std::chrono::steady_clock::time_point last_send_time;
-
-    explicit NumberGenerator(int req_id) {}
-};
-
-
-/**
- * @brief Generates next batch of numbers in sequence
- * 
- * @param generator Opaque pointer to generator state
- * @param result_json Output parameter for next JSON result
- * @return 0 on success, 1 on completion, -1 on error
- * Generates the next batch of numbers with full tracking
- * 
+ * @brief Streams the numbers up to 1024 in batches of ten, ten batches a second
+ *
  * Implements:
- * 1. Rate limiting (10 numbers/second)
+ * 1. Rate limiting (100 numbers/second), waiting on a server timer between batches
  * 2. Sequence tracking
  * 3. Breakpoint resumption support
+ *
+ * @param first First number to send
  */
-static int number_stream_next(StreamGenerator generator, const char **result_json, MCPError *error) {
-    if (!generator) {
-        *result_json = nullptr;
-        return 1;
-    }
-
-    auto *gen = static_cast<NumberGenerator *>(generator);
-    if (!gen->running || gen->current_num > 1024) {
-        *result_json = nullptr;
-        return 1;
-    }
-
-    // Rate control
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           now - gen->last_send_time)
-                           .count();
-    if (elapsed < 100) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100 - elapsed));
-    }
-
-    // Generate batch
-    std::vector<int> batch;
-    while (batch.size() < 10 && gen->current_num <= 1024) {
-        batch.push_back(gen->current_num++);
-    }
-
-    nlohmann::json result = {{"batch", batch}, {"remaining", 1024 - gen->current_num + 1}};
-    std::string response = mcp::protocol::generate_result(result);
+static mcp::sdk::Stream number_stream(int first) {
+    int current_num = first;
+    while (current_num <= 1024) {
+        // Generate batch
+        std::vector<int> batch;
+        while (batch.size() < 10 && current_num <= 1024) {
+            batch.push_back(current_num++);
+        }
 
-    static thread_local std::string buffer;
-    buffer = response;
-    *result_json = buffer.c_str();
+        nlohmann::json result = {{"batch", batch}, {"remaining", 1024 - current_num + 1}};
+        co_yield mcp::protocol::generate_result(result);
 
-    gen->last_send_time = now;
-    return 0;
-}
-/**
- * @brief Cleans up generator resources
- * 
- * @param generator Opaque pointer to generator state
- */
-static void number_stream_free(StreamGenerator generator) {
-    if (generator) {
-        auto *gen = static_cast<NumberGenerator *>(generator);
-        gen->running = false;
-        delete gen;
+        // Rate control
+        if (current_num <= 1024) {
+            co_await mcp::sdk::host_sleep(std::chrono::milliseconds(100));
+        }
     }
 }
 
 /**
  * Handles tool initialization with resumption support
- * 
+ *
  * Expected params format:
  * {
  *   "id": 123,                // Required: request ID
  *   "last_event_id": 5        // Optional: for resuming
  * }
  */
-extern "C" MCP_API const char *call_tool(const char *name, const char *args_json, MCPError *error) {
+extern "C" MCP_API const char *call_tool([[maybe_unused]] const char *name, const char *args_json, MCPError *error) {
     try {
         // Parse arguments (compatible with both tools/call and direct JSON-RPC)
         nlohmann::json args = args_json ? nlohmann::json::parse(args_json) : nlohmann::json::object();
@@ -113,12 +60,8 @@ extern "C" MCP_API const char *call_tool(const char *name, const char *args_json
         }
 
         // Create generator
-        auto *gen = new NumberGenerator(0);
-        if (last_event_id > 0) {
-            gen->current_num = 1 + (last_event_id * 10);
-        }
-
-        return reinterpret_cast<const char *>(gen);
+        int first = last_event_id > 0 ? 1 + (last_event_id * 10) : 1;
+        return reinterpret_cast<const char *>(mcp::sdk::start(number_stream(first)));
 
     } catch (const std::exception &e) {
         error->code = mcp::protocol::error_code::INTERNAL_ERROR;
@@ -127,31 +70,26 @@ extern "C" MCP_API const char *call_tool(const char *name, const char *args_json
     }
 }
 
+// Checked while compiling and built into the library, no tools.json to read at load time
+constinit static ToolInfo g_tools[] = {
+        mcp::sdk::streaming_tool("example_stream", "Generates number sequences from 1-1024 at 100 numbers/second (batches of 10 every 100 ms)",
+                                 R"json({"type": "object",
+                                     "properties": {"start": {"type": "number", "minimum": 1, "maximum": 1024}},
+                                     "required": []})json"),
+};
+
 /**
  * @brief Returns plugin metadata and capabilities
- * @note You had better use tools.json to generate g_tools array
  * @param count Output parameter for tool count
  * @return ToolInfo* Array of tool descriptors
  */
-static std::vector<ToolInfo> g_tools;
-
 extern "C" MCP_API ToolInfo *get_tools(int *count) {
-    try {
-        if (g_tools.empty()) {
-            g_tools = ToolInfoParser::loadFromFile("example_stream_plugin_tools.json");
-        }
-
-        *count = static_cast<int>(g_tools.size());
-        return g_tools.data();
-    } catch (const std::exception &e) {
-        *count = 0;
-        return nullptr;
-    }
+    return mcp::sdk::tool_list(g_tools, count);
 }
 
 /**
  * @brief Releases memory allocated for strings
- * 
+ *
  * @param result String pointer to free
  */
 extern "C" MCP_API void free_result(const char *result) {
@@ -160,11 +98,24 @@ extern "C" MCP_API void free_result(const char *result) {
     }
 }
 
-// Export streaming functions
+// Export streaming functions, adapted from the coroutine by the SDK
 extern "C" MCP_API StreamGeneratorNext get_stream_next() {
-    return number_stream_next;
+    return mcp::sdk::stream_next;
 }
 
 extern "C" MCP_API StreamGeneratorFree get_stream_free() {
-    return number_stream_free;
-}
\ No newline at end of file
+    return mcp::sdk::stream_free;
+}
+
+extern "C" MCP_API StreamGeneratorWait get_stream_wait() {
+    return mcp::sdk::stream_wait;
+}
+
+extern "C" MCP_API StreamGeneratorCancel get_stream_cancel() {
+    return mcp::sdk::stream_cancel;
+}
+
+// The server's timers let the stream wait between batches without holding a thread
+extern "C" MCP_API void mcp_plugin_set_host_services(const MCPHostServices *services) {
+    mcp::sdk::set_host_services(services);
+}
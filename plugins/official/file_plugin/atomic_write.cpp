@@ -0,0 +1,287 @@
+// plugins/official/file_plugin/atomic_write.cpp
+#include "atomic_write.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace file_plugin {
+
+    namespace {
+        std::atomic<unsigned long> g_temp_counter{0};
+
+        std::string temp_name(const std::string &path) {
+            auto slash = path.find_last_of("/\\");
+            std::size_t name = slash == std::string::npos ? 0 : slash + 1;
+#if !defined(_WIN32)
+            auto pid = static_cast<unsigned long>(::getpid());
+#else
+            unsigned long pid = 0;
+#endif
+            return path.substr(0, name) + "." + path.substr(name) + "." + std::to_string(pid) + "." +
+                   std::to_string(g_temp_counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+        }
+
+#if !defined(_WIN32)
+        std::string errno_message(const char *what, int error) {
+            return std::string(what) + ": " + std::strerror(error);
+        }
+
+        /**
+         * @brief Group commit of fsyncs.
+         *
+         * One caller at a time syncs; callers that arrive meanwhile queue up and the first of them
+         * syncs everything queued in one pass once it is done. Writeback of all files of a pass is
+         * started before any is waited for, and a directory is synced once per pass.
+         */
+        class SyncGroup {
+        public:
+            static SyncGroup &instance() {
+                static SyncGroup group;
+                return group;
+            }
+
+            /**
+             * @brief fsync files and directories along with the other callers.
+             * @return 0, or the errno of the first that failed
+             */
+            int sync(const std::vector<int> &fds, const std::vector<std::string> &directories) {
+                Pending self{fds, directories};
+                std::unique_lock lock(mutex_);
+                queue_.push_back(&self);
+                while (!self.done) {
+                    if (syncing_) {
+                        cv_.wait(lock);
+                        continue;
+                    }
+                    syncing_ = true;
+                    auto batch = std::move(queue_);
+                    queue_.clear();
+                    lock.unlock();
+                    run(batch);
+                    lock.lock();
+                    syncing_ = false;
+                    cv_.notify_all();
+                }
+                return self.error;
+            }
+
+        private:
+            struct Pending {
+                const std::vector<int> &fds;
+                const std::vector<std::string> &directories;
+                int error = 0;
+                bool done = false;// Guarded by mutex_
+            };
+
+            void run(const std::vector<Pending *> &batch) {
+#if defined(__linux__)
+                for (auto *pending: batch) {
+                    for (int fd: pending->fds) {
+                        ::sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+                    }
+                }
+#endif
+                std::vector<std::pair<std::string, int>> synced;// Directory, errno
+                for (auto *pending: batch) {
+                    for (int fd: pending->fds) {
+                        if (::fsync(fd) != 0 && pending->error == 0) {
+                            pending->error = errno;
+                        }
+                    }
+                    for (const auto &directory: pending->directories) {
+                        auto it = std::find_if(synced.begin(), synced.end(), [&](const auto &entry) { return entry.first == directory; });
+                        if (it == synced.end()) {
+                            synced.emplace_back(directory, sync_directory(directory));
+                            it = synced.end() - 1;
+                        }
+                        if (it->second != 0 && pending->error == 0) {
+                            pending->error = it->second;
+                        }
+                    }
+                }
+                std::lock_guard lock(mutex_);
+                for (auto *pending: batch) {
+                    pending->done = true;
+                }
+            }
+
+            static int sync_directory(const std::string &directory) {
+                int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd < 0) {
+                    return errno;
+                }
+                int error = ::fsync(fd) == 0 ? 0 : errno;
+                ::close(fd);
+                return error;
+            }
+
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            std::vector<Pending *> queue_;
+            bool syncing_ = false;
+        };
+#endif
+    }// namespace
+
+    AtomicFile::AtomicFile(std::string path) : path_(std::move(path)) {}
+
+    AtomicFile::AtomicFile(AtomicFile &&other) noexcept
+        : path_(std::move(other.path_)), temp_path_(std::move(other.temp_path_)),
+#if !defined(_WIN32)
+          fd_(std::exchange(other.fd_, -1)),
+#else
+          out_(std::move(other.out_)),
+#endif
+          committed_(other.committed_) {
+        other.temp_path_.clear();
+    }
+
+    AtomicFile::~AtomicFile() {
+        discard();
+    }
+
+    void AtomicFile::discard() {
+#if !defined(_WIN32)
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#else
+        out_.close();
+#endif
+        if (!committed_ && !temp_path_.empty()) {
+            std::remove(temp_path_.c_str());
+        }
+        temp_path_.clear();
+    }
+
+    std::string AtomicFile::directory() const {
+        auto slash = path_.find_last_of('/');
+        if (slash == std::string::npos) {
+            return ".";
+        }
+        return slash == 0 ? "/" : path_.substr(0, slash);
+    }
+
+    bool AtomicFile::open(std::string &error) {
+#if !defined(_WIN32)
+        struct stat target {};
+        bool exists = ::stat(path_.c_str(), &target) == 0;
+        // A name taken by a write of another process that died is skipped
+        for (int attempt = 0; attempt < 16 && fd_ < 0; ++attempt) {
+            temp_path_ = temp_name(path_);
+            fd_ = ::open(temp_path_.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+            if (fd_ < 0 && errno != EEXIST) {
+                break;
+            }
+        }
+        if (fd_ < 0) {
+            temp_path_.clear();
+            error = "Cannot open file for writing";
+            return false;
+        }
+        if (exists) {
+            ::fchmod(fd_, target.st_mode & 07777);
+        }
+#else
+        temp_path_ = temp_name(path_);
+        out_.open(temp_path_, std::ios::binary | std::ios::trunc);
+        if (!out_.is_open()) {
+            temp_path_.clear();
+            error = "Cannot open file for writing";
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    bool AtomicFile::write(std::string_view data, std::string &error) {
+#if !defined(_WIN32)
+        while (!data.empty()) {
+            ssize_t n = ::write(fd_, data.data(), data.size());
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = errno_message("Failed to write file", errno);
+                return false;
+            }
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+#else
+        if (!out_.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            error = "Failed to write file";
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    bool commit_files(std::vector<AtomicFile> &files, bool sync, std::string &error) {
+#if !defined(_WIN32)
+        if (sync) {
+            std::vector<int> fds;
+            for (const auto &file: files) {
+                fds.push_back(file.fd_);
+            }
+            if (int failed = SyncGroup::instance().sync(fds, {}); failed != 0) {
+                error = errno_message("Failed to sync file", failed);
+                return false;
+            }
+        }
+        for (auto &file: files) {
+            int failed = ::close(file.fd_) == 0 ? 0 : errno;
+            file.fd_ = -1;
+            if (failed != 0) {
+                error = errno_message("Failed to write file", failed);
+                return false;
+            }
+        }
+#else
+        for (auto &file: files) {
+            file.out_.close();
+            if (!file.out_) {
+                error = "Failed to write file";
+                return false;
+            }
+        }
+#endif
+        std::vector<std::string> directories;
+        for (auto &file: files) {
+            std::error_code ec;
+            std::filesystem::rename(file.temp_path_, file.path_, ec);
+            if (ec) {
+                error = "Failed to replace " + file.path_ + ": " + ec.message();
+                return false;
+            }
+            file.committed_ = true;
+            auto directory = file.directory();
+            if (std::find(directories.begin(), directories.end(), directory) == directories.end()) {
+                directories.push_back(std::move(directory));
+            }
+        }
+#if !defined(_WIN32)
+        // The renames themselves are durable once their directories are synced
+        if (sync) {
+            if (int failed = SyncGroup::instance().sync({}, directories); failed != 0) {
+                error = errno_message("Failed to sync directory", failed);
+                return false;
+            }
+        }
+#endif
+        return true;
+    }
+
+}// namespace file_plugin
@@ -0,0 +1,70 @@
+// plugins/official/file_plugin/atomic_write.h
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#endif
+
+namespace file_plugin {
+
+    /**
+     * @brief File written under a temporary name next to its target, which it replaces on commit.
+     *
+     * Readers of the target see either the old content or the new one, never part of a write.
+     * The temporary file is removed if the file is destroyed without being committed.
+     */
+    class AtomicFile {
+    public:
+        explicit AtomicFile(std::string path);
+        ~AtomicFile();
+        AtomicFile(AtomicFile &&other) noexcept;
+        AtomicFile &operator=(AtomicFile &&) = delete;
+        AtomicFile(const AtomicFile &) = delete;
+        AtomicFile &operator=(const AtomicFile &) = delete;
+
+        /**
+         * @brief Create the temporary file, with the mode of the target if there is one.
+         * @param error Set on failure
+         */
+        bool open(std::string &error);
+
+        bool write(std::string_view data, std::string &error);
+
+        const std::string &path() const { return path_; }
+
+    private:
+        friend bool commit_files(std::vector<AtomicFile> &files, bool sync, std::string &error);
+
+        /// Directory holding the target, "." for a bare name
+        std::string directory() const;
+
+        void discard();
+
+        std::string path_;
+        std::string temp_path_;
+#if !defined(_WIN32)
+        int fd_ = -1;
+#else
+        std::ofstream out_;
+#endif
+        bool committed_ = false;
+    };
+
+    /**
+     * @brief Replace the targets of files with what was written to them.
+     *
+     * Nothing is renamed until every file is written out, so a failed write leaves all targets
+     * as they were. With sync the data reaches the disk before the renames and the directories
+     * after them; these fsyncs are grouped with those of concurrent callers, so writers that
+     * arrive while one batch is being synced share the next.
+     * @param files Opened and written files
+     * @param sync Whether to fsync
+     * @param error Set on failure
+     */
+    bool commit_files(std::vector<AtomicFile> &files, bool sync, std::string &error);
+
+}// namespace file_plugin
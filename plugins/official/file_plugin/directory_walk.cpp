@@ -0,0 +1,230 @@
+// plugins/official/file_plugin/directory_walk.cpp
+#include "directory_walk.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace file_plugin {
+
+    namespace {
+        std::string to_utf8(const std::filesystem::path &path) {
+            auto text = path.u8string();// std::u8string from C++20 on
+            return std::string(text.begin(), text.end());
+        }
+
+        /**
+         * @brief Match c against the set starting at pattern[p] == '['; advances p past it.
+         * @return false with p unchanged if the set is not closed, '[' is then a plain character
+         */
+        bool match_set(std::string_view pattern, std::size_t &p, char c, bool &matched) {
+            std::size_t i = p + 1;
+            bool negate = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+            if (negate) ++i;
+            std::size_t first = i;
+            matched = false;
+            for (; i < pattern.size() && (pattern[i] != ']' || i == first); ++i) {
+                if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+                    matched |= pattern[i] <= c && c <= pattern[i + 2];
+                    i += 2;
+                } else {
+                    matched |= pattern[i] == c;
+                }
+            }
+            if (i == pattern.size()) {
+                return false;
+            }
+            matched = matched != negate && c != '/';
+            p = i + 1;
+            return true;
+        }
+
+        /**
+         * @brief Directories waiting to be read, one deque per walking thread.
+         */
+        class Walk {
+        public:
+            Walk(const std::filesystem::path &root, const WalkOptions &options,
+                 const std::function<void(const WalkEntry &)> &visit, unsigned threads)
+                : root_(root), options_(options), visit_(visit), queues_(threads) {
+                for (auto &queue: queues_) {
+                    queue = std::make_unique<Queue>();
+                }
+            }
+
+            void run() {
+                push(0, Dir{root_, std::string()});
+                std::vector<std::thread> helpers;
+                for (std::size_t self = 1; self < queues_.size(); ++self) {
+                    helpers.emplace_back([this, self]() { work(self); });
+                }
+                work(0);
+                for (auto &helper: helpers) {
+                    helper.join();
+                }
+            }
+
+            bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+        private:
+            struct Dir {
+                std::filesystem::path path;///< Path to open
+                std::string relative;      ///< Relative to the root, '/'-separated
+            };
+
+            struct Queue {
+                std::mutex mutex;
+                std::deque<Dir> dirs;
+            };
+
+            void push(std::size_t self, Dir dir) {
+                pending_.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard lock(queues_[self]->mutex);
+                queues_[self]->dirs.push_back(std::move(dir));
+            }
+
+            /**
+             * @brief Newest directory of our own deque, else the oldest of someone else's.
+             */
+            bool pop(std::size_t self, Dir &dir) {
+                {
+                    auto &own = *queues_[self];
+                    std::lock_guard lock(own.mutex);
+                    if (!own.dirs.empty()) {
+                        dir = std::move(own.dirs.back());
+                        own.dirs.pop_back();
+                        return true;
+                    }
+                }
+                for (std::size_t i = 1; i < queues_.size(); ++i) {
+                    auto &victim = *queues_[(self + i) % queues_.size()];
+                    std::lock_guard lock(victim.mutex);
+                    if (!victim.dirs.empty()) {
+                        dir = std::move(victim.dirs.front());
+                        victim.dirs.pop_front();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void work(std::size_t self) {
+                Dir dir;
+                // Directories queued or being read; none left means no more can turn up
+                while (pending_.load(std::memory_order_acquire) > 0 && !cancelled()) {
+                    if (!pop(self, dir)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (options_.cancelled && options_.cancelled()) {
+                        cancelled_.store(true, std::memory_order_relaxed);
+                    } else {
+                        read(self, dir);
+                    }
+                    pending_.fetch_sub(1, std::memory_order_release);
+                }
+            }
+
+            void read(std::size_t self, const Dir &dir) {
+                std::error_code ec;
+                std::filesystem::directory_iterator it(dir.path, std::filesystem::directory_options::skip_permission_denied, ec);
+                WalkEntry entry;
+                for (std::filesystem::directory_iterator end; !ec && it != end; it.increment(ec)) {
+                    std::string name = to_utf8(it->path().filename());
+                    entry.path.assign(dir.relative);
+                    if (!entry.path.empty()) {
+                        entry.path += '/';
+                    }
+                    entry.path += name;
+                    entry.name = std::string_view(entry.path).substr(entry.path.size() - name.size());
+
+                    std::error_code type_ec;
+                    entry.type = it->symlink_status(type_ec).type();
+                    entry.size = 0;
+                    if (options_.stat_files && entry.type == std::filesystem::file_type::regular) {
+                        std::error_code size_ec;
+                        entry.size = it->file_size(size_ec);
+                        if (size_ec) entry.size = 0;
+                    }
+                    visit_(entry);
+
+                    if (options_.recursive && entry.type == std::filesystem::file_type::directory &&
+                        (!options_.descend || options_.descend(entry.path))) {
+                        push(self, Dir{it->path(), entry.path});
+                    }
+                }
+            }
+
+            const std::filesystem::path &root_;
+            const WalkOptions &options_;
+            const std::function<void(const WalkEntry &)> &visit_;
+            std::vector<std::unique_ptr<Queue>> queues_;
+            std::atomic<std::size_t> pending_{0};
+            std::atomic<bool> cancelled_{false};
+        };
+    }// namespace
+
+    bool glob_match(std::string_view pattern, std::string_view text) {
+        std::size_t p = 0;
+        std::size_t t = 0;
+        while (p < pattern.size()) {
+            char c = pattern[p];
+            if (c == '*') {
+                bool any = p + 1 < pattern.size() && pattern[p + 1] == '*';
+                std::size_t rest = p + (any ? 2 : 1);
+                // "**/" matches no directory at all as well
+                if (any && rest < pattern.size() && pattern[rest] == '/' && glob_match(pattern.substr(rest + 1), text.substr(t))) {
+                    return true;
+                }
+                for (std::size_t k = t;; ++k) {
+                    if (glob_match(pattern.substr(rest), text.substr(k))) {
+                        return true;
+                    }
+                    if (k == text.size() || (!any && text[k] == '/')) {
+                        return false;
+                    }
+                }
+            }
+            if (t == text.size()) {
+                return false;
+            }
+            bool matched = false;
+            if (c == '[' && match_set(pattern, p, text[t], matched)) {
+                if (!matched) {
+                    return false;
+                }
+                ++t;
+                continue;
+            }
+            if (c == '?' ? text[t] == '/' : c != text[t]) {
+                return false;
+            }
+            ++p;
+            ++t;
+        }
+        return t == text.size();
+    }
+
+    bool parallel_walk(const std::filesystem::path &root, const WalkOptions &options,
+                       const std::function<void(const WalkEntry &)> &visit) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(root, ec)) {
+            return false;
+        }
+        unsigned threads = options.threads;
+        if (threads == 0) {
+            threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        }
+        // A single directory is read by one thread anyway
+        if (!options.recursive) {
+            threads = 1;
+        }
+        Walk walk(root, options, visit, threads);
+        walk.run();
+        return !walk.cancelled();
+    }
+
+}// namespace file_plugin
@@ -0,0 +1,56 @@
+// plugins/official/file_plugin/directory_walk.h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace file_plugin {
+
+    /**
+     * @brief Whether a glob pattern matches text.
+     *
+     * '*' matches any run and '?' any single character, neither of them '/'; "**" matches across
+     * directories. "[abc]", "[a-z]" and "[!abc]" match a character of a set or not of it.
+     */
+    bool glob_match(std::string_view pattern, std::string_view text);
+
+    /**
+     * @brief Entry met by parallel_walk().
+     */
+    struct WalkEntry {
+        std::string path;                ///< Relative to the root, '/'-separated
+        std::string_view name;           ///< Last component of path
+        std::filesystem::file_type type; ///< Type of the entry itself, symlinks are not followed
+        std::uintmax_t size = 0;         ///< Size of regular files, 0 for the others
+    };
+
+    /**
+     * @brief What parallel_walk() visits.
+     */
+    struct WalkOptions {
+        bool recursive = true;                          ///< Descend into subdirectories
+        unsigned threads = 0;                           ///< Walking threads, 0 = one per core, at most 8
+        bool stat_files = true;                         ///< Fill in WalkEntry::size, one stat() per file
+        std::function<bool(std::string_view dir)> descend;///< Whether to enter a directory (relative path), all if empty
+        std::function<bool()> cancelled;                ///< Polled between directories, stops the walk once true
+    };
+
+    /**
+     * @brief Walk a directory tree on several threads.
+     *
+     * Every thread owns a deque of directories still to read: it takes the newest of its own and,
+     * when it runs dry, steals the oldest of another thread's, so one deep subtree is shared out
+     * instead of leaving the other threads idle. Unreadable directories are skipped. visit is
+     * called from the walking threads at the same time, in no particular order.
+     * @param root Directory to walk
+     * @param options What to visit
+     * @param visit Called for every entry below root
+     * @return false if root is not a directory or the walk was cancelled
+     */
+    bool parallel_walk(const std::filesystem::path &root, const WalkOptions &options,
+                       const std::function<void(const WalkEntry &)> &visit);
+
+}// namespace file_plugin
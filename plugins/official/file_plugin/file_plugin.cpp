@@ -1,52 +1,238 @@
 // plugins/official/file_plugin/file_plugin.cpp
+#include "atomic_write.h"
 #include "core/mcpserver_api.h"
+#include "directory_walk.h"
+#include "mcp_base64.h"
 #include "mcp_plugin.h"
 #include "protocol/json_rpc.h"
+#include "text_search.h"
 #include "tool_info_parser.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <nlohmann/json.hpp>
-#include <sstream>
+#include <queue>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 
 static std::vector<ToolInfo> g_tools;
 
 static std::string read_file(const std::string &path) {
     try {
-        std::ifstream f(path);
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
         if (!f.is_open()) {
             // Return custom error code and message, consistent with safe_system_plugin
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "File not found or cannot open");
         }
-        std::stringstream buffer;
-        buffer << f.rdbuf();
-        return mcp::protocol::generate_result(nlohmann::json{{"content", buffer.str()}});
+        // One read into a buffer of the right size
+        std::string content(static_cast<size_t>(f.tellg()), '\0');
+        f.seekg(0);
+        f.read(content.data(), static_cast<std::streamsize>(content.size()));
+        content.resize(static_cast<size_t>(f.gcount()));
+        return mcp::protocol::generate_result(nlohmann::json{{"content", std::move(content)}});
     } catch (const std::exception &e) {
         // Return custom error code and message, consistent with safe_system_plugin
         return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "Failed to read file: " + std::string(e.what()));
     }
 }
 
-static std::string write_file(const std::string &path, const std::string &content) {
-    try {
-        std::ofstream f(path);
-        if (!f.is_open()) {
-            // Return custom error code and message, consistent with safe_system_plugin
-            return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "Cannot open file for writing");
-        }
-        f << content;
-        f.close();
-        return mcp::protocol::generate_result(nlohmann::json{{"result", "success"}});
-    } catch (const std::exception &e) {
+// Replace the file through a temporary one, so readers never see half of it
+static std::string write_file(const std::string &path, const std::string &content, bool sync) {
+    std::vector<file_plugin::AtomicFile> files;
+    files.emplace_back(path);
+    std::string message;
+    if (!files.back().open(message)) {
         // Return custom error code and message, consistent with safe_system_plugin
-        return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "Failed to write file: " + std::string(e.what()));
+        return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, message);
+    }
+    if (!files.back().write(content, message) || !file_plugin::commit_files(files, sync, message)) {
+        return mcp::protocol::generate_error(mcp::protocol::error_code::INTERNAL_ERROR, message);
+    }
+    return mcp::protocol::generate_result(nlohmann::json{{"result", "success"}});
+}
+
+// All files are written before any replaces its target, so a failed write changes none of them
+static bool write_files(const nlohmann::json &args, std::string &result, MCPError *error) {
+    thread_local std::string message;
+    auto edits = args.find("files");
+    if (edits == args.end() || !edits->is_array() || edits->empty()) {
+        error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+        error->message = "Missing 'files' parameter";
+        return false;
     }
+    std::vector<file_plugin::AtomicFile> files;
+    files.reserve(edits->size());
+    for (const auto &edit: *edits) {
+        const auto *path = edit.is_object() && edit.contains("path") ? edit["path"].get_ptr<const std::string *>() : nullptr;
+        const auto *content = edit.is_object() && edit.contains("content") ? edit["content"].get_ptr<const std::string *>() : nullptr;
+        if (!path || path->empty() || !content) {
+            error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            error->message = "Each entry of 'files' needs a 'path' and a 'content' string";
+            return false;
+        }
+        files.emplace_back(*path);
+        if (!files.back().open(message)) {
+            message += ": " + *path;
+            error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
+            error->message = message.c_str();
+            return false;
+        }
+        if (!files.back().write(*content, message)) {
+            error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+            error->message = message.c_str();
+            return false;
+        }
+    }
+    if (!file_plugin::commit_files(files, args.value("sync", false), message)) {
+        error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+        error->message = message.c_str();
+        return false;
+    }
+    result = mcp::protocol::generate_result(nlohmann::json{{"result", "success"}, {"written", files.size()}});
+    return true;
 }
 
-static std::string list_files(const std::string &path) {
-    // This is a simplified implementation that just returns the path
-    // A real implementation would actually list files in the directory
-    return mcp::protocol::generate_result(nlohmann::json{{"path", path}});
+static constexpr size_t kDefaultListLimit = 1000;
+static constexpr size_t kMaxListLimit = 10000;
+
+static const char *type_name(std::filesystem::file_type type) {
+    switch (type) {
+        case std::filesystem::file_type::regular:
+            return "file";
+        case std::filesystem::file_type::directory:
+            return "directory";
+        case std::filesystem::file_type::symlink:
+            return "symlink";
+        default:
+            return "other";
+    }
+}
+
+// The first entries of a listing in path order that come after the cursor. Only a page is held:
+// the largest entry is dropped whenever a smaller one turns up, and subtrees that can only hold
+// entries before the cursor or after a full page are not walked at all.
+class ListPage {
+public:
+    ListPage(std::string after, size_t limit) : after_(std::move(after)), limit_(limit) {}
+
+    void offer(const file_plugin::WalkEntry &entry) {
+        if (!after_.empty() && entry.path <= after_) {
+            return;
+        }
+        std::lock_guard lock(mutex_);
+        // One more than the page, to tell whether another page follows
+        if (heap_.size() <= limit_) {
+            heap_.push(Item{entry.path, entry.type, entry.size});
+        } else if (entry.path < heap_.top().path) {
+            heap_.pop();
+            heap_.push(Item{entry.path, entry.type, entry.size});
+        }
+    }
+
+    bool descend(std::string_view dir) {
+        // Paths below dir sort between "dir/" and "dir0", '0' following '/'
+        std::string below(dir);
+        below += '0';
+        if (!after_.empty() && after_ >= below) {
+            return false;
+        }
+        below.back() = '/';
+        std::lock_guard lock(mutex_);
+        return heap_.size() <= limit_ || below < heap_.top().path;
+    }
+
+    // The page in path order and the cursor of the next one, empty if this is the last
+    nlohmann::json take(std::string &next_cursor) {
+        std::vector<Item> items;
+        items.reserve(heap_.size());
+        while (!heap_.empty()) {
+            items.push_back(heap_.top());
+            heap_.pop();
+        }
+        std::reverse(items.begin(), items.end());
+        bool more = items.size() > limit_;
+        if (more) {
+            items.pop_back();
+        }
+        next_cursor = more && !items.empty() ? mcp::utils::base64_encode(items.back().path) : std::string();
+
+        nlohmann::json entries = nlohmann::json::array();
+        for (auto &item: items) {
+            nlohmann::json entry{{"path", std::move(item.path)}, {"type", type_name(item.type)}};
+            if (item.type == std::filesystem::file_type::regular) {
+                entry["size"] = item.size;
+            }
+            entries.push_back(std::move(entry));
+        }
+        return entries;
+    }
+
+private:
+    struct Item {
+        std::string path;
+        std::filesystem::file_type type;
+        std::uintmax_t size;
+        bool operator<(const Item &other) const { return path < other.path; }
+    };
+
+    std::string after_;
+    size_t limit_;
+    std::mutex mutex_;
+    std::priority_queue<Item> heap_;// Largest path on top
+};
+
+// list_files: a page of a directory listing, recursive and filtered by a glob if asked for
+static bool list_files(const nlohmann::json &args, std::string &result, MCPError *error, const MCPCancelToken *cancel) {
+    std::string root = args.value("path", ".");
+    bool recursive = args.value("recursive", false);
+    std::string pattern = args.value("pattern", "");
+    size_t limit = std::clamp<size_t>(args.value("limit", kDefaultListLimit), 1, kMaxListLimit);
+
+    std::string after;
+    if (auto cursor = args.value("cursor", ""); !cursor.empty()) {
+        auto decoded = mcp::utils::base64_decode(cursor);
+        if (!decoded || decoded->empty()) {
+            error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            error->message = "Invalid 'cursor' parameter";
+            return false;
+        }
+        after = std::move(*decoded);
+    }
+
+    // A pattern with a '/' is matched against the relative path, otherwise against the name
+    bool match_path = pattern.find('/') != std::string::npos;
+    ListPage page(std::move(after), limit);
+    file_plugin::WalkOptions options;
+    options.recursive = recursive;
+    options.descend = [&page](std::string_view dir) { return page.descend(dir); };
+    if (cancel) {
+        options.cancelled = [cancel]() { return cancel->is_cancelled(cancel->context); };
+    }
+    bool walked = file_plugin::parallel_walk(std::filesystem::path(root), options, [&](const file_plugin::WalkEntry &entry) {
+        if (pattern.empty() || file_plugin::glob_match(pattern, match_path ? std::string_view(entry.path) : entry.name)) {
+            page.offer(entry);
+        }
+    });
+    if (!walked) {
+        bool cancelled = cancel && cancel->is_cancelled(cancel->context);
+        error->code = cancelled ? mcp::protocol::error_code::INTERNAL_ERROR : mcp::protocol::error_code::TOOL_NOT_FOUND;
+        error->message = cancelled ? "Request cancelled" : "Directory not found or cannot open";
+        return false;
+    }
+
+    std::string next_cursor;
+    nlohmann::json listing{{"path", root}, {"entries", page.take(next_cursor)}};
+    if (!next_cursor.empty()) {
+        listing["nextCursor"] = std::move(next_cursor);
+    }
+    result = mcp::protocol::generate_result(listing);
+    return true;
 }
 
 extern "C" MCP_API ToolInfo *get_tools(int *count) {
@@ -63,42 +249,338 @@ extern "C" MCP_API ToolInfo *get_tools(int *count) {
     }
 }
 
-extern "C" MCP_API const char *call_tool(const char *name, const char *args_json, MCPError *error) {
-    try {
-        auto args = nlohmann::json::parse(args_json);
-        std::string tool_name = name;
-
-        if (tool_name == "read_file") {
-            std::string file_path = args.value("path", "");
-            if (file_path.empty()) {
-                // Use MCPError to return error instead of constructing JSON string
-                error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
-                error->message = "Missing 'path' parameter";
-                return nullptr;
+static constexpr size_t kDefaultSearchResults = 1000;
+static constexpr size_t kSearchBatch = 256;        // Matches per event at most
+static constexpr size_t kSearchBacklog = 4096;     // Matches waiting for the client before the walk pauses
+static constexpr size_t kMaxLineBytes = 512;       // Longer lines are cut around the match
+
+// search_files: walks the tree on its own threads and hands the matches to next() as they are found
+struct SearchGenerator {
+    struct Match {
+        std::string path;
+        size_t line;
+        size_t column;
+        std::string text;
+    };
+
+    std::filesystem::path root;
+    file_plugin::TextQuery query;
+    std::string include;// Glob the files must match, empty for all
+    bool include_path = false;
+    size_t max_results = kDefaultSearchResults;
+    uintmax_t max_file_size = 0;// 0 = no limit
+
+    std::mutex mutex;
+    std::condition_variable ready;  // Matches arrived or the walk ended
+    std::condition_variable drained;// next() took matches
+    std::deque<Match> matches;
+    size_t found = 0;
+    size_t files_searched = 0;
+    size_t lines_skipped = 0;// Too long for the regular expression
+    bool done = false;
+    std::atomic<bool> stop{false};
+    std::string event;// Returned by the last next(), valid until the following one
+    std::thread walker;
+
+    void run() {
+        file_plugin::WalkOptions options;
+        options.stat_files = max_file_size > 0;
+        options.cancelled = [this]() { return stop.load(std::memory_order_relaxed); };
+        file_plugin::parallel_walk(root, options, [this](const file_plugin::WalkEntry &entry) { search(entry); });
+        std::lock_guard lock(mutex);
+        done = true;
+        ready.notify_all();
+    }
+
+    void search(const file_plugin::WalkEntry &entry) {
+        if (stop.load(std::memory_order_relaxed) || entry.type != std::filesystem::file_type::regular ||
+            (max_file_size > 0 && entry.size > max_file_size) ||
+            (!include.empty() && !file_plugin::glob_match(include, include_path ? std::string_view(entry.path) : entry.name))) {
+            return;
+        }
+        auto file = file_plugin::MappedRegion::open((root / std::filesystem::path(entry.path)).string());
+        if (!file || file_plugin::looks_binary(file->bytes())) {
+            return;
+        }
+
+        std::vector<Match> local;
+        size_t skipped = file_plugin::search_text(file->bytes(), query, [&](const file_plugin::LineMatch &match) {
+            std::string_view text = match.text;
+            if (text.size() > kMaxLineBytes) {
+                size_t from = match.column - 1 > kMaxLineBytes / 2 ? match.column - 1 - kMaxLineBytes / 2 : 0;
+                text = text.substr(from, kMaxLineBytes);
+            }
+            local.push_back(Match{entry.path, match.line, match.column, std::string(text)});
+            return local.size() < max_results && !stop.load(std::memory_order_relaxed);
+        });
+
+        std::unique_lock lock(mutex);
+        ++files_searched;
+        lines_skipped += skipped;
+        for (auto &match: local) {
+            // Wait for the client rather than piling up matches it has not taken
+            drained.wait(lock, [this]() { return matches.size() < kSearchBacklog || stop.load(std::memory_order_relaxed); });
+            if (stop.load(std::memory_order_relaxed) || found == max_results) {
+                break;
             }
-            std::string result = read_file(file_path);
-            return strdup(result.c_str());
-        } else if (tool_name == "write_file") {
-            std::string file_path = args.value("path", "");
-            std::string content = args.value("content", "");
-            if (file_path.empty()) {
-                // Use MCPError to return error instead of constructing JSON string
-                error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
-                error->message = "Missing 'path' parameter";
-                return nullptr;
+            matches.push_back(std::move(match));
+            if (++found == max_results) {
+                stop.store(true, std::memory_order_relaxed);
             }
-            std::string result = write_file(file_path, content);
-            return strdup(result.c_str());
-        } else if (tool_name == "list_files") {
-            std::string dir_path = args.value("path", ".");
-            std::string result = list_files(dir_path);
-            return strdup(result.c_str());
-        } else {
+        }
+        ready.notify_all();
+    }
+
+    void cancel() {
+        std::lock_guard lock(mutex);
+        stop.store(true, std::memory_order_relaxed);
+        ready.notify_all();
+        drained.notify_all();
+    }
+};
+
+static int search_stream_next(StreamGenerator generator, const char **result_json, MCPError *error) {
+    auto *search = static_cast<SearchGenerator *>(generator);
+    nlohmann::json batch = nlohmann::json::array();
+    size_t files_searched = 0;
+    size_t lines_skipped = 0;
+    bool truncated = false;
+    {
+        std::unique_lock lock(search->mutex);
+        search->ready.wait(lock, [search]() { return !search->matches.empty() || search->done; });
+        if (search->matches.empty()) {
+            *result_json = nullptr;
+            return 1;
+        }
+        for (size_t i = 0; i < kSearchBatch && !search->matches.empty(); ++i) {
+            auto &match = search->matches.front();
+            batch.push_back({{"path", std::move(match.path)}, {"line", match.line}, {"column", match.column}, {"text", std::move(match.text)}});
+            search->matches.pop_front();
+        }
+        files_searched = search->files_searched;
+        lines_skipped = search->lines_skipped;
+        truncated = search->found == search->max_results && search->matches.empty();
+        search->drained.notify_all();
+    }
+
+    nlohmann::json event{{"result", {{"matches", std::move(batch)}, {"files_searched", files_searched}}}};
+    if (truncated) {
+        event["result"]["truncated"] = true;
+    }
+    if (lines_skipped > 0) {
+        event["result"]["lines_skipped"] = lines_skipped;
+    }
+    try {
+        // Lines cut in the middle of a character, or files not in UTF-8, are sent with replacement characters
+        search->event = event.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    } catch (const std::exception &) {
+        error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+        error->message = "Failed to serialize matches";
+        return -1;
+    }
+    *result_json = search->event.c_str();
+    return 0;
+}
+
+static void search_stream_cancel(StreamGenerator generator) {
+    static_cast<SearchGenerator *>(generator)->cancel();
+}
+
+static void search_stream_free(StreamGenerator generator) {
+    auto *search = static_cast<SearchGenerator *>(generator);
+    search->cancel();
+    if (search->walker.joinable()) {
+        search->walker.join();
+    }
+    delete search;
+}
+
+// Start search_files; nullptr with error filled in if the arguments do not make a search
+static SearchGenerator *start_search(const nlohmann::json &args, MCPError *error) {
+    auto search = std::make_unique<SearchGenerator>();
+    std::string query = args.value("query", "");
+    if (query.empty()) {
+        error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+        error->message = "Missing 'query' parameter";
+        return nullptr;
+    }
+    bool ignore_case = args.value("ignore_case", false);
+    if (args.value("regex", false)) {
+        try {
+            auto flags = std::regex::ECMAScript | std::regex::optimize;
+            search->query.pattern.emplace(query, ignore_case ? flags | std::regex::icase : flags);
+        } catch (const std::regex_error &) {
+            error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            error->message = "Invalid regular expression in 'query'";
+            return nullptr;
+        }
+    } else {
+        search->query.literal.emplace(std::move(query), ignore_case);
+    }
+
+    search->root = std::filesystem::path(args.value("path", "."));
+    std::error_code ec;
+    if (!std::filesystem::is_directory(search->root, ec)) {
+        error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
+        error->message = "Directory not found or cannot open";
+        return nullptr;
+    }
+    search->include = args.value("include", "");
+    search->include_path = search->include.find('/') != std::string::npos;
+    search->max_results = std::max<size_t>(args.value("max_results", kDefaultSearchResults), 1);
+    search->max_file_size = args.value("max_file_size", uintmax_t{0});
+
+    auto *started = search.release();
+    started->walker = std::thread([started]() { started->run(); });
+    return started;
+}
+
+// Run a tool; returns false with error filled in on failure. cancel is nullptr for callers without one
+static bool run_tool(const char *name, const nlohmann::json &args, std::string &result, MCPError *error,
+                     const MCPCancelToken *cancel = nullptr) {
+    std::string tool_name = name;
+
+    if (tool_name == "read_file") {
+        std::string file_path = args.value("path", "");
+        if (file_path.empty()) {
+            // Use MCPError to return error instead of constructing JSON string
+            error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            error->message = "Missing 'path' parameter";
+            return false;
+        }
+        result = read_file(file_path);
+        return true;
+    } else if (tool_name == "write_file") {
+        std::string file_path = args.value("path", "");
+        std::string content = args.value("content", "");
+        if (file_path.empty()) {
             // Use MCPError to return error instead of constructing JSON string
+            error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            error->message = "Missing 'path' parameter";
+            return false;
+        }
+        result = write_file(file_path, content, args.value("sync", false));
+        return true;
+    } else if (tool_name == "write_files") {
+        return write_files(args, result, error);
+    } else if (tool_name == "list_files") {
+        return list_files(args, result, error, cancel);
+    }
+    // Use MCPError to return error instead of constructing JSON string
+    error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
+    error->message = "Unknown tool";
+    return false;
+}
+
+extern "C" MCP_API int mcp_plugin_abi_version() {
+    return MCP_PLUGIN_ABI_VERSION;
+}
+
+// ABI v2: the result goes straight into the server's output arena, no strdup/free_result round trip
+static int call_tool_into(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error, const MCPCancelToken *cancel) {
+    try {
+        auto args = nlohmann::json::parse(args_json.data, args_json.data + args_json.size);
+        std::string result;
+        if (!run_tool(name, args, result, error, cancel)) {
+            return 1;
+        }
+        if (!output->write(output->context, result.data(), result.size())) {
+            error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+            error->message = "Out of memory writing result";
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception &) {
+        // e.what() would dangle once the handler returns, so report a fixed message
+        error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+        error->message = "Failed to run tool";
+        return 1;
+    }
+}
+
+extern "C" MCP_API int call_tool_v2(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error) {
+    return call_tool_into(name, args_json, output, error, nullptr);
+}
+
+// Preferred over call_tool_v2: a recursive list_files stops walking once the client cancels
+extern "C" MCP_API int call_tool_cancellable(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error,
+                                             const MCPCancelToken *cancel) {
+    return call_tool_into(name, args_json, output, error, cancel);
+}
+
+// write_file takes its content as a stream, so large uploads go to disk without being held in memory
+extern "C" MCP_API const char *mcp_plugin_streamed_argument(const char *name) {
+    return std::string_view(name) == "write_file" ? "content" : nullptr;
+}
+
+extern "C" MCP_API int call_tool_with_input(const char *name, MCPBuffer args_json, const MCPInputStream *input,
+                                            MCPOutput *output, MCPError *error, const MCPCancelToken *cancel) {
+    try {
+        auto args = nlohmann::json::parse(args_json.data, args_json.data + args_json.size);
+        std::string file_path = args.value("path", "");
+        if (std::string_view(name) != "write_file" || file_path.empty()) {
+            error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+            error->message = "Missing 'path' parameter";
+            return 1;
+        }
+        thread_local std::string message;
+        std::vector<file_plugin::AtomicFile> files;
+        files.emplace_back(file_path);
+        if (!files.back().open(message)) {
             error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
-            error->message = "Unknown tool";
+            error->message = message.c_str();
+            return 1;
+        }
+        std::vector<char> buffer(64 * 1024);
+        while (true) {
+            long long n = input->read(input->context, buffer.data(), buffer.size());
+            if (n < 0 || cancel->is_cancelled(cancel->context)) {
+                error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+                error->message = n < 0 ? "Upload failed" : "Request cancelled";
+                return 1;
+            }
+            if (n == 0) {
+                break;
+            }
+            if (!files.back().write(std::string_view(buffer.data(), static_cast<size_t>(n)), message)) {
+                error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+                error->message = message.c_str();
+                return 1;
+            }
+        }
+        // Only now is the target replaced, an upload cut short or cancelled leaves it as it was
+        if (!file_plugin::commit_files(files, args.value("sync", false), message)) {
+            error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+            error->message = message.c_str();
+            return 1;
+        }
+        std::string result = mcp::protocol::generate_result(nlohmann::json{{"result", "success"}});
+        if (!output->write(output->context, result.data(), result.size())) {
+            error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+            error->message = "Out of memory writing result";
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception &) {
+        error->code = mcp::protocol::error_code::INTERNAL_ERROR;
+        error->message = "Failed to run tool";
+        return 1;
+    }
+}
+
+// ABI v1 entry point, kept for servers without call_tool_v2 support
+extern "C" MCP_API const char *call_tool(const char *name, const char *args_json, MCPError *error) {
+    try {
+        auto args = nlohmann::json::parse(args_json);
+        // Streaming tools are started here; the server takes the result for their generator
+        if (std::string_view(name) == "search_files") {
+            return reinterpret_cast<const char *>(start_search(args, error));
+        }
+        std::string result;
+        if (!run_tool(name, args, result, error)) {
             return nullptr;
         }
+        return strdup(result.c_str());
     } catch (const std::exception &e) {
         // Use MCPError to return error instead of constructing JSON string
         error->code = mcp::protocol::error_code::INTERNAL_ERROR;
@@ -111,4 +593,17 @@ extern "C" MCP_API void free_result(const char *result) {
     if (result) {
         std::free(const_cast<char *>(result));
     }
-}
\ No newline at end of file
+}
+
+// Export streaming functions, used by search_files
+extern "C" MCP_API StreamGeneratorNext get_stream_next() {
+    return search_stream_next;
+}
+
+extern "C" MCP_API StreamGeneratorFree get_stream_free() {
+    return search_stream_free;
+}
+
+extern "C" MCP_API StreamGeneratorCancel get_stream_cancel() {
+    return search_stream_cancel;
+}
@@ -0,0 +1,266 @@
+// plugins/official/file_plugin/text_search.cpp
+#include "text_search.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FILE_PLUGIN_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FILE_PLUGIN_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace file_plugin {
+
+    namespace {
+        constexpr std::size_t npos = std::string_view::npos;
+
+        char lower(char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        char upper(char c) {
+            return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+        }
+
+        /// Whether text at p equals the (lowercased) needle
+        bool equals(const char *p, std::string_view needle, bool ignore_case) {
+            if (!ignore_case) {
+                return std::memcmp(p, needle.data(), needle.size()) == 0;
+            }
+            for (std::size_t i = 0; i < needle.size(); ++i) {
+                if (lower(p[i]) != needle[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::size_t find_scalar(std::string_view text, std::size_t from, std::string_view needle, bool ignore_case) {
+            if (!ignore_case) {
+                return text.find(needle, from);
+            }
+            for (std::size_t i = from; i + needle.size() <= text.size(); ++i) {
+                if (lower(text[i]) == needle[0] && equals(text.data() + i, needle, true)) {
+                    return i;
+                }
+            }
+            return npos;
+        }
+
+#if defined(FILE_PLUGIN_AVX2)
+        __attribute__((target("avx2"))) std::size_t find_avx2(std::string_view text, std::size_t from, std::string_view needle, bool ignore_case) {
+            const std::size_t k = needle.size();
+            const __m256i first_lo = _mm256_set1_epi8(needle[0]);
+            const __m256i first_up = _mm256_set1_epi8(ignore_case ? upper(needle[0]) : needle[0]);
+            const __m256i last_lo = _mm256_set1_epi8(needle[k - 1]);
+            const __m256i last_up = _mm256_set1_epi8(ignore_case ? upper(needle[k - 1]) : needle[k - 1]);
+            std::size_t i = from;
+            for (; i + k - 1 + 32 <= text.size(); i += 32) {
+                const char *p = text.data() + i;
+                __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + k - 1));
+                __m256i first = _mm256_or_si256(_mm256_cmpeq_epi8(head, first_lo), _mm256_cmpeq_epi8(head, first_up));
+                __m256i last = _mm256_or_si256(_mm256_cmpeq_epi8(tail, last_lo), _mm256_cmpeq_epi8(tail, last_up));
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(first, last)));
+                while (mask) {
+                    unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+                    if (equals(p + bit, needle, ignore_case)) {
+                        return i + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return find_scalar(text, i, needle, ignore_case);
+        }
+#elif defined(FILE_PLUGIN_NEON)
+        std::size_t find_neon(std::string_view text, std::size_t from, std::string_view needle, bool ignore_case) {
+            const std::size_t k = needle.size();
+            const uint8x16_t first_lo = vdupq_n_u8(static_cast<uint8_t>(needle[0]));
+            const uint8x16_t first_up = vdupq_n_u8(static_cast<uint8_t>(ignore_case ? upper(needle[0]) : needle[0]));
+            const uint8x16_t last_lo = vdupq_n_u8(static_cast<uint8_t>(needle[k - 1]));
+            const uint8x16_t last_up = vdupq_n_u8(static_cast<uint8_t>(ignore_case ? upper(needle[k - 1]) : needle[k - 1]));
+            std::size_t i = from;
+            for (; i + k - 1 + 16 <= text.size(); i += 16) {
+                const char *p = text.data() + i;
+                uint8x16_t head = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+                uint8x16_t tail = vld1q_u8(reinterpret_cast<const uint8_t *>(p + k - 1));
+                uint8x16_t hits = vandq_u8(vorrq_u8(vceqq_u8(head, first_lo), vceqq_u8(head, first_up)),
+                                           vorrq_u8(vceqq_u8(tail, last_lo), vceqq_u8(tail, last_up)));
+                // Four bits per byte
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+                while (mask) {
+                    unsigned bit = static_cast<unsigned>(__builtin_ctzll(mask)) / 4;
+                    if (equals(p + bit, needle, ignore_case)) {
+                        return i + bit;
+                    }
+                    mask &= ~(uint64_t{0xf} << (bit * 4));
+                }
+            }
+            return find_scalar(text, i, needle, ignore_case);
+        }
+#endif
+
+        using FindFunc = std::size_t (*)(std::string_view, std::size_t, std::string_view, bool);
+
+        struct Finder {
+            FindFunc find = find_scalar;
+            const char *name = "scalar";
+        };
+
+        /// Picked once, from what the CPU running the process supports
+        const Finder &finder() {
+            static const Finder finder = [] {
+                Finder selected;
+#if defined(FILE_PLUGIN_AVX2)
+                if (__builtin_cpu_supports("avx2")) {
+                    selected = {find_avx2, "avx2"};
+                }
+#elif defined(FILE_PLUGIN_NEON)
+                selected = {find_neon, "neon"};
+#endif
+                return selected;
+            }();
+            return finder;
+        }
+
+        std::size_t line_start(std::string_view text, std::size_t pos) {
+            if (pos == 0) {
+                return 0;
+            }
+            auto start = text.rfind('\n', pos - 1);
+            return start == npos ? 0 : start + 1;
+        }
+
+        std::size_t line_end(std::string_view text, std::size_t pos) {
+            auto end = text.find('\n', pos);
+            return end == npos ? text.size() : end;
+        }
+
+        std::string_view trim_cr(std::string_view line) {
+            return !line.empty() && line.back() == '\r' ? line.substr(0, line.size() - 1) : line;
+        }
+    }// namespace
+
+    LiteralFinder::LiteralFinder(std::string needle, bool ignore_case) : needle_(std::move(needle)), ignore_case_(ignore_case) {
+        if (ignore_case_) {
+            std::transform(needle_.begin(), needle_.end(), needle_.begin(), lower);
+        }
+    }
+
+    std::size_t LiteralFinder::find(std::string_view text, std::size_t from) const {
+        if (needle_.empty()) {
+            return from <= text.size() ? from : npos;
+        }
+        if (from >= text.size() || text.size() - from < needle_.size()) {
+            return npos;
+        }
+        if (needle_.size() == 1 && !ignore_case_) {
+            return text.find(needle_[0], from);// memchr
+        }
+        return finder().find(text, from, needle_, ignore_case_);
+    }
+
+    const char *LiteralFinder::implementation() {
+        return finder().name;
+    }
+
+    std::size_t search_text(std::string_view text, const TextQuery &query, const std::function<bool(const LineMatch &)> &visit) {
+        std::size_t line = 1;
+        std::size_t counted = 0;// Newlines are counted up to here
+        auto report = [&](std::size_t start, std::size_t end, std::size_t column) {
+            line += static_cast<std::size_t>(std::count(text.begin() + static_cast<std::ptrdiff_t>(counted),
+                                                        text.begin() + static_cast<std::ptrdiff_t>(start), '\n'));
+            counted = start;
+            return visit(LineMatch{line, column + 1, trim_cr(text.substr(start, end - start))});
+        };
+
+        if (query.literal) {
+            for (std::size_t pos = query.literal->find(text); pos != npos && pos < text.size();) {
+                std::size_t start = line_start(text, pos);
+                std::size_t end = line_end(text, pos);
+                if (!report(start, end, pos - start) || end == text.size()) {
+                    return 0;
+                }
+                pos = query.literal->find(text, end + 1);
+            }
+            return 0;
+        }
+        if (!query.pattern) {
+            return 0;
+        }
+        std::size_t skipped = 0;
+        std::cmatch match;
+        for (std::size_t start = 0; start < text.size();) {
+            std::size_t end = line_end(text, start);
+            auto content = trim_cr(text.substr(start, end - start));
+            if (content.size() > kMaxRegexLineBytes) {
+                ++skipped;
+            } else if (std::regex_search(content.data(), content.data() + content.size(), match, *query.pattern) &&
+                       !report(start, end, static_cast<std::size_t>(match.position(0)))) {
+                return skipped;
+            }
+            start = end + 1;
+        }
+        return skipped;
+    }
+
+    std::unique_ptr<MappedRegion> MappedRegion::open(const std::string &path) {
+        std::unique_ptr<MappedRegion> region(new MappedRegion());
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return nullptr;
+        }
+        // An empty file cannot be mapped, it is an empty view
+        if (st.st_size > 0) {
+            void *data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                return nullptr;
+            }
+            region->bytes_ = std::string_view(static_cast<const char *>(data), static_cast<std::size_t>(st.st_size));
+#if defined(POSIX_MADV_SEQUENTIAL)
+            ::posix_madvise(data, region->bytes_.size(), POSIX_MADV_SEQUENTIAL);
+#endif
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return nullptr;
+        }
+        region->buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        region->bytes_ = region->buffer_;
+#endif
+        return region;
+    }
+
+    MappedRegion::~MappedRegion() {
+#if !defined(_WIN32)
+        if (!bytes_.empty()) ::munmap(const_cast<char *>(bytes_.data()), bytes_.size());
+#endif
+    }
+
+    bool looks_binary(std::string_view content) {
+        return content.substr(0, 8192).find('\0') != npos;
+    }
+
+}// namespace file_plugin
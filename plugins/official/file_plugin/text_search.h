@@ -0,0 +1,103 @@
+// plugins/official/file_plugin/text_search.h
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+namespace file_plugin {
+
+    /**
+     * @brief Finds a literal in text, ASCII letters optionally ignoring case.
+     *
+     * Candidates are found 32 or 16 bytes at a time by comparing the needle's first and last byte
+     * with AVX2 or NEON where the CPU has them, and only those are compared in full; elsewhere the
+     * scalar search of the standard library is used.
+     */
+    class LiteralFinder {
+    public:
+        LiteralFinder(std::string needle, bool ignore_case);
+
+        /**
+         * @brief Offset of the first occurrence at or after from, npos if there is none.
+         */
+        std::size_t find(std::string_view text, std::size_t from = 0) const;
+
+        std::size_t size() const { return needle_.size(); }
+
+        /**
+         * @brief Name of the code path picked for this CPU: "avx2", "neon" or "scalar".
+         */
+        static const char *implementation();
+
+    private:
+        std::string needle_;// Lowercased when ignoring case
+        bool ignore_case_;
+    };
+
+    /**
+     * @brief Line of a file holding a match.
+     */
+    struct LineMatch {
+        std::size_t line;     ///< 1-based
+        std::size_t column;   ///< 1-based byte offset of the match in the line
+        std::string_view text;///< The line, without its end
+    };
+
+    /**
+     * @brief What search_text() looks for: a literal, or a regular expression where one is given.
+     */
+    struct TextQuery {
+        std::optional<LiteralFinder> literal;
+        std::optional<std::regex> pattern;// ECMAScript, matched against one line at a time
+    };
+
+    /**
+     * @brief Longest line matched against a regular expression. std::regex recurses once per
+     * character, so a longer line, e.g. of a minified bundle, could overflow the stack.
+     */
+    constexpr std::size_t kMaxRegexLineBytes = 4096;
+
+    /**
+     * @brief Report the lines of text that match, in order, at most one match per line.
+     * @param visit Called per matching line; returns false to stop
+     * @return Lines skipped for being longer than kMaxRegexLineBytes, only with a regular expression
+     */
+    std::size_t search_text(std::string_view text, const TextQuery &query, const std::function<bool(const LineMatch &)> &visit);
+
+    /**
+     * @brief Read-only view of a whole file, mapped into memory where the platform allows it.
+     */
+    class MappedRegion {
+    public:
+        /**
+         * @brief Map a regular file.
+         * @return Region, or nullptr if the file cannot be opened
+         */
+        static std::unique_ptr<MappedRegion> open(const std::string &path);
+
+        ~MappedRegion();
+        MappedRegion(const MappedRegion &) = delete;
+        MappedRegion &operator=(const MappedRegion &) = delete;
+
+        std::string_view bytes() const { return bytes_; }
+
+    private:
+        MappedRegion() = default;
+
+        std::string_view bytes_;
+#if defined(_WIN32)
+        std::string buffer_;
+#endif
+    };
+
+    /**
+     * @brief Whether content looks binary: it has a NUL byte in its first 8 KiB.
+     */
+    bool looks_binary(std::string_view content);
+
+}// namespace file_plugin
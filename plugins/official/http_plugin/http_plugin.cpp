@@ -4,39 +4,292 @@
 #include "mcp_plugin.h"
 #include "protocol/json_rpc.h"
 #include "tool_info_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <regex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 static std::vector<ToolInfo> g_tools;
+static const MCPTraceSource *g_trace_source = nullptr;
+
+// traceparent of the traced call running on this thread, so the request is part of its trace
+static httplib::Headers trace_headers() {
+    httplib::Headers headers;
+    char traceparent[MCP_TRACEPARENT_SIZE];
+    if (g_trace_source && g_trace_source->traceparent(g_trace_source->context, traceparent, sizeof(traceparent)) > 0) {
+        headers.emplace("traceparent", traceparent);
+    }
+    return headers;
+}
+
+// Numeric setting from the environment, fallback if unset or not a number
+static size_t env_setting(const char *name, size_t fallback) {
+    const char *value = std::getenv(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    char *end = nullptr;
+    unsigned long long parsed = std::strtoull(value, &end, 10);
+    return *end == '\0' ? static_cast<size_t>(parsed) : fallback;
+}
+
+/**
+ * @brief Keep-alive clients per origin (scheme://host:port), reused across calls.
+ *
+ * A call leases a client, so a connection serves one request at a time; at most
+ * max_per_host are open per origin and further calls wait for one to come back. Idle
+ * connections older than idle_timeout are closed on the next lease. Host names are
+ * resolved once per dns_ttl and the address is handed to httplib, so a new connection
+ * to a known host skips the lookup; TLS still verifies the name.
+ *
+ * Settings come from the environment: MCP_HTTP_MAX_CONNECTIONS_PER_HOST (8),
+ * MCP_HTTP_IDLE_TIMEOUT_S (30) and MCP_HTTP_DNS_TTL_S (60, 0 disables the cache).
+ */
+class ConnectionPool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept { *this = std::move(other); }
+        Lease &operator=(Lease &&other) noexcept {
+            release();
+            pool_ = std::exchange(other.pool_, nullptr);
+            origin_ = std::move(other.origin_);
+            client_ = std::move(other.client_);
+            return *this;
+        }
+        ~Lease() { release(); }
+
+        httplib::Client *operator->() const { return client_.get(); }
+        httplib::Client &operator*() const { return *client_; }
+        explicit operator bool() const { return client_ != nullptr; }
+
+        // The connection failed; it is closed instead of going back to the pool
+        void discard() { client_.reset(); }
+
+    private:
+        friend class ConnectionPool;
+        void release() {
+            if (pool_) {
+                pool_->give_back(origin_, std::move(client_));
+                pool_ = nullptr;
+            }
+        }
+
+        ConnectionPool *pool_ = nullptr;
+        std::string origin_;
+        std::unique_ptr<httplib::Client> client_;
+    };
+
+    static ConnectionPool &instance() {
+        static ConnectionPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Take a connection to an origin, opening a client if none is idle.
+     * Waits while max_per_host connections to the origin are in use.
+     * @param scheme "http" or "https"
+     * @param authority host[:port] from the URL
+     */
+    Lease acquire(const std::string &scheme, const std::string &authority) {
+        std::string origin = scheme + "://" + authority;
+        Lease lease;
+        lease.pool_ = this;
+        lease.origin_ = origin;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        Host &host = hosts_[origin];
+        auto now = std::chrono::steady_clock::now();
+        // Servers drop idle keep-alive connections on their own schedule; old ones are not worth trying
+        std::erase_if(host.idle, [&](const Idle &idle) {
+            if (now - idle.since < idle_timeout_) {
+                return false;
+            }
+            ++host.expired;
+            return true;
+        });
+        host.available.wait(lock, [&] { return !host.idle.empty() || host.active < max_per_host_; });
+        ++host.active;
+        ++host.requests;
+        if (!host.idle.empty()) {
+            lease.client_ = std::move(host.idle.back().client);
+            host.idle.pop_back();
+            ++host.reused;
+            return lease;
+        }
+        ++host.opened;
+        lock.unlock();
+
+        // Opened outside the lock; the lookup may take a while
+        auto client = std::make_unique<httplib::Client>(origin);
+        client->set_keep_alive(true);
+        std::string name = host_name(authority);
+        std::string address = resolve(name);
+        if (!address.empty() && address != name) {
+            client->set_hostname_addr_map({{name, address}});
+        }
+        lease.client_ = std::move(client);
+        return lease;
+    }
+
+    /**
+     * @brief Connection and DNS counters per origin
+     */
+    nlohmann::json stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nlohmann::json hosts = nlohmann::json::object();
+        for (const auto &[origin, host]: hosts_) {
+            hosts[origin] = {{"active", host.active}, {"idle", host.idle.size()}, {"requests", host.requests},
+                             {"opened", host.opened}, {"reused", host.reused}, {"discarded", host.discarded},
+                             {"expired", host.expired}};
+        }
+        return {{"max_connections_per_host", max_per_host_},
+                {"idle_timeout_s", idle_timeout_.count()},
+                {"dns_ttl_s", dns_ttl_.count()},
+                {"dns_hits", dns_hits_},
+                {"dns_misses", dns_misses_},
+                {"hosts", std::move(hosts)}};
+    }
+
+private:
+    struct Idle {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct Host {
+        std::vector<Idle> idle;
+        size_t active = 0;
+        std::condition_variable available;
+        uint64_t requests = 0, opened = 0, reused = 0, discarded = 0, expired = 0;
+    };
+
+    struct CachedAddress {
+        std::string address;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    ConnectionPool()
+        : max_per_host_(std::max<size_t>(env_setting("MCP_HTTP_MAX_CONNECTIONS_PER_HOST", 8), 1)),
+          idle_timeout_(env_setting("MCP_HTTP_IDLE_TIMEOUT_S", 30)),
+          dns_ttl_(env_setting("MCP_HTTP_DNS_TTL_S", 60)) {}
+
+    void give_back(const std::string &origin, std::unique_ptr<httplib::Client> client) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Host &host = hosts_[origin];
+            --host.active;
+            if (client) {
+                host.idle.push_back({std::move(client), std::chrono::steady_clock::now()});
+            } else {
+                ++host.discarded;
+            }
+            host.available.notify_one();
+        }
+    }
+
+    // Host name of an authority: without the port, and without the brackets of an IPv6 literal
+    static std::string host_name(const std::string &authority) {
+        if (!authority.empty() && authority.front() == '[') {
+            return authority.substr(1, authority.find(']') - 1);
+        }
+        return authority.substr(0, authority.rfind(':'));
+    }
+
+    /**
+     * @brief Address of a host name, from the cache while it is fresh.
+     * @return Numeric address, empty to let httplib resolve it itself
+     */
+    std::string resolve(const std::string &name) {
+        if (dns_ttl_.count() == 0 || name.empty()) {
+            return {};
+        }
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto cached = addresses_.find(name);
+            if (cached != addresses_.end() && now < cached->second.expires) {
+                ++dns_hits_;
+                return cached->second.address;
+            }
+            ++dns_misses_;
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *result = nullptr;
+        if (getaddrinfo(name.c_str(), nullptr, &hints, &result) != 0 || !result) {
+            return {};
+        }
+        char address[NI_MAXHOST];
+        bool ok = getnameinfo(result->ai_addr, static_cast<socklen_t>(result->ai_addrlen), address, sizeof(address),
+                              nullptr, 0, NI_NUMERICHOST) == 0;
+        freeaddrinfo(result);
+        if (!ok) {
+            return {};
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        addresses_[name] = {address, now + dns_ttl_};
+        return address;
+    }
+
+    const size_t max_per_host_;
+    const std::chrono::seconds idle_timeout_;
+    const std::chrono::seconds dns_ttl_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Host> hosts_;
+    std::unordered_map<std::string, CachedAddress> addresses_;
+    uint64_t dns_hits_ = 0, dns_misses_ = 0;
+};
+
+// Split a URL into scheme, authority and path; false if it is not an http(s) URL
+static bool parse_url(const std::string &url, std::string &scheme, std::string &authority, std::string &path) {
+    static const std::regex url_regex(R"(^(https?)://([^/]+)(/.*)?$)");
+    std::smatch url_match;
+    if (!std::regex_match(url, url_match, url_regex)) {
+        return false;
+    }
+    scheme = url_match[1];
+    authority = url_match[2];
+    path = url_match[3];
+    // Default path is "/"
+    if (path.empty()) {
+        path = "/";
+    }
+    return true;
+}
 
 // Send HTTP GET request
 static std::string http_get(const std::string &url) {
     try {
         // Parse URL to extract scheme, host, port, and path
-        std::regex url_regex(R"(^(https?)://([^/]+)(/.*)?$)");
-        std::smatch url_match;
-
-        if (!std::regex_match(url, url_match, url_regex)) {
+        std::string scheme, host, path;
+        if (!parse_url(url, scheme, host, path)) {
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "Invalid URL format");
         }
 
-        std::string scheme = url_match[1];
-        std::string host = url_match[2];
-        std::string path = url_match[3];
+        // Pooled keep-alive connection to the origin
+        auto client = ConnectionPool::instance().acquire(scheme, host);
 
-        // Default path is "/"
-        if (path.empty()) {
-            path = "/";
-        }
-
-        // Create client with proper scheme and host
-        std::string client_url = scheme + "://" + host;
-        httplib::Client client(client_url.c_str());
-
-        auto res = client.Get(path.c_str());
+        auto res = client->Get(path.c_str(), trace_headers());
         if (!res) {
+            client.discard();
             // Return custom error code and message, consistent with safe_system_plugin
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND,
                                                  "Request failed: Network error or invalid URL");
@@ -55,28 +308,17 @@ static std::string http_get(const std::string &url) {
 static std::string http_post(const std::string &url, const std::string &body) {
     try {
         // Parse URL to extract scheme, host, port, and path
-        std::regex url_regex(R"(^(https?)://([^/]+)(/.*)?$)");
-        std::smatch url_match;
-
-        if (!std::regex_match(url, url_match, url_regex)) {
+        std::string scheme, host, path;
+        if (!parse_url(url, scheme, host, path)) {
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "Invalid URL format");
         }
 
-        std::string scheme = url_match[1];
-        std::string host = url_match[2];
-        std::string path = url_match[3];
-
-        // Default path is "/"
-        if (path.empty()) {
-            path = "/";
-        }
-
-        // Create client with proper scheme and host
-        std::string client_url = scheme + "://" + host;
-        httplib::Client client(client_url.c_str());
+        // Pooled keep-alive connection to the origin
+        auto client = ConnectionPool::instance().acquire(scheme, host);
 
-        auto res = client.Post(path.c_str(), body, "application/json");
+        auto res = client->Post(path.c_str(), trace_headers(), body, "application/json");
         if (!res) {
+            client.discard();
             // Return custom error code and message, consistent with safe_system_plugin
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND,
                                                  "Request failed: Network error or invalid URL");
@@ -91,7 +333,171 @@ static std::string http_post(const std::string &url, const std::string &body) {
     }
 }
 
+/**
+ * @brief Streaming GET: the response body is handed out in chunks as it arrives.
+ *
+ * The request runs on a thread of its own, on a pooled connection; its content receiver
+ * fills a queue of at most kMaxQueuedChunks and waits while it is full, so a slow client
+ * slows the download instead of buffering it. Chunks end on UTF-8 character boundaries.
+ */
+struct HttpStream {
+    static constexpr size_t kMaxQueuedChunks = 16;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::string> chunks;
+    std::string partial;      // Start of a UTF-8 character split by the last chunk
+    bool finished = false;    // The request returned
+    bool cancelled = false;   // Set by cancel and free, stops the download
+    int status = 0;           // HTTP status, 0 if the request failed
+    std::string error;        // Why the request failed
+    size_t bytes = 0;
+    std::string current;      // Item handed out by the last next()
+    httplib::Client *client = nullptr;// Set while the request runs, so cancel can abort a blocked read
+    std::thread worker;
+
+    void run(ConnectionPool::Lease lease, std::string path, httplib::Headers headers) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cancelled) {
+                return;
+            }
+            client = &*lease;
+        }
+        auto res = lease->Get(
+                path.c_str(), headers,
+                [this](const httplib::Response &response) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    status = response.status;
+                    return !cancelled;
+                },
+                [this](const char *data, size_t size) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [this] { return chunks.size() < kMaxQueuedChunks || cancelled; });
+                    if (cancelled) {
+                        return false;
+                    }
+                    std::string chunk = std::move(partial);
+                    chunk.append(data, size);
+                    // Hold back an incomplete trailing character for the next chunk
+                    size_t end = chunk.size();
+                    size_t start = end;
+                    while (start > 0 && end - start < 4 && (static_cast<unsigned char>(chunk[start - 1]) & 0xC0) == 0x80) {
+                        --start;
+                    }
+                    if (start > 0) {
+                        auto lead = static_cast<unsigned char>(chunk[start - 1]);
+                        size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+                        if (end - (start - 1) < length) {
+                            partial = chunk.substr(start - 1);
+                            chunk.resize(start - 1);
+                        }
+                    }
+                    bytes += size;
+                    if (!chunk.empty()) {
+                        chunks.push_back(std::move(chunk));
+                        changed.notify_all();
+                    }
+                    return true;
+                });
+
+        std::lock_guard<std::mutex> lock(mutex);
+        client = nullptr;
+        if (!res || cancelled) {
+            lease.discard();// A stopped connection is not reused
+        }
+        if (!res) {
+            if (!cancelled) {
+                error = "Request failed: " + httplib::to_string(res.error());
+            }
+        } else {
+            status = res->status;
+        }
+        if (!partial.empty()) {
+            chunks.push_back(std::move(partial));
+        }
+        finished = true;
+        changed.notify_all();
+    }
+
+    int next(const char **result_json) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return !chunks.empty() || finished || cancelled; });
+        if (!chunks.empty()) {
+            current = nlohmann::json{
+                    {"jsonrpc", "2.0"},
+                    {"method", "http_chunk"},
+                    {"params", nlohmann::json{{"data", std::move(chunks.front())}}}}
+                              .dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            chunks.pop_front();
+            changed.notify_all();
+            *result_json = current.c_str();
+            return 0;
+        }
+        if (cancelled) {
+            *result_json = nullptr;
+            return 1;
+        }
+        if (!error.empty()) {
+            current = nlohmann::json{{"error", {{"code", mcp::protocol::error_code::INTERNAL_ERROR}, {"message", error}}}}.dump();
+            *result_json = current.c_str();
+            return -1;
+        }
+        // The status and size close the stream; the end itself carries no data
+        if (status != 0) {
+            current = nlohmann::json{
+                    {"jsonrpc", "2.0"},
+                    {"method", "http_done"},
+                    {"params", nlohmann::json{{"status", status}, {"bytes", bytes}}}}
+                              .dump();
+            status = 0;
+            *result_json = current.c_str();
+            return 0;
+        }
+        *result_json = nullptr;
+        return 1;
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        if (client) {
+            client->stop();
+        }
+        changed.notify_all();
+    }
+
+    ~HttpStream() {
+        cancel();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+};
+
+static int http_stream_next(StreamGenerator generator, const char **result_json, MCPError * /*error*/) {
+    if (!generator) {
+        *result_json = nullptr;
+        return 1;
+    }
+    return static_cast<HttpStream *>(generator)->next(result_json);
+}
+
+static void http_stream_free(StreamGenerator generator) {
+    delete static_cast<HttpStream *>(generator);
+}
+
+static void http_stream_cancel(StreamGenerator generator) {
+    if (generator) {
+        static_cast<HttpStream *>(generator)->cancel();
+    }
+}
+
 // Export functions
+extern "C" MCP_API void mcp_plugin_set_trace_source(const MCPTraceSource *source) {
+    g_trace_source = source;
+}
+
 extern "C" MCP_API ToolInfo *get_tools(int *count) {
     try {
         if (g_tools.empty()) {
@@ -106,6 +512,18 @@ extern "C" MCP_API ToolInfo *get_tools(int *count) {
     }
 }
 
+extern "C" MCP_API StreamGeneratorNext get_stream_next() {
+    return http_stream_next;
+}
+
+extern "C" MCP_API StreamGeneratorFree get_stream_free() {
+    return http_stream_free;
+}
+
+extern "C" MCP_API StreamGeneratorCancel get_stream_cancel() {
+    return http_stream_cancel;
+}
+
 extern "C" MCP_API const char *call_tool(const char *name, const char *args_json, MCPError *error) {
     try {
         auto args = nlohmann::json::parse(args_json);
@@ -132,6 +550,21 @@ extern "C" MCP_API const char *call_tool(const char *name, const char *args_json
             }
             std::string result = http_post(url, body);
             return strdup(result.c_str());
+        } else if (tool_name == "http_get_stream") {
+            std::string scheme, host, path;
+            if (!parse_url(args.value("url", ""), scheme, host, path)) {
+                error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+                error->message = "Missing or invalid 'url' parameter";
+                return nullptr;
+            }
+            // The trace context is read here, on the calling thread, not on the download thread
+            auto *stream = new HttpStream();
+            stream->worker = std::thread(&HttpStream::run, stream, ConnectionPool::instance().acquire(scheme, host),
+                                         std::move(path), trace_headers());
+            return reinterpret_cast<const char *>(stream);
+        } else if (tool_name == "http_pool_stats") {
+            std::string result = mcp::protocol::generate_result(ConnectionPool::instance().stats());
+            return strdup(result.c_str());
         } else {
             // Use MCPError to return error instead of constructing JSON string
             error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
@@ -150,4 +583,4 @@ extern "C" MCP_API void free_result(const char *result) {
     if (result) {
         std::free(const_cast<char *>(result));
     }
-}
\ No newline at end of file
+}
@@ -41,7 +41,7 @@ sdk_path = find_sdk_path()
 sys.path.insert(0, sdk_path)
 
 try:
-    from mcp_sdk import tool, string_param, call_tool, get_tools
+    from mcp_sdk import tool, string_param, integer_param, ToolType, call_tool, call_tool_object, start_stream, get_tools
 except ImportError as e:
     # Create a fallback implementation for testing
     print(f"Warning: Could not import mcp_sdk: {e}")
@@ -59,6 +59,14 @@ except ImportError as e:
     def string_param(description="", required=False, default=None):
         return {"type": "string", "description": description, 
                 "required": required, "default": default}
+
+    def integer_param(description="", required=False, default=None):
+        return {"type": "integer", "description": description,
+                "required": required, "default": default}
+
+    class ToolType:
+        STANDARD = "standard"
+        STREAMING = "streaming"
     
     # Fallback functions that mimic the real interface
     def get_tools():
@@ -92,6 +100,17 @@ def calculate_tool(expression: str) -> str:
     except Exception as e:
         return f"Error: {str(e)}"
 
+@tool(
+    name="python_count",
+    description="Stream the numbers from 0 up to count",
+    tool_type=ToolType.STREAMING,
+    count=integer_param(description="Number of events", default=5)
+)
+def count_tool(count: int = 5):
+    """Stream count events"""
+    for i in range(count):
+        yield {"index": i}
+
 # For testing purposes when running the script directly
 if __name__ == "__main__":
     # This section is for testing the plugin directly
@@ -1,3 +1,4 @@
+#include "business/plugin_error.h"
 #include "core/mcpserver_api.h"
 #include "mcp_plugin.h"
 #include "protocol/json_rpc.h"
@@ -6,25 +7,195 @@
 // Platform-specific includes for process handling
 #ifdef _WIN32
 #include <io.h>// For _popen, _pclose on Windows
+#include <stdio.h>
 #define popen _popen
 #define pclose _pclose
 #else
-#include <stdio.h>// For popen, pclose on Unix-like systems
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>// posix_spawn starts commands without copying the server's address space
+#include <sys/wait.h>
+#include <unistd.h>
+// Command streams are read on the server's event loop, woken up by the output pipe
+#define SAFE_SYSTEM_NONBLOCKING 1
+extern char **environ;
 #endif
 
 #include <algorithm>// For std::all_of
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <nlohmann/json.hpp>
 #include <sstream>
+#include <string>
+#include <vector>
 
 
 // Global storage for tool metadata
 static std::vector<ToolInfo> g_tools;
 
+// Output limits: a command printing more is stopped, a longer line is sent in pieces
+static constexpr size_t kMaxOutputBytes = 1024 * 1024;
+static constexpr size_t kMaxLineBytes = 4096;
+
+/**
+ * @brief Output of a finished command
+ */
+struct CommandOutput {
+    std::string text;      // stdout and stderr, interleaved
+    bool truncated = false;// Stopped after kMaxOutputBytes
+    int exit_code = -1;    // -1 if it could not be started or was killed
+};
+
+#ifndef _WIN32
+/**
+ * @brief A running command whose stdout and stderr go to a pipe
+ */
+struct ChildProcess {
+    pid_t pid = -1;
+    int output_fd = -1;// Read end of the pipe
+
+    ChildProcess() = default;
+    ChildProcess(const ChildProcess &) = delete;
+    ChildProcess &operator=(const ChildProcess &) = delete;
+    ~ChildProcess() { finish(true); }
+
+    /**
+     * @brief Reap the process, killing it first if asked.
+     * @return Exit code, -1 if it was killed by a signal
+     */
+    int finish(bool kill_first) {
+        if (output_fd >= 0) {
+            close(output_fd);
+            output_fd = -1;
+        }
+        int status = 0;
+        if (pid > 0) {
+            if (kill_first) {
+                kill(pid, SIGKILL);
+            }
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+            pid = -1;
+        }
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+};
+
+/**
+ * @brief Start a command directly, without a shell
+ *
+ * posix_spawn runs the child on the parent's memory until exec (vfork semantics in glibc and
+ * the BSDs), so starting it costs the same in a large server as in a small one.
+ * @param argv Program, looked up in PATH, and its arguments
+ * @param child Filled in on success
+ * @param nonblocking Make the read end of the pipe non-blocking
+ * @return Empty on success, otherwise the reason
+ */
+static std::string spawn_command(const std::vector<std::string> &argv, ChildProcess &child, bool nonblocking) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return std::string("pipe creation failed: ") + std::strerror(errno);
+    }
+    if (nonblocking) {
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+
+    // The server ignores SIGPIPE and its threads may block signals; the command gets the defaults
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaults, mask;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGCHLD);
+    sigemptyset(&mask);
+    posix_spawnattr_setsigdefault(&attributes, &defaults);
+    posix_spawnattr_setsigmask(&attributes, &mask);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    std::vector<char *> args;
+    for (const auto &arg: argv) {
+        args.push_back(const_cast<char *>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+    int rc = posix_spawnp(&child.pid, args[0], &actions, &attributes, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    close(fds[1]);
+    if (rc != 0) {
+        close(fds[0]);
+        child.pid = -1;
+        return argv[0] + ": " + std::strerror(rc);
+    }
+    child.output_fd = fds[0];
+    return {};
+}
+#endif
+
+/**
+ * @brief Run a command to completion and collect its output, at most kMaxOutputBytes of it
+ * @param argv Program and its arguments, passed without a shell where the platform allows
+ * @param error Set if the command could not be started
+ * @return Output and exit code
+ */
+static CommandOutput run_command(const std::vector<std::string> &argv, std::string &error) {
+    CommandOutput output;
+    std::array<char, 4096> buffer;
+#ifdef _WIN32
+    // No posix_spawn here; popen() goes through cmd.exe, so arguments are quoted for it
+    std::string cmd = argv[0];
+    for (size_t i = 1; i < argv.size(); ++i) {
+        cmd += argv[i].find(' ') != std::string::npos ? " \"" + argv[i] + "\"" : " " + argv[i];
+    }
+    FILE *pipe = popen(cmd.c_str(), "r");
+    if (!pipe) {
+        error = "pipe creation failed";
+        return output;
+    }
+    size_t read;
+    while ((read = fread(buffer.data(), 1, buffer.size(), pipe)) > 0) {
+        output.text.append(buffer.data(), std::min(read, kMaxOutputBytes - output.text.size()));
+        if (output.text.size() >= kMaxOutputBytes) {
+            output.truncated = true;
+            break;
+        }
+    }
+    output.exit_code = pclose(pipe);
+#else
+    ChildProcess child;
+    error = spawn_command(argv, child, false);
+    if (!error.empty()) {
+        return output;
+    }
+    while (true) {
+        ssize_t read = ::read(child.output_fd, buffer.data(), buffer.size());
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            break;
+        }
+        output.text.append(buffer.data(), std::min(static_cast<size_t>(read), kMaxOutputBytes - output.text.size()));
+        if (output.text.size() >= kMaxOutputBytes) {
+            output.truncated = true;
+            break;
+        }
+    }
+    output.exit_code = child.finish(output.truncated);
+#endif
+    return output;
+}
+
 /**
  * @brief Retrieves current system time as JSON string
  * @return JSON string containing current time
@@ -81,28 +252,22 @@ static std::string list_files(const std::string &path) {
                                                  "Path traversal is not allowed");
         }
 
-        std::array<char, 128> buffer;
-        std::string result;
-
-        // Platform-specific directory listing command
+        // Platform-specific directory listing command; the path is a single argument, never parsed by a shell
 #ifdef _WIN32
-        std::string cmd = "dir \"" + path + "\" /b";// Windows: bare format listing
+        std::vector<std::string> cmd = {"dir", path, "/b"};// Windows: bare format listing
 #else
-        std::string cmd = "ls \"" + path + "\"";// Unix: simple listing
+        std::vector<std::string> cmd = {"ls", "--", path};// Unix: simple listing
 #endif
 
         // Execute command and capture output
-        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
-        if (!pipe) {
+        std::string spawn_error;
+        CommandOutput output = run_command(cmd, spawn_error);
+        if (!spawn_error.empty()) {
             // Return custom error code and message
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND,
-                                                 "Failed to list files: Pipe creation failed");
-        }
-
-        // Read command output
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
+                                                 "Failed to list files: " + spawn_error);
         }
+        std::string result = std::move(output.text);
 
         // Return raw business data
         return mcp::protocol::generate_result(nlohmann::json{{"files", result}});
@@ -129,28 +294,22 @@ static std::string ping_host(const std::string &host) {
                                                  "Invalid host name format");
         }
 
-        std::array<char, 128> buffer;
-        std::string result;
-
         // Platform-specific ping command
 #ifdef _WIN32
-        std::string cmd = "ping -n 1 -w 1000 " + host;// Windows: 1 packet, 1s timeout
+        std::vector<std::string> cmd = {"ping", "-n", "1", "-w", "1000", host};// Windows: 1 packet, 1s timeout
 #else
-        std::string cmd = "ping -c 1 -W 1 " + host;// Unix: 1 packet, 1s timeout
+        std::vector<std::string> cmd = {"ping", "-c", "1", "-W", "1", host};// Unix: 1 packet, 1s timeout
 #endif
 
         // Execute ping command
-        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
-        if (!pipe) {
+        std::string spawn_error;
+        CommandOutput output = run_command(cmd, spawn_error);
+        if (!spawn_error.empty()) {
             // Return custom error code and message
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND,
-                                                 "Ping command failed: Pipe creation failed");
-        }
-
-        // Read ping output
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
+                                                 "Ping command failed: " + spawn_error);
         }
+        std::string result = std::move(output.text);
 
         // Determine success status from output
         bool success = result.find("TTL=") != std::string::npos ||
@@ -185,54 +344,37 @@ static std::string check_connectivity() {
  */
 static std::string get_public_ip() {
     try {
-        std::array<char, 128> buffer;
-        std::string ip;
+        // First line of a command's output, without the newline
+        auto first_line = [](const std::vector<std::string> &cmd, std::string &spawn_error) {
+            std::string line = run_command(cmd, spawn_error).text;
+            line.erase(std::min(line.find('\n'), line.size()));
+            return line;
+        };
 
         // In China, you can try some domestic - accessible IP query services,
         // such as ipip.net. Here we still use curl to get the IP,
         // and you can also use other domestic - oriented IP query APIs in the future.
-#ifdef _WIN32
-        // For Windows, the following command can be used to try to get the public IP
-        // You can change the URL to other valid ones, such as curl ipinfo.io
-        std::string cmd = "curl -s myip.ipip.net";
-#else
-        // For non - Windows systems (like Linux, macOS), the command format is similar
-        std::string cmd = "curl -s myip.ipip.net";
-#endif
+        // The same command works on Windows and on Unix-like systems;
+        // you can change the URL to other valid ones, such as curl ipinfo.io
+        std::vector<std::string> cmd = {"curl", "-s", "myip.ipip.net"};
 
-        // Use popen to execute the command and get the result
-        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
-        if (!pipe) {
+        std::string spawn_error;
+        std::string ip = first_line(cmd, spawn_error);
+        if (!spawn_error.empty()) {
             // Return custom error code and message
             return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND, "curl command not found");
         }
 
-        if (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            ip = buffer.data();
-            // Remove newline characters
-            ip.erase(std::remove(ip.begin(), ip.end(), '\n'), ip.end());
-        }
-
         if (!ip.empty() && ip.find('.') != std::string::npos) {
             return mcp::protocol::generate_result(nlohmann::json{{"public_ip", ip}});
         } else {
-// If the IP is not obtained correctly, return an error message
-// Try to use foreign - accessible IP query services
-#ifdef _WIN32
-            std::string foreign_cmd = "curl -s https://api.ipify.org";
-#else
-            std::string foreign_cmd = "curl -s https://api.ipify.org";
-#endif
-            std::unique_ptr<FILE, decltype(&pclose)> foreign_pipe(popen(foreign_cmd.c_str(), "r"), pclose);
-            if (!foreign_pipe) {
+            // If the IP is not obtained correctly, try to use foreign - accessible IP query services
+            std::vector<std::string> foreign_cmd = {"curl", "-s", "https://api.ipify.org"};
+            ip = first_line(foreign_cmd, spawn_error);
+            if (!spawn_error.empty()) {
                 return mcp::protocol::generate_error(mcp::protocol::error_code::TOOL_NOT_FOUND,
                                                      "curl command not found when trying foreign service");
             }
-            std::array<char, 128> foreign_buffer;
-            if (fgets(foreign_buffer.data(), foreign_buffer.size(), foreign_pipe.get()) != nullptr) {
-                ip = foreign_buffer.data();
-                ip.erase(std::remove(ip.begin(), ip.end(), '\n'), ip.end());
-            }
             if (!ip.empty() && ip.find('.') != std::string::npos) {
                 return mcp::protocol::generate_result(nlohmann::json{{"public_ip", ip}});
             } else {
@@ -266,86 +408,298 @@ extern "C" MCP_API ToolInfo *get_tools(int *count) {
     }
 }
 
+/**
+ * @brief State of a streaming tool; the stream functions below dispatch on it
+ */
+struct StreamState {
+    virtual ~StreamState() = default;
+    virtual int next(const char **result_json) = 0;
+    virtual int wait() { return -1; }
+    virtual void cancel() {}
+};
+
 /**
  * @brief Structure to manage log file streaming state
  */
-struct LogFileGenerator {
+struct LogFileGenerator : StreamState {
     std::ifstream file; // Log file stream
     bool running = true;// Streaming state flag
     std::string error;  // Error message storage
+    std::string buffer; // Item handed out by the last next()
+
+    /**
+     * @brief Retrieves next line from streaming log file
+     * @return 0 on success, 1 on completion/error
+     */
+    int next(const char **result_json) override {
+        // Return stored error if exists
+        if (!error.empty()) {
+            *result_json = error.c_str();
+            return 1;
+        }
+
+        // Check for streaming completion
+        if (!running || file.eof()) {
+            *result_json = nullptr;
+            return 1;
+        }
+
+        // Read next line from log file
+        std::string line;
+        if (std::getline(file, line)) {
+            buffer = nlohmann::json{
+                    {"jsonrpc", "2.0"},
+                    {"method", "log_line"},
+                    {"params", nlohmann::json{{"content", line}}}}
+                             .dump();
+            *result_json = buffer.c_str();
+            return 0;
+        }
+        *result_json = nullptr;
+        return 1;
+    }
+
+    void cancel() override { running = false; }
 };
 
 /**
- * @brief Retrieves next line from streaming log file
- * @param generator Pointer to LogFileGenerator instance
- * @param result_json Output parameter for JSON result
- * @return 0 on success, 1 on completion/error
+ * @brief Structure to manage the output stream of a running command
+ *
+ * Each item is one line of output (longer lines are split at kMaxLineBytes), the last one
+ * the exit code. With SAFE_SYSTEM_NONBLOCKING the pipe is non-blocking and next() returns
+ * MCP_STREAM_WOULD_BLOCK until a line is complete; otherwise next() blocks in fgets().
  */
-static int log_file_next(StreamGenerator generator, const char **result_json, MCPError *error) {
-    if (!generator) {
-        static thread_local std::string buffer = nlohmann::json{{"error", "Invalid generator pointer"}}.dump();
-        *result_json = buffer.c_str();
-        return 1;
+struct CommandGenerator : StreamState {
+#ifdef SAFE_SYSTEM_NONBLOCKING
+    ChildProcess child;
+#else
+    FILE *pipe = nullptr;
+#endif
+    std::string pending;              // Output read but not sent yet
+    bool eof = false;                 // The command closed its output
+    bool done = false;                // Exit code sent
+    size_t total = 0;                 // Output bytes so far, capped at kMaxOutputBytes
+    std::atomic<bool> cancelled{false};
+    std::string buffer;               // Item handed out by the last next()
+
+#ifndef SAFE_SYSTEM_NONBLOCKING
+    ~CommandGenerator() override {
+        if (pipe) {
+            pclose(pipe);
+        }
     }
+#endif
 
-    auto *gen = static_cast<LogFileGenerator *>(generator);
+    int next(const char **result_json) override {
+        *result_json = nullptr;
+        if (done || cancelled) {
+            return 1;
+        }
+        size_t line_end;
+        while ((line_end = pending.find('\n')) == std::string::npos && pending.size() < kMaxLineBytes && !eof) {
+            int status = fill();
+            if (status != 0) {
+                return status;
+            }
+        }
+
+        if (!pending.empty()) {
+            size_t size = std::min(line_end == std::string::npos ? pending.size() : line_end, kMaxLineBytes);
+            std::string line = pending.substr(0, size);
+            pending.erase(0, line_end == size ? size + 1 : size);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            buffer = nlohmann::json{
+                    {"jsonrpc", "2.0"},
+                    {"method", "command_output"},
+                    {"params", nlohmann::json{{"line", line}}}}
+                             .dump();
+            *result_json = buffer.c_str();
+            return 0;
+        }
 
-    // Return stored error if exists
-    if (!gen->error.empty()) {
-        static thread_local std::string buffer = gen->error;
+        // All output sent; the exit code is the last item
+#ifdef SAFE_SYSTEM_NONBLOCKING
+        int status = 0;
+        pid_t reaped = child.pid > 0 ? waitpid(child.pid, &status, WNOHANG) : -1;
+        if (reaped == 0) {
+            return MCP_STREAM_WOULD_BLOCK;// Closed its output but still running; the server polls again
+        }
+        child.pid = -1;
+        int exit_code = reaped > 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        child.finish(false);
+#else
+        int exit_code = pclose(pipe);
+        pipe = nullptr;
+#endif
+        done = true;
+        buffer = nlohmann::json{
+                {"jsonrpc", "2.0"},
+                {"method", "command_exit"},
+                {"params", nlohmann::json{{"exit_code", exit_code}, {"truncated", total >= kMaxOutputBytes}}}}
+                         .dump();
         *result_json = buffer.c_str();
-        return 1;
+        return 0;
     }
 
-    // Check for streaming completion
-    if (!gen->running || gen->file.eof()) {
-        *result_json = nullptr;
-        return 1;
+#ifdef SAFE_SYSTEM_NONBLOCKING
+    // The pipe becomes readable with more output or at the end; after the end there is nothing to wait on
+    int wait() override { return eof ? -1 : child.output_fd; }
+
+    void cancel() override {
+        cancelled = true;
+        if (child.pid > 0) {
+            kill(child.pid, SIGTERM);
+        }
     }
+#else
+    void cancel() override { cancelled = true; }
+#endif
 
-    // Read next line from log file
-    std::string line;
-    if (std::getline(gen->file, line)) {
-        static thread_local std::string buffer = nlohmann::json{
-                {"jsonrpc", "2.0"},
-                {"method", "log_line"},
-                {"params", nlohmann::json{{"content", line}}}}
-                                                         .dump();
-        *result_json = buffer.c_str();
+private:
+    /**
+     * @brief Read what the command has written so far, at most one line's worth
+     * @return 0 if pending or eof changed, MCP_STREAM_WOULD_BLOCK if there is nothing yet
+     */
+    int fill() {
+        std::array<char, kMaxLineBytes> chunk;
+        size_t room = std::min(chunk.size(), kMaxOutputBytes - total);
+        if (room == 0) {
+            // Output limit reached; what follows is dropped and the command stopped
+            eof = true;
+#ifdef SAFE_SYSTEM_NONBLOCKING
+            kill(child.pid, SIGKILL);
+#endif
+            return 0;
+        }
+#ifdef SAFE_SYSTEM_NONBLOCKING
+        ssize_t read = ::read(child.output_fd, chunk.data(), room);
+        if (read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return MCP_STREAM_WOULD_BLOCK;
+        }
+        if (read < 0 && errno == EINTR) {
+            return 0;
+        }
+        if (read <= 0) {
+            eof = true;
+            return 0;
+        }
+        size_t size = static_cast<size_t>(read);
+#else
+        if (!fgets(chunk.data(), static_cast<int>(room), pipe)) {
+            eof = true;
+            return 0;
+        }
+        size_t size = std::strlen(chunk.data());
+#endif
+        pending.append(chunk.data(), size);
+        total += size;
         return 0;
     }
-    return 1;
+};
+
+/**
+ * @brief Retrieves next item of a streaming tool
+ * @param generator Pointer to a StreamState instance
+ * @param result_json Output parameter for JSON result
+ * @return 0 on success, 1 on completion/error, MCP_STREAM_WOULD_BLOCK if a command has no new output yet
+ */
+static int stream_next(StreamGenerator generator, const char **result_json, MCPError * /*error*/) {
+    if (!generator) {
+        static const std::string buffer = nlohmann::json{{"error", "Invalid generator pointer"}}.dump();
+        *result_json = buffer.c_str();
+        return 1;
+    }
+    return static_cast<StreamState *>(generator)->next(result_json);
 }
 
 /**
- * @brief Cleans up log file streaming resources
- * @param generator Pointer to LogFileGenerator instance
+ * @brief Cleans up streaming resources, stopping a command that is still running
+ * @param generator Pointer to a StreamState instance
  */
-static void log_file_free(StreamGenerator generator) {
-    auto *gen = static_cast<LogFileGenerator *>(generator);
-    if (gen) {
-        gen->running = false;
-        if (gen->file.is_open()) {
-            gen->file.close();
-        }
-        delete gen;
+static void stream_free(StreamGenerator generator) {
+    delete static_cast<StreamState *>(generator);
+}
+
+/**
+ * @brief Stops a stream on behalf of the client
+ * @param generator Pointer to a StreamState instance
+ */
+static void stream_cancel(StreamGenerator generator) {
+    if (generator) {
+        static_cast<StreamState *>(generator)->cancel();
     }
 }
 
 /**
  * @brief Plugin entry: Returns stream next function
- * @return Pointer to log_file_next function
+ * @return Pointer to stream_next function
  */
 extern "C" MCP_API StreamGeneratorNext get_stream_next() {
-    return log_file_next;
+    return stream_next;
 }
 
 /**
  * @brief Plugin entry: Returns stream cleanup function
- * @return Pointer to log_file_free function
+ * @return Pointer to stream_free function
  */
 extern "C" MCP_API StreamGeneratorFree get_stream_free() {
-    return log_file_free;
+    return stream_free;
+}
+
+/**
+ * @brief Plugin entry: Returns stream cancel function
+ * @return Pointer to stream_cancel function
+ */
+extern "C" MCP_API StreamGeneratorCancel get_stream_cancel() {
+    return stream_cancel;
+}
+
+#ifdef SAFE_SYSTEM_NONBLOCKING
+/**
+ * @brief Tells the server when a stream can make progress
+ * @param generator Pointer to a StreamState instance
+ * @return Descriptor that becomes readable with more output, -1 to be polled
+ */
+static int stream_wait(StreamGenerator generator, MCPStreamWakeup /*wakeup*/, void * /*context*/) {
+    return generator ? static_cast<StreamState *>(generator)->wait() : -1;
+}
+
+/**
+ * @brief Plugin entry: Returns stream wait function
+ * @return Pointer to stream_wait function
+ */
+extern "C" MCP_API StreamGeneratorWait get_stream_wait() {
+    return stream_wait;
+}
+#endif
+
+/**
+ * @brief Starts a command whose output is streamed line by line
+ * @param cmd Program and its arguments
+ * @param error Set if the command could not be started
+ * @return Generator, nullptr on error
+ */
+static CommandGenerator *start_command_stream(const std::vector<std::string> &cmd, std::string &error) {
+    auto gen = std::make_unique<CommandGenerator>();
+#ifdef SAFE_SYSTEM_NONBLOCKING
+    error = spawn_command(cmd, gen->child, true);
+    if (!error.empty()) {
+        return nullptr;
+    }
+#else
+    std::string line = cmd[0];
+    for (size_t i = 1; i < cmd.size(); ++i) {
+        line += " " + cmd[i];
+    }
+    gen->pipe = popen(line.c_str(), "r");
+    if (!gen->pipe) {
+        error = "pipe creation failed";
+        return nullptr;
+    }
+#endif
+    return gen.release();
 }
 
 /**
@@ -392,8 +746,8 @@ extern "C" MCP_API const char *call_tool(const char *name, const char *args_json
 
             // Check if there is an error field, if so, return the error directly
             if (result_json.contains("error")) {
-                error->code = result_json["error"]["code"];
-                error->message = strdup(result_json["error"]["message"].get<std::string>().c_str());
+                mcp::business::set_plugin_error(error, result_json["error"]["code"].get<int>(),
+                                                result_json["error"]["message"].get<std::string>());
                 return nullptr;// Return nullptr to indicate an error
             }
 
@@ -414,15 +768,37 @@ extern "C" MCP_API const char *call_tool(const char *name, const char *args_json
                         {"params", nlohmann::json{{"message", "Failed to open log file: " + path}}}}
                                      .dump();
             }
-            return reinterpret_cast<const char *>(gen);
+            return reinterpret_cast<const char *>(static_cast<StreamState *>(gen));
+        } else if (tool_name == "ping_host_stream") {
+            std::string host = args.value("host", "");
+            if (host.empty() || !std::all_of(host.begin(), host.end(), [](char c) {
+                    return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-';
+                })) {
+                error->code = mcp::protocol::error_code::INVALID_TOOL_INPUT;
+                error->message = "Missing or invalid 'host' parameter";
+                return nullptr;
+            }
+            std::string count = std::to_string(std::clamp(args.value("count", 4), 1, 20));
+#ifdef _WIN32
+            std::vector<std::string> cmd = {"ping", "-n", count, "-w", "1000", host};
+#else
+            std::vector<std::string> cmd = {"ping", "-c", count, "-W", "1", host};
+#endif
+            std::string spawn_error;
+            CommandGenerator *gen = start_command_stream(cmd, spawn_error);
+            if (!gen) {
+                mcp::business::set_plugin_error(error, mcp::protocol::error_code::INTERNAL_ERROR, spawn_error);
+                return nullptr;
+            }
+            return reinterpret_cast<const char *>(static_cast<StreamState *>(gen));
         } else {
             error->code = mcp::protocol::error_code::TOOL_NOT_FOUND;
             error->message = "Unknown tool";
             return nullptr;
         }
     } catch (const std::exception &e) {
-        error->code = mcp::protocol::error_code::INTERNAL_ERROR;
-        error->message = e.what();
+        // e.what() dies with the exception, so the message is copied
+        mcp::business::set_plugin_error(error, mcp::protocol::error_code::INTERNAL_ERROR, e.what());
         return nullptr;
     }
 }
@@ -0,0 +1,170 @@
+#include "plugin_cache.hpp"
+#include "core/logger.h"
+#include <openssl/evp.h>
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace mcp::plugins {
+
+    namespace {
+        // Keys become file names; anything but a plain name character is replaced
+        std::string safe_name(const std::string &key) {
+            std::string name = key;
+            for (char &c: name) {
+                bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+                if (!plain) {
+                    c = '_';
+                }
+            }
+            return name;
+        }
+
+        // Unique per writer, so nodes sharing the directory never write the same temporary file
+        fs::path temporary_beside(const fs::path &target) {
+            static thread_local std::mt19937_64 random{std::random_device{}()};
+            std::ostringstream name;
+            name << target.filename().string() << ".tmp" << std::hex << random();
+            return target.parent_path() / name.str();
+        }
+
+        bool is_hex_digest(const std::string &text) {
+            if (text.size() != 64) {
+                return false;
+            }
+            for (char c: text) {
+                if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }// namespace
+
+    PluginCache::PluginCache(fs::path directory) : directory_(std::move(directory)) {
+        std::error_code ec;
+        fs::create_directories(directory_ / "blobs", ec);
+        fs::create_directories(directory_ / "refs", ec);
+        fs::create_directories(directory_ / "partial", ec);
+        if (ec) {
+            MCP_WARN("Could not create plugin cache in {}: {}", directory_.string(), ec.message());
+        }
+    }
+
+    std::optional<PluginCache::Entry> PluginCache::lookup(const std::string &key) const {
+        std::ifstream ref(ref_path(key));
+        Entry entry;
+        if (!ref || !(ref >> entry.sha256) || !is_hex_digest(entry.sha256)) {
+            return std::nullopt;
+        }
+        std::getline(ref >> std::ws, entry.filename);
+        entry.archive = blob_path(entry.sha256);
+
+        if (sha256_file(entry.archive) != entry.sha256) {
+            std::error_code ec;
+            if (fs::exists(entry.archive, ec)) {
+                MCP_WARN("Cached archive {} does not match its digest, dropping it", entry.archive.string());
+                fs::remove(entry.archive, ec);
+            }
+            return std::nullopt;
+        }
+        return entry;
+    }
+
+    std::optional<PluginCache::Entry> PluginCache::store(const std::string &key, const fs::path &file,
+                                                         const std::string &filename, const std::string &expected_sha256) {
+        std::error_code ec;
+        Entry entry;
+        entry.filename = filename;
+        entry.sha256 = sha256_file(file);
+        if (entry.sha256.empty() || (!expected_sha256.empty() && entry.sha256 != expected_sha256)) {
+            MCP_ERROR("Download of {} has digest {}, expected {}", key, entry.sha256, expected_sha256);
+            fs::remove(file, ec);
+            return std::nullopt;
+        }
+
+        // An identical blob stored already, by this node or another, is kept as it is
+        entry.archive = blob_path(entry.sha256);
+        if (fs::exists(entry.archive, ec)) {
+            fs::remove(file, ec);
+        } else {
+            fs::rename(file, entry.archive, ec);
+            if (ec) {
+                // partial/ may be on another file system than blobs/ only if someone linked it there
+                fs::path staged = temporary_beside(entry.archive);
+                fs::copy_file(file, staged, ec);
+                if (!ec) fs::rename(staged, entry.archive, ec);
+                if (ec) {
+                    MCP_ERROR("Could not store {} in the plugin cache: {}", key, ec.message());
+                    fs::remove(staged, ec);
+                    return std::nullopt;
+                }
+                fs::remove(file, ec);
+            }
+        }
+
+        fs::path ref = ref_path(key);
+        fs::path staged = temporary_beside(ref);
+        {
+            std::ofstream out(staged, std::ios::trunc);
+            out << entry.sha256 << ' ' << entry.filename << '\n';
+        }
+        fs::rename(staged, ref, ec);
+        if (ec) {
+            MCP_WARN("Could not record {} in the plugin cache: {}", key, ec.message());
+            fs::remove(staged, ec);
+        }
+        return entry;
+    }
+
+    fs::path PluginCache::partial_path(const std::string &key) const {
+        return directory_ / "partial" / (safe_name(key) + ".part");
+    }
+
+    fs::path PluginCache::ref_path(const std::string &key) const {
+        return directory_ / "refs" / safe_name(key);
+    }
+
+    fs::path PluginCache::blob_path(const std::string &sha256) const {
+        return directory_ / "blobs" / (sha256 + ".zip");
+    }
+
+    std::string PluginCache::sha256_file(const fs::path &file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            return {};
+        }
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        if (!context || EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr) != 1) {
+            return {};
+        }
+        std::array<char, 64 * 1024> buffer;
+        while (in) {
+            in.read(buffer.data(), buffer.size());
+            if (in.gcount() > 0) {
+                EVP_DigestUpdate(context.get(), buffer.data(), static_cast<size_t>(in.gcount()));
+            }
+        }
+        if (in.bad()) {
+            return {};
+        }
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        EVP_DigestFinal_ex(context.get(), digest, &length);
+
+        static constexpr char kHex[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(length * 2);
+        for (unsigned int i = 0; i < length; ++i) {
+            hex.push_back(kHex[digest[i] >> 4]);
+            hex.push_back(kHex[digest[i] & 0x0f]);
+        }
+        return hex;
+    }
+
+}// namespace mcp::plugins
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace mcp::plugins {
+
+    /**
+     * @brief Content-addressed store of downloaded plugin archives.
+     *
+     * Archives are kept as blobs/<sha256>.zip, and refs/<key> names the blob a plugin resolved to
+     * together with its file name, so a reinstall finds it without asking the server. Every file is
+     * written under a temporary name and renamed into place, and a blob is checked against its
+     * digest before it is used, so several nodes may share one directory over a network mount.
+     * Downloads in progress live in partial/ and are resumed from there.
+     */
+    class PluginCache {
+    public:
+        struct Entry {
+            std::filesystem::path archive;///< Blob holding the archive
+            std::string filename;         ///< Name the server gave the archive
+            std::string sha256;           ///< Hex digest of the archive
+        };
+
+        explicit PluginCache(std::filesystem::path directory);
+
+        /**
+         * @brief Find the archive a key resolved to last.
+         * @param key Plugin and platform
+         * @return Entry, or std::nullopt if there is none or its blob is missing or corrupt
+         */
+        std::optional<Entry> lookup(const std::string &key) const;
+
+        /**
+         * @brief Move a finished download into the store and point the key at it.
+         * @param key Plugin and platform
+         * @param file Downloaded archive, consumed
+         * @param filename Name the server gave the archive
+         * @param expected_sha256 Digest announced by the server, empty if none
+         * @return Entry, or std::nullopt if the digest does not match (the file is then deleted)
+         */
+        std::optional<Entry> store(const std::string &key, const std::filesystem::path &file,
+                                   const std::string &filename, const std::string &expected_sha256);
+
+        /**
+         * @brief File a download of the key is written to until it is stored.
+         */
+        std::filesystem::path partial_path(const std::string &key) const;
+
+        /**
+         * @brief Hex SHA-256 of a file, empty if it cannot be read.
+         */
+        static std::string sha256_file(const std::filesystem::path &file);
+
+    private:
+        std::filesystem::path ref_path(const std::string &key) const;
+        std::filesystem::path blob_path(const std::string &sha256) const;
+
+        std::filesystem::path directory_;
+    };
+
+}// namespace mcp::plugins
@@ -12,8 +12,15 @@
 #include "miniz.h"
 #include "plugins/sdk/mcp_plugin.h"
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 
 using namespace mcp::plugins;
@@ -24,10 +31,124 @@ namespace fs = std::filesystem;
 mcp::config::PluginHubConfig PluginHub::config_;
 std::unique_ptr<PluginHub> PluginHub::instance_;
 
+namespace {
+    constexpr int kDownloadAttempts = 3;
+
+    void ensureLogger() {
+        static std::once_flag once;
+        std::call_once(once, []() {
+            try {
+                mcp::core::initializeAsyncLogger("logs/plugin_hub.log", "info", 1048576 * 5, 3);
+                mcp::core::MCPLogger::enable_file_sink();
+            } catch (const std::exception &) {
+                // If logger is already initialized, that's fine - just continue
+            }
+        });
+    }
+
+    // Lines of plugins installed side by side must not interleave
+    std::mutex &consoleMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    void say(bool verbose, const std::string &line) {
+        if (verbose) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << line << std::endl;
+        }
+    }
+
+    void complain(const std::string &line) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cerr << line << std::endl;
+    }
+
+    // Progress bar helper function
+    void showProgress(size_t current, size_t total) {
+        if (total == 0) return;
+
+        int progress_percent = static_cast<int>((static_cast<double>(current) / total) * 100);
+        int bar_width = 50;
+        int filled_width = static_cast<int>((static_cast<double>(current) / total) * bar_width);
+
+        std::cout << "\r[";
+        for (int i = 0; i < bar_width; ++i) {
+            if (i < filled_width) {
+                std::cout << "=";
+            } else if (i == filled_width) {
+                std::cout << ">";
+            } else {
+                std::cout << " ";
+            }
+        }
+        std::cout << "] " << progress_percent << "% (" << current << "/" << total << " bytes)";
+        std::cout.flush();
+    }
+
+    // Extract filename from Content-Disposition header if available
+    std::string filenameOf(const httplib::Response &response, const std::string &fallback) {
+        std::string filename = fallback;
+        std::string content_disposition = response.get_header_value("Content-Disposition");
+        // Look for filename="..." pattern
+        size_t pos = content_disposition.find("filename=");
+        if (pos != std::string::npos) {
+            filename = content_disposition.substr(pos + 9);// 9 is length of "filename="
+            size_t end = filename.find(';');
+            if (end != std::string::npos) {
+                filename.resize(end);
+            }
+            // Remove quotes if present
+            if (filename.size() >= 2 && filename.front() == '"' && filename.back() == '"') {
+                filename = filename.substr(1, filename.length() - 2);
+            }
+        }
+        // The name ends up in a path, keep only its last component
+        filename = fs::path(filename).filename().string();
+        return filename.empty() ? fallback : filename;
+    }
+
+    std::string readFile(const fs::path &path) {
+        std::ifstream in(path);
+        std::string text;
+        std::getline(in, text);
+        return text;
+    }
+
+    // Copy everything below src into dest, replacing what is there
+    bool copyContents(const fs::path &src, const fs::path &dest, const std::string &kind, bool verbose) {
+        if (!fs::exists(src)) {
+            MCP_INFO("No {} directory found in the extracted zip file", kind);
+            say(verbose, "⚠️  No " + kind + " directory found in the extracted zip file");
+            return true;
+        }
+        try {
+            int count = 0;
+            for (const auto &entry: fs::directory_iterator(src)) {
+                fs::path dest_path = dest / entry.path().filename();
+                MCP_INFO("Moving {}: {} -> {}", kind, entry.path().string(), dest_path.string());
+                say(verbose, "  ➤ Moving " + kind + ": " + entry.path().filename().string());
+                if (fs::exists(dest_path)) {
+                    fs::remove_all(dest_path);
+                }
+                fs::copy(entry.path(), dest_path, fs::copy_options::recursive);
+                count++;
+            }
+            say(verbose, "✅ Moved " + std::to_string(count) + " " + kind + "(s)");
+            return true;
+        } catch (const fs::filesystem_error &e) {
+            MCP_ERROR("Failed to move {}: {}", kind, e.what());
+            complain("❌ Failed to move " + kind + ": " + e.what());
+            return false;
+        }
+    }
+}// namespace
+
 void PluginHub::create(mcp::config::PluginHubConfig &config) {
     config_ = config;
     instance_ = std::make_unique<PluginHub>();
     instance_->tellPlatform();
+    instance_->cache_ = std::make_unique<PluginCache>(config_.plugin_cache_dir);
     MCP_INFO("PluginHub initialized with plugin directory: {}", config_.plugin_install_dir);
 }
 
@@ -39,22 +160,16 @@ PluginHub &PluginHub::getInstance() {
     return *instance_;
 }
 
-bool PluginHub::download(const std::string &plugin_id) {
-    // Initialize logger if not already initialized
-    static bool logger_initialized = false;
-    if (!logger_initialized) {
-        try {
-            mcp::core::initializeAsyncLogger("logs/plugin_hub.log", "info", 1048576 * 5, 3);
-            mcp::core::MCPLogger::enable_file_sink();
-            logger_initialized = true;
-        } catch (const std::exception &e) {
-            // If logger is already initialized, that's fine - just continue
-            logger_initialized = true;
-        }
+std::optional<PluginCache::Entry> PluginHub::fetch(const std::string &plugin_id, bool verbose) {
+    const std::string key = plugin_id + "-" + platformName();
+    if (auto entry = cache_->lookup(key)) {
+        MCP_INFO("Plugin '{}' found in cache: {}", plugin_id, entry->archive.string());
+        say(verbose, "📦 Plugin '" + plugin_id + "' found in cache (sha256 " + entry->sha256.substr(0, 12) + ")");
+        return entry;
     }
 
     MCP_INFO("Starting download of plugin: {}", plugin_id);
-    std::cout << "📥 Downloading plugin '" << plugin_id << "'..." << std::endl;
+    say(verbose, "📥 Downloading plugin '" + plugin_id + "'...");
 
     std::string server_url = config_.plugin_server_baseurl;
     unsigned short server_port = config_.plugin_server_port;
@@ -68,18 +183,7 @@ bool PluginHub::download(const std::string &plugin_id) {
     }
 
     // Use the configured download route and append platform-specific path
-    std::string download_route = config_.download_route;
-    switch (platform_) {
-        case Platform::Windows:
-            download_route += "/windows";
-            break;
-        case Platform::Linux:
-            download_route += "/linux";
-            break;
-        default:
-            download_route += "/unknown";
-            break;
-    }
+    std::string download_route = config_.download_route + "/" + platformName();
 
     httplib::Client cli(host.c_str(), server_port);
     // Set timeouts for connection and reading
@@ -87,101 +191,133 @@ bool PluginHub::download(const std::string &plugin_id) {
     cli.set_read_timeout(30, 0);      // 30 seconds
     cli.set_write_timeout(10, 0);     // 10 seconds
 
-    // Variables for progress tracking
-    size_t current_size = 0;
-    size_t total_size = 0;
-    bool progress_started = false;
+    // Bytes already on disk are asked for again only if the archive changed (If-Range)
+    const fs::path partial = cache_->partial_path(key);
+    const fs::path etag_path = fs::path(partial.string() + ".etag");
 
-    // Progress bar helper function
-    auto show_progress = [](size_t current, size_t total) {
-        if (total == 0) return;
+    for (int attempt = 1; attempt <= kDownloadAttempts; ++attempt) {
+        std::error_code ec;
+        uint64_t offset = fs::exists(partial, ec) ? fs::file_size(partial, ec) : 0;
+        std::string etag = offset > 0 ? readFile(etag_path) : std::string{};
 
-        int progress_percent = static_cast<int>((static_cast<double>(current) / total) * 100);
-        int bar_width = 50;
-        int filled_width = static_cast<int>((static_cast<double>(current) / total) * bar_width);
+        httplib::Headers headers;
+        if (offset > 0) {
+            headers.emplace("Range", "bytes=" + std::to_string(offset) + "-");
+            if (!etag.empty()) {
+                headers.emplace("If-Range", etag);
+            }
+            MCP_INFO("Resuming download of '{}' at byte {}", plugin_id, offset);
+            say(verbose, "↪️  Resuming at byte " + std::to_string(offset));
+        }
 
-        std::cout << "\r[";
-        for (int i = 0; i < bar_width; ++i) {
-            if (i < filled_width) {
-                std::cout << "=";
-            } else if (i == filled_width) {
-                std::cout << ">";
-            } else {
-                std::cout << " ";
+        std::ofstream out;
+        int status = 0;
+        std::string filename = plugin_id + ".zip";
+        std::string expected_sha256;
+        bool progress_started = false;
+
+        auto res = cli.Get(
+                download_route.c_str(), headers,
+                [&](const httplib::Response &response) {
+                    status = response.status;
+                    if (status != 200 && status != 206) {
+                        return false;
+                    }
+                    if (status == 200) {
+                        offset = 0;// Full body, whatever was asked for
+                    }
+                    out.open(partial, std::ios::binary | (status == 206 ? std::ios::app : std::ios::trunc));
+
+                    filename = filenameOf(response, filename);
+                    expected_sha256 = response.get_header_value("X-Checksum-Sha256");
+                    std::transform(expected_sha256.begin(), expected_sha256.end(), expected_sha256.begin(), ::tolower);
+                    std::string new_etag = response.get_header_value("ETag");
+                    if (!new_etag.empty() && new_etag.rfind("W/", 0) != 0) {
+                        std::ofstream(etag_path, std::ios::trunc) << new_etag << '\n';
+                    } else {
+                        fs::remove(etag_path, ec);// A weak or missing validator cannot guard a resume
+                    }
+                    return out.is_open();
+                },
+                [&](const char *data, size_t data_length) {
+                    out.write(data, static_cast<std::streamsize>(data_length));
+                    return static_cast<bool>(out);// Continue receiving
+                },
+                [&](uint64_t current, uint64_t total) {
+                    if (verbose && total > 0) {
+                        std::lock_guard<std::mutex> lock(consoleMutex());
+                        if (!progress_started) {
+                            std::cout << "📦 File size: " << offset + total << " bytes" << std::endl;
+                            progress_started = true;
+                        }
+                        showProgress(offset + current, offset + total);
+                    }
+                    return true;// Continue receiving
+                });
+        out.close();
+        if (progress_started) {
+            say(verbose, "");
+        }
+
+        if (status == 416) {
+            // The server has nothing past our partial file, so it is not the same archive
+            MCP_WARN("Partial download of '{}' rejected by the server, starting over", plugin_id);
+            fs::remove(partial, ec);
+            fs::remove(etag_path, ec);
+            continue;
+        }
+        if (status != 0 && status != 200 && status != 206) {
+            MCP_ERROR("Failed to download plugin '{}', status code: {}", plugin_id, status);
+            complain("❌ Failed to download plugin '" + plugin_id + "', status code: " + std::to_string(status));
+            return std::nullopt;
+        }
+        if (!res) {
+            // What arrived stays in the partial file for the next attempt
+            MCP_WARN("Download of '{}' from {}:{} failed (attempt {}/{}): {}", plugin_id, host, server_port,
+                     attempt, kDownloadAttempts, httplib::to_string(res.error()));
+            if (attempt < kDownloadAttempts) {
+                std::this_thread::sleep_for(std::chrono::seconds(attempt));
             }
+            continue;
         }
-        std::cout << "] " << progress_percent << "% (" << current << "/" << total << " bytes)";
-        std::cout.flush();
-    };
 
-    std::string response_body;
-    // Use the correct signature for httplib::Client::Get
-    auto res = cli.Get(download_route.c_str(),
-                       // Content receiver callback
-                       [&](const char *data, size_t data_length) -> bool {
-                           response_body.append(data, data_length);
-                           current_size += data_length;
-                           if (progress_started && total_size > 0) {
-                               show_progress(current_size, total_size);
-                           }
-                           return true;// Continue receiving
-                       },
-                       // Progress callback
-                       [&](size_t current, size_t total) -> bool {
-                           total_size = total;
-                           progress_started = true;
-                           std::cout << "\n📦 File size: " << total << " bytes" << std::endl;
-                           return true;// Continue receiving
-                       });
-
-    if (!res) {
-        MCP_ERROR("Failed to connect to plugin server {}:{}", host, server_port);
-        MCP_ERROR("Error: {}", httplib::to_string(res.error()));
-        std::cerr << "❌ Failed to download plugin '" << plugin_id << "'" << std::endl;
-        std::cerr << "Error: " << httplib::to_string(res.error()) << std::endl;
-        return false;
+        fs::remove(etag_path, ec);
+        auto entry = cache_->store(key, partial, filename, expected_sha256);
+        if (!entry) {
+            complain("❌ Downloaded archive of '" + plugin_id + "' failed its integrity check");
+            return std::nullopt;
+        }
+        MCP_INFO("Plugin '{}' downloaded to cache: {}", plugin_id, entry->archive.string());
+        return entry;
     }
 
-    if (res->status != 200) {
-        MCP_ERROR("Failed to download plugin '{}', status code: {}", plugin_id, res->status);
-        std::cerr << "❌ Failed to download plugin '" << plugin_id << "', status code: " << res->status << std::endl;
+    MCP_ERROR("Failed to download plugin '{}' from {}:{}", plugin_id, host, server_port);
+    complain("❌ Failed to download plugin '" + plugin_id + "'");
+    return std::nullopt;
+}
+
+bool PluginHub::download(const std::string &plugin_id) {
+    ensureLogger();
+
+    auto entry = fetch(plugin_id, true);
+    if (!entry) {
         return false;
     }
 
     // Create install directory if it doesn't exist
     fs::path install_dir(config_.plugin_install_dir);
-    if (!fs::exists(install_dir)) {
-        fs::create_directories(install_dir);
-    }
-
-    // Extract filename from Content-Disposition header if available
-    std::string filename = plugin_id + ".zip";// default filename
-    auto it = res->headers.find("Content-Disposition");
-    if (it != res->headers.end()) {
-        std::string content_disposition = it->second;
-        // Look for filename="..." pattern
-        size_t pos = content_disposition.find("filename=");
-        if (pos != std::string::npos) {
-            filename = content_disposition.substr(pos + 9);// 9 is length of "filename="
-            // Remove quotes if present
-            if (!filename.empty() && filename.front() == '"' && filename.back() == '"') {
-                filename = filename.substr(1, filename.length() - 2);
-            }
-        }
-    }
+    std::error_code ec;
+    fs::create_directories(install_dir, ec);
 
     // Save the downloaded zip file
-    fs::path zip_path = install_dir / filename;
-    std::ofstream file(zip_path, std::ios::binary);
-    if (!file.is_open()) {
+    fs::path zip_path = install_dir / entry->filename;
+    fs::copy_file(entry->archive, zip_path, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
         MCP_ERROR("Failed to create file: {}", zip_path.string());
         std::cerr << "❌ Failed to create file: " << zip_path.string() << std::endl;
         return false;
     }
 
-    file.write(response_body.c_str(), response_body.size());
-    file.close();
-
     MCP_INFO("Plugin '{}' downloaded successfully to: {}", plugin_id, zip_path.string());
     std::cout << "✅ Plugin '" << plugin_id << "' downloaded successfully to: " << zip_path.string() << std::endl;
     return true;
@@ -238,266 +374,191 @@ std::vector<std::string> PluginHub::getPluginsInDirectory(const std::string &dir
 }
 
 bool PluginHub::install(const std::string &plugin_id) {
-    // Initialize logger if not already initialized
-    static bool logger_initialized = false;
-    if (!logger_initialized) {
-        try {
-            mcp::core::initializeAsyncLogger("logs/plugin_hub.log", "info", 1048576 * 5, 3);
-            mcp::core::MCPLogger::enable_file_sink();
-            logger_initialized = true;
-        } catch (const std::exception &e) {
-            // If logger is already initialized, that's fine - just continue
-            logger_initialized = true;
-        }
-    }
-
-    MCP_INFO("Starting installation of plugin: {}", plugin_id);
-    std::cout << "⚙️  Starting installation of plugin: " << plugin_id << std::endl;
-
-    // Check if zip file already exists with the standard name
-    fs::path zip_path = fs::path(config_.plugin_install_dir) / (plugin_id + ".zip");
-    MCP_INFO("Looking for zip file at: {}", zip_path.string());
+    return installOne(plugin_id, true, std::max(1u, std::thread::hardware_concurrency()));
+}
 
-    // Also check for other possible zip files in the directory that might be the plugin
-    if (!fs::exists(zip_path)) {
-        MCP_INFO("Standard zip file not found, scanning directory for any zip files");
-        try {
-            for (const auto &entry: fs::directory_iterator(config_.plugin_install_dir)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".zip") {
-                    // Use the first zip file found - this is a temporary solution
-                    // In a more robust implementation, we would match the file to the plugin
-                    zip_path = entry.path();
-                    MCP_INFO("Using existing zip file: {}", zip_path.string());
-                    std::cout << "📁 Using existing zip file: " << zip_path.string() << std::endl;
-                    break;
-                }
-            }
-        } catch (const fs::filesystem_error &e) {
-            MCP_WARN("Could not iterate plugin directory: {}", e.what());
-            std::cerr << "⚠️  Warning: Could not iterate plugin directory: " << e.what() << std::endl;
+size_t PluginHub::install(const std::vector<std::string> &plugin_ids, size_t jobs) {
+    std::vector<std::string> unique_ids;
+    std::unordered_set<std::string> seen;
+    for (const auto &id: plugin_ids) {
+        if (seen.insert(id).second) {
+            unique_ids.push_back(id);
         }
     }
+    if (unique_ids.size() == 1) {
+        return install(unique_ids.front()) ? 1 : 0;
+    }
 
-    if (!fs::exists(zip_path)) {
-        // Download if not exists
-        MCP_INFO("Plugin zip not found, downloading...");
-        std::cout << "📥 Plugin zip not found, downloading..." << std::endl;
-        if (!download(plugin_id)) {
-            MCP_ERROR("Failed to download plugin: {}", plugin_id);
-            std::cerr << "❌ Failed to download plugin: " << plugin_id << std::endl;
-            return false;
-        }
-
-        // After downloading, we need to find the actual downloaded file
-        // since download() now extracts the real filename from HTTP headers
-        MCP_INFO("Scanning for downloaded zip file");
-        std::cout << "🔎 Scanning for downloaded zip file" << std::endl;
-        try {
-            for (const auto &entry: fs::directory_iterator(config_.plugin_install_dir)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".zip") {
-                    zip_path = entry.path();
-                    MCP_INFO("Found downloaded zip file: {}", zip_path.string());
-                    std::cout << "📁 Found downloaded zip file: " << zip_path.string() << std::endl;
-                    break;
-                }
+    jobs = std::clamp<size_t>(jobs == 0 ? config_.download_jobs : jobs, 1, std::max<size_t>(unique_ids.size(), 1));
+    size_t extract_threads = std::max<size_t>(1, std::thread::hardware_concurrency() / jobs);
+    std::cout << "⚙️  Installing " << unique_ids.size() << " plugins, " << jobs << " at a time" << std::endl;
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> installed{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < unique_ids.size(); i = next++) {
+            bool ok = installOne(unique_ids[i], false, extract_threads);
+            if (ok) {
+                ++installed;
             }
-        } catch (const fs::filesystem_error &e) {
-            MCP_WARN("Could not iterate plugin directory: {}", e.what());
-            std::cerr << "⚠️  Warning: Could not iterate plugin directory: " << e.what() << std::endl;
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            (ok ? std::cout : std::cerr) << (ok ? "✅ " : "❌ ") << unique_ids[i] << std::endl;
         }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < jobs; ++i) {
+        workers.emplace_back(worker);
     }
-
-    if (!fs::exists(zip_path)) {
-        MCP_ERROR("Plugin zip file not found after download attempt");
-        std::cerr << "❌ Plugin zip file not found after download attempt" << std::endl;
-        return false;
-    }
-
-    // Create install directory if it doesn't exist
-    fs::path install_dir(config_.plugin_install_dir);
-    if (!fs::exists(install_dir)) {
-        fs::create_directories(install_dir);
+    worker();
+    for (auto &thread: workers) {
+        thread.join();
     }
+    return installed;
+}
 
-    // Extract the zip file to a temporary directory using miniz
-    fs::path temp_dir = install_dir / "temp_extract";
-    MCP_INFO("Using temporary extraction directory: {}", temp_dir.string());
-    std::cout << "📂 Using temporary extraction directory: " << temp_dir.string() << std::endl;
-
-    // Remove existing temp directory if it exists
-    if (fs::exists(temp_dir)) {
-        MCP_INFO("Removing existing temporary directory");
-        std::cout << "🗑️  Removing existing temporary directory" << std::endl;
-        fs::remove_all(temp_dir);
-    }
-
-    // Create temp directory
-    MCP_INFO("Creating temporary directory");
-    std::cout << "📁 Creating temporary directory" << std::endl;
-    fs::create_directory(temp_dir);
-
-    // Extract zip file using miniz
+bool PluginHub::extract(const fs::path &zip_path, const fs::path &destination, size_t threads, bool verbose) {
     MCP_INFO("Extracting zip file: {}", zip_path.string());
-    std::cout << "📦 Extracting zip file..." << std::endl;
+    say(verbose, "📦 Extracting zip file...");
     mz_zip_archive zip_archive;
     memset(&zip_archive, 0, sizeof(zip_archive));
 
     mz_bool status = mz_zip_reader_init_file(&zip_archive, zip_path.string().c_str(), 0);
     if (!status) {
         MCP_ERROR("Failed to initialize zip reader for file: {}", zip_path.string());
-        std::cerr << "❌ Failed to initialize zip reader for file: " << zip_path.string() << std::endl;
+        complain("❌ Failed to initialize zip reader for file: " + zip_path.string());
         return false;
     }
 
+    // Directories are made up front, files are then written by several readers of the archive
     int file_count = (int) mz_zip_reader_get_num_files(&zip_archive);
     MCP_INFO("Extracting {} files from plugin zip", file_count);
-    std::cout << "📂 Extracting " << file_count << " files from plugin zip" << std::endl;
+    say(verbose, "📂 Extracting " + std::to_string(file_count) + " files from plugin zip");
 
+    std::vector<std::pair<mz_uint, fs::path>> files;
     for (int i = 0; i < file_count; i++) {
         mz_zip_archive_file_stat file_stat;
         if (!mz_zip_reader_file_stat(&zip_archive, i, &file_stat)) {
             MCP_ERROR("Failed to get file stat for file index: {}", i);
-            std::cerr << "❌ Failed to get file stat for file index: " << i << std::endl;
+            complain("❌ Failed to get file stat for file index: " + std::to_string(i));
             mz_zip_reader_end(&zip_archive);
             return false;
         }
 
-        fs::path extract_path = temp_dir / file_stat.m_filename;
-        MCP_INFO("Extracting file: {} to {}", file_stat.m_filename, extract_path.string());
-        std::cout << "  ➤ Extracting: " << file_stat.m_filename << std::endl;
+        fs::path relative = fs::path(file_stat.m_filename).lexically_normal();
+        if (relative.is_absolute() || relative.has_root_name() || relative.has_root_directory() || (!relative.empty() && *relative.begin() == "..")) {
+            MCP_ERROR("Refusing to extract {} outside of {}", file_stat.m_filename, destination.string());
+            complain(std::string("❌ Archive entry escapes the extraction directory: ") + file_stat.m_filename);
+            mz_zip_reader_end(&zip_archive);
+            return false;
+        }
 
-        // Create directory if needed
+        fs::path extract_path = destination / relative;
+        MCP_DEBUG("Extracting file: {} to {}", file_stat.m_filename, extract_path.string());
+        std::error_code ec;
         if (file_stat.m_is_directory) {
-            fs::create_directories(extract_path);
-            continue;
+            fs::create_directories(extract_path, ec);
+        } else {
+            fs::create_directories(extract_path.parent_path(), ec);
+            files.emplace_back(static_cast<mz_uint>(i), std::move(extract_path));
         }
+    }
+    mz_zip_reader_end(&zip_archive);
 
-        // Create parent directories if needed
-        fs::create_directories(extract_path.parent_path());
-
-        // Extract file
-        mz_bool extract_result = mz_zip_reader_extract_to_file(&zip_archive, i, extract_path.string().c_str(), 0);
-        if (!extract_result) {
-            MCP_ERROR("Failed to extract file: {}", file_stat.m_filename);
-            std::cerr << "❌ Failed to extract file: " << file_stat.m_filename << std::endl;
-            mz_zip_reader_end(&zip_archive);
-            return false;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    auto worker = [&]() {
+        mz_zip_archive reader;
+        memset(&reader, 0, sizeof(reader));
+        if (!mz_zip_reader_init_file(&reader, zip_path.string().c_str(), 0)) {
+            failed = true;
+            return;
+        }
+        for (size_t i = next++; i < files.size() && !failed; i = next++) {
+            if (!mz_zip_reader_extract_to_file(&reader, files[i].first, files[i].second.string().c_str(), 0)) {
+                MCP_ERROR("Failed to extract file: {}", files[i].second.string());
+                complain("❌ Failed to extract file: " + files[i].second.string());
+                failed = true;
+            }
         }
+        mz_zip_reader_end(&reader);
+    };
+    std::vector<std::thread> workers;
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(files.size(), 1));
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread: workers) {
+        thread.join();
+    }
+    if (failed) {
+        return false;
     }
 
-    // Close the archive
-    mz_zip_reader_end(&zip_archive);
     MCP_INFO("Zip extraction completed successfully");
-    std::cout << "✅ Zip extraction completed successfully" << std::endl;
-
-    // Now move plugins to plugin_enable_dir and configs to tools_enable_dir
-    fs::path plugins_dest_dir = fs::path(config_.plugin_enable_dir);
-    fs::path tools_dest_dir = fs::path(config_.tools_enable_dir);
+    say(verbose, "✅ Zip extraction completed successfully");
+    return true;
+}
 
-    MCP_INFO("Plugins destination directory: {}", plugins_dest_dir.string());
-    MCP_INFO("Tools destination directory: {}", tools_dest_dir.string());
-    std::cout << "📂 Plugins destination directory: " << plugins_dest_dir.string() << std::endl;
-    std::cout << "📂 Tools destination directory: " << tools_dest_dir.string() << std::endl;
-
-    // Create destination directories if they don't exist
-    if (!fs::exists(plugins_dest_dir)) {
-        MCP_INFO("Creating plugins destination directory");
-        std::cout << "📁 Creating plugins destination directory" << std::endl;
-        fs::create_directories(plugins_dest_dir);
-    }
+bool PluginHub::installOne(const std::string &plugin_id, bool verbose, size_t extract_threads) {
+    ensureLogger();
 
-    if (!fs::exists(tools_dest_dir)) {
-        MCP_INFO("Creating tools destination directory");
-        std::cout << "📁 Creating tools destination directory" << std::endl;
-        fs::create_directories(tools_dest_dir);
-    }
+    MCP_INFO("Starting installation of plugin: {}", plugin_id);
+    say(verbose, "⚙️  Starting installation of plugin: " + plugin_id);
 
-    // Move plugins directory contents if it exists in the extracted files
-    // Fix: Look for the correct path structure (bin/plugins instead of just plugins)
-    fs::path plugins_src_dir = temp_dir / "bin" / "plugins";
-    MCP_INFO("Plugins source directory: {}", plugins_src_dir.string());
-    std::cout << "📂 Plugins source directory: " << plugins_src_dir.string() << std::endl;
-    if (fs::exists(plugins_src_dir)) {
-        MCP_INFO("Plugins directory found in zip, moving contents");
-        std::cout << "🚚 Plugins directory found in zip, moving contents" << std::endl;
-        try {
-            int plugin_count = 0;
-            for (const auto &entry: fs::directory_iterator(plugins_src_dir)) {
-                fs::path dest_path = plugins_dest_dir / entry.path().filename();
-                MCP_INFO("Moving plugin: {} -> {}", entry.path().string(), dest_path.string());
-                std::cout << "  ➤ Moving plugin: " << entry.path().filename().string() << std::endl;
-                if (fs::exists(dest_path)) {
-                    fs::remove_all(dest_path);
-                }
-                fs::copy(entry.path(), dest_path, fs::copy_options::recursive);
-                MCP_INFO("Moved plugin file/directory: {} -> {}", entry.path().string(), dest_path.string());
-                plugin_count++;
-            }
-            std::cout << "✅ Moved " << plugin_count << " plugin(s)" << std::endl;
-        } catch (const fs::filesystem_error &e) {
-            MCP_ERROR("Failed to move plugins: {}", e.what());
-            std::cerr << "❌ Failed to move plugins: " << e.what() << std::endl;
-            // Clean up temporary directory
-            fs::remove_all(temp_dir);
+    // An archive put in the install directory by hand wins over the cache and the server
+    fs::path zip_path = fs::path(config_.plugin_install_dir) / (plugin_id + ".zip");
+    MCP_INFO("Looking for zip file at: {}", zip_path.string());
+    if (fs::exists(zip_path)) {
+        say(verbose, "📁 Using existing zip file: " + zip_path.string());
+    } else {
+        auto entry = fetch(plugin_id, verbose);
+        if (!entry) {
+            MCP_ERROR("Failed to download plugin: {}", plugin_id);
+            complain("❌ Failed to download plugin: " + plugin_id);
             return false;
         }
-    } else {
-        MCP_INFO("No plugins directory found in the extracted zip file");
-        std::cout << "⚠️  No plugins directory found in the extracted zip file" << std::endl;
+        zip_path = entry->archive;
     }
 
-    // Move configs directory contents if it exists in the extracted files
-    // Fix: Look for the correct path structure (bin/configs instead of just configs)
-    fs::path configs_src_dir = temp_dir / "bin" / "configs";
-    MCP_INFO("Configs source directory: {}", configs_src_dir.string());
-    std::cout << "📂 Configs source directory: " << configs_src_dir.string() << std::endl;
-    if (fs::exists(configs_src_dir)) {
-        MCP_INFO("Configs directory found in zip, moving contents");
-        std::cout << "🚚 Configs directory found in zip, moving contents" << std::endl;
-        try {
-            int config_count = 0;
-            for (const auto &entry: fs::directory_iterator(configs_src_dir)) {
-                fs::path dest_path = tools_dest_dir / entry.path().filename();
-                MCP_INFO("Moving config: {} -> {}", entry.path().string(), dest_path.string());
-                std::cout << "  ➤ Moving config: " << entry.path().filename().string() << std::endl;
-                if (fs::exists(dest_path)) {
-                    fs::remove_all(dest_path);
-                }
-                fs::copy(entry.path(), dest_path, fs::copy_options::recursive);
-                MCP_INFO("Moved config file/directory: {} -> {}", entry.path().string(), dest_path.string());
-                config_count++;
-            }
-            std::cout << "✅ Moved " << config_count << " config file(s)" << std::endl;
-        } catch (const fs::filesystem_error &e) {
-            MCP_ERROR("Failed to move configs: {}", e.what());
-            std::cerr << "❌ Failed to move configs: " << e.what() << std::endl;
-            // Clean up temporary directory
-            fs::remove_all(temp_dir);
-            return false;
-        }
-    } else {
-        MCP_INFO("No configs directory found in the extracted zip file");
-        std::cout << "⚠️  No configs directory found in the extracted zip file" << std::endl;
+    // Create install directory if it doesn't exist
+    fs::path install_dir(config_.plugin_install_dir);
+    std::error_code ec;
+    fs::create_directories(install_dir, ec);
+
+    // Extract the zip file to a temporary directory of its own, plugins may be installed side by side
+    fs::path temp_dir = install_dir / ("temp_extract_" + plugin_id);
+    MCP_INFO("Using temporary extraction directory: {}", temp_dir.string());
+    say(verbose, "📂 Using temporary extraction directory: " + temp_dir.string());
+    fs::remove_all(temp_dir, ec);
+    fs::create_directories(temp_dir, ec);
+
+    if (!extract(zip_path, temp_dir, extract_threads, verbose)) {
+        fs::remove_all(temp_dir, ec);
+        return false;
     }
 
-    // Clean up temporary directory
-    MCP_INFO("Cleaning up temporary directory");
-    // Clean up temporary directory
-    MCP_INFO("Cleaning up temporary directory");
-    fs::remove_all(temp_dir);
+    // Now move plugins to plugin_enable_dir and configs to tools_enable_dir
+    fs::path plugins_dest_dir = fs::path(config_.plugin_enable_dir);
+    fs::path tools_dest_dir = fs::path(config_.tools_enable_dir);
+    MCP_INFO("Plugins destination directory: {}", plugins_dest_dir.string());
+    MCP_INFO("Tools destination directory: {}", tools_dest_dir.string());
+    fs::create_directories(plugins_dest_dir, ec);
+    fs::create_directories(tools_dest_dir, ec);
 
-    MCP_INFO("Plugin '{}' installed successfully", plugin_id);
-    std::cout << "🎉 Plugin '" << plugin_id << "' installed successfully" << std::endl;
-    return true;
-    fs::remove_all(temp_dir);
+    // Fix: Look for the correct path structure (bin/plugins and bin/configs)
+    bool moved = copyContents(temp_dir / "bin" / "plugins", plugins_dest_dir, "plugin", verbose) &&
+                 copyContents(temp_dir / "bin" / "configs", tools_dest_dir, "config", verbose);
 
-    MCP_INFO("Plugin '{}' installed successfully", plugin_id);
-    std::cout << "🎉 Plugin '" << plugin_id << "' installed successfully" << std::endl;
-    return true;
-    fs::remove_all(temp_dir);
+    // Clean up temporary directory
+    MCP_INFO("Cleaning up temporary directory");
+    fs::remove_all(temp_dir, ec);
+    if (!moved) {
+        return false;
+    }
 
     MCP_INFO("Plugin '{}' installed successfully", plugin_id);
-    std::cout << "🎉 Plugin '" << plugin_id << "' installed successfully" << std::endl;
+    say(verbose, "🎉 Plugin '" + plugin_id + "' installed successfully");
     return true;
 }
 
@@ -545,6 +606,17 @@ ReleaseInfo PluginHub::getReleaseInfo(const std::string &plugin_id) {
     return {};
 }
 
+std::string PluginHub::platformName() const {
+    switch (platform_) {
+        case Platform::Windows:
+            return "windows";
+        case Platform::Linux:
+            return "linux";
+        default:
+            return "unknown";
+    }
+}
+
 void PluginHub::tellPlatform() {
 #ifdef _WIN32
     platform_ = Platform::Windows;
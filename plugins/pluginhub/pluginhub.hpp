@@ -8,7 +8,10 @@
 #pragma once
 
 #include "config/config.hpp"
+#include "plugin_cache.hpp"
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -72,9 +75,17 @@ namespace mcp::plugins {
          */
         static PluginHub &getInstance();
 
-        // install it from the remote url
+        // install it from the cache, or from the remote url if it is not cached
         bool install(const std::string &plugin_name);
 
+        /**
+         * @brief Install several plugins, downloading and extracting up to `jobs` of them at once.
+         * @param plugin_names Plugins to install, duplicates are installed once
+         * @param jobs Plugins handled at once, 0 = download_jobs of the config
+         * @return Number of plugins installed
+         */
+        size_t install(const std::vector<std::string> &plugin_names, size_t jobs = 0);
+
         // Uninstall a plugin by name
         void uninstall(const std::string &plugin_name);
 
@@ -84,7 +95,7 @@ namespace mcp::plugins {
         // Disable a plugin (move it out of the enabled directory)
         void disable(const std::string &plugin_name);
 
-        // Download a plugin from remote server
+        // Download a plugin from remote server (or take it from the cache) into the install directory
         bool download(const std::string &plugin_name);
 
         // List remote plugins
@@ -111,11 +122,29 @@ namespace mcp::plugins {
 
         void tellPlatform();
 
+        /**
+         * @brief Get the archive of a plugin from the cache, downloading it if it is not there.
+         * An interrupted download is resumed with a range request, on the next attempt or run.
+         * @param plugin_id Plugin to get
+         * @param verbose Print progress, false while several plugins are installed at once
+         */
+        std::optional<PluginCache::Entry> fetch(const std::string &plugin_id, bool verbose);
+
+        bool installOne(const std::string &plugin_id, bool verbose, size_t extract_threads);
+
+        /**
+         * @brief Extract an archive, its files spread over up to `threads` threads.
+         */
+        bool extract(const std::filesystem::path &zip_path, const std::filesystem::path &destination, size_t threads, bool verbose);
+
+        std::string platformName() const;
+
         // Helper methods for plugin management
         std::vector<std::string> getPluginsInDirectory(const std::string &directory);
 
         static mcp::config::PluginHubConfig config_;
         static std::unique_ptr<PluginHub> instance_;
         Platform platform_;
+        std::unique_ptr<PluginCache> cache_;
     };
 }// namespace mcp::plugins
\ No newline at end of file
@@ -0,0 +1,6 @@
+// plugins/sdk/mcp_base64.h
+#pragma once
+
+// The server's base64 codec, vectorized where the CPU allows it, for plugins that return
+// binary content: mcp::utils::base64_encode / base64_append / base64_decode
+#include "utils/base64.h"
\ No newline at end of file
@@ -1,6 +1,8 @@
 // plugins/sdk/mcp_plugin.h
 #pragma once
 
+#include <stddef.h>
+
 // Tool information provided by plugin
 struct ToolInfo {
     const char *name;
@@ -9,6 +11,9 @@ struct ToolInfo {
     bool is_streaming = false;
 };
 
+// The strings of an MCPError filled in by a plugin stay owned by the plugin: they must remain valid until
+// the plugin is next called on the same thread, and the server copies them before that and never frees
+// them. A thread_local buffer, or a string literal, is the intended storage.
 struct MCPError {
     int code;           // error code,0 stand for no error
     const char *message;// readable message
@@ -22,6 +27,195 @@ struct MCPError {
 //if the tool is streaming, return a StreamGenerator pointer (type erased)
 typedef const char *(*call_tool_func)(const char *name, const char *args_json, MCPError *error);
 
+// ABI v2: length-delimited buffers and a server-owned output arena.
+// A plugin opts in by exporting mcp_plugin_abi_version (returning MCP_PLUGIN_ABI_VERSION) and
+// call_tool_v2. Plugins without them keep using call_tool/free_result.
+#define MCP_PLUGIN_ABI_VERSION 2
+
+// Byte range, not NUL-terminated
+struct MCPBuffer {
+    const char *data;
+    size_t size;
+};
+
+// The output is a complete tools/call result ({"content": [...]}) and is sent as-is, without re-parsing
+#define MCP_OUTPUT_PASSTHROUGH 0x1
+
+// Output arena supplied by the server for one call; valid only until call_tool_v2 returns
+struct MCPOutput {
+    void *context;    // server side state, pass it back to the functions below
+    unsigned flags;   // MCP_OUTPUT_* bits, set by the plugin
+    // append size bytes to the result, returns false if the server is out of memory
+    bool (*write)(void *context, const char *data, size_t size);
+    // get at least capacity writable bytes at the end of the result, NULL if out of memory
+    char *(*reserve)(void *context, size_t capacity);
+    // append the first size bytes written to the last reserve() to the result
+    void (*commit)(void *context, size_t size);
+};
+
+// Function pointer to query the ABI version of a plugin
+typedef int (*get_abi_version_func)();
+
+// Function pointer to call a synchronous tool (ABI v2)
+// return 0 on success with the result JSON written to output, non-zero with error filled in
+// streaming tools are still started through call_tool
+typedef int (*call_tool_v2_func)(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error);
+
+// Cooperative cancellation: the server sets the token when the client sends notifications/cancelled
+// for the request. A long-running tool should poll it and return early, with an error or what it has.
+struct MCPCancelToken {
+    void *context;                     // server side state, pass it back to is_cancelled
+    bool (*is_cancelled)(void *context);// thread safe, cheap enough to call in a loop
+};
+
+// Function pointer to call a synchronous tool that can be cancelled (ABI v2, optional)
+// same contract as call_tool_v2, which it is preferred over; cancel is valid until the call returns
+typedef int (*call_tool_cancellable_func)(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error,
+                                          const MCPCancelToken *cancel);
+
+// Batches: a plugin that can answer many calls with one round trip, such as a query to a database or a
+// remote API, exports call_tools_batch. With tool_batch_window_us set ([concurrency]), the server
+// collects the calls of one tool that arrive within the window, from a JSON-RPC batch or separate
+// requests, and hands them over together. Only reentrant tools are batched, on any thread, and batched calls
+// are neither cancellable nor report progress.
+struct MCPBatchCall {
+    MCPBuffer args_json;// arguments of this call
+    MCPOutput *output;  // where its result goes
+    MCPError error;     // filled in by the plugin when status is non-zero
+    int status;         // set by the plugin, 0 on success; non-zero until it is
+};
+
+// Function pointer to run count calls of tool name at once (ABI v2, optional); every call gets a status.
+// The error strings of a batch must stay valid until it returns, so distinct calls need distinct storage
+typedef void (*call_tools_batch_func)(const char *name, MCPBatchCall *calls, size_t count);
+
+// Progress of a long-running call, sent to the client as notifications/progress when it asked for it.
+// Reports are coalesced by the server, so calling this often is cheap; progress must increase from one
+// report to the next, total is negative if unknown and message may be NULL.
+struct MCPProgress {
+    void *context;// server side state, pass it back to report
+    // thread safe, returns right away
+    void (*report)(void *context, double progress, double total, const char *message);
+};
+
+// Function pointer to call a synchronous tool that reports progress (ABI v2, optional)
+// same contract as call_tool_cancellable, which it is preferred over; progress is valid until the call returns
+typedef int (*call_tool_with_progress_func)(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error,
+                                            const MCPCancelToken *cancel, const MCPProgress *progress);
+
+// Streamed input: a tool can take one large string argument, such as the content of a file to write, as
+// bytes read off the connection while they arrive instead of inside args_json. The server streams only
+// large requests that send the argument last, and only to synchronous tools; other calls get it in
+// args_json as usual.
+struct MCPInputStream {
+    void *context;// server side state, pass it back to read
+    // reads up to size bytes of the argument's value, unescaped, into buffer and returns their number, 0 at
+    // the end of the value and -1 if the upload failed (the client went away, the body was malformed).
+    // Blocks until data arrives; valid until the call returns
+    long long (*read)(void *context, char *buffer, size_t size);
+};
+
+// Optional export mcp_plugin_streamed_argument: name of the string argument tool name takes as a stream,
+// NULL if it takes none. The string must stay valid while the plugin is loaded
+typedef const char *(*streamed_argument_func)(const char *name);
+
+// Function pointer to call a tool with a streamed argument (ABI v2, optional, used with
+// mcp_plugin_streamed_argument); same contract as call_tool_cancellable, and args_json holds the streamed
+// argument as an empty string: its value is read from input
+typedef int (*call_tool_with_input_func)(const char *name, MCPBuffer args_json, const MCPInputStream *input,
+                                         MCPOutput *output, MCPError *error, const MCPCancelToken *cancel);
+
+// Trace context of the call running on the calling thread, for plugins that call other services and
+// want them to be part of the request's trace: pass it on as the W3C traceparent header.
+struct MCPTraceSource {
+    void *context;// server side state, pass it back to traceparent
+    // writes the traceparent ("00-<trace id>-<span id>-<flags>") and a terminating NUL to buffer, returns its
+    // length; returns 0 if the call is not traced or size is below MCP_TRACEPARENT_SIZE. Only valid on the
+    // thread of a call, while it runs
+    size_t (*traceparent)(void *context, char *buffer, size_t size);
+};
+
+#define MCP_TRACEPARENT_SIZE 56
+
+// Optional export mcp_plugin_set_trace_source, called once after the plugin is loaded;
+// source stays valid for as long as the plugin is loaded
+typedef void (*set_trace_source_func)(const MCPTraceSource *source);
+
+// Optional export mcp_plugin_server_started, called once the server accepts connections, or right after
+// loading for plugins loaded later. For work that would otherwise delay the start, such as warming caches;
+// it should return quickly and leave anything longer to a thread of its own
+typedef void (*server_started_func)();
+
+// Host services: timers, HTTP requests and file reads run by the server on its event loops, so that a plugin
+// can wait for them without blocking a thread or running a loop of its own. Each call returns right away and
+// its callback runs exactly once, later, on a server thread; callbacks must not block, and what they are
+// passed is only valid while they run. Together with MCP_STREAM_WOULD_BLOCK, a stream can wait for them
+// and call its wakeup from the callback.
+#define MCP_HOST_SERVICES_VERSION 2
+
+// cancelled is non-zero if the timer was cancelled before it expired
+typedef void (*MCPTimerCallback)(void *user, int cancelled);
+
+struct MCPHttpRequest {
+    const char *method; // "GET", "POST", ...
+    const char *url;    // http://host[:port][/path][?query], plain HTTP only
+    const char *headers;// extra request header lines, each ending in "\r\n", or NULL
+    MCPBuffer body;     // sent with a Content-Length if size is non-zero
+    unsigned timeout_ms;// for the whole exchange, 0 for the server's default of 30 s
+};
+
+struct MCPHttpResponse {
+    const char *error;// NULL, or why there is no response (the fields below are then empty)
+    int status;       // HTTP status code
+    MCPBuffer headers;// header lines with lower case names, each ending in "\r\n"
+    MCPBuffer body;   // without transfer encoding
+};
+
+typedef void (*MCPHttpCallback)(void *user, const MCPHttpResponse *response);
+
+// data holds what was read, fewer bytes than asked for at the end of the file; error is NULL on success
+typedef void (*MCPReadCallback)(void *user, MCPBuffer data, const char *error);
+
+struct MCPHostServices {
+    unsigned version;// MCP_HOST_SERVICES_VERSION, functions added later are only there in later versions
+    void *context;   // server side state, pass it back to the functions below
+    // calls callback after delay_ms; returns an id for cancel_timer
+    unsigned long long (*start_timer)(void *context, unsigned delay_ms, MCPTimerCallback callback, void *user);
+    // makes a pending timer's callback run soon with cancelled set; false if it already ran or is running
+    bool (*cancel_timer)(void *context, unsigned long long timer);
+    // sends request, which only needs to be valid until the call returns, and calls callback with the response
+    void (*http_request)(void *context, const MCPHttpRequest *request, MCPHttpCallback callback, void *user);
+    // reads up to size bytes of file path from offset
+    void (*read_file)(void *context, const char *path, unsigned long long offset, size_t size,
+                      MCPReadCallback callback, void *user);
+
+    // Version 2: memory from the server's heap, thread safe. free_result can hand results allocated with
+    // alloc back with free
+    void *(*alloc)(void *context, size_t size);
+    void (*free)(void *context, void *ptr);
+    // memory that lives until the server has taken the result of the synchronous call running on this
+    // thread, NULL outside of one. It is released all at once, never free it: a call_tool result allocated
+    // here is not passed to free_result, and scratch space of call_tool_v2 and the like costs no free either
+    void *(*call_alloc)(void *context, size_t size);
+};
+
+// Optional export mcp_plugin_set_host_services, called once after loading, before initialize_plugin;
+// services stays valid for as long as the plugin is loaded. Calls still pending when the plugin is
+// unloaded complete without their callbacks
+typedef void (*set_host_services_func)(const MCPHostServices *services);
+
+// Thread safety of a tool's synchronous calls, which the server otherwise makes from any number of
+// threads at once. Tools of a plugin that are not reentrant share one queue: their calls run one at
+// a time, in the order they arrived, and reentrant tools keep running alongside them.
+#define MCP_THREAD_SAFETY_REENTRANT 0 // any number of calls at once, on any thread (the default)
+#define MCP_THREAD_SAFETY_SERIALIZED 1// one call of the plugin's serialized and pinned tools at a time, on any thread
+#define MCP_THREAD_SAFETY_PINNED 2    // as serialized, and always on the same thread of the plugin's own
+
+// Optional export mcp_plugin_thread_safety: MCP_THREAD_SAFETY_* level of tool name, asked once per tool
+// after loading. A plugin with one pinned tool runs all its serialized tools on that thread as well.
+// Streams are started the same way; their generators are driven as before.
+typedef int (*thread_safety_func)(const char *name);
+
 // Function pointer to get tools
 typedef ToolInfo *(*get_tools_func)(int *count);
 
@@ -41,13 +235,53 @@ typedef void *StreamGenerator;
 // return 0: more data
 // return 1: end of stream
 // return -1: error occurred
+// return MCP_STREAM_WOULD_BLOCK: no data yet, only if the plugin exports get_stream_wait
 typedef int (*StreamGeneratorNext)(StreamGenerator generator, const char **result_json, MCPError *error);
 
 typedef void (*StreamGeneratorFree)(StreamGenerator generator);
 
+// Non-blocking streams: instead of blocking inside next(), a generator returns MCP_STREAM_WOULD_BLOCK
+// and the server calls wait() to learn when to call next() again. next() then runs on the server's
+// event loop, so it must not block at all.
+#define MCP_STREAM_WOULD_BLOCK 2
+
+// Wakes up a waiting stream; may be called from any thread, any number of times,
+// until the generator is freed
+typedef void (*MCPStreamWakeup)(void *context);
+
+// Called after next() returned MCP_STREAM_WOULD_BLOCK.
+// Return a file descriptor that becomes readable when next() can make progress (POSIX only, the plugin
+// keeps ownership), or -1 and call wakeup(context) once it can. The server also calls next() again
+// after a while without either, so a spurious MCP_STREAM_WOULD_BLOCK is harmless.
+typedef int (*StreamGeneratorWait)(StreamGenerator generator, MCPStreamWakeup wakeup, void *context);
+
+// Called when the client cancels the stream, before the generator is freed. Should make a next()
+// in progress return soon (with 1 or -1); may be called from any thread, at most once.
+typedef void (*StreamGeneratorCancel)(StreamGenerator generator);
+
+// Checkpoints: a generator that can describe its position compactly (an offset, a cursor) lets the
+// server resume its stream after the generator is gone, because it expired, the client reconnected to
+// another node or the server restarted, instead of running the tool again from the start.
+// Called after next() returned an event; writes the position after that event into buffer and returns
+// its length. Returns the length needed without writing anything if size is too small, and 0 if there is
+// no checkpoint for this position. Must not block; checkpoints longer than MCP_STREAM_CHECKPOINT_MAX are
+// not kept.
+typedef size_t (*StreamGeneratorCheckpoint)(StreamGenerator generator, char *buffer, size_t size);
+
+#define MCP_STREAM_CHECKPOINT_MAX 4096
+
+// Optional export stream_restore, used with get_stream_checkpoint: start tool name again so that its
+// first event is the one after the checkpoint, which a generator of a call with the same arguments
+// wrote. Returns NULL and sets error if it cannot, the server then runs the tool from the start.
+typedef StreamGenerator (*stream_restore_func)(const char *name, const char *args_json, const char *checkpoint,
+                                               size_t checkpoint_size, MCPError *error);
+
 // Function pointer types for streaming
 using get_stream_next_func = StreamGeneratorNext (*)();
 using get_stream_free_func = StreamGeneratorFree (*)();
+using get_stream_wait_func = StreamGeneratorWait (*)();
+using get_stream_cancel_func = StreamGeneratorCancel (*)();
+using get_stream_checkpoint_func = StreamGeneratorCheckpoint (*)();
 
 struct StreamingResult {
     StreamGenerator generator;// the generator object
@@ -5,6 +5,7 @@ This SDK provides a simple way to create MCP plugins using Python with decorator
 and other syntactic sugar to make plugin development more intuitive and less error-prone.
 """
 
+import base64
 import json
 import functools
 from typing import Any, Dict, List, Callable, Optional, Union
@@ -12,6 +13,16 @@ from dataclasses import dataclass, field
 from enum import Enum
 
 
+BINARY_TYPES = (bytes, bytearray, memoryview)
+
+
+def _encode_binary(value: Any) -> str:
+    """json.dumps default: binary data nested in a result becomes base64, as the server writes it"""
+    if isinstance(value, BINARY_TYPES):
+        return base64.b64encode(value).decode("ascii")
+    raise TypeError(f"Object of type {type(value).__name__} is not JSON serializable")
+
+
 class ToolType(Enum):
     """Tool types supported by MCP"""
     STANDARD = "standard"
@@ -132,17 +143,57 @@ class MCPPlugin:
                 }
             })
         
-        if name not in self._tools:
+        result = self.call_tool_object(name, args)
+        if isinstance(result, BINARY_TYPES):
+            return result
+        try:
+            return json.dumps(result, default=_encode_binary)
+        except (TypeError, ValueError) as e:
             return json.dumps({
+                "error": {
+                    "type": "execution_error",
+                    "message": str(e)
+                }
+            })
+    
+    def start_stream(self, name: str, args: Dict[str, Any]) -> Any:
+        """
+        Start a streaming tool without consuming its output
+        
+        Args:
+            name: Tool name
+            args: Tool arguments
+            
+        Returns:
+            What the tool function returned: a generator, an async generator,
+            any other iterable, an awaitable or a single value
+        """
+        if name not in self._tools:
+            raise KeyError(f"Unknown tool: {name}")
+        return self._tools[name](**(args or {}))
+    
+    def call_tool_object(self, name: str, args: Dict[str, Any]) -> Dict[str, Any]:
+        """
+        Call a specific tool with parsed arguments
+        
+        Args:
+            name: Tool name
+            args: Tool arguments
+            
+        Returns:
+            Tool result, as call_tool would encode it
+        """
+        if name not in self._tools:
+            return {
                 "error": {
                     "type": "unknown_tool", 
                     "message": f"Unknown tool: {name}"
                 }
-            })
+            }
         
         try:
             # Call the tool function with arguments
-            result = self._tools[name](**args)
+            result = self._tools[name](**(args or {}))
             
             # Handle streaming tools differently
             if self._tool_infos[name].tool_type == ToolType.STREAMING:
@@ -152,19 +203,22 @@ class MCPPlugin:
                     # If it's a generator or iterator, convert to list
                     result = list(result)
             
-            # Return result as JSON
-            if isinstance(result, dict) and "error" in result:
-                return json.dumps(result)
+            # Binary results and complete results go to the server as they are; it encodes
+            # bytes straight from their buffer, without base64 or json.dumps in Python
+            if isinstance(result, BINARY_TYPES):
+                return result
+            if isinstance(result, dict) and ("error" in result or isinstance(result.get("content"), list)):
+                return result
             else:
-                return json.dumps({"result": result})
+                return {"result": result}
                 
         except Exception as e:
-            return json.dumps({
+            return {
                 "error": {
                     "type": "execution_error",
                     "message": str(e)
                 }
-            })
+            }
 
 
 # Global plugin instance
@@ -219,7 +273,54 @@ def call_tool(name: str, args_json: str) -> str:
     return _plugin.call_tool(name, args_json)
 
 
+def call_tool_object(name: str, args: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Call a specific tool with arguments already parsed
+    The C++ wrapper prefers this over call_tool: it converts the arguments
+    and the result itself, so they don't go through JSON text in Python
+    
+    Args:
+        name: Tool name
+        args: Tool arguments
+        
+    Returns:
+        Tool result
+    """
+    return _plugin.call_tool_object(name, args)
+
+
+def start_stream(name: str, args: Dict[str, Any]) -> Any:
+    """
+    Start a streaming tool
+    The C++ wrapper drives what it returns on an asyncio event loop and sends
+    each item as one stream event: async generators are iterated on the loop,
+    plain generators one item at a time in a thread, so neither blocks it
+    
+    Args:
+        name: Tool name
+        args: Tool arguments
+        
+    Returns:
+        The tool's generator, async generator or result
+    """
+    return _plugin.start_stream(name, args)
+
+
 # Convenience functions for creating parameters
+def image_content(data: Union[bytes, bytearray, memoryview], mime_type: str = "image/png") -> Dict[str, Any]:
+    """
+    Result holding one image, for a tool to return as it is
+
+    Args:
+        data: Image bytes, not base64: the server encodes them
+        mime_type: MIME type of the image
+
+    Returns:
+        Complete tool result
+    """
+    return {"content": [{"type": "image", "data": data, "mimeType": mime_type}]}
+
+
 def string_param(description: str = "", required: bool = False, default: str = None) -> ToolParameter:
     """Create a string parameter"""
     return ToolParameter(type="string", description=description, required=required, default=default)
@@ -0,0 +1,274 @@
+// plugins/sdk/mcp_stream.h
+#pragma once
+
+// Streaming tools written as C++20 coroutines. A tool's body co_yields the result JSON of each event and
+// co_awaits host_sleep() between them; the adapters below turn it into the generator the server drives:
+//
+//   mcp::sdk::Stream numbers(int count) {
+//       for (int i = 0; i < count; ++i) {
+//           co_yield mcp::protocol::generate_result({{"n", i}});
+//           co_await mcp::sdk::host_sleep(std::chrono::milliseconds(100));
+//       }
+//   }
+//
+//   call_tool:        return reinterpret_cast<const char *>(mcp::sdk::start(numbers(10)));
+//   get_stream_next:  return mcp::sdk::stream_next;   (and stream_free, stream_wait, stream_cancel)
+//   mcp_plugin_set_host_services: mcp::sdk::set_host_services(services);
+//
+// With host services, host_sleep suspends on a server timer and the stream waits through get_stream_wait
+// without holding a thread; without them it sleeps inside next(). The coroutine runs on whichever server
+// thread calls next(), one step at a time, so it needs no locking of its own.
+
+#include "mcp_plugin.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace mcp::sdk {
+
+    namespace detail {
+        inline const MCPHostServices *&host_services() {
+            static const MCPHostServices *services = nullptr;
+            return services;
+        }
+
+        // Shared with the timer callback, which can still come after the generator is gone
+        struct Wake {
+            std::mutex mutex;
+            bool fired = false;
+            MCPStreamWakeup wakeup = nullptr;
+            void *context = nullptr;
+            unsigned long long timer = 0;
+
+            static void fire(void *user, int /*cancelled*/) {
+                std::unique_ptr<std::shared_ptr<Wake>> wake(static_cast<std::shared_ptr<Wake> *>(user));
+                std::lock_guard lock((*wake)->mutex);
+                (*wake)->fired = true;
+                if ((*wake)->wakeup) {
+                    (*wake)->wakeup((*wake)->context);
+                }
+            }
+        };
+    }// namespace detail
+
+    /**
+     * @brief Call from mcp_plugin_set_host_services; without it host_sleep blocks.
+     */
+    inline void set_host_services(const MCPHostServices *services) {
+        detail::host_services() = services;
+    }
+
+    /**
+     * @brief Return type of a streaming tool's coroutine.
+     */
+    class Stream {
+    public:
+        struct promise_type {
+            std::string current;                ///< Last event yielded
+            bool yielded = false;
+            std::exception_ptr failure;
+            std::shared_ptr<detail::Wake> wake;///< Set while suspended in host_sleep on a timer
+
+            Stream get_return_object() { return Stream(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            std::suspend_always yield_value(std::string event) {
+                current = std::move(event);
+                yielded = true;
+                return {};
+            }
+            void return_void() {}
+            void unhandled_exception() { failure = std::current_exception(); }
+        };
+
+        Stream(Stream &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+        Stream &operator=(Stream &&) = delete;
+        ~Stream() {
+            if (handle_) {
+                handle_.destroy();
+            }
+        }
+
+        std::coroutine_handle<promise_type> release() { return std::exchange(handle_, nullptr); }
+
+    private:
+        explicit Stream(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    /**
+     * @brief Awaitable returned by host_sleep.
+     */
+    struct HostSleep {
+        std::chrono::milliseconds duration;
+
+        bool await_ready() const {
+            if (duration.count() <= 0) {
+                return true;
+            }
+            if (!detail::host_services()) {
+                std::this_thread::sleep_for(duration);
+                return true;
+            }
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<Stream::promise_type> handle) const {
+            const MCPHostServices *host = detail::host_services();
+            auto wake = std::make_shared<detail::Wake>();
+            handle.promise().wake = wake;
+            // The lock keeps fire() from reading timer before it is set
+            std::lock_guard lock(wake->mutex);
+            wake->timer = host->start_timer(host->context, static_cast<unsigned>(duration.count()), &detail::Wake::fire,
+                                            new std::shared_ptr<detail::Wake>(wake));
+        }
+
+        void await_resume() const {}
+    };
+
+    /**
+     * @brief Suspend the stream for a while, on a server timer if there are host services.
+     */
+    inline HostSleep host_sleep(std::chrono::milliseconds duration) {
+        return {duration};
+    }
+
+    namespace detail {
+        struct StreamState {
+            std::coroutine_handle<Stream::promise_type> handle;
+            std::atomic<bool> cancelled{false};
+            std::string error;
+            std::mutex mutex;
+            std::shared_ptr<Wake> pending;///< The promise's wake, for stream_cancel on another thread
+        };
+
+        inline StreamState &state_of(StreamGenerator generator) {
+            return *static_cast<StreamState *>(generator);
+        }
+    }// namespace detail
+
+    /**
+     * @brief Turn a coroutine into the generator call_tool returns for a streaming tool.
+     */
+    inline StreamGenerator start(Stream stream) {
+        auto *state = new detail::StreamState;
+        state->handle = stream.release();
+        return state;
+    }
+
+    /**
+     * @brief StreamGeneratorNext of coroutine streams: runs the coroutine up to its next event.
+     */
+    inline int stream_next(StreamGenerator generator, const char **result_json, MCPError *error) {
+        auto &state = detail::state_of(generator);
+        auto &promise = state.handle.promise();
+        *result_json = nullptr;
+        if (state.cancelled.load(std::memory_order_acquire)) {
+            return 1;
+        }
+        if (promise.wake) {
+            std::lock_guard lock(promise.wake->mutex);
+            if (!promise.wake->fired) {
+                return MCP_STREAM_WOULD_BLOCK;
+            }
+        }
+        if (promise.wake) {
+            std::lock_guard lock(state.mutex);
+            promise.wake.reset();
+            state.pending.reset();
+        }
+        if (state.handle.done()) {
+            return 1;
+        }
+
+        promise.yielded = false;
+        state.handle.resume();
+        if (promise.wake) {
+            std::lock_guard lock(state.mutex);
+            state.pending = promise.wake;
+        }
+        if (promise.failure) {
+            try {
+                std::rethrow_exception(std::exchange(promise.failure, nullptr));
+            } catch (const std::exception &e) {
+                state.error = e.what();
+            } catch (...) {
+                state.error = "Stream failed";
+            }
+            error->code = -32603;// INTERNAL_ERROR
+            error->message = state.error.c_str();
+            return -1;
+        }
+        if (promise.yielded) {
+            *result_json = promise.current.c_str();
+            return 0;
+        }
+        return promise.wake ? MCP_STREAM_WOULD_BLOCK : 1;
+    }
+
+    /**
+     * @brief StreamGeneratorWait of coroutine streams: wakes the server when host_sleep is over.
+     */
+    inline int stream_wait(StreamGenerator generator, MCPStreamWakeup wakeup, void *context) {
+        auto wake = detail::state_of(generator).handle.promise().wake;
+        bool fired = true;
+        if (wake) {
+            std::lock_guard lock(wake->mutex);
+            fired = wake->fired;
+            wake->wakeup = wakeup;
+            wake->context = context;
+        }
+        if (fired) {
+            wakeup(context);
+        }
+        return -1;
+    }
+
+    /**
+     * @brief StreamGeneratorCancel of coroutine streams: ends the stream, cutting a host_sleep short.
+     */
+    inline void stream_cancel(StreamGenerator generator) {
+        auto &state = detail::state_of(generator);
+        state.cancelled.store(true, std::memory_order_release);
+        std::shared_ptr<detail::Wake> wake;
+        {
+            std::lock_guard lock(state.mutex);
+            wake = state.pending;
+        }
+        if (wake && detail::host_services()) {
+            unsigned long long timer;
+            {
+                std::lock_guard lock(wake->mutex);
+                timer = wake->timer;
+            }
+            detail::host_services()->cancel_timer(detail::host_services()->context, timer);
+        }
+    }
+
+    /**
+     * @brief StreamGeneratorFree of coroutine streams.
+     */
+    inline void stream_free(StreamGenerator generator) {
+        auto *state = &detail::state_of(generator);
+        if (auto wake = state->handle.promise().wake) {
+            unsigned long long timer;
+            {
+                std::lock_guard lock(wake->mutex);
+                wake->wakeup = nullptr;
+                timer = wake->timer;
+            }
+            if (detail::host_services()) {
+                detail::host_services()->cancel_timer(detail::host_services()->context, timer);
+            }
+        }
+        state->handle.destroy();
+        delete state;
+    }
+
+}// namespace mcp::sdk
@@ -0,0 +1,208 @@
+// plugins/sdk/mcp_tools.h
+#pragma once
+
+// Tool metadata compiled into the plugin instead of read from a tools.json at load time. Each entry is
+// checked while compiling: a name of letters, digits, '_', '-' and '.', and parameters that are a
+// well-formed JSON object. A mistake fails the build instead of the plugin's load, and get_tools
+// returns static data without any I/O or parsing:
+//
+//   constinit ToolInfo g_tools[] = {
+//       mcp::sdk::tool("echo", "Returns its text", R"({"type":"object","properties":{"text":{"type":"string"}}})"),
+//       mcp::sdk::streaming_tool("tail", "Streams the lines appended to a file", R"({"type":"object"})"),
+//   };
+//
+//   extern "C" MCP_API ToolInfo *get_tools(int *count) {
+//       return mcp::sdk::tool_list(g_tools, count);
+//   }
+
+#include "mcp_plugin.h"
+#include <cstddef>
+#include <string_view>
+
+namespace mcp::sdk {
+
+    namespace detail {
+        constexpr size_t kInvalid = static_cast<size_t>(-1);
+        constexpr int kMaxDepth = 64;
+
+        constexpr size_t skip_space(std::string_view text, size_t i) {
+            while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n' || text[i] == '\r')) {
+                ++i;
+            }
+            return i;
+        }
+
+        constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+        constexpr bool is_hex(char c) { return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+        // Each returns the index after the value starting at i, kInvalid if there is none
+        constexpr size_t json_string(std::string_view text, size_t i) {
+            for (++i; i < text.size(); ++i) {
+                char c = text[i];
+                if (c == '"') {
+                    return i + 1;
+                }
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    return kInvalid;
+                }
+                if (c == '\\') {
+                    if (++i >= text.size()) {
+                        return kInvalid;
+                    }
+                    if (text[i] == 'u') {
+                        for (int k = 0; k < 4; ++k) {
+                            if (++i >= text.size() || !is_hex(text[i])) {
+                                return kInvalid;
+                            }
+                        }
+                    } else if (std::string_view("\"\\/bfnrt").find(text[i]) == std::string_view::npos) {
+                        return kInvalid;
+                    }
+                }
+            }
+            return kInvalid;
+        }
+
+        constexpr size_t json_number(std::string_view text, size_t i) {
+            if (i < text.size() && text[i] == '-') {
+                ++i;
+            }
+            if (i >= text.size() || !is_digit(text[i])) {
+                return kInvalid;
+            }
+            if (text[i] == '0') {
+                ++i;
+            } else {
+                while (i < text.size() && is_digit(text[i])) ++i;
+            }
+            if (i < text.size() && text[i] == '.') {
+                if (++i >= text.size() || !is_digit(text[i])) {
+                    return kInvalid;
+                }
+                while (i < text.size() && is_digit(text[i])) ++i;
+            }
+            if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+                ++i;
+                if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+                    ++i;
+                }
+                if (i >= text.size() || !is_digit(text[i])) {
+                    return kInvalid;
+                }
+                while (i < text.size() && is_digit(text[i])) ++i;
+            }
+            return i;
+        }
+
+        constexpr size_t json_value(std::string_view text, size_t i, int depth) {
+            i = skip_space(text, i);
+            if (i >= text.size() || depth > kMaxDepth) {
+                return kInvalid;
+            }
+            char c = text[i];
+            if (c == '"') {
+                return json_string(text, i);
+            }
+            if (c == '{' || c == '[') {
+                const char close = c == '{' ? '}' : ']';
+                i = skip_space(text, i + 1);
+                if (i < text.size() && text[i] == close) {
+                    return i + 1;
+                }
+                for (;;) {
+                    if (c == '{') {
+                        i = skip_space(text, i);
+                        if (i >= text.size() || text[i] != '"' || (i = json_string(text, i)) == kInvalid) {
+                            return kInvalid;
+                        }
+                        i = skip_space(text, i);
+                        if (i >= text.size() || text[i] != ':') {
+                            return kInvalid;
+                        }
+                        ++i;
+                    }
+                    if ((i = json_value(text, i, depth + 1)) == kInvalid) {
+                        return kInvalid;
+                    }
+                    i = skip_space(text, i);
+                    if (i < text.size() && text[i] == ',') {
+                        ++i;
+                    } else if (i < text.size() && text[i] == close) {
+                        return i + 1;
+                    } else {
+                        return kInvalid;
+                    }
+                }
+            }
+            for (std::string_view literal: {std::string_view("true"), std::string_view("false"), std::string_view("null")}) {
+                if (text.substr(i, literal.size()) == literal) {
+                    return i + literal.size();
+                }
+            }
+            return json_number(text, i);
+        }
+
+        constexpr bool is_json_object(std::string_view text) {
+            size_t start = skip_space(text, 0);
+            if (start >= text.size() || text[start] != '{') {
+                return false;
+            }
+            size_t end = json_value(text, start, 0);
+            return end != kInvalid && skip_space(text, end) == text.size();
+        }
+
+        constexpr bool is_tool_name(std::string_view name) {
+            if (name.empty() || name.size() > 128) {
+                return false;
+            }
+            for (char c: name) {
+                bool allowed = is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '-' || c == '.';
+                if (!allowed) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Reaching a throw while evaluating a consteval function is a compile error that shows the message
+        consteval ToolInfo checked(const char *name, const char *description, const char *parameters, bool is_streaming) {
+            if (!name || !is_tool_name(name)) {
+                throw "tool names are 1 to 128 letters, digits, '_', '-' or '.'";
+            }
+            if (!description) {
+                throw "a tool needs a description";
+            }
+            if (!parameters || !is_json_object(parameters)) {
+                throw "tool parameters must be a JSON object";
+            }
+            return ToolInfo{name, description, parameters, is_streaming};
+        }
+    }// namespace detail
+
+    /**
+     * @brief Metadata of a synchronous tool, checked at compile time.
+     * @param parameters JSON Schema of the arguments, as a JSON object
+     */
+    consteval ToolInfo tool(const char *name, const char *description, const char *parameters) {
+        return detail::checked(name, description, parameters, false);
+    }
+
+    /**
+     * @brief Metadata of a streaming tool, checked at compile time.
+     * @param parameters JSON Schema of the arguments, as a JSON object
+     */
+    consteval ToolInfo streaming_tool(const char *name, const char *description, const char *parameters) {
+        return detail::checked(name, description, parameters, true);
+    }
+
+    /**
+     * @brief What get_tools returns for a static table of tools.
+     */
+    template<size_t N>
+    ToolInfo *tool_list(ToolInfo (&tools)[N], int *count) {
+        *count = static_cast<int>(N);
+        return tools;
+    }
+
+}// namespace mcp::sdk
@@ -12,6 +12,7 @@
  */
 #pragma once
 
+#include "../src/business/plugin_error.h"
 #include "../src/business/python_plugin_instance.h"
 #include "../src/core/logger.h"
 #include "../src/core/mcpserver_api.h"
@@ -51,10 +52,7 @@ MCP_API ToolInfo *get_tools(int *count) {
 MCP_API const char *call_tool(const char *name, const char *args_json, MCPError *error) {
     if (g_plugin_instances.empty()) {
         MCP_ERROR("[PLUGIN] No plugin instances available");
-        if (error) {
-            error->code = -1;
-            error->message = strdup("No plugin instances available");
-        }
+        set_plugin_error(error, -1, "No plugin instances available");
         return nullptr;
     }
 
@@ -62,18 +60,56 @@ MCP_API const char *call_tool(const char *name, const char *args_json, MCPError
     return instance->call_tool(name, args_json, error);
 }
 
+MCP_API int mcp_plugin_abi_version() {
+    return MCP_PLUGIN_ABI_VERSION;
+}
+
+// ABI v2: results are written into the server's buffer instead of a strdup'd copy
+MCP_API int call_tool_v2(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error) {
+    if (g_plugin_instances.empty()) {
+        MCP_ERROR("[PLUGIN] No plugin instances available");
+        set_plugin_error(error, -1, "No plugin instances available");
+        return -1;
+    }
+
+    PythonPluginInstance *instance = g_plugin_instances.begin()->second.get();
+    return instance->call_tool_v2(name, args_json, output, error);
+}
+
+// Streaming tools return a generator driven by the plugin's event loop; next() never blocks,
+// the server waits through get_stream_wait instead
+MCP_API StreamGeneratorNext get_stream_next() {
+    return &PythonStreamLoop::next;
+}
+
+MCP_API StreamGeneratorFree get_stream_free() {
+    return &PythonStreamLoop::free;
+}
+
+MCP_API StreamGeneratorWait get_stream_wait() {
+    return &PythonStreamLoop::wait;
+}
+
+MCP_API StreamGeneratorCancel get_stream_cancel() {
+    return &PythonStreamLoop::cancel;
+}
+
+// Preloads the configured modules once the server listens
+MCP_API void mcp_plugin_server_started() {
+    for (auto &[path, instance]: g_plugin_instances) {
+        instance->warm_up();
+    }
+}
+
 // Free result function
 MCP_API void free_result(const char *result) {
     free((void *) result);
 }
 
-// Free error function
+// Free error function; the message belongs to the plugin (see MCPError), only the fields are reset
 MCP_API void free_error(MCPError *error) {
     if (error) {
-        if (error->message) {
-            free((void *) error->message);
-            error->message = nullptr;
-        }
+        error->message = nullptr;
         error->code = 0;
     }
 }
@@ -0,0 +1,70 @@
+"""Compare Google Benchmark JSON results against a baseline and fail on regressions.
+
+Usage:
+    python scripts/benchmark_gate.py BASELINE CURRENT [--threshold 0.10] [--metric real_time]
+
+BASELINE and CURRENT are JSON files written with --benchmark_out_format=json, or directories
+of them such as the build's benchmarks/ directory after "cmake --build . --target run_benchmarks".
+With repetitions the median aggregate is compared, otherwise the single run. Benchmarks present
+on one side only are listed but do not fail the gate.
+"""
+import argparse
+import json
+import sys
+from pathlib import Path
+
+
+def load_results(path):
+    """Map benchmark name -> time in nanoseconds, from a file or every *.json of a directory"""
+    files = sorted(Path(path).glob("*.json")) if Path(path).is_dir() else [Path(path)]
+    results = {}
+    for file in files:
+        with open(file, encoding="utf-8") as handle:
+            data = json.load(handle)
+        for benchmark in data.get("benchmarks", []):
+            if benchmark.get("run_type") == "aggregate" and benchmark.get("aggregate_name") != "median":
+                continue
+            name = benchmark.get("run_name", benchmark["name"])
+            results[(file.stem, name)] = benchmark
+    return results
+
+
+def to_ns(benchmark, metric):
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[benchmark.get("time_unit", "ns")]
+    return benchmark[metric] * scale
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fail when benchmarks got slower than a baseline")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10, help="Allowed slowdown, 0.10 = 10%%")
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"], default="real_time")
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+
+    regressions = 0
+    for key in sorted(baseline.keys() | current.keys()):
+        suite, name = key
+        if key not in baseline or key not in current:
+            print(f"  new/removed  {suite}/{name}")
+            continue
+        before = to_ns(baseline[key], args.metric)
+        after = to_ns(current[key], args.metric)
+        change = (after - before) / before if before > 0 else 0.0
+        marker = "REGRESSION" if change > args.threshold else "ok"
+        if change > args.threshold:
+            regressions += 1
+        print(f"  {marker:<11}  {suite}/{name}: {before:.1f} ns -> {after:.1f} ns ({change:+.1%})")
+
+    if regressions:
+        print(f"{regressions} benchmarks are more than {args.threshold:.0%} slower than the baseline")
+        return 1
+    print("No benchmark regressed beyond the threshold")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,205 @@
+"""Keep benchmark and mcp_bench results in one stable schema and compare two such files.
+
+Usage:
+    python scripts/perf_results.py collect OUTPUT INPUT... [--commit SHA] [--build-type TYPE]
+    python scripts/perf_results.py compare BASELINE CURRENT [--threshold 0.10]
+
+collect reads Google Benchmark JSON files (--benchmark_out_format=json), directories of them such
+as the build's benchmarks/ directory, and reports written by "mcp_bench --json". It writes:
+
+    {"schema": "mcpserver-perf/1",
+     "context": {"commit", "build_type", "cpu_model", "cpus", "host", "date"},
+     "scenarios": {"<name>": {"p50_ns", "p99_ns", "throughput", "unit"}}}
+
+p99_ns is null where the source has no distribution, as for microbenchmarks; throughput is in
+"unit" per second. Scenario names are "<benchmark executable>/<benchmark>" and
+"mcp_bench/<workload>".
+
+compare fails when a scenario's p50 or p99 rose, or its throughput fell, by more than the
+threshold. Scenarios present in only one file are listed but do not fail.
+"""
+import argparse
+import datetime
+import json
+import os
+import platform
+import socket
+import subprocess
+import sys
+from pathlib import Path
+
+SCHEMA = "mcpserver-perf/1"
+
+
+def cpu_model():
+    """Model name of the CPU, from /proc/cpuinfo on Linux"""
+    try:
+        with open("/proc/cpuinfo", encoding="utf-8") as handle:
+            for line in handle:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def git_commit(source_dir):
+    try:
+        return subprocess.run(["git", "-C", str(source_dir), "rev-parse", "HEAD"], capture_output=True, text=True,
+                              check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def benchmark_scenarios(suite, data):
+    """Scenarios of a Google Benchmark file; the median aggregate where there are repetitions"""
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    scenarios = {}
+    for benchmark in data.get("benchmarks", []):
+        if benchmark.get("run_type") == "aggregate" and benchmark.get("aggregate_name") != "median":
+            continue
+        name = f"{suite}/{benchmark.get('run_name', benchmark['name'])}"
+        p50 = benchmark["real_time"] * scale[benchmark.get("time_unit", "ns")]
+        if "items_per_second" in benchmark:
+            throughput, unit = benchmark["items_per_second"], "items"
+        elif "bytes_per_second" in benchmark:
+            throughput, unit = benchmark["bytes_per_second"], "bytes"
+        else:
+            throughput, unit = (1e9 / p50 if p50 > 0 else 0.0), "iterations"
+        scenarios[name] = {"p50_ns": p50, "p99_ns": None, "throughput": throughput, "unit": unit}
+    return scenarios
+
+
+def histogram_scenario(histogram, seconds, unit="requests"):
+    return {"p50_ns": histogram.get("p50", 0) * 1e3,
+            "p99_ns": histogram.get("p99", 0) * 1e3,
+            "throughput": histogram.get("count", 0) / seconds if seconds > 0 else 0.0,
+            "unit": unit}
+
+
+def mcp_bench_scenarios(data):
+    """Scenarios of an mcp_bench --json report, latencies are in microseconds there"""
+    seconds = data.get("duration_s", 0)
+    scenarios = {}
+    if data.get("mode") == "reconnect":
+        scenarios["mcp_bench/reconnect/replay"] = histogram_scenario(data["replay_us"], seconds, "reconnects")
+        scenarios["mcp_bench/reconnect/first_event"] = histogram_scenario(data["first_event_us"], seconds, "streams")
+        return scenarios
+    if data.get("mode") == "tls":
+        name = f"mcp_bench/tls/{data['tls_mode']}"
+        if data["tls_mode"] == "bulk":
+            scenarios[name] = histogram_scenario(data["latency_us"], seconds)
+            scenarios[name]["throughput"], scenarios[name]["unit"] = data["bytes_per_second"], "bytes"
+        else:
+            scenarios[name] = histogram_scenario(data["handshake_us"], seconds, "handshakes")
+        return scenarios
+    for workload, stats in data.get("workloads", {}).items():
+        scenarios[f"mcp_bench/{workload}"] = histogram_scenario(stats["latency_us"], seconds)
+        if stats.get("first_event_us", {}).get("count", 0) > 0:
+            scenarios[f"mcp_bench/{workload}/first_event"] = histogram_scenario(stats["first_event_us"], seconds)
+    return scenarios
+
+
+def load_inputs(paths):
+    scenarios = {}
+    for path in paths:
+        path = Path(path)
+        files = sorted(path.glob("*.json")) if path.is_dir() else [path]
+        for file in files:
+            with open(file, encoding="utf-8") as handle:
+                data = json.load(handle)
+            if data.get("schema") == SCHEMA:
+                continue  # an earlier collect output in the same directory
+            if "benchmarks" in data:
+                scenarios.update(benchmark_scenarios(file.stem, data))
+            elif "mode" in data:
+                scenarios.update(mcp_bench_scenarios(data))
+            else:
+                print(f"Skipping {file}: neither Google Benchmark nor mcp_bench output", file=sys.stderr)
+    return scenarios
+
+
+def collect(args):
+    context = {
+        "commit": args.commit or git_commit(args.source_dir),
+        "build_type": args.build_type or "unknown",
+        "cpu_model": cpu_model(),
+        "cpus": os.cpu_count(),
+        "host": socket.gethostname(),
+        "date": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds"),
+    }
+    results = {"schema": SCHEMA, "context": context, "scenarios": load_inputs(args.inputs)}
+    with open(args.output, "w", encoding="utf-8") as handle:
+        json.dump(results, handle, indent=2, sort_keys=True)
+        handle.write("\n")
+    print(f"{len(results['scenarios'])} scenarios of {context['commit'][:12]} ({context['build_type']}) "
+          f"written to {args.output}")
+    return 0
+
+
+def load_results(path):
+    with open(path, encoding="utf-8") as handle:
+        results = json.load(handle)
+    if results.get("schema") != SCHEMA:
+        raise SystemExit(f"{path} is not a {SCHEMA} file, write one with 'collect'")
+    return results
+
+
+def compare(args):
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+    for label, results in (("baseline", baseline), ("current", current)):
+        context = results["context"]
+        print(f"{label:<9} {context['commit'][:12]} {context['build_type']} on {context['cpu_model']}, {context['date']}")
+    if baseline["context"]["cpu_model"] != current["context"]["cpu_model"]:
+        print("Warning: the results come from different CPUs")
+
+    regressions = 0
+    before_all, after_all = baseline["scenarios"], current["scenarios"]
+    for name in sorted(before_all.keys() | after_all.keys()):
+        if name not in before_all or name not in after_all:
+            print(f"  new/removed  {name}")
+            continue
+        before, after = before_all[name], after_all[name]
+        changes = []
+        for metric in ("p50_ns", "p99_ns"):
+            if before.get(metric) and after.get(metric) is not None:
+                changes.append((metric, before[metric], after[metric], (after[metric] - before[metric]) / before[metric]))
+        if before.get("throughput"):
+            # Less throughput is worse, so it counts as a positive change
+            changes.append(("throughput", before["throughput"], after["throughput"],
+                            (before["throughput"] - after["throughput"]) / before["throughput"]))
+        for metric, old, new, change in changes:
+            marker = "REGRESSION" if change > args.threshold else "ok"
+            regressions += change > args.threshold
+            print(f"  {marker:<11}  {name} {metric}: {old:.1f} -> {new:.1f} ({change:+.1%} worse)")
+
+    if regressions:
+        print(f"{regressions} metrics are more than {args.threshold:.0%} worse than the baseline")
+        return 1
+    print("No scenario regressed beyond the threshold")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Persist and compare performance results")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    collect_parser = commands.add_parser("collect", help="Write results in the stable schema")
+    collect_parser.add_argument("output")
+    collect_parser.add_argument("inputs", nargs="+", help="Benchmark JSON files or directories, mcp_bench --json reports")
+    collect_parser.add_argument("--commit", help="Commit measured, default: HEAD of --source-dir")
+    collect_parser.add_argument("--build-type", help="CMAKE_BUILD_TYPE of the measured build")
+    collect_parser.add_argument("--source-dir", default=Path(__file__).resolve().parent.parent)
+
+    compare_parser = commands.add_parser("compare", help="Fail when a scenario got worse than a baseline")
+    compare_parser.add_argument("baseline")
+    compare_parser.add_argument("current")
+    compare_parser.add_argument("--threshold", type=float, default=0.10, help="Allowed change, 0.10 = 10%%")
+
+    args = parser.parse_args()
+    return collect(args) if args.command == "collect" else compare(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
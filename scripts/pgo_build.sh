@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+# Profile guided build of mcp-server++, trained with the mcp_bench workload.
+#
+# Usage: scripts/pgo_build.sh [BUILD_DIR] [extra cmake arguments...]
+#
+# 1. Configures BUILD_DIR with MCP_PGO=GENERATE and builds an instrumented server.
+# 2. Starts it from BUILD_DIR/bin with the config.ini found there. Then it runs mcp_bench with tool
+#    calls of echo, tools/list, bench_stream streams and a round of stream reconnects. Finally it
+#    stops the server with SIGINT, so the profiles are written.
+# 3. Reconfigures the same directory with MCP_PGO=USE and builds again. GCC finds its profiles by
+#    object path, so both builds have to share the directory.
+#
+# MCP_PGO_URL (default http://127.0.0.1:6666/mcp) and MCP_PGO_SECONDS (default 30) set where and
+# how long the training runs. The bench plugin is built for the training, see BUILD_BENCH_PLUGINS.
+set -euo pipefail
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=$(realpath -m "${1:-$SOURCE_DIR/build-pgo}")
+shift || true
+URL=${MCP_PGO_URL:-http://127.0.0.1:6666/mcp}
+SECONDS_PER_RUN=${MCP_PGO_SECONDS:-30}
+PROFILE_DIR="$BUILD_DIR/pgo"
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+configure() {
+    local phase=$1
+    shift
+    cmake -S "$SOURCE_DIR" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release -DMCP_PERF_PROFILE=ON \
+        -DBUILD_BENCH_PLUGINS=ON -DMCP_PGO="$phase" -DMCP_PGO_DIR="$PROFILE_DIR" "$@"
+    cmake --build "$BUILD_DIR" -j"$JOBS"
+}
+
+echo "== Instrumented build"
+rm -rf "$PROFILE_DIR"
+mkdir -p "$PROFILE_DIR"
+configure GENERATE "$@"
+
+echo "== Training"
+cd "$BUILD_DIR/bin"
+# clang writes raw profiles where LLVM_PROFILE_FILE says, one per process
+LLVM_PROFILE_FILE="$PROFILE_DIR/mcp-%p.profraw" ./mcp-server++ &
+SERVER_PID=$!
+trap 'kill "$SERVER_PID" 2>/dev/null || true' EXIT
+
+READY_URL="${URL%/mcp}/readyz"
+for _ in $(seq 1 60); do
+    if curl -sf "$READY_URL" >/dev/null 2>&1; then
+        break
+    fi
+    sleep 0.5
+done
+
+./mcp_bench "$URL" -c 32 -r 2000 -d "$SECONDS_PER_RUN" -m call=70,list=20,stream=10 \
+    --tool echo --arguments '{"text":"profile guided optimization"}' \
+    --stream-tool bench_stream --stream-arguments '{"count":20,"size":256,"rate":0}'
+./mcp_bench "$URL" --reconnect -c 64 -d 10 --disconnect-ms 200 \
+    --stream-tool bench_stream --stream-arguments '{"count":200,"size":128,"rate":100}'
+
+kill -INT "$SERVER_PID"
+wait "$SERVER_PID" || true
+trap - EXIT
+cd "$SOURCE_DIR"
+
+if ls "$PROFILE_DIR"/*.profraw >/dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILE_DIR/mcp.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+echo "== Optimized build"
+configure USE "$@"
+echo "Profile guided mcp-server++ in $BUILD_DIR/bin"
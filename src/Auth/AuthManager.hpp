@@ -1,14 +1,98 @@
 #pragma once
 
+#include "transport/header_map.h"
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 
+// ==============================
+// Accepted keys
+// ==============================
+/**
+ * @brief Immutable set of accepted keys, kept as SHA-256 digests only.
+ * A lookup hashes the presented key and compares it with every digest without stopping at a
+ * match, so the time taken does not depend on which key, or how much of one, was guessed.
+ */
+class AuthKeySet {
+public:
+    using Digest = std::array<unsigned char, SHA256_DIGEST_LENGTH>;
+
+    explicit AuthKeySet(const std::vector<std::string> &keys) {
+        for (const auto &key: keys) {
+            if (!key.empty()) {
+                digests_.push_back(digest(key));
+            }
+        }
+    }
+
+    static Digest digest(std::string_view key) {
+        Digest result;
+        SHA256(reinterpret_cast<const unsigned char *>(key.data()), key.size(), result.data());
+        return result;
+    }
+
+    bool contains(std::string_view key) const {
+        const Digest presented = digest(key);
+        int found = 0;
+        for (const auto &stored: digests_) {
+            found |= CRYPTO_memcmp(stored.data(), presented.data(), presented.size()) == 0;
+        }
+        return found != 0;
+    }
+
+    size_t size() const { return digests_.size(); }
+
+private:
+    std::vector<Digest> digests_;
+};
+
+/**
+ * @brief Last accepted credential of a connection, kept by the Session so that later requests on
+ *        the same connection skip hashing while the key set is unchanged.
+ */
+class AuthManagerBase;
+struct AuthDecision {
+    const AuthManagerBase *manager = nullptr;///< Manager that accepted it, nullptr if none yet
+    uint64_t generation = 0;                 ///< That manager's key set generation at the time
+    int64_t expires_at = 0;                  ///< Unix time the credential stops being valid, 0 = never
+    std::string credential;                  ///< Header value that was accepted
+};
+
+/**
+ * @brief The token of an "Authorization: Bearer" header without surrounding blanks, empty if there is none.
+ */
+inline std::string_view bearer_token(const mcp::transport::HeaderMap &headers) {
+    auto it = headers.find("Authorization");
+    if (it == headers.end()) {
+        return {};
+    }
+
+    std::string_view auth = it->second;
+    constexpr std::string_view prefix = "Bearer ";
+    if (!auth.starts_with(prefix)) {
+        return {};
+    }
+
+    std::string_view token = auth.substr(prefix.size());
+    size_t start = token.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = token.find_last_not_of(" \t");
+    return token.substr(start, end - start + 1);
+}
+
 // ==============================
 // Abstract Auth Manager
 // ==============================
@@ -16,82 +100,126 @@ class AuthManagerBase {
 public:
     virtual ~AuthManagerBase() = default;
 
-    virtual bool validate(const std::unordered_map<std::string, std::string> &headers) const = 0;
+    virtual bool validate(const mcp::transport::HeaderMap &headers) const = 0;
+
+    /**
+     * @brief Validate, reusing the connection's previous decision if it was made on the same
+     *        credential and key set.
+     * @param cached Decision stored on the session, updated when the headers are accepted anew
+     */
+    virtual bool validate(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const {
+        (void) cached;
+        return validate(headers);
+    }
+
+    /**
+     * @brief Like the cached validate(), but only if it is cheap enough for an io thread.
+     * @return The decision, or std::nullopt if it needs work such as a signature check; the caller
+     *         then runs the cached validate() on a worker thread
+     */
+    virtual std::optional<bool> validate_fast(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const {
+        return validate(headers, cached);
+    }
+
+    /**
+     * @brief Replace the accepted keys. Requests being checked keep the set they started with;
+     *        decisions cached on sessions are dropped. Managers without static keys ignore it.
+     */
+    virtual void set_keys(const std::vector<std::string> &keys) { (void) keys; }
+
     // Get the type of the auth manager
     virtual std::string type() const = 0;
 };
 
-// ==============================
-// X-API-Key Auth
-// ==============================
-class AuthManagerXApi final : public AuthManagerBase {
-private:
-    std::unordered_set<std::string> valid_keys_;
-
+/**
+ * @brief Manager that accepts a credential taken from a single header.
+ * The key set is swapped atomically by set_keys(); a generation counter tells cached decisions
+ * apart from those made on an older set, so the cached path reads one atomic integer.
+ */
+class AuthManagerKeyed : public AuthManagerBase {
 public:
-    explicit AuthManagerXApi(std::vector<std::string> api_keys) {
-        for (auto &key: api_keys) {
-            if (!key.empty()) {
-                valid_keys_.insert(std::move(key));
-            }
-        }
+    explicit AuthManagerKeyed(const std::vector<std::string> &keys)
+        : keys_(std::make_shared<const AuthKeySet>(keys)) {}
+
+    bool validate(const mcp::transport::HeaderMap &headers) const final {
+        auto credential = extract(headers);
+        return !credential.empty() && keys_.load(std::memory_order_acquire)->contains(credential);
     }
 
-    bool validate(const std::unordered_map<std::string, std::string> &headers) const override {
-        auto it = headers.find("X-API-Key");
-        if (it == headers.end()) {
+    bool validate(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const final {
+        auto credential = extract(headers);
+        if (credential.empty()) {
+            return false;
+        }
+        // Read before the keys: a set stored meanwhile carries a newer generation
+        const uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (cached.manager == this && cached.generation == generation && cached.credential.size() == credential.size() &&
+            CRYPTO_memcmp(cached.credential.data(), credential.data(), credential.size()) == 0) {
+            return true;
+        }
+        if (!keys_.load(std::memory_order_acquire)->contains(credential)) {
             return false;
         }
-        return valid_keys_.find(it->second) != valid_keys_.end();
+        cached.manager = this;
+        cached.generation = generation;
+        cached.credential.assign(credential);
+        return true;
     }
 
-    std::string type() const override {
-        return "X-API-Key";
+    void set_keys(const std::vector<std::string> &keys) override {
+        keys_.store(std::make_shared<const AuthKeySet>(keys), std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
     }
+
+    size_t key_count() const { return keys_.load(std::memory_order_acquire)->size(); }
+
+protected:
+    /**
+     * @brief The credential in the headers, empty if there is none.
+     */
+    virtual std::string_view extract(const mcp::transport::HeaderMap &headers) const = 0;
+
+private:
+    std::atomic<std::shared_ptr<const AuthKeySet>> keys_;
+    std::atomic<uint64_t> generation_{1};
 };
 
 // ==============================
-// Bearer Token Auth
+// X-API-Key Auth
 // ==============================
-class AuthManagerBearer final : public AuthManagerBase {
-private:
-    std::unordered_set<std::string> valid_tokens_;
-
+class AuthManagerXApi final : public AuthManagerKeyed {
 public:
-    explicit AuthManagerBearer(std::vector<std::string> tokens) {
-        for (auto &token: tokens) {
-            if (!token.empty()) {
-                valid_tokens_.insert(std::move(token));
-            }
-        }
+    explicit AuthManagerXApi(const std::vector<std::string> &api_keys) : AuthManagerKeyed(api_keys) {}
+
+    std::string type() const override {
+        return "X-API-Key";
     }
 
-    bool validate(const std::unordered_map<std::string, std::string> &headers) const override {
-        auto it = headers.find("Authorization");
+protected:
+    std::string_view extract(const mcp::transport::HeaderMap &headers) const override {
+        auto it = headers.find("X-API-Key");
         if (it == headers.end()) {
-            return false;
-        }
-
-        const std::string &auth = it->second;
-        constexpr std::string_view prefix = "Bearer ";
-        if (auth.substr(0, prefix.size()) != prefix) {
-            return false;
-        }
-
-        std::string token = auth.substr(prefix.size());
-        size_t start = token.find_first_not_of(" \t");
-        size_t end = token.find_last_not_of(" \t");
-        if (start == std::string::npos) {
-            return false;
+            return {};
         }
-        token = token.substr(start, end - start + 1);
-
-        return valid_tokens_.find(token) != valid_tokens_.end();
+        return it->second;
     }
+};
+
+// ==============================
+// Bearer Token Auth
+// ==============================
+class AuthManagerBearer final : public AuthManagerKeyed {
+public:
+    explicit AuthManagerBearer(const std::vector<std::string> &tokens) : AuthManagerKeyed(tokens) {}
 
     std::string type() const override {
         return "Bearer";
     }
+
+protected:
+    std::string_view extract(const mcp::transport::HeaderMap &headers) const override {
+        return bearer_token(headers);
+    }
 };
 
 class AuthManagerAny final : public AuthManagerBase {
@@ -102,13 +230,44 @@ public:
     explicit AuthManagerAny(std::vector<std::shared_ptr<AuthManagerBase>> managers)
         : managers_(std::move(managers)) {}
 
-    bool validate(const std::unordered_map<std::string, std::string> &headers) const override {
+    bool validate(const mcp::transport::HeaderMap &headers) const override {
         return std::any_of(managers_.begin(), managers_.end(),
                            [&headers](const auto &mgr) {
                                return mgr->validate(headers);
                            });
     }
 
+    std::optional<bool> validate_fast(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const override {
+        bool pending = false;
+        for (const auto &mgr: managers_) {
+            auto accepted = mgr->validate_fast(headers, cached);
+            if (accepted.value_or(false)) {
+                return true;
+            }
+            pending = pending || !accepted;
+        }
+        return pending ? std::nullopt : std::optional<bool>(false);
+    }
+
+    bool validate(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const override {
+        // The manager that accepted the connection last is asked first
+        for (const auto &mgr: managers_) {
+            if (mgr.get() == cached.manager && mgr->validate(headers, cached)) {
+                return true;
+            }
+        }
+        return std::any_of(managers_.begin(), managers_.end(),
+                           [&headers, &cached](const auto &mgr) {
+                               return mgr->validate(headers, cached);
+                           });
+    }
+
+    void set_keys(const std::vector<std::string> &keys) override {
+        for (const auto &mgr: managers_) {
+            mgr->set_keys(keys);
+        }
+    }
+
     std::string type() const override {
         std::string types;
         for (size_t i = 0; i < managers_.size(); ++i) {
@@ -119,4 +278,4 @@ public:
         }
         return types;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,736 @@
+#include "AuthManagerJwt.hpp"
+#include "core/logger.h"
+#include "utils/base64.h"
+
+#include <nlohmann/json.hpp>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/param_build.h>
+#include <openssl/rsa.h>
+#include <openssl/ssl.h>
+
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+
+
+namespace {
+
+    constexpr size_t kMaxTokenSize = 16 * 1024;
+    constexpr size_t kMaxDocumentSize = 1024 * 1024;
+    constexpr int kFetchTimeoutSeconds = 10;
+    constexpr int kMaxRedirects = 3;
+    constexpr auto kRetryInterval = std::chrono::seconds(30);
+    constexpr auto kMinRefreshInterval = std::chrono::seconds(10);
+
+    int64_t unix_now() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string openssl_error() {
+        unsigned long code = ERR_get_error();
+        if (code == 0) {
+            return "unknown error";
+        }
+        char buffer[256];
+        ERR_error_string_n(code, buffer, sizeof(buffer));
+        ERR_clear_error();
+        return buffer;
+    }
+
+    std::optional<std::string> base64url_decode(std::string_view text) {
+        std::string standard(text);
+        for (char &c: standard) {
+            if (c == '-') {
+                c = '+';
+            } else if (c == '_') {
+                c = '/';
+            } else if (c == '+' || c == '/') {
+                return std::nullopt;
+            }
+        }
+        std::string out(mcp::utils::base64_decoded_max_size(standard.size()), '\0');
+        auto size = mcp::utils::base64_decode(standard.data(), standard.size(), out.data());
+        if (!size) {
+            return std::nullopt;
+        }
+        out.resize(*size);
+        return out;
+    }
+
+    // ==============================
+    // JWKS fetching
+    // ==============================
+
+    struct Url {
+        bool tls = false;
+        std::string host;
+        std::string port;
+        std::string path;
+    };
+
+    std::optional<Url> parse_url(std::string_view text) {
+        Url url;
+        if (text.starts_with("https://")) {
+            url.tls = true;
+            text.remove_prefix(8);
+        } else if (text.starts_with("http://")) {
+            text.remove_prefix(7);
+        } else {
+            return std::nullopt;
+        }
+        size_t slash = text.find('/');
+        std::string_view authority = text.substr(0, slash);
+        url.path = slash == std::string_view::npos ? "/" : std::string(text.substr(slash));
+        size_t colon = authority.rfind(':');
+        if (colon != std::string_view::npos && authority.find(']', colon) == std::string_view::npos) {
+            url.host = authority.substr(0, colon);
+            url.port = authority.substr(colon + 1);
+        } else {
+            url.host = authority;
+            url.port = url.tls ? "443" : "80";
+        }
+        if (url.host.empty()) {
+            return std::nullopt;
+        }
+        return url;
+    }
+
+    void set_socket_timeout(BIO *bio) {
+        int fd = -1;
+        if (BIO_get_fd(bio, &fd) < 0 || fd < 0) {
+            return;
+        }
+#ifdef _WIN32
+        DWORD timeout = kFetchTimeoutSeconds * 1000;
+        setsockopt(static_cast<SOCKET>(fd), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+        setsockopt(static_cast<SOCKET>(fd), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+#else
+        timeval timeout{kFetchTimeoutSeconds, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#endif
+    }
+
+    /**
+     * @brief GET one URL with HTTP/1.0, so the body is never chunked.
+     * @param location Set to the Location header of a redirect
+     * @return HTTP status, 0 with error set if there was no response
+     */
+    int http_get(const Url &url, std::string &body, std::string &location, std::string &error) {
+        std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> ctx(nullptr, SSL_CTX_free);
+        std::unique_ptr<BIO, decltype(&BIO_free_all)> bio(nullptr, BIO_free_all);
+        const std::string address = url.host + ":" + url.port;
+        if (url.tls) {
+            ctx.reset(SSL_CTX_new(TLS_client_method()));
+            if (!ctx) {
+                error = openssl_error();
+                return 0;
+            }
+            SSL_CTX_set_default_verify_paths(ctx.get());
+            SSL_CTX_set_verify(ctx.get(), SSL_VERIFY_PEER, nullptr);
+            bio.reset(BIO_new_ssl_connect(ctx.get()));
+            SSL *ssl = nullptr;
+            if (!bio || BIO_get_ssl(bio.get(), &ssl) <= 0 || !ssl) {
+                error = openssl_error();
+                return 0;
+            }
+            SSL_set_tlsext_host_name(ssl, url.host.c_str());
+            SSL_set1_host(ssl, url.host.c_str());
+            BIO_set_conn_hostname(bio.get(), address.c_str());
+        } else {
+            bio.reset(BIO_new_connect(address.c_str()));
+        }
+        if (!bio) {
+            error = "cannot connect to " + address + ": " + openssl_error();
+            return 0;
+        }
+        // Connect and handshake without blocking, so an unreachable host fails after the timeout
+        // like a slow one; then back to blocking I/O bounded by the socket timeouts
+        BIO_set_nbio(bio.get(), 1);
+        int connected = BIO_do_connect_retry(bio.get(), kFetchTimeoutSeconds, 0);
+        int fd = -1;
+        if (connected <= 0 || BIO_get_fd(bio.get(), &fd) < 0 || fd < 0 || !BIO_socket_nbio(fd, 0)) {
+            error = "cannot connect to " + address + ": " + (connected == 0 ? std::string("timed out") : openssl_error());
+            return 0;
+        }
+        set_socket_timeout(bio.get());
+
+        std::string request = "GET " + url.path + " HTTP/1.0\r\nHost: " + url.host +
+                              "\r\nAccept: application/json\r\nUser-Agent: mcp-server++\r\nConnection: close\r\n\r\n";
+        if (BIO_write(bio.get(), request.data(), static_cast<int>(request.size())) != static_cast<int>(request.size())) {
+            error = "cannot send the request to " + address;
+            return 0;
+        }
+
+        std::string response;
+        char buffer[16 * 1024];
+        int read;
+        while ((read = BIO_read(bio.get(), buffer, sizeof(buffer))) > 0) {
+            response.append(buffer, static_cast<size_t>(read));
+            if (response.size() > kMaxDocumentSize) {
+                error = "response larger than 1 MiB";
+                return 0;
+            }
+        }
+
+        size_t header_end = response.find("\r\n\r\n");
+        if (!response.starts_with("HTTP/1.") || header_end == std::string::npos || response.size() < 12) {
+            error = "malformed response from " + address;
+            return 0;
+        }
+        int status = std::atoi(response.c_str() + 9);
+
+        std::istringstream header_lines(response.substr(0, header_end));
+        std::string line;
+        while (std::getline(header_lines, line)) {
+            if (line.size() > 9 && (line.compare(0, 9, "Location:") == 0 || line.compare(0, 9, "location:") == 0)) {
+                location = line.substr(9);
+                location.erase(0, location.find_first_not_of(" \t"));
+                location.erase(location.find_last_not_of(" \t\r") + 1);
+            }
+        }
+        body = response.substr(header_end + 4);
+        return status;
+    }
+
+    /**
+     * @brief Read a JSON document from an http(s) URL, following a few redirects, or from a file.
+     */
+    std::optional<nlohmann::json> fetch_json(const std::string &source, std::string &error) {
+        std::string body;
+        if (source.starts_with("http://") || source.starts_with("https://")) {
+            std::string target = source;
+            for (int hop = 0;; ++hop) {
+                auto url = parse_url(target);
+                if (!url) {
+                    error = "invalid URL " + target;
+                    return std::nullopt;
+                }
+                std::string location;
+                int status = http_get(*url, body, location, error);
+                if (status == 0) {
+                    return std::nullopt;
+                }
+                if (status >= 300 && status < 400 && !location.empty() && hop < kMaxRedirects) {
+                    target = location.starts_with("/") ? (url->tls ? "https://" : "http://") + url->host + ":" + url->port + location : location;
+                    continue;
+                }
+                if (status != 200) {
+                    error = target + " answered HTTP " + std::to_string(status);
+                    return std::nullopt;
+                }
+                break;
+            }
+        } else {
+            std::ifstream file(source.starts_with("file://") ? source.substr(7) : source, std::ios::binary);
+            if (!file) {
+                error = "cannot open " + source;
+                return std::nullopt;
+            }
+            body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+
+        auto document = nlohmann::json::parse(body, nullptr, false);
+        if (document.is_discarded()) {
+            error = source + " is not JSON";
+            return std::nullopt;
+        }
+        return document;
+    }
+
+    // ==============================
+    // Keys and signatures
+    // ==============================
+
+    using PKey = std::shared_ptr<EVP_PKEY>;
+
+    PKey make_pkey(const char *type, OSSL_PARAM_BLD *builder) {
+        std::unique_ptr<OSSL_PARAM, decltype(&OSSL_PARAM_free)> params(OSSL_PARAM_BLD_to_param(builder), OSSL_PARAM_free);
+        std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx(EVP_PKEY_CTX_new_from_name(nullptr, type, nullptr), EVP_PKEY_CTX_free);
+        EVP_PKEY *pkey = nullptr;
+        if (!params || !ctx || EVP_PKEY_fromdata_init(ctx.get()) <= 0 ||
+            EVP_PKEY_fromdata(ctx.get(), &pkey, EVP_PKEY_PUBLIC_KEY, params.get()) <= 0) {
+            return nullptr;
+        }
+        return PKey(pkey, EVP_PKEY_free);
+    }
+
+    std::optional<std::string> member_bytes(const nlohmann::json &jwk, const char *name) {
+        auto it = jwk.find(name);
+        if (it == jwk.end() || !it->is_string()) {
+            return std::nullopt;
+        }
+        return base64url_decode(it->get_ref<const std::string &>());
+    }
+
+    PKey rsa_key(const nlohmann::json &jwk) {
+        auto n = member_bytes(jwk, "n");
+        auto e = member_bytes(jwk, "e");
+        if (!n || !e) {
+            return nullptr;
+        }
+        std::unique_ptr<BIGNUM, decltype(&BN_free)> modulus(BN_bin2bn(reinterpret_cast<const unsigned char *>(n->data()), static_cast<int>(n->size()), nullptr), BN_free);
+        std::unique_ptr<BIGNUM, decltype(&BN_free)> exponent(BN_bin2bn(reinterpret_cast<const unsigned char *>(e->data()), static_cast<int>(e->size()), nullptr), BN_free);
+        std::unique_ptr<OSSL_PARAM_BLD, decltype(&OSSL_PARAM_BLD_free)> builder(OSSL_PARAM_BLD_new(), OSSL_PARAM_BLD_free);
+        if (!modulus || !exponent || !builder ||
+            !OSSL_PARAM_BLD_push_BN(builder.get(), OSSL_PKEY_PARAM_RSA_N, modulus.get()) ||
+            !OSSL_PARAM_BLD_push_BN(builder.get(), OSSL_PKEY_PARAM_RSA_E, exponent.get())) {
+            return nullptr;
+        }
+        return make_pkey("RSA", builder.get());
+    }
+
+    PKey ec_key(const nlohmann::json &jwk, const std::string &curve, size_t coordinate_size) {
+        auto x = member_bytes(jwk, "x");
+        auto y = member_bytes(jwk, "y");
+        if (!x || !y || x->size() != coordinate_size || y->size() != coordinate_size) {
+            return nullptr;
+        }
+        std::string point = "\x04" + *x + *y;// Uncompressed
+        std::unique_ptr<OSSL_PARAM_BLD, decltype(&OSSL_PARAM_BLD_free)> builder(OSSL_PARAM_BLD_new(), OSSL_PARAM_BLD_free);
+        if (!builder ||
+            !OSSL_PARAM_BLD_push_utf8_string(builder.get(), OSSL_PKEY_PARAM_GROUP_NAME, curve.c_str(), 0) ||
+            !OSSL_PARAM_BLD_push_octet_string(builder.get(), OSSL_PKEY_PARAM_PUB_KEY, point.data(), point.size())) {
+            return nullptr;
+        }
+        return make_pkey("EC", builder.get());
+    }
+
+    size_t curve_size(std::string_view curve) {
+        if (curve == "P-256") {
+            return 32;
+        }
+        if (curve == "P-384") {
+            return 48;
+        }
+        if (curve == "P-521") {
+            return 66;
+        }
+        return 0;
+    }
+
+    enum class Family { RSA,
+                        PSS,
+                        EC };
+
+    struct Algorithm {
+        std::string_view name;
+        Family family;
+        const EVP_MD *(*digest)();
+        std::string_view curve;///< EC only
+    };
+
+    const Algorithm kAlgorithms[] = {
+            {"RS256", Family::RSA, EVP_sha256, {}},
+            {"RS384", Family::RSA, EVP_sha384, {}},
+            {"RS512", Family::RSA, EVP_sha512, {}},
+            {"PS256", Family::PSS, EVP_sha256, {}},
+            {"PS384", Family::PSS, EVP_sha384, {}},
+            {"PS512", Family::PSS, EVP_sha512, {}},
+            {"ES256", Family::EC, EVP_sha256, "P-256"},
+            {"ES384", Family::EC, EVP_sha384, "P-384"},
+            {"ES512", Family::EC, EVP_sha512, "P-521"},
+    };
+
+    const Algorithm *find_algorithm(std::string_view name) {
+        for (const auto &algorithm: kAlgorithms) {
+            if (algorithm.name == name) {
+                return &algorithm;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief JWS ECDSA signatures are r and s side by side; OpenSSL wants them DER encoded.
+     */
+    std::optional<std::string> ecdsa_der(std::string_view raw, size_t coordinate_size) {
+        if (raw.size() != 2 * coordinate_size) {
+            return std::nullopt;
+        }
+        const auto *bytes = reinterpret_cast<const unsigned char *>(raw.data());
+        ECDSA_SIG *sig = ECDSA_SIG_new();
+        BIGNUM *r = BN_bin2bn(bytes, static_cast<int>(coordinate_size), nullptr);
+        BIGNUM *s = BN_bin2bn(bytes + coordinate_size, static_cast<int>(coordinate_size), nullptr);
+        if (!sig || !r || !s || !ECDSA_SIG_set0(sig, r, s)) {
+            BN_free(r);
+            BN_free(s);
+            ECDSA_SIG_free(sig);
+            return std::nullopt;
+        }
+        unsigned char *der = nullptr;
+        int size = i2d_ECDSA_SIG(sig, &der);
+        ECDSA_SIG_free(sig);
+        if (size <= 0) {
+            return std::nullopt;
+        }
+        std::string out(reinterpret_cast<const char *>(der), static_cast<size_t>(size));
+        OPENSSL_free(der);
+        return out;
+    }
+
+    bool verify_signature(const Algorithm &algorithm, EVP_PKEY *key, std::string_view signing_input, std::string_view signature) {
+        std::string der;
+        if (algorithm.family == Family::EC) {
+            auto encoded = ecdsa_der(signature, curve_size(algorithm.curve));
+            if (!encoded) {
+                return false;
+            }
+            der = std::move(*encoded);
+            signature = der;
+        }
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        EVP_PKEY_CTX *pkey_ctx = nullptr;
+        if (!ctx || EVP_DigestVerifyInit(ctx.get(), &pkey_ctx, algorithm.digest(), nullptr, key) != 1) {
+            ERR_clear_error();
+            return false;
+        }
+        if (algorithm.family == Family::PSS &&
+            (EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) != 1 ||
+             EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, RSA_PSS_SALTLEN_DIGEST) != 1)) {
+            ERR_clear_error();
+            return false;
+        }
+        bool valid = EVP_DigestVerify(ctx.get(), reinterpret_cast<const unsigned char *>(signature.data()), signature.size(),
+                                      reinterpret_cast<const unsigned char *>(signing_input.data()), signing_input.size()) == 1;
+        ERR_clear_error();
+        return valid;
+    }
+
+    std::optional<int64_t> numeric_claim(const nlohmann::json &claims, const char *name) {
+        auto it = claims.find(name);
+        if (it == claims.end() || !it->is_number()) {
+            return std::nullopt;
+        }
+        return static_cast<int64_t>(it->get<double>());
+    }
+
+}// namespace
+
+struct AuthManagerJwt::KeySet {
+    struct Key {
+        std::string kid;
+        std::string alg;  ///< Empty if the JWK does not pin one
+        std::string curve;///< EC keys only
+        bool rsa = false;
+        PKey pkey;
+    };
+
+    std::vector<Key> keys;
+    std::string fingerprint;///< The JWKS "keys" member as read, to tell whether a refresh changed anything
+
+    const Key *find(std::string_view kid, const Algorithm &algorithm) const {
+        const Key *match = nullptr;
+        for (const auto &key: keys) {
+            if ((algorithm.family == Family::EC) == key.rsa) {
+                continue;
+            }
+            if (algorithm.family == Family::EC && key.curve != algorithm.curve) {
+                continue;
+            }
+            if (!key.alg.empty() && key.alg != algorithm.name) {
+                continue;
+            }
+            if (key.kid == kid) {
+                return &key;
+            }
+            if (kid.empty() && !match) {
+                match = &key;
+            }
+        }
+        return match;
+    }
+};
+
+AuthManagerJwt::AuthManagerJwt(JwtAuthOptions options)
+    : options_(std::move(options)),
+      keys_(std::make_shared<const KeySet>()),
+      jwks_url_(options_.jwks_url) {
+    refresher_ = std::thread([this]() { refresh_loop(); });
+}
+
+AuthManagerJwt::~AuthManagerJwt() {
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        stopping_ = true;
+    }
+    refresh_cv_.notify_all();
+    if (refresher_.joinable()) {
+        refresher_.join();
+    }
+}
+
+bool AuthManagerJwt::validate(const mcp::transport::HeaderMap &headers) const {
+    AuthDecision scratch;
+    return validate(headers, scratch);
+}
+
+std::optional<bool> AuthManagerJwt::validate_fast(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const {
+    std::string_view token = bearer_token(headers);
+    if (token.empty() || token.size() > kMaxTokenSize || std::count(token.begin(), token.end(), '.') != 2) {
+        return false;
+    }
+    const int64_t now = unix_now();
+    const uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (cached.manager == this && cached.generation == generation && now < cached.expires_at &&
+        cached.credential.size() == token.size() &&
+        CRYPTO_memcmp(cached.credential.data(), token.data(), token.size()) == 0) {
+        return true;
+    }
+    int64_t expires_at = 0;
+    if (!lookup(AuthKeySet::digest(token), generation, now, expires_at)) {
+        return std::nullopt;
+    }
+    cached.manager = this;
+    cached.generation = generation;
+    cached.expires_at = expires_at;
+    cached.credential.assign(token);
+    return true;
+}
+
+bool AuthManagerJwt::validate(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const {
+    if (auto accepted = validate_fast(headers, cached)) {
+        return *accepted;
+    }
+    std::string_view token = bearer_token(headers);
+    // Read before the keys: a set stored meanwhile carries a newer generation
+    const uint64_t generation = generation_.load(std::memory_order_acquire);
+    auto expires_at = verify(token);
+    if (!expires_at) {
+        return false;
+    }
+    remember(AuthKeySet::digest(token), generation, *expires_at);
+    cached.manager = this;
+    cached.generation = generation;
+    cached.expires_at = *expires_at;
+    cached.credential.assign(token);
+    return true;
+}
+
+std::optional<int64_t> AuthManagerJwt::verify(std::string_view token) const {
+    const size_t first = token.find('.');
+    const size_t second = token.find('.', first + 1);
+    auto header = nlohmann::json::parse(base64url_decode(token.substr(0, first)).value_or(""), nullptr, false);
+    if (header.is_discarded() || !header.is_object()) {
+        return std::nullopt;
+    }
+    auto alg = header.find("alg");
+    const Algorithm *algorithm = alg != header.end() && alg->is_string() ? find_algorithm(alg->get_ref<const std::string &>()) : nullptr;
+    if (!algorithm) {
+        MCP_DEBUG("JWT rejected: unsupported alg");
+        return std::nullopt;
+    }
+    auto kid_it = header.find("kid");
+    std::string kid = kid_it != header.end() && kid_it->is_string() ? kid_it->get<std::string>() : "";
+
+    auto keys = keys_.load(std::memory_order_acquire);
+    const auto *key = keys->find(kid, *algorithm);
+    if (!key) {
+        MCP_DEBUG("JWT rejected: no {} key '{}' in the JWKS", algorithm->name, kid);
+        request_refresh();
+        return std::nullopt;
+    }
+    auto signature = base64url_decode(token.substr(second + 1));
+    if (!signature || !verify_signature(*algorithm, key->pkey.get(), token.substr(0, second), *signature)) {
+        MCP_DEBUG("JWT rejected: bad signature");
+        return std::nullopt;
+    }
+
+    auto claims = nlohmann::json::parse(base64url_decode(token.substr(first + 1, second - first - 1)).value_or(""), nullptr, false);
+    if (claims.is_discarded() || !claims.is_object()) {
+        return std::nullopt;
+    }
+    const int64_t now = unix_now();
+    const int64_t leeway = options_.leeway.count();
+    auto exp = numeric_claim(claims, "exp");
+    if (!exp || now >= *exp + leeway) {
+        MCP_DEBUG("JWT rejected: expired or without exp");
+        return std::nullopt;
+    }
+    if (auto nbf = numeric_claim(claims, "nbf"); nbf && now + leeway < *nbf) {
+        MCP_DEBUG("JWT rejected: not valid yet");
+        return std::nullopt;
+    }
+    if (!options_.issuer.empty()) {
+        auto iss = claims.find("iss");
+        if (iss == claims.end() || !iss->is_string() || iss->get_ref<const std::string &>() != options_.issuer) {
+            MCP_DEBUG("JWT rejected: wrong issuer");
+            return std::nullopt;
+        }
+    }
+    if (!options_.audience.empty()) {
+        auto aud = claims.find("aud");
+        bool found = false;
+        if (aud != claims.end() && aud->is_string()) {
+            found = aud->get_ref<const std::string &>() == options_.audience;
+        } else if (aud != claims.end() && aud->is_array()) {
+            found = std::any_of(aud->begin(), aud->end(), [this](const nlohmann::json &entry) {
+                return entry.is_string() && entry.get_ref<const std::string &>() == options_.audience;
+            });
+        }
+        if (!found) {
+            MCP_DEBUG("JWT rejected: wrong audience");
+            return std::nullopt;
+        }
+    }
+    return *exp + leeway;
+}
+
+bool AuthManagerJwt::lookup(const Digest &digest, uint64_t generation, int64_t now, int64_t &expires_at) const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(digest);
+    if (it == cache_.end()) {
+        return false;
+    }
+    if (it->second->generation != generation || now >= it->second->expires_at) {
+        lru_.erase(it->second);
+        cache_.erase(it);
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    expires_at = it->second->expires_at;
+    return true;
+}
+
+void AuthManagerJwt::remember(const Digest &digest, uint64_t generation, int64_t expires_at) const {
+    if (options_.cache_size == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(digest);
+    if (it != cache_.end()) {
+        it->second->expires_at = expires_at;
+        it->second->generation = generation;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    lru_.push_front({digest, expires_at, generation});
+    cache_.emplace(digest, lru_.begin());
+    if (lru_.size() > options_.cache_size) {
+        cache_.erase(lru_.back().digest);
+        lru_.pop_back();
+    }
+}
+
+bool AuthManagerJwt::refresh(std::string &error) {
+    if (jwks_url_.empty()) {
+        if (options_.issuer.empty()) {
+            error = "neither jwt_jwks_url nor jwt_issuer is set";
+            return false;
+        }
+        std::string issuer = options_.issuer;
+        if (issuer.ends_with("/")) {
+            issuer.pop_back();
+        }
+        auto discovery = fetch_json(issuer + "/.well-known/openid-configuration", error);
+        if (!discovery) {
+            return false;
+        }
+        auto jwks_uri = discovery->find("jwks_uri");
+        if (jwks_uri == discovery->end() || !jwks_uri->is_string()) {
+            error = "the OpenID configuration of " + options_.issuer + " has no jwks_uri";
+            return false;
+        }
+        jwks_url_ = jwks_uri->get<std::string>();
+        MCP_INFO("JWKS of {} is at {}", options_.issuer, jwks_url_);
+    }
+
+    auto jwks = fetch_json(jwks_url_, error);
+    if (!jwks) {
+        return false;
+    }
+    auto members = jwks->find("keys");
+    if (members == jwks->end() || !members->is_array()) {
+        error = jwks_url_ + " is not a JWKS";
+        return false;
+    }
+
+    auto keys = std::make_shared<KeySet>();
+    keys->fingerprint = members->dump();
+    if (keys->fingerprint == keys_.load(std::memory_order_acquire)->fingerprint) {
+        return true;
+    }
+    for (const auto &jwk: *members) {
+        if (!jwk.is_object() || (jwk.contains("use") && jwk["use"] != "sig")) {
+            continue;
+        }
+        KeySet::Key key;
+        key.kid = jwk.value("kid", "");
+        key.alg = jwk.value("alg", "");
+        const std::string kty = jwk.value("kty", "");
+        if (kty == "RSA") {
+            key.rsa = true;
+            key.pkey = rsa_key(jwk);
+        } else if (kty == "EC") {
+            key.curve = jwk.value("crv", "");
+            if (size_t size = curve_size(key.curve)) {
+                key.pkey = ec_key(jwk, key.curve, size);
+            }
+        }
+        if (!key.pkey) {
+            MCP_WARN("Skipping JWK '{}' ({}): unsupported or malformed", key.kid, kty);
+            ERR_clear_error();
+            continue;
+        }
+        keys->keys.push_back(std::move(key));
+    }
+
+    const size_t count = keys->keys.size();
+    keys_.store(std::move(keys), std::memory_order_release);
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        lru_.clear();
+        cache_.clear();
+    }
+    MCP_INFO("Loaded {} JWT signing keys from {}", count, jwks_url_);
+    return true;
+}
+
+void AuthManagerJwt::refresh_loop() {
+    std::unique_lock<std::mutex> lock(refresh_mutex_);
+    bool ok = false;
+    bool first = true;
+    while (!stopping_) {
+        if (!first) {
+            auto wait = ok ? options_.refresh_interval : std::min<std::chrono::seconds>(options_.refresh_interval, kRetryInterval);
+            refresh_cv_.wait_for(lock, wait, [this]() { return stopping_ || refresh_requested_; });
+            if (stopping_) {
+                break;
+            }
+        }
+        first = false;
+        refresh_requested_ = false;
+        last_refresh_ = std::chrono::steady_clock::now();
+        lock.unlock();
+
+        std::string error;
+        ok = refresh(error);
+        if (!ok) {
+            MCP_WARN("JWKS refresh failed: {}", error);
+        }
+
+        lock.lock();
+    }
+}
+
+void AuthManagerJwt::request_refresh() const {
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        if (std::chrono::steady_clock::now() - last_refresh_ < kMinRefreshInterval) {
+            return;
+        }
+        refresh_requested_ = true;
+    }
+    refresh_cv_.notify_one();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "AuthManager.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+
+
+/**
+ * @brief Settings of AuthManagerJwt, normally the jwt_* options of [server].
+ */
+struct JwtAuthOptions {
+    std::string issuer;                        ///< Required iss claim, empty = any; keys are discovered from it if jwks_url is empty
+    std::string audience;                      ///< Required aud claim, empty = not checked
+    std::string jwks_url;                      ///< http(s) URL or file path of the JWKS
+    std::chrono::seconds refresh_interval{300};///< Time between JWKS fetches
+    std::chrono::seconds leeway{60};           ///< Clock skew allowed for exp and nbf
+    size_t cache_size = 10000;                 ///< Verified tokens remembered
+};
+
+// ==============================
+// JWT Bearer Auth
+// ==============================
+/**
+ * @brief Accepts "Authorization: Bearer <JWT>" signed by a key of the identity provider's JWKS.
+ *
+ * RS256/384/512, PS256/384/512 and ES256/384/512 are accepted, "none" and HMAC are not. A thread of
+ * its own fetches the JWKS at start, then every refresh_interval, and early when a token names a
+ * key it does not have.
+ *
+ * A verified token is remembered by its SHA-256 digest until it expires, in an LRU of cache_size
+ * entries, and on the session that presented it. Only a token not seen before has its signature
+ * checked, which validate_fast() leaves to a worker thread. A changed JWKS forgets them all.
+ */
+class AuthManagerJwt final : public AuthManagerBase {
+public:
+    explicit AuthManagerJwt(JwtAuthOptions options);
+    ~AuthManagerJwt() override;
+
+    AuthManagerJwt(const AuthManagerJwt &) = delete;
+    AuthManagerJwt &operator=(const AuthManagerJwt &) = delete;
+
+    bool validate(const mcp::transport::HeaderMap &headers) const override;
+    bool validate(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const override;
+    std::optional<bool> validate_fast(const mcp::transport::HeaderMap &headers, AuthDecision &cached) const override;
+
+    std::string type() const override {
+        return "JWT";
+    }
+
+private:
+    struct KeySet;
+    using Digest = AuthKeySet::Digest;
+
+    struct DigestHash {
+        size_t operator()(const Digest &digest) const {
+            size_t hash;
+            std::memcpy(&hash, digest.data(), sizeof(hash));
+            return hash;
+        }
+    };
+
+    struct CacheEntry {
+        Digest digest;
+        int64_t expires_at;
+        uint64_t generation;///< Of the key set that verified it
+    };
+
+    /**
+     * @brief Check the signature and claims of a token.
+     * @return Unix time it stops being accepted, leeway included, or std::nullopt if it is not valid
+     */
+    std::optional<int64_t> verify(std::string_view token) const;
+
+    bool lookup(const Digest &digest, uint64_t generation, int64_t now, int64_t &expires_at) const;
+    void remember(const Digest &digest, uint64_t generation, int64_t expires_at) const;
+
+    /**
+     * @brief Fetch the JWKS and swap it in if it changed.
+     */
+    bool refresh(std::string &error);
+    void refresh_loop();
+
+    /**
+     * @brief Wake the refresh thread for a token signed by an unknown key, at most every few seconds.
+     */
+    void request_refresh() const;
+
+    const JwtAuthOptions options_;
+    std::atomic<std::shared_ptr<const KeySet>> keys_;
+    std::atomic<uint64_t> generation_{1};
+
+    mutable std::mutex cache_mutex_;
+    mutable std::list<CacheEntry> lru_;///< Most recently used first
+    mutable std::unordered_map<Digest, std::list<CacheEntry>::iterator, DigestHash> cache_;
+
+    mutable std::mutex refresh_mutex_;
+    mutable std::condition_variable refresh_cv_;
+    mutable bool refresh_requested_ = false;
+    mutable std::chrono::steady_clock::time_point last_refresh_{};
+    bool stopping_ = false;
+    std::string jwks_url_;///< Discovered from the issuer if not configured; refresh thread only
+    std::thread refresher_;
+};
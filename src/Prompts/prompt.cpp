@@ -1,79 +1,351 @@
 // src/Prompts/prompt.cpp
 #include "prompt.h"
+#include "metrics/metrics_manager.h"
+#include "transport/LRUCache.hpp"
+#include "transport/notification_broadcast.h"
 #include <algorithm>
-#include <sstream>
+#include <array>
+#include <mutex>
+#include <stdexcept>
 
+namespace Astra::datastructures {
+
+    // Rendered results are shared with the responses, count the string they point to
+    template<>
+    struct CacheEntryBytes<std::shared_ptr<const std::string>> {
+        static size_t Heap(const std::shared_ptr<const std::string> &value) {
+            return value ? sizeof(std::string) + value->capacity() : 0;
+        }
+    };
+
+}// namespace Astra::datastructures
 
 namespace mcp::prompts {
 
+    // Memoized prompts/get results by prompt generation, name and argument values, counted as "prompt_renders"
+    class RenderCache : public Astra::datastructures::LRUCache<std::string, std::shared_ptr<const std::string>> {
+    public:
+        using LRUCache::LRUCache;
+
+        std::optional<std::shared_ptr<const std::string>> Lookup(const std::string &key) {
+            auto cached = Get(key);
+            (cached ? counters_->hits : counters_->misses).fetch_add(1, std::memory_order_relaxed);
+            return cached;
+        }
+
+        void Store(const std::string &key, const std::shared_ptr<const std::string> &value) {
+            Put(key, value);
+            counters_->resident_bytes.store(static_cast<int64_t>(MemoryUsage()), std::memory_order_relaxed);
+            counters_->entries.store(Size(), std::memory_order_relaxed);
+        }
+
+    private:
+        std::shared_ptr<mcp::metrics::CacheCounters> counters_ = mcp::metrics::MetricsManager::getInstance()->register_cache_counters("prompt_renders");
+    };
+
+    namespace {
+        // JSON string contents without the quotes; invalid UTF-8 is replaced rather than thrown on
+        std::string escape(const std::string &text) {
+            auto quoted = nlohmann::json(text).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            return quoted.substr(1, quoted.size() - 2);
+        }
+
+        // Builds the segment list of a prompt
+        class Builder {
+        public:
+            explicit Builder(CompiledPrompt &compiled) : compiled_(compiled) {}
+
+            void raw(const std::string &json) {
+                auto offset = static_cast<uint32_t>(compiled_.literals.size());
+                compiled_.literals += json;
+                auto &segments = compiled_.segments;
+                if (!segments.empty() && segments.back().slot < 0 &&
+                    segments.back().offset + segments.back().length == offset) {
+                    segments.back().length += static_cast<uint32_t>(json.size());// extend the previous literal
+                } else {
+                    segments.push_back({offset, static_cast<uint32_t>(json.size()), -1, CompiledPrompt::SlotKind::Value});
+                }
+            }
+
+            void text(const std::string &text) { raw(escape(text)); }
+
+            void slot(const std::string &name, CompiledPrompt::SlotKind kind) {
+                auto &names = compiled_.slot_names;
+                auto it = std::find(names.begin(), names.end(), name);
+                auto index = static_cast<int32_t>(it - names.begin());
+                if (it == names.end()) {
+                    names.push_back(name);
+                }
+                compiled_.segments.push_back({0, 0, index, kind});
+            }
+
+            // Template text: {{name}} becomes a slot, everything else stays literal
+            void message_text(const std::string &text) {
+                std::size_t pos = 0;
+                while (pos < text.size()) {
+                    auto open = text.find("{{", pos);
+                    auto close = open == std::string::npos ? std::string::npos : text.find("}}", open + 2);
+                    if (close == std::string::npos) {
+                        this->text(text.substr(pos));
+                        break;
+                    }
+                    this->text(text.substr(pos, open - pos));
+
+                    auto name = text.substr(open + 2, close - open - 2);
+                    auto first = name.find_first_not_of(' ');
+                    auto last = name.find_last_not_of(' ');
+                    if (first == std::string::npos) {
+                        this->text(text.substr(open, close + 2 - open));// "{{}}" is not a slot
+                    } else {
+                        slot(name.substr(first, last - first + 1), CompiledPrompt::SlotKind::Value);
+                    }
+                    pos = close + 2;
+                }
+            }
+
+        private:
+            CompiledPrompt &compiled_;
+        };
+
+        std::shared_ptr<const CompiledPrompt> compile(const Prompt &prompt) {
+            auto compiled = std::make_shared<CompiledPrompt>();
+            compiled->prompt = prompt;
+            for (const auto &arg: prompt.arguments) {
+                if (arg.required) {
+                    compiled->required.push_back(arg.name);
+                }
+            }
+
+            Builder out(*compiled);
+            out.raw("{");
+            if (prompt.description.has_value()) {
+                out.raw("\"description\":\"");
+                out.text(prompt.description.value());
+                out.raw("\",");
+            }
+            out.raw("\"messages\":[");
+
+            auto begin_message = [&out]() {
+                out.raw("{\"content\":{\"text\":\"");
+            };
+            auto end_message = [&out](const std::string &role) {
+                out.raw("\",\"type\":\"text\"},\"role\":\"");
+                out.text(role);
+                out.raw("\"}");
+            };
+
+            if (prompt.messages.empty()) {
+                // No template: a summary of the prompt and the arguments it was given
+                begin_message();
+                out.text("Prompt: " + prompt.name + "\n");
+                if (prompt.description.has_value()) {
+                    out.text("Description: " + prompt.description.value() + "\n");
+                }
+                out.text("Arguments:\n");
+                for (const auto &arg: prompt.arguments) {
+                    out.text("  - " + arg.name + ": " + arg.description.value_or(""));
+                    out.slot(arg.name, CompiledPrompt::SlotKind::Assignment);
+                    out.text("\n");
+                }
+                end_message("user");
+            } else {
+                for (std::size_t i = 0; i < prompt.messages.size(); ++i) {
+                    if (i > 0) {
+                        out.raw(",");
+                    }
+                    begin_message();
+                    out.message_text(prompt.messages[i].text);
+                    end_message(prompt.messages[i].role);
+                }
+            }
+            out.raw("]}");
+            return compiled;
+        }
+
+        // Escaped text of one slot
+        std::string render_slot(const nlohmann::json *value, CompiledPrompt::SlotKind kind) {
+            if (!value) {
+                return {};
+            }
+            if (kind == CompiledPrompt::SlotKind::Assignment) {
+                return escape(" = " + value->dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+            }
+            if (value->is_string()) {
+                return escape(value->get_ref<const std::string &>());
+            }
+            return escape(value->dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+        }
+
+        std::string render_compiled(const CompiledPrompt &compiled, const std::vector<const nlohmann::json *> &values) {
+            // Each slot is escaped once per kind, then everything is copied into one buffer
+            std::vector<std::array<std::optional<std::string>, 2>> rendered(values.size());
+            std::size_t size = 0;
+            for (const auto &segment: compiled.segments) {
+                if (segment.slot < 0) {
+                    size += segment.length;
+                    continue;
+                }
+                auto &text = rendered[segment.slot][static_cast<std::size_t>(segment.kind)];
+                if (!text) {
+                    text = render_slot(values[segment.slot], segment.kind);
+                }
+                size += text->size();
+            }
+
+            std::string out;
+            out.reserve(size);
+            for (const auto &segment: compiled.segments) {
+                if (segment.slot < 0) {
+                    out.append(compiled.literals, segment.offset, segment.length);
+                } else {
+                    out += *rendered[segment.slot][static_cast<std::size_t>(segment.kind)];
+                }
+            }
+            return out;
+        }
+    }// namespace
+
+    PromptManager::PromptManager() {
+        const auto &options = PromptRenderOptions::current();
+        if (options.cache_max_bytes > 0) {
+            render_cache_ = std::make_unique<RenderCache>(Astra::datastructures::MemoryBudget{options.cache_max_bytes});
+        }
+    }
+
+    PromptManager::~PromptManager() = default;
+
     void PromptManager::register_prompt(const Prompt &prompt) {
-        // Check if a prompt with the same name already exists
-        auto it = std::find_if(prompts_.begin(), prompts_.end(),
-                               [&prompt](const Prompt &p) { return p.name == prompt.name; });
+        auto compiled = compile(prompt);
 
-        if (it != prompts_.end()) {
+        std::unique_lock lock(mutex_);
+        auto it = prompt_index_.find(prompt.name);
+        if (it != prompt_index_.end()) {
             // If exists, replace it
-            *it = prompt;
+            prompts_[it->second] = std::move(compiled);
         } else {
             // Otherwise add new prompt
-            prompts_.push_back(prompt);
+            prompt_index_.emplace(prompt.name, prompts_.size());
+            prompts_.push_back(std::move(compiled));
         }
+        ++generation_;// results memoized for the old definition are never looked up again
+        list_result_.reset();
     }
 
     std::vector<Prompt> PromptManager::get_prompts() const {
-        return prompts_;
+        std::shared_lock lock(mutex_);
+        std::vector<Prompt> prompts;
+        prompts.reserve(prompts_.size());
+        for (const auto &compiled: prompts_) {
+            prompts.push_back(compiled->prompt);
+        }
+        return prompts;
     }
 
-    std::optional<PromptContent> PromptManager::get_prompt_content(const std::string &name, const nlohmann::json &arguments) const {
-        // Find matching prompt
-        auto it = std::find_if(prompts_.begin(), prompts_.end(),
-                               [&name](const Prompt &p) { return p.name == name; });
+    std::shared_ptr<const core::PagedList> PromptManager::list_result() const {
+        {
+            std::shared_lock lock(mutex_);
+            if (list_result_) {
+                return list_result_;
+            }
+        }
 
-        if (it == prompts_.end()) {
-            return std::nullopt;
+        std::unique_lock lock(mutex_);
+        if (list_result_) {
+            return list_result_;// another thread built it while we waited
         }
+        // A replaced prompt keeps its place, so the order is stable for cursors
+        auto list = std::make_shared<core::PagedList>();
+        list->version = ++list_version_;
+        list->array = "prompts";
+        std::string prompts;
+        for (const auto &compiled: prompts_) {
+            list->keys.push_back(compiled->prompt.name);
+            prompts += prompts.empty() ? "[" : ",";
+            prompts += list->entries.emplace_back(to_json(compiled->prompt).dump());
+        }
+        prompts += prompts.empty() ? "[]" : "]";
+        list->full = std::make_shared<const std::string>(R"({"prompts":)" + prompts + "}");
+        list_result_ = std::move(list);
+        return list_result_;
+    }
 
-        PromptContent content;
-        content.description = it->description;
+    std::shared_ptr<const std::string> PromptManager::render(const std::string &name, const nlohmann::json &arguments) const {
+        std::shared_ptr<const CompiledPrompt> compiled;
+        uint64_t generation;
+        {
+            std::shared_lock lock(mutex_);
+            auto it = prompt_index_.find(name);
+            if (it == prompt_index_.end()) {
+                return nullptr;
+            }
+            compiled = prompts_[it->second];
+            generation = generation_;
+        }
 
-        // Create sample message content
-        // In actual implementation, concrete messages should be generated here based on prompt definition and provided arguments
-        PromptMessage message;
-        message.role = "user";
+        bool has_arguments = arguments.is_object();
+        for (const auto &required: compiled->required) {
+            if (!has_arguments || !arguments.contains(required)) {
+                throw std::invalid_argument("Missing required argument '" + required + "'");
+            }
+        }
 
-        // Build information text containing prompt name and arguments
-        std::ostringstream text_stream;
-        text_stream << "Prompt: " << name << "\n";
-        if (it->description.has_value()) {
-            text_stream << "Description: " << it->description.value() << "\n";
+        std::vector<const nlohmann::json *> values;
+        values.reserve(compiled->slot_names.size());
+        for (const auto &slot: compiled->slot_names) {
+            auto it = has_arguments ? arguments.find(slot) : arguments.end();
+            values.push_back(has_arguments && it != arguments.end() ? &*it : nullptr);
         }
-        text_stream << "Arguments:\n";
 
-        for (const auto &arg: it->arguments) {
-            text_stream << "  - " << arg.name << ": ";
-            if (arg.description.has_value()) {
-                text_stream << arg.description.value();
+        // only the arguments the prompt uses are part of the key
+        std::string key;
+        if (render_cache_) {
+            key = std::to_string(generation);
+            key += '\0';
+            key += name;
+            for (const auto *value: values) {
+                key += '\0';
+                if (value) {
+                    key += value->dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+                }
             }
-            if (arguments.contains(arg.name)) {
-                text_stream << " = " << arguments[arg.name].dump();
+            if (auto cached = render_cache_->Lookup(key)) {
+                return *cached;
             }
-            text_stream << "\n";
         }
 
-        nlohmann::json content_json;
-        content_json["type"] = "text";
-        content_json["text"] = text_stream.str();
-        message.content = content_json;
+        auto result = std::make_shared<const std::string>(render_compiled(*compiled, values));
+        if (render_cache_) {
+            render_cache_->Store(key, result);
+        }
+        return result;
+    }
 
-        content.messages.push_back(message);
+    std::optional<PromptContent> PromptManager::get_prompt_content(const std::string &name, const nlohmann::json &arguments) const {
+        auto result = render(name, arguments);
+        if (!result) {
+            return std::nullopt;
+        }
 
+        auto json = nlohmann::json::parse(*result);
+        PromptContent content;
+        if (json.contains("description")) {
+            content.description = json["description"].get<std::string>();
+        }
+        for (const auto &message: json["messages"]) {
+            content.messages.push_back({message["role"].get<std::string>(), message["content"]});
+        }
         return content;
     }
 
     void PromptManager::notify_list_changed() {
-        // Notify clients that prompt list has changed
-        //todo notifications/prompts/list_changed
-        // and then the client would refetch the prompt list
+        {
+            std::unique_lock lock(mutex_);
+            list_result_.reset();
+        }
+        // Clients refetch the prompt list; the notification is the same for everyone, so it is serialized once
+        static const auto notification = transport::NotificationBroadcast::encode(
+                {{"jsonrpc", "2.0"}, {"method", "notifications/prompts/list_changed"}});
+        transport::NotificationBroadcast::instance().broadcast(notification);
     }
 
 }// namespace mcp::prompts
\ No newline at end of file
@@ -1,20 +1,47 @@
 // src/Prompts/prompt.h
 #pragma once
 
+#include "core/paged_list.h"
 #include "nlohmann/json.hpp"
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace mcp::prompts {
 
+    // Settings of prompts/get rendering, normally taken from the [cache] section
+    struct PromptRenderOptions {
+        std::size_t cache_max_bytes = 8 * 1024 * 1024;// Memory budget of memoized results, 0 = no memoization
+
+        static const PromptRenderOptions &current() { return storage(); }
+
+        // Set the options. Call once at startup, before the PromptManager is created
+        static void configure(PromptRenderOptions options) { storage() = options; }
+
+    private:
+        static PromptRenderOptions &storage() {
+            static PromptRenderOptions options;
+            return options;
+        }
+    };
+
+    // Message of a prompt, {{name}} in its text is replaced by the value of argument name
+    struct PromptMessageTemplate {
+        std::string role = "user";// Message role (user, assistant)
+        std::string text;         // Template text
+    };
+
     // Prompt struct, represents a prompt template
     struct Prompt {
         std::string name;                            // Unique identifier for the prompt
         std::optional<std::string> description;      // Human-readable description
         std::vector<struct PromptArgument> arguments;// Optional list of arguments
+        std::vector<PromptMessageTemplate> messages; // Message templates, empty for a summary of the arguments
     };
 
     // Prompt argument struct
@@ -42,8 +69,8 @@ namespace mcp::prompts {
         nlohmann::json j;
         j["name"] = prompt.name;
 
-        if (!prompt.description.has_value()) {
-            j["description"] = prompt.description;
+        if (prompt.description.has_value()) {
+            j["description"] = prompt.description.value();
         }
 
         if (!prompt.arguments.empty()) {
@@ -96,8 +123,8 @@ namespace mcp::prompts {
     inline nlohmann::json to_json(const PromptContent &content) {
         nlohmann::json j;
 
-        if (!content.description.has_value()) {
-            j["description"] = content.description;
+        if (content.description.has_value()) {
+            j["description"] = content.description.value();
         }
 
         if (!content.messages.empty()) {
@@ -115,24 +142,62 @@ namespace mcp::prompts {
     // Prompt update callback function signature
     using PromptUpdateCallback = std::function<void(const std::string &name)>;
 
+    class RenderCache;
+
+    // Prompt compiled at registration: literal spans, already JSON-escaped, and argument slots
+    struct CompiledPrompt {
+        enum class SlotKind : uint8_t {
+            Value,     // Argument value, strings without quotes, empty if missing
+            Assignment,// " = " and the argument as JSON, nothing if missing
+        };
+
+        struct Segment {
+            uint32_t offset = 0;            // Literal span in literals
+            uint32_t length = 0;            // Literal length, 0 for a slot
+            int32_t slot = -1;              // Index in slot_names, -1 for a literal
+            SlotKind kind = SlotKind::Value;// How the slot is rendered
+        };
+
+        Prompt prompt;
+        std::string literals;               // Serialized prompts/get result without the argument values
+        std::vector<Segment> segments;      // In output order
+        std::vector<std::string> slot_names;// Distinct arguments the result depends on
+        std::vector<std::string> required;  // Arguments that must be given
+    };
+
+    // Shared by all requests; safe to use from several threads
     class PromptManager {
     public:
-        PromptManager() = default;
+        PromptManager();
+        ~PromptManager();
 
-        // Register static prompt
+        // Register static prompt, replacing one of the same name
         void register_prompt(const Prompt &prompt);
 
         // Get all registered prompts
         std::vector<Prompt> get_prompts() const;
 
+        // Serialized prompts/list result, whole and prompt by prompt for paging; built once and reused until the list changes
+        std::shared_ptr<const core::PagedList> list_result() const;
+
+        // Serialized prompts/get result, memoized per argument values; nullptr for an unknown prompt.
+        // Throws std::invalid_argument when a required argument is missing
+        std::shared_ptr<const std::string> render(const std::string &name, const nlohmann::json &arguments) const;
+
         // Get content of a specific prompt
         std::optional<PromptContent> get_prompt_content(const std::string &name, const nlohmann::json &arguments) const;
 
-        // Notify prompt list change
+        // Notify prompt list change, broadcast to every open event stream as notifications/prompts/list_changed
         void notify_list_changed();
 
     private:
-        std::vector<Prompt> prompts_;
+        mutable std::shared_mutex mutex_;                       // Guards the members below
+        mutable std::shared_ptr<const core::PagedList> list_result_;// nullptr until built, reset on changes
+        mutable uint64_t list_version_ = 0;                         // Bumped by every rebuild of list_result_
+        std::vector<std::shared_ptr<const CompiledPrompt>> prompts_;
+        std::unordered_map<std::string, size_t> prompt_index_;// name -> index in prompts_
+        uint64_t generation_ = 0;                             // Bumped by every registration, part of memo keys
+        std::unique_ptr<RenderCache> render_cache_;           // nullptr without memoization
         std::unordered_map<std::string, std::vector<PromptUpdateCallback>> subscriptions_;
     };
 
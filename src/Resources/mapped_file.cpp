@@ -0,0 +1,84 @@
+// src/Resources/mapped_file.cpp
+#include "mapped_file.h"
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace mcp::resources {
+
+    std::shared_ptr<const MappedFile> MappedFile::open(const std::string &path) {
+        std::shared_ptr<MappedFile> file(new MappedFile());
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        file->fd_ = fd;// closed by the destructor from here on
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            return nullptr;
+        }
+        // An empty file cannot be mapped, it is an empty view
+        if (st.st_size > 0) {
+            void *data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                return nullptr;
+            }
+            file->data_ = data;
+            file->size_ = static_cast<size_t>(st.st_size);
+        }
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return nullptr;
+        }
+        file->buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+#endif
+        return file;
+    }
+
+    MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+        if (data_) ::munmap(data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    int MappedFile::native_handle() const {
+#if !defined(_WIN32)
+        return fd_;
+#else
+        return -1;
+#endif
+    }
+
+    std::string_view MappedFile::bytes() const {
+#if !defined(_WIN32)
+        return data_ ? std::string_view(static_cast<const char *>(data_), size_) : std::string_view();
+#else
+        return buffer_;
+#endif
+    }
+
+    void MappedFile::will_read([[maybe_unused]] std::size_t offset, [[maybe_unused]] std::size_t length) const {
+#if !defined(_WIN32) && defined(POSIX_MADV_SEQUENTIAL)
+        if (!data_ || offset >= size_ || length == 0) {
+            return;
+        }
+        // madvise wants a page-aligned start
+        auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t start = offset / page * page;
+        std::size_t end = std::min(size_, offset + length);
+        ::posix_madvise(static_cast<char *>(data_) + start, end - start, POSIX_MADV_SEQUENTIAL);
+#endif
+    }
+
+}// namespace mcp::resources
\ No newline at end of file
@@ -0,0 +1,59 @@
+// src/Resources/mapped_file.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace mcp::resources {
+
+    /**
+     * @brief Read-only view of a whole file, mapped into memory where the platform allows it.
+     *
+     * Pages are only read in as the view is touched, so handing out a range of a large file
+     * costs no more memory than the range itself. The file stays open while the view exists, so
+     * a range can also be sent to a socket straight from its descriptor.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @brief Map a file.
+         * @param path File path
+         * @return Mapped file, or nullptr if it cannot be opened
+         */
+        static std::shared_ptr<const MappedFile> open(const std::string &path);
+
+        ~MappedFile();
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        std::string_view bytes() const;
+        std::size_t size() const { return bytes().size(); }
+
+        /**
+         * @brief Hint that a range is about to be read sequentially.
+         * @param offset First byte
+         * @param length Number of bytes
+         */
+        void will_read(std::size_t offset, std::size_t length) const;
+
+        /**
+         * @brief Descriptor of the open file, for sendfile(2).
+         * @return Descriptor, or -1 where the file is not kept open
+         */
+        int native_handle() const;
+
+    private:
+        MappedFile() = default;
+
+#if !defined(_WIN32)
+        void *data_ = nullptr;
+        std::size_t size_ = 0;
+        int fd_ = -1;
+#else
+        std::string buffer_;
+#endif
+    };
+
+}// namespace mcp::resources
\ No newline at end of file
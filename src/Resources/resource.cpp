@@ -1,99 +1,267 @@
 // src/Resources/resource.cpp
 #include "resource.h"
+#include "core/logger.h"
+#include "transport/notification_broadcast.h"
+#include "utils/base64.h"
+#include "utils/content_hash.h"
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <filesystem>
 #include <unordered_map>
 
 namespace mcp::resources {
 
+    bool is_text_mime_type(const std::string &mimeType) {
+        return mimeType.find("text/") == 0 ||
+               mimeType == "application/json" ||
+               mimeType == "application/xml";
+    }
+
+    ResourceManager::ResourceManager()
+        : subscriptions_(SubscriptionOptions::current(), [](const std::string &uri) {
+              nlohmann::json notification;
+              notification["jsonrpc"] = "2.0";
+              notification["method"] = "notifications/resources/updated";
+              notification["params"]["uri"] = uri;
+              return transport::NotificationBroadcast::encode(notification);
+          }) {
+    }
+
     void ResourceManager::register_resource(const Resource &resource) {
+        std::unique_lock lock(mutex_);
+        // a uri registered twice keeps resolving to the first resource
+        resource_index_.emplace(resource.uri, resources_.size());
         resources_.push_back(resource);
+        list_result_.reset();
     }
 
-    void ResourceManager::register_resource_template(const ResourceTemplate &resourceTemplate) {
+    void ResourceManager::register_resource_template(const ResourceTemplate &resourceTemplate, ResourceTemplateReader reader) {
+        std::unique_lock lock(mutex_);
+        if (!template_matcher_.add(resourceTemplate.uriTemplate, resource_templates_.size())) {
+            MCP_WARN("Resource template {} uses an unsupported expression, it is listed but never matched",
+                     resourceTemplate.uriTemplate);
+        }
         resource_templates_.push_back(resourceTemplate);
+        template_readers_.push_back(std::move(reader));
+        list_result_.reset();
     }
 
     std::vector<Resource> ResourceManager::get_resources() const {
+        std::shared_lock lock(mutex_);
         return resources_;
     }
 
     std::vector<ResourceTemplate> ResourceManager::get_resource_templates() const {
+        std::shared_lock lock(mutex_);
         return resource_templates_;
     }
 
+    std::shared_ptr<const core::PagedList> ResourceManager::list_result() const {
+        {
+            std::shared_lock lock(mutex_);
+            if (list_result_) {
+                return list_result_;
+            }
+        }
+
+        std::unique_lock lock(mutex_);
+        if (list_result_) {
+            return list_result_;// another thread built it while we waited
+        }
+
+        auto list = std::make_shared<core::PagedList>();
+        list->version = ++list_version_;
+        list->array = "resources";
+        nlohmann::json resource_list = nlohmann::json::array();
+        for (const auto &resource: resources_) {
+            nlohmann::json res;
+            res["uri"] = resource.uri;
+            res["name"] = resource.name;
+            if (!resource.description.empty()) {
+                res["description"] = resource.description;
+            }
+            if (!resource.mimeType.empty()) {
+                res["mimeType"] = resource.mimeType;
+            }
+            list->keys.push_back(resource.uri);
+            list->entries.push_back(res.dump());
+            resource_list.push_back(res);
+        }
+
+        nlohmann::json template_list = nlohmann::json::array();
+        for (const auto &resourceTemplate: resource_templates_) {
+            nlohmann::json tmpl;
+            tmpl["uriTemplate"] = resourceTemplate.uriTemplate;
+            tmpl["name"] = resourceTemplate.name;
+            if (!resourceTemplate.description.empty()) {
+                tmpl["description"] = resourceTemplate.description;
+            }
+            if (!resourceTemplate.mimeType.empty()) {
+                tmpl["mimeType"] = resourceTemplate.mimeType;
+            }
+            template_list.push_back(tmpl);
+        }
+        // Resources are paged; the templates are few and come with the first page
+        list->first_page_tail = R"("resourceTemplates":)" + template_list.dump();
+
+        nlohmann::json result;
+        result["resources"] = resource_list;
+        result["resourceTemplates"] = template_list;
+        list->full = std::make_shared<const std::string>(result.dump());
+        list_result_ = std::move(list);
+        return list_result_;
+    }
+
     std::vector<ResourceContent> ResourceManager::read_resource(const std::string &uri) const {
-        // todo accroding to the uri to read resources
         std::vector<ResourceContent> contents;
 
-        // find matched resources
-        for (const auto &resource: resources_) {
-            if (resource.uri == uri) {
-                ResourceContent content;
-                content.uri = resource.uri;
-                content.mimeType = resource.mimeType;
-
-                // handle file resources
-                if (uri.substr(0, 7) == "file://") {
-                    std::string file_path = uri.substr(7);
-                    std::ifstream file(file_path, std::ios::binary);
-                    if (file.is_open()) {
-                        // read file contents
-                        std::ostringstream buffer;
-                        buffer << file.rdbuf();
-                        std::string file_content = buffer.str();
-
-                        // tell the mime type by looking at the file extension
-                        if (resource.mimeType.find("text/") == 0 ||
-                            resource.mimeType == "application/json" ||
-                            resource.mimeType == "application/xml") {
-                            content.text = file_content;
-                        } else {
-                            //todo handle binary with base64
-                            content.blob = "base64_encoded_data";
-                        }
-                    } else {
-                        // cannot read file
-                        content.text = "Error: Unable to read file " + file_path;
-                    }
+        // look the uri up under the lock, read without it
+        std::optional<Resource> resource;
+        std::optional<UriTemplateMatch> match;
+        ResourceTemplateReader reader;
+        {
+            std::shared_lock lock(mutex_);
+            auto it = resource_index_.find(uri);
+            if (it != resource_index_.end()) {
+                resource = resources_[it->second];
+            } else if ((match = template_matcher_.match(uri))) {
+                reader = template_readers_[match->id];
+            }
+        }
+
+        if (!resource) {
+            // dynamic resources are produced by the reader of their template
+            if (reader) {
+                contents = reader(uri, match->variables);
+            }
+            return contents;
+        }
+
+        ResourceContent content;
+        content.uri = resource->uri;
+        content.mimeType = resource->mimeType;
+
+        // handle file resources
+        if (uri.substr(0, 7) == "file://") {
+            std::string file_path = uri.substr(7);
+            if (auto file = MappedFile::open(file_path)) {
+                // copied once, straight from the mapping
+                if (is_text_mime_type(resource->mimeType)) {
+                    content.text = file->bytes();
                 } else {
-                    // example content
-                    if (resource.mimeType.find("text/") == 0) {
-                        content.text = "Sample text content for " + uri;
-                    } else {
-                        content.blob = "c2FtcGxlIGJpbmFyeSBjb250ZW50";// "sample binary content" base64
-                    }
+                    content.blob = utils::base64_encode(file->bytes());
                 }
-
-                contents.push_back(content);
-                break;
+            } else {
+                // cannot read file
+                content.text = "Error: Unable to read file " + file_path;
+            }
+        } else {
+            // example content
+            if (resource->mimeType.find("text/") == 0) {
+                content.text = "Sample text content for " + uri;
+            } else {
+                content.blob = "c2FtcGxlIGJpbmFyeSBjb250ZW50";// "sample binary content" base64
             }
         }
 
+        contents.push_back(content);
         return contents;
     }
 
-    void ResourceManager::subscribe(const std::string &uri, const ResourceUpdateCallback &callback) {
-        subscriptions_[uri].push_back(callback);
+    std::optional<ResourceTemplateMatch> ResourceManager::match_template(const std::string &uri) const {
+        std::shared_lock lock(mutex_);
+        auto match = template_matcher_.match(uri);
+        if (!match) {
+            return std::nullopt;
+        }
+        return ResourceTemplateMatch{resource_templates_[match->id], std::move(match->variables)};
     }
 
-    void ResourceManager::unsubscribe(const std::string &uri) {
-        subscriptions_.erase(uri);
+    std::optional<ResourceFile> ResourceManager::open_file(const std::string &uri) const {
+        if (uri.substr(0, 7) != "file://") {
+            return std::nullopt;
+        }
+
+        ResourceFile result;
+        {
+            std::shared_lock lock(mutex_);
+            auto it = resource_index_.find(uri);
+            if (it == resource_index_.end()) {
+                return std::nullopt;
+            }
+            const auto &resource = resources_[it->second];
+            result.uri = resource.uri;
+            result.mimeType = resource.mimeType;
+            result.is_text = is_text_mime_type(resource.mimeType);
+        }
+
+        // mapped outside the lock, opening may block on the file system; the version is taken
+        // first, so a file changing meanwhile gets a newer version than the one recorded here
+        result.version = file_version(uri).value_or(0);
+        result.file = MappedFile::open(uri.substr(7));
+        if (!result.file) {
+            return std::nullopt;
+        }
+        return result;
     }
 
-    void ResourceManager::notify_list_changed() {
-        //todo inform that the resource list has changed with notifications/resources/list_changed
+    std::optional<uint64_t> ResourceManager::file_version(const std::string &uri) const {
+        if (uri.substr(0, 7) != "file://") {
+            return std::nullopt;
+        }
+        {
+            std::shared_lock lock(mutex_);
+            if (!resource_index_.count(uri)) {
+                return std::nullopt;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::path path(uri.substr(7));
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        auto modified = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        uint64_t key[2] = {static_cast<uint64_t>(size), static_cast<uint64_t>(modified.time_since_epoch().count())};
+        // 0 stands for an unknown version
+        return std::max<uint64_t>(1, utils::content_hash(std::string_view(reinterpret_cast<const char *>(key), sizeof(key))));
     }
 
-    void ResourceManager::notify_resource_updated(const std::string &uri) {
-        // inform the subscribers that the resource has been updated
-        auto it = subscriptions_.find(uri);
-        if (it != subscriptions_.end()) {
-            for (const auto &callback: it->second) {
-                callback(uri);
+    void ResourceManager::subscribe(const std::string &uri, Subscriber subscriber) {
+        std::string watch_path;
+        if (uri.substr(0, 7) == "file://") {
+            std::shared_lock lock(mutex_);
+            if (resource_index_.count(uri)) {
+                watch_path = uri.substr(7);
             }
         }
+        subscriptions_.subscribe(uri, std::move(subscriber), watch_path);
+    }
+
+    void ResourceManager::unsubscribe(const std::string &uri, const std::string &key) {
+        subscriptions_.unsubscribe(uri, key);
+    }
+
+    void ResourceManager::unsubscribe_all(const std::string &key) {
+        subscriptions_.unsubscribe_all(key);
+    }
+
+    void ResourceManager::notify_list_changed() {
+        {
+            std::unique_lock lock(mutex_);
+            list_result_.reset();
+        }
+        static const auto notification = transport::NotificationBroadcast::encode(
+                {{"jsonrpc", "2.0"}, {"method", "notifications/resources/list_changed"}});
+        transport::NotificationBroadcast::instance().broadcast(notification);
+    }
+
+    void ResourceManager::notify_resource_updated(const std::string &uri) {
+        // inform the subscribers that the resource has been updated, once per debounce window
+        subscriptions_.publish(uri);
     }
 
 }// namespace mcp::resources
\ No newline at end of file
@@ -1,9 +1,16 @@
 // src/Resources/resource.h
 #pragma once
 
+#include "core/paged_list.h"
+#include "mapped_file.h"
+#include "subscription_hub.h"
+#include "uri_template.h"
 #include "nlohmann/json.hpp"
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,21 +41,41 @@ namespace mcp::resources {
         std::string blob;    // For binary resources (base64 encoded)
     };
 
+    // File behind a file:// resource, for reads of a range or too large to copy
+    struct ResourceFile {
+        std::string uri;                       // URI of the resource
+        std::string mimeType;                  // Optional MIME type
+        bool is_text = false;                  // Sent as text, otherwise as a base64 blob
+        std::shared_ptr<const MappedFile> file;// Mapped contents
+        uint64_t version = 0;                  // file_version() taken before mapping, 0 if unknown
+    };
+
+    // Whether contents of a MIME type are sent as text rather than as a base64 blob
+    bool is_text_mime_type(const std::string &mimeType);
+
     // Resource read callback function signature
     using ReadResourceCallback = std::function<void(const std::vector<ResourceContent> &)>;
 
-    // Resource update callback function signature
-    using ResourceUpdateCallback = std::function<void(const std::string &uri)>;
+    // Produces the contents of a resource matched by a template, from the template's variables
+    using ResourceTemplateReader = std::function<std::vector<ResourceContent>(
+            const std::string &uri, const std::unordered_map<std::string, std::string> &variables)>;
+
+    // Template a uri was expanded from, with the values of its variables
+    struct ResourceTemplateMatch {
+        ResourceTemplate resourceTemplate;
+        std::unordered_map<std::string, std::string> variables;
+    };
 
+    // Shared by all requests; safe to use from several threads
     class ResourceManager {
     public:
-        ResourceManager() = default;
+        ResourceManager();
 
         // Register static resource
         void register_resource(const Resource &resource);
 
-        // Register resource template
-        void register_resource_template(const ResourceTemplate &resourceTemplate);
+        // Register resource template, compiled for matching; reader produces the contents of matched uris
+        void register_resource_template(const ResourceTemplate &resourceTemplate, ResourceTemplateReader reader = nullptr);
 
         // Get all registered resources
         std::vector<Resource> get_resources() const;
@@ -56,25 +83,48 @@ namespace mcp::resources {
         // Get all registered resource templates
         std::vector<ResourceTemplate> get_resource_templates() const;
 
+        // Serialized resources/list result, whole and entry by entry for paging; built once and reused until the list changes
+        std::shared_ptr<const core::PagedList> list_result() const;
+
         // Read resource content
         std::vector<ResourceContent> read_resource(const std::string &uri) const;
 
-        // Subscribe to resource updates
-        void subscribe(const std::string &uri, const ResourceUpdateCallback &callback);
+        // Find the template a uri was expanded from, without backtracking over the templates
+        std::optional<ResourceTemplateMatch> match_template(const std::string &uri) const;
+
+        // Map the file of a registered file:// resource, std::nullopt for other resources or a missing file
+        std::optional<ResourceFile> open_file(const std::string &uri) const;
+
+        // Version of the file of a registered file:// resource from its size and modification time, without
+        // reading it; changes whenever the file does. std::nullopt for other resources or a missing file
+        std::optional<uint64_t> file_version(const std::string &uri) const;
+
+        // Subscribe to resource updates; registered file:// resources are also watched for changes
+        void subscribe(const std::string &uri, Subscriber subscriber);
+
+        // Unsubscribe a subscriber key from resource updates
+        void unsubscribe(const std::string &uri, const std::string &key);
 
-        // Unsubscribe from resource updates
-        void unsubscribe(const std::string &uri);
+        // Drop every subscription of a subscriber key
+        void unsubscribe_all(const std::string &key);
 
-        // Notify resource list change
+        // Notify resource list change, broadcast to every open event stream as notifications/resources/list_changed
         void notify_list_changed();
 
-        // Notify resource content update
+        // Notify resource content update, debounced and delivered asynchronously as notifications/resources/updated,
+        // serialized once for all subscribers
         void notify_resource_updated(const std::string &uri);
 
     private:
+        mutable std::shared_mutex mutex_;                       // Guards the members below
+        mutable std::shared_ptr<const core::PagedList> list_result_;// nullptr until built, reset on changes
+        mutable uint64_t list_version_ = 0;                         // Bumped by every rebuild of list_result_
         std::vector<Resource> resources_;
+        std::unordered_map<std::string, size_t> resource_index_;// uri -> index in resources_
         std::vector<ResourceTemplate> resource_templates_;
-        std::unordered_map<std::string, std::vector<ResourceUpdateCallback>> subscriptions_;
+        std::vector<ResourceTemplateReader> template_readers_;  // Parallel to resource_templates_
+        UriTemplateMatcher template_matcher_;                   // Ids are indexes in resource_templates_
+        SubscriptionHub subscriptions_;                         // Thread safe on its own, renders the notifications
     };
 
 }// namespace mcp::resources
\ No newline at end of file
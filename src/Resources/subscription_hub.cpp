@@ -0,0 +1,319 @@
+// src/Resources/subscription_hub.cpp
+#include "subscription_hub.h"
+#include "core/logger.h"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace mcp::resources {
+
+    namespace {
+#if defined(__linux__)
+        // Writes, replacement by rename and removal; IN_IGNORED follows the last two
+        constexpr uint32_t kWatchMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+#endif
+    }// namespace
+
+    SubscriptionHub::SubscriptionHub(const SubscriptionOptions &options, UpdateRenderer render)
+        : options_(options),
+          render_(std::move(render)) {}
+
+    SubscriptionHub::~SubscriptionHub() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+#if defined(__linux__)
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+        if (wake_fd_ >= 0) close(wake_fd_);
+#endif
+    }
+
+    void SubscriptionHub::start_locked() {
+        if (thread_.joinable()) {
+            return;
+        }
+#if defined(__linux__)
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (options_.watch_files && wake_fd_ >= 0) {
+            inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotify_fd_ < 0) {
+                MCP_WARN("inotify unavailable (errno {}), file resources are not watched", errno);
+            }
+        }
+#else
+        if (options_.watch_files) {
+            MCP_INFO("No file watching on this platform, file resources are only updated when notified");
+        }
+#endif
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void SubscriptionHub::wake() {
+#if defined(__linux__)
+        if (wake_fd_ >= 0) {
+            uint64_t one = 1;
+            [[maybe_unused]] auto written = write(wake_fd_, &one, sizeof(one));
+            return;
+        }
+#endif
+        cv_.notify_all();
+    }
+
+    void SubscriptionHub::subscribe(const std::string &uri, Subscriber subscriber, const std::string &watch_path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        start_locked();
+
+        auto &topic = topics_[uri];
+        auto it = std::find_if(topic.subscribers.begin(), topic.subscribers.end(),
+                               [&subscriber](const Subscriber &other) { return other.key == subscriber.key; });
+        if (it != topic.subscribers.end()) {
+            *it = std::move(subscriber);
+        } else {
+            topic.subscribers.push_back(std::move(subscriber));
+        }
+
+        if (!watch_path.empty() && topic.watch < 0) {
+            topic.watch_path = watch_path;
+            add_watch_locked(uri, topic);
+        }
+    }
+
+    void SubscriptionHub::unsubscribe(const std::string &uri, const std::string &key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = topics_.find(uri);
+        if (it == topics_.end()) {
+            return;
+        }
+        auto &subscribers = it->second.subscribers;
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                         [&key](const Subscriber &subscriber) { return subscriber.key == key; }),
+                          subscribers.end());
+        if (subscribers.empty()) {
+            remove_watch_locked(uri, it->second);
+            topics_.erase(it);
+        }
+    }
+
+    void SubscriptionHub::unsubscribe_all(const std::string &key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = topics_.begin(); it != topics_.end();) {
+            auto &subscribers = it->second.subscribers;
+            subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                             [&key](const Subscriber &subscriber) { return subscriber.key == key; }),
+                              subscribers.end());
+            if (subscribers.empty()) {
+                remove_watch_locked(it->first, it->second);
+                it = topics_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    std::size_t SubscriptionHub::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t count = 0;
+        for (const auto &[uri, topic]: topics_) {
+            count += topic.subscribers.size();
+        }
+        return count;
+    }
+
+    void SubscriptionHub::publish(const std::string &uri) {
+        bool queued;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued = publish_locked(uri);
+        }
+        if (queued) {
+            wake();
+        }
+    }
+
+    bool SubscriptionHub::publish_locked(const std::string &uri) {
+        // Nobody listens, or the uri is already due: this update rides along with the pending one
+        if (topics_.find(uri) == topics_.end() || !pending_uris_.insert(uri).second) {
+            return false;
+        }
+        pending_.emplace_back(uri, std::chrono::steady_clock::now() + options_.debounce);
+        return true;
+    }
+
+    void SubscriptionHub::flush_due(std::chrono::steady_clock::time_point now) {
+        // Batch per subscriber, then render and deliver without the lock
+        std::vector<std::string> uris;
+        std::vector<std::pair<Subscriber, std::vector<std::size_t>>> batches;///< Indexes in uris
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::unordered_map<std::string, std::size_t> batch_index;
+            while (!pending_.empty() && pending_.front().second <= now) {
+                auto uri = std::move(pending_.front().first);
+                pending_.pop_front();
+                pending_uris_.erase(uri);
+
+                auto it = topics_.find(uri);
+                if (it == topics_.end()) {
+                    continue;// Unsubscribed in the meantime
+                }
+                for (const auto &subscriber: it->second.subscribers) {
+                    auto [entry, inserted] = batch_index.emplace(subscriber.key, batches.size());
+                    if (inserted) {
+                        batches.emplace_back(subscriber, std::vector<std::size_t>{});
+                    }
+                    batches[entry->second].second.push_back(uris.size());
+                }
+                uris.push_back(std::move(uri));
+            }
+        }
+
+        std::vector<std::shared_ptr<const std::string>> rendered;
+        rendered.reserve(uris.size());
+        for (auto &uri: uris) {
+            rendered.push_back(render_ ? render_(uri) : std::make_shared<const std::string>(std::move(uri)));
+        }
+
+        for (auto &[subscriber, indexes]: batches) {
+            std::vector<std::shared_ptr<const std::string>> updates;
+            updates.reserve(indexes.size());
+            for (auto index: indexes) {
+                updates.push_back(rendered[index]);
+            }
+            if (subscriber.executor) {
+                asio::post(subscriber.executor, [sink = std::move(subscriber.sink), updates = std::move(updates)]() mutable {
+                    sink(std::move(updates));
+                });
+                continue;
+            }
+            try {
+                subscriber.sink(std::move(updates));
+            } catch (const std::exception &e) {
+                MCP_ERROR("Resource update delivery to {} failed: {}", subscriber.key, e.what());
+            }
+        }
+    }
+
+    void SubscriptionHub::run() {
+        while (true) {
+            std::chrono::steady_clock::time_point due = std::chrono::steady_clock::time_point::max();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (stopping_) {
+                    break;
+                }
+                if (!pending_.empty()) {
+                    due = pending_.front().second;
+                }
+#if defined(__linux__)
+                if (wake_fd_ < 0) {
+#endif
+                    if (due == std::chrono::steady_clock::time_point::max()) {
+                        cv_.wait(lock);
+                    } else {
+                        cv_.wait_until(lock, due);
+                    }
+#if defined(__linux__)
+                }
+#endif
+            }
+
+#if defined(__linux__)
+            if (wake_fd_ >= 0) {
+                int timeout = -1;
+                if (due != std::chrono::steady_clock::time_point::max()) {
+                    auto left = std::chrono::ceil<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+                    timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(left.count(), 0));
+                }
+                pollfd fds[2] = {{wake_fd_, POLLIN, 0}, {inotify_fd_, POLLIN, 0}};
+                int ready = poll(fds, inotify_fd_ >= 0 ? 2 : 1, timeout);
+                if (ready > 0 && fds[0].revents != 0) {
+                    uint64_t count;
+                    [[maybe_unused]] auto drained = read(wake_fd_, &count, sizeof(count));
+                }
+                if (ready > 0 && inotify_fd_ >= 0 && fds[1].revents != 0) {
+                    read_watch_events();
+                }
+            }
+#endif
+            flush_due(std::chrono::steady_clock::now());
+        }
+    }
+
+    void SubscriptionHub::add_watch_locked([[maybe_unused]] const std::string &uri, [[maybe_unused]] Topic &topic) {
+#if defined(__linux__)
+        if (inotify_fd_ < 0) {
+            return;
+        }
+        topic.watch = inotify_add_watch(inotify_fd_, topic.watch_path.c_str(), kWatchMask);
+        if (topic.watch < 0) {
+            MCP_DEBUG("Not watching {} for {} (errno {})", topic.watch_path, uri, errno);
+            return;
+        }
+        // Paths of one file share the descriptor
+        watches_[topic.watch].push_back(uri);
+#endif
+    }
+
+    void SubscriptionHub::remove_watch_locked([[maybe_unused]] const std::string &uri, [[maybe_unused]] Topic &topic) {
+#if defined(__linux__)
+        if (topic.watch < 0) {
+            return;
+        }
+        auto it = watches_.find(topic.watch);
+        if (it != watches_.end()) {
+            auto &uris = it->second;
+            uris.erase(std::remove(uris.begin(), uris.end(), uri), uris.end());
+            if (uris.empty()) {
+                inotify_rm_watch(inotify_fd_, topic.watch);
+                watches_.erase(it);
+            }
+        }
+        topic.watch = -1;
+#endif
+    }
+
+    void SubscriptionHub::read_watch_events() {
+#if defined(__linux__)
+        alignas(inotify_event) char buffer[4096];
+        std::lock_guard<std::mutex> lock(mutex_);
+        ssize_t length;
+        while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+            for (char *p = buffer; p < buffer + length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(p);
+                p += sizeof(inotify_event) + event->len;
+
+                auto it = watches_.find(event->wd);
+                if (it == watches_.end()) {
+                    continue;// Removed by unsubscribe, or a late event of a dropped watch
+                }
+                auto uris = it->second;
+                if (event->mask & IN_IGNORED) {
+                    // The file was replaced or removed: watch whatever now has its path
+                    watches_.erase(it);
+                    for (const auto &uri: uris) {
+                        auto topic = topics_.find(uri);
+                        if (topic != topics_.end()) {
+                            topic->second.watch = -1;
+                            add_watch_locked(uri, topic->second);
+                        }
+                    }
+                }
+                for (const auto &uri: uris) {
+                    publish_locked(uri);
+                }
+            }
+        }
+#endif
+    }
+
+}// namespace mcp::resources
\ No newline at end of file
@@ -0,0 +1,151 @@
+// src/Resources/subscription_hub.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace mcp::resources {
+
+    /**
+     * @brief Settings of resource update notifications, normally taken from the [transport] section.
+     */
+    struct SubscriptionOptions {
+        std::chrono::milliseconds debounce{100};///< Updates of one uri within this window are sent once
+        bool watch_files = true;                ///< Watch subscribed file:// resources (inotify on Linux)
+
+        static const SubscriptionOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(SubscriptionOptions options) { storage() = options; }
+
+    private:
+        static SubscriptionOptions &storage() {
+            static SubscriptionOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Renders the update of a uri once per delivery, whatever the number of subscribers.
+     */
+    using UpdateRenderer = std::function<std::shared_ptr<const std::string>(const std::string &uri)>;
+
+    /**
+     * @brief Receives the updates of the uris updated since its last delivery, in the order they
+     *        were first updated. Subscribers of a uri share its rendered update.
+     */
+    using SubscriptionSink = std::function<void(std::vector<std::shared_ptr<const std::string>> updates)>;
+
+    /**
+     * @brief One party interested in updates, normally a session.
+     */
+    struct Subscriber {
+        std::string key;               ///< Session id; a key is subscribed to a uri at most once
+        asio::any_io_executor executor;///< Deliveries are posted here, no executor runs them on the hub thread
+        SubscriptionSink sink;         ///< Called with the batch of updates
+    };
+
+    /**
+     * @brief Thread-safe fan-out of resource updates to their subscribers.
+     *
+     * publish() only marks a uri as updated. The hub's thread sends it once the debounce window
+     * that the first update opened has passed, so a resource that changes a hundred times a second
+     * is announced roughly once per window. Everything due for one subscriber goes out as a single
+     * batch, posted to the subscriber's executor; the hub thread never waits for a session. Each
+     * update is rendered once and shared by all its subscribers.
+     * Subscribed file:// resources are watched with inotify on Linux and published when their file
+     * is written, replaced or removed. The thread is started by the first subscription.
+     */
+    class SubscriptionHub {
+    public:
+        /**
+         * @param options Debounce and file watching
+         * @param render Renders the update of a uri, nullptr delivers the uri itself
+         */
+        explicit SubscriptionHub(const SubscriptionOptions &options = SubscriptionOptions::current(),
+                                 UpdateRenderer render = nullptr);
+        ~SubscriptionHub();
+
+        SubscriptionHub(const SubscriptionHub &) = delete;
+        SubscriptionHub &operator=(const SubscriptionHub &) = delete;
+
+        /**
+         * @brief Subscribe to updates of a uri, replacing an earlier subscription of the same key.
+         * @param uri Resource uri
+         * @param subscriber Subscriber
+         * @param watch_path File to watch for changes, empty for none
+         */
+        void subscribe(const std::string &uri, Subscriber subscriber, const std::string &watch_path = {});
+
+        /**
+         * @brief Remove the subscription of a key to a uri.
+         * @param uri Resource uri
+         * @param key Subscriber key
+         */
+        void unsubscribe(const std::string &uri, const std::string &key);
+
+        /**
+         * @brief Remove every subscription of a key, e.g. when its session has closed.
+         * @param key Subscriber key
+         */
+        void unsubscribe_all(const std::string &key);
+
+        /**
+         * @brief Report that a resource has changed. Never blocks on delivery.
+         * @param uri Resource uri
+         */
+        void publish(const std::string &uri);
+
+        /**
+         * @brief Number of subscriptions, over all uris.
+         */
+        std::size_t size() const;
+
+    private:
+        struct Topic {
+            std::vector<Subscriber> subscribers;
+            int watch = -1;///< inotify watch descriptor, -1 if the uri is not watched
+            std::string watch_path;
+        };
+
+        void start_locked();
+        void run();
+        void wake();
+        bool publish_locked(const std::string &uri);
+        void flush_due(std::chrono::steady_clock::time_point now);
+        void add_watch_locked(const std::string &uri, Topic &topic);
+        void remove_watch_locked(const std::string &uri, Topic &topic);
+        void read_watch_events();
+
+        SubscriptionOptions options_;
+        UpdateRenderer render_;
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;///< Wakes the thread where inotify is not available
+        std::unordered_map<std::string, Topic> topics_;
+        std::deque<std::pair<std::string, std::chrono::steady_clock::time_point>> pending_;///< uri, due time; in publish order
+        std::unordered_set<std::string> pending_uris_;                                     ///< uris in pending_
+        std::unordered_map<int, std::vector<std::string>> watches_;                        ///< Watch descriptor -> uris
+        std::thread thread_;
+        bool stopping_ = false;
+        int inotify_fd_ = -1;
+        int wake_fd_ = -1;
+    };
+
+}// namespace mcp::resources
\ No newline at end of file
@@ -0,0 +1,223 @@
+// src/Resources/uri_template.cpp
+#include "uri_template.h"
+#include <algorithm>
+#include <cstring>
+
+namespace mcp::resources {
+
+    namespace {
+        /// A literal character or a variable of a parsed template
+        struct Token {
+            char literal = 0;
+            std::string name;///< Empty for a literal
+            bool reserved = false;
+            bool no_dot = false;
+
+            static Token character(char c) {
+                Token token;
+                token.literal = c;
+                return token;
+            }
+        };
+
+        bool is_unreserved(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '-' || c == '.' || c == '_' || c == '~';
+        }
+
+        int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        std::string percent_decode(std::string_view value) {
+            std::string out;
+            out.reserve(value.size());
+            for (std::size_t i = 0; i < value.size(); ++i) {
+                int hi, lo;
+                if (value[i] == '%' && i + 2 < value.size() &&
+                    (hi = hex_value(value[i + 1])) >= 0 && (lo = hex_value(value[i + 2])) >= 0) {
+                    out += static_cast<char>(hi * 16 + lo);
+                    i += 2;
+                } else {
+                    out += value[i];
+                }
+            }
+            return out;
+        }
+
+        /// Split a template into tokens, std::nullopt if it has an unsupported expression
+        std::optional<std::vector<Token>> parse(std::string_view uri_template) {
+            std::vector<Token> tokens;
+            for (std::size_t i = 0; i < uri_template.size(); ++i) {
+                if (uri_template[i] != '{') {
+                    tokens.push_back(Token::character(uri_template[i]));
+                    continue;
+                }
+                auto close = uri_template.find('}', i);
+                if (close == std::string_view::npos || close == i + 1) {
+                    return std::nullopt;
+                }
+                auto expression = uri_template.substr(i + 1, close - i - 1);
+                i = close;
+
+                char op = expression.front();
+                if (std::strchr("+#/.", op)) {
+                    expression.remove_prefix(1);
+                } else {
+                    op = 0;
+                }
+                // Lists, prefixes, explode and the query forms would need more than one edge per expression
+                if (expression.empty() || expression.find_first_of(",:*?&;=!@|") != std::string_view::npos) {
+                    return std::nullopt;
+                }
+
+                if (op == '#' || op == '/' || op == '.') {
+                    tokens.push_back(Token::character(op));
+                }
+                Token variable;
+                variable.name = std::string(expression);
+                variable.reserved = op == '+' || op == '#';
+                variable.no_dot = op == '.';
+                tokens.push_back(std::move(variable));
+            }
+            return tokens;
+        }
+    }// namespace
+
+    UriTemplateMatcher::UriTemplateMatcher() : nodes_(1) {}
+
+    bool UriTemplateMatcher::allowed(CharSet chars, char c) {
+        if (is_unreserved(c) || c == '%') {
+            return chars != CharSet::UnreservedNoDot || c != '.';
+        }
+        return chars == CharSet::Reserved && c != '\0' && std::strchr(":/?#[]@!$&'()*+,;=", c);
+    }
+
+    uint32_t UriTemplateMatcher::literal_child(uint32_t node, char c) {
+        auto &literals = nodes_[node].literals;
+        auto it = std::lower_bound(literals.begin(), literals.end(), c,
+                                   [](const auto &entry, char value) { return entry.first < value; });
+        if (it != literals.end() && it->first == c) {
+            return it->second;
+        }
+        auto child = static_cast<uint32_t>(nodes_.size());
+        literals.insert(it, {c, child});
+        nodes_.emplace_back();
+        return child;
+    }
+
+    uint32_t UriTemplateMatcher::variable_edge(uint32_t node, std::string name, CharSet chars, bool decode) {
+        for (auto edge: nodes_[node].variables) {
+            if (edges_[edge].name == name && edges_[edge].chars == chars) {
+                return edges_[edge].target;
+            }
+        }
+        auto target = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        nodes_[node].variables.push_back(static_cast<uint32_t>(edges_.size()));
+        edges_.push_back(VariableEdge{std::move(name), chars, decode, target});
+        return target;
+    }
+
+    bool UriTemplateMatcher::add(std::string_view uri_template, std::size_t id) {
+        auto tokens = parse(uri_template);
+        if (!tokens) {
+            return false;
+        }
+
+        uint32_t node = 0;
+        for (auto &token: *tokens) {
+            if (token.name.empty()) {
+                node = literal_child(node, token.literal);
+            } else {
+                auto chars = token.reserved ? CharSet::Reserved : token.no_dot ? CharSet::UnreservedNoDot
+                                                                               : CharSet::Unreserved;
+                node = variable_edge(node, std::move(token.name), chars, !token.reserved);
+            }
+        }
+        // The same template added twice keeps its first id
+        if (!nodes_[node].id) {
+            nodes_[node].id = id;
+        }
+        ++templates_;
+        return true;
+    }
+
+    void UriTemplateMatcher::add_thread(std::vector<Thread> &list, Thread thread, uint32_t pos) const {
+        // The first thread to reach a state has the higher priority, later ones are dropped
+        for (const auto &other: list) {
+            if (other.index == thread.index && other.in_variable == thread.in_variable) {
+                return;
+            }
+        }
+        if (!thread.in_variable) {
+            list.push_back(std::move(thread));
+            return;
+        }
+
+        // A variable may end after any character it consumed: its capture is closed there. Ending
+        // goes first, so the literals after a variable win over the variable consuming them
+        Thread done{edges_[thread.index].target, false, thread.captures};
+        done.captures.back().end = pos;
+        add_thread(list, std::move(done), pos);
+        list.push_back(std::move(thread));
+    }
+
+    std::optional<UriTemplateMatch> UriTemplateMatcher::match(std::string_view uri) const {
+        if (templates_ == 0) {
+            return std::nullopt;
+        }
+
+        std::vector<Thread> current;
+        std::vector<Thread> next;
+        current.push_back(Thread{0, false, {}});
+
+        for (std::size_t i = 0; i < uri.size() && !current.empty(); ++i) {
+            char c = uri[i];
+            auto pos = static_cast<uint32_t>(i + 1);
+            next.clear();
+            for (auto &thread: current) {
+                if (thread.in_variable) {
+                    if (allowed(edges_[thread.index].chars, c)) {
+                        add_thread(next, std::move(thread), pos);
+                    }
+                    continue;
+                }
+
+                const auto &node = nodes_[thread.index];
+                auto it = std::lower_bound(node.literals.begin(), node.literals.end(), c,
+                                           [](const auto &entry, char value) { return entry.first < value; });
+                if (it != node.literals.end() && it->first == c) {
+                    add_thread(next, Thread{it->second, false, thread.captures}, pos);
+                }
+                for (auto edge: node.variables) {
+                    if (allowed(edges_[edge].chars, c)) {
+                        Thread inside{edge, true, thread.captures};
+                        inside.captures.push_back(Capture{edge, static_cast<uint32_t>(i), pos});
+                        add_thread(next, std::move(inside), pos);
+                    }
+                }
+            }
+            std::swap(current, next);
+        }
+
+        for (const auto &thread: current) {
+            if (thread.in_variable || !nodes_[thread.index].id) {
+                continue;
+            }
+            UriTemplateMatch result;
+            result.id = *nodes_[thread.index].id;
+            for (const auto &capture: thread.captures) {
+                const auto &edge = edges_[capture.edge];
+                auto value = uri.substr(capture.begin, capture.end - capture.begin);
+                result.variables[edge.name] = edge.decode ? percent_decode(value) : std::string(value);
+            }
+            return result;
+        }
+        return std::nullopt;
+    }
+
+}// namespace mcp::resources
\ No newline at end of file
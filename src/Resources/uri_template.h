@@ -0,0 +1,102 @@
+// src/Resources/uri_template.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mcp::resources {
+
+    /**
+     * @brief A URI that fit one of the templates of a UriTemplateMatcher.
+     */
+    struct UriTemplateMatch {
+        std::size_t id = 0;                                    ///< Id the template was added with
+        std::unordered_map<std::string, std::string> variables;///< Variable name -> value, percent-decoded
+    };
+
+    /**
+     * @brief Set of RFC 6570 URI templates compiled into one automaton, to tell which template
+     *        a URI was expanded from and with which values.
+     *
+     * Templates share a trie of their literal characters; each expression is an edge that consumes
+     * the characters its operator can expand to. A URI is matched in a single pass that advances
+     * every live path of the automaton one character at a time, so the cost grows with the URI
+     * length and the number of paths alive at once, never with backtracking. Single-variable
+     * expressions of the forms {var}, {+var}, {#var}, {/var} and {.var} are supported, and a
+     * variable matches at least one character.
+     * Not thread safe.
+     */
+    class UriTemplateMatcher {
+    public:
+        UriTemplateMatcher();
+
+        /**
+         * @brief Compile a template into the matcher.
+         * @param uri_template Template, e.g. "file://localhost/{path}"
+         * @param id Returned with matches of this template
+         * @return false if the template uses an expression form that is not supported
+         */
+        bool add(std::string_view uri_template, std::size_t id);
+
+        /**
+         * @brief Find the template a URI was expanded from. Where several fit, literal characters
+         *        are preferred over variables from left to right, then the template added first.
+         * @param uri URI to match
+         * @return The match, or std::nullopt if no template fits
+         */
+        std::optional<UriTemplateMatch> match(std::string_view uri) const;
+
+        std::size_t size() const { return templates_; }
+
+    private:
+        /// Characters a variable edge may consume
+        enum class CharSet : uint8_t {
+            Unreserved,     ///< {var}, {/var}: unreserved and percent-encoded
+            UnreservedNoDot,///< {.var}: as above, without '.'
+            Reserved,       ///< {+var}, {#var}: reserved characters as well
+        };
+
+        struct VariableEdge {
+            std::string name;
+            CharSet chars;
+            bool decode;    ///< Percent-decode the value
+            uint32_t target;///< Node entered once the variable ends
+        };
+
+        struct Node {
+            std::vector<std::pair<char, uint32_t>> literals;///< Literal character -> child, sorted
+            std::vector<uint32_t> variables;                ///< Variable edges leaving the node
+            std::optional<std::size_t> id;                  ///< Set where a template ends
+        };
+
+        /// Value of one variable, as a range of the URI
+        struct Capture {
+            uint32_t edge; ///< Variable edge
+            uint32_t begin;///< First character
+            uint32_t end;  ///< One past the last character
+        };
+
+        /// One live path through the automaton while matching
+        struct Thread {
+            uint32_t index;               ///< Node, or variable edge while in_variable
+            bool in_variable;             ///< Inside a variable, whose capture is the last one
+            std::vector<Capture> captures;///< Variables passed, in order
+        };
+
+        static bool allowed(CharSet chars, char c);
+        uint32_t literal_child(uint32_t node, char c);
+        uint32_t variable_edge(uint32_t node, std::string name, CharSet chars, bool decode);
+        void add_thread(std::vector<Thread> &list, Thread thread, uint32_t pos) const;
+
+        std::vector<Node> nodes_;
+        std::vector<VariableEdge> edges_;
+        std::size_t templates_ = 0;
+    };
+
+}// namespace mcp::resources
\ No newline at end of file
@@ -0,0 +1,71 @@
+// src/business/call_arena.cpp
+#include "call_arena.h"
+#include <algorithm>
+#include <functional>
+#include <new>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr size_t kAlignment = alignof(std::max_align_t);
+        constexpr size_t kFirstBlock = 4096;
+        constexpr size_t kLargestGrowth = 1024 * 1024;
+
+        thread_local CallArena *tls_current = nullptr;
+    }// namespace
+
+    void *CallArena::allocate(size_t size) {
+        size = (std::max<size_t>(size, 1) + kAlignment - 1) & ~(kAlignment - 1);
+        if (blocks_.empty() || blocks_.back().size - used_ < size) {
+            size_t grown = blocks_.empty() ? kFirstBlock : std::min(blocks_.back().size * 2, kLargestGrowth);
+            size_t block_size = std::max(grown, size);
+            // operator new[] of char is aligned for any fundamental type
+            std::unique_ptr<char[]> data(new (std::nothrow) char[block_size]);
+            if (!data) {
+                return nullptr;
+            }
+            blocks_.push_back({std::move(data), block_size});
+            used_ = 0;
+        }
+        void *p = blocks_.back().data.get() + used_;
+        used_ += size;
+        return p;
+    }
+
+    bool CallArena::owns(const void *p) const {
+        std::less<const char *> before;
+        auto *c = static_cast<const char *>(p);
+        return std::any_of(blocks_.begin(), blocks_.end(), [&](const Block &block) {
+            return !before(c, block.data.get()) && before(c, block.data.get() + block.size);
+        });
+    }
+
+    void CallArena::reset() {
+        if (blocks_.size() > 1) {
+            auto largest = std::max_element(blocks_.begin(), blocks_.end(), [](const Block &a, const Block &b) { return a.size < b.size; });
+            Block kept = std::move(*largest);
+            blocks_.clear();
+            blocks_.push_back(std::move(kept));
+        }
+        used_ = 0;
+    }
+
+    CallArena *CallArena::current() {
+        return tls_current;
+    }
+
+    CallArena::Scope::Scope() : outermost_(tls_current == nullptr) {
+        if (outermost_) {
+            thread_local CallArena arena;
+            tls_current = &arena;
+        }
+    }
+
+    CallArena::Scope::~Scope() {
+        if (outermost_) {
+            tls_current->reset();
+            tls_current = nullptr;
+        }
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,69 @@
+// src/business/call_arena.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Bump allocator for what a plugin allocates during one synchronous call, see MCPHostServices::call_alloc.
+     *
+     * Each thread has one arena that Scope hands to the calls it runs: nothing is freed one by one,
+     * everything goes at once when the outermost call on the thread is over, and the largest block
+     * is kept for the next call so a thread in steady state does not touch the heap at all.
+     */
+    class CallArena {
+    public:
+        CallArena() = default;
+        CallArena(const CallArena &) = delete;
+        CallArena &operator=(const CallArena &) = delete;
+
+        /**
+         * @brief Allocate size bytes, aligned for any type.
+         * @return Memory valid until reset(), nullptr if out of memory
+         */
+        void *allocate(size_t size);
+
+        /**
+         * @brief Whether p points into memory this arena handed out.
+         */
+        bool owns(const void *p) const;
+
+        /**
+         * @brief Release everything allocated, keeping the largest block.
+         */
+        void reset();
+
+        /**
+         * @brief Arena of the call running on this thread, nullptr outside of one.
+         */
+        static CallArena *current();
+
+        /**
+         * @brief Makes this thread's arena current() while a call runs into a plugin, and resets it afterwards.
+         * Nested scopes share the outer one's arena.
+         */
+        class Scope {
+        public:
+            Scope();
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            bool outermost_;
+        };
+
+    private:
+        struct Block {
+            std::unique_ptr<char[]> data;
+            size_t size;
+        };
+
+        std::vector<Block> blocks_;///< The last one is being filled
+        size_t used_ = 0;          ///< Bytes used of the last block
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,111 @@
+#include "cancellation.h"
+
+namespace mcp::business {
+
+    namespace {
+        thread_local const CancellationToken *current_token = nullptr;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// CancellationToken
+    ////////////////////////////////////////////////////////////////////////////////
+
+    CancellationToken::CancellationToken(std::string key)
+        : key_(std::move(key)), plugin_token_{this, &CancellationToken::is_cancelled} {}
+
+    CancellationToken::~CancellationToken() {
+        CancellationRegistry::instance().release(key_);
+    }
+
+    void CancellationToken::cancel() {
+        if (cancelled_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (callback_) {
+            auto callback = std::move(callback_);
+            callback_ = nullptr;
+            callback();
+        }
+    }
+
+    void CancellationToken::on_cancel(std::function<void()> callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled()) {
+            callback();
+            return;
+        }
+        callback_ = std::move(callback);
+    }
+
+    void CancellationToken::clear_callback() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = nullptr;
+    }
+
+    bool CancellationToken::is_cancelled(void *context) {
+        return static_cast<const CancellationToken *>(context)->cancelled();
+    }
+
+    const CancellationToken *CancellationToken::current() {
+        return current_token;
+    }
+
+    CancellationToken::Scope::Scope(const CancellationToken *token) : previous_(current_token) {
+        current_token = token;
+    }
+
+    CancellationToken::Scope::~Scope() {
+        current_token = previous_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// CancellationRegistry
+    ////////////////////////////////////////////////////////////////////////////////
+
+    CancellationRegistry &CancellationRegistry::instance() {
+        static CancellationRegistry registry;
+        return registry;
+    }
+
+    std::string CancellationRegistry::make_key(const std::string &scope, const nlohmann::json &id) {
+        // A string id and a number id with the same digits are different requests
+        std::string key = scope;
+        key += '\n';
+        key += id.dump();
+        return key;
+    }
+
+    std::shared_ptr<CancellationToken> CancellationRegistry::track(const std::string &scope, const nlohmann::json &id) {
+        std::string key = make_key(scope, id);
+        std::shared_ptr<CancellationToken> token(new CancellationToken(key));
+        std::lock_guard<std::mutex> lock(mutex_);
+        tokens_[std::move(key)] = token;
+        return token;
+    }
+
+    std::shared_ptr<CancellationToken> CancellationRegistry::find(const std::string &scope, const nlohmann::json &id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tokens_.find(make_key(scope, id));
+        return it != tokens_.end() ? it->second.lock() : nullptr;
+    }
+
+    bool CancellationRegistry::cancel(const std::string &scope, const nlohmann::json &id) {
+        // Cancelled outside the lock, the callback may free a stream generator
+        auto token = find(scope, id);
+        if (!token) {
+            return false;
+        }
+        token->cancel();
+        return true;
+    }
+
+    void CancellationRegistry::release(const std::string &key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tokens_.find(key);
+        if (it != tokens_.end() && it->second.expired()) {
+            tokens_.erase(it);
+        }
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,137 @@
+// src/business/cancellation.h
+#pragma once
+
+#include "mcp_plugin.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace mcp::business {
+
+    /**
+     * @brief Cancellation state of one request; set by notifications/cancelled, read by whoever runs it.
+     *
+     * Tokens are created by CancellationRegistry::track() and stay cancellable as long as someone
+     * holds them; the tool executor keeps one for the duration of a call, a stream consumer for the
+     * lifetime of its stream.
+     */
+    class CancellationToken {
+    public:
+        ~CancellationToken();
+        CancellationToken(const CancellationToken &) = delete;
+        CancellationToken &operator=(const CancellationToken &) = delete;
+
+        bool cancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Cancel the request and run the callback, if one is set. Later calls do nothing.
+         */
+        void cancel();
+
+        /**
+         * @brief Set the function run on cancellation, right away if the request is already cancelled.
+         * It runs on the cancelling thread and must not call back into the token.
+         * @param callback Replaces the previous callback
+         */
+        void on_cancel(std::function<void()> callback);
+
+        /**
+         * @brief Drop the callback; once this returns it is neither running nor going to run.
+         */
+        void clear_callback();
+
+        /**
+         * @brief Token in the form handed to plugins, valid as long as this object is.
+         */
+        const MCPCancelToken *plugin_token() const { return &plugin_token_; }
+
+        /**
+         * @brief Token of the tool call running on this thread, see Scope.
+         * @return Token, or nullptr if the call cannot be cancelled
+         */
+        static const CancellationToken *current();
+
+        /**
+         * @brief Makes a token current() on this thread while a synchronous call runs into a plugin.
+         */
+        class Scope {
+        public:
+            explicit Scope(const CancellationToken *token);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const CancellationToken *previous_;
+        };
+
+    private:
+        friend class CancellationRegistry;
+
+        explicit CancellationToken(std::string key);
+
+        static bool is_cancelled(void *context);
+
+        std::string key_;///< Entry in the registry, removed with the token
+        std::atomic<bool> cancelled_{false};
+        std::mutex mutex_;///< Serializes the callback with clear_callback()
+        std::function<void()> callback_;
+        MCPCancelToken plugin_token_;
+    };
+
+    /**
+     * @brief Maps requests in progress to their cancellation tokens.
+     *
+     * Requests are keyed by the client's session and the JSON-RPC id, the same pair a
+     * notifications/cancelled names. The registry only holds weak references; a token removes
+     * its entry when the last holder lets go.
+     */
+    class CancellationRegistry {
+    public:
+        static CancellationRegistry &instance();
+
+        /**
+         * @brief Make a request cancellable. A request reusing the id of one still running replaces it.
+         * @param scope Client session the request belongs to
+         * @param id JSON-RPC id of the request
+         * @return Token, the request is cancellable until it is released
+         */
+        std::shared_ptr<CancellationToken> track(const std::string &scope, const nlohmann::json &id);
+
+        /**
+         * @brief Look up the token of a request in progress.
+         * @param scope Client session the request belongs to
+         * @param id JSON-RPC id of the request
+         * @return Token, or nullptr if the request is not tracked
+         */
+        std::shared_ptr<CancellationToken> find(const std::string &scope, const nlohmann::json &id) const;
+
+        /**
+         * @brief Cancel a request in progress.
+         * @param scope Client session the request belongs to
+         * @param id JSON-RPC id of the request
+         * @return false if the request is not tracked, e.g. because it has already finished
+         */
+        bool cancel(const std::string &scope, const nlohmann::json &id);
+
+    private:
+        friend class CancellationToken;
+
+        CancellationRegistry() = default;
+
+        static std::string make_key(const std::string &scope, const nlohmann::json &id);
+
+        /**
+         * @brief Remove the entry of a destroyed token, unless a newer request took the key over.
+         */
+        void release(const std::string &key);
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, std::weak_ptr<CancellationToken>> tokens_;
+    };
+
+}// namespace mcp::business
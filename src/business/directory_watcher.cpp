@@ -0,0 +1,232 @@
+#include "directory_watcher.h"
+#include "core/logger.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace mcp::business {
+
+    namespace {
+        constexpr auto kPollInterval = std::chrono::seconds(1);///< Rescan interval without change notifications
+    }
+
+    /// Shared with the pending waits, so it outlives the watcher until they have completed
+    struct DirectoryWatcher::State : std::enable_shared_from_this<State> {
+        State(asio::any_io_executor executor, std::chrono::milliseconds debounce, Callback on_change)
+            : debounce(debounce), on_change(std::move(on_change)), timer(executor)
+#if defined(__linux__)
+              ,
+              inotify(executor)
+#endif
+        {
+        }
+
+        std::chrono::milliseconds debounce;
+        Callback on_change;
+        asio::steady_timer timer;///< Debounce, or the poll interval without change notifications
+        bool event_driven = false;
+
+        std::mutex mutex;
+        std::condition_variable idle_cv;///< on_change returned
+        bool stopped = false;
+        bool running = false;
+        std::thread::id running_on;
+#if defined(__linux__)
+        asio::posix::stream_descriptor inotify;
+#elif defined(_WIN32)
+        HANDLE change_handle = INVALID_HANDLE_VALUE;
+        HANDLE wait_handle = nullptr;
+#endif
+
+        bool is_stopped() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return stopped;
+        }
+
+        /// Wait for the next notification; each one restarts the debounce period
+        void wait_event() {
+#if defined(__linux__)
+            inotify.async_wait(asio::posix::stream_descriptor::wait_read,
+                               [self = shared_from_this()](const asio::error_code &ec) {
+                                   if (ec || self->is_stopped()) {
+                                       return;
+                                   }
+                                   // Drain the queue; the events themselves are not needed since callers rescan
+                                   alignas(inotify_event) char buffer[4096];
+                                   while (read(self->inotify.native_handle(), buffer, sizeof(buffer)) > 0) {
+                                   }
+                                   self->debounce_change();
+                                   self->wait_event();
+                               });
+#elif defined(_WIN32)
+            // The thread pool only hands the notification over to the executor
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped) {
+                return;
+            }
+            RegisterWaitForSingleObject(
+                    &wait_handle, change_handle,
+                    [](PVOID context, BOOLEAN) {
+                        auto self = static_cast<State *>(context)->shared_from_this();
+                        asio::post(self->timer.get_executor(), [self]() {
+                            {
+                                std::lock_guard<std::mutex> lock(self->mutex);
+                                if (self->stopped) {
+                                    return;
+                                }
+                                UnregisterWait(std::exchange(self->wait_handle, nullptr));
+                            }
+                            FindNextChangeNotification(self->change_handle);
+                            self->debounce_change();
+                            self->wait_event();
+                        });
+                    },
+                    this, INFINITE, WT_EXECUTEONLYONCE);
+#endif
+        }
+
+        /// Report the change once no further one came for the debounce period
+        void debounce_change() {
+            // Moving the expiry cancels the wait of the previous event
+            timer.expires_after(debounce);
+            timer.async_wait([self = shared_from_this()](const asio::error_code &ec) {
+                if (!ec) {
+                    self->fire();
+                }
+            });
+        }
+
+        void poll() {
+            timer.expires_after(kPollInterval);
+            timer.async_wait([self = shared_from_this()](const asio::error_code &ec) {
+                if (!ec) {
+                    self->fire();// Every interval counts as a possible change
+                    self->poll();
+                }
+            });
+        }
+
+        void fire() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopped) {
+                    return;
+                }
+                running = true;
+                running_on = std::this_thread::get_id();
+            }
+            try {
+                on_change();
+            } catch (const std::exception &e) {
+                MCP_ERROR("Directory change handler failed: {}", e.what());
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            idle_cv.notify_all();
+        }
+
+        /// Cancel the pending waits, on the executor that owns them
+        void close() {
+            asio::error_code ignored;
+            timer.cancel();
+#if defined(__linux__)
+            inotify.close(ignored);
+#elif defined(_WIN32)
+            if (change_handle != INVALID_HANDLE_VALUE) {
+                FindCloseChangeNotification(change_handle);
+                change_handle = INVALID_HANDLE_VALUE;
+            }
+#endif
+        }
+    };
+
+    DirectoryWatcher::DirectoryWatcher(const std::filesystem::path &directory, asio::any_io_executor executor,
+                                       std::chrono::milliseconds debounce, Callback on_change)
+        : state_(std::make_shared<State>(executor, debounce, std::move(on_change))) {
+        auto &state = *state_;
+#if defined(__linux__)
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd >= 0) {
+            // IN_CLOSE_WRITE and IN_MOVED_TO mark a finished copy; IN_MODIFY keeps the debounce
+            // window open while a large plugin is still being written
+            uint32_t mask = IN_CREATE | IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ATTRIB;
+            state.event_driven = inotify_add_watch(fd, directory.c_str(), mask) >= 0;
+            if (state.event_driven) {
+                state.inotify.assign(fd);
+            } else {
+                close(fd);
+            }
+        }
+        if (!state.event_driven) {
+            MCP_WARN("inotify unavailable for {} (errno {}), falling back to polling", directory.string(), errno);
+        }
+#elif defined(_WIN32)
+        state.change_handle = FindFirstChangeNotificationW(
+                directory.c_str(), FALSE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE);
+        state.event_driven = state.change_handle != INVALID_HANDLE_VALUE;
+        if (!state.event_driven) {
+            MCP_WARN("Change notifications unavailable for {} (error {}), falling back to polling",
+                     directory.string(), GetLastError());
+        }
+#else
+        MCP_INFO("No change notifications on this platform, polling {} every {}s",
+                 directory.string(), kPollInterval.count());
+#endif
+        // The descriptor and timer are only touched on the executor
+        asio::post(executor, [state = state_]() {
+            if (state->is_stopped()) {
+                return;
+            }
+            if (state->event_driven) {
+                state->wait_event();
+            } else {
+                state->poll();
+            }
+        });
+    }
+
+    DirectoryWatcher::~DirectoryWatcher() {
+        stop();
+    }
+
+    bool DirectoryWatcher::event_driven() const noexcept {
+        return state_->event_driven;
+    }
+
+    void DirectoryWatcher::stop() {
+#if defined(_WIN32)
+        HANDLE wait_handle = nullptr;
+#endif
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            if (state_->stopped) {
+                return;
+            }
+            state_->stopped = true;
+            if (state_->running && state_->running_on != std::this_thread::get_id()) {
+                state_->idle_cv.wait(lock, [this] { return !state_->running; });
+            }
+#if defined(_WIN32)
+            wait_handle = std::exchange(state_->wait_handle, nullptr);
+#endif
+        }
+#if defined(_WIN32)
+        if (wait_handle) {
+            // Waits for a notification callback in progress, which only posts
+            UnregisterWaitEx(wait_handle, INVALID_HANDLE_VALUE);
+        }
+#endif
+        asio::post(state_->timer.get_executor(), [state = state_]() { state->close(); });
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,59 @@
+#pragma once
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+namespace mcp::business {
+
+    /**
+     * @brief Change notification for a single directory, waited for on an io_context.
+     *
+     * Uses inotify on Linux and change notifications (the ReadDirectoryChangesW family) on
+     * Windows, so an idle server does not wake up at all and no thread is spent on the watch.
+     * Other platforms fall back to a timer that reports a possible change every second, like
+     * the old polling loop. The watcher only reports that something changed; callers rescan
+     * the directory.
+     */
+    class DirectoryWatcher {
+    public:
+        using Callback = std::function<void()>;
+
+        /**
+         * @brief Start watching.
+         * @param directory Directory to watch
+         * @param executor Executor of a single-threaded io_context, on_change runs there
+         * @param debounce Time without further events before a change is reported. Waiting for quiet
+         *        means a plugin that is still being copied is not picked up half written.
+         * @param on_change Called once per change, after the debounce period
+         */
+        DirectoryWatcher(const std::filesystem::path &directory, asio::any_io_executor executor,
+                         std::chrono::milliseconds debounce, Callback on_change);
+        ~DirectoryWatcher();
+
+        DirectoryWatcher(const DirectoryWatcher &) = delete;
+        DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+        /**
+         * @brief Whether change notifications are available (false means timed polling).
+         * @return true if the platform watcher was set up
+         */
+        bool event_driven() const noexcept;
+
+        /**
+         * @brief Stop watching; on_change is not called again once this returns. A call in progress
+         *        is waited for, unless stop() comes from on_change itself. Safe to call from any thread.
+         */
+        void stop();
+
+    private:
+        struct State;
+        std::shared_ptr<State> state_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,893 @@
+#include "federation.h"
+#include "cancellation.h"
+#include "core/logger.h"
+#include "metrics/rate_limiter.h"
+#include "metrics/tracing.h"
+#include "progress.h"
+#include "protocol/json_rpc.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr size_t kMaxHeadBytes = 64 * 1024;
+        constexpr int kMaxListPages = 100;
+        constexpr double kLatencyWeight = 0.2;///< Weight of a new ping in the smoothed latency
+        constexpr auto kWaitSlice = std::chrono::milliseconds(20);
+        const char *const kProtocolVersion = "2025-03-26";
+
+        bool iequals(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                       return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+                   });
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+            return text;
+        }
+
+        struct Endpoint {
+            std::string host;
+            std::string port;
+            std::string path;
+        };
+
+        // Only plain http:// endpoints; upstreams are expected on the same private network
+        std::optional<Endpoint> parse_url(std::string_view url) {
+            constexpr std::string_view scheme = "http://";
+            if (!url.starts_with(scheme)) {
+                return std::nullopt;
+            }
+            url.remove_prefix(scheme.size());
+            size_t slash = url.find('/');
+            std::string_view authority = url.substr(0, slash);
+            Endpoint endpoint;
+            endpoint.path = slash == std::string_view::npos ? "/mcp" : std::string(url.substr(slash));
+            size_t colon = authority.rfind(':');
+            if (colon == std::string_view::npos || authority.find(']', colon) != std::string_view::npos) {
+                endpoint.host = authority;
+                endpoint.port = "80";
+            } else {
+                endpoint.host = authority.substr(0, colon);
+                endpoint.port = authority.substr(colon + 1);
+            }
+            if (endpoint.host.size() >= 2 && endpoint.host.front() == '[' && endpoint.host.back() == ']') {
+                endpoint.host = endpoint.host.substr(1, endpoint.host.size() - 2);
+            }
+            if (endpoint.host.empty() || endpoint.port.empty()) {
+                return std::nullopt;
+            }
+            return endpoint;
+        }
+
+        struct ResponseHead {
+            int status = 0;
+            bool chunked = false;
+            std::optional<size_t> length;
+            bool close = false;
+            bool event_stream = false;
+            std::string session_id;
+        };
+
+        ResponseHead parse_head(std::string_view head) {
+            ResponseHead response;
+            size_t end = head.find("\r\n");
+            std::string_view status_line = head.substr(0, end);
+            if (!status_line.starts_with("HTTP/1.") || status_line.size() < 12 ||
+                std::from_chars(status_line.data() + 9, status_line.data() + 12, response.status).ec != std::errc{}) {
+                throw std::runtime_error("invalid HTTP response");
+            }
+            response.close = status_line.starts_with("HTTP/1.0");
+            while (end != std::string_view::npos) {
+                head.remove_prefix(end + 2);
+                end = head.find("\r\n");
+                std::string_view line = head.substr(0, end);
+                size_t colon = line.find(':');
+                if (colon == std::string_view::npos) {
+                    continue;
+                }
+                std::string_view name = trim(line.substr(0, colon));
+                std::string_view value = trim(line.substr(colon + 1));
+                if (iequals(name, "Content-Length")) {
+                    size_t length = 0;
+                    std::from_chars(value.data(), value.data() + value.size(), length);
+                    response.length = length;
+                } else if (iequals(name, "Transfer-Encoding")) {
+                    response.chunked = value.find("chunked") != std::string_view::npos;
+                } else if (iequals(name, "Connection")) {
+                    response.close = iequals(value, "close");
+                } else if (iequals(name, "Content-Type")) {
+                    response.event_stream = value.starts_with("text/event-stream");
+                } else if (iequals(name, "Mcp-Session-Id")) {
+                    response.session_id = value;
+                }
+            }
+            return response;
+        }
+
+        /**
+         * @brief Splits an event stream into the JSON messages of its data fields.
+         */
+        /// An upstream response, or one of its events, is larger than max_response_size
+        class ResponseTooLarge : public std::runtime_error {
+        public:
+            explicit ResponseTooLarge(size_t limit)
+                : std::runtime_error("response exceeds max_response_size of " + std::to_string(limit) + " bytes") {}
+        };
+
+        /// max_response_size, the most bytes an upstream body or event may have; unlimited if 0
+        size_t response_limit() {
+            size_t limit = metrics::RateLimiter::getInstance()->get_config().max_response_size;
+            return limit == 0 ? SIZE_MAX : limit;
+        }
+
+        class EventParser {
+        public:
+            explicit EventParser(size_t limit) : limit_(limit) {}
+
+            template<typename Sink>
+            void feed(std::string_view data, const Sink &sink) {
+                for (char c: data) {
+                    if (c != '\r') {
+                        pending_.push_back(c);
+                    }
+                }
+                size_t end;
+                while ((end = pending_.find("\n\n")) != std::string::npos) {
+                    std::string payload;
+                    std::string_view event(pending_.data(), end);
+                    while (!event.empty()) {
+                        size_t newline = event.find('\n');
+                        std::string_view line = event.substr(0, newline);
+                        event = newline == std::string_view::npos ? std::string_view{} : event.substr(newline + 1);
+                        if (line.starts_with("data:")) {
+                            line.remove_prefix(5);
+                            if (line.starts_with(' ')) line.remove_prefix(1);
+                            if (!payload.empty()) payload.push_back('\n');
+                            payload.append(line);
+                        }
+                    }
+                    pending_.erase(0, end + 2);
+                    auto message = nlohmann::json::parse(payload, nullptr, false);
+                    if (message.is_object()) {
+                        sink(message);
+                    }
+                }
+                // A stream may go on for long, only the event still incomplete is bounded
+                if (pending_.size() > limit_) {
+                    throw ResponseTooLarge(limit_);
+                }
+            }
+
+        private:
+            std::string pending_;
+            size_t limit_;
+        };
+    }// namespace
+
+    struct Federation::Connection {
+        explicit Connection(asio::io_context &io) : socket(io) {}
+
+        asio::ip::tcp::socket socket;
+        std::string buffer;///< Received and not consumed yet
+    };
+
+    // Everything below is only touched on the federation thread
+    struct Federation::Replica {
+        std::string url;
+        std::string upstream;
+        Endpoint endpoint;
+        std::vector<std::unique_ptr<Connection>> idle;
+        std::string session_id;
+        bool session_open = false;
+        std::shared_ptr<asio::steady_timer> opening;///< Set while a call opens the session, cancelled when it is done
+        bool healthy = true;
+        bool probing = false;
+        double latency_us = 0;///< Smoothed ping round trip
+        int in_flight = 0;
+    };
+
+    struct Federation::Upstream {
+        std::string name;
+        std::vector<std::unique_ptr<Replica>> replicas;
+        std::vector<std::string> tools;///< Names registered for it
+        std::string listed;            ///< Tool list the registered tools were built from
+    };
+
+    struct Federation::Call {
+        const MCPProgress *progress = nullptr;
+        std::string traceparent;
+        Connection *active = nullptr;///< Connection the call waits on
+        bool aborted = false;
+        bool cancelled = false;
+        bool timed_out = false;
+
+        void abort() {
+            aborted = true;
+            if (active) {
+                asio::error_code ignored;
+                active->socket.close(ignored);
+            }
+        }
+    };
+
+    struct Federation::Reply {
+        int status = 0;
+        std::string session_id;
+    };
+
+    std::vector<FederationOptions::Upstream> FederationOptions::parse_upstreams(std::string_view text) {
+        std::vector<Upstream> upstreams;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = trim(text.substr(0, comma));
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            size_t eq = item.find('=');
+            if (eq == std::string_view::npos) {
+                continue;
+            }
+            Upstream upstream;
+            upstream.name = trim(item.substr(0, eq));
+            std::string_view replicas = item.substr(eq + 1);
+            while (!replicas.empty()) {
+                size_t bar = replicas.find('|');
+                std::string_view replica = trim(replicas.substr(0, bar));
+                replicas = bar == std::string_view::npos ? std::string_view{} : replicas.substr(bar + 1);
+                if (!replica.empty()) {
+                    upstream.replicas.emplace_back(replica);
+                }
+            }
+            if (!upstream.name.empty() && !upstream.replicas.empty()) {
+                upstreams.push_back(std::move(upstream));
+            }
+        }
+        return upstreams;
+    }
+
+    Federation::Federation(std::shared_ptr<ToolRegistry> registry, const FederationOptions &options)
+        : registry_(std::move(registry)), options_(options) {
+        for (const auto &configured: options_.upstreams) {
+            auto upstream = std::make_unique<Upstream>();
+            upstream->name = configured.name;
+            for (const auto &url: configured.replicas) {
+                auto endpoint = parse_url(url);
+                if (!endpoint) {
+                    MCP_ERROR("Ignoring replica {} of upstream {}: only http://host[:port][/path] is supported", url, configured.name);
+                    continue;
+                }
+                auto replica = std::make_unique<Replica>();
+                replica->url = url;
+                replica->upstream = configured.name;
+                replica->endpoint = std::move(*endpoint);
+                upstream->replicas.push_back(std::move(replica));
+            }
+            if (!upstream->replicas.empty()) {
+                upstreams_.push_back(std::move(upstream));
+            }
+        }
+    }
+
+    std::shared_ptr<Federation> Federation::start(std::shared_ptr<ToolRegistry> registry, const FederationOptions &options) {
+        if (options.upstreams.empty()) {
+            return nullptr;
+        }
+        auto federation = std::shared_ptr<Federation>(new Federation(std::move(registry), options));
+        if (federation->upstreams_.empty()) {
+            return nullptr;
+        }
+        federation->running_.store(true, std::memory_order_release);
+        asio::co_spawn(federation->io_, federation->refresh_loop(), asio::detached);
+        asio::co_spawn(federation->io_, federation->health_loop(), asio::detached);
+        federation->thread_ = std::thread([federation = federation.get()]() { federation->io_.run(); });
+        MCP_INFO("Federating tools of {} upstream MCP servers", federation->upstreams_.size());
+        return federation;
+    }
+
+    Federation::~Federation() {
+        stop();
+    }
+
+    void Federation::stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        io_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        halted_.store(true, std::memory_order_release);
+
+        // The thread is gone, nothing else touches the upstreams now
+        for (auto &upstream: upstreams_) {
+            registry_->replace_tools(upstream->tools, {});
+            upstream->tools.clear();
+            for (auto &replica: upstream->replicas) {
+                replica->idle.clear();
+            }
+        }
+    }
+
+    ToolOutput Federation::call_tool(Upstream &upstream, const std::string &remote_name, const nlohmann::json &args) {
+        ToolOutput output;
+        if (halted_.load(std::memory_order_acquire)) {
+            output.error_code = protocol::error_code::INTERNAL_ERROR;
+            output.error_message = "Federation is stopped";
+            return output;
+        }
+
+        auto call = std::make_shared<Call>();
+        const auto *progress = ProgressReporter::current();
+        const auto *cancel = CancellationToken::current();
+        if (const auto *span = metrics::SpanContext::current()) {
+            call->traceparent = span->traceparent();
+        }
+
+        int64_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+        nlohmann::json params = {{"name", remote_name}, {"arguments", args.is_null() ? nlohmann::json::object() : args}};
+        if (progress) {
+            call->progress = progress->plugin_progress();
+            params["_meta"] = {{"progressToken", id}};
+        }
+        nlohmann::json message = {{"jsonrpc", "2.0"}, {"id", id}, {"method", "tools/call"}, {"params", std::move(params)}};
+
+        // The call runs on the federation thread; this one waits and passes a cancellation on
+        auto result = asio::co_spawn(io_, run_call(upstream, std::move(message), call), asio::use_future);
+        bool cancel_sent = false;
+        while (result.wait_for(kWaitSlice) != std::future_status::ready) {
+            if (halted_.load(std::memory_order_acquire)) {
+                output.error_code = protocol::error_code::INTERNAL_ERROR;
+                output.error_message = "Federation is stopped";
+                return output;
+            }
+            if (!cancel_sent && cancel && cancel->cancelled()) {
+                cancel_sent = true;
+                asio::post(io_, [call]() {
+                    call->cancelled = true;
+                    call->abort();
+                });
+            }
+        }
+        return result.get();
+    }
+
+    asio::awaitable<ToolOutput> Federation::run_call(Upstream &upstream, nlohmann::json message, std::shared_ptr<Call> call) {
+        ToolOutput output;
+        asio::steady_timer deadline(io_, options_.call_timeout);
+        deadline.async_wait([call](const asio::error_code &ec) {
+            if (!ec) {
+                call->timed_out = true;
+                call->abort();
+            }
+        });
+
+        Replica *replica = pick(upstream);
+        const nlohmann::json id = message["id"];
+        bool answered = false;
+        bool too_large = false;
+        std::string failure;
+        ++replica->in_flight;
+        try {
+            Reply reply = co_await request(*replica, message, call.get(), [&](const nlohmann::json &received) {
+                if (received.value("method", "") == "notifications/progress" && call->progress) {
+                    const auto &params = received.value("params", nlohmann::json::object());
+                    std::string text = params.value("message", "");
+                    call->progress->report(call->progress->context,
+                                           params.value("progress", 0.0),
+                                           params.value("total", -1.0),
+                                           text.empty() ? nullptr : text.c_str());
+                    return;
+                }
+                if (!received.contains("id") || received["id"] != id) {
+                    return;
+                }
+                answered = true;
+                if (received.contains("error") && received["error"].is_object()) {
+                    output.error_code = received["error"].value("code", protocol::error_code::INTERNAL_ERROR);
+                    output.error_message = received["error"].value("message", "Upstream error");
+                } else {
+                    output.json = received.value("result", nlohmann::json::object()).dump();
+                    output.passthrough = true;// Already a tools/call result
+                }
+            });
+            if (!answered) {
+                failure = "HTTP " + std::to_string(reply.status) + " without a response";
+            }
+        } catch (const ResponseTooLarge &e) {
+            failure = e.what();
+            too_large = true;
+        } catch (const std::exception &e) {
+            failure = e.what();
+        }
+        deadline.cancel();
+        --replica->in_flight;
+
+        if (answered) {
+            co_return output;
+        }
+        if (call->cancelled) {
+            // Best effort, the call may have finished upstream in the meantime
+            nlohmann::json notification = {{"jsonrpc", "2.0"},
+                                           {"method", "notifications/cancelled"},
+                                           {"params", {{"requestId", id}, {"reason", "Cancelled by the client"}}}};
+            asio::co_spawn(
+                    io_,
+                    [this, replica, notification]() -> asio::awaitable<void> {
+                        auto call = std::make_shared<Call>();
+                        asio::steady_timer deadline(io_, options_.health_interval);
+                        deadline.async_wait([call](const asio::error_code &ec) {
+                            if (!ec) call->abort();
+                        });
+                        try {
+                            co_await request(*replica, notification, call.get(), [](const nlohmann::json &) {});
+                        } catch (const std::exception &) {
+                        }
+                        deadline.cancel();
+                    },
+                    asio::detached);
+            output.error_code = protocol::error_code::REQUEST_CANCELLED;
+            output.error_message = "Request cancelled";
+        } else if (call->timed_out) {
+            output.error_code = protocol::error_code::TIMEOUT;
+            output.error_message = "Upstream " + upstream.name + " did not answer in time";
+        } else if (too_large) {
+            // The replica is healthy, the result is just too large to pass on
+            output.error_code = protocol::error_code::RESPONSE_TOO_LARGE;
+            output.error_message = "Upstream " + upstream.name + " " + failure;
+        } else {
+            mark_failed(*replica, failure);
+            output.error_code = protocol::error_code::INTERNAL_ERROR;
+            output.error_message = "Upstream " + upstream.name + " failed: " + failure;
+        }
+        co_return output;
+    }
+
+    asio::awaitable<Federation::Reply> Federation::request(Replica &replica, const nlohmann::json &message, Call *call,
+                                                           const MessageSink &sink) {
+        std::string body = message.dump();
+        for (int attempt = 0;; ++attempt) {
+            co_await open_session(replica, call);
+            Reply reply = co_await exchange(replica, body, call, sink);
+            // A replica that restarted no longer knows the session; open a new one, once
+            if (reply.status == 404 && !replica.session_id.empty() && attempt == 0) {
+                MCP_DEBUG("Session {} expired on replica {}, opening a new one", replica.session_id, replica.url);
+                replica.session_open = false;
+                replica.session_id.clear();
+                continue;
+            }
+            co_return reply;
+        }
+    }
+
+    asio::awaitable<void> Federation::open_session(Replica &replica, Call *call) {
+        if (replica.session_open) {
+            co_return;
+        }
+        if (auto opening = replica.opening) {
+            asio::error_code ec;
+            co_await opening->async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            if (!replica.session_open) {
+                throw std::runtime_error("no session with " + replica.url);
+            }
+            co_return;
+        }
+
+        auto opening = std::make_shared<asio::steady_timer>(io_, asio::steady_timer::time_point::max());
+        replica.opening = opening;
+        replica.session_id.clear();
+        std::exception_ptr failure;
+        try {
+            nlohmann::json initialize = {{"jsonrpc", "2.0"},
+                                         {"id", next_id_.fetch_add(1, std::memory_order_relaxed)},
+                                         {"method", "initialize"},
+                                         {"params",
+                                          {{"protocolVersion", kProtocolVersion},
+                                           {"capabilities", nlohmann::json::object()},
+                                           {"clientInfo", {{"name", "mcp-server++-federation"}, {"version", "1.0"}}}}}};
+            bool accepted = false;
+            Reply reply = co_await exchange(replica, initialize.dump(), call, [&](const nlohmann::json &received) {
+                accepted |= received.contains("result") && received["id"] == initialize["id"];
+            });
+            if (!accepted) {
+                throw std::runtime_error("initialize answered with HTTP " + std::to_string(reply.status));
+            }
+            replica.session_id = reply.session_id;
+
+            nlohmann::json initialized = {{"jsonrpc", "2.0"}, {"method", "notifications/initialized"}};
+            co_await exchange(replica, initialized.dump(), call, [](const nlohmann::json &) {});
+            replica.session_open = true;
+            MCP_DEBUG("Opened MCP session {} with replica {}", replica.session_id, replica.url);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        replica.opening.reset();
+        opening->cancel();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    asio::awaitable<Federation::Reply> Federation::exchange(Replica &replica, const std::string &body, Call *call,
+                                                            const MessageSink &sink) {
+        std::string head = "POST " + replica.endpoint.path + " HTTP/1.1\r\n";
+        head += "Host: " + replica.endpoint.host + ":" + replica.endpoint.port + "\r\n";
+        head += "Content-Type: application/json\r\n";
+        head += "Accept: application/json, text/event-stream\r\n";
+        if (!options_.token.empty()) {
+            head += "Authorization: Bearer " + options_.token + "\r\n";
+        }
+        if (!replica.session_id.empty()) {
+            head += "Mcp-Session-Id: " + replica.session_id + "\r\n";
+        }
+        if (call && !call->traceparent.empty()) {
+            head += "traceparent: " + call->traceparent + "\r\n";
+        }
+        head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+        std::array<asio::const_buffer, 2> request{asio::buffer(head), asio::buffer(body)};
+
+        for (int attempt = 0;; ++attempt) {
+            if (call && call->aborted) {
+                throw std::runtime_error(call->timed_out ? "timed out" : "aborted");
+            }
+            std::unique_ptr<Connection> connection;
+            bool reused = !replica.idle.empty();
+            if (reused) {
+                connection = std::move(replica.idle.back());
+                replica.idle.pop_back();
+            } else {
+                connection = std::make_unique<Connection>(io_);
+            }
+            if (call) {
+                call->active = connection.get();
+            }
+
+            std::exception_ptr failure;
+            try {
+                if (!reused) {
+                    asio::ip::tcp::resolver resolver(io_);
+                    auto endpoints = co_await resolver.async_resolve(replica.endpoint.host, replica.endpoint.port, asio::use_awaitable);
+                    co_await asio::async_connect(connection->socket, endpoints, asio::use_awaitable);
+                    connection->socket.set_option(asio::ip::tcp::no_delay(true));
+                }
+                co_await asio::async_write(connection->socket, request, asio::use_awaitable);
+
+                std::array<char, 16 * 1024> chunk;
+                auto read_more = [&]() -> asio::awaitable<bool> {
+                    asio::error_code ec;
+                    size_t n = co_await connection->socket.async_read_some(asio::buffer(chunk), asio::redirect_error(asio::use_awaitable, ec));
+                    if (ec == asio::error::eof) {
+                        co_return false;
+                    }
+                    if (ec) {
+                        throw std::runtime_error(ec.message());
+                    }
+                    connection->buffer.append(chunk.data(), n);
+                    co_return true;
+                };
+
+                size_t head_end;
+                while ((head_end = connection->buffer.find("\r\n\r\n")) == std::string::npos) {
+                    if (connection->buffer.size() > kMaxHeadBytes || !co_await read_more()) {
+                        throw std::runtime_error("connection closed before the response");
+                    }
+                }
+                ResponseHead response = parse_head(std::string_view(connection->buffer).substr(0, head_end));
+                connection->buffer.erase(0, head_end + 4);
+
+                // Event streams are handed over event by event, JSON bodies once complete
+                const size_t limit = response_limit();
+                EventParser events(limit);
+                std::string json;
+                auto deliver = [&](std::string_view data) {
+                    if (response.event_stream) {
+                        events.feed(data, sink);
+                    } else {
+                        if (data.size() > limit - json.size()) {
+                            throw ResponseTooLarge(limit);
+                        }
+                        json.append(data);
+                    }
+                };
+
+                bool reusable = !response.close;
+                if (response.status == 204 || response.status == 304 || response.status / 100 == 1) {
+                    // No body
+                } else if (response.chunked) {
+                    for (;;) {
+                        size_t line_end;
+                        while ((line_end = connection->buffer.find("\r\n")) == std::string::npos) {
+                            if (!co_await read_more()) throw std::runtime_error("truncated chunked response");
+                        }
+                        size_t size = 0;
+                        auto parsed = std::from_chars(connection->buffer.data(), connection->buffer.data() + line_end, size, 16);
+                        if (parsed.ec == std::errc::result_out_of_range || (parsed.ec == std::errc{} && size > limit)) {
+                            throw ResponseTooLarge(limit);
+                        }
+                        if (parsed.ec != std::errc{} || size > SIZE_MAX - 2) {
+                            throw std::runtime_error("invalid chunk size");
+                        }
+                        connection->buffer.erase(0, line_end + 2);
+                        if (size == 0) {
+                            // Trailers end with an empty line
+                            for (;;) {
+                                while ((line_end = connection->buffer.find("\r\n")) == std::string::npos) {
+                                    if (!co_await read_more()) throw std::runtime_error("truncated chunked response");
+                                }
+                                connection->buffer.erase(0, line_end + 2);
+                                if (line_end == 0) break;
+                            }
+                            break;
+                        }
+                        while (connection->buffer.size() < size + 2) {
+                            if (!co_await read_more()) throw std::runtime_error("truncated chunked response");
+                        }
+                        deliver(std::string_view(connection->buffer).substr(0, size));
+                        connection->buffer.erase(0, size + 2);
+                    }
+                } else if (response.length) {
+                    if (!response.event_stream && *response.length > limit) {
+                        throw ResponseTooLarge(limit);
+                    }
+                    size_t remaining = *response.length;
+                    while (remaining > 0) {
+                        if (connection->buffer.empty() && !co_await read_more()) {
+                            throw std::runtime_error("truncated response");
+                        }
+                        size_t n = std::min(remaining, connection->buffer.size());
+                        deliver(std::string_view(connection->buffer).substr(0, n));
+                        connection->buffer.erase(0, n);
+                        remaining -= n;
+                    }
+                } else {
+                    // Delimited by the end of the connection
+                    reusable = false;
+                    do {
+                        deliver(connection->buffer);
+                        connection->buffer.clear();
+                    } while (co_await read_more());
+                }
+
+                if (!json.empty()) {
+                    auto message = nlohmann::json::parse(json, nullptr, false);
+                    if (message.is_object()) {
+                        sink(message);
+                    } else if (message.is_array()) {
+                        for (const auto &item: message) {
+                            if (item.is_object()) sink(item);
+                        }
+                    }
+                }
+
+                if (call) {
+                    call->active = nullptr;
+                }
+                if (reusable && replica.idle.size() < options_.max_idle_connections) {
+                    replica.idle.push_back(std::move(connection));
+                }
+                co_return Reply{response.status, std::move(response.session_id)};
+            } catch (const ResponseTooLarge &) {
+                // The rest of the body is never read, nor the request sent again
+                if (call) {
+                    call->active = nullptr;
+                }
+                throw;
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            if (call) {
+                call->active = nullptr;
+            }
+            // A kept-alive connection the replica has closed meanwhile fails before anything arrives
+            bool stale = reused && connection->buffer.empty() && attempt == 0 && !(call && call->aborted);
+            if (!stale) {
+                std::rethrow_exception(failure);
+            }
+        }
+    }
+
+    Federation::Replica *Federation::pick(Upstream &upstream) {
+        auto &replicas = upstream.replicas;
+        std::array<Replica *, 2> candidates{};
+        size_t healthy = 0;
+        for (auto &replica: replicas) {
+            healthy += replica->healthy ? 1 : 0;
+        }
+
+        // Two choices among the healthy replicas; with none, among all, so calls still find one coming back
+        auto eligible = [&](const Replica &replica) { return healthy == 0 || replica.healthy; };
+        size_t count = healthy == 0 ? replicas.size() : healthy;
+        for (auto &candidate: candidates) {
+            size_t index = std::uniform_int_distribution<size_t>(0, count - 1)(random_);
+            for (auto &replica: replicas) {
+                if (eligible(*replica) && index-- == 0) {
+                    candidate = replica.get();
+                    break;
+                }
+            }
+        }
+        auto score = [](const Replica &replica) { return (replica.latency_us + 1000.0) * (replica.in_flight + 1); };
+        return score(*candidates[0]) <= score(*candidates[1]) ? candidates[0] : candidates[1];
+    }
+
+    void Federation::mark_failed(Replica &replica, const std::string &reason) {
+        if (replica.healthy) {
+            MCP_WARN("Replica {} of upstream {} is down: {}", replica.url, replica.upstream, reason);
+        }
+        replica.healthy = false;
+        replica.idle.clear();
+        replica.session_open = false;
+    }
+
+    asio::awaitable<void> Federation::health_loop() {
+        asio::steady_timer timer(io_);
+        while (running_.load(std::memory_order_acquire)) {
+            timer.expires_after(options_.health_interval);
+            asio::error_code ec;
+            co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            for (auto &upstream: upstreams_) {
+                for (auto &replica: upstream->replicas) {
+                    if (!replica->probing) {
+                        replica->probing = true;
+                        asio::co_spawn(io_, probe(*replica), asio::detached);
+                    }
+                }
+            }
+        }
+    }
+
+    asio::awaitable<void> Federation::probe(Replica &replica) {
+        auto call = std::make_shared<Call>();
+        asio::steady_timer deadline(io_, options_.health_interval);
+        deadline.async_wait([call](const asio::error_code &ec) {
+            if (!ec) {
+                call->timed_out = true;
+                call->abort();
+            }
+        });
+
+        auto started = std::chrono::steady_clock::now();
+        nlohmann::json ping = {{"jsonrpc", "2.0"}, {"id", next_id_.fetch_add(1, std::memory_order_relaxed)}, {"method", "ping"}};
+        bool answered = false;
+        std::string failure = "no answer to ping";
+        try {
+            co_await request(replica, ping, call.get(), [&](const nlohmann::json &received) {
+                answered |= received.contains("id") && received["id"] == ping["id"];
+            });
+        } catch (const std::exception &e) {
+            failure = call->timed_out ? "ping timed out" : e.what();
+        }
+        deadline.cancel();
+        replica.probing = false;
+
+        if (!answered) {
+            mark_failed(replica, failure);
+            co_return;
+        }
+        double sample = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+        replica.latency_us = replica.latency_us == 0 ? sample : replica.latency_us + kLatencyWeight * (sample - replica.latency_us);
+        if (!replica.healthy) {
+            MCP_INFO("Replica {} of upstream {} is up again", replica.url, replica.upstream);
+            replica.healthy = true;
+        }
+    }
+
+    asio::awaitable<void> Federation::refresh_loop() {
+        asio::steady_timer timer(io_);
+        while (running_.load(std::memory_order_acquire)) {
+            bool listed = true;
+            for (auto &upstream: upstreams_) {
+                listed &= co_await list_tools(*upstream);
+            }
+            // An upstream that could not be listed is tried again as soon as replicas are pinged
+            timer.expires_after(listed ? std::chrono::duration_cast<std::chrono::milliseconds>(options_.refresh_interval) : options_.health_interval);
+            asio::error_code ec;
+            co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+    }
+
+    asio::awaitable<bool> Federation::list_tools(Upstream &upstream) {
+        // Each replica in turn until one answers; pick() passes over those that failed
+        nlohmann::json tools;
+        for (size_t attempt = 0; attempt < upstream.replicas.size() && tools.is_null(); ++attempt) {
+            auto call = std::make_shared<Call>();
+            asio::steady_timer deadline(io_, options_.call_timeout);
+            deadline.async_wait([call](const asio::error_code &ec) {
+                if (!ec) {
+                    call->timed_out = true;
+                    call->abort();
+                }
+            });
+
+            Replica *replica = pick(upstream);
+            nlohmann::json listed = nlohmann::json::array();
+            std::string failure = "too many pages";
+            try {
+                nlohmann::json cursor;
+                for (int page = 0; page < kMaxListPages; ++page) {
+                    nlohmann::json message = {{"jsonrpc", "2.0"},
+                                              {"id", next_id_.fetch_add(1, std::memory_order_relaxed)},
+                                              {"method", "tools/list"},
+                                              {"params", cursor.is_string() ? nlohmann::json{{"cursor", cursor}} : nlohmann::json::object()}};
+                    nlohmann::json result;
+                    co_await request(*replica, message, call.get(), [&](const nlohmann::json &received) {
+                        if (received.contains("id") && received["id"] == message["id"] && received.contains("result")) {
+                            result = received["result"];
+                        }
+                    });
+                    if (!result.is_object() || !result.contains("tools") || !result["tools"].is_array()) {
+                        throw std::runtime_error("tools/list returned no tools");
+                    }
+                    for (auto &tool: result["tools"]) {
+                        if (tool.is_object() && tool.contains("name") && tool["name"].is_string()) {
+                            listed.push_back(std::move(tool));
+                        }
+                    }
+                    cursor = result.value("nextCursor", nlohmann::json());
+                    if (!cursor.is_string() || cursor.get<std::string>().empty()) {
+                        tools = std::move(listed);
+                        break;
+                    }
+                }
+            } catch (const std::exception &e) {
+                failure = call->timed_out ? "timed out" : e.what();
+            }
+            deadline.cancel();
+            if (tools.is_null()) {
+                MCP_WARN("Could not list the tools of upstream {} at {}: {}", upstream.name, replica->url, failure);
+                mark_failed(*replica, failure);
+            }
+        }
+        if (tools.is_null()) {
+            co_return false;// The tools registered before stay; calls of tools that are gone fail upstream
+        }
+
+        std::string listed = tools.dump();
+        if (listed == upstream.listed) {
+            co_return true;
+        }
+
+        std::vector<RegisteredTool> entries;
+        entries.reserve(tools.size());
+        std::weak_ptr<Federation> weak = weak_from_this();
+        for (const auto &tool: tools) {
+            std::string remote_name = tool["name"].get<std::string>();
+            RegisteredTool entry;
+            entry.metadata.name = options_.prefix_tools ? upstream.name + "_" + remote_name : remote_name;
+            entry.metadata.description = tool.value("description", "");
+            entry.metadata.parameters = tool.value("inputSchema", nlohmann::json());
+            entry.raw_executor = [weak, upstream = &upstream, remote_name](const nlohmann::json &args) {
+                auto self = weak.lock();
+                if (!self) {
+                    ToolOutput output;
+                    output.error_code = protocol::error_code::INTERNAL_ERROR;
+                    output.error_message = "Federation is stopped";
+                    return output;
+                }
+                return self->call_tool(*upstream, remote_name, args);
+            };
+            // Callers that want a parsed result get the same call, with errors in the plugin form
+            entry.executor = [raw = entry.raw_executor](const nlohmann::json &args) -> nlohmann::json {
+                ToolOutput output = raw(args);
+                if (output.error_code != 0) {
+                    return {{"error", {{"code", output.error_code}, {"message", output.error_message}}}};
+                }
+                return nlohmann::json::parse(output.json);
+            };
+            entries.push_back(std::move(entry));
+        }
+
+        upstream.tools = registry_->replace_tools(upstream.tools, std::move(entries));
+        upstream.listed = std::move(listed);
+        MCP_INFO("Serving {} tools of upstream {}", upstream.tools.size(), upstream.name);
+        co_return true;
+    }
+
+}// namespace mcp::business
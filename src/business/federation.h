@@ -0,0 +1,145 @@
+// src/business/federation.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "tool_output.h"
+#include "tool_registry.h"
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Upstream MCP servers whose tools are served here, normally taken from the [federation] section.
+     */
+    struct FederationOptions {
+        struct Upstream {
+            std::string name;                 ///< Prefix of its tools
+            std::vector<std::string> replicas;///< Streamable HTTP endpoints, e.g. http://10.0.0.5:8080/mcp
+        };
+
+        std::vector<Upstream> upstreams;
+        bool prefix_tools = true;                     ///< Publish tools as "<upstream>_<tool>"
+        std::string token;                            ///< Bearer token sent upstream, empty = none
+        size_t max_idle_connections = 8;              ///< Kept-alive connections per replica
+        std::chrono::milliseconds call_timeout{30000};///< Longest a forwarded call may take
+        std::chrono::milliseconds health_interval{5000};///< Time between pings of each replica
+        std::chrono::seconds refresh_interval{60};    ///< Time between tools/list of each upstream
+
+        /**
+         * @brief Parse "search=http://a:8080/mcp|http://b:8080/mcp,docs=http://c:9000/mcp".
+         * Replicas of one upstream are separated by '|', upstreams by ','.
+         */
+        static std::vector<Upstream> parse_upstreams(std::string_view text);
+
+        static const FederationOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before the server is built.
+         * @param options Options
+         */
+        static void configure(FederationOptions options) { storage() = std::move(options); }
+
+    private:
+        static FederationOptions &storage() {
+            static FederationOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Serves the tools of upstream MCP servers as tools of this one.
+     *
+     * Each upstream is listed with tools/list now and then, and its tools are registered in the
+     * ToolRegistry as one version; a call is forwarded as tools/call and its result spliced into
+     * the response unparsed. Upstream progress notifications reach the client through the call's
+     * ProgressReporter, and cancelling the call cancels it upstream.
+     *
+     * All network I/O runs on one thread of its own, over keep-alive HTTP/1.1 connections pooled
+     * per replica, so a call costs a tool pool thread waiting and no new handshake. Replicas are
+     * pinged every health_interval; a call picks the better of two random healthy replicas by
+     * smoothed latency times calls in flight.
+     */
+    class Federation : public std::enable_shared_from_this<Federation> {
+    public:
+        /**
+         * @brief Connect to the configured upstreams and keep their tools registered.
+         * @param registry Registry the tools are published in
+         * @param options Upstreams
+         * @return Federation, nullptr if no upstream is configured
+         */
+        static std::shared_ptr<Federation> start(std::shared_ptr<ToolRegistry> registry,
+                                                 const FederationOptions &options = FederationOptions::current());
+
+        ~Federation();
+        Federation(const Federation &) = delete;
+        Federation &operator=(const Federation &) = delete;
+
+        /**
+         * @brief Unregister the remote tools and close every connection. Calls in flight fail.
+         */
+        void stop();
+
+    private:
+        struct Connection;
+        struct Replica;
+        struct Upstream;
+        struct Call;
+        struct Reply;
+
+        using MessageSink = std::function<void(const nlohmann::json &message)>;
+
+        Federation(std::shared_ptr<ToolRegistry> registry, const FederationOptions &options);
+
+        /**
+         * @brief Forward a tools/call; runs on a tool pool thread and blocks until the answer.
+         */
+        ToolOutput call_tool(Upstream &upstream, const std::string &remote_name, const nlohmann::json &args);
+
+        asio::awaitable<ToolOutput> run_call(Upstream &upstream, nlohmann::json message, std::shared_ptr<Call> call);
+
+        /**
+         * @brief Send a JSON-RPC request to a replica of its session, opening the session first.
+         * Messages of the answer, the response and anything sent before it, go to the sink.
+         */
+        asio::awaitable<Reply> request(Replica &replica, const nlohmann::json &message, Call *call, const MessageSink &sink);
+
+        /**
+         * @brief One POST on a pooled connection; a connection found closed by the peer is replaced once.
+         */
+        asio::awaitable<Reply> exchange(Replica &replica, const std::string &body, Call *call, const MessageSink &sink);
+
+        asio::awaitable<void> open_session(Replica &replica, Call *call);
+        asio::awaitable<void> refresh_loop();
+        asio::awaitable<void> health_loop();
+        asio::awaitable<void> probe(Replica &replica);
+        asio::awaitable<bool> list_tools(Upstream &upstream);
+
+        Replica *pick(Upstream &upstream);
+        void mark_failed(Replica &replica, const std::string &reason);
+
+        std::shared_ptr<ToolRegistry> registry_;
+        FederationOptions options_;
+        std::vector<std::unique_ptr<Upstream>> upstreams_;
+        std::atomic<int64_t> next_id_{1};
+        std::atomic<bool> running_{false};
+        std::atomic<bool> halted_{false};///< The thread has stopped, waiting calls give up
+        std::mt19937 random_{std::random_device{}()};///< Used on the federation thread only
+
+        asio::io_context io_{1};
+        std::thread thread_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,383 @@
+// src/business/host_services.cpp
+#include "host_services.h"
+#include "call_arena.h"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include "core/tool_thread_pool.hpp"
+#include "plugin_usage.h"
+#include "transport/http_response_decoder.h"
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr std::chrono::milliseconds kDefaultHttpTimeout{30000};
+        constexpr size_t kMaxResponseBytes = 64 * 1024 * 1024;
+        constexpr size_t kMaxHeadBytes = 64 * 1024;
+
+        struct Timer {
+            explicit Timer(asio::io_context &io) : timer(io) {}
+            asio::steady_timer timer;
+            std::atomic<bool> claimed{false};///< Set by whichever of expiry and cancel_timer comes first
+        };
+
+        struct HttpTarget {
+            std::string host;
+            std::string port;
+            std::string target;
+            std::string authority;///< For the Host header
+        };
+
+        std::optional<HttpTarget> parse_http_url(std::string_view url) {
+            constexpr std::string_view scheme = "http://";
+            if (!url.starts_with(scheme)) {
+                return std::nullopt;
+            }
+            url.remove_prefix(scheme.size());
+            size_t slash = url.find_first_of("/?");
+            std::string_view authority = url.substr(0, slash);
+            HttpTarget parsed;
+            parsed.authority = authority;
+            parsed.target = slash == std::string_view::npos ? "/" : std::string(url.substr(slash));
+            if (parsed.target.front() == '?') {
+                parsed.target.insert(0, 1, '/');
+            }
+            size_t colon = authority.rfind(':');
+            if (colon == std::string_view::npos || authority.find(']', colon) != std::string_view::npos) {
+                parsed.host = authority;
+                parsed.port = "80";
+            } else {
+                parsed.host = authority.substr(0, colon);
+                parsed.port = authority.substr(colon + 1);
+            }
+            if (parsed.host.size() >= 2 && parsed.host.front() == '[' && parsed.host.back() == ']') {
+                parsed.host = parsed.host.substr(1, parsed.host.size() - 2);
+            }
+            if (parsed.host.empty() || parsed.port.empty()) {
+                return std::nullopt;
+            }
+            return parsed;
+        }
+    }// namespace
+
+    struct HostServices::State : std::enable_shared_from_this<State> {
+        std::string plugin_name;
+        std::shared_mutex gate;///< Held shared by callbacks into the plugin, exclusively by close()
+        std::atomic<bool> open{true};
+        std::mutex mutex;
+        std::unordered_map<unsigned long long, std::shared_ptr<Timer>> timers;///< Pending timers, by id
+        unsigned long long next_timer = 1;
+
+        /**
+         * @brief Call back into the plugin unless it is closed.
+         */
+        template<typename Callback>
+        void deliver(Callback &&callback) {
+            std::shared_lock lock(gate);
+            if (open) {
+                callback();
+            }
+        }
+
+        static State &of(void *context) { return *static_cast<State *>(context); }
+
+        static unsigned long long start_timer(void *context, unsigned delay_ms, MCPTimerCallback callback, void *user);
+        static bool cancel_timer(void *context, unsigned long long id);
+        static void http_request(void *context, const MCPHttpRequest *request, MCPHttpCallback callback, void *user);
+        static void read_file(void *context, const char *path, unsigned long long offset, size_t size,
+                              MCPReadCallback callback, void *user);
+        static void *alloc(void *, size_t size) {
+            PluginUsage::count_allocation(size);
+            return std::malloc(size);
+        }
+        static void free(void *, void *ptr) { std::free(ptr); }
+        static void *call_alloc(void *, size_t size) {
+            CallArena *arena = CallArena::current();
+            if (!arena) {
+                return nullptr;
+            }
+            PluginUsage::count_allocation(size);
+            return arena->allocate(size);
+        }
+
+        asio::awaitable<void> exchange(HttpTarget target, std::string message, std::chrono::milliseconds timeout,
+                                       MCPHttpCallback callback, void *user);
+    };
+
+    namespace {
+        // Set while a callback runs, so that close() from inside one does not wait for itself
+        thread_local HostServices::State *tls_delivering = nullptr;
+
+        struct DeliveringScope {
+            explicit DeliveringScope(HostServices::State *state) : previous(tls_delivering) { tls_delivering = state; }
+            ~DeliveringScope() { tls_delivering = previous; }
+            HostServices::State *previous;
+        };
+    }// namespace
+
+    unsigned long long HostServices::State::start_timer(void *context, unsigned delay_ms, MCPTimerCallback callback, void *user) {
+        auto state = of(context).shared_from_this();
+        auto timer = std::make_shared<Timer>(AsioIOServicePool::GetInstance()->GetIOService());
+        unsigned long long id;
+        {
+            std::lock_guard lock(state->mutex);
+            id = state->next_timer++;
+            state->timers.emplace(id, timer);
+        }
+        timer->timer.expires_after(std::chrono::milliseconds(delay_ms));
+        timer->timer.async_wait([state, timer, id, callback, user](const asio::error_code &) {
+            {
+                std::lock_guard lock(state->mutex);
+                state->timers.erase(id);
+            }
+            bool cancelled = timer->claimed.exchange(true, std::memory_order_acq_rel);
+            state->deliver([&]() {
+                DeliveringScope scope(state.get());
+                callback(user, cancelled ? 1 : 0);
+            });
+        });
+        return id;
+    }
+
+    bool HostServices::State::cancel_timer(void *context, unsigned long long id) {
+        auto &state = of(context);
+        std::shared_ptr<Timer> timer;
+        {
+            std::lock_guard lock(state.mutex);
+            auto it = state.timers.find(id);
+            if (it == state.timers.end()) {
+                return false;
+            }
+            timer = it->second;
+        }
+        if (timer->claimed.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        // Timers are not thread safe, the cancel runs where the wait does
+        asio::post(timer->timer.get_executor(), [timer]() { timer->timer.cancel(); });
+        return true;
+    }
+
+    void HostServices::State::http_request(void *context, const MCPHttpRequest *request, MCPHttpCallback callback, void *user) {
+        auto state = of(context).shared_from_this();
+        auto &io = AsioIOServicePool::GetInstance()->GetIOService();
+        auto target = request->url ? parse_http_url(request->url) : std::nullopt;
+        if (!target) {
+            asio::post(io, [state, callback, user]() {
+                MCPHttpResponse response{"only http://host[:port][/path] URLs are supported", 0, {}, {}};
+                state->deliver([&]() {
+                    DeliveringScope scope(state.get());
+                    callback(user, &response);
+                });
+            });
+            return;
+        }
+
+        std::string message = request->method && *request->method ? request->method : "GET";
+        message += ' ' + target->target + " HTTP/1.1\r\n";
+        message += "Host: " + target->authority + "\r\n";
+        message += "Connection: close\r\n";
+        if (request->body.size > 0) {
+            message += "Content-Length: " + std::to_string(request->body.size) + "\r\n";
+        }
+        if (request->headers) {
+            message += request->headers;
+        }
+        message += "\r\n";
+        if (request->body.size > 0) {
+            message.append(request->body.data, request->body.size);
+        }
+        auto timeout = request->timeout_ms ? std::chrono::milliseconds(request->timeout_ms) : kDefaultHttpTimeout;
+        asio::co_spawn(io, state->exchange(std::move(*target), std::move(message), timeout, callback, user), asio::detached);
+    }
+
+    asio::awaitable<void> HostServices::State::exchange(HttpTarget target, std::string message, std::chrono::milliseconds timeout,
+                                                        MCPHttpCallback callback, void *user) {
+        auto self = shared_from_this();
+        auto executor = co_await asio::this_coro::executor;
+        struct Connection {
+            explicit Connection(const asio::any_io_executor &executor) : resolver(executor), socket(executor) {}
+            asio::ip::tcp::resolver resolver;
+            asio::ip::tcp::socket socket;
+            bool timed_out = false;
+        };
+        auto connection = std::make_shared<Connection>(executor);
+        auto &socket = connection->socket;
+        // Everything runs on this coroutine's io_context, so the watchdog can close the socket directly
+        asio::steady_timer watchdog(executor, timeout);
+        watchdog.async_wait([connection](const asio::error_code &ec) {
+            if (!ec) {
+                connection->timed_out = true;
+                connection->resolver.cancel();
+                asio::error_code ignored;
+                connection->socket.close(ignored);
+            }
+        });
+
+        std::string failure;
+        std::string headers;
+        std::string body;
+        int status = 0;
+        try {
+            auto endpoints = co_await connection->resolver.async_resolve(target.host, target.port, asio::use_awaitable);
+            co_await asio::async_connect(socket, endpoints, asio::use_awaitable);
+            socket.set_option(asio::ip::tcp::no_delay(true));
+            co_await asio::async_write(socket, asio::buffer(message), asio::use_awaitable);
+
+            transport::HttpResponseDecoder decoder;
+            std::array<char, 16 * 1024> chunk;
+            bool complete = false;
+            while (!complete) {
+                asio::error_code ec;
+                size_t n = co_await socket.async_read_some(asio::buffer(chunk), asio::redirect_error(asio::use_awaitable, ec));
+                if (ec == asio::error::eof && decoder.until_close()) {
+                    break;
+                }
+                if (ec) {
+                    throw std::runtime_error(ec == asio::error::eof ? "connection closed before the response was complete" : ec.message());
+                }
+                std::string_view data(chunk.data(), n);
+                while (!data.empty() && !complete) {
+                    switch (decoder.next(data)) {
+                        case transport::HttpResponseDecoder::Part::Head:
+                            status = decoder.status();
+                            for (const auto &[name, value]: decoder.fields()) {
+                                headers += name + ": " + value + "\r\n";
+                            }
+                            if (headers.size() > kMaxHeadBytes) {
+                                throw std::runtime_error("response head too large");
+                            }
+                            break;
+                        case transport::HttpResponseDecoder::Part::Body:
+                            if (body.size() + decoder.body().size() > kMaxResponseBytes) {
+                                throw std::runtime_error("response too large");
+                            }
+                            body.append(decoder.body());
+                            break;
+                        case transport::HttpResponseDecoder::Part::Error:
+                            throw std::runtime_error(decoder.error() ? decoder.error() : "malformed response");
+                        case transport::HttpResponseDecoder::Part::NeedMore:
+                            break;
+                    }
+                    complete = decoder.done();
+                }
+            }
+        } catch (const std::exception &e) {
+            failure = connection->timed_out ? "timed out" : e.what();
+            MCP_DEBUG("HTTP request of plugin {} to {}:{} failed: {}", plugin_name, target.host, target.port, failure);
+        }
+        watchdog.cancel();
+
+        MCPHttpResponse response{};
+        if (!failure.empty()) {
+            response.error = failure.c_str();
+        } else {
+            response.status = status;
+            response.headers = {headers.data(), headers.size()};
+            response.body = {body.data(), body.size()};
+        }
+        deliver([&]() {
+            DeliveringScope scope(this);
+            callback(user, &response);
+        });
+    }
+
+    void HostServices::State::read_file(void *context, const char *path, unsigned long long offset, size_t size,
+                                        MCPReadCallback callback, void *user) {
+        auto state = of(context).shared_from_this();
+#if defined(ASIO_HAS_FILE)
+        // Built with io_uring: the read is submitted by an io thread and completes there, no pool thread waits
+        auto &io = AsioIOServicePool::GetInstance()->GetIOService();
+        auto file = std::make_shared<asio::random_access_file>(io);
+        auto data = std::make_shared<std::string>();
+        std::string name(path ? path : "");
+        asio::error_code open_error;
+        file->open(name, asio::file_base::read_only, open_error);
+        uint64_t file_size = open_error ? 0 : file->size(open_error);
+        if (open_error) {
+            asio::post(io, [state, name, callback, user]() {
+                std::string failure = "cannot open " + name;
+                state->deliver([&]() {
+                    DeliveringScope scope(state.get());
+                    callback(user, {nullptr, 0}, failure.c_str());
+                });
+            });
+            return;
+        }
+        data->resize(offset < file_size ? static_cast<size_t>(std::min<uint64_t>(size, file_size - offset)) : 0);
+        asio::async_read_at(*file, offset, asio::buffer(*data), [state, file, data, name, callback, user](const asio::error_code &ec, size_t read) {
+            std::string failure = ec && ec != asio::error::eof ? "cannot read " + name : std::string();
+            data->resize(failure.empty() ? read : 0);
+            state->deliver([&]() {
+                DeliveringScope scope(state.get());
+                callback(user, {data->data(), data->size()}, failure.empty() ? nullptr : failure.c_str());
+            });
+        });
+#else
+        asio::post(core::ToolThreadPool::instance().executor(), [state, path = std::string(path ? path : ""), offset, size, callback, user]() {
+            std::string data;
+            std::string failure;
+            std::error_code ec;
+            auto file_size = std::filesystem::file_size(path, ec);
+            std::ifstream file(path, std::ios::binary);
+            if (ec || !file) {
+                failure = "cannot open " + path;
+            } else if (offset < file_size) {
+                data.resize(static_cast<size_t>(std::min<unsigned long long>(size, file_size - offset)));
+                file.seekg(static_cast<std::streamoff>(offset));
+                file.read(data.data(), static_cast<std::streamsize>(data.size()));
+                if (file.bad()) {
+                    failure = "cannot read " + path;
+                    data.clear();
+                } else {
+                    data.resize(static_cast<size_t>(file.gcount()));
+                }
+            }
+            state->deliver([&]() {
+                DeliveringScope scope(state.get());
+                callback(user, {data.data(), data.size()}, failure.empty() ? nullptr : failure.c_str());
+            });
+        });
+#endif
+    }
+
+    HostServices::HostServices(std::string plugin_name)
+        : state_(std::make_shared<State>()),
+          table_{MCP_HOST_SERVICES_VERSION, state_.get(), &State::start_timer, &State::cancel_timer, &State::http_request, &State::read_file,
+                 &State::alloc, &State::free, &State::call_alloc} {
+        state_->plugin_name = std::move(plugin_name);
+    }
+
+    HostServices::~HostServices() {
+        close();
+    }
+
+    void HostServices::close() {
+        if (tls_delivering == state_.get()) {
+            // The callback on this thread holds the gate already
+            state_->open = false;
+        } else {
+            std::unique_lock lock(state_->gate);
+            state_->open = false;
+        }
+
+        std::unordered_map<unsigned long long, std::shared_ptr<Timer>> timers;
+        {
+            std::lock_guard lock(state_->mutex);
+            timers.swap(state_->timers);
+        }
+        for (auto &[id, timer]: timers) {
+            asio::post(timer->timer.get_executor(), [timer]() { timer->timer.cancel(); });
+        }
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,46 @@
+// src/business/host_services.h
+#pragma once
+
+#include "mcp_plugin.h"
+#include <memory>
+#include <string>
+
+namespace mcp::business {
+
+    /**
+     * @brief Server side of MCPHostServices for one plugin, see mcp_plugin_set_host_services.
+     *
+     * Timers and HTTP requests run on the IO service pool, file reads on the ToolThreadPool. Every
+     * callback into the plugin passes a gate that close() shuts, so none runs, or is still running,
+     * once the library is about to be unmapped; operations still pending then finish without one.
+     */
+    class HostServices {
+    public:
+        /**
+         * @brief Create the services of a plugin.
+         * @param plugin_name Plugin file name, for the log
+         */
+        explicit HostServices(std::string plugin_name);
+        ~HostServices();
+        HostServices(const HostServices &) = delete;
+        HostServices &operator=(const HostServices &) = delete;
+
+        /**
+         * @brief Table to pass to the plugin, valid as long as this object.
+         */
+        const MCPHostServices *table() const { return &table_; }
+
+        /**
+         * @brief Stop calling back into the plugin, waiting for callbacks in progress on other threads.
+         * Pending timers are cancelled. Safe to call from a callback and more than once.
+         */
+        void close();
+
+        struct State;
+
+    private:
+        std::shared_ptr<State> state_;
+        MCPHostServices table_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,139 @@
+// src/business/idempotency_cache.cpp
+#include "idempotency_cache.h"
+#include "core/logger.h"
+#include "metrics/metrics_manager.h"
+#include "utils/content_hash.h"
+
+namespace mcp::business {
+
+    namespace {
+        constexpr std::size_t kMaxKeyLength = 255;
+
+        protocol::Response for_request(const protocol::Response &response, const nlohmann::json &id) {
+            protocol::Response copy = response;
+            copy.id = id;
+            if (copy.error) {
+                copy.error->id = id;
+            }
+            return copy;
+        }
+    }// namespace
+
+    IdempotencyCacheOptions &IdempotencyCache::pending_options() {
+        static IdempotencyCacheOptions options;
+        return options;
+    }
+
+    void IdempotencyCache::configure(IdempotencyCacheOptions options) {
+        pending_options() = std::move(options);
+    }
+
+    IdempotencyCache &IdempotencyCache::instance() {
+        static IdempotencyCache cache(pending_options());
+        return cache;
+    }
+
+    IdempotencyCache::IdempotencyCache(IdempotencyCacheOptions options)
+        : options_(std::move(options)),
+          results_(Astra::datastructures::MemoryBudget{options_.max_bytes}),
+          counters_(metrics::MetricsManager::getInstance()->register_cache_counters("idempotency")) {
+        if (options_.ttl.count() > 0) {
+            results_.StartCleanupThread();
+        }
+    }
+
+    std::string IdempotencyCache::key_of(const nlohmann::json &params, const transport::HeaderMap *headers) {
+        std::string key;
+        if (headers) {
+            key = std::string(headers->get("Idempotency-Key"));
+        }
+        if (key.empty() && params.is_object()) {
+            auto meta = params.find("_meta");
+            if (meta != params.end() && meta->is_object()) {
+                auto value = meta->find("idempotencyKey");
+                if (value != meta->end() && value->is_string()) {
+                    key = value->get<std::string>();
+                }
+            }
+        }
+        return key.size() <= kMaxKeyLength ? key : std::string();
+    }
+
+    void IdempotencyCache::set_max_bytes(std::size_t max_bytes) {
+        results_.setByteBudget(max_bytes);
+    }
+
+    asio::awaitable<protocol::Response> IdempotencyCache::call(const std::string &scope,
+                                                               const std::string &key,
+                                                               const std::string &tool_name,
+                                                               const nlohmann::json &args,
+                                                               const nlohmann::json &id,
+                                                               const Call &call) {
+        std::string cache_key = scope;
+        cache_key.push_back('\0');
+        cache_key.append(key);
+        // A retry must be the same call; objects serialize with sorted keys
+        std::string fingerprint = tool_name;
+        fingerprint.push_back('\0');
+        fingerprint.append(std::to_string(utils::content_hash(args.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace))));
+
+        if (auto kept = results_.Get(cache_key)) {
+            size_t end = fingerprint.size();
+            if (kept->size() <= end || kept->compare(0, end, fingerprint) != 0 || (*kept)[end] != '\0') {
+                co_return protocol::Response{protocol::Error{protocol::error_code::INVALID_PARAMS,
+                                                             "Idempotency key was used for a different call"},
+                                             id};
+            }
+            counters_->hits.fetch_add(1, std::memory_order_relaxed);
+            MCP_DEBUG("Answered retry of tool {} from its kept result", tool_name);
+            protocol::Response response;
+            response.id = id;
+            response.raw_result = std::make_shared<const std::string>(kept->substr(end + 1));
+            co_return response;
+        }
+
+        // The flight is keyed by the fingerprint too, so a reused key cannot join a different call
+        bool shared = false;
+        std::string flight_key = cache_key;
+        flight_key.push_back('\0');
+        flight_key.append(fingerprint);
+        std::function<asio::awaitable<protocol::Response>()> produce = [this, cache_key, fingerprint, call]() {
+            return run_and_store(cache_key, fingerprint, call);
+        };
+        auto response = co_await flights_.run(std::move(flight_key), std::move(produce), &shared);
+        if (shared) {
+            counters_->hits.fetch_add(1, std::memory_order_relaxed);
+            MCP_DEBUG("Retry of tool {} joined the call in flight", tool_name);
+        } else {
+            counters_->misses.fetch_add(1, std::memory_order_relaxed);
+        }
+        co_return for_request(response, id);
+    }
+
+    asio::awaitable<protocol::Response> IdempotencyCache::run_and_store(std::string key, std::string fingerprint, Call call) {
+        protocol::Response response;
+        try {
+            response = co_await call();
+        } catch (const std::exception &e) {
+            response.error = protocol::Error{protocol::error_code::INTERNAL_ERROR, e.what()};
+        }
+
+        // Keep successful results only, a failed call runs again when it is retried
+        if (!response.error && options_.ttl.count() > 0) {
+            std::string value = std::move(fingerprint);
+            value.push_back('\0');
+            if (response.raw_result) {
+                value.append(*response.raw_result);
+            } else {
+                value.append(response.result.dump());
+            }
+            if (value.size() <= options_.max_result_bytes) {
+                results_.Put(key, value, options_.ttl);
+                counters_->resident_bytes.store(static_cast<int64_t>(results_.MemoryUsage()), std::memory_order_relaxed);
+                counters_->entries.store(results_.Size(), std::memory_order_relaxed);
+            }
+        }
+        co_return response;
+    }
+
+}// namespace mcp::business
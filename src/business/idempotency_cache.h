@@ -0,0 +1,110 @@
+// src/business/idempotency_cache.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "core/single_flight.hpp"
+#include "protocol/json_rpc.h"
+#include "transport/LRUCache.hpp"
+#include "transport/header_map.h"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace mcp::metrics {
+    struct CacheCounters;
+}
+
+namespace mcp::business {
+
+    /**
+     * @brief Settings for the IdempotencyCache, normally taken from the [cache] section.
+     */
+    struct IdempotencyCacheOptions {
+        std::chrono::seconds ttl{300};             ///< How long a completed result answers retries, 0 = only calls in flight are joined
+        std::size_t max_bytes = 16 * 1024 * 1024;  ///< Memory budget of all kept results
+        std::size_t max_result_bytes = 1024 * 1024;///< Larger results are not kept
+    };
+
+    /**
+     * @brief Results of tools/call requests that carry an idempotency key, so that a client
+     *        retrying a call it gave up on does not run the tool a second time.
+     *
+     * The key is the Idempotency-Key header or "_meta.idempotencyKey" of the request, scoped
+     * to the caller: its tenant or credential (see ClusterQuota::tenant_of()), else its MCP
+     * session. A retry arriving while the first call runs waits for it and gets its outcome;
+     * one arriving later, within the TTL, gets the kept result. Only successful responses are
+     * kept, a failed call runs again on retry. A key reused with other arguments is refused.
+     * Counted in MetricsManager as "idempotency".
+     */
+    class IdempotencyCache {
+    public:
+        using Call = std::function<asio::awaitable<protocol::Response>()>;
+
+        IdempotencyCache(const IdempotencyCache &) = delete;
+        IdempotencyCache &operator=(const IdempotencyCache &) = delete;
+
+        /**
+         * @brief Set the cache options. Must be called before the first instance().
+         * @param options Cache options
+         */
+        static void configure(IdempotencyCacheOptions options);
+
+        /**
+         * @brief Get the process-wide cache, creating it on first use.
+         * @return Idempotency cache
+         */
+        static IdempotencyCache &instance();
+
+        /**
+         * @brief Idempotency key of a request: the Idempotency-Key header, else
+         *        params._meta.idempotencyKey.
+         * @return The key, empty if the request has none or it is longer than 255 bytes
+         */
+        static std::string key_of(const nlohmann::json &params, const transport::HeaderMap *headers);
+
+        /**
+         * @brief Change the memory budget of the running cache, evicting down to a smaller one.
+         * @param max_bytes New budget, 0 leaves it unchanged
+         */
+        void set_max_bytes(std::size_t max_bytes);
+
+        /**
+         * @brief Answer a call from the kept result of its key, by joining the call in flight
+         *        with its key, or by running it.
+         * @param scope Caller the key belongs to, must not be empty
+         * @param key Idempotency key, see key_of()
+         * @param tool_name Tool name
+         * @param args Tool arguments
+         * @param id JSON-RPC id of this request, set on shared responses
+         * @param call Runs the tool and builds its response
+         * @return Response for this request
+         */
+        asio::awaitable<protocol::Response> call(const std::string &scope,
+                                                 const std::string &key,
+                                                 const std::string &tool_name,
+                                                 const nlohmann::json &args,
+                                                 const nlohmann::json &id,
+                                                 const Call &call);
+
+    private:
+        explicit IdempotencyCache(IdempotencyCacheOptions options);
+
+        static IdempotencyCacheOptions &pending_options();
+
+        /**
+         * @brief Run a call as the leader of its flight and keep its result if it succeeded.
+         */
+        asio::awaitable<protocol::Response> run_and_store(std::string key, std::string fingerprint, Call call);
+
+        IdempotencyCacheOptions options_;
+        Astra::datastructures::LRUCache<std::string, std::string> results_;///< Key -> fingerprint, '\0', serialized result
+        core::SingleFlight<protocol::Response> flights_;                   ///< Calls in progress by key
+        std::shared_ptr<metrics::CacheCounters> counters_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "mcp_plugin.h"
+#include <string>
+#include <string_view>
+
+namespace mcp::business {
+
+    /**
+     * @brief Fill in an MCPError the way mcp_plugin.h asks: the message is kept in a buffer of
+     *        the calling thread, valid until the next call into the plugin on that thread, and
+     *        nothing is allocated per error that would have to be freed.
+     */
+    inline void set_plugin_error(MCPError *error, int code, std::string_view message) {
+        if (!error) {
+            return;
+        }
+        thread_local std::string buffer;
+        buffer.assign(message.data(), message.size());
+        error->code = code;
+        error->message = buffer.c_str();
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,931 @@
+#include "plugin_host.h"
+#include "core/logger.h"
+#include "plugin_error.h"
+#include "protocol/json_rpc.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+namespace mcp::business {
+
+    namespace {
+        constexpr std::size_t kHeaderBytes = 64;     ///< Control block at the start of each channel
+        constexpr std::size_t kMinBufferBytes = 4096;///< Smallest channel area
+        constexpr int kRegionFd = 3;                 ///< Descriptor of the region in the child, the channel sockets follow
+        constexpr auto kExitGrace = std::chrono::seconds(1);///< Time the child gets to uninitialize the plugin and exit
+
+        // Requests, a reply carries the op of its request
+        constexpr uint32_t kReady = 1;        ///< Child to server once the plugin is loaded: tool list or error
+        constexpr uint32_t kCall = 2;         ///< Synchronous call: status 0 and the result, or the error code and message
+        constexpr uint32_t kStreamStart = 3;  ///< Start a streaming tool: the stream id, or an error
+        constexpr uint32_t kStreamNext = 4;   ///< Next item of a stream: the status of next() and the item
+        constexpr uint32_t kStreamFree = 5;   ///< Free a stream
+        constexpr uint32_t kServerStarted = 6;///< Forward mcp_plugin_server_started
+
+        /**
+         * @brief Start of a channel; its area follows. Written before passing the turn and read after
+         *        receiving it, the socket send and receive order them.
+         */
+        struct ControlBlock {
+            uint32_t op;
+            uint32_t size;  ///< Bytes of this chunk in the area
+            uint32_t more;  ///< More chunks of the message follow
+            int32_t status; ///< Reply status, see the ops
+            uint32_t flags; ///< MCP_OUTPUT_* bits of a call result
+            uint32_t unused;
+            uint64_t stream;///< Stream the message is about
+        };
+        static_assert(sizeof(ControlBlock) <= kHeaderBytes);
+
+        /// A call or stream start: the 4-byte length of the tool name, the name and the arguments
+        std::string encode_call(std::string_view name, std::string_view args_json) {
+            auto name_size = static_cast<uint32_t>(name.size());
+            std::string payload(reinterpret_cast<const char *>(&name_size), sizeof(name_size));
+            payload += name;
+            payload += args_json;
+            return payload;
+        }
+
+        bool decode_call(const std::string &payload, std::string &name, std::string &args_json) {
+            uint32_t name_size = 0;
+            if (payload.size() < sizeof(name_size)) {
+                return false;
+            }
+            std::memcpy(&name_size, payload.data(), sizeof(name_size));
+            if (payload.size() - sizeof(name_size) < name_size) {
+                return false;
+            }
+            name.assign(payload, sizeof(name_size), name_size);
+            args_json.assign(payload, sizeof(name_size) + name_size);
+            return true;
+        }
+
+        std::string stream_error(std::string_view message) {
+            return nlohmann::json{{"error", {{"code", protocol::error_code::INTERNAL_ERROR}, {"message", message}}}}.dump();
+        }
+    }// namespace
+
+    struct PluginHost::Message {
+        Message() = default;
+        explicit Message(uint32_t op, int32_t status = 0, uint32_t flags = 0, uint64_t stream = 0)
+            : op(op), status(status), flags(flags), stream(stream) {}
+
+        uint32_t op = 0;
+        int32_t status = 0;
+        uint32_t flags = 0;
+        uint64_t stream = 0;
+        std::string payload;
+    };
+
+#if defined(__linux__)
+    namespace {
+        /**
+         * @brief One side's view of a channel.
+         */
+        struct Channel {
+            int socket = -1;
+            char *base = nullptr;
+            std::size_t capacity = 0;
+
+            ControlBlock *control() const { return reinterpret_cast<ControlBlock *>(base); }
+            char *area() const { return base + kHeaderBytes; }
+        };
+
+        bool pass_turn(int socket) {
+            char byte = 0;
+            while (send(socket, &byte, 1, MSG_NOSIGNAL) < 0) {
+                if (errno != EINTR) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Wait for the other side to pass the turn.
+         * @param timeout_ms Longest wait, negative for no limit
+         * @return false if it hung up or did not answer in time, with error set
+         */
+        bool take_turn(int socket, int timeout_ms, std::string &error) {
+            pollfd fd{socket, POLLIN, 0};
+            while (true) {
+                int ready = poll(&fd, 1, timeout_ms);
+                if (ready < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (ready < 0) {
+                    error = std::strerror(errno);
+                    return false;
+                }
+                if (ready == 0) {
+                    error = "no answer in time";
+                    return false;
+                }
+                // A final message and the hangup can arrive together, the message is read first
+                char byte;
+                ssize_t received = recv(socket, &byte, 1, 0);
+                if (received == 1) {
+                    return true;
+                }
+                if (received < 0 && errno == EINTR) {
+                    continue;
+                }
+                error = "process exited";
+                return false;
+            }
+        }
+
+        template<typename Header>
+        bool send_chunks(const Channel &channel, const Header &header, std::string_view payload, std::string &error) {
+            auto *control = channel.control();
+            std::size_t offset = 0;
+            while (true) {
+                std::size_t chunk = std::min(channel.capacity, payload.size() - offset);
+                std::memcpy(channel.area(), payload.data() + offset, chunk);
+                offset += chunk;
+                bool more = offset < payload.size();
+                control->op = header.op;
+                control->size = static_cast<uint32_t>(chunk);
+                control->more = more ? 1 : 0;
+                control->status = header.status;
+                control->flags = header.flags;
+                control->stream = header.stream;
+                if (!pass_turn(channel.socket)) {
+                    error = "process exited";
+                    return false;
+                }
+                if (!more) {
+                    return true;
+                }
+                // The other side acknowledges each chunk before the area is reused
+                if (!take_turn(channel.socket, -1, error)) {
+                    return false;
+                }
+            }
+        }
+
+        template<typename Header>
+        bool receive_chunks(const Channel &channel, int timeout_ms, Header &message, std::string &error) {
+            auto *control = channel.control();
+            message.payload.clear();
+            while (true) {
+                if (!take_turn(channel.socket, timeout_ms, error)) {
+                    return false;
+                }
+                if (control->size > channel.capacity) {
+                    error = "malformed message";
+                    return false;
+                }
+                message.payload.append(channel.area(), control->size);
+                message.op = control->op;
+                message.status = control->status;
+                message.flags = control->flags;
+                message.stream = control->stream;
+                if (!control->more) {
+                    return true;
+                }
+                if (!pass_turn(channel.socket)) {
+                    error = "process exited";
+                    return false;
+                }
+            }
+        }
+    }// namespace
+
+    struct PluginHost::Process {
+        pid_t pid = -1;
+        char *region = nullptr;
+        std::size_t region_size = 0;
+        std::vector<Channel> channels;
+        std::vector<std::size_t> free;///< Channels no call is using
+        bool retired = false;         ///< Failed, or replaced by a newer child; its channels are not reused
+
+        ~Process() {
+            // The child sees the hangup, uninitializes the plugin and exits
+            for (auto &channel: channels) {
+                if (channel.socket >= 0) {
+                    close(channel.socket);
+                }
+            }
+            if (pid > 0) {
+                auto deadline = std::chrono::steady_clock::now() + kExitGrace;
+                bool reaped = false;
+                while (!reaped && std::chrono::steady_clock::now() < deadline) {
+                    pid_t result = waitpid(pid, nullptr, WNOHANG);
+                    // Reaped here, or by someone else (ECHILD): either way the pid is no longer ours
+                    reaped = result == pid || (result < 0 && errno != EINTR);
+                    if (!reaped) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    }
+                }
+                // Only a child not reaped yet still owns its pid, afterwards it may be another process's
+                if (!reaped) {
+                    ::kill(pid, SIGKILL);
+                    while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {}
+                }
+            }
+            if (region) {
+                munmap(region, region_size);
+            }
+        }
+    };
+#else
+    struct PluginHost::Process {
+        std::vector<std::size_t> free;
+        bool retired = false;
+    };
+#endif
+
+    struct PluginHost::Lease {
+        std::shared_ptr<Process> process;
+        std::size_t channel = 0;
+    };
+
+    struct PluginHost::Stream {
+        std::shared_ptr<PluginHost> host;
+        std::shared_ptr<Process> process;///< The child the stream runs in; it ends if that child dies
+        uint64_t id = 0;
+        std::string current;///< Item handed out by the last next(), valid until the next call
+    };
+
+    PluginHost::PluginHost(std::filesystem::path plugin_path, Options options)
+        : plugin_path_(std::move(plugin_path)), options_(std::move(options)) {}
+
+    PluginHost::~PluginHost() {
+        std::shared_ptr<Process> process;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            process = std::move(process_);
+        }
+        idle_.notify_all();
+        // Calls still running hold their own reference to the child
+    }
+
+    bool PluginHost::supported() {
+#if defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool PluginHost::start(std::string &error) {
+        if (!supported()) {
+            error = "plugin hosts need Linux";
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string tools_json;
+        auto process = spawn(tools_json, error);
+        if (!process) {
+            return false;
+        }
+
+        try {
+            auto tools = nlohmann::json::parse(tools_json);
+            tools_.clear();
+            tool_strings_.clear();
+            // Reserved up front, so the strings never move and the pointers into them hold
+            tool_strings_.reserve(tools.size() * 3);
+            for (const auto &tool: tools) {
+                ToolInfo info{};
+                info.name = tool_strings_.emplace_back(tool.value("name", "")).c_str();
+                info.description = tool_strings_.emplace_back(tool.value("description", "")).c_str();
+                info.parameters = tool_strings_.emplace_back(tool.value("parameters", "{}")).c_str();
+                info.is_streaming = tool.value("is_streaming", false);
+                tools_.push_back(info);
+            }
+        } catch (const nlohmann::json::exception &e) {
+            error = std::string("malformed tool list: ") + e.what();
+            return false;
+        }
+        process_ = std::move(process);
+        return true;
+    }
+
+    bool PluginHost::acquire(std::shared_ptr<Process> process, Lease &lease, std::string &error) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            if (stopping_) {
+                error = "plugin host stopped";
+                return false;
+            }
+            if (process && process->retired) {
+                error = "plugin host restarted";
+                return false;
+            }
+            auto target = process ? process : process_;
+            if (!target) {
+                // The child died; the call that finds it gone starts the next one
+                if (std::chrono::steady_clock::now() < next_start_) {
+                    error = "plugin host is restarting";
+                    return false;
+                }
+                std::string tools_json;
+                target = spawn(tools_json, error);
+                if (!target) {
+                    next_start_ = std::chrono::steady_clock::now() + options_.restart_delay;
+                    MCP_ERROR("[PLUGIN] Cannot restart the host of {}: {}", plugin_path_.filename().string(), error);
+                    return false;
+                }
+                ++restarts_;
+                MCP_WARN("[PLUGIN] Restarted the host of {} ({} restarts)", plugin_path_.filename().string(), restarts_);
+                process_ = target;
+            }
+            if (!target->free.empty()) {
+                lease.process = target;
+                lease.channel = target->free.back();
+                target->free.pop_back();
+                return true;
+            }
+            idle_.wait(lock);
+        }
+    }
+
+    void PluginHost::release(Lease &lease, bool failed) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (failed && !lease.process->retired) {
+                lease.process->retired = true;
+                if (process_ == lease.process) {
+                    process_.reset();
+                }
+                MCP_WARN("[PLUGIN] Host of {} failed, it is started again on the next call", plugin_path_.filename().string());
+            } else if (!lease.process->retired) {
+                lease.process->free.push_back(lease.channel);
+            }
+        }
+        idle_.notify_all();
+        // The last reference to a retired child reaps it, outside the lock
+        lease.process.reset();
+    }
+
+    ToolOutput PluginHost::call_tool(const std::string &name, std::string_view args_json) {
+        ToolOutput output;
+        Lease lease;
+        std::string error;
+        if (!acquire(nullptr, lease, error)) {
+            output.error_code = -protocol::error_code::INTERNAL_ERROR;
+            output.error_message = "Plugin host unavailable: " + error;
+            return output;
+        }
+        Message request{kCall};
+        Message reply;
+        bool ok = exchange(lease, request, encode_call(name, args_json), reply, error);
+        release(lease, !ok);
+        if (!ok) {
+            output.error_code = -protocol::error_code::INTERNAL_ERROR;
+            output.error_message = "Plugin host failed during the call: " + error;
+        } else if (reply.status != 0) {
+            output.error_code = reply.status;
+            output.error_message = std::move(reply.payload);
+        } else {
+            output.json = std::move(reply.payload);
+            output.passthrough = (reply.flags & MCP_OUTPUT_PASSTHROUGH) != 0;
+        }
+        return output;
+    }
+
+    StreamGenerator PluginHost::start_stream(const std::string &name, std::string_view args_json, MCPError *error) {
+        Lease lease;
+        std::string failure;
+        if (!acquire(nullptr, lease, failure)) {
+            set_plugin_error(error, -protocol::error_code::INTERNAL_ERROR, "Plugin host unavailable: " + failure);
+            return nullptr;
+        }
+        Message request{kStreamStart};
+        Message reply;
+        bool ok = exchange(lease, request, encode_call(name, args_json), reply, failure);
+        auto process = lease.process;
+        release(lease, !ok);
+        if (!ok) {
+            set_plugin_error(error, -protocol::error_code::INTERNAL_ERROR, "Plugin host failed during the call: " + failure);
+            return nullptr;
+        }
+        if (reply.status != 0) {
+            set_plugin_error(error, reply.status, reply.payload);
+            return nullptr;
+        }
+        return new Stream{shared_from_this(), std::move(process), reply.stream, {}};
+    }
+
+    void PluginHost::server_started() {
+        Lease lease;
+        std::string error;
+        if (!acquire(nullptr, lease, error)) {
+            return;
+        }
+        Message request{kServerStarted};
+        Message reply;
+        bool ok = exchange(lease, request, {}, reply, error);
+        release(lease, !ok);
+    }
+
+    StreamGeneratorNext PluginHost::get_stream_next() {
+        return &PluginHost::stream_next;
+    }
+
+    StreamGeneratorFree PluginHost::get_stream_free() {
+        return &PluginHost::stream_free;
+    }
+
+    int PluginHost::stream_next(StreamGenerator generator, const char **result_json, MCPError * /*error*/) {
+        *result_json = nullptr;
+        if (!generator) {
+            return 1;
+        }
+        auto *stream = static_cast<Stream *>(generator);
+        Lease lease;
+        std::string failure;
+        if (!stream->host->acquire(stream->process, lease, failure)) {
+            stream->current = stream_error("Plugin host unavailable: " + failure);
+            *result_json = stream->current.c_str();
+            return -1;
+        }
+        Message request{kStreamNext, 0, 0, stream->id};
+        Message reply;
+        bool ok = stream->host->exchange(lease, request, {}, reply, failure);
+        stream->host->release(lease, !ok);
+        if (!ok) {
+            stream->current = stream_error("Plugin host failed during the stream: " + failure);
+            *result_json = stream->current.c_str();
+            return -1;
+        }
+        stream->current = std::move(reply.payload);
+        if (!stream->current.empty()) {
+            *result_json = stream->current.c_str();
+        }
+        return reply.status;
+    }
+
+    void PluginHost::stream_free(StreamGenerator generator) {
+        auto *stream = static_cast<Stream *>(generator);
+        if (!stream) {
+            return;
+        }
+        // A child that has died took the stream with it
+        Lease lease;
+        std::string failure;
+        if (stream->host->acquire(stream->process, lease, failure)) {
+            Message request{kStreamFree, 0, 0, stream->id};
+            Message reply;
+            bool ok = stream->host->exchange(lease, request, {}, reply, failure);
+            stream->host->release(lease, !ok);
+        }
+        delete stream;
+    }
+
+#if defined(__linux__)
+    std::shared_ptr<PluginHost::Process> PluginHost::spawn(std::string &tools_json, std::string &error) {
+        auto process = std::make_shared<Process>();
+        const std::size_t capacity = std::max(options_.buffer_bytes, kMinBufferBytes);
+        const std::size_t channels = std::max<std::size_t>(options_.channels, 1);
+        const std::size_t stride = kHeaderBytes + capacity;
+        process->region_size = channels * stride;
+
+        int region_fd = memfd_create("mcp-plugin-host", MFD_CLOEXEC);
+        if (region_fd < 0 || ftruncate(region_fd, static_cast<off_t>(process->region_size)) != 0) {
+            error = std::string("cannot create the shared region: ") + std::strerror(errno);
+            if (region_fd >= 0) close(region_fd);
+            return nullptr;
+        }
+        void *region = mmap(nullptr, process->region_size, PROT_READ | PROT_WRITE, MAP_SHARED, region_fd, 0);
+        if (region == MAP_FAILED) {
+            error = std::string("cannot map the shared region: ") + std::strerror(errno);
+            close(region_fd);
+            return nullptr;
+        }
+        process->region = static_cast<char *>(region);
+
+        // The child gets the region as descriptor 3 and its channel sockets from 4 on; they are
+        // moved above that range first, so one dup2 can't overwrite the source of another
+        std::vector<int> child_fds = {region_fd};
+        for (std::size_t i = 0; i < channels; ++i) {
+            int pair[2];
+            if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) != 0) {
+                error = std::string("cannot create a channel socket: ") + std::strerror(errno);
+                for (int fd: child_fds) close(fd);
+                return nullptr;
+            }
+            process->channels.push_back({pair[0], process->region + i * stride, capacity});
+            child_fds.push_back(pair[1]);
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        std::vector<int> moved;
+        for (std::size_t i = 0; i < child_fds.size(); ++i) {
+            moved.push_back(fcntl(child_fds[i], F_DUPFD_CLOEXEC, static_cast<int>(kRegionFd + child_fds.size() + 8)));
+            posix_spawn_file_actions_adddup2(&actions, moved.back(), kRegionFd + static_cast<int>(i));
+        }
+        // Whatever the plugin prints must not end up in a stdio transport
+        posix_spawn_file_actions_adddup2(&actions, STDERR_FILENO, STDOUT_FILENO);
+
+        std::string load_path = plugin_path_.string();
+        std::vector<std::string> args = {options_.executable, kHostFlag, load_path, std::to_string(channels), std::to_string(capacity)};
+        std::vector<char *> argv;
+        for (auto &arg: args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        pid_t pid = -1;
+        int rc = std::any_of(moved.begin(), moved.end(), [](int fd) { return fd < 0; })
+                         ? errno
+                         : posix_spawn(&pid, options_.executable.c_str(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        for (int fd: moved) {
+            if (fd >= 0) close(fd);
+        }
+        for (int fd: child_fds) {
+            close(fd);// The mapping keeps the region alive
+        }
+        if (rc != 0) {
+            error = "cannot start " + options_.executable + ": " + std::strerror(rc);
+            return nullptr;
+        }
+        process->pid = pid;
+
+        // The child reports on the first channel once it has loaded the plugin
+        Message ready;
+        if (!receive_chunks(process->channels.front(), static_cast<int>(options_.start_timeout.count()), ready, error)) {
+            error = "plugin host did not start: " + error;
+            return nullptr;
+        }
+        if (ready.op != kReady || ready.status != 0) {
+            error = ready.payload.empty() ? "plugin host did not start" : ready.payload;
+            return nullptr;
+        }
+        tools_json = std::move(ready.payload);
+        for (std::size_t i = channels; i > 0; --i) {
+            process->free.push_back(i - 1);
+        }
+        MCP_DEBUG("[PLUGIN] Host of {} started as process {} with {} channels", plugin_path_.filename().string(), pid, channels);
+        return process;
+    }
+
+    bool PluginHost::exchange(Lease &lease, const Message &request, std::string_view payload, Message &reply, std::string &error) {
+        const Channel &channel = lease.process->channels[lease.channel];
+        if (!send_chunks(channel, request, payload, error) || !receive_chunks(channel, -1, reply, error)) {
+            return false;
+        }
+        if (reply.op != request.op) {
+            error = "reply out of order";
+            return false;
+        }
+        return true;
+    }
+
+    namespace {
+        /**
+         * @brief Child side: the plugin, loaded the way PluginManager loads it in process.
+         */
+        class HostedPlugin {
+        public:
+            bool load(const std::string &path, std::string &tools_json, std::string &error) {
+                path_ = path;
+                handle_ = dlopen(path.c_str(), RTLD_LAZY);
+                if (!handle_) {
+                    error = std::string("Failed to load library: ") + dlerror();
+                    return false;
+                }
+                get_tools_ = (get_tools_func) dlsym(handle_, "get_tools");
+                call_tool_ = (call_tool_func) dlsym(handle_, "call_tool");
+                free_result_ = (free_result_func) dlsym(handle_, "free_result");
+                auto initialize_plugin = (initialize_plugin_func) dlsym(handle_, "initialize_plugin");
+                uninitialize_plugin_ = (uninitialize_plugin_func) dlsym(handle_, "uninitialize_plugin");
+                auto get_abi_version = (get_abi_version_func) dlsym(handle_, "mcp_plugin_abi_version");
+                int abi_version = get_abi_version ? get_abi_version() : 1;
+                if (abi_version >= 2) {
+                    call_tool_v2_ = (call_tool_v2_func) dlsym(handle_, "call_tool_v2");
+                    call_tool_cancellable_ = (call_tool_cancellable_func) dlsym(handle_, "call_tool_cancellable");
+                    call_tool_with_progress_ = (call_tool_with_progress_func) dlsym(handle_, "call_tool_with_progress");
+                }
+                auto get_stream_next = (get_stream_next_func) dlsym(handle_, "get_stream_next");
+                auto get_stream_free = (get_stream_free_func) dlsym(handle_, "get_stream_free");
+                auto get_stream_wait = (get_stream_wait_func) dlsym(handle_, "get_stream_wait");
+                server_started_ = (server_started_func) dlsym(handle_, "mcp_plugin_server_started");
+                if (!get_tools_ || (!call_tool_v2_ && !call_tool_cancellable_ && !call_tool_with_progress_ && (!call_tool_ || !free_result_))) {
+                    error = "Plugin missing required functions: " + path;
+                    return false;
+                }
+                stream_next_ = get_stream_next ? get_stream_next() : nullptr;
+                stream_free_ = get_stream_free ? get_stream_free() : nullptr;
+                stream_wait_ = get_stream_wait ? get_stream_wait() : nullptr;
+
+                if (initialize_plugin && !initialize_plugin(path.c_str())) {
+                    error = "Failed to initialize plugin: " + path;
+                    return false;
+                }
+                initialized_ = initialize_plugin != nullptr;
+
+                int count = 0;
+                ToolInfo *tools = get_tools_(&count);
+                auto list = nlohmann::json::array();
+                for (int i = 0; tools && i < count; ++i) {
+                    list.push_back({{"name", tools[i].name ? tools[i].name : ""},
+                                    {"description", tools[i].description ? tools[i].description : ""},
+                                    {"parameters", tools[i].parameters ? tools[i].parameters : "{}"},
+                                    {"is_streaming", tools[i].is_streaming}});
+                }
+                tools_json = list.dump();
+                return true;
+            }
+
+            void unload() {
+                std::unordered_map<uint64_t, std::unique_ptr<HostedStream>> streams;
+                {
+                    std::lock_guard<std::mutex> lock(streams_mutex_);
+                    streams.swap(streams_);
+                }
+                for (auto &[id, stream]: streams) {
+                    if (stream_free_) {
+                        stream_free_(stream->generator);
+                    }
+                }
+                if (initialized_ && uninitialize_plugin_) {
+                    uninitialize_plugin_(path_.c_str());
+                }
+            }
+
+            void serve(const Channel &channel) {
+                PluginHost::Message request;
+                PluginHost::Message reply;
+                std::string error;
+                while (receive_chunks(channel, -1, request, error)) {
+                    reply = PluginHost::Message{request.op, 0, 0, request.stream};
+                    switch (request.op) {
+                        case kCall:
+                            call(request.payload, reply);
+                            break;
+                        case kStreamStart:
+                            start_stream(request.payload, reply);
+                            break;
+                        case kStreamNext:
+                            next(request.stream, reply);
+                            break;
+                        case kStreamFree:
+                            free_stream(request.stream);
+                            break;
+                        case kServerStarted:
+                            if (server_started_) {
+                                server_started_();
+                            }
+                            break;
+                        default:
+                            reply.status = -1;
+                            break;
+                    }
+                    if (!send_chunks(channel, reply, reply.payload, error)) {
+                        break;
+                    }
+                }
+            }
+
+        private:
+            /**
+             * @brief A stream and the wakeup its generator calls; freed with the stream, so a late
+             *        wakeup never finds it gone.
+             */
+            struct HostedStream {
+                StreamGenerator generator = nullptr;
+                std::mutex mutex;
+                std::condition_variable woken_cv;
+                bool woken = false;
+
+                static void wake(void *context) {
+                    auto *stream = static_cast<HostedStream *>(context);
+                    std::lock_guard<std::mutex> lock(stream->mutex);
+                    stream->woken = true;
+                    stream->woken_cv.notify_all();
+                }
+            };
+
+            void fail(PluginHost::Message &reply, const MCPError &error, const char *fallback) {
+                reply.status = error.code != 0 ? error.code : -protocol::error_code::INTERNAL_ERROR;
+                reply.payload = error.message ? error.message : fallback;
+            }
+
+            void call(const std::string &payload, PluginHost::Message &reply) {
+                std::string name, args_json;
+                if (!decode_call(payload, name, args_json)) {
+                    fail(reply, {}, "Malformed call");
+                    return;
+                }
+                MCPError error = {0, nullptr, nullptr, nullptr};
+                if (call_tool_with_progress_ || call_tool_cancellable_ || call_tool_v2_) {
+                    // Cancellation and progress stay in the server, the child gets the inert versions
+                    static const MCPCancelToken never_cancelled = {nullptr, [](void *) { return false; }};
+                    static const MCPProgress no_progress = {nullptr, [](void *, double, double, const char *) {}};
+                    OutputArena arena{reply.payload};
+                    MCPOutput sink = {&arena, 0, &OutputArena::write, &OutputArena::reserve, &OutputArena::commit};
+                    MCPBuffer args = {args_json.data(), args_json.size()};
+                    int status;
+                    if (call_tool_with_progress_) {
+                        status = call_tool_with_progress_(name.c_str(), args, &sink, &error, &never_cancelled, &no_progress);
+                    } else if (call_tool_cancellable_) {
+                        status = call_tool_cancellable_(name.c_str(), args, &sink, &error, &never_cancelled);
+                    } else {
+                        status = call_tool_v2_(name.c_str(), args, &sink, &error);
+                    }
+                    arena.finish();
+                    if (status != 0 || error.code != 0) {
+                        fail(reply, error, "Tool failed without an error message");
+                        return;
+                    }
+                    reply.flags = sink.flags;
+                    return;
+                }
+                const char *result = call_tool_(name.c_str(), args_json.c_str(), &error);
+                if (error.code != 0 || !result) {
+                    if (result) {
+                        free_result_(result);
+                    }
+                    fail(reply, error, "Tool returned null result");
+                    return;
+                }
+                reply.payload = result;
+                free_result_(result);
+            }
+
+            void start_stream(const std::string &payload, PluginHost::Message &reply) {
+                std::string name, args_json;
+                if (!decode_call(payload, name, args_json) || !call_tool_ || !stream_next_) {
+                    fail(reply, {}, "Plugin does not support streaming tools");
+                    return;
+                }
+                MCPError error = {0, nullptr, nullptr, nullptr};
+                const char *raw = call_tool_(name.c_str(), args_json.c_str(), &error);
+                if (error.code != 0 || !raw) {
+                    fail(reply, error, "Plugin returned null for streaming tool");
+                    return;
+                }
+                auto stream = std::make_unique<HostedStream>();
+                stream->generator = reinterpret_cast<StreamGenerator>(const_cast<char *>(raw));
+                std::lock_guard<std::mutex> lock(streams_mutex_);
+                reply.stream = ++next_stream_;
+                streams_.emplace(reply.stream, std::move(stream));
+            }
+
+            void next(uint64_t id, PluginHost::Message &reply) {
+                HostedStream *stream = find(id);
+                if (!stream) {
+                    reply.status = 1;
+                    return;
+                }
+                // The server reads the stream as a blocking generator, a non-blocking one is waited for here
+                const char *item = nullptr;
+                MCPError error = {0, nullptr, nullptr, nullptr};
+                int status;
+                while ((status = stream_next_(stream->generator, &item, &error)) == MCP_STREAM_WOULD_BLOCK) {
+                    if (!stream_wait_) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(stream->mutex);
+                    stream->woken = false;
+                    lock.unlock();
+                    int fd = stream_wait_(stream->generator, &HostedStream::wake, stream);
+                    if (fd >= 0) {
+                        pollfd readable{fd, POLLIN, 0};
+                        poll(&readable, 1, 1000);
+                    } else {
+                        lock.lock();
+                        stream->woken_cv.wait_for(lock, std::chrono::seconds(1), [stream] { return stream->woken; });
+                    }
+                }
+                reply.status = status;
+                if (item) {
+                    reply.payload = item;
+                } else if (status == -1 && error.message) {
+                    reply.payload = stream_error(error.message);
+                }
+            }
+
+            void free_stream(uint64_t id) {
+                std::unique_ptr<HostedStream> stream;
+                {
+                    std::lock_guard<std::mutex> lock(streams_mutex_);
+                    auto it = streams_.find(id);
+                    if (it == streams_.end()) {
+                        return;
+                    }
+                    stream = std::move(it->second);
+                    streams_.erase(it);
+                }
+                if (stream_free_) {
+                    stream_free_(stream->generator);
+                }
+            }
+
+            HostedStream *find(uint64_t id) {
+                std::lock_guard<std::mutex> lock(streams_mutex_);
+                auto it = streams_.find(id);
+                return it != streams_.end() ? it->second.get() : nullptr;
+            }
+
+            std::string path_;
+            void *handle_ = nullptr;
+            bool initialized_ = false;
+            get_tools_func get_tools_ = nullptr;
+            call_tool_func call_tool_ = nullptr;
+            free_result_func free_result_ = nullptr;
+            uninitialize_plugin_func uninitialize_plugin_ = nullptr;
+            call_tool_v2_func call_tool_v2_ = nullptr;
+            call_tool_cancellable_func call_tool_cancellable_ = nullptr;
+            call_tool_with_progress_func call_tool_with_progress_ = nullptr;
+            server_started_func server_started_ = nullptr;
+            StreamGeneratorNext stream_next_ = nullptr;
+            StreamGeneratorFree stream_free_ = nullptr;
+            StreamGeneratorWait stream_wait_ = nullptr;
+
+            std::mutex streams_mutex_;
+            std::unordered_map<uint64_t, std::unique_ptr<HostedStream>> streams_;
+            uint64_t next_stream_ = 0;
+        };
+    }// namespace
+
+    int PluginHost::run(int argc, char **argv) {
+        if (argc < 5) {
+            std::fprintf(stderr, "usage: %s %s <plugin> <channels> <area bytes>\n", argv[0], kHostFlag);
+            return 2;
+        }
+        // The server decides when the child ends, by hanging up its channels
+        std::signal(SIGINT, SIG_IGN);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        std::string plugin_path = argv[2];
+        std::size_t channels = std::strtoull(argv[3], nullptr, 10);
+        std::size_t capacity = std::strtoull(argv[4], nullptr, 10);
+        std::size_t stride = kHeaderBytes + capacity;
+        if (channels == 0 || capacity < kMinBufferBytes) {
+            std::fprintf(stderr, "%s: invalid channel layout\n", kHostFlag);
+            return 2;
+        }
+        void *region = mmap(nullptr, channels * stride, PROT_READ | PROT_WRITE, MAP_SHARED, kRegionFd, 0);
+        if (region == MAP_FAILED) {
+            std::fprintf(stderr, "%s: cannot map the shared region: %s\n", kHostFlag, std::strerror(errno));
+            return 1;
+        }
+        close(kRegionFd);
+        std::vector<Channel> links;
+        for (std::size_t i = 0; i < channels; ++i) {
+            links.push_back({kRegionFd + 1 + static_cast<int>(i), static_cast<char *>(region) + i * stride, capacity});
+        }
+
+        HostedPlugin plugin;
+        std::string tools_json;
+        std::string error;
+        bool loaded = plugin.load(plugin_path, tools_json, error);
+        Message ready{kReady, loaded ? 0 : 1};
+        std::string send_error;
+        if (!send_chunks(links.front(), ready, loaded ? tools_json : error, send_error) || !loaded) {
+            return 1;
+        }
+
+        std::vector<std::thread> threads;
+        for (const auto &link: links) {
+            threads.emplace_back([&plugin, &link]() { plugin.serve(link); });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        plugin.unload();
+        return 0;
+    }
+#else
+    std::shared_ptr<PluginHost::Process> PluginHost::spawn(std::string &, std::string &error) {
+        error = "plugin hosts need Linux";
+        return nullptr;
+    }
+
+    bool PluginHost::exchange(Lease &, const Message &, std::string_view, Message &, std::string &error) {
+        error = "plugin hosts need Linux";
+        return false;
+    }
+
+    int PluginHost::run(int, char **) {
+        return 2;
+    }
+#endif
+
+}// namespace mcp::business
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "mcp_plugin.h"
+#include "tool_output.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Runs one shared-library plugin in a child process, so a crash or a leak takes down
+     *        only the child.
+     *
+     * The child is the server executable started with kHostFlag. It loads the plugin the way
+     * PluginManager would and serves calls on a few channels, each with a thread of its own on
+     * both sides. A channel is an area in a memory region shared with the child and one end of a
+     * Unix socket pair: a side writes a message into the area and sends a byte to pass the turn,
+     * the socket hangs up when the other side exits. A message larger than the area is passed in
+     * chunks, each acknowledged through the socket. A caller takes the next idle channel and waits
+     * for one if all are busy.
+     *
+     * A child that dies fails the calls it was running and is started again by the next call; the
+     * tools are the ones it reported first. Streams run in the child as well and are read like a
+     * blocking generator; they end with an error if the child dies.
+     * Linux only; start() fails elsewhere.
+     */
+    class PluginHost : public std::enable_shared_from_this<PluginHost> {
+    public:
+        static constexpr const char *kHostFlag = "--plugin-host";///< First argument of the child
+
+        struct Options {
+            std::string executable;                        ///< Server executable, started with kHostFlag
+            std::size_t channels = 2;                      ///< Calls the child runs at the same time
+            std::size_t buffer_bytes = 256 * 1024;         ///< Size of each channel's area
+            std::chrono::milliseconds start_timeout{30000};///< Longest time the child may take to load the plugin
+            std::chrono::milliseconds restart_delay{1000}; ///< Wait after a failed start before the next attempt
+        };
+
+        PluginHost(std::filesystem::path plugin_path, Options options);
+        ~PluginHost();
+
+        PluginHost(const PluginHost &) = delete;
+        PluginHost &operator=(const PluginHost &) = delete;
+
+        /**
+         * @brief Whether plugin hosts are available on this platform.
+         */
+        static bool supported();
+
+        /**
+         * @brief Start the child and wait until it has loaded the plugin and listed its tools.
+         * @param error Set to the reason if it fails
+         */
+        bool start(std::string &error);
+
+        /**
+         * @brief Tools the plugin reported on the first start; the strings live as long as the host.
+         */
+        const std::vector<ToolInfo> &tools() const { return tools_; }
+
+        /**
+         * @brief Run a synchronous tool in the child, blocking until it returns.
+         * @return Output, or an error code and message; a dead child is reported as an error
+         */
+        ToolOutput call_tool(const std::string &name, std::string_view args_json);
+
+        /**
+         * @brief Start a streaming tool in the child.
+         * @param error Filled in if it fails; the message is valid until the next call on this thread
+         * @return Generator for the functions of get_stream_next() and get_stream_free(), nullptr on error
+         */
+        StreamGenerator start_stream(const std::string &name, std::string_view args_json, MCPError *error);
+
+        /**
+         * @brief Tell the child that the server accepts connections, for plugins exporting
+         *        mcp_plugin_server_started.
+         */
+        void server_started();
+
+        static StreamGeneratorNext get_stream_next();
+        static StreamGeneratorFree get_stream_free();
+
+        /**
+         * @brief Entry point of the child, called by main() when argv[1] is kHostFlag.
+         * @return Exit status
+         */
+        static int run(int argc, char **argv);
+
+        struct Message;///< Request or reply on a channel, defined with the wire format
+
+    private:
+        struct Process;
+        struct Stream;
+        struct Lease;
+
+        /**
+         * @brief Take an idle channel of the running child, starting it first if needed.
+         * @param process The child to use; unset for the current one, which may be (re)started
+         * @return false with error set if there is no child to call
+         */
+        bool acquire(std::shared_ptr<Process> process, Lease &lease, std::string &error);
+
+        /**
+         * @brief Give a channel back. A failed one retires its child, which the next call replaces.
+         */
+        void release(Lease &lease, bool failed);
+
+        /**
+         * @brief Start a child process and read the tools it reports. Called with mutex_ held.
+         */
+        std::shared_ptr<Process> spawn(std::string &tools_json, std::string &error);
+
+        /**
+         * @brief Send a request on a leased channel and read the reply.
+         * @return false if the child died or answered garbage, with error set
+         */
+        bool exchange(Lease &lease, const Message &request, std::string_view payload, Message &reply, std::string &error);
+
+        static int stream_next(StreamGenerator generator, const char **result_json, MCPError *error);
+        static void stream_free(StreamGenerator generator);
+
+        const std::filesystem::path plugin_path_;
+        const Options options_;
+        std::vector<ToolInfo> tools_;
+        std::vector<std::string> tool_strings_;///< Backs the strings of tools_
+
+        std::mutex mutex_;
+        std::condition_variable idle_;
+        std::shared_ptr<Process> process_;///< Running child, nullptr until started or after it died
+        std::chrono::steady_clock::time_point next_start_{};
+        uint64_t restarts_ = 0;
+        bool stopping_ = false;
+    };
+
+}// namespace mcp::business
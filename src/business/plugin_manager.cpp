@@ -1,33 +1,310 @@
 // src/business/plugin_manager.cpp
 #include "plugin_manager.h"
+#include "core/housekeeping.h"
 #include "core/logger.h"
+#include "call_arena.h"
+#include "cancellation.h"
+#include "metrics/metrics_manager.h"
+#include "metrics/rate_limiter.h"
+#include "metrics/tracing.h"
+#include "plugin_manifest.h"
+#include "plugin_usage.h"
+#include "progress.h"
 #include "protocol/json_rpc.h"
+#include "transport/upload_stream.h"
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <utility>
 
 namespace mcp::business {
 
-    PluginManager::~PluginManager() {
-        stop_directory_monitoring();
-        for (auto &[name, plugin]: plugins_) {
-            if (plugin->handle) {
-                CLOSE_LIB(plugin->handle);
+    namespace {
+        constexpr auto kReloadDebounce = std::chrono::milliseconds(500);///< Quiet time before a changed plugin is reloaded
+
+        int64_t now_ticks() {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        /**
+         * @brief Server side of MCPTraceSource: the span context the tool call scoped on the calling thread.
+         */
+        size_t current_traceparent(void * /*context*/, char *buffer, size_t size) {
+            const metrics::SpanContext *span = metrics::SpanContext::current();
+            if (!span || !buffer || size < MCP_TRACEPARENT_SIZE) {
+                return 0;
             }
+            std::string traceparent = span->traceparent();
+            std::memcpy(buffer, traceparent.c_str(), traceparent.size() + 1);
+            return traceparent.size();
         }
+
+        const MCPTraceSource kTraceSource = {nullptr, &current_traceparent};
+
+        /**
+         * @brief Take the plugin's error of a call into its output, copying the message.
+         * @param has_result Whether the plugin reported success
+         */
+        void take_error(ToolOutput &output, const MCPError &error, bool has_result) {
+            if (error.code != 0) {
+                MCP_CRITICAL("Error calling tool: {}", error.message ? error.message : "Unknown error");
+                output.error_code = error.code;// Use the error code returned by the plugin
+                output.error_message = error.message ? error.message : "Unknown error";
+                output.json.clear();
+            } else if (!has_result) {
+                output.error_code = -mcp::protocol::error_code::INTERNAL_ERROR;
+                output.error_message = "Tool returned null result";
+            }
+        }
+
+        /// max_response_size, the most bytes a tool result may have; 0 = unlimited
+        size_t result_limit() {
+            return metrics::RateLimiter::getInstance()->get_config().max_response_size;
+        }
+
+        /**
+         * @brief Replace the output of a call whose plugin wrote more than result_limit() with an error.
+         */
+        void take_overflow(ToolOutput &output, size_t limit) {
+            MCP_WARN("Tool result exceeds max_response_size of {} bytes, the call is answered with an error", limit);
+            output.error_code = mcp::protocol::error_code::RESPONSE_TOO_LARGE;
+            output.error_message = "Tool result exceeds the maximum response size of " + std::to_string(limit) + " bytes";
+            output.json.clear();
+            output.json.shrink_to_fit();
+            output.passthrough = false;
+        }
+
+        /**
+         * @brief Run a batch of calls of one tool through the plugin's call_tools_batch.
+         */
+        void run_batch(PluginManager::Plugin &plugin, const std::string &name, const std::vector<BatchedCall *> &calls) {
+            std::vector<OutputArena> arenas;
+            std::vector<MCPOutput> sinks;
+            std::vector<MCPBatchCall> batch;
+            arenas.reserve(calls.size());
+            sinks.reserve(calls.size());
+            batch.reserve(calls.size());
+            const size_t limit = result_limit();
+            for (auto *call: calls) {
+                auto &arena = arenas.emplace_back(OutputArena{call->output.json, 0, limit});
+                auto &sink = sinks.emplace_back(MCPOutput{&arena, 0, &OutputArena::write, &OutputArena::reserve, &OutputArena::commit});
+                batch.push_back(MCPBatchCall{{call->args_json.data(), call->args_json.size()}, &sink, {0, nullptr, nullptr, nullptr}, -1});
+            }
+
+            CallArena::Scope arena_scope;
+            plugin.call_tools_batch(name.c_str(), batch.data(), batch.size());
+
+            for (size_t i = 0; i < calls.size(); ++i) {
+                arenas[i].finish();
+                calls[i]->output.passthrough = (sinks[i].flags & MCP_OUTPUT_PASSTHROUGH) != 0;
+                MCPError &error = batch[i].error;
+                if (batch[i].status != 0 && error.code == 0) {
+                    error.code = -mcp::protocol::error_code::INTERNAL_ERROR;
+                    error.message = "Tool failed without an error message";
+                }
+                take_error(calls[i]->output, error, batch[i].status == 0);
+                if (arenas[i].exceeded) {
+                    take_overflow(calls[i]->output, limit);
+                }
+            }
+        }
+    }// namespace
+
+    PluginManager::Plugin::~Plugin() {
+        if (unloading && uninitialize_plugin) {
+            MCP_DEBUG("Uninitializing plugin: {}", name);
+            uninitialize_plugin(name.c_str());
+        }
+        // No more callbacks into the library
+        if (host_services) {
+            host_services->close();
+        }
+        if (handle) {
+            CLOSE_LIB(handle);
+            MCP_DEBUG("Closed library handle for plugin: {}", name);
+        }
+        if (!shadow_path.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(shadow_path, ec);
+        }
+    }
+
+    PluginStrand *PluginManager::Plugin::strand_for(const ToolInfo *tool) const {
+        if (!strand || tool < tool_list.data() || tool >= tool_list.data() + tool_list.size()) {
+            return nullptr;
+        }
+        return tool_thread_safety[static_cast<size_t>(tool - tool_list.data())] != MCP_THREAD_SAFETY_REENTRANT ? strand.get() : nullptr;
+    }
+
+    PluginManager::~PluginManager() {
+        stop_directory_monitoring();
+        core::Housekeeping::instance().cancel(std::exchange(idle_task_, 0));
+        // Libraries are closed by ~Plugin once the last reference is released
+        tool_index_.store(std::make_shared<const ToolIndex>());
         plugins_.clear();
         load_order_.clear();
     }
 
     bool PluginManager::load_plugin(const std::string &path) {
         std::filesystem::path plugin_path = std::filesystem::absolute(path);
-        std::string plugin_file_path = plugin_path.string();
-        MCP_TRACE("Loading plugin from: {}", plugin_file_path);
+        MCP_TRACE("Loading plugin from: {}", plugin_path.string());
+
+        std::shared_ptr<Plugin> plugin;
+        if (lazy_loading_) {
+            if (auto manifest = PluginManifest::load(plugin_path.parent_path())) {
+                if (auto entry = manifest->find_current(plugin_path)) {
+                    plugin = make_stub(plugin_path, std::move(entry));
+                }
+            }
+        }
+
+        if (!plugin) {
+            std::filesystem::path shadow_path;
+            if (!prepare_load(plugin_path, shadow_path)) {
+                return false;
+            }
+            plugin = open_plugin(plugin_path, std::move(shadow_path));
+            if (!plugin) {
+                return false;
+            }
+        }
+
+        // Loading a plugin again lifts a disable for exceeding its quota
+        PluginUsage::instance().reset(plugin->name);
+
+        std::lock_guard<std::mutex> lock(plugins_mutex_);
+        bool deferred = !plugin->loaded();
+        install_plugin(std::move(plugin));
+        rebuild_tool_index();
+        MCP_DEBUG("Plugin {} successfully: {} (total plugins: {})", deferred ? "registered from manifest" : "loaded",
+                  plugin_path.filename().string(), plugins_.size());
+        return true;
+    }
+
+    size_t PluginManager::load_plugins(const std::vector<std::string> &paths) {
+        struct Job {
+            std::filesystem::path plugin_path;
+            std::filesystem::path shadow_path;
+            bool ready = false;
+            std::shared_ptr<Plugin> plugin;
+        };
+
+        // Resolving paths touches draining_plugins_, so it stays on the calling thread.
+        // With lazy loading, plugins whose manifest entry is current only get a stub.
+        std::vector<Job> jobs(paths.size());
+        std::unordered_map<std::string, std::optional<PluginManifest>> manifests;// directory -> manifest
+        size_t deferred = 0;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            jobs[i].plugin_path = std::filesystem::absolute(paths[i]);
+            if (lazy_loading_) {
+                std::string directory = jobs[i].plugin_path.parent_path().string();
+                auto manifest = manifests.find(directory);
+                if (manifest == manifests.end()) {
+                    manifest = manifests.emplace(directory, PluginManifest::load(directory)).first;
+                }
+                if (manifest->second) {
+                    if (auto entry = manifest->second->find_current(jobs[i].plugin_path)) {
+                        jobs[i].plugin = make_stub(jobs[i].plugin_path, std::move(entry));
+                        ++deferred;
+                        continue;
+                    }
+                }
+            }
+            jobs[i].ready = prepare_load(jobs[i].plugin_path, jobs[i].shadow_path);
+        }
+
+        // dlopen, initialize_plugin and get_tools run in parallel; they only touch the job they own
+        auto started = std::chrono::steady_clock::now();
+        std::atomic<size_t> next_job{0};
+        auto worker = [this, &jobs, &next_job]() {
+            for (size_t i = next_job.fetch_add(1); i < jobs.size(); i = next_job.fetch_add(1)) {
+                if (jobs[i].ready) {
+                    jobs[i].plugin = open_plugin(jobs[i].plugin_path, std::move(jobs[i].shadow_path));
+                }
+            }
+        };
+        size_t thread_count = std::min<size_t>(jobs.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < thread_count; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread: workers) {
+            thread.join();
+        }
+
+        // Install in the order given so tool ownership and logging do not depend on thread timing
+        size_t loaded = 0;
+        {
+            std::lock_guard<std::mutex> lock(plugins_mutex_);
+            for (auto &job: jobs) {
+                if (!job.plugin) {
+                    MCP_ERROR("Skipping invalid plugin: {}", job.plugin_path.string());
+                    continue;
+                }
+                install_plugin(std::move(job.plugin));
+                ++loaded;
+            }
+            rebuild_tool_index();
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        MCP_INFO("Loaded {} of {} plugins in {} ms using {} threads ({} deferred until first call)", loaded, jobs.size(),
+                 elapsed.count(), thread_count, deferred);
+        return loaded;
+    }
+
+    bool PluginManager::prepare_load(const std::filesystem::path &plugin_path, std::filesystem::path &shadow_path) {
+        if (!std::filesystem::exists(plugin_path)) {
+            MCP_ERROR("Plugin file not found: {}", plugin_path.string());
+            return false;
+        }
+
+        // dlopen/LoadLibrary return the already mapped library for a known path. While an older
+        // version is still draining, load a private copy so both versions can run side by side.
+        std::string plugin_name = plugin_path.filename().string();
+        std::lock_guard<std::mutex> lock(plugins_mutex_);
+        auto draining = draining_plugins_.find(plugin_name);
+        if (draining != draining_plugins_.end() && draining->second.expired()) {
+            draining_plugins_.erase(draining);
+            draining = draining_plugins_.end();
+        }
+        if (draining == draining_plugins_.end()) {
+            return true;
+        }
 
-        if (!std::filesystem::exists(plugin_file_path)) {
-            MCP_ERROR("Plugin file not found: {}", plugin_file_path);
+        std::error_code ec;
+        std::filesystem::path shadow_dir = std::filesystem::temp_directory_path(ec) / "mcp-plugins";
+        std::filesystem::create_directories(shadow_dir, ec);
+        shadow_path = shadow_dir / (plugin_path.stem().string() + "." + std::to_string(++shadow_counter_) +
+                                    plugin_path.extension().string());
+        if (ec || !std::filesystem::copy_file(plugin_path, shadow_path, std::filesystem::copy_options::overwrite_existing, ec)) {
+            MCP_ERROR("Failed to create shadow copy of {} while the previous version drains: {}",
+                      plugin_path.string(), ec.message());
+            shadow_path.clear();
             return false;
         }
+        MCP_INFO("Previous version of {} still in use, loading new version from {}", plugin_name, shadow_path.string());
+        return true;
+    }
+
+    std::shared_ptr<PluginManager::Plugin> PluginManager::open_plugin(const std::filesystem::path &plugin_path,
+                                                                      std::filesystem::path shadow_path) const {
+        auto started = std::chrono::steady_clock::now();
+        std::string plugin_file_path = plugin_path.string();
+        std::string plugin_name = plugin_path.filename().string();
+        std::string load_path = shadow_path.empty() ? plugin_file_path : shadow_path.string();
+
+        if (is_isolated(plugin_path)) {
+            // Each child maps the library afresh, a draining version in another child is no obstacle
+            if (!shadow_path.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(shadow_path, ec);
+            }
+            return open_hosted_plugin(plugin_path);
+        }
 
-        lib_handle handle = LOAD_LIB(plugin_file_path.c_str());
+        lib_handle handle = LOAD_LIB(load_path.c_str());
         if (!handle) {
             MCP_ERROR("Failed to load library: {}", plugin_file_path);
 #ifdef _WIN32
@@ -35,7 +312,11 @@ namespace mcp::business {
 #else
             MCP_ERROR("dlerror: {}", dlerror());
 #endif
-            return false;
+            if (!shadow_path.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(shadow_path, ec);
+            }
+            return nullptr;
         }
 
         // Get the plugin functions
@@ -52,13 +333,43 @@ namespace mcp::business {
         // Load stream functions if available
         auto get_stream_next_loader = (get_stream_next_func) GET_FUNC(handle, "get_stream_next");
         auto get_stream_free_loader = (get_stream_free_func) GET_FUNC(handle, "get_stream_free");
-        std::string plugin_name = plugin_path.filename().string();
+        auto get_stream_wait_loader = (get_stream_wait_func) GET_FUNC(handle, "get_stream_wait");
+        // ABI v2 entry point, only trusted if the plugin reports a version that has it
+        auto get_abi_version = (get_abi_version_func) GET_FUNC(handle, "mcp_plugin_abi_version");
+        int abi_version = get_abi_version ? get_abi_version() : 1;
+        auto call_tool_v2 = abi_version >= 2 ? (call_tool_v2_func) GET_FUNC(handle, "call_tool_v2") : nullptr;
+        auto call_tool_cancellable = abi_version >= 2 ? (call_tool_cancellable_func) GET_FUNC(handle, "call_tool_cancellable") : nullptr;
+        auto call_tool_with_progress = abi_version >= 2 ? (call_tool_with_progress_func) GET_FUNC(handle, "call_tool_with_progress") : nullptr;
+        auto call_tool_with_input = abi_version >= 2 ? (call_tool_with_input_func) GET_FUNC(handle, "call_tool_with_input") : nullptr;
+        auto call_tools_batch = abi_version >= 2 ? (call_tools_batch_func) GET_FUNC(handle, "call_tools_batch") : nullptr;
+        // A streamed argument is of no use without the entry point that reads it
+        auto streamed_argument = call_tool_with_input ? (streamed_argument_func) GET_FUNC(handle, "mcp_plugin_streamed_argument") : nullptr;
+        auto get_stream_cancel_loader = (get_stream_cancel_func) GET_FUNC(handle, "get_stream_cancel");
+        // Checkpoints are only of use with a way to restore them
+        auto stream_restore = (stream_restore_func) GET_FUNC(handle, "stream_restore");
+        auto get_stream_checkpoint_loader = stream_restore ? (get_stream_checkpoint_func) GET_FUNC(handle, "get_stream_checkpoint") : nullptr;
+        auto set_trace_source = (set_trace_source_func) GET_FUNC(handle, "mcp_plugin_set_trace_source");
+        auto server_started = (server_started_func) GET_FUNC(handle, "mcp_plugin_server_started");
+        auto set_host_services = (set_host_services_func) GET_FUNC(handle, "mcp_plugin_set_host_services");
+        auto thread_safety = (thread_safety_func) GET_FUNC(handle, "mcp_plugin_thread_safety");
 
 
-        if (!get_tools || !call_tool || !free_result) {
+        // From here on ~Plugin closes the library (and removes the shadow copy) on every exit path
+        auto plugin = std::make_shared<Plugin>();
+        plugin->handle = handle;
+        plugin->name = plugin_name;
+        plugin->path = plugin_path;
+        plugin->shadow_path = std::move(shadow_path);
+
+        if (!get_tools || (!call_tool_v2 && !call_tool_cancellable && !call_tool_with_progress && (!call_tool || !free_result))) {
             MCP_ERROR("Plugin missing required functions: {}", plugin_file_path);
-            CLOSE_LIB(handle);
-            return false;
+            return nullptr;
+        }
+
+        // Plugins that do their I/O through the server get the services before they initialize
+        if (set_host_services) {
+            plugin->host_services = std::make_unique<HostServices>(plugin_name);
+            set_host_services(plugin->host_services->table());
         }
 
         // Initialize plugin if it has initialize_plugin function
@@ -69,13 +380,17 @@ namespace mcp::business {
             MCP_DEBUG("initialize_plugin returned: {}", init_result);
             if (!init_result) {
                 MCP_ERROR("Failed to initialize plugin: {}", plugin_file_path);
-                CLOSE_LIB(handle);
-                return false;
+                return nullptr;
             }
         } else {
             MCP_DEBUG("Plugin does not have initialize_plugin function: {}", plugin_file_path);
         }
 
+        // Plugins that propagate trace context read it from the source while a call runs
+        if (set_trace_source) {
+            set_trace_source(&kTraceSource);
+        }
+
         // Loading tools from the plugin
         int tool_count = 0;
         ToolInfo *tool_infos = get_tools(&tool_count);
@@ -83,9 +398,7 @@ namespace mcp::business {
             MCP_WARN("Plugin has no tools: {}", plugin_file_path);
         }
 
-        // Create plugin object
-        auto plugin = std::make_unique<Plugin>();
-        plugin->handle = handle;
+        // Fill in the plugin object
         plugin->get_tools = get_tools;
         plugin->call_tool = call_tool;
         plugin->free_result = free_result;
@@ -93,21 +406,245 @@ namespace mcp::business {
         plugin->uninitialize_plugin = uninitialize_plugin;
         plugin->get_stream_next = get_stream_next_loader;
         plugin->get_stream_free = get_stream_free_loader;
+        plugin->get_stream_wait = get_stream_wait_loader;
+        plugin->call_tool_v2 = call_tool_v2;
+        plugin->call_tool_cancellable = call_tool_cancellable;
+        plugin->call_tool_with_progress = call_tool_with_progress;
+        plugin->call_tool_with_input = streamed_argument ? call_tool_with_input : nullptr;
+        plugin->streamed_argument = streamed_argument;
+        plugin->call_tools_batch = call_tools_batch;
+        plugin->get_stream_cancel = get_stream_cancel_loader;
+        plugin->get_stream_checkpoint = get_stream_checkpoint_loader;
+        plugin->stream_restore = get_stream_checkpoint_loader ? stream_restore : nullptr;
+        plugin->server_started = server_started;
         for (int i = 0; i < tool_count; ++i) {
             plugin->tool_list.push_back(tool_infos[i]);
             MCP_DEBUG("Loaded tool: '{}' from plugin", tool_infos[i].name);
         }
 
+        // Tools that are not reentrant queue on a strand of the plugin's, see mcp_plugin_thread_safety
+        if (thread_safety) {
+            bool serialized = false;
+            bool pinned = false;
+            for (const auto &tool: plugin->tool_list) {
+                int level = thread_safety(tool.name);
+                plugin->tool_thread_safety.push_back(level);
+                serialized |= level != MCP_THREAD_SAFETY_REENTRANT;
+                pinned |= level == MCP_THREAD_SAFETY_PINNED;
+            }
+            if (serialized) {
+                plugin->strand = std::make_shared<PluginStrand>(pinned, plugin_name);
+            } else {
+                plugin->tool_thread_safety.clear();
+            }
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        MCP_INFO("Opened plugin {} ({} tools, ABI v{}) in {} ms", plugin_name, plugin->tool_list.size(),
+                 call_tool_v2 || call_tool_cancellable || call_tool_with_progress ? 2 : 1, elapsed.count());
+
+        // Hot-reloaded and lazily loaded plugins come after the start
+        if (plugin->server_started && server_started_.load(std::memory_order_acquire)) {
+            plugin->server_started();
+        }
+        return plugin;
+    }
+
+    std::shared_ptr<PluginManager::Plugin> PluginManager::open_hosted_plugin(const std::filesystem::path &plugin_path) const {
+        auto started = std::chrono::steady_clock::now();
+        auto host = std::make_shared<PluginHost>(plugin_path, host_options_);
+        std::string error;
+        if (!host->start(error)) {
+            MCP_ERROR("Failed to start plugin host for {}: {}", plugin_path.string(), error);
+            return nullptr;
+        }
+
+        auto plugin = std::make_shared<Plugin>();
+        plugin->name = plugin_path.filename().string();
+        plugin->path = plugin_path;
+        plugin->host = std::move(host);
+        plugin->tool_list = plugin->host->tools();// Points into the host, which the plugin keeps alive
+        if (std::any_of(plugin->tool_list.begin(), plugin->tool_list.end(), [](const ToolInfo &tool) { return tool.is_streaming; })) {
+            plugin->get_stream_next = &PluginHost::get_stream_next;
+            plugin->get_stream_free = &PluginHost::get_stream_free;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        MCP_INFO("Opened plugin {} in a child process ({} tools) in {} ms", plugin->name, plugin->tool_list.size(), elapsed.count());
+
+        if (server_started_.load(std::memory_order_acquire)) {
+            plugin->host->server_started();
+        }
+        return plugin;
+    }
+
+    bool PluginManager::is_isolated(const std::filesystem::path &plugin_path) const {
+        std::string file_name = plugin_path.filename().string();
+        std::string stem = plugin_path.stem().string();
+        return std::any_of(isolated_plugins_.begin(), isolated_plugins_.end(), [&](const std::string &name) {
+            return name == "*" || name == file_name || name == stem;
+        });
+    }
 
+    void PluginManager::set_isolation(std::vector<std::string> plugins, PluginHost::Options options) {
+        if (!plugins.empty() && !PluginHost::supported()) {
+            MCP_WARN("Plugin isolation is not supported on this platform, plugins are loaded in process");
+            return;
+        }
+        isolated_plugins_ = std::move(plugins);
+        host_options_ = std::move(options);
+        if (!isolated_plugins_.empty()) {
+            std::string names;
+            for (const auto &name: isolated_plugins_) {
+                names += (names.empty() ? "" : ", ") + name;
+            }
+            MCP_INFO("Plugins run in child processes: {} ({} channels of {} KiB each)", names, host_options_.channels,
+                     host_options_.buffer_bytes / 1024);
+        }
+    }
+
+    void PluginManager::install_plugin(std::shared_ptr<Plugin> plugin) {
+        std::string plugin_name = plugin->name;
         plugins_[plugin_name] = std::move(plugin);
         load_order_.push_back(plugin_name);
-        MCP_DEBUG("Plugin loaded successfully: {} (total plugins: {})", plugin_name, plugins_.size());
+    }
+
+    std::shared_ptr<PluginManager::Plugin> PluginManager::make_stub(const std::filesystem::path &plugin_path,
+                                                                    std::shared_ptr<const PluginManifestEntry> manifest) {
+        auto stub = std::make_shared<Plugin>();
+        stub->name = plugin_path.filename().string();
+        stub->path = plugin_path;
+        stub->tool_list = manifest->tool_infos;// Points into the manifest entry, which the stub keeps alive
+        stub->manifest = std::move(manifest);
+        MCP_DEBUG("Registered {} tools of {} from the manifest", stub->tool_list.size(), stub->name);
+        return stub;
+    }
+
+    void PluginManager::notify_server_started() {
+        std::vector<std::shared_ptr<Plugin>> plugins;
+        {
+            std::lock_guard<std::mutex> lock(plugins_mutex_);
+            if (server_started_.exchange(true, std::memory_order_acq_rel)) {
+                return;
+            }
+            for (const auto &[plugin_name, plugin]: plugins_) {
+                if (plugin->loaded() && (plugin->server_started || plugin->host)) {
+                    plugins.push_back(plugin);
+                }
+            }
+        }
+        for (const auto &plugin: plugins) {
+            if (plugin->host) {
+                plugin->host->server_started();
+            } else {
+                plugin->server_started();
+            }
+        }
+    }
+
+    void PluginManager::set_lazy_loading(bool enabled, std::chrono::seconds idle_timeout) {
+        lazy_loading_ = enabled;
+        idle_timeout_ = enabled ? idle_timeout : std::chrono::seconds(0);
+        if (idle_timeout_.count() <= 0 || idle_task_ != 0) {
+            return;
+        }
+
+        // Checking a few times per timeout keeps the overshoot at a quarter timeout
+        auto interval = std::max<std::chrono::seconds>(std::chrono::seconds(1), idle_timeout_ / 4);
+        idle_task_ = core::Housekeeping::instance().every(interval, [this]() { unload_idle_plugins(); });
+        MCP_INFO("Lazily loaded plugins are unloaded after {}s without calls", idle_timeout_.count());
+    }
+
+    std::optional<PluginManager::ToolEntry> PluginManager::resolve_tool(const std::string &name) {
+        auto entry = find_tool(name);
+        if (entry && !entry->plugin->loaded() && ensure_loaded(entry->plugin)) {
+            // Switch to the loaded plugin's entry; the stub and its tool list are on their way out
+            if (auto loaded = find_tool(name)) {
+                entry = std::move(loaded);
+            }
+        }
+        if (entry) {
+            entry->plugin->last_used.store(now_ticks(), std::memory_order_relaxed);
+        }
+        return entry;
+    }
+
+    bool PluginManager::ensure_loaded(const std::shared_ptr<Plugin> &stub) {
+        std::lock_guard<std::mutex> lazy_lock(lazy_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(plugins_mutex_);
+            auto it = plugins_.find(stub->name);
+            if (it == plugins_.end() || it->second != stub) {
+                // Loaded by a concurrent call, or replaced or removed by the directory monitor
+                return it != plugins_.end() && it->second->loaded();
+            }
+        }
+
+        MCP_INFO("Loading plugin {} on first use", stub->name);
+        std::filesystem::path shadow_path;
+        if (!prepare_load(stub->path, shadow_path)) {
+            return false;
+        }
+        auto plugin = open_plugin(stub->path, std::move(shadow_path));
+        if (!plugin) {
+            return false;
+        }
+        plugin->manifest = stub->manifest;
+        plugin->last_used.store(now_ticks(), std::memory_order_relaxed);
 
+        std::lock_guard<std::mutex> lock(plugins_mutex_);
+        auto it = plugins_.find(stub->name);
+        if (it == plugins_.end() || it->second != stub) {
+            // The directory monitor replaced the stub meanwhile; drop this copy
+            plugin->unloading = true;
+            return false;
+        }
+        it->second = std::move(plugin);
+        rebuild_tool_index();
         return true;
     }
 
+    void PluginManager::unload_idle_plugins() {
+        std::vector<std::shared_ptr<Plugin>> released;
+        {
+            std::lock_guard<std::mutex> lock(plugins_mutex_);
+            auto index = tool_index_.load(std::memory_order_acquire);
+            int64_t now = now_ticks();
+            int64_t timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(idle_timeout_).count();
+            for (auto &[plugin_name, plugin]: plugins_) {
+                // Only plugins listed in the manifest can be turned back into a stub
+                if (!plugin->loaded() || !plugin->manifest ||
+                    now - plugin->last_used.load(std::memory_order_relaxed) < timeout) {
+                    continue;
+                }
+                // plugins_ holds one reference and the index one per tool; more means a call or stream is running
+                long expected = 1 + std::count_if(index->begin(), index->end(),
+                                                  [&plugin](const auto &item) { return item.second.plugin == plugin; });
+                if (plugin.use_count() > expected) {
+                    continue;
+                }
+                MCP_INFO("Unloading plugin {} after {}s without calls", plugin_name, idle_timeout_.count());
+                auto stub = make_stub(plugin->path, plugin->manifest);
+                plugin->unloading = true;
+                // A lookup that raced with this still holds a reference; a reload must not reuse the mapping
+                draining_plugins_[plugin_name] = plugin;
+                released.push_back(std::move(plugin));
+                plugin = std::move(stub);
+            }
+            if (!released.empty()) {
+                rebuild_tool_index();
+            }
+        }
+        // Uninitialize and close the libraries outside the lock
+        released.clear();
+    }
+
 
     void PluginManager::load_plugins_from_directory(const std::string &directory) {
+        load_plugins(find_plugin_files(directory));
+    }
+
+    std::vector<std::string> PluginManager::find_plugin_files(const std::string &directory) const {
         // Handle empty directory path - use current directory
         std::filesystem::path dir_path;
         if (directory.empty()) {
@@ -119,34 +656,26 @@ namespace mcp::business {
 
         if (!std::filesystem::exists(dir_path)) {
             MCP_WARN("Plugin directory does not exist: {}", dir_path.string());
-            return;
+            return {};
         }
 
         if (!std::filesystem::is_directory(dir_path)) {
             MCP_WARN("Path is not a directory: {}", dir_path.string());
-            return;
+            return {};
         }
 
         MCP_INFO("Scanning plugin directory: {}", dir_path.string());
 
-        // Foreach file in directory
+        std::vector<std::string> files;
         for (const auto &entry: std::filesystem::directory_iterator(dir_path)) {
-            if (entry.is_regular_file()) {
-                std::string filename = entry.path().filename().string();
-
-                // Cross platform
-#ifdef _WIN32
-                if (entry.path().extension() == ".dll") {
-#elif __APPLE__
-                if (entry.path().extension() == ".dylib") {
-#else
-                if (entry.path().extension() == ".so") {
-#endif
-                    MCP_TRACE("Found plugin file: {}", filename);
-                    load_plugin(entry.path().string());
-                }
+            if (entry.is_regular_file() && is_plugin_file(entry.path())) {
+                MCP_TRACE("Found plugin file: {}", entry.path().filename().string());
+                files.push_back(entry.path().string());
             }
         }
+        // directory_iterator order is unspecified; sort so load order is reproducible
+        std::sort(files.begin(), files.end());
+        return files;
     }
 
 
@@ -154,6 +683,7 @@ namespace mcp::business {
         std::string plugin_name = std::filesystem::path(plugin_path).filename().string();
         MCP_INFO("get_tools_from_plugin: looking for '{}'", plugin_name);
 
+        std::lock_guard<std::mutex> lock(plugins_mutex_);
         auto it = plugins_.find(plugin_name);
         if (it == plugins_.end()) {
             MCP_WARN("Plugin '{}' not found", plugin_name);
@@ -166,86 +696,248 @@ namespace mcp::business {
 
     std::vector<ToolInfo> PluginManager::get_all_tools() const {
         std::vector<ToolInfo> all_tools;
-        for (const auto &[name, plugin]: plugins_) {
-            all_tools.insert(all_tools.end(), plugin->tool_list.begin(), plugin->tool_list.end());
+        std::lock_guard<std::mutex> lock(plugins_mutex_);
+        for (const auto &name: load_order_) {
+            auto it = plugins_.find(name);
+            if (it != plugins_.end()) {
+                all_tools.insert(all_tools.end(), it->second->tool_list.begin(), it->second->tool_list.end());
+            }
         }
         return all_tools;
     }
 
-    nlohmann::json PluginManager::call_tool(const std::string &name, const nlohmann::json &args) {
+    std::string PluginManager::streamed_argument(const std::string &name) const {
+        auto entry = find_tool(name);
+        if (!entry || !entry->plugin->streamed_argument) {
+            return {};
+        }
+        const char *argument = entry->plugin->streamed_argument(name.c_str());
+        return argument ? argument : "";
+    }
+
+    std::shared_ptr<PluginStrand> PluginManager::tool_strand(const std::string &name) {
+        auto entry = resolve_tool(name);
+        if (!entry || !entry->plugin->strand_for(entry->tool)) {
+            return nullptr;
+        }
+        return entry->plugin->strand;
+    }
+
+    ToolOutput PluginManager::invoke_tool(const std::string &name, const nlohmann::json &args) {
         MCP_INFO("Calling tool: '{}'", name);
-        for (const auto &[plugin_name, plugin]: plugins_) {
-            for (const auto &tool: plugin->tool_list) {
-                if (tool.name && std::string(tool.name) == name) {
-                    try {
-                        std::string args_json = args.dump();
-                        set_current_plugin(plugin.get());
-
-                        // Create MCPError object to receive plugin errors
-                        MCPError error = {0, nullptr, nullptr, nullptr};
-                        const char *result_json = plugin->call_tool(name.c_str(), args_json.c_str(), &error);
-                        set_current_plugin(nullptr);
-
-                        // Check if there is error information
-                        if (error.code != 0) {
-                            MCP_CRITICAL("Error calling tool: {}", error.message);
-                            return nlohmann::json{
-                                    {"error", {{"code", error.code},// Use the error code returned by the plugin
-                                               {"message", error.message ? error.message : "Unknown error"}}}};
-                        }
+        ToolOutput output;
+        auto entry = resolve_tool(name);
+        if (!entry) {
+            output.error_code = mcp::protocol::error_code::METHOD_NOT_FOUND;
+            output.error_message = "Tool not found: " + name;
+            return output;
+        }
+        if (!entry->plugin->loaded()) {
+            output.error_code = -mcp::protocol::error_code::INTERNAL_ERROR;
+            output.error_message = "Failed to load plugin for tool: " + name;
+            return output;
+        }
 
-                        if (!result_json) {
-                            return nlohmann::json{
-                                    {"error", {{"code", -mcp::protocol::error_code::INTERNAL_ERROR},// INTERNAL_ERROR
-                                               {"message", "Tool returned null result"}}}};
-                        }
+        // A request cancelled while it was queued is not started at all
+        const CancellationToken *cancel = CancellationToken::current();
+        if (cancel && cancel->cancelled()) {
+            output.error_code = mcp::protocol::error_code::REQUEST_CANCELLED;
+            output.error_message = "Request cancelled";
+            return output;
+        }
 
-                        // Parse the JSON returned by the plugin
-                        auto result = nlohmann::json::parse(result_json);
-                        plugin->free_result(result_json);
+        // entry holds a reference, so the library stays loaded until the call returns
+        Plugin *plugin = entry->plugin.get();
+        // The value of a streamed argument is only on the connection, a plugin that cannot read it must not run
+        transport::UploadStream *upload = transport::UploadStream::current();
+        if (upload && !plugin->call_tool_with_input) {
+            output.error_code = -mcp::protocol::error_code::INVALID_PARAMS;
+            output.error_message = "Tool does not take streamed input: " + name;
+            return output;
+        }
+        if (auto refusal = PluginUsage::instance().refusal(plugin->name)) {
+            output.error_code = mcp::protocol::error_code::RATE_LIMITED;
+            output.error_message = std::move(*refusal);
+            return output;
+        }
+        static auto &plugin_calls = metrics::MetricsManager::getInstance()->runtime_gauges().plugin_calls;
+        metrics::GaugeHold running(plugin_calls);
+        std::string args_json = args.dump();
+        if (plugin->host) {
+            output = plugin->host->call_tool(name, args_json);
+            if (output.error_code != 0) {
+                MCP_CRITICAL("Error calling tool: {}", output.error_message);
+            }
+            return output;
+        }
+        // Calls that could share a round trip wait a moment for each other. Calls of tools that are not
+        // reentrant arrive one at a time and would only wait
+        if (plugin->call_tools_batch && !upload && !plugin->strand_for(entry->tool) &&
+            ToolBatchOptions::current().window.count() > 0) {
+            return batcher_.submit(name, std::move(args_json), [&](const std::vector<BatchedCall *> &calls) {
+                PluginUsage::Meter meter(plugin->name, name);
+                run_batch(*plugin, name, calls);
+            });
+        }
 
-                        // If the JSON returned by the plugin contains an error field, return the error directly
-                        if (result.contains("error")) {
-                            // Use the error code and message returned by the plugin
-                            return nlohmann::json{
-                                    {"error", {{"code", result["error"].value("code", -mcp::protocol::error_code::INTERNAL_ERROR)}, {"message", result["error"].value("message", "Unknown error")}}}};
-                        }
+        const ProgressReporter *progress = ProgressReporter::current();
+        const metrics::SpanContext *span = metrics::SpanContext::current();
+        // The plugin's error strings are copied before another call on its thread can replace them
+        auto call = [&]() {
+            // A pinned plugin runs the call on its own thread, which needs the caller's trace context
+            metrics::SpanContext::Scope span_scope(span);
+            CallArena::Scope arena_scope;
+            PluginUsage::Meter meter(plugin->name, name);
+            set_current_plugin(plugin);
 
-                        // Return result on success
-                        return result;
-                    } catch (const std::exception &e) {
-                        MCP_ERROR("Error calling tool '{}': {}", name, e.what());
-                        return nlohmann::json{
-                                {"error", {{"code", -mcp::protocol::error_code::INTERNAL_ERROR},// INTERNAL_ERROR
-                                           {"message", e.what()}}}};
+            // Create MCPError object to receive plugin errors
+            MCPError error = {0, nullptr, nullptr, nullptr};
+            bool has_result = false;
+            // The arena stops a v2 plugin at the limit; a v1 result is already whole, it is only not copied
+            const size_t limit = result_limit();
+            bool exceeded = false;
+            if (upload || plugin->call_tool_with_progress || plugin->call_tool_cancellable || plugin->call_tool_v2) {
+                OutputArena arena{output.json, 0, limit};
+                MCPOutput sink = {&arena, 0, &OutputArena::write, &OutputArena::reserve, &OutputArena::commit};
+                // Calls that cannot be cancelled get a token that never is, calls nobody watches a progress that goes nowhere
+                static const MCPCancelToken never_cancelled = {nullptr, [](void *) { return false; }};
+                static const MCPProgress no_progress = {nullptr, [](void *, double, double, const char *) {}};
+                const MCPCancelToken *cancel_token = cancel ? cancel->plugin_token() : &never_cancelled;
+                MCPBuffer args_buffer = {args_json.data(), args_json.size()};
+                int status;
+                if (upload) {
+                    MCPInputStream input = {upload, [](void *context, char *buffer, size_t size) {
+                                                return static_cast<transport::UploadStream *>(context)->read(buffer, size);
+                                            }};
+                    status = plugin->call_tool_with_input(name.c_str(), args_buffer, &input, &sink, &error, cancel_token);
+                } else if (plugin->call_tool_with_progress) {
+                    status = plugin->call_tool_with_progress(name.c_str(), args_buffer, &sink, &error, cancel_token,
+                                                             progress ? progress->plugin_progress() : &no_progress);
+                } else if (plugin->call_tool_cancellable) {
+                    status = plugin->call_tool_cancellable(name.c_str(), args_buffer, &sink, &error, cancel_token);
+                } else {
+                    status = plugin->call_tool_v2(name.c_str(), args_buffer, &sink, &error);
+                }
+                arena.finish();
+                exceeded = arena.exceeded;
+                has_result = status == 0;
+                output.passthrough = (sink.flags & MCP_OUTPUT_PASSTHROUGH) != 0;
+                if (status != 0 && error.code == 0) {
+                    error.code = -mcp::protocol::error_code::INTERNAL_ERROR;
+                    error.message = "Tool failed without an error message";
+                }
+            } else {
+                // v1 shim: copy the plugin's string into the output and hand it back right away
+                const char *result_json = plugin->call_tool(name.c_str(), args_json.c_str(), &error);
+                if (result_json) {
+                    exceeded = limit > 0 && strnlen(result_json, limit + 1) > limit;
+                    if (!exceeded) {
+                        output.json.assign(result_json);
+                    }
+                    // Results in the call's arena go with it
+                    if (!CallArena::current()->owns(result_json)) {
+                        plugin->free_result(result_json);
                     }
+                    has_result = true;
                 }
             }
+            set_current_plugin(nullptr);
+            take_error(output, error, has_result);
+            if (exceeded) {
+                take_overflow(output, limit);
+            }
+        };
+        if (PluginStrand *strand = plugin->strand_for(entry->tool)) {
+            strand->run(call);
+        } else {
+            call();
+        }
+        return output;
+    }
+
+    nlohmann::json PluginManager::call_tool(const std::string &name, const nlohmann::json &args) {
+        try {
+            auto output = invoke_tool(name, args);
+            if (output.error_code != 0) {
+                return nlohmann::json{
+                        {"error", {{"code", output.error_code}, {"message", output.error_message}}}};
+            }
+
+            // Parse the JSON returned by the plugin
+            auto result = nlohmann::json::parse(output.json);
+
+            // If the JSON returned by the plugin contains an error field, return the error directly
+            if (result.contains("error")) {
+                // Use the error code and message returned by the plugin
+                return nlohmann::json{
+                        {"error", {{"code", result["error"].value("code", -mcp::protocol::error_code::INTERNAL_ERROR)}, {"message", result["error"].value("message", "Unknown error")}}}};
+            }
+
+            // Return result on success
+            return result;
+        } catch (const std::exception &e) {
+            MCP_ERROR("Error calling tool '{}': {}", name, e.what());
+            return nlohmann::json{
+                    {"error", {{"code", -mcp::protocol::error_code::INTERNAL_ERROR},// INTERNAL_ERROR
+                               {"message", e.what()}}}};
         }
-        return nlohmann::json{
-                {"error", {{"code", mcp::protocol::error_code::METHOD_NOT_FOUND},// METHOD_NOT_FOUND
-                           {"message", "Tool not found: " + name}}}};
     }
 
     std::optional<std::string> PluginManager::find_plugin_name_for_tool(const std::string &tool_name) const {
-        for (const auto &[plugin_name, plugin_ptr]: plugins_) {
-            for (const auto &tool_info: plugin_ptr->tool_list) {
-                if (tool_info.name && std::string(tool_info.name) == tool_name) {
-                    return plugin_name;// Return when found
+        auto entry = find_tool(tool_name);
+        if (entry) {
+            return entry->plugin->name;
+        }
+        return std::nullopt;// Not found
+    }
+
+    std::optional<PluginManager::ToolEntry> PluginManager::find_tool(const std::string &name) const {
+        // The snapshot is immutable; holding the shared_ptr keeps it alive across a concurrent rebuild
+        auto index = tool_index_.load(std::memory_order_acquire);
+        auto it = index->find(name);
+        if (it == index->end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    void PluginManager::rebuild_tool_index() {
+        auto index = std::make_shared<ToolIndex>();
+        // Walk plugins in load order so that the first plugin to register a name keeps it
+        for (const auto &plugin_name: load_order_) {
+            auto it = plugins_.find(plugin_name);
+            if (it == plugins_.end()) {
+                continue;
+            }
+            for (const auto &tool: it->second->tool_list) {
+                if (!tool.name) {
+                    continue;
+                }
+                auto [pos, inserted] = index->try_emplace(tool.name, ToolEntry{it->second, &tool});
+                if (!inserted) {
+                    MCP_WARN("Tool '{}' from plugin {} is shadowed by plugin {}", tool.name, plugin_name,
+                             pos->second.plugin->name);
                 }
             }
         }
-        return std::nullopt;// Not found
+        MCP_DEBUG("Tool index rebuilt with {} tools", index->size());
+        tool_index_.store(std::move(index), std::memory_order_release);
     }
 
     PluginManager::StreamFunctions PluginManager::get_stream_functions(StreamGenerator generator) const {
         std::lock_guard<std::mutex> lock(generator_mutex_);
         auto it = generator_to_plugin_.find(generator);
         if (it != generator_to_plugin_.end()) {
-            Plugin *plugin = it->second;
-            StreamGeneratorNext next_func = plugin->get_stream_next ? plugin->get_stream_next() : nullptr;
-            StreamGeneratorFree free_func = plugin->get_stream_free ? plugin->get_stream_free() : nullptr;
-            return {next_func, free_func, {0, nullptr, nullptr, nullptr}};
+            if (auto plugin = it->second.lock()) {
+                StreamGeneratorNext next_func = plugin->get_stream_next ? plugin->get_stream_next() : nullptr;
+                StreamGeneratorFree free_func = plugin->get_stream_free ? plugin->get_stream_free() : nullptr;
+                StreamGeneratorWait wait_func = plugin->get_stream_wait ? plugin->get_stream_wait() : nullptr;
+                StreamGeneratorCancel cancel_func = plugin->get_stream_cancel ? plugin->get_stream_cancel() : nullptr;
+                StreamGeneratorCheckpoint checkpoint_func = plugin->get_stream_checkpoint ? plugin->get_stream_checkpoint() : nullptr;
+                std::string plugin_name = plugin->name;
+                return {next_func, free_func, {0, nullptr, nullptr, nullptr}, std::move(plugin), wait_func, cancel_func, checkpoint_func,
+                        std::move(plugin_name)};
+            }
         }
         // Return error if plugin not found
         MCPError error = {
@@ -253,7 +945,7 @@ namespace mcp::business {
                 "Plugin not found for generator",
                 nullptr,
                 "PluginManager::get_stream_functions"};
-        return {nullptr, nullptr, error};
+        return {nullptr, nullptr, error, nullptr};
     }
 
     StreamGenerator PluginManager::start_streaming_tool(const std::string &name, const nlohmann::json &args, MCPError *out_error) {
@@ -263,44 +955,77 @@ namespace mcp::business {
             out_error->message = nullptr;
         }
 
-        for (const auto &[plugin_name, plugin]: plugins_) {
-            for (const auto &tool: plugin->tool_list) {
-                if (tool.name && std::string(tool.name) == name && tool.is_streaming) {
-                    try {
-                        std::string args_json = args.dump();
-                        MCPError error = {0, nullptr, nullptr, nullptr};
-                        const char *raw_result = plugin->call_tool(name.c_str(), args_json.c_str(), &error);
-
-                        // Check plugin returned error
-                        if (error.code != 0) {
-                            if (out_error) {
-                                *out_error = error;
-                            }
-                            return nullptr;
-                        }
+        auto entry = resolve_tool(name);
+        if (entry && entry->tool->is_streaming && !entry->plugin->loaded()) {
+            if (out_error) {
+                out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
+                out_error->message = "Failed to load plugin for streaming tool";
+            }
+            return nullptr;
+        }
+        if (entry && entry->tool->is_streaming && !entry->plugin->call_tool && !entry->plugin->host) {
+            // ABI v2 plugins may leave out call_tool, which is still what starts a stream
+            if (out_error) {
+                out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
+                out_error->message = "Plugin does not export call_tool for streaming tool";
+            }
+            return nullptr;
+        }
+        if (entry && entry->tool->is_streaming && PluginUsage::instance().refusal(entry->plugin->name)) {
+            if (out_error) {
+                out_error->code = mcp::protocol::error_code::RATE_LIMITED;
+                out_error->message = "Plugin exceeded its resource quota, try again later";
+            }
+            return nullptr;
+        }
+        if (entry && entry->tool->is_streaming) {
+            Plugin *plugin = entry->plugin.get();
+            try {
+                std::string args_json = args.dump();
+                MCPError error = {0, nullptr, nullptr, nullptr};
+                const char *raw_result;
+                auto start = [&]() {
+                    PluginUsage::Meter meter(plugin->name, name);
+                    return plugin->call_tool(name.c_str(), args_json.c_str(), &error);
+                };
+                if (plugin->host) {
+                    raw_result = static_cast<const char *>(plugin->host->start_stream(name, args_json, &error));
+                } else if (PluginStrand *strand = plugin->strand_for(entry->tool)) {
+                    raw_result = strand->run(start);
+                } else {
+                    raw_result = start();
+                }
 
-                        if (!raw_result) {
-                            if (out_error) {
-                                out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
-                                out_error->message = "Plugin returned null for streaming tool";
-                            }
-                            return nullptr;
-                        }
+                // Check plugin returned error
+                if (error.code != 0) {
+                    if (out_error) {
+                        *out_error = error;
+                    }
+                    return nullptr;
+                }
 
-                        StreamGenerator generator = reinterpret_cast<StreamGenerator>(const_cast<char *>(raw_result));
-                        {
-                            std::lock_guard<std::mutex> lock(generator_mutex_);
-                            generator_to_plugin_[generator] = plugin.get();
-                        }
-                        return generator;
-                    } catch (const std::exception &e) {
-                        if (out_error) {
-                            out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
-                            out_error->message = e.what();
-                        }
-                        return nullptr;
+                if (!raw_result) {
+                    if (out_error) {
+                        out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
+                        out_error->message = "Plugin returned null for streaming tool";
                     }
+                    return nullptr;
+                }
+
+                StreamGenerator generator = reinterpret_cast<StreamGenerator>(const_cast<char *>(raw_result));
+                {
+                    std::lock_guard<std::mutex> lock(generator_mutex_);
+                    // Drop generators whose plugin has been released
+                    std::erase_if(generator_to_plugin_, [](const auto &item) { return item.second.expired(); });
+                    generator_to_plugin_[generator] = entry->plugin;
                 }
+                return generator;
+            } catch (const std::exception &e) {
+                if (out_error) {
+                    out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
+                    out_error->message = e.what();
+                }
+                return nullptr;
             }
         }
 
@@ -311,6 +1036,51 @@ namespace mcp::business {
         return nullptr;
     }
 
+    StreamGenerator PluginManager::restore_streaming_tool(const std::string &name, const nlohmann::json &args,
+                                                          std::string_view checkpoint, MCPError *out_error) {
+        if (out_error) {
+            out_error->code = 0;
+            out_error->message = nullptr;
+        }
+
+        auto entry = resolve_tool(name);
+        if (!entry || !entry->tool->is_streaming || !entry->plugin->stream_restore) {
+            if (out_error) {
+                out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
+                out_error->message = "Plugin cannot restore streams";
+            }
+            return nullptr;
+        }
+
+        try {
+            std::string args_json = args.dump();
+            MCPError error = {0, nullptr, nullptr, nullptr};
+            auto restore = [&]() {
+                PluginUsage::Meter meter(entry->plugin->name, name);
+                return entry->plugin->stream_restore(name.c_str(), args_json.c_str(), checkpoint.data(), checkpoint.size(), &error);
+            };
+            PluginStrand *strand = entry->plugin->strand_for(entry->tool);
+            StreamGenerator generator = strand ? strand->run(restore) : restore();
+            if (!generator || error.code != 0) {
+                if (out_error) {
+                    *out_error = error;
+                }
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(generator_mutex_);
+            std::erase_if(generator_to_plugin_, [](const auto &item) { return item.second.expired(); });
+            generator_to_plugin_[generator] = entry->plugin;
+            return generator;
+        } catch (const std::exception &e) {
+            if (out_error) {
+                out_error->code = -mcp::protocol::error_code::INTERNAL_ERROR;// INTERNAL_ERROR
+                out_error->message = e.what();
+            }
+            return nullptr;
+        }
+    }
+
     bool PluginManager::start_directory_monitoring(const std::string &directory) {
         if (monitoring_active_) {
             MCP_WARN("Directory monitoring is already active");
@@ -339,86 +1109,108 @@ namespace mcp::business {
             return false;
         }
 
+        // Called on the housekeeping thread once the directory changed and stayed quiet for the debounce period
+        watcher_ = std::make_unique<DirectoryWatcher>(dir_path, core::Housekeeping::instance().executor(),
+                                                      kReloadDebounce, [this]() { sync_plugin_directory(); });
         monitoring_active_ = true;
-        monitoring_thread_ = std::thread([this]() {
-            while (monitoring_active_) {
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                std::lock_guard<std::mutex> lock(monitoring_mutex_);
-
-                try {
-                    // Get all files in the directory
-                    std::unordered_map<std::string, std::filesystem::file_time_type> current_files;
-                    for (const auto &entry: std::filesystem::directory_iterator(monitored_directory_)) {
-                        if (entry.is_regular_file() && is_plugin_file(entry.path())) {
-                            std::string path_str = entry.path().string();
-                            current_files[path_str] = std::filesystem::last_write_time(entry.path());
-                        }
-                    }
 
-                    // handle the case where a plugin was deleted
-                    for (auto it = plugin_file_times_.begin(); it != plugin_file_times_.end();) {
-                        const std::string &path = it->first;
-                        if (!current_files.count(path)) {
-                            std::string plugin_name = std::filesystem::path(path).filename().string();
-                            MCP_INFO("Detected removed plugin: {}", plugin_name);
-                            unload_plugin(plugin_name);
-                            it = plugin_file_times_.erase(it);
-                        } else {
-                            ++it;
-                        }
-                    }
+        MCP_INFO("Started directory monitoring for: {}", directory);
+        return true;
+    }
+    void PluginManager::set_reload_listener(ReloadListener listener) {
+        std::lock_guard<std::mutex> lock(monitoring_mutex_);
+        reload_listener_ = std::move(listener);
+    }
 
-                    // handle update plugins and remove plugins
-                    for (const auto &[path, current_time]: current_files) {
-                        auto it = plugin_file_times_.find(path);
-                        if (it == plugin_file_times_.end()) {
-                            // new plugin
-                            MCP_INFO("Detected new plugin: {}", path);
-                            if (load_plugin(path)) {
-                                plugin_file_times_[path] = current_time;
-                                // print the plugin's tools
-                                auto new_tools = get_tools_from_plugin(path);
-                                MCP_INFO("New tools added from plugin (total: {}):", new_tools.size());
-                                for (const auto &tool: new_tools) {
-                                    if (tool.name) {
-                                        MCP_INFO("  - '{}'", tool.name);
-                                    }
-                                }
+    void PluginManager::sync_plugin_directory() {
+        std::lock_guard<std::mutex> lock(monitoring_mutex_);
+        // Tools of the plugins that changed, handed to the reload listener together
+        std::vector<std::string> removed_tools;
+        std::vector<ToolInfo> added_tools;
+        auto forget_tools = [&](const std::string &path) {
+            for (const auto &tool: get_tools_from_plugin(path)) {
+                if (tool.name) {
+                    removed_tools.emplace_back(tool.name);
+                }
+            }
+        };
+        try {
+            // Get all files in the directory
+            std::unordered_map<std::string, std::filesystem::file_time_type> current_files;
+            for (const auto &entry: std::filesystem::directory_iterator(monitored_directory_)) {
+                if (entry.is_regular_file() && is_plugin_file(entry.path())) {
+                    std::string path_str = entry.path().string();
+                    current_files[path_str] = std::filesystem::last_write_time(entry.path());
+                }
+            }
+
+            // handle the case where a plugin was deleted
+            for (auto it = plugin_file_times_.begin(); it != plugin_file_times_.end();) {
+                const std::string &path = it->first;
+                if (!current_files.count(path)) {
+                    std::string plugin_name = std::filesystem::path(path).filename().string();
+                    MCP_INFO("Detected removed plugin: {}", plugin_name);
+                    forget_tools(path);
+                    unload_plugin(plugin_name);
+                    it = plugin_file_times_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            // handle update plugins and remove plugins
+            for (const auto &[path, current_time]: current_files) {
+                auto it = plugin_file_times_.find(path);
+                if (it == plugin_file_times_.end()) {
+                    // new plugin
+                    MCP_INFO("Detected new plugin: {}", path);
+                    if (load_plugin(path)) {
+                        plugin_file_times_[path] = current_time;
+                        // print the plugin's tools
+                        auto new_tools = get_tools_from_plugin(path);
+                        MCP_INFO("New tools added from plugin (total: {}):", new_tools.size());
+                        for (const auto &tool: new_tools) {
+                            if (tool.name) {
+                                MCP_INFO("  - '{}'", tool.name);
                             }
-                        } else if (current_time != it->second) {
-                            // update plugin
-                            MCP_INFO("Detected modified plugin: {}", path);
-                            std::string plugin_name = std::filesystem::path(path).filename().string();
-                            unload_plugin(plugin_name);
-                            if (load_plugin(path)) {
-                                it->second = current_time;
-                                auto updated_tools = get_tools_from_plugin(path);
-                                MCP_INFO("Updated tools in plugin (total: {}):", updated_tools.size());
-                                for (const auto &tool: updated_tools) {
-                                    if (tool.name) {
-                                        MCP_INFO("  - '{}'", tool.name);
-                                    }
-                                }
+                        }
+                        added_tools.insert(added_tools.end(), new_tools.begin(), new_tools.end());
+                    }
+                } else if (current_time != it->second) {
+                    // update plugin
+                    MCP_INFO("Detected modified plugin: {}", path);
+                    std::string plugin_name = std::filesystem::path(path).filename().string();
+                    forget_tools(path);
+                    unload_plugin(plugin_name);
+                    if (load_plugin(path)) {
+                        it->second = current_time;
+                        auto updated_tools = get_tools_from_plugin(path);
+                        MCP_INFO("Updated tools in plugin (total: {}):", updated_tools.size());
+                        for (const auto &tool: updated_tools) {
+                            if (tool.name) {
+                                MCP_INFO("  - '{}'", tool.name);
                             }
                         }
+                        added_tools.insert(added_tools.end(), updated_tools.begin(), updated_tools.end());
                     }
-                } catch (const std::filesystem::filesystem_error &e) {
-                    MCP_ERROR("Filesystem error during monitoring: {}", e.what());
-                } catch (const std::exception &e) {
-                    MCP_ERROR("Unexpected error during monitoring: {}", e.what());
                 }
             }
-        });
+        } catch (const std::filesystem::filesystem_error &e) {
+            MCP_ERROR("Filesystem error during monitoring: {}", e.what());
+        } catch (const std::exception &e) {
+            MCP_ERROR("Unexpected error during monitoring: {}", e.what());
+        }
 
-        MCP_INFO("Started directory monitoring for: {}", directory);
-        return true;
+        if (reload_listener_ && (!removed_tools.empty() || !added_tools.empty())) {
+            reload_listener_(removed_tools, added_tools);
+        }
     }
+
     void PluginManager::stop_directory_monitoring() {
         if (monitoring_active_) {
             monitoring_active_ = false;
-            if (monitoring_thread_.joinable()) {
-                monitoring_thread_.join();
-            }
+            watcher_->stop();
+            watcher_.reset();
             MCP_INFO("Stopped directory monitoring for: {}", monitored_directory_);
             monitored_directory_.clear();
             plugin_file_times_.clear();
@@ -426,23 +1218,19 @@ namespace mcp::business {
     }
 
     void PluginManager::unload_plugin(const std::string &plugin_name) {
+        std::unique_lock<std::mutex> lock(plugins_mutex_);
         auto it = plugins_.find(plugin_name);
         if (it == plugins_.end()) {
             MCP_WARN("Plugin not found for unloading: {}", plugin_name);
             return;
         }
 
-        lib_handle handle = it->second->handle;
+        std::shared_ptr<Plugin> plugin = it->second;
 
-        if (it->second->uninitialize_plugin) {
-            MCP_DEBUG("Uninitializing plugin: {}", plugin_name);
-            it->second->uninitialize_plugin(plugin_name.c_str());
-        }
-
-        if (handle) {
-            CLOSE_LIB(handle);
-            MCP_DEBUG("Closed library handle for plugin: {}", plugin_name);
-        }
+        // Unpublish the tools first so no new call is routed to this version
+        auto index = std::make_shared<ToolIndex>(*tool_index_.load(std::memory_order_acquire));
+        std::erase_if(*index, [&plugin](const auto &item) { return item.second.plugin == plugin; });
+        tool_index_.store(std::move(index), std::memory_order_release);
 
         plugins_.erase(it);
         MCP_DEBUG("Removed plugin from registry: {}", plugin_name);
@@ -451,15 +1239,21 @@ namespace mcp::business {
         if (load_it != load_order_.end()) {
             load_order_.erase(load_it);
         }
+        // Tools shadowed by the removed plugin become visible again
+        rebuild_tool_index();
 
-        std::lock_guard<std::mutex> lock(generator_mutex_);
-        for (auto gen_it = generator_to_plugin_.begin(); gen_it != generator_to_plugin_.end();) {
-            if (gen_it->second->handle == handle) {
-                gen_it = generator_to_plugin_.erase(gen_it);
-            } else {
-                ++gen_it;
-            }
+        // The library is uninitialized and closed by ~Plugin when the last in-flight call,
+        // index snapshot or stream generator lets go of it
+        plugin->unloading = true;
+        if (plugin->loaded()) {
+            draining_plugins_[plugin_name] = plugin;
+        }
+        if (plugin.use_count() > 1) {
+            MCP_INFO("Plugin {} still in use ({} references), closing it once they finish", plugin_name,
+                     plugin.use_count() - 1);
         }
+        lock.unlock();
+        plugin.reset();
 
         MCP_INFO("Successfully unloaded plugin: {}", plugin_name);
     }
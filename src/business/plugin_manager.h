@@ -4,14 +4,23 @@
 #define _WIN32_WINNT 0x0601
 #endif
 
+#include "directory_watcher.h"
 #include "mcp_plugin.h"
+#include "plugin_host.h"
+#include "host_services.h"
+#include "plugin_strand.h"
+#include "tool_batcher.h"
+#include "tool_output.h"
 #include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <string>
-#include <thread>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -32,10 +41,12 @@ using lib_handle = void *;
 
 namespace mcp::business {
 
+    struct PluginManifestEntry;
+
     class PluginManager {
     public:
         struct Plugin {
-            lib_handle handle;
+            lib_handle handle = nullptr;///< nullptr for a stub whose tools come from the manifest
             get_tools_func get_tools;
             call_tool_func call_tool;
             free_result_func free_result;
@@ -44,6 +55,49 @@ namespace mcp::business {
             std::vector<ToolInfo> tool_list;
             get_stream_next_func get_stream_next;
             get_stream_free_func get_stream_free;
+            get_stream_wait_func get_stream_wait = nullptr;     ///< Set if the plugin's generators can return MCP_STREAM_WOULD_BLOCK
+            call_tool_v2_func call_tool_v2 = nullptr;           ///< Set for ABI v2 plugins, preferred over call_tool
+            call_tool_cancellable_func call_tool_cancellable = nullptr;///< Optional with ABI v2, preferred over call_tool_v2
+            call_tool_with_progress_func call_tool_with_progress = nullptr;///< Optional with ABI v2, preferred over call_tool_cancellable
+            call_tool_with_input_func call_tool_with_input = nullptr;      ///< Optional with ABI v2, used for calls with a streamed argument
+            streamed_argument_func streamed_argument = nullptr;            ///< Set with call_tool_with_input, names the argument a tool streams
+            call_tools_batch_func call_tools_batch = nullptr;              ///< Optional with ABI v2, runs calls collected by the ToolBatcher
+            get_stream_cancel_func get_stream_cancel = nullptr;        ///< Set if the plugin's generators can be cancelled
+            get_stream_checkpoint_func get_stream_checkpoint = nullptr;///< Set with stream_restore if streams can be resumed from a checkpoint
+            stream_restore_func stream_restore = nullptr;              ///< Restarts a stream from a checkpoint
+            server_started_func server_started = nullptr;              ///< Optional, told once the server listens
+            std::string name;                                   ///< File name, the key in plugins_
+            std::filesystem::path shadow_path;                  ///< Private copy of the library, empty when loaded in place
+            bool unloading = false;                             ///< Set by unload_plugin(), uninitializes the plugin on release
+            std::filesystem::path path;                         ///< Absolute path of the plugin file
+            std::shared_ptr<const PluginManifestEntry> manifest;///< Set when the tools are listed in the manifest
+            std::atomic<int64_t> last_used{0};                  ///< steady_clock ticks of the last call, drives idle unloading
+            std::shared_ptr<PluginHost> host;                   ///< Set when the library runs in a child process instead of being mapped
+            std::vector<int> tool_thread_safety;                ///< MCP_THREAD_SAFETY_* of each tool in tool_list, empty if all are reentrant
+            std::shared_ptr<PluginStrand> strand;               ///< Runs the tools that are not reentrant, nullptr if there are none
+            std::unique_ptr<HostServices> host_services;        ///< Set if the plugin exports mcp_plugin_set_host_services
+
+            /**
+             * @brief Whether the library is mapped or hosted. Stubs only carry the manifest's tool list.
+             */
+            bool loaded() const { return handle != nullptr || host != nullptr; }
+
+            /**
+             * @brief Strand the calls of a tool must run on, nullptr if the tool is reentrant.
+             * @param tool Entry in tool_list
+             */
+            PluginStrand *strand_for(const ToolInfo *tool) const;
+
+            Plugin() = default;
+            Plugin(const Plugin &) = delete;
+            Plugin &operator=(const Plugin &) = delete;
+
+            /**
+             * @brief Close the library once the last reference is gone.
+             * Index snapshots, calls in progress and live stream generators all hold a reference,
+             * so an unloaded plugin stays mapped until they have drained.
+             */
+            ~Plugin();
         };
 
         ~PluginManager();
@@ -51,16 +105,69 @@ namespace mcp::business {
         bool load_plugin(const std::string &path);
         void load_plugins_from_directory(const std::string &directory);
 
+        /**
+         * @brief Load several plugins in parallel.
+         * dlopen, initialize_plugin and get_tools run on worker threads; the plugins are then
+         * installed in the order given and the tool index is rebuilt once.
+         * @param paths Plugin files
+         * @return Number of plugins loaded
+         */
+        size_t load_plugins(const std::vector<std::string> &paths);
+
+        /**
+         * @brief List the plugin files of a directory, sorted by path.
+         * @param directory Directory to scan, empty for the current directory
+         * @return Plugin file paths
+         */
+        std::vector<std::string> find_plugin_files(const std::string &directory) const;
+
         // Real-time plugin directory monitoring functionality
         bool start_directory_monitoring(const std::string &directory);
         void stop_directory_monitoring();
 
+        // Called on the monitoring thread after each hot reload with the tool names the changed plugins
+        // had and the tools they have now, so the registry can swap them in one version
+        using ReloadListener = std::function<void(const std::vector<std::string> &removed, const std::vector<ToolInfo> &added)>;
+        void set_reload_listener(ReloadListener listener);
+
         // get tools from a specific plugin
         std::vector<ToolInfo> get_tools_from_plugin(const std::string &plugin_path) const;
 
-        // get all tools from all plugins(for debugging)
+        // get all tools from all plugins in load order
         std::vector<ToolInfo> get_all_tools() const;
 
+        /**
+         * @brief Call a synchronous tool and collect its raw output.
+         * ABI v2 plugins write into a server-owned arena; older plugins go through a shim
+         * around call_tool and free_result that produces the same output. A plugin exporting
+         * call_tool_cancellable gets the CancellationToken::current() of the calling thread,
+         * call_tool_with_progress also the ProgressReporter::current(). A call with an
+         * UploadStream::current() goes to call_tool_with_input. Calls of a plugin exporting
+         * call_tools_batch are batched with concurrent calls of the same tool while
+         * ToolBatchOptions has a window.
+         * @param name Tool name
+         * @param args Tool arguments
+         * @return Output, or an error code and message
+         */
+        ToolOutput invoke_tool(const std::string &name, const nlohmann::json &args);
+
+        /**
+         * @brief Name of the string argument a tool takes as a stream, see mcp_plugin_streamed_argument.
+         * Never loads a plugin: tools of stubs stream nothing until their first call loaded them.
+         * @param name Tool name
+         * @return Argument name, empty if the tool takes none
+         */
+        std::string streamed_argument(const std::string &name) const;
+
+        /**
+         * @brief Strand of a tool that is not reentrant, see mcp_plugin_thread_safety.
+         * Loads the tool's plugin if it is still a stub. Calls co_spawned onto its executor wait
+         * for their turn without holding a thread; invoke_tool() keeps to the strand either way.
+         * @param name Tool name
+         * @return Strand, nullptr if the tool is reentrant or unknown
+         */
+        std::shared_ptr<PluginStrand> tool_strand(const std::string &name);
+
         // call a tool by name with JSON arguments
         nlohmann::json call_tool(const std::string &name, const nlohmann::json &args);
 
@@ -68,31 +175,175 @@ namespace mcp::business {
 
         StreamGenerator start_streaming_tool(const std::string &name, const nlohmann::json &args, MCPError *out_error = nullptr);
 
+        /**
+         * @brief Start a streaming tool again from a checkpoint its generator wrote, see stream_restore.
+         * @param name Tool name
+         * @param args Tool arguments, the same as for the call that wrote the checkpoint
+         * @param checkpoint Checkpoint
+         * @param out_error Receives the plugin's error
+         * @return Generator, nullptr if the plugin cannot restore streams or failed to
+         */
+        StreamGenerator restore_streaming_tool(const std::string &name, const nlohmann::json &args,
+                                               std::string_view checkpoint, MCPError *out_error = nullptr);
+
         struct StreamFunctions {
             StreamGeneratorNext next = nullptr;
             StreamGeneratorFree free = nullptr;
             MCPError error = {0, nullptr, nullptr, nullptr};
+            std::shared_ptr<const void> owner; ///< Keeps the plugin loaded, hold it as long as the generator is used
+            StreamGeneratorWait wait = nullptr;///< nullptr if the generator always blocks in next
+            StreamGeneratorCancel cancel = nullptr;///< nullptr if the generator cannot be cancelled
+            StreamGeneratorCheckpoint checkpoint = nullptr;///< nullptr if the stream cannot be resumed from a checkpoint
+            std::string plugin{};                          ///< File name of the plugin, for its usage accounting
         };
 
         StreamFunctions get_stream_functions(StreamGenerator generator) const;
         void unload_plugin(const std::string &plugin_name);
         void set_current_plugin(Plugin *plugin) { current_plugin_ = plugin; }
 
+        /**
+         * @brief Defer loading of plugins listed in their directory's manifest until a tool is called.
+         * Must be called before plugins are loaded.
+         * @param enabled Publish manifest-listed plugins as stubs instead of loading them
+         * @param idle_timeout Unload a lazily loaded plugin again after this long without calls, 0 to keep it
+         */
+        void set_lazy_loading(bool enabled, std::chrono::seconds idle_timeout);
+
+        /**
+         * @brief Run some plugins in a child process each instead of loading them into the server.
+         * Must be called before plugins are loaded.
+         * @param plugins File names or stems of the plugins to isolate, "*" for all of them
+         * @param options Child process settings, see PluginHost::Options
+         */
+        void set_isolation(std::vector<std::string> plugins, PluginHost::Options options);
+
+        /**
+         * @brief Tell the loaded plugins that the server accepts connections; plugins loaded
+         *        afterwards are told right after loading.
+         */
+        void notify_server_started();
+
 
     private:
+        /**
+         * @brief Index entry resolving a tool name to the plugin that provides it.
+         */
+        struct ToolEntry {
+            std::shared_ptr<Plugin> plugin;///< Owning plugin, pinned while the entry is held
+            const ToolInfo *tool = nullptr;///< Entry in plugin->tool_list
+        };
+        using ToolIndex = std::unordered_map<std::string, ToolEntry>;
+
+        /**
+         * @brief Rebuild the tool index from plugins_ and publish it. The caller holds plugins_mutex_.
+         * Called after every load and unload; readers keep the snapshot they already hold.
+         */
+        void rebuild_tool_index();
+
+        /**
+         * @brief Check a plugin file and pick a shadow copy if an older version is still draining.
+         * @param plugin_path Absolute plugin path
+         * @param shadow_path Set to the copy to load, left empty to load in place
+         * @return false if the plugin cannot be loaded
+         */
+        bool prepare_load(const std::filesystem::path &plugin_path, std::filesystem::path &shadow_path);
+
+        /**
+         * @brief Open and initialize a plugin without publishing it. Safe to run concurrently.
+         * @param plugin_path Absolute plugin path
+         * @param shadow_path Copy to load instead of plugin_path, or empty
+         * @return Plugin, or nullptr on failure
+         */
+        std::shared_ptr<Plugin> open_plugin(const std::filesystem::path &plugin_path, std::filesystem::path shadow_path) const;
+
+        /**
+         * @brief Start a plugin in a PluginHost child instead of loading it, see set_isolation().
+         * @param plugin_path Absolute plugin path
+         * @return Plugin, or nullptr on failure
+         */
+        std::shared_ptr<Plugin> open_hosted_plugin(const std::filesystem::path &plugin_path) const;
+
+        bool is_isolated(const std::filesystem::path &plugin_path) const;
+
+        /**
+         * @brief Add an opened plugin to plugins_ and load_order_.
+         * The caller holds plugins_mutex_ and rebuilds the tool index.
+         * @param plugin Opened plugin
+         */
+        void install_plugin(std::shared_ptr<Plugin> plugin);
+
+        /**
+         * @brief Create an unloaded placeholder that publishes the tools of a manifest entry.
+         * @param plugin_path Absolute plugin path
+         * @param manifest Entry describing the plugin
+         * @return Stub plugin
+         */
+        static std::shared_ptr<Plugin> make_stub(const std::filesystem::path &plugin_path,
+                                                 std::shared_ptr<const PluginManifestEntry> manifest);
+
+        /**
+         * @brief Look up a tool and load its plugin if it is still a stub.
+         * @param name Tool name
+         * @return Index entry, or std::nullopt if no plugin provides the tool.
+         *         The plugin is still a stub if loading failed.
+         */
+        std::optional<ToolEntry> resolve_tool(const std::string &name);
+
+        /**
+         * @brief Replace a stub with the loaded plugin.
+         * @param stub Stub taken from the tool index
+         * @return true if the plugin is loaded now (by this call or a concurrent one)
+         */
+        bool ensure_loaded(const std::shared_ptr<Plugin> &stub);
+
+        /**
+         * @brief Turn lazily loaded plugins that have been idle for idle_timeout_ back into stubs.
+         * Plugins with a call or stream in progress are left alone.
+         */
+        void unload_idle_plugins();
+
+        /**
+         * @brief Look up a tool in the current index snapshot without locking.
+         * @param name Tool name
+         * @return Index entry, or std::nullopt if no loaded plugin provides the tool
+         */
+        std::optional<ToolEntry> find_tool(const std::string &name) const;
+
         bool is_plugin_file(const std::filesystem::path &path) const;
-        std::unordered_map<std::string, std::unique_ptr<Plugin>> plugins_;// name -> Plugin mapping
+
+        /**
+         * @brief Rescan the monitored directory and load, reload or unload plugins that changed.
+         */
+        void sync_plugin_directory();
+        mutable std::mutex plugins_mutex_;                                 ///< Guards plugins_, load_order_ and draining_plugins_
+        std::unordered_map<std::string, std::shared_ptr<Plugin>> plugins_;// name -> Plugin mapping
         std::vector<std::string> load_order_;                             // to keep track of load order
         Plugin *current_plugin_ = nullptr;
+        std::atomic<bool> server_started_{false};
         mutable std::mutex generator_mutex_;// thread safety
-        std::unordered_map<StreamGenerator, Plugin *> generator_to_plugin_;
+        std::unordered_map<StreamGenerator, std::weak_ptr<Plugin>> generator_to_plugin_;
+        std::unordered_map<std::string, std::weak_ptr<Plugin>> draining_plugins_;///< Unloaded versions that may still be in use
+        uint64_t shadow_counter_ = 0;                                               ///< Suffix for shadow copies
+        ToolBatcher batcher_;
+        std::atomic<std::shared_ptr<const ToolIndex>> tool_index_{std::make_shared<const ToolIndex>()};///< tool name -> plugin, replaced as a whole
+
+        // Lazy loading related member variables
+        bool lazy_loading_ = false;
+        std::chrono::seconds idle_timeout_{0};
+        std::mutex lazy_mutex_;///< Serializes first-call loads so a plugin is opened once
+        uint64_t idle_task_ = 0;///< Housekeeping task unloading idle plugins
+
+        // Isolation related member variables
+        std::vector<std::string> isolated_plugins_;///< Names from set_isolation(), "*" for all
+        PluginHost::Options host_options_;
 
         // Real-time monitoring related member variables
         std::atomic<bool> monitoring_active_{false};
-        std::thread monitoring_thread_;
+        std::unique_ptr<DirectoryWatcher> watcher_;
         std::string monitored_directory_;
         std::unordered_map<std::string, std::filesystem::file_time_type> plugin_file_times_;
         std::mutex monitoring_mutex_;
+        ReloadListener reload_listener_;// Guarded by monitoring_mutex_
     };
 
 }// namespace mcp::business
\ No newline at end of file
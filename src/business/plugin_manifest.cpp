@@ -0,0 +1,118 @@
+// src/business/plugin_manifest.cpp
+#include "plugin_manifest.h"
+#include "core/logger.h"
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr int kManifestFormat = 1;///< Bumped when the layout changes; other versions are ignored
+    }
+
+    void PluginManifestEntry::bind() {
+        tool_infos.clear();
+        tool_infos.reserve(tools.size());
+        for (const auto &tool: tools) {
+            tool_infos.push_back({tool.name.c_str(), tool.description.c_str(), tool.parameters.c_str(), tool.is_streaming});
+        }
+    }
+
+    std::string PluginManifest::hash_file(const std::filesystem::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return {};
+        }
+        uint64_t hash = 14695981039346656037ull;
+        char buffer[64 * 1024];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            for (std::streamsize i = 0; i < in.gcount(); ++i) {
+                hash ^= static_cast<unsigned char>(buffer[i]);
+                hash *= 1099511628211ull;
+            }
+        }
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+        return hex;
+    }
+
+    std::optional<PluginManifest> PluginManifest::load(const std::filesystem::path &directory) {
+        std::filesystem::path manifest_path = directory / kFileName;
+        std::ifstream in(manifest_path);
+        if (!in) {
+            return std::nullopt;
+        }
+        try {
+            auto json = nlohmann::json::parse(in);
+            if (json.value("format", 0) != kManifestFormat) {
+                MCP_WARN("Ignoring plugin manifest with unsupported format: {}", manifest_path.string());
+                return std::nullopt;
+            }
+            PluginManifest manifest;
+            for (const auto &item: json.at("plugins")) {
+                auto entry = std::make_shared<PluginManifestEntry>();
+                entry->file = item.at("file").get<std::string>();
+                entry->size = item.at("size").get<std::uintmax_t>();
+                entry->hash = item.at("hash").get<std::string>();
+                for (const auto &tool: item.at("tools")) {
+                    entry->tools.push_back({tool.at("name").get<std::string>(),
+                                            tool.value("description", ""),
+                                            tool.value("parameters", ""),
+                                            tool.value("is_streaming", false)});
+                }
+                entry->bind();
+                manifest.entries_[entry->file] = std::move(entry);
+            }
+            return manifest;
+        } catch (const std::exception &e) {
+            MCP_WARN("Ignoring invalid plugin manifest {}: {}", manifest_path.string(), e.what());
+            return std::nullopt;
+        }
+    }
+
+    bool PluginManifest::save(const std::filesystem::path &directory, const std::vector<PluginManifestEntry> &entries) {
+        nlohmann::json plugins = nlohmann::json::array();
+        for (const auto &entry: entries) {
+            nlohmann::json tools = nlohmann::json::array();
+            for (const auto &tool: entry.tools) {
+                tools.push_back({{"name", tool.name},
+                                 {"description", tool.description},
+                                 {"parameters", tool.parameters},
+                                 {"is_streaming", tool.is_streaming}});
+            }
+            plugins.push_back({{"file", entry.file}, {"size", entry.size}, {"hash", entry.hash}, {"tools", std::move(tools)}});
+        }
+
+        // Write a temporary file and rename it so a starting server never reads half a manifest
+        std::filesystem::path target = directory / kFileName;
+        std::filesystem::path temp = target;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            out << nlohmann::json{{"format", kManifestFormat}, {"plugins", std::move(plugins)}}.dump(2) << '\n';
+            if (!out) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, target, ec);
+        return !ec;
+    }
+
+    std::shared_ptr<const PluginManifestEntry> PluginManifest::find_current(const std::filesystem::path &plugin_path) const {
+        auto it = entries_.find(plugin_path.filename().string());
+        if (it == entries_.end()) {
+            return nullptr;
+        }
+        // The size check is free and catches most rebuilds before the file is read
+        std::error_code ec;
+        auto size = std::filesystem::file_size(plugin_path, ec);
+        if (ec || size != it->second->size || hash_file(plugin_path) != it->second->hash) {
+            MCP_INFO("Plugin {} changed since the manifest was written, loading it eagerly", it->first);
+            return nullptr;
+        }
+        return it->second;
+    }
+
+}// namespace mcp::business
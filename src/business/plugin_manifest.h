@@ -0,0 +1,85 @@
+// src/business/plugin_manifest.h
+#pragma once
+
+#include "mcp_plugin.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Tool metadata of one plugin as recorded in a manifest.
+     * Owns the strings that tool_infos point into, so the ToolInfo array stays valid
+     * for as long as the entry is alive.
+     */
+    struct PluginManifestEntry {
+        struct Tool {
+            std::string name;
+            std::string description;
+            std::string parameters;// JSON Schema string
+            bool is_streaming = false;
+        };
+
+        std::string file;       ///< Plugin file name, relative to the manifest directory
+        std::uintmax_t size = 0;///< File size in bytes, checked before the hash
+        std::string hash;       ///< Content hash, see PluginManifest::hash_file()
+        std::vector<Tool> tools;
+        std::vector<ToolInfo> tool_infos;///< Views into tools, built by bind()
+
+        /**
+         * @brief Rebuild tool_infos from tools. Call after tools was filled in.
+         */
+        void bind();
+    };
+
+    /**
+     * @brief Manifest of a plugin directory, written by `plugin_ctl manifest`.
+     * Lets the server publish the tools of a plugin without loading it; the file hash
+     * tells whether an entry still describes the library on disk.
+     */
+    class PluginManifest {
+    public:
+        static constexpr const char *kFileName = "plugins.manifest.json";///< Stored inside the plugin directory
+
+        /**
+         * @brief Hash a file's contents (FNV-1a, 64 bit).
+         * Not cryptographic; it only has to notice a rebuilt plugin.
+         * @param path File to hash
+         * @return Hex digest, empty if the file cannot be read
+         */
+        static std::string hash_file(const std::filesystem::path &path);
+
+        /**
+         * @brief Read the manifest of a directory.
+         * @param directory Plugin directory
+         * @return Manifest, or std::nullopt if there is none or it cannot be parsed
+         */
+        static std::optional<PluginManifest> load(const std::filesystem::path &directory);
+
+        /**
+         * @brief Write the manifest of a directory, replacing the previous one atomically.
+         * @param directory Plugin directory
+         * @param entries Plugin entries
+         * @return true on success
+         */
+        static bool save(const std::filesystem::path &directory, const std::vector<PluginManifestEntry> &entries);
+
+        /**
+         * @brief Find the entry of a plugin file if it still matches the file on disk.
+         * @param plugin_path Plugin file
+         * @return Entry, or nullptr if the plugin is not listed or was rebuilt since
+         */
+        std::shared_ptr<const PluginManifestEntry> find_current(const std::filesystem::path &plugin_path) const;
+
+        size_t size() const { return entries_.size(); }
+
+    private:
+        std::unordered_map<std::string, std::shared_ptr<const PluginManifestEntry>> entries_;// file name -> entry
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,39 @@
+#include "plugin_strand.h"
+#include "core/logger.h"
+#include "core/tool_thread_pool.hpp"
+
+namespace mcp::business {
+
+    PluginStrand::PluginStrand(bool pinned, const std::string &plugin_name) {
+        if (!pinned) {
+            executor_ = asio::make_strand(core::ToolThreadPool::instance().executor());
+            return;
+        }
+        context_ = std::make_unique<asio::io_context>(1);
+        work_ = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(context_->get_executor());
+        executor_ = context_->get_executor();
+        // Thread names are cut at 15 characters on Linux
+        thread_ = std::thread([context = context_.get(), name = "mcp-pin-" + plugin_name.substr(0, 7)]() {
+            AsioIOServicePool::SetupCurrentThread(name, -1);
+            context->run();
+        });
+        MCP_INFO("Plugin {} runs its calls on a thread of its own", plugin_name);
+    }
+
+    PluginStrand::~PluginStrand() {
+        if (!context_) {
+            return;
+        }
+        work_.reset();
+        context_->stop();
+        // The last reference to a plugin can go away in one of its own calls
+        if (thread_.get_id() == std::this_thread::get_id()) {
+            // run() returns once this call does, the context must outlive it
+            thread_.detach();
+            (void) context_.release();
+        } else {
+            thread_.join();
+        }
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,75 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace mcp::business {
+
+    /**
+     * @brief Where the calls of a plugin's tools that are not reentrant run, see mcp_plugin_thread_safety.
+     *
+     * Serialized plugins get a strand over the ToolThreadPool: their calls run on whichever worker is
+     * free, one after the other. Pinned plugins get a thread of their own that runs all of them. Tool
+     * calls co_spawn onto executor(), so a call waiting for its turn is a suspended coroutine and a
+     * queue of calls to one plugin never holds up the pool workers other tools need.
+     *
+     * run() is the plugin boundary itself and is safe from any thread: calls that arrive on
+     * executor() pass straight through, others (streams being started) wait for their turn there.
+     */
+    class PluginStrand {
+    public:
+        /**
+         * @brief Create the strand for a plugin.
+         * @param pinned Give the plugin a thread of its own instead of a strand over the pool
+         * @param plugin_name Plugin file name, names the thread
+         */
+        PluginStrand(bool pinned, const std::string &plugin_name);
+        ~PluginStrand();
+        PluginStrand(const PluginStrand &) = delete;
+        PluginStrand &operator=(const PluginStrand &) = delete;
+
+        /**
+         * @brief Executor to co_spawn the plugin's calls onto.
+         */
+        const asio::any_io_executor &executor() const { return executor_; }
+
+        bool pinned() const { return context_ != nullptr; }
+
+        /**
+         * @brief Call into the plugin in its turn, blocking until it returns.
+         * @param call Calls the plugin
+         * @return What call returned
+         */
+        template<typename Call>
+        std::invoke_result_t<Call> run(Call &&call) {
+            if (!pinned()) {
+                std::lock_guard lock(mutex_);
+                return call();
+            }
+            if (std::this_thread::get_id() == thread_.get_id()) {
+                return call();
+            }
+            std::packaged_task<std::invoke_result_t<Call>()> task(std::forward<Call>(call));
+            auto result = task.get_future();
+            asio::post(executor_, [&task]() { task(); });
+            return result.get();
+        }
+
+    private:
+        std::unique_ptr<asio::io_context> context_;///< Pinned plugins only
+        std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work_;
+        std::thread thread_;
+        std::mutex mutex_;///< Serialized plugins: held for each call, the strand keeps it uncontended
+        asio::any_io_executor executor_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,152 @@
+// src/business/plugin_usage.cpp
+#include "plugin_usage.h"
+#include "core/logger.h"
+#include "metrics/metrics_manager.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace mcp::business {
+
+    namespace {
+        thread_local uint64_t tls_allocated = 0;///< Bytes the host allocator hooks handed out on this thread
+
+        /**
+         * @brief CPU time the calling thread has used, in nanoseconds.
+         */
+        int64_t thread_cpu_ns() {
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+                return 0;
+            }
+            auto ticks = [](const FILETIME &time) {
+                return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            return (ticks(kernel) + ticks(user)) * 100;// 100 ns units
+#else
+            timespec now{};
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) {
+                return 0;
+            }
+            return static_cast<int64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+#endif
+        }
+    }// namespace
+
+    PluginQuotaOptions::Action PluginQuotaOptions::parse_action(std::string_view text) {
+        return text == "disable" ? Action::Disable : Action::Throttle;
+    }
+
+    PluginUsage &PluginUsage::instance() {
+        static PluginUsage usage;
+        return usage;
+    }
+
+    PluginUsage::Meter::Meter(std::string_view plugin, std::string_view tool)
+        : plugin_(plugin), tool_(tool), cpu_start_(thread_cpu_ns()), allocated_start_(tls_allocated) {}
+
+    PluginUsage::Meter::~Meter() {
+        int64_t cpu = thread_cpu_ns() - cpu_start_;
+        PluginUsage::instance().record(plugin_, tool_, cpu > 0 ? static_cast<uint64_t>(cpu) : 0, tls_allocated - allocated_start_);
+    }
+
+    void PluginUsage::count_allocation(size_t bytes) noexcept {
+        tls_allocated += bytes;
+    }
+
+    PluginUsage::Budget &PluginUsage::budget(std::string_view plugin) {
+        {
+            std::shared_lock lock(budgets_mutex_);
+            auto it = budgets_.find(std::string(plugin));
+            if (it != budgets_.end()) {
+                return *it->second;
+            }
+        }
+        std::unique_lock lock(budgets_mutex_);
+        auto &budget = budgets_[std::string(plugin)];
+        if (!budget) {
+            budget = std::make_unique<Budget>();
+            budget->window_start = std::chrono::steady_clock::now();
+        }
+        return *budget;
+    }
+
+    void PluginUsage::record(std::string_view plugin, std::string_view tool, uint64_t cpu_ns, uint64_t allocated) {
+        static auto &manager = *metrics::MetricsManager::getInstance();
+        auto &stats = manager.plugin_usage_stats(plugin, tool);
+        stats.cpu_ns.add(cpu_ns);
+        stats.allocated_bytes.add(allocated);
+
+        const auto &options = PluginQuotaOptions::current();
+        if (!options.enabled()) {
+            return;
+        }
+        Budget &budget = this->budget(plugin);
+        std::lock_guard lock(budget.mutex);
+        auto now = std::chrono::steady_clock::now();
+        if (now - budget.window_start >= options.window) {
+            budget.window_start = now;
+            budget.cpu_ns = 0;
+            budget.allocated = 0;
+            if (options.action == PluginQuotaOptions::Action::Throttle) {
+                budget.exceeded = false;
+            }
+        }
+        budget.cpu_ns += cpu_ns;
+        budget.allocated += allocated;
+        bool over = (options.cpu.count() > 0 && budget.cpu_ns > static_cast<uint64_t>(std::chrono::nanoseconds(options.cpu).count())) ||
+                    (options.allocated > 0 && budget.allocated > options.allocated);
+        if (over && !budget.exceeded) {
+            budget.exceeded = true;
+            MCP_WARN("Plugin {} used {} ms of CPU and allocated {} bytes within {} s, its calls are {}", plugin,
+                     budget.cpu_ns / 1'000'000, budget.allocated, options.window.count(),
+                     options.action == PluginQuotaOptions::Action::Disable ? "refused until it is reloaded" : "refused for the rest of the window");
+        }
+    }
+
+    std::optional<std::string> PluginUsage::refusal(const std::string &plugin) {
+        const auto &options = PluginQuotaOptions::current();
+        if (!options.enabled()) {
+            return std::nullopt;
+        }
+        Budget &budget = this->budget(plugin);
+        std::lock_guard lock(budget.mutex);
+        if (!budget.exceeded) {
+            return std::nullopt;
+        }
+        if (options.action == PluginQuotaOptions::Action::Disable) {
+            return "Plugin " + plugin + " is disabled, it exceeded its resource quota";
+        }
+        auto left = options.window - (std::chrono::steady_clock::now() - budget.window_start);
+        if (left <= std::chrono::steady_clock::duration::zero()) {
+            // The window is over; the next call that is recorded opens a new one
+            budget.window_start = std::chrono::steady_clock::now();
+            budget.cpu_ns = 0;
+            budget.allocated = 0;
+            budget.exceeded = false;
+            return std::nullopt;
+        }
+        return "Plugin " + plugin + " exceeded its resource quota, try again in " +
+               std::to_string(std::chrono::ceil<std::chrono::seconds>(left).count()) + " s";
+    }
+
+    void PluginUsage::reset(const std::string &plugin) {
+        // Budgets are never erased, a call being recorded may hold one
+        std::shared_lock lock(budgets_mutex_);
+        auto it = budgets_.find(plugin);
+        if (it == budgets_.end()) {
+            return;
+        }
+        Budget &budget = *it->second;
+        std::lock_guard budget_lock(budget.mutex);
+        budget.window_start = std::chrono::steady_clock::now();
+        budget.cpu_ns = 0;
+        budget.allocated = 0;
+        budget.exceeded = false;
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,118 @@
+// src/business/plugin_usage.h
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace mcp::business {
+
+    /**
+     * @brief Resource budgets of each plugin, normally taken from the [server] config section.
+     */
+    struct PluginQuotaOptions {
+        enum class Action {
+            Throttle,///< Refuse the plugin's calls until its window is over
+            Disable, ///< Refuse them until the plugin is loaded again
+        };
+
+        std::chrono::milliseconds cpu{0};///< Thread CPU time a plugin may use per window, 0 = unlimited
+        uint64_t allocated = 0;          ///< Bytes a plugin may take through the host allocator hooks per window, 0 = unlimited
+        std::chrono::seconds window{60}; ///< Length of the accounting window
+        Action action = Action::Throttle;
+
+        bool enabled() const { return cpu.count() > 0 || allocated > 0; }
+
+        /**
+         * @brief Parse "throttle" or "disable"; anything else throttles.
+         */
+        static Action parse_action(std::string_view text);
+
+        static const PluginQuotaOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         */
+        static void configure(const PluginQuotaOptions &options) { storage() = options; }
+
+    private:
+        static PluginQuotaOptions &storage() {
+            static PluginQuotaOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief CPU time and allocations of plugin calls, per plugin and tool, and the quotas on them.
+     *
+     * Every synchronous call and every pull of a stream generator runs under a Meter, which takes
+     * the thread's CPU clock and its count of bytes handed out by the host allocator hooks
+     * (MCPHostServices::alloc and call_alloc) before and after. The differences go to
+     * mcp_plugin_cpu_seconds_total and mcp_plugin_allocated_bytes_total, and against the plugin's
+     * budget for the current window. A plugin over its budget has its new calls and streams
+     * refused with a rate limited error; calls and streams already running finish normally.
+     * Plugins running in a child process are not metered, their work is not on the server's threads.
+     */
+    class PluginUsage {
+    public:
+        static PluginUsage &instance();
+
+        /**
+         * @brief Measures one call into a plugin on the current thread and records it on destruction.
+         */
+        class Meter {
+        public:
+            Meter(std::string_view plugin, std::string_view tool);
+            ~Meter();
+            Meter(const Meter &) = delete;
+            Meter &operator=(const Meter &) = delete;
+
+        private:
+            std::string_view plugin_;
+            std::string_view tool_;
+            int64_t cpu_start_;
+            uint64_t allocated_start_;
+        };
+
+        /**
+         * @brief Count bytes the host allocator hooks hand to a plugin on this thread.
+         */
+        static void count_allocation(size_t bytes) noexcept;
+
+        /**
+         * @brief Why a new call of a plugin is refused.
+         * @param plugin Plugin file name
+         * @return Error message, std::nullopt if the plugin is within its budget
+         */
+        std::optional<std::string> refusal(const std::string &plugin);
+
+        /**
+         * @brief Forget a plugin's budget, lifting a disable. Called when it is loaded again.
+         */
+        void reset(const std::string &plugin);
+
+    private:
+        PluginUsage() = default;
+
+        struct Budget {
+            std::mutex mutex;
+            std::chrono::steady_clock::time_point window_start;
+            uint64_t cpu_ns = 0;   ///< Used in the current window
+            uint64_t allocated = 0;///< Used in the current window
+            bool exceeded = false; ///< Over budget in the current window, or for good when disabled
+        };
+
+        void record(std::string_view plugin, std::string_view tool, uint64_t cpu_ns, uint64_t allocated);
+        Budget &budget(std::string_view plugin);
+
+        std::shared_mutex budgets_mutex_;
+        std::unordered_map<std::string, std::unique_ptr<Budget>> budgets_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,134 @@
+// src/business/progress.cpp
+#include "progress.h"
+
+namespace mcp::business {
+
+    namespace {
+        thread_local const ProgressReporter *current_reporter = nullptr;
+    }
+
+    std::shared_ptr<ProgressReporter> ProgressReporter::create(nlohmann::json token,
+                                                               asio::any_io_executor executor,
+                                                               Sink sink,
+                                                               const ProgressOptions &options) {
+        if (options.max_per_second == 0) {
+            return nullptr;
+        }
+        auto interval = std::chrono::nanoseconds(std::chrono::seconds(1)) / options.max_per_second;
+        return std::shared_ptr<ProgressReporter>(
+                new ProgressReporter(std::move(token), std::move(executor), std::move(sink), interval));
+    }
+
+    std::optional<nlohmann::json> ProgressReporter::token_of(const nlohmann::json &params) {
+        if (!params.is_object()) {
+            return std::nullopt;
+        }
+        auto meta = params.find("_meta");
+        if (meta == params.end() || !meta->is_object()) {
+            return std::nullopt;
+        }
+        auto token = meta->find("progressToken");
+        if (token == meta->end() || !(token->is_string() || token->is_number_integer())) {
+            return std::nullopt;
+        }
+        return std::optional<nlohmann::json>(std::in_place, *token);
+    }
+
+    ProgressReporter::ProgressReporter(nlohmann::json token, asio::any_io_executor executor, Sink sink,
+                                       std::chrono::nanoseconds interval)
+        : token_(std::move(token)), executor_(executor), sink_(std::move(sink)), interval_(interval),
+          flush_timer_(executor), plugin_progress_{this, &ProgressReporter::report_from_plugin} {}
+
+    void ProgressReporter::report(double progress, double total, const char *message) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || (reported_ && progress <= progress_)) {
+            return;
+        }
+        progress_ = progress;
+        total_ = total;
+        if (message) {
+            message_ = message;
+        } else {
+            message_.clear();
+        }
+        reported_ = true;
+        pending_ = true;
+        if (flush_scheduled_) {
+            return;// the scheduled send picks this report up
+        }
+
+        flush_scheduled_ = true;
+        auto self = shared_from_this();
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_send_) {
+            asio::post(executor_, [self]() { self->send_pending(); });
+            return;
+        }
+        // The timer is only touched on the executor
+        asio::post(executor_, [self, due = next_send_]() {
+            self->flush_timer_.expires_at(due);
+            self->flush_timer_.async_wait([self](const asio::error_code &ec) {
+                if (!ec) {
+                    self->send_pending();
+                }
+            });
+        });
+    }
+
+    void ProgressReporter::close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            pending_ = false;
+        }
+        flush_timer_.cancel();
+    }
+
+    void ProgressReporter::send_pending() {
+        std::string notification;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush_scheduled_ = false;
+            if (closed_ || !pending_) {
+                return;
+            }
+            pending_ = false;
+            next_send_ = std::chrono::steady_clock::now() + interval_;
+            notification = render_locked();
+        }
+        sink_(std::move(notification));
+    }
+
+    std::string ProgressReporter::render_locked() const {
+        nlohmann::json notification;
+        notification["jsonrpc"] = "2.0";
+        notification["method"] = "notifications/progress";
+        auto &params = notification["params"];
+        params["progressToken"] = token_;
+        params["progress"] = progress_;
+        if (total_ >= 0) {
+            params["total"] = total_;
+        }
+        if (!message_.empty()) {
+            params["message"] = message_;
+        }
+        return notification.dump();
+    }
+
+    void ProgressReporter::report_from_plugin(void *context, double progress, double total, const char *message) {
+        static_cast<ProgressReporter *>(context)->report(progress, total, message);
+    }
+
+    const ProgressReporter *ProgressReporter::current() {
+        return current_reporter;
+    }
+
+    ProgressReporter::Scope::Scope(const ProgressReporter *reporter) : previous_(current_reporter) {
+        current_reporter = reporter;
+    }
+
+    ProgressReporter::Scope::~Scope() {
+        current_reporter = previous_;
+    }
+
+}// namespace mcp::business
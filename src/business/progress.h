@@ -0,0 +1,147 @@
+// src/business/progress.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "mcp_plugin.h"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+
+namespace mcp::business {
+
+    /**
+     * @brief Settings of progress notifications, normally taken from the [concurrency] section.
+     */
+    struct ProgressOptions {
+        unsigned max_per_second = 10;///< Notifications sent per call and second at most, 0 = progress is not reported
+
+        static const ProgressOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(ProgressOptions options) { storage() = options; }
+
+    private:
+        static ProgressOptions &storage() {
+            static ProgressOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Sends the progress a synchronous tool call reports as notifications/progress.
+     *
+     * Plugins may report as often as they like, from any thread. Reports are coalesced: at most
+     * max_per_second notifications go out per call, each carrying the latest report, and one held
+     * back by the limit is sent when its slot comes up. Notifications are handed to the sink on the
+     * reporter's executor, one at a time and in order; nothing is cached or replayed.
+     */
+    class ProgressReporter : public std::enable_shared_from_this<ProgressReporter> {
+    public:
+        using Sink = std::function<void(std::string notification)>;///< Gets one serialized notification
+
+        /**
+         * @brief Create a reporter for a request that asked for progress.
+         * @param token progressToken of the request
+         * @param executor Executor the sink runs on
+         * @param sink Sends a notification
+         * @param options Rate limit
+         * @return Reporter, nullptr if progress reporting is disabled
+         */
+        static std::shared_ptr<ProgressReporter> create(nlohmann::json token,
+                                                        asio::any_io_executor executor,
+                                                        Sink sink,
+                                                        const ProgressOptions &options = ProgressOptions::current());
+
+        /**
+         * @brief progressToken of a request, taken from params._meta.
+         * @param params Request params
+         * @return Token, std::nullopt if the client did not ask for progress
+         */
+        static std::optional<nlohmann::json> token_of(const nlohmann::json &params);
+
+        ProgressReporter(const ProgressReporter &) = delete;
+        ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+        /**
+         * @brief Report progress. Thread safe and never blocks; reports that do not increase
+         *        the progress are ignored, as are reports after close().
+         * @param progress Work done so far
+         * @param total Total work, negative if unknown
+         * @param message Status text, may be nullptr
+         */
+        void report(double progress, double total, const char *message);
+
+        /**
+         * @brief Stop sending. A report held back by the rate limit is dropped.
+         * Call from the reporter's executor, so that no notification is handed to the sink afterwards.
+         */
+        void close();
+
+        /**
+         * @brief Reporter in the form handed to plugins, valid as long as this object is.
+         */
+        const MCPProgress *plugin_progress() const { return &plugin_progress_; }
+
+        /**
+         * @brief Reporter of the tool call running on this thread, see Scope.
+         * @return Reporter, or nullptr if the call does not report progress
+         */
+        static const ProgressReporter *current();
+
+        /**
+         * @brief Makes a reporter current() on this thread while a synchronous call runs into a plugin.
+         */
+        class Scope {
+        public:
+            explicit Scope(const ProgressReporter *reporter);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const ProgressReporter *previous_;
+        };
+
+    private:
+        ProgressReporter(nlohmann::json token, asio::any_io_executor executor, Sink sink, std::chrono::nanoseconds interval);
+
+        static void report_from_plugin(void *context, double progress, double total, const char *message);
+
+        /**
+         * @brief Hand the latest report to the sink; runs on the executor.
+         */
+        void send_pending();
+
+        std::string render_locked() const;
+
+        nlohmann::json token_;
+        asio::any_io_executor executor_;
+        Sink sink_;
+        std::chrono::nanoseconds interval_;///< Minimum time between two notifications
+        asio::steady_timer flush_timer_;   ///< Sends a report held back by the limit
+
+        std::mutex mutex_;
+        double progress_ = 0;
+        double total_ = -1;
+        std::string message_;
+        bool reported_ = false;     ///< A report has been accepted, progress_ must increase from here
+        bool pending_ = false;      ///< The latest report has not been sent yet
+        bool flush_scheduled_ = false;///< A send is posted or the flush timer is armed
+        bool closed_ = false;
+        std::chrono::steady_clock::time_point next_send_{};///< Earliest time of the next notification
+
+        MCPProgress plugin_progress_;
+    };
+
+}// namespace mcp::business
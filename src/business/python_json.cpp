@@ -0,0 +1,170 @@
+#include "python_json.h"
+#include "metrics/tracing.h"
+#include "utils/base64.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr int kMaxDepth = 512;///< Nesting accepted from a tool result, deeper ones are most likely cycles
+        constexpr size_t kBlobPiece = 3 * 256 * 1024;///< Bytes encoded per output reservation, a multiple of 3
+
+        /**
+         * @brief A read-only view of an object's buffer, released with the GIL held.
+         */
+        class BufferView {
+        public:
+            explicit BufferView(PyObject *object) {
+                if (PyObject_GetBuffer(object, &view_, PyBUF_SIMPLE | PyBUF_C_CONTIGUOUS) != 0) {
+                    throw py::error_already_set();
+                }
+            }
+            ~BufferView() { PyBuffer_Release(&view_); }
+            BufferView(const BufferView &) = delete;
+            BufferView &operator=(const BufferView &) = delete;
+
+            const char *data() const { return static_cast<const char *>(view_.buf); }
+            size_t size() const { return static_cast<size_t>(view_.len); }
+
+        private:
+            Py_buffer view_{};
+        };
+
+        py::object steal(PyObject *object) {
+            if (!object) {
+                throw py::error_already_set();
+            }
+            return py::reinterpret_steal<py::object>(object);
+        }
+
+        void append_utf8(std::string &out, PyObject *text) {
+            Py_ssize_t size = 0;
+            const char *utf8 = PyUnicode_AsUTF8AndSize(text, &size);
+            if (!utf8) {
+                throw py::error_already_set();
+            }
+            mcp::metrics::append_json_string(out, std::string_view(utf8, static_cast<size_t>(size)));
+        }
+
+        void append_value(std::string &out, PyObject *value, int depth) {
+            if (depth > kMaxDepth) {
+                throw py::type_error("Tool result nested too deeply to be converted to JSON");
+            }
+            if (value == Py_None) {
+                out += "null";
+            } else if (value == Py_True) {
+                out += "true";
+            } else if (value == Py_False) {
+                out += "false";
+            } else if (PyUnicode_Check(value)) {
+                append_utf8(out, value);
+            } else if (PyLong_Check(value)) {
+                int overflow = 0;
+                long long number = PyLong_AsLongLongAndOverflow(value, &overflow);
+                if (overflow != 0) {
+                    // Python ints are unbounded, like JSON numbers; the decimal text is exact
+                    auto text = steal(PyObject_Str(value));
+                    out += py::reinterpret_borrow<py::str>(text).cast<std::string>();
+                } else if (number == -1 && PyErr_Occurred()) {
+                    throw py::error_already_set();
+                } else {
+                    out += std::to_string(number);
+                }
+            } else if (PyFloat_Check(value)) {
+                double number = PyFloat_AS_DOUBLE(value);
+                if (!std::isfinite(number)) {
+                    out += "null";
+                } else {
+                    char *text = PyOS_double_to_string(number, 'r', 0, Py_DTSF_ADD_DOT_0, nullptr);
+                    if (!text) {
+                        throw py::error_already_set();
+                    }
+                    out += text;
+                    PyMem_Free(text);
+                }
+            } else if (PyDict_Check(value)) {
+                out += '{';
+                Py_ssize_t position = 0;
+                PyObject *key;
+                PyObject *item;
+                bool first = true;
+                while (PyDict_Next(value, &position, &key, &item)) {
+                    if (!first) {
+                        out += ',';
+                    }
+                    first = false;
+                    if (PyUnicode_Check(key)) {
+                        append_utf8(out, key);
+                    } else if (key == Py_None || PyBool_Check(key) || PyLong_Check(key) || PyFloat_Check(key)) {
+                        // json.dumps writes these keys as the JSON text of the key, quoted
+                        std::string text;
+                        append_value(text, key, depth + 1);
+                        mcp::metrics::append_json_string(out, text);
+                    } else {
+                        throw py::type_error(std::string("Keys must be str, int, float, bool or None, not ") + Py_TYPE(key)->tp_name);
+                    }
+                    out += ':';
+                    append_value(out, item, depth + 1);
+                }
+                out += '}';
+            } else if (PyList_Check(value) || PyTuple_Check(value)) {
+                out += '[';
+                Py_ssize_t size = PySequence_Fast_GET_SIZE(value);
+                for (Py_ssize_t i = 0; i < size; ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    append_value(out, PySequence_Fast_GET_ITEM(value, i), depth + 1);
+                }
+                out += ']';
+            } else if (is_python_binary(value)) {
+                BufferView bytes(value);
+                out += '"';
+                size_t start = out.size();
+                out.resize(start + mcp::utils::base64_encoded_size(bytes.size()));
+                mcp::utils::base64_encode(bytes.data(), bytes.size(), out.data() + start);
+                out += '"';
+            } else {
+                throw py::type_error(std::string("Object of type ") + Py_TYPE(value)->tp_name + " is not JSON serializable");
+            }
+        }
+    }// namespace
+
+    void append_python_json(std::string &out, py::handle value) {
+        append_value(out, value.ptr(), 0);
+    }
+
+    bool is_python_binary(py::handle value) {
+        return PyBytes_Check(value.ptr()) || PyByteArray_Check(value.ptr()) || PyMemoryView_Check(value.ptr());
+    }
+
+    bool write_python_blob_result(MCPOutput &output, std::string_view uri, py::handle value) {
+        BufferView bytes(value.ptr());
+        std::string head = R"({"content":[{"type":"resource","resource":{"uri":)";
+        mcp::metrics::append_json_string(head, uri);
+        head += R"(,"mimeType":"application/octet-stream","blob":")";
+
+        bool written = output.write(output.context, head.data(), head.size());
+        {
+            // Only the buffer is read from here on, other Python threads may run meanwhile
+            py::gil_scoped_release release;
+            for (size_t offset = 0; written && offset < bytes.size(); offset += kBlobPiece) {
+                size_t piece = std::min(kBlobPiece, bytes.size() - offset);
+                char *out = output.reserve(output.context, mcp::utils::base64_encoded_size(piece));
+                if (!out) {
+                    written = false;
+                    break;
+                }
+                output.commit(output.context, mcp::utils::base64_encode(bytes.data() + offset, piece, out));
+            }
+        }
+        static constexpr std::string_view kTail = R"("}}]})";
+        written = written && output.write(output.context, kTail.data(), kTail.size());
+        if (written) {
+            output.flags |= MCP_OUTPUT_PASSTHROUGH;
+        }
+        return written;
+    }
+
+}// namespace mcp::business
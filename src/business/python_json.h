@@ -0,0 +1,43 @@
+#pragma once
+
+#include "mcp_plugin.h"
+#include <pybind11/pybind11.h>
+#include <string>
+#include <string_view>
+
+namespace mcp::business {
+
+    namespace py = pybind11;
+
+    /**
+     * @brief Append a Python object as compact JSON, without building a JSON tree first.
+     * Accepts what json.dumps accepts by default; non-finite floats are written as null.
+     * bytes, bytearray and memoryview are written as base64 strings, encoded straight from their
+     * buffer, so a tool can put binary data into image, audio or blob content as it is.
+     * Needs the GIL.
+     * @param out Text to append to
+     * @param value dict, list, tuple, str, int, float, bool, None or binary, nested
+     * @throws py::type_error for anything else, or nesting deeper than 512 levels
+     */
+    void append_python_json(std::string &out, py::handle value);
+
+    /**
+     * @brief Whether a tool result is binary: bytes, bytearray or memoryview.
+     */
+    bool is_python_binary(py::handle value);
+
+    /**
+     * @brief Write binary tool output as a complete tools/call result: one embedded resource
+     *        whose blob is the base64 of the object's bytes.
+     * The bytes are encoded straight from the object's buffer into the output, in pieces, with
+     * the GIL released meanwhile; the buffer stays exported until then, which keeps the object
+     * alive and its memory in place. Needs the GIL.
+     * @param output Server output to write to; MCP_OUTPUT_PASSTHROUGH is set on it
+     * @param uri URI of the resource
+     * @param value Binary object, see is_python_binary()
+     * @return false if the output ran out of memory
+     * @throws py::error_already_set if the object's buffer cannot be read
+     */
+    bool write_python_blob_result(MCPOutput &output, std::string_view uri, py::handle value);
+
+}// namespace mcp::business
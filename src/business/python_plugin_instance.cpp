@@ -1,11 +1,105 @@
 #include "python_plugin_instance.h"
 #include "core/logger.h"
+#include "plugin_error.h"
+#include "python_json.h"
 #include "python_runtime_manager.h"
+#include "tool_output.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 
 namespace fs = std::filesystem;
 namespace mcp::business {
+    namespace {
+        std::string read_environment(const char *name) {
+#ifdef _MSC_VER
+            std::string value;
+            char *buffer = nullptr;
+            size_t length = 0;
+            if (_dupenv_s(&buffer, &length, name) == 0 && buffer != nullptr) {
+                value = buffer;
+                free(buffer);
+            }
+            return value;
+#else
+            const char *value = std::getenv(name);
+            return value ? value : "";
+#endif
+        }
+
+        void read_environment(const char *name, std::size_t &value) {
+            std::string text = read_environment(name);
+            std::size_t parsed = 0;
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+            if (!text.empty() && ec == std::errc() && ptr == text.data() + text.size()) {
+                value = parsed;
+            }
+        }
+
+        constexpr std::size_t kKeptResultCapacity = 1024 * 1024;///< Larger result buffers are released after the call
+
+        /**
+         * @brief Buffer the results of the calling thread are built in, reused from call to call.
+         */
+        std::string &result_buffer() {
+            thread_local std::string buffer;
+            buffer.clear();
+            return buffer;
+        }
+
+        void release_result_buffer(std::string &buffer) {
+            if (buffer.capacity() > kKeptResultCapacity) {
+                std::string().swap(buffer);
+            }
+        }
+
+        void append_utf8(std::string &out, py::handle text) {
+            Py_ssize_t size = 0;
+            const char *utf8 = PyUnicode_AsUTF8AndSize(text.ptr(), &size);
+            if (!utf8) {
+                throw py::error_already_set();
+            }
+            out.append(utf8, static_cast<size_t>(size));
+        }
+
+        void write_environment(const char *name, const std::string &value) {
+#ifdef _WIN32
+            _putenv_s(name, value.c_str());
+#else
+            setenv(name, value.c_str(), 1);
+#endif
+        }
+    }// namespace
+
+    PythonExecutionOptions PythonExecutionOptions::from_environment() {
+        PythonExecutionOptions options;
+        read_environment("MCP_PYTHON_INTERPRETERS", options.interpreters);
+        read_environment("MCP_PYTHON_WORKERS", options.workers);
+        if (auto executable = read_environment("MCP_PYTHON_WORKER_EXECUTABLE"); !executable.empty()) {
+            options.worker_executable = executable;
+        }
+        read_environment("MCP_PYTHON_WORKER_BUFFER_KB", options.worker_buffer_kb);
+        read_environment("MCP_PYTHON_WORKER_MAX_CALLS", options.worker_max_calls);
+        read_environment("MCP_PYTHON_WORKER_MAX_RSS_MB", options.worker_max_rss_mb);
+        options.bytecode_cache_dir = read_environment("MCP_PYTHON_BYTECODE_CACHE_DIR");
+        options.preload_modules = read_environment("MCP_PYTHON_PRELOAD_MODULES");
+        return options;
+    }
+
+    void PythonExecutionOptions::export_to_environment() const {
+        write_environment("MCP_PYTHON_INTERPRETERS", std::to_string(interpreters));
+        write_environment("MCP_PYTHON_WORKERS", std::to_string(workers));
+        write_environment("MCP_PYTHON_WORKER_EXECUTABLE", worker_executable);
+        write_environment("MCP_PYTHON_WORKER_BUFFER_KB", std::to_string(worker_buffer_kb));
+        write_environment("MCP_PYTHON_WORKER_MAX_CALLS", std::to_string(worker_max_calls));
+        write_environment("MCP_PYTHON_WORKER_MAX_RSS_MB", std::to_string(worker_max_rss_mb));
+        write_environment("MCP_PYTHON_BYTECODE_CACHE_DIR", bytecode_cache_dir);
+        write_environment("MCP_PYTHON_PRELOAD_MODULES", preload_modules);
+    }
+
     PythonPluginInstance::PythonPluginInstance() : initialized_(false) {
     }
 
@@ -34,6 +128,8 @@ namespace mcp::business {
             }
 
             MCP_DEBUG("[PLUGIN] Python file found: {}", python_file_path.string());
+            execution_ = PythonExecutionOptions::from_environment();
+            stopping_ = false;
 
             // Get the Python runtime manager instance
             auto &runtime_manager = PythonRuntimeManager::getInstance();
@@ -52,6 +148,36 @@ namespace mcp::business {
                 return false;
             }
 
+            // Tool calls run in worker processes or in sub-interpreters with their own GIL if
+            // enabled; tools are still listed by the main interpreter, which also takes the calls
+            // if neither can be started
+            const auto &execution = execution_;
+            if (execution.workers > 0) {
+                PythonWorkerPool::Options worker_options;
+                worker_options.executable = execution.worker_executable;
+                worker_options.plugin_dir = plugin_dir_;
+                worker_options.module_name = module_name_;
+                worker_options.workers = execution.workers;
+                worker_options.buffer_bytes = execution.worker_buffer_kb * 1024;
+                worker_options.max_calls = execution.worker_max_calls;
+                worker_options.max_rss_mb = execution.worker_max_rss_mb;
+                worker_options.pycache_prefix = execution.bytecode_cache_dir;
+                auto workers = std::make_unique<PythonWorkerPool>(std::move(worker_options));
+                if (workers->start()) {
+                    workers_ = std::move(workers);
+                } else {
+                    MCP_WARN("[PLUGIN] {} runs its tool calls in process", module_name_);
+                }
+            }
+            if (!workers_ && execution.interpreters > 0) {
+                auto interpreters = std::make_unique<PythonSubinterpreterPool>(module_name_, std::vector<std::string>{plugin_dir_}, execution.interpreters);
+                if (interpreters->start()) {
+                    interpreters_ = std::move(interpreters);
+                } else {
+                    MCP_WARN("[PLUGIN] {} runs its tool calls in the main interpreter", module_name_);
+                }
+            }
+
             initialized_ = true;
             MCP_INFO("[PLUGIN] Plugin instance initialized successfully");
             return true;
@@ -62,16 +188,32 @@ namespace mcp::business {
     }
 
     void PythonPluginInstance::uninitialize() {
-        std::lock_guard<std::mutex> lock(cache_mutex_);
+        stopping_ = true;
+        if (warm_up_thread_.joinable()) {
+            warm_up_thread_.join();
+        }
 
-        for (auto &tool: tools_cache_) {
-            free((void *) tool.name);
-            free((void *) tool.description);
-            free((void *) tool.parameters);
+        // Queued calls are answered before the interpreters and workers end, running streams are cancelled
+        interpreters_.reset();
+        workers_.reset();
+        if (streams_) {
+            streams_->stop();
         }
+
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+
         tools_cache_.clear();
+        tool_strings_.clear();
 
-        plugin_module_ = py::module_();
+        // Dropping the last references runs Python code, which needs the GIL
+        if (Py_IsInitialized() && (plugin_module_ || call_tool_func_ || call_tool_object_func_ || start_stream_func_)) {
+            py::gil_scoped_acquire acquire;
+            call_tool_func_ = py::object();
+            call_tool_object_func_ = py::object();
+            start_stream_func_ = py::object();
+            json_loads_func_ = py::object();
+            plugin_module_ = py::module_();
+        }
 
         initialized_ = false;
         MCP_DEBUG("[PLUGIN] Plugin instance uninitialized");
@@ -89,10 +231,16 @@ namespace mcp::business {
             // Get the Python runtime manager instance
             auto &runtime_manager = PythonRuntimeManager::getInstance();
 
+            if (!execution_.bytecode_cache_dir.empty()) {
+                precompile_plugins();
+            }
+
             // Import the plugin module (now safe to call Python API under GIL protection)
             MCP_DEBUG("[PLUGIN] Trying to import Python module: {}", module_name_);
+            auto import_started = std::chrono::steady_clock::now();
             plugin_module_ = runtime_manager.importModule(module_name_);
-            MCP_DEBUG("[PLUGIN] Python module imported successfully: {}", module_name_);
+            MCP_INFO("[PLUGIN] Imported Python module {} in {:.1f} ms", module_name_,
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - import_started).count());
 
             // Validate module has required functions
             if (!py::hasattr(plugin_module_, "get_tools") ||
@@ -101,6 +249,21 @@ namespace mcp::business {
                 return false;
             }
 
+            // Resolved once, a call only looks up its arguments
+            call_tool_func_ = plugin_module_.attr("call_tool");
+            if (py::hasattr(plugin_module_, "call_tool_object")) {
+                call_tool_object_func_ = plugin_module_.attr("call_tool_object");
+                MCP_DEBUG("[PLUGIN] {} takes its arguments as objects", module_name_);
+            }
+            if (py::hasattr(plugin_module_, "start_stream")) {
+                start_stream_func_ = plugin_module_.attr("start_stream");
+                streams_ = std::make_unique<PythonStreamLoop>();
+                MCP_DEBUG("[PLUGIN] {} streams through an event loop", module_name_);
+            }
+            if (call_tool_object_func_ || start_stream_func_) {
+                json_loads_func_ = py::module_::import("json").attr("loads");
+            }
+
             MCP_INFO("[PLUGIN] Plugin module loaded successfully");
             return true;
         } catch (const py::error_already_set &) {
@@ -112,6 +275,64 @@ namespace mcp::business {
             return false;
         }
     }
+    void PythonPluginInstance::precompile_plugins() {
+        // Called with the GIL held. Bytecode of every module then goes to the cache directory, so
+        // read-only plugin and site-packages directories get cached too, the first start fills it
+        auto started = std::chrono::steady_clock::now();
+        try {
+            py::module_::import("sys").attr("pycache_prefix") = execution_.bytecode_cache_dir;
+            // Up-to-date files are skipped, a warm cache costs one stat per source
+            bool compiled = py::module_::import("compileall").attr("compile_dir")(plugin_dir_, py::arg("quiet") = 1).cast<bool>();
+            if (!compiled) {
+                MCP_WARN("[PLUGIN] Some Python files in {} failed to compile", plugin_dir_);
+            }
+        } catch (const py::error_already_set &e) {
+            MCP_WARN("[PLUGIN] Failed to precompile {} into {}: {}", plugin_dir_, execution_.bytecode_cache_dir, e.what());
+            return;
+        }
+        MCP_DEBUG("[PLUGIN] Precompiled {} into {} in {:.1f} ms", plugin_dir_, execution_.bytecode_cache_dir,
+                  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+    }
+
+    void PythonPluginInstance::warm_up() {
+        if (!initialized_ || execution_.preload_modules.empty() || warm_up_thread_.joinable()) {
+            return;
+        }
+
+        std::vector<std::string> modules;
+        std::string_view list = execution_.preload_modules;
+        while (!list.empty()) {
+            auto comma = list.find(',');
+            auto name = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            auto begin = name.find_first_not_of(" \t");
+            if (begin != std::string_view::npos) {
+                modules.emplace_back(name.substr(begin, name.find_last_not_of(" \t") - begin + 1));
+            }
+        }
+
+        // One module per GIL hold, so tool calls get in between the imports
+        warm_up_thread_ = std::thread([this, modules = std::move(modules)]() {
+            for (const auto &module: modules) {
+                if (stopping_) {
+                    break;
+                }
+                py::gil_scoped_acquire acquire;
+                try {
+                    auto sys_modules = py::module_::import("sys").attr("modules");
+                    auto before = py::len(sys_modules);
+                    auto started = std::chrono::steady_clock::now();
+                    py::module_::import(module.c_str());
+                    MCP_INFO("[PLUGIN] Preloaded Python module {} in {:.1f} ms ({} modules)", module,
+                             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count(),
+                             py::len(sys_modules) - before);
+                } catch (const py::error_already_set &e) {
+                    MCP_WARN("[PLUGIN] Failed to preload Python module {}: {}", module, e.what());
+                }
+            }
+        });
+    }
+
     ToolInfo *PythonPluginInstance::get_tools(int *count) {
         MCP_DEBUG("[PLUGIN] get_tools called, initialized={}", (initialized_ ? "true" : "false"));
 
@@ -122,44 +343,42 @@ namespace mcp::business {
         }
 
         try {
+            {
+                std::lock_guard<std::mutex> lock(cache_mutex_);
+                if (!tools_cache_.empty()) {
+                    *count = static_cast<int>(tools_cache_.size());
+                    return tools_cache_.data();
+                }
+            }
+
             py::gil_scoped_acquire acquire;
 
             std::lock_guard<std::mutex> lock(cache_mutex_);
 
-            // Clear the cache
-            for (auto &tool: tools_cache_) {
-                free((void *) tool.name);
-                free((void *) tool.description);
-                free((void *) tool.parameters);
-            }
-            tools_cache_.clear();
-
             // Call Python function
             py::object get_tools_func = plugin_module_.attr("get_tools");
             py::list tools_list = get_tools_func();
 
-            *count = static_cast<int>(py::len(tools_list));
-            tools_cache_.reserve(*count);
+            std::vector<ToolInfo> tools;
+            std::vector<std::string> strings;
+            tools.reserve(py::len(tools_list));
+            // Reserved up front, so the strings never move and the pointers into them hold
+            strings.reserve(py::len(tools_list) * 3);
 
             // Convert Python objects to ToolInfo structures
             for (const auto &tool_obj: tools_list) {
                 ToolInfo tool{};
-
-                // Extract string fields and make copies
-                std::string name = py::str(tool_obj.attr("name")).cast<std::string>();
-                std::string description = py::str(tool_obj.attr("description")).cast<std::string>();
-                std::string parameters = py::str(tool_obj.attr("parameters")).cast<std::string>();
-
-                // Allocate memory for strings
-                tool.name = strdup(name.c_str());
-                tool.description = strdup(description.c_str());
-                tool.parameters = strdup(parameters.c_str());
-
+                tool.name = strings.emplace_back(py::str(tool_obj.attr("name")).cast<std::string>()).c_str();
+                tool.description = strings.emplace_back(py::str(tool_obj.attr("description")).cast<std::string>()).c_str();
+                tool.parameters = strings.emplace_back(py::str(tool_obj.attr("parameters")).cast<std::string>()).c_str();
                 tool.is_streaming = tool_obj.attr("is_streaming").cast<bool>();
-
-                tools_cache_.push_back(tool);
+                tools.push_back(tool);
             }
 
+            // Moving the vectors keeps their elements in place
+            tool_strings_ = std::move(strings);
+            tools_cache_ = std::move(tools);
+            *count = static_cast<int>(tools_cache_.size());
             return tools_cache_.data();
         } catch (const py::error_already_set &e) {
             MCP_ERROR("[PLUGIN] Python error in get_tools: {}", e.what());
@@ -176,97 +395,187 @@ namespace mcp::business {
         }
     }
 
+    bool PythonPluginInstance::is_streaming_tool(const char *name) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        return std::any_of(tools_cache_.begin(), tools_cache_.end(), [name](const ToolInfo &tool) {
+            return tool.is_streaming && strcmp(tool.name, name) == 0;
+        });
+    }
+
     const char *PythonPluginInstance::call_tool(const char *name, const char *args_json, MCPError *error) {
         MCP_DEBUG("[PLUGIN] call_tool called, initialized={}", (initialized_ ? "true" : "false"));
 
         // 1. First check basic parameter validity (avoid hidden crashes caused by null pointers)
         if (!name || strlen(name) == 0) {
             MCP_ERROR("[PLUGIN] call_tool: ERROR - tool name is null/empty");
-            if (error) {
-                error->code = -1;
-                error->message = strdup("Invalid tool name");
-            }
+            set_plugin_error(error, -1, "Invalid tool name");
+            return nullptr;
+        }
+        std::string_view actual_args = args_json ? args_json : "{}";// Fallback to empty JSON
+
+        // Streams are driven in the main interpreter, by the plugin's event loop
+        if (is_streaming_tool(name)) {
+            return start_stream(name, actual_args, error);
+        }
+
+        std::string &result = result_buffer();
+        OutputArena arena{result};
+        MCPOutput output{&arena, 0, &OutputArena::write, &OutputArena::reserve, &OutputArena::commit};
+        if (!run_tool(name, actual_args, result, output, error)) {
+            return nullptr;
+        }
+        if (output.flags & MCP_OUTPUT_PASSTHROUGH) {
+            arena.finish();// A binary result was written through the arena, not appended
+        }
+        // ABI v1 hands the result over, free_result releases it
+        const char *copy = strdup(result.c_str());
+        release_result_buffer(result);
+        return copy;
+    }
+
+    int PythonPluginInstance::call_tool_v2(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error) {
+        if (!name || strlen(name) == 0) {
+            set_plugin_error(error, -1, "Invalid tool name");
+            return -1;
+        }
+        std::string_view actual_args = args_json.data ? std::string_view(args_json.data, args_json.size) : "{}";
+
+        std::string &result = result_buffer();
+        if (!run_tool(name, actual_args, result, *output, error)) {
+            return -1;
+        }
+        // A binary result is already in the output
+        bool written = (output->flags & MCP_OUTPUT_PASSTHROUGH) || output->write(output->context, result.data(), result.size());
+        release_result_buffer(result);
+        if (!written) {
+            set_plugin_error(error, -1, "Out of memory for the tool result");
+            return -1;
+        }
+        return 0;
+    }
+
+    const char *PythonPluginInstance::start_stream(const char *name, std::string_view args_json, MCPError *error) {
+        if (!initialized_ || !plugin_module_) {
+            set_plugin_error(error, -1, "Plugin not initialized");
+            return nullptr;
+        }
+        if (!streams_) {
+            MCP_ERROR("[PLUGIN] call_tool: ERROR - {} has no start_stream for streaming tool {}", module_name_, name);
+            set_plugin_error(error, -1, "Python module has no start_stream for streaming tools");
+            return nullptr;
+        }
+
+        try {
+            py::gil_scoped_acquire acquire;
+            // The result of a streaming tool is the generator the server reads it through
+            py::object args = json_loads_func_(py::str(args_json.data(), args_json.size()));
+            py::object source = start_stream_func_(py::str(name), args);
+            MCP_DEBUG("[PLUGIN] call_tool: stream of {} started", name);
+            return reinterpret_cast<const char *>(streams_->open(std::move(source)));
+        } catch (const py::error_already_set &e) {
+            MCP_ERROR("[PLUGIN] call_tool: PYTHON ERROR - {}", e.what());
+            set_plugin_error(error, -1, e.what());
             return nullptr;
+        } catch (const std::exception &e) {
+            MCP_ERROR("[PLUGIN] call_tool: C++ ERROR - {}: {}", typeid(e).name(), e.what());
+            set_plugin_error(error, -1, e.what());
+            return nullptr;
+        }
+    }
+
+    bool PythonPluginInstance::write_binary_result(const char *name, py::handle value, MCPOutput &output, MCPError *error) {
+        if (!write_python_blob_result(output, "python://" + module_name_ + "/" + name, value)) {
+            set_plugin_error(error, -1, "Out of memory for the tool result");
+            return false;
         }
-        const char *actual_args = args_json ? args_json : "{}";// Fallback to empty JSON
-        MCP_DEBUG("[PLUGIN] call_tool: tool name={}, args_json={}", name, actual_args);
+        return true;
+    }
+
+    bool PythonPluginInstance::run_tool(const char *name, std::string_view args_json, std::string &result, MCPOutput &output, MCPError *error) {
+        MCP_DEBUG("[PLUGIN] call_tool: tool name={}, args_json={}", name, args_json);
 
         if (!initialized_) {
             MCP_ERROR("[PLUGIN] call_tool: ERROR - plugin not initialized");
-            if (error) {
-                error->code = -1;
-                error->message = strdup("Plugin not initialized");
-            }
-            return nullptr;
+            set_plugin_error(error, -1, "Plugin not initialized");
+            return false;
         }
 
         // 2. Check if Python module is valid (exclude module not loaded)
         if (plugin_module_.is_none()) {
             MCP_ERROR("[PLUGIN] call_tool: ERROR - plugin_module_ is empty");
-            if (error) {
-                error->code = -1;
-                error->message = strdup("Plugin module not loaded");
-            }
-            return nullptr;
+            set_plugin_error(error, -1, "Plugin module not loaded");
+            return false;
         }
         MCP_DEBUG("[PLUGIN] call_tool: plugin_module_ is valid");
 
+        if (workers_) {
+            return workers_->call_tool(name, args_json, result, error);
+        }
+        if (interpreters_) {
+            return interpreters_->call_tool(name, args_json, result, error);
+        }
+
         try {
             // 3. Key: Acquire GIL (most likely blocking point)
-            MCP_DEBUG("[PLUGIN] call_tool: trying to acquire GIL...");
+            MCP_DEBUG("[PLUGIN] call_tool: acquiring GIL...");
             py::gil_scoped_acquire acquire;// Acquire GIL, will block on failure
             MCP_DEBUG("[PLUGIN] call_tool: GIL acquired successfully");
-
-            // 4. Find the call_tool function in Python layer (exclude function not exported)
-            MCP_DEBUG("[PLUGIN] call_tool: looking for 'call_tool' in Python module");
-            if (!py::hasattr(plugin_module_, "call_tool")) {
-                MCP_ERROR("[PLUGIN] call_tool: ERROR - Python module has no 'call_tool' function");
-                if (error) {
-                    error->code = -1;
-                    error->message = strdup("Python call_tool not found");
+            py::str args(args_json.data(), args_json.size());
+
+            // 4. A module with call_tool_object gets the arguments as Python objects and hands back
+            // its result as one: the arguments are decoded by the C scanner of json.loads, the
+            // result encoded here, about three times faster than json.dumps
+            if (call_tool_object_func_) {
+                py::object decoded;
+                try {
+                    decoded = json_loads_func_(args);
+                } catch (const py::error_already_set &) {
+                    // Arguments that aren't JSON are left to the module's call_tool to report
+                }
+                if (decoded) {
+                    py::object value = call_tool_object_func_(py::str(name), decoded);
+                    if (is_python_binary(value)) {
+                        return write_binary_result(name, value, output, error);
+                    }
+                    if (PyUnicode_Check(value.ptr())) {
+                        append_utf8(result, value);
+                    } else {
+                        append_python_json(result, value);
+                    }
+                    return true;
                 }
-                return nullptr;
             }
-            py::object call_tool_func = plugin_module_.attr("call_tool");
-            MCP_DEBUG("[PLUGIN] call_tool: got Python call_tool function");
 
-            // 5. Call Python function (if we reach this step, previous steps have no issues)
+            // 5. Call Python function
             MCP_DEBUG("[PLUGIN] call_tool: calling Python call_tool (name={})", name);
-            py::object result = call_tool_func(py::str(name), py::str(actual_args));
+            py::object value = call_tool_func_(py::str(name), args);
             MCP_DEBUG("[PLUGIN] call_tool: Python call_tool returned");
+            if (is_python_binary(value)) {
+                return write_binary_result(name, value, output, error);
+            }
 
             // 6. Process return result
-            std::string result_str = py::str(result).cast<std::string>();
-            MCP_DEBUG("[PLUGIN] call_tool: Python result={}", result_str);
-            const char *ret = strdup(result_str.c_str());
-            return ret;
+            append_utf8(result, PyUnicode_Check(value.ptr()) ? value : py::str(value));
+            MCP_DEBUG("[PLUGIN] call_tool: Python result={}", result);
+            return true;
 
         } catch (const py::error_already_set &e) {
             // Catch Python exceptions (e.g. JSON parsing errors, tool not found)
             MCP_ERROR("[PLUGIN] call_tool: PYTHON ERROR - {}", e.what());
 
             // MCP_ERROR("[PLUGIN] call_tool: PYTHON TRACEBACK - {}", e.trace());
-            if (error) {
-                error->code = -1;
-                error->message = strdup(e.what());
-            }
-            return nullptr;
+            set_plugin_error(error, -1, e.what());
+            return false;
         } catch (const std::exception &e) {
             // Catch C++ exceptions (e.g. memory allocation failure)
             MCP_ERROR("[PLUGIN] call_tool: C++ ERROR - {}: {}", typeid(e).name(), e.what());
-            if (error) {
-                error->code = -1;
-                error->message = strdup(e.what());
-            }
-            return nullptr;
+            set_plugin_error(error, -1, e.what());
+            return false;
         } catch (...) {
             // Catch unknown exceptions
             MCP_ERROR("[PLUGIN] call_tool: UNKNOWN ERROR");
-            if (error) {
-                error->code = -1;
-                error->message = strdup("Unknown error");
-            }
-            return nullptr;
+            set_plugin_error(error, -1, "Unknown error");
+            return false;
         }
     }
-}// namespace mcp::business
\ No newline at end of file
+}// namespace mcp::business
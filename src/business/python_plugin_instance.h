@@ -2,10 +2,17 @@
 #define PYTHON_PLUGIN_INSTANCE_H
 
 #include "mcp_plugin.h"
+#include "python_stream_loop.h"
+#include "python_subinterpreter_pool.h"
+#include "python_worker_pool.h"
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace mcp::business {
@@ -158,6 +165,32 @@ namespace mcp::business {
         std::string venv_path_;
     };
 
+    /**
+     * @brief Where Python plugins run their tool calls, set from the [python_environment] config
+     * section. Plugins are libraries of their own that never see the server's config, so the
+     * server passes these through MCP_PYTHON_* environment variables before it loads them.
+     */
+    struct PythonExecutionOptions {
+        std::size_t interpreters = 0;              ///< Sub-interpreters per plugin, 0 = the main interpreter
+        std::size_t workers = 0;                   ///< Worker processes per plugin, 0 = in process; wins over interpreters
+        std::string worker_executable = "python3"; ///< Interpreter the workers are started with
+        std::size_t worker_buffer_kb = 1024;       ///< Shared request and response area of each worker
+        std::size_t worker_max_calls = 0;          ///< Calls after which a worker is replaced, 0 = never
+        std::size_t worker_max_rss_mb = 0;         ///< Peak RSS at which a worker is replaced, 0 = never
+        std::string bytecode_cache_dir;            ///< sys.pycache_prefix, plugins are precompiled into it; empty = off
+        std::string preload_modules;               ///< Comma separated modules imported once the server listens
+
+        /**
+         * @brief Read the options the server exported.
+         */
+        static PythonExecutionOptions from_environment();
+
+        /**
+         * @brief Export the options for the plugins loaded afterwards.
+         */
+        void export_to_environment() const;
+    };
+
     class PythonPluginInstance {
     public:
         PythonPluginInstance();
@@ -166,18 +199,66 @@ namespace mcp::business {
         bool initialize(const char *plugin_path);
         void uninitialize();
 
+        /**
+         * @brief List the module's tools. The list is built on the first call and kept, so the
+         *        pointers already handed out stay valid until uninitialize().
+         */
         ToolInfo *get_tools(int *count);
+
+        /**
+         * @brief Start a stream for a streaming tool, or run any other tool (ABI v1).
+         * @return Generator, or result allocated with strdup; nullptr on error
+         */
         const char *call_tool(const char *name, const char *args_json, MCPError *error);
 
+        /**
+         * @brief Run a tool and write its result into the server's output (ABI v2).
+         * @return 0 on success, -1 with error filled in
+         */
+        int call_tool_v2(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error);
+
+        /**
+         * @brief Import the configured preload modules on a thread of their own, logging how long
+         *        each took. Called once the server listens, so they don't delay its start.
+         */
+        void warm_up();
+
     private:
         bool initialize_plugin_module();
+        void precompile_plugins();
+        bool is_streaming_tool(const char *name);
+        const char *start_stream(const char *name, std::string_view args_json, MCPError *error);
+
+        /**
+         * @brief Run a synchronous tool where it is configured to run.
+         * @param result Set to the result JSON
+         * @param output Gets a binary result (bytes, bytearray, memoryview) instead, written as
+         *        a complete result with MCP_OUTPUT_PASSTHROUGH set; result stays empty then
+         */
+        bool run_tool(const char *name, std::string_view args_json, std::string &result, MCPOutput &output, MCPError *error);
+
+        /**
+         * @brief Write the binary result of a tool to output, see write_python_blob_result(). Needs the GIL.
+         */
+        bool write_binary_result(const char *name, py::handle value, MCPOutput &output, MCPError *error);
 
         py::module_ plugin_module_;
+        py::object call_tool_func_;       ///< The module's call_tool(name, args_json)
+        py::object call_tool_object_func_;///< The module's call_tool_object(name, args), if it has one
+        py::object start_stream_func_;    ///< The module's start_stream(name, args), if it has one
+        py::object json_loads_func_;      ///< json.loads, decodes the arguments for call_tool_object and start_stream
         std::string plugin_dir_;
         std::string module_name_;
         std::vector<ToolInfo> tools_cache_;
+        std::vector<std::string> tool_strings_;///< Name, description and parameters of each tool in tools_cache_
         bool initialized_;
         std::mutex cache_mutex_;
+        std::unique_ptr<PythonSubinterpreterPool> interpreters_;///< Runs call_tool when sub-interpreters are enabled
+        std::unique_ptr<PythonWorkerPool> workers_;              ///< Runs call_tool when worker processes are enabled
+        std::unique_ptr<PythonStreamLoop> streams_;              ///< Drives streaming tools, in the main interpreter
+        PythonExecutionOptions execution_;
+        std::thread warm_up_thread_;
+        std::atomic<bool> stopping_{false};///< Ends the warm-up after the module it is importing
     };
 
 }// namespace mcp::business
@@ -0,0 +1,384 @@
+#include "python_stream_loop.h"
+#include "core/logger.h"
+#include "metrics/tracing.h"
+#include "protocol/json_rpc.h"
+#include "python_json.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <pybind11/eval.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+namespace mcp::business {
+
+    namespace {
+        // Commands for the loop, and what push() tells a task
+        constexpr int kRoom = 0;  ///< The server took an item from a full queue
+        constexpr int kCancel = 1;///< The server cancelled or freed the stream
+        constexpr int kStop = 2;  ///< The loop is to end
+
+        constexpr int kPushMore = 0;   ///< Go on producing
+        constexpr int kPushFull = 1;   ///< Wait for the server to take an item first
+        constexpr int kPushStopped = 2;///< The server no longer reads the stream
+
+        // The Python side: an event loop woken through a socket pair, and the tasks that drive the streams
+        constexpr const char *kDriverScript = R"PY(
+import asyncio
+import inspect
+import socket
+
+ROOM, CANCEL, STOP = 0, 1, 2
+MORE, FULL, STOPPED = 0, 1, 2
+
+
+class StreamLoop:
+    def __init__(self, take_commands):
+        self.loop = asyncio.SelectorEventLoop()
+        self.reader, self.writer = socket.socketpair()
+        self.reader.setblocking(False)
+        self.writer.setblocking(False)
+        self.take_commands = take_commands
+        self.streams = {}
+        self.loop.add_reader(self.reader.fileno(), self.drain)
+
+    def run(self):
+        try:
+            self.loop.run_forever()
+            tasks = [task for task, _ in self.streams.values()]
+            for task in tasks:
+                task.cancel()
+            if tasks:
+                self.loop.run_until_complete(asyncio.gather(*tasks, return_exceptions=True))
+            self.loop.run_until_complete(self.loop.shutdown_asyncgens())
+        finally:
+            self.loop.remove_reader(self.reader.fileno())
+            self.reader.close()
+            self.loop.close()
+
+    def drain(self):
+        try:
+            while self.reader.recv(4096):
+                pass
+        except (BlockingIOError, InterruptedError):
+            pass
+        for stream_id, command in self.take_commands():
+            if command == STOP:
+                self.loop.stop()
+                continue
+            entry = self.streams.get(stream_id)
+            if entry is None:
+                continue
+            task, room = entry
+            if command == ROOM:
+                room.set()
+            else:
+                task.cancel()
+
+    def open(self, stream_id, source, push, finish):
+        self.loop.call_soon_threadsafe(self.start, stream_id, source, push, finish)
+
+    def start(self, stream_id, source, push, finish):
+        room = asyncio.Event()
+        task = self.loop.create_task(self.drive(source, push, finish, room))
+        self.streams[stream_id] = (task, room)
+        task.add_done_callback(lambda _: self.streams.pop(stream_id, None))
+
+    async def put(self, item, push, room):
+        state = push(item)
+        if state == FULL:
+            room.clear()
+            await room.wait()
+        return state != STOPPED
+
+    async def drive(self, source, push, finish, room):
+        error = None
+        owner = source
+        try:
+            if hasattr(source, "__aiter__"):
+                async for item in source:
+                    if not await self.put(item, push, room):
+                        break
+            elif hasattr(source, "__iter__") and not isinstance(source, (str, bytes, dict)):
+                # Plain generators may block, they are stepped in a thread
+                iterator = iter(source)
+                end = object()
+                while True:
+                    item = await asyncio.to_thread(next, iterator, end)
+                    if item is end or not await self.put(item, push, room):
+                        break
+            else:
+                if inspect.isawaitable(source):
+                    source = await source
+                await self.put(source, push, room)
+        except asyncio.CancelledError:
+            pass
+        except Exception as e:
+            error = str(e) or type(e).__name__
+        finally:
+            try:
+                if hasattr(owner, "aclose"):
+                    await owner.aclose()
+                elif hasattr(owner, "close") and inspect.isgenerator(owner):
+                    owner.close()
+            except Exception:
+                pass
+            finish(error)
+)PY";
+
+#ifdef _WIN32
+        using Socket = SOCKET;
+        constexpr Socket kNoSocket = INVALID_SOCKET;
+#else
+        using Socket = int;
+        constexpr Socket kNoSocket = -1;
+#endif
+    }// namespace
+
+    struct PythonStreamLoop::Core {
+        std::mutex mutex;
+        std::vector<std::pair<std::uint64_t, int>> commands;
+        Socket writer = kNoSocket;///< Write end of the loop's socket pair, owned by the Python side
+        std::uint64_t next_id = 1;
+
+        /**
+         * @brief Queue a command and wake the loop if it isn't about to look at the queue anyway.
+         *        Does nothing once the loop has ended.
+         */
+        void post(std::uint64_t stream, int command) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (writer == kNoSocket) {
+                return;
+            }
+            bool wake = commands.empty();
+            commands.emplace_back(stream, command);
+            if (wake) {
+                // Non-blocking; if the socket is full, the loop has a wakeup pending already
+                char byte = 0;
+#if defined(_WIN32)
+                ::send(writer, &byte, 1, 0);
+#elif defined(MSG_NOSIGNAL)
+                ::send(writer, &byte, 1, MSG_NOSIGNAL);
+#else
+                ::send(writer, &byte, 1, 0);
+#endif
+            }
+        }
+    };
+
+    struct PythonStreamLoop::Stream {
+        std::shared_ptr<Core> core;
+        std::uint64_t id = 0;
+        std::size_t capacity = 0;
+
+        std::mutex mutex;
+        std::deque<std::string> items;
+        std::string current;///< Item handed out by the last next(), valid until the next call
+        std::string error;
+        bool done = false;
+        bool failed = false;
+        bool cancelled = false;
+        bool paused = false;///< The task waits for the server to take an item
+        MCPStreamWakeup wakeup = nullptr;
+        void *wakeup_context = nullptr;
+
+        /**
+         * @brief Tell a waiting server that next() has something. Called with the mutex held, so
+         *        the wakeup can't outlive free().
+         */
+        void wake() {
+            if (wakeup) {
+                auto function = std::exchange(wakeup, nullptr);
+                function(wakeup_context);
+            }
+        }
+    };
+
+    PythonStreamLoop::PythonStreamLoop(std::size_t queue_items)
+        : queue_items_(queue_items > 0 ? queue_items : 1), core_(std::make_shared<Core>()) {
+    }
+
+    PythonStreamLoop::~PythonStreamLoop() {
+        stop();
+    }
+
+    PythonStreamLoop::Stream &PythonStreamLoop::stream_of(StreamGenerator generator) {
+        return **static_cast<std::shared_ptr<Stream> *>(generator);
+    }
+
+    void PythonStreamLoop::start() {
+        py::dict scope;
+        scope["__builtins__"] = py::module_::import("builtins");
+        py::exec(kDriverScript, scope);
+
+        auto core = core_;
+        py::cpp_function take_commands([core]() {
+            std::vector<std::pair<std::uint64_t, int>> commands;
+            {
+                std::lock_guard<std::mutex> lock(core->mutex);
+                commands.swap(core->commands);
+            }
+            py::list list;
+            for (const auto &[stream, command]: commands) {
+                list.append(py::make_tuple(stream, command));
+            }
+            return list;
+        });
+        py::object driver = scope["StreamLoop"](take_commands);
+        {
+            std::lock_guard<std::mutex> lock(core_->mutex);
+            core_->writer = static_cast<Socket>(driver.attr("writer").attr("fileno")().cast<long long>());
+        }
+
+        // The thread takes the GIL once this one lets go of it, driver_ is set by then
+        thread_ = std::thread([this]() {
+            py::gil_scoped_acquire acquire;
+            try {
+                driver_.attr("run")();
+            } catch (const py::error_already_set &e) {
+                MCP_ERROR("[PLUGIN] Python stream loop failed: {}", e.what());
+            }
+            {
+                std::lock_guard<std::mutex> lock(core_->mutex);
+                core_->writer = kNoSocket;
+            }
+            try {
+                driver_.attr("writer").attr("close")();
+            } catch (const py::error_already_set &e) {
+                MCP_WARN("[PLUGIN] Failed to close the Python stream loop: {}", e.what());
+            }
+            driver_ = py::object();
+        });
+        driver_ = std::move(driver);
+        MCP_DEBUG("[PLUGIN] Python stream loop started");
+    }
+
+    StreamGenerator PythonStreamLoop::open(py::object source) {
+        if (!thread_.joinable()) {
+            start();
+        }
+        if (!driver_) {
+            throw std::runtime_error("The stream loop of this plugin has ended");
+        }
+
+        auto stream = std::make_shared<Stream>();
+        stream->core = core_;
+        stream->capacity = queue_items_;
+        {
+            std::lock_guard<std::mutex> lock(core_->mutex);
+            stream->id = core_->next_id++;
+        }
+
+        py::cpp_function push([stream](py::handle item) {
+            std::string text = "{\"result\":";
+            append_python_json(text, item);
+            text += '}';
+
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            if (stream->cancelled) {
+                return kPushStopped;
+            }
+            stream->items.push_back(std::move(text));
+            stream->wake();
+            if (stream->items.size() >= stream->capacity) {
+                stream->paused = true;
+                return kPushFull;
+            }
+            return kPushMore;
+        });
+        py::cpp_function finish([stream](py::object error) {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            stream->done = true;
+            if (!error.is_none()) {
+                stream->failed = true;
+                stream->error = error.cast<std::string>();
+            }
+            stream->wake();
+        });
+        driver_.attr("open")(stream->id, std::move(source), push, finish);
+        return new std::shared_ptr<Stream>(std::move(stream));
+    }
+
+    void PythonStreamLoop::stop() {
+        if (!thread_.joinable()) {
+            return;
+        }
+        core_->post(0, kStop);
+        thread_.join();
+        MCP_DEBUG("[PLUGIN] Python stream loop stopped");
+    }
+
+    int PythonStreamLoop::next(StreamGenerator generator, const char **result_json, MCPError * /*error*/) {
+        *result_json = nullptr;
+        if (!generator) {
+            return 1;
+        }
+        auto &stream = stream_of(generator);
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        if (!stream.items.empty()) {
+            stream.current = std::move(stream.items.front());
+            stream.items.pop_front();
+            if (stream.paused) {
+                stream.paused = false;
+                stream.core->post(stream.id, kRoom);
+            }
+            *result_json = stream.current.c_str();
+            return 0;
+        }
+        if (!stream.done) {
+            return MCP_STREAM_WOULD_BLOCK;
+        }
+        if (stream.failed) {
+            stream.current = "{\"error\":{\"code\":" + std::to_string(protocol::error_code::INTERNAL_ERROR) + ",\"message\":";
+            mcp::metrics::append_json_string(stream.current, stream.error);
+            stream.current += "}}";
+            *result_json = stream.current.c_str();
+            return -1;
+        }
+        return 1;
+    }
+
+    int PythonStreamLoop::wait(StreamGenerator generator, MCPStreamWakeup wakeup, void *context) {
+        auto &stream = stream_of(generator);
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        stream.wakeup = wakeup;
+        stream.wakeup_context = context;
+        if (!stream.items.empty() || stream.done) {
+            stream.wake();
+        }
+        return -1;
+    }
+
+    void PythonStreamLoop::cancel(StreamGenerator generator) {
+        auto &stream = stream_of(generator);
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        if (!stream.cancelled) {
+            stream.cancelled = true;
+            if (!stream.done) {
+                stream.core->post(stream.id, kCancel);
+            }
+        }
+    }
+
+    void PythonStreamLoop::free(StreamGenerator generator) {
+        if (!generator) {
+            return;
+        }
+        cancel(generator);
+        {
+            auto &stream = stream_of(generator);
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.wakeup = nullptr;
+        }
+        // The task holds its own reference until it has finished
+        delete static_cast<std::shared_ptr<Stream> *>(generator);
+    }
+
+}// namespace mcp::business
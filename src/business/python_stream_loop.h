@@ -0,0 +1,66 @@
+#pragma once
+
+#include "mcp_plugin.h"
+#include <cstddef>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <thread>
+
+namespace mcp::business {
+
+    namespace py = pybind11;
+
+    /**
+     * @brief Drives the streaming tools of one Python plugin on an asyncio event loop.
+     *
+     * The loop runs on a thread of its own, started with the first stream. Each stream is a task
+     * on it: async generators are iterated on the loop, plain generators one item at a time in
+     * its default executor, so a tool that waits doesn't hold up the others. Items go into a
+     * bounded queue per stream that the server reads through the non-blocking stream interface
+     * (MCP_STREAM_WOULD_BLOCK and wait()); a task whose queue is full waits until the server has
+     * taken an item. next(), wait(), cancel() and free() never take the GIL: they signal the loop
+     * through a socket pair, so the event loop of the server never waits for Python.
+     */
+    class PythonStreamLoop {
+    public:
+        /**
+         * @param queue_items Items a stream may produce ahead of the server before it is paused
+         */
+        explicit PythonStreamLoop(std::size_t queue_items = 32);
+        ~PythonStreamLoop();
+
+        PythonStreamLoop(const PythonStreamLoop &) = delete;
+        PythonStreamLoop &operator=(const PythonStreamLoop &) = delete;
+
+        /**
+         * @brief Start driving what a streaming tool returned. Needs the GIL.
+         * @param source Async generator, iterable, awaitable or single value of the tool
+         * @return Generator to hand to the server, for the functions below
+         */
+        StreamGenerator open(py::object source);
+
+        /**
+         * @brief Cancel the running streams and end the loop thread. Call without the GIL;
+         *        generators still held by the server report the end of their stream.
+         */
+        void stop();
+
+        static int next(StreamGenerator generator, const char **result_json, MCPError *error);
+        static int wait(StreamGenerator generator, MCPStreamWakeup wakeup, void *context);
+        static void cancel(StreamGenerator generator);
+        static void free(StreamGenerator generator);
+
+    private:
+        struct Core;
+        struct Stream;
+
+        void start();
+        static Stream &stream_of(StreamGenerator generator);
+
+        const std::size_t queue_items_;
+        std::shared_ptr<Core> core_;///< Shared with the streams, which signal the loop through it
+        py::object driver_;         ///< The Python side of the loop, released by its thread when it ends
+        std::thread thread_;
+    };
+
+}// namespace mcp::business
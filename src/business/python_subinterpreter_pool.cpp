@@ -0,0 +1,231 @@
+#include "python_subinterpreter_pool.h"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include "plugin_error.h"
+#include <cstring>
+
+// Include Python.h after the standard headers to avoid conflicts
+#include <Python.h>
+
+namespace mcp::business {
+
+    namespace {
+#if PY_VERSION_HEX >= 0x030C0000
+        /**
+         * @brief Take the raised exception as "Type: message". Needs the GIL.
+         */
+        std::string take_error() {
+            PyObject *exception = PyErr_GetRaisedException();
+            if (!exception) {
+                return "Unknown Python error";
+            }
+            std::string message = Py_TYPE(exception)->tp_name;
+            if (PyObject *text = PyObject_Str(exception)) {
+                const char *utf8 = PyUnicode_AsUTF8(text);
+                if (utf8 && *utf8) {
+                    message += ": ";
+                    message += utf8;
+                }
+                Py_DECREF(text);
+            }
+            PyErr_Clear();
+            Py_DECREF(exception);
+            return message;
+        }
+
+        /**
+         * @brief Import the plugin module into the current interpreter. Needs its GIL.
+         * @return New reference to the module's call_tool, nullptr with error set on failure
+         */
+        PyObject *load_call_tool(const std::string &module_name, const std::vector<std::string> &paths, std::string &error) {
+            PyObject *sys_path = PySys_GetObject("path");// Borrowed
+            for (const auto &path: paths) {
+                PyObject *entry = PyUnicode_FromString(path.c_str());
+                if (!entry || !sys_path || PyList_Append(sys_path, entry) != 0) {
+                    Py_XDECREF(entry);
+                    error = take_error();
+                    return nullptr;
+                }
+                Py_DECREF(entry);
+            }
+
+            PyObject *module = PyImport_ImportModule(module_name.c_str());
+            if (!module) {
+                error = take_error();
+                return nullptr;
+            }
+            PyObject *call_tool = PyObject_GetAttrString(module, "call_tool");
+            Py_DECREF(module);
+            if (!call_tool) {
+                error = take_error();
+            }
+            return call_tool;
+        }
+
+        /**
+         * @brief Call call_tool(name, args_json) and convert its result to a string. Needs the GIL.
+         */
+        std::pair<bool, std::string> invoke(PyObject *call_tool, const std::string &name, const std::string &args_json) {
+            PyObject *result = PyObject_CallFunction(call_tool, "ss", name.c_str(), args_json.c_str());
+            if (!result) {
+                return {false, take_error()};
+            }
+            PyObject *text = PyObject_Str(result);
+            Py_DECREF(result);
+            if (!text) {
+                return {false, take_error()};
+            }
+            Py_ssize_t size = 0;
+            const char *utf8 = PyUnicode_AsUTF8AndSize(text, &size);
+            std::pair<bool, std::string> converted = utf8 ? std::pair<bool, std::string>{true, std::string(utf8, static_cast<std::size_t>(size))}
+                                                          : std::pair<bool, std::string>{false, take_error()};
+            Py_DECREF(text);
+            return converted;
+        }
+#endif
+    }// namespace
+
+    PythonSubinterpreterPool::PythonSubinterpreterPool(std::string module_name, std::vector<std::string> paths, std::size_t workers)
+        : module_name_(std::move(module_name)), paths_(std::move(paths)), workers_(workers) {}
+
+    PythonSubinterpreterPool::~PythonSubinterpreterPool() {
+        stop();
+    }
+
+    bool PythonSubinterpreterPool::supported() {
+        return PY_VERSION_HEX >= 0x030C0000;
+    }
+
+    bool PythonSubinterpreterPool::start() {
+        if (!supported()) {
+            MCP_WARN("[PYTHON] Sub-interpreters with their own GIL need Python 3.12 or later, {} runs in the main interpreter", module_name_);
+            return false;
+        }
+        threads_.reserve(workers_);
+        for (std::size_t i = 0; i < workers_; ++i) {
+            // Interpreters are created one after the other, the first failure ends the pool
+            std::promise<bool> ready;
+            auto started = ready.get_future();
+            threads_.emplace_back([this, i, ready = std::move(ready)]() mutable {
+                AsioIOServicePool::SetupCurrentThread("mcp-py-" + std::to_string(i), -1);
+                run(ready);
+            });
+            if (!started.get()) {
+                stop();
+                return false;
+            }
+        }
+        MCP_INFO("[PYTHON] Running {} in {} sub-interpreters", module_name_, workers_);
+        return true;
+    }
+
+    void PythonSubinterpreterPool::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto &thread: threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        threads_.clear();
+    }
+
+    bool PythonSubinterpreterPool::call_tool(const char *name, std::string_view args_json, std::string &result, MCPError *error) {
+        auto call = std::make_shared<Call>();
+        call->name = name;
+        call->args_json = args_json;
+        auto answer = call->result.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || threads_.empty()) {
+                set_plugin_error(error, -1, "Python interpreters not running");
+                return false;
+            }
+            calls_.push_back(std::move(call));
+        }
+        wake_.notify_one();
+
+        auto [ok, text] = answer.get();
+        if (!ok) {
+            MCP_ERROR("[PLUGIN] call_tool: PYTHON ERROR - {}", text);
+            set_plugin_error(error, -1, text);
+            return false;
+        }
+        result = std::move(text);
+        return true;
+    }
+
+    void PythonSubinterpreterPool::run([[maybe_unused]] std::promise<bool> &ready) {
+#if PY_VERSION_HEX >= 0x030C0000
+        // The sub-interpreter is created from a thread state of the main interpreter
+        PyThreadState *main_state = PyThreadState_New(PyInterpreterState_Main());
+        PyEval_RestoreThread(main_state);
+
+        PyInterpreterConfig config = {};
+        config.use_main_obmalloc = 0;
+        config.allow_fork = 0;
+        config.allow_exec = 0;
+        config.allow_threads = 1;
+        config.allow_daemon_threads = 0;
+        config.check_multi_interp_extensions = 1;
+        config.gil = PyInterpreterConfig_OWN_GIL;
+
+        PyThreadState *state = nullptr;
+        PyStatus status = Py_NewInterpreterFromConfig(&state, &config);
+        if (PyStatus_Exception(status)) {
+            MCP_ERROR("[PYTHON] Cannot create a sub-interpreter for {}: {}", module_name_, status.err_msg ? status.err_msg : "unknown error");
+            PyThreadState_Clear(main_state);
+            PyThreadState_DeleteCurrent();
+            ready.set_value(false);
+            return;
+        }
+
+        // From here this thread holds the sub-interpreter's own GIL, the main one is released
+        std::string error;
+        PyObject *call_tool = load_call_tool(module_name_, paths_, error);
+        if (!call_tool) {
+            MCP_ERROR("[PYTHON] Cannot import {} into a sub-interpreter: {}", module_name_, error);
+            Py_EndInterpreter(state);
+            PyEval_RestoreThread(main_state);
+            PyThreadState_Clear(main_state);
+            PyThreadState_DeleteCurrent();
+            ready.set_value(false);
+            return;
+        }
+        ready.set_value(true);
+
+        // The GIL is only held while a call runs, so threads the plugin started can run meanwhile
+        PyThreadState *saved = PyEval_SaveThread();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stopping_ || !calls_.empty(); });
+            if (calls_.empty()) {
+                break;// Stopping, and every queued call was answered
+            }
+            auto call = std::move(calls_.front());
+            calls_.pop_front();
+            lock.unlock();
+
+            PyEval_RestoreThread(saved);
+            call->result.set_value(invoke(call_tool, call->name, call->args_json));
+            saved = PyEval_SaveThread();
+
+            lock.lock();
+        }
+        lock.unlock();
+
+        PyEval_RestoreThread(saved);
+        Py_DECREF(call_tool);
+        Py_EndInterpreter(state);
+        PyEval_RestoreThread(main_state);
+        PyThreadState_Clear(main_state);
+        PyThreadState_DeleteCurrent();
+#else
+        ready.set_value(false);
+#endif
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "mcp_plugin.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Runs the tool calls of one Python plugin in sub-interpreters with their own GIL.
+     *
+     * Each worker thread creates a sub-interpreter with a GIL of its own (PEP 684, Python 3.12
+     * and later), imports the plugin module into it and then takes calls from a queue shared by
+     * all workers, so a call is picked up by the next idle interpreter and calls of one plugin,
+     * and of different plugins, run on as many cores as there are workers. A worker holds its
+     * GIL only while it runs a call.
+     *
+     * The interpreters share no Python objects: module state, caches and globals exist once per
+     * worker. Extension modules that don't support multi-phase initialization can't be imported
+     * into a sub-interpreter; start() then fails and the plugin keeps using the main interpreter.
+     */
+    class PythonSubinterpreterPool {
+    public:
+        /**
+         * @param module_name Plugin module to import into every interpreter
+         * @param paths Directories added to each interpreter's sys.path first
+         * @param workers Interpreters to create
+         */
+        PythonSubinterpreterPool(std::string module_name, std::vector<std::string> paths, std::size_t workers);
+        ~PythonSubinterpreterPool();
+
+        PythonSubinterpreterPool(const PythonSubinterpreterPool &) = delete;
+        PythonSubinterpreterPool &operator=(const PythonSubinterpreterPool &) = delete;
+
+        /**
+         * @brief Whether this build's Python has per-interpreter GILs.
+         */
+        static bool supported();
+
+        /**
+         * @brief Create the interpreters and import the module into each. Call with the main
+         *        interpreter's GIL released.
+         * @return false if any interpreter failed; none are left running then
+         */
+        bool start();
+
+        /**
+         * @brief Run call_tool of the plugin module in the next idle interpreter, blocking until
+         *        it returns.
+         * @param result Set to the result
+         * @return false with error filled in if the call failed
+         */
+        bool call_tool(const char *name, std::string_view args_json, std::string &result, MCPError *error);
+
+        std::size_t size() const { return threads_.size(); }
+
+    private:
+        struct Call {
+            std::string name;
+            std::string args_json;
+            std::promise<std::pair<bool, std::string>> result;///< Success and the result or error message
+        };
+
+        void run(std::promise<bool> &ready);
+        void stop();
+
+        const std::string module_name_;
+        const std::vector<std::string> paths_;
+        const std::size_t workers_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::deque<std::shared_ptr<Call>> calls_;
+        bool stopping_ = false;
+        std::vector<std::thread> threads_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,442 @@
+#include "python_worker_pool.h"
+#include "core/logger.h"
+#include "plugin_error.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+namespace mcp::business {
+
+    namespace {
+        constexpr std::size_t kHeaderBytes = 64;               ///< Control block at the start of the region
+        constexpr std::size_t kMinBufferBytes = 4096;          ///< Smallest request and response area
+        constexpr auto kRetireGrace = std::chrono::seconds(1);///< Time a retiring worker gets to exit
+
+        /**
+         * @brief Start of a worker's region; the request area follows, then the response area.
+         *
+         * Fields are only read after the other side signalled and written before signalling, the
+         * eventfd read and write order them. The worker loop below packs the same layout.
+         */
+        struct ControlBlock {
+            uint32_t request_size;   ///< Bytes of the request chunk in the request area
+            uint32_t request_more;   ///< More request chunks follow
+            uint32_t response_size;  ///< Bytes of the reply chunk in the response area
+            uint32_t response_more;  ///< More reply chunks follow
+            uint32_t response_status;///< 0 for a result, 1 for an error message
+            uint32_t retiring;       ///< The worker exits after this reply
+        };
+        static_assert(sizeof(ControlBlock) <= kHeaderBytes);
+
+        /**
+         * Worker loop, run with `python -c`. argv: region fd, request eventfd, response eventfd,
+         * area size, plugin directory, module, max calls, max RSS in MiB. Descriptor 6, the
+         * write end of the server's life pipe, is only held open. A request is the 4-byte length
+         * of the tool name, the name and the arguments.
+         */
+        constexpr const char *kWorkerScript = R"PY(
+import mmap, os, resource, signal, struct, sys
+signal.signal(signal.SIGINT, signal.SIG_IGN)
+region_fd, request_fd, response_fd, capacity = (int(value) for value in sys.argv[1:5])
+plugin_dir, module_name = sys.argv[5], sys.argv[6]
+max_calls, max_rss_mb = int(sys.argv[7]), int(sys.argv[8])
+HEADER = 64
+region = mmap.mmap(region_fd, HEADER + 2 * capacity)
+responses = HEADER + capacity
+
+def wait():
+    os.read(request_fd, 8)
+
+def notify():
+    os.write(response_fd, (1).to_bytes(8, sys.byteorder))
+
+def reply(status, payload, retiring):
+    offset = 0
+    while True:
+        chunk = payload[offset:offset + capacity]
+        offset += len(chunk)
+        more = offset < len(payload)
+        region[responses:responses + len(chunk)] = chunk
+        struct.pack_into("=IIII", region, 8, len(chunk), more, status, retiring)
+        notify()
+        if not more:
+            return
+        wait()
+
+try:
+    sys.path.append(plugin_dir)
+    module = __import__(module_name)
+    call_tool = module.call_tool
+except BaseException as e:
+    reply(1, f"{type(e).__name__}: {e}".encode(), 1)
+    sys.exit(1)
+reply(0, b"", 0)
+
+calls = 0
+while True:
+    request = bytearray()
+    while True:
+        wait()
+        size, more = struct.unpack_from("=II", region, 0)
+        request += region[HEADER:HEADER + size]
+        if not more:
+            break
+        notify()
+    name_size = int.from_bytes(request[:4], sys.byteorder)
+    name = request[4:4 + name_size].decode()
+    try:
+        status, payload = 0, str(call_tool(name, request[4 + name_size:].decode())).encode()
+    except Exception as e:
+        status, payload = 1, f"{type(e).__name__}: {e}".encode()
+    calls += 1
+    retiring = (max_calls > 0 and calls >= max_calls) or \
+               (max_rss_mb > 0 and resource.getrusage(resource.RUSAGE_SELF).ru_maxrss >= max_rss_mb * 1024)
+    reply(status, payload, int(retiring))
+    if retiring:
+        break
+)PY";
+    }// namespace
+
+    struct PythonWorkerPool::Worker {
+        std::size_t index = 0;
+        int pid = -1;
+        int request_fd = -1; ///< eventfd the server signals
+        int response_fd = -1;///< eventfd the worker signals
+        int life_fd = -1;    ///< Read end of a pipe only the worker holds the write end of; hangs up when it exits
+        char *region = nullptr;
+        std::size_t capacity = 0;///< Size of each area
+        uint64_t calls = 0;      ///< Calls served by the current process
+
+        bool alive() const { return pid > 0; }
+        ControlBlock *control() const { return reinterpret_cast<ControlBlock *>(region); }
+        char *request_area() const { return region + kHeaderBytes; }
+        char *response_area() const { return region + kHeaderBytes + capacity; }
+    };
+
+    PythonWorkerPool::PythonWorkerPool(Options options) : options_(std::move(options)) {}
+
+    PythonWorkerPool::~PythonWorkerPool() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+        idle_.notify_all();
+        // Calls in progress finish first
+        idle_.wait(lock, [this]() { return free_.size() == workers_.size(); });
+        for (auto &worker: workers_) {
+            terminate(*worker, true);
+        }
+    }
+
+    bool PythonWorkerPool::supported() {
+#if defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool PythonWorkerPool::start() {
+        if (!supported()) {
+            MCP_WARN("[PYTHON] Worker processes need Linux, {} runs in process", options_.module_name);
+            return false;
+        }
+        for (std::size_t i = 0; i < options_.workers; ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->index = i;
+            std::string error;
+            if (!spawn(*worker, error)) {
+                MCP_ERROR("[PYTHON] Cannot start worker {} of {}: {}", i, options_.module_name, error);
+                for (auto &started: workers_) {
+                    terminate(*started, true);
+                }
+                workers_.clear();
+                return false;
+            }
+            workers_.push_back(std::move(worker));
+        }
+        for (auto &worker: workers_) {
+            free_.push_back(worker.get());
+        }
+        MCP_INFO("[PYTHON] Running {} in {} worker processes", options_.module_name, workers_.size());
+        return true;
+    }
+
+    bool PythonWorkerPool::call_tool(const char *name, std::string_view args_json, std::string &result, MCPError *error) {
+        auto name_size = static_cast<uint32_t>(std::strlen(name));
+        std::string request(reinterpret_cast<const char *>(&name_size), sizeof(name_size));
+        request += name;
+        request += args_json;
+
+        Worker *worker = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this]() { return stopping_ || !free_.empty() || workers_.empty(); });
+            if (stopping_ || free_.empty()) {
+                set_plugin_error(error, -1, "Python workers stopped");
+                return false;
+            }
+            worker = free_.back();
+            free_.pop_back();
+        }
+
+        // A worker that died or retired on an earlier call is started again by the next one
+        std::string failure;
+        uint32_t status = 0;
+        std::string reply;
+        bool retiring = false;
+        bool answered = false;
+        if (!worker->alive() && !spawn(*worker, failure)) {
+            failure = "Python worker unavailable: " + failure;
+        } else if (exchange(*worker, request, status, reply, retiring, failure)) {
+            answered = true;
+            ++worker->calls;
+            if (retiring) {
+                MCP_INFO("[PYTHON] Worker {} of {} retires after {} calls", worker->index, options_.module_name, worker->calls);
+                terminate(*worker, false);
+            }
+        } else {
+            MCP_WARN("[PYTHON] Worker {} of {} failed: {}", worker->index, options_.module_name, failure);
+            terminate(*worker, true);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(worker);
+        }
+        idle_.notify_all();
+
+        if (!answered) {
+            set_plugin_error(error, -1, failure);
+            return false;
+        }
+        if (status != 0) {
+            MCP_ERROR("[PLUGIN] call_tool: PYTHON ERROR - {}", reply);
+            set_plugin_error(error, -1, reply);
+            return false;
+        }
+        result = std::move(reply);
+        return true;
+    }
+
+#if defined(__linux__)
+    namespace {
+        void notify(int fd) {
+            uint64_t one = 1;
+            while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+        }
+
+        /**
+         * @brief Wait for a worker to signal, or to exit.
+         */
+        bool wait_signal(int response_fd, int life_fd, int timeout_ms, std::string &error) {
+            pollfd fds[2] = {{response_fd, POLLIN, 0}, {life_fd, POLLIN, 0}};
+            while (true) {
+                int ready = poll(fds, 2, timeout_ms);
+                if (ready < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (ready < 0) {
+                    error = std::strerror(errno);
+                    return false;
+                }
+                if (ready == 0) {
+                    error = "Python worker did not answer in time";
+                    return false;
+                }
+                // A final reply and the exit can arrive together, the reply is read first
+                if (fds[0].revents & POLLIN) {
+                    uint64_t value;
+                    while (read(response_fd, &value, sizeof(value)) < 0 && errno == EINTR) {}
+                    return true;
+                }
+                error = "Python worker exited";
+                return false;
+            }
+        }
+    }// namespace
+
+    bool PythonWorkerPool::spawn(Worker &worker, std::string &error) {
+        worker.capacity = std::max(options_.buffer_bytes, kMinBufferBytes);
+        const std::size_t region_size = kHeaderBytes + 2 * worker.capacity;
+        worker.calls = 0;
+
+        int region_fd = memfd_create("mcp-py-worker", MFD_CLOEXEC);
+        int life[2] = {-1, -1};
+        worker.request_fd = eventfd(0, EFD_CLOEXEC);
+        worker.response_fd = eventfd(0, EFD_CLOEXEC);
+        if (region_fd < 0 || worker.request_fd < 0 || worker.response_fd < 0 || pipe2(life, O_CLOEXEC) != 0 ||
+            ftruncate(region_fd, static_cast<off_t>(region_size)) != 0) {
+            error = std::string("cannot create the shared region: ") + std::strerror(errno);
+            if (region_fd >= 0) close(region_fd);
+            if (life[0] >= 0) close(life[0]);
+            if (life[1] >= 0) close(life[1]);
+            terminate(worker, true);
+            return false;
+        }
+        void *region = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, region_fd, 0);
+        if (region == MAP_FAILED) {
+            error = std::string("cannot map the shared region: ") + std::strerror(errno);
+            close(region_fd);
+            close(life[0]);
+            close(life[1]);
+            terminate(worker, true);
+            return false;
+        }
+        worker.region = static_cast<char *>(region);
+        worker.life_fd = life[0];
+
+        // The worker gets its descriptors as 3 to 6; they are moved above that range first, so
+        // one dup2 can't overwrite the source of another
+        int sources[4] = {region_fd, worker.request_fd, worker.response_fd, life[1]};
+        int moved[4];
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        for (int i = 0; i < 4; ++i) {
+            moved[i] = fcntl(sources[i], F_DUPFD_CLOEXEC, 10);
+            posix_spawn_file_actions_adddup2(&actions, moved[i], 3 + i);
+        }
+
+        std::vector<std::string> args = {options_.executable, "-c", kWorkerScript, "3", "4", "5",
+                                         std::to_string(worker.capacity), options_.plugin_dir, options_.module_name,
+                                         std::to_string(options_.max_calls), std::to_string(options_.max_rss_mb)};
+        if (!options_.pycache_prefix.empty()) {
+            args.insert(args.begin() + 1, {"-X", "pycache_prefix=" + options_.pycache_prefix});
+        }
+        std::vector<char *> argv;
+        for (auto &arg: args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        pid_t pid = -1;
+        int rc = std::any_of(std::begin(moved), std::end(moved), [](int fd) { return fd < 0; })
+                         ? errno
+                         : posix_spawnp(&pid, options_.executable.c_str(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        for (int fd: moved) {
+            if (fd >= 0) close(fd);
+        }
+        close(region_fd);// The mapping keeps the region alive
+        close(life[1]);
+        if (rc != 0) {
+            error = "cannot start " + options_.executable + ": " + std::strerror(rc);
+            terminate(worker, true);
+            return false;
+        }
+        worker.pid = pid;
+
+        // The worker replies once it has imported the module
+        uint32_t status = 0;
+        std::string reply;
+        bool retiring = false;
+        if (!receive(worker, static_cast<int>(options_.start_timeout.count()), status, reply, retiring, error)) {
+            terminate(worker, true);
+            return false;
+        }
+        if (status != 0) {
+            error = reply;
+            terminate(worker, false);
+            return false;
+        }
+        return true;
+    }
+
+    void PythonWorkerPool::terminate(Worker &worker, bool kill) {
+        if (worker.pid > 0) {
+            if (!kill && worker.life_fd >= 0) {
+                pollfd exited{worker.life_fd, POLLIN, 0};
+                poll(&exited, 1, static_cast<int>(std::chrono::milliseconds(kRetireGrace).count()));
+            }
+            ::kill(worker.pid, SIGKILL);// Harmless once it exited, it is reaped below
+            while (waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {}
+            worker.pid = -1;
+        }
+        if (worker.region) {
+            munmap(worker.region, kHeaderBytes + 2 * worker.capacity);
+            worker.region = nullptr;
+        }
+        for (int *fd: {&worker.request_fd, &worker.response_fd, &worker.life_fd}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    bool PythonWorkerPool::exchange(Worker &worker, std::string_view request, uint32_t &status, std::string &reply,
+                                    bool &retiring, std::string &error) {
+        auto *control = worker.control();
+        std::size_t offset = 0;
+        while (true) {
+            std::size_t chunk = std::min(worker.capacity, request.size() - offset);
+            std::memcpy(worker.request_area(), request.data() + offset, chunk);
+            offset += chunk;
+            bool more = offset < request.size();
+            control->request_size = static_cast<uint32_t>(chunk);
+            control->request_more = more ? 1 : 0;
+            notify(worker.request_fd);
+            if (!more) {
+                break;
+            }
+            // The worker acknowledges each chunk before the area is reused
+            if (!wait_signal(worker.response_fd, worker.life_fd, -1, error)) {
+                return false;
+            }
+        }
+        return receive(worker, -1, status, reply, retiring, error);
+    }
+
+    bool PythonWorkerPool::receive(Worker &worker, int timeout_ms, uint32_t &status, std::string &reply, bool &retiring,
+                                   std::string &error) {
+        auto *control = worker.control();
+        reply.clear();
+        while (true) {
+            if (!wait_signal(worker.response_fd, worker.life_fd, timeout_ms, error)) {
+                return false;
+            }
+            std::size_t size = control->response_size;
+            if (size > worker.capacity) {
+                error = "Python worker sent a malformed reply";
+                return false;
+            }
+            reply.append(worker.response_area(), size);
+            status = control->response_status;
+            retiring = control->retiring != 0;
+            if (!control->response_more) {
+                return true;
+            }
+            notify(worker.request_fd);
+        }
+    }
+#else
+    bool PythonWorkerPool::spawn(Worker &, std::string &error) {
+        error = "worker processes need Linux";
+        return false;
+    }
+
+    void PythonWorkerPool::terminate(Worker &, bool) {}
+
+    bool PythonWorkerPool::exchange(Worker &, std::string_view, uint32_t &, std::string &, bool &, std::string &error) {
+        error = "worker processes need Linux";
+        return false;
+    }
+
+    bool PythonWorkerPool::receive(Worker &, int, uint32_t &, std::string &, bool &, std::string &error) {
+        error = "worker processes need Linux";
+        return false;
+    }
+#endif
+
+}// namespace mcp::business
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "mcp_plugin.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Runs the tool calls of one Python plugin in worker processes.
+     *
+     * Each worker is a Python interpreter of its own, started with a small loop that imports the
+     * plugin module and serves calls, so CPU-bound tools run in parallel and a crash takes down
+     * only the worker. A worker shares a memory region with the server, a request and a response
+     * area, and two eventfds the sides signal each other through; a message larger than its area
+     * is passed in chunks, each acknowledged through the other eventfd. A caller takes the next
+     * idle worker and waits for one if all are busy.
+     *
+     * A worker that dies is answered with an error for the call it ran and started again on its
+     * next use. Workers retire themselves after max_calls calls or once their peak RSS reaches
+     * max_rss_mb, which keeps a leaking plugin in check without restarting the server.
+     * Linux only; start() fails elsewhere and the plugin stays in process.
+     */
+    class PythonWorkerPool {
+    public:
+        struct Options {
+            std::string executable = "python3";///< Interpreter to start, looked up in PATH without a slash
+            std::string plugin_dir;            ///< Added to the workers' sys.path
+            std::string module_name;           ///< Plugin module the workers import
+            std::size_t workers = 1;
+            std::size_t buffer_bytes = 1024 * 1024;///< Size of the request and of the response area
+            std::size_t max_calls = 0;             ///< Calls after which a worker is replaced, 0 = never
+            std::size_t max_rss_mb = 0;            ///< Peak RSS at which a worker is replaced, 0 = never
+            std::string pycache_prefix;            ///< Bytecode cache directory of the workers, empty for the default
+            std::chrono::milliseconds start_timeout{30000};///< Longest time a worker may take to import the module
+        };
+
+        explicit PythonWorkerPool(Options options);
+        ~PythonWorkerPool();
+
+        PythonWorkerPool(const PythonWorkerPool &) = delete;
+        PythonWorkerPool &operator=(const PythonWorkerPool &) = delete;
+
+        /**
+         * @brief Whether worker processes are available on this platform.
+         */
+        static bool supported();
+
+        /**
+         * @brief Start every worker and wait until each has imported the module.
+         * @return false if a worker failed; none are left running then
+         */
+        bool start();
+
+        /**
+         * @brief Run call_tool of the plugin module in the next idle worker, blocking until it returns.
+         * @param result Set to the result
+         * @return false with error filled in if the call failed
+         */
+        bool call_tool(const char *name, std::string_view args_json, std::string &result, MCPError *error);
+
+        std::size_t size() const { return workers_.size(); }
+
+    private:
+        struct Worker;
+
+        /**
+         * @brief Start a worker process and wait for it to be ready.
+         * @param error Set to the reason if it fails
+         */
+        bool spawn(Worker &worker, std::string &error);
+
+        /**
+         * @brief Reap a worker's process and release its region and descriptors.
+         * @param kill Kill the process first, rather than wait for it to exit itself
+         */
+        void terminate(Worker &worker, bool kill);
+
+        /**
+         * @brief Pass a message to a worker and read its reply.
+         * @param status Set to the reply status, 0 for a result, otherwise an error message
+         * @param retiring Set if the worker exits after this reply
+         * @return false if the worker died, with error set
+         */
+        bool exchange(Worker &worker, std::string_view request, uint32_t &status, std::string &reply,
+                      bool &retiring, std::string &error);
+
+        /**
+         * @brief Read a reply, chunk by chunk, once the worker signals it.
+         * @param timeout Longest wait for each chunk, negative for no limit
+         */
+        bool receive(Worker &worker, int timeout_ms, uint32_t &status, std::string &reply, bool &retiring, std::string &error);
+
+        const Options options_;
+        std::mutex mutex_;
+        std::condition_variable idle_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<Worker *> free_;///< Workers no call is using
+        bool stopping_ = false;
+    };
+
+}// namespace mcp::business
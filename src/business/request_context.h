@@ -0,0 +1,30 @@
+// src/business/request_context.h
+#pragma once
+
+#include "tool_registry.h"
+#include "transport/session.h"
+#include <memory>
+#include <string>
+
+namespace mcp::metrics {
+    class MetricsManager;
+}
+
+namespace mcp::business {
+
+    /**
+     * @brief What one request is handled with, borrowed from its caller while the request runs.
+     *
+     * RequestHandler keeps the owners and passes the context by reference through RpcRouter to
+     * the RPC handlers, so routing a request copies no shared_ptr. A handler that starts work
+     * outliving the request, such as a stream or a call running on past its deadline, copies
+     * the session or registry out of it to own them.
+     */
+    struct RequestContext {
+        const std::shared_ptr<ToolRegistry> &registry;
+        const std::shared_ptr<transport::Session> &session;///< nullptr for stdio
+        const std::string &session_id;                     ///< Transport session identifier
+        metrics::MetricsManager &metrics;
+    };
+
+}// namespace mcp::business
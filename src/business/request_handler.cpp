@@ -10,46 +10,106 @@
 #include "routers/resources_subscribe.hpp"
 #include "routers/tool_list.hpp"
 #include "routers/tools_call.hpp"
+#include "core/tool_thread_pool.hpp"
+#include "metrics/metrics_manager.h"
+#include "metrics/request_trace.h"
 #include "rpc_router.h"
-#include <iostream>
+#include "transport/admission_controller.h"
+#include "transport/fair_scheduler.h"
+#include <mutex>
 
 
 namespace mcp::business {
 
     using namespace routers;
-    RequestHandler::RequestHandler(std::shared_ptr<ToolRegistry> registry, ResponseCallback send_response)
-        : registry_(std::move(registry)), send_response_(std::move(send_response)) {
+
+    // Progress of one batch; entries that miss the deadline finish after it and are dropped
+    struct RequestHandler::BatchState : std::enable_shared_from_this<BatchState> {
+        BatchState(asio::any_io_executor executor, std::size_t size)
+            : timer(std::move(executor)), responses(size), ids(size), done(size, false), remaining(size) {}
+
+        // Record the response of an entry, empty for a notification
+        void complete(std::size_t index, std::string response) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed || done[index]) {
+                return;
+            }
+            responses[index] = std::move(response);
+            done[index] = true;
+            if (--remaining == 0) {
+                // The timer belongs to the batch's executor, cancel it there
+                asio::post(timer.get_executor(), [self = shared_from_this()]() { self->timer.cancel(); });
+            }
+        }
+
+        std::mutex mutex;
+        asio::steady_timer timer;          ///< Expires at the deadline, cancelled when the last entry is done
+        std::vector<std::string> responses;///< Serialized response of each entry
+        std::vector<nlohmann::json> ids;   ///< Request id of each entry, null for notifications
+        std::vector<bool> done;
+        std::size_t remaining;
+        bool closed = false;///< The answer was assembled
+    };
+
+    RequestHandler::RequestHandler(std::shared_ptr<ToolRegistry> registry,
+                                   std::shared_ptr<resources::ResourceManager> resource_manager,
+                                   std::shared_ptr<prompts::PromptManager> prompt_manager,
+                                   ResponseCallback send_response)
+        : registry_(std::move(registry)),
+          resource_manager_(std::move(resource_manager)),
+          prompt_manager_(std::move(prompt_manager)),
+          send_response_(std::move(send_response)),
+          metrics_(metrics::MetricsManager::getInstance()) {
         // Register route handlers
         router_.register_handler("initialize", handle_initialize);
         router_.register_handler("tools/list", handle_tools_list);
-        router_.register_handler("tools/call", handle_tools_call);
+        router_.register_async_handler("tools/call", handle_tools_call);
         router_.register_handler("exit", handle_exit);
 
-        // Register resource handlers
-        router_.register_handler("resources/list", handle_resources_list);
-        router_.register_handler("resources/read", handle_resources_read);
-        router_.register_handler("resources/subscribe", handle_resources_subscribe);
-        router_.register_handler("resources/unsubscribe", handle_resources_unsubscribe);
+        // Register resource handlers, they all use the server's resource manager
+        router_.register_handler("resources/list", [resource_manager = resource_manager_](const protocol::Request &req, const RequestContext &ctx) {
+            return handle_resources_list(req, resource_manager, ctx);
+        });
+        router_.register_async_handler("resources/read", [resource_manager = resource_manager_](const protocol::Request &req, const RequestContext &ctx) {
+            return handle_resources_read(req, resource_manager, ctx);
+        });
+        router_.register_handler("resources/subscribe", [resource_manager = resource_manager_](const protocol::Request &req, const RequestContext &ctx) {
+            return handle_resources_subscribe(req, resource_manager, ctx);
+        });
+        router_.register_handler("resources/unsubscribe", [resource_manager = resource_manager_](const protocol::Request &req, const RequestContext &ctx) {
+            return handle_resources_unsubscribe(req, resource_manager, ctx);
+        });
+
+        // Register prompt handlers, they use the server's prompt manager
+        router_.register_handler("prompts/list", [prompt_manager = prompt_manager_](const protocol::Request &req, const RequestContext &ctx) {
+            return handle_prompts_list(req, prompt_manager, ctx);
+        });
+        router_.register_handler("prompts/get", [prompt_manager = prompt_manager_](const protocol::Request &req, const RequestContext &ctx) {
+            return handle_prompts_get(req, prompt_manager, ctx);
+        });
 
-        // Register prompt handlers
-        router_.register_handler("prompts/list", handle_prompts_list);
-        router_.register_handler("prompts/get", handle_prompts_get);
+        router_.register_handler("notifications/initialized", [](const protocol::Request &, const RequestContext &ctx) {
+            MCP_DEBUG("Received notifications/initialized for session: {}", ctx.session_id);
 
-        router_.register_handler("notifications/initialized", [](
-                                                                      const protocol::Request &,
-                                                                      std::shared_ptr<business::ToolRegistry> /*registry*/,
-                                                                      std::shared_ptr<transport::Session>,
-                                                                      const std::string &session_id) {
-            MCP_DEBUG("Received notifications/initialized for session: {}", session_id);
+            return protocol::Response{};// Return empty response for notifications
+        });
+        router_.register_handler("notifications/cancelled", [](const protocol::Request &req, const RequestContext &ctx) {
+            const std::string &session_id = ctx.session_id;
+            // A request that has already finished is not an error, the notification may cross its response
+            auto request_id = req.params.is_object() ? req.params.find("requestId") : req.params.end();
+            if (request_id != req.params.end() &&
+                CancellationRegistry::instance().cancel(RpcRouter::cancellation_scope(ctx.session, session_id), *request_id)) {
+                auto reason = req.params.find("reason");
+                MCP_INFO("Cancelled request {} (session: {}, reason: {})", request_id->dump(), session_id,
+                         reason != req.params.end() && reason->is_string() ? reason->get<std::string>() : "none");
+            } else {
+                MCP_DEBUG("Received notifications/cancelled for no running request (session: {})", session_id);
+            }
 
             return protocol::Response{};// Return empty response for notifications
         });
-        router_.register_handler("ping", [](
-                                                 const protocol::Request &req,
-                                                 std::shared_ptr<business::ToolRegistry> /*registry*/,
-                                                 std::shared_ptr<transport::Session> /*session*/,
-                                                 const std::string &session_id) {
-            MCP_DEBUG("Received ping request (session: {})", session_id);
+        router_.register_handler("ping", [](const protocol::Request &req, const RequestContext &ctx) {
+            MCP_DEBUG("Received ping request (session: {})", ctx.session_id);
 
             protocol::Response resp;
             resp.id = req.id.value_or(nlohmann::json(nullptr));
@@ -59,56 +119,245 @@ namespace mcp::business {
         });
     }
 
-    void RequestHandler::handle_request(
-            const std::string &msg,
-            std::shared_ptr<transport::Session> session,
+    asio::awaitable<void> RequestHandler::handle_request(
+            std::string_view msg,
+            const std::shared_ptr<transport::Session> &session,
             const std::string &session_id) {
-        MCP_DEBUG("Raw message: {}", msg);
+        std::string response = co_await respond(msg, session, session_id);
+        if (!response.empty()) {
+            send(std::move(response), session, session_id);
+        }
+    }
+
+    asio::awaitable<std::string> RequestHandler::respond(
+            std::string_view msg,
+            const std::shared_ptr<transport::Session> &session,
+            const std::string &session_id) {
+        MCP_DEBUG("Raw message: {}", core::payload(msg));
+        // Stages of a sampled request; stdio has no session and is not traced
+        metrics::RequestTrace *trace = session ? session->trace() : nullptr;
+        metrics::RequestTrace::clock::time_point lap;
+        if (trace) {
+            lap = trace->lap(metrics::RequestStage::Queue, trace->started());
+        }
+
+        // A batch is answered with one array once all of its entries are done. Its entries run side
+        // by side, so they are not traced one by one: the whole batch is its execute stage
+        if (auto batch = protocol::scan_batch(msg)) {
+            auto body = co_await handle_batch(std::move(*batch), session, session_id);
+            if (trace) {
+                trace->set_method("batch");
+                trace->lap(metrics::RequestStage::Execute, lap);
+            }
+            co_return body;
+        }
+
         // Parse JSON-RPC request
         auto [parsed_req, parse_error] = mcp::protocol::parse_request(msg);
+        if (trace) {
+            lap = trace->lap(metrics::RequestStage::Parse, lap);
+        }
 
         // Check if request parsing failed
         if (!parsed_req.has_value()) {
             // Generate appropriate error message
-            std::string err;
             if (parse_error.has_value()) {
-                err = protocol::make_error(parse_error.value());
-            } else {
-                err = protocol::make_error(
-                        protocol::error_code::INVALID_REQUEST,
-                        "Invalid JSON-RPC request format");
+                co_return protocol::make_error(parse_error.value());
             }
+            co_return protocol::make_error(
+                    protocol::error_code::INVALID_REQUEST,
+                    "Invalid JSON-RPC request format");
+        }
 
-            // Handle stdio transport (no session)
-            if (!session) {
-                std::cout << err << std::endl;
-                return;
+        // Get valid request object from parsed result; the trace goes along with it to the handler
+        parsed_req->trace = trace;
+        const protocol::Request &request = parsed_req.value();
+
+        // Route request to appropriate handler; the context borrows what this frame and the handler own
+        RequestContext ctx{registry_, session, session_id, *metrics_};
+        auto response = co_await router_.route_request(request, ctx);
+        if (trace) {
+            lap = trace->lap(metrics::RequestStage::Execute, lap);
+            if (response.error) {
+                trace->set_error(response.error->message);
             }
+        }
 
-            // Send error response through callback
-            send_response_(err, session, session_id);
-            return;
+        // Only answer non-notification requests (those with ID)
+        if (response.id.is_null()) {
+            co_return std::string();
+        }
+        auto body = protocol::make_response(response);
+        if (trace) {
+            trace->lap(metrics::RequestStage::Serialize, lap);
         }
+        co_return body;
+    }
 
-        // Get valid request object from parsed result
-        const protocol::Request &request = parsed_req.value();
+    asio::awaitable<protocol::Response> RequestHandler::dispatch(
+            const protocol::Request &request,
+            const std::shared_ptr<transport::Session> &session,
+            const std::string &session_id) {
+        RequestContext ctx{registry_, session, session_id, *metrics_};
+        co_return co_await router_.route_request(request, ctx);
+    }
 
-        // Route request to appropriate handler
-        auto response = router_.route_request(request, registry_, session, session_id);
+    asio::awaitable<std::string> RequestHandler::handle_batch(
+            std::vector<std::string_view> entries,
+            const std::shared_ptr<transport::Session> &session,
+            const std::string &session_id) {
+        const auto &options = protocol::BatchOptions::current();
+        if (entries.empty()) {
+            co_return protocol::make_error(protocol::error_code::INVALID_REQUEST, "Batch must not be empty", nlohmann::json(nullptr));
+        }
+        if (options.max_size > 0 && entries.size() > options.max_size) {
+            co_return protocol::make_error(protocol::error_code::INVALID_REQUEST,
+                                           "Batch of " + std::to_string(entries.size()) + " requests exceeds the limit of " +
+                                                   std::to_string(options.max_size),
+                                           nlohmann::json(nullptr));
+        }
 
-        // Only send responses for non-notification requests (those with ID)
-        if (!response.id.is_null()) {
-            std::string resp_str = protocol::make_response(response);
+        auto executor = co_await asio::this_coro::executor;
+        auto state = std::make_shared<BatchState>(executor, entries.size());
+        if (options.deadline.count() > 0) {
+            state->timer.expires_after(options.deadline);
+        } else {
+            state->timer.expires_at(asio::steady_timer::time_point::max());
+        }
 
-            // Handle stdio transport (no session)
-            if (!session) {
-                std::cout << resp_str << std::endl;
-                return;
+        // Entries start once this coroutine suspends, then run side by side
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            auto [parsed_req, parse_error] = protocol::parse_request(entries[i]);
+            if (!parsed_req.has_value()) {
+                state->complete(i, parse_error.has_value()
+                                           ? protocol::make_error(parse_error.value())
+                                           : protocol::make_error(protocol::error_code::INVALID_REQUEST, "Invalid JSON-RPC request format"));
+                continue;
             }
+            state->ids[i] = parsed_req->id.value_or(nullptr);
+            asio::co_spawn(executor,
+                           run_batch_entry(&router_, registry_, metrics_.get(), std::move(parsed_req.value()), session, session_id, state, i),
+                           asio::detached);
+        }
 
-            // Send normal response through callback
-            send_response_(resp_str, session, session_id);
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            pending = state->remaining > 0;
+        }
+        if (pending) {
+            asio::error_code ec;
+            co_await state->timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+
+        std::string body = "[";
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->closed = true;
+            if (state->remaining > 0) {
+                MCP_WARN("{} of {} batch entries missed the deadline (session: {})", state->remaining, entries.size(), session_id);
+            }
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                bool timed_out = !state->done[i] && !state->ids[i].is_null();
+                if (!timed_out && state->responses[i].empty()) {
+                    continue;// Notification
+                }
+                if (body.size() > 1) {
+                    body += ',';
+                }
+                if (timed_out) {
+                    protocol::write_error(body, protocol::Error{protocol::error_code::TIMEOUT, "Batch deadline exceeded",
+                                                                std::nullopt, state->ids[i]});
+                } else {
+                    body += state->responses[i];
+                }
+            }
+        }
+
+        // A batch of notifications only gets no answer
+        if (body.size() == 1) {
+            co_return std::string();
+        }
+        body += ']';
+        co_return body;
+    }
+
+    asio::awaitable<void> RequestHandler::run_batch_entry(
+            const RpcRouter *router,
+            std::shared_ptr<ToolRegistry> registry,
+            metrics::MetricsManager *metrics,
+            protocol::Request request,
+            std::shared_ptr<transport::Session> session,
+            std::string session_id,
+            std::shared_ptr<BatchState> state,
+            std::size_t index) {
+        std::string response;
+        try {
+            bool is_tool_call = request.method == "tools/call" || request.method == "/tools/call";
+
+            std::string tool_name;
+            if (is_tool_call && request.params.is_object()) {
+                auto name = request.params.find("name");
+                if (name != request.params.end() && name->is_string()) {
+                    tool_name = name->get<std::string>();
+                }
+            }
+            const bool is_control = transport::PriorityOptions::current().is_control(request.method, tool_name);
+
+            // Each tool call of a batch counts against the concurrency limits, like a single one
+            // and shares the tool pool fairly with other clients' calls
+            transport::AdmissionController::Permit permit;
+            transport::FairScheduler::Turn turn;
+            auto &admission = transport::AdmissionController::getInstance();
+            auto &fair_scheduler = transport::FairScheduler::getInstance();
+            if (!tool_name.empty() && !is_control && session && (admission.enabled() || fair_scheduler.enabled())) {
+                bool admitted = true;
+                if (admission.enabled()) {
+                    permit = co_await admission.acquire(tool_name);
+                    admitted = static_cast<bool>(permit);
+                }
+                if (admitted && fair_scheduler.enabled()) {
+                    turn = co_await fair_scheduler.acquire(fair_scheduler.tenant_of(*session));
+                    admitted = static_cast<bool>(turn);
+                }
+                if (!admitted) {
+                    state->complete(index, protocol::make_error(protocol::error_code::RATE_LIMITED,
+                                                                "Server busy, try again later",
+                                                                request.id.value_or(nullptr)));
+                    co_return;
+                }
+            }
+
+            // An entry may outlive the batch's deadline, so it owns what its context borrows
+            RequestContext ctx{registry, session, session_id, *metrics};
+            protocol::Response result;
+            if (is_tool_call) {
+                // Tool calls may block, so they run on the tool pool, in parallel with each other
+                auto &pool = core::ToolThreadPool::instance();
+                result = co_await asio::co_spawn(is_control ? pool.control_executor() : pool.executor(),
+                                                 router->route_request(request, ctx),
+                                                 asio::use_awaitable);
+            } else {
+                result = co_await router->route_request(request, ctx);
+            }
+            if (!result.id.is_null()) {
+                response = protocol::make_response(result);
+            }
+        } catch (const std::exception &e) {
+            MCP_ERROR("Batch entry {} failed: {}", request.method, e.what());
+            response = protocol::make_error(protocol::error_code::INTERNAL_ERROR, e.what(), request.id.value_or(nullptr));
+        }
+        state->complete(index, std::move(response));
+    }
+
+    void RequestHandler::send(std::string message,
+                              const std::shared_ptr<transport::Session> &session,
+                              const std::string &session_id) {
+        // Stdio has no session, it writes what respond() returns itself
+        if (!session || !send_response_) {
+            return;
         }
+        send_response_(std::move(message), session, session_id);
     }
 
 }// namespace mcp::business
\ No newline at end of file
@@ -1,37 +1,112 @@
 // src/business/request_handler.h
 #pragma once
 
+#include "Prompts/prompt.h"
+#include "Resources/resource.h"
 #include "business/rpc_router.h"
 #include "business/tool_registry.h"
 #include "transport/session.h"
+#include <asio.hpp>
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 
 namespace mcp::business {
 
     // Response callback function signature
     using ResponseCallback = std::function<void(
-            const std::string &,                // response JSON string
-            std::shared_ptr<transport::Session>,// session
-            const std::string &                 // session ID
+            std::string,                               // response JSON string, handed over to be sent
+            const std::shared_ptr<transport::Session> &,// session
+            const std::string &                        // session ID
             )>;
 
     class RequestHandler {
     public:
         explicit RequestHandler(
                 std::shared_ptr<ToolRegistry> registry,
+                std::shared_ptr<resources::ResourceManager> resource_manager,
+                std::shared_ptr<prompts::PromptManager> prompt_manager,
                 ResponseCallback send_response = nullptr);
 
-        void handle_request(
-                const std::string &msg,
-                std::shared_ptr<transport::Session> session,
+        /**
+         * @brief Parse, route and answer one JSON-RPC message.
+         * The message view, session and session_id must stay valid until the returned awaitable
+         * completes; they are lent to the handler as its RequestContext.
+         * @param msg Raw JSON-RPC message
+         * @param session Session the message arrived on
+         * @param session_id Session identifier
+         */
+        asio::awaitable<void> handle_request(
+                std::string_view msg,
+                const std::shared_ptr<transport::Session> &session,
+                const std::string &session_id);
+
+        /**
+         * @brief Parse and route one JSON-RPC message, returning the answer instead of sending it.
+         * For transports that write answers themselves (stdio).
+         * @param msg Raw JSON-RPC message, valid until the returned awaitable completes
+         * @param session Session the message arrived on, nullptr for stdio
+         * @param session_id Session identifier
+         * @return Serialized response, empty for notifications
+         */
+        asio::awaitable<std::string> respond(
+                std::string_view msg,
+                const std::shared_ptr<transport::Session> &session,
+                const std::string &session_id);
+
+        /**
+         * @brief Route a request that is already parsed, returning its response unserialized.
+         * For callers in the same process (core::Engine); no JSON text is read or written.
+         * @param request Request, valid until the returned awaitable completes
+         * @param session Session the request belongs to, nullptr if it has none
+         * @param session_id Session identifier
+         * @return Response, with a null id for notifications
+         */
+        asio::awaitable<protocol::Response> dispatch(
+                const protocol::Request &request,
+                const std::shared_ptr<transport::Session> &session,
                 const std::string &session_id);
 
     private:
+        struct BatchState;
+
+        /**
+         * @brief Run the entries of a batch at once and answer them with one array.
+         * Tool calls go to the tool pool, the other entries run on the calling executor; entries
+         * still running at the batch deadline are answered with a timeout error.
+         * @param entries Raw entries, views into the message
+         * @param session Session the batch arrived on, nullptr for stdio
+         * @param session_id Session identifier
+         * @return Array of the answers, empty if all entries were notifications
+         */
+        asio::awaitable<std::string> handle_batch(
+                std::vector<std::string_view> entries,
+                const std::shared_ptr<transport::Session> &session,
+                const std::string &session_id);
+
+        static asio::awaitable<void> run_batch_entry(
+                const RpcRouter *router,
+                std::shared_ptr<ToolRegistry> registry,
+                metrics::MetricsManager *metrics,
+                protocol::Request request,
+                std::shared_ptr<transport::Session> session,
+                std::string session_id,
+                std::shared_ptr<BatchState> state,
+                std::size_t index);
+
+        // Write a response to the session
+        void send(std::string message,
+                  const std::shared_ptr<transport::Session> &session,
+                  const std::string &session_id);
+
         std::shared_ptr<ToolRegistry> registry_;
+        std::shared_ptr<resources::ResourceManager> resource_manager_;
+        std::shared_ptr<prompts::PromptManager> prompt_manager_;
         ResponseCallback send_response_;
+        std::shared_ptr<metrics::MetricsManager> metrics_;
         RpcRouter router_;
     };
 
@@ -1,10 +1,13 @@
 #include "rpc_router.h"
 #include "core/logger.h"
+#include "metrics/request_trace.h"
 #include "protocol/json_rpc.h"
+#include "transport/http_parser.h"
 #include "transport/mcp_cache.h"
 #include "transport/session.h"
 #include <asio/co_spawn.hpp>
 #include <asio/detached.hpp>
+#include <cstdint>
 #include <mutex>
 
 
@@ -13,6 +16,85 @@
 
 namespace mcp::business {
 
+    namespace {
+        struct BuiltinMethod {
+            std::string_view name;
+            std::size_t slot;          ///< Index into RpcRouter::builtins_
+            std::string_view canonical;///< Method the name stands for, traces are labeled with it
+        };
+
+        // The methods the server implements; the HTTP paths are aliases kept for debugging convenience
+        constexpr std::array kBuiltinMethods{
+                BuiltinMethod{"initialize", 0, "initialize"},
+                BuiltinMethod{"tools/list", 1, "tools/list"},
+                BuiltinMethod{"tools/call", 2, "tools/call"},
+                BuiltinMethod{"exit", 3, "exit"},
+                BuiltinMethod{"resources/list", 4, "resources/list"},
+                BuiltinMethod{"resources/read", 5, "resources/read"},
+                BuiltinMethod{"resources/subscribe", 6, "resources/subscribe"},
+                BuiltinMethod{"resources/unsubscribe", 7, "resources/unsubscribe"},
+                BuiltinMethod{"prompts/list", 8, "prompts/list"},
+                BuiltinMethod{"prompts/get", 9, "prompts/get"},
+                BuiltinMethod{"notifications/initialized", 10, "notifications/initialized"},
+                BuiltinMethod{"notifications/cancelled", 11, "notifications/cancelled"},
+                BuiltinMethod{"ping", 12, "ping"},
+                BuiltinMethod{"/tools/list", 1, "tools/list"},
+                BuiltinMethod{"/tools/call", 2, "tools/call"},
+        };
+        static_assert(kBuiltinMethods.size() - 2 == RpcRouter::kBuiltinSlots);
+
+        constexpr std::size_t kBuiltinBuckets = 64;
+
+        // FNV-1a with a seed picked so that the built-in methods land in distinct buckets
+        constexpr uint32_t method_hash(std::string_view method, uint32_t seed) {
+            uint32_t hash = 2166136261u ^ seed;
+            for (char c: method) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+            }
+            return hash % kBuiltinBuckets;
+        }
+
+        constexpr bool is_perfect(uint32_t seed) {
+            std::array<bool, kBuiltinBuckets> used{};
+            for (const auto &method: kBuiltinMethods) {
+                auto bucket = method_hash(method.name, seed);
+                if (used[bucket]) {
+                    return false;
+                }
+                used[bucket] = true;
+            }
+            return true;
+        }
+
+        constexpr uint32_t find_seed() {
+            uint32_t seed = 0;
+            while (!is_perfect(seed)) {
+                ++seed;
+            }
+            return seed;
+        }
+
+        constexpr uint32_t kBuiltinSeed = find_seed();
+
+        // Bucket to index into kBuiltinMethods, -1 for an empty bucket
+        constexpr auto kBuiltinBucketTable = [] {
+            std::array<int8_t, kBuiltinBuckets> table{};
+            table.fill(-1);
+            for (std::size_t i = 0; i < kBuiltinMethods.size(); ++i) {
+                table[method_hash(kBuiltinMethods[i].name, kBuiltinSeed)] = static_cast<int8_t>(i);
+            }
+            return table;
+        }();
+
+        const BuiltinMethod *find_builtin(std::string_view method) {
+            auto index = kBuiltinBucketTable[method_hash(method, kBuiltinSeed)];
+            if (index < 0 || kBuiltinMethods[index].name != method) {
+                return nullptr;
+            }
+            return &kBuiltinMethods[index];
+        }
+    }// namespace
+
     /**
      * @brief Initialize cache singleton once with reconnection parameters
      *        Max 1000 sessions, 500 entries per session, 24-hour expiration
@@ -21,7 +103,7 @@ namespace mcp::business {
         static std::once_flag flag;
         std::call_once(flag, []() {
             auto *cache = mcp::cache::McpCache::GetInstance();
-            cache->Init(1000, 500, std::chrono::hours(24));
+            cache->Init(mcp::cache::McpCacheOptions::current());
 
             if (cache->IsInitialized()) {
                 MCP_INFO("McpCache initialized successfully for reconnection support");
@@ -41,54 +123,112 @@ namespace mcp::business {
      * @param handler Handler function for the method
      */
     void RpcRouter::register_handler(const std::string &method, RpcHandler handler) {
+        if (const auto *builtin = find_builtin(method)) {
+            builtins_[builtin->slot] = BuiltinSlot{std::move(handler), nullptr};
+            return;
+        }
+        async_handlers_.erase(method);
         handlers_[method] = std::move(handler);
     }
 
     /**
-     * @brief Find registered handler for a method
+     * @brief Register coroutine RPC method handler
      * @param method RPC method name
-     * @return Optional handler if found
+     * @param handler Coroutine handler for the method
      */
-    std::optional<RpcHandler> RpcRouter::find_handler(const std::string &method) const {
+    void RpcRouter::register_async_handler(const std::string &method, AsyncRpcHandler handler) {
+        if (const auto *builtin = find_builtin(method)) {
+            builtins_[builtin->slot] = BuiltinSlot{nullptr, std::move(handler)};
+            return;
+        }
+        handlers_.erase(method);
+        async_handlers_[method] = std::move(handler);
+    }
+
+    /**
+     * @brief Find registered synchronous handler for a method
+     * @param method RPC method name
+     * @return Handler if found, nullptr otherwise
+     */
+    const RpcHandler *RpcRouter::find_handler(std::string_view method) const {
+        if (const auto *builtin = find_builtin(method)) {
+            const auto &handler = builtins_[builtin->slot].handler;
+            return handler ? &handler : nullptr;
+        }
         auto it = handlers_.find(method);
-        return (it != handlers_.end()) ? std::optional<RpcHandler>(it->second) : std::nullopt;
+        return (it != handlers_.end()) ? &it->second : nullptr;
     }
 
     /**
      * @brief Route RPC request to appropriate handler
      * @param req RPC request object
-     * @param registry Tool registry instance
-     * @param session Transport session
-     * @param session_id Unique session identifier
+     * @param ctx Session, registry and metrics of the request
      * @return RPC response
      */
-    protocol::Response RpcRouter::route_request(
+    asio::awaitable<protocol::Response> RpcRouter::route_request(
             const protocol::Request &req,
-            std::shared_ptr<ToolRegistry> registry,
-            std::shared_ptr<transport::Session> session,
-            const std::string &session_id) const {
+            const RequestContext &ctx) const {
+
+        // Handlers are called in place: a coroutine handler refers to its stored function object
+        const RpcHandler *handler = nullptr;
+        const AsyncRpcHandler *async_handler = nullptr;
+        std::string_view method = req.method;
+        if (const auto *builtin = find_builtin(method)) {
+            method = builtin->canonical;
+            const auto &slot = builtins_[builtin->slot];
+            handler = slot.handler ? &slot.handler : nullptr;
+            async_handler = slot.async_handler ? &slot.async_handler : nullptr;
+        } else if (auto it = async_handlers_.find(method); it != async_handlers_.end()) {
+            async_handler = &it->second;
+        } else if (auto it = handlers_.find(method); it != handlers_.end()) {
+            handler = &it->second;
+        }
 
-        std::string method = req.method;
+        // A traced request is labeled with its method once it is known to be one, so clients
+        // can't add labels by sending made-up methods
+        if (req.trace && (handler || async_handler)) {
+            req.trace->set_method(method);
+        }
 
-        // Map HTTP paths to RPC methods for debugging convenience
-        if (method == "/tools/list") {
-            method = "tools/list";
-        } else if (method == "/tools/call") {
-            method = "tools/call";
+        if (async_handler) {
+            // Only coroutine handlers run long enough to be cancelled; the token stays tracked
+            // while the handler runs, and longer if it hands the token on (e.g. to a stream)
+            std::shared_ptr<CancellationToken> cancel;
+            if (req.id.has_value() && !req.id->is_null()) {
+                cancel = CancellationRegistry::instance().track(cancellation_scope(ctx.session, ctx.session_id), *req.id);
+            }
+            co_return co_await (*async_handler)(req, ctx);
+        }
+        if (handler) {
+            co_return (*handler)(req, ctx);
         }
 
-        auto handler = find_handler(method);
-        if (handler.has_value()) {
-            return handler.value()(req, registry, session, session_id);
-        } else {
-            protocol::Response resp;
-            resp.id = req.id.value_or(nullptr);
-            resp.result = nlohmann::json::parse(protocol::make_error(
-                    protocol::error_code::METHOD_NOT_FOUND,
-                    "Method not supported: " + method,
-                    req.id.value_or(nullptr)));
-            return resp;
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+        resp.error = protocol::Error{
+                protocol::error_code::METHOD_NOT_FOUND,
+                "Method not supported: " + std::string(method)};
+        co_return resp;
+    }
+
+    std::string RpcRouter::cancellation_scope(const std::shared_ptr<transport::Session> &session,
+                                              const std::string &session_id) {
+        if (session) {
+            auto it = session->get_headers().find("Mcp-Session-Id");
+            if (it != session->get_headers().end()) {
+                return it->second;
+            }
+        }
+        return session_id;
+    }
+
+    std::shared_ptr<CancellationToken> RpcRouter::cancellation_token(const protocol::Request &req,
+                                                                     const std::shared_ptr<transport::Session> &session,
+                                                                     const std::string &session_id) {
+        if (!req.id.has_value() || req.id->is_null()) {
+            return nullptr;
         }
+        return CancellationRegistry::instance().find(cancellation_scope(session, session_id), *req.id);
     }
 
 
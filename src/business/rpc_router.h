@@ -1,35 +1,104 @@
 #pragma once
+#include "cancellation.h"
 #include "protocol/json_rpc.h"
-#include "tool_registry.h"
+#include "request_context.h"
 #include "transport/session.h"
+#include <array>
+#include <asio.hpp>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace mcp::business {
     using RpcHandler = std::function<protocol::Response(
             const protocol::Request &,
-            std::shared_ptr<ToolRegistry>,
-            std::shared_ptr<transport::Session>,
-            const std::string &// SessionID
-            )>;
+            const RequestContext &)>;
 
+    // Coroutine handler variant for methods that wait on I/O; it must not block its thread.
+    // The context is valid until the handler completes
+    using AsyncRpcHandler = std::function<asio::awaitable<protocol::Response>(
+            const protocol::Request &,
+            const RequestContext &)>;
+
+    /**
+     * @brief Routes requests to the handler registered for their method.
+     *
+     * The MCP methods the server implements have a fixed slot each, found through a perfect hash
+     * computed at compile time, so routing one of them neither allocates nor copies its handler;
+     * other methods, e.g. of an embedding application, are kept in a map.
+     */
     class RpcRouter {
     public:
         RpcRouter();
 
         void register_handler(const std::string &method, RpcHandler handler);
 
-        std::optional<RpcHandler> find_handler(const std::string &method) const;
+        void register_async_handler(const std::string &method, AsyncRpcHandler handler);
 
-        protocol::Response route_request(
+        /**
+         * @brief Find the synchronous handler of a method.
+         * @param method RPC method name
+         * @return Handler owned by the router, nullptr if the method has none
+         */
+        const RpcHandler *find_handler(std::string_view method) const;
+
+        /**
+         * @brief Route a request to its handler.
+         * Requests with an id that go to a coroutine handler can be cancelled while they run, see
+         * CancellationRegistry; the handler finds its token with cancellation_token().
+         * @param req Request
+         * @param ctx Session, registry and metrics of the request, borrowed until the request is answered
+         */
+        asio::awaitable<protocol::Response> route_request(
                 const protocol::Request &req,
-                std::shared_ptr<ToolRegistry> registry,
-                std::shared_ptr<transport::Session> session,
-                const std::string &session_id) const;
+                const RequestContext &ctx) const;
+
+        /**
+         * @brief Client session that requests are tracked under for cancellation.
+         * The client's Mcp-Session-Id header if it sends one, so a notifications/cancelled arriving on
+         * another connection finds the request; the transport session otherwise.
+         * @param session Transport session, nullptr for stdio
+         * @param session_id Transport session identifier
+         * @return Cancellation scope
+         */
+        static std::string cancellation_scope(const std::shared_ptr<transport::Session> &session,
+                                              const std::string &session_id);
+
+        /**
+         * @brief Token of a request routed by route_request() that is still running.
+         * @param req Request
+         * @param session Transport session, nullptr for stdio
+         * @param session_id Transport session identifier
+         * @return Token, or nullptr if the request cannot be cancelled
+         */
+        static std::shared_ptr<CancellationToken> cancellation_token(const protocol::Request &req,
+                                                                     const std::shared_ptr<transport::Session> &session,
+                                                                     const std::string &session_id);
+
+        /// Number of built-in methods, see kBuiltinMethods in rpc_router.cpp
+        static constexpr std::size_t kBuiltinSlots = 13;
 
     private:
-        std::unordered_map<std::string, RpcHandler> handlers_;
+        // Handlers of a built-in method, at most one of them is set
+        struct BuiltinSlot {
+            RpcHandler handler;
+            AsyncRpcHandler async_handler;
+        };
+
+        // Lets the maps be searched with a string_view
+        struct MethodHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view method) const noexcept {
+                return std::hash<std::string_view>{}(method);
+            }
+        };
+
+        std::array<BuiltinSlot, kBuiltinSlots> builtins_;
+        std::unordered_map<std::string, RpcHandler, MethodHash, std::equal_to<>> handlers_;
+        std::unordered_map<std::string, AsyncRpcHandler, MethodHash, std::equal_to<>> async_handlers_;
     };
 
 }// namespace mcp::business
@@ -0,0 +1,132 @@
+#include "runtime_settings.h"
+#include "config/config.hpp"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include "core/tool_thread_pool.hpp"
+#include "metrics/rate_limiter.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mcp::business {
+
+    namespace {
+        /**
+         * @brief One setting: how it is read back and how a new value goes into a config.
+         */
+        struct RuntimeSetting {
+            const char *name;
+            std::function<nlohmann::json(const config::GlobalConfig &)> effective;
+            std::function<bool(config::GlobalConfig &, const nlohmann::json &)> assign;///< false for an invalid value
+        };
+
+        /**
+         * @brief A setting held in a size_t config field; values must be non-negative integers.
+         * @param effective Reads the value in use, nullptr to report the config's
+         */
+        template<typename Section>
+        RuntimeSetting size_setting(const char *name, Section config::GlobalConfig::*section, size_t Section::*field,
+                                    std::function<size_t()> effective = nullptr) {
+            return {name,
+                    [section, field, effective](const config::GlobalConfig &config) {
+                        return nlohmann::json(effective ? effective() : config.*section.*field);
+                    },
+                    [section, field](config::GlobalConfig &config, const nlohmann::json &value) {
+                        if (!value.is_number_unsigned()) {
+                            return false;
+                        }
+                        config.*section.*field = value.get<size_t>();
+                        return true;
+                    }};
+        }
+
+        const std::vector<RuntimeSetting> &settings() {
+            static const std::vector<RuntimeSetting> table = [] {
+                auto limits = []() -> const metrics::RateLimitConfig & { return metrics::RateLimiter::getInstance()->get_config(); };
+                std::vector<RuntimeSetting> table;
+                table.push_back({"server.log_level",
+                                 [](const config::GlobalConfig &) {
+                                     return nlohmann::json(core::MCPLogger::level_name(core::MCPLogger::instance().get_level()));
+                                 },
+                                 [](config::GlobalConfig &config, const nlohmann::json &value) {
+                                     if (!value.is_string() || !core::MCPLogger::parse_level(value.get<std::string>())) {
+                                         return false;
+                                     }
+                                     config.server.log_level = value.get<std::string>();
+                                     return true;
+                                 }});
+                table.push_back(size_setting(
+                        "server.io_threads", &config::GlobalConfig::server, &config::ServerConfig::io_threads,
+                        [] { return AsioIOServicePool::GetInstance()->ActiveSize(); }));
+                table.push_back(size_setting(
+                        "concurrency.tool_threads", &config::GlobalConfig::concurrency, &config::ConcurrencyConfig::tool_threads,
+                        [] { return core::ToolThreadPool::stats().min_threads; }));
+                table.push_back(size_setting(
+                        "concurrency.tool_threads_max", &config::GlobalConfig::concurrency, &config::ConcurrencyConfig::tool_threads_max,
+                        [] { return core::ToolThreadPool::stats().max_threads; }));
+                table.push_back(size_setting(
+                        "server.max_requests_per_second", &config::GlobalConfig::server, &config::ServerConfig::max_requests_per_second,
+                        [limits] { return limits().max_requests_per_second; }));
+                table.push_back(size_setting(
+                        "server.max_concurrent_requests", &config::GlobalConfig::server, &config::ServerConfig::max_concurrent_requests,
+                        [limits] { return limits().max_concurrent_requests; }));
+                table.push_back(size_setting(
+                        "server.rate_limit_burst", &config::GlobalConfig::server, &config::ServerConfig::rate_limit_burst,
+                        [limits] { return limits().burst; }));
+                table.push_back(size_setting(
+                        "server.max_request_size", &config::GlobalConfig::server, &config::ServerConfig::max_request_size,
+                        [limits] { return limits().max_request_size; }));
+                table.push_back(size_setting(
+                        "server.max_response_size", &config::GlobalConfig::server, &config::ServerConfig::max_response_size,
+                        [limits] { return limits().max_response_size; }));
+                table.push_back(size_setting(
+                        "cache.max_sessions", &config::GlobalConfig::cache, &config::CacheConfig::max_sessions));
+                table.push_back(size_setting(
+                        "cache.max_events_per_session", &config::GlobalConfig::cache, &config::CacheConfig::max_events_per_session));
+                table.push_back(size_setting(
+                        "cache.max_bytes", &config::GlobalConfig::cache, &config::CacheConfig::max_bytes));
+                table.push_back(size_setting(
+                        "cache.result_cache_max_bytes", &config::GlobalConfig::cache, &config::CacheConfig::result_cache_max_bytes));
+                table.push_back(size_setting(
+                        "cache.idempotency_max_bytes", &config::GlobalConfig::cache, &config::CacheConfig::idempotency_max_bytes));
+                return table;
+            }();
+            return table;
+        }
+    }// namespace
+
+    nlohmann::json runtime_settings() {
+        auto config = config::current_config();
+        nlohmann::json values = nlohmann::json::object();
+        for (const auto &setting: settings()) {
+            values[setting.name] = setting.effective(*config);
+        }
+        auto tool_pool = core::ToolThreadPool::stats();
+        return {{"settings", std::move(values)},
+                {"pools", {{"io_threads_started", AsioIOServicePool::GetInstance()->Size()}, {"tool_threads_running", tool_pool.threads}}},
+                {"config_version", config::config_version()}};
+    }
+
+    nlohmann::json apply_runtime_settings(const nlohmann::json &changes) {
+        // One change at a time, so two requests cannot each publish a copy missing the other's
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+
+        config::GlobalConfig next = *config::current_config();
+        for (const auto &[name, value]: changes.items()) {
+            auto it = std::find_if(settings().begin(), settings().end(), [&name](const RuntimeSetting &setting) { return name == setting.name; });
+            if (it == settings().end()) {
+                throw std::invalid_argument("Unknown setting " + name);
+            }
+            if (!it->assign(next, value)) {
+                throw std::invalid_argument("Invalid value for " + name + ": " + value.dump());
+            }
+        }
+        config::apply_runtime_config(std::move(next));
+        return runtime_settings();
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "protocol/json_extern.h"
+
+namespace mcp::business {
+
+    /**
+     * @brief Effective values of the settings that can be changed while the server runs, by
+     *        their config name ("section.key"): the io and tool pool sizes, the request limits,
+     *        the cache limits and the log level.
+     * Pool sizes, request limits and the log level are read from the components that use
+     * them, so a pool that could not take a size reports the one it has; the cache limits
+     * are those of the config they were last set from.
+     * @return {"settings": {name: value}, "pools": {...}, "config_version": n}
+     */
+    nlohmann::json runtime_settings();
+
+    /**
+     * @brief Change settings while the server runs, through the config snapshot: the current
+     *        config is copied, the changes applied to the copy and the copy published, so the
+     *        config observers resize the pools and reconfigure the limits as they would on a
+     *        reload of the file. config.ini is not rewritten.
+     * @param changes JSON object of setting names and new values
+     * @return The effective settings afterwards, see runtime_settings()
+     * @throws std::invalid_argument naming the first unknown setting or invalid value; no
+     *         setting is changed then
+     */
+    nlohmann::json apply_runtime_settings(const nlohmann::json &changes);
+
+}// namespace mcp::business
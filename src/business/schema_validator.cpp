@@ -0,0 +1,654 @@
+#include "schema_validator.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr uint8_t kNull = 0x01;
+        constexpr uint8_t kBoolean = 0x02;
+        constexpr uint8_t kInteger = 0x04;
+        constexpr uint8_t kNumber = 0x08;
+        constexpr uint8_t kString = 0x10;
+        constexpr uint8_t kArray = 0x20;
+        constexpr uint8_t kObject = 0x40;
+
+        /// Longest string or property name matched against a pattern. std::regex recurses once per
+        /// character of the subject, so a longer one could overflow the stack of the calling thread
+        constexpr size_t kMaxPatternSubject = 4096;
+
+        constexpr const char *kTypeNames[] = {"null", "boolean", "integer", "number", "string", "array", "object"};
+
+        uint8_t type_bit(const std::string &name) {
+            for (uint8_t i = 0; i < std::size(kTypeNames); ++i) {
+                if (name == kTypeNames[i]) {
+                    return static_cast<uint8_t>(1u << i);
+                }
+            }
+            return 0;
+        }
+
+        bool is_integral(const nlohmann::json &value) {
+            if (value.is_number_integer()) {
+                return true;
+            }
+            double number = value.get<double>();
+            return std::isfinite(number) && std::floor(number) == number;
+        }
+
+        /// Types a value satisfies; an integral float is an integer, as in JSON Schema
+        uint8_t type_bits(const nlohmann::json &value) {
+            switch (value.type()) {
+                case nlohmann::json::value_t::null:
+                    return kNull;
+                case nlohmann::json::value_t::boolean:
+                    return kBoolean;
+                case nlohmann::json::value_t::number_integer:
+                case nlohmann::json::value_t::number_unsigned:
+                    return kInteger | kNumber;
+                case nlohmann::json::value_t::number_float:
+                    return is_integral(value) ? kInteger | kNumber : kNumber;
+                case nlohmann::json::value_t::string:
+                    return kString;
+                case nlohmann::json::value_t::array:
+                    return kArray;
+                case nlohmann::json::value_t::object:
+                    return kObject;
+                default:
+                    return 0;
+            }
+        }
+
+        std::string type_list(uint8_t types) {
+            std::string text;
+            for (uint8_t i = 0; i < std::size(kTypeNames); ++i) {
+                if (types & (1u << i)) {
+                    if (!text.empty()) {
+                        text += " or ";
+                    }
+                    text += kTypeNames[i];
+                }
+            }
+            return text;
+        }
+
+        std::string value_type_name(const nlohmann::json &value) {
+            if (value.is_number()) {
+                return is_integral(value) ? "integer" : "number";
+            }
+            return value.type_name();
+        }
+
+        std::optional<size_t> size_keyword(const nlohmann::json &schema, const char *keyword) {
+            auto it = schema.find(keyword);
+            if (it == schema.end() || !it->is_number() || it->get<double>() < 0) {
+                return std::nullopt;
+            }
+            return static_cast<size_t>(it->get<double>());
+        }
+
+        std::optional<double> number_keyword(const nlohmann::json &schema, const char *keyword) {
+            auto it = schema.find(keyword);
+            if (it == schema.end() || !it->is_number()) {
+                return std::nullopt;
+            }
+            return it->get<double>();
+        }
+
+        size_t code_points(const std::string &text) {
+            return static_cast<size_t>(std::count_if(text.begin(), text.end(), [](char c) {
+                return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+            }));
+        }
+
+        std::string escape_pointer(const std::string &key) {
+            std::string escaped;
+            escaped.reserve(key.size());
+            for (char c: key) {
+                if (c == '~') {
+                    escaped += "~0";
+                } else if (c == '/') {
+                    escaped += "~1";
+                } else {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+
+        std::string number_text(double number) {
+            if (std::floor(number) == number && std::abs(number) < 1e15) {
+                return std::to_string(static_cast<long long>(number));
+            }
+            return nlohmann::json(number).dump();
+        }
+
+        std::string shorten(std::string text, size_t limit = 120) {
+            if (text.size() > limit) {
+                text.resize(limit);
+                text += "...";
+            }
+            return text;
+        }
+    }// namespace
+
+    struct SchemaValidator::Failure {
+        std::vector<std::string> path;///< Innermost segment first, pushed while unwinding
+        std::string message;
+    };
+
+    /**
+     * @brief Builds the nodes of one document; subschemas are compiled depth first, a $ref once per target.
+     */
+    class SchemaValidator::Compiler {
+    public:
+        Compiler(const nlohmann::json &root, std::vector<Node> &nodes) : root_(root), nodes_(nodes) {}
+
+        int compile(const nlohmann::json &schema, const std::string &pointer) {
+            int index = static_cast<int>(nodes_.size());
+            nodes_.emplace_back();
+            compiled_.emplace(pointer, index);
+
+            // nodes_ grows while the subschemas are compiled, so the node is built aside
+            Node node;
+            if (schema.is_boolean()) {
+                node.reject_all = !schema.get<bool>();
+            } else if (schema.is_object()) {
+                fill(node, schema, pointer);
+            }
+            nodes_[index] = std::move(node);
+            return index;
+        }
+
+    private:
+        void fill(Node &node, const nlohmann::json &schema, const std::string &pointer) {
+            if (auto it = schema.find("type"); it != schema.end()) {
+                uint8_t types = 0;
+                if (it->is_string()) {
+                    types = type_bit(it->get<std::string>());
+                } else if (it->is_array()) {
+                    for (const auto &name: *it) {
+                        if (name.is_string()) {
+                            types |= type_bit(name.get<std::string>());
+                        }
+                    }
+                }
+                // An integer is a number too
+                if (types & kNumber) {
+                    types |= kInteger;
+                }
+                node.types = types ? types : Node::kAnyType;
+            }
+            if (auto it = schema.find("enum"); it != schema.end() && it->is_array()) {
+                node.enum_values.assign(it->begin(), it->end());
+            }
+            if (auto it = schema.find("const"); it != schema.end()) {
+                node.const_value = *it;
+            }
+
+            if (auto it = schema.find("properties"); it != schema.end() && it->is_object()) {
+                for (const auto &[key, subschema]: it->items()) {
+                    node.properties.emplace(key, compile(subschema, pointer + "/properties/" + escape_pointer(key)));
+                }
+            }
+            if (auto it = schema.find("patternProperties"); it != schema.end() && it->is_object()) {
+                for (const auto &[key, subschema]: it->items()) {
+                    if (auto regex = make_regex(key, pointer)) {
+                        node.pattern_properties.emplace_back(std::move(*regex), compile(subschema, pointer + "/patternProperties/" + escape_pointer(key)));
+                    }
+                }
+            }
+            if (auto it = schema.find("additionalProperties"); it != schema.end()) {
+                if (it->is_boolean()) {
+                    node.no_additional_properties = !it->get<bool>();
+                } else if (it->is_object()) {
+                    node.additional_properties = compile(*it, pointer + "/additionalProperties");
+                }
+            }
+            if (auto it = schema.find("required"); it != schema.end() && it->is_array()) {
+                for (const auto &name: *it) {
+                    if (name.is_string()) {
+                        node.required.push_back(name.get<std::string>());
+                    }
+                }
+            }
+            node.min_properties = size_keyword(schema, "minProperties");
+            node.max_properties = size_keyword(schema, "maxProperties");
+
+            // Tuples: prefixItems plus items for the rest (2020-12), or an items array plus additionalItems
+            auto rest = schema.end();
+            if (auto it = schema.find("prefixItems"); it != schema.end() && it->is_array()) {
+                compile_list(*it, pointer + "/prefixItems", node.prefix_items);
+                rest = schema.find("items");
+            } else if (auto items = schema.find("items"); items != schema.end() && items->is_array()) {
+                compile_list(*items, pointer + "/items", node.prefix_items);
+                rest = schema.find("additionalItems");
+            } else if (items != schema.end()) {
+                node.items = compile(*items, pointer + "/items");
+            }
+            if (rest != schema.end()) {
+                if (rest->is_boolean()) {
+                    node.no_additional_items = !rest->get<bool>();
+                } else if (rest->is_object()) {
+                    node.items = compile(*rest, pointer + "/" + (schema.contains("prefixItems") ? "items" : "additionalItems"));
+                }
+            }
+            node.min_items = size_keyword(schema, "minItems");
+            node.max_items = size_keyword(schema, "maxItems");
+            if (auto it = schema.find("uniqueItems"); it != schema.end() && it->is_boolean()) {
+                node.unique_items = it->get<bool>();
+            }
+
+            node.min_length = size_keyword(schema, "minLength");
+            node.max_length = size_keyword(schema, "maxLength");
+            if (auto it = schema.find("pattern"); it != schema.end() && it->is_string()) {
+                node.pattern = make_regex(it->get<std::string>(), pointer);
+                if (node.pattern) {
+                    node.pattern_text = it->get<std::string>();
+                }
+            }
+
+            // Draft 4 spells exclusive bounds as booleans next to minimum/maximum
+            node.minimum = number_keyword(schema, "minimum");
+            node.maximum = number_keyword(schema, "maximum");
+            if (auto it = schema.find("exclusiveMinimum"); it != schema.end()) {
+                if (it->is_boolean()) {
+                    if (it->get<bool>()) {
+                        node.exclusive_minimum = std::exchange(node.minimum, std::nullopt);
+                    }
+                } else {
+                    node.exclusive_minimum = number_keyword(schema, "exclusiveMinimum");
+                }
+            }
+            if (auto it = schema.find("exclusiveMaximum"); it != schema.end()) {
+                if (it->is_boolean()) {
+                    if (it->get<bool>()) {
+                        node.exclusive_maximum = std::exchange(node.maximum, std::nullopt);
+                    }
+                } else {
+                    node.exclusive_maximum = number_keyword(schema, "exclusiveMaximum");
+                }
+            }
+            node.multiple_of = number_keyword(schema, "multipleOf");
+            if (node.multiple_of && *node.multiple_of <= 0) {
+                node.multiple_of.reset();
+            }
+
+            if (auto it = schema.find("allOf"); it != schema.end() && it->is_array()) {
+                compile_list(*it, pointer + "/allOf", node.all_of);
+            }
+            if (auto it = schema.find("anyOf"); it != schema.end() && it->is_array()) {
+                compile_list(*it, pointer + "/anyOf", node.any_of);
+            }
+            if (auto it = schema.find("oneOf"); it != schema.end() && it->is_array()) {
+                compile_list(*it, pointer + "/oneOf", node.one_of);
+            }
+            if (auto it = schema.find("not"); it != schema.end()) {
+                node.not_schema = compile(*it, pointer + "/not");
+            }
+            if (auto it = schema.find("$ref"); it != schema.end() && it->is_string()) {
+                node.ref = resolve(it->get<std::string>());
+            }
+        }
+
+        void compile_list(const nlohmann::json &schemas, const std::string &pointer, std::vector<int> &indices) {
+            for (size_t i = 0; i < schemas.size(); ++i) {
+                indices.push_back(compile(schemas[i], pointer + "/" + std::to_string(i)));
+            }
+        }
+
+        /// Node of a $ref into this document, -1 (not checked) for anything else
+        int resolve(const std::string &ref) {
+            if (ref.empty() || ref[0] != '#') {
+                MCP_DEBUG("Schema $ref '{}' is not local, not checked", ref);
+                return -1;
+            }
+            std::string pointer = ref.substr(1);
+            if (auto it = compiled_.find(pointer); it != compiled_.end()) {
+                return it->second;
+            }
+            try {
+                const auto &target = root_.at(nlohmann::json::json_pointer(pointer));
+                return compile(target, pointer);
+            } catch (const nlohmann::json::exception &e) {
+                MCP_WARN("Schema $ref '{}' not resolved, not checked: {}", ref, e.what());
+                return -1;
+            }
+        }
+
+        std::optional<std::regex> make_regex(const std::string &pattern, const std::string &pointer) {
+            try {
+                return std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+            } catch (const std::regex_error &e) {
+                MCP_WARN("Schema pattern '{}' at '{}' not supported, not checked: {}", pattern, pointer, e.what());
+                return std::nullopt;
+            }
+        }
+
+        const nlohmann::json &root_;
+        std::vector<Node> &nodes_;
+        std::unordered_map<std::string, int> compiled_;///< Node of every JSON pointer compiled so far
+    };
+
+    bool SchemaValidator::Node::accepts_all() const {
+        return !reject_all && types == kAnyType && enum_values.empty() && !const_value &&
+               properties.empty() && pattern_properties.empty() && additional_properties < 0 && !no_additional_properties &&
+               required.empty() && !min_properties && !max_properties &&
+               items < 0 && prefix_items.empty() && !no_additional_items && !min_items && !max_items && !unique_items &&
+               !min_length && !max_length && !pattern &&
+               !minimum && !maximum && !exclusive_minimum && !exclusive_maximum && !multiple_of &&
+               all_of.empty() && any_of.empty() && one_of.empty() && not_schema < 0 && ref < 0;
+    }
+
+    std::shared_ptr<const SchemaValidator> SchemaValidator::compile(const nlohmann::json &schema) {
+        auto validator = std::make_shared<SchemaValidator>();
+        Compiler(schema, validator->nodes_).compile(schema, "");
+        std::vector<uint8_t> state(validator->nodes_.size(), 0);
+        for (int i = 0; i < static_cast<int>(validator->nodes_.size()); ++i) {
+            if (state[i] == 0) {
+                validator->break_cycles(i, state);
+            }
+        }
+        return validator;
+    }
+
+    // $ref, allOf, anyOf, oneOf and not check the same value again, so a cycle of those alone would
+    // never end; properties and items descend into the value and end with it. State per node:
+    // 0 not visited, 1 on the path being followed, 2 done
+    void SchemaValidator::break_cycles(int index, std::vector<uint8_t> &state) {
+        state[index] = 1;
+        auto keep = [&](int target) {
+            if (state[target] == 1) {
+                MCP_WARN("Schema $ref cycle that never descends into the value, not checked");
+                return false;
+            }
+            if (state[target] == 0) {
+                break_cycles(target, state);
+            }
+            return true;
+        };
+        Node &node = nodes_[index];
+        if (node.ref >= 0 && !keep(node.ref)) {
+            node.ref = -1;
+        }
+        std::erase_if(node.all_of, [&](int schema) { return !keep(schema); });
+        std::erase_if(node.any_of, [&](int schema) { return !keep(schema); });
+        std::erase_if(node.one_of, [&](int schema) { return !keep(schema); });
+        if (node.not_schema >= 0 && !keep(node.not_schema)) {
+            node.not_schema = -1;
+        }
+        state[index] = 2;
+    }
+
+    std::optional<SchemaViolation> SchemaValidator::validate(const nlohmann::json &value) const {
+        Failure failure;
+        if (check(0, value, &failure)) {
+            return std::nullopt;
+        }
+        SchemaViolation violation;
+        for (auto it = failure.path.rbegin(); it != failure.path.rend(); ++it) {
+            violation.path += '/';
+            violation.path += escape_pointer(*it);
+        }
+        violation.message = std::move(failure.message);
+        return violation;
+    }
+
+    // Messages are only composed when failure is set; anyOf, oneOf and not probe without one
+    bool SchemaValidator::check(int index, const nlohmann::json &value, Failure *failure) const {
+        const Node &node = nodes_[index];
+        if (node.reject_all) {
+            if (failure) {
+                failure->message = "is not allowed";
+            }
+            return false;
+        }
+        if (node.ref >= 0 && !check(node.ref, value, failure)) {
+            return false;
+        }
+
+        uint8_t types = type_bits(value);
+        if (!(node.types & types)) {
+            if (failure) {
+                failure->message = "expected " + type_list(node.types) + ", got " + value_type_name(value);
+            }
+            return false;
+        }
+        if (!node.enum_values.empty() && std::find(node.enum_values.begin(), node.enum_values.end(), value) == node.enum_values.end()) {
+            if (failure) {
+                failure->message = "must be one of " + shorten(nlohmann::json(node.enum_values).dump());
+            }
+            return false;
+        }
+        if (node.const_value && *node.const_value != value) {
+            if (failure) {
+                failure->message = "must be " + shorten(node.const_value->dump());
+            }
+            return false;
+        }
+
+        bool valid = true;
+        if (types & kObject) {
+            valid = check_object(node, value, failure);
+        } else if (types & kArray) {
+            valid = check_array(node, value, failure);
+        } else if (types & kString) {
+            valid = check_string(node, value, failure);
+        } else if (types & kNumber) {
+            valid = check_number(node, value, failure);
+        }
+        if (!valid) {
+            return false;
+        }
+
+        for (int schema: node.all_of) {
+            if (!check(schema, value, failure)) {
+                return false;
+            }
+        }
+        if (!node.any_of.empty() &&
+            std::none_of(node.any_of.begin(), node.any_of.end(), [&](int schema) { return check(schema, value, nullptr); })) {
+            if (failure) {
+                failure->message = "does not match any of the allowed schemas";
+            }
+            return false;
+        }
+        if (!node.one_of.empty() &&
+            std::count_if(node.one_of.begin(), node.one_of.end(), [&](int schema) { return check(schema, value, nullptr); }) != 1) {
+            if (failure) {
+                failure->message = "must match exactly one of the allowed schemas";
+            }
+            return false;
+        }
+        if (node.not_schema >= 0 && check(node.not_schema, value, nullptr)) {
+            if (failure) {
+                failure->message = "matches a schema it must not";
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool SchemaValidator::check_object(const Node &node, const nlohmann::json &value, Failure *failure) const {
+        if (node.min_properties && value.size() < *node.min_properties) {
+            if (failure) {
+                failure->message = "must have at least " + std::to_string(*node.min_properties) + " properties";
+            }
+            return false;
+        }
+        if (node.max_properties && value.size() > *node.max_properties) {
+            if (failure) {
+                failure->message = "must have at most " + std::to_string(*node.max_properties) + " properties";
+            }
+            return false;
+        }
+        for (const auto &name: node.required) {
+            if (!value.contains(name)) {
+                if (failure) {
+                    failure->message = "missing required property '" + name + "'";
+                }
+                return false;
+            }
+        }
+
+        bool open = !node.no_additional_properties && node.additional_properties < 0;
+        if (node.properties.empty() && node.pattern_properties.empty() && open) {
+            return true;
+        }
+        for (const auto &[key, item]: value.items()) {
+            bool matched = false;
+            if (auto it = node.properties.find(key); it != node.properties.end()) {
+                matched = true;
+                if (!check(it->second, item, failure)) {
+                    if (failure) {
+                        failure->path.push_back(key);
+                    }
+                    return false;
+                }
+            }
+            if (!node.pattern_properties.empty() && key.size() > kMaxPatternSubject) {
+                if (failure) {
+                    failure->message = "property name '" + shorten(key) + "' is longer than the " +
+                                       std::to_string(kMaxPatternSubject) + " bytes matched against patterns";
+                }
+                return false;
+            }
+            for (const auto &[regex, schema]: node.pattern_properties) {
+                if (std::regex_search(key, regex)) {
+                    matched = true;
+                    if (!check(schema, item, failure)) {
+                        if (failure) {
+                            failure->path.push_back(key);
+                        }
+                        return false;
+                    }
+                }
+            }
+            if (matched || open) {
+                continue;
+            }
+            if (node.no_additional_properties) {
+                if (failure) {
+                    failure->message = "unexpected property '" + key + "'";
+                }
+                return false;
+            }
+            if (!check(node.additional_properties, item, failure)) {
+                if (failure) {
+                    failure->path.push_back(key);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool SchemaValidator::check_array(const Node &node, const nlohmann::json &value, Failure *failure) const {
+        if (node.min_items && value.size() < *node.min_items) {
+            if (failure) {
+                failure->message = "must have at least " + std::to_string(*node.min_items) + " items";
+            }
+            return false;
+        }
+        if (node.max_items && value.size() > *node.max_items) {
+            if (failure) {
+                failure->message = "must have at most " + std::to_string(*node.max_items) + " items";
+            }
+            return false;
+        }
+        if (node.no_additional_items && value.size() > node.prefix_items.size()) {
+            if (failure) {
+                failure->message = "must have at most " + std::to_string(node.prefix_items.size()) + " items";
+            }
+            return false;
+        }
+        for (size_t i = 0; i < value.size(); ++i) {
+            int schema = i < node.prefix_items.size() ? node.prefix_items[i] : node.items;
+            if (schema >= 0 && !check(schema, value[i], failure)) {
+                if (failure) {
+                    failure->path.push_back(std::to_string(i));
+                }
+                return false;
+            }
+        }
+        if (node.unique_items) {
+            for (size_t i = 1; i < value.size(); ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (value[i] == value[j]) {
+                        if (failure) {
+                            failure->message = "items " + std::to_string(j) + " and " + std::to_string(i) + " are equal";
+                        }
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool SchemaValidator::check_string(const Node &node, const nlohmann::json &value, Failure *failure) const {
+        const auto &text = value.get_ref<const std::string &>();
+        if (node.min_length || node.max_length) {
+            size_t length = code_points(text);
+            if (node.min_length && length < *node.min_length) {
+                if (failure) {
+                    failure->message = "must be at least " + std::to_string(*node.min_length) + " characters long";
+                }
+                return false;
+            }
+            if (node.max_length && length > *node.max_length) {
+                if (failure) {
+                    failure->message = "must be at most " + std::to_string(*node.max_length) + " characters long";
+                }
+                return false;
+            }
+        }
+        if (node.pattern && text.size() > kMaxPatternSubject) {
+            if (failure) {
+                failure->message = "is longer than the " + std::to_string(kMaxPatternSubject) + " bytes matched against the pattern '" + node.pattern_text + "'";
+            }
+            return false;
+        }
+        if (node.pattern && !std::regex_search(text, *node.pattern)) {
+            if (failure) {
+                failure->message = "does not match the pattern '" + node.pattern_text + "'";
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool SchemaValidator::check_number(const Node &node, const nlohmann::json &value, Failure *failure) const {
+        double number = value.get<double>();
+        auto bound = [&](const char *relation, double limit) {
+            if (failure) {
+                failure->message = std::string("must be ") + relation + " " + number_text(limit);
+            }
+            return false;
+        };
+        if (node.minimum && number < *node.minimum) {
+            return bound(">=", *node.minimum);
+        }
+        if (node.maximum && number > *node.maximum) {
+            return bound("<=", *node.maximum);
+        }
+        if (node.exclusive_minimum && number <= *node.exclusive_minimum) {
+            return bound(">", *node.exclusive_minimum);
+        }
+        if (node.exclusive_maximum && number >= *node.exclusive_maximum) {
+            return bound("<", *node.exclusive_maximum);
+        }
+        if (node.multiple_of) {
+            double quotient = number / *node.multiple_of;
+            if (std::abs(quotient - std::round(quotient)) > 1e-9 * std::max(1.0, std::abs(quotient))) {
+                if (failure) {
+                    failure->message = "must be a multiple of " + number_text(*node.multiple_of);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+}// namespace mcp::business
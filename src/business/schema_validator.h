@@ -0,0 +1,109 @@
+// src/business/schema_validator.h
+#pragma once
+
+#include "nlohmann/json.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief First violation found by SchemaValidator::validate.
+     */
+    struct SchemaViolation {
+        std::string path;   ///< JSON pointer to the offending value, "" for the arguments themselves
+        std::string message;///< What is wrong with it
+    };
+
+    /**
+     * @brief JSON Schema for tool arguments, compiled once into a tree of checks.
+     *
+     * Covers what tool schemas use: type, enum, const, properties, required, additionalProperties,
+     * patternProperties, min/maxProperties, items (one schema or a tuple), min/maxItems, uniqueItems,
+     * min/maxLength, pattern, minimum, maximum, exclusiveMinimum/Maximum (both drafts), multipleOf,
+     * allOf, anyOf, oneOf, not, and $ref into the same document. Other keywords are ignored, so an
+     * unsupported schema accepts rather than rejects; so is a $ref cycle that never descends into
+     * the value. Strings and property names longer than 4 KB fail a pattern rather than being
+     * matched. Immutable after compile(), safe to share between threads.
+     */
+    class SchemaValidator {
+    public:
+        /**
+         * @brief Compile a schema.
+         * @param schema Schema object or boolean; null accepts everything
+         */
+        static std::shared_ptr<const SchemaValidator> compile(const nlohmann::json &schema);
+
+        /**
+         * @brief Check a value against the schema, stopping at the first violation.
+         * @param value Value to check
+         * @return The violation, std::nullopt if the value is valid
+         */
+        std::optional<SchemaViolation> validate(const nlohmann::json &value) const;
+
+        /**
+         * @brief Whether the schema checks anything at all; validate() of one that doesn't always passes.
+         */
+        bool trivial() const { return nodes_.front().accepts_all(); }
+
+    private:
+        struct Node {
+            static constexpr uint8_t kAnyType = 0x7f;
+
+            bool reject_all = false;  ///< false schema
+            uint8_t types = kAnyType; ///< Bit per JSON type, see type_bit()
+            std::vector<nlohmann::json> enum_values;
+            std::optional<nlohmann::json> const_value;
+
+            // Objects
+            std::unordered_map<std::string, int> properties;
+            std::vector<std::pair<std::regex, int>> pattern_properties;
+            int additional_properties = -1;///< Schema for the other properties, -1 if any are allowed
+            bool no_additional_properties = false;
+            std::vector<std::string> required;
+            std::optional<size_t> min_properties, max_properties;
+
+            // Arrays
+            int items = -1;              ///< Schema for every item, or for those after prefix_items
+            std::vector<int> prefix_items;///< Tuple form of items
+            bool no_additional_items = false;
+            std::optional<size_t> min_items, max_items;
+            bool unique_items = false;
+
+            // Strings, lengths in code points
+            std::optional<size_t> min_length, max_length;
+            std::optional<std::regex> pattern;
+            std::string pattern_text;
+
+            // Numbers
+            std::optional<double> minimum, maximum, exclusive_minimum, exclusive_maximum, multiple_of;
+
+            // Combinators
+            std::vector<int> all_of, any_of, one_of;
+            int not_schema = -1;
+            int ref = -1;///< Target of $ref, checked in addition to the rest of the node
+
+            bool accepts_all() const;
+        };
+
+        class Compiler;
+        struct Failure;
+
+        void break_cycles(int index, std::vector<uint8_t> &state);
+        bool check(int node, const nlohmann::json &value, Failure *failure) const;
+        bool check_object(const Node &node, const nlohmann::json &value, Failure *failure) const;
+        bool check_array(const Node &node, const nlohmann::json &value, Failure *failure) const;
+        bool check_string(const Node &node, const nlohmann::json &value, Failure *failure) const;
+        bool check_number(const Node &node, const nlohmann::json &value, Failure *failure) const;
+
+        std::vector<Node> nodes_;///< nodes_[0] is the root; nodes refer to each other by index
+    };
+
+}// namespace mcp::business
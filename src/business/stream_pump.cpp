@@ -0,0 +1,275 @@
+// src/business/stream_pump.cpp
+#include "stream_pump.h"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include "plugin_usage.h"
+#include <algorithm>
+
+namespace mcp::business {
+
+    namespace {
+        constexpr int kPullsPerSlice = 16;                   ///< Pulls before a pump moves on to other streams
+        constexpr std::chrono::seconds kSlowPullThreshold{1};///< A single next() call this long is logged
+        thread_local std::size_t current_pump = 0;           ///< Index of the pump thread running the caller
+    }// namespace
+
+    std::string read_stream_checkpoint(StreamGeneratorCheckpoint checkpoint, StreamGenerator generator) {
+        if (!checkpoint) {
+            return {};
+        }
+        // Checkpoints are meant to be small, most fit the first try
+        std::string result(64, '\0');
+        std::size_t size = checkpoint(generator, result.data(), result.size());
+        if (size > result.size() && size <= MCP_STREAM_CHECKPOINT_MAX) {
+            result.resize(size);
+            size = checkpoint(generator, result.data(), result.size());
+        }
+        result.resize(size <= result.size() ? size : 0);
+        return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// StreamPumpPool
+    ////////////////////////////////////////////////////////////////////////////////
+
+    StreamPumpPoolOptions &StreamPumpPool::pending_options() {
+        static StreamPumpPoolOptions options;
+        return options;
+    }
+
+    void StreamPumpPool::configure(StreamPumpPoolOptions options) {
+        pending_options() = std::move(options);
+    }
+
+    StreamPumpPool &StreamPumpPool::instance() {
+        static StreamPumpPool pool(pending_options());
+        return pool;
+    }
+
+    StreamPumpPool::StreamPumpPool(StreamPumpPoolOptions options)
+        : options_(std::move(options)),
+          context_(static_cast<int>(options_.threads != 0 ? options_.threads : std::max(1u, std::thread::hardware_concurrency()))),
+          work_(asio::make_work_guard(context_)),
+          started_(std::chrono::steady_clock::now()) {
+        std::size_t count = options_.threads != 0 ? options_.threads : std::max(1u, std::thread::hardware_concurrency());
+        thread_counters_.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            thread_counters_.push_back(std::make_unique<ThreadCounters>());
+        }
+        threads_.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            threads_.emplace_back([this, i, name = options_.thread_name + "-" + std::to_string(i)]() {
+                AsioIOServicePool::SetupCurrentThread(name, -1);
+                current_pump = i;
+                context_.run();
+            });
+        }
+        MCP_INFO("Started stream pump pool '{}' with {} threads", options_.thread_name, count);
+    }
+
+    void StreamPumpPool::stop() {
+        work_.reset();
+        context_.stop();
+        for (auto &thread: threads_) {
+            if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+                thread.join();
+            }
+        }
+    }
+
+    void StreamPumpPool::record(const std::string &tool, std::chrono::nanoseconds busy) {
+        auto &counters = *thread_counters_[current_pump];
+        counters.calls.fetch_add(1, std::memory_order_relaxed);
+        counters.busy_ns.fetch_add(busy.count(), std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(tools_mutex_);
+        auto &stats = tools_[tool];
+        ++stats.calls;
+        stats.busy += busy;
+    }
+
+    std::vector<StreamPumpStats> StreamPumpPool::thread_stats() const {
+        auto uptime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_);
+        std::vector<StreamPumpStats> result;
+        result.reserve(thread_counters_.size());
+        for (std::size_t i = 0; i < thread_counters_.size(); ++i) {
+            StreamPumpStats stats;
+            stats.name = options_.thread_name + "-" + std::to_string(i);
+            stats.calls = thread_counters_[i]->calls.load(std::memory_order_relaxed);
+            stats.busy = std::chrono::nanoseconds(thread_counters_[i]->busy_ns.load(std::memory_order_relaxed));
+            stats.utilization = uptime.count() > 0 ? static_cast<double>(stats.busy.count()) / static_cast<double>(uptime.count()) : 0;
+            result.push_back(std::move(stats));
+        }
+        return result;
+    }
+
+    std::vector<StreamPumpStats> StreamPumpPool::tool_stats() const {
+        auto uptime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started_);
+        std::vector<StreamPumpStats> result;
+        {
+            std::lock_guard<std::mutex> lock(tools_mutex_);
+            result.reserve(tools_.size());
+            for (const auto &[name, stats]: tools_) {
+                result.push_back(stats);
+                result.back().name = name;
+            }
+        }
+        for (auto &stats: result) {
+            stats.utilization = uptime.count() > 0 ? static_cast<double>(stats.busy.count()) / static_cast<double>(uptime.count()) : 0;
+        }
+        std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) { return a.busy > b.busy; });
+        return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// StreamPump
+    ////////////////////////////////////////////////////////////////////////////////
+
+    StreamPump::StreamPump(StreamGenerator generator, StreamGeneratorNext next, StreamGeneratorCheckpoint checkpoint,
+                           std::shared_ptr<const void> owner, std::string tool_name, std::string plugin_name, std::size_t queue_size)
+        : generator_(generator),
+          next_(next),
+          checkpoint_(checkpoint),
+          owner_(std::move(owner)),
+          tool_name_(std::move(tool_name)),
+          plugin_name_(std::move(plugin_name)),
+          queue_(queue_size) {}
+
+    std::shared_ptr<StreamPump> StreamPump::start(StreamGenerator generator,
+                                                  StreamGeneratorNext next,
+                                                  std::shared_ptr<const void> owner,
+                                                  std::string tool_name,
+                                                  std::string plugin_name,
+                                                  StreamGeneratorCheckpoint checkpoint) {
+        auto &pool = StreamPumpPool::instance();
+        std::shared_ptr<StreamPump> pump(new StreamPump(generator, next, checkpoint, std::move(owner), std::move(tool_name),
+                                                        std::move(plugin_name), pool.options().queue_size));
+        pump->schedule();
+        return pump;
+    }
+
+    int StreamPump::next(const char **result_json, MCPError *error) {
+        if (!queue_.try_pop(current_)) {
+            return MCP_STREAM_WOULD_BLOCK;
+        }
+        // There is room again, resume the pump if a full queue paused it
+        schedule();
+
+        *result_json = current_.has_data ? current_.data.c_str() : nullptr;
+        if (error) {
+            error->code = current_.error_code;
+            error->message = current_.has_error_message ? current_.error_message.c_str() : nullptr;
+        }
+        return current_.status;
+    }
+
+    asio::awaitable<void> StreamPump::wait(std::chrono::milliseconds max_wait) {
+        co_await waiter_.wait(&StreamPump::wait_hook, this, max_wait);
+    }
+
+    int StreamPump::wait_hook(StreamGenerator self, MCPStreamWakeup wakeup, void *context) {
+        // A result pushed before the waiter was armed would otherwise only be seen after max_wait
+        if (!static_cast<StreamPump *>(self)->queue_.empty()) {
+            wakeup(context);
+        }
+        return -1;
+    }
+
+    void StreamPump::close(StreamGeneratorFree free_func) {
+        bool free_now = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            if (scheduled_) {
+                free_func_ = free_func;
+            } else {
+                free_now = true;
+            }
+        }
+        if (free_now && free_func) {
+            free_func(generator_);
+        }
+    }
+
+    void StreamPump::schedule() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (scheduled_ || finished_ || closed_) {
+                return;
+            }
+            scheduled_ = true;
+        }
+        asio::post(StreamPumpPool::instance().executor(), [self = shared_from_this()]() { self->run(); });
+    }
+
+    void StreamPump::run() {
+        auto &pool = StreamPumpPool::instance();
+        bool finished = false;
+
+        for (int i = 0; i < kPullsPerSlice && !queue_.full() && !closed_; ++i) {
+            const char *result_json = nullptr;
+            MCPError error = {0, nullptr, nullptr, nullptr};
+
+            auto started = std::chrono::steady_clock::now();
+            int status;
+            {
+                PluginUsage::Meter meter(plugin_name_, tool_name_);
+                status = next_(generator_, &result_json, &error);
+            }
+            auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+            pool.record(tool_name_, busy);
+            if (busy >= kSlowPullThreshold) {
+                MCP_WARN("Stream generator of tool {} held a pump thread for {}ms", tool_name_,
+                         std::chrono::duration_cast<std::chrono::milliseconds>(busy).count());
+            }
+
+            // Calls that produced nothing are not worth a slot
+            if (status == MCP_STREAM_WOULD_BLOCK || (status == 0 && (!result_json || *result_json == '\0'))) {
+                continue;
+            }
+
+            Item item;
+            item.status = status;
+            item.has_data = result_json != nullptr;
+            if (result_json) {
+                item.data = result_json;
+            }
+            item.error_code = error.code;
+            item.has_error_message = error.message != nullptr;
+            if (error.message) {
+                item.error_message = error.message;
+            }
+            if (status == 0) {
+                item.checkpoint = read_stream_checkpoint(checkpoint_, generator_);
+            }
+            queue_.try_push(std::move(item));// cannot fail, this is the only producer and the queue had room
+            StreamWaiter::wakeup(&waiter_);
+
+            if (status == 1 || status == -1) {
+                finished = true;
+                break;
+            }
+        }
+
+        StreamGeneratorFree free_func = nullptr;
+        bool again = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            scheduled_ = false;
+            finished_ = finished_ || finished;
+            if (closed_) {
+                std::swap(free_func, free_func_);
+            } else if (!finished_ && !queue_.full()) {
+                // Checked under the lock, so a pop that raced with this slice cannot leave the pump paused
+                scheduled_ = again = true;
+            }
+        }
+        if (free_func) {
+            free_func(generator_);
+        }
+        if (again) {
+            asio::post(pool.executor(), [self = shared_from_this()]() { self->run(); });
+        }
+    }
+
+}// namespace mcp::business
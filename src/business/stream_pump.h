@@ -0,0 +1,227 @@
+// src/business/stream_pump.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "core/spsc_queue.hpp"
+#include "mcp_plugin.h"
+#include "stream_waiter.h"
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Checkpoint of a generator's position after the event its next() returned last.
+     * @param checkpoint Generator's checkpoint function, may be nullptr
+     * @param generator Generator
+     * @return Checkpoint, empty if there is none or it is longer than MCP_STREAM_CHECKPOINT_MAX
+     */
+    std::string read_stream_checkpoint(StreamGeneratorCheckpoint checkpoint, StreamGenerator generator);
+
+    /**
+     * @brief Settings for the StreamPumpPool, normally taken from the [concurrency] section.
+     */
+    struct StreamPumpPoolOptions {
+        std::size_t threads = 0;             ///< Pump threads, 0 = hardware concurrency
+        std::size_t queue_size = 64;         ///< Events buffered per stream before its generator is paused
+        std::string thread_name = "mcp-pump";///< Thread name prefix, the thread index is appended
+    };
+
+    /**
+     * @brief Time spent in generator calls by one pump thread or one tool.
+     */
+    struct StreamPumpStats {
+        std::string name;                ///< Thread name or tool name
+        uint64_t calls = 0;              ///< Calls to the generator's next function
+        std::chrono::nanoseconds busy{0};///< Time spent inside those calls
+        double utilization = 0;          ///< busy divided by the pool's uptime
+    };
+
+    /**
+     * @brief Threads that drive blocking stream generators, so io threads never wait in next().
+     *
+     * Like the ToolThreadPool, all pumps run one shared io_context: a stream posts a slice of
+     * pulls and the next idle pump runs it, so a generator that blocks only holds up itself.
+     */
+    class StreamPumpPool {
+    public:
+        ~StreamPumpPool() { stop(); }
+        StreamPumpPool(const StreamPumpPool &) = delete;
+        StreamPumpPool &operator=(const StreamPumpPool &) = delete;
+
+        /**
+         * @brief Set the pool options. Must be called before the first instance().
+         * @param options Pool options
+         */
+        static void configure(StreamPumpPoolOptions options);
+
+        /**
+         * @brief Get the process-wide pool, starting it on first use.
+         * @return Stream pump pool
+         */
+        static StreamPumpPool &instance();
+
+        asio::io_context::executor_type executor() { return context_.get_executor(); }
+        const StreamPumpPoolOptions &options() const { return options_; }
+        std::size_t size() const { return threads_.size(); }
+
+        /**
+         * @brief Generator time per pump thread, in thread order.
+         * @return Per-thread statistics
+         */
+        std::vector<StreamPumpStats> thread_stats() const;
+
+        /**
+         * @brief Generator time per tool, busiest first; shows which tools hog the pumps.
+         * @return Per-tool statistics
+         */
+        std::vector<StreamPumpStats> tool_stats() const;
+
+        /**
+         * @brief Stop accepting work and join the pumps.
+         */
+        void stop();
+
+    private:
+        friend class StreamPump;
+
+        struct ThreadCounters {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<int64_t> busy_ns{0};
+        };
+
+        explicit StreamPumpPool(StreamPumpPoolOptions options);
+
+        /**
+         * @brief Account one generator call to the calling pump thread and to its tool.
+         * @param tool Tool name
+         * @param busy Duration of the call
+         */
+        void record(const std::string &tool, std::chrono::nanoseconds busy);
+
+        static StreamPumpPoolOptions &pending_options();
+
+        StreamPumpPoolOptions options_;
+        asio::io_context context_;
+        asio::executor_work_guard<asio::io_context::executor_type> work_;
+        std::vector<std::thread> threads_;
+        std::vector<std::unique_ptr<ThreadCounters>> thread_counters_;
+        std::chrono::steady_clock::time_point started_;
+        mutable std::mutex tools_mutex_;
+        std::unordered_map<std::string, StreamPumpStats> tools_;///< tool name -> counters
+    };
+
+    /**
+     * @brief Runs a blocking generator on the StreamPumpPool and buffers its results.
+     *
+     * The pump pulls on pump threads until its queue is full, the stream ends or the stream is
+     * closed; the session's coroutine takes results without blocking and waits through wait()
+     * when there are none. Shared by every consumer of the generator, one at a time, so buffered
+     * results carry over a reconnect.
+     */
+    class StreamPump : public std::enable_shared_from_this<StreamPump> {
+    public:
+        /**
+         * @brief Create a pump and start pulling.
+         * @param generator Generator to drive
+         * @param next Generator's next function
+         * @param owner Keeps the plugin loaded while the pump may call into it
+         * @param tool_name Tool the generator belongs to, for statistics
+         * @param plugin_name Plugin the generator belongs to, for its usage accounting
+         * @param checkpoint Generator's checkpoint function, taken after each event; may be nullptr
+         * @return Pump
+         */
+        static std::shared_ptr<StreamPump> start(StreamGenerator generator,
+                                                 StreamGeneratorNext next,
+                                                 std::shared_ptr<const void> owner,
+                                                 std::string tool_name,
+                                                 std::string plugin_name,
+                                                 StreamGeneratorCheckpoint checkpoint = nullptr);
+
+        /**
+         * @brief Take the next result, same contract as StreamGeneratorNext. Consumer only.
+         * The strings stay valid until the next call.
+         * @return Generator status, or MCP_STREAM_WOULD_BLOCK if no result is buffered
+         */
+        int next(const char **result_json, MCPError *error);
+
+        /**
+         * @brief Checkpoint of the generator right after the result next() returned last, empty if
+         *        it has none. Consumer only. The generator itself is ahead by the buffered results.
+         */
+        const std::string &checkpoint() const { return current_.checkpoint; }
+
+        /**
+         * @brief Wait until a result is buffered or max_wait has passed. Consumer only.
+         * @param max_wait Longest time to wait
+         */
+        asio::awaitable<void> wait(std::chrono::milliseconds max_wait);
+
+        /**
+         * @brief Wake a consumer waiting in wait() right away, e.g. because its stream was cancelled. Thread safe.
+         */
+        void interrupt() { StreamWaiter::wakeup(&waiter_); }
+
+        /**
+         * @brief Stop pulling and free the generator, right away or once the call in progress returns.
+         * @param free_func Generator's free function, may be nullptr
+         */
+        void close(StreamGeneratorFree free_func);
+
+    private:
+        struct Item {
+            int status = 0;
+            bool has_data = false;///< result_json was not NULL
+            std::string data;
+            int error_code = 0;
+            bool has_error_message = false;
+            std::string error_message;
+            std::string checkpoint;///< Taken right after the pull
+        };
+
+        StreamPump(StreamGenerator generator, StreamGeneratorNext next, StreamGeneratorCheckpoint checkpoint,
+                   std::shared_ptr<const void> owner, std::string tool_name, std::string plugin_name, std::size_t queue_size);
+
+        /**
+         * @brief Post a slice of pulls unless one is pending, the stream ended or it is closed.
+         */
+        void schedule();
+
+        /**
+         * @brief Pull one slice on a pump thread.
+         */
+        void run();
+
+        /**
+         * @brief StreamGeneratorWait for the pump's own waiter: wakes it at once if results are buffered.
+         */
+        static int wait_hook(StreamGenerator self, MCPStreamWakeup wakeup, void *context);
+
+        StreamGenerator generator_;
+        StreamGeneratorNext next_;
+        StreamGeneratorCheckpoint checkpoint_;
+        std::shared_ptr<const void> owner_;
+        std::string tool_name_;
+        std::string plugin_name_;
+        core::SpscQueue<Item> queue_;            ///< Pump threads push, the session's coroutine pops
+        Item current_;                           ///< Result handed out by the last next()
+        StreamWaiter waiter_;                    ///< Woken after each push
+        std::mutex mutex_;                       ///< Guards the flags below
+        bool scheduled_ = false;                 ///< A slice is posted or running
+        bool finished_ = false;                  ///< The generator reported its end or an error
+        std::atomic<bool> closed_{false};        ///< close() was called
+        StreamGeneratorFree free_func_ = nullptr;///< Left for the running slice to call
+    };
+
+}// namespace mcp::business
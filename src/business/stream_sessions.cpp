@@ -0,0 +1,161 @@
+// src/business/stream_sessions.cpp
+#include "stream_sessions.h"
+#include "core/housekeeping.h"
+#include "core/logger.h"
+#include "metrics/metrics_manager.h"
+#include "transport/mcp_cache.h"
+
+namespace mcp::business {
+
+    StreamSessionRegistry &StreamSessionRegistry::instance() {
+        static StreamSessionRegistry registry;
+        return registry;
+    }
+
+    StreamSessionRegistry::StreamSessionRegistry() : executor_(core::Housekeeping::instance().executor()) {
+    }
+
+    StreamSessionRegistry::~StreamSessionRegistry() {
+        // The expiry timers refer to the registry; at exit nothing else needs the housekeeping thread
+        core::Housekeeping::instance().stop();
+    }
+
+    std::shared_ptr<StreamSession> StreamSessionRegistry::attach(const std::string &session_id,
+                                                                 StreamGenerator generator,
+                                                                 StreamGeneratorFree free_func,
+                                                                 std::shared_ptr<const void> owner) {
+        auto stream = std::make_shared<StreamSession>();
+        stream->generator = generator;
+        stream->free_func = free_func;
+        stream->owner = std::move(owner);
+
+        std::shared_ptr<StreamSession> replaced;
+        {
+            auto &shard = shard_of(session_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto &slot = shard.sessions[session_id];
+            replaced = std::exchange(slot, stream);
+        }
+        if (!replaced) {
+            size_.fetch_add(1, std::memory_order_relaxed);
+            publish_size();
+        }
+        asio::post(executor_, [this, session_id, stream, replaced]() {
+            if (replaced) {
+                dispose(session_id, replaced, false);
+            }
+            arm(session_id, stream);
+        });
+        return stream;
+    }
+
+    std::shared_ptr<StreamSession> StreamSessionRegistry::find(const std::string &session_id) {
+        auto &shard = shard_of(session_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(session_id);
+        if (it == shard.sessions.end()) {
+            return nullptr;
+        }
+        it->second->touch();
+        return it->second;
+    }
+
+    std::shared_ptr<StreamPump> StreamSessionRegistry::pump(const std::string &session_id,
+                                                            const std::function<std::shared_ptr<StreamPump>()> &start) {
+        auto &shard = shard_of(session_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(session_id);
+        if (it == shard.sessions.end()) {
+            return nullptr;
+        }
+        if (!it->second->pump) {
+            it->second->pump = start();
+        }
+        return it->second->pump;
+    }
+
+    void StreamSessionRegistry::forget(const std::string &session_id) {
+        auto &shard = shard_of(session_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        take(shard, session_id);
+    }
+
+    void StreamSessionRegistry::release(const std::string &session_id) {
+        std::shared_ptr<StreamSession> stream;
+        {
+            auto &shard = shard_of(session_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stream = take(shard, session_id);
+        }
+        mcp::cache::McpCache::GetInstance()->CleanupSession(session_id);
+        if (stream) {
+            asio::post(executor_, [session_id, stream]() { dispose(session_id, stream, false); });
+        }
+    }
+
+    std::shared_ptr<StreamSession> StreamSessionRegistry::take(Shard &shard, const std::string &session_id) {
+        auto it = shard.sessions.find(session_id);
+        if (it == shard.sessions.end()) {
+            return nullptr;
+        }
+        auto stream = std::move(it->second);
+        shard.sessions.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        publish_size();
+        return stream;
+    }
+
+    void StreamSessionRegistry::arm(const std::string &session_id, const std::shared_ptr<StreamSession> &stream) {
+        if (!stream->timer) {
+            stream->timer = std::make_unique<asio::steady_timer>(executor_);
+        }
+        auto last_active = std::chrono::steady_clock::time_point(
+                std::chrono::steady_clock::duration(stream->last_active_ns.load(std::memory_order_relaxed)));
+        stream->timer->expires_at(last_active + kIdleTimeout);
+        stream->timer->async_wait([this, session_id, weak = std::weak_ptr<StreamSession>(stream)](const asio::error_code &ec) {
+            auto stream = weak.lock();
+            if (ec || !stream) {
+                return;
+            }
+            // Activity since the timer was set moves the deadline, the timer starts over
+            auto idle = std::chrono::steady_clock::now().time_since_epoch().count() - stream->last_active_ns.load(std::memory_order_relaxed);
+            if (std::chrono::steady_clock::duration(idle) < kIdleTimeout) {
+                arm(session_id, stream);
+                return;
+            }
+            {
+                auto &shard = shard_of(session_id);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.sessions.find(session_id);
+                if (it == shard.sessions.end() || it->second != stream) {
+                    return;// Released or replaced meanwhile, whoever did it frees it
+                }
+                take(shard, session_id);
+                // Under the lock, so a stream attached to the session right after keeps its events
+                mcp::cache::McpCache::GetInstance()->CleanupSession(session_id);
+            }
+            dispose(session_id, stream, true);
+        });
+    }
+
+    void StreamSessionRegistry::dispose(const std::string &session_id, const std::shared_ptr<StreamSession> &stream, bool expired) {
+        if (stream->timer) {
+            stream->timer->cancel();
+        }
+        // A pump frees the generator itself once the call it may be running has returned
+        if (stream->pump) {
+            stream->pump->close(stream->free_func);
+        } else if (stream->free_func) {
+            stream->free_func(stream->generator);
+        }
+        if (expired) {
+            MCP_INFO("Freed stream resources for expired session - session: {}", session_id);
+        }
+    }
+
+    void StreamSessionRegistry::publish_size() {
+        static auto &gauge = metrics::MetricsManager::getInstance()->runtime_gauges().stream_generators;
+        gauge.store(static_cast<int64_t>(size()), std::memory_order_relaxed);
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,155 @@
+// src/business/stream_sessions.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "mcp_plugin.h"
+#include "stream_pump.h"
+#include "stream_waiter.h"
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace mcp::business {
+
+    /**
+     * @brief Generator of a streaming tools/call, kept so the client can reconnect to it.
+     */
+    struct StreamSession {
+        StreamGenerator generator = nullptr;
+        StreamGeneratorFree free_func = nullptr;
+        std::shared_ptr<const void> owner;                                      ///< Keeps the plugin loaded while the generator may be resumed
+        std::shared_ptr<StreamWaiter> waiter = std::make_shared<StreamWaiter>();///< Wakeup context handed to the plugin, lives as long as the generator
+        std::shared_ptr<StreamPump> pump;                                       ///< Drives a blocking generator off the io threads, owns freeing it
+
+        /**
+         * @brief Record activity of the stream, which postpones its expiry. Thread safe and cheap,
+         *        the stream consumer calls it once per batch.
+         */
+        void touch() noexcept {
+            last_active_ns.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+        std::atomic<int64_t> last_active_ns{std::chrono::steady_clock::now().time_since_epoch().count()};
+        std::unique_ptr<asio::steady_timer> timer;///< Expiry timer, only used on the housekeeping thread
+    };
+
+    /**
+     * @brief The stream generators tools/call keeps for reconnection, by client session.
+     *
+     * Sessions are spread over shards with a lock each, so streams starting and reconnecting on
+     * different io threads rarely wait for one another. Each session has an expiry timer on the
+     * housekeeping thread (core::Housekeeping): a session idle for the idle timeout is dropped
+     * there, and its generator and cached events are freed there too, never on a request's thread.
+     */
+    class StreamSessionRegistry {
+    public:
+        /// Idle time after which a parked stream is dropped, it cannot be resumed then
+        static constexpr std::chrono::minutes kIdleTimeout{5};
+
+        ~StreamSessionRegistry();
+        StreamSessionRegistry(const StreamSessionRegistry &) = delete;
+        StreamSessionRegistry &operator=(const StreamSessionRegistry &) = delete;
+
+        /**
+         * @brief Get the process-wide registry, starting the housekeeping thread on first use.
+         * @return Stream session registry
+         */
+        static StreamSessionRegistry &instance();
+
+        /**
+         * @brief Keep a generator for a session. A generator the session already had is freed.
+         * @param session_id Client session
+         * @param generator Generator
+         * @param free_func Generator's free function
+         * @param owner Keeps the plugin loaded
+         * @return The session's stream
+         */
+        std::shared_ptr<StreamSession> attach(const std::string &session_id,
+                                              StreamGenerator generator,
+                                              StreamGeneratorFree free_func,
+                                              std::shared_ptr<const void> owner);
+
+        /**
+         * @brief Find the stream of a session and mark it active.
+         * @param session_id Client session
+         * @return Stream, nullptr if the session has none or it expired
+         */
+        std::shared_ptr<StreamSession> find(const std::string &session_id);
+
+        /**
+         * @brief Pump of a session's generator, started with start() if it has none yet.
+         * @param session_id Client session
+         * @param start Creates the pump
+         * @return Pump, nullptr if the session has no stream
+         */
+        std::shared_ptr<StreamPump> pump(const std::string &session_id,
+                                         const std::function<std::shared_ptr<StreamPump>()> &start);
+
+        /**
+         * @brief Forget the stream of a session whose generator the caller has freed already.
+         * @param session_id Client session
+         */
+        void forget(const std::string &session_id);
+
+        /**
+         * @brief Drop the stream of a session now: its generator and cached events are freed
+         *        on the housekeeping thread, and the stream cannot be resumed.
+         * @param session_id Client session
+         */
+        void release(const std::string &session_id);
+
+        /**
+         * @brief Streams kept.
+         */
+        std::size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr std::size_t kShards = 16;
+
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::shared_ptr<StreamSession>> sessions;
+        };
+
+        StreamSessionRegistry();
+
+        Shard &shard_of(const std::string &session_id) {
+            return shards_[std::hash<std::string>{}(session_id) % kShards];
+        }
+
+        /**
+         * @brief Remove a session's stream from its shard. The caller holds the shard's lock.
+         * @return The stream removed, nullptr if there was none
+         */
+        std::shared_ptr<StreamSession> take(Shard &shard, const std::string &session_id);
+
+        /**
+         * @brief Start the expiry timer of a stream. Housekeeping thread only.
+         */
+        void arm(const std::string &session_id, const std::shared_ptr<StreamSession> &stream);
+
+        /**
+         * @brief Free the generator of a stream dropped from its shard. Housekeeping thread only.
+         * @param expired The stream was dropped by its expiry timer, which is logged
+         */
+        static void dispose(const std::string &session_id, const std::shared_ptr<StreamSession> &stream, bool expired);
+
+        void publish_size();
+
+        std::array<Shard, kShards> shards_;
+        std::atomic<std::size_t> size_{0};
+        asio::any_io_executor executor_;///< Housekeeping executor, runs the expiry timers and frees generators
+    };
+
+}// namespace mcp::business
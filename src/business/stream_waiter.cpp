@@ -0,0 +1,71 @@
+// src/business/stream_waiter.cpp
+#include "stream_waiter.h"
+#include "core/logger.h"
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+#include <unistd.h>
+#endif
+
+namespace mcp::business {
+
+    asio::awaitable<void> StreamWaiter::wait(StreamGeneratorWait wait_func, StreamGenerator generator, std::chrono::milliseconds max_wait) {
+        auto executor = co_await asio::this_coro::executor;
+        auto timer = std::make_shared<asio::steady_timer>(executor, max_wait);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            woken_ = false;
+            timer_ = timer;
+        }
+
+        int fd = wait_func ? wait_func(generator, &StreamWaiter::wakeup, this) : -1;
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+        // Wait on a duplicate, the descriptor itself stays owned by the plugin
+        std::shared_ptr<asio::posix::stream_descriptor> descriptor;
+        if (fd >= 0) {
+            int copy = ::dup(fd);
+            if (copy >= 0) {
+                descriptor = std::make_shared<asio::posix::stream_descriptor>(executor, copy);
+                descriptor->async_wait(asio::posix::stream_descriptor::wait_read,
+                                       [timer, descriptor](const asio::error_code &) { timer->cancel(); });
+            } else {
+                MCP_WARN("Failed to duplicate stream wait descriptor {}, polling instead", fd);
+            }
+        }
+#else
+        if (fd >= 0) {
+            MCP_WARN("Stream wait descriptors are not supported on this platform, polling instead");
+        }
+#endif
+
+        bool woken;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            woken = woken_;
+        }
+        if (!woken) {
+            asio::error_code ec;
+            co_await timer->async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+        if (descriptor) {
+            asio::error_code ec;
+            descriptor->close(ec);
+        }
+#endif
+        std::lock_guard<std::mutex> lock(mutex_);
+        timer_.reset();
+    }
+
+    void StreamWaiter::wakeup(void *context) {
+        auto *waiter = static_cast<StreamWaiter *>(context);
+        std::lock_guard<std::mutex> lock(waiter->mutex_);
+        waiter->woken_ = true;
+        if (waiter->timer_) {
+            // The timer belongs to the consumer's executor, cancel it there
+            asio::post(waiter->timer_->get_executor(), [timer = waiter->timer_]() { timer->cancel(); });
+        }
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,45 @@
+// src/business/stream_waiter.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "mcp_plugin.h"
+#include <asio.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace mcp::business {
+
+    /**
+     * @brief Suspends a stream consumer while its generator has no data, see MCP_STREAM_WOULD_BLOCK.
+     * Passed to the plugin as the wakeup context, so it has to live as long as the generator;
+     * one waiter serves all consumers of a generator, one at a time.
+     */
+    class StreamWaiter {
+    public:
+        /**
+         * @brief Wait until the generator can make progress.
+         * Returns when the plugin calls the wakeup, the descriptor it returned becomes readable,
+         * or max_wait has passed, whichever comes first.
+         * @param wait_func Plugin's wait function, nullptr to just wait max_wait
+         * @param generator Generator that returned MCP_STREAM_WOULD_BLOCK
+         * @param max_wait Longest time to wait before next() is tried again
+         */
+        asio::awaitable<void> wait(StreamGeneratorWait wait_func, StreamGenerator generator, std::chrono::milliseconds max_wait);
+
+        /**
+         * @brief Wakeup function handed to the plugin. Thread safe.
+         * @param context The StreamWaiter
+         */
+        static void wakeup(void *context);
+
+    private:
+        std::mutex mutex_;
+        bool woken_ = false;                      ///< Set by wakeup() during the current wait
+        std::shared_ptr<asio::steady_timer> timer_;///< Timer of the wait in progress, cancelled to wake it
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,51 @@
+// src/business/tool_batcher.cpp
+#include "tool_batcher.h"
+#include "protocol/json_rpc.h"
+#include <exception>
+
+namespace mcp::business {
+
+    ToolOutput ToolBatcher::submit(const std::string &key, std::string args_json, const Run &run) {
+        const auto &options = ToolBatchOptions::current();
+        BatchedCall call{std::move(args_json), {}};
+        std::unique_lock lock(mutex_);
+
+        auto &slot = open_[key];
+        if (slot) {
+            auto batch = slot;
+            batch->calls.push_back(&call);
+            if (batch->calls.size() >= options.max_calls) {
+                open_.erase(key);
+                batch->full.notify_one();
+            }
+            done_.wait(lock, [&]() { return batch->done; });
+            return std::move(call.output);
+        }
+
+        auto batch = std::make_shared<Batch>();
+        slot = batch;
+        batch->calls.push_back(&call);
+        batch->full.wait_for(lock, options.window, [&]() { return batch->calls.size() >= options.max_calls; });
+        // Closed from here on, later calls open the next batch
+        if (auto it = open_.find(key); it != open_.end() && it->second == batch) {
+            open_.erase(it);
+        }
+        lock.unlock();
+
+        try {
+            run(batch->calls);
+        } catch (const std::exception &e) {
+            for (auto *entry: batch->calls) {
+                entry->output = ToolOutput{};
+                entry->output.error_code = -mcp::protocol::error_code::INTERNAL_ERROR;
+                entry->output.error_message = e.what();
+            }
+        }
+
+        lock.lock();
+        batch->done = true;
+        done_.notify_all();
+        return std::move(call.output);
+    }
+
+}// namespace mcp::business
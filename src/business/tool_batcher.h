@@ -0,0 +1,79 @@
+// src/business/tool_batcher.h
+#pragma once
+
+#include "tool_output.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::business {
+
+    /**
+     * @brief Micro-batching of plugin calls, normally taken from the [concurrency] section.
+     */
+    struct ToolBatchOptions {
+        std::chrono::microseconds window{0};///< How long the first call of a batch waits for more, 0 = no batching
+        size_t max_calls = 32;              ///< A batch this large runs at once
+
+        static const ToolBatchOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(ToolBatchOptions options) { storage() = options; }
+
+    private:
+        static ToolBatchOptions &storage() {
+            static ToolBatchOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief One call waiting in a batch.
+     */
+    struct BatchedCall {
+        std::string args_json;
+        ToolOutput output;
+    };
+
+    /**
+     * @brief Collects concurrent calls of a tool into batches, see call_tools_batch.
+     *
+     * The first call of a batch leads it: it waits up to the window for more calls of the same key
+     * to join, or until max_calls have, then runs them all on its own thread while the others wait
+     * for their outputs. Calls that arrive while a batch runs start the next one.
+     */
+    class ToolBatcher {
+    public:
+        using Run = std::function<void(const std::vector<BatchedCall *> &calls)>;
+
+        /**
+         * @brief Run a call as part of a batch, blocking until its output is there.
+         * @param key Calls of one key are batched together
+         * @param args_json Arguments of the call
+         * @param run Runs a batch, fills in the output of every call; only the leader's is used
+         * @return Output of this call
+         */
+        ToolOutput submit(const std::string &key, std::string args_json, const Run &run);
+
+    private:
+        struct Batch {
+            std::vector<BatchedCall *> calls;
+            std::condition_variable full;///< Wakes the leader once max_calls have joined
+            bool done = false;
+        };
+
+        std::mutex mutex_;
+        std::condition_variable done_;
+        std::unordered_map<std::string, std::shared_ptr<Batch>> open_;///< Batches still taking calls, by key
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,92 @@
+// src/business/tool_deadline.cpp
+#include "tool_deadline.h"
+#include "core/logger.h"
+#include "core/tool_thread_pool.hpp"
+#include "metrics/metrics_manager.h"
+#include <mutex>
+#include <optional>
+
+namespace mcp::business {
+
+    namespace {
+        // Outcome of one call racing its deadline, shared by the waiter and the call
+        struct DeadlineRace {
+            std::mutex mutex;
+            std::shared_ptr<asio::steady_timer> timer;///< Waiter's timer, dropped once it gave up
+            std::optional<protocol::Response> response;
+            bool abandoned = false;///< The deadline passed first, the response is dropped
+        };
+    }// namespace
+
+    asio::awaitable<protocol::Response> run_with_deadline(const std::string &tool_name,
+                                                          std::chrono::milliseconds timeout,
+                                                          std::function<asio::awaitable<protocol::Response>()> call,
+                                                          std::shared_ptr<CancellationToken> cancel,
+                                                          const nlohmann::json &id) {
+        // The wait and the cancel of a call that returned both run on this strand, so the cancel
+        // never races the wait being set up, nor comes before it and gets lost
+        auto strand = asio::make_strand(co_await asio::this_coro::executor);
+        auto timer = std::make_shared<asio::steady_timer>(strand, timeout);
+        auto race = std::make_shared<DeadlineRace>();
+        race->timer = timer;
+        auto counters = metrics::MetricsManager::getInstance()->register_tool_timeout_counters(tool_name);
+        auto started = std::chrono::steady_clock::now();
+
+        asio::co_spawn(core::ToolThreadPool::instance().executor(), std::move(call),
+                       [race, counters, started, timeout, tool_name](std::exception_ptr error, protocol::Response response) {
+                           if (error) {
+                               try {
+                                   std::rethrow_exception(error);
+                               } catch (const std::exception &e) {
+                                   response = protocol::Response{protocol::Error{protocol::error_code::INTERNAL_ERROR, e.what()}, nullptr};
+                               }
+                           }
+
+                           std::lock_guard<std::mutex> lock(race->mutex);
+                           if (race->abandoned) {
+                               auto overrun = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started) - timeout;
+                               counters->running.fetch_sub(1, std::memory_order_relaxed);
+                               counters->overrun_ms.fetch_add(static_cast<uint64_t>(overrun.count()), std::memory_order_relaxed);
+                               MCP_INFO("Tool {} returned {} ms after its deadline", tool_name, overrun.count());
+                               return;
+                           }
+                           race->response = std::move(response);
+                           // The timer belongs to the waiter's strand, cancel it there
+                           asio::post(race->timer->get_executor(), [timer = race->timer]() { timer->cancel(); });
+                       });
+
+        std::function<asio::awaitable<void>()> wait = [race, timer]() -> asio::awaitable<void> {
+            {
+                std::lock_guard<std::mutex> lock(race->mutex);
+                if (race->response) {
+                    co_return;// Returned before the wait started, its cancel has run already
+                }
+            }
+            asio::error_code ec;
+            co_await timer->async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        };
+        co_await asio::co_spawn(strand, wait, asio::use_awaitable);
+        {
+            std::lock_guard<std::mutex> lock(race->mutex);
+            if (race->response) {
+                protocol::Response response = std::move(*race->response);
+                response.id = id;
+                co_return response;
+            }
+            // The timer may belong to a private io_context that is gone by the time the call returns
+            race->abandoned = true;
+            race->timer.reset();
+            counters->timeouts.fetch_add(1, std::memory_order_relaxed);
+            counters->running.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        MCP_WARN("Tool {} missed its deadline of {} ms", tool_name, timeout.count());
+        if (cancel) {
+            cancel->cancel();
+        }
+        co_return protocol::Response{protocol::Error{protocol::error_code::TIMEOUT,
+                                                     "Tool call exceeded its deadline of " + std::to_string(timeout.count()) + " ms"},
+                                     id};
+    }
+
+}// namespace mcp::business
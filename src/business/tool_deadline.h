@@ -0,0 +1,71 @@
+// src/business/tool_deadline.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "cancellation.h"
+#include "protocol/json_rpc.h"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace mcp::business {
+
+    /**
+     * @brief Deadlines of synchronous tool calls, normally taken from the [concurrency] section.
+     */
+    struct ToolDeadlineOptions {
+        std::chrono::milliseconds timeout{0};                            ///< Deadline of every tool call, 0 = none
+        std::unordered_map<std::string, std::chrono::milliseconds> tools;///< Per-tool deadlines, override timeout
+
+        /**
+         * @brief Deadline of a tool.
+         * @param tool_name Tool name
+         * @return Deadline, 0 if calls of the tool are not limited
+         */
+        std::chrono::milliseconds for_tool(const std::string &tool_name) const {
+            auto it = tools.find(tool_name);
+            return it != tools.end() ? it->second : timeout;
+        }
+
+        static const ToolDeadlineOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(ToolDeadlineOptions options) { storage() = std::move(options); }
+
+    private:
+        static ToolDeadlineOptions &storage() {
+            static ToolDeadlineOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Run a tool call on the tool pool and stop waiting for it at its deadline.
+     *
+     * The awaiting coroutine races the call against a timer on its own executor. When the timer
+     * wins, the request is answered with a TIMEOUT error and its cancellation token is set, so a
+     * plugin polling it returns early; a plugin that does not keeps its pool thread until it
+     * returns, and its result is dropped. Missed deadlines are counted per tool in MetricsManager.
+     * @param tool_name Tool name, for metrics and logs
+     * @param timeout Deadline, must be positive
+     * @param call Runs the tool; must own everything it refers to, it may outlive the request
+     * @param cancel Token of the request, may be nullptr
+     * @param id JSON-RPC id of the request
+     * @return Response of the call, or a TIMEOUT error
+     */
+    asio::awaitable<protocol::Response> run_with_deadline(const std::string &tool_name,
+                                                          std::chrono::milliseconds timeout,
+                                                          std::function<asio::awaitable<protocol::Response>()> call,
+                                                          std::shared_ptr<CancellationToken> cancel,
+                                                          const nlohmann::json &id);
+
+}// namespace mcp::business
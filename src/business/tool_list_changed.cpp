@@ -0,0 +1,56 @@
+#include "tool_list_changed.h"
+#include "core/logger.h"
+#include "transport/notification_broadcast.h"
+
+namespace mcp::business {
+
+    std::shared_ptr<const std::string> encode_tool_list_changed(const ToolRegistrySnapshot &before,
+                                                               const ToolRegistrySnapshot &after) {
+        nlohmann::json notification = {{"jsonrpc", "2.0"}, {"method", "notifications/tools/list_changed"}};
+        const auto &options = ToolListChangedOptions::current();
+        if (!options.delta) {
+            return transport::NotificationBroadcast::encode(notification);
+        }
+
+        nlohmann::json added = nlohmann::json::array();
+        nlohmann::json removed = nlohmann::json::array();
+        size_t changes = 0;
+        for (const auto &[name, entry]: after.tools) {
+            auto it = before.tools.find(name);
+            if (it == before.tools.end() || it->second != entry) {
+                if (++changes > options.max_delta) {
+                    break;
+                }
+                added.push_back(protocol::to_list_entry(entry->metadata));
+            }
+        }
+        for (const auto &[name, entry]: before.tools) {
+            if (changes > options.max_delta) {
+                break;
+            }
+            if (!after.tools.count(name)) {
+                ++changes;
+                removed.push_back(name);
+            }
+        }
+
+        if (changes > options.max_delta) {
+            // Listing again is cheaper for the client than a delta this large
+            notification["params"] = {{"_meta", {{"version", after.version}}}};
+        } else {
+            notification["params"] = {{"_meta", {{"version", after.version},
+                                                 {"previousVersion", before.version},
+                                                 {"added", std::move(added)},
+                                                 {"removed", std::move(removed)}}}};
+        }
+        return transport::NotificationBroadcast::encode(notification);
+    }
+
+    void broadcast_tool_list_changes(ToolRegistry &registry) {
+        registry.set_change_listener([](const ToolRegistrySnapshot &before, const ToolRegistrySnapshot &after) {
+            size_t streams = transport::NotificationBroadcast::instance().broadcast(encode_tool_list_changed(before, after));
+            MCP_DEBUG("Tool list changed to version {}, notified {} event streams", after.version, streams);
+        });
+    }
+
+}// namespace mcp::business
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "tool_registry.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace mcp::business {
+
+    /**
+     * @brief What notifications/tools/list_changed carries, normally taken from the [server] config section.
+     */
+    struct ToolListChangedOptions {
+        bool delta = false;      ///< Attach the tools added and removed, so clients need not list again
+        size_t max_delta = 256;  ///< Changes with more tools than this are sent without a delta
+
+        static const ToolListChangedOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         */
+        static void configure(const ToolListChangedOptions &options) { storage() = options; }
+
+    private:
+        static ToolListChangedOptions &storage() {
+            static ToolListChangedOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief notifications/tools/list_changed for one registry change.
+     *
+     * With deltas on, params._meta holds the registry version before and after the change, the
+     * tools/list entries of the tools that were added or changed (replace by name) and the names
+     * of the tools that were removed. A client whose cached list is at previousVersion (the
+     * version in _meta of a tools/list result) applies the delta and is at version; any other
+     * client, and every client for a notification without a delta, lists again. Entries are
+     * shared between registry versions, so the delta is found by comparing pointers.
+     * @param before Registry before the change
+     * @param after Registry after the change
+     * @return Serialized notification
+     */
+    std::shared_ptr<const std::string> encode_tool_list_changed(const ToolRegistrySnapshot &before,
+                                                               const ToolRegistrySnapshot &after);
+
+    /**
+     * @brief Broadcast notifications/tools/list_changed on every later change of a registry.
+     */
+    void broadcast_tool_list_changes(ToolRegistry &registry);
+
+}// namespace mcp::business
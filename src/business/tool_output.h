@@ -0,0 +1,112 @@
+// src/business/tool_output.h
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <string>
+
+namespace mcp::business {
+
+    /**
+     * @brief Result bytes of a synchronous tool call, before any parsing.
+     */
+    struct ToolOutput {
+        std::string json;        ///< Result JSON as written by the plugin
+        bool passthrough = false;///< Plugin marked the output as a complete tools/call result
+        int error_code = 0;      ///< Non-zero if the call failed
+        std::string error_message;
+    };
+
+    /**
+     * @brief Server side of MCPOutput: plugins append straight into the result string.
+     *
+     * With a limit, a write or reserve that would take the result past it fails as if the server
+     * were out of memory, so a plugin producing too much stops before it is all held.
+     */
+    struct OutputArena {
+        std::string &buffer;
+        size_t committed = 0; ///< Bytes that belong to the result; the rest is reserved scratch
+        size_t limit = 0;     ///< Most bytes the result may have, 0 = unlimited
+        bool exceeded = false;///< The plugin tried to go past the limit
+
+        bool fits(size_t more) {
+            exceeded |= limit > 0 && more > limit - std::min(committed, limit);
+            return !exceeded;
+        }
+
+        static bool write(void *context, const char *data, size_t size) {
+            auto *arena = static_cast<OutputArena *>(context);
+            if (!arena->fits(size)) {
+                return false;
+            }
+            try {
+                arena->buffer.resize(arena->committed);
+                arena->buffer.append(data, size);
+            } catch (const std::exception &) {
+                return false;// Must not unwind into the plugin
+            }
+            arena->committed = arena->buffer.size();
+            return true;
+        }
+
+        static char *reserve(void *context, size_t capacity) {
+            auto *arena = static_cast<OutputArena *>(context);
+            if (!arena->fits(capacity)) {
+                return nullptr;
+            }
+            try {
+                arena->buffer.resize(arena->committed + capacity);
+            } catch (const std::exception &) {
+                return nullptr;
+            }
+            return arena->buffer.data() + arena->committed;
+        }
+
+        static void commit(void *context, size_t size) {
+            auto *arena = static_cast<OutputArena *>(context);
+            arena->committed = std::min(arena->committed + size, arena->buffer.size());
+        }
+
+        void finish() { buffer.resize(committed); }
+    };
+
+    /**
+     * @brief How tools/call treats raw tool output and stream events, normally taken from ServerConfig.
+     */
+    struct ToolOutputOptions {
+        /// Check that output marked as passthrough is valid JSON with a content array before it is
+        /// spliced into the response. Turning this off trusts the plugin and skips the scan entirely.
+        bool validate_passthrough = true;
+
+        /// Streaming tools: the most events pulled from a generator and sent with one write.
+        size_t stream_batch_max_items = 1;
+
+        /// Streaming tools: how long a batch keeps pulling after its first event. The deadline is checked
+        /// between calls to the generator, so a generator that blocks holds the batch until it returns.
+        std::chrono::microseconds stream_batch_max_delay{0};
+
+        /// Synchronous tools: results serialized beyond this many bytes are sent as a chunked HTTP
+        /// response while they are serialized, 0 = always buffered with Content-Length.
+        size_t result_stream_threshold = 1024 * 1024;
+
+        /// Synchronous tools: result bytes serialized and sent per chunk of a chunked response.
+        size_t result_stream_chunk = 64 * 1024;
+
+        static const ToolOutputOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(ToolOutputOptions options) { storage() = options; }
+
+    private:
+        static ToolOutputOptions &storage() {
+            static ToolOutputOptions options;
+            return options;
+        }
+    };
+
+}// namespace mcp::business
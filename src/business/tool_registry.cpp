@@ -1,22 +1,83 @@
 #include "tool_registry.h"
 #include "core/logger.h"
+#include "protocol/json_rpc.h"
 
 namespace mcp::business {
 
-    void ToolRegistry::register_builtin(const mcp::protocol::Tool &tool, ToolExecutor exec) {
-        if (tools_.count(tool.name)) {
-            MCP_WARN("Built-in tool '{}' already exists, overwriting", tool.name);
+    void ToolRegistry::modify(const std::function<bool(std::unordered_map<std::string, std::shared_ptr<const RegisteredTool>> &)> &change) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto current = snapshot_.load(std::memory_order_acquire);
+        auto next = std::make_shared<ToolRegistrySnapshot>(*current);
+        if (!change(next->tools)) {
+            return;
+        }
+        next->version = current->version + 1;
+        snapshot_.store(next, std::memory_order_release);
+        published_.fetch_add(1, std::memory_order_release);
+        if (change_listener_) {
+            change_listener_(*current, *next);
         }
-        tools_[tool.name] = {tool, std::move(exec)};
-        MCP_TRACE("Registered builtin tool: {}", tool.name);
     }
 
-    void ToolRegistry::register_plugin_tool(const ToolInfo &info, ToolExecutor exec) {
-        try {
+    const ToolRegistrySnapshot &ToolRegistry::thread_snapshot() const {
+        struct Copy {
+            uint64_t registry = 0;
+            uint64_t published = 0;
+            std::shared_ptr<const ToolRegistrySnapshot> snapshot;
+        };
+        thread_local Copy copy;
+        // Read before the snapshot, so a copy is never older than the count it is kept for
+        uint64_t published = published_.load(std::memory_order_acquire);
+        if (copy.registry != id_ || copy.published != published || !copy.snapshot) {
+            copy.snapshot = snapshot();
+            copy.registry = id_;
+            copy.published = published;
+        }
+        return *copy.snapshot;
+    }
+
+    void ToolRegistry::set_change_listener(ChangeListener listener) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        change_listener_ = std::move(listener);
+    }
+
+    std::shared_ptr<const SchemaValidator> ToolRegistry::make_validator(const mcp::protocol::Tool &tool) {
+        if (tool.parameters.is_null()) {
+            return nullptr;
+        }
+        // Tools of a plugin often share a schema, and reloads bring the same ones back
+        std::string key = tool.parameters.dump();
+        std::lock_guard<std::mutex> lock(validators_mutex_);
+        auto &cached = validators_[key];
+        if (auto validator = cached.lock()) {
+            return validator;
+        }
+        auto validator = SchemaValidator::compile(tool.parameters);
+        if (validator->trivial()) {
+            validators_.erase(key);
+            return nullptr;
+        }
+        cached = validator;
+        // Drop the entries of schemas no tool uses any more
+        if (validators_.size() > 2 * validators_live_ + 64) {
+            std::erase_if(validators_, [](const auto &entry) { return entry.second.expired(); });
+            validators_live_ = validators_.size();
+        }
+        return validator;
+    }
+
+    namespace {
+        // Build a registry entry from plugin tool info; nullptr if the info is invalid. The executors are
+        // made for the entry's own copy of the name, which they may keep a pointer to
+        template<typename MakeValidator>
+        std::shared_ptr<const RegisteredTool> make_plugin_entry(const ToolInfo &info,
+                                                                 const std::function<ToolExecutor(const std::string &)> &make_executor,
+                                                                 const std::function<RawToolExecutor(const std::string &)> &make_raw_executor,
+                                                                 const MakeValidator &make_validator) {
             // make sure the tool name is valid
             if (info.name == nullptr || info.name[0] == '\0') {
                 MCP_ERROR("Invalid tool name (empty or null)");
-                return;
+                return nullptr;
             }
             std::string tool_name = info.name;
 
@@ -31,58 +92,230 @@ namespace mcp::business {
                 } catch (const nlohmann::json::parse_error &e) {
                     MCP_ERROR("Failed to parse parameters for tool '{}': {}", tool_name, e.what());
                     MCP_ERROR("Invalid parameters: {}", info.parameters);
-                    return;
+                    return nullptr;
                 }
             }
+            auto entry = std::make_shared<RegisteredTool>();
+            entry->metadata = std::move(tool);
+            entry->executor = make_executor(entry->metadata.name);
+            entry->raw_executor = make_raw_executor ? make_raw_executor(entry->metadata.name) : nullptr;
+            entry->arguments_validator = make_validator(entry->metadata);
+            return entry;
+        }
+    }// namespace
 
-            // insert the tool into the registry
-            if (tools_.count(tool_name)) {
-                MCP_WARN("Plugin tool '{}' already exists, overwriting", tool_name);
+    void ToolRegistry::register_builtin(const mcp::protocol::Tool &tool, ToolExecutor exec) {
+        auto entry = std::make_shared<const RegisteredTool>(RegisteredTool{tool, std::move(exec), nullptr,
+                                                                           validate_arguments_ ? make_validator(tool) : nullptr});
+        modify([&](auto &tools) {
+            if (tools.count(tool.name)) {
+                MCP_WARN("Built-in tool '{}' already exists, overwriting", tool.name);
+            }
+            tools[tool.name] = std::move(entry);
+            return true;
+        });
+        MCP_TRACE("Registered builtin tool: {}", tool.name);
+    }
+
+    void ToolRegistry::register_plugin_tool(const ToolInfo &info, ToolExecutor exec) {
+        try {
+            auto entry = make_plugin_entry(
+                    info, [&](const std::string &) { return std::move(exec); }, nullptr,
+                    [this](const mcp::protocol::Tool &tool) { return validate_arguments_ ? make_validator(tool) : nullptr; });
+            if (!entry) {
+                return;
             }
-            tools_[tool_name] = {tool, std::move(exec)};
+            const std::string &tool_name = entry->metadata.name;
+
+            // insert the tool into the registry
+            size_t registry_size = 0;
+            modify([&](auto &tools) {
+                if (tools.count(tool_name)) {
+                    MCP_WARN("Plugin tool '{}' already exists, overwriting", tool_name);
+                }
+                tools[tool_name] = entry;
+                registry_size = tools.size();
+                return true;
+            });
             MCP_TRACE("Registered plugin tool: {}", tool_name);
-            MCP_TRACE("Current registry size after adding '{}': {}", tool_name, tools_.size());
+            MCP_TRACE("Current registry size after adding '{}': {}", tool_name, registry_size);
 
         } catch (const std::exception &e) {
             MCP_ERROR("Unexpected error registering tool: {}", e.what());
         }
     }
 
+    std::vector<std::shared_ptr<const RegisteredTool>> ToolRegistry::make_plugin_entries(
+            const std::vector<ToolInfo> &infos,
+            const std::function<ToolExecutor(const std::string &)> &make_executor,
+            const std::function<RawToolExecutor(const std::string &)> &make_raw_executor) {
+        std::vector<std::shared_ptr<const RegisteredTool>> entries;
+        entries.reserve(infos.size());
+        for (const auto &info: infos) {
+            try {
+                if (info.name == nullptr) {
+                    MCP_WARN("Skipping tool with null name");
+                    continue;
+                }
+                auto validator = [this](const mcp::protocol::Tool &tool) { return validate_arguments_ ? make_validator(tool) : nullptr; };
+                if (auto entry = make_plugin_entry(info, make_executor, make_raw_executor, validator)) {
+                    entries.push_back(std::move(entry));
+                }
+            } catch (const std::exception &e) {
+                MCP_ERROR("Unexpected error registering tool: {}", e.what());
+            }
+        }
+        return entries;
+    }
+
+    size_t ToolRegistry::register_plugin_tools(const std::vector<ToolInfo> &infos,
+                                               const std::function<ToolExecutor(const std::string &)> &make_executor,
+                                               const std::function<RawToolExecutor(const std::string &)> &make_raw_executor) {
+        // Parse everything first, then publish a single new version
+        auto entries = make_plugin_entries(infos, make_executor, make_raw_executor);
+
+        modify([&](auto &tools) {
+            for (auto &entry: entries) {
+                if (tools.count(entry->metadata.name)) {
+                    MCP_WARN("Plugin tool '{}' already exists, overwriting", entry->metadata.name);
+                }
+                tools[entry->metadata.name] = entry;
+            }
+            return !entries.empty();
+        });
+        MCP_DEBUG("Registered {} plugin tools", entries.size());
+        return entries.size();
+    }
+
+    size_t ToolRegistry::reload_plugin_tools(const std::vector<std::string> &removed,
+                                             const std::vector<ToolInfo> &infos,
+                                             const std::function<ToolExecutor(const std::string &)> &make_executor,
+                                             const std::function<RawToolExecutor(const std::string &)> &make_raw_executor) {
+        auto entries = make_plugin_entries(infos, make_executor, make_raw_executor);
+
+        modify([&](auto &tools) {
+            size_t erased = 0;
+            for (const auto &name: removed) {
+                erased += tools.erase(name);
+            }
+            for (auto &entry: entries) {
+                tools[entry->metadata.name] = entry;
+            }
+            return erased > 0 || !entries.empty();
+        });
+        MCP_INFO("Reloaded plugin tools: {} removed, {} registered", removed.size(), entries.size());
+        return entries.size();
+    }
+
+    bool ToolRegistry::unregister_tool(const std::string &name) {
+        bool removed = false;
+        modify([&](auto &tools) {
+            removed = tools.erase(name) > 0;
+            return removed;
+        });
+        if (removed) {
+            MCP_TRACE("Unregistered tool: {}", name);
+        }
+        return removed;
+    }
+
+    std::vector<std::string> ToolRegistry::replace_tools(const std::vector<std::string> &previous, std::vector<RegisteredTool> tools) {
+        std::vector<std::shared_ptr<const RegisteredTool>> entries;
+        entries.reserve(tools.size());
+        for (auto &tool: tools) {
+            if (validate_arguments_ && !tool.arguments_validator) {
+                tool.arguments_validator = make_validator(tool.metadata);
+            }
+            entries.push_back(std::make_shared<const RegisteredTool>(std::move(tool)));
+        }
+
+        std::vector<std::string> names;
+        modify([&](auto &all) {
+            for (const auto &name: previous) {
+                all.erase(name);
+            }
+            for (auto &entry: entries) {
+                const std::string &name = entry->metadata.name;
+                if (all.count(name)) {
+                    MCP_WARN("Tool '{}' already exists, not replacing it", name);
+                    continue;
+                }
+                all[name] = std::move(entry);
+                names.push_back(name);
+            }
+            return !previous.empty() || !names.empty();
+        });
+        return names;
+    }
+
     std::optional<nlohmann::json> ToolRegistry::execute(const std::string &name, const nlohmann::json &args) {
-        MCP_DEBUG("Querying tool: '{}' (registry size: {})", name, tools_.size());
+        // Hold the snapshot for the duration of the call so a concurrent reload cannot free the executor
+        auto current = snapshot();
+        MCP_DEBUG("Querying tool: '{}' (registry size: {})", name, current->tools.size());
 
-        auto it = tools_.find(name);
-        if (it == tools_.end()) {
+        auto it = current->tools.find(name);
+        if (it == current->tools.end()) {
             MCP_ERROR("Tool not found: '{}'", name);
             return std::nullopt;
         }
 
         try {
-            return it->second.executor(args);
+            return it->second->executor(args);
         } catch (const std::exception &e) {
             MCP_ERROR("Error executing tool '{}': {}", name, e.what());
             return std::nullopt;
         }
     }
 
+    std::optional<ToolOutput> ToolRegistry::execute_raw(const std::string &name, const nlohmann::json &args) {
+        auto current = snapshot();
+        auto it = current->tools.find(name);
+        if (it == current->tools.end() || !it->second->raw_executor) {
+            return std::nullopt;
+        }
+
+        try {
+            return it->second->raw_executor(args);
+        } catch (const std::exception &e) {
+            MCP_ERROR("Error executing tool '{}': {}", name, e.what());
+            ToolOutput output;
+            output.error_code = protocol::error_code::INTERNAL_ERROR;
+            output.error_message = e.what();
+            return output;
+        }
+    }
+
     std::vector<std::string> ToolRegistry::get_all_tool_names() const {
+        auto current = snapshot();
         std::vector<std::string> names;
-        for (const auto &[name, _]: tools_) {
+        names.reserve(current->tools.size());
+        for (const auto &[name, _]: current->tools) {
             names.push_back(name);
         }
         return names;
     }
-    std::shared_ptr<mcp::protocol::Tool> ToolRegistry::get_tool_info(const std::string &name) const {
-        auto it = tools_.find(name);
-        if (it != tools_.end()) {
-            return std::make_shared<mcp::protocol::Tool>(it->second.metadata);
+    std::shared_ptr<const mcp::protocol::Tool> ToolRegistry::get_tool_info(const std::string &name) const {
+        std::shared_ptr<const ToolRegistrySnapshot> held;
+        const ToolRegistrySnapshot &current = per_thread_snapshots_ ? thread_snapshot() : *(held = snapshot());
+        auto it = current.tools.find(name);
+        if (it != current.tools.end()) {
+            // Share ownership of the entry instead of copying the metadata
+            return {it->second, &it->second->metadata};
         }
         return nullptr;
     }
+    std::shared_ptr<const RegisteredTool> ToolRegistry::get_tool(const std::string &name) const {
+        std::shared_ptr<const ToolRegistrySnapshot> held;
+        const ToolRegistrySnapshot &current = per_thread_snapshots_ ? thread_snapshot() : *(held = snapshot());
+        auto it = current.tools.find(name);
+        return it != current.tools.end() ? it->second : nullptr;
+    }
     std::vector<mcp::protocol::Tool> ToolRegistry::get_all_tools() const {
+        auto current = snapshot();
         std::vector<mcp::protocol::Tool> all_tools;
-        for (const auto &[name, registered_tool]: tools_) {
-            all_tools.push_back(registered_tool.metadata);
+        all_tools.reserve(current->tools.size());
+        for (const auto &[name, registered_tool]: current->tools) {
+            all_tools.push_back(registered_tool->metadata);
         }
         return all_tools;
     }
@@ -3,7 +3,14 @@
 
 #include "mcp_plugin.h"
 #include "protocol/tool.h"
+#include "schema_validator.h"
+#include "tool_output.h"
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -13,17 +20,33 @@ namespace mcp::business {
 
     // Tool execution function signature
     using ToolExecutor = std::function<nlohmann::json(const nlohmann::json &)>;
+    // Tool execution returning the result unparsed, so it can be spliced into the response
+    using RawToolExecutor = std::function<ToolOutput(const nlohmann::json &)>;
 
     // Tool metadata + executor
     struct RegisteredTool {
         mcp::protocol::Tool metadata;
         ToolExecutor executor;
+        RawToolExecutor raw_executor = nullptr;// Optional, set for plugin tools
+        std::shared_ptr<const SchemaValidator> arguments_validator;// Compiled from metadata.parameters, nullptr if not checked
     };
 
     class PluginManager;
 
+    /**
+     * @brief Immutable view of the registry at one point in time.
+     * Entries are shared between versions, so publishing a change only copies pointers.
+     */
+    struct ToolRegistrySnapshot {
+        std::unordered_map<std::string, std::shared_ptr<const RegisteredTool>> tools;
+        uint64_t version = 0;///< Incremented on every published change
+    };
+
     class ToolRegistry {
     public:
+        // Called with the versions before and after each published change
+        using ChangeListener = std::function<void(const ToolRegistrySnapshot &before, const ToolRegistrySnapshot &after)>;
+
         // Register built-in tools
         void register_builtin(const mcp::protocol::Tool &tool, ToolExecutor exec);
 
@@ -32,16 +55,130 @@ namespace mcp::business {
 
         // Plugin tools loaded from PluginManager
         void register_plugin_tool(const ToolInfo &info, ToolExecutor exec);
+        // Register many plugin tools as one registry version; returns the number registered. The executors
+        // are made for the name stored in the tool's entry, which lives as long as they do
+        size_t register_plugin_tools(const std::vector<ToolInfo> &infos,
+                                     const std::function<ToolExecutor(const std::string &)> &make_executor,
+                                     const std::function<RawToolExecutor(const std::string &)> &make_raw_executor = nullptr);
+        /**
+         * @brief Swap the tools of reloaded plugins as one registry version.
+         * @param removed Names the plugins had before, removed unless registered again
+         * @param infos Tools the plugins have now; entries are made like register_plugin_tools() does
+         * @return Number of tools registered
+         */
+        size_t reload_plugin_tools(const std::vector<std::string> &removed,
+                                   const std::vector<ToolInfo> &infos,
+                                   const std::function<ToolExecutor(const std::string &)> &make_executor,
+                                   const std::function<RawToolExecutor(const std::string &)> &make_raw_executor = nullptr);
         std::vector<std::string> get_all_tool_names() const;
         // Get all tools as protocol::Tool objects for debugging
         std::vector<mcp::protocol::Tool> get_all_tools() const;
-        // Execute tool
-        std::shared_ptr<mcp::protocol::Tool> get_tool_info(const std::string &name) const;
+        // Remove a tool, e.g. when its plugin is unloaded
+        bool unregister_tool(const std::string &name);
+        /**
+         * @brief Replace one group of tools with another as a single registry version, e.g. the
+         *        tools of a remote server after it was listed again. Tools outside the group keep
+         *        their names; a new tool naming one of them is skipped.
+         * @param previous Names the group had, removed unless registered again
+         * @param tools New entries of the group; their validators are compiled here
+         * @return Names the group has now
+         */
+        std::vector<std::string> replace_tools(const std::vector<std::string> &previous, std::vector<RegisteredTool> tools);
+        // Metadata of a tool; shares ownership of its entry, so it allocates nothing
+        std::shared_ptr<const mcp::protocol::Tool> get_tool_info(const std::string &name) const;
+        // Registry entry of a tool, nullptr if it does not exist
+        std::shared_ptr<const RegisteredTool> get_tool(const std::string &name) const;
+
+        /**
+         * @brief Check the arguments of every call against the tool's parameters schema before it is
+         *        dispatched. The schemas are compiled when tools are registered, so set this first.
+         * @param enable false registers tools without a validator
+         */
+        void set_argument_validation(bool enable) { validate_arguments_ = enable; }
         std::optional<nlohmann::json> execute(const std::string &name, const nlohmann::json &args);
 
+        /**
+         * @brief Execute a tool through its raw executor, leaving the result unparsed.
+         * @param name Tool name
+         * @param args Tool arguments
+         * @return Output, or std::nullopt if the tool does not exist or has no raw executor (use execute())
+         */
+        std::optional<ToolOutput> execute_raw(const std::string &name, const nlohmann::json &args);
+
+        /**
+         * @brief Get the current snapshot. Wait-free; the snapshot stays valid while it is held.
+         * @return Current registry snapshot
+         */
+        std::shared_ptr<const ToolRegistrySnapshot> snapshot() const {
+            return snapshot_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Version of the current snapshot, changes whenever a tool is added or removed.
+         * @return Registry version
+         */
+        uint64_t version() const { return per_thread_snapshots_ ? thread_snapshot().version : snapshot()->version; }
+
+        /**
+         * @brief Have lookups read a copy of the snapshot kept by each thread, for the shared-nothing
+         *        server mode. A thread takes the current snapshot again only when a change was published
+         *        since, so io threads no longer share the reference count of the current snapshot on every
+         *        lookup, only a counter that is written once per change. A thread keeps the version it last
+         *        looked at alive until its next lookup. Set before requests are served.
+         * @param enable true for per-thread copies
+         */
+        void set_per_thread_snapshots(bool enable) { per_thread_snapshots_ = enable; }
+
+        /**
+         * @brief Have every later change reported, e.g. to notify clients. Called on the writing
+         *        thread with the writers serialized, so changes arrive in version order.
+         * @param listener Listener, nullptr for none
+         */
+        void set_change_listener(ChangeListener listener);
+
     private:
-        std::unordered_map<std::string, RegisteredTool> tools_;
+        /**
+         * @brief Copy the current snapshot, apply a change and publish the result.
+         * Writers are serialized; readers are never blocked.
+         * @param change Modification applied to the copied tool map, returns false to discard it
+         */
+        void modify(const std::function<bool(std::unordered_map<std::string, std::shared_ptr<const RegisteredTool>> &)> &change);
+
+        std::vector<std::shared_ptr<const RegisteredTool>> make_plugin_entries(
+                const std::vector<ToolInfo> &infos,
+                const std::function<ToolExecutor(const std::string &)> &make_executor,
+                const std::function<RawToolExecutor(const std::string &)> &make_raw_executor);
+
+        /**
+         * @brief Compile the parameters schema of a tool, so calls are checked without reaching the plugin.
+         * Tools with the same schema share one validator.
+         * @return Validator, nullptr if the schema checks nothing
+         */
+        std::shared_ptr<const SchemaValidator> make_validator(const mcp::protocol::Tool &tool);
+
+        /**
+         * @brief The calling thread's copy of the current snapshot, see set_per_thread_snapshots().
+         * Valid until the thread's next call.
+         */
+        const ToolRegistrySnapshot &thread_snapshot() const;
+
+        std::atomic<std::shared_ptr<const ToolRegistrySnapshot>> snapshot_{std::make_shared<const ToolRegistrySnapshot>()};
+        std::atomic<uint64_t> published_{0};///< Changes published, tells threads their copy is out of date
+        const uint64_t id_ = next_id();     ///< Tells the copies of different registries apart
+        bool per_thread_snapshots_ = false;
+        std::mutex write_mutex_;///< Serializes modify()
+        ChangeListener change_listener_;///< Guarded by write_mutex_
         std::shared_ptr<PluginManager> plugin_manager_;
+        bool validate_arguments_ = true;
+        std::mutex validators_mutex_;
+        std::unordered_map<std::string, std::weak_ptr<const SchemaValidator>> validators_;///< By serialized schema
+        size_t validators_live_ = 0;                                                       ///< Size after the last sweep
+
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
     };
 
 }// namespace mcp::business
\ No newline at end of file
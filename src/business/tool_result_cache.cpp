@@ -0,0 +1,100 @@
+// src/business/tool_result_cache.cpp
+#include "tool_result_cache.h"
+#include "core/logger.h"
+#include "metrics/metrics_manager.h"
+
+namespace mcp::business {
+
+    ToolResultCacheOptions &ToolResultCache::pending_options() {
+        static ToolResultCacheOptions options;
+        return options;
+    }
+
+    void ToolResultCache::configure(ToolResultCacheOptions options) {
+        pending_options() = std::move(options);
+    }
+
+    ToolResultCache &ToolResultCache::instance() {
+        static ToolResultCache cache(pending_options());
+        return cache;
+    }
+
+    ToolResultCache::ToolResultCache(ToolResultCacheOptions options)
+        : options_(std::move(options)),
+          results_(Astra::datastructures::MemoryBudget{options_.max_bytes}),
+          counters_(metrics::MetricsManager::getInstance()->register_cache_counters("tool_results")) {
+        if (!options_.tools.empty()) {
+            results_.StartCleanupThread();
+            MCP_INFO("Tool result cache enabled for {} tools ({} bytes)", options_.tools.size(), options_.max_bytes);
+        }
+    }
+
+    void ToolResultCache::set_max_bytes(std::size_t max_bytes) {
+        results_.setByteBudget(max_bytes);
+    }
+
+    protocol::Response ToolResultCache::for_request(const protocol::Response &response, const nlohmann::json &id) {
+        protocol::Response copy = response;
+        copy.id = id;
+        if (copy.error) {
+            copy.error->id = id;
+        }
+        return copy;
+    }
+
+    asio::awaitable<protocol::Response> ToolResultCache::call(const std::string &tool_name,
+                                                              const nlohmann::json &args,
+                                                              uint64_t registry_version,
+                                                              const nlohmann::json &id,
+                                                              const Call &call) {
+        // Objects serialize with sorted keys, so equal arguments give equal keys
+        std::string key = tool_name;
+        key.push_back('\0');
+        key.append(std::to_string(registry_version));
+        key.push_back('\0');
+        key.append(args.dump());
+
+        if (auto cached = results_.Get(key)) {
+            counters_->hits.fetch_add(1, std::memory_order_relaxed);
+            protocol::Response response;
+            response.id = id;
+            response.raw_result = std::make_shared<const std::string>(std::move(*cached));
+            co_return response;
+        }
+
+        // Identical calls in flight share one execution
+        bool shared = false;
+        std::function<asio::awaitable<protocol::Response>()> produce = [this, key, tool_name, call]() {
+            return run_and_store(key, tool_name, call);
+        };
+        auto response = co_await flights_.run(key, std::move(produce), &shared);
+        if (shared) {
+            counters_->hits.fetch_add(1, std::memory_order_relaxed);
+            MCP_DEBUG("Shared in-flight result of tool {}", tool_name);
+        } else {
+            counters_->misses.fetch_add(1, std::memory_order_relaxed);
+        }
+        co_return for_request(response, id);
+    }
+
+    asio::awaitable<protocol::Response> ToolResultCache::run_and_store(std::string key, std::string tool_name, Call call) {
+        protocol::Response response;
+        try {
+            response = call();
+        } catch (const std::exception &e) {
+            response.error = protocol::Error{protocol::error_code::INTERNAL_ERROR, e.what()};
+        }
+
+        // Keep successful results only, a failed call is retried by the next request
+        if (!response.error) {
+            std::string body = response.raw_result ? *response.raw_result : response.result.dump();
+            if (body.size() <= options_.max_result_bytes) {
+                results_.Put(key, body, options_.tools.at(tool_name));
+                counters_->resident_bytes.store(static_cast<int64_t>(results_.MemoryUsage()), std::memory_order_relaxed);
+                counters_->entries.store(results_.Size(), std::memory_order_relaxed);
+            }
+        }
+        co_return response;
+    }
+
+}// namespace mcp::business
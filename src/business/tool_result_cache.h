@@ -0,0 +1,109 @@
+// src/business/tool_result_cache.h
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "core/single_flight.hpp"
+#include "protocol/json_rpc.h"
+#include "transport/LRUCache.hpp"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace mcp::metrics {
+    struct CacheCounters;
+}
+
+namespace mcp::business {
+
+    /**
+     * @brief Settings for the ToolResultCache, normally taken from the [cache] section.
+     */
+    struct ToolResultCacheOptions {
+        std::unordered_map<std::string, std::chrono::seconds> tools;///< Cacheable tools -> result TTL
+        std::size_t max_bytes = 64 * 1024 * 1024;                   ///< Memory budget of all cached results
+        std::size_t max_result_bytes = 1024 * 1024;                 ///< Larger results are not cached
+    };
+
+    /**
+     * @brief Memoized tools/call results of tools declared idempotent in the configuration.
+     *
+     * Results are keyed by the tool, the registry version and the arguments serialized with
+     * sorted keys, so argument order does not matter and reloading a plugin starts afresh.
+     * Identical calls arriving while one is running wait for it instead of running the tool
+     * again (single-flight); they share its outcome, errors included, but only successful
+     * results are kept. Counted in MetricsManager as "tool_results".
+     */
+    class ToolResultCache {
+    public:
+        using Call = std::function<protocol::Response()>;
+
+        ToolResultCache(const ToolResultCache &) = delete;
+        ToolResultCache &operator=(const ToolResultCache &) = delete;
+
+        /**
+         * @brief Set the cache options. Must be called before the first instance().
+         * @param options Cache options
+         */
+        static void configure(ToolResultCacheOptions options);
+
+        /**
+         * @brief Get the process-wide cache, creating it on first use.
+         * @return Tool result cache
+         */
+        static ToolResultCache &instance();
+
+        /**
+         * @brief Change the memory budget of the running cache, evicting down to a smaller one.
+         * @param max_bytes New budget, 0 leaves it unchanged
+         */
+        void set_max_bytes(std::size_t max_bytes);
+
+        /**
+         * @brief Whether results of a tool are memoized.
+         * @param tool_name Tool name
+         */
+        bool enabled_for(const std::string &tool_name) const { return options_.tools.count(tool_name) != 0; }
+
+        /**
+         * @brief Answer a call from the cache, from an identical call in flight, or by running it.
+         * @param tool_name Tool name, must be enabled_for()
+         * @param args Tool arguments
+         * @param registry_version Version of the tool registry the call runs against
+         * @param id JSON-RPC id of this request, set on shared responses
+         * @param call Runs the tool and builds its response; called on the awaiting thread
+         * @return Response for this request
+         */
+        asio::awaitable<protocol::Response> call(const std::string &tool_name,
+                                                 const nlohmann::json &args,
+                                                 uint64_t registry_version,
+                                                 const nlohmann::json &id,
+                                                 const Call &call);
+
+    private:
+        explicit ToolResultCache(ToolResultCacheOptions options);
+
+        static ToolResultCacheOptions &pending_options();
+
+        /**
+         * @brief Run a call as the leader of its flight and keep its result if it succeeded.
+         */
+        asio::awaitable<protocol::Response> run_and_store(std::string key, std::string tool_name, Call call);
+
+        /**
+         * @brief Copy a shared response for another request.
+         */
+        static protocol::Response for_request(const protocol::Response &response, const nlohmann::json &id);
+
+        ToolResultCacheOptions options_;
+        Astra::datastructures::LRUCache<std::string, std::string> results_;///< Key -> serialized result
+        core::SingleFlight<protocol::Response> flights_;                   ///< Calls in progress by key
+        std::shared_ptr<metrics::CacheCounters> counters_;
+    };
+
+}// namespace mcp::business
@@ -0,0 +1,400 @@
+#include "binary_log.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <csignal>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <spdlog/details/os.h>
+
+namespace mcp::core {
+
+    namespace {
+        /**
+         * @brief Start of a record in a ring, followed by its encoded arguments.
+         */
+        struct RecordHeader {
+            uint32_t size;///< Header and arguments, rounded up to kRecordAlign; kWrap marks the unused end of the ring
+            uint32_t level;
+            BinaryLog::Decoder decoder;
+            const char *format;
+            size_t format_size;
+            int64_t unix_ns;
+        };
+
+        constexpr uint32_t kWrap = UINT32_MAX;
+        constexpr size_t kRecordAlign = alignof(RecordHeader);
+        constexpr size_t kMinRingBytes = 4096;
+        constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+
+        constexpr size_t record_size(size_t args_size) {
+            return (sizeof(RecordHeader) + args_size + kRecordAlign - 1) & ~(kRecordAlign - 1);
+        }
+
+        /**
+         * @brief Ring of one logging thread: the thread produces, the backend consumes.
+         */
+        struct Ring {
+            explicit Ring(size_t bytes)
+                : capacity(std::bit_ceil(std::max(bytes, kMinRingBytes))),
+                  mask(capacity - 1),
+                  data(new char[capacity]),
+                  thread_id(spdlog::details::os::thread_id()) {}
+
+            const size_t capacity;
+            const size_t mask;
+            const std::unique_ptr<char[]> data;
+            const size_t thread_id;
+            alignas(64) std::atomic<size_t> head{0};///< Next byte to read, written by the backend
+            alignas(64) std::atomic<size_t> tail{0};///< Next byte to write, written by the thread
+            size_t reserved = 0;                    ///< Start of the record being written
+            size_t reserved_size = 0;
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<bool> orphaned{false};///< The thread has exited, the ring goes once drained
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Ring>> rings;
+        };
+
+        // Leaked so threads that log during exit still find it
+        Registry &registry() {
+            static auto *registry = new Registry;
+            return *registry;
+        }
+
+        struct State {
+            BinaryLogOptions options;
+            std::mutex drain_mutex;///< Held while the rings are read, by the backend, stop or the crash handler
+            std::mutex control_mutex;
+            std::thread backend;
+            std::atomic<bool> running{false};
+            std::atomic<uint64_t> dropped{0};
+        };
+
+        State &state() {
+            static auto *state = new State;
+            return *state;
+        }
+
+        struct ThreadRing {
+            std::shared_ptr<Ring> ring;
+
+            ~ThreadRing() {
+                if (ring) {
+                    ring->orphaned.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ThreadRing t_ring;
+
+        Ring &thread_ring() {
+            if (!t_ring.ring) {
+                t_ring.ring = std::make_shared<Ring>(state().options.ring_bytes);
+                auto &reg = registry();
+                std::lock_guard lock(reg.mutex);
+                reg.rings.push_back(t_ring.ring);
+            }
+            return *t_ring.ring;
+        }
+
+        void append_json_string(fmt::memory_buffer &out, std::string_view text) {
+            out.push_back('"');
+            for (char c: text) {
+                switch (c) {
+                    case '"':
+                        out.append(std::string_view("\\\""));
+                        break;
+                    case '\\':
+                        out.append(std::string_view("\\\\"));
+                        break;
+                    case '\n':
+                        out.append(std::string_view("\\n"));
+                        break;
+                    case '\r':
+                        out.append(std::string_view("\\r"));
+                        break;
+                    case '\t':
+                        out.append(std::string_view("\\t"));
+                        break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            fmt::format_to(fmt::appender(out), "\\u{:04x}", static_cast<unsigned>(c));
+                        } else {
+                            out.push_back(c);
+                        }
+                }
+            }
+            out.push_back('"');
+        }
+
+        /**
+         * @brief Write a formatted line to g_logger, wrapped in a JSON object in JSON mode.
+         */
+        void write_line(spdlog::level::level_enum level, int64_t unix_ns, size_t thread_id, std::string_view message) {
+            auto time = spdlog::log_clock::time_point(
+                    std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(unix_ns)));
+            if (state().options.format == BinaryLogOptions::Format::Text) {
+                g_logger->log(time, spdlog::source_loc{}, level, message);
+                return;
+            }
+
+            auto tm = spdlog::details::os::gmtime(static_cast<std::time_t>(unix_ns / 1000000000));
+            fmt::memory_buffer line;
+            fmt::format_to(fmt::appender(line), R"({{"time":"{:04}-{:02}-{:02}T{:02}:{:02}:{:02}.{:03}Z","level":)",
+                           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                           (unix_ns / 1000000) % 1000);
+            auto name = spdlog::level::to_string_view(level);
+            append_json_string(line, std::string_view(name.data(), name.size()));
+            fmt::format_to(fmt::appender(line), R"(,"thread":{},"message":)", thread_id);
+            append_json_string(line, message);
+            line.push_back('}');
+            g_logger->log(time, spdlog::source_loc{}, level, std::string_view(line.data(), line.size()));
+        }
+
+        /**
+         * @brief Format and write the records of a ring. Call with drain_mutex held.
+         * @return Records written
+         */
+        size_t drain(Ring &ring) {
+            size_t head = ring.head.load(std::memory_order_relaxed);
+            const size_t tail = ring.tail.load(std::memory_order_acquire);
+            size_t written = 0;
+            fmt::memory_buffer message;
+            while (head != tail) {
+                const char *record = ring.data.get() + (head & ring.mask);
+                uint32_t size;
+                std::memcpy(&size, record, sizeof(size));
+                if (size == kWrap) {
+                    head += ring.capacity - (head & ring.mask);
+                    continue;
+                }
+                RecordHeader header;
+                std::memcpy(&header, record, sizeof(header));
+
+                message.clear();
+                try {
+                    header.decoder(record + sizeof(header), std::string_view(header.format, header.format_size), message);
+                } catch (const std::exception &e) {
+                    message.clear();
+                    fmt::format_to(fmt::appender(message), "Log formatting error: {}", e.what());
+                }
+                write_line(static_cast<spdlog::level::level_enum>(header.level), header.unix_ns, ring.thread_id,
+                           std::string_view(message.data(), message.size()));
+                head += header.size;
+                ring.head.store(head, std::memory_order_release);
+                ++written;
+            }
+
+            if (uint64_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed)) {
+                auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+                write_line(spdlog::level::warn, now.count(), ring.thread_id,
+                           fmt::format("Dropped {} log lines, the thread's log ring buffer was full", dropped));
+            }
+            return written;
+        }
+
+        /**
+         * @brief Drain every ring and forget those of exited threads. Call with drain_mutex held.
+         */
+        size_t drain_all() {
+            auto &reg = registry();
+            std::vector<std::shared_ptr<Ring>> rings;
+            {
+                std::lock_guard lock(reg.mutex);
+                rings = reg.rings;
+            }
+
+            size_t written = 0;
+            bool orphans = false;
+            for (auto &ring: rings) {
+                written += drain(*ring);
+                orphans |= ring->orphaned.load(std::memory_order_acquire);
+            }
+
+            if (orphans) {
+                std::lock_guard lock(reg.mutex);
+                std::erase_if(reg.rings, [](const std::shared_ptr<Ring> &ring) {
+                    return ring->orphaned.load(std::memory_order_acquire) &&
+                           ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire);
+                });
+            }
+            return written;
+        }
+
+        void run_backend() {
+            auto &s = state();
+            while (s.running.load(std::memory_order_acquire)) {
+                size_t written;
+                {
+                    std::lock_guard lock(s.drain_mutex);
+                    written = drain_all();
+                }
+                if (written == 0) {
+                    std::this_thread::sleep_for(kIdleSleep);
+                }
+            }
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        constexpr auto kCrashWait = std::chrono::milliseconds(200);
+        constexpr int kCrashSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+        struct sigaction previous_actions[std::size(kCrashSignals)];
+
+        /**
+         * @brief Write what the rings hold, then let the signal take its previous course.
+         *
+         * Formatting in a signal handler is not async-signal-safe; this is a last attempt at the
+         * lines that explain the crash. The backend is given kCrashWait to finish its pass, the
+         * rings are left alone if it does not, as when it is the thread that crashed.
+         */
+        void on_crash(int signal_number) {
+            auto &s = state();
+            s.running.store(false, std::memory_order_release);
+            auto deadline = std::chrono::steady_clock::now() + kCrashWait;
+            bool locked = s.drain_mutex.try_lock();
+            while (!locked && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                locked = s.drain_mutex.try_lock();
+            }
+            if (locked) {
+                drain_all();
+                s.drain_mutex.unlock();
+            }
+            if (g_logger) {
+                g_logger->flush();
+            }
+            for (size_t i = 0; i < std::size(kCrashSignals); ++i) {
+                if (kCrashSignals[i] == signal_number) {
+                    sigaction(signal_number, &previous_actions[i], nullptr);
+                }
+            }
+            raise(signal_number);
+        }
+
+        void install_crash_handlers() {
+            struct sigaction action {};
+            action.sa_handler = on_crash;
+            sigemptyset(&action.sa_mask);
+            for (size_t i = 0; i < std::size(kCrashSignals); ++i) {
+                sigaction(kCrashSignals[i], &action, &previous_actions[i]);
+            }
+        }
+#else
+        void install_crash_handlers() {}
+#endif
+    }// namespace
+
+    BinaryLogOptions::Format BinaryLogOptions::parse_format(std::string_view value) {
+        return value == "json" ? Format::Json : Format::Text;
+    }
+
+    BinaryLogOptions::Overflow BinaryLogOptions::parse_overflow(std::string_view value) {
+        return value == "block" ? Overflow::Block : Overflow::Drop;
+    }
+
+    void BinaryLog::start(const BinaryLogOptions &options) {
+        auto &s = state();
+        std::lock_guard lock(s.control_mutex);
+        if (!g_logger || s.running.load()) {
+            return;
+        }
+        s.options = options;
+        if (options.format == BinaryLogOptions::Format::Json) {
+            g_logger->set_pattern("%v");
+        }
+        s.running.store(true, std::memory_order_release);
+        s.backend = std::thread(run_backend);
+
+        static std::once_flag once;
+        std::call_once(once, [] {
+            install_crash_handlers();
+            std::atexit(stop);
+        });
+        active_.store(true, std::memory_order_release);
+    }
+
+    void BinaryLog::stop() {
+        auto &s = state();
+        std::lock_guard lock(s.control_mutex);
+        if (!s.running.load()) {
+            return;
+        }
+        active_.store(false, std::memory_order_release);
+        s.running.store(false, std::memory_order_release);
+        s.backend.join();
+        {
+            std::lock_guard drain_lock(s.drain_mutex);
+            drain_all();
+        }
+        if (s.options.format == BinaryLogOptions::Format::Json) {
+            g_logger->set_pattern(kLogPattern);
+        }
+        g_logger->flush();
+    }
+
+    uint64_t BinaryLog::dropped() noexcept {
+        return state().dropped.load(std::memory_order_relaxed);
+    }
+
+    void BinaryLog::decode_text(const char *args, std::string_view, fmt::memory_buffer &out) {
+        auto text = decode_one<std::string_view>(args);
+        out.append(text);
+    }
+
+    char *BinaryLog::reserve(size_t args_size, bool &dropped) {
+        if (!active()) {
+            return nullptr;
+        }
+        Ring &ring = thread_ring();
+        const size_t size = record_size(args_size);
+        if (size > ring.capacity / 2) {
+            return nullptr;
+        }
+
+        const size_t tail = ring.tail.load(std::memory_order_relaxed);
+        const size_t offset = tail & ring.mask;
+        // A record does not wrap: if it does not fit before the end, the end is skipped
+        const size_t padding = ring.capacity - offset < size ? ring.capacity - offset : 0;
+        while (tail + padding + size - ring.head.load(std::memory_order_acquire) > ring.capacity) {
+            if (state().options.overflow == BinaryLogOptions::Overflow::Drop) {
+                ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                state().dropped.fetch_add(1, std::memory_order_relaxed);
+                dropped = true;
+                return nullptr;
+            }
+            if (!active()) {
+                return nullptr;
+            }
+            std::this_thread::yield();
+        }
+
+        if (padding != 0) {
+            std::memcpy(ring.data.get() + offset, &kWrap, sizeof(kWrap));
+        }
+        ring.reserved = tail + padding;
+        ring.reserved_size = size;
+        return ring.data.get() + (ring.reserved & ring.mask) + sizeof(RecordHeader);
+    }
+
+    void BinaryLog::commit(LogLevel level, Decoder decoder, fmt::string_view format) {
+        Ring &ring = *t_ring.ring;
+        RecordHeader header{};
+        header.size = static_cast<uint32_t>(ring.reserved_size);
+        header.level = static_cast<uint32_t>(level);
+        header.decoder = decoder;
+        header.format = format.data();
+        header.format_size = format.size();
+        header.unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        std::memcpy(ring.data.get() + (ring.reserved & ring.mask), &header, sizeof(header));
+        ring.tail.store(ring.reserved + ring.reserved_size, std::memory_order_release);
+    }
+
+}// namespace mcp::core
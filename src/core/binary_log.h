@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <spdlog/fmt/fmt.h>
+
+namespace mcp::core {
+
+    enum class LogLevel;
+
+    /**
+     * @brief Settings of the binary log mode, normally taken from the [server] config section.
+     */
+    struct BinaryLogOptions {
+        enum class Format {
+            Text,///< Lines in the logger's usual pattern
+            Json,///< One JSON object per line
+        };
+
+        enum class Overflow {
+            Drop, ///< Drop the line and count it, the caller never waits
+            Block,///< Wait for the backend to make room
+        };
+
+        bool enabled = false;
+        Format format = Format::Text;
+        Overflow overflow = Overflow::Drop;
+        size_t ring_bytes = 256 * 1024;///< Ring buffer of each logging thread, rounded up to a power of two
+
+        /**
+         * @brief Parse a log_format value, "text" or "json"; anything else is text.
+         */
+        static Format parse_format(std::string_view value);
+
+        /**
+         * @brief Parse a log_overflow value, "drop" or "block"; anything else is drop.
+         */
+        static Overflow parse_overflow(std::string_view value);
+    };
+
+    /**
+     * @brief Deferred formatting of log lines on a backend thread.
+     *
+     * While it runs, a log call copies its level, a timestamp, the address of its format string
+     * and its raw arguments into a ring buffer of the calling thread; a backend thread takes the
+     * records from every ring, formats them, as text or JSON, and hands them to the sinks of
+     * g_logger. A log call takes no lock and does not format. Strings are copied, numbers,
+     * enums and pointers stored as they are; a line with any other argument is formatted on the
+     * caller, and only its text deferred. Format strings must outlive the process, which the
+     * compile-time checked strings of the MCP_ macros do.
+     *
+     * When a ring is full the line is dropped and counted, or the caller waits, see
+     * BinaryLogOptions::Overflow. Lines from different threads are written in the order the
+     * backend takes them, each with the time it was logged. The rings are drained when the
+     * process exits and, as well as that can be done, when it crashes.
+     */
+    class BinaryLog {
+    public:
+        /**
+         * @brief Format a record's arguments; one instantiation per argument list, so the
+         *        decoder's address identifies how a record is laid out.
+         */
+        using Decoder = void (*)(const char *args, std::string_view format, fmt::memory_buffer &out);
+
+        /**
+         * @brief Start the backend thread and route log calls through the rings; the backend is
+         *        stopped and the rings drained at exit. Call once, after initializeAsyncLogger.
+         * @param options Mode settings, enabled is ignored
+         */
+        static void start(const BinaryLogOptions &options);
+
+        /**
+         * @brief Route log calls back to g_logger, drain the rings and stop the backend.
+         */
+        static void stop();
+
+        /**
+         * @brief Whether log calls go through the rings.
+         */
+        static bool active() noexcept { return active_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Lines dropped because a ring was full, since start.
+         */
+        static uint64_t dropped() noexcept;
+
+        /**
+         * @brief Queue a log line for the backend.
+         * @param level Level, already checked
+         * @param format Format string, kept by address
+         * @param args Arguments for the format string
+         * @return false if the line was not queued and the caller should write it itself
+         */
+        template<typename... Args>
+        static bool push(LogLevel level, fmt::string_view format, const Args &...args) {
+            if constexpr ((deferrable<Args> && ...)) {
+                size_t size = (size_t{0} + ... + encoded_size(args));
+                bool dropped = false;
+                char *out = reserve(size, dropped);
+                if (!out) {
+                    return dropped;
+                }
+                (encode(out, args), ...);
+                commit(level, &decode<stored_t<Args>...>, format);
+                return true;
+            } else {
+                std::string text = fmt::vformat(format, fmt::make_format_args(args...));
+                bool dropped = false;
+                char *out = reserve(sizeof(uint32_t) + text.size(), dropped);
+                if (!out) {
+                    return dropped;
+                }
+                encode(out, std::string_view(text));
+                commit(level, &decode_text, {});
+                return true;
+            }
+        }
+
+    private:
+        template<typename T>
+        static constexpr bool is_string = std::is_convertible_v<const T &, std::string_view>;
+
+        template<typename T>
+        static constexpr bool deferrable = is_string<T> || std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+                                           std::is_same_v<std::decay_t<T>, const void *> ||
+                                           std::is_same_v<std::decay_t<T>, void *>;
+
+        template<typename T>
+        using stored_t = std::conditional_t<is_string<T>, std::string_view, std::decay_t<T>>;
+
+        template<typename T>
+        static size_t encoded_size(const T &value) {
+            if constexpr (is_string<T>) {
+                return sizeof(uint32_t) + std::string_view(value).size();
+            } else {
+                return sizeof(T);
+            }
+        }
+
+        template<typename T>
+        static void encode(char *&out, const T &value) {
+            if constexpr (is_string<T>) {
+                std::string_view text(value);
+                auto length = static_cast<uint32_t>(text.size());
+                std::memcpy(out, &length, sizeof(length));
+                std::memcpy(out + sizeof(length), text.data(), text.size());
+                out += sizeof(length) + text.size();
+            } else {
+                std::memcpy(out, &value, sizeof(T));
+                out += sizeof(T);
+            }
+        }
+
+        template<typename T>
+        static T decode_one(const char *&in) {
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                uint32_t length;
+                std::memcpy(&length, in, sizeof(length));
+                std::string_view text(in + sizeof(length), length);
+                in += sizeof(length) + length;
+                return text;
+            } else {
+                T value;
+                std::memcpy(&value, in, sizeof(T));
+                in += sizeof(T);
+                return value;
+            }
+        }
+
+        template<typename... Stored>
+        static void decode(const char *args, std::string_view format, fmt::memory_buffer &out) {
+            // Braced initialization reads the arguments in order
+            std::tuple<Stored...> values{decode_one<Stored>(args)...};
+            std::apply([&](const auto &...value) { fmt::vformat_to(fmt::appender(out), format, fmt::make_format_args(value...)); }, values);
+        }
+
+        static void decode_text(const char *args, std::string_view format, fmt::memory_buffer &out);
+
+        /**
+         * @brief Space for a record's arguments in the calling thread's ring.
+         * @param dropped Set if the ring was full and the line dropped and counted
+         * @return Where to write them, nullptr if the line is not queued
+         */
+        static char *reserve(size_t args_size, bool &dropped);
+
+        /**
+         * @brief Publish the record reserved last.
+         */
+        static void commit(LogLevel level, Decoder decoder, fmt::string_view format);
+
+        static inline std::atomic<bool> active_{false};
+    };
+
+}// namespace mcp::core
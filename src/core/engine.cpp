@@ -0,0 +1,123 @@
+#include "engine.h"
+#include "business/plugin_manager.h"
+#include "core/logger.h"
+#include "mcp_engine.h"
+#include <algorithm>
+#include <exception>
+
+
+namespace mcp::core {
+
+    Engine::Engine(std::unique_ptr<MCPserver> server, size_t threads)
+        : server_(std::move(server)), work_(asio::make_work_guard(io_context_)) {
+        // What run() does for a server with transports: plugins may start their background work
+        if (server_->plugin_manager_) {
+            server_->plugin_manager_->notify_server_started();
+        }
+        threads = std::max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this]() {
+                io_context_.run();
+            });
+        }
+        MCP_INFO("Engine started with {} threads and {} tools", threads, server_->registry_->get_all_tool_names().size());
+    }
+
+    Engine::~Engine() {
+        // The callback calls still running keep the io_context busy until they have answered
+        work_.reset();
+        for (auto &thread: threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    asio::awaitable<std::string> Engine::handle(std::string_view message) {
+        co_return co_await server_->request_handler_->respond(message, nullptr, session_id_);
+    }
+
+    asio::awaitable<protocol::Response> Engine::call(const protocol::Request &request) {
+        co_return co_await server_->request_handler_->dispatch(request, nullptr, session_id_);
+    }
+
+    asio::awaitable<protocol::Response> Engine::call_tool(std::string name, nlohmann::json arguments) {
+        protocol::Request request("tools/call",
+                                  nlohmann::json{{"name", std::move(name)}, {"arguments", std::move(arguments)}},
+                                  nlohmann::json(next_id_.fetch_add(1, std::memory_order_relaxed)));
+        co_return co_await call(request);
+    }
+
+    void Engine::submit(std::string message, Callback done) {
+        asio::co_spawn(
+                io_context_,
+                [this, message = std::move(message)]() -> asio::awaitable<std::string> {
+                    co_return co_await handle(message);
+                },
+                [done = std::move(done)](std::exception_ptr error, std::string response) {
+                    if (error) {
+                        try {
+                            std::rethrow_exception(error);
+                        } catch (const std::exception &e) {
+                            MCP_ERROR("Engine request failed: {}", e.what());
+                            response = protocol::make_error(protocol::error_code::INTERNAL_ERROR, e.what());
+                        }
+                    }
+                    done(std::move(response));
+                });
+    }
+
+    void Engine::submit_tool_call(std::string name, nlohmann::json arguments, ResponseCallback done) {
+        asio::co_spawn(
+                io_context_,
+                [this, name = std::move(name), arguments = std::move(arguments)]() mutable -> asio::awaitable<protocol::Response> {
+                    co_return co_await call_tool(std::move(name), std::move(arguments));
+                },
+                [done = std::move(done)](std::exception_ptr error, protocol::Response response) {
+                    if (error) {
+                        try {
+                            std::rethrow_exception(error);
+                        } catch (const std::exception &e) {
+                            MCP_ERROR("Engine tool call failed: {}", e.what());
+                            response = protocol::Response{protocol::Error{protocol::error_code::INTERNAL_ERROR, e.what()}, nullptr};
+                        }
+                    }
+                    done(std::move(response));
+                });
+    }
+
+}// namespace mcp::core
+
+struct mcp_engine {
+    std::unique_ptr<mcp::core::Engine> engine;
+};
+
+extern "C" {
+
+MCP_API mcp_engine *mcp_engine_create(const char *plugin_directory, size_t threads) {
+    try {
+        mcp::core::MCPserver::Builder builder;
+        if (plugin_directory && *plugin_directory) {
+            builder.with_plugin_path(plugin_directory);
+        }
+        return new mcp_engine{builder.build_engine(threads)};
+    } catch (const std::exception &e) {
+        MCP_ERROR("Failed to start the engine: {}", e.what());
+        return nullptr;
+    }
+}
+
+MCP_API void mcp_engine_submit(mcp_engine *engine, const char *request, size_t length,
+                               mcp_engine_callback callback, void *user_data) {
+    engine->engine->submit(std::string(request, length), [callback, user_data](std::string response) {
+        if (callback) {
+            callback(response.empty() ? nullptr : response.data(), response.size(), user_data);
+        }
+    });
+}
+
+MCP_API void mcp_engine_destroy(mcp_engine *engine) {
+    delete engine;
+}
+
+}// extern "C"
@@ -0,0 +1,107 @@
+// src/core/engine.h
+#pragma once
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "business/request_handler.h"
+#include "business/tool_registry.h"
+#include "protocol/json_rpc.h"
+#include "server.h"
+#include <asio.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace mcp::core {
+
+    /**
+     * @brief The server without its transports, for a process that calls tools itself.
+     *
+     * Built by MCPserver::Builder::build_engine(), which loads the plugins, Python ones included,
+     * and registers their tools as the server does. Requests go straight to the RequestHandler:
+     * no socket, no HTTP parsing, and typed calls (call(), call_tool()) are not serialized at all.
+     * They run as stdio requests do, without a transport session, under the engine's session_id
+     * for cancellation and idempotency keys; streaming tools are therefore not streamed.
+     *
+     * The awaitable calls run on the executor of the awaiting coroutine. The callback calls run
+     * on the engine's own io_context and call back on one of its threads. Destroying the engine
+     * waits for the callback calls still running.
+     */
+    class Engine {
+    public:
+        using Callback = std::function<void(std::string)>;                  ///< Serialized response, empty for notifications
+        using ResponseCallback = std::function<void(protocol::Response)>;///< Response of a typed call
+
+        /**
+         * @brief Take a server over and start the threads of the callback calls.
+         * @param server Server built without transports
+         * @param threads Threads running the engine's io_context, at least one
+         */
+        Engine(std::unique_ptr<MCPserver> server, size_t threads = 1);
+        ~Engine();
+
+        Engine(const Engine &) = delete;
+        Engine &operator=(const Engine &) = delete;
+
+        /**
+         * @brief Answer one JSON-RPC message, or a batch, as the stdio transport would.
+         * @param message Raw JSON-RPC message, valid until the returned awaitable completes
+         * @return Serialized response, empty for notifications
+         */
+        asio::awaitable<std::string> handle(std::string_view message);
+
+        /**
+         * @brief Route a request that is already built, without serializing it or its answer.
+         * @param request Request, valid until the returned awaitable completes; without an id
+         *        it is a notification and gets a response with a null id
+         * @return Response; plugin tools put their output in raw_result, as the plugin wrote it
+         */
+        asio::awaitable<protocol::Response> call(const protocol::Request &request);
+
+        /**
+         * @brief Call a tool the way tools/call does: arguments are checked against its schema,
+         *        and its deadline, result cache and idempotency key apply.
+         * @param name Tool name
+         * @param arguments Tool arguments, moved into the request
+         * @return Response of tools/call, with an id the engine picked
+         */
+        asio::awaitable<protocol::Response> call_tool(std::string name, nlohmann::json arguments);
+
+        /**
+         * @brief handle() on the engine's io_context, reporting the answer to a callback.
+         * @param message Raw JSON-RPC message
+         * @param done Called on an engine thread with the serialized response, empty for notifications
+         */
+        void submit(std::string message, Callback done);
+
+        /**
+         * @brief call_tool() on the engine's io_context, reporting the answer to a callback.
+         * @param name Tool name
+         * @param arguments Tool arguments
+         * @param done Called on an engine thread with the response
+         */
+        void submit_tool_call(std::string name, nlohmann::json arguments, ResponseCallback done);
+
+        /// Tools the engine can call, with their schemas
+        business::ToolRegistry &registry() { return *server_->registry_; }
+
+        asio::any_io_executor get_executor() { return io_context_.get_executor(); }
+
+        /// Session the engine's requests are made under; notifications/cancelled finds them by it
+        const std::string &session_id() const { return session_id_; }
+
+    private:
+        std::unique_ptr<MCPserver> server_;
+        std::string session_id_ = "embedded";
+        std::atomic<int64_t> next_id_{1};///< Ids of the tool calls the engine makes
+        asio::io_context io_context_;
+        asio::executor_work_guard<asio::io_context::executor_type> work_;
+        std::vector<std::thread> threads_;
+    };
+
+}// namespace mcp::core
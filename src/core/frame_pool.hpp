@@ -0,0 +1,139 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <array>
+#include <asio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace mcp::core {
+
+    /**
+     * @brief Per-thread free lists for the short-lived blocks of asynchronous operations.
+     *
+     * Blocks are grouped in 64-byte size classes up to kMaxBlockSize; a freed block is kept by
+     * the thread that frees it, up to kMaxCachedPerClass per class, and handed out again for
+     * the next block of its class. Larger blocks go straight to the heap. No locks: each thread
+     * only ever touches its own lists. Blocks freed on another thread than they were allocated
+     * on simply change lists, which is what happens when a tool pool thread resumes a session.
+     */
+    class FramePool {
+    public:
+        static constexpr std::size_t kGranularity = 64;
+        static constexpr std::size_t kMaxBlockSize = 4096;
+        static constexpr std::size_t kMaxCachedPerClass = 64;
+
+        /**
+         * @brief Allocation counters of the calling thread.
+         */
+        struct Stats {
+            uint64_t pooled = 0;///< Served from a free list
+            uint64_t heap = 0;  ///< Went to operator new
+        };
+
+        static void *allocate(std::size_t size) {
+            auto &lists = local();
+            std::size_t index = class_of(size);
+            if (index < kClasses) {
+                if (Block *block = lists.heads[index]) {
+                    lists.heads[index] = block->next;
+                    --lists.counts[index];
+                    ++lists.stats.pooled;
+                    return block;
+                }
+                size = (index + 1) * kGranularity;// so the block fits any size of its class later
+            }
+            ++lists.stats.heap;
+            return ::operator new(size);
+        }
+
+        static void deallocate(void *pointer, std::size_t size) noexcept {
+            if (!pointer) {
+                return;
+            }
+            auto &lists = local();
+            std::size_t index = class_of(size);
+            if (index < kClasses && lists.counts[index] < kMaxCachedPerClass) {
+                auto *block = static_cast<Block *>(pointer);
+                block->next = lists.heads[index];
+                lists.heads[index] = block;
+                ++lists.counts[index];
+                return;
+            }
+            ::operator delete(pointer);
+        }
+
+        static const Stats &stats() { return local().stats; }
+
+    private:
+        static constexpr std::size_t kClasses = kMaxBlockSize / kGranularity;
+
+        struct Block {
+            Block *next;
+        };
+
+        struct Lists {
+            std::array<Block *, kClasses> heads{};
+            std::array<std::size_t, kClasses> counts{};
+            Stats stats;
+
+            ~Lists() {
+                for (Block *head: heads) {
+                    while (head) {
+                        Block *next = head->next;
+                        ::operator delete(head);
+                        head = next;
+                    }
+                }
+                // Operations torn down later on this thread bypass the lists
+                heads.fill(nullptr);
+                counts.fill(kMaxCachedPerClass);
+            }
+        };
+
+        static std::size_t class_of(std::size_t size) {
+            return size == 0 ? 0 : (size - 1) / kGranularity;
+        }
+
+        static Lists &local() {
+            thread_local Lists lists;
+            return lists;
+        }
+    };
+
+    /**
+     * @brief Standard allocator on top of FramePool, to be associated with completion handlers.
+     */
+    template<typename T>
+    struct FrameAllocator {
+        using value_type = T;
+
+        FrameAllocator() noexcept = default;
+
+        template<typename U>
+        FrameAllocator(const FrameAllocator<U> &) noexcept {}
+
+        T *allocate(std::size_t n) { return static_cast<T *>(FramePool::allocate(n * sizeof(T))); }
+        void deallocate(T *pointer, std::size_t n) noexcept { FramePool::deallocate(pointer, n * sizeof(T)); }
+
+        template<typename U>
+        bool operator==(const FrameAllocator<U> &) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const FrameAllocator<U> &) const noexcept { return false; }
+    };
+
+    /**
+     * @brief Completion token whose operation state is allocated from FramePool.
+     * Wraps any token, e.g. pooled(asio::use_awaitable) or pooled(asio::redirect_error(asio::use_awaitable, ec)).
+     */
+    template<typename CompletionToken>
+    auto pooled(CompletionToken &&token) {
+        return asio::bind_allocator(FrameAllocator<void>(), std::forward<CompletionToken>(token));
+    }
+
+}// namespace mcp::core
@@ -0,0 +1,125 @@
+#include "housekeeping.h"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+
+
+namespace mcp::core {
+
+    Housekeeping &Housekeeping::instance() {
+        static auto *instance = new Housekeeping();
+        return *instance;
+    }
+
+    void Housekeeping::start_locked() {
+        if (work_ || stopped_) {
+            return;
+        }
+        work_ = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(io_.get_executor());
+        thread_ = std::thread([this]() {
+            AsioIOServicePool::SetupCurrentThread("mcp-housekeeping", -1);
+            while (true) {
+                try {
+                    io_.run();
+                    break;
+                } catch (const std::exception &e) {
+                    // A task that throws must not end the others
+                    MCP_ERROR("Housekeeping task failed: {}", e.what());
+                }
+            }
+        });
+    }
+
+    asio::any_io_executor Housekeeping::executor() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        start_locked();
+        return io_.get_executor();
+    }
+
+    uint64_t Housekeeping::every(clock_type::duration interval, Task task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t id = ++last_id_;
+        if (stopped_) {
+            return id;
+        }
+        start_locked();
+        auto job = std::make_shared<Job>(Job{interval, std::move(task), asio::steady_timer(io_)});
+        jobs_.emplace(id, job);
+        // The timer is only touched on the housekeeping thread
+        asio::post(io_, [this, id, job]() { arm(id, job); });
+        return id;
+    }
+
+    void Housekeeping::arm(uint64_t id, const std::shared_ptr<Job> &job) {
+        job->timer.expires_after(job->interval);
+        job->timer.async_wait([this, id, job](const asio::error_code &ec) {
+            if (!ec) {
+                run(id, job);
+            }
+        });
+    }
+
+    void Housekeeping::run(uint64_t id, const std::shared_ptr<Job> &job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = jobs_.find(id);
+            if (it == jobs_.end() || it->second != job) {
+                return;// Cancelled meanwhile
+            }
+            running_id_ = id;
+        }
+        try {
+            job->task();
+        } catch (const std::exception &e) {
+            MCP_ERROR("Housekeeping task failed: {}", e.what());
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_id_ = 0;
+        done_cv_.notify_all();
+        if (jobs_.count(id)) {
+            arm(id, job);
+        }
+    }
+
+    void Housekeeping::cancel(uint64_t id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end()) {
+            return;
+        }
+        auto job = std::move(it->second);
+        jobs_.erase(it);
+        if (running_id_ == id && !on_thread()) {
+            done_cv_.wait(lock, [this, id] { return running_id_ != id; });
+        }
+        if (!stopped_) {
+            asio::post(io_, [job]() { job->timer.cancel(); });
+        }
+    }
+
+    void Housekeeping::stop() {
+        std::map<uint64_t, std::shared_ptr<Job>> jobs;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stopped_) {
+                return;
+            }
+            stopped_ = true;
+            jobs.swap(jobs_);
+            if (running_id_ != 0 && !on_thread()) {
+                done_cv_.wait(lock, [this] { return running_id_ == 0; });
+            }
+        }
+        io_.stop();
+        if (thread_.joinable() && !on_thread()) {
+            thread_.join();
+        }
+        work_.reset();
+        MCP_DEBUG("Housekeeping stopped with {} tasks", jobs.size());
+    }
+
+    size_t Housekeeping::tasks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return jobs_.size();
+    }
+
+}// namespace mcp::core
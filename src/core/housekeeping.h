@@ -0,0 +1,102 @@
+// src/core/housekeeping.h
+#pragma once
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mcp::core {
+
+    /**
+     * @brief One thread and io_context for the server's periodic and monitoring work.
+     *
+     * Cache cleanups, idle plugin unloading, the expiry of stream sessions and the config and
+     * plugin directory watchers all run here as timers and descriptor waits, instead of each
+     * keeping a thread that mostly sleeps. Tasks must not block for long, they delay the others;
+     * a plugin reload is the longest one. The thread starts with the first task and is named
+     * mcp-housekeeping.
+     *
+     * stop() cancels everything and joins the thread, so after it returns no task is running and
+     * none will run again; the server calls it when draining, before the stream cache is flushed.
+     */
+    class Housekeeping {
+    public:
+        using clock_type = std::chrono::steady_clock;
+        using Task = std::function<void()>;
+
+        Housekeeping(const Housekeeping &) = delete;
+        Housekeeping &operator=(const Housekeeping &) = delete;
+
+        /**
+         * @brief The process-wide instance, never destroyed so objects with static storage can
+         *        cancel their tasks at exit.
+         */
+        static Housekeeping &instance();
+
+        /**
+         * @brief Executor of the housekeeping io_context, for timers and watchers of one's own.
+         * Starts the thread if it is not running yet.
+         */
+        asio::any_io_executor executor();
+
+        /**
+         * @brief Run a task every interval, the first time one interval from now.
+         * @param interval Time from the end of one run to the start of the next
+         * @param task Task, run on the housekeeping thread
+         * @return Registration id for cancel(), never 0
+         */
+        uint64_t every(clock_type::duration interval, Task task);
+
+        /**
+         * @brief Stop running a task. A run in progress is waited for, unless cancel() is called
+         *        from the housekeeping thread, i.e. by a task.
+         * @param id Registration id, 0 and unknown ids are ignored
+         */
+        void cancel(uint64_t id);
+
+        /**
+         * @brief Cancel every task and watcher and join the thread. Idempotent; tasks registered
+         *        afterwards never run.
+         */
+        void stop();
+
+        /// Whether the caller runs on the housekeeping thread
+        bool on_thread() const { return thread_.get_id() == std::this_thread::get_id(); }
+
+        /// Number of registered periodic tasks
+        size_t tasks() const;
+
+    private:
+        struct Job {
+            clock_type::duration interval;
+            Task task;
+            asio::steady_timer timer;
+        };
+
+        Housekeeping() = default;
+
+        void start_locked();
+        void arm(uint64_t id, const std::shared_ptr<Job> &job);
+        void run(uint64_t id, const std::shared_ptr<Job> &job);
+
+        asio::io_context io_{1};
+        std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work_;
+        std::thread thread_;
+        mutable std::mutex mutex_;
+        std::condition_variable done_cv_;///< A task returned
+        std::map<uint64_t, std::shared_ptr<Job>> jobs_;
+        uint64_t last_id_ = 0;
+        uint64_t running_id_ = 0;
+        bool stopped_ = false;
+    };
+
+}// namespace mcp::core
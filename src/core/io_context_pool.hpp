@@ -1,9 +1,92 @@
 #pragma once
 #include "Singleton.h"
 #include "asio.hpp"
+#include "core/logger.h"
+#include "metrics/histogram.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+/**
+ * @brief Settings for an AsioIOServicePool, normally taken from ServerConfig.
+ */
+struct IOServicePoolOptions {
+    std::size_t threads = 0;           ///< Number of io_contexts (one thread each), 0 = hardware concurrency
+    std::string thread_name = "mcp-io";///< Thread name prefix, the thread index is appended
+    std::vector<int> cpus;             ///< CPUs the threads are pinned to round-robin, empty = no pinning
+    std::chrono::milliseconds lag_probe_interval{0};///< Period of each io_context's scheduling lag probe, 0 = not probed
+    std::chrono::microseconds busy_poll{0};          ///< How long a thread polls for work before it sleeps, 0 = sleep at once
+};
+
+/**
+ * @brief Live counts of one io_context, kept by the code that runs on it.
+ * Plain relaxed counters, so reading them for a snapshot takes no lock and stops no thread.
+ */
+struct IOServiceActivity {
+    std::atomic<std::size_t> sessions{0};///< Connections whose session coroutine is running
+    std::atomic<std::size_t> requests{0};///< HTTP requests being handled
+    std::atomic<uint64_t> lag_us{0};     ///< Scheduling lag, smoothed over the last probes (the newest weighs a quarter)
+    std::atomic<uint64_t> shed{0};       ///< Requests turned away because lag_us was over the overload threshold
+    std::atomic<uint64_t> spin_us{0};    ///< Time spent busy polling with nothing to run, the CPU cost of busy_poll
+
+    /**
+     * @brief Counts one for as long as it lives; counts nothing outside of a pool thread.
+     */
+    class Count {
+    public:
+        explicit Count(std::atomic<std::size_t> *counter) : _counter(counter) {
+            if (_counter) {
+                _counter->fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        ~Count() {
+            if (_counter) {
+                _counter->fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        Count(const Count &) = delete;
+        Count &operator=(const Count &) = delete;
+
+    private:
+        std::atomic<std::size_t> *_counter;
+    };
+
+    /**
+     * @brief Activity of the io_context the calling thread runs, nullptr outside of a pool thread.
+     */
+    static IOServiceActivity *Current() { return CurrentRef(); }
+
+    /**
+     * @brief Smoothed scheduling lag of the calling thread's io_context, 0 outside of a pool thread
+     *        or when it is not probed.
+     */
+    static std::chrono::microseconds CurrentLag() {
+        return std::chrono::microseconds(Current() ? Current()->lag_us.load(std::memory_order_relaxed) : 0);
+    }
+
+    static Count CountSession() { return Count(Current() ? &Current()->sessions : nullptr); }
+    static Count CountRequest() { return Count(Current() ? &Current()->requests : nullptr); }
+
+private:
+    friend class AsioIOServicePool;
+
+    static IOServiceActivity *&CurrentRef() {
+        thread_local IOServiceActivity *current = nullptr;
+        return current;
+    }
+};
+
 class AsioIOServicePool : public Singleton<AsioIOServicePool> {
     friend Singleton<AsioIOServicePool>;
 
@@ -16,44 +99,289 @@ public:
     AsioIOServicePool &operator=(const AsioIOServicePool &) = delete;
 
     asio::io_context &GetIOService();
+    asio::io_context &GetIOService(std::size_t index) { return _ioServices[index]; }
     void Stop();
+    std::size_t Size() const { return _ioServices.size(); }
+
+    /**
+     * @brief Number of io_contexts GetIOService() deals new connections to, see Resize().
+     */
+    std::size_t ActiveSize() const { return _active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Deal new connections to the first n io_contexts only, e.g. from the admin endpoint.
+     * Connections already on the others stay there until they close; their threads keep running
+     * and take connections again once the pool grows back. The pool cannot grow beyond the
+     * io_contexts it was started with, and SO_REUSEPORT acceptors (one per io_context) keep
+     * accepting on all of them.
+     * @param n io_contexts to use, 0 or more than Size() = all of them
+     * @return io_contexts now used
+     */
+    std::size_t Resize(std::size_t n) {
+        n = n == 0 ? _ioServices.size() : std::min(n, _ioServices.size());
+        if (_active.exchange(n, std::memory_order_relaxed) != n) {
+            MCP_INFO("IO service pool '{}' deals new connections to {} of its {} threads", _options.thread_name, n, _ioServices.size());
+        }
+        return n;
+    }
 
     static std::shared_ptr<AsioIOServicePool> GetInstance() {
         return Singleton<AsioIOServicePool>::GetInstance();
     }
 
+    /**
+     * @brief Pool used for HTTPS sessions (and their handshakes).
+     * This is a dedicated pool if ConfigureTls() was called with a non-zero thread count,
+     * otherwise the shared pool returned by GetInstance().
+     */
+    static std::shared_ptr<AsioIOServicePool> GetTlsInstance() {
+        static std::shared_ptr<AsioIOServicePool> tls_pool = []() -> std::shared_ptr<AsioIOServicePool> {
+            if (TlsOptions().threads == 0) {
+                return GetInstance();
+            }
+            return std::shared_ptr<AsioIOServicePool>(new AsioIOServicePool(TlsOptions()));
+        }();
+        return tls_pool;
+    }
+
+    /**
+     * @brief Pool that runs TLS handshakes before the sessions move to GetTlsInstance().
+     * This is a dedicated pool if ConfigureHandshake() was called with a non-zero thread count,
+     * otherwise the pool returned by GetTlsInstance(), in which case handshakes are not offloaded.
+     */
+    static std::shared_ptr<AsioIOServicePool> GetHandshakeInstance() {
+        static std::shared_ptr<AsioIOServicePool> handshake_pool = []() -> std::shared_ptr<AsioIOServicePool> {
+            if (HandshakeOptions().threads == 0) {
+                return GetTlsInstance();
+            }
+            return std::shared_ptr<AsioIOServicePool>(new AsioIOServicePool(HandshakeOptions()));
+        }();
+        return handshake_pool;
+    }
+
+    /**
+     * @brief Set the options of the shared pool. Must be called before the first GetInstance().
+     * @param options Pool options
+     */
+    static void Configure(IOServicePoolOptions options) {
+        if (_instance) {
+            MCP_WARN("AsioIOServicePool already running with {} threads, new options are ignored", _instance->Size());
+            return;
+        }
+        Options() = std::move(options);
+    }
+
+    /**
+     * @brief Set the options of the HTTPS pool. Must be called before the first GetTlsInstance().
+     * @param options Pool options; threads = 0 keeps HTTPS on the shared pool
+     */
+    static void ConfigureTls(IOServicePoolOptions options) {
+        TlsOptions() = std::move(options);
+    }
+
+    /**
+     * @brief Set the options of the handshake pool. Must be called before the first GetHandshakeInstance().
+     * @param options Pool options; threads = 0 runs handshakes on the HTTPS pool
+     */
+    static void ConfigureHandshake(IOServicePoolOptions options) {
+        HandshakeOptions() = std::move(options);
+    }
+
+    /**
+     * @brief Parse a CPU list such as "0-7,16,18-19".
+     * @param text CPU list, empty for none
+     * @return CPU indices in the order given
+     */
+    static std::vector<int> ParseCpuList(std::string_view text);
+
+    /**
+     * @brief Name the calling thread and optionally pin it to a CPU.
+     * @param name Thread name (truncated to 15 characters on Linux)
+     * @param cpu CPU index, -1 for no pinning
+     */
+    static void SetupCurrentThread(std::string name, int cpu);
+
+    /**
+     * @brief Counts of one io_context at the time of a Snapshot().
+     */
+    struct ContextSnapshot {
+        std::size_t sessions = 0;
+        std::size_t requests = 0;
+        uint64_t lag_us = 0;
+        uint64_t shed = 0;
+        uint64_t spin_us = 0;
+    };
+
+    /**
+     * @brief Counts of the io_contexts of one pool at the time of a Snapshot().
+     */
+    struct PoolSnapshot {
+        std::string name;///< Thread name prefix of the pool
+        std::vector<ContextSnapshot> contexts;
+        bool lag_probed = false;                    ///< The pool's io_contexts are probed, lag is meaningful
+        bool busy_poll = false;                     ///< The pool's threads busy poll, spin_us is meaningful
+        mcp::metrics::LatencyHistogram::Snapshot lag;///< Lag of every probe of the pool's io_contexts
+    };
+
+    /**
+     * @brief Read the activity of every io_context of the pools that exist.
+     * Pools are not created by taking a snapshot; the shared pool appears once even when the
+     * HTTPS or handshake pool is the same pool.
+     * @return One entry per pool, in the order they were created
+     */
+    static std::vector<PoolSnapshot> Snapshot();
+
+    /**
+     * @brief Stop every pool that exists, e.g. once a drain has finished; none is created.
+     * Must not be called from a pool thread.
+     */
+    static void StopAll();
+
 private:
-    AsioIOServicePool(std::size_t size = 2 /*std::thread::hardware_concurrency()*/);
+    AsioIOServicePool() : AsioIOServicePool(Options()) {}
+    explicit AsioIOServicePool(const IOServicePoolOptions &options);
+
+    static IOServicePoolOptions &Options() {
+        static IOServicePoolOptions options;
+        return options;
+    }
+
+    static IOServicePoolOptions &TlsOptions() {
+        static IOServicePoolOptions options{0, "mcp-tls", {}};
+        return options;
+    }
+
+    static IOServicePoolOptions &HandshakeOptions() {
+        static IOServicePoolOptions options{0, "mcp-tls-hs", {}};
+        return options;
+    }
 
+    void SetupThread(std::size_t index) const;
+
+    /**
+     * @brief Run an io_context until it is stopped. With busy_poll, a thread that runs out of work keeps
+     *        polling for that long before it sleeps in the reactor, so work arriving meanwhile skips the wakeup.
+     */
+    void Run(std::size_t index);
+
+    /**
+     * @brief Schedule the next lag probe of an io_context; the probe measures how late its timer
+     *        ran, which is how long the handlers before it kept the thread busy.
+     */
+    void ArmLagProbe(std::size_t index);
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<AsioIOServicePool *> pools;
+    };
+
+    static Registry &LivePools() {
+        static auto *registry = new Registry;// Never destroyed, pools held by statics may outlive it
+        return *registry;
+    }
+
+    IOServicePoolOptions _options;
     std::vector<IOService> _ioServices;
+    std::unique_ptr<IOServiceActivity[]> _activity;
+    mcp::metrics::LatencyHistogram _lag;
+    std::vector<std::unique_ptr<asio::steady_timer>> _lagProbes;///< One per io_context if probed, destroyed before them
     std::vector<WorkPtr> _works;
     std::vector<std::thread> _threads;
-    std::size_t _nextIOService;
+    std::atomic<std::size_t> _nextIOService;
+    std::atomic<std::size_t> _active;///< Leading io_contexts GetIOService() picks from
 };
 
-inline AsioIOServicePool::AsioIOServicePool(std::size_t size) : _ioServices(size),
-                                                                _works(size), _nextIOService(0) {
-    for (std::size_t i = 0; i < size; ++i) {
+inline AsioIOServicePool::AsioIOServicePool(const IOServicePoolOptions &options)
+    : _options(options),
+      _ioServices(options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency())),
+      _activity(std::make_unique<IOServiceActivity[]>(_ioServices.size())),
+      _works(_ioServices.size()), _nextIOService(0), _active(_ioServices.size()) {
+    for (std::size_t i = 0; i < _ioServices.size(); ++i) {
         _works[i] = std::make_unique<Work>(asio::make_work_guard(_ioServices[i]));
     }
+    if (_options.lag_probe_interval.count() > 0) {
+        for (std::size_t i = 0; i < _ioServices.size(); ++i) {
+            _lagProbes.push_back(std::make_unique<asio::steady_timer>(_ioServices[i]));
+            ArmLagProbe(i);
+        }
+    }
 
     for (std::size_t i = 0; i < _ioServices.size(); ++i) {
         _threads.emplace_back([this, i]() {
-            _ioServices[i].run();
+            SetupThread(i);
+            IOServiceActivity::CurrentRef() = &_activity[i];
+            Run(i);
         });
     }
+    {
+        auto &registry = LivePools();
+        std::lock_guard lock(registry.mutex);
+        registry.pools.push_back(this);
+    }
+    MCP_INFO("Started IO service pool '{}' with {} threads", _options.thread_name, _ioServices.size());
+    if (_options.busy_poll.count() > 0) {
+        MCP_INFO("IO service pool '{}' busy polls for {}us before sleeping", _options.thread_name, _options.busy_poll.count());
+        if (_options.cpus.empty()) {
+            MCP_WARN("IO service pool '{}' busy polls without pinned CPUs; its threads compete with the rest of the server", _options.thread_name);
+        }
+    }
 }
 
 inline AsioIOServicePool::~AsioIOServicePool() {
+    {
+        auto &registry = LivePools();
+        std::lock_guard lock(registry.mutex);
+        registry.pools.erase(std::remove(registry.pools.begin(), registry.pools.end(), this), registry.pools.end());
+    }
     Stop();
 }
 
 inline asio::io_context &AsioIOServicePool::GetIOService() {
-    auto &service = _ioServices[_nextIOService++];
-    if (_nextIOService == _ioServices.size()) {
-        _nextIOService = 0;
+    // Accept loops of several transports may pick contexts concurrently
+    return _ioServices[_nextIOService.fetch_add(1, std::memory_order_relaxed) % _active.load(std::memory_order_relaxed)];
+}
+
+inline void AsioIOServicePool::Run(std::size_t index) {
+    auto &io = _ioServices[index];
+    if (_options.busy_poll.count() <= 0) {
+        io.run();
+        return;
+    }
+    using clock = std::chrono::steady_clock;
+    auto &spin_us = _activity[index].spin_us;
+    while (!io.stopped()) {
+        if (io.poll() > 0) {
+            continue;
+        }
+        // Nothing ready: keep asking the reactor without blocking for a while, then sleep in it
+        auto spin_start = clock::now();
+        std::size_t ran = 0;
+        while ((ran = io.poll()) == 0 && !io.stopped() && clock::now() - spin_start < _options.busy_poll) {
+        }
+        auto spun = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - spin_start).count();
+        spin_us.fetch_add(static_cast<uint64_t>(spun), std::memory_order_relaxed);
+        if (ran == 0) {
+            io.run_one();
+        }
     }
-    return service;
+}
+
+inline void AsioIOServicePool::ArmLagProbe(std::size_t index) {
+    auto &timer = *_lagProbes[index];
+    timer.expires_after(_options.lag_probe_interval);
+    timer.async_wait([this, index](const asio::error_code &ec) {
+        if (ec) {
+            return;
+        }
+        auto late = std::chrono::steady_clock::now() - _lagProbes[index]->expiry();
+        auto us = static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(late).count()));
+        _lag.record(us);
+        // Only the io thread writes, a single slow handler moves the smoothed lag by a quarter
+        auto &smoothed = _activity[index].lag_us;
+        uint64_t previous = smoothed.load(std::memory_order_relaxed);
+        smoothed.store(previous - previous / 4 + us / 4, std::memory_order_relaxed);
+        ArmLagProbe(index);
+    });
 }
 
 inline void AsioIOServicePool::Stop() {
@@ -74,4 +402,103 @@ inline void AsioIOServicePool::Stop() {
             }
         }
     }
-}
\ No newline at end of file
+}
+
+inline std::vector<AsioIOServicePool::PoolSnapshot> AsioIOServicePool::Snapshot() {
+    auto &registry = LivePools();
+    std::lock_guard lock(registry.mutex);
+    std::vector<PoolSnapshot> result;
+    result.reserve(registry.pools.size());
+    for (const auto *pool: registry.pools) {
+        PoolSnapshot snapshot{pool->_options.thread_name, {}, !pool->_lagProbes.empty(), pool->_options.busy_poll.count() > 0,
+                              pool->_lag.snapshot()};
+        snapshot.contexts.reserve(pool->_ioServices.size());
+        for (std::size_t i = 0; i < pool->_ioServices.size(); ++i) {
+            const auto &activity = pool->_activity[i];
+            snapshot.contexts.push_back({activity.sessions.load(std::memory_order_relaxed),
+                                         activity.requests.load(std::memory_order_relaxed),
+                                         activity.lag_us.load(std::memory_order_relaxed),
+                                         activity.shed.load(std::memory_order_relaxed),
+                                         activity.spin_us.load(std::memory_order_relaxed)});
+        }
+        result.push_back(std::move(snapshot));
+    }
+    return result;
+}
+
+inline void AsioIOServicePool::StopAll() {
+    std::vector<AsioIOServicePool *> pools;
+    {
+        // Stop() joins the threads, which may be taking a Snapshot() under the registry lock
+        auto &registry = LivePools();
+        std::lock_guard lock(registry.mutex);
+        pools = registry.pools;
+    }
+    for (auto *pool: pools) {
+        pool->Stop();
+    }
+}
+
+inline std::vector<int> AsioIOServicePool::ParseCpuList(std::string_view text) {
+    std::vector<int> cpus;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+        while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+        if (item.empty()) {
+            continue;
+        }
+
+        int first = 0;
+        int last = 0;
+        size_t dash = item.find('-');
+        auto parse = [](std::string_view number, int &value) {
+            auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+            return ec == std::errc() && ptr == number.data() + number.size() && value >= 0;
+        };
+        bool valid = dash == std::string_view::npos
+                             ? parse(item, first) && parse(item, last)
+                             : parse(item.substr(0, dash), first) && parse(item.substr(dash + 1), last) && first <= last;
+        if (!valid) {
+            MCP_WARN("Ignoring invalid CPU list entry '{}'", item);
+            continue;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+inline void AsioIOServicePool::SetupThread(std::size_t index) const {
+    SetupCurrentThread(_options.thread_name + "-" + std::to_string(index),
+                       _options.cpus.empty() ? -1 : _options.cpus[index % _options.cpus.size()]);
+}
+
+inline void AsioIOServicePool::SetupCurrentThread(std::string name, [[maybe_unused]] int cpu) {
+#if defined(__linux__)
+    name.resize(std::min<std::size_t>(name.size(), 15));// Kernel limit is 16 bytes including NUL
+    pthread_setname_np(pthread_self(), name.c_str());
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            MCP_WARN("Failed to pin thread {} to CPU {}", name, cpu);
+        }
+    }
+#elif defined(__APPLE__)
+    pthread_setname_np(name.c_str());
+    if (cpu >= 0) {
+        MCP_WARN("CPU pinning is not supported on this platform, thread {} is not pinned", name);
+    }
+#elif defined(_WIN32)
+    SetThreadDescription(GetCurrentThread(), std::wstring(name.begin(), name.end()).c_str());
+    if (cpu >= 0 && cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) == 0) {
+        MCP_WARN("Failed to pin thread {} to CPU {}", name, cpu);
+    }
+#endif
+}
@@ -9,7 +9,7 @@ namespace mcp {
 
         // Static logger instance
         std::shared_ptr<spdlog::logger> g_logger = nullptr;
-        LogLevel g_current_level = LogLevel::INFO;
+        std::atomic<LogLevel> g_current_level{LogLevel::INFO};
 
         MCPLogger &MCPLogger::instance() {
             static MCPLogger instance;
@@ -32,39 +32,56 @@ namespace mcp {
             return g_current_level;
         }
 
+        namespace {
+            constexpr std::string_view kLevelNames[] = {"trace", "debug", "info", "warn", "error", "critical", "off"};
+        }
+
+        std::optional<LogLevel> MCPLogger::parse_level(std::string_view name) {
+            for (size_t i = 0; i < std::size(kLevelNames); ++i) {
+                if (name == kLevelNames[i]) {
+                    return static_cast<LogLevel>(i);
+                }
+            }
+            return std::nullopt;
+        }
+
+        std::string_view MCPLogger::level_name(LogLevel level) {
+            return kLevelNames[std::min<size_t>(static_cast<size_t>(level), std::size(kLevelNames) - 1)];
+        }
+
         // Overloads for string literals (without format arguments)
         void MCPLogger::trace(const char *msg) {
-            if (g_logger && static_cast<int>(LogLevel::TRACE) >= static_cast<int>(g_current_level)) {
+            if (g_logger && enabled(LogLevel::TRACE) && !(BinaryLog::active() && BinaryLog::push(LogLevel::TRACE, "{}", msg))) {
                 g_logger->trace(msg);
             }
         }
 
         void MCPLogger::debug(const char *msg) {
-            if (g_logger && static_cast<int>(LogLevel::DEBUG) >= static_cast<int>(g_current_level)) {
+            if (g_logger && enabled(LogLevel::DEBUG) && !(BinaryLog::active() && BinaryLog::push(LogLevel::DEBUG, "{}", msg))) {
                 g_logger->debug(msg);
             }
         }
 
         void MCPLogger::info(const char *msg) {
-            if (g_logger && static_cast<int>(LogLevel::INFO) >= static_cast<int>(g_current_level)) {
+            if (g_logger && enabled(LogLevel::INFO) && !(BinaryLog::active() && BinaryLog::push(LogLevel::INFO, "{}", msg))) {
                 g_logger->info(msg);
             }
         }
 
         void MCPLogger::warn(const char *msg) {
-            if (g_logger && static_cast<int>(LogLevel::WARN) >= static_cast<int>(g_current_level)) {
+            if (g_logger && enabled(LogLevel::WARN) && !(BinaryLog::active() && BinaryLog::push(LogLevel::WARN, "{}", msg))) {
                 g_logger->warn(msg);
             }
         }
 
         void MCPLogger::error(const char *msg) {
-            if (g_logger && static_cast<int>(LogLevel::ERR) >= static_cast<int>(g_current_level)) {
+            if (g_logger && enabled(LogLevel::ERR) && !(BinaryLog::active() && BinaryLog::push(LogLevel::ERR, "{}", msg))) {
                 g_logger->error(msg);
             }
         }
 
         void MCPLogger::critical(const char *msg) {
-            if (g_logger && static_cast<int>(LogLevel::CRITICAL) >= static_cast<int>(g_current_level)) {
+            if (g_logger && enabled(LogLevel::CRITICAL) && !(BinaryLog::active() && BinaryLog::push(LogLevel::CRITICAL, "{}", msg))) {
                 g_logger->critical(msg);
             }
         }
@@ -100,27 +117,9 @@ namespace mcp {
 
             auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(log_path, max_file_size, max_files);
 
-            // Set log level
-            spdlog::level::level_enum level_val = spdlog::level::info;
-            if (log_level == "trace") {
-                level_val = spdlog::level::trace;
-                g_current_level = LogLevel::TRACE;
-            } else if (log_level == "debug") {
-                level_val = spdlog::level::debug;
-                g_current_level = LogLevel::DEBUG;
-            } else if (log_level == "warn") {
-                level_val = spdlog::level::warn;
-                g_current_level = LogLevel::WARN;
-            } else if (log_level == "error") {
-                level_val = spdlog::level::err;
-                g_current_level = LogLevel::ERR;
-            } else if (log_level == "critical") {
-                level_val = spdlog::level::critical;
-                g_current_level = LogLevel::CRITICAL;
-            } else if (log_level == "off") {
-                level_val = spdlog::level::off;
-                g_current_level = LogLevel::OFF;
-            }
+            // Set log level, unknown names mean info
+            g_current_level = MCPLogger::parse_level(log_level).value_or(LogLevel::INFO);
+            auto level_val = static_cast<spdlog::level::level_enum>(static_cast<int>(g_current_level.load()));
 
             // Create async logger
             if (MCPLogger::is_file_sink_enabled())
@@ -128,7 +127,12 @@ namespace mcp {
             else
                 g_logger = std::make_shared<spdlog::logger>("mcp_logger", spdlog::sinks_init_list{console_sink});
             g_logger->set_level(level_val);
-            g_logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v");
+            g_logger->set_pattern(kLogPattern);
+
+            if (static_cast<int>(g_current_level.load()) < MCP_LOG_MIN_LEVEL) {
+                g_logger->warn("log_level {} is below the lowest level this build logs ({}), only those lines are written",
+                               log_level, MCP_LOG_MIN_LEVEL);
+            }
 
             spdlog::register_logger(g_logger);
             spdlog::set_default_logger(g_logger);
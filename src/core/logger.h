@@ -1,18 +1,41 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+
+#include "binary_log.h"
 
 // Include format library for format string support
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/logger.h>
 
-#define MCP_TRACE(...) ::mcp::core::MCPLogger::instance().trace(__VA_ARGS__)
-#define MCP_DEBUG(...) ::mcp::core::MCPLogger::instance().debug(__VA_ARGS__)
-#define MCP_INFO(...) ::mcp::core::MCPLogger::instance().info(__VA_ARGS__)
-#define MCP_WARN(...) ::mcp::core::MCPLogger::instance().warn(__VA_ARGS__)
-#define MCP_ERROR(...) ::mcp::core::MCPLogger::instance().error(__VA_ARGS__)
-#define MCP_CRITICAL(...) ::mcp::core::MCPLogger::instance().critical(__VA_ARGS__)
+// Log calls below this level (0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 critical) are compiled
+// out, arguments included; release builds set it to 2. The configured log_level filters the rest.
+#ifndef MCP_LOG_MIN_LEVEL
+#define MCP_LOG_MIN_LEVEL 0
+#endif
+
+// The level is checked before the arguments are evaluated, a disabled call costs one load
+#define MCP_LOG_AT_(level, method, ...)                                                  \
+    do {                                                                                 \
+        if constexpr (static_cast<int>(level) >= MCP_LOG_MIN_LEVEL) {                    \
+            if (::mcp::core::MCPLogger::enabled(level)) {                                \
+                ::mcp::core::MCPLogger::instance().method(__VA_ARGS__);                  \
+            }                                                                            \
+        }                                                                                \
+    } while (false)
+
+#define MCP_TRACE(...) MCP_LOG_AT_(::mcp::core::LogLevel::TRACE, trace, __VA_ARGS__)
+#define MCP_DEBUG(...) MCP_LOG_AT_(::mcp::core::LogLevel::DEBUG, debug, __VA_ARGS__)
+#define MCP_INFO(...) MCP_LOG_AT_(::mcp::core::LogLevel::INFO, info, __VA_ARGS__)
+#define MCP_WARN(...) MCP_LOG_AT_(::mcp::core::LogLevel::WARN, warn, __VA_ARGS__)
+#define MCP_ERROR(...) MCP_LOG_AT_(::mcp::core::LogLevel::ERR, error, __VA_ARGS__)
+#define MCP_CRITICAL(...) MCP_LOG_AT_(::mcp::core::LogLevel::CRITICAL, critical, __VA_ARGS__)
 
 namespace mcp {
     namespace core {
@@ -30,9 +53,27 @@ namespace mcp {
             OFF = 6
         };
 
+        /**
+         * @brief Line pattern of g_logger.
+         */
+        inline constexpr const char *kLogPattern = "[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v";
+
         // global logger instance
         extern std::shared_ptr<spdlog::logger> g_logger;
-        extern LogLevel g_current_level;
+        extern std::atomic<LogLevel> g_current_level;
+
+        /**
+         * @brief A message body or other payload in a log line, cut to MCPLogger::payload_limit().
+         */
+        struct LogPayload {
+            std::string_view text;
+        };
+
+        /**
+         * @brief Log a payload, such as a request or response body, cut to the configured limit.
+         * @param text Payload, referenced until the line is formatted
+         */
+        inline LogPayload payload(std::string_view text) { return {text}; }
 
 
         /**
@@ -83,24 +124,53 @@ namespace mcp {
             void critical(const char *msg);
 
             void set_level(LogLevel level);
+
+            /**
+             * @brief Parse a log_level name: trace, debug, info, warn, error, critical or off.
+             * @return The level, std::nullopt for an unknown name
+             */
+            static std::optional<LogLevel> parse_level(std::string_view name);
+
+            /**
+             * @brief The log_level name of a level, as parse_level() takes it.
+             */
+            static std::string_view level_name(LogLevel level);
             static void enable_file_sink() { enable_file_logging_ = true; }
             static void disable_file_sink() { enable_file_logging_ = false; }
             static bool is_file_sink_enabled() { return enable_file_logging_; }
 
             LogLevel get_level() const;
 
+            /**
+             * @brief Whether a log call at a level is written; what the MCP_ macros check first.
+             */
+            static bool enabled(LogLevel level) noexcept {
+                return static_cast<int>(level) >= static_cast<int>(g_current_level.load(std::memory_order_relaxed));
+            }
+
+            /**
+             * @brief Longest payload logged through payload(), longer ones are cut.
+             * @param bytes Limit in bytes, 0 for no limit
+             */
+            static void set_payload_limit(size_t bytes) { payload_limit_.store(bytes, std::memory_order_relaxed); }
+            static size_t payload_limit() { return payload_limit_.load(std::memory_order_relaxed); }
+
         private:
             MCPLogger() = default;
 
             static bool enable_file_logging_;
+            static inline std::atomic<size_t> payload_limit_{2048};
 
             template<typename... Args>
             void log(LogLevel level, fmt::format_string<Args...> fmt, Args &&...args) {
-                if (!g_logger || static_cast<int>(level) < static_cast<int>(g_current_level)) {
+                if (!g_logger || !enabled(level)) {
                     return;
                 }
 
                 try {
+                    if (BinaryLog::active() && BinaryLog::push(level, fmt, args...)) {
+                        return;
+                    }
                     std::string formatted_msg = fmt::format(fmt, std::forward<Args>(args)...);
                     switch (level) {
                         case LogLevel::TRACE:
@@ -176,4 +246,21 @@ namespace mcp {
             MCPLogger::instance().critical(fmt, std::forward<Args>(args)...);
         }
     }// namespace core
-}// namespace mcp
\ No newline at end of file
+}// namespace mcp
+
+/**
+ * @brief Writes a LogPayload, cut to the payload limit with the full size appended.
+ */
+template<>
+struct fmt::formatter<mcp::core::LogPayload> {
+    constexpr auto parse(fmt::format_parse_context &ctx) { return ctx.begin(); }
+
+    template<typename FormatContext>
+    auto format(const mcp::core::LogPayload &payload, FormatContext &ctx) const {
+        size_t limit = mcp::core::MCPLogger::payload_limit();
+        if (limit == 0 || payload.text.size() <= limit) {
+            return fmt::format_to(ctx.out(), "{}", payload.text);
+        }
+        return fmt::format_to(ctx.out(), "{}... ({} bytes)", payload.text.substr(0, limit), payload.text.size());
+    }
+};
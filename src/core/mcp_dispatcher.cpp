@@ -2,39 +2,54 @@
 #include "core/logger.h"
 #include "protocol/json_rpc.h"
 #include "transport/session.h"
-#include <sstream>
 
 using namespace mcp::core;
 McpDispatcher::McpDispatcher() {
 }
 
-void McpDispatcher::send_json_response(std::shared_ptr<mcp::transport::Session> session,
-                                       const std::string &json_body,
+void McpDispatcher::send_json_response(const std::shared_ptr<mcp::transport::Session> &session,
+                                       std::string json_body,
                                        int status_code) {
-    // clean buffer before sending response
-    session->clear_buffer();
-
-    std::ostringstream oss;
-    oss << "HTTP/1.1 " << status_code << " " << (status_code == 200 ? "OK" : "Bad Request") << "\r\n";
-    oss << "Content-Type: application/json\r\n";
-    oss << "Content-Length: " << json_body.size() << "\r\n";
-    //oss << "Connection: close\r\n";// force close after response
-    oss << "Connection: keep-alive\r\n";
-    oss << "\r\n";
-    oss << json_body;
-
-    MCP_DEBUG("[Sending Json Response]:\n{}", oss.str());
-
-    auto send_task = [session, response = oss.str()]() mutable -> asio::awaitable<void> {
-        try {
-            session->clear_buffer();
-            co_await session->write(response);
-        } catch (const std::exception &e) {
-            MCP_ERROR("Failed to send JSON response: {}", e.what());
-        }
-        //session->close();
-    };
-    asio::co_spawn(session->get_socket().get_executor(), send_task, asio::detached);
+    // A large result for a local client that asked goes in a sealed memfd passed with the response
+    std::optional<mcp::transport::SealedMemfd> memfd;
+    if (mcp::transport::wants_memfd(*session, json_body.size())) {
+        memfd = mcp::transport::SealedMemfd::create(json_body);
+    }
+
+    std::string header;
+    header.reserve(96);
+    header += "HTTP/1.1 ";
+    header += std::to_string(status_code);
+    header += status_code == 200 ? " OK\r\n" : " Bad Request\r\n";
+    header += "Content-Type: ";
+    header += memfd ? mcp::transport::kMemfdContentType : std::string_view("application/json");
+    header += "\r\n";
+    //header += "Connection: close\r\n";// force close after response
+    header += "Connection: keep-alive\r\n";
+
+    MCP_DEBUG("[Sending Json Response]:\n{}{}", header, payload(json_body));
+
+    if (memfd) {
+        std::string envelope = mcp::transport::memfd_envelope(json_body.size());
+        header += "Content-Length: ";
+        header += std::to_string(envelope.size());
+        header += "\r\n\r\n";
+        session->queue_write(std::move(header), std::move(envelope), std::move(*memfd));
+        return;
+    }
+
+    // Queued on the session so pipelined responses go out in request order;
+    // header and body are sent with one gather write, the body is not concatenated or copied
+    auto encoding = mcp::transport::response_encoding(session->get_headers(), json_body.size());
+    if (encoding != mcp::transport::ContentEncoding::Identity) {
+        // Compressed when the session sends it, off the handler's path
+        session->queue_write(std::move(header), std::move(json_body), encoding);
+        return;
+    }
+    header += "Content-Length: ";
+    header += std::to_string(json_body.size());
+    header += "\r\n\r\n";
+    session->queue_write(std::move(header), std::move(json_body));
 }
 
 void McpDispatcher::send_sse_error_event(std::shared_ptr<mcp::transport::Session> session, const std::string &message) {
@@ -51,8 +66,5 @@ void McpDispatcher::send_sse_error_event(std::shared_ptr<mcp::transport::Session
     std::string sse_error = "event: error\n" + json_string + "\n\n";
 
     MCP_DEBUG("[Error Sending SSE]: {}", sse_error);
-    asio::co_spawn(session->get_socket().get_executor(), [session, sse_error]() -> asio::awaitable<void> {
-            co_await session->write(sse_error);
-            session->close();
-            co_return; }, asio::detached);
+    session->post_write(std::move(sse_error), true);
 }
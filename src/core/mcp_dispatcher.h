@@ -11,7 +11,7 @@ namespace mcp::core {
     public:
         explicit McpDispatcher();
         static void send_sse_error_event(std::shared_ptr<mcp::transport::Session> session, const std::string &message);
-        static void send_json_response(std::shared_ptr<mcp::transport::Session> session, const std::string &json_body, int status_code);
+        static void send_json_response(const std::shared_ptr<mcp::transport::Session> &session, std::string json_body, int status_code);
     };
 
 }// namespace mcp::core
\ No newline at end of file
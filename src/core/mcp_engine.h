@@ -0,0 +1,51 @@
+/* src/core/mcp_engine.h - C interface of core::Engine, for embedding the server in any language */
+#ifndef MCP_ENGINE_H
+#define MCP_ENGINE_H
+
+#include "mcpserver_api.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mcp_engine mcp_engine;
+
+/**
+ * @brief Receives the answer of a request.
+ * @param response Serialized JSON-RPC response, only valid during the call; NULL for notifications
+ * @param length Bytes of response
+ * @param user_data Pointer given with the request
+ */
+typedef void (*mcp_engine_callback)(const char *response, size_t length, void *user_data);
+
+/**
+ * @brief Load the plugins of a directory and start an engine.
+ * @param plugin_directory Directory relative to the executable, as plugin_dir in config.ini; NULL for none
+ * @param threads Threads calling back, 0 for one
+ * @return Engine, NULL if it could not be started
+ */
+MCP_API mcp_engine *mcp_engine_create(const char *plugin_directory, size_t threads);
+
+/**
+ * @brief Answer a JSON-RPC message, or a batch, on an engine thread.
+ * @param engine Engine
+ * @param request Raw JSON-RPC message, copied before the call returns
+ * @param length Bytes of request
+ * @param callback Called once with the answer, on an engine thread
+ * @param user_data Passed to the callback
+ */
+MCP_API void mcp_engine_submit(mcp_engine *engine, const char *request, size_t length,
+                               mcp_engine_callback callback, void *user_data);
+
+/**
+ * @brief Wait for the requests still running, then stop the engine and unload its plugins.
+ * @param engine Engine, may be NULL
+ */
+MCP_API void mcp_engine_destroy(mcp_engine *engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MCP_ENGINE_H */
@@ -0,0 +1,92 @@
+#include "paged_list.h"
+#include <algorithm>
+#include <charconv>
+#include <nlohmann/json.hpp>
+
+namespace mcp::core {
+
+    namespace {
+        // version "." offset "." key; the key goes last, it may contain anything
+        bool parse_number(std::string_view text, uint64_t &value) {
+            auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return ec == std::errc() && end == text.data() + text.size() && !text.empty();
+        }
+    }// namespace
+
+    std::string PagedList::cursor_after(size_t end) const {
+        std::string cursor = std::to_string(version);
+        cursor += '.';
+        cursor += std::to_string(end);
+        cursor += '.';
+        cursor += keys[end - 1];
+        return cursor;
+    }
+
+    std::optional<size_t> PagedList::resume(std::string_view cursor) const {
+        size_t first_dot = cursor.find('.');
+        size_t second_dot = first_dot == std::string_view::npos ? first_dot : cursor.find('.', first_dot + 1);
+        if (second_dot == std::string_view::npos) {
+            return std::nullopt;
+        }
+        uint64_t cursor_version = 0;
+        uint64_t offset = 0;
+        if (!parse_number(cursor.substr(0, first_dot), cursor_version) ||
+            !parse_number(cursor.substr(first_dot + 1, second_dot - first_dot - 1), offset) || offset == 0) {
+            return std::nullopt;
+        }
+        std::string_view key = cursor.substr(second_dot + 1);
+
+        if (offset <= keys.size() && (cursor_version == version || keys[offset - 1] == key)) {
+            return static_cast<size_t>(offset);
+        }
+        if (sorted) {
+            return static_cast<size_t>(std::upper_bound(keys.begin(), keys.end(), key, [](std::string_view k, const std::string &entry) {
+                                           return k < entry;
+                                       }) -
+                                       keys.begin());
+        }
+        auto it = std::find(keys.begin(), keys.end(), key);
+        if (it == keys.end()) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(it - keys.begin()) + 1;
+    }
+
+    std::optional<std::string> PagedList::page(std::string_view cursor, size_t page_size) const {
+        size_t begin = 0;
+        if (!cursor.empty()) {
+            auto offset = resume(cursor);
+            if (!offset) {
+                return std::nullopt;
+            }
+            begin = *offset;
+        }
+        size_t end = page_size == 0 ? entries.size() : std::min(entries.size(), begin + page_size);
+
+        std::string result = "{";
+        if (!head.empty()) {
+            result += head;
+            result += ',';
+        }
+        result += nlohmann::json(array).dump();
+        result += ":[";
+        for (size_t i = begin; i < end; ++i) {
+            if (i != begin) {
+                result += ',';
+            }
+            result += entries[i];
+        }
+        result += ']';
+        if (cursor.empty() && !first_page_tail.empty()) {
+            result += ',';
+            result += first_page_tail;
+        }
+        if (end < entries.size()) {
+            result += R"(,"nextCursor":)";
+            result += nlohmann::json(cursor_after(end)).dump();
+        }
+        result += '}';
+        return result;
+    }
+
+}// namespace mcp::core
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp::core {
+
+    /**
+     * @brief Page size of tools/list, resources/list and prompts/list, normally taken from the [server] config section.
+     */
+    struct PaginationOptions {
+        size_t page_size = 0;///< Entries per page, 0 = the whole list in one result
+
+        static const PaginationOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         */
+        static void configure(const PaginationOptions &options) { storage() = options; }
+
+    private:
+        static PaginationOptions &storage() {
+            static PaginationOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief A list result cut into serialized entries, so pages are put together without
+     *        serializing anything again. Built once per version of the list and shared.
+     *
+     * A cursor names the list version, the offset of the next entry and the key of the last
+     * entry sent. While the version is unchanged the offset is used as it is. After a change the
+     * key of the entry before the offset is compared, which is all it takes for lists that are
+     * only appended to; otherwise the page resumes after the key, found by binary search in a
+     * sorted list or by a scan in one that is not. Entries added or removed before the cursor
+     * therefore never make a client skip or repeat entries that were there all along.
+     */
+    struct PagedList {
+        uint64_t version = 0;            ///< Bumped whenever the list changes
+        bool sorted = false;             ///< Keys in ascending order
+        std::string array;               ///< Member of the result the entries go in, e.g. "tools"
+        std::string head;                ///< Members written before the array on every page, "" for none
+        std::string first_page_tail;     ///< Members written after the array on the first page only, "" for none
+        std::vector<std::string> keys;   ///< Name or URI of each entry
+        std::vector<std::string> entries;///< Serialized JSON object of each entry
+        std::shared_ptr<const std::string> full;///< Serialized result with every entry, sent when no paging is needed
+
+        /**
+         * @brief Serialized result object with one page of entries.
+         * @param cursor params.cursor of the request, empty for the first page
+         * @param page_size Entries per page, 0 = all the rest
+         * @return Result with nextCursor set when entries are left; std::nullopt if the cursor
+         *         is malformed or its last entry is gone from an unsorted list
+         */
+        std::optional<std::string> page(std::string_view cursor, size_t page_size) const;
+
+    private:
+        std::optional<size_t> resume(std::string_view cursor) const;
+        std::string cursor_after(size_t end) const;
+    };
+
+}// namespace mcp::core
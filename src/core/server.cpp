@@ -1,12 +1,22 @@
 #include "server.h"
 #include "Resources/resource.h"
+#include "engine.h"
 #include "business/plugin_manager.h"
+#include "business/tool_list_changed.h"
 #include "business/tool_registry.h"
+#include "core/housekeeping.h"
+#include "core/io_context_pool.hpp"
 #include "core/logger.h"
 #include "executable_path.h"
+#include "startup_timeline.h"
 #include "protocol/tool.h"
+#include "transport/drain.h"
+#include "transport/mcp_cache.h"
+#include "transport/notification_broadcast.h"
 #include "transport/session.h"
 #include "transport/ssl_session.h"
+#include "transport/upload_stream.h"
+#include <algorithm>
 #include <memory>
 #include <thread>
 
@@ -62,22 +72,38 @@ namespace mcp::core {
     }
 
     std::unique_ptr<MCPserver> MCPserver::Builder::build() {
-        // init core components
-        server_->registry_ = std::make_shared<business::ToolRegistry>();
-        server_->resource_manager_ = std::make_shared<resources::ResourceManager>();
-        server_->plugin_manager_ = std::make_shared<business::PluginManager>();
-        server_->registry_->set_plugin_manager(server_->plugin_manager_);
-
-        server_->request_handler_ = std::make_unique<business::RequestHandler>(
-                server_->registry_,
-
-                [server_ptr = server_.get()](const std::string &resp,
-                                             std::shared_ptr<transport::Session> session,
-                                             [[maybe_unused]] const std::string &session_id) {
-                    // pass session_id
-                    server_ptr->dispatcher_->send_json_response(session, resp, 200);
-                });
-        server_->prompt_manager_ = std::make_shared<prompts::PromptManager>();
+        auto &timeline = StartupTimeline::instance();
+        {
+            // init core components; the request handler's router restores the stream cache
+            auto phase = timeline.phase("core and stream cache");
+            server_->registry_ = std::make_shared<business::ToolRegistry>();
+            server_->resource_manager_ = std::make_shared<resources::ResourceManager>();
+            // Subscriptions of an MCP session last until it ends, over any number of connections
+            transport::NotificationBroadcast::instance().on_session_end(
+                    [weak_manager = std::weak_ptr<resources::ResourceManager>(server_->resource_manager_)](const std::string &client_session) {
+                        if (auto manager = weak_manager.lock()) {
+                            manager->unsubscribe_all(client_session);
+                        }
+                    });
+            server_->prompt_manager_ = std::make_shared<prompts::PromptManager>();
+            server_->plugin_manager_ = std::make_shared<business::PluginManager>();
+            server_->registry_->set_plugin_manager(server_->plugin_manager_);
+            server_->registry_->set_argument_validation(server_->validate_tool_arguments_);
+            server_->registry_->set_per_thread_snapshots(server_->shared_nothing_);
+
+            server_->request_handler_ = std::make_unique<business::RequestHandler>(
+                    server_->registry_,
+                    server_->resource_manager_,
+                    server_->prompt_manager_,
+
+                    [server_ptr = server_.get()](std::string resp,
+                                                 const std::shared_ptr<transport::Session> &session,
+                                                 [[maybe_unused]] const std::string &session_id) {
+                        // pass session_id
+                        server_ptr->dispatcher_->send_json_response(session, std::move(resp), 200);
+                    });
+            server_->dispatcher_ = std::make_unique<McpDispatcher>();
+        }
 
         MCP_TRACE("Created ToolRegistry (initial size: {})", server_->registry_->get_all_tool_names().size());
 
@@ -92,131 +118,124 @@ namespace mcp::core {
             MCP_INFO("Registered built-in echo tool");
         }
 
-        // Load plugins from directories
-        for (const auto &directory: server_->plugin_directories_) {
-            MCP_TRACE("Loading plugins from directory: {}", directory);
-            server_->plugin_manager_->load_plugins_from_directory(directory);
-        }
-
-        // Register tools from plugins loaded from directories
-        auto all_tools = server_->plugin_manager_->get_all_tools();
-        MCP_INFO("Found {} tools from all plugins loaded from directories", all_tools.size());
-
-        for (const auto &tool_info: all_tools) {
-            if (!tool_info.name) {
-                MCP_WARN("Skipping tool with null name");
-                continue;
+        // Large tools/call bodies go straight to plugins that stream one of their arguments
+        transport::set_streamed_argument_lookup([plugin_manager = std::weak_ptr(server_->plugin_manager_)](std::string_view tool) {
+            auto manager = plugin_manager.lock();
+            return manager ? manager->streamed_argument(std::string(tool)) : std::string();
+        });
+
+        server_->plugin_manager_->set_lazy_loading(server_->lazy_plugin_loading_,
+                                                    std::chrono::seconds(server_->plugin_idle_unload_seconds_));
+
+        // Plugins named in plugin_isolation run in a child process started from this executable
+        std::vector<std::string> isolated_plugins;
+        for (size_t start = 0; start <= server_->plugin_isolation_.size();) {
+            size_t end = std::min(server_->plugin_isolation_.find(',', start), server_->plugin_isolation_.size());
+            std::string name = server_->plugin_isolation_.substr(start, end - start);
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (!name.empty()) {
+                isolated_plugins.push_back(std::move(name));
             }
+            start = end + 1;
+        }
+        if (!isolated_plugins.empty()) {
+            business::PluginHost::Options host_options;
+            host_options.executable = getExecutablePath();
+            host_options.channels = std::max<size_t>(server_->plugin_host_channels_, 1);
+            host_options.buffer_bytes = server_->plugin_host_buffer_kb_ * 1024;
+            server_->plugin_manager_->set_isolation(std::move(isolated_plugins), std::move(host_options));
+        }
 
-            std::string tool_name = tool_info.name;
-            MCP_DEBUG("Registering tool: '{}' from plugin", tool_name);
-
-            // bind the tool call to the plugin manager
-            auto executor = [server_ptr = server_.get(), tool_name](const nlohmann::json &args) {
-                return server_ptr->plugin_manager_->call_tool(tool_name, args);
-            };
-
-            // register the tool in the registry table
-            server_->registry_->register_plugin_tool(tool_info, executor);
+        {
+            auto phase = timeline.phase("resources and prompts");
+
+            // Register sample resources
+            mcp::resources::Resource sample_resource;
+            sample_resource.uri = "file://localhost/resources/sample.txt";
+            sample_resource.name = "Sample Text Resource";
+            sample_resource.description = "A sample text file demonstrating the Resources primitive";
+            sample_resource.mimeType = "text/plain";
+            server_->resource_manager_->register_resource(sample_resource);
+
+            mcp::resources::ResourceTemplate file_template;
+            file_template.uriTemplate = "file://localhost/{path}";
+            file_template.name = "File Resource";
+            file_template.description = "Template for accessing files on the server";
+            file_template.mimeType = "application/octet-stream";
+            server_->resource_manager_->register_resource_template(file_template);
+
+            // Register sample prompts
+            mcp::prompts::Prompt analyze_code_prompt;
+            analyze_code_prompt.name = "analyze-code";
+            analyze_code_prompt.description = "Analyze a code snippet";
+            mcp::prompts::PromptArgument language_arg;
+            language_arg.name = "language";
+            language_arg.description = "programming language";
+            language_arg.required = true;
+            analyze_code_prompt.arguments.push_back(language_arg);
+            analyze_code_prompt.messages.push_back({"user", "Analyze the given {{language}} code and suggest how to improve it."});
+            server_->prompt_manager_->register_prompt(analyze_code_prompt);
+
+            mcp::prompts::Prompt git_commit_prompt;
+            git_commit_prompt.name = "git-commit";
+            git_commit_prompt.description = "generate Git commit message";
+            mcp::prompts::PromptArgument changes_arg;
+            changes_arg.name = "changes";
+            changes_arg.description = "Git diff or changes description";
+            changes_arg.required = true;
+            git_commit_prompt.arguments.push_back(changes_arg);
+            git_commit_prompt.messages.push_back({"user", "Write a Git commit message for these changes:\n\n{{changes}}"});
+            server_->prompt_manager_->register_prompt(git_commit_prompt);
         }
 
-        // 3. load plugins and register their tools
-        for (const auto &path: server_->plugin_paths_) {
-            MCP_TRACE("Processing plugin: {}", path);
-            if (!server_->plugin_manager_->load_plugin(path)) {
-                MCP_ERROR("Skipping invalid plugin: {}", path);
-                continue;
+        {
+            // The listeners are bound before the tools load; the readiness probe answers 503 until they are in
+            auto phase = timeline.phase("listeners");
+            if (enable_http_transport_) {
+                // Automatically start HTTP transport as part of the build process
+                if (!server_->start_http_transport(port_, address_)) {
+                    MCP_ERROR("Failed to start HTTP transport during server build");
+                } else {
+                    // HTTP transport started message is logged in start_http_transport
+                }
             }
 
-            // get current tools from the plugin and register them
-            auto tools = server_->plugin_manager_->get_tools_from_plugin(path);
-            MCP_INFO("Found {} tools in plugin: {}", tools.size(), path);
-
-            for (const auto &tool_info: tools) {
-                if (!tool_info.name) {
-                    MCP_WARN("Skipping tool with null name");
-                    continue;
+            if (enable_https_transport_) {
+                // Automatically start HTTPS transport as part of the build process
+                if (!server_->start_https_transport(https_port_, address_, cert_file_, private_key_file_, dh_params_file_)) {
+                    MCP_ERROR("Failed to start HTTPS transport during server build");
+                    MCP_ERROR("HTTPS transport will be disabled");
+                    // Disable HTTPS transport since it failed to start
+                    enable_https_transport_ = false;
+                } else {
+                    MCP_INFO("HTTPS Transport started on {}:{}", address_, https_port_);
                 }
-
-                std::string tool_name = tool_info.name;
-
-                // bind the tool call to the plugin manager
-                auto executor = [server_ptr = server_.get(), tool_name](const nlohmann::json &args) {
-                    return server_ptr->plugin_manager_->call_tool(tool_name, args);
-                };
-
-                // register the tool in the registry table
-                server_->registry_->register_plugin_tool(tool_info, executor);
             }
-        }
-
-        // debug: print all registered tools
-        auto final_tools = server_->registry_->get_all_tool_names();
-        MCP_INFO("Final tools in registry (total: {}):", final_tools.size());
-        for (const auto &name: final_tools) {
-            MCP_INFO("  - '{}'", name);
-        }
 
-        // Register sample resources
-        mcp::resources::Resource sample_resource;
-        sample_resource.uri = "file://localhost/resources/sample.txt";
-        sample_resource.name = "Sample Text Resource";
-        sample_resource.description = "A sample text file demonstrating the Resources primitive";
-        sample_resource.mimeType = "text/plain";
-        server_->resource_manager_->register_resource(sample_resource);
-
-        mcp::resources::ResourceTemplate file_template;
-        file_template.uriTemplate = "file://localhost/{path}";
-        file_template.name = "File Resource";
-        file_template.description = "Template for accessing files on the server";
-        file_template.mimeType = "application/octet-stream";
-        server_->resource_manager_->register_resource_template(file_template);
-
-        server_->dispatcher_ = std::make_unique<McpDispatcher>();
-
-        // Register sample prompts
-        mcp::prompts::Prompt analyze_code_prompt;
-        analyze_code_prompt.name = "analyze-code";
-        analyze_code_prompt.description = "analyze-code";
-        mcp::prompts::PromptArgument language_arg;
-        language_arg.name = "language";
-        language_arg.description = "programming language";
-        language_arg.required = true;
-        analyze_code_prompt.arguments.push_back(language_arg);
-        server_->prompt_manager_->register_prompt(analyze_code_prompt);
-
-        mcp::prompts::Prompt git_commit_prompt;
-        git_commit_prompt.name = "git-commit";
-        git_commit_prompt.description = "generate Git commit message";
-        mcp::prompts::PromptArgument changes_arg;
-        changes_arg.name = "changes";
-        changes_arg.description = "Git diff or changes description";
-        changes_arg.required = true;
-        git_commit_prompt.arguments.push_back(changes_arg);
-        server_->prompt_manager_->register_prompt(git_commit_prompt);
-
-        if (enable_http_transport_) {
-            // Automatically start HTTP transport as part of the build process
-            if (!server_->start_http_transport(port_, address_)) {
-                MCP_ERROR("Failed to start HTTP transport during server build");
-            } else {
-                // HTTP transport started message is logged in start_http_transport
+            if (!unix_socket_path_.empty()) {
+                if (!server_->start_unix_transport(unix_socket_path_, unix_socket_auth_)) {
+                    MCP_ERROR("Failed to start Unix socket transport during server build");
+                    unix_socket_path_.clear();
+                }
             }
         }
 
-        if (enable_https_transport_) {
-            // Automatically start HTTPS transport as part of the build process
-            if (!server_->start_https_transport(https_port_, address_, cert_file_, private_key_file_, dh_params_file_)) {
-                MCP_ERROR("Failed to start HTTPS transport during server build");
-                MCP_ERROR("HTTPS transport will be disabled");
-                // Disable HTTPS transport since it failed to start
-                enable_https_transport_ = false;
-            } else {
-                MCP_INFO("HTTPS Transport started on {}:{}", address_, https_port_);
-            }
+        // Loading plugins may take seconds; with a listener up it runs while requests are served
+        bool listening = server_->http_transport_ || server_->https_transport_ || server_->unix_transport_;
+        if (server_->background_tool_loading_ && listening) {
+            server_->tool_loader_ = std::thread([server_ptr = server_.get()]() {
+                server_ptr->load_tools();
+            });
+        } else {
+            server_->load_tools();
         }
 
         if (enable_stdio_transport_) {
+            // stdio clients have no readiness probe, they get the server once the tools are in
+            if (server_->tool_loader_.joinable()) {
+                server_->tool_loader_.join();
+            }
             // Automatically start Stdio transport as part of the build process
             if (!server_->start_stdio_transport()) {
                 MCP_ERROR("Failed to start Stdio transport during server build");
@@ -226,7 +245,7 @@ namespace mcp::core {
         }
 
         // Summary of enabled transports
-        if (enable_http_transport_ || enable_https_transport_ || enable_stdio_transport_) {
+        if (enable_http_transport_ || enable_https_transport_ || enable_stdio_transport_ || !unix_socket_path_.empty()) {
             MCP_INFO("Enabled transports:");
             if (enable_stdio_transport_) {
                 MCP_INFO("  - Stdio transport");
@@ -237,18 +256,93 @@ namespace mcp::core {
             if (enable_https_transport_) {
                 MCP_INFO("  - HTTPS transport on port {}", https_port_);
             }
-        } else {
+            if (!unix_socket_path_.empty()) {
+                MCP_INFO("  - Unix socket transport on {}", unix_socket_path_);
+            }
+        } else if (!embedded_) {
             MCP_WARN("No transports enabled. Server will not be able to receive messages.");
         }
-        for (const auto &directory: server_->plugin_directories_) {
-            if (server_->plugin_manager_->start_directory_monitoring(directory)) {
+
+        return std::move(server_);
+    }
+
+    std::unique_ptr<Engine> MCPserver::Builder::build_engine(size_t threads) {
+        embedded_ = true;
+        enable_http_transport_ = false;
+        enable_https_transport_ = false;
+        enable_stdio_transport_ = false;
+        unix_socket_path_.clear();
+        // With no listener the tools are loaded before build() returns
+        return std::make_unique<Engine>(build(), threads);
+    }
+
+    MCPserver::~MCPserver() {
+        if (tool_loader_.joinable()) {
+            tool_loader_.join();
+        }
+    }
+
+    void MCPserver::load_tools() {
+        auto &timeline = StartupTimeline::instance();
+        {
+            // Load plugins from directories and explicit paths in one parallel phase
+            auto phase = timeline.phase("plugins");
+            std::vector<std::string> plugin_files;
+            for (const auto &directory: plugin_directories_) {
+                MCP_TRACE("Loading plugins from directory: {}", directory);
+                auto files = plugin_manager_->find_plugin_files(directory);
+                plugin_files.insert(plugin_files.end(), files.begin(), files.end());
+            }
+            plugin_files.insert(plugin_files.end(), plugin_paths_.begin(), plugin_paths_.end());
+            plugin_manager_->load_plugins(plugin_files);
+        }
+
+        {
+            // Register the tools of all loaded plugins at once, in load order
+            auto phase = timeline.phase("tool registration");
+            auto all_tools = plugin_manager_->get_all_tools();
+            MCP_INFO("Found {} tools from all loaded plugins", all_tools.size());
+            auto make_executor = [this](const std::string &tool_name) -> business::ToolExecutor {
+                // bind the tool call to the plugin manager; the name is the registry entry's own,
+                // and two pointers fit std::function without an allocation
+                return [this, name = &tool_name](const nlohmann::json &args) {
+                    return plugin_manager_->call_tool(*name, args);
+                };
+            };
+            auto make_raw_executor = [this](const std::string &tool_name) -> business::RawToolExecutor {
+                // same call, but tools/call gets the plugin's bytes and decides whether to parse them
+                return [this, name = &tool_name](const nlohmann::json &args) {
+                    return plugin_manager_->invoke_tool(*name, args);
+                };
+            };
+            registry_->register_plugin_tools(all_tools, make_executor, make_raw_executor);
+
+            // Later changes, hot reloads and upstream tools, are announced to the clients
+            business::broadcast_tool_list_changes(*registry_);
+            plugin_manager_->set_reload_listener([this, make_executor, make_raw_executor](const auto &removed, const auto &added) {
+                registry_->reload_plugin_tools(removed, added, make_executor, make_raw_executor);
+            });
+
+            // Upstream tools are listed in the background and join the registry as they arrive
+            federation_ = business::Federation::start(registry_);
+        }
+
+        // debug: print all registered tools
+        auto final_tools = registry_->get_all_tool_names();
+        std::sort(final_tools.begin(), final_tools.end());
+        MCP_INFO("Final tools in registry (total: {}):", final_tools.size());
+        for (const auto &name: final_tools) {
+            MCP_INFO("  - '{}'", name);
+        }
+
+        for (const auto &directory: plugin_directories_) {
+            if (plugin_manager_->start_directory_monitoring(directory)) {
                 MCP_INFO("Started monitoring plugin directory: {}", directory);
             } else {
                 MCP_WARN("Failed to start monitoring for plugin directory: {}", directory);
             }
         }
-
-        return std::move(server_);
+        timeline.set_ready();
     }
 
     void MCPserver::start() {
@@ -260,15 +354,15 @@ namespace mcp::core {
 
     bool MCPserver::start_http_transport(uint16_t port, const std::string &address) {
         try {
-            http_transport_ = std::make_unique<mcp::transport::HttpTransport>(address, port, auth_manager_);
+            http_transport_ = std::make_unique<mcp::transport::HttpTransport>(address, port, auth_manager_, reuse_port_);
 
-            auto success = http_transport_->start([this](const std::string &msg,
-                                                         std::shared_ptr<mcp::transport::Session> session,
-                                                         const std::string &session_id) {
-                MCP_DEBUG("HTTP message received: \n{}", msg);
+            auto success = http_transport_->start([this](std::string_view msg,
+                                                         const std::shared_ptr<mcp::transport::Session> &session,
+                                                         const std::string &session_id) -> asio::awaitable<void> {
+                MCP_DEBUG("HTTP message received: \n{}", payload(msg));
                 // handle by dispatcher
                 //dispatcher_->handle_request(msg, session, session_id);
-                request_handler_->handle_request(msg, session, session_id);
+                co_await request_handler_->handle_request(msg, session, session_id);
             });
 
             if (success) {
@@ -287,16 +381,13 @@ namespace mcp::core {
     bool MCPserver::start_https_transport(uint16_t port, const std::string &address,
                                           const std::string &cert_file, const std::string &private_key_file, const std::string &dh_params_file) {
         try {
-            https_transport_ = std::make_unique<mcp::transport::HttpsTransport>(address, port, cert_file, private_key_file, dh_params_file, auth_manager_);
+            https_transport_ = std::make_unique<mcp::transport::HttpsTransport>(address, port, cert_file, private_key_file, dh_params_file, auth_manager_, reuse_port_);
 
-            auto success = https_transport_->start([this](const std::string &msg,
-                                                          std::shared_ptr<mcp::transport::Session> session,
-                                                          const std::string &session_id) {
-                MCP_DEBUG("HTTPS message received: \n{}", msg);
-                // handle by dispatcher
-                // convert to SSL session
-                auto ssl_session = std::dynamic_pointer_cast<mcp::transport::SslSession>(session);
-                request_handler_->handle_request(msg, ssl_session ? ssl_session : session, session_id);
+            auto success = https_transport_->start([this](std::string_view msg,
+                                                          const std::shared_ptr<mcp::transport::Session> &session,
+                                                          const std::string &session_id) -> asio::awaitable<void> {
+                MCP_DEBUG("HTTPS message received: \n{}", payload(msg));
+                co_await request_handler_->handle_request(msg, session, session_id);
             });
 
             if (success) {
@@ -320,20 +411,42 @@ namespace mcp::core {
         }
     }
 
-    bool MCPserver::start_stdio_transport() {
+    bool MCPserver::start_unix_transport(const std::string &path, const mcp::transport::UnixSocketAuth &peer_auth) {
         try {
-            // handle stdio
-            auto stdio_handler = [this](const std::string &msg) {
-                MCP_DEBUG("STDIO message received: {}", msg);
+            unix_transport_ = std::make_unique<mcp::transport::UnixTransport>(path, auth_manager_, peer_auth);
+
+            auto success = unix_transport_->start([this](std::string_view msg,
+                                                         const std::shared_ptr<mcp::transport::Session> &session,
+                                                         const std::string &session_id) -> asio::awaitable<void> {
+                MCP_DEBUG("Unix socket message received: \n{}", payload(msg));
+                co_await request_handler_->handle_request(msg, session, session_id);
+            });
+
+            if (success) {
+                MCP_INFO("Unix socket Transport started on {}", path);
+            } else {
+                MCP_ERROR("Failed to start Unix socket Transport on {}", path);
+            }
 
-                // use the same handler as http_transport_
-                request_handler_->handle_request(msg, nullptr, "");
+            return success;
+        } catch (const std::exception &e) {
+            MCP_ERROR("Exception when starting Unix socket Transport on {}: {}", path, e.what());
+            return false;
+        }
+    }
+
+    bool MCPserver::start_stdio_transport() {
+        try {
+            // handle stdio with the same handler as http_transport_; the transport writes the answers
+            auto stdio_handler = [this](std::string_view msg) -> asio::awaitable<std::string> {
+                std::string session_id;
+                co_return co_await request_handler_->respond(msg, nullptr, session_id);
             };
 
             // init the transport with the same registry tools as http_transport_
-            stdio_transport_ = mcp::transport::StdioTransport(registry_);
+            stdio_transport_ = std::make_unique<mcp::transport::StdioTransport>(registry_);
 
-            bool success = stdio_transport_.open(stdio_handler);
+            bool success = stdio_transport_->open(stdio_handler);
 
             if (success) {
                 MCP_INFO("STDIO Transport started");
@@ -349,6 +462,11 @@ namespace mcp::core {
     }
 
     void MCPserver::run() {
+        // The listeners are open by now, plugins may start their background work
+        if (plugin_manager_) {
+            plugin_manager_->notify_server_started();
+        }
+
         // Check if we have any transport running
         if (http_transport_ || https_transport_) {
             std::vector<std::thread> threads;
@@ -378,12 +496,55 @@ namespace mcp::core {
             MCP_INFO("MCPServer is running in stdio-only mode. Waiting for input on stdin...");
             MCP_INFO("Press Ctrl+C to stop the server.");
 
-            while (true) {
+            while (!stopped_) {
                 std::this_thread::sleep_for(std::chrono::seconds(1));
             }
         }
     }
 
+    void MCPserver::drain() {
+        auto &drain = transport::Drain::instance();
+        const auto &options = transport::DrainOptions::current();
+        auto deadline = std::chrono::steady_clock::now() + options.timeout;
+
+        if (!drain.begin(options)) {
+            return;// A signal and a hot restart may both ask; the first drain stops the server
+        }
+        if (http_transport_) {
+            http_transport_->stop_accepting();
+        }
+        if (https_transport_) {
+            https_transport_->stop_accepting();
+        }
+        if (unix_transport_) {
+            unix_transport_->stop_accepting();
+        }
+
+        if (drain.wait_idle(deadline)) {
+            MCP_INFO("Drained: all requests and streams have finished");
+        } else {
+            MCP_WARN("Drain timed out after {} ms with {} requests and {} streams still open",
+                     options.timeout.count(), transport::Drain::requests_in_flight(), drain.streams());
+        }
+
+        // No cleanup, reload or expiry runs from here on, so the flush sees the cache as it is
+        Housekeeping::instance().stop();
+        // Streams ended by the drain are resumed from the cache; its backend gets everything first
+        cache::McpCache::GetInstance()->Flush();
+
+        if (http_transport_) {
+            http_transport_->stop();
+        }
+        if (https_transport_) {
+            https_transport_->stop();
+        }
+        if (unix_transport_) {
+            unix_transport_->stop();
+        }
+        AsioIOServicePool::StopAll();
+        stopped_ = true;
+    }
+
     asio::io_context &MCPserver::get_io_context() {
         // Return HTTP context if available, otherwise HTTPS context
         if (http_transport_) {
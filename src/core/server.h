@@ -8,19 +8,25 @@
 #include "Auth/AuthManager.hpp"
 #include "Prompts/prompt.h"
 #include "Resources/resource.h"
+#include "business/federation.h"
 #include "business/request_handler.h"
 #include "business/tool_registry.h"
 #include "core/mcp_dispatcher.h"
 #include "transport/http_transport.h"
 #include "transport/https_transport.h"
 #include "transport/stdio_transport.h"
+#include "transport/unix_transport.h"
 #include <asio/io_context.hpp>
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <vector>
 
 
 namespace mcp::core {
 
+    class Engine;
+
     class MCPserver {
     public:
         class Builder;
@@ -28,29 +34,56 @@ namespace mcp::core {
         void start();
 
         void run();
+
+        /**
+         * @brief Stop gracefully. The listeners close; responses from then on close their connection,
+         * and requests being handled finish. Open streams are ended, spread over DrainOptions::stream_spread.
+         * After DrainOptions::timeout at the latest, the stream cache is written out and the transports
+         * and IO pools stop, so run() returns. Call from a thread that does not run the server.
+         */
+        void drain();
+        ~MCPserver();
         McpDispatcher &get_dispatcher() { return *dispatcher_; }
         asio::io_context &get_io_context();
 
     private:
         MCPserver() = default;
         friend class Builder;
+        friend class Engine;
 
         bool start_http_transport(uint16_t port, const std::string &address);
         bool start_https_transport(uint16_t port, const std::string &address,
                                    const std::string &cert_file, const std::string &private_key_file, const std::string &dh_params_file);
         bool start_stdio_transport();
+        bool start_unix_transport(const std::string &path, const mcp::transport::UnixSocketAuth &peer_auth);
+
+        /**
+         * @brief Load the plugins, register their tools and start federation, then mark the server ready.
+         */
+        void load_tools();
         std::shared_ptr<business::ToolRegistry> registry_;
         std::shared_ptr<resources::ResourceManager> resource_manager_;
         std::shared_ptr<prompts::PromptManager> prompt_manager_;
         std::unique_ptr<McpDispatcher> dispatcher_;
         std::unique_ptr<mcp::transport::HttpTransport> http_transport_;
         std::unique_ptr<mcp::transport::HttpsTransport> https_transport_;
-        mcp::transport::StdioTransport stdio_transport_;
+        std::unique_ptr<mcp::transport::UnixTransport> unix_transport_;
         std::unique_ptr<business::RequestHandler> request_handler_;
+        std::unique_ptr<mcp::transport::StdioTransport> stdio_transport_;// After request_handler_: closed before it goes away
         std::shared_ptr<business::PluginManager> plugin_manager_;
+        std::shared_ptr<business::Federation> federation_;// Tools of upstream MCP servers, nullptr if none are configured
 
         // Used to record configuration
         bool should_register_echo_tool_ = false;
+        bool validate_tool_arguments_ = true;  // Check tools/call arguments against the tool schema
+        bool reuse_port_ = false;              // One SO_REUSEPORT acceptor per pool io_context
+        bool shared_nothing_ = false;          // Per-thread tool registry snapshots, implies reuse_port_
+        bool lazy_plugin_loading_ = false;     // Load manifest-listed plugins on first call
+        size_t plugin_idle_unload_seconds_ = 0;// 0 = lazily loaded plugins stay loaded
+        std::string plugin_isolation_;         // Comma-separated plugins run in a child process, "*" = all
+        size_t plugin_host_channels_ = 2;      // Concurrent calls per isolated plugin
+        size_t plugin_host_buffer_kb_ = 256;   // Shared memory per call channel of an isolated plugin
+        bool background_tool_loading_ = true;  // Load tools while the listeners already accept
 
         std::vector<std::string> plugin_paths_;
         std::vector<std::string> plugin_directories_;
@@ -58,6 +91,8 @@ namespace mcp::core {
 
         asio::io_context io_context_;
         std::shared_ptr<AuthManagerBase> auth_manager_;// Authentication manager
+        std::atomic<bool> stopped_{false};            // Set by drain(), ends run()
+        std::thread tool_loader_;                     // Runs load_tools() with background tool loading
     };
 
     class MCPserver::Builder {
@@ -89,17 +124,60 @@ namespace mcp::core {
             enable_stdio_transport_ = enable;
             return *this;
         }
+        Builder &with_unix_socket(const std::string &path, mcp::transport::UnixSocketAuth peer_auth = {}) {
+            unix_socket_path_ = path;
+            unix_socket_auth_ = std::move(peer_auth);
+            return *this;
+        }
+        Builder &with_reuse_port(bool enable = true) {
+            server_->reuse_port_ = enable;
+            return *this;
+        }
+        Builder &with_shared_nothing(bool enable = true) {
+            server_->shared_nothing_ = enable;
+            if (enable) {
+                server_->reuse_port_ = true;
+            }
+            return *this;
+        }
+        Builder &with_argument_validation(bool enable = true) {
+            server_->validate_tool_arguments_ = enable;
+            return *this;
+        }
+        Builder &with_lazy_plugin_loading(bool enable = true, size_t idle_unload_seconds = 0) {
+            server_->lazy_plugin_loading_ = enable;
+            server_->plugin_idle_unload_seconds_ = idle_unload_seconds;
+            return *this;
+        }
+        Builder &with_plugin_isolation(std::string plugins, size_t channels = 2, size_t buffer_kb = 256) {
+            server_->plugin_isolation_ = std::move(plugins);
+            server_->plugin_host_channels_ = channels;
+            server_->plugin_host_buffer_kb_ = buffer_kb;
+            return *this;
+        }
+        Builder &with_background_tool_loading(bool enable = true) {
+            server_->background_tool_loading_ = enable;
+            return *this;
+        }
         Builder &with_auth_manager(std::shared_ptr<AuthManagerBase> auth_manager) {
             auth_manager_ = auth_manager;
             return *this;
         }
         std::unique_ptr<MCPserver> build();
 
+        /**
+         * @brief Build a server without transports and wrap it in an Engine, which takes requests
+         *        from the embedding process. Transports enabled on this builder are ignored.
+         * @param threads Threads of the engine's io_context, which runs the callback calls
+         */
+        std::unique_ptr<Engine> build_engine(size_t threads = 1);
+
     private:
         std::unique_ptr<MCPserver> server_ = nullptr;
         bool enable_http_transport_ = false;
         bool enable_https_transport_ = false;
         bool enable_stdio_transport_ = false;
+        bool embedded_ = false;// Built for an Engine, no transports expected
 
         std::string address_ = "0.0.0.0";
         unsigned short port_ = 6666;
@@ -107,6 +185,8 @@ namespace mcp::core {
         std::string cert_file_ = "server.crt";
         std::string private_key_file_ = "server.key";
         std::string dh_params_file_ = "dh2048.pem";
+        std::string unix_socket_path_;// Empty = no Unix socket listener
+        mcp::transport::UnixSocketAuth unix_socket_auth_;
         std::shared_ptr<AuthManagerBase> auth_manager_ = nullptr;// Authentication manager
     };
 
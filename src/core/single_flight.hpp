@@ -0,0 +1,136 @@
+#pragma once
+#include <asio.hpp>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::core {
+
+    /**
+     * @brief Deduplicates concurrent work by key: while one caller (the leader) produces the
+     *        result for a key, later callers with the same key wait for it instead of
+     *        producing it again, and all of them get the leader's result or exception.
+     *
+     * Waiting does not block a thread. Nothing is kept once the leader is done, callers
+     * wanting a cache put one in front.
+     */
+    template<typename Result>
+    class SingleFlight {
+    public:
+        /// Called once by the leader; the awaitable it returns must not refer to the callable itself
+        using Producer = std::function<asio::awaitable<Result>()>;
+
+        /**
+         * @brief Produce the result for a key, or wait for the call already producing it.
+         * @param key Identity of the work
+         * @param produce Produces the result if no call for the key is in flight
+         * @param shared Set to true if the result came from another call, may be nullptr
+         * @return Result of the leader
+         * @throws Whatever the leader's produce() threw
+         */
+        asio::awaitable<Result> run(std::string key, Producer produce, bool *shared = nullptr) {
+            auto executor = co_await asio::this_coro::executor;
+            std::shared_ptr<Flight> flight;
+            bool leader = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto &entry = flights_[key];
+                if (!entry) {
+                    entry = std::make_shared<Flight>(executor);
+                    leader = true;
+                }
+                flight = entry;
+            }
+            if (shared) {
+                *shared = !leader;
+            }
+
+            if (!leader) {
+                co_await asio::co_spawn(flight->strand, wait(flight), asio::use_awaitable);
+                std::lock_guard<std::mutex> lock(flight->mutex);
+                if (flight->error) {
+                    std::rethrow_exception(flight->error);
+                }
+                co_return *flight->result;
+            }
+
+            std::optional<Result> result;
+            std::exception_ptr error;
+            try {
+                result.emplace(co_await produce());
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flights_.erase(key);
+            }
+            {
+                std::lock_guard<std::mutex> lock(flight->mutex);
+                flight->result = result;
+                flight->error = error;
+                flight->done = true;
+            }
+            // Waiters registered before done was set; later ones see done and do not wait
+            asio::post(flight->strand, [flight]() {
+                std::lock_guard<std::mutex> lock(flight->mutex);
+                for (auto *timer: flight->waiters) {
+                    timer->cancel();
+                }
+                flight->waiters.clear();
+            });
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            co_return std::move(*result);
+        }
+
+        /**
+         * @brief Number of keys with a call in flight.
+         */
+        std::size_t in_flight() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return flights_.size();
+        }
+
+    private:
+        struct Flight {
+            explicit Flight(asio::any_io_executor executor) : strand(asio::make_strand(std::move(executor))) {}
+
+            asio::strand<asio::any_io_executor> strand;///< Runs every waiter timer operation
+            std::mutex mutex;                          ///< Guards the members below
+            bool done = false;
+            std::optional<Result> result;
+            std::exception_ptr error;
+            std::vector<asio::steady_timer *> waiters;///< Cancelled on the strand when done
+        };
+
+        /**
+         * @brief Wait until the leader is done. Runs on the flight's strand, so the
+         *        leader's cancel cannot race the wait.
+         */
+        static asio::awaitable<void> wait(std::shared_ptr<Flight> flight) {
+            asio::steady_timer timer(flight->strand, asio::steady_timer::time_point::max());
+            {
+                std::lock_guard<std::mutex> lock(flight->mutex);
+                if (flight->done) {
+                    co_return;
+                }
+                flight->waiters.push_back(&timer);
+            }
+            asio::error_code ec;
+            co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+
+        mutable std::mutex mutex_;                                        ///< Guards flights_
+        std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;///< Key -> call in progress
+    };
+
+}// namespace mcp::core
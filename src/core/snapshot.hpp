@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace mcp::core {
+
+    /**
+     * @brief Immutable, versioned value behind an atomic pointer, for settings read on hot paths
+     *        and replaced while the server runs.
+     *
+     * get() is a single acquire load and never blocks. publish() stores a new version and frees
+     * the versions replaced more than a grace period (one second by default) earlier, so a
+     * reference from get() stays valid for at least that long after it stops being current.
+     * Readers must therefore not keep it across a suspension point or a blocking call; copy out
+     * what has to live longer. Republishing as often as one likes keeps only the versions of
+     * the last grace period.
+     */
+    template<typename T>
+    class Snapshot {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit Snapshot(T initial = T{}, Clock::duration grace = std::chrono::seconds(1)) : grace_(grace) {
+            publish(std::move(initial));
+        }
+
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        /**
+         * @brief The current version.
+         */
+        const T &get() const noexcept { return *current_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Number of versions published, the initial value included.
+         */
+        uint64_t version() const noexcept { return version_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Make a new version current. Readers see either the old or the new one whole.
+         */
+        void publish(T value) {
+            auto next = std::make_unique<const T>(std::move(value));
+            auto now = Clock::now();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (owner_) {
+                retired_.push_back({std::move(owner_), now});
+            }
+            owner_ = std::move(next);
+            current_.store(owner_.get(), std::memory_order_release);
+            version_.fetch_add(1, std::memory_order_acq_rel);
+            while (!retired_.empty() && now - retired_.front().since >= grace_) {
+                retired_.pop_front();
+            }
+        }
+
+    private:
+        struct Retired {
+            std::unique_ptr<const T> value;
+            Clock::time_point since;///< When it stopped being current
+        };
+
+        std::atomic<const T *> current_{nullptr};
+        std::atomic<uint64_t> version_{0};
+        const Clock::duration grace_;
+        std::mutex mutex_;              ///< Serializes publishers only
+        std::unique_ptr<const T> owner_;///< The current version
+        std::deque<Retired> retired_;   ///< Replaced versions still in their grace period, oldest first
+    };
+
+}// namespace mcp::core
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace mcp::core {
+
+    /**
+     * @brief Bounded lock-free queue for one producer and one consumer.
+     *
+     * The producer and the consumer may each move between threads, as long as the
+     * hand-over is synchronized (e.g. through an executor post) and no two threads
+     * push, or pop, at the same time.
+     */
+    template<typename T>
+    class SpscQueue {
+    public:
+        /**
+         * @param capacity Minimum number of elements, rounded up to a power of two
+         */
+        explicit SpscQueue(std::size_t capacity)
+            : slots_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity)),
+              mask_(slots_.size() - 1) {}
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        /**
+         * @brief Append an element. Producer only.
+         * @param value Element, moved from on success
+         * @return false if the queue is full
+         */
+        bool try_push(T &&value) {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+                return false;
+            }
+            slots_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Take the oldest element. Consumer only.
+         * @param value Set to the element on success
+         * @return false if the queue is empty
+         */
+        bool try_pop(T &value) {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = std::move(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+        bool full() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire) == slots_.size(); }
+        std::size_t capacity() const { return slots_.size(); }
+
+    private:
+        std::vector<T> slots_;
+        std::size_t mask_;
+        alignas(64) std::atomic<std::size_t> head_{0};///< Next slot to pop, written by the consumer
+        alignas(64) std::atomic<std::size_t> tail_{0};///< Next slot to push, written by the producer
+    };
+
+}// namespace mcp::core
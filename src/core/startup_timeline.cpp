@@ -0,0 +1,64 @@
+#include "startup_timeline.h"
+#include "logger.h"
+#include <algorithm>
+
+namespace mcp::core {
+
+    namespace {
+        // Static initialization runs before main(), close enough to the start of the process
+        const auto process_start = std::chrono::steady_clock::now();
+
+        std::chrono::milliseconds since_start(std::chrono::steady_clock::time_point point) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(point - process_start);
+        }
+    }// namespace
+
+    StartupTimeline::Phase::~Phase() {
+        StartupTimeline::instance().record(std::move(name_), start_, std::chrono::steady_clock::now());
+    }
+
+    StartupTimeline &StartupTimeline::instance() {
+        static StartupTimeline timeline;
+        return timeline;
+    }
+
+    void StartupTimeline::record(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        std::lock_guard lock(mutex_);
+        records_.push_back({std::move(name), since_start(start), std::chrono::duration_cast<std::chrono::milliseconds>(end - start)});
+    }
+
+    void StartupTimeline::set_ready() {
+        if (ready_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        MCP_INFO("Ready for tool calls {} ms after start", uptime().count());
+        if (!log_timeline_) {
+            return;
+        }
+
+        std::vector<Record> records;
+        {
+            std::lock_guard lock(mutex_);
+            records = records_;
+        }
+        std::stable_sort(records.begin(), records.end(), [](const Record &a, const Record &b) { return a.start < b.start; });
+        MCP_INFO("Startup timeline (start, duration):");
+        for (const auto &record: records) {
+            MCP_INFO("  {:>6} ms {:>6} ms  {}", record.start.count(), record.duration.count(), record.name);
+        }
+    }
+
+    std::chrono::milliseconds StartupTimeline::uptime() const {
+        return since_start(std::chrono::steady_clock::now());
+    }
+
+    nlohmann::json StartupTimeline::to_json() const {
+        nlohmann::json phases = nlohmann::json::array();
+        std::lock_guard lock(mutex_);
+        for (const auto &record: records_) {
+            phases.push_back({{"phase", record.name}, {"start_ms", record.start.count()}, {"duration_ms", record.duration.count()}});
+        }
+        return phases;
+    }
+
+}// namespace mcp::core
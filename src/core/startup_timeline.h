@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace mcp::core {
+
+    /**
+     * @brief How long each startup phase took, and whether the server is ready for tool calls.
+     *
+     * Phases are timed from process start, which is when this translation unit is initialized.
+     * They may run concurrently, e.g. tool loading in the background while the listeners already
+     * accept. The server is ready once its tools are registered; the readiness probe of the HTTP
+     * transports answers 503 until then.
+     */
+    class StartupTimeline {
+    public:
+        /**
+         * @brief Times a phase from construction to destruction.
+         */
+        class Phase {
+        public:
+            Phase(Phase &&) = delete;
+            ~Phase();
+
+        private:
+            friend class StartupTimeline;
+            explicit Phase(std::string name) : name_(std::move(name)), start_(std::chrono::steady_clock::now()) {}
+
+            std::string name_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+        static StartupTimeline &instance();
+
+        /**
+         * @brief Time a phase for as long as the returned object lives.
+         * @param name Phase name, e.g. "plugins"
+         */
+        [[nodiscard]] Phase phase(std::string name) { return Phase(std::move(name)); }
+
+        /**
+         * @brief Mark the server ready and log how long startup took, per phase if the timeline is on.
+         */
+        void set_ready();
+
+        /**
+         * @brief Whether the tools are registered. Lock free.
+         */
+        bool ready() const noexcept { return ready_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Log every phase with its start and duration when set_ready() is called.
+         * @param enabled Log the timeline; otherwise only the time to readiness is logged
+         */
+        void set_logging(bool enabled) { log_timeline_ = enabled; }
+
+        /**
+         * @brief Time since process start.
+         */
+        std::chrono::milliseconds uptime() const;
+
+        /**
+         * @brief Phases recorded so far, as [{"phase", "start_ms", "duration_ms"}].
+         */
+        nlohmann::json to_json() const;
+
+    private:
+        struct Record {
+            std::string name;
+            std::chrono::milliseconds start;
+            std::chrono::milliseconds duration;
+        };
+
+        StartupTimeline() = default;
+
+        void record(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+        std::atomic<bool> ready_{false};
+        bool log_timeline_ = false;
+        mutable std::mutex mutex_;
+        std::vector<Record> records_;///< In order of completion; mutex_
+    };
+
+}// namespace mcp::core
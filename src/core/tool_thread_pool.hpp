@@ -0,0 +1,436 @@
+#pragma once
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace mcp::core {
+
+    /**
+     * @brief Settings for the ToolThreadPool, normally taken from the [concurrency] section.
+     */
+    struct ToolThreadPoolOptions {
+        std::size_t threads = 0;             ///< Worker threads, 0 = hardware concurrency
+        std::size_t control_threads = 1;     ///< Workers reserved for control-plane calls, 0 = none
+        std::string thread_name = "mcp-tool";///< Thread name prefix, the thread index is appended
+        std::size_t max_threads = 0;         ///< Workers the pool may grow to while they block, 0 or threads = fixed size
+        double blocked_ratio = 0.5;          ///< CPU time over wall time below which busy workers count as blocked
+        std::chrono::milliseconds adapt_interval{250};///< How often the pool size is reconsidered
+        unsigned shrink_after = 20;          ///< Intervals without a backlog before one extra worker retires
+    };
+
+    /**
+     * @brief Pool size and resize counts of the ToolThreadPool, for metrics.
+     */
+    struct ToolThreadPoolStats {
+        std::size_t threads = 0;    ///< Workers now, not counting the control-plane ones
+        std::size_t min_threads = 0;///< Workers the pool never shrinks below
+        std::size_t max_threads = 0;///< Workers the pool never grows beyond
+        uint64_t grown = 0;         ///< Workers added because the others were blocked
+        uint64_t shrunk = 0;        ///< Workers retired once the backlog was gone
+        double cpu_ratio = 0;       ///< CPU time over wall time of the workers in the last interval
+    };
+
+    /**
+     * @brief Thread pool that runs blocking tool calls away from the io threads.
+     *
+     * All workers run one shared io_context, so every queued call is picked up by the next
+     * idle worker: a slow call never holds up calls queued behind it while other workers are
+     * free. Sessions co_spawn work onto executor() and are resumed on their own executor
+     * when it finishes.
+     *
+     * Control-plane calls (see transport::PriorityOptions) go to control_executor() instead,
+     * a second io_context with a few workers of its own, so they are picked up at once however
+     * many tool calls are queued on the shared one.
+     *
+     * With max_threads above threads the pool compensates for workers that block, the way a
+     * ForkJoin pool's managed blocker does. Every adapt_interval a monitor thread reads the CPU
+     * clocks of the workers and checks how long a probe posted to the shared io_context waited.
+     * Calls waiting while the workers used less than blocked_ratio of their wall time on the CPU
+     * means they sit in I/O or sleeps (http_plugin, safe_system_plugin), so a worker is added for
+     * about every other blocked one, up to max_threads. Workers busy on the CPU get no company,
+     * nor do workers that only look blocked because the pool already keeps the machine's cores
+     * busy: more threads would only share the same cores. After shrink_after intervals without a
+     * backlog one extra worker retires, until the pool is back at threads.
+     */
+    class ToolThreadPool {
+    public:
+        ~ToolThreadPool() { stop(); }
+        ToolThreadPool(const ToolThreadPool &) = delete;
+        ToolThreadPool &operator=(const ToolThreadPool &) = delete;
+
+        /**
+         * @brief Set the pool options. Must be called before the first instance().
+         * @param options Pool options
+         */
+        static void configure(ToolThreadPoolOptions options) {
+            pending_options() = std::move(options);
+        }
+
+        /**
+         * @brief Get the process-wide pool, starting it on first use.
+         * @return Tool thread pool
+         */
+        static ToolThreadPool &instance() {
+            static ToolThreadPool pool(pending_options());
+            return pool;
+        }
+
+        /**
+         * @brief Executor to run tool calls on.
+         * @return Pool executor
+         */
+        asio::io_context::executor_type executor() { return context_.get_executor(); }
+
+        /**
+         * @brief Executor to run control-plane calls on; the shared one if none are reserved.
+         * @return Reserved executor
+         */
+        asio::io_context::executor_type control_executor() {
+            return control_work_ ? control_context_.get_executor() : context_.get_executor();
+        }
+
+        /**
+         * @brief Number of worker threads.
+         * @return Thread count
+         */
+        std::size_t size() const { return live_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Number of worker threads the pool may grow to.
+         * @return Thread count, size() for a fixed pool
+         */
+        std::size_t max_size() const { return max_count_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Change the pool size while it runs, e.g. from the admin endpoint.
+         * Workers missing below the new size start at once; workers beyond the new maximum retire
+         * once they finish the call they are running, so no call is cut short.
+         * @param threads Workers the pool never shrinks below, 0 = hardware concurrency
+         * @param max_threads Workers it may grow to while they block, 0 or threads = fixed size
+         */
+        void resize(std::size_t threads, std::size_t max_threads) {
+            ToolThreadPoolOptions sizes = options_;
+            sizes.threads = threads;
+            std::size_t min_count = thread_count(sizes);
+            std::size_t max_count = std::max(min_count, max_threads);
+
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            // Join the workers that retired, the monitor does it if there is one
+            for (auto it = workers_.begin(); it != workers_.end();) {
+                if (!monitor_.joinable() && it->done.load(std::memory_order_acquire)) {
+                    it->thread.join();
+                    it = workers_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            min_count_.store(min_count, std::memory_order_relaxed);
+            max_count_.store(max_count, std::memory_order_relaxed);
+            counters_storage().min_threads.store(min_count, std::memory_order_relaxed);
+            counters_storage().max_threads.store(max_count, std::memory_order_relaxed);
+
+            std::size_t staying = live_.load(std::memory_order_relaxed) - retiring_.load(std::memory_order_relaxed);
+            for (; staying < min_count; ++staying) {
+                spawn();
+            }
+            if (staying > max_count) {
+                // Whichever workers finish a handler next retire; wake idle ones in case none is busy
+                std::size_t retire = staying - max_count;
+                retiring_.fetch_add(retire, std::memory_order_relaxed);
+                for (std::size_t i = 0; i < retire; ++i) {
+                    asio::post(context_, []() {});
+                }
+            }
+            if (max_count > min_count && !monitor_.joinable()) {
+                monitor_ = std::thread([this]() {
+                    AsioIOServicePool::SetupCurrentThread(options_.thread_name + "-mon", -1);
+                    monitor();
+                });
+            }
+            MCP_INFO("Tool thread pool '{}' resized to {} threads, up to {} while they block", options_.thread_name, min_count, max_count);
+        }
+
+        /**
+         * @brief Pool size and resizes so far, zeros until the pool is started.
+         * Does not start the pool, so metrics can be read before the first tool call.
+         * @return Pool statistics
+         */
+        static ToolThreadPoolStats stats() {
+            ToolThreadPoolStats result;
+            const Counters &counters = counters_storage();
+            result.threads = counters.threads.load(std::memory_order_relaxed);
+            result.min_threads = counters.min_threads.load(std::memory_order_relaxed);
+            result.max_threads = counters.max_threads.load(std::memory_order_relaxed);
+            result.grown = counters.grown.load(std::memory_order_relaxed);
+            result.shrunk = counters.shrunk.load(std::memory_order_relaxed);
+            result.cpu_ratio = static_cast<double>(counters.cpu_permille.load(std::memory_order_relaxed)) / 1000.0;
+            return result;
+        }
+
+        /**
+         * @brief Stop accepting work and join the workers.
+         */
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(monitor_mutex_);
+                stopping_ = true;
+            }
+            monitor_cv_.notify_all();
+            if (monitor_.joinable() && monitor_.get_id() != std::this_thread::get_id()) {
+                monitor_.join();
+            }
+            work_.reset();
+            control_work_.reset();
+            context_.stop();
+            control_context_.stop();
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            for (auto &worker: workers_) {
+                if (worker.thread.joinable() && worker.thread.get_id() != std::this_thread::get_id()) {
+                    worker.thread.join();
+                }
+            }
+            for (auto &thread: control_threads_) {
+                if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+                    thread.join();
+                }
+            }
+        }
+
+    private:
+        struct Worker {
+            std::thread thread;
+            std::atomic<bool> done{false};
+            int64_t cpu_ns = 0;///< CPU clock at the last monitor pass
+        };
+
+        // Process-wide so stats() can be read without starting the pool
+        struct Counters {
+            std::atomic<std::size_t> threads{0};
+            std::atomic<std::size_t> min_threads{0};
+            std::atomic<std::size_t> max_threads{0};
+            std::atomic<uint64_t> grown{0};
+            std::atomic<uint64_t> shrunk{0};
+            std::atomic<uint64_t> cpu_permille{0};
+        };
+
+        explicit ToolThreadPool(const ToolThreadPoolOptions &options)
+            : context_(static_cast<int>(std::max(thread_count(options), options.max_threads))),
+              control_context_(static_cast<int>(std::max<std::size_t>(1, options.control_threads))),
+              work_(std::make_unique<AsioIOServicePool::Work>(asio::make_work_guard(context_))),
+              options_(options),
+              min_count_(thread_count(options)),
+              max_count_(std::max(thread_count(options), options.max_threads)),
+              control_count_(options.control_threads) {
+            {
+                std::lock_guard<std::mutex> lock(workers_mutex_);
+                for (std::size_t i = 0; i < min_count_; ++i) {
+                    spawn();
+                }
+            }
+            if (control_count_ > 0) {
+                control_work_ = std::make_unique<AsioIOServicePool::Work>(asio::make_work_guard(control_context_));
+                control_threads_.reserve(control_count_);
+                for (std::size_t i = 0; i < control_count_; ++i) {
+                    control_threads_.emplace_back([this, name = options.thread_name + "-ctl-" + std::to_string(i)]() {
+                        AsioIOServicePool::SetupCurrentThread(name, -1);
+                        control_context_.run();
+                    });
+                }
+            }
+            Counters &counters = counters_storage();
+            counters.min_threads.store(min_count_, std::memory_order_relaxed);
+            counters.max_threads.store(max_count_, std::memory_order_relaxed);
+            if (max_count_ > min_count_) {
+                monitor_ = std::thread([this]() {
+                    AsioIOServicePool::SetupCurrentThread(options_.thread_name + "-mon", -1);
+                    monitor();
+                });
+                MCP_INFO("Started tool thread pool '{}' with {} threads, up to {} while they block ({} reserved for the control plane)",
+                         options.thread_name, min_count_.load(), max_count_.load(), control_count_);
+            } else {
+                MCP_INFO("Started tool thread pool '{}' with {} threads ({} reserved for the control plane)",
+                         options.thread_name, min_count_.load(), control_count_);
+            }
+        }
+
+        /**
+         * @brief Start one more worker on the shared io_context. Call with workers_mutex_ held.
+         */
+        void spawn() {
+            Worker &worker = workers_.emplace_back();
+            worker.thread = std::thread([this, &worker, name = options_.thread_name + "-" + std::to_string(next_index_++)]() {
+                AsioIOServicePool::SetupCurrentThread(name, -1);
+                // One handler at a time, so a worker can be asked to retire between two calls
+                while (context_.run_one() > 0) {
+                    std::size_t retiring = retiring_.load(std::memory_order_relaxed);
+                    if (retiring > 0 && retiring_.compare_exchange_strong(retiring, retiring - 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                live_.fetch_sub(1, std::memory_order_relaxed);
+                counters_storage().threads.fetch_sub(1, std::memory_order_relaxed);
+                worker.done.store(true, std::memory_order_release);
+            });
+            worker.cpu_ns = cpu_time(worker.thread);
+            live_.fetch_add(1, std::memory_order_relaxed);
+            counters_storage().threads.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Grow and shrink the pool every adapt_interval until stop().
+         */
+        void monitor() {
+            auto probe_ran = std::make_shared<std::atomic<bool>>(true);
+            auto probe_posted = std::chrono::steady_clock::now();
+            auto probe_lag = std::chrono::steady_clock::duration::zero();
+            auto probe_waited = std::make_shared<std::atomic<int64_t>>(0);
+            auto last = std::chrono::steady_clock::now();
+            unsigned quiet = 0;
+
+            std::unique_lock<std::mutex> monitor_lock(monitor_mutex_);
+            while (!monitor_cv_.wait_for(monitor_lock, options_.adapt_interval, [this]() { return stopping_; })) {
+                auto now = std::chrono::steady_clock::now();
+                auto wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+                last = now;
+
+                // A probe still queued from the last pass, or one that waited long, means calls are waiting for a worker
+                if (probe_ran->load(std::memory_order_acquire)) {
+                    probe_lag = std::chrono::nanoseconds(probe_waited->load(std::memory_order_relaxed));
+                } else {
+                    probe_lag = now - probe_posted;
+                }
+                bool backlog = probe_lag > options_.adapt_interval / 10;
+
+                std::lock_guard<std::mutex> lock(workers_mutex_);
+                // Join the workers that retired since the last pass
+                for (auto it = workers_.begin(); it != workers_.end();) {
+                    if (it->done.load(std::memory_order_acquire)) {
+                        it->thread.join();
+                        it = workers_.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+
+                int64_t cpu_ns = 0;
+                for (auto &worker: workers_) {
+                    int64_t now_ns = cpu_time(worker.thread);
+                    cpu_ns += std::max<int64_t>(0, now_ns - worker.cpu_ns);
+                    worker.cpu_ns = now_ns;
+                }
+                std::size_t live = live_.load(std::memory_order_relaxed);
+                double ratio = wall_ns > 0 && live > 0 ? static_cast<double>(cpu_ns) / static_cast<double>(wall_ns * static_cast<int64_t>(live)) : 0.0;
+                counters_storage().cpu_permille.store(static_cast<uint64_t>(std::min(ratio, 1.0) * 1000.0), std::memory_order_relaxed);
+
+                // Threads starved of a core look blocked too; a pool already using the machine's cores is not grown
+                double cores = wall_ns > 0 ? static_cast<double>(cpu_ns) / static_cast<double>(wall_ns) : 0.0;
+                bool cores_free = cores < static_cast<double>(std::max(1u, std::thread::hardware_concurrency())) * options_.blocked_ratio;
+                if (backlog && ratio < options_.blocked_ratio && cores_free && live < max_count_) {
+                    // With calls queued every worker is busy, so the share of time off the CPU is the share blocked
+                    auto blocked = static_cast<std::size_t>(static_cast<double>(live) * (1.0 - ratio));
+                    std::size_t add = std::min(max_count_ - live, std::max<std::size_t>(1, blocked / 2));
+                    for (std::size_t i = 0; i < add; ++i) {
+                        spawn();
+                    }
+                    counters_storage().grown.fetch_add(add, std::memory_order_relaxed);
+                    MCP_DEBUG("Tool pool '{}' grew to {} threads: calls waited {} ms while workers ran {:.0f}% of the time",
+                              options_.thread_name, live + add,
+                              std::chrono::duration_cast<std::chrono::milliseconds>(probe_lag).count(), ratio * 100.0);
+                    quiet = 0;
+                } else if (backlog) {
+                    quiet = 0;
+                } else if (++quiet >= options_.shrink_after && live - retiring_.load(std::memory_order_relaxed) > min_count_) {
+                    // Whichever worker finishes a handler next retires; wake an idle one in case none is busy
+                    retiring_.fetch_add(1, std::memory_order_relaxed);
+                    asio::post(context_, []() {});
+                    counters_storage().shrunk.fetch_add(1, std::memory_order_relaxed);
+                    MCP_DEBUG("Tool pool '{}' shrinks to {} threads", options_.thread_name, live - 1);
+                    quiet = 0;
+                }
+
+                if (probe_ran->load(std::memory_order_acquire)) {
+                    probe_ran->store(false, std::memory_order_relaxed);
+                    probe_posted = std::chrono::steady_clock::now();
+                    asio::post(context_, [probe_ran, probe_waited, posted = probe_posted]() {
+                        probe_waited->store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - posted).count(),
+                                            std::memory_order_relaxed);
+                        probe_ran->store(true, std::memory_order_release);
+                    });
+                }
+            }
+        }
+
+        /**
+         * @brief CPU time a thread has used so far, 0 where it cannot be read.
+         */
+        static int64_t cpu_time(std::thread &thread) {
+#if defined(_WIN32)
+            FILETIME created, exited, kernel, user;
+            if (!GetThreadTimes(static_cast<HANDLE>(thread.native_handle()), &created, &exited, &kernel, &user)) {
+                return 0;
+            }
+            auto ticks = [](const FILETIME &time) {
+                return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            return (ticks(kernel) + ticks(user)) * 100;
+#else
+            clockid_t clock;
+            timespec ts{};
+            if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0 || clock_gettime(clock, &ts) != 0) {
+                return 0;
+            }
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+        }
+
+        static std::size_t thread_count(const ToolThreadPoolOptions &options) {
+            return options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        static ToolThreadPoolOptions &pending_options() {
+            static ToolThreadPoolOptions options;
+            return options;
+        }
+
+        static Counters &counters_storage() {
+            static Counters counters;
+            return counters;
+        }
+
+        asio::io_context context_;
+        asio::io_context control_context_;
+        AsioIOServicePool::WorkPtr work_;
+        AsioIOServicePool::WorkPtr control_work_;
+        ToolThreadPoolOptions options_;
+        std::atomic<std::size_t> min_count_{0};///< Changed by resize(), under workers_mutex_
+        std::atomic<std::size_t> max_count_{0};
+        std::size_t control_count_ = 0;
+        std::size_t next_index_ = 0;
+        std::atomic<std::size_t> live_{0};
+        std::atomic<std::size_t> retiring_{0};///< Workers asked to retire that have not stopped yet
+        std::mutex workers_mutex_;
+        std::list<Worker> workers_;           ///< A list, so a worker's entry stays put while others come and go
+        std::vector<std::thread> control_threads_;
+        std::mutex monitor_mutex_;
+        std::condition_variable monitor_cv_;
+        bool stopping_ = false;
+        std::thread monitor_;
+    };
+
+}// namespace mcp::core
@@ -1,43 +1,118 @@
 #include "Auth/AuthManager.hpp"
+#include "Auth/AuthManagerJwt.hpp"
+#include "Prompts/prompt.h"
+#include "Resources/subscription_hub.h"
+#include "business/federation.h"
+#include "business/plugin_host.h"
+#include "business/plugin_usage.h"
+#include "business/progress.h"
 #include "business/python_runtime_manager.h"
+#include "business/runtime_settings.h"
+#include "business/stream_pump.h"
+#include "business/tool_batcher.h"
+#include "business/tool_deadline.h"
+#include "business/tool_list_changed.h"
+#include "business/tool_output.h"
+#include "business/idempotency_cache.h"
+#include "business/tool_result_cache.h"
 #include "config/config.hpp"// Configuration management using INI file
 #include "config/config_observer.hpp"
+#include "core/io_context_pool.hpp"
 #include "core/logger.h"
+#include "core/paged_list.h"
 #include "core/server.h"
+#include "core/startup_timeline.h"
+#include "core/tool_thread_pool.hpp"
+#include "metrics/access_log.h"
+#include "metrics/audit_log.h"
 #include "metrics/metrics_manager.h"
+#include "metrics/metrics_push.h"
 #include "metrics/performance_metrics.h"
 #include "metrics/rate_limiter.h"
+#include "metrics/request_trace.h"
+#include "metrics/tracing.h"
+#include "protocol/json_rpc.h"
+#include "routers/resources_read.hpp"
+#include "transport/admission_controller.h"
+#include "transport/fair_scheduler.h"
+#include "transport/cluster.h"
+#include "transport/cluster_quota.h"
+#include "transport/connection_timeouts.h"
+#include "transport/drain.h"
+#include "transport/hot_restart.h"
+#include "transport/http2_connection.h"
+#include "transport/http_compression.h"
+#include "transport/http_handler.h"
+#include "transport/memfd_handoff.h"
+#include "transport/page_memory.h"
+#include "transport/segment_log_backend.h"
+#include "transport/socket_options.h"
+#include "transport/sse_send_queue.h"
+#include "transport/stdio_transport.h"
+#include "transport/tenants.h"
+#include "transport/tls_options.h"
+#include "transport/traffic_capture.h"
+#include "transport/unix_transport.h"
+#include "transport/upload_stream.h"
+#include "transport/websocket.h"
 #include "utils/auth_utils.h"
+#include <algorithm>
 #include <asio/io_context.hpp>
 #include <asio/signal_set.hpp>
 #include <csignal>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <thread>
+#include <tuple>
 
 /**
  * Entry point of the MCP server application.
  * This function initializes the configuration, sets up logging, builds the server instance,
  * and starts the main event loop.
  *
+ * Started with PluginHost::kHostFlag it is the child process of an isolated plugin instead,
+ * see business/plugin_host.h.
+ *
  * @return 0 on successful execution, 1 if an exception occurs.
  */
-int main() {
+int main(int argc, char **argv) {
+    if (argc >= 2 && std::strcmp(argv[1], mcp::business::PluginHost::kHostFlag) == 0) {
+        return mcp::business::PluginHost::run(argc, argv);
+    }
     try {
-        // Step 1: Ensure the default configuration file exists.
-        // If the config file is missing or empty, create one with safe defaults.
-        mcp::config::initialize_config_system(mcp::config::ConfigMode::DYNAMIC);
-
-        // Step 2: Load the full configuration from the INI file.
-        auto config = mcp::config::get_current_config();
-
-        // Step 3: Initialize the asynchronous logger using settings from the config.
-        // Parameters include log file path, log level, maximum file size, and number of rotation files.
-        mcp::core::initializeAsyncLogger(
-                config.server.log_path,
-                config.server.log_level,
-                config.server.max_file_size,
-                config.server.max_files);
+        // Each startup phase is timed, see StartupTimeline
+        auto &timeline = mcp::core::StartupTimeline::instance();
+
+        auto config = [&timeline]() {
+            auto phase = timeline.phase("config");
+            // Step 1: Ensure the default configuration file exists.
+            // If the config file is missing or empty, create one with safe defaults.
+            mcp::config::initialize_config_system(mcp::config::ConfigMode::DYNAMIC);
+
+            // Step 2: Load the full configuration from the INI file.
+            return mcp::config::get_current_config();
+        }();
+        timeline.set_logging(config.server.startup_timeline);
+
+        {
+            auto phase = timeline.phase("logger");
+            // Step 3: Initialize the asynchronous logger using settings from the config.
+            // Parameters include log file path, log level, maximum file size, and number of rotation files.
+            mcp::core::initializeAsyncLogger(
+                    config.server.log_path,
+                    config.server.log_level,
+                    config.server.max_file_size,
+                    config.server.max_files);
+            mcp::core::MCPLogger::set_payload_limit(config.server.log_payload_limit);
+            if (config.server.log_binary) {
+                mcp::core::BinaryLogOptions log_options;
+                log_options.format = mcp::core::BinaryLogOptions::parse_format(config.server.log_format);
+                log_options.overflow = mcp::core::BinaryLogOptions::parse_overflow(config.server.log_overflow);
+                log_options.ring_bytes = config.server.log_ring_bytes;
+                mcp::core::BinaryLog::start(log_options);
+            }
+        }
         MCP_INFO("Starting MCP Server with configuration: {}", mcp::config::get_config_file_path());
 
         // Print configuration
@@ -47,8 +122,14 @@ int main() {
         MCP_INFO("  HTTP Port: {}", config.server.http_port);
         MCP_INFO("  HTTPS Port: {}", config.server.https_port);
         MCP_INFO("  Plugin Directory: {}", config.server.plugin_dir);
+        MCP_INFO("  Plugin Lazy Load: {} (idle unload: {}s)", config.server.plugin_lazy_load, config.server.plugin_idle_unload_s);
         MCP_INFO("  Log Level: {}", config.server.log_level);
         MCP_INFO("  Log Path: {}", config.server.log_path);
+#if defined(ASIO_HAS_IO_URING) && defined(ASIO_DISABLE_EPOLL)
+        MCP_INFO("  I/O Backend: io_uring");
+#else
+        MCP_INFO("  I/O Backend: default (epoll on Linux)");
+#endif
         auto address = config.server.ip;
 
         // Step 4: Set up PythonRuntimeManager with initial config and observer
@@ -61,6 +142,22 @@ int main() {
         MCP_INFO("Python Environment Initialized:");
         MCP_INFO("  Default: {}", config.python_env.default_env);
         MCP_INFO("  UV Venv: {}", config.python_env.uv_venv_path);
+        MCP_INFO("  Interpreters: {}", config.python_env.interpreters);
+
+        MCP_INFO("  Workers: {}", config.python_env.workers);
+
+        // Python plugins are separate libraries with their own runtime manager; where they run
+        // their calls reaches them through the environment
+        mcp::business::PythonExecutionOptions python_execution;
+        python_execution.interpreters = config.python_env.interpreters;
+        python_execution.workers = config.python_env.workers;
+        python_execution.worker_executable = config.python_env.worker_executable;
+        python_execution.worker_buffer_kb = config.python_env.worker_buffer_kb;
+        python_execution.worker_max_calls = config.python_env.worker_max_calls;
+        python_execution.worker_max_rss_mb = config.python_env.worker_max_rss_mb;
+        python_execution.bytecode_cache_dir = config.python_env.bytecode_cache_dir;
+        python_execution.preload_modules = config.python_env.preload_modules;
+        python_execution.export_to_environment();
 
         auto python_observer = std::make_unique<mcp::business::PythonConfigObserver>(python_runtime_manager);
 
@@ -85,12 +182,39 @@ int main() {
 
         // Initialize the rate limiter
         auto rate_limiter = mcp::metrics::RateLimiter::getInstance();
-        mcp::metrics::RateLimitConfig rate_limit_config;
-        rate_limit_config.max_requests_per_second = config.server.max_requests_per_second;
-        rate_limit_config.max_concurrent_requests = config.server.max_concurrent_requests;
-        rate_limit_config.max_request_size = config.server.max_request_size;
-        rate_limit_config.max_response_size = config.server.max_response_size;
-        rate_limiter->set_config(rate_limit_config);
+        auto rate_limits_of = [](const mcp::config::GlobalConfig &config) {
+            mcp::metrics::RateLimitConfig rate_limit_config;
+            rate_limit_config.max_requests_per_second = config.server.max_requests_per_second;
+            rate_limit_config.max_concurrent_requests = config.server.max_concurrent_requests;
+            rate_limit_config.burst = config.server.rate_limit_burst;
+            rate_limit_config.max_request_size = config.server.max_request_size;
+            rate_limit_config.max_response_size = config.server.max_response_size;
+            return rate_limit_config;
+        };
+        rate_limiter->set_config(rate_limits_of(config));
+        if (config.server.shared_nothing) {
+            // One partition of requests in flight per thread that serves connections
+            size_t io_threads = config.server.io_threads != 0 ? config.server.io_threads : std::max(1u, std::thread::hardware_concurrency());
+            rate_limiter->set_partitions(io_threads + config.server.https_io_threads);
+        }
+
+        // Tenants are limited over the whole cluster, on top of the session limit
+        // Credentials grouped into named tenants, before the limits that apply per tenant
+        auto tenants_of = [](const mcp::config::GlobalConfig &config) {
+            mcp::transport::TenantOptions options;
+            options.credentials = mcp::transport::TenantOptions::parse_credentials(config.concurrency.tenants);
+            return options;
+        };
+        mcp::transport::Tenants::instance().configure(tenants_of(config));
+
+        auto cluster_quota_of = [](const mcp::config::GlobalConfig &config) {
+            mcp::transport::ClusterQuotaOptions options;
+            options.requests_per_second = config.server.tenant_requests_per_second;
+            options.burst = config.server.tenant_rate_limit_burst;
+            options.tenant_limits = mcp::transport::TenantOptions::parse_limits(config.server.tenant_rate_limits);
+            return options;
+        };
+        mcp::transport::ClusterQuota::instance().configure(cluster_quota_of(config));
 
         rate_limiter->set_rate_limit_callback([](
                                                       const std::string &session_id,
@@ -108,15 +232,470 @@ int main() {
             }
         });
 
+        // Placement of the buffer pools and cache tables, before anything allocates from them
+        mcp::transport::PageMemoryOptions page_memory_options;
+        page_memory_options.huge_pages = mcp::transport::PageMemoryOptions::parse_huge_pages(config.server.pool_huge_pages);
+        page_memory_options.numa = config.server.pool_numa;
+        mcp::transport::PageMemoryOptions::configure(page_memory_options);
+
+        // Size and pin the IO thread pools before any transport starts using them
+        IOServicePoolOptions io_pool_options;
+        io_pool_options.threads = config.server.io_threads;
+        io_pool_options.thread_name = config.server.io_thread_name;
+        io_pool_options.cpus = AsioIOServicePool::ParseCpuList(config.server.io_cpu_affinity);
+        if (config.server.shared_nothing && io_pool_options.cpus.empty()) {
+            // Shared-nothing: each IO thread keeps its connections on a core of its own
+            for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+                io_pool_options.cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        io_pool_options.lag_probe_interval = std::chrono::milliseconds(config.server.io_lag_probe_ms);
+        io_pool_options.busy_poll = std::chrono::microseconds(config.server.io_busy_poll_us);
+        AsioIOServicePool::Configure(std::move(io_pool_options));
+
+        IOServicePoolOptions https_pool_options;
+        https_pool_options.threads = config.server.https_io_threads;
+        https_pool_options.thread_name = "mcp-tls";
+        https_pool_options.cpus = AsioIOServicePool::ParseCpuList(config.server.https_io_cpu_affinity);
+        https_pool_options.lag_probe_interval = std::chrono::milliseconds(config.server.io_lag_probe_ms);
+        https_pool_options.busy_poll = std::chrono::microseconds(config.server.io_busy_poll_us);
+        AsioIOServicePool::ConfigureTls(std::move(https_pool_options));
+
+        IOServicePoolOptions handshake_pool_options;
+        handshake_pool_options.threads = config.server.https_handshake_threads;
+        handshake_pool_options.thread_name = "mcp-tls-hs";
+        handshake_pool_options.lag_probe_interval = std::chrono::milliseconds(config.server.io_lag_probe_ms);
+        AsioIOServicePool::ConfigureHandshake(std::move(handshake_pool_options));
+
+        // TCP tuning for listeners and accepted sockets, read when transports are created
+        mcp::transport::SocketOptions socket_options;
+        socket_options.tcp_nodelay = config.transport.tcp_nodelay;
+        socket_options.tcp_quickack = config.transport.tcp_quickack;
+        socket_options.keep_alive = config.transport.tcp_keepalive;
+        socket_options.send_buffer_size = config.transport.send_buffer_size;
+        socket_options.receive_buffer_size = config.transport.receive_buffer_size;
+        socket_options.listen_backlog = config.transport.listen_backlog;
+        socket_options.tcp_fastopen = config.transport.tcp_fastopen;
+        socket_options.tcp_congestion = config.transport.tcp_congestion;
+        socket_options.tcp_notsent_lowat = config.transport.tcp_notsent_lowat;
+        socket_options.tcp_user_timeout_ms = config.transport.tcp_user_timeout_ms;
+        socket_options.busy_poll_us = static_cast<int>(config.server.io_busy_poll_us);
+        mcp::transport::SocketOptions::configure(socket_options);
+
+        // TLS session resumption, applied when the HTTPS transport builds its context
+        mcp::transport::TlsOptions tls_options;
+        tls_options.session_cache_size = config.server.ssl_session_cache_size;
+        tls_options.session_timeout_s = static_cast<long>(config.server.ssl_session_timeout_s);
+        tls_options.ticket_rotation_s = static_cast<long>(config.server.ssl_ticket_rotation_s);
+        mcp::transport::TlsOptions::configure(tls_options);
+
+        // HTTP/2 through ALPN on the HTTPS listener
+        mcp::transport::Http2Options http2_options;
+        http2_options.enabled = config.server.http2;
+        http2_options.max_concurrent_streams = static_cast<uint32_t>(config.server.http2_max_concurrent_streams);
+        http2_options.initial_window_size = static_cast<uint32_t>(std::min<size_t>(config.server.http2_initial_window_size, 0x7fffffff));
+        mcp::transport::Http2Options::configure(http2_options);
+
+        // WebSocket upgrades on the HTTP and HTTPS listeners
+        mcp::transport::WebSocketOptions websocket_options;
+        websocket_options.enabled = config.server.websocket;
+        websocket_options.max_message_size = config.server.websocket_max_message_size;
+        websocket_options.max_in_flight = config.server.websocket_max_in_flight;
+        mcp::transport::WebSocketOptions::configure(websocket_options);
+
+        // Stdin reads and concurrent handling of stdio messages
+        mcp::transport::StdioOptions stdio_options;
+        stdio_options.read_buffer_size = config.server.stdio_read_buffer_size;
+        stdio_options.max_in_flight = config.server.stdio_max_in_flight;
+        mcp::transport::StdioOptions::configure(stdio_options);
+
+        // Content-Encoding negotiation of responses
+        mcp::transport::CompressionOptions compression_options;
+        compression_options.enabled = config.server.compression;
+        compression_options.min_size = config.server.compression_min_size;
+        compression_options.level = config.server.compression_level;
+        compression_options.offload_size = config.server.compression_offload_size;
+        compression_options.streaming = config.server.compression_streaming;
+        compression_options.decode_requests = config.server.request_decompression;
+        compression_options.max_decoded_size = config.server.max_decompressed_request_size;
+        mcp::transport::CompressionOptions::configure(compression_options);
+
+        mcp::transport::ConnectionTimeoutOptions timeout_options;
+        timeout_options.header_timeout_ms = config.server.header_timeout_ms;
+        timeout_options.body_timeout_ms = config.server.body_timeout_ms;
+        timeout_options.idle_timeout_ms = config.server.keepalive_timeout_ms;
+        mcp::transport::ConnectionTimeoutOptions::configure(timeout_options);
+
+        mcp::transport::MetricsEndpointOptions metrics_endpoint_options;
+        metrics_endpoint_options.path = config.server.metrics_endpoint ? config.server.metrics_path : std::string();
+        metrics_endpoint_options.stats_path = config.server.admin_stats_endpoint ? "/admin/stats" : "";
+        metrics_endpoint_options.ready_path = config.server.ready_path;
+        mcp::transport::MetricsEndpointOptions::configure(metrics_endpoint_options);
+
+        mcp::transport::DebugEndpointOptions debug_endpoint_options;
+        debug_endpoint_options.enabled = config.server.debug_endpoints;
+        debug_endpoint_options.max_profile_seconds = config.server.max_profile_seconds;
+        mcp::transport::DebugEndpointOptions::configure(debug_endpoint_options);
+
+        // Pool sizes, limits and the log level changed at runtime go through the config snapshot
+        mcp::transport::AdminEndpointOptions admin_endpoint_options;
+        admin_endpoint_options.token = config.server.admin_token;
+        admin_endpoint_options.read = mcp::business::runtime_settings;
+        admin_endpoint_options.apply = mcp::business::apply_runtime_settings;
+        mcp::transport::AdminEndpointOptions::configure(admin_endpoint_options);
+
+        mcp::transport::DrainOptions drain_options;
+        drain_options.timeout = std::chrono::milliseconds(config.server.drain_timeout_ms);
+        drain_options.stream_spread = std::chrono::milliseconds(config.server.drain_stream_spread_ms);
+        mcp::transport::DrainOptions::configure(drain_options);
+
+        mcp::metrics::RequestTraceOptions trace_options;
+        trace_options.sample_every = config.server.trace_sample_every;
+        mcp::metrics::RequestTraceOptions::configure(trace_options);
+
+        mcp::metrics::TracingOptions tracing_options;
+        tracing_options.otlp_endpoint = config.server.otlp_endpoint;
+        tracing_options.service_name = config.server.otlp_service_name;
+        tracing_options.sample_every = config.server.otlp_sample_every;
+        tracing_options.batch_size = config.server.otlp_batch_size;
+        tracing_options.export_interval = std::chrono::milliseconds(config.server.otlp_export_interval_ms);
+        mcp::metrics::TracingOptions::configure(tracing_options);
+        mcp::metrics::SpanExporter::instance().start();
+
+        mcp::metrics::MetricsPushOptions push_options;
+        push_options.statsd_endpoint = config.server.metrics_statsd_endpoint;
+        push_options.statsd_prefix = config.server.metrics_statsd_prefix;
+        push_options.otlp_endpoint = config.server.metrics_otlp_endpoint;
+        push_options.service_name = config.server.otlp_service_name;
+        push_options.interval = std::chrono::milliseconds(config.server.metrics_push_interval_ms);
+        push_options.max_buffered_bytes = config.server.metrics_push_buffer_bytes;
+        mcp::metrics::MetricsPushOptions::configure(push_options);
+        mcp::metrics::MetricsPusher::instance().start();
+
+        mcp::metrics::AccessLogOptions access_log_options;
+        access_log_options.path = config.server.access_log_path;
+        access_log_options.error_sample_every = config.server.access_log_error_sample_every;
+        access_log_options.success_sample_every = config.server.access_log_success_sample_every;
+        access_log_options.batch_size = config.server.access_log_batch_size;
+        access_log_options.flush_interval = std::chrono::milliseconds(config.server.access_log_flush_ms);
+        mcp::metrics::AccessLogOptions::configure(access_log_options);
+        mcp::metrics::AccessLog::instance().start();
+
+        mcp::metrics::AuditLogOptions audit_options;
+        audit_options.directory = config.server.audit_log_dir;
+        audit_options.segment_bytes = config.server.audit_segment_bytes;
+        audit_options.sync_interval = std::chrono::milliseconds(config.server.audit_sync_interval_ms);
+        audit_options.ring_bytes = config.server.audit_ring_bytes;
+        mcp::metrics::AuditLogOptions::configure(audit_options);
+        mcp::metrics::AuditLog::instance().start();
+
+        // Requests are captured for replay from the moment the transports start
+        mcp::transport::TrafficCaptureOptions capture_options;
+        capture_options.path = config.server.capture_path;
+        capture_options.redact = mcp::transport::TrafficCaptureOptions::parse_fields(config.server.capture_redact_fields);
+        mcp::transport::TrafficCaptureOptions::configure(capture_options);
+        mcp::transport::TrafficCapture::instance().start();
+
+        // Blocking tool calls run on their own pool so they never stall the IO threads
+        mcp::core::ToolThreadPoolOptions tool_pool_options;
+        tool_pool_options.threads = config.concurrency.tool_threads;
+        tool_pool_options.control_threads = config.concurrency.control_threads;
+        tool_pool_options.max_threads = config.concurrency.tool_threads_max;
+        tool_pool_options.blocked_ratio = static_cast<double>(std::min<size_t>(config.concurrency.tool_blocked_cpu_percent, 100)) / 100.0;
+        mcp::core::ToolThreadPool::configure(std::move(tool_pool_options));
+
+        // Blocking stream generators are pulled on their own pool as well
+        mcp::business::StreamPumpPoolOptions stream_pump_options;
+        stream_pump_options.threads = config.concurrency.stream_pump_threads;
+        stream_pump_options.queue_size = std::max<size_t>(config.concurrency.stream_pump_queue, 1);
+        mcp::business::StreamPumpPool::configure(std::move(stream_pump_options));
+
+        // Plugin results are spliced into responses unparsed; passthrough output is checked unless disabled.
+        // Stream events are pulled in batches and sent with one write per batch, large results in chunks
+        mcp::business::ToolOutputOptions tool_output_options;
+        tool_output_options.validate_passthrough = config.server.validate_passthrough_results;
+        tool_output_options.stream_batch_max_items = std::max<size_t>(config.server.stream_batch_max_items, 1);
+        tool_output_options.stream_batch_max_delay = std::chrono::microseconds(config.server.stream_batch_max_delay_us);
+        tool_output_options.result_stream_threshold = config.transport.result_stream_threshold;
+        tool_output_options.result_stream_chunk = std::max<size_t>(config.transport.result_stream_chunk, 1024);
+        mcp::business::ToolOutputOptions::configure(tool_output_options);
+
+        mcp::transport::UploadOptions upload_options;
+        upload_options.stream_threshold = config.transport.upload_stream_threshold;
+        upload_options.max_size = config.transport.upload_max_size;
+        mcp::transport::UploadOptions::configure(upload_options);
+
+        // Per-stream send queue, bounds how far a generator runs ahead of a slow client
+        mcp::transport::SseQueueOptions sse_queue_options;
+        sse_queue_options.high_watermark = std::max<size_t>(config.server.stream_queue_high_watermark, 1);
+        sse_queue_options.low_watermark = std::min(config.server.stream_queue_low_watermark, sse_queue_options.high_watermark);
+        sse_queue_options.policy = mcp::transport::SseQueueOptions::parse_policy(config.server.stream_slow_consumer_policy);
+        sse_queue_options.heartbeat_interval = std::chrono::milliseconds(config.server.stream_heartbeat_interval_ms);
+        sse_queue_options.heartbeat_jitter = std::chrono::milliseconds(config.server.stream_heartbeat_jitter_ms);
+        mcp::transport::SseQueueOptions::configure(sse_queue_options);
+
+        // Reconnect cache limits, applied when the first router initializes the cache
+        mcp::cache::McpCacheOptions cache_options;
+        cache_options.max_sessions = config.cache.max_sessions;
+        cache_options.max_data_per_session = config.cache.max_events_per_session;
+        cache_options.ttl = std::chrono::seconds(config.cache.ttl_s);
+        cache_options.max_bytes = config.cache.max_bytes;
+        cache_options.shard_count = config.cache.shards;
+        cache_options.tool_ttls = mcp::cache::McpCacheOptions::parse_tool_ttls(config.cache.tool_ttls);
+        cache_options.stream_state_commit = mcp::cache::McpCacheOptions::parse_stream_state_commit(config.cache.stream_state_commit);
+        cache_options.stream_state_commit_interval = std::chrono::milliseconds(config.cache.stream_state_commit_interval_ms);
+        mcp::cache::McpCacheOptions::configure(std::move(cache_options));
+
+        // Results of idempotent tools are memoized, identical calls in flight share one execution
+        mcp::business::ToolResultCacheOptions result_cache_options;
+        for (auto &[tool, ttl]: mcp::cache::McpCacheOptions::parse_tool_ttls(config.cache.result_cache_tools)) {
+            if (ttl.count() > 0) {
+                result_cache_options.tools.emplace(tool, ttl);
+            }
+        }
+        result_cache_options.max_bytes = config.cache.result_cache_max_bytes;
+        result_cache_options.max_result_bytes = config.cache.result_cache_max_result_bytes;
+        mcp::business::ToolResultCache::configure(std::move(result_cache_options));
+
+        // Retries of a call with an idempotency key join it or get its result instead of running again
+        mcp::business::IdempotencyCacheOptions idempotency_options;
+        idempotency_options.ttl = std::chrono::seconds(config.cache.idempotency_ttl_s);
+        idempotency_options.max_bytes = config.cache.idempotency_max_bytes;
+        idempotency_options.max_result_bytes = config.cache.result_cache_max_result_bytes;
+        mcp::business::IdempotencyCache::configure(idempotency_options);
+
+        // Concurrent reads of one resource share the I/O, contents may be reused for a while after
+        mcp::routers::ResourceReadOptions resource_read_options;
+        resource_read_options.cache_ttl = std::chrono::seconds(config.cache.resource_cache_ttl_s);
+        resource_read_options.cache_max_bytes = config.cache.resource_cache_max_bytes;
+        resource_read_options.cache_max_entry_bytes = config.cache.result_cache_max_result_bytes;
+        resource_read_options.stream_threshold = config.transport.resource_stream_threshold;
+        resource_read_options.stream_window = config.transport.resource_stream_window;
+        resource_read_options.bulk_max_uris = config.transport.resource_read_max_uris;
+        resource_read_options.bulk_concurrency = config.transport.resource_read_concurrency;
+        mcp::routers::ResourceReadOptions::configure(resource_read_options);
+
+        // prompts/get results are memoized per argument values
+        mcp::prompts::PromptRenderOptions prompt_render_options;
+        prompt_render_options.cache_max_bytes = config.cache.prompt_cache_max_bytes;
+        mcp::prompts::PromptRenderOptions::configure(prompt_render_options);
+
+        // Subscribed resources are announced at most once per debounce window
+        mcp::resources::SubscriptionOptions subscription_options;
+        subscription_options.debounce = std::chrono::milliseconds(config.transport.resource_notify_debounce_ms);
+        subscription_options.watch_files = config.transport.resource_watch_files;
+        mcp::resources::SubscriptionOptions::configure(subscription_options);
+
+        // A running server on the hot restart socket hands its listeners over before any is
+        // opened here, and its cache persistence before the backend below opens the directory
+        mcp::transport::HotRestartOptions hot_restart_options;
+        hot_restart_options.socket_path = config.server.hot_restart_socket;
+        mcp::transport::HotRestartOptions::configure(hot_restart_options);
+        mcp::transport::HotRestart::instance().take_over();
+
+        // Reconnect cache persistence, restored when the first router initializes the cache
+        if (config.cache.persistence == "segment") {
+            mcp::cache::SegmentLogOptions segment_options;
+            segment_options.directory = config.cache.persistence_dir;
+            segment_options.flush_interval = std::chrono::milliseconds(std::max<size_t>(config.cache.persistence_flush_ms, 1));
+            try {
+                mcp::cache::McpCache::GetInstance()->SetBackend(std::make_shared<mcp::cache::SegmentLogBackend>(std::move(segment_options)));
+            } catch (const std::exception &e) {
+                MCP_ERROR("Cache persistence disabled: {}", e.what());
+            }
+        } else if (config.cache.persistence != "none") {
+            MCP_WARN("Unknown cache persistence backend: {}, keeping the cache in memory", config.cache.persistence);
+        }
+
+        auto admission_of = [](const mcp::config::GlobalConfig &config) {
+            mcp::transport::AdmissionOptions admission_options;
+            admission_options.max_in_flight = config.concurrency.max_in_flight;
+            admission_options.tool_limits = mcp::transport::AdmissionOptions::parse_tool_limits(config.concurrency.tool_limits);
+            admission_options.max_queue = config.concurrency.queue_size;
+            admission_options.queue_timeout = std::chrono::milliseconds(config.concurrency.queue_timeout_ms);
+            return admission_options;
+        };
+        mcp::transport::AdmissionController::getInstance().configure(admission_of(config));
+
+        // Tool calls of different clients take turns on the tool pool
+        auto fair_share_of = [](const mcp::config::GlobalConfig &config) {
+            mcp::transport::FairShareOptions fair_share_options;
+            fair_share_options.tenant = mcp::transport::FairShareOptions::parse_tenant(config.concurrency.fair_scheduling);
+            fair_share_options.slots = config.concurrency.fair_slots;
+            fair_share_options.weights = mcp::transport::FairShareOptions::parse_weights(config.concurrency.fair_weights);
+            fair_share_options.tenant_slots = mcp::transport::TenantOptions::parse_limits(config.concurrency.tenant_tool_slots);
+            fair_share_options.max_queue = config.concurrency.queue_size;
+            fair_share_options.queue_timeout = std::chrono::milliseconds(config.concurrency.queue_timeout_ms);
+            return fair_share_options;
+        };
+        mcp::transport::FairScheduler::getInstance().configure(fair_share_of(config), mcp::core::ToolThreadPool::instance().max_size());
+
+        mcp::transport::OverloadOptions overload_options;
+        overload_options.lag_threshold = std::chrono::milliseconds(config.concurrency.overload_lag_ms);
+        overload_options.retry_after = std::chrono::seconds(config.concurrency.overload_retry_after_s);
+        mcp::transport::OverloadOptions::configure(overload_options);
+
+        // Handshakes and health checks bypass shedding and queued tool calls
+        mcp::transport::PriorityOptions priority_options;
+        priority_options.control_methods = mcp::transport::PriorityOptions::parse_names(config.concurrency.control_plane_methods);
+        priority_options.control_tools = mcp::transport::PriorityOptions::parse_names(config.concurrency.control_plane_tools);
+        mcp::transport::PriorityOptions::configure(priority_options);
+
+        // Batch entries run side by side and are answered together, within the deadline
+        mcp::protocol::BatchOptions batch_options;
+        batch_options.max_size = config.concurrency.max_batch_size;
+        batch_options.deadline = std::chrono::milliseconds(config.concurrency.batch_deadline_ms);
+        mcp::protocol::BatchOptions::configure(batch_options);
+
+        // Synchronous tool calls are answered with a timeout error at their deadline
+        mcp::business::ToolDeadlineOptions deadline_options;
+        deadline_options.timeout = std::chrono::milliseconds(config.concurrency.tool_timeout_ms);
+        for (auto &[tool, timeout_ms]: mcp::transport::AdmissionOptions::parse_tool_limits(config.concurrency.tool_timeouts)) {
+            deadline_options.tools.emplace(tool, std::chrono::milliseconds(timeout_ms));
+        }
+        mcp::business::ToolDeadlineOptions::configure(std::move(deadline_options));
+
+        // Plugins that use more than their share of CPU or memory have their calls refused
+        mcp::business::PluginQuotaOptions quota_options;
+        quota_options.cpu = std::chrono::milliseconds(config.server.plugin_cpu_quota_ms);
+        quota_options.allocated = static_cast<uint64_t>(config.server.plugin_alloc_quota_mb) * 1024 * 1024;
+        quota_options.window = std::chrono::seconds(std::max<size_t>(config.server.plugin_quota_window_s, 1));
+        quota_options.action = mcp::business::PluginQuotaOptions::parse_action(config.server.plugin_quota_action);
+        mcp::business::PluginQuotaOptions::configure(quota_options);
+
+        // Long tool, resource and prompt lists are sent in pages
+        mcp::core::PaginationOptions pagination_options;
+        pagination_options.page_size = config.server.list_page_size;
+        mcp::core::PaginationOptions::configure(pagination_options);
+
+        // Tool list changes can carry what changed, so clients need not list again
+        mcp::business::ToolListChangedOptions tool_list_changed_options;
+        tool_list_changed_options.delta = config.server.tools_list_delta;
+        tool_list_changed_options.max_delta = config.server.tools_list_delta_max;
+        mcp::business::ToolListChangedOptions::configure(tool_list_changed_options);
+
+        // Progress reports of tool calls are coalesced to this rate
+        mcp::business::ProgressOptions progress_options;
+        progress_options.max_per_second = static_cast<unsigned>(config.concurrency.progress_max_per_second);
+        mcp::business::ProgressOptions::configure(progress_options);
+
+        // Calls of plugins exporting call_tools_batch wait this long for others of the same tool
+        mcp::business::ToolBatchOptions tool_batch_options;
+        tool_batch_options.window = std::chrono::microseconds(config.concurrency.tool_batch_window_us);
+        tool_batch_options.max_calls = std::max<size_t>(config.concurrency.tool_batch_max, 1);
+        mcp::business::ToolBatchOptions::configure(tool_batch_options);
+
+        // Replicas that share sessions; peers forward requests to the HTTP listener advertised here
+        mcp::transport::ClusterOptions cluster_options;
+        cluster_options.enabled = config.cluster.enabled;
+        cluster_options.node_id = config.cluster.node_id;
+        cluster_options.bind = config.cluster.bind;
+        cluster_options.advertise = config.cluster.advertise.empty()
+                                            ? config.server.ip + ":" + std::to_string(config.server.http_port)
+                                            : config.cluster.advertise;
+        cluster_options.seeds = mcp::transport::ClusterOptions::parse_list(config.cluster.seeds);
+        cluster_options.secret = config.cluster.secret;
+        cluster_options.gossip_interval = std::chrono::milliseconds(config.cluster.gossip_interval_ms);
+        cluster_options.suspect_after = std::chrono::milliseconds(config.cluster.suspect_after_ms);
+        cluster_options.virtual_nodes = config.cluster.virtual_nodes;
+        cluster_options.forward_timeout = std::chrono::milliseconds(config.cluster.forward_timeout_ms);
+        mcp::transport::ClusterOptions::configure(cluster_options);
+
+        // Tools of upstream MCP servers, registered once the server is built
+        mcp::business::FederationOptions federation_options;
+        federation_options.upstreams = mcp::business::FederationOptions::parse_upstreams(config.federation.upstreams);
+        federation_options.prefix_tools = config.federation.prefix_tools;
+        federation_options.token = config.federation.token;
+        federation_options.max_idle_connections = config.federation.max_idle_connections;
+        federation_options.call_timeout = std::chrono::milliseconds(config.federation.call_timeout_ms);
+        federation_options.health_interval = std::chrono::milliseconds(config.federation.health_interval_ms);
+        federation_options.refresh_interval = std::chrono::seconds(config.federation.refresh_interval_s);
+        mcp::business::FederationOptions::configure(std::move(federation_options));
+
+        // Limits that follow config reloads, each applied only when its own settings change
+        using CacheLimits = std::tuple<size_t, size_t, size_t>;
+        std::vector<std::unique_ptr<mcp::config::ConfigObserver>> live_limits;
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<mcp::metrics::RateLimitConfig>>(
+                config, rate_limits_of, [](const mcp::metrics::RateLimitConfig &limits) {
+                    mcp::metrics::RateLimiter::getInstance()->set_config(limits);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<mcp::transport::TenantOptions>>(
+                config, tenants_of, [](const mcp::transport::TenantOptions &options) {
+                    mcp::transport::Tenants::instance().configure(options);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<mcp::transport::ClusterQuotaOptions>>(
+                config, cluster_quota_of, [](const mcp::transport::ClusterQuotaOptions &options) {
+                    mcp::transport::ClusterQuota::instance().configure(options);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<mcp::transport::AdmissionOptions>>(
+                config, admission_of, [](const mcp::transport::AdmissionOptions &options) {
+                    mcp::transport::AdmissionController::getInstance().configure(options);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<mcp::transport::FairShareOptions>>(
+                config, fair_share_of, [](const mcp::transport::FairShareOptions &options) {
+                    mcp::transport::FairScheduler::getInstance().configure(options, mcp::core::ToolThreadPool::instance().max_size());
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<CacheLimits>>(
+                config, [](const mcp::config::GlobalConfig &config) { return CacheLimits{config.cache.max_sessions, config.cache.max_events_per_session, config.cache.max_bytes}; },
+                [](const CacheLimits &limits) {
+                    mcp::cache::McpCacheOptions options = mcp::cache::McpCacheOptions::current();
+                    std::tie(options.max_sessions, options.max_data_per_session, options.max_bytes) = limits;
+                    mcp::cache::McpCache::GetInstance()->SetLimits(options);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<size_t>>(
+                config, [](const mcp::config::GlobalConfig &config) { return config.cache.result_cache_max_bytes; },
+                [](const size_t &max_bytes) {
+                    mcp::business::ToolResultCache::instance().set_max_bytes(max_bytes);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<size_t>>(
+                config, [](const mcp::config::GlobalConfig &config) { return config.cache.idempotency_max_bytes; },
+                [](const size_t &max_bytes) {
+                    mcp::business::IdempotencyCache::instance().set_max_bytes(max_bytes);
+                }));
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<std::string>>(
+                config, [](const mcp::config::GlobalConfig &config) { return config.server.log_level; },
+                [](const std::string &log_level) {
+                    mcp::core::MCPLogger::instance().set_level(mcp::core::MCPLogger::parse_level(log_level).value_or(mcp::core::LogLevel::INFO));
+                }));
+        // Pools resize without closing a connection or cutting a call short
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<size_t>>(
+                config, [](const mcp::config::GlobalConfig &config) { return config.server.io_threads; },
+                [](const size_t &io_threads) {
+                    AsioIOServicePool::GetInstance()->Resize(io_threads);
+                }));
+        using ToolPoolSize = std::pair<size_t, size_t>;
+        live_limits.push_back(std::make_unique<mcp::config::ConfigSubscription<ToolPoolSize>>(
+                config, [](const mcp::config::GlobalConfig &config) { return ToolPoolSize{config.concurrency.tool_threads, config.concurrency.tool_threads_max}; },
+                [fair_share_of](const ToolPoolSize &size) {
+                    auto &pool = mcp::core::ToolThreadPool::instance();
+                    pool.resize(size.first, size.second);
+                    // Fair share slots default to what the pool may grow to
+                    mcp::transport::FairScheduler::getInstance().configure(fair_share_of(*mcp::config::current_config()), pool.max_size());
+                }));
+        for (auto &observer: live_limits) {
+            mcp::config::g_config_loader->addObserver(observer.get());
+        }
+
         // Create auth manager if auth is enabled
         std::shared_ptr<AuthManagerBase> auth_manager = nullptr;
+        std::unique_ptr<mcp::utils::AuthKeysObserver> auth_observer;
         if (config.server.enable_auth) {
             MCP_DEBUG("Authentication is enabled with type: {}", config.server.auth_type);
 
             // Load auth keys from file
-            auto auth_keys = mcp::utils::load_auth_keys_from_file(config.server.auth_env_file);
+            auto auth_keys = config.server.auth_type == "JWT" ? std::vector<std::string>{} : mcp::utils::load_auth_keys_from_file(config.server.auth_env_file);
 
-            if (auth_keys.empty()) {
+            if (config.server.auth_type == "JWT") {
+                // Tokens are checked against the identity provider's keys, fetched in the background
+                JwtAuthOptions jwt_options;
+                jwt_options.issuer = config.server.jwt_issuer;
+                jwt_options.audience = config.server.jwt_audience;
+                jwt_options.jwks_url = config.server.jwt_jwks_url;
+                jwt_options.refresh_interval = std::chrono::seconds(std::max<size_t>(1, config.server.jwt_refresh_s));
+                jwt_options.leeway = std::chrono::seconds(config.server.jwt_leeway_s);
+                jwt_options.cache_size = config.server.jwt_cache_size;
+                auth_manager = std::make_shared<AuthManagerJwt>(std::move(jwt_options));
+            } else if (auth_keys.empty()) {
                 MCP_WARN("Authentication is enabled but no keys were loaded from {}", config.server.auth_env_file);
             } else {
                 if (config.server.auth_type == "X-API-Key") {
@@ -127,11 +706,25 @@ int main() {
                     MCP_WARN("Unknown authentication type: {}, using X-API-Key as default", config.server.auth_type);
                     auth_manager = std::make_shared<AuthManagerXApi>(auth_keys);
                 }
+
+                // Edits of the keys file take effect on the next config reload
+                auth_observer = std::make_unique<mcp::utils::AuthKeysObserver>(auth_manager);
+                mcp::config::g_config_loader->addObserver(auth_observer.get());
             }
         } else {
             MCP_DEBUG("Authentication is disabled");
         }
 
+        // Local clients on the Unix socket may be authenticated by their user id instead
+        mcp::transport::UnixSocketAuth unix_socket_auth;
+        unix_socket_auth.enabled = config.server.unix_socket_peer_auth;
+        unix_socket_auth.allowed_uids = mcp::transport::UnixSocketAuth::parse_uids(config.server.unix_socket_allowed_uids);
+
+        // Large responses go to local clients that ask in a sealed memfd rather than through the socket
+        mcp::transport::MemfdHandoffOptions memfd_handoff_options;
+        memfd_handoff_options.min_size = config.server.unix_memfd_min_size;
+        mcp::transport::MemfdHandoffOptions::configure(memfd_handoff_options);
+
         // Step 6: Build the MCP server instance using the configuration.
         // Configure transport layers and plugin directory based on settings.
         auto server = mcp::core::MCPserver::Builder{}
@@ -145,6 +738,16 @@ int main() {
                               .with_ssl_certificates(config.server.ssl_cert_file,
                                                      config.server.ssl_key_file, config.server.ssl_dh_params_file)// Set SSL certificate files
                               .with_auth_manager(auth_manager)                                                    // Set authentication manager
+                              .with_reuse_port(config.server.reuse_port)                                          // One acceptor per IO thread
+                              .with_shared_nothing(config.server.shared_nothing)                                  // Per-core acceptors, limits and tool lookups
+                              .with_unix_socket(config.server.unix_socket, unix_socket_auth)                      // Unix domain socket listener, if configured
+                              .with_argument_validation(config.server.validate_tool_arguments)                    // Reject invalid tool arguments before dispatch
+                              .with_lazy_plugin_loading(config.server.plugin_lazy_load,
+                                                        config.server.plugin_idle_unload_s)// Load manifest-listed plugins on first call
+                              .with_plugin_isolation(config.server.plugin_isolation,
+                                                     config.server.plugin_host_channels,
+                                                     config.server.plugin_host_buffer_kb)// Run the listed plugins in child processes
+                              .with_background_tool_loading(config.server.background_tool_loading)// Load the tools while the listeners accept
                               .build();                                                                           // Construct the server instance
 
         // Setup signal handler for graceful shutdown
@@ -153,8 +756,8 @@ int main() {
 
         signals.async_wait([&](const asio::error_code &error, int signal_number) {
             if (!error) {
-                MCP_INFO("Received signal {}, initiating graceful shutdown...", signal_number);
-                std::quick_exit(0);
+                MCP_INFO("Received signal {}, draining connections before shutdown...", signal_number);
+                server->drain();// run() returns once it is done
             }
         });
 
@@ -163,6 +766,12 @@ int main() {
             io_context.run();
         });
 
+        // Join the cluster before the first session ID is minted
+        mcp::transport::Cluster::instance().start();
+
+        // Take the sessions of the previous process over and let it drain, or wait for a successor
+        mcp::transport::HotRestart::instance().start([&server]() { server->drain(); });
+
         // Notify that the server is ready to accept connections.
         MCP_INFO("MCPServer.cpp is ready.");
         MCP_INFO("Send JSON-RPC messages via /mcp.");
@@ -177,6 +786,16 @@ int main() {
             signal_thread.join();
         }
 
+        mcp::transport::Cluster::instance().stop();
+        mcp::transport::HotRestart::instance().stop();
+
+        // Send the spans, metrics, access log lines, audit records and captured requests still queued while the logger is still around
+        mcp::metrics::SpanExporter::instance().shutdown();
+        mcp::metrics::MetricsPusher::instance().shutdown();
+        mcp::metrics::AccessLog::instance().shutdown();
+        mcp::metrics::AuditLog::instance().shutdown();
+        mcp::transport::TrafficCapture::instance().shutdown();
+
         MCP_INFO("Server shutdown complete.");
         return 0;// Normal exit
 
@@ -0,0 +1,216 @@
+#include "access_log.h"
+#include "core/logger.h"
+#include "tracing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace mcp::metrics {
+
+    namespace {
+        AccessLogOptions &options_storage() {
+            static AccessLogOptions options;
+            return options;
+        }
+
+        constexpr size_t kQueuedBatches = 4;///< Batches queued at most before lines are dropped
+
+        /**
+         * @brief Whether this is one in every calls of the calling thread; counted per thread, so
+         *        sampling takes no shared state.
+         */
+        bool one_in(size_t &count, size_t every) {
+            if (every == 0) {
+                return false;
+            }
+            if (++count < every) {
+                return false;
+            }
+            count = 0;
+            return true;
+        }
+
+        void append_timestamp(std::string &out, std::chrono::system_clock::time_point time) {
+            auto since_epoch = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+            std::time_t seconds = static_cast<std::time_t>(since_epoch / 1000);
+            std::tm tm{};
+#ifdef _WIN32
+            gmtime_s(&tm, &seconds);
+#else
+            gmtime_r(&seconds, &tm);
+#endif
+            char buffer[32];
+            size_t size = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+            out.append(buffer, size);
+            std::snprintf(buffer, sizeof(buffer), ".%03dZ", static_cast<int>(since_epoch % 1000));
+            out += buffer;
+        }
+
+        void append_member(std::string &out, std::string_view key, std::string_view value) {
+            out += ",\"";
+            out += key;
+            out += "\":";
+            append_json_string(out, value);
+        }
+
+        void append_member(std::string &out, std::string_view key, uint64_t value) {
+            out += ",\"";
+            out += key;
+            out += "\":";
+            out += std::to_string(value);
+        }
+
+        /**
+         * @brief Format a request as one JSON line.
+         */
+        void encode(std::string &out, const AccessLogEntry &entry) {
+            out += "{\"time\":\"";
+            append_timestamp(out, entry.time);
+            out += '"';
+            append_member(out, "session", entry.session_id);
+            append_member(out, "method", entry.http_method);
+            append_member(out, "path", entry.path);
+            if (!entry.rpc_method.empty()) {
+                append_member(out, "rpc_method", entry.rpc_method);
+            }
+            if (!entry.tool.empty()) {
+                append_member(out, "tool", entry.tool);
+            }
+            append_member(out, "status", static_cast<uint64_t>(entry.status));
+            append_member(out, "request_bytes", entry.request_bytes);
+            append_member(out, "response_bytes", entry.response_bytes);
+            if (entry.error) {
+                append_member(out, "error", *entry.error);
+            }
+            append_member(out, "duration_us", entry.duration_us);
+            out += ",\"stages_us\":{";
+            bool first = true;
+            for (size_t i = 0; i < kRequestStages; ++i) {
+                if (!entry.stage_us[i]) {
+                    continue;
+                }
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                append_json_string(out, stage_name(static_cast<RequestStage>(i)));
+                out += ':';
+                out += std::to_string(*entry.stage_us[i]);
+            }
+            out += "}}\n";
+        }
+    }// namespace
+
+    void AccessLogOptions::configure(const AccessLogOptions &options) {
+        options_storage() = options;
+    }
+
+    const AccessLogOptions &AccessLogOptions::current() {
+        return options_storage();
+    }
+
+    AccessLog &AccessLog::instance() {
+        static AccessLog log;
+        return log;
+    }
+
+    AccessLog::~AccessLog() {
+        shutdown();
+    }
+
+    void AccessLog::start() {
+        const auto &options = AccessLogOptions::current();
+        if (options.path.empty() || thread_.joinable()) {
+            return;
+        }
+        file_ = std::fopen(options.path.c_str(), "a");
+        if (!file_) {
+            MCP_WARN("Access log disabled: cannot open {}: {}", options.path, std::strerror(errno));
+            return;
+        }
+
+        stopping_ = false;
+        enabled_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread([this]() { run(); });
+        MCP_INFO("Writing the access log to {} (errors 1/{}, successes 1/{})", options.path,
+                 options.error_sample_every, options.success_sample_every);
+    }
+
+    void AccessLog::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            stopping_ = true;
+        }
+        enabled_.store(false, std::memory_order_relaxed);
+        wake_.notify_one();
+        thread_.join();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    bool AccessLog::sample(bool error) const {
+        thread_local size_t errors = 0;
+        thread_local size_t successes = 0;
+        const auto &options = options_storage();
+        return error ? one_in(errors, options.error_sample_every) : one_in(successes, options.success_sample_every);
+    }
+
+    void AccessLog::submit(AccessLogEntry entry) {
+        if (!enabled()) {
+            return;
+        }
+        const size_t batch_size = std::max<size_t>(1, AccessLogOptions::current().batch_size);
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= batch_size * kQueuedBatches) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            queue_.push_back(std::move(entry));
+            full = queue_.size() == batch_size;
+        }
+        if (full) {
+            wake_.notify_one();
+        }
+    }
+
+    void AccessLog::run() {
+        const auto &options = AccessLogOptions::current();
+        const size_t batch_size = std::max<size_t>(1, options.batch_size);
+        std::vector<AccessLogEntry> batch;
+        std::string lines;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait_for(lock, options.flush_interval, [&]() { return stopping_ || queue_.size() >= batch_size; });
+            if (queue_.empty()) {
+                if (stopping_) {
+                    return;
+                }
+                continue;
+            }
+            size_t count = std::min(batch_size, queue_.size());
+            batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + static_cast<std::ptrdiff_t>(count)));
+            queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(count));
+
+            // Lines are formatted and written without the lock, requests keep queueing meanwhile
+            lock.unlock();
+            lines.clear();
+            for (const auto &entry: batch) {
+                encode(lines, entry);
+            }
+            if (std::fwrite(lines.data(), 1, lines.size(), file_) == lines.size() && std::fflush(file_) == 0) {
+                written_.fetch_add(batch.size(), std::memory_order_relaxed);
+            } else {
+                dropped_.fetch_add(batch.size(), std::memory_order_relaxed);
+            }
+            batch.clear();
+            lock.lock();
+        }
+    }
+
+}// namespace mcp::metrics
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "request_trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mcp::metrics {
+
+    /**
+     * @brief Built-in access log, normally taken from the [server] config section.
+     */
+    struct AccessLogOptions {
+        std::string path;                            ///< File the lines are appended to, empty = access log off
+        size_t error_sample_every = 1;               ///< Log one in this many failed requests of each io thread, 0 = none
+        size_t success_sample_every = 100;           ///< Log one in this many successful requests of each io thread, 0 = none
+        size_t batch_size = 256;                     ///< Lines per write; up to four batches are queued, more are dropped
+        std::chrono::milliseconds flush_interval{1000};///< Longest time a line waits to be written
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const AccessLogOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const AccessLogOptions &current();
+    };
+
+    /**
+     * @brief One request, as it is written to the access log.
+     */
+    struct AccessLogEntry {
+        std::chrono::system_clock::time_point time;///< When the request arrived
+        std::string session_id;
+        std::string http_method;
+        std::string path;
+        std::string rpc_method;///< JSON-RPC method, empty for requests that are not JSON-RPC
+        std::string tool;
+        int status = 0;
+        size_t request_bytes = 0;
+        size_t response_bytes = 0;
+        std::optional<std::string> error;///< JSON-RPC error message
+        uint64_t duration_us = 0;
+        std::array<std::optional<uint64_t>, kRequestStages> stage_us{};///< Time in each stage the request went through
+    };
+
+    /**
+     * @brief Writes sampled requests to the access log file, in batches, from its own thread.
+     *
+     * Every request of a session is timed by a RequestTrace while the access log is on; when it
+     * completes, errors (HTTP status 400 and above, or a JSON-RPC error) and successes are each
+     * sampled one in so many, counted per thread, and only the sampled ones are formatted.
+     * Submitting a line only appends it to a queue. The writer thread formats a batch as JSON
+     * lines and appends it with one write once it is full or flush_interval has passed; when the
+     * disk can't keep up the queue is bounded and further lines are dropped and counted.
+     */
+    class AccessLog {
+    public:
+        static AccessLog &instance();
+
+        /**
+         * @brief Open the configured file and start the writer; does nothing if the path is empty.
+         */
+        void start();
+
+        /**
+         * @brief Write what is queued, stop the writer thread and close the file.
+         */
+        void shutdown();
+
+        /**
+         * @brief Whether requests are logged; requests need a trace for the access log only then.
+         */
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Whether the next completed request of the calling thread is logged.
+         * @param error The request failed
+         */
+        bool sample(bool error) const;
+
+        /**
+         * @brief Queue a sampled request; dropped if the log is disabled or its queue is full.
+         */
+        void submit(AccessLogEntry entry);
+
+        uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        AccessLog() = default;
+        ~AccessLog();
+
+        void run();
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::vector<AccessLogEntry> queue_;
+        std::thread thread_;
+        std::FILE *file_ = nullptr;
+        bool stopping_ = false;
+        std::atomic<bool> enabled_{false};
+        std::atomic<uint64_t> written_{0};
+        std::atomic<uint64_t> dropped_{0};
+    };
+
+}// namespace mcp::metrics
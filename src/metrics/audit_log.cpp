@@ -0,0 +1,490 @@
+#include "audit_log.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mcp::metrics {
+
+    namespace {
+        AuditLogOptions &options_storage() {
+            static AuditLogOptions options;
+            return options;
+        }
+
+        constexpr size_t kHeaderBytes = 8;         ///< u32 size, u32 checksum
+        constexpr size_t kRingAlign = 8;           ///< Records in a ring start at multiples of this, so a wrap marker always fits
+        constexpr uint32_t kWrap = UINT32_MAX;     ///< Size marking the unused end of a ring
+        constexpr size_t kMinRingBytes = 4096;
+        constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+        constexpr std::string_view kSegmentPrefix = "audit-";
+        constexpr std::string_view kSegmentSuffix = ".log";
+
+        uint32_t checksum(std::string_view bytes) {
+            // FNV-1a, enough to tell a torn write from a complete record
+            uint32_t hash = 2166136261u;
+            for (unsigned char c: bytes) {
+                hash = (hash ^ c) * 16777619u;
+            }
+            return hash;
+        }
+
+        void put_uint(std::string &out, uint64_t value, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) {
+                out += static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+        }
+
+        uint64_t get_uint(const char *in, size_t bytes) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+            }
+            return value;
+        }
+
+        void put_string(std::string &out, std::string_view value) {
+            value = value.substr(0, UINT16_MAX);
+            put_uint(out, value.size(), 2);
+            out += value;
+        }
+
+        /// Reads the fields of one record, failing on anything that runs past its end
+        struct FieldReader {
+            std::string_view bytes;
+            bool ok = true;
+
+            uint64_t number(size_t size) {
+                if (bytes.size() < size) {
+                    ok = false;
+                    return 0;
+                }
+                uint64_t value = get_uint(bytes.data(), size);
+                bytes.remove_prefix(size);
+                return value;
+            }
+
+            std::string string() {
+                size_t size = number(2);
+                if (!ok || bytes.size() < size) {
+                    ok = false;
+                    return {};
+                }
+                std::string value(bytes.substr(0, size));
+                bytes.remove_prefix(size);
+                return value;
+            }
+        };
+
+        /**
+         * @brief Ring of one recording thread: the thread produces, the writer consumes.
+         */
+        struct Ring {
+            explicit Ring(size_t bytes)
+                : capacity(std::bit_ceil(std::max(bytes, kMinRingBytes))), mask(capacity - 1), data(new char[capacity]) {}
+
+            const size_t capacity;
+            const size_t mask;
+            const std::unique_ptr<char[]> data;
+            alignas(64) std::atomic<size_t> head{0};///< Next byte to read, written by the writer
+            alignas(64) std::atomic<size_t> tail{0};///< Next byte to write, written by the thread
+            std::atomic<bool> orphaned{false};      ///< The thread has exited, the ring goes once drained
+
+            /**
+             * @brief Copy a record in; false if it does not fit.
+             */
+            bool push(std::string_view record) {
+                const size_t size = (record.size() + kRingAlign - 1) & ~(kRingAlign - 1);
+                if (size > capacity / 2) {
+                    return false;
+                }
+                const size_t start = tail.load(std::memory_order_relaxed);
+                const size_t offset = start & mask;
+                // A record does not wrap: if it does not fit before the end, the end is skipped
+                const size_t padding = capacity - offset < size ? capacity - offset : 0;
+                if (start + padding + size - head.load(std::memory_order_acquire) > capacity) {
+                    return false;
+                }
+                if (padding != 0) {
+                    std::memcpy(data.get() + offset, &kWrap, sizeof(kWrap));
+                }
+                std::memcpy(data.get() + ((start + padding) & mask), record.data(), record.size());
+                tail.store(start + padding + size, std::memory_order_release);
+                return true;
+            }
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Ring>> rings;
+        };
+
+        // Leaked so threads that record during exit still find it
+        Registry &registry() {
+            static auto *registry = new Registry;
+            return *registry;
+        }
+
+        struct ThreadRing {
+            std::shared_ptr<Ring> ring;
+            std::string scratch;///< Encoding buffer, reused by every record of the thread
+
+            ~ThreadRing() {
+                if (ring) {
+                    ring->orphaned.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ThreadRing t_ring;
+
+        Ring &thread_ring() {
+            if (!t_ring.ring) {
+                t_ring.ring = std::make_shared<Ring>(AuditLogOptions::current().ring_bytes);
+                auto &reg = registry();
+                std::lock_guard lock(reg.mutex);
+                reg.rings.push_back(t_ring.ring);
+            }
+            return *t_ring.ring;
+        }
+    }// namespace
+
+    /**
+     * @brief The segment file being written: mapped at its full size where the platform
+     *        allows it, written through stdio elsewhere.
+     */
+    class AuditLog::Segment {
+    public:
+        ~Segment() {
+#if !defined(_WIN32)
+            if (!data_) {
+                return;// Never created
+            }
+            sync();
+            ::munmap(data_, capacity_);
+            // What was never written is cut off, a reader sees exactly the records
+            if (::ftruncate(fd_, static_cast<off_t>(used_)) != 0 || ::fsync(fd_) != 0) {
+                MCP_WARN("Audit segment {} was not closed cleanly: {}", path_, std::strerror(errno));
+            }
+            ::close(fd_);
+#else
+            if (file_) {
+                sync();
+                std::fclose(file_);
+            }
+#endif
+        }
+
+        /**
+         * @brief Create a segment of the given size and write its magic.
+         * @return nullptr if it cannot be created
+         */
+        static std::unique_ptr<Segment> create(const std::string &path, size_t capacity) {
+            auto segment = std::unique_ptr<Segment>(new Segment(path, capacity));
+#if !defined(_WIN32)
+            segment->fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0640);
+            if (segment->fd_ < 0) {
+                return nullptr;
+            }
+            void *data = ::ftruncate(segment->fd_, static_cast<off_t>(capacity)) == 0
+                                 ? ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd_, 0)
+                                 : MAP_FAILED;
+            if (data == MAP_FAILED) {
+                int error = errno;
+                ::close(segment->fd_);
+                ::unlink(path.c_str());
+                errno = error;
+                return nullptr;
+            }
+            segment->data_ = static_cast<char *>(data);
+#else
+            segment->file_ = std::fopen(path.c_str(), "wbx");
+            if (!segment->file_) {
+                return nullptr;
+            }
+#endif
+            segment->append(kAuditMagic.data(), kAuditMagic.size());
+            return segment;
+        }
+
+        size_t free() const { return capacity_ - used_; }
+
+        /**
+         * @brief Size of a segment of the configured size.
+         */
+        static size_t configured_capacity() { return std::max<size_t>(AuditLogOptions::current().segment_bytes, kMinRingBytes); }
+
+        void append(const char *bytes, size_t size) {
+#if !defined(_WIN32)
+            std::memcpy(data_ + used_, bytes, size);
+#else
+            std::fwrite(bytes, 1, size, file_);
+#endif
+            used_ += size;
+        }
+
+        /**
+         * @brief Make what was appended since the last sync durable.
+         */
+        void sync() {
+            if (synced_ == used_) {
+                return;
+            }
+#if !defined(_WIN32)
+            static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t from = synced_ / page * page;
+            if (::msync(data_ + from, used_ - from, MS_SYNC) != 0) {
+                MCP_WARN("Syncing audit segment {} failed: {}", path_, std::strerror(errno));
+            }
+#else
+            std::fflush(file_);
+#endif
+            synced_ = used_;
+        }
+
+    private:
+        Segment(std::string path, size_t capacity) : path_(std::move(path)), capacity_(capacity) {}
+
+        std::string path_;
+        size_t capacity_;
+        size_t used_ = 0;
+        size_t synced_ = 0;
+#if !defined(_WIN32)
+        int fd_ = -1;
+        char *data_ = nullptr;
+#else
+        std::FILE *file_ = nullptr;
+#endif
+    };
+
+    void AuditLogOptions::configure(const AuditLogOptions &options) {
+        options_storage() = options;
+    }
+
+    const AuditLogOptions &AuditLogOptions::current() {
+        return options_storage();
+    }
+
+    size_t encode_audit_record(const AuditRecord &record, std::string &out) {
+        size_t start = out.size();
+        put_uint(out, 0, 4);
+        put_uint(out, 0, 4);
+        put_uint(out, record.unix_ns, 8);
+        put_uint(out, record.duration_us, 8);
+        put_uint(out, record.args_hash, 8);
+        put_uint(out, static_cast<uint32_t>(record.status), 4);
+        put_string(out, record.tool);
+        put_string(out, record.caller);
+        put_string(out, record.session);
+
+        // The size and checksum cover what follows the header
+        std::string header;
+        put_uint(header, out.size() - start - kHeaderBytes, 4);
+        put_uint(header, checksum(std::string_view(out).substr(start + kHeaderBytes)), 4);
+        out.replace(start, kHeaderBytes, header);
+        return out.size() - start;
+    }
+
+    AuditSegmentReader::AuditSegmentReader(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        bytes_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (!std::string_view(bytes_).starts_with(kAuditMagic)) {
+            throw std::runtime_error(path + " is not an audit segment");
+        }
+        rest_ = std::string_view(bytes_).substr(kAuditMagic.size());
+    }
+
+    bool AuditSegmentReader::next(AuditRecord &record) {
+        if (rest_.size() < kHeaderBytes) {
+            return false;
+        }
+        size_t size = get_uint(rest_.data(), 4);
+        if (size == 0) {
+            return false;// The unwritten end of a segment that was not closed
+        }
+        if (rest_.size() - kHeaderBytes < size ||
+            checksum(rest_.substr(kHeaderBytes, size)) != static_cast<uint32_t>(get_uint(rest_.data() + 4, 4))) {
+            damaged_ = true;
+            return false;
+        }
+        FieldReader fields{rest_.substr(kHeaderBytes, size)};
+        rest_.remove_prefix(kHeaderBytes + size);
+        record.unix_ns = fields.number(8);
+        record.duration_us = fields.number(8);
+        record.args_hash = fields.number(8);
+        record.status = static_cast<int32_t>(static_cast<uint32_t>(fields.number(4)));
+        record.tool = fields.string();
+        record.caller = fields.string();
+        record.session = fields.string();
+        if (!fields.ok) {
+            damaged_ = true;
+        }
+        return fields.ok;
+    }
+
+    AuditLog &AuditLog::instance() {
+        static AuditLog log;
+        return log;
+    }
+
+    AuditLog::~AuditLog() {
+        shutdown();
+    }
+
+    void AuditLog::start() {
+        const auto &options = AuditLogOptions::current();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (options.directory.empty() || thread_.joinable()) {
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(options.directory, ec);
+        if (ec) {
+            MCP_WARN("Audit log disabled: cannot create {}: {}", options.directory, ec.message());
+            return;
+        }
+
+        // Segments of earlier runs are left as they are, this run starts after the last one
+        for (const auto &entry: std::filesystem::directory_iterator(options.directory, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.starts_with(kSegmentPrefix) && name.ends_with(kSegmentSuffix)) {
+                auto digits = name.substr(kSegmentPrefix.size(), name.size() - kSegmentPrefix.size() - kSegmentSuffix.size());
+                next_sequence_ = std::max<uint64_t>(next_sequence_, std::strtoull(digits.c_str(), nullptr, 10) + 1);
+            }
+        }
+        if (!open_segment()) {
+            return;
+        }
+
+        stopping_.store(false, std::memory_order_relaxed);
+        enabled_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread([this]() { run(); });
+        MCP_INFO("Auditing tool calls to {} ({} byte segments)", options.directory, options.segment_bytes);
+    }
+
+    void AuditLog::shutdown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) {
+            return;
+        }
+        enabled_.store(false, std::memory_order_relaxed);
+        stopping_.store(true, std::memory_order_relaxed);
+        thread_.join();
+        MCP_INFO("Audit log closed: {} tool calls written, {} dropped", written(), dropped());
+    }
+
+    void AuditLog::record(const AuditRecord &record) {
+        if (!enabled()) {
+            return;
+        }
+        auto &scratch = t_ring.scratch;
+        scratch.clear();
+        encode_audit_record(record, scratch);
+        if (!thread_ring().push(scratch)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool AuditLog::open_segment() {
+        const auto &options = AuditLogOptions::current();
+        char name[32];
+        std::snprintf(name, sizeof(name), "%s%08llu%s", kSegmentPrefix.data(), static_cast<unsigned long long>(next_sequence_),
+                      kSegmentSuffix.data());
+        std::string path = (std::filesystem::path(options.directory) / name).string();
+        segment_ = Segment::create(path, Segment::configured_capacity());
+        if (!segment_) {
+            MCP_WARN("Cannot create audit segment {}: {}", path, std::strerror(errno));
+            return false;
+        }
+        ++next_sequence_;
+        return true;
+    }
+
+    void AuditLog::run() {
+        const auto sync_interval = AuditLogOptions::current().sync_interval;
+        auto last_sync = std::chrono::steady_clock::now();
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            size_t drained = drain();
+            auto now = std::chrono::steady_clock::now();
+            if (segment_ && now - last_sync >= sync_interval) {
+                // One sync for everything written since the last one
+                segment_->sync();
+                last_sync = now;
+            }
+            if (drained == 0) {
+                std::this_thread::sleep_for(kIdleSleep);
+            }
+        }
+        drain();
+        segment_.reset();
+    }
+
+    size_t AuditLog::drain() {
+        auto &reg = registry();
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard lock(reg.mutex);
+            rings = reg.rings;
+        }
+
+        // A record that would not fit even an empty segment is dropped rather than rotated for
+        const size_t max_record = Segment::configured_capacity() - kAuditMagic.size();
+        size_t drained = 0;
+        bool orphans = false;
+        for (auto &ring: rings) {
+            size_t head = ring->head.load(std::memory_order_relaxed);
+            const size_t tail = ring->tail.load(std::memory_order_acquire);
+            while (head != tail) {
+                const char *record = ring->data.get() + (head & ring->mask);
+                uint32_t size;
+                std::memcpy(&size, record, sizeof(size));
+                if (size == kWrap) {
+                    head += ring->capacity - (head & ring->mask);
+                    continue;
+                }
+                // The ring holds records as the segment does, little-endian
+                const size_t bytes = kHeaderBytes + static_cast<size_t>(get_uint(record, 4));
+                if (bytes <= max_record && (!segment_ || segment_->free() < bytes)) {
+                    segment_.reset();
+                    open_segment();
+                }
+                if (segment_ && segment_->free() >= bytes) {
+                    segment_->append(record, bytes);
+                    written_.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                head += (bytes + kRingAlign - 1) & ~(kRingAlign - 1);
+                ring->head.store(head, std::memory_order_release);
+                ++drained;
+            }
+            orphans |= ring->orphaned.load(std::memory_order_acquire);
+        }
+
+        if (orphans) {
+            std::lock_guard lock(reg.mutex);
+            std::erase_if(reg.rings, [](const std::shared_ptr<Ring> &ring) {
+                return ring->orphaned.load(std::memory_order_acquire) &&
+                       ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire);
+            });
+        }
+        return drained;
+    }
+
+}// namespace mcp::metrics
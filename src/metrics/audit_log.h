@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace mcp::metrics {
+
+    /**
+     * @brief Audit log of tool calls, normally taken from the [server] config section.
+     */
+    struct AuditLogOptions {
+        std::string directory;                       ///< Directory of the segment files, empty = audit log off
+        size_t segment_bytes = 64 * 1024 * 1024;     ///< Size of a segment, a new one is started when it is full
+        std::chrono::milliseconds sync_interval{100};///< Longest time a written record waits to be synced to disk
+        size_t ring_bytes = 256 * 1024;              ///< Ring buffer of each calling thread; records that find it full are dropped
+
+        /**
+         * @brief Set the process-wide options. Call before AuditLog::start().
+         * @param options New options
+         */
+        static void configure(const AuditLogOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const AuditLogOptions &current();
+    };
+
+    /**
+     * @brief One tool call, as it is kept in the audit log.
+     */
+    struct AuditRecord {
+        uint64_t unix_ns = 0;    ///< When the call arrived
+        uint64_t duration_us = 0;///< Until it was answered, or its stream started
+        uint64_t args_hash = 0;  ///< XXH64 of its serialized arguments
+        int32_t status = 0;      ///< 0 for success, else the JSON-RPC error code it was answered with
+        std::string tool;
+        std::string caller;      ///< Named tenant or hash of the credential, see ClusterQuota::tenant_of(); empty without one
+        std::string session;     ///< Mcp-Session-Id of the call
+    };
+
+    /// First bytes of every segment file
+    inline constexpr std::string_view kAuditMagic = "MCPAUDT1";
+
+    /**
+     * @brief Append a record in the segment format: u32 size and u32 FNV-1a checksum of what
+     *        follows, then u64 unix_ns, duration_us and args_hash, i32 status and the tool,
+     *        caller and session as u16 length and bytes, all little-endian.
+     * @param out Buffer to append to
+     * @return Bytes appended
+     */
+    size_t encode_audit_record(const AuditRecord &record, std::string &out);
+
+    /**
+     * @brief Reads the records of one segment file, in the order they were written.
+     * A segment ends at its first zero size, which is where a crash leaves it, or at a record
+     * cut short or failing its checksum.
+     */
+    class AuditSegmentReader {
+    public:
+        /**
+         * @param path Segment file
+         * @throws std::runtime_error if it cannot be read or is not a segment
+         */
+        explicit AuditSegmentReader(const std::string &path);
+
+        /**
+         * @brief Read the next record.
+         * @return false at the end of the segment
+         */
+        bool next(AuditRecord &record);
+
+        /**
+         * @brief Whether the segment ended in a damaged record rather than cleanly.
+         */
+        bool damaged() const { return damaged_; }
+
+    private:
+        std::string bytes_;
+        std::string_view rest_;
+        bool damaged_ = false;
+    };
+
+    /**
+     * @brief Append-only audit log of every tool call, written by a background thread.
+     *
+     * A call being recorded encodes its record into a ring buffer of the calling thread, without
+     * a lock or a system call; a full ring drops the record and counts it. The writer thread
+     * copies the records of every ring into the current segment file, which is mapped into
+     * memory at its full size, and syncs what it wrote every sync_interval. A full segment is cut
+     * to its used size and a new one started; segments are named audit-<sequence>.log and never
+     * reopened, a restart starts the next one. tools/mcp_audit prints them.
+     */
+    class AuditLog {
+    public:
+        static AuditLog &instance();
+
+        /**
+         * @brief Create the first segment in the configured directory and start the writer;
+         *        does nothing if the directory is empty.
+         */
+        void start();
+
+        /**
+         * @brief Write what the rings hold, stop the writer and close the segment.
+         */
+        void shutdown();
+
+        /**
+         * @brief Whether tool calls are recorded; nothing needs to be hashed otherwise.
+         */
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Queue a record in the calling thread's ring; dropped if the log is disabled or the ring is full.
+         */
+        void record(const AuditRecord &record);
+
+        uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        AuditLog() = default;
+        ~AuditLog();
+
+        class Segment;
+
+        void run();
+        size_t drain();
+        bool open_segment();
+
+        std::mutex mutex_;///< Held by start() and shutdown()
+        std::thread thread_;
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> enabled_{false};
+        std::atomic<uint64_t> written_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::unique_ptr<Segment> segment_;///< Used by the writer thread only
+        uint64_t next_sequence_ = 1;
+    };
+
+}// namespace mcp::metrics
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace mcp::metrics {
+
+    namespace detail {
+        inline constexpr size_t kShards = 64;///< Shards of a counter: one per thread, threads beyond share the last
+
+        inline std::atomic<size_t> next_shard{0};
+
+        /**
+         * @brief Shard of the calling thread, assigned on its first use.
+         */
+        inline size_t thread_shard() noexcept {
+            thread_local const size_t shard = std::min(next_shard.fetch_add(1, std::memory_order_relaxed), kShards - 1);
+            return shard;
+        }
+
+        /**
+         * @brief Add to a shard's counter; a shard with a single writer needs no locked instruction.
+         */
+        inline void shard_add(std::atomic<uint64_t> &counter, uint64_t n, size_t shard) noexcept {
+            if (shard < kShards - 1) {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            } else {
+                counter.fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+    }// namespace detail
+
+    /**
+     * @brief Counter that every thread increments in its own cache line.
+     * Each shard has one writer, so an increment is a plain load and store; value() sums the shards.
+     */
+    class ShardedCounter {
+    public:
+        void add(uint64_t n = 1) noexcept {
+            size_t shard = detail::thread_shard();
+            detail::shard_add(shards_[shard].value, n, shard);
+        }
+
+        uint64_t value() const noexcept {
+            uint64_t total = 0;
+            for (const auto &shard: shards_) {
+                total += shard.value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> value{0};
+        };
+        std::array<Shard, detail::kShards> shards_{};
+    };
+
+    /**
+     * @brief Latency histogram with power-of-two buckets, sharded per thread.
+     *
+     * Bucket i counts durations below 2^i microseconds, so the bucket of a sample is its bit
+     * width: recording is a bit scan and two unlocked adds in the calling thread's shard, with
+     * no shared cache line. A scrape merges the shards.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr size_t kBuckets = 27;///< Finite buckets, the last bound is 2^26 us (about 67 s)
+
+        /**
+         * @brief Merged counts of all shards.
+         */
+        struct Snapshot {
+            std::array<uint64_t, kBuckets + 1> counts{};///< Per bucket (not cumulative), the last one above every bound
+            uint64_t count = 0;
+            uint64_t sum_us = 0;
+        };
+
+        /**
+         * @brief Upper bound of a finite bucket.
+         * @param bucket Bucket index, below kBuckets
+         * @return Bound in microseconds
+         */
+        static constexpr uint64_t bound_us(size_t bucket) noexcept { return uint64_t{1} << bucket; }
+
+        /**
+         * @brief Record a duration.
+         * @param us Duration in microseconds
+         */
+        void record(uint64_t us) noexcept {
+            size_t index = detail::thread_shard();
+            auto &shard = shards_[index];
+            size_t bucket = static_cast<size_t>(std::bit_width(us));
+            detail::shard_add(shard.counts[bucket < kBuckets ? bucket : kBuckets], 1, index);
+            detail::shard_add(shard.sum_us, us, index);
+        }
+
+        Snapshot snapshot() const noexcept {
+            Snapshot result;
+            for (const auto &shard: shards_) {
+                for (size_t i = 0; i <= kBuckets; ++i) {
+                    uint64_t n = shard.counts[i].load(std::memory_order_relaxed);
+                    result.counts[i] += n;
+                    result.count += n;
+                }
+                result.sum_us += shard.sum_us.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::array<std::atomic<uint64_t>, kBuckets + 1> counts{};
+            std::atomic<uint64_t> sum_us{0};
+        };
+        std::array<Shard, detail::kShards> shards_{};
+    };
+
+}// namespace mcp::metrics
@@ -1,8 +1,119 @@
 #include "metrics_manager.h"
+#include "core/io_context_pool.hpp"
+#include "core/tool_thread_pool.hpp"
 #include "core/logger.h"
+#include <algorithm>
+#include <charconv>
 
 namespace mcp::metrics {
 
+    namespace {
+        template<size_t N>
+        size_t index_of(const std::array<std::string_view, N> &names, std::string_view name) {
+            auto it = std::find(names.begin(), names.end() - 1, name);
+            return static_cast<size_t>(it - names.begin());// The last name stands for everything else
+        }
+
+        void append_number(std::string &out, double value) {
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        void append_number(std::string &out, uint64_t value) {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        void append_number(std::string &out, int64_t value) {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        /**
+         * @brief Append a label, escaping the value as the exposition format requires.
+         */
+        void append_label(std::string &out, std::string_view name, std::string_view value) {
+            if (out.back() != '{') {
+                out += ',';
+            }
+            out += name;
+            out += "=\"";
+            for (char c: value) {
+                if (c == '\\' || c == '"') {
+                    out += '\\';
+                    out += c;
+                } else if (c == '\n') {
+                    out += "\\n";
+                } else {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        void append_header(std::string &out, std::string_view name, std::string_view type, std::string_view help) {
+            out += "# HELP ";
+            out += name;
+            out += ' ';
+            out += help;
+            out += "\n# TYPE ";
+            out += name;
+            out += ' ';
+            out += type;
+            out += '\n';
+        }
+
+        /**
+         * @brief Append one sample.
+         * @param labels Rendered labels including the braces, empty for none
+         */
+        template<typename T>
+        void append_sample(std::string &out, std::string_view name, std::string_view labels, T value) {
+            out += name;
+            out += labels;
+            out += ' ';
+            append_number(out, value);
+            out += '\n';
+        }
+
+        /**
+         * @brief Append the buckets, sum and count of a histogram with cumulative le buckets in seconds.
+         * @param labels Rendered labels with their opening brace, without the closing one
+         */
+        void append_histogram(std::string &out, std::string_view name, const std::string &labels, const LatencyHistogram::Snapshot &snapshot) {
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i <= LatencyHistogram::kBuckets; ++i) {
+                cumulative += snapshot.counts[i];
+                out += name;
+                out += "_bucket";
+                out += labels;
+                out += labels.size() > 1 ? ",le=\"" : "le=\"";
+                if (i < LatencyHistogram::kBuckets) {
+                    append_number(out, static_cast<double>(LatencyHistogram::bound_us(i)) / 1e6);
+                } else {
+                    out += "+Inf";
+                }
+                out += "\"} ";
+                append_number(out, cumulative);
+                out += '\n';
+            }
+            std::string closed = labels.size() > 1 ? labels + "}" : std::string();
+            append_sample(out, std::string(name) + "_sum", closed, static_cast<double>(snapshot.sum_us) / 1e6);
+            append_sample(out, std::string(name) + "_count", closed, snapshot.count);
+        }
+
+        std::string labels(std::initializer_list<std::pair<std::string_view, std::string_view>> pairs) {
+            std::string out = "{";
+            for (const auto &[name, value]: pairs) {
+                append_label(out, name, value);
+            }
+            return out;
+        }
+    }// namespace
+
     // static shared instance
     static std::shared_ptr<MetricsManager> instance = nullptr;
 
@@ -33,4 +144,424 @@ namespace mcp::metrics {
         return instance;
     }
 
+    std::shared_ptr<AcceptCounters> MetricsManager::register_accept_counters(const std::string &listener, size_t acceptors) {
+        auto counters = std::make_shared<AcceptCounters>(acceptors);
+        std::lock_guard<std::mutex> lock(accept_mutex_);
+        accept_counters_[listener] = counters;
+        return counters;
+    }
+
+    std::map<std::string, std::vector<uint64_t>> MetricsManager::get_accept_counts() const {
+        std::map<std::string, std::vector<uint64_t>> result;
+        std::lock_guard<std::mutex> lock(accept_mutex_);
+        for (const auto &[listener, counters]: accept_counters_) {
+            auto &counts = result[listener];
+            counts.reserve(counters->counts.size());
+            for (const auto &count: counters->counts) {
+                counts.push_back(count.load(std::memory_order_relaxed));
+            }
+        }
+        return result;
+    }
+
+    std::shared_ptr<CacheCounters> MetricsManager::register_cache_counters(const std::string &cache) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto &counters = cache_counters_[cache];
+        if (!counters) {
+            counters = std::make_shared<CacheCounters>();
+        }
+        return counters;
+    }
+
+    std::map<std::string, CacheStats> MetricsManager::get_cache_stats() const {
+        std::map<std::string, CacheStats> result;
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        for (const auto &[cache, counters]: cache_counters_) {
+            auto &stats = result[cache];
+            stats.hits = counters->hits.load(std::memory_order_relaxed);
+            stats.misses = counters->misses.load(std::memory_order_relaxed);
+            stats.evictions = counters->evictions.load(std::memory_order_relaxed);
+            stats.expirations = counters->expirations.load(std::memory_order_relaxed);
+            stats.resident_bytes = counters->resident_bytes.load(std::memory_order_relaxed);
+            stats.entries = counters->entries.load(std::memory_order_relaxed);
+            uint64_t lookups = stats.hits + stats.misses;
+            stats.hit_rate = lookups ? static_cast<double>(stats.hits) / static_cast<double>(lookups) : 0;
+        }
+        return result;
+    }
+
+    std::shared_ptr<ToolTimeoutCounters> MetricsManager::register_tool_timeout_counters(const std::string &tool) {
+        std::lock_guard<std::mutex> lock(timeout_mutex_);
+        auto &counters = timeout_counters_[tool];
+        if (!counters) {
+            counters = std::make_shared<ToolTimeoutCounters>();
+        }
+        return counters;
+    }
+
+    std::map<std::string, ToolTimeoutStats> MetricsManager::get_tool_timeout_stats() const {
+        std::map<std::string, ToolTimeoutStats> result;
+        std::lock_guard<std::mutex> lock(timeout_mutex_);
+        for (const auto &[tool, counters]: timeout_counters_) {
+            auto &stats = result[tool];
+            stats.timeouts = counters->timeouts.load(std::memory_order_relaxed);
+            stats.running = counters->running.load(std::memory_order_relaxed);
+            stats.overrun_ms = counters->overrun_ms.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    std::shared_ptr<TenantCounters> MetricsManager::register_tenant_counters(const std::string &tenant) {
+        std::lock_guard<std::mutex> lock(tenant_mutex_);
+        auto &counters = tenant_counters_[tenant];
+        if (!counters) {
+            counters = std::make_shared<TenantCounters>();
+        }
+        return counters;
+    }
+
+    std::map<std::string, TenantStats> MetricsManager::get_tenant_stats() const {
+        std::map<std::string, TenantStats> result;
+        std::lock_guard<std::mutex> lock(tenant_mutex_);
+        for (const auto &[tenant, counters]: tenant_counters_) {
+            auto &stats = result[tenant];
+            stats.running = counters->running.load(std::memory_order_relaxed);
+            stats.queued = counters->queued.load(std::memory_order_relaxed);
+            stats.slots = counters->slots.load(std::memory_order_relaxed);
+            stats.rejected = counters->rejected.load(std::memory_order_relaxed);
+            stats.rate_limited = counters->rate_limited.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    std::shared_ptr<TlsHandshakeCounters> MetricsManager::register_tls_handshake_counters(const std::string &listener) {
+        std::lock_guard<std::mutex> lock(tls_mutex_);
+        auto &counters = tls_counters_[listener];
+        if (!counters) {
+            counters = std::make_shared<TlsHandshakeCounters>();
+        }
+        return counters;
+    }
+
+    std::map<std::string, TlsHandshakeStats> MetricsManager::get_tls_handshake_stats() const {
+        std::map<std::string, TlsHandshakeStats> result;
+        std::lock_guard<std::mutex> lock(tls_mutex_);
+        for (const auto &[listener, counters]: tls_counters_) {
+            auto &stats = result[listener];
+            stats.full = counters->full.load(std::memory_order_relaxed);
+            stats.resumed = counters->resumed.load(std::memory_order_relaxed);
+            stats.failed = counters->failed.load(std::memory_order_relaxed);
+            stats.queued = counters->queued.load(std::memory_order_relaxed);
+            for (const auto &bucket: counters->latency) {
+                stats.latency.push_back(bucket.load(std::memory_order_relaxed));
+            }
+            uint64_t completed = stats.full + stats.resumed;
+            stats.resumption_ratio = completed ? static_cast<double>(stats.resumed) / static_cast<double>(completed) : 0;
+        }
+        return result;
+    }
+
+    std::shared_ptr<ConnectionTimeoutCounters> MetricsManager::register_connection_timeout_counters(const std::string &listener) {
+        std::lock_guard<std::mutex> lock(connection_timeout_mutex_);
+        auto &counters = connection_timeout_counters_[listener];
+        if (!counters) {
+            counters = std::make_shared<ConnectionTimeoutCounters>();
+        }
+        return counters;
+    }
+
+    std::map<std::string, ConnectionTimeoutStats> MetricsManager::get_connection_timeout_stats() const {
+        std::map<std::string, ConnectionTimeoutStats> result;
+        std::lock_guard<std::mutex> lock(connection_timeout_mutex_);
+        for (const auto &[listener, counters]: connection_timeout_counters_) {
+            auto &stats = result[listener];
+            stats.header = counters->header.load(std::memory_order_relaxed);
+            stats.body = counters->body.load(std::memory_order_relaxed);
+            stats.idle = counters->idle.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    void MetricsManager::record_request(const TrackedHttpRequest &request, const PerformanceMetrics &metrics) {
+        auto &stats = route_stats_[index_of(kRoutes, request.target)][index_of(kMethods, request.method)];
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(metrics.end_time - metrics.start_time).count();
+        stats.latency.record(static_cast<uint64_t>(std::max<int64_t>(us, 0)));
+        stats.request_bytes.add(metrics.request_size);
+        stats.response_bytes.add(metrics.response_size);
+    }
+
+    ToolCallStats &MetricsManager::tool_call_stats(std::string_view tool) {
+        {
+            std::shared_lock<std::shared_mutex> lock(tool_stats_mutex_);
+            auto it = tool_stats_.find(tool);
+            if (it != tool_stats_.end()) {
+                return *it->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(tool_stats_mutex_);
+        auto &stats = tool_stats_[std::string(tool)];
+        if (!stats) {
+            stats = std::make_unique<ToolCallStats>();
+        }
+        return *stats;
+    }
+
+    RequestStageStats &MetricsManager::request_stage_stats(std::string_view method, std::string_view tool) {
+        {
+            std::shared_lock<std::shared_mutex> lock(stage_stats_mutex_);
+            if (auto by_method = stage_stats_.find(method); by_method != stage_stats_.end()) {
+                if (auto it = by_method->second.find(tool); it != by_method->second.end()) {
+                    return *it->second;
+                }
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(stage_stats_mutex_);
+        auto by_method = stage_stats_.find(method);
+        if (by_method == stage_stats_.end()) {
+            by_method = stage_stats_.emplace(std::string(method), ToolStageStats{}).first;
+        }
+        auto &stats = by_method->second[std::string(tool)];
+        if (!stats) {
+            stats = std::make_unique<RequestStageStats>();
+        }
+        return *stats;
+    }
+
+    PluginUsageStats &MetricsManager::plugin_usage_stats(std::string_view plugin, std::string_view tool) {
+        {
+            std::shared_lock<std::shared_mutex> lock(plugin_usage_mutex_);
+            if (auto by_plugin = plugin_usage_.find(plugin); by_plugin != plugin_usage_.end()) {
+                if (auto it = by_plugin->second.find(tool); it != by_plugin->second.end()) {
+                    return *it->second;
+                }
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(plugin_usage_mutex_);
+        auto by_plugin = plugin_usage_.find(plugin);
+        if (by_plugin == plugin_usage_.end()) {
+            by_plugin = plugin_usage_.emplace(std::string(plugin), ToolUsageStats{}).first;
+        }
+        auto &stats = by_plugin->second[std::string(tool)];
+        if (!stats) {
+            stats = std::make_unique<PluginUsageStats>();
+        }
+        return *stats;
+    }
+
+    std::string MetricsManager::render_prometheus() const {
+        std::string out;
+        out.reserve(16 * 1024);
+
+        append_header(out, "mcp_http_request_duration_seconds", "histogram", "Time to handle an HTTP request");
+        for (size_t route = 0; route < kRoutes.size(); ++route) {
+            for (size_t method = 0; method < kMethods.size(); ++method) {
+                auto snapshot = route_stats_[route][method].latency.snapshot();
+                if (snapshot.count > 0) {
+                    std::string route_labels = labels({{"route", kRoutes[route]}, {"method", kMethods[method]}});
+                    append_histogram(out, "mcp_http_request_duration_seconds", route_labels, snapshot);
+                }
+            }
+        }
+        for (auto [name, help, field]: {std::tuple{"mcp_http_request_bytes_total", "Bytes of HTTP requests on the wire", &RouteStats::request_bytes},
+                                        std::tuple{"mcp_http_response_bytes_total", "Bytes of HTTP responses", &RouteStats::response_bytes}}) {
+            append_header(out, name, "counter", help);
+            for (size_t route = 0; route < kRoutes.size(); ++route) {
+                for (size_t method = 0; method < kMethods.size(); ++method) {
+                    const auto &stats = route_stats_[route][method];
+                    if (stats.latency.snapshot().count > 0) {
+                        append_sample(out, name, labels({{"route", kRoutes[route]}, {"method", kMethods[method]}}) + "}", (stats.*field).value());
+                    }
+                }
+            }
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> lock(tool_stats_mutex_);
+            append_header(out, "mcp_tool_call_duration_seconds", "histogram", "Time to answer a synchronous tool call");
+            for (const auto &[tool, stats]: tool_stats_) {
+                append_histogram(out, "mcp_tool_call_duration_seconds", labels({{"tool", tool}}), stats->latency.snapshot());
+            }
+            append_header(out, "mcp_tool_call_errors_total", "counter", "Tool calls answered with an error");
+            for (const auto &[tool, stats]: tool_stats_) {
+                append_sample(out, "mcp_tool_call_errors_total", labels({{"tool", tool}}) + "}", stats->errors.value());
+            }
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> lock(stage_stats_mutex_);
+            append_header(out, "mcp_request_stage_duration_seconds", "histogram", "Time sampled JSON-RPC requests spent in each stage");
+            for (const auto &[method, tools]: stage_stats_) {
+                for (const auto &[tool, stats]: tools) {
+                    for (size_t stage = 0; stage < kRequestStages; ++stage) {
+                        auto snapshot = stats->stages[stage].snapshot();
+                        if (snapshot.count > 0) {
+                            std::string stage_labels = labels({{"method", method}, {"tool", tool}, {"stage", stage_name(static_cast<RequestStage>(stage))}});
+                            append_histogram(out, "mcp_request_stage_duration_seconds", stage_labels, snapshot);
+                        }
+                    }
+                }
+            }
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> lock(plugin_usage_mutex_);
+            append_header(out, "mcp_plugin_cpu_seconds_total", "counter", "Thread CPU time of a plugin tool's calls and stream pulls");
+            for (const auto &[plugin, tools]: plugin_usage_) {
+                for (const auto &[tool, stats]: tools) {
+                    append_sample(out, "mcp_plugin_cpu_seconds_total", labels({{"plugin", plugin}, {"tool", tool}}) + "}",
+                                  static_cast<double>(stats->cpu_ns.value()) / 1e9);
+                }
+            }
+            append_header(out, "mcp_plugin_allocated_bytes_total", "counter", "Bytes a plugin tool took through the host allocator hooks");
+            for (const auto &[plugin, tools]: plugin_usage_) {
+                for (const auto &[tool, stats]: tools) {
+                    append_sample(out, "mcp_plugin_allocated_bytes_total", labels({{"plugin", plugin}, {"tool", tool}}) + "}",
+                                  stats->allocated_bytes.value());
+                }
+            }
+        }
+
+        append_header(out, "mcp_live_objects", "gauge", "Sessions, kept streams and running plugin calls");
+        for (auto [kind, gauge]: {std::pair{"tcp_session", &runtime_gauges_.tcp_sessions},
+                                  std::pair{"ssl_session", &runtime_gauges_.ssl_sessions},
+                                  std::pair{"unix_session", &runtime_gauges_.unix_sessions},
+                                  std::pair{"stream_generator", &runtime_gauges_.stream_generators},
+                                  std::pair{"plugin_call", &runtime_gauges_.plugin_calls}}) {
+            append_sample(out, "mcp_live_objects", labels({{"kind", kind}}) + "}", gauge->load(std::memory_order_relaxed));
+        }
+
+        // Pools that probe their io_contexts' scheduling lag
+        auto pools = AsioIOServicePool::Snapshot();
+        pools.erase(std::remove_if(pools.begin(), pools.end(), [](const auto &pool) { return !pool.lag_probed; }), pools.end());
+        if (!pools.empty()) {
+            append_header(out, "mcp_io_lag_seconds", "histogram", "How late the lag probes of a pool's io_contexts ran");
+            for (const auto &pool: pools) {
+                append_histogram(out, "mcp_io_lag_seconds", labels({{"pool", pool.name}}), pool.lag);
+            }
+            append_header(out, "mcp_io_lag_smoothed_seconds", "gauge", "Smoothed scheduling lag of each io_context, what load shedding compares");
+            for (const auto &pool: pools) {
+                for (size_t i = 0; i < pool.contexts.size(); ++i) {
+                    std::string index = std::to_string(i);
+                    append_sample(out, "mcp_io_lag_smoothed_seconds", labels({{"pool", pool.name}, {"context", index}}) + "}",
+                                  static_cast<double>(pool.contexts[i].lag_us) / 1e6);
+                }
+            }
+            append_header(out, "mcp_overload_shed_total", "counter", "Requests answered 503 because their io_context lagged");
+            for (const auto &pool: pools) {
+                uint64_t shed = 0;
+                for (const auto &context: pool.contexts) {
+                    shed += context.shed;
+                }
+                append_sample(out, "mcp_overload_shed_total", labels({{"pool", pool.name}}) + "}", shed);
+            }
+        }
+        bool header_written = false;
+        for (const auto &pool: AsioIOServicePool::Snapshot()) {
+            if (!pool.busy_poll) {
+                continue;
+            }
+            if (!header_written) {
+                append_header(out, "mcp_io_busy_poll_seconds_total", "counter", "Time io threads spent busy polling with nothing to run");
+                header_written = true;
+            }
+            uint64_t spin_us = 0;
+            for (const auto &context: pool.contexts) {
+                spin_us += context.spin_us;
+            }
+            append_sample(out, "mcp_io_busy_poll_seconds_total", labels({{"pool", pool.name}}) + "}", static_cast<double>(spin_us) / 1e6);
+        }
+
+        auto tool_pool = core::ToolThreadPool::stats();
+        append_header(out, "mcp_tool_pool_threads", "gauge", "Tool pool workers, and the bounds it resizes within");
+        for (auto [bound, value]: {std::pair{"current", tool_pool.threads},
+                                   std::pair{"min", tool_pool.min_threads},
+                                   std::pair{"max", tool_pool.max_threads}}) {
+            append_sample(out, "mcp_tool_pool_threads", labels({{"bound", bound}}) + "}", value);
+        }
+        append_header(out, "mcp_tool_pool_resizes_total", "counter", "Tool pool workers added because the others blocked, and retired afterwards");
+        append_sample(out, "mcp_tool_pool_resizes_total", "{direction=\"grow\"}", tool_pool.grown);
+        append_sample(out, "mcp_tool_pool_resizes_total", "{direction=\"shrink\"}", tool_pool.shrunk);
+        append_header(out, "mcp_tool_pool_cpu_ratio", "gauge", "CPU time over wall time of the tool pool workers in the last resize interval");
+        append_sample(out, "mcp_tool_pool_cpu_ratio", "", tool_pool.cpu_ratio);
+
+        const auto &exporter = SpanExporter::instance();
+        append_header(out, "mcp_trace_spans_total", "counter", "Spans handed to the OTLP exporter by result");
+        append_sample(out, "mcp_trace_spans_total", "{result=\"exported\"}", exporter.exported());
+        append_sample(out, "mcp_trace_spans_total", "{result=\"dropped\"}", exporter.dropped());
+
+        append_header(out, "mcp_accepted_connections_total", "counter", "Connections accepted per accept loop");
+        for (const auto &[listener, counts]: get_accept_counts()) {
+            for (size_t i = 0; i < counts.size(); ++i) {
+                std::string index = std::to_string(i);
+                append_sample(out, "mcp_accepted_connections_total", labels({{"listener", listener}, {"acceptor", index}}) + "}", counts[i]);
+            }
+        }
+
+        append_header(out, "mcp_connection_timeouts_total", "counter", "Connections closed because the client stalled");
+        for (const auto &[listener, stats]: get_connection_timeout_stats()) {
+            for (auto [phase, value]: {std::pair{"header", stats.header}, std::pair{"body", stats.body}, std::pair{"idle", stats.idle}}) {
+                append_sample(out, "mcp_connection_timeouts_total", labels({{"listener", listener}, {"phase", phase}}) + "}", value);
+            }
+        }
+
+        auto caches = get_cache_stats();
+        append_header(out, "mcp_cache_lookups_total", "counter", "Cache lookups by result");
+        for (const auto &[cache, stats]: caches) {
+            append_sample(out, "mcp_cache_lookups_total", labels({{"cache", cache}, {"result", "hit"}}) + "}", stats.hits);
+            append_sample(out, "mcp_cache_lookups_total", labels({{"cache", cache}, {"result", "miss"}}) + "}", stats.misses);
+        }
+        append_header(out, "mcp_cache_removals_total", "counter", "Cache entries dropped by reason");
+        for (const auto &[cache, stats]: caches) {
+            append_sample(out, "mcp_cache_removals_total", labels({{"cache", cache}, {"reason", "eviction"}}) + "}", stats.evictions);
+            append_sample(out, "mcp_cache_removals_total", labels({{"cache", cache}, {"reason", "expiration"}}) + "}", stats.expirations);
+        }
+        append_header(out, "mcp_cache_resident_bytes", "gauge", "Bytes held by a cache");
+        for (const auto &[cache, stats]: caches) {
+            append_sample(out, "mcp_cache_resident_bytes", labels({{"cache", cache}}) + "}", stats.resident_bytes);
+        }
+        append_header(out, "mcp_cache_entries", "gauge", "Entries held by a cache");
+        for (const auto &[cache, stats]: caches) {
+            append_sample(out, "mcp_cache_entries", labels({{"cache", cache}}) + "}", stats.entries);
+        }
+
+        auto timeouts = get_tool_timeout_stats();
+        append_header(out, "mcp_tool_timeouts_total", "counter", "Tool calls answered with a timeout error");
+        for (const auto &[tool, stats]: timeouts) {
+            append_sample(out, "mcp_tool_timeouts_total", labels({{"tool", tool}}) + "}", stats.timeouts);
+        }
+        append_header(out, "mcp_tool_timed_out_running", "gauge", "Timed-out tool calls whose plugin has not returned yet");
+        for (const auto &[tool, stats]: timeouts) {
+            append_sample(out, "mcp_tool_timed_out_running", labels({{"tool", tool}}) + "}", stats.running);
+        }
+
+        auto tenants = get_tenant_stats();
+        append_header(out, "mcp_tenant_tool_calls", "gauge", "Tool calls of a named tenant running on the tool pool or waiting for their turn");
+        for (const auto &[tenant, stats]: tenants) {
+            append_sample(out, "mcp_tenant_tool_calls", labels({{"tenant", tenant}, {"state", "running"}}) + "}", stats.running);
+            append_sample(out, "mcp_tenant_tool_calls", labels({{"tenant", tenant}, {"state", "queued"}}) + "}", stats.queued);
+        }
+        append_header(out, "mcp_tenant_tool_slots", "gauge", "Tool calls a named tenant may have on the tool pool at once, 0 = no cap");
+        for (const auto &[tenant, stats]: tenants) {
+            append_sample(out, "mcp_tenant_tool_slots", labels({{"tenant", tenant}}) + "}", stats.slots);
+        }
+        append_header(out, "mcp_tenant_rejections_total", "counter", "Requests of a named tenant turned away by reason");
+        for (const auto &[tenant, stats]: tenants) {
+            append_sample(out, "mcp_tenant_rejections_total", labels({{"tenant", tenant}, {"reason", "tool_queue"}}) + "}", stats.rejected);
+            append_sample(out, "mcp_tenant_rejections_total", labels({{"tenant", tenant}, {"reason", "rate_limit"}}) + "}", stats.rate_limited);
+        }
+
+        auto handshakes = get_tls_handshake_stats();
+        append_header(out, "mcp_tls_handshakes_total", "counter", "Finished TLS handshakes by result");
+        for (const auto &[listener, stats]: handshakes) {
+            for (auto [result, value]: {std::pair{"full", stats.full}, std::pair{"resumed", stats.resumed}, std::pair{"failed", stats.failed}}) {
+                append_sample(out, "mcp_tls_handshakes_total", labels({{"listener", listener}, {"result", result}}) + "}", value);
+            }
+        }
+        append_header(out, "mcp_tls_handshakes_queued", "gauge", "Connections waiting for the handshake pool");
+        for (const auto &[listener, stats]: handshakes) {
+            append_sample(out, "mcp_tls_handshakes_queued", labels({{"listener", listener}}) + "}", stats.queued);
+        }
+        return out;
+    }
+
 }// namespace mcp::metrics
\ No newline at end of file
@@ -1,12 +1,217 @@
 #pragma once
 
+#include "histogram.h"
 #include "performance_metrics.h"
+#include "request_trace.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace mcp::metrics {
 
+    /**
+     * @brief Accepted connection counters of one listener, one slot per accept loop.
+     */
+    struct AcceptCounters {
+        explicit AcceptCounters(size_t acceptors) : counts(acceptors) {}
+
+        /**
+         * @brief Count an accepted connection.
+         * @param index Accept loop index
+         */
+        void increment(size_t index) { counts[index].fetch_add(1, std::memory_order_relaxed); }
+
+        std::vector<std::atomic<uint64_t>> counts;///< Accepted connections per accept loop
+    };
+
+    /**
+     * @brief Counters of one cache, updated by the cache and read by monitoring.
+     */
+    struct CacheCounters {
+        std::atomic<uint64_t> hits{0};         ///< Lookups that found the entry
+        std::atomic<uint64_t> misses{0};       ///< Lookups that found nothing
+        std::atomic<uint64_t> evictions{0};    ///< Entries dropped to stay within a limit
+        std::atomic<uint64_t> expirations{0};  ///< Entries dropped because their TTL ran out
+        std::atomic<int64_t> resident_bytes{0};///< Bytes currently held
+        std::atomic<uint64_t> entries{0};      ///< Entries currently held
+    };
+
+    /**
+     * @brief Snapshot of CacheCounters.
+     */
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        int64_t resident_bytes = 0;
+        uint64_t entries = 0;
+        double hit_rate = 0;///< hits / (hits + misses), 0 before the first lookup
+    };
+
+    /**
+     * @brief Missed deadlines of one tool, updated by the tool executor and read by monitoring.
+     */
+    struct ToolTimeoutCounters {
+        std::atomic<uint64_t> timeouts{0};  ///< Calls answered with a timeout error
+        std::atomic<int64_t> running{0};    ///< Timed-out calls whose plugin has not returned yet
+        std::atomic<uint64_t> overrun_ms{0};///< Time timed-out calls ran past their deadline, once they returned
+    };
+
+    /**
+     * @brief Snapshot of ToolTimeoutCounters.
+     */
+    struct ToolTimeoutStats {
+        uint64_t timeouts = 0;
+        int64_t running = 0;
+        uint64_t overrun_ms = 0;
+    };
+
+    /**
+     * @brief TLS handshakes of one listener, updated by its sessions and read by monitoring.
+     */
+    struct TlsHandshakeCounters {
+        /// Upper bounds of the latency buckets in microseconds, a last bucket counts the slower ones
+        static constexpr std::array<uint64_t, 10> kLatencyBoundsUs = {500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000, 1000000};
+
+        std::atomic<uint64_t> full{0};   ///< Handshakes that negotiated a new session
+        std::atomic<uint64_t> resumed{0};///< Handshakes that resumed a cached session or a ticket
+        std::atomic<uint64_t> failed{0}; ///< Handshakes that did not complete
+        std::atomic<int64_t> queued{0};  ///< Connections handed to the handshake pool whose handshake has not finished
+        std::array<std::atomic<uint64_t>, kLatencyBoundsUs.size() + 1> latency{};///< Completed handshakes per latency bucket
+
+        /**
+         * @brief Count a completed handshake in its latency bucket.
+         * @param us Time from accepting the connection to the finished handshake, in microseconds
+         */
+        void record_latency(uint64_t us) {
+            size_t bucket = 0;
+            while (bucket < kLatencyBoundsUs.size() && us > kLatencyBoundsUs[bucket]) {
+                ++bucket;
+            }
+            latency[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Snapshot of TlsHandshakeCounters.
+     */
+    struct TlsHandshakeStats {
+        uint64_t full = 0;
+        uint64_t resumed = 0;
+        uint64_t failed = 0;
+        int64_t queued = 0;
+        double resumption_ratio = 0;  ///< resumed / (full + resumed), 0 before the first handshake
+        std::vector<uint64_t> latency;///< Handshakes per bucket of TlsHandshakeCounters::kLatencyBoundsUs
+    };
+
+    /**
+     * @brief Connections of one listener closed for stalling, updated by its sessions and read by monitoring.
+     */
+    struct ConnectionTimeoutCounters {
+        std::atomic<uint64_t> header{0};///< Closed because a request's headers did not arrive in time
+        std::atomic<uint64_t> body{0};  ///< Closed because a request body did not arrive in time
+        std::atomic<uint64_t> idle{0};  ///< Keep-alive connections closed after idling between requests
+    };
+
+    /**
+     * @brief Snapshot of ConnectionTimeoutCounters.
+     */
+    struct ConnectionTimeoutStats {
+        uint64_t header = 0;
+        uint64_t body = 0;
+        uint64_t idle = 0;
+    };
+
+    /**
+     * @brief Usage of one named tenant, updated by the fair scheduler and the tenant rate limit.
+     */
+    struct TenantCounters {
+        std::atomic<int64_t> running{0};      ///< Tool calls on the tool pool
+        std::atomic<int64_t> queued{0};       ///< Tool calls waiting for their turn
+        std::atomic<int64_t> slots{0};        ///< Tool calls the tenant may have on the pool at once, 0 = no cap
+        std::atomic<uint64_t> rejected{0};    ///< Tool calls turned away because the tenant's queue was full or they waited too long
+        std::atomic<uint64_t> rate_limited{0};///< Requests over the tenant's rate limit
+    };
+
+    /**
+     * @brief Snapshot of TenantCounters.
+     */
+    struct TenantStats {
+        int64_t running = 0;
+        int64_t queued = 0;
+        int64_t slots = 0;
+        uint64_t rejected = 0;
+        uint64_t rate_limited = 0;
+    };
+
+    /**
+     * @brief Objects alive right now, kept by the code that creates and destroys them.
+     * Relaxed counters, so /admin/stats reads them without walking any structure or taking its lock.
+     */
+    struct RuntimeGauges {
+        std::atomic<int64_t> tcp_sessions{0};     ///< Plain HTTP connections
+        std::atomic<int64_t> ssl_sessions{0};     ///< HTTPS connections
+        std::atomic<int64_t> unix_sessions{0};    ///< Unix socket connections
+        std::atomic<int64_t> stream_generators{0};///< Streams tools/call keeps for reconnection
+        std::atomic<int64_t> plugin_calls{0};     ///< Plugin tool calls running
+    };
+
+    /**
+     * @brief Counts one in a gauge for as long as it lives.
+     */
+    class GaugeHold {
+    public:
+        explicit GaugeHold(std::atomic<int64_t> &gauge) : gauge_(gauge) { gauge_.fetch_add(1, std::memory_order_relaxed); }
+        ~GaugeHold() { gauge_.fetch_sub(1, std::memory_order_relaxed); }
+
+        GaugeHold(const GaugeHold &) = delete;
+        GaugeHold &operator=(const GaugeHold &) = delete;
+
+    private:
+        std::atomic<int64_t> &gauge_;
+    };
+
+    /**
+     * @brief Built-in aggregates of the HTTP requests of one route and method.
+     */
+    struct RouteStats {
+        LatencyHistogram latency;
+        ShardedCounter request_bytes; ///< Bytes of the requests on the wire
+        ShardedCounter response_bytes;///< Bytes of the responses
+    };
+
+    /**
+     * @brief Built-in aggregates of the calls of one tool.
+     */
+    struct ToolCallStats {
+        LatencyHistogram latency;
+        ShardedCounter errors;///< Calls answered with an error, timeouts included
+    };
+
+    /**
+     * @brief Resources the calls of one plugin tool used, see business::PluginUsage.
+     */
+    struct PluginUsageStats {
+        ShardedCounter cpu_ns;         ///< Thread CPU time of its calls and stream pulls
+        ShardedCounter allocated_bytes;///< Bytes it took through the host allocator hooks
+    };
+
+    /**
+     * @brief Stage latencies of the sampled requests of one method and tool.
+     */
+    struct RequestStageStats {
+        std::array<LatencyHistogram, kRequestStages> stages;///< Indexed by RequestStage
+    };
+
     /**
      * @brief Metrics manager for handling performance metrics callbacks.
      */
@@ -52,6 +257,7 @@ namespace mcp::metrics {
         void report_performance(const TrackedHttpRequest &request,
                                 const PerformanceMetrics &metrics,
                                 const std::string &session_id) {
+            record_request(request, metrics);
             if (performance_callback_) {
                 performance_callback_(request, metrics, session_id);
             }
@@ -68,6 +274,129 @@ namespace mcp::metrics {
             }
         }
 
+        /**
+         * @brief Create (or replace) the accept counters of a listener.
+         * @param listener Listener name, e.g. "http" or "https"
+         * @param acceptors Number of accept loops of the listener
+         * @return Counters the accept loops increment
+         */
+        std::shared_ptr<AcceptCounters> register_accept_counters(const std::string &listener, size_t acceptors);
+
+        /**
+         * @brief Snapshot of the accepted connection counts of every listener.
+         * @return Listener name mapped to the count of each accept loop
+         */
+        std::map<std::string, std::vector<uint64_t>> get_accept_counts() const;
+
+        /**
+         * @brief Get the counters of a cache, creating them on first use.
+         * @param cache Cache name, e.g. "mcp_cache"
+         * @return Counters the cache updates
+         */
+        std::shared_ptr<CacheCounters> register_cache_counters(const std::string &cache);
+
+        /**
+         * @brief Snapshot of the counters of every cache.
+         * @return Cache name mapped to its statistics
+         */
+        std::map<std::string, CacheStats> get_cache_stats() const;
+
+        /**
+         * @brief Get the timeout counters of a tool, creating them on first use.
+         * @param tool Tool name
+         * @return Counters the tool executor updates
+         */
+        std::shared_ptr<ToolTimeoutCounters> register_tool_timeout_counters(const std::string &tool);
+
+        /**
+         * @brief Snapshot of the timeout counters of every tool that has a deadline.
+         * @return Tool name mapped to its statistics
+         */
+        std::map<std::string, ToolTimeoutStats> get_tool_timeout_stats() const;
+
+        /**
+         * @brief Get the handshake counters of a TLS listener, creating them on first use.
+         * @param listener Listener name, e.g. "https"
+         * @return Counters the listener's sessions update
+         */
+        std::shared_ptr<TlsHandshakeCounters> register_tls_handshake_counters(const std::string &listener);
+
+        /**
+         * @brief Snapshot of the handshake counters of every TLS listener.
+         * @return Listener name mapped to its statistics
+         */
+        std::map<std::string, TlsHandshakeStats> get_tls_handshake_stats() const;
+
+        /**
+         * @brief Get the connection timeout counters of a listener, creating them on first use.
+         * @param listener Listener name, e.g. "http", "https" or "unix"
+         * @return Counters the listener's sessions update
+         */
+        std::shared_ptr<ConnectionTimeoutCounters> register_connection_timeout_counters(const std::string &listener);
+
+        /**
+         * @brief Snapshot of the connections every listener closed for stalling.
+         * @return Listener name mapped to its statistics
+         */
+        std::map<std::string, ConnectionTimeoutStats> get_connection_timeout_stats() const;
+
+        /**
+         * @brief Get the usage counters of a named tenant, creating them on first use.
+         * @param tenant Tenant name, as configured
+         * @return Counters the fair scheduler and the tenant rate limit update
+         */
+        std::shared_ptr<TenantCounters> register_tenant_counters(const std::string &tenant);
+
+        /**
+         * @brief Snapshot of the usage of every named tenant.
+         * @return Tenant name mapped to its statistics
+         */
+        std::map<std::string, TenantStats> get_tenant_stats() const;
+
+        /**
+         * @brief Add a request to the built-in aggregates of its route; called by report_performance().
+         * @param request Request that was handled
+         * @param metrics Its timing and sizes
+         */
+        void record_request(const TrackedHttpRequest &request, const PerformanceMetrics &metrics);
+
+        /**
+         * @brief Get the aggregates of a tool, creating them on first use.
+         * Look the stats up once per call and record into them; they live as long as the manager.
+         * @param tool Tool name
+         * @return Stats of the tool
+         */
+        ToolCallStats &tool_call_stats(std::string_view tool);
+
+        /**
+         * @brief Get the stage aggregates of a method and tool, creating them on first use.
+         * Only methods the router handles and tools that exist get here, which bounds the labels.
+         * @param method JSON-RPC method
+         * @param tool Tool name, empty for other methods
+         * @return Stats of the method and tool
+         */
+        RequestStageStats &request_stage_stats(std::string_view method, std::string_view tool);
+
+        /**
+         * @brief Get the resource usage of a plugin's tool, creating it on first use.
+         * @param plugin Plugin file name
+         * @param tool Tool name
+         * @return Usage of the tool
+         */
+        PluginUsageStats &plugin_usage_stats(std::string_view plugin, std::string_view tool);
+
+        /**
+         * @brief Live object counts, updated in place by their owners.
+         */
+        RuntimeGauges &runtime_gauges() { return runtime_gauges_; }
+        const RuntimeGauges &runtime_gauges() const { return runtime_gauges_; }
+
+        /**
+         * @brief Render every built-in metric in the Prometheus text exposition format (version 0.0.4).
+         * @return Exposition text
+         */
+        std::string render_prometheus() const;
+
     private:
         /**
          * @brief Private constructor for singleton pattern.
@@ -76,6 +405,41 @@ namespace mcp::metrics {
 
         PerformanceCallback performance_callback_;
         ErrorCallback error_callback_;
+
+        mutable std::mutex accept_mutex_;
+        std::map<std::string, std::shared_ptr<AcceptCounters>> accept_counters_;
+
+        mutable std::mutex cache_mutex_;
+        std::map<std::string, std::shared_ptr<CacheCounters>> cache_counters_;
+
+        mutable std::mutex timeout_mutex_;
+        std::map<std::string, std::shared_ptr<ToolTimeoutCounters>> timeout_counters_;
+
+        mutable std::mutex tls_mutex_;
+        std::map<std::string, std::shared_ptr<TlsHandshakeCounters>> tls_counters_;
+
+        mutable std::mutex tenant_mutex_;
+        std::map<std::string, std::shared_ptr<TenantCounters>> tenant_counters_;
+
+        mutable std::mutex connection_timeout_mutex_;
+        std::map<std::string, std::shared_ptr<ConnectionTimeoutCounters>> connection_timeout_counters_;
+
+        static constexpr std::array<std::string_view, 4> kRoutes = {"/mcp", "/tools/list", "/tools/call", "other"};
+        static constexpr std::array<std::string_view, 4> kMethods = {"GET", "POST", "DELETE", "other"};
+        std::array<std::array<RouteStats, kMethods.size()>, kRoutes.size()> route_stats_;///< Indexed by route, then method
+
+        mutable std::shared_mutex tool_stats_mutex_;
+        std::map<std::string, std::unique_ptr<ToolCallStats>, std::less<>> tool_stats_;
+
+        using ToolStageStats = std::map<std::string, std::unique_ptr<RequestStageStats>, std::less<>>;
+        mutable std::shared_mutex stage_stats_mutex_;
+        std::map<std::string, ToolStageStats, std::less<>> stage_stats_;///< By method, then tool
+
+        using ToolUsageStats = std::map<std::string, std::unique_ptr<PluginUsageStats>, std::less<>>;
+        mutable std::shared_mutex plugin_usage_mutex_;
+        std::map<std::string, ToolUsageStats, std::less<>> plugin_usage_;///< By plugin, then tool
+
+        RuntimeGauges runtime_gauges_;
     };
 
 }// namespace mcp::metrics
\ No newline at end of file
@@ -0,0 +1,483 @@
+#include "metrics_push.h"
+#include "core/logger.h"
+#include "metrics_manager.h"
+#include "tracing.h"
+#include <algorithm>
+#include <asio.hpp>
+#include <charconv>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace mcp::metrics {
+
+    namespace {
+        MetricsPushOptions &options_storage() {
+            static MetricsPushOptions options;
+            return options;
+        }
+
+        constexpr size_t kMaxDatagram = 1432;///< Fits one Ethernet frame with IPv6 and UDP headers
+
+        void append_number(std::string &out, double value) {
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        /**
+         * @brief Parse the labels of a sample, "{name="value",...}", advancing past them.
+         */
+        bool parse_labels(std::string_view &line, std::vector<std::pair<std::string, std::string>> &labels) {
+            line.remove_prefix(1);
+            while (!line.empty() && line.front() != '}') {
+                auto equals = line.find("=\"");
+                if (equals == std::string_view::npos) {
+                    return false;
+                }
+                std::string name(line.substr(0, equals));
+                line.remove_prefix(equals + 2);
+                std::string value;
+                while (!line.empty() && line.front() != '"') {
+                    if (line.front() == '\\' && line.size() > 1) {
+                        line.remove_prefix(1);
+                        value += line.front() == 'n' ? '\n' : line.front();
+                    } else {
+                        value += line.front();
+                    }
+                    line.remove_prefix(1);
+                }
+                if (line.empty()) {
+                    return false;
+                }
+                line.remove_prefix(1);
+                if (!line.empty() && line.front() == ',') {
+                    line.remove_prefix(1);
+                }
+                labels.emplace_back(std::move(name), std::move(value));
+            }
+            if (line.empty()) {
+                return false;
+            }
+            line.remove_prefix(1);
+            return true;
+        }
+
+        /**
+         * @brief Key of a sample among those of one push: its name and labels.
+         */
+        std::string sample_key(const MetricSample &sample, std::string_view skip_label = {}) {
+            std::string key = sample.name;
+            for (const auto &[name, value]: sample.labels) {
+                if (name != skip_label) {
+                    key += '\x1f';
+                    key += name;
+                    key += '=';
+                    key += value;
+                }
+            }
+            return key;
+        }
+
+        /**
+         * @brief StatsD over UDP, with DogStatsD tags.
+         */
+        class StatsdExporter : public MetricsPushExporter {
+        public:
+            StatsdExporter(std::string endpoint, std::string prefix)
+                : endpoint_(std::move(endpoint)), prefix_(std::move(prefix)), socket_(io_) {}
+
+            std::string_view name() const override { return "statsd"; }
+
+            std::vector<std::string> encode(const std::vector<MetricSample> &samples, uint64_t) override {
+                std::vector<std::string> datagrams;
+                std::string datagram;
+                for (const auto &sample: samples) {
+                    bool histogram = sample.type == "histogram";
+                    if (histogram && !sample.name.ends_with("_count") && !sample.name.ends_with("_sum")) {
+                        continue;// StatsD has no buckets
+                    }
+                    double value = sample.value;
+                    if (sample.type == "counter" || histogram) {
+                        // Counters go out as what they grew by; one that went down was restarted
+                        double &last = last_[sample_key(sample)];
+                        double delta = value >= last ? value - last : value;
+                        last = value;
+                        if (delta == 0) {
+                            continue;
+                        }
+                        value = delta;
+                    }
+
+                    std::string line = prefix_ + sample.name + ':';
+                    append_number(line, value);
+                    line += sample.type == "gauge" ? "|g" : "|c";
+                    for (size_t i = 0; i < sample.labels.size(); ++i) {
+                        line += i == 0 ? "|#" : ",";
+                        line += tag(sample.labels[i].first);
+                        line += ':';
+                        line += tag(sample.labels[i].second);
+                    }
+                    if (!datagram.empty() && datagram.size() + 1 + line.size() > kMaxDatagram) {
+                        datagrams.push_back(std::move(datagram));
+                        datagram.clear();
+                    }
+                    datagram += datagram.empty() ? "" : "\n";
+                    datagram += line;
+                }
+                if (!datagram.empty()) {
+                    datagrams.push_back(std::move(datagram));
+                }
+                return datagrams;
+            }
+
+            bool send(const std::string &payload) override {
+                asio::error_code ec;
+                if (!target_) {
+                    auto colon = endpoint_.rfind(':');
+                    if (colon == std::string::npos) {
+                        return false;
+                    }
+                    std::string host = endpoint_.substr(0, colon);
+                    if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+                        host = host.substr(1, host.size() - 2);
+                    }
+                    asio::ip::udp::resolver resolver(io_);
+                    auto results = resolver.resolve(host, endpoint_.substr(colon + 1), ec);
+                    if (ec || results.empty()) {
+                        MCP_WARN("Pushing metrics to StatsD {} failed: {}", endpoint_, ec ? ec.message() : "no address");
+                        return false;
+                    }
+                    target_ = results.begin()->endpoint();
+                    socket_.open(target_->protocol(), ec);
+                }
+                socket_.send_to(asio::buffer(payload), *target_, 0, ec);
+                if (ec) {
+                    // Resolved again on the next push, the server may have moved
+                    target_.reset();
+                    socket_.close(ec);
+                    return false;
+                }
+                return true;
+            }
+
+        private:
+            /**
+             * @brief A label name or value as a tag, without the characters that delimit tags.
+             */
+            static std::string tag(std::string_view text) {
+                std::string out(text);
+                std::replace_if(out.begin(), out.end(), [](char c) { return c == ',' || c == '|' || c == ':' || c == '#' || c == '\n'; }, '_');
+                return out;
+            }
+
+            std::string endpoint_;
+            std::string prefix_;
+            asio::io_context io_;
+            asio::ip::udp::socket socket_;
+            std::optional<asio::ip::udp::endpoint> target_;
+            std::unordered_map<std::string, double> last_;///< Counter values of the last push
+        };
+
+        /**
+         * @brief OTLP metrics over HTTP, in OTLP JSON.
+         */
+        class OtlpMetricsExporter : public MetricsPushExporter {
+        public:
+            OtlpMetricsExporter(HttpEndpoint endpoint, std::string service_name)
+                : endpoint_(std::move(endpoint)), service_name_(std::move(service_name)),
+                  start_unix_ns_(unix_nanos(std::chrono::steady_clock::now())) {}
+
+            std::string_view name() const override { return "otlp"; }
+
+            std::vector<std::string> encode(const std::vector<MetricSample> &samples, uint64_t time_unix_ns) override {
+                std::string times = R"("startTimeUnixNano":")" + std::to_string(start_unix_ns_) + R"(","timeUnixNano":")" +
+                                    std::to_string(time_unix_ns) + '"';
+                std::string out;
+                out.reserve(samples.size() * 160);
+                out += R"({"resourceMetrics":[{"resource":{"attributes":[{"key":"service.name","value":{"stringValue":)";
+                append_json_string(out, service_name_);
+                out += R"(}}]},"scopeMetrics":[{"scope":{"name":"mcp-server"},"metrics":[)";
+
+                bool first_metric = true;
+                for (size_t begin = 0; begin < samples.size();) {
+                    size_t end = begin;
+                    while (end < samples.size() && samples[end].family == samples[begin].family) {
+                        ++end;
+                    }
+                    const std::string &type = samples[begin].type;
+                    out += first_metric ? "" : ",";
+                    first_metric = false;
+                    out += R"({"name":)";
+                    append_json_string(out, samples[begin].family);
+                    if (type == "histogram") {
+                        out += R"(,"histogram":{"aggregationTemporality":2,"dataPoints":[)";
+                        append_histograms(out, samples, begin, end, times);
+                    } else {
+                        out += type == "counter" ? R"(,"sum":{"aggregationTemporality":2,"isMonotonic":true,"dataPoints":[)"
+                                                 : R"(,"gauge":{"dataPoints":[)";
+                        for (size_t i = begin; i < end; ++i) {
+                            out += i == begin ? "{" : ",{";
+                            append_attributes(out, samples[i].labels, {});
+                            out += ',' + times + R"(,"asDouble":)";
+                            append_number(out, samples[i].value);
+                            out += '}';
+                        }
+                    }
+                    out += "]}}";
+                    begin = end;
+                }
+                out += "]}]}]}";
+                return {std::move(out)};
+            }
+
+            bool send(const std::string &payload) override { return endpoint_.post_json(payload, "metrics"); }
+
+        private:
+            struct Histogram {
+                const MetricSample *first = nullptr;///< Labels come from here, without le
+                std::vector<double> bounds;
+                std::vector<uint64_t> cumulative;
+                double sum = 0;
+                uint64_t count = 0;
+            };
+
+            static void append_attributes(std::string &out, const std::vector<std::pair<std::string, std::string>> &labels, std::string_view skip) {
+                out += R"("attributes":[)";
+                bool first = true;
+                for (const auto &[name, value]: labels) {
+                    if (name == skip) {
+                        continue;
+                    }
+                    out += first ? "" : ",";
+                    first = false;
+                    out += R"({"key":)";
+                    append_json_string(out, name);
+                    out += R"(,"value":{"stringValue":)";
+                    append_json_string(out, value);
+                    out += "}}";
+                }
+                out += ']';
+            }
+
+            /**
+             * @brief Fold the _bucket, _sum and _count samples of one histogram family into data points.
+             */
+            static void append_histograms(std::string &out, const std::vector<MetricSample> &samples, size_t begin, size_t end, const std::string &times) {
+                const std::string &family = samples[begin].family;
+                std::map<std::string, Histogram> series;
+                std::vector<Histogram *> order;
+                for (size_t i = begin; i < end; ++i) {
+                    const auto &sample = samples[i];
+                    std::string_view suffix = std::string_view(sample.name).substr(std::min(family.size(), sample.name.size()));
+                    MetricSample unsuffixed{family, family, sample.type, sample.labels, 0};
+                    auto [it, inserted] = series.try_emplace(sample_key(unsuffixed, "le"));
+                    Histogram &histogram = it->second;
+                    if (inserted) {
+                        histogram.first = &sample;
+                        order.push_back(&histogram);
+                    }
+                    if (suffix == "_bucket") {
+                        auto le = std::find_if(sample.labels.begin(), sample.labels.end(), [](const auto &label) { return label.first == "le"; });
+                        if (le != sample.labels.end() && le->second != "+Inf") {
+                            histogram.bounds.push_back(std::strtod(le->second.c_str(), nullptr));
+                        }
+                        histogram.cumulative.push_back(static_cast<uint64_t>(sample.value));
+                    } else if (suffix == "_sum") {
+                        histogram.sum = sample.value;
+                    } else if (suffix == "_count") {
+                        histogram.count = static_cast<uint64_t>(sample.value);
+                    }
+                }
+
+                for (size_t i = 0; i < order.size(); ++i) {
+                    const Histogram &histogram = *order[i];
+                    out += i == 0 ? "{" : ",{";
+                    append_attributes(out, histogram.first->labels, "le");
+                    out += ',' + times + R"(,"count":")" + std::to_string(histogram.count) + R"(","sum":)";
+                    append_number(out, histogram.sum);
+                    // OTLP counts each bucket on its own, the exposition's buckets are cumulative
+                    out += R"(,"bucketCounts":[)";
+                    uint64_t previous = 0;
+                    for (size_t b = 0; b < histogram.cumulative.size(); ++b) {
+                        out += b == 0 ? "\"" : ",\"";
+                        out += std::to_string(histogram.cumulative[b] - std::min(previous, histogram.cumulative[b]));
+                        out += '"';
+                        previous = histogram.cumulative[b];
+                    }
+                    out += R"(],"explicitBounds":[)";
+                    for (size_t b = 0; b < histogram.bounds.size(); ++b) {
+                        out += b == 0 ? "" : ",";
+                        append_number(out, histogram.bounds[b]);
+                    }
+                    out += "]}";
+                }
+            }
+
+            HttpEndpoint endpoint_;
+            std::string service_name_;
+            uint64_t start_unix_ns_;
+        };
+    }// namespace
+
+    void MetricsPushOptions::configure(const MetricsPushOptions &options) {
+        options_storage() = options;
+    }
+
+    const MetricsPushOptions &MetricsPushOptions::current() {
+        return options_storage();
+    }
+
+    std::vector<MetricSample> parse_exposition(std::string_view text) {
+        std::vector<MetricSample> samples;
+        std::string family;
+        std::string type;
+        while (!text.empty()) {
+            size_t newline = text.find('\n');
+            std::string_view line = text.substr(0, newline);
+            text = newline == std::string_view::npos ? std::string_view{} : text.substr(newline + 1);
+            if (line.empty()) {
+                continue;
+            }
+            if (line.front() == '#') {
+                constexpr std::string_view kType = "# TYPE ";
+                if (line.starts_with(kType)) {
+                    line.remove_prefix(kType.size());
+                    auto space = line.find(' ');
+                    family = std::string(line.substr(0, space));
+                    type = space == std::string_view::npos ? "untyped" : std::string(line.substr(space + 1));
+                }
+                continue;
+            }
+
+            MetricSample sample;
+            size_t name_end = line.find_first_of("{ ");
+            if (name_end == std::string_view::npos) {
+                continue;
+            }
+            sample.name = std::string(line.substr(0, name_end));
+            line.remove_prefix(name_end);
+            if (line.front() == '{' && !parse_labels(line, sample.labels)) {
+                continue;
+            }
+            while (!line.empty() && line.front() == ' ') {
+                line.remove_prefix(1);
+            }
+            line = line.substr(0, line.find(' '));// A timestamp may follow
+            auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), sample.value);
+            if (error != std::errc() || !std::isfinite(sample.value)) {
+                continue;
+            }
+            bool in_family = sample.name.starts_with(family);
+            sample.family = in_family ? family : sample.name;
+            sample.type = in_family ? type : "untyped";
+            samples.push_back(std::move(sample));
+        }
+        return samples;
+    }
+
+    std::unique_ptr<MetricsPushExporter> make_statsd_exporter(std::string endpoint, std::string prefix) {
+        return std::make_unique<StatsdExporter>(std::move(endpoint), std::move(prefix));
+    }
+
+    std::unique_ptr<MetricsPushExporter> make_otlp_metrics_exporter(std::string_view endpoint, std::string service_name) {
+        auto parsed = HttpEndpoint::parse(endpoint, "/v1/metrics");
+        if (!parsed) {
+            return nullptr;
+        }
+        return std::make_unique<OtlpMetricsExporter>(std::move(*parsed), std::move(service_name));
+    }
+
+    MetricsPusher &MetricsPusher::instance() {
+        static MetricsPusher pusher;
+        return pusher;
+    }
+
+    MetricsPusher::~MetricsPusher() {
+        shutdown();
+    }
+
+    void MetricsPusher::add_exporter(std::unique_ptr<MetricsPushExporter> exporter) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sinks_.push_back({std::move(exporter), {}, 0});
+    }
+
+    void MetricsPusher::start() {
+        const auto &options = MetricsPushOptions::current();
+        if (thread_.joinable()) {
+            return;
+        }
+        if (!options.statsd_endpoint.empty()) {
+            add_exporter(make_statsd_exporter(options.statsd_endpoint, options.statsd_prefix));
+            MCP_INFO("Pushing metrics to StatsD {} every {} ms", options.statsd_endpoint, options.interval.count());
+        }
+        if (!options.otlp_endpoint.empty()) {
+            if (auto exporter = make_otlp_metrics_exporter(options.otlp_endpoint, options.service_name)) {
+                add_exporter(std::move(exporter));
+                MCP_INFO("Pushing metrics to {} every {} ms", options.otlp_endpoint, options.interval.count());
+            } else {
+                MCP_WARN("OTLP metrics push disabled: {} is not an http:// URL", options.otlp_endpoint);
+            }
+        }
+        if (sinks_.empty()) {
+            return;
+        }
+        stopping_ = false;
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    void MetricsPusher::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void MetricsPusher::run() {
+        const auto interval = std::max(MetricsPushOptions::current().interval, std::chrono::milliseconds(100));
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            bool stopping = wake_.wait_for(lock, interval, [&]() { return stopping_; });
+            // Exporters are only touched by this thread once it runs
+            lock.unlock();
+            push();
+            lock.lock();
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    void MetricsPusher::push() {
+        const size_t max_bytes = MetricsPushOptions::current().max_buffered_bytes;
+        auto samples = parse_exposition(MetricsManager::getInstance()->render_prometheus());
+        uint64_t now = unix_nanos(std::chrono::steady_clock::now());
+        for (auto &sink: sinks_) {
+            for (auto &payload: sink.exporter->encode(samples, now)) {
+                sink.pending_bytes += payload.size();
+                sink.pending.push_back(std::move(payload));
+            }
+            // An unreachable collector costs at most the buffer, the oldest pushes go first
+            while (sink.pending_bytes > max_bytes && !sink.pending.empty()) {
+                sink.pending_bytes -= sink.pending.front().size();
+                sink.pending.pop_front();
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            while (!sink.pending.empty() && sink.exporter->send(sink.pending.front())) {
+                sink.pending_bytes -= sink.pending.front().size();
+                sink.pending.pop_front();
+                pushed_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!sink.pending.empty()) {
+                MCP_DEBUG("{} metrics pushes to {} wait for the next push", sink.pending.size(), sink.exporter->name());
+            }
+        }
+    }
+
+}// namespace mcp::metrics
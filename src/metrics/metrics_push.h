@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mcp::metrics {
+
+    /**
+     * @brief Push of the built-in metrics, normally taken from the [server] config section.
+     */
+    struct MetricsPushOptions {
+        std::string statsd_endpoint;                   ///< StatsD server as "host:port", sent to over UDP; empty = no StatsD push
+        std::string otlp_endpoint;                     ///< OTLP/HTTP collector, such as "http://localhost:4318"; empty = no OTLP push
+        std::string statsd_prefix = "mcp.";            ///< Put before every StatsD metric name
+        std::string service_name = "mcp-server";       ///< service.name of the OTLP metrics
+        std::chrono::milliseconds interval{10000};     ///< Time between two pushes
+        size_t max_buffered_bytes = 1024 * 1024;       ///< Encoded pushes an exporter keeps while its collector is unreachable, the oldest are dropped beyond
+
+        bool enabled() const { return !statsd_endpoint.empty() || !otlp_endpoint.empty(); }
+
+        /**
+         * @brief Set the process-wide options. Call before MetricsPusher::start().
+         * @param options New options
+         */
+        static void configure(const MetricsPushOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const MetricsPushOptions &current();
+    };
+
+    /**
+     * @brief One sample of the metrics, as the push exporters see it.
+     */
+    struct MetricSample {
+        std::string family;///< Name of its metric; a histogram's samples share it
+        std::string name;  ///< Name of the sample, with the _bucket, _sum or _count of a histogram
+        std::string type;  ///< "counter", "gauge" or "histogram"
+        std::vector<std::pair<std::string, std::string>> labels;
+        double value = 0;
+    };
+
+    /**
+     * @brief Parse the Prometheus text exposition, as MetricsManager::render_prometheus() writes it.
+     * @param text Exposition text
+     * @return Its samples in order, each with the family and type of the TYPE line before it
+     */
+    std::vector<MetricSample> parse_exposition(std::string_view text);
+
+    /**
+     * @brief A destination the metrics are pushed to, for environments that are not scraped.
+     * Called from the push thread only.
+     */
+    class MetricsPushExporter {
+    public:
+        virtual ~MetricsPushExporter() = default;
+
+        /**
+         * @brief Name for the log, such as "statsd".
+         */
+        virtual std::string_view name() const = 0;
+
+        /**
+         * @brief Encode the samples of one push.
+         * @param samples All built-in metrics, cumulative since the start
+         * @param time_unix_ns Time of the push
+         * @return Payloads to send, each one on its own
+         */
+        virtual std::vector<std::string> encode(const std::vector<MetricSample> &samples, uint64_t time_unix_ns) = 0;
+
+        /**
+         * @brief Send one payload.
+         * @return Whether it went out; a payload that did not is sent again on the next push
+         */
+        virtual bool send(const std::string &payload) = 0;
+    };
+
+    /**
+     * @brief StatsD exporter: counters as the increments since the last push, gauges as they
+     *        are, histograms as the increments of their _count and _sum. Labels become
+     *        DogStatsD tags, lines are packed into datagrams of at most 1432 bytes.
+     * @param endpoint "host:port"
+     * @param prefix Put before every metric name
+     */
+    std::unique_ptr<MetricsPushExporter> make_statsd_exporter(std::string endpoint, std::string prefix);
+
+    /**
+     * @brief OTLP/HTTP exporter: one ExportMetricsServiceRequest in OTLP JSON per push, with
+     *        cumulative sums, gauges and explicit-bucket histograms.
+     * @param endpoint "http://host[:port][/path]", the path defaults to /v1/metrics
+     * @param service_name service.name of the metrics
+     * @return Exporter, nullptr if the endpoint is not an http:// URL
+     */
+    std::unique_ptr<MetricsPushExporter> make_otlp_metrics_exporter(std::string_view endpoint, std::string service_name);
+
+    /**
+     * @brief Pushes the built-in metrics to every exporter, from its own thread.
+     *
+     * Each push renders the metrics once, which folds the per-thread shards of the hot-path
+     * counters and histograms, and hands the samples to every exporter; nothing on the request
+     * path waits for it. An exporter whose collector is unreachable keeps its unsent payloads up
+     * to max_buffered_bytes and retries them first on the next push; beyond that the oldest are
+     * dropped and counted.
+     */
+    class MetricsPusher {
+    public:
+        static MetricsPusher &instance();
+
+        /**
+         * @brief Add an exporter of its own, besides the configured ones. Call before start().
+         */
+        void add_exporter(std::unique_ptr<MetricsPushExporter> exporter);
+
+        /**
+         * @brief Add the configured exporters and start pushing; does nothing without any exporter.
+         */
+        void start();
+
+        /**
+         * @brief Push one last time and stop the push thread.
+         */
+        void shutdown();
+
+        uint64_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        MetricsPusher() = default;
+        ~MetricsPusher();
+
+        struct Sink {
+            std::unique_ptr<MetricsPushExporter> exporter;
+            std::deque<std::string> pending;///< Payloads not sent yet, the oldest first
+            size_t pending_bytes = 0;
+        };
+
+        void run();
+        void push();
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::thread thread_;
+        bool stopping_ = false;
+        std::vector<Sink> sinks_;
+        std::atomic<uint64_t> pushed_{0}; ///< Payloads sent
+        std::atomic<uint64_t> dropped_{0};///< Payloads dropped because their exporter's buffer was full
+    };
+
+}// namespace mcp::metrics
@@ -1,20 +1,26 @@
 #pragma once
 
+#include "transport/header_map.h"
 #include <chrono>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 namespace mcp::metrics {
 
     /**
-     * @brief HTTP request structure for performance tracking.
+     * @brief Non-owning description of an HTTP request for performance tracking and rate limiting.
+     * The views point into the session's read buffer and are only valid during the call the
+     * descriptor is passed to; callbacks must copy whatever they want to keep.
      */
     struct TrackedHttpRequest {
-        std::string method;                                  ///< HTTP method (GET, POST, etc.)
-        std::string target;                                  ///< Request target/URL
-        std::string version;                                 ///< HTTP version
-        std::unordered_map<std::string, std::string> headers;///< HTTP headers
-        std::string body;                                    ///< Request body
+        std::string_view method;    ///< HTTP method (GET, POST, etc.)
+        std::string_view target;    ///< Request target/URL
+        std::string_view version;   ///< HTTP version
+        std::string_view body;      ///< Request body, only look at it when really needed
+        std::string_view session_id;///< Session the request arrived on
+        size_t header_count = 0;    ///< Number of request headers
+        size_t request_size = 0;    ///< Bytes the request occupied on the wire
+        const transport::HeaderMap *headers = nullptr;///< Session headers, may be null
     };
 
     /**
@@ -0,0 +1,411 @@
+#include "profiler.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <filesystem>
+#include <malloc.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace mcp::metrics {
+
+    namespace {
+#if defined(__linux__)
+        /**
+         * @brief Minimal protobuf encoder, for the handful of messages of profile.proto.
+         */
+        class ProtoWriter {
+        public:
+            void varint(uint64_t value) {
+                while (value >= 0x80) {
+                    data_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                    value >>= 7;
+                }
+                data_.push_back(static_cast<char>(value));
+            }
+
+            void uint(int field, uint64_t value) {
+                if (value != 0) {// Zero is the default, proto3 leaves it out
+                    varint(static_cast<uint64_t>(field) << 3);
+                    varint(value);
+                }
+            }
+
+            void bytes(int field, std::string_view value) {
+                varint((static_cast<uint64_t>(field) << 3) | 2);
+                varint(value.size());
+                data_.append(value);
+            }
+
+            void message(int field, const ProtoWriter &message) { bytes(field, message.data_); }
+
+            void packed(int field, const std::vector<uint64_t> &values) {
+                ProtoWriter packed;
+                for (uint64_t value: values) {
+                    packed.varint(value);
+                }
+                message(field, packed);
+            }
+
+            std::string &data() { return data_; }
+
+        private:
+            std::string data_;
+        };
+
+        /**
+         * @brief String table of a profile; index 0 is the empty string, as pprof requires.
+         */
+        class StringTable {
+        public:
+            StringTable() { index(""); }
+
+            uint64_t index(const std::string &value) {
+                auto [it, inserted] = indices_.try_emplace(value, strings_.size());
+                if (inserted) {
+                    strings_.push_back(value);
+                }
+                return it->second;
+            }
+
+            void write(ProtoWriter &profile) const {
+                for (const auto &value: strings_) {
+                    profile.bytes(6, value);
+                }
+            }
+
+        private:
+            std::vector<std::string> strings_;
+            std::unordered_map<std::string, uint64_t> indices_;
+        };
+
+        ProtoWriter value_type(StringTable &strings, const std::string &type, const std::string &unit) {
+            ProtoWriter message;
+            message.uint(1, strings.index(type));
+            message.uint(2, strings.index(unit));
+            return message;
+        }
+
+        struct Mapping {
+            uint64_t start = 0;
+            uint64_t limit = 0;
+            uint64_t offset = 0;
+            std::string file;
+        };
+
+        /**
+         * @brief Executable mappings of the process, where the sampled addresses are.
+         */
+        std::vector<Mapping> executable_mappings() {
+            std::vector<Mapping> mappings;
+            std::ifstream maps("/proc/self/maps");
+            std::string line;
+            while (std::getline(maps, line)) {
+                // start-limit perms offset dev inode path
+                std::istringstream fields(line);
+                std::string range, perms, offset, device, inode, file;
+                fields >> range >> perms >> offset >> device >> inode;
+                std::getline(fields >> std::ws, file);
+                auto dash = range.find('-');
+                if (perms.size() < 3 || perms[2] != 'x' || dash == std::string::npos) {
+                    continue;
+                }
+                Mapping mapping;
+                mapping.start = std::stoull(range.substr(0, dash), nullptr, 16);
+                mapping.limit = std::stoull(range.substr(dash + 1), nullptr, 16);
+                mapping.offset = std::stoull(offset, nullptr, 16);
+                mapping.file = std::move(file);
+                mappings.push_back(std::move(mapping));
+            }
+            return mappings;
+        }
+
+        constexpr size_t kMaxFrames = 64;     ///< Deepest stack recorded, deeper stacks lose their outermost frames
+        constexpr size_t kMaxSamples = 16384; ///< Samples a profile holds, further ones are counted as lost
+        constexpr int kSkipFrames = 2;        ///< The signal handler and the signal trampoline
+
+        struct Sample {
+            uint32_t depth = 0;
+            uintptr_t pcs[kMaxFrames];
+        };
+
+        // Shared with the signal handler, which must not lock or allocate
+        std::atomic<bool> sampling{false};
+        std::atomic<int> in_handler{0};
+        std::atomic<size_t> next_sample{0};
+        Sample *samples = nullptr;
+
+        void on_sigprof(int) {
+            int saved_errno = errno;
+            in_handler.fetch_add(1);
+            if (sampling.load()) {
+                size_t slot = next_sample.fetch_add(1, std::memory_order_relaxed);
+                if (slot < kMaxSamples) {
+                    void *frames[kMaxFrames + kSkipFrames];
+                    int depth = backtrace(frames, static_cast<int>(std::size(frames)));
+                    auto &sample = samples[slot];
+                    sample.depth = 0;
+                    for (int i = kSkipFrames; i < depth; ++i) {
+                        sample.pcs[sample.depth++] = reinterpret_cast<uintptr_t>(frames[i]);
+                    }
+                }
+            }
+            in_handler.fetch_sub(1);
+            errno = saved_errno;
+        }
+
+        void set_timer(std::chrono::microseconds period) {
+            itimerval timer{};
+            timer.it_interval.tv_sec = static_cast<time_t>(period.count() / 1000000);
+            timer.it_interval.tv_usec = static_cast<suseconds_t>(period.count() % 1000000);
+            timer.it_value = timer.it_interval;
+            setitimer(ITIMER_PROF, &timer, nullptr);
+        }
+#endif
+    }// namespace
+
+    CpuProfiler &CpuProfiler::instance() {
+        static CpuProfiler profiler;
+        return profiler;
+    }
+
+    bool CpuProfiler::supported() {
+#if defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool CpuProfiler::start([[maybe_unused]] std::chrono::microseconds period) {
+#if defined(__linux__)
+        bool expected = false;
+        if (period.count() <= 0 || !running_.compare_exchange_strong(expected, true)) {
+            return false;
+        }
+
+        // The first backtrace() loads the unwinder, which is not safe in a signal handler
+        static const bool warmed_up = [] {
+            void *frame;
+            return backtrace(&frame, 1) > 0;
+        }();
+        (void) warmed_up;
+
+        static const bool installed = [] {
+            struct sigaction action{};
+            action.sa_handler = on_sigprof;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            return sigaction(SIGPROF, &action, nullptr) == 0;
+        }();
+        if (!installed) {
+            running_ = false;
+            return false;
+        }
+
+        samples = new Sample[kMaxSamples];
+        next_sample.store(0, std::memory_order_relaxed);
+        period_ = period;
+        started_ = std::chrono::system_clock::now();
+        lost_ = 0;
+        sampling.store(true);
+        set_timer(period);
+        MCP_INFO("CPU profile started, one sample per {} us of CPU time", period.count());
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::string CpuProfiler::stop() {
+#if defined(__linux__)
+        if (!running_) {
+            return {};
+        }
+        set_timer(std::chrono::microseconds(0));
+        sampling.store(false);
+        // A signal that was already being handled finishes writing its sample
+        while (in_handler.load() != 0) {
+            std::this_thread::yield();
+        }
+        auto duration = std::chrono::system_clock::now() - started_;
+        size_t taken = next_sample.load(std::memory_order_relaxed);
+        size_t recorded = std::min(taken, kMaxSamples);
+        lost_ = taken - recorded;
+
+        // Samples of the same stack become one pprof sample
+        std::map<std::vector<uintptr_t>, uint64_t> stacks;
+        for (size_t i = 0; i < recorded; ++i) {
+            const auto &sample = samples[i];
+            if (sample.depth != 0) {
+                ++stacks[std::vector<uintptr_t>(sample.pcs, sample.pcs + sample.depth)];
+            }
+        }
+        delete[] samples;
+        samples = nullptr;
+
+        StringTable strings;
+        ProtoWriter profile;
+        profile.message(1, value_type(strings, "samples", "count"));
+        profile.message(1, value_type(strings, "cpu", "nanoseconds"));
+
+        auto period_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(period_).count());
+        std::unordered_map<uint64_t, uint64_t> location_ids;
+        std::vector<uint64_t> addresses;
+        for (const auto &[stack, count]: stacks) {
+            std::vector<uint64_t> ids;
+            ids.reserve(stack.size());
+            for (size_t i = 0; i < stack.size(); ++i) {
+                // Callers' addresses are return addresses, one byte back is inside the call
+                uint64_t address = i == 0 ? stack[i] : stack[i] - 1;
+                auto [it, inserted] = location_ids.try_emplace(address, location_ids.size() + 1);
+                if (inserted) {
+                    addresses.push_back(address);
+                }
+                ids.push_back(it->second);
+            }
+            ProtoWriter sample;
+            sample.packed(1, ids);
+            sample.packed(2, {count, count * period_ns});
+            profile.message(2, sample);
+        }
+
+        auto mappings = executable_mappings();
+        for (size_t i = 0; i < mappings.size(); ++i) {
+            ProtoWriter mapping;
+            mapping.uint(1, i + 1);
+            mapping.uint(2, mappings[i].start);
+            mapping.uint(3, mappings[i].limit);
+            mapping.uint(4, mappings[i].offset);
+            mapping.uint(5, strings.index(mappings[i].file));
+            profile.message(3, mapping);
+        }
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            ProtoWriter location;
+            location.uint(1, i + 1);
+            auto mapping = std::find_if(mappings.begin(), mappings.end(), [&](const Mapping &m) {
+                return addresses[i] >= m.start && addresses[i] < m.limit;
+            });
+            if (mapping != mappings.end()) {
+                location.uint(2, static_cast<uint64_t>(mapping - mappings.begin()) + 1);
+            }
+            location.uint(3, addresses[i]);
+            profile.message(4, location);
+        }
+
+        auto started_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(started_.time_since_epoch()).count();
+        auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        auto period_type = value_type(strings, "cpu", "nanoseconds");
+        strings.write(profile);
+        profile.uint(9, static_cast<uint64_t>(started_ns));
+        profile.uint(10, static_cast<uint64_t>(duration_ns));
+        profile.message(11, period_type);
+        profile.uint(12, period_ns);
+
+        MCP_INFO("CPU profile stopped: {} samples, {} stacks, {} lost", recorded, stacks.size(), lost_);
+        running_ = false;
+        return std::move(profile.data());
+#else
+        return {};
+#endif
+    }
+
+    std::optional<HeapProfile> heap_profile(std::string &error) {
+#if defined(__linux__)
+        // Looked up at run time, so the server links against neither allocator
+        using mallctl_func = int (*)(const char *, void *, size_t *, void *, size_t);
+        if (auto mallctl = reinterpret_cast<mallctl_func>(dlsym(RTLD_DEFAULT, "mallctl"))) {
+            bool enabled = false;
+            size_t size = sizeof(enabled);
+            if (mallctl("opt.prof", &enabled, &size, nullptr, 0) != 0 || !enabled) {
+                error = "jemalloc was not started with profiling, set MALLOC_CONF=prof:true";
+                return std::nullopt;
+            }
+            auto path = (std::filesystem::temp_directory_path() / "mcp-heap-XXXXXX").string();
+            int fd = mkstemp(path.data());
+            if (fd < 0) {
+                error = "cannot create a temporary file for the heap profile";
+                return std::nullopt;
+            }
+            close(fd);
+            const char *file = path.c_str();
+            int result = mallctl("prof.dump", nullptr, nullptr, &file, sizeof(file));
+            std::ifstream in(path, std::ios::binary);
+            std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            unlink(path.c_str());
+            if (result != 0) {
+                error = "jemalloc failed to dump the heap profile";
+                return std::nullopt;
+            }
+            return HeapProfile{"jemalloc", std::move(data)};
+        }
+
+        using running_func = int (*)();
+        using profile_func = char *(*) ();
+        auto running = reinterpret_cast<running_func>(dlsym(RTLD_DEFAULT, "IsHeapProfilerRunning"));
+        auto get_profile = reinterpret_cast<profile_func>(dlsym(RTLD_DEFAULT, "GetHeapProfile"));
+        if (running && get_profile) {
+            if (!running()) {
+                error = "the gperftools heap profiler is not running, set HEAPPROFILE";
+                return std::nullopt;
+            }
+            char *data = get_profile();
+            HeapProfile profile{"gperftools", data ? data : ""};
+            std::free(data);
+            return profile;
+        }
+#endif
+        error = "no heap profiler is linked, use jemalloc or tcmalloc with profiling enabled";
+        return std::nullopt;
+    }
+
+    ProcessMemory process_memory() {
+        ProcessMemory memory;
+#if defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        int64_t pages = 0, resident = 0;
+        if (statm >> pages >> resident) {
+            memory.rss_bytes = resident * static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+        }
+
+        using mallctl_func = int (*)(const char *, void *, size_t *, void *, size_t);
+        if (auto mallctl = reinterpret_cast<mallctl_func>(dlsym(RTLD_DEFAULT, "mallctl"))) {
+            // jemalloc's statistics are a snapshot taken when the epoch is advanced
+            uint64_t epoch = 1;
+            size_t size = sizeof(epoch);
+            mallctl("epoch", &epoch, &size, &epoch, size);
+            size_t allocated = 0, held = 0;
+            size = sizeof(size_t);
+            if (mallctl("stats.allocated", &allocated, &size, nullptr, 0) == 0 &&
+                mallctl("stats.resident", &held, &size, nullptr, 0) == 0) {
+                memory.heap_allocated = static_cast<int64_t>(allocated);
+                memory.heap_resident = static_cast<int64_t>(held);
+                memory.allocator = "jemalloc";
+            }
+            return memory;
+        }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        memory.heap_allocated = static_cast<int64_t>(info.uordblks + info.hblkhd);
+        memory.heap_resident = static_cast<int64_t>(info.arena + info.hblkhd);
+        memory.allocator = "glibc";
+#endif
+#endif
+        return memory;
+    }
+
+}// namespace mcp::metrics
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace mcp::metrics {
+
+    /**
+     * @brief Sampling CPU profiler for the /debug/pprof endpoints.
+     *
+     * While a profile runs, ITIMER_PROF delivers SIGPROF for every period of CPU time the
+     * process uses, to whichever thread is running; the signal handler records that thread's
+     * stack into a buffer allocated when the profile starts, with no lock and no allocation.
+     * Nothing is armed between profiles, so the profiler costs nothing until it is asked for
+     * one. Stacks are written unsymbolized, with the process's mappings, in pprof's protobuf
+     * format: `pprof <binary> profile.pb.gz` symbolizes them. Only one profile runs at a time;
+     * supported on Linux.
+     */
+    class CpuProfiler {
+    public:
+        static CpuProfiler &instance();
+
+        /**
+         * @brief Whether CPU profiles can be taken on this platform.
+         */
+        static bool supported();
+
+        /**
+         * @brief Start sampling.
+         * @param period CPU time between samples
+         * @return false if a profile is already running or profiling is not supported
+         */
+        bool start(std::chrono::microseconds period = std::chrono::milliseconds(10));
+
+        /**
+         * @brief Stop sampling; only the caller of a successful start() may stop.
+         * @return The profile, a serialized (uncompressed) perftools.profiles.Profile
+         */
+        std::string stop();
+
+        /**
+         * @brief Samples lost because the buffer was full, in the last profile.
+         */
+        uint64_t lost() const { return lost_; }
+
+    private:
+        CpuProfiler() = default;
+
+        std::atomic<bool> running_{false};
+        std::chrono::microseconds period_{0};
+        std::chrono::system_clock::time_point started_;
+        uint64_t lost_ = 0;
+    };
+
+    /**
+     * @brief A heap profile, in the format of the allocator that wrote it.
+     */
+    struct HeapProfile {
+        std::string allocator;///< "jemalloc" or "gperftools"
+        std::string data;
+    };
+
+    /**
+     * @brief Take a heap profile from the allocator the process is linked with.
+     * Works with jemalloc started with prof:true (MALLOC_CONF=prof:true) and with the gperftools
+     * heap profiler while it runs (HEAPPROFILE=...). Both write their own heap format, which
+     * pprof and jeprof read.
+     * @param error Set to the reason when there is no profile
+     * @return Profile, std::nullopt if no heap profiler is available
+     */
+    std::optional<HeapProfile> heap_profile(std::string &error);
+
+    /**
+     * @brief Memory of the process, for the stats endpoint and soak runs.
+     */
+    struct ProcessMemory {
+        int64_t rss_bytes = -1;     ///< Resident set size, -1 where unknown
+        int64_t heap_allocated = -1;///< Bytes handed out by the allocator and not freed, -1 where unknown
+        int64_t heap_resident = -1; ///< Bytes the allocator holds from the system, -1 where unknown
+        std::string allocator;      ///< "jemalloc", "glibc" or empty
+    };
+
+    /**
+     * @brief Read the resident set size from /proc and the heap figures from jemalloc's
+     *        statistics or glibc's mallinfo2(). mallinfo2() walks every arena under its lock,
+     *        so this is for occasional reads, not the request path. Linux only.
+     */
+    ProcessMemory process_memory();
+
+}// namespace mcp::metrics
@@ -1,6 +1,7 @@
 #include "rate_limiter.h"
 #include "core/logger.h"
 #include <algorithm>
+#include <mutex>
 
 namespace mcp::metrics {
 
@@ -14,14 +15,38 @@ namespace mcp::metrics {
         return instance;
     }
 
+    void RateLimiter::set_config(const RateLimitConfig &config) {
+        Limits limits;
+        limits.config = config;
+        size_t burst = config.burst != 0 ? config.burst : config.max_requests_per_second;
+        limits.emission_interval_ns = config.max_requests_per_second != 0
+                                              ? std::max<int64_t>(1, 1000000000 / static_cast<int64_t>(config.max_requests_per_second))
+                                              : 0;
+        limits.burst_window_ns = limits.emission_interval_ns * static_cast<int64_t>(std::max<size_t>(burst, 1));
+        limits_.publish(limits);
+    }
+
+    void RateLimiter::set_partitions(size_t partitions) {
+        partition_count_.store(std::clamp<size_t>(partitions, 1, kMaxPartitions), std::memory_order_relaxed);
+    }
+
+    size_t RateLimiter::thread_partition() const {
+        // Threads take consecutive slots on first use, so n io threads get n different partitions
+        static std::atomic<size_t> next_slot{0};
+        thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+        return slot % partition_count_.load(std::memory_order_relaxed);
+    }
+
     RateLimitDecision RateLimiter::check_request_allowed(
             const TrackedHttpRequest &request,
             const std::string &session_id) {
+        const Limits &limits = limits_.get();
+        const RateLimitConfig &config = limits.config;
 
         // Check request size
-        if (request.body.size() > config_.max_request_size) {
+        if (request.body.size() > config.max_request_size) {
             MCP_WARN("Request too large - Session: {}, Size: {}, Max: {}",
-                     session_id, request.body.size(), config_.max_request_size);
+                     session_id, request.body.size(), config.max_request_size);
 
             if (rate_limit_callback_) {
                 rate_limit_callback_(session_id, RateLimitDecision::TOO_LARGE);
@@ -29,10 +54,13 @@ namespace mcp::metrics {
             return RateLimitDecision::TOO_LARGE;
         }
 
-        // Check concurrent requests
-        if (active_requests_.size() >= config_.max_concurrent_requests) {
+        // Check concurrent requests (the request being checked has already been started on this thread)
+        size_t partitions = partition_count_.load(std::memory_order_relaxed);
+        size_t active = partitions_[thread_partition()].active.load(std::memory_order_relaxed);
+        size_t max_active = (config.max_concurrent_requests + partitions - 1) / partitions;
+        if (active > max_active) {
             MCP_WARN("Too many concurrent requests - Session: {}, Active: {}, Max: {}",
-                     session_id, active_requests_.size(), config_.max_concurrent_requests);
+                     session_id, active, max_active);
 
             if (rate_limit_callback_) {
                 rate_limit_callback_(session_id, RateLimitDecision::RATE_LIMITED);
@@ -41,23 +69,9 @@ namespace mcp::metrics {
         }
 
         // Check requests per second
-        auto now = std::chrono::high_resolution_clock::now();
-        auto &timestamps = request_timestamps_[session_id];
-
-        // Remove timestamps older than 1 second
-        timestamps.erase(
-                std::remove_if(timestamps.begin(), timestamps.end(),
-                               [now](const auto &timestamp) {
-                                   auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                           now - timestamp);
-                                   return diff.count() >= 1000;
-                               }),
-                timestamps.end());
-
-        // Check if we're exceeding the rate limit
-        if (timestamps.size() >= config_.max_requests_per_second) {
-            MCP_WARN("Rate limit exceeded - Session: {}, Requests: {}, Max: {}",
-                     session_id, timestamps.size(), config_.max_requests_per_second);
+        if (!take_token(limits, session_id, now_ns())) {
+            MCP_WARN("Rate limit exceeded - Session: {}, Max: {}/s",
+                     session_id, config.max_requests_per_second);
 
             if (rate_limit_callback_) {
                 rate_limit_callback_(session_id, RateLimitDecision::RATE_LIMITED);
@@ -72,17 +86,97 @@ namespace mcp::metrics {
         return RateLimitDecision::ALLOW;
     }
 
-    void RateLimiter::report_request_started(const std::string &session_id) {
-        auto now = std::chrono::high_resolution_clock::now();
-        active_requests_[session_id] = now;
-        request_timestamps_[session_id].push_back(now);
+    size_t RateLimiter::report_request_started(const std::string & /*session_id*/) {
+        size_t partition = thread_partition();
+        partitions_[partition].active.fetch_add(1, std::memory_order_relaxed);
+        return partition;
+    }
+
+    void RateLimiter::report_request_completed(const std::string & /*session_id*/, size_t partition) {
+        partitions_[partition].active.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    size_t RateLimiter::active_requests() const {
+        size_t count = 0;
+        for (const auto &partition: partitions_) {
+            count += partition.active.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    size_t RateLimiter::tracked_sessions() const {
+        size_t count = 0;
+        for (const auto &shard: shards_) {
+            std::shared_lock lock(shard.mutex);
+            count += shard.buckets.size();
+        }
+        return count;
+    }
+
+    RateLimiter::Shard &RateLimiter::shard_for(const std::string &session_id) {
+        return shards_[std::hash<std::string>{}(session_id) & (kShardCount - 1)];
     }
 
-    void RateLimiter::report_request_completed(const std::string &session_id) {
-        active_requests_.erase(session_id);
+    bool RateLimiter::take_token(const Limits &limits, const std::string &session_id, int64_t now) {
+        if (limits.emission_interval_ns == 0) {
+            return false;// max_requests_per_second = 0 admits nothing
+        }
+
+        // GCRA: the request conforms if the bucket would not overflow the burst window
+        auto conforms = [&limits, now](Bucket &bucket) {
+            int64_t tat = bucket.tat.load(std::memory_order_relaxed);
+            while (true) {
+                int64_t new_tat = std::max(tat, now) + limits.emission_interval_ns;
+                if (new_tat - now > limits.burst_window_ns) {
+                    return false;
+                }
+                if (bucket.tat.compare_exchange_weak(tat, new_tat, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        };
+
+        Shard &shard = shard_for(session_id);
+        bool allowed = false;
+        bool found = false;
+        {
+            std::shared_lock lock(shard.mutex);
+            auto it = shard.buckets.find(session_id);
+            if (it != shard.buckets.end()) {
+                allowed = conforms(it->second);
+                found = true;
+            }
+        }
+        if (!found) {
+            std::unique_lock lock(shard.mutex);
+            allowed = conforms(shard.buckets.try_emplace(session_id).first->second);
+        }
+
+        sweep(shard, now);
+        return allowed;
+    }
+
+    void RateLimiter::sweep(Shard &shard, int64_t now) {
+        int64_t next = shard.next_sweep.load(std::memory_order_relaxed);
+        if (now < next || !shard.next_sweep.compare_exchange_strong(next, now + kSweepIntervalNs, std::memory_order_relaxed)) {
+            return;
+        }
+
+        // A bucket that has refilled completely is indistinguishable from a new one
+        std::unique_lock lock(shard.mutex);
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            if (it->second.tat.load(std::memory_order_relaxed) <= now) {
+                it = shard.buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
 
-        // We keep the timestamp for rate limiting calculations
-        // It will be cleaned up in check_request_allowed when it expires
+    int64_t RateLimiter::now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
     }
 
-}// namespace mcp::metrics
\ No newline at end of file
+}// namespace mcp::metrics
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "core/snapshot.hpp"
 #include "performance_metrics.h"
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 
@@ -15,8 +20,11 @@ namespace mcp::metrics {
     struct RateLimitConfig {
         size_t max_requests_per_second = 100;       ///< Maximum requests allowed per second
         size_t max_concurrent_requests = 1000;      ///< Maximum concurrent requests
+        size_t burst = 0;                           ///< Requests a session may send back to back, 0 = max_requests_per_second
         size_t max_request_size = 1024 * 1024;      ///< Maximum request size in bytes (1MB)
         size_t max_response_size = 10 * 1024 * 1024;///< Maximum response size in bytes (10MB)
+
+        bool operator==(const RateLimitConfig &) const = default;
     };
 
     /**
@@ -30,6 +38,19 @@ namespace mcp::metrics {
 
     /**
      * @brief Rate limiter for controlling traffic flow
+     *
+     * Each session owns a token bucket refilled at max_requests_per_second and holding up to
+     * burst tokens. A bucket is stored as a single atomic "theoretical arrival time" (GCRA), so
+     * a check is one compare-and-swap. Buckets live in hash shards that are only locked
+     * exclusively to insert new sessions or evict full buckets, which behave exactly like
+     * missing ones. All methods may be called from any io thread.
+     *
+     * The limits are an immutable Snapshot, so set_config() may replace them while requests are
+     * checked; each check reads one version whole. Existing buckets keep their fill level.
+     *
+     * Requests in flight are counted in partitions, one per io thread in the shared-nothing
+     * server mode (see set_partitions()), each on a cache line of its own and checked against
+     * its share of max_concurrent_requests.
      */
     class RateLimiter {
     public:
@@ -44,21 +65,29 @@ namespace mcp::metrics {
         static std::shared_ptr<RateLimiter> getInstance();
 
         /**
-         * @brief Set rate limit configuration
+         * @brief Set rate limit configuration, at startup or on a config reload.
          * @param config Rate limit configuration
          */
-        void set_config(const RateLimitConfig &config) {
-            config_ = config;
-        }
+        void set_config(const RateLimitConfig &config);
 
         /**
          * @brief Get current rate limit configuration
-         * @return Current rate limit configuration
+         * @return Current rate limit configuration; not to be kept across a suspension point
          */
         const RateLimitConfig &get_config() const {
-            return config_;
+            return limits_.get().config;
         }
 
+        /**
+         * @brief Count requests in flight in separate partitions, so io threads do not share one
+         *        counter. Each thread counts in one partition and a request is refused once its
+         *        partition holds its share of max_concurrent_requests, rounded up. Set before
+         *        requests are served.
+         * @param partitions Number of partitions, normally the number of io threads; 1 counts all
+         *        requests together, values are clamped to [1, 256]
+         */
+        void set_partitions(size_t partitions);
+
         /**
          * @brief Set callback for rate limiting events
          * @param callback Function to call when rate limiting decisions are made
@@ -68,7 +97,8 @@ namespace mcp::metrics {
         }
 
         /**
-         * @brief Check if a request should be allowed based on rate limiting rules
+         * @brief Check if a request should be allowed based on rate limiting rules.
+         * An allowed request takes a token from the session's bucket.
          * @param request The HTTP request being checked
          * @param session_id Session identifier
          * @return RateLimitDecision indicating if the request is allowed
@@ -78,16 +108,31 @@ namespace mcp::metrics {
                 const std::string &session_id);
 
         /**
-         * @brief Report completion of a request (to update counters)
+         * @brief Report completion of a request (to update counters).
+         * Must be called exactly once for every report_request_started().
          * @param session_id Session identifier
+         * @param partition Partition returned by report_request_started()
          */
-        void report_request_completed(const std::string &session_id);
+        void report_request_completed(const std::string &session_id, size_t partition = 0);
 
         /**
          * @brief Report start of a request (to update counters)
          * @param session_id Session identifier
+         * @return Partition the request is counted in
+         */
+        size_t report_request_started(const std::string &session_id);
+
+        /**
+         * @brief Number of requests currently in flight.
+         * @return Started but not yet completed requests
+         */
+        size_t active_requests() const;
+
+        /**
+         * @brief Number of sessions that currently have a (not yet full) token bucket.
+         * @return Tracked sessions
          */
-        void report_request_started(const std::string &session_id);
+        size_t tracked_sessions() const;
 
     private:
         /**
@@ -95,14 +140,67 @@ namespace mcp::metrics {
          */
         RateLimiter() = default;
 
-        RateLimitConfig config_;
+        static constexpr size_t kShardCount = 64;             ///< Number of bucket shards, a power of two
+        static constexpr size_t kMaxPartitions = 256;         ///< Most partitions of requests in flight
+        static constexpr int64_t kSweepIntervalNs = 1000000000;///< Minimum time between evictions of a shard
+
+        /**
+         * @brief Token bucket of one session, encoded as the GCRA theoretical arrival time.
+         */
+        struct Bucket {
+            std::atomic<int64_t> tat{0};///< Time (ns) at which the bucket is full again
+        };
+
+        /**
+         * @brief One version of the limits, with the GCRA parameters derived from them.
+         */
+        struct Limits {
+            RateLimitConfig config;
+            int64_t emission_interval_ns = 1000000000 / 100;///< Time one token takes to refill
+            int64_t burst_window_ns = 1000000000;           ///< Emission interval times burst
+        };
+
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<std::string, Bucket> buckets;
+            std::atomic<int64_t> next_sweep{0};///< Time (ns) of the next eviction pass
+        };
+
+        struct alignas(64) Partition {
+            std::atomic<size_t> active{0};///< Requests in flight counted here
+        };
+
+        size_t thread_partition() const;
+        Shard &shard_for(const std::string &session_id);
+        bool take_token(const Limits &limits, const std::string &session_id, int64_t now);
+        void sweep(Shard &shard, int64_t now);
+        static int64_t now_ns();
+
+        core::Snapshot<Limits> limits_;
         RateLimitCallback rate_limit_callback_;
 
-        // Track concurrent requests
-        std::unordered_map<std::string, std::chrono::high_resolution_clock::time_point> active_requests_;
+        std::atomic<size_t> partition_count_{1};
+        std::array<Partition, kMaxPartitions> partitions_;///< Requests in flight across all sessions
+        std::array<Shard, kShardCount> shards_;
+    };
+
+    /**
+     * @brief Reports a request as started on construction and as completed on destruction,
+     * so every exit path of a request handler completes it exactly once.
+     */
+    class ActiveRequest {
+    public:
+        ActiveRequest(RateLimiter &limiter, const std::string &session_id)
+            : limiter_(limiter), session_id_(session_id), partition_(limiter_.report_request_started(session_id_)) {}
+        ~ActiveRequest() { limiter_.report_request_completed(session_id_, partition_); }
+
+        ActiveRequest(const ActiveRequest &) = delete;
+        ActiveRequest &operator=(const ActiveRequest &) = delete;
 
-        // Track request rates per second
-        std::unordered_map<std::string, std::vector<std::chrono::high_resolution_clock::time_point>> request_timestamps_;
+    private:
+        RateLimiter &limiter_;
+        const std::string &session_id_;///< Owned by the session, which outlives the request
+        size_t partition_;
     };
 
 }// namespace mcp::metrics
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "request_trace.h"
+#include "access_log.h"
+#include "metrics_manager.h"
+
+namespace mcp::metrics {
+
+    namespace {
+        RequestTraceOptions &options_storage() {
+            static RequestTraceOptions options;
+            return options;
+        }
+    }// namespace
+
+    void RequestTraceOptions::configure(const RequestTraceOptions &options) {
+        options_storage() = options;
+    }
+
+    const RequestTraceOptions &RequestTraceOptions::current() {
+        return options_storage();
+    }
+
+    std::string_view stage_name(RequestStage stage) {
+        switch (stage) {
+            case RequestStage::Queue:
+                return "queue";
+            case RequestStage::Parse:
+                return "parse";
+            case RequestStage::Execute:
+                return "execute";
+            case RequestStage::Plugin:
+                return "plugin";
+            case RequestStage::Serialize:
+                return "serialize";
+            case RequestStage::Write:
+                return "write";
+        }
+        return "unknown";
+    }
+
+    namespace {
+        /**
+         * @brief Whether the next request of the calling thread is one in every; counted per
+         *        thread, so sampling takes no shared state.
+         */
+        template<typename Tag>
+        bool one_in(size_t every) {
+            if (every == 0) {
+                return false;
+            }
+            thread_local size_t count = 0;
+            if (++count < every) {
+                return false;
+            }
+            count = 0;
+            return true;
+        }
+
+        struct HistogramTag;
+        struct SpanTag;
+    }// namespace
+
+    std::unique_ptr<RequestTrace> RequestTrace::sample(std::string_view traceparent, bool rpc) {
+        bool access_log = AccessLog::instance().enabled();
+        if (!rpc) {
+            if (!access_log) {
+                return nullptr;
+            }
+            auto trace = std::make_unique<RequestTrace>();
+            trace->access_log_ = true;
+            return trace;
+        }
+
+        bool histograms = one_in<HistogramTag>(options_storage().sample_every);
+        std::optional<SpanContext> parent;
+        bool exported = false;
+        if (SpanExporter::instance().enabled()) {
+            parent = traceparent.empty() ? std::nullopt : SpanContext::parse(traceparent);
+            exported = parent ? parent->sampled : one_in<SpanTag>(TracingOptions::current().sample_every);
+        }
+        if (!histograms && !exported && !access_log) {
+            return nullptr;
+        }
+
+        auto trace = std::make_unique<RequestTrace>();
+        trace->histograms_ = histograms;
+        trace->access_log_ = access_log;
+        if (exported) {
+            trace->span_ = parent ? parent->child() : SpanContext::root(true);
+            trace->parent_ = parent;
+            trace->plugin_span_ = trace->span_->child();
+        }
+        return trace;
+    }
+
+    void RequestTrace::report() const {
+        if (access_log_) {
+            log_access();
+        }
+        if (method_.empty()) {
+            return;
+        }
+        if (histograms_) {
+            // The manager lives as long as the process, so no reference is taken per request
+            static auto &manager = *MetricsManager::getInstance();
+            auto &stats = manager.request_stage_stats(method_, tool_);
+            for (size_t i = 0; i < kRequestStages; ++i) {
+                if (recorded_ & (1u << i)) {
+                    stats.stages[i].record(static_cast<uint64_t>(
+                            std::chrono::duration_cast<std::chrono::microseconds>(durations_[i]).count()));
+                }
+            }
+        }
+        if (!span_) {
+            return;
+        }
+
+        auto &exporter = SpanExporter::instance();
+        auto end = started_;
+        for (size_t i = 0; i < kRequestStages; ++i) {
+            if (recorded_ & (1u << i)) {
+                end = std::max(end, ends_[i]);
+            }
+        }
+
+        SpanData request;
+        request.context = *span_;
+        if (parent_) {
+            request.parent_span_id = parent_->span_id;
+        }
+        request.name = method_;
+        request.kind = SpanKind::Server;
+        request.start_unix_ns = unix_nanos(started_);
+        request.end_unix_ns = unix_nanos(end);
+        request.attributes = {{"rpc.system", "jsonrpc"}, {"rpc.method", method_}};
+        if (!tool_.empty()) {
+            request.attributes.emplace_back("mcp.tool.name", tool_);
+        }
+        request.error = error_;
+        exporter.submit(std::move(request));
+
+        // The plugin runs inside the execute stage, the other stages follow each other
+        std::array<SpanContext, kRequestStages> stages;
+        for (size_t i = 0; i < kRequestStages; ++i) {
+            stages[i] = static_cast<RequestStage>(i) == RequestStage::Plugin ? *plugin_span_ : span_->child();
+        }
+        const size_t execute = static_cast<size_t>(RequestStage::Execute);
+        for (size_t i = 0; i < kRequestStages; ++i) {
+            if (!(recorded_ & (1u << i))) {
+                continue;
+            }
+            auto stage = static_cast<RequestStage>(i);
+            SpanData span;
+            span.context = stages[i];
+            span.parent_span_id = stage == RequestStage::Plugin && (recorded_ & (1u << execute)) ? stages[execute].span_id : span_->span_id;
+            span.name = stage_name(stage);
+            span.start_unix_ns = unix_nanos(starts_[i]);
+            span.end_unix_ns = unix_nanos(ends_[i]);
+            if (stage == RequestStage::Plugin) {
+                span.attributes.emplace_back("mcp.tool.name", tool_);
+            }
+            exporter.submit(std::move(span));
+        }
+    }
+
+    void RequestTrace::log_access() const {
+        auto &log = AccessLog::instance();
+        if (!log.sample(status_ >= 400 || error_.has_value())) {
+            return;
+        }
+
+        auto elapsed = clock::now() - started_;
+        AccessLogEntry entry;
+        entry.time = std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(elapsed);
+        entry.session_id = session_id_;
+        entry.http_method = http_method_;
+        entry.path = path_;
+        entry.rpc_method = method_;
+        entry.tool = tool_;
+        entry.status = status_;
+        entry.request_bytes = request_bytes_;
+        entry.response_bytes = response_bytes_;
+        entry.error = error_;
+        entry.duration_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        for (size_t i = 0; i < kRequestStages; ++i) {
+            if (recorded_ & (1u << i)) {
+                entry.stage_us[i] = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(durations_[i]).count());
+            }
+        }
+        log.submit(std::move(entry));
+    }
+
+}// namespace mcp::metrics
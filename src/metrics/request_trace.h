@@ -0,0 +1,186 @@
+#pragma once
+
+#include "tracing.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace mcp::metrics {
+
+    /**
+     * @brief Sampling of the per-stage request traces, normally taken from the [server] config section.
+     */
+    struct RequestTraceOptions {
+        size_t sample_every = 0;///< Trace one in this many POST requests of each io thread, 0 = off
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const RequestTraceOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const RequestTraceOptions &current();
+    };
+
+    /**
+     * @brief Stages a JSON-RPC request passes through, in order.
+     */
+    enum class RequestStage : size_t {
+        Queue,    ///< From the HTTP handler to the business layer: body decoding, admission, the hop to the tool pool
+        Parse,    ///< Parsing the JSON-RPC message
+        Execute,  ///< Running the method's handler
+        Plugin,   ///< The plugin's part of Execute, for synchronous tool calls
+        Serialize,///< Serializing the response
+        Write,    ///< Compressing and writing the response
+    };
+
+    inline constexpr size_t kRequestStages = 6;
+
+    /**
+     * @brief Label of a stage, such as "queue".
+     */
+    std::string_view stage_name(RequestStage stage);
+
+    /**
+     * @brief Stage timings of one sampled request.
+     *
+     * Created by the HTTP handler for a sampled request and owned by its session; the layers
+     * the request passes through add the stages they run and the session reports the trace
+     * once the response is written. A request that is not sampled has no trace, so the cost of
+     * tracing is a null check per stage. Used by one thread at a time, like the request.
+     *
+     * A request can be sampled for the stage histograms, for span export (see SpanExporter) or
+     * both. An exported request becomes a server span, child of the client's traceparent if it
+     * sent one, with a child span per stage. While the access log is on every request is traced,
+     * and the access log samples the completed ones, see AccessLog.
+     */
+    class RequestTrace {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Start a trace if the next request is sampled, see RequestTraceOptions and TracingOptions.
+         * A request with a traceparent is exported if the client sampled it, others one in
+         * TracingOptions::sample_every.
+         * @param traceparent traceparent header of the request, empty if it has none
+         * @param rpc The request may carry a JSON-RPC message; others are only traced for the access log
+         * @return Trace, nullptr for a request that is not traced
+         */
+        static std::unique_ptr<RequestTrace> sample(std::string_view traceparent = {}, bool rpc = true);
+
+        /**
+         * @brief When the request reached the HTTP handler, the start of the queue stage.
+         */
+        clock::time_point started() const { return started_; }
+
+        /**
+         * @brief Set the JSON-RPC method label; requests without one (rejected early) are not reported.
+         */
+        void set_method(std::string_view method) { method_ = method; }
+
+        /**
+         * @brief Set the tool label of a tool call.
+         */
+        void set_tool(std::string_view tool) { tool_ = tool; }
+
+        /**
+         * @brief Describe the HTTP request, for the access log.
+         */
+        void set_request(std::string_view http_method, std::string_view path, std::string_view session_id, size_t bytes) {
+            if (access_log_) {
+                http_method_ = http_method;
+                path_ = path;
+                session_id_ = session_id;
+                request_bytes_ = bytes;
+            }
+        }
+
+        /**
+         * @brief Set the HTTP status and size of the response, for the access log.
+         */
+        void set_response(int status, size_t bytes) {
+            status_ = status;
+            response_bytes_ = bytes;
+        }
+
+        /**
+         * @brief Context of the request's span, nullptr if it is not exported.
+         */
+        const SpanContext *span_context() const { return span_ ? &*span_ : nullptr; }
+
+        /**
+         * @brief Context of the plugin stage's span, made current while the plugin runs so it can
+         *        propagate it; nullptr if the request is not exported.
+         */
+        const SpanContext *plugin_context() const { return plugin_span_ ? &*plugin_span_ : nullptr; }
+
+        /**
+         * @brief Mark the request as failed, for the status of its span.
+         */
+        void set_error(std::string message) { error_ = std::move(message); }
+
+        /**
+         * @brief Add a span of time to a stage; a stage added more than once spans from its first start to its last end.
+         */
+        void add(RequestStage stage, clock::time_point start, clock::time_point end) {
+            auto index = static_cast<size_t>(stage);
+            if (!(recorded_ & (1u << index))) {
+                starts_[index] = start;
+            }
+            ends_[index] = end;
+            durations_[index] += end - start;
+            recorded_ |= 1u << index;
+        }
+
+        /**
+         * @brief Add the time from a point until now to a stage.
+         * @param stage Stage that ends now
+         * @param since When it started
+         * @return Now, the start of the next stage
+         */
+        clock::time_point lap(RequestStage stage, clock::time_point since) {
+            auto now = clock::now();
+            add(stage, since, now);
+            return now;
+        }
+
+        /**
+         * @brief Record the stages into the histograms of the method and tool, export the spans
+         *        and hand the request to the access log.
+         */
+        void report() const;
+
+    private:
+        void log_access() const;
+
+        clock::time_point started_ = clock::now();
+        bool histograms_ = false;              ///< Sampled for the stage histograms
+        std::optional<SpanContext> span_;      ///< Set if the request is exported
+        std::optional<SpanContext> parent_;    ///< The client's span, from its traceparent
+        std::optional<SpanContext> plugin_span_;
+        std::string method_;
+        std::string tool_;
+        std::optional<std::string> error_;
+        std::array<clock::time_point, kRequestStages> starts_{};
+        std::array<clock::time_point, kRequestStages> ends_{};
+        std::array<clock::duration, kRequestStages> durations_{};
+        uint32_t recorded_ = 0;///< Bit per stage that was added
+        bool access_log_ = false;///< Traced for the access log
+        std::string http_method_;
+        std::string path_;
+        std::string session_id_;
+        size_t request_bytes_ = 0;
+        int status_ = 0;
+        size_t response_bytes_ = 0;
+    };
+
+}// namespace mcp::metrics
@@ -0,0 +1,404 @@
+#include "tracing.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <asio.hpp>
+#include <random>
+
+namespace mcp::metrics {
+
+    namespace {
+        TracingOptions &options_storage() {
+            static TracingOptions options;
+            return options;
+        }
+
+        thread_local const SpanContext *current_context = nullptr;
+
+        constexpr size_t kQueuedBatches = 4;                     ///< Batches queued at most before spans are dropped
+        constexpr std::chrono::seconds kExportTimeout{10};       ///< Longest export request, a hung collector only delays its batch
+        constexpr std::string_view kHexDigits = "0123456789abcdef";
+
+        template<size_t N>
+        void random_bytes(std::array<uint8_t, N> &bytes) {
+            // All zero ids are invalid, a draw of zeros is repeated
+            thread_local std::mt19937_64 engine{std::random_device{}()};
+            do {
+                for (size_t i = 0; i < N; i += 8) {
+                    uint64_t value = engine();
+                    for (size_t j = 0; j < 8 && i + j < N; ++j) {
+                        bytes[i + j] = static_cast<uint8_t>(value >> (j * 8));
+                    }
+                }
+            } while (std::all_of(bytes.begin(), bytes.end(), [](uint8_t b) { return b == 0; }));
+        }
+
+        int hex_value(char c) {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            return -1;// Upper case is invalid in traceparent
+        }
+
+        template<size_t N>
+        bool parse_hex(std::string_view text, std::array<uint8_t, N> &bytes) {
+            if (text.size() != N * 2) {
+                return false;
+            }
+            bool all_zero = true;
+            for (size_t i = 0; i < N; ++i) {
+                int high = hex_value(text[2 * i]);
+                int low = hex_value(text[2 * i + 1]);
+                if (high < 0 || low < 0) {
+                    return false;
+                }
+                bytes[i] = static_cast<uint8_t>(high << 4 | low);
+                all_zero = all_zero && bytes[i] == 0;
+            }
+            return !all_zero;
+        }
+
+        template<size_t N>
+        void append_hex(std::string &out, const std::array<uint8_t, N> &bytes) {
+            for (uint8_t b: bytes) {
+                out += kHexDigits[b >> 4];
+                out += kHexDigits[b & 0xf];
+            }
+        }
+
+        void append_attribute(std::string &out, std::string_view key, std::string_view value) {
+            out += "{\"key\":";
+            append_json_string(out, key);
+            out += ",\"value\":{\"stringValue\":";
+            append_json_string(out, value);
+            out += "}}";
+        }
+
+        /**
+         * @brief Encode spans as an OTLP/JSON ExportTraceServiceRequest.
+         */
+        std::string encode(const std::vector<SpanData> &spans, std::string_view service_name) {
+            std::string out;
+            out.reserve(256 + spans.size() * 384);
+            out += "{\"resourceSpans\":[{\"resource\":{\"attributes\":[";
+            append_attribute(out, "service.name", service_name);
+            out += "]},\"scopeSpans\":[{\"scope\":{\"name\":\"mcp-server\"},\"spans\":[";
+            for (size_t i = 0; i < spans.size(); ++i) {
+                const auto &span = spans[i];
+                if (i > 0) {
+                    out += ',';
+                }
+                out += "{\"traceId\":\"";
+                append_hex(out, span.context.trace_id);
+                out += "\",\"spanId\":\"";
+                append_hex(out, span.context.span_id);
+                out += '"';
+                if (span.parent_span_id) {
+                    out += ",\"parentSpanId\":\"";
+                    append_hex(out, *span.parent_span_id);
+                    out += '"';
+                }
+                out += ",\"name\":";
+                append_json_string(out, span.name);
+                out += ",\"kind\":";
+                out += std::to_string(static_cast<int>(span.kind));
+                out += ",\"startTimeUnixNano\":\"";
+                out += std::to_string(span.start_unix_ns);
+                out += "\",\"endTimeUnixNano\":\"";
+                out += std::to_string(span.end_unix_ns);
+                out += "\",\"attributes\":[";
+                for (size_t j = 0; j < span.attributes.size(); ++j) {
+                    if (j > 0) {
+                        out += ',';
+                    }
+                    append_attribute(out, span.attributes[j].first, span.attributes[j].second);
+                }
+                out += ']';
+                if (span.error) {
+                    out += ",\"status\":{\"code\":2,\"message\":";
+                    append_json_string(out, *span.error);
+                    out += '}';
+                }
+                out += '}';
+            }
+            out += "]}]}]}";
+            return out;
+        }
+    }// namespace
+
+    void TracingOptions::configure(const TracingOptions &options) {
+        options_storage() = options;
+    }
+
+    const TracingOptions &TracingOptions::current() {
+        return options_storage();
+    }
+
+    void append_json_string(std::string &out, std::string_view value) {
+        out += '"';
+        for (char c: value) {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += "\\u00";
+                        out += kHexDigits[(c >> 4) & 0xf];
+                        out += kHexDigits[c & 0xf];
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    std::optional<SpanContext> SpanContext::parse(std::string_view traceparent) {
+        // Only version 00 is understood, which has exactly these four fields
+        if (traceparent.size() != 55 || traceparent.substr(0, 3) != "00-" || traceparent[35] != '-' || traceparent[52] != '-') {
+            return std::nullopt;
+        }
+        SpanContext context;
+        std::array<uint8_t, 1> flags{};
+        if (!parse_hex(traceparent.substr(3, 32), context.trace_id) || !parse_hex(traceparent.substr(36, 16), context.span_id)) {
+            return std::nullopt;
+        }
+        if (hex_value(traceparent[53]) < 0 || hex_value(traceparent[54]) < 0) {
+            return std::nullopt;
+        }
+        parse_hex(traceparent.substr(53, 2), flags);// Zero flags are valid, unlike zero ids
+        context.sampled = (flags[0] & 0x1) != 0;
+        return context;
+    }
+
+    SpanContext SpanContext::root(bool sampled) {
+        SpanContext context;
+        random_bytes(context.trace_id);
+        random_bytes(context.span_id);
+        context.sampled = sampled;
+        return context;
+    }
+
+    SpanContext SpanContext::child() const {
+        SpanContext context = *this;
+        random_bytes(context.span_id);
+        return context;
+    }
+
+    std::string SpanContext::traceparent() const {
+        std::string out = "00-";
+        out.reserve(55);
+        append_hex(out, trace_id);
+        out += '-';
+        append_hex(out, span_id);
+        out += sampled ? "-01" : "-00";
+        return out;
+    }
+
+    SpanContext::Scope::Scope(const SpanContext *context) : previous_(current_context) {
+        current_context = context;
+    }
+
+    SpanContext::Scope::~Scope() {
+        current_context = previous_;
+    }
+
+    const SpanContext *SpanContext::current() {
+        return current_context;
+    }
+
+    uint64_t unix_nanos(std::chrono::steady_clock::time_point time) {
+        // The offset between the clocks is taken once, so spans of a trace never move against each other
+        static const auto offset = std::chrono::system_clock::now().time_since_epoch() -
+                                   std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                           std::chrono::steady_clock::now().time_since_epoch());
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             time.time_since_epoch() + offset)
+                                             .count());
+    }
+
+    Span::Span(std::string name, const SpanContext &parent) {
+        data_.context = parent.child();
+        data_.parent_span_id = parent.span_id;
+        data_.name = std::move(name);
+        data_.start_unix_ns = unix_nanos(std::chrono::steady_clock::now());
+    }
+
+    void Span::end() {
+        if (ended_) {
+            return;
+        }
+        ended_ = true;
+        data_.end_unix_ns = unix_nanos(std::chrono::steady_clock::now());
+        if (data_.context.sampled) {
+            SpanExporter::instance().submit(std::move(data_));
+        }
+    }
+
+    SpanExporter &SpanExporter::instance() {
+        static SpanExporter exporter;
+        return exporter;
+    }
+
+    SpanExporter::~SpanExporter() {
+        shutdown();
+    }
+
+    void SpanExporter::start() {
+        const auto &options = TracingOptions::current();
+        if (options.otlp_endpoint.empty() || thread_.joinable()) {
+            return;
+        }
+
+        auto endpoint = HttpEndpoint::parse(options.otlp_endpoint, "/v1/traces");
+        if (!endpoint) {
+            MCP_WARN("Tracing disabled: otlp_endpoint {} is not an http:// URL", options.otlp_endpoint);
+            return;
+        }
+        endpoint_ = std::move(*endpoint);
+
+        stopping_ = false;
+        enabled_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread([this]() { run(); });
+        MCP_INFO("Exporting traces to http://{}:{}{}", endpoint_.host, endpoint_.port, endpoint_.path);
+    }
+
+    void SpanExporter::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            stopping_ = true;
+        }
+        enabled_.store(false, std::memory_order_relaxed);
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void SpanExporter::submit(SpanData span) {
+        if (!enabled()) {
+            return;
+        }
+        const size_t batch_size = std::max<size_t>(1, TracingOptions::current().batch_size);
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= batch_size * kQueuedBatches) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            queue_.push_back(std::move(span));
+            full = queue_.size() == batch_size;
+        }
+        if (full) {
+            wake_.notify_one();
+        }
+    }
+
+    void SpanExporter::run() {
+        const auto &options = TracingOptions::current();
+        const size_t batch_size = std::max<size_t>(1, options.batch_size);
+        std::vector<SpanData> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait_for(lock, options.export_interval, [&]() { return stopping_ || queue_.size() >= batch_size; });
+            if (queue_.empty()) {
+                if (stopping_) {
+                    return;
+                }
+                continue;
+            }
+            size_t count = std::min(batch_size, queue_.size());
+            batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + static_cast<std::ptrdiff_t>(count)));
+            queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(count));
+
+            // The collector is called without the lock, spans keep queueing meanwhile
+            lock.unlock();
+            if (endpoint_.post_json(encode(batch, options.service_name), "spans")) {
+                exported_.fetch_add(batch.size(), std::memory_order_relaxed);
+            } else {
+                dropped_.fetch_add(batch.size(), std::memory_order_relaxed);
+            }
+            batch.clear();
+            lock.lock();
+        }
+    }
+
+    std::optional<HttpEndpoint> HttpEndpoint::parse(std::string_view url, std::string_view default_path) {
+        constexpr std::string_view scheme = "http://";
+        if (url.substr(0, scheme.size()) != scheme) {
+            return std::nullopt;
+        }
+        url.remove_prefix(scheme.size());
+        HttpEndpoint endpoint;
+        auto slash = url.find('/');
+        std::string_view authority = url.substr(0, slash);
+        endpoint.path = slash == std::string_view::npos || slash + 1 == url.size() ? std::string(default_path) : std::string(url.substr(slash));
+        auto colon = authority.rfind(':');
+        if (colon != std::string_view::npos && authority.find(']', colon) == std::string_view::npos) {
+            endpoint.host = std::string(authority.substr(0, colon));
+            endpoint.port = std::string(authority.substr(colon + 1));
+        } else {
+            endpoint.host = std::string(authority);
+            endpoint.port = "4318";
+        }
+        if (endpoint.host.size() > 2 && endpoint.host.front() == '[' && endpoint.host.back() == ']') {
+            endpoint.host = endpoint.host.substr(1, endpoint.host.size() - 2);
+        }
+        return endpoint;
+    }
+
+    bool HttpEndpoint::post_json(const std::string &body, std::string_view what) const {
+        std::string header = "POST " + path + " HTTP/1.1\r\nHost: " + host + ":" + port +
+                             "\r\nContent-Type: application/json\r\nConnection: close\r\nContent-Length: " +
+                             std::to_string(body.size()) + "\r\n\r\n";
+
+        asio::io_context io;
+        asio::ip::tcp::resolver resolver(io);
+        asio::ip::tcp::socket socket(io);
+        std::string status_line;
+        asio::co_spawn(
+                io,
+                [&]() -> asio::awaitable<void> {
+                    auto endpoints = co_await resolver.async_resolve(host, port, asio::use_awaitable);
+                    co_await asio::async_connect(socket, endpoints, asio::use_awaitable);
+                    std::array<asio::const_buffer, 2> buffers = {asio::buffer(header), asio::buffer(body)};
+                    co_await asio::async_write(socket, buffers, asio::use_awaitable);
+                    co_await asio::async_read_until(socket, asio::dynamic_buffer(status_line), "\r\n", asio::use_awaitable);
+                },
+                [](std::exception_ptr) {});
+        io.run_for(kExportTimeout);
+        if (!io.stopped()) {
+            resolver.cancel();
+            asio::error_code ignored;
+            socket.close(ignored);
+            io.run();
+        }
+
+        // "HTTP/1.1 200 OK", any 2xx is a success
+        bool ok = status_line.size() > 9 && status_line.compare(0, 5, "HTTP/") == 0 &&
+                  status_line[status_line.find(' ') + 1] == '2';
+        if (!ok) {
+            MCP_WARN("Exporting {} to {}:{} failed: {}", what, host, port,
+                     status_line.empty() ? std::string("no response") : status_line.substr(0, status_line.find('\r')));
+        }
+        return ok;
+    }
+
+}// namespace mcp::metrics
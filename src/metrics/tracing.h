@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mcp::metrics {
+
+    /**
+     * @brief Export of tracing spans, normally taken from the [server] config section.
+     */
+    struct TracingOptions {
+        std::string otlp_endpoint;                   ///< OTLP/HTTP collector, such as "http://localhost:4318"; empty = tracing off
+        std::string service_name = "mcp-server";     ///< service.name of the exported spans
+        size_t sample_every = 1;                     ///< Trace one in this many requests that arrive without a traceparent
+        size_t batch_size = 512;                     ///< Spans per export request; up to four batches are queued, more are dropped
+        std::chrono::milliseconds export_interval{5000};///< Longest time a span waits to be exported
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const TracingOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const TracingOptions &current();
+    };
+
+    /**
+     * @brief W3C trace context of a span.
+     */
+    struct SpanContext {
+        std::array<uint8_t, 16> trace_id{};
+        std::array<uint8_t, 8> span_id{};
+        bool sampled = false;
+
+        /**
+         * @brief Parse a traceparent header.
+         * @param traceparent Header value, "00-<32 hex trace id>-<16 hex span id>-<2 hex flags>"
+         * @return Context of the caller's span, std::nullopt if the header is missing or invalid
+         */
+        static std::optional<SpanContext> parse(std::string_view traceparent);
+
+        /**
+         * @brief Context of a new trace, with random ids.
+         */
+        static SpanContext root(bool sampled);
+
+        /**
+         * @brief Context of a child span of this one: the same trace and a new span id.
+         */
+        SpanContext child() const;
+
+        /**
+         * @brief Format as a traceparent header value.
+         */
+        std::string traceparent() const;
+
+        /**
+         * @brief Sets the context of the calling thread for as long as it lives.
+         * Plugins read it through the trace source they are handed, see MCPTraceSource.
+         */
+        class Scope {
+        public:
+            explicit Scope(const SpanContext *context);
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const SpanContext *previous_;
+        };
+
+        /**
+         * @brief Context of the calling thread, nullptr outside of a Scope.
+         */
+        static const SpanContext *current();
+    };
+
+    enum class SpanKind {
+        Internal = 1,
+        Server = 2,
+    };
+
+    /**
+     * @brief A finished span, as it is exported.
+     */
+    struct SpanData {
+        SpanContext context;
+        std::optional<std::array<uint8_t, 8>> parent_span_id;
+        std::string name;
+        SpanKind kind = SpanKind::Internal;
+        uint64_t start_unix_ns = 0;
+        uint64_t end_unix_ns = 0;
+        std::vector<std::pair<std::string, std::string>> attributes;
+        std::optional<std::string> error;///< Status message of a failed span
+    };
+
+    /**
+     * @brief Time since the epoch of a steady clock time point, for span timestamps.
+     */
+    uint64_t unix_nanos(std::chrono::steady_clock::time_point time);
+
+    /**
+     * @brief Append text as a JSON string literal, quotes included.
+     */
+    void append_json_string(std::string &out, std::string_view value);
+
+    /**
+     * @brief An OTLP/HTTP collector, or any other http:// endpoint taking JSON.
+     */
+    struct HttpEndpoint {
+        std::string host;
+        std::string port;
+        std::string path;
+
+        /**
+         * @brief Parse "http://host[:port][/path]"; the port defaults to the OTLP/HTTP one, 4318.
+         * @param url URL
+         * @param default_path Path of a URL without one, such as "/v1/traces"
+         * @return Endpoint, std::nullopt if the URL is not http://
+         */
+        static std::optional<HttpEndpoint> parse(std::string_view url, std::string_view default_path);
+
+        /**
+         * @brief POST a JSON body on a connection of its own, for at most ten seconds.
+         * @param body Request body
+         * @param what What is sent, for the warning logged on failure
+         * @return Whether the endpoint answered with a 2xx status
+         */
+        bool post_json(const std::string &body, std::string_view what) const;
+    };
+
+    /**
+     * @brief Span that is exported when it ends, or when it is destroyed.
+     * For work that outlives a request, such as an event stream; the stages of a request are
+     * exported by its RequestTrace.
+     */
+    class Span {
+    public:
+        /**
+         * @param name Span name
+         * @param parent Context of the parent span
+         */
+        Span(std::string name, const SpanContext &parent);
+        ~Span() { end(); }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+        const SpanContext &context() const { return data_.context; }
+
+        void set_attribute(std::string key, std::string value) { data_.attributes.emplace_back(std::move(key), std::move(value)); }
+        void set_error(std::string message) { data_.error = std::move(message); }
+
+        /**
+         * @brief End the span and hand it to the exporter; later calls do nothing.
+         */
+        void end();
+
+    private:
+        SpanData data_;
+        bool ended_ = false;
+    };
+
+    /**
+     * @brief Exports finished spans to an OTLP/HTTP collector, in batches, from its own thread.
+     *
+     * Submitting a span only appends it to a queue. The export thread sends a batch once it is
+     * full or export_interval has passed, encoded as OTLP JSON, so the request path never waits
+     * for the collector. When the collector can't keep up the queue is bounded and further spans
+     * are dropped and counted.
+     */
+    class SpanExporter {
+    public:
+        static SpanExporter &instance();
+
+        /**
+         * @brief Start exporting to the configured endpoint; does nothing if it is empty or not http://.
+         */
+        void start();
+
+        /**
+         * @brief Export what is queued and stop the export thread.
+         */
+        void shutdown();
+
+        /**
+         * @brief Whether spans are exported; nothing needs to be traced otherwise.
+         */
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Queue a finished span; dropped if the exporter is disabled or its queue is full.
+         */
+        void submit(SpanData span);
+
+        uint64_t exported() const { return exported_.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        SpanExporter() = default;
+        ~SpanExporter();
+
+        void run();
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::vector<SpanData> queue_;
+        std::thread thread_;
+        bool stopping_ = false;
+        std::atomic<bool> enabled_{false};
+        std::atomic<uint64_t> exported_{0};
+        std::atomic<uint64_t> dropped_{0};
+
+        HttpEndpoint endpoint_;
+    };
+
+}// namespace mcp::metrics
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+// nlohmann::json is instantiated once, in json_rpc.cpp, for every target linking mcp_protocol
+// (the server's libraries and plugins built with the SDK); without this each translation unit
+// using it would instantiate the class again. Code including the headers without linking
+// mcp_protocol does not get MCP_JSON_EXTERN_TEMPLATE and keeps its own instantiation.
+#if defined(MCP_JSON_EXTERN_TEMPLATE)
+extern template class nlohmann::basic_json<>;
+#endif
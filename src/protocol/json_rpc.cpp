@@ -1,5 +1,13 @@
 #include "json_rpc.h"
+#include "utils/utf8.h"
+#include <algorithm>
+#include <cctype>
 #include <string>
+#include <utility>
+
+#if defined(MCP_JSON_EXTERN_TEMPLATE)
+template class nlohmann::basic_json<>;
+#endif
 
 namespace mcp::protocol {
 
@@ -10,13 +18,346 @@ namespace mcp::protocol {
             return j.contains("jsonrpc") && j["jsonrpc"].is_string() &&
                    j["jsonrpc"].get<std::string>() == "2.0";
         }
+
+        // Validating skipper over JSON text, positions are offsets into text
+        class JsonScanner {
+        public:
+            static constexpr std::size_t kFailed = std::string_view::npos;
+            static constexpr int kMaxDepth = 512;// Deeper documents are left to the full parser
+
+            explicit JsonScanner(std::string_view text) : text_(text) {}
+
+            std::size_t skip_whitespace(std::size_t pos) const {
+                while (pos < text_.size() && (text_[pos] == ' ' || text_[pos] == '\t' || text_[pos] == '\n' || text_[pos] == '\r')) {
+                    ++pos;
+                }
+                return pos;
+            }
+
+            // Position one past the value that starts at pos, kFailed if it is malformed
+            std::size_t skip_value(std::size_t pos, int depth = 0) const {
+                if (pos >= text_.size() || depth > kMaxDepth) {
+                    return kFailed;
+                }
+                switch (text_[pos]) {
+                    case '"':
+                        return skip_string(pos);
+                    case '{':
+                        return skip_object(pos, depth, nullptr);
+                    case '[':
+                        return skip_array(pos, depth, nullptr);
+                    case 't':
+                        return skip_literal(pos, "true");
+                    case 'f':
+                        return skip_literal(pos, "false");
+                    case 'n':
+                        return skip_literal(pos, "null");
+                    default:
+                        return skip_number(pos);
+                }
+            }
+
+            // Walk an object, calling on_member(key, value) with raw spans for each member
+            template<typename OnMember>
+            std::size_t skip_object(std::size_t pos, int depth, OnMember *on_member) const {
+                pos = skip_whitespace(pos + 1);
+                if (pos < text_.size() && text_[pos] == '}') {
+                    return pos + 1;
+                }
+                while (pos < text_.size()) {
+                    auto key_end = skip_string(pos);
+                    if (key_end == kFailed) {
+                        return kFailed;
+                    }
+                    auto key = text_.substr(pos + 1, key_end - pos - 2);
+                    pos = skip_whitespace(key_end);
+                    if (pos >= text_.size() || text_[pos] != ':') {
+                        return kFailed;
+                    }
+                    auto value_begin = skip_whitespace(pos + 1);
+                    auto value_end = skip_value(value_begin, depth + 1);
+                    if (value_end == kFailed) {
+                        return kFailed;
+                    }
+                    if (on_member) {
+                        (*on_member)(key, text_.substr(value_begin, value_end - value_begin));
+                    }
+                    pos = skip_whitespace(value_end);
+                    if (pos < text_.size() && text_[pos] == ',') {
+                        pos = skip_whitespace(pos + 1);
+                    } else if (pos < text_.size() && text_[pos] == '}') {
+                        return pos + 1;
+                    } else {
+                        return kFailed;
+                    }
+                }
+                return kFailed;
+            }
+
+            std::size_t skip_object(std::size_t pos, int depth, std::nullptr_t) const {
+                auto ignore = [](std::string_view, std::string_view) {};
+                return skip_object(pos, depth, &ignore);
+            }
+
+            // Walk an array, calling on_element(value) with the raw span of each element
+            template<typename OnElement>
+            std::size_t skip_array(std::size_t pos, int depth, OnElement *on_element) const {
+                pos = skip_whitespace(pos + 1);
+                if (pos < text_.size() && text_[pos] == ']') {
+                    return pos + 1;
+                }
+                while (pos < text_.size()) {
+                    auto value_end = skip_value(pos, depth + 1);
+                    if (value_end == kFailed) {
+                        return kFailed;
+                    }
+                    if (on_element) {
+                        (*on_element)(text_.substr(pos, value_end - pos));
+                    }
+                    pos = skip_whitespace(value_end);
+                    if (pos < text_.size() && text_[pos] == ',') {
+                        pos = skip_whitespace(pos + 1);
+                    } else if (pos < text_.size() && text_[pos] == ']') {
+                        return pos + 1;
+                    } else {
+                        return kFailed;
+                    }
+                }
+                return kFailed;
+            }
+
+            std::size_t skip_array(std::size_t pos, int depth, std::nullptr_t) const {
+                auto ignore = [](std::string_view) {};
+                return skip_array(pos, depth, &ignore);
+            }
+
+        private:
+            std::size_t skip_string(std::size_t pos) const {
+                if (pos >= text_.size() || text_[pos] != '"') {
+                    return kFailed;
+                }
+                std::size_t begin = pos + 1;
+                for (++pos; pos < text_.size(); ++pos) {
+                    auto c = static_cast<unsigned char>(text_[pos]);
+                    if (c == '"') {
+                        // Escapes are ASCII, so the raw text is valid UTF-8 if the value is
+                        return mcp::utils::utf8_valid(text_.data() + begin, pos - begin) ? pos + 1 : kFailed;
+                    }
+                    if (c < 0x20) {
+                        return kFailed;// Control characters must be escaped
+                    }
+                    if (c != '\\') {
+                        continue;
+                    }
+                    if (++pos >= text_.size()) {
+                        return kFailed;
+                    }
+                    switch (text_[pos]) {
+                        case '"':
+                        case '\\':
+                        case '/':
+                        case 'b':
+                        case 'f':
+                        case 'n':
+                        case 'r':
+                        case 't':
+                            break;
+                        case 'u':
+                            for (int i = 0; i < 4; ++i) {
+                                if (++pos >= text_.size() || !std::isxdigit(static_cast<unsigned char>(text_[pos]))) {
+                                    return kFailed;
+                                }
+                            }
+                            break;
+                        default:
+                            return kFailed;
+                    }
+                }
+                return kFailed;
+            }
+
+            std::size_t skip_literal(std::size_t pos, std::string_view literal) const {
+                return text_.substr(pos, literal.size()) == literal ? pos + literal.size() : kFailed;
+            }
+
+            std::size_t skip_number(std::size_t pos) const {
+                auto digits = [this](std::size_t p) {
+                    auto start = p;
+                    while (p < text_.size() && text_[p] >= '0' && text_[p] <= '9') {
+                        ++p;
+                    }
+                    return p == start ? kFailed : p;
+                };
+                if (pos < text_.size() && text_[pos] == '-') {
+                    ++pos;
+                }
+                if (pos < text_.size() && text_[pos] == '0') {
+                    ++pos;// No leading zeros
+                } else if ((pos = digits(pos)) == kFailed) {
+                    return kFailed;
+                }
+                if (pos < text_.size() && text_[pos] == '.') {
+                    if ((pos = digits(pos + 1)) == kFailed) {
+                        return kFailed;
+                    }
+                }
+                if (pos < text_.size() && (text_[pos] == 'e' || text_[pos] == 'E')) {
+                    ++pos;
+                    if (pos < text_.size() && (text_[pos] == '+' || text_[pos] == '-')) {
+                        ++pos;
+                    }
+                    if ((pos = digits(pos)) == kFailed) {
+                        return kFailed;
+                    }
+                }
+                return pos;
+            }
+
+            std::string_view text_;
+        };
+
+        // Parse only the envelope members a request needs
+        nlohmann::json parse_envelope(const RequestEnvelope &envelope) {
+            nlohmann::json j = nlohmann::json::object();
+            if (!envelope.jsonrpc.empty()) {
+                j["jsonrpc"] = envelope.jsonrpc == "\"2.0\"" ? nlohmann::json("2.0") : nlohmann::json::parse(envelope.jsonrpc);
+            }
+            if (!envelope.method.empty()) {
+                auto method = decode_string(envelope.method);
+                j["method"] = method ? nlohmann::json(std::move(*method)) : nlohmann::json::parse(envelope.method);
+            }
+            if (envelope.has_id()) {
+                j["id"] = nlohmann::json::parse(envelope.id);
+            }
+            if (!envelope.params.empty()) {
+                j["params"] = nlohmann::json::parse(envelope.params);
+            }
+            return j;
+        }
+
+        // Build the request straight from the envelope of a valid one, without the document object,
+        // its keys and the method's second copy. Anything else, std::nullopt, goes through
+        // parse_envelope and is checked and reported as before
+        std::optional<Request> request_from_envelope(const RequestEnvelope &envelope) {
+            if (envelope.jsonrpc != "\"2.0\"") {
+                return std::nullopt;
+            }
+            auto method = decode_string(envelope.method);
+            if (!method) {
+                return std::nullopt;
+            }
+            std::optional<nlohmann::json> id;
+            if (envelope.has_id()) {
+                id = nlohmann::json::parse(envelope.id);
+                if (!id->is_number() && !id->is_string() && !id->is_null()) {
+                    return std::nullopt;
+                }
+            }
+            nlohmann::json params = envelope.params.empty() ? nlohmann::json{} : nlohmann::json::parse(envelope.params);
+            return Request(std::move(*method), std::move(params), std::move(id));
+        }
     }// namespace
 
+    // ==================== envelope scanning ====================
+    std::optional<RequestEnvelope> scan_request_envelope(std::string_view text) {
+        JsonScanner scanner(text);
+        auto pos = scanner.skip_whitespace(0);
+        if (pos >= text.size() || text[pos] != '{') {
+            return std::nullopt;
+        }
+
+        // Later duplicates win, as with the full parser
+        RequestEnvelope envelope;
+        auto on_member = [&envelope](std::string_view key, std::string_view value) {
+            if (key == "jsonrpc") {
+                envelope.jsonrpc = value;
+            } else if (key == "method") {
+                envelope.method = value;
+            } else if (key == "id") {
+                envelope.id = value;
+            } else if (key == "params") {
+                envelope.params = value;
+            }
+        };
+        pos = scanner.skip_object(pos, 0, &on_member);
+        if (pos == JsonScanner::kFailed || scanner.skip_whitespace(pos) != text.size()) {
+            return std::nullopt;
+        }
+        return envelope;
+    }
+
+    std::optional<std::vector<std::string_view>> scan_batch(std::string_view text) {
+        JsonScanner scanner(text);
+        auto pos = scanner.skip_whitespace(0);
+        if (pos >= text.size() || text[pos] != '[') {
+            return std::nullopt;
+        }
+
+        std::vector<std::string_view> elements;
+        auto on_element = [&elements](std::string_view value) { elements.push_back(value); };
+        pos = scanner.skip_array(pos, 0, &on_element);
+        if (pos == JsonScanner::kFailed || scanner.skip_whitespace(pos) != text.size()) {
+            return std::nullopt;
+        }
+        return elements;
+    }
+
+    std::string_view find_member(std::string_view object, std::string_view key) {
+        JsonScanner scanner(object);
+        auto pos = scanner.skip_whitespace(0);
+        if (pos >= object.size() || object[pos] != '{') {
+            return {};
+        }
+        std::string_view found;
+        auto on_member = [&found, key](std::string_view name, std::string_view value) {
+            if (name == key) {
+                found = value;
+            }
+        };
+        if (scanner.skip_object(pos, 0, &on_member) == JsonScanner::kFailed) {
+            return {};
+        }
+        return found;
+    }
+
+    std::optional<std::string> decode_string(std::string_view raw) {
+        if (raw.size() < 2 || raw.front() != '"' || raw.back() != '"') {
+            return std::nullopt;
+        }
+        auto body = raw.substr(1, raw.size() - 2);
+        if (body.find('\\') == std::string_view::npos) {
+            return mcp::utils::utf8_valid(body) ? std::optional<std::string>(body) : std::nullopt;
+        }
+        try {
+            auto value = nlohmann::json::parse(raw);
+            if (value.is_string()) {
+                return value.get<std::string>();
+            }
+        } catch (const nlohmann::json::exception &) {
+        }
+        return std::nullopt;
+    }
+
     // ==================== parse_request implementation ====================
-    std::pair<std::optional<Request>, std::optional<Error>> parse_request(const std::string &text) {
+    std::pair<std::optional<Request>, std::optional<Error>> parse_request(std::string_view text) {
         nlohmann::json j;
+        bool parsed = false;
+        if (auto envelope = scan_request_envelope(text)) {
+            try {
+                if (auto req = request_from_envelope(*envelope)) {
+                    return {std::move(req), std::nullopt};
+                }
+                j = parse_envelope(*envelope);
+                parsed = true;
+            } catch (const nlohmann::json::parse_error &) {
+                // Reported by the full parse below
+            }
+        }
         try {
-            j = nlohmann::json::parse(text);
+            // The full parse only runs for texts the envelope path rejected, to report the error
+            if (!parsed) {
+                j = nlohmann::json::parse(text);
+            }
         } catch (const nlohmann::json::parse_error &e) {
             // JSON parsing failed (PARSE_ERROR)
             return {
@@ -80,40 +421,160 @@ namespace mcp::protocol {
         }
 
         // Build and return valid request
+        // params is moved out, it can be the bulk of the request
+        auto params = j.find("params");
         Request req(
                 j["method"].get<std::string>(),
-                j.value("params", nlohmann::json{}),
+                params != j.end() ? std::move(*params) : nlohmann::json{},
                 req_id);
         return {req, std::nullopt};
     }
 
-    // ==================== make_response implementations ====================
-    std::string make_response(const Response &resp) {
-        if (!resp.is_valid()) {
-            return make_error(
-                    error_code::INTERNAL_ERROR,
-                    "Invalid response: contains both result and error",
-                    resp.id);
+    // ==================== response writer ====================
+    namespace {
+        // Serialize a value onto the end of out, without a temporary string
+        void append_json(std::string &out, const nlohmann::json &value) {
+            nlohmann::detail::serializer<nlohmann::json> serializer(nlohmann::detail::output_adapter<char>(out), ' ');
+            serializer.dump(value, false, false, 0);
         }
 
-        nlohmann::json j;
-        j["jsonrpc"] = "2.0";
-        j["id"] = resp.id;
+        // Escape the characters of a string the way dump() does, without the quotes. Text that is not
+        // valid UTF-8 goes through the serializer, which throws for it as dump() would
+        void append_escaped(std::string &out, std::string_view text) {
+            if (mcp::utils::utf8_valid(text)) {
+                mcp::utils::json_escape_append(out, text);
+                return;
+            }
+            auto start = out.size();
+            append_json(out, nlohmann::json(std::string(text)));
+            out.pop_back();
+            out.erase(start, 1);
+        }
 
-        if (resp.error.has_value()) {
-            // Add error object
-            j["error"] = nlohmann::json{
-                    {"code", resp.error->code},
-                    {"message", resp.error->message}};
-            if (resp.error->data.has_value()) {
-                j["error"]["data"] = resp.error->data.value();
+        // Escape a string the way dump() does
+        void append_string(std::string &out, std::string_view text) {
+            out += '"';
+            append_escaped(out, text);
+            out += '"';
+        }
+
+        // Members in key order, as the DOM serialized them: code, data, message
+        void append_error_object(std::string &out, const Error &err) {
+            out += R"({"code":)";
+            out += std::to_string(err.code);
+            if (err.data.has_value()) {
+                out += R"(,"data":)";
+                append_json(out, err.data.value());
             }
+            out += R"(,"message":)";
+            append_string(out, err.message);
+            out += '}';
+        }
+
+        void append_error(std::string &out, const Error &err, const nlohmann::json &id) {
+            out += R"({"error":)";
+            append_error_object(out, err);
+            out += R"(,"id":)";
+            append_json(out, id);
+            out += R"(,"jsonrpc":"2.0"})";
+        }
+    }// namespace
+
+    void write_response(std::string &out, const Response &resp) {
+        if (!resp.is_valid()) {
+            append_error(out, Error{error_code::INTERNAL_ERROR, "Invalid response: contains both result and error"}, resp.id);
+            return;
+        }
+        if (resp.error.has_value()) {
+            append_error(out, resp.error.value(), resp.id);
+            return;
+        }
+
+        if (resp.raw_result) {
+            // Splice the cached result into the envelope without parsing it again
+            write_response_head(out, resp.id);
+            out += *resp.raw_result;
         } else if (!resp.result.is_null()) {
-            // Add result object
-            j["result"] = resp.result;
+            write_response_head(out, resp.id);
+            append_json(out, resp.result);
+        } else {
+            out += R"({"id":)";
+            append_json(out, resp.id);
+            out += R"(,"jsonrpc":"2.0")";
         }
+        out += '}';
+    }
 
-        return j.dump();
+    void write_response_head(std::string &out, const nlohmann::json &id) {
+        out += R"({"id":)";
+        append_json(out, id);
+        out += R"(,"jsonrpc":"2.0","result":)";
+    }
+
+    bool JsonPieceWriter::next(std::string &out, std::size_t max_bytes) {
+        const std::size_t start = out.size();
+        const std::size_t min_slice = 64;// a piece always makes progress through a long string
+        while (out.size() - start < max_bytes) {
+            std::size_t budget = max_bytes - (out.size() - start);
+            if (in_string_) {
+                std::size_t cut = mcp::utils::utf8_cut(string_rest_, std::min(string_rest_.size(), std::max(budget, min_slice)));
+                append_escaped(out, string_rest_.substr(0, cut));
+                string_rest_.remove_prefix(cut);
+                if (string_rest_.empty()) {
+                    out += '"';
+                    in_string_ = false;
+                }
+                continue;
+            }
+
+            if (pending_) {
+                const nlohmann::json &value = *std::exchange(pending_, nullptr);
+                if (value.is_structured() && !value.empty()) {
+                    out += value.is_object() ? '{' : '[';
+                    stack_.push_back(Frame{&value, value.cbegin()});
+                } else if (value.is_string() && value.get_ref<const std::string &>().size() > budget) {
+                    out += '"';
+                    string_rest_ = value.get_ref<const std::string &>();
+                    in_string_ = true;
+                } else {
+                    append_json(out, value);
+                }
+                continue;
+            }
+
+            if (stack_.empty()) {
+                break;
+            }
+            auto &frame = stack_.back();
+            if (frame.it == frame.container->cend()) {
+                out += frame.container->is_object() ? '}' : ']';
+                stack_.pop_back();
+                continue;
+            }
+            if (!frame.first) {
+                out += ',';
+            }
+            frame.first = false;
+            if (frame.container->is_object()) {
+                append_string(out, frame.it.key());
+                out += ':';
+            }
+            pending_ = &frame.it.value();
+            ++frame.it;
+        }
+        return in_string_ || pending_ || !stack_.empty();
+    }
+
+    void write_error(std::string &out, const Error &err) {
+        append_error(out, err, err.id.has_value() ? err.id.value() : nlohmann::json(nullptr));
+    }
+
+    // ==================== make_response implementations ====================
+    std::string make_response(const Response &resp) {
+        std::string out;
+        out.reserve(resp.raw_result ? resp.raw_result->size() + 64 : 256);
+        write_response(out, resp);
+        return out;
     }
 
     std::string make_response(const nlohmann::json &result, const nlohmann::json &id) {
@@ -126,20 +587,10 @@ namespace mcp::protocol {
 
     // ==================== make_error implementations ====================
     std::string make_error(const Error &err) {
-        nlohmann::json j;
-        j["jsonrpc"] = "2.0";
-
-        // Build error object
-        nlohmann::json error_obj{{"code", err.code}, {"message", err.message}};
-        if (err.data.has_value()) {
-            error_obj["data"] = err.data.value();
-        }
-        j["error"] = error_obj;
-
-        // Set id (use null if not provided)
-        j["id"] = err.id.has_value() ? err.id.value() : nlohmann::json(nullptr);
-
-        return j.dump();
+        std::string out;
+        out.reserve(err.message.size() + 64);
+        write_error(out, err);
+        return out;
     }
 
     std::string make_error(int code, const std::string &message) {
@@ -1,9 +1,19 @@
 #pragma once
 
+#include "json_extern.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
+
+namespace mcp::metrics {
+    class RequestTrace;
+}
 
 namespace mcp::protocol {
 
@@ -22,6 +32,8 @@ namespace mcp::protocol {
         constexpr int RATE_LIMITED = -32003;      // Rate limited
         constexpr int TIMEOUT = -32004;           // Timeout
         constexpr int INVALID_TOOL_INPUT = -32005;// Invalid tool input
+        constexpr int REQUEST_CANCELLED = -32006; // Cancelled by the client with notifications/cancelled
+        constexpr int RESPONSE_TOO_LARGE = -32007;// Result or stream event beyond max_response_size
     }// namespace error_code
 
     // JSON-RPC 2.0 Request Object
@@ -30,6 +42,7 @@ namespace mcp::protocol {
         std::string method;                      // A String containing the name of the method to be invoked
         nlohmann::json params = nlohmann::json{};// A Structured value that holds the parameter values
         std::optional<nlohmann::json> id;        // An identifier established by the Client (optional for notifications)
+        metrics::RequestTrace *trace = nullptr;  // Stage timings of a sampled request, not part of the message
 
         // Constructors for easier initialization
         Request() = default;
@@ -61,6 +74,7 @@ namespace mcp::protocol {
         nlohmann::json result = nlohmann::json{};// The result of the method invocation
         nlohmann::json id;                       // The identifier established by the Client (must match request id)
         std::optional<Error> error;              // The error object
+        std::shared_ptr<const std::string> raw_result;// Pre-serialized result, spliced in verbatim instead of result
 
         // Constructors for success and error responses
 
@@ -76,13 +90,135 @@ namespace mcp::protocol {
         }
     };
 
+    /**
+     * @brief Top-level members of a JSON-RPC message, located without building a DOM.
+     * Each view is the raw JSON text of a member's value inside the scanned message, empty if the
+     * member is absent; the views are only valid as long as the message is.
+     */
+    struct RequestEnvelope {
+        std::string_view jsonrpc;
+        std::string_view method;
+        std::string_view id;
+        std::string_view params;
+
+        bool has_id() const { return !id.empty(); }
+    };
+
+    /**
+     * @brief Check that a text is well-formed JSON and locate the members of its top-level object,
+     *        in one pass and without allocating. Strings, keys included, must be valid UTF-8.
+     * @return The envelope, or std::nullopt if the text is not JSON or not an object
+     */
+    std::optional<RequestEnvelope> scan_request_envelope(std::string_view text);
+
+    /**
+     * @brief Limits of JSON-RPC batches, normally taken from the [concurrency] section.
+     * Read by the transports as well, to tell a batch of notifications from one that is answered.
+     */
+    struct BatchOptions {
+        std::size_t max_size = 64;                ///< Entries per batch, larger batches are rejected whole; 0 = unlimited
+        std::chrono::milliseconds deadline{30000};///< Entries still running then are answered with a timeout error; 0 = none
+
+        static const BatchOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(BatchOptions options) { storage() = options; }
+
+    private:
+        static BatchOptions &storage() {
+            static BatchOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Split a JSON-RPC batch into its entries, in one pass and without parsing them.
+     * @return Raw JSON text of each element, std::nullopt if the text is not a well-formed array
+     */
+    std::optional<std::vector<std::string_view>> scan_batch(std::string_view text);
+
+    /**
+     * @brief Locate one member of a JSON object text, e.g. "name" in the params of tools/call.
+     * @param object Raw JSON object, as found by scan_request_envelope
+     * @param key Member name, matched without unescaping
+     * @return The member's raw value, empty if it is absent or object is not a well-formed object
+     */
+    std::string_view find_member(std::string_view object, std::string_view key);
+
+    /**
+     * @brief Value of a raw JSON string.
+     * @param raw Raw JSON value, quotes included
+     * @return The unescaped string, std::nullopt if raw is not a string or not valid UTF-8
+     */
+    std::optional<std::string> decode_string(std::string_view raw);
+
     /**
      * @brief Parses a JSON-RPC 2.0 request from text
      * @return Pair containing:
      *         - std::optional<Request>: Valid request if parsing succeeded
      *         - std::optional<Error>: Error if parsing failed (nullopt otherwise)
+     * The envelope is scanned first and only params is parsed into a DOM, once.
+     */
+    std::pair<std::optional<Request>, std::optional<Error>> parse_request(std::string_view text);
+
+    /**
+     * @brief Serialize a response onto the end of a buffer, e.g. the body about to be sent,
+     *        without building a JSON DOM for the envelope. An error takes precedence over the result.
+     * @param out Buffer to append to
+     * @param resp Response
+     */
+    void write_response(std::string &out, const Response &resp);
+
+    /**
+     * @brief Serialize the start of a successful response up to its result, as write_response() does.
+     * @param out Buffer to append to
+     * @param id Request id
+     */
+    void write_response_head(std::string &out, const nlohmann::json &id);
+
+    /**
+     * @brief Serializes a JSON value a piece at a time, for results sent while they are produced.
+     *
+     * The text is the same as dump() without indentation. Containers are walked with an explicit
+     * stack and strings longer than a piece are escaped in slices that end on a UTF-8 sequence, so
+     * a piece overshoots max_bytes by at most one scalar or the escapes of one slice. The value
+     * must outlive the writer.
+     */
+    class JsonPieceWriter {
+    public:
+        explicit JsonPieceWriter(const nlohmann::json &value) : pending_(&value) {}
+
+        /**
+         * @brief Append the next piece of the text to out.
+         * @param out Buffer to append to
+         * @param max_bytes Size of the piece to aim for
+         * @return true if text remains after this piece
+         * @throws nlohmann::json::type_error If a string is not valid UTF-8, as dump() does
+         */
+        bool next(std::string &out, std::size_t max_bytes);
+
+    private:
+        struct Frame {
+            const nlohmann::json *container;
+            nlohmann::json::const_iterator it;
+            bool first = true;
+        };
+
+        std::vector<Frame> stack_;             ///< Open objects and arrays, innermost last
+        const nlohmann::json *pending_;        ///< Value to start next, nullptr if none
+        std::string_view string_rest_;         ///< Unwritten part of the string being sliced
+        bool in_string_ = false;
+    };
+
+    /**
+     * @brief Serialize an error response onto the end of a buffer, with the error's own id.
+     * @param out Buffer to append to
+     * @param err Error
      */
-    std::pair<std::optional<Request>, std::optional<Error>> parse_request(const std::string &text);
+    void write_error(std::string &out, const Error &err);
 
     /**
      * @brief Serializes a Response object into a JSON-RPC 2.0 compliant JSON string
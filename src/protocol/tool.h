@@ -13,6 +13,20 @@ namespace mcp::protocol {
         bool is_streaming = false;
     };
 
+    // Entry of a tool in tools/list results and in list_changed deltas
+    inline nlohmann::json to_list_entry(const Tool &tool) {
+        nlohmann::json entry = {
+                {"name", tool.name},
+                {"description", tool.description}};
+        if (!tool.parameters.is_null() && !tool.parameters.empty()) {
+            entry["inputSchema"] = tool.parameters;
+        }
+        if (tool.is_streaming) {
+            entry["isStreaming"] = true;
+        }
+        return entry;
+    }
+
     // this function creates a simple echo tool
     inline Tool make_echo_tool() {
         return Tool{
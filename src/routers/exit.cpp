@@ -0,0 +1,14 @@
+#include "exit.hpp"
+#include "core/logger.h"
+#include <cstdlib>
+
+namespace mcp::routers {
+
+    protocol::Response handle_exit(
+            const protocol::Request & /*req*/,
+            const business::RequestContext & /*ctx*/) {
+        MCP_INFO("Exit command received");
+        std::exit(0);
+    }
+
+}// namespace mcp::routers
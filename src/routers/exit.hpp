@@ -1,6 +1,9 @@
-#include "core/logger.h"
+#pragma once
+
+#include "business/request_context.h"
 #include "protocol/json_rpc.h"
-#include "request_handler.h"
+#include <memory>
+#include <string>
 
 namespace mcp::routers {
 
@@ -9,12 +12,8 @@ namespace mcp::routers {
      * @param req RPC request
      * @return Terminates application
      */
-    inline protocol::Response handle_exit(
-            const protocol::Request & /*req*/,
-            std::shared_ptr<business::ToolRegistry> /*registry*/,
-            std::shared_ptr<transport::Session> /*session*/,
-            const std::string & /*session_id*/) {
-        MCP_INFO("Exit command received");
-        std::exit(0);
-    }
-}// namespace mcp::routers
\ No newline at end of file
+    protocol::Response handle_exit(
+            const protocol::Request &req,
+            const business::RequestContext &ctx);
+
+}// namespace mcp::routers
@@ -0,0 +1,40 @@
+#include "initialize.hpp"
+#include "business/tool_list_changed.h"
+#include "resources_read.hpp"
+#include <version.h>
+
+namespace mcp::routers {
+
+    protocol::Response handle_initialize(
+            const protocol::Request &req,
+            const business::RequestContext & /*ctx*/) {
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+
+        // get client's request protocol version
+        std::string client_protocol_version = req.params.value("protocolVersion", "2025-01-07");
+        std::string server_version = PROJECT_VERSION;
+        std::string server_name = PROJECT_NAME;
+
+        nlohmann::json capabilities({{"logging", nlohmann::json::object()},
+                                     {"prompts", {{"listChanged", true}}},
+                                     {"resources", {{"listChanged", true}, {"subscribe", true}}},
+                                     {"tools", {{"listChanged", true}}}});
+        // Extension: tools/list_changed carries the tools added and removed, see tool_list_changed.h
+        const auto &list_changed = business::ToolListChangedOptions::current();
+        if (list_changed.delta) {
+            capabilities["experimental"]["toolsListDelta"] = {{"maxTools", list_changed.max_delta}};
+        }
+        // Extension: resources/read takes "uris" to read many resources at once, see resources_read.hpp
+        const auto &read = ResourceReadOptions::current();
+        capabilities["experimental"]["resourcesReadMany"] = {{"maxUris", read.bulk_max_uris}, {"concurrency", read.bulk_concurrency}};
+
+        resp.result = nlohmann::json{
+                {"protocolVersion", client_protocol_version},
+                {"capabilities", std::move(capabilities)},
+                {"serverInfo", {{"name", server_name}, {"version", server_version}}}};
+
+        return resp;
+    }
+
+}// namespace mcp::routers
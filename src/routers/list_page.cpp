@@ -0,0 +1,29 @@
+#include "list_page.hpp"
+#include <nlohmann/json.hpp>
+
+namespace mcp::routers {
+
+    void respond_with_page(const protocol::Request &req, protocol::Response &resp, const core::PagedList &list) {
+        std::string cursor;
+        if (req.params.is_object()) {
+            auto it = req.params.find("cursor");
+            if (it != req.params.end() && it->is_string()) {
+                cursor = it->get<std::string>();
+            }
+        }
+
+        size_t page_size = core::PaginationOptions::current().page_size;
+        if (cursor.empty() && (page_size == 0 || list.entries.size() <= page_size)) {
+            resp.raw_result = list.full;
+            return;
+        }
+
+        auto page = list.page(cursor, page_size);
+        if (!page) {
+            resp.error = protocol::Error{protocol::error_code::INVALID_PARAMS, "Invalid or expired cursor"};
+            return;
+        }
+        resp.raw_result = std::make_shared<const std::string>(std::move(*page));
+    }
+
+}// namespace mcp::routers
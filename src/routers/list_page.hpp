@@ -0,0 +1,18 @@
+#pragma once
+#include "core/paged_list.h"
+#include "protocol/json_rpc.h"
+
+namespace mcp::routers {
+
+    /**
+     * @brief Answer a list request with one page of a list, as core::PaginationOptions says.
+     * A request without a cursor for a list that fits in one page gets the prebuilt full result,
+     * so nothing changes for small lists or with paging off. An unknown or stale cursor is
+     * answered with an invalid params error, after which clients start over from the first page.
+     * @param req List request, params.cursor names the page
+     * @param resp Response to fill
+     * @param list The list
+     */
+    void respond_with_page(const protocol::Request &req, protocol::Response &resp, const core::PagedList &list);
+
+}// namespace mcp::routers
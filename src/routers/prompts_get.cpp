@@ -0,0 +1,40 @@
+#include "prompts_get.hpp"
+#include <stdexcept>
+
+namespace mcp::routers {
+
+    protocol::Response handle_prompts_get(
+            const protocol::Request &req,
+            const std::shared_ptr<prompts::PromptManager> &prompt_manager,
+            const business::RequestContext & /*ctx*/) {
+
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+
+        // Extract name from request params
+        std::string name = req.params.value("name", "");
+        if (name.empty()) {
+            resp.error = protocol::Error{
+                    protocol::error_code::INVALID_PARAMS,
+                    "Missing 'name' parameter"};
+            return resp;
+        }
+
+        // Extract arguments from request params
+        nlohmann::json arguments = req.params.value("arguments", nlohmann::json::object());
+
+        try {
+            resp.raw_result = prompt_manager->render(name, arguments);
+        } catch (const std::invalid_argument &e) {
+            resp.error = protocol::Error{protocol::error_code::INVALID_PARAMS, e.what()};
+            return resp;
+        }
+        if (!resp.raw_result) {
+            resp.error = protocol::Error{
+                    protocol::error_code::INVALID_PARAMS,
+                    "Unknown prompt: " + name};
+        }
+        return resp;
+    }
+
+}// namespace mcp::routers
@@ -0,0 +1,19 @@
+#include "prompts_list.hpp"
+#include "list_page.hpp"
+
+namespace mcp::routers {
+
+    protocol::Response handle_prompts_list(
+            const protocol::Request &req,
+            const std::shared_ptr<prompts::PromptManager> &prompt_manager,
+            const business::RequestContext & /*ctx*/) {
+
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+
+        // the list only changes with registrations, the manager keeps it serialized
+        respond_with_page(req, resp, *prompt_manager->list_result());
+        return resp;
+    }
+
+}// namespace mcp::routers
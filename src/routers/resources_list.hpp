@@ -1,8 +1,8 @@
 #pragma once
 
-#include "business/tool_registry.h"
+#include "Resources/resource.h"
+#include "business/request_context.h"
 #include "protocol/json_rpc.h"
-#include "transport/session.h"
 #include <memory>
 #include <string>
 
@@ -10,8 +10,7 @@ namespace mcp::routers {
 
     protocol::Response handle_resources_list(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> registry,
-            std::shared_ptr<transport::Session> session,
-            const std::string &session_id);
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx);
 
 }// namespace mcp::routers
\ No newline at end of file
@@ -1,39 +1,147 @@
 #include "resources_read.hpp"
-#include "Resources/resource.h"
 #include "core/logger.h"
+#include "core/single_flight.hpp"
+#include "core/tool_thread_pool.hpp"
+#include "metrics/metrics_manager.h"
 #include "protocol/json_rpc.h"
+#include "transport/LRUCache.hpp"
+#include "transport/chunked_body.h"
+#include "transport/http_compression.h"
+#include "utils/base64.h"
+#include "utils/content_hash.h"
+#include "utils/utf8.h"
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 namespace mcp::routers {
 
-    protocol::Response handle_resources_read(
-            const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> /*registry*/,
-            std::shared_ptr<transport::Session> /*session*/,
-            const std::string &session_id) {
+    namespace {
+        using Contents = std::shared_ptr<const std::string>;
 
-        MCP_DEBUG("Handling resources/read request for session: {}", session_id);
+        /// Part of a file resource asked for with the "range" parameter
+        struct ByteRange {
+            std::size_t offset = 0;
+            std::size_t length = 0;
+        };
 
-        protocol::Response resp;
-        resp.id = req.id;
+        /// Reads in progress by URI
+        core::SingleFlight<Contents> &read_flights() {
+            static core::SingleFlight<Contents> flights;
+            return flights;
+        }
 
-        try {
-            // check if the request has an uri
-            if (!req.params.contains("uri")) {
-                resp.result = nlohmann::json::parse(protocol::make_error(
-                        protocol::error_code::INVALID_PARAMS,
-                        "Missing 'uri' parameter",
-                        req.id));
-                return resp;
+        /// Recently read contents by URI, nullptr when caching is off
+        Astra::datastructures::LRUCache<std::string, std::string> *read_cache() {
+            static auto cache = [] {
+                const auto &options = ResourceReadOptions::current();
+                std::unique_ptr<Astra::datastructures::LRUCache<std::string, std::string>> cache;
+                if (options.cache_ttl.count() > 0 && options.cache_max_bytes > 0) {
+                    cache = std::make_unique<Astra::datastructures::LRUCache<std::string, std::string>>(
+                            Astra::datastructures::MemoryBudget{options.cache_max_bytes});
+                    cache->StartCleanupThread();
+                }
+                return cache;
+            }();
+            return cache.get();
+        }
+
+        /// Hit rate and size of read_cache(), as "resource_reads"
+        metrics::CacheCounters &read_cache_counters() {
+            static const auto counters = metrics::MetricsManager::getInstance()->register_cache_counters("resource_reads");
+            return *counters;
+        }
+
+        /// Serialize JSON whose strings may hold invalid UTF-8, e.g. text cut at a range boundary
+        std::string dump_lenient(const nlohmann::json &value) {
+            return value.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+        }
+
+        /// Every whole read result starts with its entity tag, see read_contents()
+        constexpr std::string_view kEtagPrefix = R"({"_meta":{"etag":)";
+
+        /**
+         * @brief Entity tag of a file resource at the version it was last read at, so a conditional
+         *        read of an unchanged file is answered from the file's size and modification time
+         *        alone. Only registered file resources are kept, which bounds the table.
+         */
+        struct KnownEtag {
+            uint64_t version = 0;
+            std::string etag;
+        };
+
+        std::mutex known_etags_mutex;
+        std::unordered_map<std::string, KnownEtag> known_etags;
+
+        void remember_etag(const std::string &uri, uint64_t version, std::string etag) {
+            if (version == 0) {
+                return;
             }
+            std::lock_guard<std::mutex> lock(known_etags_mutex);
+            known_etags[uri] = KnownEtag{version, std::move(etag)};
+        }
 
-            std::string uri = req.params["uri"];
+        std::string known_etag(const std::string &uri, uint64_t version) {
+            std::lock_guard<std::mutex> lock(known_etags_mutex);
+            auto it = known_etags.find(uri);
+            return it != known_etags.end() && it->second.version == version ? it->second.etag : std::string();
+        }
 
-            mcp::resources::ResourceManager resource_manager;
+        /**
+         * @brief Entity tag of a serialized read result, empty for results without one (ranges).
+         */
+        std::string etag_of(const std::string &result) {
+            // The tag is 16 hex digits in quotes, escaped inside the JSON string: "\"0123456789abcdef\""
+            std::string_view rest = std::string_view(result).substr(std::min(result.size(), kEtagPrefix.size()));
+            if (!result.starts_with(kEtagPrefix) || rest.size() < 22 || !rest.starts_with(R"("\")") || rest.substr(19, 3) != R"(\"")") {
+                return {};
+            }
+            return '"' + std::string(rest.substr(3, 16)) + '"';
+        }
+
+        /**
+         * @brief Whether the client already holds a version of the result with this entity tag, by
+         *        the "_meta.etag" parameter or an If-None-Match header.
+         */
+        bool client_has(const protocol::Request &req, const transport::Session *session, const std::string &etag) {
+            if (etag.empty()) {
+                return false;
+            }
+            if (auto meta = req.params.find("_meta"); meta != req.params.end() && meta->is_object()) {
+                if (auto tag = meta->find("etag"); tag != meta->end() && tag->is_string() && tag->get_ref<const std::string &>() == etag) {
+                    return true;
+                }
+            }
+            return session && utils::etag_matches(session->get_headers().get("If-None-Match"), etag);
+        }
+
+        bool is_conditional(const protocol::Request &req, const transport::Session *session) {
+            if (auto meta = req.params.find("_meta"); meta != req.params.end() && meta->is_object() && meta->contains("etag")) {
+                return true;
+            }
+            return session && !session->get_headers().get("If-None-Match").empty();
+        }
+
+        /**
+         * @brief The small result answering a read the client already holds.
+         */
+        Contents not_modified(const std::string &etag) {
+            return std::make_shared<const std::string>(dump_lenient(nlohmann::json{{"_meta", {{"etag", etag}, {"notModified", true}}}}));
+        }
 
+        /**
+         * @brief Read a resource and serialize its contents as a resources/read result, led by a
+         *        "_meta" object with the entity tag of the contents.
+         */
+        Contents read_contents(const resources::ResourceManager &resource_manager, const std::string &uri) {
+            // Taken before the read, so a file changing meanwhile is not remembered as unchanged
+            uint64_t version = resource_manager.file_version(uri).value_or(0);
             auto contents = resource_manager.read_resource(uri);
 
-            nlohmann::json result;
             nlohmann::json content_list = nlohmann::json::array();
 
             for (const auto &content: contents) {
@@ -51,17 +159,527 @@ namespace mcp::routers {
                 content_list.push_back(c);
             }
 
-            result["contents"] = content_list;
-            resp.result = result;
+            std::string serialized = dump_lenient(content_list);
+            std::string etag = utils::content_etag(serialized);
+            std::string body(kEtagPrefix);
+            body += nlohmann::json(etag).dump();
+            body += R"(},"contents":)";
+            body += serialized;
+            body += '}';
+            remember_etag(uri, version, std::move(etag));
+            return std::make_shared<const std::string>(std::move(body));
+        }
+
+        /**
+         * @brief The content object of a file read without its text or blob field, for a range
+         *        with the "range" object included.
+         */
+        nlohmann::json file_content(const resources::ResourceFile &file, const std::optional<ByteRange> &range) {
+            nlohmann::json c;
+            c["uri"] = file.uri;
+            if (!file.mimeType.empty()) {
+                c["mimeType"] = file.mimeType;
+            }
+            if (range) {
+                c["range"] = {{"offset", range->offset}, {"length", range->length}, {"size", file.file->size()}};
+            }
+            return c;
+        }
+
+        /**
+         * @brief Serialize a range of a file resource as a resources/read result.
+         */
+        Contents read_range(const resources::ResourceFile &file, ByteRange range) {
+            auto bytes = file.file->bytes().substr(range.offset, range.length);
+            auto c = file_content(file, range);
+            if (file.is_text) {
+                c["text"] = std::string(bytes);
+            } else {
+                c["blob"] = utils::base64_encode(bytes);
+            }
+            nlohmann::json result;
+            result["contents"] = nlohmann::json::array({std::move(c)});
+            return std::make_shared<const std::string>(dump_lenient(result));
+        }
+
+        asio::awaitable<Contents> read_on_pool(std::shared_ptr<resources::ResourceManager> resource_manager, std::string uri) {
+            co_return read_contents(*resource_manager, uri);
+        }
+
+        asio::awaitable<Contents> read_range_on_pool(resources::ResourceFile file, ByteRange range) {
+            co_return read_range(file, range);
+        }
+
+        asio::awaitable<std::optional<uint64_t>> version_on_pool(std::shared_ptr<resources::ResourceManager> resource_manager, std::string uri) {
+            co_return resource_manager->file_version(uri);
+        }
+
+        asio::awaitable<std::optional<resources::ResourceFile>> open_on_pool(std::shared_ptr<resources::ResourceManager> resource_manager, std::string uri) {
+            co_return resource_manager->open_file(uri);
+        }
+
+        /**
+         * @brief Leader of a read: runs it on the tool pool, the file I/O may block.
+         */
+        asio::awaitable<Contents> load_contents(std::shared_ptr<resources::ResourceManager> resource_manager, std::string uri) {
+            auto contents = co_await asio::co_spawn(core::ToolThreadPool::instance().executor(),
+                                                    read_on_pool(std::move(resource_manager), uri), asio::use_awaitable);
+
+            const auto &options = ResourceReadOptions::current();
+            if (auto *cache = read_cache()) {
+                if (options.cache_max_entry_bytes == 0 || contents->size() <= options.cache_max_entry_bytes) {
+                    cache->Put(uri, *contents, options.cache_ttl);
+                    auto &counters = read_cache_counters();
+                    counters.resident_bytes.store(static_cast<int64_t>(cache->MemoryUsage()), std::memory_order_relaxed);
+                    counters.entries.store(cache->Size(), std::memory_order_relaxed);
+                }
+            }
+            co_return contents;
+        }
+
+        /**
+         * @brief Contents of a whole read from the read cache, nullptr if it is off or has none.
+         */
+        Contents cached_contents(const std::string &uri) {
+            auto *cache = read_cache();
+            if (!cache) {
+                return nullptr;
+            }
+            if (auto cached = cache->Get(uri)) {
+                read_cache_counters().hits.fetch_add(1, std::memory_order_relaxed);
+                return std::make_shared<const std::string>(std::move(*cached));
+            }
+            read_cache_counters().misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        /**
+         * @brief Read a whole resource; concurrent reads of one URI share the first one's I/O.
+         */
+        asio::awaitable<Contents> read_shared(std::shared_ptr<resources::ResourceManager> resource_manager, std::string uri) {
+            bool shared = false;
+            std::function<asio::awaitable<Contents>()> load = [resource_manager, uri]() { return load_contents(resource_manager, uri); };
+            auto contents = co_await read_flights().run(uri, std::move(load), &shared);
+            if (shared) {
+                MCP_DEBUG("Shared in-flight read of resource {}", uri);
+            }
+            co_return contents;
+        }
+
+        /**
+         * @brief End of the next window of a file, shortened so that it ends on a base64 group or,
+         *        for text, does not split a UTF-8 sequence.
+         */
+        std::size_t window_end(std::string_view bytes, std::size_t begin, std::size_t end, std::size_t window, bool is_text) {
+            if (end - begin <= window) {
+                return end;
+            }
+            if (!is_text) {
+                return begin + std::max<std::size_t>(3, window / 3 * 3);
+            }
+            return utils::utf8_cut(bytes, begin + window, begin);
+        }
+
+        /**
+         * @brief Whether text goes into a JSON string as it is: valid UTF-8 without quotes,
+         *        backslashes or control characters, which dump() would escape or replace.
+         */
+        bool is_plain_json_text(std::string_view text) {
+            return utils::json_escape_scan(text) == text.size() && utils::utf8_valid(text);
+        }
+
+        /**
+         * @brief Send a file read as a chunked HTTP response, one window of the mapped file at a
+         *        time. Runs on the tool pool; only the window being sent is held in memory. Text
+         *        windows that need no escaping are sent from the file itself, see Session::write_file().
+         * @param encoding Coding of the body, each window is compressed and flushed as one chunk
+         */
+        asio::awaitable<void> stream_file(std::shared_ptr<transport::Session> session,
+                                          nlohmann::json id,
+                                          resources::ResourceFile file,
+                                          std::optional<ByteRange> range,
+                                          ByteRange slice,
+                                          std::size_t window,
+                                          transport::ContentEncoding encoding) {
+            // Once the header is out an error cannot be answered any more, only the connection dropped
+            transport::ChunkedBodyWriter body(session, encoding);
+            try {
+                co_await body.begin();
+
+                // Same envelope as protocol::make_response, with the content's data field left open
+                std::string head = file_content(file, range).dump();
+                head.pop_back();
+                std::string prefix;
+                protocol::write_response_head(prefix, id);
+                prefix += '{';
+                if (!range) {
+                    // Hashing the mapped file costs far less than sending it
+                    std::string etag = utils::content_etag(file.file->bytes());
+                    prefix += kEtagPrefix.substr(1);
+                    prefix += nlohmann::json(etag).dump() + "},";
+                    remember_etag(file.uri, file.version, std::move(etag));
+                }
+                prefix += R"("contents":[)" + head + (file.is_text ? R"(,"text":")" : R"(,"blob":")");
+                co_await body.write(std::move(prefix));
+
+                auto bytes = file.file->bytes();
+                std::size_t end = slice.offset + slice.length;
+                for (std::size_t begin = slice.offset; begin < end && !body.closed();) {
+                    std::size_t next = window_end(bytes, begin, end, window, file.is_text);
+                    file.file->will_read(next, window);
+                    auto piece = bytes.substr(begin, next - begin);
+
+                    std::string chunk;
+                    if (file.is_text && is_plain_json_text(piece)) {
+                        co_await body.write_file(transport::FileSlice{file.file->native_handle(), begin, piece});
+                        begin = next;
+                        continue;
+                    }
+                    if (file.is_text) {
+                        chunk = dump_lenient(std::string(piece));
+                        chunk = chunk.substr(1, chunk.size() - 2);// the quotes belong to the whole string
+                    } else {
+                        chunk.reserve(utils::base64_encoded_size(piece.size()));
+                        utils::base64_append(chunk, piece);
+                    }
+                    co_await body.write(std::move(chunk));
+                    begin = next;
+                }
+
+                co_await body.write(R"("}]}})");
+                co_await body.finish();
+            } catch (const std::exception &e) {
+                MCP_ERROR("Failed to stream resource {}: {}", file.uri, e.what());
+                body.abort();
+            }
+        }
+
+        /**
+         * @brief Parse the "uris" parameter of a bulk read.
+         * @throws std::invalid_argument If it is not a non-empty array of at most max_uris strings
+         */
+        std::vector<std::string> parse_uris(const nlohmann::json &uris, std::size_t max_uris) {
+            if (!uris.is_array() || uris.empty()) {
+                throw std::invalid_argument("'uris' must be a non-empty array of strings");
+            }
+            if (uris.size() > max_uris) {
+                throw std::invalid_argument("'uris' lists " + std::to_string(uris.size()) + " resources, at most " +
+                                            std::to_string(max_uris) + " are read in one request");
+            }
+            std::vector<std::string> result;
+            result.reserve(uris.size());
+            for (const auto &uri: uris) {
+                if (!uri.is_string()) {
+                    throw std::invalid_argument("'uris' must be a non-empty array of strings");
+                }
+                result.push_back(uri.get<std::string>());
+            }
+            return result;
+        }
+
+        /**
+         * @brief One result of a bulk read: {"index", "uri"} followed by the members of the
+         *        contents, or by an "error" if the resource could not be read.
+         */
+        std::string bulk_entry(std::size_t index, const std::string &uri, const Contents &contents, const std::string &error) {
+            std::string entry = R"({"index":)" + std::to_string(index) + R"(,"uri":)" + dump_lenient(uri);
+            if (contents) {
+                entry += ',';
+                entry.append(*contents, 1, std::string::npos);
+            } else {
+                entry += R"(,"error":)";
+                entry += dump_lenient(nlohmann::json{{"code", protocol::error_code::INTERNAL_ERROR},
+                                                     {"message", "Failed to read resource: " + error}});
+                entry += '}';
+            }
+            return entry;
+        }
+
+        /// State shared by the workers of a bulk read and the coroutine sending its results
+        struct BulkRead {
+            explicit BulkRead(asio::strand<asio::any_io_executor> strand) : wake(strand) {}
+
+            std::vector<std::string> uris;
+            std::size_t next = 0;                             ///< Index of the next URI a worker takes
+            std::deque<std::pair<std::size_t, std::string>> ready;///< Finished entries not sent yet
+            std::size_t failed = 0;
+            bool stopped = false;                             ///< The client went away, no more reads are started
+            asio::steady_timer wake;                          ///< Cancelled whenever an entry is ready
+        };
+
+        /**
+         * @brief Take URIs of a bulk read until none are left, each read like a single whole read.
+         *        Runs on the strand of the bulk read.
+         */
+        asio::awaitable<void> bulk_worker(std::shared_ptr<BulkRead> bulk, std::shared_ptr<resources::ResourceManager> resource_manager) {
+            while (!bulk->stopped && bulk->next < bulk->uris.size()) {
+                std::size_t index = bulk->next++;
+                const std::string &uri = bulk->uris[index];
+                Contents contents;
+                std::string error;
+                try {
+                    contents = cached_contents(uri);
+                    if (!contents) {
+                        contents = co_await read_shared(resource_manager, uri);
+                    }
+                } catch (const std::exception &e) {
+                    error = e.what();
+                    MCP_DEBUG("Bulk read of resource {} failed: {}", uri, error);
+                }
+                if (!contents) {
+                    ++bulk->failed;
+                }
+                bulk->ready.emplace_back(index, bulk_entry(index, uri, contents, error));
+                bulk->wake.cancel();
+            }
+        }
+
+        /**
+         * @brief Read many resources, bulk_concurrency at a time, and answer with all of them.
+         *
+         * Without a session the results are collected in request order. Otherwise each is sent
+         * as soon as it is read: as an SSE event to clients accepting text/event-stream, else as
+         * the next element of a chunked {"results": [...]} response.
+         */
+        asio::awaitable<protocol::Response> bulk_read(std::shared_ptr<BulkRead> bulk,
+                                                      std::shared_ptr<resources::ResourceManager> resource_manager,
+                                                      std::shared_ptr<transport::Session> session,
+                                                      nlohmann::json id) {
+            protocol::Response resp;
+            resp.id = id;
+            const std::size_t count = bulk->uris.size();
+            const std::size_t workers = std::min(std::max<std::size_t>(ResourceReadOptions::current().bulk_concurrency, 1), count);
+            auto strand = bulk->wake.get_executor();
+            for (std::size_t i = 0; i < workers; ++i) {
+                asio::co_spawn(strand, bulk_worker(bulk, resource_manager), asio::detached);
+            }
+
+            // Workers and this coroutine share the strand, so an entry is never pushed between
+            // the check for ready entries and the wait
+            auto next_entry = [bulk]() -> asio::awaitable<std::pair<std::size_t, std::string>> {
+                while (bulk->ready.empty()) {
+                    bulk->wake.expires_at(asio::steady_timer::time_point::max());
+                    asio::error_code ec;
+                    co_await bulk->wake.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+                }
+                auto entry = std::move(bulk->ready.front());
+                bulk->ready.pop_front();
+                co_return entry;
+            };
+
+            if (!session) {
+                std::vector<std::string> entries(count);
+                for (std::size_t done = 0; done < count; ++done) {
+                    auto [index, entry] = co_await next_entry();
+                    entries[index] = std::move(entry);
+                }
+                std::string result = R"({"results":[)";
+                for (std::size_t i = 0; i < count; ++i) {
+                    result += i == 0 ? "" : ",";
+                    result += entries[i];
+                }
+                result += "]}";
+                resp.raw_result = std::make_shared<const std::string>(std::move(result));
+                co_return resp;
+            }
+
+            bool sse = session->get_accept_header().find("text/event-stream") != std::string::npos;
+            transport::ChunkedBodyWriter body(session, transport::stream_encoding(session->get_headers()));
+            try {
+                co_await body.begin(sse ? "text/event-stream" : "application/json");
+                if (!sse) {
+                    std::string prefix;
+                    protocol::write_response_head(prefix, id);
+                    prefix += R"({"results":[)";
+                    co_await body.write(std::move(prefix));
+                }
+                for (std::size_t done = 0; done < count && !body.closed(); ++done) {
+                    std::string entry = (co_await next_entry()).second;
+                    if (sse) {
+                        entry = "event: message\ndata: " R"({"jsonrpc":"2.0","method":"notifications/resources/readResult","params":)" +
+                                entry + "}\n\n";
+                    } else if (done > 0) {
+                        entry.insert(entry.begin(), ',');
+                    }
+                    co_await body.write(std::move(entry));
+                }
+                if (sse) {
+                    nlohmann::json summary{{"read", count - bulk->failed}, {"failed", bulk->failed}};
+                    co_await body.write("event: message\ndata: " + protocol::make_response(summary, id) + "\n\n");
+                } else {
+                    co_await body.write("]}}");
+                }
+                co_await body.finish();
+            } catch (const std::exception &e) {
+                MCP_ERROR("Failed to send bulk read results: {}", e.what());
+                body.abort();
+            }
+            bulk->stopped = true;
+            // The response has been written, nothing is left for the router to send
+            resp.id = nullptr;
+            resp.result = nlohmann::json::value_t::discarded;
+            co_return resp;
+        }
+
+        /**
+         * @brief Parse the optional "range" parameter.
+         * @throws std::invalid_argument If it is not an object of non-negative integers
+         */
+        std::optional<ByteRange> parse_range(const nlohmann::json &params) {
+            auto it = params.find("range");
+            if (it == params.end() || it->is_null()) {
+                return std::nullopt;
+            }
+            if (!it->is_object()) {
+                throw std::invalid_argument("'range' must be an object");
+            }
+            ByteRange range;
+            range.length = std::numeric_limits<std::size_t>::max();
+            for (auto [name, field]: {std::pair{"offset", &range.offset}, std::pair{"length", &range.length}}) {
+                auto value = it->find(name);
+                if (value == it->end()) {
+                    continue;
+                }
+                if (!value->is_number_unsigned()) {
+                    throw std::invalid_argument(std::string("'range.") + name + "' must be a non-negative integer");
+                }
+                *field = value->get<std::size_t>();
+            }
+            return range;
+        }
+    }// namespace
+
+    asio::awaitable<protocol::Response> handle_resources_read(
+            const protocol::Request &req,
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx) {
+
+        MCP_DEBUG("Handling resources/read request for session: {}", ctx.session_id);
+        const std::shared_ptr<transport::Session> &session = ctx.session;
+
+        protocol::Response resp;
+        resp.id = req.id;
+
+        // Many resources in one request
+        if (auto uris = req.params.find("uris"); uris != req.params.end()) {
+            const auto &options = ResourceReadOptions::current();
+            try {
+                if (req.params.contains("uri") || req.params.contains("range")) {
+                    throw std::invalid_argument("'uris' cannot be combined with 'uri' or 'range'");
+                }
+                auto strand = asio::make_strand(co_await asio::this_coro::executor);
+                auto bulk = std::make_shared<BulkRead>(strand);
+                bulk->uris = parse_uris(*uris, options.bulk_max_uris);
+                MCP_DEBUG("Bulk read of {} resources", bulk->uris.size());
+                co_return co_await asio::co_spawn(strand, bulk_read(bulk, resource_manager, session, req.id.value_or(nullptr)),
+                                                  asio::use_awaitable);
+            } catch (const std::invalid_argument &e) {
+                resp.error = protocol::Error{
+                        protocol::error_code::INVALID_PARAMS,
+                        e.what()};
+                co_return resp;
+            }
+        }
+
+        // check if the request has an uri
+        if (!req.params.contains("uri")) {
+            resp.error = protocol::Error{
+                    protocol::error_code::INVALID_PARAMS,
+                    "Missing 'uri' parameter"};
+            co_return resp;
+        }
+
+        std::optional<ByteRange> range;
+        try {
+            range = parse_range(req.params);
+        } catch (const std::invalid_argument &e) {
+            resp.error = protocol::Error{
+                    protocol::error_code::INVALID_PARAMS,
+                    e.what()};
+            co_return resp;
+        }
+
+        std::optional<std::string> error;
+        try {
+            std::string uri = req.params["uri"];
+            const auto &options = ResourceReadOptions::current();
+
+            // A conditional read of a file that has not changed is answered without reading it
+            bool conditional = !range && is_conditional(req, session.get());
+            if (conditional && uri.starts_with("file://")) {
+                auto version = co_await asio::co_spawn(core::ToolThreadPool::instance().executor(),
+                                                       version_on_pool(resource_manager, uri), asio::use_awaitable);
+                std::string etag = version ? known_etag(uri, *version) : std::string();
+                if (client_has(req, session.get(), etag)) {
+                    resp.raw_result = not_modified(etag);
+                    co_return resp;
+                }
+            }
+            // Otherwise only the sending is saved
+            auto unless_held = [&](Contents contents) {
+                if (conditional) {
+                    if (auto etag = etag_of(*contents); client_has(req, session.get(), etag)) {
+                        return not_modified(etag);
+                    }
+                }
+                return contents;
+            };
+
+            if (auto cached = range ? nullptr : cached_contents(uri)) {
+                resp.raw_result = unless_held(std::move(cached));
+                co_return resp;
+            }
+
+            // Ranges and large files are served from the mapped file instead of a full copy
+            bool can_stream = session && options.stream_threshold > 0;
+            if (range || can_stream) {
+                auto file = co_await asio::co_spawn(core::ToolThreadPool::instance().executor(),
+                                                    open_on_pool(resource_manager, uri), asio::use_awaitable);
+                if (file) {
+                    ByteRange slice{0, file->file->size()};
+                    if (range) {
+                        if (range->offset > slice.length) {
+                            resp.error = protocol::Error{
+                                    protocol::error_code::INVALID_PARAMS,
+                                    "Range starts past the end of the resource"};
+                            co_return resp;
+                        }
+                        range->length = std::min(range->length, slice.length - range->offset);
+                        slice = *range;
+                    }
+
+                    if (can_stream && slice.length > options.stream_threshold) {
+                        MCP_DEBUG("Streaming {} bytes of resource {}", slice.length, uri);
+                        co_await asio::co_spawn(core::ToolThreadPool::instance().executor(),
+                                                stream_file(session, req.id.value_or(nullptr), std::move(*file), range, slice,
+                                                            std::max<std::size_t>(options.stream_window, 4),
+                                                            transport::stream_encoding(session->get_headers())),
+                                                asio::use_awaitable);
+                        // The response has been written, nothing is left for the router to send
+                        resp.id = nullptr;
+                        resp.result = nlohmann::json::value_t::discarded;
+                        co_return resp;
+                    }
+                    if (range) {
+                        resp.raw_result = co_await asio::co_spawn(core::ToolThreadPool::instance().executor(),
+                                                                  read_range_on_pool(std::move(*file), *range), asio::use_awaitable);
+                        co_return resp;
+                    }
+                }
+            }
+
+            resp.raw_result = unless_held(co_await read_shared(resource_manager, uri));
         } catch (const std::exception &e) {
-            MCP_ERROR("Error handling resources/read request: {}", e.what());
-            resp.result = nlohmann::json::parse(protocol::make_error(
-                    protocol::error_code::INTERNAL_ERROR,
-                    "Failed to read resource: " + std::string(e.what()),
-                    req.id));
+            error = e.what();
         }
 
-        return resp;
+        if (error) {
+            MCP_ERROR("Error handling resources/read request: {}", *error);
+            resp.error = protocol::Error{
+                    protocol::error_code::INTERNAL_ERROR,
+                    "Failed to read resource: " + *error};
+        }
+        co_return resp;
     }
 
-}// namespace mcp::routers
\ No newline at end of file
+}// namespace mcp::routers
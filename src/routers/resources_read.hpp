@@ -1,17 +1,64 @@
 #pragma once
 
-#include "business/tool_registry.h"
+#include "Resources/resource.h"
+#include "business/request_context.h"
 #include "protocol/json_rpc.h"
-#include "transport/session.h"
+#include <asio.hpp>
+#include <chrono>
 #include <memory>
 #include <string>
 
 namespace mcp::routers {
 
-    protocol::Response handle_resources_read(
+    /**
+     * @brief Settings of resources/read, normally taken from the [cache] and [transport] sections.
+     */
+    struct ResourceReadOptions {
+        std::chrono::seconds cache_ttl{0};             ///< How long read contents are reused, 0 = only while a read is in flight
+        std::size_t cache_max_bytes = 0;               ///< Memory budget of cached contents
+        std::size_t cache_max_entry_bytes = 0;         ///< Larger contents are not cached, 0 = no limit
+        std::size_t stream_threshold = 8 * 1024 * 1024;///< Larger file reads are streamed over HTTP, 0 = never
+        std::size_t stream_window = 1024 * 1024;       ///< File bytes encoded and sent per chunk while streaming
+        std::size_t bulk_max_uris = 64;                ///< Most resources one request may read with "uris"
+        std::size_t bulk_concurrency = 8;              ///< Resources of one bulk read being read at a time
+
+        static const ResourceReadOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(ResourceReadOptions options) { storage() = options; }
+
+    private:
+        static ResourceReadOptions &storage() {
+            static ResourceReadOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Read a resource on the tool pool. Concurrent reads of the same URI share one read,
+     *        and with a cache TTL its contents are reused for later requests as well.
+     *
+     * An optional "range": {"offset", "length"} parameter reads part of a file resource; its
+     * content then carries a "range" object with the offset, length and total size. File reads
+     * larger than stream_threshold are sent as a chunked HTTP response straight from the mapped
+     * file, stream_window bytes at a time, and never held in memory as a whole.
+     *
+     * Whole reads lead with "_meta": {"etag"}. A read whose "_meta.etag" parameter or
+     * If-None-Match header names the current tag gets only {"_meta": {"etag", "notModified"}};
+     * for an unchanged file resource that is known from its size and modification time alone.
+     *
+     * A "uris" array instead of "uri" reads up to bulk_max_uris resources, bulk_concurrency at a
+     * time, each like a whole single read. Every result is {"index", "uri"} plus its contents or
+     * an "error". Over HTTP each is sent as soon as it is read, in the order they finish: as a
+     * notifications/resources/readResult event followed by a {"read", "failed"} response to
+     * clients accepting text/event-stream, else as an element of a chunked {"results": [...]}.
+     */
+    asio::awaitable<protocol::Response> handle_resources_read(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> registry,
-            std::shared_ptr<transport::Session> session,
-            const std::string &session_id);
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx);
 
-}// namespace mcp::routers
\ No newline at end of file
+}// namespace mcp::routers
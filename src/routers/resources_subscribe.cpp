@@ -1,17 +1,94 @@
 #include "resources_subscribe.hpp"
 #include "core/logger.h"
 #include "protocol/json_rpc.h"
+#include "transport/notification_broadcast.h"
+#include "transport/sse_send_queue.h"
+#include "transport/stdio_transport.h"
+#include <iostream>
 #include <nlohmann/json.hpp>
 
 namespace mcp::routers {
 
+    namespace {
+        /**
+         * @brief Key of a session's subscriptions: its Mcp-Session-Id, so that they outlive the
+         *        connection they were made on, or the connection itself for clients without one.
+         */
+        std::string subscriber_key(const business::RequestContext &ctx) {
+            return ctx.session ? ctx.session->client_session_id() : ctx.session_id;
+        }
+
+        /**
+         * @brief Subscriber that sends a batch of updates down the session's event stream,
+         *        or to stdout for stdio, whose requests come without a session.
+         */
+        resources::Subscriber make_subscriber(const std::shared_ptr<resources::ResourceManager> &resource_manager,
+                                              const std::shared_ptr<transport::Session> &session,
+                                              const std::string &key) {
+            resources::Subscriber subscriber;
+            subscriber.key = key;
+
+            if (!session) {
+                // runs on the hub thread, one write per batch
+                subscriber.sink = [](std::vector<std::shared_ptr<const std::string>> updates) {
+                    std::string lines;
+                    for (const auto &update: updates) {
+                        if (!lines.empty()) {
+                            lines += '\n';
+                        }
+                        lines += *update;
+                    }
+                    // through the transport, so that they don't land inside an answer being written
+                    if (auto *stdio = transport::StdioTransport::active()) {
+                        stdio->write(lines);
+                    } else {
+                        std::cout << lines << '\n' << std::flush;
+                    }
+                };
+                return subscriber;
+            }
+
+            if (key != session->get_session_id()) {
+                // An MCP session: updates go to the event stream it has open, on whichever connection,
+                // and the subscription lasts until the session ends (NotificationBroadcast::end_session)
+                subscriber.sink = [key](std::vector<std::shared_ptr<const std::string>> updates) {
+                    if (!transport::NotificationBroadcast::instance().send(key, updates)) {
+                        MCP_DEBUG("No event stream open, dropping {} resource updates - session: {}", updates.size(), key);
+                    }
+                };
+                return subscriber;
+            }
+
+            // Without Mcp-Session-Id the connection is the session, its subscriptions end with it
+            subscriber.executor = session->get_executor();
+            subscriber.sink = [weak_session = std::weak_ptr<transport::Session>(session),
+                               weak_manager = std::weak_ptr<resources::ResourceManager>(resource_manager),
+                               key](std::vector<std::shared_ptr<const std::string>> updates) {
+                auto session = weak_session.lock();
+                if (!session || session->is_closed()) {
+                    if (auto manager = weak_manager.lock()) {
+                        manager->unsubscribe_all(key);
+                    }
+                    return;
+                }
+                auto queue = session->notification_stream();
+                if (!queue) {
+                    MCP_DEBUG("No event stream open, dropping {} resource updates - session: {}", updates.size(), key);
+                    return;
+                }
+                // the updates are shared with the other subscribers, the queue only takes pointers
+                queue->push_shared(transport::NotificationBroadcast::sse_frame(updates));
+            };
+            return subscriber;
+        }
+    }// namespace
+
     protocol::Response handle_resources_subscribe(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> /*registry*/,
-            std::shared_ptr<transport::Session> /*session*/,
-            const std::string &session_id) {
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx) {
 
-        MCP_DEBUG("Handling resources/subscribe request for session: {}", session_id);
+        MCP_DEBUG("Handling resources/subscribe request for session: {}", ctx.session_id);
 
         protocol::Response resp;
         resp.id = req.id;
@@ -19,24 +96,22 @@ namespace mcp::routers {
         try {
             // check the uri
             if (!req.params.contains("uri")) {
-                resp.result = nlohmann::json::parse(protocol::make_error(
+                resp.error = protocol::Error{
                         protocol::error_code::INVALID_PARAMS,
-                        "Missing 'uri' parameter",
-                        req.id));
+                        "Missing 'uri' parameter"};
                 return resp;
             }
 
             std::string uri = req.params["uri"];
 
-            // todo set a subscription here instead of returning an empty success response
-            nlohmann::json result;
-            resp.result = result;
+            // updates are debounced, batched and sent as notifications/resources/updated
+            resource_manager->subscribe(uri, make_subscriber(resource_manager, ctx.session, subscriber_key(ctx)));
+            resp.result = nlohmann::json::object();
         } catch (const std::exception &e) {
             MCP_ERROR("Error handling resources/subscribe request: {}", e.what());
-            resp.result = nlohmann::json::parse(protocol::make_error(
+            resp.error = protocol::Error{
                     protocol::error_code::INTERNAL_ERROR,
-                    "Failed to subscribe to resource: " + std::string(e.what()),
-                    req.id));
+                    "Failed to subscribe to resource: " + std::string(e.what())};
         }
 
         return resp;
@@ -44,11 +119,10 @@ namespace mcp::routers {
 
     protocol::Response handle_resources_unsubscribe(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> /*registry*/,
-            std::shared_ptr<transport::Session> /*session*/,
-            const std::string &session_id) {
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx) {
 
-        MCP_DEBUG("Handling resources/unsubscribe request for session: {}", session_id);
+        MCP_DEBUG("Handling resources/unsubscribe request for session: {}", ctx.session_id);
 
         protocol::Response resp;
         resp.id = req.id;
@@ -56,25 +130,21 @@ namespace mcp::routers {
         try {
             // check if the request has an id
             if (!req.params.contains("uri")) {
-                resp.result = nlohmann::json::parse(protocol::make_error(
+                resp.error = protocol::Error{
                         protocol::error_code::INVALID_PARAMS,
-                        "Missing 'uri' parameter",
-                        req.id));
+                        "Missing 'uri' parameter"};
                 return resp;
             }
 
             std::string uri = req.params["uri"];
 
-            // todo unsubscribe here instead of returning an empty success response
-
-            nlohmann::json result;
-            resp.result = result;
+            resource_manager->unsubscribe(uri, subscriber_key(ctx));
+            resp.result = nlohmann::json::object();
         } catch (const std::exception &e) {
             MCP_ERROR("Error handling resources/unsubscribe request: {}", e.what());
-            resp.result = nlohmann::json::parse(protocol::make_error(
+            resp.error = protocol::Error{
                     protocol::error_code::INTERNAL_ERROR,
-                    "Failed to unsubscribe from resource: " + std::string(e.what()),
-                    req.id));
+                    "Failed to unsubscribe from resource: " + std::string(e.what())};
         }
 
         return resp;
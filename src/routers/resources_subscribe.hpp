@@ -1,23 +1,25 @@
 #pragma once
 
-#include "business/tool_registry.h"
+#include "Resources/resource.h"
+#include "business/request_context.h"
 #include "protocol/json_rpc.h"
-#include "transport/session.h"
 #include <memory>
 #include <string>
 
 namespace mcp::routers {
 
+    /**
+     * @brief Subscribe the session to updates of a resource. They arrive as notifications/resources/updated
+     *        on the event stream the session opens with GET (stdout for stdio), debounced per uri.
+     */
     protocol::Response handle_resources_subscribe(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> registry,
-            std::shared_ptr<transport::Session> session,
-            const std::string &session_id);
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx);
 
     protocol::Response handle_resources_unsubscribe(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> registry,
-            std::shared_ptr<transport::Session> session,
-            const std::string &session_id);
+            const std::shared_ptr<resources::ResourceManager> &resource_manager,
+            const business::RequestContext &ctx);
 
 }// namespace mcp::routers
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "tool_list.hpp"
+#include "list_page.hpp"
+#include "utils/content_hash.h"
+#include <algorithm>
+#include <atomic>
+#include <nlohmann/json.hpp>
+
+namespace mcp::routers {
+
+    /**
+     * @brief Serialized tools/list result for one registry version.
+     */
+    struct CachedToolList {
+        const business::ToolRegistry *registry = nullptr;///< Registry the list was built from
+        uint64_t version = 0;                            ///< Registry version the list was built from
+        std::string etag;                                ///< Validator of the tools array
+        core::PagedList paged;                           ///< Serialized result object, and the tools one by one sorted by name
+    };
+
+    /**
+     * @brief Build the tools/list result for the current registry snapshot.
+     * @param snapshot Registry snapshot
+     * @param registry Registry the snapshot belongs to
+     * @return Cached result; each tool is serialized exactly once per registry version
+     */
+    static std::shared_ptr<const CachedToolList> build_tools_list(
+            const business::ToolRegistrySnapshot &snapshot,
+            const business::ToolRegistry *registry) {
+        auto cached = std::make_shared<CachedToolList>();
+        auto &paged = cached->paged;
+        paged.version = snapshot.version;
+        paged.sorted = true;
+        paged.array = "tools";
+
+        // Sorted, so pages keep their order across registry versions
+        std::vector<const protocol::Tool *> sorted;
+        sorted.reserve(snapshot.tools.size());
+        for (const auto &[name, registered_tool]: snapshot.tools) {
+            sorted.push_back(&registered_tool->metadata);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) { return a->name < b->name; });
+
+        std::string tools = "[";
+        for (const auto *tool: sorted) {
+            if (tools.size() > 1) {
+                tools += ',';
+            }
+            paged.keys.push_back(tool->name);
+            tools += paged.entries.emplace_back(protocol::to_list_entry(*tool).dump());
+        }
+        tools += ']';
+
+        cached->registry = registry;
+        cached->version = snapshot.version;
+        cached->etag = utils::content_etag(tools);
+        // The version is what the deltas of notifications/tools/list_changed are relative to
+        paged.head = R"("_meta":{"etag":)" + nlohmann::json(cached->etag).dump() + R"(,"version":)" + std::to_string(snapshot.version) + "}";
+        paged.full = std::make_shared<const std::string>("{" + paged.head + R"(,"tools":)" + tools + "}");
+        return cached;
+    }
+
+    protocol::Response handle_tools_list(
+            const protocol::Request &req,
+            const business::RequestContext &ctx) {
+        static std::atomic<std::shared_ptr<const CachedToolList>> cache;
+
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+
+        const auto &registry = ctx.registry;
+        auto snapshot = registry->snapshot();
+        auto cached = cache.load(std::memory_order_acquire);
+        if (!cached || cached->registry != registry.get() || cached->version != snapshot->version) {
+            // Concurrent rebuilds produce identical lists, whichever is stored last wins
+            cached = build_tools_list(*snapshot, registry.get());
+            cache.store(cached, std::memory_order_release);
+        }
+
+        // The tag a client holds comes as "_meta.etag", or as If-None-Match from HTTP clients
+        bool held = ctx.session && utils::etag_matches(ctx.session->get_headers().get("If-None-Match"), cached->etag);
+        if (!held && req.params.is_object() && req.params.contains("_meta")) {
+            const auto &meta = req.params["_meta"];
+            held = meta.is_object() && meta.contains("etag") && meta["etag"].is_string() &&
+                   meta["etag"].get<std::string>() == cached->etag;
+        }
+        if (held) {
+            resp.result = nlohmann::json{{"_meta", {{"etag", cached->etag}, {"version", cached->version}, {"notModified", true}}}};
+            return resp;
+        }
+
+        respond_with_page(req, resp, cached->paged);
+        return resp;
+    }
+}// namespace mcp::routers
@@ -1,43 +1,23 @@
 #pragma once
+#include "business/request_context.h"
 #include "protocol/json_rpc.h"
-#include "tool_registry.h"
-#include "transport/session.h"
 #include <memory>
+#include <string>
 
 namespace mcp::routers {
+
     /**
      * @brief Handle tool list request
+     * The result is served from a cache that is rebuilt only when the registry version changes.
+     * A client that sends the etag of its last list in params._meta.etag gets a short
+     * "notModified" result instead of the full list while the tools are unchanged. Tools are sorted
+     * by name and sent in pages of PaginationOptions::page_size, see respond_with_page().
      * @param req RPC request
-     * @param registry Tool registry containing available tools
+     * @param ctx Request context, the tools come from its registry
      * @return Response with list of tools and their metadata
      */
-    inline protocol::Response handle_tools_list(
+    protocol::Response handle_tools_list(
             const protocol::Request &req,
-            std::shared_ptr<business::ToolRegistry> registry,
-            std::shared_ptr<transport::Session> /*session*/,
-            const std::string & /*session_id*/) {
-
-        protocol::Response resp;
-        resp.id = req.id.value_or(nullptr);
-
-        auto tools = registry->get_all_tools();
-        nlohmann::json tools_json = nlohmann::json::array();
-
-        for (const auto &tool: tools) {
-            nlohmann::json tool_json = {
-                    {"name", tool.name},
-                    {"description", tool.description}};
-
-            if (!tool.parameters.is_null() && !tool.parameters.empty()) {
-                tool_json["inputSchema"] = tool.parameters;
-            }
-            if (tool.is_streaming) {
-                tool_json["isStreaming"] = true;
-            }
-            tools_json.push_back(tool_json);
-        }
+            const business::RequestContext &ctx);
 
-        resp.result = nlohmann::json{{"tools", tools_json}};
-        return resp;
-    }
-}// namespace mcp::routers
\ No newline at end of file
+}// namespace mcp::routers
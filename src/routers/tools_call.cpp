@@ -0,0 +1,1323 @@
+#include "tools_call.hpp"
+#include "cancellation.h"
+#include "idempotency_cache.h"
+#include "core/logger.h"
+#include "metrics/audit_log.h"
+#include "metrics/metrics_manager.h"
+#include "metrics/rate_limiter.h"
+#include "plugin_manager.h"
+#include "plugin_usage.h"
+#include "progress.h"
+#include "protocol/json_rpc.h"
+#include "request_handler.h"
+#include "rpc_router.h"
+#include "stream_pump.h"
+#include "stream_sessions.h"
+#include "stream_waiter.h"
+#include "tool_deadline.h"
+#include "tool_output.h"
+#include "tool_result_cache.h"
+#include "transport/chunked_body.h"
+#include "transport/cluster_quota.h"
+#include "transport/drain.h"
+#include "transport/hot_restart.h"
+#include "transport/mcp_cache.h"
+#include "transport/notification_broadcast.h"
+#include "transport/sse_send_queue.h"
+#include "transport/upload_stream.h"
+#include "utils/base64.h"
+#include "utils/content_hash.h"
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mcp::routers {
+
+    // Longest wait for a non-blocking generator before next() is tried again, bounds a lost wakeup
+    constexpr std::chrono::milliseconds kStreamRepollInterval{1000};
+    // Retry interval for a generator that returns MCP_STREAM_WOULD_BLOCK without exporting get_stream_wait
+    constexpr std::chrono::milliseconds kStreamWaitFallbackInterval{10};
+
+    /**
+     * @brief Drop the stream of a session at once, it cannot be resumed then.
+     */
+    static void release_stream_session(const std::string &session_id) {
+        business::StreamSessionRegistry::instance().release(session_id);
+    }
+
+    /**
+     * @brief SAX handler that validates a tool result and records its top-level shape without building a DOM.
+     */
+    struct ToolResultShape {
+        using json = nlohmann::json;
+
+        bool is_object = false;    ///< Top-level value is an object
+        bool has_error = false;    ///< Top-level "error" key
+        bool has_text = false;     ///< Top-level "text" key
+        bool content_array = false;///< Top-level "content" key holding an array
+
+        bool null() { return value(false); }
+        bool boolean(bool) { return value(false); }
+        bool number_integer(json::number_integer_t) { return value(false); }
+        bool number_unsigned(json::number_unsigned_t) { return value(false); }
+        bool number_float(json::number_float_t, const json::string_t &) { return value(false); }
+        bool string(json::string_t &) { return value(false); }
+        bool binary(json::binary_t &) { return value(false); }
+        bool start_object(std::size_t) {
+            if (depth_ == 0) {
+                is_object = true;
+            }
+            value(false);
+            ++depth_;
+            return true;
+        }
+        bool key(json::string_t &name) {
+            if (depth_ == 1) {
+                key_.swap(name);
+            }
+            return true;
+        }
+        bool end_object() {
+            --depth_;
+            return true;
+        }
+        bool start_array(std::size_t) {
+            value(true);
+            ++depth_;
+            return true;
+        }
+        bool end_array() {
+            --depth_;
+            return true;
+        }
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) { return false; }
+
+    private:
+        bool value(bool is_array) {
+            if (depth_ == 1 && is_object) {
+                has_error |= key_ == "error";
+                has_text |= key_ == "text";
+                if (key_ == "content") {
+                    content_array = is_array;
+                }
+            }
+            return true;
+        }
+
+        std::size_t depth_ = 0;
+        std::string key_;
+    };
+
+    /**
+     * @brief Turn raw tool output into a serialized tools/call result without parsing it into a DOM.
+     * Output that already has a content array is used verbatim; other objects become a single text
+     * item. Strings, objects with "text" and errors need the parsed value and are left to the caller.
+     * @param output Raw tool output, moved from when a result is returned
+     * @return Serialized result, or nullptr if the output has to be parsed
+     * @throws std::runtime_error If the output is not valid JSON
+     */
+    static std::shared_ptr<const std::string> splice_tool_result(business::ToolOutput &output) {
+        if (output.passthrough && !business::ToolOutputOptions::current().validate_passthrough) {
+            return std::make_shared<const std::string>(std::move(output.json));
+        }
+
+        ToolResultShape shape;
+        if (!nlohmann::json::sax_parse(output.json, &shape)) {
+            throw std::runtime_error("Tool returned invalid JSON");
+        }
+        if (!shape.is_object || shape.has_error || (shape.has_text && !shape.content_array)) {
+            return nullptr;
+        }
+        if (shape.content_array) {
+            return std::make_shared<const std::string>(std::move(output.json));
+        }
+        // Same as wrapping result->dump(), but the plugin's bytes are escaped as they are
+        return std::make_shared<const std::string>(
+                R"({"content":[{"type":"text","text":)" + nlohmann::json(std::move(output.json)).dump() + "}]}");
+    }
+
+    std::optional<std::string> stream_event_data(std::string_view item) {
+        if (item.empty() || item.front() != '{') {
+            return std::nullopt;
+        }
+        if (item.find_first_of("\r\n") == std::string_view::npos) {
+            if (!nlohmann::json::accept(item)) {
+                return std::nullopt;
+            }
+            return std::string(item);
+        }
+        auto data = nlohmann::json::parse(item, nullptr, false);
+        if (data.is_discarded()) {
+            return std::nullopt;
+        }
+        return data.dump();
+    }
+
+    std::optional<std::string> oversized_event(const char *item, std::string_view tool_name) {
+        const size_t limit = metrics::RateLimiter::getInstance()->get_config().max_response_size;
+        if (limit == 0 || strnlen(item, limit + 1) <= limit) {
+            return std::nullopt;
+        }
+        MCP_WARN("Stream event of tool {} exceeds max_response_size of {} bytes, ending the stream", tool_name, limit);
+        return nlohmann::json{{"code", protocol::error_code::RESPONSE_TOO_LARGE},
+                              {"message", "Stream event exceeds the maximum response size of " + std::to_string(limit) + " bytes"}}
+                .dump();
+    }
+
+    protocol::Response run_tool_call(const protocol::Request &req,
+                                     const std::shared_ptr<business::ToolRegistry> &registry,
+                                     const std::string &tool_name,
+                                     const nlohmann::json &args) {
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+        try {
+            // Plugin tools hand over their bytes; most results are spliced into the response unparsed
+            std::optional<nlohmann::json> result;
+            if (auto raw = registry->execute_raw(tool_name, args)) {
+                if (raw->error_code != 0) {
+                    resp.error = protocol::Error{
+                            raw->error_code,
+                            raw->error_message,
+                            std::nullopt,
+                            req.id.value_or(nullptr)};
+                    return resp;
+                }
+                if (auto spliced = splice_tool_result(*raw)) {
+                    resp.raw_result = std::move(spliced);
+                    return resp;
+                }
+                result = nlohmann::json::parse(raw->json);
+            } else {
+                result = registry->execute(tool_name, args);
+            }
+            if (!result) {
+                // return the error when tools failed
+                resp.error = protocol::Error{
+                        protocol::error_code::INTERNAL_ERROR,
+                        "Tool execution failed",
+                        std::nullopt,
+                        req.id.value_or(nullptr)};
+                return resp;
+            }
+
+            // check if there is error
+            if (result->contains("error")) {
+                // return plugin's error and err msg
+                resp.error = protocol::Error{
+                        (*result)["error"].value("code", protocol::error_code::INTERNAL_ERROR),
+                        (*result)["error"].value("message", "Unknown error"),
+                        std::nullopt,
+                        req.id.value_or(nullptr)};
+                return resp;
+            }
+
+            // Check if the result is already in the correct MCP format with content array
+            if (result->contains("content") && (*result)["content"].is_array()) {
+                // Already in correct format, use directly
+                resp.result = *result;
+            } else {
+                // Convert to MCP format
+                nlohmann::json content_array = nlohmann::json::array();
+
+                // Check if result is a string (text content) or object
+                if (result->is_string()) {
+                    // Pure text content from plugin
+                    content_array.push_back({{"type", "text"}, {"text", result->get<std::string>()}});
+                } else if (result->is_object() && result->contains("text")) {
+                    // Object with text field
+                    content_array.push_back({{"type", "text"}, {"text", (*result)["text"]}});
+                } else {
+                    // Other JSON content
+                    content_array.push_back({{"type", "text"}, {"text", result->dump()}});
+                }
+
+                resp.result = nlohmann::json{{"content", content_array}};
+            }
+            return resp;
+        } catch (const std::exception &e) {
+            resp.error = protocol::Error{
+                    protocol::error_code::INTERNAL_ERROR,
+                    e.what(),
+                    std::nullopt,
+                    req.id.value_or(nullptr)};
+            return resp;
+        }
+    }
+
+    /**
+     * @brief Progress notifications of a synchronous call.
+     *
+     * A client with an event stream open gets them there, and its response stays ordinary JSON.
+     * Otherwise they go on the request's own connection: the first notification turns the
+     * response into a plain SSE stream of headers, the notifications and finally the response as
+     * one more event, after which the connection is closed. Unlike a streaming tool nothing is
+     * registered, cached or resumable; a call that reports no progress is answered with ordinary JSON.
+     */
+    struct ProgressResponse {
+        std::shared_ptr<transport::Session> session;
+        std::shared_ptr<transport::SseSendQueue> queue;///< Created by the first notification
+        std::shared_ptr<business::ProgressReporter> reporter;
+        std::string channel;///< Client session whose event stream carries the notifications, empty for none
+
+        /**
+         * @brief Set up progress reporting for a request whose client asked for it and accepts SSE,
+         *        on the response or on its event stream.
+         * @return nullptr if the request does not get progress notifications
+         */
+        static std::shared_ptr<ProgressResponse> create(const protocol::Request &req,
+                                                        const std::shared_ptr<transport::Session> &session,
+                                                        bool client_supports_sse) {
+            auto token = business::ProgressReporter::token_of(req.params);
+            if (!token || !session) {
+                return nullptr;
+            }
+            std::string channel = session->client_session_id();
+            if (!transport::NotificationBroadcast::instance().channel(channel)) {
+                channel.clear();
+            }
+            if (channel.empty() && !client_supports_sse) {
+                return nullptr;
+            }
+            auto progress = std::make_shared<ProgressResponse>();
+            progress->session = session;
+            progress->channel = std::move(channel);
+            // The sink runs on the session's executor, so the queue needs no lock
+            progress->reporter = business::ProgressReporter::create(
+                    std::move(*token), session->get_executor(),
+                    [weak = std::weak_ptr<ProgressResponse>(progress)](std::string notification) {
+                        auto self = weak.lock();
+                        if (!self || self->session->is_closed()) {
+                            return;
+                        }
+                        // A channel that has closed since leaves the rest of the call without progress
+                        if (!self->channel.empty()) {
+                            transport::NotificationBroadcast::instance().send(
+                                    self->channel, {std::make_shared<const std::string>(std::move(notification))});
+                            return;
+                        }
+                        transport::SseSendQueue::Frame frame;
+                        if (!self->queue) {
+                            auto encoding = transport::stream_encoding(self->session->get_headers());
+                            self->queue = transport::SseSendQueue::create(self->session, transport::SseQueueOptions::current(), encoding);
+                            self->queue->push_head("HTTP/1.1 200 OK\r\n"
+                                                   "Content-Type: text/event-stream\r\n"
+                                                   "Cache-Control: no-cache, no-transform\r\n" +
+                                                   transport::encoding_header(encoding) +
+                                                   "Connection: close\r\n"
+                                                   "Mcp-Session-Id: " +
+                                                   self->session->get_session_id() + "\r\n\r\n");
+                        }
+                        frame.push_back("event: message\ndata: " + notification + "\n\n");
+                        asio::co_spawn(self->session->get_executor(),
+                                       [queue = self->queue, frame = std::move(frame)]() mutable -> asio::awaitable<void> {
+                                           co_await queue->push(std::move(frame));
+                                       },
+                                       asio::detached);
+                    });
+            if (!progress->reporter) {
+                return nullptr;// disabled by configuration
+            }
+            return progress;
+        }
+
+        /**
+         * @brief Stop reporting and, if notifications went out, send the response as the last event.
+         * @param response Response of the call
+         * @return true if the response was sent on the event stream and must not be sent again
+         */
+        static asio::awaitable<bool> finish(std::shared_ptr<ProgressResponse> progress, const protocol::Response &response) {
+            co_return co_await asio::co_spawn(
+                    progress->session->get_executor(),
+                    [progress, response]() -> asio::awaitable<bool> {
+                        progress->reporter->close();
+                        if (!progress->queue) {
+                            co_return false;
+                        }
+                        transport::SseSendQueue::Frame frame;
+                        frame.push_back("event: message\ndata: " + protocol::make_response(response) + "\n\n");
+                        co_await progress->queue->push(std::move(frame));
+                        co_await progress->queue->drain();
+                        progress->session->close();
+                        co_return true;
+                    },
+                    asio::use_awaitable);
+        }
+    };
+
+    /**
+     * @brief Run a synchronous tool call, memoized for tools configured as cacheable.
+     * @param cancel Token of the request, polled by plugins exporting call_tool_cancellable. Memoized
+     *        calls ignore it: their flight is shared with identical calls, one client cancelling does not stop it
+     * @param progress Reporter of the request for plugins exporting call_tool_with_progress, nullptr if
+     *        the client did not ask for progress; memoized calls ignore it for the same reason
+     * @param span Trace context the plugin propagates, nullptr if the request is not traced; memoized
+     *        calls ignore it as well
+     * @param upload Streamed argument the plugin reads while the body arrives, nullptr if there is none;
+     *        calls with one are never memoized
+     */
+    static asio::awaitable<protocol::Response> run_sync_tool_call_here(const protocol::Request &req,
+                                                                       const std::shared_ptr<business::ToolRegistry> &registry,
+                                                                       const std::string &tool_name,
+                                                                       const nlohmann::json &args,
+                                                                       const business::CancellationToken *cancel,
+                                                                       const business::ProgressReporter *progress,
+                                                                       const metrics::SpanContext *span,
+                                                                       transport::UploadStream *upload) {
+        auto &result_cache = business::ToolResultCache::instance();
+        if (!upload && result_cache.enabled_for(tool_name)) {
+            co_return co_await result_cache.call(tool_name, args, registry->version(), req.id.value_or(nullptr),
+                                                 [&]() { return run_tool_call(req, registry, tool_name, args); });
+        }
+
+        protocol::Response resp;
+        {
+            business::CancellationToken::Scope cancel_scope(cancel);
+            business::ProgressReporter::Scope progress_scope(progress);
+            metrics::SpanContext::Scope span_scope(span);
+            transport::UploadStream::Scope upload_scope(upload);
+            resp = run_tool_call(req, registry, tool_name, args);
+        }
+        if (cancel && cancel->cancelled()) {
+            resp = protocol::Response{protocol::Error{protocol::error_code::REQUEST_CANCELLED, "Request cancelled"},
+                                      req.id.value_or(nullptr)};
+        }
+        co_return resp;
+    }
+
+    /**
+     * @brief Run a synchronous tool call in its plugin's turn, see run_sync_tool_call_here().
+     *
+     * Calls of tools that are not reentrant queue on their plugin's strand, suspended rather than
+     * holding a pool worker, and run there with the scopes the plugin reads set on that thread.
+     */
+    static asio::awaitable<protocol::Response> run_sync_tool_call(const protocol::Request &req,
+                                                                  const std::shared_ptr<business::ToolRegistry> &registry,
+                                                                  const std::string &tool_name,
+                                                                  const nlohmann::json &args,
+                                                                  const business::CancellationToken *cancel,
+                                                                  const business::ProgressReporter *progress = nullptr,
+                                                                  const metrics::SpanContext *span = nullptr,
+                                                                  transport::UploadStream *upload = nullptr) {
+        auto plugin_manager = registry->get_plugin_manager();
+        if (auto strand = plugin_manager ? plugin_manager->tool_strand(tool_name) : nullptr) {
+            co_return co_await asio::co_spawn(strand->executor(),
+                                              run_sync_tool_call_here(req, registry, tool_name, args, cancel, progress, span, upload),
+                                              asio::use_awaitable);
+        }
+        co_return co_await run_sync_tool_call_here(req, registry, tool_name, args, cancel, progress, span, upload);
+    }
+
+    /**
+     * @brief Send a large synchronous result as a chunked response while it is serialized.
+     *
+     * The result goes out result_stream_chunk bytes at a time and each piece is written before the
+     * next one is serialized, so neither the whole body nor a second copy of it is held. A JSON
+     * result is serialized up to result_stream_threshold first; one that ends there is handed back
+     * as raw_result and answered as usual, without serializing it again. max_response_size is
+     * checked as the body grows: a result beyond it is answered with an error while nothing has been
+     * sent, later its connection is dropped before the body ends.
+     * @param resp Response of the call, replaced by an error or a spliced result when it is not streamed
+     * @return true if the response was sent and must not be sent again
+     */
+    static asio::awaitable<bool> stream_large_result(const std::shared_ptr<transport::Session> &session, protocol::Response &resp) {
+        const auto &options = business::ToolOutputOptions::current();
+        if (!session || options.result_stream_threshold == 0 || resp.error || resp.id.is_null()) {
+            co_return false;
+        }
+        const size_t limit = metrics::RateLimiter::getInstance()->get_config().max_response_size;
+
+        std::string piece;
+        std::optional<protocol::JsonPieceWriter> writer;
+        std::string_view raw;
+        if (resp.raw_result) {
+            if (resp.raw_result->size() <= options.result_stream_threshold) {
+                co_return false;
+            }
+            raw = *resp.raw_result;
+        } else {
+            if (resp.result.is_null() || resp.result.is_discarded()) {
+                co_return false;
+            }
+            writer.emplace(resp.result);
+            if (!writer->next(piece, options.result_stream_threshold)) {
+                resp.raw_result = std::make_shared<const std::string>(std::move(piece));
+                resp.result = nullptr;
+                co_return false;
+            }
+        }
+        if (limit > 0 && std::max(raw.size(), piece.size()) > limit) {
+            MCP_WARN("Tool result exceeds max_response_size of {} bytes (session: {})", limit, session->get_session_id());
+            resp = protocol::Response{protocol::Error{protocol::error_code::RESPONSE_TOO_LARGE,
+                                                      "Tool result exceeds the maximum response size of " + std::to_string(limit) + " bytes"},
+                                      resp.id};
+            co_return false;
+        }
+
+        // Once the header is out an error cannot be answered any more, only the connection dropped
+        transport::ChunkedBodyWriter body(session, transport::stream_encoding(session->get_headers()));
+        try {
+            co_await body.begin();
+            std::string head;
+            protocol::write_response_head(head, resp.id);
+            co_await body.write(std::move(head));
+            bool more = true;
+            while (more && !body.closed()) {
+                if (writer) {
+                    if (piece.empty()) {
+                        more = writer->next(piece, options.result_stream_chunk);
+                    }
+                } else {
+                    auto take = std::min(raw.size(), options.result_stream_chunk);
+                    piece.assign(raw.substr(0, take));
+                    raw.remove_prefix(take);
+                    more = !raw.empty();
+                }
+                if (limit > 0 && body.written() + piece.size() > limit) {
+                    MCP_WARN("Tool result exceeds max_response_size of {} bytes after {} bytes were sent, dropping the connection (session: {})",
+                             limit, body.written(), session->get_session_id());
+                    body.abort();
+                    co_return true;
+                }
+                co_await body.write(std::exchange(piece, {}));
+            }
+            co_await body.write("}");
+            co_await body.finish();
+            MCP_DEBUG("Streamed a {} byte tool result (session: {})", body.written(), session->get_session_id());
+        } catch (const std::exception &e) {
+            MCP_ERROR("Failed to stream tool result: {}", e.what());
+            body.abort();
+        }
+        co_return true;
+    }
+
+    std::optional<protocol::Error> check_tool_arguments(const business::RegisteredTool &tool, const nlohmann::json &args) {
+        if (!tool.arguments_validator) {
+            return std::nullopt;
+        }
+        // Absent arguments are an empty object
+        static const nlohmann::json no_arguments = nlohmann::json::object();
+        auto violation = tool.arguments_validator->validate(args.is_null() ? no_arguments : args);
+        if (!violation) {
+            return std::nullopt;
+        }
+        MCP_DEBUG("Invalid arguments for tool '{}' at '{}': {}", tool.metadata.name, violation->path, violation->message);
+        std::string where = violation->path.empty() ? "arguments" : "arguments" + violation->path;
+        return protocol::Error{protocol::error_code::INVALID_TOOL_INPUT,
+                               "Invalid arguments for tool " + tool.metadata.name + ": " + where + " " + violation->message,
+                               nlohmann::json{{"path", violation->path}}};
+    }
+
+    /**
+     * @brief Run a streaming call as a sub-stream of the client's event stream.
+     *
+     * For a client that posts without accepting SSE but has its GET event stream open: the
+     * request is answered at once, with the sub-stream's name in "_meta", and the call's events
+     * follow on the event stream with SSE ids "<name>/<n>", the name being the request id. Any
+     * number of calls share the one connection, each costs a coroutine on the stream's executor.
+     * Sub-streams are neither cached nor resumable; they end with a complete or error event, or
+     * when the event stream closes.
+     * @return Response to the request
+     */
+    static protocol::Response stream_on_channel(const protocol::Request &req,
+                                                const std::shared_ptr<business::PluginManager> &plugin_manager,
+                                                const std::string &tool_name,
+                                                const nlohmann::json &args,
+                                                const transport::NotificationBroadcast::Channel &channel,
+                                                std::shared_ptr<business::CancellationToken> cancel) {
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+
+        const auto &id = resp.id;
+        std::string name = id.is_string() ? id.get<std::string>() : id.dump();
+        // The name goes into the SSE id field, where a line break would start a field of its own
+        if (name.find_first_of("\r\n") != std::string::npos) {
+            resp.error = protocol::Error{protocol::error_code::INVALID_REQUEST,
+                                         "A request id with a line break cannot name a sub-stream"};
+            return resp;
+        }
+
+        MCPError tool_error = {0, nullptr, nullptr, nullptr};
+        StreamGenerator generator = plugin_manager->start_streaming_tool(tool_name, args, &tool_error);
+        auto functions = generator ? plugin_manager->get_stream_functions(generator) : business::PluginManager::StreamFunctions{};
+        if (!generator || !functions.next || !functions.free) {
+            if (generator && functions.free) {
+                functions.free(generator);
+            }
+            resp.error = protocol::Error{
+                    tool_error.code ? tool_error.code : protocol::error_code::INTERNAL_ERROR,
+                    tool_error.message ? tool_error.message : "Failed to start streaming tool: " + tool_name};
+            return resp;
+        }
+
+        resp.result = {{"content", nlohmann::json::array()}, {"_meta", {{"stream", name}}}};
+
+        asio::co_spawn(channel.executor, [generator, functions, weak_queue = channel.queue, cancel, tool_name, name]() -> asio::awaitable<void> {
+            std::shared_ptr<business::StreamPump> pump;
+            if (!functions.wait) {
+                pump = business::StreamPump::start(generator, functions.next, functions.owner, tool_name, functions.plugin);
+            }
+            auto waiter = std::make_shared<business::StreamWaiter>();
+            if (cancel) {
+                cancel->on_cancel([generator, cancel_func = functions.cancel, pump, waiter]() {
+                    if (cancel_func) {
+                        cancel_func(generator);
+                    }
+                    if (pump) {
+                        pump->interrupt();
+                    } else {
+                        business::StreamWaiter::wakeup(waiter.get());
+                    }
+                });
+            }
+
+            const auto &batch_options = business::ToolOutputOptions::current();
+            int event_id = 1;
+            auto event = [&name, &event_id](std::string_view type, std::string_view data) {
+                return std::string("event: ").append(type).append("\nid: ").append(name).append("/").append(std::to_string(event_id++)).append("\ndata: ").append(data).append("\n\n");
+            };
+
+            bool finished = false;
+            while (!finished) {
+                if (cancel && cancel->cancelled()) {
+                    transport::SseSendQueue::Frame frame;
+                    frame.push_back(event("error", nlohmann::json{{"code", protocol::error_code::REQUEST_CANCELLED}, {"message", "Request cancelled"}}.dump()));
+                    if (auto queue = weak_queue.lock()) {
+                        co_await queue->push(std::move(frame));
+                    }
+                    break;
+                }
+
+                transport::SseSendQueue::Frame frame;
+                bool would_block = false;
+                const auto deadline = std::chrono::steady_clock::now() + batch_options.stream_batch_max_delay;
+                while (frame.size() < batch_options.stream_batch_max_items) {
+                    const char *result_json = nullptr;
+                    MCPError error = {0, nullptr, nullptr, nullptr};
+                    int status;
+                    if (pump) {
+                        status = pump->next(&result_json, &error);
+                    } else {
+                        business::PluginUsage::Meter meter(functions.plugin, tool_name);
+                        status = functions.next(generator, &result_json, &error);
+                    }
+                    if (status == 1) {
+                        frame.push_back(event("complete", nlohmann::json{{"message", "Stream completed"}}.dump()));
+                        finished = true;
+                        break;
+                    } else if (status == -1) {
+                        std::string message = error.message ? error.message : (result_json && *result_json ? result_json : "Unknown stream error");
+                        frame.push_back(event("error", nlohmann::json{{"code", error.code ? error.code : protocol::error_code::INTERNAL_ERROR}, {"message", message}}.dump()));
+                        finished = true;
+                        break;
+                    } else if (status == MCP_STREAM_WOULD_BLOCK) {
+                        would_block = true;
+                        break;
+                    } else if (result_json && *result_json != '\0') {
+                        if (auto overflow = oversized_event(result_json, tool_name)) {
+                            frame.push_back(event("error", *overflow));
+                            finished = true;
+                            break;
+                        }
+                        if (auto data = stream_event_data(result_json)) {
+                            frame.push_back(event("message", *data));
+                        } else {
+                            MCP_ERROR("Invalid data format: {}", result_json);
+                        }
+                    }
+                    if (std::chrono::steady_clock::now() >= deadline) {
+                        break;
+                    }
+                }
+
+                auto queue = weak_queue.lock();
+                if (!queue || (!frame.empty() && !co_await queue->push(std::move(frame)))) {
+                    MCP_INFO("Event stream closed, stopping sub-stream {} of tool {}", name, tool_name);
+                    break;
+                }
+                queue.reset();// A closed stream is not held open by a waiting generator
+
+                if (would_block && pump) {
+                    co_await pump->wait(kStreamRepollInterval);
+                } else if (would_block) {
+                    co_await waiter->wait(functions.wait, generator, kStreamRepollInterval);
+                }
+            }
+
+            if (cancel) {
+                cancel->clear_callback();
+            }
+            // A pump frees the generator itself once the call it may be running has returned
+            if (pump) {
+                pump->close(functions.free);
+            } else {
+                functions.free(generator);
+            }
+            co_return; }, asio::detached);
+
+        MCP_DEBUG("Tool {} streams on the event channel as {}", tool_name, name);
+        return resp;
+    }
+
+    /**
+     * @brief Queue the audit record of an answered tool call.
+     * @param status 0 for success, else the error code it was answered with
+     */
+    static void audit_tool_call(const protocol::Request &req,
+                                const transport::Session *session,
+                                const std::string &session_id,
+                                std::chrono::system_clock::time_point arrived,
+                                std::chrono::steady_clock::time_point started,
+                                int32_t status) {
+        metrics::AuditRecord record;
+        record.unix_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(arrived.time_since_epoch()).count());
+        record.duration_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count());
+        record.status = status;
+        record.tool = req.params.value("name", "");
+        // The arguments are kept as a hash only, they may hold anything
+        auto arguments = req.params.find("arguments");
+        record.args_hash = utils::content_hash(arguments != req.params.end()
+                                                       ? arguments->dump(-1, ' ', false, nlohmann::json::error_handler_t::replace)
+                                                       : std::string());
+        if (session) {
+            record.caller = transport::ClusterQuota::tenant_of(session->get_headers(), &session->auth_decision());
+        }
+        record.session = session_id;
+        metrics::AuditLog::instance().record(record);
+    }
+
+    static asio::awaitable<protocol::Response> call_tool(
+            const protocol::Request &req,
+            const business::RequestContext &ctx);
+
+    asio::awaitable<protocol::Response> handle_tools_call(
+            const protocol::Request &req,
+            const business::RequestContext &ctx) {
+        if (!metrics::AuditLog::instance().enabled()) {
+            co_return co_await call_tool(req, ctx);
+        }
+        auto arrived = std::chrono::system_clock::now();
+        auto started = std::chrono::steady_clock::now();
+        std::optional<protocol::Response> resp;
+        try {
+            resp = co_await call_tool(req, ctx);
+        } catch (...) {
+            audit_tool_call(req, ctx.session.get(), ctx.session_id, arrived, started, protocol::error_code::INTERNAL_ERROR);
+            throw;
+        }
+        audit_tool_call(req, ctx.session.get(), ctx.session_id, arrived, started, resp->error ? resp->error->code : 0);
+        co_return std::move(*resp);
+    }
+
+    static asio::awaitable<protocol::Response> call_tool(
+            const protocol::Request &req,
+            const business::RequestContext &ctx) {
+        // Borrowed for the request; the stream and a call past its deadline capture their own copies
+        const auto &registry = ctx.registry;
+        const auto &session = ctx.session;
+        const std::string &session_id = ctx.session_id;
+        protocol::Response resp;
+        resp.id = req.id.value_or(nullptr);
+
+        // Set by notifications/cancelled; a cancelled call is answered with an error
+        auto cancel = business::RpcRouter::cancellation_token(req, session, session_id);
+
+        // read in place, arguments can be large
+        static const nlohmann::json no_arguments;
+        const auto &params = req.params;
+        std::string tool_name = params.value("name", "");
+        auto arguments = params.find("arguments");
+        const nlohmann::json &args = arguments != params.end() ? *arguments : no_arguments;
+
+        // Validate tool existence
+        auto tool = registry->get_tool(tool_name);
+        if (!tool) {
+            resp.error = protocol::Error{
+                    protocol::error_code::METHOD_NOT_FOUND,
+                    "Tool not found: " + tool_name};
+            co_return resp;
+        }
+        const protocol::Tool *tool_info = &tool->metadata;
+        if (req.trace) {
+            req.trace->set_tool(tool_name);
+        }
+        if (auto error = check_tool_arguments(*tool, args)) {
+            resp.error = std::move(*error);
+            co_return resp;
+        }
+
+        // Validate plugin manager
+        auto plugin_manager = registry->get_plugin_manager();
+        if (!plugin_manager) {
+            resp.error = protocol::Error{
+                    protocol::error_code::INTERNAL_ERROR,
+                    "PluginManager not found"};
+            co_return resp;
+        }
+
+        // Check client SSE support
+        std::string accept_header = session ? session->get_accept_header() : std::string();
+        bool client_supports_sse = (accept_header.find("text/event-stream") != std::string::npos);
+
+        MCP_DEBUG("Tool name: {}", tool_name);
+        MCP_DEBUG("Tool is_streaming: {}", tool_info->is_streaming);
+        MCP_DEBUG("Client supports SSE: {}", client_supports_sse);
+
+        // A client that takes no SSE on the request but has its event stream open gets a sub-stream there
+        if (tool_info->is_streaming && !client_supports_sse && session) {
+            if (auto channel = transport::NotificationBroadcast::instance().channel(session->client_session_id())) {
+                co_return stream_on_channel(req, plugin_manager, tool_name, args, *channel, std::move(cancel));
+            }
+        }
+
+        // Streaming handling with reconnection support
+        if (tool_info->is_streaming && client_supports_sse) {
+            MCP_INFO("Upgrading to SSE stream for tool: {}", tool_name);
+            std::string current_session_id = session->get_session_id();
+            auto *cache = mcp::cache::McpCache::GetInstance();
+
+            // 1. Reconnection detection and state recovery
+            int last_event_id = 0;
+            bool is_reconnect = false;
+            const auto &headers = session->get_headers();
+
+            // Get last received event ID from request headers
+            if (headers.count("Last-Event-ID")) {
+                try {
+                    last_event_id = std::stoi(headers.at("Last-Event-ID"));
+                    // A reconnect may arrive on a new connection, or forwarded by another cluster node
+                    auto presented = headers.find("Mcp-Session-Id");
+                    if (presented != headers.end() && !presented->second.empty() && presented->second != current_session_id &&
+                        cache->GetSessionState(presented->second).has_value()) {
+                        current_session_id = presented->second;
+                    }
+                    auto session_state = cache->GetSessionState(current_session_id);
+
+                    if (session_state.has_value()) {
+                        is_reconnect = true;
+                        MCP_INFO("Reconnection detected - session: {}, last_event_id: {}",
+                                 current_session_id, last_event_id);
+                    }
+                } catch (...) {
+                    MCP_WARN("Invalid Last-Event-ID format, treating as new connection");
+                }
+            }
+
+            // 2. Send SSE response headers
+            std::string sse_header = "HTTP/1.1 200 OK\r\n";
+            sse_header += "Content-Type: text/event-stream\r\n";
+            sse_header += "Cache-Control: no-cache, no-transform\r\n";
+            sse_header += "Connection: keep-alive\r\n";
+            sse_header += "Mcp-Session-Id: " + current_session_id + "\r\n";
+            sse_header += "\r\n\r\n";
+
+            session->post_write(std::move(sse_header));
+
+            // 3. Send session initialization event
+            {
+                std::string init_event = nlohmann::json{
+                        {"jsonrpc", "2.0"},
+                        {"id", req.id.value_or(1)},
+                        {"session_id", current_session_id}}
+                                                 .dump();
+                std::string sse_init =
+                        "event: session_init\n"
+                        "id: " +
+                        std::to_string(static_cast<long long>(req.id.value_or(0))) + "\n"
+                                                                                     "data: " +
+                        init_event + "\n\n";
+
+                session->post_write(std::move(sse_init));
+            }
+
+            // 4. Get or create stream generator (reuse for reconnections)
+            StreamGenerator generator = nullptr;
+            StreamGeneratorFree stream_free_func = nullptr;
+            std::shared_ptr<business::StreamWaiter> stream_waiter;
+            MCPError tool_error = {0, nullptr, nullptr, nullptr};
+
+            auto &streams = business::StreamSessionRegistry::instance();
+            std::shared_ptr<business::StreamSession> stream;
+            std::optional<int> restored_after;// Last event before the checkpoint a restored generator continues from
+            if (is_reconnect) {
+                stream = streams.find(current_session_id);
+                if (stream) {
+                    generator = stream->generator;
+                    MCP_INFO("Reusing existing generator - session: {}", current_session_id);
+                } else {
+                    // A generator that left a checkpoint continues after it; others start over
+                    auto state = cache->GetSessionState(current_session_id);
+                    auto checkpoint = state && !state->checkpoint.empty() ? utils::base64_decode(state->checkpoint) : std::nullopt;
+                    if (checkpoint) {
+                        generator = plugin_manager->restore_streaming_tool(tool_name, args, *checkpoint);
+                        if (generator) {
+                            restored_after = state->checkpoint_event_id;
+                            MCP_INFO("Restored generator from checkpoint at event {} - session: {}", *restored_after, current_session_id);
+                        }
+                    }
+                    if (!generator) {
+                        MCP_WARN("Generator expired, recreating for reconnection - session: {}", current_session_id);
+                        generator = plugin_manager->start_streaming_tool(tool_name, args);
+                    }
+
+                    if (generator) {
+                        // Get the stream functions for the new generator
+                        auto stream_functions = plugin_manager->get_stream_functions(generator);
+                        stream_free_func = stream_functions.free;
+
+                        // Store the new generator with its free function
+                        stream = streams.attach(current_session_id, generator, stream_free_func, stream_functions.owner);
+                    }
+                }
+                if (stream) {
+                    stream_waiter = stream->waiter;
+                }
+
+                if (!generator) {
+                    std::string error_msg = "Session expired, please restart request";
+                    std::string sse_error = "event: error\n data: " +
+                                            nlohmann::json{{"message", error_msg}}.dump() + "\n\n";
+
+                    session->post_write(std::move(sse_error), true);
+
+                    resp.id = nullptr;
+                    resp.result = nlohmann::json::value_t::discarded;
+                    co_return resp;
+                }
+            } else {
+                // Create new generator for fresh connection
+                generator = plugin_manager->start_streaming_tool(tool_name, args);
+                if (!generator) {
+                    std::string error_msg = tool_error.message
+                                                    ? tool_error.message
+                                                    : "Failed to start streaming tool: " + tool_name;
+                    int error_code = tool_error.code ? tool_error.code : -mcp::protocol::error_code::INTERNAL_ERROR;
+
+                    nlohmann::json error_event = {
+                            {"code", error_code},
+                            {"message", error_msg}};
+
+
+                    std::string sse_error = "event: error\n data: " +
+                                            nlohmann::json{{"message", error_msg}}.dump() + "\n\n";
+                    session->post_write(std::move(sse_error), true);
+
+                    resp.id = nullptr;
+                    resp.result = nlohmann::json::value_t::discarded;
+                    co_return resp;
+                }
+
+                // Get the stream functions
+                auto stream_functions = plugin_manager->get_stream_functions(generator);
+                stream_free_func = stream_functions.free;
+
+                // Save generator with its free function for potential reconnection
+                stream = streams.attach(current_session_id, generator, stream_free_func, stream_functions.owner);
+                stream_waiter = stream->waiter;
+
+                // Initialize new session state
+                mcp::cache::SessionState initial_state;
+                initial_state.session_id = current_session_id;
+                initial_state.tool_name = tool_name;
+                initial_state.last_event_id = 0;
+                initial_state.last_update = std::chrono::system_clock::now();
+                cache->SaveSessionState(initial_state);
+            }
+
+            // 5. Get stream processing functions
+            auto stream_functions = plugin_manager->get_stream_functions(generator);
+            if (!stream_functions.next || !stream_functions.free || stream_functions.error.code != 0) {
+                std::string error_msg = "Stream functions not found for tool: " + tool_name;
+                if (stream_functions.error.message) {
+                    error_msg = stream_functions.error.message;
+                }
+
+                // Clean up if generator was created
+                if (stream_functions.free) stream_functions.free(generator);
+
+                // Remove from generator map if exists
+                streams.forget(session->get_session_id());
+
+                // Clean up cache session
+                cache->CleanupSession(session->get_session_id());
+
+                std::string sse_error = "event: error\n data: " +
+                                        nlohmann::json{{"message", error_msg}}.dump() + "\n\n";
+
+                session->post_write(std::move(sse_error), true);
+
+                resp.id = nullptr;
+                resp.result = nlohmann::json::value_t::discarded;
+                co_return resp;
+            }
+
+            StreamGeneratorNext stream_next = stream_functions.next;
+            StreamGeneratorFree stream_free = stream_functions.free;
+            StreamGeneratorWait stream_wait = stream_functions.wait;
+            StreamGeneratorCancel stream_cancel = stream_functions.cancel;
+            StreamGeneratorCheckpoint stream_checkpoint = stream_functions.checkpoint;
+
+            // Generators without the non-blocking interface are pulled on the stream pump pool
+            std::shared_ptr<business::StreamPump> stream_pump;
+            if (!stream_wait) {
+                stream_pump = streams.pump(current_session_id, [&]() {
+                    return business::StreamPump::start(generator, stream_next, stream_functions.owner, tool_name, stream_functions.plugin,
+                                                                      stream_checkpoint);
+                });
+            }
+
+            // 6. Reconnection data resend logic (based on Event-ID)
+            if (is_reconnect) {
+                auto frames = cache->GetReconnectFrames(current_session_id, last_event_id);
+                MCP_INFO("Reconnection resend plan - session: {}, items to resend: {}",
+                         current_session_id, frames.size());
+
+                // Resend everything before the stream consumer starts, so events stay in order.
+                // The frames keep their original event IDs and leave the outbound queue together.
+                if (!frames.empty() && !session->is_closed()) {
+                    for (auto &frame: frames) {
+                        session->post_write(std::move(frame));
+                    }
+                    MCP_DEBUG("Resend completed - session: {}", current_session_id);
+                }
+            }
+
+            // The span of a traced stream lasts as long as its consumer; the consumer outlives the
+            // request, so it gets a copy of the request without its trace
+            std::shared_ptr<metrics::Span> stream_span;
+            if (const auto *request_span = req.trace ? req.trace->span_context() : nullptr) {
+                stream_span = std::make_shared<metrics::Span>("tools/call stream", *request_span);
+                stream_span->set_attribute("mcp.tool.name", tool_name);
+                stream_span->set_attribute("mcp.stream.reconnect", is_reconnect ? "true" : "false");
+            }
+
+            // 7. Start stream consumer (new data processing + caching)
+            asio::co_spawn(session->get_executor(), [session, generator, stream, stream_next, stream_free, stream_wait, stream_cancel, stream_checkpoint, stream_waiter, stream_pump, cancel, owner = stream_functions.owner, plugin_name = stream_functions.plugin, tool_name, req = protocol::Request(req.method, req.params, req.id), current_session_id, last_event_id, is_reconnect, restored_after, stream_span]() -> asio::awaitable<void> {
+                    
+                const char* result_json = nullptr;
+                int status = 0;
+                auto* cache = mcp::cache::McpCache::GetInstance();
+                const auto& batch_options = business::ToolOutputOptions::current();
+                auto send_queue = transport::SseSendQueue::create(session);
+                std::string failure_event; // error event of an exception, sent after the loop
+                bool cancelled = false;
+
+                // A drain ends the stream after a batch it has cached; the client resumes it with
+                // Last-Event-ID, on another replica if the cache has a persistent backend
+                auto drained = std::make_shared<std::atomic<bool>>(false);
+                auto drain_watch = transport::Drain::instance().watch(session->get_executor(), [drained, stream_waiter, stream_pump]() {
+                    drained->store(true, std::memory_order_relaxed);
+                    if (stream_pump) {
+                        stream_pump->interrupt();
+                    } else if (stream_waiter) {
+                        business::StreamWaiter::wakeup(stream_waiter.get());
+                    }
+                });
+
+                // On cancellation the plugin is asked to return from a blocked next() and the
+                // consumer is woken; it frees the generator itself once it has left the loop
+                if (cancel) {
+                    cancel->on_cancel([generator, stream_cancel, stream_waiter, stream_pump]() {
+                        if (stream_cancel) {
+                            stream_cancel(generator);
+                        }
+                        if (stream_pump) {
+                            stream_pump->interrupt();
+                        } else if (stream_waiter) {
+                            business::StreamWaiter::wakeup(stream_waiter.get());
+                        }
+                    });
+                }
+
+                // Initialize event ID counter (continue from last on reconnection)
+
+                int event_id = 1;
+                if (restored_after) {
+                    event_id = *restored_after + 1;
+                } else if (is_reconnect) {
+                    //get the session_id after reconnect
+                    auto state_opt = cache->GetSessionState(current_session_id);
+                    if (state_opt.has_value()) {
+                        event_id = state_opt.value().last_event_id + 1;
+                    } else {
+                        event_id = last_event_id + 1;
+                    }
+                }
+
+                // Last event and checkpoint, committed to the cache as stream_state_commit says
+                mcp::cache::StreamStateWriter state_writer(current_session_id);
+
+                try {
+                    std::vector<std::pair<int, std::string>> batch; // event ID -> compact JSON, cached and then sent
+                    std::string checkpoint;                          // position after the last event of the batch, if the generator has them
+                    bool finished = false;
+                    bool would_block = false;
+
+                    while (!finished) {
+                        // Check connection status first
+                        if (session->is_closed()) {
+                            MCP_INFO("Connection closed, stopping stream - session: {}", current_session_id);
+                            break;
+                        }
+                        if (cancel && cancel->cancelled()) {
+                            cancelled = true;
+                            break;
+                        }
+                        if (drained->load(std::memory_order_relaxed)) {
+                            MCP_INFO("Server draining, ending stream at event {} - session: {}", event_id - 1, current_session_id);
+                            state_writer.commit();
+                            transport::HotRestart::instance().hand_over(current_session_id);
+                            break;
+                        }
+
+                        // Pull up to stream_batch_max_items events, or as many as arrive before the deadline
+                        batch.clear();
+                        checkpoint.clear();
+                        would_block = false;
+                        std::string final_event; // complete or error event that ends the stream
+                        const auto deadline = std::chrono::steady_clock::now() + batch_options.stream_batch_max_delay;
+
+                        while (batch.size() < batch_options.stream_batch_max_items) {
+                            // Get next stream data
+                            MCPError error = {0, nullptr, nullptr, nullptr};
+                            if (stream_pump) {
+                                status = stream_pump->next(&result_json, &error);
+                            } else {
+                                business::PluginUsage::Meter meter(plugin_name, tool_name);
+                                status = stream_next(generator, &result_json, &error);
+                            }
+
+                            // Handle stream termination
+                            if (status == 1) {
+                                MCP_DEBUG("Stream completed normally - session: {}", current_session_id);
+
+                                // Send stream completion event after the rest of the batch
+                                final_event =
+                                    "event: complete\n"
+                                    "id: " + std::to_string(event_id) + "\n"
+                                    "data: " + nlohmann::json{{"message", "Stream completed"}}.dump() + "\n\n";
+                                finished = true;
+                                break;
+                            }
+                            // Handle stream errors
+                            else if (status == -1) {
+                                std::string error_json_str = result_json ? result_json : "";
+                                nlohmann::json error_data;
+
+                                try {
+                                    // Try to parse error JSON
+                                    if (!error_json_str.empty()) {
+                                        error_data = nlohmann::json::parse(error_json_str);
+                                    }
+                                } catch (...) {
+                                    // Parsing failed, create default error
+                                    error_data = nlohmann::json{
+                                        {"error", {
+                                            {"code", protocol::error_code::INTERNAL_ERROR},
+                                            {"message", error_json_str.empty() ? "Unknown stream error" : error_json_str}
+                                        }}
+                                    };
+                                }
+
+                                // Extract error code and message
+                                int error_code = protocol::error_code::INTERNAL_ERROR;
+                                std::string error_msg = "Unknown stream error";
+
+                                if (error_data.contains("error")) {
+                                    error_code = error_data["error"].value("code", error_code);
+                                    error_msg = error_data["error"].value("message", error_msg);
+                                } else if (error.message) {
+                                    error_msg = error.message;
+                                }
+
+                                MCP_ERROR("Stream error - session: {}: {} (code: {})",
+                                        current_session_id, error_msg, error_code);
+
+                                // Send structured error event
+                                nlohmann::json error_event = {
+                                    {"code", error_code},
+                                    {"message", error_msg}
+                                };
+
+                                final_event = "event: error\n data: " +
+                                              error_event.dump() + "\n\n";
+                                finished = true;
+                                break;
+                            }
+                            // No data yet, send what the batch has and wait for the generator
+                            else if (status == MCP_STREAM_WOULD_BLOCK) {
+                                would_block = true;
+                                break;
+                            }
+                            // Process valid data
+                            else if (result_json && *result_json != '\0') {
+                                if (auto overflow = oversized_event(result_json, tool_name)) {
+                                    final_event = "event: error\ndata: " + *overflow + "\n\n";
+                                    finished = true;
+                                    break;
+                                }
+                                if (auto data = stream_event_data(result_json)) {
+                                    batch.emplace_back(event_id++, std::move(*data));
+                                    // The pump's generator is ahead, it took the checkpoint with the event
+                                    if (stream_checkpoint && stream_pump) {
+                                        checkpoint = stream_pump->checkpoint();
+                                    }
+                                } else {
+                                    MCP_ERROR("Invalid data format: {}", result_json);
+                                }
+                            }
+
+                            if (std::chrono::steady_clock::now() >= deadline) {
+                                break;
+                            }
+                        }
+
+                        // Calls after the last event of the batch have not moved the generator on
+                        if (stream_checkpoint && !stream_pump && !batch.empty()) {
+                            checkpoint = business::read_stream_checkpoint(stream_checkpoint, generator);
+                        }
+
+                        // Cache the events of the batch; the session state is written behind, and an
+                        // active stream does not expire
+                        if (!batch.empty()) {
+                            cache->CacheStreamEvents(current_session_id, batch);
+                            if (!checkpoint.empty()) {
+                                state_writer.checkpoint(batch.back().first, utils::base64_encode(checkpoint));
+                            }
+                            state_writer.sent(batch.back().first);
+                        }
+                        stream->touch();
+
+                        // Hand the batch to the send queue as one frame, the queue applies backpressure
+                        if (!batch.empty() || !final_event.empty()) {
+                            transport::SseSendQueue::Frame frame;
+                            frame.reserve(batch.size() * 2 + 1);
+                            for (auto& [id, data] : batch) {
+                                frame.push_back((frame.empty() ? "" : "\n\n") + std::string("event: message\nid: ") + std::to_string(id) + "\ndata: ");
+                                frame.push_back(std::move(data));
+                            }
+                            frame.push_back((frame.empty() ? "" : "\n\n") + final_event);
+
+                            if (!co_await send_queue->push(std::move(frame))) {
+                                MCP_INFO("Connection closed, stopping stream - session: {}", current_session_id);
+                                break;
+                            }
+                        }
+
+                        // The io thread serves other sessions until the generator has data again
+                        if (would_block && cancel && cancel->cancelled()) {
+                            continue;
+                        } else if (would_block && stream_pump) {
+                            co_await stream_pump->wait(kStreamRepollInterval);
+                        } else if (would_block) {
+                            co_await stream_waiter->wait(stream_wait, generator,
+                                                         stream_wait ? kStreamRepollInterval : kStreamWaitFallbackInterval);
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    MCP_ERROR("Stream consumer exception - session: {}: {}", current_session_id, e.what());
+                    std::string error_msg = "Stream error: " + std::string(e.what());
+                    failure_event = "event: error\n data: " +
+                        nlohmann::json{{"message", error_msg}}.dump() + "\n\n";
+                }
+
+                // From here on the cancel callback cannot touch the generator any more
+                if (cancel) {
+                    cancel->clear_callback();
+                }
+                // Before the client can reconnect, the state reaches the cache
+                state_writer.commit();
+                if (cancelled) {
+                    MCP_INFO("Stream cancelled by the client - session: {}", current_session_id);
+                    release_stream_session(current_session_id);
+                    failure_event = "event: error\n data: " +
+                        nlohmann::json{{"code", protocol::error_code::REQUEST_CANCELLED}, {"message", "Request cancelled"}}.dump() + "\n\n";
+                }
+
+                // Send what is still queued before the session is closed
+                if (!failure_event.empty()) {
+                    transport::SseSendQueue::Frame frame;
+                    frame.push_back(std::move(failure_event));
+                    co_await send_queue->push(std::move(frame));
+                }
+                co_await send_queue->drain();
+                if (stream_span) {
+                    if (!failure_event.empty()) {
+                        stream_span->set_error(cancelled ? "Request cancelled" : "Stream error");
+                    }
+                    stream_span->end();
+                }
+
+                // Cleanup only if session is expired (handled by StreamSessionRegistry)
+                // Do NOT remove generator from map here to allow reconnection
+                if (!session->is_closed()) {
+                    session->close();
+                }
+                co_return; }, asio::detached);
+
+            // Mark response as SSE stream
+            resp.id = nullptr;
+            resp.result = nlohmann::json::value_t::discarded;
+            co_return resp;
+        }
+        // Synchronous tool invocation handling, bounded by the tool's deadline if it has one
+        else {
+            auto progress = ProgressResponse::create(req, session, client_supports_sse);
+            auto reporter = progress ? progress->reporter : nullptr;
+            auto &stats = ctx.metrics.tool_call_stats(tool_name);
+            auto started = std::chrono::steady_clock::now();
+            const metrics::SpanContext *span = req.trace ? req.trace->plugin_context() : nullptr;
+            // A large body still arriving is read by the plugin of this call
+            auto upload = session ? session->take_upload() : nullptr;
+            auto timeout = business::ToolDeadlineOptions::current().for_tool(tool_name);
+            business::IdempotencyCache::Call execute = [&]() -> asio::awaitable<protocol::Response> {
+                if (timeout.count() > 0) {
+                    // The call may outlive this request, so it works on copies; it only needs the id of the request
+                    std::optional<metrics::SpanContext> span_copy = span ? std::optional(*span) : std::nullopt;
+                    co_return co_await business::run_with_deadline(
+                            tool_name, timeout,
+                            [call_req = protocol::Request(req.method, nlohmann::json{}, req.id), registry, tool_name, args = nlohmann::json(args), cancel, reporter, span_copy, upload]() -> asio::awaitable<protocol::Response> {
+                                co_return co_await run_sync_tool_call(call_req, registry, tool_name, args, cancel.get(), reporter.get(),
+                                                                      span_copy ? &*span_copy : nullptr, upload.get());
+                            },
+                            cancel, req.id.value_or(nullptr));
+                }
+                co_return co_await run_sync_tool_call(req, registry, tool_name, args, cancel.get(), reporter.get(), span, upload.get());
+            };
+            // A client retrying with the key of a call it gave up on gets that call's result
+            std::string idempotency_key = upload ? std::string() : business::IdempotencyCache::key_of(params, session ? &session->get_headers() : nullptr);
+            std::string caller;
+            if (!idempotency_key.empty()) {
+                caller = session ? transport::ClusterQuota::tenant_of(session->get_headers(), &session->auth_decision()) : std::string();
+                caller = caller.empty() ? session_id : caller;
+            }
+            if (!caller.empty()) {
+                resp = co_await business::IdempotencyCache::instance().call(caller, idempotency_key, tool_name, args, req.id.value_or(nullptr), execute);
+            } else {
+                resp = co_await execute();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - started;
+            stats.latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+            if (req.trace) {
+                req.trace->add(metrics::RequestStage::Plugin, started, started + elapsed);
+            }
+            if (resp.error) {
+                stats.errors.add();
+            }
+
+            // Once progress went out as SSE, the response is the last event of that stream; large
+            // results are sent in chunks as they are serialized
+            if ((progress && co_await ProgressResponse::finish(progress, resp)) || co_await stream_large_result(session, resp)) {
+                resp.id = nullptr;
+                resp.result = nlohmann::json::value_t::discarded;
+                resp.raw_result = nullptr;
+            }
+            co_return resp;
+        }
+    }
+
+}// namespace mcp::routers
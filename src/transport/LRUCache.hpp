@@ -1,30 +1,93 @@
 #pragma once
 
-#include <atomic>
+#include "core/housekeeping.h"
+#include "page_memory.h"
+#include <algorithm>
+#include <bit>
 #include <chrono>
-#include <condition_variable>
-#include <list>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <thread>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace Astra::datastructures {
 
+    // Heap memory owned by a cached key or value, counted against a MemoryBudget
+    template<typename T>
+    struct CacheEntryBytes {
+        static size_t Heap(const T &) { return 0; }
+    };
+
+    template<typename Char, typename Traits, typename Alloc>
+    struct CacheEntryBytes<std::basic_string<Char, Traits, Alloc>> {
+        static size_t Heap(const std::basic_string<Char, Traits, Alloc> &value) {
+            // Short strings live inside the object
+            static const size_t inline_capacity = std::basic_string<Char, Traits, Alloc>().capacity();
+            return value.capacity() > inline_capacity ? (value.capacity() + 1) * sizeof(Char) : 0;
+        }
+    };
 
+    // Limit a cache by the bytes it holds instead of by entry count
+    struct MemoryBudget {
+        size_t bytes;
+    };
+
+    // LRU cache on an open-addressing table: every entry lives in a table slot, keys are stored
+    // once and the LRU and expiry links are slot indices, so entries need no allocation of their own
     template<typename Key, typename Value>
     class LRUCache {
+        static constexpr uint32_t kNil = UINT32_MAX;
+        static constexpr size_t kMinSlots = 16;
+        static constexpr size_t kMaxPresized = 4096;// Larger caches grow their table as they fill
+
+        struct ExpiryList;
+
+        struct Slot {
+            Key key{};
+            Value value{};
+            size_t hash = 0;
+            std::chrono::steady_clock::time_point expires{};
+            ExpiryList *expiry = nullptr;// nullptr if the entry never expires
+            uint32_t lru_prev = kNil;    // Towards the most recently used entry
+            uint32_t lru_next = kNil;    // Towards the least recently used entry
+            uint32_t expiry_prev = kNil;
+            uint32_t expiry_next = kNil;
+            uint32_t hits = 0;
+            bool used = false;
+        };
+
+        // Entries sharing one TTL, in order of expiry because the clock only moves forward
+        struct ExpiryList {
+            std::chrono::seconds ttl;
+            uint32_t head = kNil;
+            uint32_t tail = kNil;
+        };
+
+        // Shared by every io thread, so spread over the NUMA nodes when pages are placed
+        using SlotTable = std::vector<Slot, mcp::transport::PageAllocator<Slot>>;
+
     public:
-        using iterator = typename std::list<std::pair<Key, Value>>::iterator;
-        using const_iterator = typename std::list<std::pair<Key, Value>>::const_iterator;
         using clock_type = std::chrono::steady_clock;
         using time_point = std::chrono::time_point<clock_type>;
 
         explicit LRUCache(size_t capacity, size_t hot_key_threshold = 100, std::chrono::seconds ttl = std::chrono::seconds::zero())
-            : capacity_(capacity), hot_key_threshold_(hot_key_threshold), ttl_(ttl),
-              cleanup_thread_(nullptr), cleanup_running_(false) {}
+            : capacity_(capacity), hot_key_threshold_(hot_key_threshold), ttl_(ttl) {
+            // Sized for the full capacity up front, so a full cache never rehashes
+            Rehash(SlotsFor(std::min(capacity, kMaxPresized)));
+        }
+
+        explicit LRUCache(MemoryBudget budget, size_t hot_key_threshold = 100, std::chrono::seconds ttl = std::chrono::seconds::zero())
+            : capacity_(std::numeric_limits<size_t>::max()), byte_budget_(budget.bytes),
+              hot_key_threshold_(hot_key_threshold), ttl_(ttl) {
+            Rehash(kMinSlots);
+        }
 
         ~LRUCache() {
             StopCleanupThread();
@@ -32,19 +95,19 @@ namespace Astra::datastructures {
 
         std::optional<Value> Get(const Key &key) {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            auto it = cache_.find(key);
-            if (it == cache_.end()) {
+            uint32_t index = Find(key, HashOf(key));
+            if (index == kNil) {
                 return std::nullopt;
             }
 
-            if (IsExpired(it)) {
-                Remove(key);
+            if (IsExpired(slots_[index])) {
+                Erase(index);
                 return std::nullopt;
             }
 
-            MoveToFront(it);
-            UpdateHotKey(it->second, key);
-            return std::make_optional(it->second->second);
+            MoveToFront(index);
+            ++slots_[index].hits;
+            return std::make_optional(slots_[index].value);
         }
 
         std::vector<std::optional<Value>> BatchGet(const std::vector<Key> &keys) {
@@ -53,21 +116,21 @@ namespace Astra::datastructures {
             values.reserve(keys.size());
 
             for (const auto &key: keys) {
-                auto it = cache_.find(key);
-                if (it == cache_.end()) {
+                uint32_t index = Find(key, HashOf(key));
+                if (index == kNil) {
                     values.emplace_back(std::nullopt);
                     continue;
                 }
 
-                if (IsExpired(it)) {
-                    Remove(key);
+                if (IsExpired(slots_[index])) {
+                    Erase(index);
                     values.emplace_back(std::nullopt);
                     continue;
                 }
 
-                MoveToFront(it);
-                UpdateHotKey(it->second, key);
-                values.emplace_back(it->second->second);
+                MoveToFront(index);
+                ++slots_[index].hits;
+                values.emplace_back(slots_[index].value);
             }
 
             return values;
@@ -76,28 +139,24 @@ namespace Astra::datastructures {
         void setCacheCapacity(size_t capacity) {
             std::lock_guard<std::mutex> lock(cache_mutex_);
             capacity_ = capacity;
+            EvictLRUBatch(size_ > capacity_ ? size_ - capacity_ : 0);
         }
 
-        void Put(const Key &key, const Value &value, std::chrono::seconds ttl = std::chrono::seconds::zero()) {
+        // Change the memory budget of a budgeted cache, evicting at once down to a smaller one
+        void setByteBudget(size_t bytes) {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            if (capacity_ == 0) {
-                Clear();
-                return;
+            if (byte_budget_ == 0 || bytes == 0) {
+                return;// The budget decides how the table grows, it cannot be switched on or off
             }
-
-            auto it = cache_.find(key);
-            if (it != cache_.end()) {
-                usage_.erase(it->second);
-                cache_.erase(it);
+            byte_budget_ = bytes;
+            while (size_ > 0 && slots_.size() * sizeof(Slot) + heap_bytes_ > byte_budget_) {
+                EvictLRU();
             }
+        }
 
-            EnsureCapacity(1);
-
-            usage_.emplace_front(key, value);
-            cache_[key] = usage_.begin();
-            UpdateHotKey(usage_.begin(), key);
-
-            SetExpiration(key, ttl);
+        void Put(const Key &key, const Value &value, std::chrono::seconds ttl = std::chrono::seconds::zero()) {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            PutLocked(key, value, ttl);
         }
 
         void BatchPut(const std::vector<Key> &keys, const std::vector<Value> &values,
@@ -107,57 +166,44 @@ namespace Astra::datastructures {
                 throw std::invalid_argument("keys and values must have the same size");
             }
 
-            if (capacity_ == 0) {
-                Clear();
-                return;
-            }
-
-            size_t required_capacity = keys.size();
-            size_t current_size = cache_.size();
-            size_t need_to_evict = 0;
-
-            if (current_size + required_capacity > capacity_) {
-                need_to_evict = current_size + required_capacity - capacity_;
-            }
-
-            EvictLRUBatch(need_to_evict);
-
             for (size_t i = 0; i < keys.size(); ++i) {
-                const auto &key = keys[i];
-                const auto &value = values[i];
-
-                auto it = cache_.find(key);
-                if (it != cache_.end()) {
-                    usage_.erase(it->second);
-                    cache_.erase(it);
-                }
-
-                usage_.emplace_front(key, value);
-                cache_[key] = usage_.begin();
-                UpdateHotKey(usage_.begin(), key);
-                SetExpiration(key, ttl);
+                PutLocked(keys[i], values[i], ttl);
             }
         }
 
         [[nodiscard]] bool Contains(const Key &key) const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            return cache_.find(key) != cache_.end();
+            return Find(key, HashOf(key)) != kNil;
         }
 
         [[nodiscard]] size_t Size() const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            return cache_.size();
+            return size_;
         }
 
         [[nodiscard]] size_t Capacity() const {
             return capacity_;
         }
 
+        // Bytes held: the slot table plus the heap memory of the cached keys and values
+        [[nodiscard]] size_t MemoryUsage() const {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            return slots_.size() * sizeof(Slot) + heap_bytes_;
+        }
+
+        // A key read at least hot_key_threshold times since it was stored
+        [[nodiscard]] bool IsHotKey(const Key &key) const {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            uint32_t index = Find(key, HashOf(key));
+            return index != kNil && slots_[index].hits >= hot_key_threshold_;
+        }
+
         std::vector<std::pair<Key, Value>> GetAllEntries() const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
             std::vector<std::pair<Key, Value>> result;
-            for (auto it = usage_.begin(); it != usage_.end(); ++it) {
-                result.emplace_back(it->first, it->second);
+            result.reserve(size_);
+            for (uint32_t i = lru_head_; i != kNil; i = slots_[i].lru_next) {
+                result.emplace_back(slots_[i].key, slots_[i].value);
             }
             return result;
         }
@@ -165,8 +211,9 @@ namespace Astra::datastructures {
         std::vector<Key> GetKeys() const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
             std::vector<Key> keys;
-            for (const auto &entry: usage_) {
-                keys.emplace_back(entry.first);
+            keys.reserve(size_);
+            for (uint32_t i = lru_head_; i != kNil; i = slots_[i].lru_next) {
+                keys.emplace_back(slots_[i].key);
             }
             return keys;
         }
@@ -174,47 +221,28 @@ namespace Astra::datastructures {
         std::vector<Value> GetValues() const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
             std::vector<Value> values;
-            for (const auto &entry: usage_) {
-                values.emplace_back(entry.second);
+            values.reserve(size_);
+            for (uint32_t i = lru_head_; i != kNil; i = slots_[i].lru_next) {
+                values.emplace_back(slots_[i].value);
             }
             return values;
         }
 
         void Clear() {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            usage_.clear();
-            cache_.clear();
-            access_count_.clear();
-            hot_key_cache_.hot_keys.clear();
-            expiration_times_.clear();
+            ClearLocked();
         }
 
         bool Remove(const Key &key) {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            auto it = cache_.find(key);
-            if (it == cache_.end()) {
-                return false;
-            }
-
-            usage_.erase(it->second);
-            cache_.erase(it);
-
-            auto hot_it = hot_key_cache_.hot_keys.find(key);
-            if (hot_it != hot_key_cache_.hot_keys.end()) {
-                hot_key_cache_.hot_keys.erase(hot_it);
-            }
-
-            access_count_.erase(key);
-            expiration_times_.erase(key);
-
-            return true;
+            return RemoveLocked(key);
         }
 
         size_t BatchRemove(const std::vector<Key> &keys) {
             std::lock_guard<std::mutex> lock(cache_mutex_);
             size_t removed_count = 0;
             for (const auto &key: keys) {
-                if (Remove(key)) {
+                if (RemoveLocked(key)) {
                     removed_count++;
                 }
             }
@@ -223,175 +251,334 @@ namespace Astra::datastructures {
 
         bool HasKey(const Key &key) const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            auto it = cache_.find(key);
-            if (it == cache_.end()) return false;
-            return !IsExpired(it);
+            uint32_t index = Find(key, HashOf(key));
+            if (index == kNil) return false;
+            return !IsExpired(slots_[index]);
         }
 
         std::optional<std::chrono::seconds> GetExpiryTime(const Key &key) const {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            auto exp_it = expiration_times_.find(key);
-            if (exp_it == expiration_times_.end()) return std::nullopt;
+            uint32_t index = Find(key, HashOf(key));
+            if (index == kNil || !slots_[index].expiry) return std::nullopt;
 
-            auto now = std::chrono::steady_clock::now();
-            auto remaining = std::chrono::duration_cast<std::chrono::seconds>(exp_it->second - now);
+            auto now = clock_type::now();
+            auto remaining = std::chrono::duration_cast<std::chrono::seconds>(slots_[index].expires - now);
             return (remaining > std::chrono::seconds::zero()) ? std::make_optional(remaining) : std::nullopt;
         }
 
-        // Start automatic cleanup thread with specified interval
+        // Have the server's housekeeping thread clean up expired items every interval
         void StartCleanupThread(std::chrono::seconds interval = std::chrono::seconds(60)) {
-            std::lock_guard<std::mutex> lock(cleanup_thread_mutex_);
-            if (cleanup_running_) {
+            std::lock_guard<std::mutex> lock(cleanup_mutex_);
+            if (cleanup_id_ != 0) {
                 return;// Already running
             }
-
-            cleanup_running_ = true;
-            cleanup_thread_ = std::make_unique<std::thread>([this, interval]() {
-                while (cleanup_running_) {
-                    std::unique_lock<std::mutex> lock(cleanup_mutex_);
-                    cleanup_condition_.wait_for(lock, interval, [this] { return !cleanup_running_; });
-
-                    if (cleanup_running_) {
-                        CleanUpExpiredItems();
-                    }
-                }
-            });
+            cleanup_id_ = mcp::core::Housekeeping::instance().every(interval, [this]() { CleanUpExpiredItems(); });
         }
 
-        // Stop automatic cleanup thread
+        // Stop the periodic cleanup; a cleanup in progress is finished first
         void StopCleanupThread() {
-            std::lock_guard<std::mutex> lock(cleanup_thread_mutex_);
-            if (cleanup_running_) {
-                cleanup_running_ = false;
-                cleanup_condition_.notify_all();
-
-                if (cleanup_thread_ && cleanup_thread_->joinable()) {
-                    cleanup_thread_->join();
-                }
-                cleanup_thread_.reset();
+            std::lock_guard<std::mutex> lock(cleanup_mutex_);
+            if (cleanup_id_ != 0) {
+                mcp::core::Housekeeping::instance().cancel(cleanup_id_);
+                cleanup_id_ = 0;
             }
         }
 
-        // Manual cleanup of expired items
+        // Manual cleanup of expired items, only visits the items that have expired
         void CleanUpExpiredItems() {
             std::lock_guard<std::mutex> lock(cache_mutex_);
-            for (auto it = expiration_times_.begin(); it != expiration_times_.end();) {
-                if (it->second <= clock_type::now()) {
-                    // Remove the expired item
-                    auto cache_it = cache_.find(it->first);
-                    if (cache_it != cache_.end()) {
-                        usage_.erase(cache_it->second);
-                        cache_.erase(cache_it);
+            auto now = clock_type::now();
+            for (auto list_it = expiry_lists_.begin(); list_it != expiry_lists_.end();) {
+                // Erasing the last entry of a list also erases the list
+                auto next = std::next(list_it);
+                while (list_it->second.head != kNil && slots_[list_it->second.head].expires <= now) {
+                    bool last = list_it->second.head == list_it->second.tail;
+                    Erase(list_it->second.head);
+                    if (last) {
+                        break;
                     }
-
-                    // Remove from other data structures
-                    access_count_.erase(it->first);
-                    hot_key_cache_.hot_keys.erase(it->first);
-
-                    // Erase from expiration map and move iterator
-                    it = expiration_times_.erase(it);
-                } else {
-                    ++it;
                 }
+                list_it = next;
             }
         }
 
     protected:
-        void MoveToFront(typename std::unordered_map<Key, iterator>::iterator it) {
-            if (usage_.begin() != it->second) {
-                usage_.splice(usage_.begin(), usage_, it->second);
-                cache_[it->first] = usage_.begin();
+        void MoveToFront(uint32_t index) {
+            if (lru_head_ != index) {
+                UnlinkLru(index);
+                LinkLruFront(index);
             }
         }
 
         void EvictLRU() {
-            if (usage_.empty()) return;
-
-            const auto &lru_entry = usage_.back();
-            cache_.erase(lru_entry.first);
-            expiration_times_.erase(lru_entry.first);
-            access_count_.erase(lru_entry.first);
-            hot_key_cache_.hot_keys.erase(lru_entry.first);
-            usage_.pop_back();
+            if (lru_tail_ == kNil) return;
+            Erase(lru_tail_);
         }
 
         void EvictLRUBatch(size_t count) {
-            if (count == 0 || usage_.empty()) return;
-            size_t evict_count = std::min(count, usage_.size());
-
+            size_t evict_count = std::min(count, size_);
             for (size_t i = 0; i < evict_count; ++i) {
-                const auto &lru_entry = usage_.back();
-                cache_.erase(lru_entry.first);
-                expiration_times_.erase(lru_entry.first);
-                access_count_.erase(lru_entry.first);
-                hot_key_cache_.hot_keys.erase(lru_entry.first);
-                usage_.pop_back();
+                EvictLRU();
             }
         }
 
         void EnsureCapacity(size_t required) {
-            if (cache_.size() + required <= capacity_) return;
+            if (size_ + required <= capacity_) return;
 
-            size_t need_to_evict = cache_.size() + required - capacity_;
+            size_t need_to_evict = size_ + required - capacity_;
             EvictLRUBatch(need_to_evict);
         }
 
-        void SetExpiration(const Key &key, std::chrono::seconds ttl) {
-            if (ttl.count() > 0) {
-                expiration_times_[key] = clock_type::now() + ttl;
-            } else if (ttl_ > std::chrono::seconds::zero()) {
-                expiration_times_[key] = clock_type::now() + ttl_;
-            } else {
-                expiration_times_.erase(key);
+    private:
+        static size_t SlotsFor(size_t entries) {
+            // Keep the load factor at or below 3/4
+            return std::bit_ceil(std::max(kMinSlots, entries + entries / 3 + 1));
+        }
+
+        // std::hash is the identity for integers, which would put consecutive keys into one long probe run
+        static size_t HashOf(const Key &key) {
+            uint64_t h = std::hash<Key>{}(key);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+
+        static size_t HeapBytes(const Key &key, const Value &value) {
+            return CacheEntryBytes<Key>::Heap(key) + CacheEntryBytes<Value>::Heap(value);
+        }
+
+        uint32_t Find(const Key &key, size_t hash) const {
+            for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+                const Slot &slot = slots_[i];
+                if (!slot.used) {
+                    return kNil;
+                }
+                if (slot.hash == hash && slot.key == key) {
+                    return static_cast<uint32_t>(i);
+                }
             }
         }
 
-        void UpdateHotKey(iterator it, const Key &key) {
-            access_count_[key]++;
-            if (access_count_[key] >= hot_key_threshold_) {
-                if (hot_key_cache_.hot_keys.find(key) == hot_key_cache_.hot_keys.end()) {
-                    hot_key_cache_.hot_keys[key] = it;
+        void PutLocked(const Key &key, const Value &value, std::chrono::seconds ttl) {
+            if (capacity_ == 0) {
+                ClearLocked();
+                return;
+            }
+
+            size_t hash = HashOf(key);
+            uint32_t index = Find(key, hash);
+            if (index != kNil) {
+                Erase(index);
+            }
+
+            EnsureCapacity(1);
+            size_t heap = HeapBytes(key, value);
+            if (byte_budget_ != 0) {
+                // Grow the table only while the budget allows it, otherwise make room by evicting
+                if (SlotsFor(size_ + 1) > slots_.size()) {
+                    size_t grown = SlotsFor(size_ + 1) * sizeof(Slot);
+                    if (grown + heap_bytes_ + heap <= byte_budget_) {
+                        Rehash(SlotsFor(size_ + 1));
+                    } else {
+                        while (size_ > 0 && SlotsFor(size_ + 1) > slots_.size()) {
+                            EvictLRU();
+                        }
+                    }
+                }
+                while (size_ > 0 && slots_.size() * sizeof(Slot) + heap_bytes_ + heap > byte_budget_) {
+                    EvictLRU();
                 }
-                access_count_.erase(key);
+            } else if (SlotsFor(size_ + 1) > slots_.size()) {
+                Rehash(SlotsFor(size_ + 1));
             }
+
+            Insert(key, value, hash, ttl);
+            heap_bytes_ += heap;
         }
 
-        iterator GetIterator(const Key &key) {
-            auto it = cache_.find(key);
-            if (it == cache_.end()) return usage_.end();
-            return it->second;
+        // Store a new entry as the most recently used one, the key must not be cached
+        void Insert(const Key &key, const Value &value, size_t hash, std::chrono::seconds ttl) {
+            size_t i = hash & mask_;
+            while (slots_[i].used) {
+                i = (i + 1) & mask_;
+            }
+            auto index = static_cast<uint32_t>(i);
+            Slot &slot = slots_[index];
+            slot.key = key;
+            slot.value = value;
+            slot.hash = hash;
+            slot.hits = 0;
+            slot.used = true;
+            ++size_;
+            LinkLruFront(index);
+
+            std::chrono::seconds effective = ttl.count() > 0 ? ttl : ttl_;
+            if (effective > std::chrono::seconds::zero()) {
+                slot.expires = clock_type::now() + effective;
+                auto &list = expiry_lists_[effective];
+                list.ttl = effective;
+                LinkExpiry(index, list);
+            }
         }
 
+        void Erase(uint32_t index) {
+            Slot &slot = slots_[index];
+            UnlinkLru(index);
+            UnlinkExpiry(index);
+            heap_bytes_ -= HeapBytes(slot.key, slot.value);
+            Reset(slot);
+            --size_;
+
+            // Backward-shift deletion: pull later entries of the probe run into the hole, no tombstones
+            size_t hole = index;
+            for (size_t i = (hole + 1) & mask_; slots_[i].used; i = (i + 1) & mask_) {
+                size_t home = slots_[i].hash & mask_;
+                bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+                if (!stays) {
+                    Relocate(static_cast<uint32_t>(i), static_cast<uint32_t>(hole));
+                    hole = i;
+                }
+            }
+        }
 
-    private:
-        bool IsExpired(const typename std::unordered_map<Key, iterator>::const_iterator &it) const {
-            auto exp_it = expiration_times_.find(it->first);
-            if (exp_it != expiration_times_.end()) {
-                return exp_it->second <= clock_type::now();
+        // Move an entry to a free slot and repoint its neighbours at it
+        void Relocate(uint32_t from, uint32_t to) {
+            slots_[to] = std::move(slots_[from]);
+            Reset(slots_[from]);
+
+            Slot &slot = slots_[to];
+            (slot.lru_prev != kNil ? slots_[slot.lru_prev].lru_next : lru_head_) = to;
+            (slot.lru_next != kNil ? slots_[slot.lru_next].lru_prev : lru_tail_) = to;
+            if (slot.expiry) {
+                (slot.expiry_prev != kNil ? slots_[slot.expiry_prev].expiry_next : slot.expiry->head) = to;
+                (slot.expiry_next != kNil ? slots_[slot.expiry_next].expiry_prev : slot.expiry->tail) = to;
             }
-            return false;
+        }
+
+        // Rebuild the table with slot_count slots, keeping the LRU and expiry order
+        void Rehash(size_t slot_count) {
+            SlotTable old = std::move(slots_);
+            slots_ = SlotTable(slot_count);
+            mask_ = slot_count - 1;
+
+            std::vector<uint32_t> moved(old.size(), kNil);
+            for (size_t from = 0; from < old.size(); ++from) {
+                if (!old[from].used) continue;
+                size_t i = old[from].hash & mask_;
+                while (slots_[i].used) {
+                    i = (i + 1) & mask_;
+                }
+                slots_[i] = std::move(old[from]);
+                moved[from] = static_cast<uint32_t>(i);
+            }
+
+            auto remap = [&moved](uint32_t &index) {
+                if (index != kNil) index = moved[index];
+            };
+            for (auto &slot: slots_) {
+                if (!slot.used) continue;
+                remap(slot.lru_prev);
+                remap(slot.lru_next);
+                remap(slot.expiry_prev);
+                remap(slot.expiry_next);
+            }
+            remap(lru_head_);
+            remap(lru_tail_);
+            for (auto &[ttl, list]: expiry_lists_) {
+                remap(list.head);
+                remap(list.tail);
+            }
+        }
+
+        bool RemoveLocked(const Key &key) {
+            uint32_t index = Find(key, HashOf(key));
+            if (index == kNil) {
+                return false;
+            }
+            Erase(index);
+            return true;
+        }
+
+        void ClearLocked() {
+            for (auto &slot: slots_) {
+                if (slot.used) Reset(slot);
+            }
+            size_ = 0;
+            heap_bytes_ = 0;
+            lru_head_ = lru_tail_ = kNil;
+            expiry_lists_.clear();
+        }
+
+        // Free what the slot's key and value hold and mark it empty
+        static void Reset(Slot &slot) {
+            slot = Slot{};
+        }
+
+        void LinkLruFront(uint32_t index) {
+            Slot &slot = slots_[index];
+            slot.lru_prev = kNil;
+            slot.lru_next = lru_head_;
+            (lru_head_ != kNil ? slots_[lru_head_].lru_prev : lru_tail_) = index;
+            lru_head_ = index;
+        }
+
+        void UnlinkLru(uint32_t index) {
+            Slot &slot = slots_[index];
+            (slot.lru_prev != kNil ? slots_[slot.lru_prev].lru_next : lru_head_) = slot.lru_next;
+            (slot.lru_next != kNil ? slots_[slot.lru_next].lru_prev : lru_tail_) = slot.lru_prev;
+            slot.lru_prev = slot.lru_next = kNil;
+        }
+
+        // Entries of one TTL are appended in expiry order
+        void LinkExpiry(uint32_t index, ExpiryList &list) {
+            Slot &slot = slots_[index];
+            slot.expiry = &list;
+            slot.expiry_prev = list.tail;
+            slot.expiry_next = kNil;
+            (list.tail != kNil ? slots_[list.tail].expiry_next : list.head) = index;
+            list.tail = index;
+        }
+
+        void UnlinkExpiry(uint32_t index) {
+            Slot &slot = slots_[index];
+            ExpiryList *list = slot.expiry;
+            if (!list) return;
+
+            (slot.expiry_prev != kNil ? slots_[slot.expiry_prev].expiry_next : list->head) = slot.expiry_next;
+            (slot.expiry_next != kNil ? slots_[slot.expiry_next].expiry_prev : list->tail) = slot.expiry_prev;
+            slot.expiry = nullptr;
+            slot.expiry_prev = slot.expiry_next = kNil;
+
+            if (list->head == kNil) {
+                expiry_lists_.erase(list->ttl);
+            }
+        }
+
+        bool IsExpired(const Slot &slot) const {
+            return slot.expiry && slot.expires <= clock_type::now();
         }
 
         size_t capacity_;
+        size_t byte_budget_ = 0;// 0 if only the entry count is limited
         size_t hot_key_threshold_;
         std::chrono::seconds ttl_;
-        std::unordered_map<Key, time_point> expiration_times_;
-        std::list<std::pair<Key, Value>> usage_;
-        std::unordered_map<Key, iterator> cache_;
-        mutable std::unordered_map<Key, size_t> access_count_;
-        struct HotKeyCache {
-            std::unordered_map<Key, iterator> hot_keys;
-        } hot_key_cache_;
+        SlotTable slots_;// Power-of-two open-addressing table with linear probing
+        size_t mask_ = 0;
+        size_t size_ = 0;
+        size_t heap_bytes_ = 0;// Heap memory of the cached keys and values
+        uint32_t lru_head_ = kNil;// Most recently used entry
+        uint32_t lru_tail_ = kNil;// Least recently used entry
+        std::map<std::chrono::seconds, ExpiryList> expiry_lists_;// One list per TTL in use
 
         // Thread safety
         mutable std::mutex cache_mutex_;
 
         // Automatic cleanup functionality
-        std::unique_ptr<std::thread> cleanup_thread_;
-        std::atomic<bool> cleanup_running_;
-        std::mutex cleanup_mutex_;
-        std::condition_variable cleanup_condition_;
-        std::mutex cleanup_thread_mutex_;// Mutex to protect thread start/stop operations
+        std::mutex cleanup_mutex_;// Protects cleanup start/stop operations
+        uint64_t cleanup_id_ = 0; // Registration with core::Housekeeping, 0 if not running
     };
 
-}// namespace Astra::datastructures
\ No newline at end of file
+}// namespace Astra::datastructures
@@ -0,0 +1,274 @@
+#include "admission_controller.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace mcp::transport {
+
+    namespace {
+        OverloadOptions &overload_storage() {
+            static OverloadOptions options;
+            return options;
+        }
+
+        PriorityOptions &priority_storage() {
+            static PriorityOptions options;
+            return options;
+        }
+    }// namespace
+
+    void OverloadOptions::configure(const OverloadOptions &options) {
+        overload_storage() = options;
+    }
+
+    const OverloadOptions &OverloadOptions::current() {
+        return overload_storage();
+    }
+
+    void PriorityOptions::configure(const PriorityOptions &options) {
+        priority_storage() = options;
+    }
+
+    const PriorityOptions &PriorityOptions::current() {
+        return priority_storage();
+    }
+
+    std::unordered_set<std::string> PriorityOptions::parse_names(std::string_view text) {
+        std::unordered_set<std::string> names;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+            if (!item.empty()) {
+                names.emplace(item);
+            }
+        }
+        return names;
+    }
+
+    bool PriorityOptions::is_control(std::string_view method, std::string_view tool_name) const {
+        if (!tool_name.empty() && control_tools.count(std::string(tool_name)) != 0) {
+            return true;
+        }
+        return !method.empty() && control_methods.count(std::string(method)) != 0;
+    }
+
+    std::unordered_map<std::string, size_t> AdmissionOptions::parse_tool_limits(std::string_view text) {
+        std::unordered_map<std::string, size_t> limits;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+            if (item.empty()) {
+                continue;
+            }
+
+            size_t equals = item.find('=');
+            size_t limit = 0;
+            std::string_view name = item.substr(0, equals);
+            std::string_view number = equals == std::string_view::npos ? std::string_view{} : item.substr(equals + 1);
+            while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+            while (!number.empty() && number.front() == ' ') number.remove_prefix(1);
+            auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), limit);
+            if (name.empty() || number.empty() || ec != std::errc() || ptr != number.data() + number.size() || limit == 0) {
+                MCP_WARN("Ignoring invalid tool limit entry '{}'", item);
+                continue;
+            }
+            limits[std::string(name)] = limit;
+        }
+        return limits;
+    }
+
+    asio::awaitable<bool> AdmissionController::Gate::enter(std::chrono::steady_clock::time_point deadline) {
+        auto executor = co_await asio::this_coro::executor;
+        std::shared_ptr<Waiter> waiter;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (in_flight_ < limit_ && waiters_.empty()) {
+                ++in_flight_;
+                ++admitted_;
+                co_return true;
+            }
+            if (waiters_.size() >= max_queue_) {
+                ++rejected_;
+                MCP_WARN("Admission queue of '{}' is full ({} waiting, {} running)", name_, waiters_.size(), in_flight_);
+                co_return false;
+            }
+            waiter = std::make_shared<Waiter>(executor);
+            waiter->timer.expires_at(deadline);
+            waiters_.push_back(waiter);
+        }
+
+        // Woken either by the deadline or by leave() cancelling the timer
+        asio::error_code ec;
+        co_await waiter->timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (waiter->granted) {
+            co_return true;
+        }
+        waiters_.erase(std::find(waiters_.begin(), waiters_.end(), waiter));
+        ++timed_out_;
+        MCP_WARN("Timed out waiting for admission to '{}' ({} waiting, {} running)", name_, waiters_.size(), in_flight_);
+        co_return false;
+    }
+
+    void AdmissionController::Gate::leave() {
+        std::shared_ptr<Waiter> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (waiters_.empty() || in_flight_ > limit_) {
+                --in_flight_;// Nobody waiting, or the limit was lowered below what runs
+                return;
+            }
+            // The slot passes straight to the oldest waiter, in_flight_ stays the same
+            next = std::move(waiters_.front());
+            waiters_.pop_front();
+            next->granted = true;
+            ++admitted_;
+        }
+        // Timers are not thread safe; cancel on the waiter's own executor
+        asio::post(next->timer.get_executor(), [next]() { next->timer.cancel(); });
+    }
+
+    void AdmissionController::Gate::resize(size_t limit, size_t max_queue) {
+        std::vector<std::shared_ptr<Waiter>> granted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            limit_ = limit;
+            max_queue_ = max_queue;
+            while (in_flight_ < limit_ && !waiters_.empty()) {
+                granted.push_back(std::move(waiters_.front()));
+                waiters_.pop_front();
+                granted.back()->granted = true;
+                ++in_flight_;
+                ++admitted_;
+            }
+        }
+        for (auto &next: granted) {
+            asio::post(next->timer.get_executor(), [next]() { next->timer.cancel(); });
+        }
+    }
+
+    AdmissionStats AdmissionController::Gate::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return AdmissionStats{name_, limit_, in_flight_, waiters_.size(), admitted_, rejected_, timed_out_};
+    }
+
+    AdmissionController::Permit::Permit(Permit &&other) noexcept
+        : admitted_(std::exchange(other.admitted_, false)),
+          tool_(std::move(other.tool_)),
+          global_(std::move(other.global_)) {}
+
+    AdmissionController::Permit &AdmissionController::Permit::operator=(Permit &&other) noexcept {
+        if (this != &other) {
+            release();
+            admitted_ = std::exchange(other.admitted_, false);
+            tool_ = std::move(other.tool_);
+            global_ = std::move(other.global_);
+        }
+        return *this;
+    }
+
+    void AdmissionController::Permit::release() noexcept {
+        if (global_) {
+            global_->leave();
+        }
+        if (tool_) {
+            tool_->leave();
+        }
+        admitted_ = false;
+        global_.reset();
+        tool_.reset();
+    }
+
+    AdmissionController &AdmissionController::getInstance() {
+        static AdmissionController instance;
+        return instance;
+    }
+
+    void AdmissionController::configure(const AdmissionOptions &options) {
+        std::lock_guard<std::mutex> lock(configure_mutex_);
+        const GateSet &old_gates = gates_.get();
+
+        // Reuse the gate of a limit that stays, so its running and waiting calls carry over
+        auto gate_for = [](const std::shared_ptr<Gate> &old_gate, const std::string &name, size_t limit, size_t max_queue) {
+            if (!old_gate) {
+                return std::make_shared<Gate>(name, limit, max_queue);
+            }
+            old_gate->resize(limit, max_queue);
+            return old_gate;
+        };
+
+        GateSet gates;
+        gates.queue_timeout = options.queue_timeout;
+        if (options.max_in_flight != 0) {
+            gates.global = gate_for(old_gates.global, "*", options.max_in_flight, options.max_queue);
+        }
+        for (const auto &[name, limit]: options.tool_limits) {
+            auto it = old_gates.tools.find(name);
+            gates.tools.emplace(name, gate_for(it != old_gates.tools.end() ? it->second : nullptr, name, limit, options.max_queue));
+        }
+        size_t tool_count = gates.tools.size();
+        gates_.publish(std::move(gates));
+
+        if (enabled()) {
+            MCP_INFO("Tool admission control: {} global, {} tool limits, queue {} for up to {} ms",
+                     options.max_in_flight, tool_count, options.max_queue, options.queue_timeout.count());
+        }
+    }
+
+    asio::awaitable<AdmissionController::Permit> AdmissionController::acquire(const std::string &tool_name) {
+        Permit permit;
+        permit.admitted_ = true;
+        std::shared_ptr<Gate> tool_gate;
+        std::shared_ptr<Gate> global_gate;
+        std::chrono::steady_clock::time_point deadline;
+        {
+            // The GateSet may be freed once this coroutine suspends, so keep only copies
+            const GateSet &gates = gates_.get();
+            auto it = gates.tools.find(tool_name);
+            if (it != gates.tools.end()) {
+                tool_gate = it->second;
+            }
+            global_gate = gates.global;
+            deadline = std::chrono::steady_clock::now() + gates.queue_timeout;
+        }
+
+        // Per-tool slot first, so calls waiting for a busy tool do not hold global slots
+        if (tool_gate) {
+            if (!co_await tool_gate->enter(deadline)) {
+                co_return Permit{};
+            }
+            permit.tool_ = std::move(tool_gate);
+        }
+        if (global_gate) {
+            if (!co_await global_gate->enter(deadline)) {
+                co_return Permit{};// Releases the tool slot
+            }
+            permit.global_ = std::move(global_gate);
+        }
+        co_return permit;
+    }
+
+    std::vector<AdmissionStats> AdmissionController::stats() const {
+        const GateSet &gates = gates_.get();
+        std::vector<AdmissionStats> result;
+        result.reserve(gates.tools.size() + 1);
+        if (gates.global) {
+            result.push_back(gates.global->stats());
+        }
+        for (const auto &[name, gate]: gates.tools) {
+            result.push_back(gate->stats());
+        }
+        return result;
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,256 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "core/snapshot.hpp"
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Concurrency limits for tool calls, normally taken from the [concurrency] config section.
+     */
+    struct AdmissionOptions {
+        size_t max_in_flight = 0;                          ///< Tool calls running at once across all tools, 0 = unlimited
+        std::unordered_map<std::string, size_t> tool_limits;///< Per-tool in-flight limits
+        size_t max_queue = 64;                             ///< Calls waiting per limit before new ones are rejected
+        std::chrono::milliseconds queue_timeout{5000};     ///< Longest time a call waits for a slot
+
+        bool operator==(const AdmissionOptions &) const = default;
+
+        /**
+         * @brief Parse a tool limit list such as "safe_system_plugin=2,search=8".
+         * @param text Limit list, empty for none
+         * @return Tool name mapped to its in-flight limit
+         */
+        static std::unordered_map<std::string, size_t> parse_tool_limits(std::string_view text);
+    };
+
+    /**
+     * @brief Load shedding on io_context lag, normally taken from the [concurrency] config section.
+     *
+     * Each io_context's scheduling lag is probed by its pool (see IOServicePoolOptions); while the
+     * smoothed lag of the io_context a session runs on is above the threshold, new JSON-RPC
+     * requests of that session are answered 503 with Retry-After instead of being handled, so a
+     * thread that fell behind catches up on the work it already has.
+     */
+    struct OverloadOptions {
+        std::chrono::microseconds lag_threshold{0};///< Smoothed lag above which requests are shed, 0 = never shed
+        std::chrono::seconds retry_after{1};       ///< Retry-After of the 503
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const OverloadOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const OverloadOptions &current();
+    };
+
+    /**
+     * @brief Control-plane requests, normally taken from the [concurrency] config section.
+     *
+     * Handshakes, health checks and listings are cheap but must be answered while tool calls
+     * pile up, or an orchestrator takes a healthy server for a dead one. Requests of the listed
+     * methods, and calls of the listed tools, are never shed on lag and never wait in an
+     * admission queue; control-plane tool calls run on the threads the ToolThreadPool reserves
+     * for them, so they are not queued behind other tool calls either.
+     */
+    struct PriorityOptions {
+        std::unordered_set<std::string> control_methods;///< JSON-RPC methods of the control plane
+        std::unordered_set<std::string> control_tools;  ///< Tools whose calls are control plane as well
+
+        /**
+         * @brief Parse a comma-separated name list such as "initialize,ping".
+         * @param text Name list, empty for none
+         * @return Names, trimmed
+         */
+        static std::unordered_set<std::string> parse_names(std::string_view text);
+
+        /**
+         * @brief Whether a request belongs to the control plane.
+         * @param method JSON-RPC method
+         * @param tool_name Tool of a tools/call, empty otherwise
+         */
+        bool is_control(std::string_view method, std::string_view tool_name = {}) const;
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const PriorityOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const PriorityOptions &current();
+    };
+
+    /**
+     * @brief Counters of one concurrency limit, for metrics.
+     */
+    struct AdmissionStats {
+        std::string name;      ///< Tool name, or "*" for the global limit
+        size_t limit = 0;      ///< Configured in-flight limit
+        size_t in_flight = 0;  ///< Calls currently holding a slot
+        size_t queued = 0;     ///< Calls currently waiting for a slot
+        uint64_t admitted = 0; ///< Calls that got a slot
+        uint64_t rejected = 0; ///< Calls turned away because the queue was full
+        uint64_t timed_out = 0;///< Calls that gave up waiting
+    };
+
+    /**
+     * @brief Admission control for tool calls: a global and per-tool in-flight limit, each
+     * with a bounded wait queue.
+     *
+     * A call that finds its limit exhausted waits asynchronously (its session coroutine is
+     * suspended, the io thread keeps running) until a slot is handed over or the queue
+     * timeout passes, so bursts are absorbed instead of failed. Slots are handed to waiters
+     * in FIFO order. acquire() may be called from any io thread, and configure() again while
+     * calls run: a limit that keeps its name keeps its gate and only changes size, so calls
+     * already holding or waiting for a slot are not disturbed.
+     */
+    class AdmissionController {
+    public:
+        class Gate;
+
+        /**
+         * @brief Slots held by an admitted call, released on destruction.
+         */
+        class Permit {
+        public:
+            Permit() = default;
+            Permit(Permit &&other) noexcept;
+            Permit &operator=(Permit &&other) noexcept;
+            ~Permit() { release(); }
+
+            /**
+             * @brief Whether the call was admitted.
+             */
+            explicit operator bool() const noexcept { return admitted_; }
+
+            /**
+             * @brief Give the slots back early.
+             */
+            void release() noexcept;
+
+        private:
+            friend class AdmissionController;
+
+            bool admitted_ = false;
+            std::shared_ptr<Gate> tool_;  ///< Per-tool slot, if the tool is limited
+            std::shared_ptr<Gate> global_;///< Global slot, if a global limit is set
+        };
+
+        static AdmissionController &getInstance();
+
+        /**
+         * @brief Set the limits, at startup or on a config reload.
+         * @param options Admission options
+         */
+        void configure(const AdmissionOptions &options);
+
+        /**
+         * @brief Whether any limit is configured.
+         * @return true if acquire() can ever wait or reject
+         */
+        bool enabled() const noexcept {
+            const GateSet &gates = gates_.get();
+            return gates.global != nullptr || !gates.tools.empty();
+        }
+
+        /**
+         * @brief Wait for the slots a call of the given tool needs.
+         * Must be awaited on the io_context that runs the calling session.
+         * @param tool_name Tool being called
+         * @return Permit; false if the queue was full or the timeout passed
+         */
+        asio::awaitable<Permit> acquire(const std::string &tool_name);
+
+        /**
+         * @brief Snapshot of every configured limit.
+         * @return Global limit first (if any), then the per-tool limits
+         */
+        std::vector<AdmissionStats> stats() const;
+
+    private:
+        AdmissionController() = default;
+
+        /**
+         * @brief The gates of one configuration. A version is freed soon after it is replaced,
+         * so acquire() copies the gates it waits on and a Permit owns them.
+         */
+        struct GateSet {
+            std::chrono::milliseconds queue_timeout{5000};
+            std::shared_ptr<Gate> global;
+            std::unordered_map<std::string, std::shared_ptr<Gate>> tools;
+        };
+
+        std::mutex configure_mutex_;///< Serializes configure() calls
+        core::Snapshot<GateSet> gates_;
+    };
+
+    /**
+     * @brief One in-flight limit with its FIFO wait queue.
+     */
+    class AdmissionController::Gate {
+    public:
+        Gate(std::string name, size_t limit, size_t max_queue)
+            : name_(std::move(name)), limit_(limit), max_queue_(max_queue) {}
+
+        /**
+         * @brief Take a slot, waiting until the deadline if none is free.
+         * @param deadline Latest time to get a slot
+         * @return true once a slot is held
+         */
+        asio::awaitable<bool> enter(std::chrono::steady_clock::time_point deadline);
+
+        /**
+         * @brief Give a slot back, handing it to the oldest waiter if there is one.
+         */
+        void leave();
+
+        /**
+         * @brief Change the limit and queue size; waiters get the slots a larger limit frees.
+         * Running calls above a smaller limit finish normally, their slots are not handed on.
+         */
+        void resize(size_t limit, size_t max_queue);
+
+        AdmissionStats stats() const;
+
+    private:
+        struct Waiter {
+            explicit Waiter(const asio::any_io_executor &executor) : timer(executor) {}
+            asio::steady_timer timer;///< Expires at the deadline, cancelled when a slot is handed over
+            bool granted = false;    ///< Set under the gate mutex when a slot is handed over
+        };
+
+        mutable std::mutex mutex_;
+        const std::string name_;
+        size_t limit_;
+        size_t max_queue_;
+        size_t in_flight_ = 0;
+        std::deque<std::shared_ptr<Waiter>> waiters_;
+        uint64_t admitted_ = 0;
+        uint64_t rejected_ = 0;
+        uint64_t timed_out_ = 0;
+    };
+
+}// namespace mcp::transport
@@ -1,17 +1,115 @@
 #include "base_transport.h"
+#include "core/io_context_pool.hpp"
 #include "core/logger.h"
+#include "hot_restart.h"
+#include "socket_options.h"
 
 namespace mcp::transport {
 
+    namespace {
+#if defined(SO_REUSEPORT)
+        using reuse_port_option = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+        // Open, configure and bind an acceptor; SO_REUSEPORT must be set before bind()
+        void listen_on(asio::ip::tcp::acceptor &acceptor, const asio::ip::tcp::endpoint &endpoint, [[maybe_unused]] bool reuse_port) {
+            acceptor.open(endpoint.protocol());
+            acceptor.set_option(asio::socket_base::reuse_address(true));
+#if defined(SO_REUSEPORT)
+            if (reuse_port) {
+                acceptor.set_option(reuse_port_option(true));
+            }
+#endif
+            const auto &options = SocketOptions::current();
+            options.apply_listener(acceptor);
+            acceptor.bind(endpoint);
+            acceptor.listen(options.backlog());
+        }
+
+        // Adopt the listener a predecessor handed over on hot restart, or open a new one
+        bool adopt_or_listen(asio::ip::tcp::acceptor &acceptor, const asio::ip::tcp::endpoint &endpoint, bool reuse_port) {
+            if (auto fd = HotRestart::instance().inherit(HotRestart::tcp_key(endpoint))) {
+                acceptor.assign(endpoint.protocol(), *fd);
+                return true;
+            }
+            listen_on(acceptor, endpoint, reuse_port);
+            return false;
+        }
+    }// namespace
+
     /**
      * @brief Construct base transport with specified address and port.
      * @param address IP address to bind to
      * @param port Port number to listen on
+     * @param reuse_port Enable SO_REUSEPORT multi-acceptor mode
      */
-    BaseTransport::BaseTransport(const std::string &address, unsigned short port)
+    BaseTransport::BaseTransport(const std::string &address, unsigned short port, bool reuse_port)
         : io_context_(),
-          acceptor_(io_context_, asio::ip::tcp::endpoint(asio::ip::make_address(address), port)),
+          acceptor_(io_context_),
+          reuse_port_(reuse_port),
           work_guard_(asio::make_work_guard(io_context_)) {
+#if !defined(SO_REUSEPORT)
+        if (reuse_port_) {
+            MCP_WARN("SO_REUSEPORT is not supported on this platform, using a single acceptor");
+            reuse_port_ = false;
+        }
+#endif
+        inherited_ = adopt_or_listen(acceptor_, asio::ip::tcp::endpoint(asio::ip::make_address(address), port), reuse_port_);
+        endpoint_ = acceptor_.local_endpoint();// Resolves port 0 to the bound port
+        HotRestart::instance().share(HotRestart::tcp_key(endpoint_), acceptor_.native_handle());
+        MCP_INFO("{} on {}:{} with {}", inherited_ ? "Took over listener" : "Listening",
+                 endpoint_.address().to_string(), endpoint_.port(), SocketOptions::current().describe(acceptor_));
+    }
+
+    void BaseTransport::open_pool_acceptors(AsioIOServicePool &pool) {
+        pool_acceptors_.clear();
+        pool_acceptors_.reserve(pool.Size());
+        auto &hot_restart = HotRestart::instance();
+        const auto key = HotRestart::tcp_key(endpoint_);
+        hot_restart.unshare(acceptor_.native_handle());
+        for (std::size_t i = 0; i < pool.Size(); ++i) {
+            auto &context = pool.GetIOService(i);
+            auto acceptor = std::make_unique<asio::ip::tcp::acceptor>(context);
+            if (i == 0 && inherited_) {
+                // Closing a socket taken over would reset the connections queued on it
+                acceptor->assign(endpoint_.protocol(), acceptor_.release());
+            } else {
+                adopt_or_listen(*acceptor, endpoint_, true);
+            }
+            hot_restart.share(key, acceptor->native_handle());
+            pool_acceptors_.push_back({&context, std::move(acceptor)});
+        }
+
+        // A predecessor with more IO threads left more sockets in the group, they are served too
+        while (auto fd = hot_restart.inherit(key)) {
+            auto &context = pool.GetIOService(pool_acceptors_.size() % pool.Size());
+            auto acceptor = std::make_unique<asio::ip::tcp::acceptor>(context);
+            acceptor->assign(endpoint_.protocol(), *fd);
+            hot_restart.share(key, acceptor->native_handle());
+            pool_acceptors_.push_back({&context, std::move(acceptor)});
+        }
+
+        // Only the pool acceptors accept from now on; a listening but idle socket in the
+        // SO_REUSEPORT group would still be handed its share of the connections
+        asio::error_code ec;
+        acceptor_.close(ec);
+        MCP_INFO("Opened {} SO_REUSEPORT acceptors on {}:{}", pool_acceptors_.size(),
+                 endpoint_.address().to_string(), endpoint_.port());
+    }
+
+    void BaseTransport::close_acceptors() {
+        auto &hot_restart = HotRestart::instance();
+        asio::error_code ec;
+        if (acceptor_.is_open()) {
+            hot_restart.unshare(acceptor_.native_handle());
+            acceptor_.close(ec);
+        }
+        for (auto &pool_acceptor: pool_acceptors_) {
+            if (pool_acceptor.acceptor->is_open()) {
+                hot_restart.unshare(pool_acceptor.acceptor->native_handle());
+            }
+            pool_acceptor.acceptor->close(ec);
+        }
     }
 
-}// namespace mcp::transport
\ No newline at end of file
+}// namespace mcp::transport
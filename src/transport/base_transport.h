@@ -5,10 +5,14 @@
 #endif
 
 #include "http_handler.h"
+#include "metrics/metrics_manager.h"
 #include "transport_types.h"
 #include <array>
 #include <asio.hpp>
 #include <memory>
+#include <vector>
+
+class AsioIOServicePool;
 
 namespace mcp::transport {
 
@@ -35,6 +39,11 @@ namespace mcp::transport {
          */
         virtual void stop() = 0;
 
+        /**
+         * @brief Close the listeners; connections already accepted go on being served.
+         */
+        virtual void stop_accepting() = 0;
+
         std::array<char, 8192> &get_buffer() { return buffer_; }
 
         /**
@@ -44,10 +53,42 @@ namespace mcp::transport {
         asio::io_context &get_io_context() { return io_context_; }
 
     protected:
-        BaseTransport(const std::string &address, unsigned short port);
+        /**
+         * @brief Bind and listen on the given endpoint.
+         * @param address IP address to bind to
+         * @param port Port number to listen on
+         * @param reuse_port Open the listener with SO_REUSEPORT so that every io_context of
+         *                   the session pool can later run its own acceptor on the same port
+         */
+        BaseTransport(const std::string &address, unsigned short port, bool reuse_port = false);
+
+        /**
+         * @brief One acceptor per io_context of a pool, for SO_REUSEPORT mode.
+         */
+        struct PoolAcceptor {
+            asio::io_context *context;                   ///< Context the acceptor and its sessions run on
+            std::unique_ptr<asio::ip::tcp::acceptor> acceptor;///< Acceptor bound to the transport endpoint
+        };
+
+        /**
+         * @brief Open one SO_REUSEPORT acceptor per io_context of the pool and close the
+         * initial acceptor, so the kernel spreads new connections across the pool threads.
+         * @param pool Pool whose io_contexts receive an acceptor each
+         */
+        void open_pool_acceptors(AsioIOServicePool &pool);
+
+        /**
+         * @brief Close the initial acceptor and all pool acceptors.
+         */
+        void close_acceptors();
 
         asio::io_context io_context_;                                                                              ///< IO context for async operations
         asio::ip::tcp::acceptor acceptor_;                                                                         ///< TCP acceptor for incoming connections
+        asio::ip::tcp::endpoint endpoint_;                                                                         ///< Endpoint the transport listens on
+        bool reuse_port_ = false;                                                                                  ///< SO_REUSEPORT multi-acceptor mode
+        bool inherited_ = false;                                                                                   ///< acceptor_ was handed over by the previous process
+        std::vector<PoolAcceptor> pool_acceptors_;                                                                 ///< Per-context acceptors in SO_REUSEPORT mode
+        std::shared_ptr<metrics::AcceptCounters> accept_counters_;                                                 ///< Accepted connections per accept loop
         std::unique_ptr<HttpHandler> handler_;                                                                     ///< HTTP request handler
         asio::executor_work_guard<asio::io_context::executor_type> work_guard_{asio::make_work_guard(io_context_)};///< Keep IO context running
         std::array<char, 8192> buffer_;                                                                            ///< Shared buffer
@@ -0,0 +1,75 @@
+#pragma once
+#include "mcp_cache.h"
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace mcp::cache {
+
+    /**
+     * @brief Callbacks receiving the records of a CacheBackend in the order they were written.
+     */
+    struct CacheReplay {
+        std::function<void(const SessionState &)> state;                      ///< A saved session state
+        std::function<void(const std::string &, int, std::string_view)> event;///< Session, event ID, compact JSON data
+        std::function<void(const std::string &)> remove;                      ///< A session that was dropped
+    };
+
+    /**
+     * @brief Durable store behind McpCache, so reconnects can be resumed after a restart or on another node.
+     *
+     * McpCache calls the write functions with a shard lock held, so they must only queue the
+     * record; persisting it happens in the background. Records of one session arrive in order.
+     */
+    class CacheBackend {
+    public:
+        virtual ~CacheBackend() = default;
+
+        /**
+         * @brief Record the latest state of a session.
+         * @param state Session state
+         */
+        virtual void SaveState(const SessionState &state) = 0;
+
+        /**
+         * @brief Record a cached stream event.
+         * @param session_id Session identifier
+         * @param event_id Event identifier
+         * @param data Compact JSON data of the event
+         */
+        virtual void AppendEvent(const std::string &session_id, int event_id, std::string_view data) = 0;
+
+        /**
+         * @brief Record that a session and its events were dropped.
+         * @param session_id Session identifier
+         */
+        virtual void RemoveSession(const std::string &session_id) = 0;
+
+        /**
+         * @brief Replay everything stored, oldest first. Called once by McpCache::Init.
+         * @param replay Record callbacks
+         */
+        virtual void Load(const CacheReplay &replay) = 0;
+
+        /**
+         * @brief Whether stale records take enough space that McpCache should rewrite its live data.
+         */
+        virtual bool NeedsCompaction() const { return false; }
+
+        /**
+         * @brief Start a rewrite: the records written until EndSnapshot() replace everything before.
+         */
+        virtual void BeginSnapshot() {}
+
+        /**
+         * @brief Finish a rewrite started by BeginSnapshot(); older records may be discarded.
+         */
+        virtual void EndSnapshot() {}
+
+        /**
+         * @brief Wait until every record queued so far has been persisted.
+         */
+        virtual void Flush() = 0;
+    };
+
+}// namespace mcp::cache
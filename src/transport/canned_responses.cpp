@@ -0,0 +1,127 @@
+#include "canned_responses.h"
+#include "core/logger.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace mcp::transport {
+
+    std::string_view http_status_text(int status_code) {
+        switch (status_code) {
+            case 200:
+                return "OK";
+            case 201:
+                return "Created";
+            case 202:
+                return "Accepted";
+            case 204:
+                return "No Content";
+            case 400:
+                return "Bad Request";
+            case 401:
+                return "Unauthorized";
+            case 403:
+                return "Forbidden";
+            case 404:
+                return "Not Found";
+            case 405:
+                return "Method Not Allowed";
+            case 413:
+                return "Payload Too Large";
+            case 415:
+                return "Unsupported Media Type";
+            case 429:
+                return "Too Many Requests";
+            case 500:
+                return "Internal Server Error";
+            case 501:
+                return "Not Implemented";
+            case 503:
+                return "Service Unavailable";
+            default:
+                return "Unknown";
+        }
+    }
+
+    CannedResponses &CannedResponses::getInstance() {
+        static CannedResponses instance;
+        return instance;
+    }
+
+    CannedResponses::CannedResponses() {
+        register_response(kAccepted, 202, "");
+        register_response(kBadRequest, 400, R"({"error":"Invalid HTTP request"})");
+        register_response(kUnauthorized, 401, R"({"error":"Unauthorized"})");
+        register_response(kNotFound, 404, R"({"error":"Not Found"})");
+        register_response(kMethodNotAllowed, 405, R"({"error":"Method Not Allowed"})");
+        register_response(kTooLarge, 413, R"({"error":"Request too large"})");
+        register_response(kUnsupportedEncoding, 415, R"({"error":"Unsupported Content-Encoding"})");
+        register_response(kRateLimited, 429, R"({"error":"Rate limit exceeded"})");
+        register_response(kNotAllowed, 429, R"({"error":"Request not allowed"})");
+        register_response(kInternalError, 500, R"({"error":"Internal Server Error"})");
+        register_response(kOverloaded, 503, R"({"error":"Server busy, try again later"})");
+    }
+
+    CannedResponse CannedResponses::render(int status_code, std::string body, std::string_view content_type, std::string_view extra_headers) {
+        // Responses without a body (202/204) never carry one on the wire
+        bool has_body = status_code != 202 && status_code != 204;
+
+        std::string head;
+        head += "HTTP/1.1 ";
+        head += std::to_string(status_code);
+        head += ' ';
+        head += http_status_text(status_code);
+        head += "\r\nContent-Type: ";
+        head += content_type;
+        head += "\r\nServer: MCPServer++\r\n";
+        head += extra_headers;
+        head += "Content-Length: ";
+        head += std::to_string(has_body ? body.size() : 0);
+        head += "\r\n";
+
+        CannedResponse response;
+        response.status_code = status_code;
+        response.keep_alive = head + "Connection: keep-alive\r\nKeep-Alive: timeout=300, max=100\r\n\r\n";
+        response.close = head + "Connection: close\r\n\r\n";
+        if (has_body) {
+            response.keep_alive += body;
+            response.close += body;
+        }
+        response.body = std::move(body);
+        return response;
+    }
+
+    const CannedResponse &CannedResponses::register_response(std::string_view name,
+                                                             int status_code,
+                                                             std::string body,
+                                                             std::string_view content_type,
+                                                             std::string_view extra_headers) {
+        std::unique_lock lock(mutex_);
+        auto it = responses_.find(std::string(name));
+        if (it != responses_.end()) {
+            if (it->second->status_code != status_code || it->second->body != body) {
+                MCP_WARN("Canned response '{}' is already registered, keeping the existing one", name);
+            }
+            return *it->second;
+        }
+
+        auto response = std::make_unique<CannedResponse>(render(status_code, std::move(body), content_type, extra_headers));
+        const CannedResponse &ref = *response;
+        responses_.emplace(std::string(name), std::move(response));
+        return ref;
+    }
+
+    const CannedResponse *CannedResponses::find(std::string_view name) const {
+        std::shared_lock lock(mutex_);
+        auto it = responses_.find(std::string(name));
+        return it != responses_.end() ? it->second.get() : nullptr;
+    }
+
+    const CannedResponse &CannedResponses::get(std::string_view name) const {
+        const CannedResponse *response = find(name);
+        if (!response) {
+            throw std::out_of_range("Canned response not registered: " + std::string(name));
+        }
+        return *response;
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Get the reason phrase for an HTTP status code.
+     * @param status_code HTTP status code
+     * @return Reason phrase, "Unknown" for unmapped codes
+     */
+    std::string_view http_status_text(int status_code);
+
+    /**
+     * @brief A fully pre-serialized HTTP response.
+     * Status line, headers and body are rendered once; the only per-request choice is
+     * the Connection header, so both variants are kept ready to write.
+     */
+    struct CannedResponse {
+        int status_code = 200; ///< HTTP status code
+        std::string body;      ///< Response body
+        std::string keep_alive;///< Complete response with keep-alive connection headers
+        std::string close;     ///< Complete response with "Connection: close"
+
+        /**
+         * @brief Get the wire representation for the requested connection mode.
+         * @param keep_alive_connection Whether the connection stays open
+         * @return Complete HTTP response
+         */
+        const std::string &render(bool keep_alive_connection) const {
+            return keep_alive_connection ? keep_alive : close;
+        }
+    };
+
+    /**
+     * @brief Table of pre-serialized responses for common replies.
+     *
+     * Built-in entries cover the transport's own error and acknowledgement replies. Routers
+     * may register additional responses by name; once registered an entry is immutable and
+     * references to it stay valid for the lifetime of the process.
+     */
+    class CannedResponses {
+    public:
+        static constexpr std::string_view kAccepted = "accepted";                ///< 202, empty body
+        static constexpr std::string_view kBadRequest = "bad_request";           ///< 400 invalid HTTP request
+        static constexpr std::string_view kUnauthorized = "unauthorized";        ///< 401
+        static constexpr std::string_view kNotFound = "not_found";               ///< 404
+        static constexpr std::string_view kMethodNotAllowed = "method_not_allowed";///< 405
+        static constexpr std::string_view kTooLarge = "too_large";               ///< 413
+        static constexpr std::string_view kUnsupportedEncoding = "unsupported_encoding";///< 415 request body coding unknown
+        static constexpr std::string_view kRateLimited = "rate_limited";         ///< 429 rate limit exceeded
+        static constexpr std::string_view kNotAllowed = "not_allowed";           ///< 429 generic rejection
+        static constexpr std::string_view kInternalError = "internal_error";     ///< 500
+        static constexpr std::string_view kOverloaded = "overloaded";            ///< 503 admission queue full or timed out
+        static constexpr std::string_view kLagging = "lagging";                  ///< 503 io thread behind, with Retry-After; registered by the HTTP handler
+
+        static CannedResponses &getInstance();
+
+        /**
+         * @brief Register a canned response.
+         * Registering an existing name returns the existing entry unchanged.
+         * @param name Lookup key
+         * @param status_code HTTP status code
+         * @param body Response body
+         * @param content_type Content-Type header value
+         * @param extra_headers Further header lines, each ending in CRLF
+         * @return The registered response
+         */
+        const CannedResponse &register_response(std::string_view name,
+                                                int status_code,
+                                                std::string body,
+                                                std::string_view content_type = "application/json",
+                                                std::string_view extra_headers = {});
+
+        /**
+         * @brief Find a canned response by name.
+         * @param name Lookup key
+         * @return The response or nullptr if not registered
+         */
+        const CannedResponse *find(std::string_view name) const;
+
+        /**
+         * @brief Get a canned response that is known to exist (e.g. a built-in).
+         * @param name Lookup key
+         * @return The response
+         * @throws std::out_of_range if the name is not registered
+         */
+        const CannedResponse &get(std::string_view name) const;
+
+    private:
+        CannedResponses();
+
+        static CannedResponse render(int status_code, std::string body, std::string_view content_type, std::string_view extra_headers = {});
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, std::unique_ptr<CannedResponse>> responses_;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,96 @@
+#include "chunked_body.h"
+#include "session.h"
+#include <array>
+
+namespace mcp::transport {
+
+    namespace {
+        /**
+         * @brief Write data on the session's own executor, as one HTTP chunk when chunk is set.
+         */
+        asio::awaitable<void> session_write(std::shared_ptr<Session> session, std::string data, bool chunk) {
+            if (!chunk) {
+                co_await session->write(data);
+                co_return;
+            }
+            ChunkSizeLine size_line(data.size());
+            std::array<asio::const_buffer, 3> buffers = {size_line.buffer(), asio::buffer(data), asio::buffer("\r\n", 2)};
+            co_await session->write_buffers(buffers);
+        }
+
+        /**
+         * @brief Write a range of a file on the session's own executor, as one HTTP chunk.
+         */
+        asio::awaitable<void> session_write_file(std::shared_ptr<Session> session, FileSlice piece) {
+            ChunkSizeLine size_line(piece.bytes.size());
+            asio::const_buffer head = size_line.buffer();
+            asio::const_buffer tail = asio::buffer("\r\n", 2);
+            co_await session->write_file(std::span<const asio::const_buffer>(&head, 1), piece,
+                                         std::span<const asio::const_buffer>(&tail, 1));
+        }
+    }// namespace
+
+    ChunkedBodyWriter::ChunkedBodyWriter(std::shared_ptr<Session> session, ContentEncoding encoding)
+        : session_(std::move(session)), encoding_(encoding) {
+        if (encoding_ != ContentEncoding::Identity) {
+            compressor_ = std::make_unique<StreamCompressor>(encoding_, CompressionOptions::current().level);
+        }
+    }
+
+    ChunkedBodyWriter::~ChunkedBodyWriter() = default;
+
+    asio::awaitable<void> ChunkedBodyWriter::begin(std::string_view content_type) {
+        std::string header = "HTTP/1.1 200 OK\r\nContent-Type: ";
+        header += content_type;
+        header += "\r\n";
+        header += encoding_header(encoding_);
+        header += "Transfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n";
+        co_await send(std::move(header), false);
+    }
+
+    asio::awaitable<void> ChunkedBodyWriter::write(std::string piece) {
+        written_ += piece.size();
+        if (compressor_) {
+            piece = compressor_->compress(piece);
+        }
+        if (piece.empty()) {
+            co_return;// an empty chunk would end the body
+        }
+        co_await send(std::move(piece), true);
+    }
+
+    asio::awaitable<void> ChunkedBodyWriter::write_file(FileSlice piece) {
+        if (compressor_) {
+            co_await write(std::string(piece.bytes));
+            co_return;
+        }
+        if (piece.bytes.empty()) {
+            co_return;
+        }
+        written_ += piece.bytes.size();
+        co_await asio::co_spawn(session_->get_executor(), session_write_file(session_, piece), asio::use_awaitable);
+    }
+
+    asio::awaitable<void> ChunkedBodyWriter::finish() {
+        if (compressor_) {
+            auto trailer = compressor_->finish();
+            if (!trailer.empty()) {
+                co_await send(std::move(trailer), true);
+            }
+        }
+        co_await send("0\r\n\r\n", false);
+    }
+
+    void ChunkedBodyWriter::abort() {
+        asio::post(session_->get_executor(), [session = session_]() { session->close(); });
+    }
+
+    bool ChunkedBodyWriter::closed() const {
+        return session_->is_closed();
+    }
+
+    asio::awaitable<void> ChunkedBodyWriter::send(std::string data, bool chunk) {
+        co_await asio::co_spawn(session_->get_executor(), session_write(session_, std::move(data), chunk), asio::use_awaitable);
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,88 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "http_compression.h"
+#include "session.h"
+#include <asio.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Writes a 200 response with Transfer-Encoding: chunked, one piece of the body at a time.
+     *
+     * For bodies produced while they are sent, such as large file reads or tool results. May be used
+     * from any executor: every write runs on the session's executor and is awaited, so the producer
+     * never runs more than one piece ahead of the socket. With a coding every piece is compressed and
+     * flushed as one chunk. Once begin() has written the header an error can no longer be answered;
+     * abort() drops the connection, so the client sees a body without its last chunk.
+     */
+    class ChunkedBodyWriter {
+    public:
+        /**
+         * @param session Session to answer on
+         * @param encoding Coding of the body, from stream_encoding()
+         */
+        ChunkedBodyWriter(std::shared_ptr<Session> session, ContentEncoding encoding);
+        ~ChunkedBodyWriter();
+
+        ChunkedBodyWriter(const ChunkedBodyWriter &) = delete;
+        ChunkedBodyWriter &operator=(const ChunkedBodyWriter &) = delete;
+
+        /**
+         * @brief Write the response header.
+         * @param content_type Content-Type of the body
+         */
+        asio::awaitable<void> begin(std::string_view content_type = "application/json");
+
+        /**
+         * @brief Send the next piece of the body as one chunk; empty pieces are skipped.
+         * @param piece Uncompressed data
+         */
+        asio::awaitable<void> write(std::string piece);
+
+        /**
+         * @brief Send a range of a file as the next chunk, as it is.
+         * Without a coding the range goes out with Session::write_file(), from the file itself where
+         * the session can; with one it is compressed like a piece given to write(). The range must
+         * stay valid until the returned awaitable completes.
+         * @param piece Uncompressed range
+         */
+        asio::awaitable<void> write_file(FileSlice piece);
+
+        /**
+         * @brief End the body with the coding's trailer and the last chunk.
+         */
+        asio::awaitable<void> finish();
+
+        /**
+         * @brief Drop the connection of an unfinished body.
+         */
+        void abort();
+
+        /**
+         * @brief Uncompressed body bytes written so far.
+         */
+        size_t written() const { return written_; }
+
+        /**
+         * @brief Whether the client went away, writing more is pointless.
+         */
+        bool closed() const;
+
+    private:
+        asio::awaitable<void> send(std::string data, bool chunk);
+
+        std::shared_ptr<Session> session_;
+        ContentEncoding encoding_;
+        std::unique_ptr<StreamCompressor> compressor_;
+        size_t written_ = 0;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,409 @@
+#include "cluster.h"
+#include "cluster_quota.h"
+#include "core/logger.h"
+#include "utils/session_id.h"
+#include <nlohmann/json.hpp>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <random>
+
+namespace mcp::transport {
+
+    namespace {
+        ClusterOptions &options_storage() {
+            static ClusterOptions options;
+            return options;
+        }
+
+        constexpr size_t kFanout = 3;             ///< Peers gossiped to per round
+        constexpr size_t kMaxDatagram = 65507;    ///< Largest UDP payload
+        constexpr int kForgetAfterSuspicions = 12;///< Silent members are dropped after this many suspect_after
+
+        std::pair<std::string, std::string> split_address(std::string_view address) {
+            size_t colon = address.rfind(':');
+            if (colon == std::string_view::npos) {
+                return {std::string(address), {}};
+            }
+            std::string_view host = address.substr(0, colon);
+            if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+                host = host.substr(1, host.size() - 2);
+            }
+            return {std::string(host), std::string(address.substr(colon + 1))};
+        }
+
+        bool is_unspecified_host(const std::string &host) {
+            return host.empty() || host == "0.0.0.0" || host == "::";
+        }
+
+        std::string hex(const unsigned char *data, size_t size) {
+            static constexpr char kHex[] = "0123456789abcdef";
+            std::string text;
+            text.reserve(size * 2);
+            for (size_t i = 0; i < size; ++i) {
+                text.push_back(kHex[data[i] >> 4]);
+                text.push_back(kHex[data[i] & 0x0f]);
+            }
+            return text;
+        }
+
+        // "-" when gossip is not authenticated
+        std::string mac_of(const std::string &secret, std::string_view payload) {
+            if (secret.empty()) {
+                return "-";
+            }
+            unsigned char mac[EVP_MAX_MD_SIZE];
+            size_t length = 0;
+            if (!EVP_Q_mac(nullptr, "HMAC", nullptr, "SHA256", nullptr, secret.data(), secret.size(),
+                           reinterpret_cast<const unsigned char *>(payload.data()), payload.size(), mac, sizeof(mac), &length)) {
+                return {};
+            }
+            return hex(mac, length);
+        }
+
+        int64_t silent_ms(std::chrono::steady_clock::time_point changed, std::chrono::steady_clock::time_point now) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now - changed).count();
+        }
+    }// namespace
+
+    std::vector<std::string> ClusterOptions::parse_list(std::string_view text) {
+        std::vector<std::string> items;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+            if (!item.empty()) {
+                items.emplace_back(item);
+            }
+        }
+        return items;
+    }
+
+    void ClusterOptions::configure(const ClusterOptions &options) {
+        options_storage() = options;
+    }
+
+    const ClusterOptions &ClusterOptions::current() {
+        return options_storage();
+    }
+
+    HashRing::HashRing(std::vector<Node> nodes, size_t virtual_nodes) : nodes_(std::move(nodes)) {
+        std::sort(nodes_.begin(), nodes_.end(), [](const Node &a, const Node &b) { return a.id < b.id; });
+        virtual_nodes = std::max<size_t>(virtual_nodes, 1);
+        points_.reserve(nodes_.size() * virtual_nodes);
+        for (uint32_t i = 0; i < nodes_.size(); ++i) {
+            for (size_t v = 0; v < virtual_nodes; ++v) {
+                points_.emplace_back(hash(nodes_[i].id + "#" + std::to_string(v)), i);
+            }
+        }
+        std::sort(points_.begin(), points_.end());
+    }
+
+    const HashRing::Node *HashRing::owner(std::string_view key) const {
+        if (points_.empty()) {
+            return nullptr;
+        }
+        auto it = std::lower_bound(points_.begin(), points_.end(), std::make_pair(hash(key), uint32_t{0}));
+        if (it == points_.end()) {
+            it = points_.begin();// Past the last point the ring wraps around
+        }
+        return &nodes_[it->second];
+    }
+
+    uint64_t HashRing::hash(std::string_view key) {
+        // FNV-1a, then the splitmix64 finalizer so that similar keys land far apart
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c: key) {
+            h = (h ^ c) * 0x100000001b3ULL;
+        }
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    Cluster &Cluster::instance() {
+        static Cluster cluster;
+        return cluster;
+    }
+
+    Cluster::~Cluster() {
+        stop();
+    }
+
+    void Cluster::start() {
+        if (running_.load() || !ClusterOptions::current().enabled) {
+            return;
+        }
+        options_ = ClusterOptions::current();
+
+        auto [http_host, http_port] = split_address(options_.advertise);
+        auto [bind_host, bind_port] = split_address(options_.bind);
+        if (is_unspecified_host(http_host)) {
+            http_host = asio::ip::host_name();
+        }
+
+        self_.id = options_.node_id;
+        if (self_.id.empty()) {
+            self_.id = "node-" + utils::generate_session_id().str().substr(0, 12);
+        }
+        self_.address = http_host + ":" + http_port;
+        self_.gossip = http_host + ":" + bind_port;
+        self_.heartbeat = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                        std::chrono::system_clock::now().time_since_epoch())
+                                                        .count());
+
+        io_ = std::make_unique<asio::io_context>(1);
+        try {
+            asio::ip::udp::endpoint endpoint(asio::ip::make_address(is_unspecified_host(bind_host) ? "0.0.0.0" : bind_host),
+                                             static_cast<unsigned short>(std::stoi(bind_port)));
+            socket_ = std::make_unique<asio::ip::udp::socket>(*io_, endpoint);
+        } catch (const std::exception &e) {
+            MCP_ERROR("Cluster mode disabled, cannot receive gossip on {}: {}", options_.bind, e.what());
+            socket_.reset();
+            io_.reset();
+            return;
+        }
+
+        ring_.store(std::make_shared<const HashRing>(std::vector<HashRing::Node>{{self_.id, self_.address}}, options_.virtual_nodes));
+        ring_ids_ = {self_.id};
+        running_.store(true, std::memory_order_release);
+
+        asio::co_spawn(*io_, gossip_loop(), asio::detached);
+        asio::co_spawn(*io_, receive_loop(), asio::detached);
+        thread_ = std::thread([this]() { io_->run(); });
+        MCP_INFO("Cluster node {} serving {} gossips on {} ({} seeds)", self_.id, self_.address, options_.bind, options_.seeds.size());
+    }
+
+    void Cluster::stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        io_->stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        socket_.reset();
+        io_.reset();
+    }
+
+    std::optional<HashRing::Node> Cluster::remote_owner(std::string_view session_id) const {
+        if (!enabled()) {
+            return std::nullopt;
+        }
+        auto ring = ring_.load(std::memory_order_acquire);
+        const HashRing::Node *owner = ring->owner(session_id.substr(0, session_id.find('-')));
+        if (!owner || owner->id == self_.id) {
+            return std::nullopt;
+        }
+        return *owner;
+    }
+
+    std::string Cluster::mint_session_id() const {
+        std::string id = utils::generate_session_id().str();
+        if (!enabled()) {
+            return id;
+        }
+        // A node owns about 1/n of the ring, so a few draws find an ID that hashes to it
+        auto ring = ring_.load(std::memory_order_acquire);
+        for (int attempt = 0; attempt < 256; ++attempt) {
+            const HashRing::Node *owner = ring->owner(id);
+            if (!owner || owner->id == self_.id) {
+                break;
+            }
+            id = utils::generate_session_id().str();
+        }
+        return id;
+    }
+
+    std::vector<ClusterMemberStats> Cluster::members() const {
+        std::vector<ClusterMemberStats> result;
+        if (!enabled()) {
+            return result;
+        }
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(members_mutex_);
+        result.push_back({self_.id, self_.address, self_.heartbeat, 0, true});
+        for (const auto &[id, member]: members_) {
+            int64_t silent = silent_ms(member.changed, now);
+            result.push_back({id, member.address, member.heartbeat, silent, silent < options_.suspect_after.count()});
+        }
+        return result;
+    }
+
+    std::string Cluster::encode_table(const nlohmann::json &quota) {
+        // The caller holds members_mutex_
+        nlohmann::json members = nlohmann::json::array();
+        members.push_back({self_.id, self_.address, self_.gossip, self_.heartbeat});
+        for (const auto &[id, member]: members_) {
+            members.push_back({id, member.address, member.gossip, member.heartbeat});
+        }
+        nlohmann::json message = {{"from", self_.id}, {"members", std::move(members)}};
+        if (!quota.empty()) {
+            message["quota"] = quota;
+        }
+        std::string payload = message.dump();
+        return mac_of(options_.secret, payload) + "\n" + payload;
+    }
+
+    void Cluster::rebuild_ring(std::chrono::steady_clock::time_point now) {
+        // The caller holds members_mutex_
+        const int64_t suspect_ms = options_.suspect_after.count();
+        std::vector<HashRing::Node> live{{self_.id, self_.address}};
+        for (auto it = members_.begin(); it != members_.end();) {
+            int64_t silent = silent_ms(it->second.changed, now);
+            if (silent > suspect_ms * kForgetAfterSuspicions) {
+                MCP_INFO("Cluster node {} forgotten after {} ms of silence", it->first, silent);
+                it = members_.erase(it);
+                continue;
+            }
+            if (silent < suspect_ms) {
+                live.push_back({it->first, it->second.address});
+            }
+            ++it;
+        }
+
+        std::vector<std::string> ids;
+        ids.reserve(live.size());
+        for (const auto &node: live) {
+            ids.push_back(node.id);
+        }
+        std::sort(ids.begin(), ids.end());
+        if (ids == ring_ids_) {
+            return;
+        }
+        ring_ids_ = std::move(ids);
+        ring_.store(std::make_shared<const HashRing>(std::move(live), options_.virtual_nodes), std::memory_order_release);
+        MCP_INFO("Cluster ring changed, {} live nodes", ring_ids_.size());
+    }
+
+    void Cluster::merge(std::string_view datagram, std::chrono::steady_clock::time_point now) {
+        size_t newline = datagram.find('\n');
+        if (newline == std::string_view::npos) {
+            return;
+        }
+        std::string_view mac = datagram.substr(0, newline);
+        std::string_view payload = datagram.substr(newline + 1);
+        std::string expected = mac_of(options_.secret, payload);
+        if (expected.empty() || mac.size() != expected.size() || CRYPTO_memcmp(mac.data(), expected.data(), mac.size()) != 0) {
+            MCP_DEBUG("Dropping cluster gossip with a bad signature");
+            return;
+        }
+
+        nlohmann::json message = nlohmann::json::parse(payload, nullptr, false);
+        if (!message.is_object() || !message.contains("members") || !message["members"].is_array()) {
+            return;
+        }
+
+        if (message.contains("quota") && message.contains("from") && message["from"].is_string()) {
+            ClusterQuota::instance().merge(message["from"].get<std::string>(), message["quota"]);
+        }
+
+        std::lock_guard<std::mutex> lock(members_mutex_);
+        for (const auto &entry: message["members"]) {
+            if (!entry.is_array() || entry.size() != 4 || !entry[0].is_string() || !entry[1].is_string() ||
+                !entry[2].is_string() || !entry[3].is_number_unsigned()) {
+                continue;
+            }
+            std::string id = entry[0].get<std::string>();
+            uint64_t heartbeat = entry[3].get<uint64_t>();
+            if (id == self_.id) {
+                if (heartbeat > self_.heartbeat && entry[1].get<std::string>() != self_.address) {
+                    MCP_WARN("Cluster node {} at {} uses the id of this node", id, entry[1].get<std::string>());
+                }
+                continue;
+            }
+            auto [it, inserted] = members_.try_emplace(id);
+            Member &member = it->second;
+            if (inserted || heartbeat > member.heartbeat) {
+                if (inserted) {
+                    MCP_INFO("Cluster node {} joined at {}", id, entry[1].get<std::string>());
+                }
+                member.id = id;
+                member.address = entry[1].get<std::string>();
+                member.gossip = entry[2].get<std::string>();
+                member.heartbeat = heartbeat;
+                member.changed = now;
+            }
+        }
+        rebuild_ring(now);
+    }
+
+    asio::awaitable<void> Cluster::gossip_loop() {
+        asio::steady_timer timer(*io_);
+        asio::ip::udp::resolver resolver(*io_);
+        std::mt19937_64 random{std::random_device{}()};
+
+        while (running_.load(std::memory_order_acquire)) {
+            auto now = std::chrono::steady_clock::now();
+            std::string datagram;
+            std::vector<std::string> targets;
+            {
+                std::lock_guard<std::mutex> lock(members_mutex_);
+                ++self_.heartbeat;
+                rebuild_ring(now);
+                datagram = encode_table(ClusterQuota::instance().reconcile(ring_ids_));
+
+                std::vector<std::string> live;
+                std::vector<std::string> silent;
+                for (const auto &[id, member]: members_) {
+                    (silent_ms(member.changed, now) < options_.suspect_after.count() ? live : silent).push_back(member.gossip);
+                }
+                std::shuffle(live.begin(), live.end(), random);
+                live.resize(std::min(live.size(), kFanout));
+                targets = std::move(live);
+
+                // Seeds while alone, and now and then a silent node or a seed, so split groups merge again
+                ++rounds_;
+                if (targets.empty()) {
+                    targets.insert(targets.end(), options_.seeds.begin(), options_.seeds.end());
+                } else if (rounds_ % 10 == 0) {
+                    const auto &pool = !silent.empty() ? silent : options_.seeds;
+                    if (!pool.empty()) {
+                        targets.push_back(pool[random() % pool.size()]);
+                    }
+                }
+            }
+
+            if (datagram.size() > kMaxDatagram) {
+                MCP_WARN("Cluster member table of {} bytes does not fit a datagram", datagram.size());
+            } else {
+                for (const auto &target: targets) {
+                    auto [host, port] = split_address(target);
+                    asio::error_code ec;
+                    auto endpoints = co_await resolver.async_resolve(asio::ip::udp::v4(), host, port, asio::redirect_error(asio::use_awaitable, ec));
+                    if (ec || endpoints.empty()) {
+                        MCP_DEBUG("Cannot resolve cluster peer {}: {}", target, ec.message());
+                        continue;
+                    }
+                    co_await socket_->async_send_to(asio::buffer(datagram), endpoints.begin()->endpoint(),
+                                                    asio::redirect_error(asio::use_awaitable, ec));
+                }
+            }
+
+            timer.expires_after(options_.gossip_interval);
+            asio::error_code ec;
+            co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+    }
+
+    asio::awaitable<void> Cluster::receive_loop() {
+        std::vector<char> buffer(kMaxDatagram);
+        asio::ip::udp::endpoint sender;
+        while (running_.load(std::memory_order_acquire)) {
+            asio::error_code ec;
+            size_t size = co_await socket_->async_receive_from(asio::buffer(buffer), sender, asio::redirect_error(asio::use_awaitable, ec));
+            if (ec) {
+                if (ec == asio::error::operation_aborted) {
+                    co_return;
+                }
+                continue;
+            }
+            merge(std::string_view(buffer.data(), size), std::chrono::steady_clock::now());
+        }
+    }
+
+}// namespace mcp::transport
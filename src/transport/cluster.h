@@ -0,0 +1,172 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Cluster mode, normally taken from the [cluster] config section.
+     *
+     * Replicas behind one load balancer find each other by gossip and place every session on a
+     * consistent-hash ring. A request naming a session (Mcp-Session-Id) that another node owns is
+     * forwarded to that node, so its streams and generators are found wherever the client lands.
+     */
+    struct ClusterOptions {
+        bool enabled = false;
+        std::string node_id;                           ///< Name of this node, random if empty
+        std::string bind = "0.0.0.0:7946";             ///< UDP address gossip is received on
+        std::string advertise;                         ///< host:port of the HTTP listener peers forward to
+        std::vector<std::string> seeds;                ///< Gossip addresses (host:port) of nodes to join through
+        std::string secret;                            ///< Key gossip is authenticated with (HMAC-SHA256), empty = none
+        std::chrono::milliseconds gossip_interval{1000};///< Time between gossip rounds
+        std::chrono::milliseconds suspect_after{5000}; ///< Silence after which a node leaves the ring
+        size_t virtual_nodes = 64;                     ///< Ring points per node
+        std::chrono::milliseconds forward_timeout{5000};///< Longest wait for the owner to connect and answer
+
+        /**
+         * @brief Parse a comma-separated address list such as "10.0.0.2:7946,10.0.0.3:7946".
+         */
+        static std::vector<std::string> parse_list(std::string_view text);
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const ClusterOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const ClusterOptions &current();
+    };
+
+    /**
+     * @brief Consistent-hash ring of the live nodes, immutable once built.
+     */
+    class HashRing {
+    public:
+        struct Node {
+            std::string id;
+            std::string address;///< host:port of its HTTP listener
+        };
+
+        HashRing() = default;
+        HashRing(std::vector<Node> nodes, size_t virtual_nodes);
+
+        /**
+         * @brief Node owning a key, nullptr if the ring is empty.
+         */
+        const Node *owner(std::string_view key) const;
+
+        const std::vector<Node> &nodes() const { return nodes_; }
+
+        static uint64_t hash(std::string_view key);
+
+    private:
+        std::vector<Node> nodes_;                         ///< Sorted by id
+        std::vector<std::pair<uint64_t, uint32_t>> points_;///< Ring position and node index, sorted
+    };
+
+    /**
+     * @brief One node as this node knows it, for /admin/stats.
+     */
+    struct ClusterMemberStats {
+        std::string id;
+        std::string address;
+        uint64_t heartbeat = 0;
+        int64_t silent_ms = 0;///< Since its heartbeat last advanced, 0 for this node
+        bool alive = false;
+    };
+
+    /**
+     * @brief Membership by gossip and session ownership of this process.
+     *
+     * Each round the node raises its heartbeat (it starts at the wall clock, so a restarted node
+     * is not mistaken for an old one) and sends its member table to a few random peers over UDP,
+     * to the seeds while it knows no peer. Tables are merged by taking the higher heartbeat; a
+     * member whose heartbeat stops advancing for suspect_after leaves the ring, and is forgotten
+     * much later. Gossip runs on a thread of its own; owner lookups only load the current ring.
+     * Each datagram also carries this node's tenant rates for ClusterQuota.
+     */
+    class Cluster {
+    public:
+        static Cluster &instance();
+
+        ~Cluster();
+
+        /**
+         * @brief Join the cluster with the process-wide options; nothing happens unless enabled.
+         */
+        void start();
+
+        void stop();
+
+        bool enabled() const noexcept { return running_.load(std::memory_order_acquire); }
+
+        const std::string &node_id() const { return self_.id; }
+
+        /**
+         * @brief Node a session must be served by, if it is not this one.
+         * IDs derived from a connection's ("<id>-<n>") belong to the connection's owner.
+         * @param session_id Mcp-Session-Id presented by the client
+         * @return Owner, std::nullopt if this node owns the session or cluster mode is off
+         */
+        std::optional<HashRing::Node> remote_owner(std::string_view session_id) const;
+
+        /**
+         * @brief New session ID owned by this node, a plain random one when cluster mode is off.
+         */
+        std::string mint_session_id() const;
+
+        std::vector<ClusterMemberStats> members() const;
+
+    private:
+        struct Member {
+            std::string id;
+            std::string address;
+            std::string gossip;///< host:port gossip is sent to
+            uint64_t heartbeat = 0;
+            std::chrono::steady_clock::time_point changed;///< When heartbeat last advanced
+        };
+
+        Cluster() = default;
+
+        asio::awaitable<void> gossip_loop();
+        asio::awaitable<void> receive_loop();
+        void merge(std::string_view datagram, std::chrono::steady_clock::time_point now);
+        std::string encode_table(const nlohmann::json &quota);
+        void rebuild_ring(std::chrono::steady_clock::time_point now);
+
+        ClusterOptions options_;
+        Member self_;
+        std::atomic<bool> running_{false};
+        std::atomic<std::shared_ptr<const HashRing>> ring_;
+
+        mutable std::mutex members_mutex_;
+        std::unordered_map<std::string, Member> members_;///< Other nodes
+        std::vector<std::string> ring_ids_;              ///< Live members the ring was built from, sorted
+
+        std::unique_ptr<asio::io_context> io_;
+        std::unique_ptr<asio::ip::udp::socket> socket_;
+        std::thread thread_;
+        uint64_t rounds_ = 0;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,234 @@
+#include "cluster_quota.h"
+#include "cluster.h"
+#include "core/logger.h"
+#include "tenants.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace mcp::transport {
+
+    namespace {
+        constexpr size_t kMaxReported = 512;                ///< Tenants gossiped per round, the busiest first
+        constexpr int64_t kForgetIdleNs = 60LL * 1000000000;///< Tenants idle this long are dropped
+
+        std::string tenant_hash(std::string_view kind, std::string_view credential) {
+            // Only a hash is kept and gossiped, never the credential itself
+            std::string key(kind);
+            key += credential;
+            char text[17];
+            std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(HashRing::hash(key)));
+            return text;
+        }
+
+        int64_t interval_for(double rate) {
+            return rate > 0 ? std::max<int64_t>(1, static_cast<int64_t>(1e9 / rate)) : 0;
+        }
+
+        constexpr std::string_view kNamedPrefix = "tenant:";
+    }// namespace
+
+    ClusterQuota &ClusterQuota::instance() {
+        static ClusterQuota quota;
+        return quota;
+    }
+
+    void ClusterQuota::configure(const ClusterQuotaOptions &options) {
+        auto current = std::make_shared<const ClusterQuotaOptions>(options);
+        options_.store(current, std::memory_order_release);
+        enabled_.store(options.enabled(), std::memory_order_relaxed);
+        // Allowances restart from the new limit, the next gossip round shares it out again
+        for (auto &shard: shards_) {
+            std::unique_lock lock(shard.mutex);
+            for (auto &[tenant, state]: shard.tenants) {
+                assign_limit(tenant, state, *current);
+            }
+        }
+        if (options.enabled()) {
+            MCP_INFO("Tenant rate limit: {}/s (burst {}), {} named tenants with limits of their own, {}",
+                     options.requests_per_second, options.burst != 0 ? options.burst : options.requests_per_second,
+                     options.tenant_limits.size(), ClusterOptions::current().enabled ? "over the cluster" : "per process");
+        }
+    }
+
+    size_t ClusterQuota::limit_of(const std::string &tenant, const ClusterQuotaOptions &options) const {
+        if (tenant.starts_with(kNamedPrefix)) {
+            if (auto it = options.tenant_limits.find(tenant.substr(kNamedPrefix.size())); it != options.tenant_limits.end()) {
+                return it->second;
+            }
+        }
+        return options.requests_per_second;
+    }
+
+    void ClusterQuota::assign_limit(const std::string &tenant, Tenant &state, const ClusterQuotaOptions &options) const {
+        size_t limit = limit_of(tenant, options);
+        size_t burst = limit == options.requests_per_second && options.burst != 0 ? options.burst : limit;
+        int64_t interval = interval_for(static_cast<double>(limit));
+        state.limit = static_cast<double>(limit);
+        state.window_ns = interval * static_cast<int64_t>(std::max<size_t>(burst, 1));
+        state.allowed_rate = state.limit;
+        state.interval_ns.store(interval, std::memory_order_relaxed);
+    }
+
+    std::string ClusterQuota::tenant_of(const HeaderMap &headers, const AuthDecision *decision) {
+        if (auto name = Tenants::instance().name_of(headers, decision); !name.empty()) {
+            std::string tenant(kNamedPrefix);
+            tenant += name;
+            return tenant;
+        }
+        if (auto key = headers.get("X-API-Key"); !key.empty()) {
+            return tenant_hash("key:", key);
+        }
+        if (auto authorization = headers.get("Authorization"); !authorization.empty()) {
+            return tenant_hash("auth:", authorization);
+        }
+        return {};
+    }
+
+    ClusterQuota::Shard &ClusterQuota::shard_for(const std::string &tenant) {
+        return shards_[std::hash<std::string>{}(tenant) & (kShardCount - 1)];
+    }
+
+    int64_t ClusterQuota::now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool ClusterQuota::try_acquire(const std::string &tenant) {
+        const int64_t now = now_ns();
+
+        // GCRA as in RateLimiter, with the refill interval of this node's current allowance
+        auto conforms = [now](Tenant &state) {
+            int64_t interval = state.interval_ns.load(std::memory_order_relaxed);
+            if (interval == 0) {
+                // A tenant without a limit
+                return true;
+            }
+            // A small allowance still lets single requests through at its pace
+            int64_t limit = std::max(state.window_ns, interval);
+            int64_t tat = state.tat.load(std::memory_order_relaxed);
+            while (true) {
+                int64_t new_tat = std::max(tat, now) + interval;
+                if (new_tat - now > limit) {
+                    if (state.counters) {
+                        state.counters->rate_limited.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return false;
+                }
+                if (state.tat.compare_exchange_weak(tat, new_tat, std::memory_order_relaxed)) {
+                    state.admitted.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        };
+
+        Shard &shard = shard_for(tenant);
+        {
+            std::shared_lock lock(shard.mutex);
+            auto it = shard.tenants.find(tenant);
+            if (it != shard.tenants.end()) {
+                it->second.last_used.store(now, std::memory_order_relaxed);
+                return conforms(it->second);
+            }
+        }
+        auto options = options_.load(std::memory_order_acquire);
+        if (limit_of(tenant, *options) == 0) {
+            return true;
+        }
+        std::unique_lock lock(shard.mutex);
+        auto [it, inserted] = shard.tenants.try_emplace(tenant);
+        if (inserted) {
+            // Until the next round a new tenant may use the whole limit here
+            assign_limit(tenant, it->second, *options);
+            if (tenant.starts_with(kNamedPrefix)) {
+                it->second.counters = metrics::MetricsManager::getInstance()->register_tenant_counters(tenant.substr(kNamedPrefix.size()));
+            }
+        }
+        it->second.last_used.store(now, std::memory_order_relaxed);
+        return conforms(it->second);
+    }
+
+    nlohmann::json ClusterQuota::reconcile(const std::vector<std::string> &live_nodes) {
+        nlohmann::json report = nlohmann::json::object();
+        if (!enabled()) {
+            return report;
+        }
+        auto now = std::chrono::steady_clock::now();
+        const int64_t now_ticks = now_ns();
+        const double nodes = static_cast<double>(std::max<size_t>(live_nodes.size(), 1));
+
+        std::lock_guard<std::mutex> peers_lock(peers_mutex_);
+        double elapsed = last_reconcile_ == std::chrono::steady_clock::time_point{}
+                                 ? 0
+                                 : std::chrono::duration<double>(now - last_reconcile_).count();
+        last_reconcile_ = now;
+
+        // Reports of nodes that left the ring no longer count against anyone
+        for (auto it = peers_.begin(); it != peers_.end();) {
+            bool live = std::find(live_nodes.begin(), live_nodes.end(), it->first) != live_nodes.end();
+            it = live ? std::next(it) : peers_.erase(it);
+        }
+
+        std::vector<std::pair<double, std::string>> rates;
+        for (auto &shard: shards_) {
+            std::unique_lock lock(shard.mutex);
+            for (auto it = shard.tenants.begin(); it != shard.tenants.end();) {
+                Tenant &state = it->second;
+                uint64_t admitted = state.admitted.exchange(0, std::memory_order_relaxed);
+                if (admitted == 0 && now_ticks - state.last_used.load(std::memory_order_relaxed) > kForgetIdleNs) {
+                    it = shard.tenants.erase(it);
+                    continue;
+                }
+                state.local_rate = elapsed > 0 ? static_cast<double>(admitted) / elapsed : 0;
+                state.peer_rate = 0;
+                for (const auto &[node, peer]: peers_) {
+                    if (auto rate = peer.find(it->first); rate != peer.end()) {
+                        state.peer_rate += rate->second;
+                    }
+                }
+                // What the others leave of the limit, but never less than an even share of it
+                if (state.limit > 0) {
+                    state.allowed_rate = std::min(state.limit, std::max(state.limit - state.peer_rate, state.limit / nodes));
+                    state.interval_ns.store(interval_for(state.allowed_rate), std::memory_order_relaxed);
+                }
+                if (state.local_rate > 0) {
+                    rates.emplace_back(state.local_rate, it->first);
+                }
+                ++it;
+            }
+        }
+
+        if (rates.size() > kMaxReported) {
+            std::nth_element(rates.begin(), rates.begin() + kMaxReported, rates.end(), std::greater<>());
+            rates.resize(kMaxReported);
+        }
+        for (auto &[rate, tenant]: rates) {
+            report[tenant] = rate;
+        }
+        return report;
+    }
+
+    void ClusterQuota::merge(const std::string &node, const nlohmann::json &report) {
+        if (!enabled() || !report.is_object()) {
+            return;
+        }
+        std::unordered_map<std::string, double> rates;
+        for (const auto &[tenant, rate]: report.items()) {
+            if (rate.is_number()) {
+                rates[tenant] = std::max(0.0, rate.get<double>());
+            }
+        }
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        peers_[node] = std::move(rates);
+    }
+
+    std::vector<ClusterQuotaStats> ClusterQuota::stats() const {
+        std::vector<ClusterQuotaStats> result;
+        for (const auto &shard: shards_) {
+            std::shared_lock lock(shard.mutex);
+            for (const auto &[tenant, state]: shard.tenants) {
+                result.push_back({tenant, state.limit, state.local_rate, state.peer_rate, state.allowed_rate});
+            }
+        }
+        return result;
+    }
+
+}// namespace mcp::transport
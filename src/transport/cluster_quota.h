@@ -0,0 +1,154 @@
+#pragma once
+
+#include "header_map.h"
+#include "metrics/metrics_manager.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct AuthDecision;
+
+namespace mcp::transport {
+
+    /**
+     * @brief Request rate of each tenant over the whole cluster, normally taken from the [server] config section.
+     */
+    struct ClusterQuotaOptions {
+        size_t requests_per_second = 0;                      ///< Requests a tenant may send per second to all nodes together, 0 = no tenant limit
+        size_t burst = 0;                                    ///< Requests a tenant may send back to back, 0 = requests_per_second
+        std::unordered_map<std::string, size_t> tenant_limits;///< Named tenant -> its requests per second, overriding requests_per_second; its burst is one second's worth
+
+        bool enabled() const { return requests_per_second > 0 || !tenant_limits.empty(); }
+
+        bool operator==(const ClusterQuotaOptions &) const = default;
+    };
+
+    /**
+     * @brief Rate of one tenant as this node sees it, for /admin/stats.
+     */
+    struct ClusterQuotaStats {
+        std::string tenant;     ///< Name of a named tenant, else a hash of the tenant's credential
+        double limit = 0;       ///< Requests per second over the cluster
+        double local_rate = 0;  ///< Requests per second admitted here in the last gossip round
+        double peer_rate = 0;   ///< Requests per second the other live nodes reported
+        double allowed_rate = 0;///< Requests per second this node admits now
+    };
+
+    /**
+     * @brief Per-tenant rate limit shared by the nodes of a cluster.
+     *
+     * The session rate limit is enforced by the node owning the session, so it holds cluster-wide
+     * already; a tenant (an API key or bearer token) opens many sessions spread over every node,
+     * and would get the limit once per node. Here each node keeps a token bucket per tenant,
+     * checked locally like the session buckets, so a request never waits on the network. The
+     * buckets refill at the rate the node is allowed: what the other live nodes did not use of
+     * the tenant's limit in their last report, but at least an even share of it. Each gossip
+     * round a node reports the rate it admitted per tenant and recomputes its own allowance from
+     * the reports of its peers.
+     *
+     * Reports are one gossip round old, so when a tenant's traffic shifts between nodes they may
+     * together admit more than the limit for about one gossip interval: at most the limit times
+     * the number of nodes, before the next round brings their allowances back to the limit.
+     * Without cluster mode the limit is simply enforced per process.
+     *
+     * Credentials grouped under a named tenant (see Tenants) share one bucket, and a named tenant
+     * may have a limit of its own; names are gossiped as they are.
+     */
+    class ClusterQuota {
+    public:
+        static ClusterQuota &instance();
+
+        /**
+         * @brief Set the limit, at startup or on a config reload. Buckets keep their fill level.
+         */
+        void configure(const ClusterQuotaOptions &options);
+
+        bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Tenant of a request: its named tenant, or a hash of its X-API-Key, or of its
+         *        Authorization header.
+         * @param headers Request headers
+         * @param decision Credential accepted on the connection, if any
+         * @return Tenant, empty for requests without credentials, which only the session limit applies to
+         */
+        static std::string tenant_of(const HeaderMap &headers, const AuthDecision *decision);
+
+        /**
+         * @brief Take a token from the tenant's bucket. Never blocks.
+         * @return Whether the request is admitted; always for tenants without a limit
+         */
+        bool try_acquire(const std::string &tenant);
+
+        /**
+         * @brief Recompute the allowances from the peers' last reports and report this node's rates.
+         * Called by the cluster's gossip loop once per round.
+         * @param live_nodes Nodes in the ring, this one included
+         * @return Rates to gossip, {tenant: requests per second}; the busiest tenants if there are many
+         */
+        nlohmann::json reconcile(const std::vector<std::string> &live_nodes);
+
+        /**
+         * @brief Take a peer's report, as received by gossip.
+         * @param node Node that sent it
+         * @param report Its rates, see reconcile()
+         */
+        void merge(const std::string &node, const nlohmann::json &report);
+
+        std::vector<ClusterQuotaStats> stats() const;
+
+    private:
+        ClusterQuota() = default;
+
+        static constexpr size_t kShardCount = 16;
+
+        struct Tenant {
+            std::atomic<int64_t> tat{0};        ///< GCRA theoretical arrival time (ns)
+            std::atomic<int64_t> interval_ns{0};///< Time one token takes to refill at the current allowance
+            std::atomic<uint64_t> admitted{0};  ///< Since the last reconcile()
+            std::atomic<int64_t> last_used{0};  ///< Time (ns) of the last request
+            double limit = 0;                   ///< Requests per second over the cluster, written with the shard locked exclusively
+            int64_t window_ns = 0;              ///< Burst times the refill time at the full limit
+            double local_rate = 0;              ///< Written by reconcile() only
+            double peer_rate = 0;
+            double allowed_rate = 0;
+            std::shared_ptr<metrics::TenantCounters> counters;///< Usage of a named tenant, null for the others
+        };
+
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<std::string, Tenant> tenants;
+        };
+
+        Shard &shard_for(const std::string &tenant);
+        static int64_t now_ns();
+
+        /**
+         * @brief Requests per second over the cluster of a tenant, 0 = no limit.
+         */
+        size_t limit_of(const std::string &tenant, const ClusterQuotaOptions &options) const;
+
+        /**
+         * @brief Give a tenant its limit in full, until the next round shares it out.
+         */
+        void assign_limit(const std::string &tenant, Tenant &state, const ClusterQuotaOptions &options) const;
+
+        std::atomic<bool> enabled_{false};
+        std::atomic<std::shared_ptr<const ClusterQuotaOptions>> options_{std::make_shared<const ClusterQuotaOptions>()};
+        std::array<Shard, kShardCount> shards_;
+
+        std::mutex peers_mutex_;
+        std::unordered_map<std::string, std::unordered_map<std::string, double>> peers_;///< Last report of each peer
+        std::chrono::steady_clock::time_point last_reconcile_{};
+    };
+
+}// namespace mcp::transport
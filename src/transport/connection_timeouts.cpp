@@ -0,0 +1,203 @@
+#include "connection_timeouts.h"
+#include "metrics/metrics_manager.h"
+#include <algorithm>
+
+namespace mcp::transport {
+
+    namespace {
+        ConnectionTimeoutOptions &options_storage() {
+            static ConnectionTimeoutOptions options;
+            return options;
+        }
+    }// namespace
+
+    void ConnectionTimeoutOptions::configure(const ConnectionTimeoutOptions &options) {
+        options_storage() = options;
+    }
+
+    const ConnectionTimeoutOptions &ConnectionTimeoutOptions::current() {
+        return options_storage();
+    }
+
+    ConnectionDeadline::ConnectionDeadline(const asio::any_io_executor &executor, metrics::ConnectionTimeoutCounters *counters,
+                                           std::function<void()> on_expired)
+        : wheel_(ConnectionTimerWheel::of(executor)),
+          counters_(counters),
+          on_expired_(std::move(on_expired)) {
+    }
+
+    ConnectionDeadline::~ConnectionDeadline() {
+        wheel_.cancel(*this);
+    }
+
+    void ConnectionDeadline::enter(ConnectionPhase phase) {
+        if (phase == phase_ || expired_) {
+            return;
+        }
+        phase_ = phase;
+
+        const auto &options = ConnectionTimeoutOptions::current();
+        size_t timeout_ms = 0;
+        switch (phase) {
+            case ConnectionPhase::Idle:
+                timeout_ms = options.idle_timeout_ms;
+                break;
+            case ConnectionPhase::Header:
+                timeout_ms = options.header_timeout_ms;
+                break;
+            case ConnectionPhase::Body:
+                timeout_ms = options.body_timeout_ms;
+                break;
+            case ConnectionPhase::Handling:
+                break;
+        }
+        if (timeout_ms == 0) {
+            wheel_.cancel(*this);
+        } else {
+            wheel_.schedule(*this, std::chrono::milliseconds(timeout_ms));
+        }
+    }
+
+    void ConnectionDeadline::expire() {
+        expired_ = true;
+        if (counters_) {
+            switch (phase_) {
+                case ConnectionPhase::Idle:
+                    counters_->idle.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                case ConnectionPhase::Header:
+                    counters_->header.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                case ConnectionPhase::Body:
+                    counters_->body.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                case ConnectionPhase::Handling:
+                    break;
+            }
+        }
+        phase_ = ConnectionPhase::Handling;
+        if (on_expired_) {
+            on_expired_();
+        }
+    }
+
+    asio::execution_context::id ConnectionTimerWheel::id;
+
+    ConnectionTimerWheel::ConnectionTimerWheel(asio::execution_context &context)
+        : asio::execution_context::service(context),
+          slots_(kSlots, nullptr) {
+    }
+
+    ConnectionTimerWheel &ConnectionTimerWheel::of(const asio::any_io_executor &executor) {
+        auto &wheel = asio::use_service<ConnectionTimerWheel>(asio::query(executor, asio::execution::context));
+        if (!wheel.timer_) {
+            wheel.timer_.emplace(executor);
+        }
+        return wheel;
+    }
+
+    uint64_t ConnectionTimerWheel::now_tick() const {
+        return static_cast<uint64_t>((std::chrono::steady_clock::now() - epoch_) / kTick);
+    }
+
+    void ConnectionTimerWheel::schedule(ConnectionDeadline &deadline, std::chrono::milliseconds timeout) {
+        cancel(deadline);
+
+        uint64_t now = now_tick();
+        if (!ticking_) {
+            current_tick_ = now;// Nothing was due while the wheel stood still
+        }
+        uint64_t ticks = std::max<uint64_t>(1, static_cast<uint64_t>((timeout + kTick - std::chrono::milliseconds(1)) / kTick));
+        deadline.expiry_tick_ = now + ticks;
+
+        auto &head = slots_[deadline.expiry_tick_ % kSlots];
+        deadline.prev_ = nullptr;
+        deadline.next_ = head;
+        if (head) {
+            head->prev_ = &deadline;
+        }
+        head = &deadline;
+        deadline.scheduled_ = true;
+        ++size_;
+
+        if (!ticking_ && timer_) {
+            ticking_ = true;
+            wait();
+        }
+    }
+
+    void ConnectionTimerWheel::cancel(ConnectionDeadline &deadline) {
+        if (!deadline.scheduled_) {
+            return;
+        }
+        if (deadline.prev_) {
+            deadline.prev_->next_ = deadline.next_;
+        } else {
+            slots_[deadline.expiry_tick_ % kSlots] = deadline.next_;
+        }
+        if (deadline.next_) {
+            deadline.next_->prev_ = deadline.prev_;
+        }
+        deadline.prev_ = nullptr;
+        deadline.next_ = nullptr;
+        deadline.scheduled_ = false;
+        --size_;
+    }
+
+    /**
+     * @brief Expire the deadlines of the slots passed since the last tick.
+     * A stalled thread catches up in one go: at most one turn of the wheel is walked.
+     */
+    void ConnectionTimerWheel::tick() {
+        uint64_t target = now_tick();
+        uint64_t steps = std::min<uint64_t>(target - current_tick_, kSlots);
+
+        std::vector<ConnectionDeadline *> due;
+        for (uint64_t t = target - steps + 1; t <= target; ++t) {
+            for (ConnectionDeadline *deadline = slots_[t % kSlots]; deadline;) {
+                ConnectionDeadline *next = deadline->next_;
+                if (deadline->expiry_tick_ <= target) {
+                    cancel(*deadline);
+                    due.push_back(deadline);
+                }
+                deadline = next;
+            }
+        }
+        current_tick_ = target;
+
+        // Closing a connection does not destroy its deadline right away, the read loop
+        // still has to resume with the error
+        for (ConnectionDeadline *deadline: due) {
+            deadline->expire();
+        }
+
+        if (size_ == 0) {
+            ticking_ = false;// Started again by the next schedule()
+            return;
+        }
+        wait();
+    }
+
+    void ConnectionTimerWheel::wait() {
+        timer_->expires_at(epoch_ + (current_tick_ + 1) * kTick);
+        timer_->async_wait([this](const asio::error_code &ec) {
+            if (ec) {
+                ticking_ = false;
+                return;
+            }
+            tick();
+        });
+    }
+
+    void ConnectionTimerWheel::shutdown() {
+        // Deadlines that outlive the io_context find themselves unscheduled
+        for (auto &head: slots_) {
+            while (head) {
+                cancel(*head);
+            }
+        }
+        timer_.reset();
+        ticking_ = false;
+    }
+
+}// namespace mcp::transport
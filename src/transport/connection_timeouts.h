@@ -0,0 +1,173 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace mcp::metrics {
+    struct ConnectionTimeoutCounters;
+}
+
+namespace mcp::transport {
+
+    /**
+     * @brief Read timeouts of HTTP/1.1 connections, normally taken from the [server] config section.
+     * A timeout of 0 disables it.
+     */
+    struct ConnectionTimeoutOptions {
+        size_t header_timeout_ms = 10000;///< From accepting the connection or the first byte of a request to the end of its headers
+        size_t body_timeout_ms = 30000;  ///< From the end of the headers to the end of the body
+        size_t idle_timeout_ms = 60000;  ///< Keep-alive wait for the next request
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const ConnectionTimeoutOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const ConnectionTimeoutOptions &current();
+    };
+
+    /**
+     * @brief What a connection's read loop is waiting for, which decides its timeout.
+     */
+    enum class ConnectionPhase {
+        Handling,///< A request is being answered (or the connection was taken over), no timeout
+        Idle,    ///< Waiting for the next request on a kept-alive connection
+        Header,  ///< Waiting for the rest of a request's headers
+        Body,    ///< Waiting for the rest of a request's body
+    };
+
+    /**
+     * @brief Phase of a read loop that is about to wait for more of a request.
+     * @param buffered Bytes of the next request received so far
+     * @param headers_complete Whether its headers have been received
+     * @param first_request Nothing was answered on the connection yet; a new connection gets the header timeout
+     */
+    inline ConnectionPhase read_phase(size_t buffered, bool headers_complete, bool first_request) {
+        if (buffered == 0) {
+            return first_request ? ConnectionPhase::Header : ConnectionPhase::Idle;
+        }
+        return headers_complete ? ConnectionPhase::Body : ConnectionPhase::Header;
+    }
+
+    class ConnectionTimerWheel;
+
+    /**
+     * @brief Timeout of one connection, moved along by its read loop.
+     *
+     * A deadline is set when the connection enters a phase and kept while it stays there, so
+     * a client that trickles a byte at a time still runs out of time (slowloris). When it
+     * expires the connection is closed, which fails the pending read. All calls must be made
+     * on the connection's executor.
+     */
+    class ConnectionDeadline {
+    public:
+        /**
+         * @param executor Executor of the connection, its io_context's timer wheel is used
+         * @param counters Timeout counters of the listener, may be nullptr
+         * @param on_expired Closes the connection
+         */
+        ConnectionDeadline(const asio::any_io_executor &executor, metrics::ConnectionTimeoutCounters *counters,
+                           std::function<void()> on_expired);
+        ~ConnectionDeadline();
+
+        ConnectionDeadline(const ConnectionDeadline &) = delete;
+        ConnectionDeadline &operator=(const ConnectionDeadline &) = delete;
+
+        /**
+         * @brief Move to a phase; staying in the same phase keeps the running deadline.
+         * @param phase New phase
+         */
+        void enter(ConnectionPhase phase);
+
+        /**
+         * @brief Whether the connection was closed by this deadline.
+         */
+        bool expired() const { return expired_; }
+
+    private:
+        friend class ConnectionTimerWheel;
+
+        void expire();
+
+        ConnectionTimerWheel &wheel_;
+        metrics::ConnectionTimeoutCounters *counters_;
+        std::function<void()> on_expired_;
+        ConnectionPhase phase_ = ConnectionPhase::Handling;
+        bool expired_ = false;
+
+        // Links of the wheel slot the deadline is in
+        ConnectionDeadline *prev_ = nullptr;
+        ConnectionDeadline *next_ = nullptr;
+        bool scheduled_ = false;
+        uint64_t expiry_tick_ = 0;
+    };
+
+    /**
+     * @brief Hashed timer wheel holding the deadlines of one io_context's connections.
+     *
+     * Setting or moving a deadline relinks it into a slot, without touching a timer. A single
+     * steady_timer per io_context ticks through the slots and only runs while the wheel holds
+     * deadlines. Deadlines further out than one turn of the wheel stay in their slot until the
+     * wheel comes around to their tick. Used from the io_context's thread only.
+     */
+    class ConnectionTimerWheel : public asio::execution_context::service {
+    public:
+        static constexpr size_t kSlots = 512;
+        static constexpr std::chrono::milliseconds kTick{250};///< Resolution of the timeouts
+
+        static asio::execution_context::id id;
+
+        explicit ConnectionTimerWheel(asio::execution_context &context);
+
+        /**
+         * @brief Wheel of the io_context an executor belongs to, created on first use.
+         * @param executor Executor of a connection
+         */
+        static ConnectionTimerWheel &of(const asio::any_io_executor &executor);
+
+        /**
+         * @brief Set a deadline, replacing the one it had.
+         * @param deadline Deadline to set
+         * @param timeout Time from now, rounded up to the next tick
+         */
+        void schedule(ConnectionDeadline &deadline, std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Remove a deadline from the wheel, if it is in it.
+         */
+        void cancel(ConnectionDeadline &deadline);
+
+        /**
+         * @brief Number of deadlines the wheel holds.
+         */
+        size_t size() const { return size_; }
+
+    private:
+        void shutdown() override;
+        uint64_t now_tick() const;
+        void tick();
+        void wait();///< Wait for the next tick
+
+        std::vector<ConnectionDeadline *> slots_;
+        std::optional<asio::steady_timer> timer_;
+        std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+        uint64_t current_tick_ = 0;///< Last tick whose slot was processed
+        size_t size_ = 0;
+        bool ticking_ = false;
+    };
+
+}// namespace mcp::transport
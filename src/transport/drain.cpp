@@ -0,0 +1,148 @@
+#include "drain.h"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include <random>
+#include <string_view>
+#include <thread>
+
+namespace mcp::transport {
+
+    namespace {
+        DrainOptions &drain_storage() {
+            static DrainOptions options;
+            return options;
+        }
+
+        constexpr std::chrono::milliseconds kIdlePollInterval{20};
+    }// namespace
+
+    void DrainOptions::configure(const DrainOptions &options) {
+        drain_storage() = options;
+    }
+
+    const DrainOptions &DrainOptions::current() {
+        return drain_storage();
+    }
+
+    Drain::Registration &Drain::Registration::operator=(Registration &&other) noexcept {
+        if (this != &other) {
+            if (id_ != 0) {
+                Drain::instance().remove(id_);
+            }
+            id_ = std::exchange(other.id_, 0);
+        }
+        return *this;
+    }
+
+    Drain::Registration::~Registration() {
+        if (id_ != 0) {
+            Drain::instance().remove(id_);
+        }
+    }
+
+    Drain &Drain::instance() {
+        static Drain drain;
+        return drain;
+    }
+
+    Drain::Registration Drain::watch(asio::any_io_executor executor, std::function<void()> close) {
+        std::lock_guard lock(mutex_);
+        uint64_t id = next_id_++;
+        auto &watch = watches_[id];
+        watch.executor = std::move(executor);
+        watch.close = std::move(close);
+        if (draining_.load(std::memory_order_relaxed)) {
+            schedule(watch, spread_);
+        }
+        return Registration(id);
+    }
+
+    bool Drain::begin(const DrainOptions &options) {
+        std::lock_guard lock(mutex_);
+        if (draining_.exchange(true)) {
+            return false;
+        }
+        spread_ = options.stream_spread;
+        for (auto &[id, watch]: watches_) {
+            schedule(watch, spread_);
+        }
+        MCP_INFO("Draining: {} requests in flight, {} streams ended over {} ms",
+                 requests_in_flight(), watches_.size(), spread_.count());
+        return true;
+    }
+
+    void Drain::schedule(Watch &watch, std::chrono::milliseconds spread) {
+        static thread_local std::mt19937 random{std::random_device{}()};
+        auto delay = spread.count() > 0 ? std::chrono::milliseconds(std::uniform_int_distribution<int64_t>(0, spread.count())(random))
+                                        : std::chrono::milliseconds(0);
+
+        // The timer is only touched on the stream's executor
+        watch.timer = std::make_shared<asio::steady_timer>(watch.executor, delay);
+        asio::post(watch.executor, [timer = watch.timer, close = watch.close]() {
+            timer->async_wait([timer, close](const asio::error_code &ec) {
+                if (!ec) {
+                    close();
+                }
+            });
+        });
+    }
+
+    void Drain::remove(uint64_t id) {
+        std::lock_guard lock(mutex_);
+        auto it = watches_.find(id);
+        if (it == watches_.end()) {
+            return;
+        }
+        if (auto timer = std::move(it->second.timer)) {
+            asio::post(it->second.executor, [timer]() { timer->cancel(); });
+        }
+        watches_.erase(it);
+    }
+
+    bool Drain::wait_idle(std::chrono::steady_clock::time_point deadline) const {
+        while (requests_in_flight() != 0 || streams() != 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(kIdlePollInterval);
+        }
+        return true;
+    }
+
+    size_t Drain::requests_in_flight() {
+        size_t requests = 0;
+        for (const auto &pool: AsioIOServicePool::Snapshot()) {
+            for (const auto &context: pool.contexts) {
+                requests += context.requests;
+            }
+        }
+        return requests;
+    }
+
+    size_t Drain::streams() const {
+        std::lock_guard lock(mutex_);
+        return watches_.size();
+    }
+
+    void Drain::close_connection(std::string &header) {
+        static constexpr std::string_view keep_alive = "Connection: keep-alive\r\n";
+        static constexpr std::string_view parameters = "Keep-Alive: ";
+        if (auto pos = header.find(keep_alive); pos != std::string::npos) {
+            header.replace(pos, keep_alive.size(), "Connection: close\r\n");
+        } else if (header.find("Connection: close\r\n") == std::string::npos) {
+            // No connection header yet, it goes right after the status line
+            auto status_end = header.find("\r\n");
+            if (status_end == std::string::npos) {
+                return;
+            }
+            header.insert(status_end + 2, "Connection: close\r\n");
+        }
+        if (auto pos = header.find(parameters); pos != std::string::npos) {
+            auto end = header.find("\r\n", pos);
+            if (end != std::string::npos) {
+                header.erase(pos, end + 2 - pos);
+            }
+        }
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,138 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Graceful shutdown, normally taken from the [server] config section.
+     */
+    struct DrainOptions {
+        std::chrono::milliseconds timeout{30000};     ///< Longest wait for in-flight requests and streams
+        std::chrono::milliseconds stream_spread{10000};///< Open streams are ended at random points over this window
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const DrainOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const DrainOptions &current();
+    };
+
+    /**
+     * @brief Connection draining before the process stops, for deploys that replace replicas.
+     *
+     * Once begin() is called, every response tells its client "Connection: close" and its
+     * connection is closed after it, so the next request goes to another replica. Requests being
+     * handled run to completion. Long-lived streams (event streams and streaming tool calls)
+     * register with watch(); draining ends each of them at a random point of stream_spread, so
+     * their clients do not all reconnect elsewhere at the same moment. A streaming tool call ends
+     * after an event it has cached, and is resumed with Last-Event-ID.
+     */
+    class Drain {
+    public:
+        /**
+         * @brief Keeps a stream on the list of what a drain waits for; removes it on destruction.
+         * Destroy it on the executor the stream was watched on.
+         */
+        class Registration {
+        public:
+            Registration() = default;
+            Registration(Registration &&other) noexcept : id_(std::exchange(other.id_, 0)) {}
+            Registration &operator=(Registration &&other) noexcept;
+            ~Registration();
+
+        private:
+            friend class Drain;
+            explicit Registration(uint64_t id) : id_(id) {}
+            uint64_t id_ = 0;
+        };
+
+        static Drain &instance();
+
+        /**
+         * @brief Whether the server is draining. Lock free, cheap enough for every response.
+         */
+        static bool draining() noexcept { return instance().draining_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Have a long-lived stream ended when the server drains.
+         * @param executor Executor the stream runs on; close is called there
+         * @param close Ends the stream, called at most once
+         * @return Registration; if the server is draining already, the stream is ended within stream_spread
+         */
+        Registration watch(asio::any_io_executor executor, std::function<void()> close);
+
+        /**
+         * @brief Start draining: close connections after their response and end the watched streams.
+         * @param options Stream spread
+         * @return false if the server was draining already
+         */
+        bool begin(const DrainOptions &options = DrainOptions::current());
+
+        /**
+         * @brief Wait until no request is handled on any io_context and no stream is watched.
+         * Blocks the calling thread, which must not run an io_context of the server.
+         * @param deadline Latest time to wait until
+         * @return true if everything finished in time
+         */
+        bool wait_idle(std::chrono::steady_clock::time_point deadline) const;
+
+        /**
+         * @brief HTTP requests being handled on all io_contexts.
+         */
+        static size_t requests_in_flight();
+
+        /**
+         * @brief Watched streams that are still open.
+         */
+        size_t streams() const;
+
+        /**
+         * @brief Turn the keep-alive connection header of a response header block into "Connection: close".
+         * @param header Header block, rewritten in place
+         */
+        static void close_connection(std::string &header);
+
+    private:
+        struct Watch {
+            asio::any_io_executor executor;
+            std::function<void()> close;
+            std::shared_ptr<asio::steady_timer> timer;///< Set once the stream's end is scheduled
+        };
+
+        Drain() = default;
+
+        /**
+         * @brief Schedule the end of a stream at a random point of the spread.
+         */
+        void schedule(Watch &watch, std::chrono::milliseconds spread);
+
+        void remove(uint64_t id);
+
+        std::atomic<bool> draining_{false};
+        std::chrono::milliseconds spread_{0};
+        mutable std::mutex mutex_;
+        std::unordered_map<uint64_t, Watch> watches_;
+        uint64_t next_id_ = 1;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,302 @@
+#include "fair_scheduler.h"
+#include "admission_controller.h"
+#include "core/logger.h"
+#include "session.h"
+#include "tenants.h"
+#include <algorithm>
+#include <utility>
+
+namespace mcp::transport {
+
+    namespace {
+        // Tenants named by an API key carry this prefix, so a key never collides with a session id
+        constexpr std::string_view kKeyPrefix = "key:";
+        // Named tenants, see Tenants
+        constexpr std::string_view kNamedPrefix = "tenant:";
+    }// namespace
+
+    FairShareOptions::Tenant FairShareOptions::parse_tenant(std::string_view text) {
+        if (text == "session") {
+            return Tenant::Session;
+        }
+        if (text == "api_key") {
+            return Tenant::ApiKey;
+        }
+        return Tenant::Off;
+    }
+
+    std::unordered_map<std::string, size_t> FairShareOptions::parse_weights(std::string_view text) {
+        // Same "name=number" list as the tool limits
+        return AdmissionOptions::parse_tool_limits(text);
+    }
+
+    FairScheduler::Turn::Turn(Turn &&other) noexcept
+        : scheduler_(std::exchange(other.scheduler_, nullptr)), tenant_(std::move(other.tenant_)) {}
+
+    FairScheduler::Turn &FairScheduler::Turn::operator=(Turn &&other) noexcept {
+        if (this != &other) {
+            release();
+            scheduler_ = std::exchange(other.scheduler_, nullptr);
+            tenant_ = std::move(other.tenant_);
+        }
+        return *this;
+    }
+
+    void FairScheduler::Turn::release() noexcept {
+        if (scheduler_) {
+            std::exchange(scheduler_, nullptr)->leave(tenant_);
+        }
+    }
+
+    FairScheduler &FairScheduler::getInstance() {
+        static FairScheduler instance;
+        return instance;
+    }
+
+    void FairScheduler::configure(const FairShareOptions &options, size_t pool_size) {
+        std::vector<std::shared_ptr<Waiter>> granted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Caps taken off or changed show in the tenants' gauges at once
+            auto manager = metrics::MetricsManager::getInstance();
+            for (const auto &[name, slots]: options_.tenant_slots) {
+                if (!options.tenant_slots.contains(name)) {
+                    manager->register_tenant_counters(name)->slots.store(0, std::memory_order_relaxed);
+                }
+            }
+            for (const auto &[name, slots]: options.tenant_slots) {
+                manager->register_tenant_counters(name)->slots.store(static_cast<int64_t>(slots), std::memory_order_relaxed);
+            }
+            options_ = options;
+            slots_ = std::max<size_t>(1, options.slots != 0 ? options.slots : pool_size);
+            enabled_.store(options.tenant != FairShareOptions::Tenant::Off, std::memory_order_relaxed);
+            // More slots, or fair sharing turned off, lets waiting calls through
+            if (!enabled()) {
+                slots_ = static_cast<size_t>(-1);
+            }
+            granted = dispatch();
+        }
+        for (auto &next: granted) {
+            asio::post(next->timer.get_executor(), [next]() { next->timer.cancel(); });
+        }
+
+        if (enabled()) {
+            MCP_INFO("Fair tool scheduling per {}: {} slots, {} weighted and {} capped tenants, queue {} for up to {} ms",
+                     options.tenant == FairShareOptions::Tenant::ApiKey ? "API key" : "session",
+                     slots_, options.weights.size(), options.tenant_slots.size(), options.max_queue, options.queue_timeout.count());
+        }
+    }
+
+    std::string FairScheduler::tenant_of(const Session &session) const {
+        if (auto name = Tenants::instance().name_of(session.get_headers(), &session.auth_decision()); !name.empty()) {
+            std::string tenant(kNamedPrefix);
+            tenant += name;
+            return tenant;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (options_.tenant == FairShareOptions::Tenant::ApiKey) {
+            auto key = session.get_headers().get("X-API-Key");
+            if (!key.empty()) {
+                std::string tenant(kKeyPrefix);
+                tenant += key;
+                return tenant;
+            }
+        }
+        return session.client_session_id();
+    }
+
+    size_t FairScheduler::weight(const std::string &tenant) const {
+        std::string_view name = tenant;
+        if (name.starts_with(kKeyPrefix)) {
+            name.remove_prefix(kKeyPrefix.size());
+        } else if (name.starts_with(kNamedPrefix)) {
+            name.remove_prefix(kNamedPrefix.size());
+        }
+        auto it = options_.weights.find(std::string(name));
+        return it != options_.weights.end() ? it->second : 1;
+    }
+
+    size_t FairScheduler::cap(const std::string &tenant) const {
+        if (!tenant.starts_with(kNamedPrefix)) {
+            return 0;
+        }
+        auto it = options_.tenant_slots.find(tenant.substr(kNamedPrefix.size()));
+        return it != options_.tenant_slots.end() ? it->second : 0;
+    }
+
+    FairScheduler::Tenant &FairScheduler::tenant_entry(const std::string &name) {
+        auto [it, inserted] = tenants_.try_emplace(name);
+        if (inserted && name.starts_with(kNamedPrefix)) {
+            it->second.counters = metrics::MetricsManager::getInstance()->register_tenant_counters(name.substr(kNamedPrefix.size()));
+        }
+        return it->second;
+    }
+
+    std::vector<std::shared_ptr<FairScheduler::Waiter>> FairScheduler::dispatch() {
+        std::vector<std::shared_ptr<Waiter>> granted;
+        size_t skipped = 0;
+        while (in_flight_ < slots_ && skipped < round_.size()) {
+            const std::string &name = round_.front();
+            Tenant &tenant = tenants_[name];
+            // A tenant at its cap waits for one of its own calls to finish, the others go ahead
+            if (size_t limit = cap(name); limit != 0 && tenant.running >= limit) {
+                round_.splice(round_.end(), round_, round_.begin());
+                ++skipped;
+                continue;
+            }
+            skipped = 0;
+
+            // A tenant arriving at the front gets its weight in calls for this round
+            if (tenant.deficit == 0) {
+                tenant.deficit = weight(name);
+            }
+
+            auto next = std::move(tenant.waiters.front());
+            tenant.waiters.pop_front();
+            next->granted = true;
+            granted.push_back(std::move(next));
+            --tenant.deficit;
+            ++tenant.running;
+            ++tenant.dispatched;
+            ++in_flight_;
+            if (tenant.counters) {
+                tenant.counters->queued.fetch_sub(1, std::memory_order_relaxed);
+                tenant.counters->running.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            if (tenant.waiters.empty()) {
+                // Leaves the round; it starts a fresh one when it queues again
+                tenant.active = false;
+                tenant.deficit = 0;
+                round_.pop_front();
+            } else if (tenant.deficit == 0) {
+                round_.splice(round_.end(), round_, round_.begin());
+            }
+        }
+        return granted;
+    }
+
+    asio::awaitable<FairScheduler::Turn> FairScheduler::acquire(std::string name) {
+        auto executor = co_await asio::this_coro::executor;
+        std::shared_ptr<Waiter> waiter;
+        std::vector<std::shared_ptr<Waiter>> granted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Tenant &tenant = tenant_entry(name);
+            // A free slot nobody else waits for is taken at once, unless the tenant is at its cap
+            size_t limit = cap(name);
+            if (in_flight_ < slots_ && round_.empty() && (limit == 0 || tenant.running < limit)) {
+                ++in_flight_;
+                ++tenant.running;
+                ++tenant.dispatched;
+                if (tenant.counters) {
+                    tenant.counters->running.fetch_add(1, std::memory_order_relaxed);
+                }
+                Turn turn;
+                turn.scheduler_ = this;
+                turn.tenant_ = std::move(name);
+                co_return turn;
+            }
+            if (tenant.waiters.size() >= options_.max_queue) {
+                MCP_WARN("Fair scheduling queue of a tenant is full ({} waiting, {} running)", tenant.waiters.size(), tenant.running);
+                if (tenant.counters) {
+                    tenant.counters->rejected.fetch_add(1, std::memory_order_relaxed);
+                }
+                co_return Turn{};
+            }
+            waiter = std::make_shared<Waiter>(executor);
+            waiter->timer.expires_after(options_.queue_timeout);
+            tenant.waiters.push_back(waiter);
+            if (tenant.counters) {
+                tenant.counters->queued.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!tenant.active) {
+                tenant.active = true;
+                round_.push_back(name);
+            }
+            // Queued behind a cap, free slots go to the other tenants meanwhile
+            granted = dispatch();
+        }
+        bool turn_now = false;
+        for (auto &next: granted) {
+            if (next == waiter) {
+                turn_now = true;
+            } else {
+                asio::post(next->timer.get_executor(), [next]() { next->timer.cancel(); });
+            }
+        }
+
+        // Woken either by the deadline or by dispatch() cancelling the timer
+        if (!turn_now) {
+            asio::error_code ec;
+            co_await waiter->timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (waiter->granted) {
+            Turn turn;
+            turn.scheduler_ = this;
+            turn.tenant_ = std::move(name);
+            co_return turn;
+        }
+        Tenant &tenant = tenants_[name];
+        tenant.waiters.erase(std::find(tenant.waiters.begin(), tenant.waiters.end(), waiter));
+        if (tenant.waiters.empty() && tenant.active) {
+            tenant.active = false;
+            tenant.deficit = 0;
+            round_.erase(std::find(round_.begin(), round_.end(), name));
+        }
+        if (tenant.counters) {
+            tenant.counters->queued.fetch_sub(1, std::memory_order_relaxed);
+            tenant.counters->rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        MCP_WARN("Timed out waiting for a fair scheduling turn ({} waiting, {} running)", tenant.waiters.size(), tenant.running);
+        forget_if_idle(name);
+        co_return Turn{};
+    }
+
+    void FairScheduler::leave(const std::string &name) {
+        std::vector<std::shared_ptr<Waiter>> granted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --in_flight_;
+            Tenant &tenant = tenants_[name];
+            --tenant.running;
+            if (tenant.counters) {
+                tenant.counters->running.fetch_sub(1, std::memory_order_relaxed);
+            }
+            forget_if_idle(name);
+            granted = dispatch();
+        }
+        // Timers are not thread safe; cancel on the waiter's own executor
+        for (auto &next: granted) {
+            asio::post(next->timer.get_executor(), [next]() { next->timer.cancel(); });
+        }
+    }
+
+    void FairScheduler::forget_if_idle(const std::string &name) {
+        auto it = tenants_.find(name);
+        if (it != tenants_.end() && it->second.running == 0 && it->second.waiters.empty()) {
+            tenants_.erase(it);
+        }
+    }
+
+    std::vector<FairShareStats> FairScheduler::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<FairShareStats> result;
+        result.reserve(tenants_.size());
+        for (const auto &[name, tenant]: tenants_) {
+            FairShareStats stats;
+            // API keys are credentials, only enough of one is shown to tell tenants apart
+            stats.tenant = name.starts_with(kKeyPrefix) ? name.substr(0, kKeyPrefix.size() + 4) + "..." : name;
+            stats.weight = weight(name);
+            stats.slots = cap(name);
+            stats.running = tenant.running;
+            stats.queued = tenant.waiters.size();
+            stats.dispatched = tenant.dispatched;
+            result.push_back(std::move(stats));
+        }
+        return result;
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,185 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "metrics/metrics_manager.h"
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::transport {
+
+    class Session;
+
+    /**
+     * @brief Fair sharing of the tool pool between clients, normally taken from the [concurrency] config section.
+     */
+    struct FairShareOptions {
+        enum class Tenant {
+            Off,    ///< Calls reach the tool pool in arrival order
+            Session,///< One share per MCP session
+            ApiKey, ///< One share per X-API-Key, the session for requests without one
+        };
+
+        Tenant tenant = Tenant::Off;
+        size_t slots = 0;                                    ///< Calls handed to the tool pool at once, 0 = the workers it may grow to
+        std::unordered_map<std::string, size_t> weights;     ///< Calls a tenant gets per round, 1 for tenants not listed
+        std::unordered_map<std::string, size_t> tenant_slots;///< Named tenant -> its calls on the tool pool at once, no cap for tenants not listed
+        size_t max_queue = 64;                          ///< Calls waiting per tenant before new ones are rejected
+        std::chrono::milliseconds queue_timeout{5000};  ///< Longest time a call waits for its turn
+
+        bool operator==(const FairShareOptions &) const = default;
+
+        /**
+         * @brief Parse "off", "session" or "api_key"; anything else is off.
+         */
+        static Tenant parse_tenant(std::string_view text);
+
+        /**
+         * @brief Parse a weight list such as "key-of-batch-jobs=1,key-of-the-ide=4".
+         * @param text Weight list, empty for none
+         * @return Tenant mapped to its weight
+         */
+        static std::unordered_map<std::string, size_t> parse_weights(std::string_view text);
+    };
+
+    /**
+     * @brief Queue depth of one tenant, for /admin/stats.
+     */
+    struct FairShareStats {
+        std::string tenant;     ///< Named tenant, session id, or the first characters of the API key
+        size_t weight = 1;      ///< Calls per round
+        size_t slots = 0;       ///< Calls it may have on the tool pool at once, 0 = no cap
+        size_t running = 0;     ///< Calls on the tool pool
+        size_t queued = 0;      ///< Calls waiting for their turn
+        uint64_t dispatched = 0;///< Calls handed to the tool pool since the tenant was last idle
+    };
+
+    /**
+     * @brief Weighted fair queuing of tool calls in front of the tool pool, by deficit round robin.
+     *
+     * The pool's io_context runs what it is given in arrival order, so a client that fires a
+     * hundred calls at once delays every other client's calls behind them. With fair sharing on,
+     * only `slots` calls are on the pool at a time; the rest wait here in a queue per tenant
+     * (suspended, like calls waiting for admission), and each slot that frees goes to the next
+     * tenant in round robin. A tenant visited in its turn gets as many calls through as its
+     * weight before the next one is visited, so a tenant of weight 4 gets four times the share of
+     * the pool of one of weight 1 while both have calls waiting; an idle tenant costs nothing.
+     * A named tenant (see Tenants) can also be capped to a number of slots, a partition of the
+     * pool it never grows beyond even while the pool is idle; its turns are skipped while it is
+     * at the cap.
+     * Control-plane calls bypass the scheduler, they have threads of their own.
+     */
+    class FairScheduler {
+    public:
+        /**
+         * @brief A tool pool slot held by a call, given back on destruction.
+         */
+        class Turn {
+        public:
+            Turn() = default;
+            Turn(Turn &&other) noexcept;
+            Turn &operator=(Turn &&other) noexcept;
+            ~Turn() { release(); }
+
+            /**
+             * @brief Whether the call got its turn.
+             */
+            explicit operator bool() const noexcept { return scheduler_ != nullptr; }
+
+            /**
+             * @brief Give the slot back early.
+             */
+            void release() noexcept;
+
+        private:
+            friend class FairScheduler;
+
+            FairScheduler *scheduler_ = nullptr;
+            std::string tenant_;
+        };
+
+        static FairScheduler &getInstance();
+
+        /**
+         * @brief Set the options, at startup or on a config reload. Waiting calls keep their place.
+         * @param options Fair share options
+         * @param pool_size Workers the tool pool may grow to, the slots when options.slots is 0
+         */
+        void configure(const FairShareOptions &options, size_t pool_size);
+
+        /**
+         * @brief Whether calls go through the scheduler at all.
+         */
+        bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief The tenant a session's calls are accounted to: its named tenant if its credential
+         *        has one, else the session or API key, as configured.
+         */
+        std::string tenant_of(const Session &session) const;
+
+        /**
+         * @brief Wait for the turn of a call of the given tenant.
+         * Must be awaited on the io_context that runs the calling session.
+         * @param tenant Tenant, see tenant_of()
+         * @return Turn; false if the tenant's queue was full or the timeout passed
+         */
+        asio::awaitable<Turn> acquire(std::string tenant);
+
+        /**
+         * @brief Queue depths of the tenants with calls running or waiting.
+         */
+        std::vector<FairShareStats> stats() const;
+
+    private:
+        FairScheduler() = default;
+
+        struct Waiter {
+            explicit Waiter(const asio::any_io_executor &executor) : timer(executor) {}
+            asio::steady_timer timer;///< Expires at the deadline, cancelled when the turn is handed over
+            bool granted = false;    ///< Set under the mutex when the turn is handed over
+        };
+
+        struct Tenant {
+            size_t deficit = 0;///< Calls left in the current round, topped up by the weight on each visit
+            size_t running = 0;
+            bool active = false;///< In the round robin, i.e. has waiters
+            uint64_t dispatched = 0;
+            std::deque<std::shared_ptr<Waiter>> waiters;
+            std::shared_ptr<metrics::TenantCounters> counters;///< Usage of a named tenant, null for the others
+        };
+
+        /**
+         * @brief Hand free slots to waiters in deficit round robin order. Call with the mutex held.
+         * @return Waiters to wake once the mutex is released
+         */
+        std::vector<std::shared_ptr<Waiter>> dispatch();
+
+        void leave(const std::string &tenant);
+        void forget_if_idle(const std::string &tenant);
+        size_t weight(const std::string &tenant) const;
+        size_t cap(const std::string &tenant) const;
+        Tenant &tenant_entry(const std::string &tenant);
+
+        mutable std::mutex mutex_;
+        std::atomic<bool> enabled_{false};
+        FairShareOptions options_;
+        size_t slots_ = 0;
+        size_t in_flight_ = 0;
+        std::unordered_map<std::string, Tenant> tenants_;
+        std::list<std::string> round_;///< Active tenants, the one being served in front
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Hash of a header name that ignores ASCII case (FNV-1a over the lowercased bytes).
+     * constexpr, so a name given as a literal is hashed while compiling.
+     */
+    constexpr uint32_t header_hash(std::string_view name) noexcept {
+        uint32_t hash = 2166136261u;
+        for (char c: name) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Headers of a request as a flat list, looked up by name without regard to case.
+     *
+     * A request has a few dozen headers at most, so a scan over precomputed name hashes beats a hash
+     * table. clear() keeps the entries and their strings, so a session that refills the map for every
+     * request on its connection reuses the same storage instead of allocating a copy each time.
+     * Iterates as (name, value) pairs like the map it replaces.
+     */
+    class HeaderMap {
+    public:
+        using value_type = std::pair<std::string, std::string>;
+        using const_iterator = std::vector<value_type>::const_iterator;
+        using iterator = const_iterator;
+
+        HeaderMap() = default;
+        HeaderMap(std::initializer_list<value_type> headers) {
+            for (const auto &[name, value]: headers) {
+                emplace(name, value);
+            }
+        }
+
+        /**
+         * @brief Add a header; a repeated name keeps its first value, as the map did.
+         */
+        void emplace(std::string_view name, std::string_view value) {
+            uint32_t hash = header_hash(name);
+            if (find(name, hash) != end()) {
+                return;
+            }
+            if (size_ == entries_.size()) {
+                entries_.emplace_back();
+                hashes_.emplace_back();
+            }
+            entries_[size_].first.assign(name);
+            entries_[size_].second.assign(value);
+            hashes_[size_] = hash;
+            ++size_;
+        }
+
+        const_iterator find(std::string_view name) const noexcept { return find(name, header_hash(name)); }
+
+        const_iterator find(std::string_view name, uint32_t hash) const noexcept {
+            for (size_t i = 0; i < size_; ++i) {
+                if (hashes_[i] == hash && iequal(entries_[i].first, name)) {
+                    return entries_.begin() + static_cast<std::ptrdiff_t>(i);
+                }
+            }
+            return end();
+        }
+
+        /**
+         * @brief Value of a header, empty if it is missing.
+         */
+        std::string_view get(std::string_view name) const noexcept {
+            auto it = find(name);
+            return it == end() ? std::string_view{} : std::string_view(it->second);
+        }
+
+        size_t count(std::string_view name) const noexcept { return find(name) != end() ? 1 : 0; }
+        bool contains(std::string_view name) const noexcept { return find(name) != end(); }
+
+        const std::string &at(std::string_view name) const {
+            auto it = find(name);
+            if (it == end()) {
+                throw std::out_of_range("no such header");
+            }
+            return it->second;
+        }
+
+        const_iterator begin() const noexcept { return entries_.begin(); }
+        const_iterator end() const noexcept { return entries_.begin() + static_cast<std::ptrdiff_t>(size_); }
+        size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+        void reserve(size_t count) {
+            entries_.reserve(count);
+            hashes_.reserve(count);
+        }
+
+        /**
+         * @brief Forget the headers, keeping their storage for the next request.
+         */
+        void clear() noexcept { size_ = 0; }
+
+    private:
+        static bool iequal(std::string_view a, std::string_view b) noexcept {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.size(); ++i) {
+                char x = a[i], y = b[i];
+                if (x != y && ((x | 0x20) != (y | 0x20) || (x | 0x20) < 'a' || (x | 0x20) > 'z')) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::vector<value_type> entries_;///< The first size_ are in use
+        std::vector<uint32_t> hashes_;   ///< header_hash of each entry's name
+        size_t size_ = 0;
+    };
+
+}// namespace mcp::transport
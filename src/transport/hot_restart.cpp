@@ -0,0 +1,492 @@
+#include "hot_restart.h"
+#include "core/logger.h"
+#include "core/startup_timeline.h"
+#include "mcp_cache.h"
+#include <nlohmann/json.hpp>
+#include <cstring>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace mcp::transport {
+
+    namespace {
+        HotRestartOptions &hot_restart_storage() {
+            static HotRestartOptions options;
+            return options;
+        }
+
+        constexpr std::chrono::milliseconds kHandshakeTimeout{5000};
+        constexpr std::chrono::milliseconds kPollInterval{200};
+        constexpr size_t kMaxListeners = 64;
+#if defined(MSG_CMSG_CLOEXEC)
+        constexpr int kReceiveFlags = MSG_CMSG_CLOEXEC;
+#else
+        constexpr int kReceiveFlags = 0;
+#endif
+
+#if !defined(_WIN32)
+        /// Whether the process connected on fd runs as our own user, the only one a handoff may go to
+        bool same_user(int fd) {
+#if defined(SO_PEERCRED)
+            struct ucred credentials{};
+            socklen_t size = sizeof(credentials);
+            return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == ::geteuid();
+#else
+            uid_t uid = 0;
+            gid_t gid = 0;
+            return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::geteuid();
+#endif
+        }
+#endif
+    }// namespace
+
+    void HotRestartOptions::configure(const HotRestartOptions &options) {
+        hot_restart_storage() = options;
+    }
+
+    const HotRestartOptions &HotRestartOptions::current() {
+        return hot_restart_storage();
+    }
+
+    std::string HotRestart::tcp_key(const asio::ip::tcp::endpoint &endpoint) {
+        return "tcp:" + endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+    }
+
+    std::string HotRestart::unix_key(const std::string &path) {
+        return "unix:" + path;
+    }
+
+    HotRestart &HotRestart::instance() {
+        static HotRestart hot_restart;
+        return hot_restart;
+    }
+
+#if !defined(_WIN32)
+    /**
+     * @brief One handoff connection carrying newline-delimited JSON messages.
+     */
+    class HotRestart::Channel {
+    public:
+        explicit Channel(int fd) : fd_(fd) {}
+        ~Channel() { ::close(fd_); }
+        Channel(const Channel &) = delete;
+        Channel &operator=(const Channel &) = delete;
+
+        bool send(const nlohmann::json &message, const std::vector<int> &fds = {}) {
+            std::string line = message.dump() + "\n";
+            std::string_view rest = line;
+            if (!fds.empty()) {
+                // The descriptors ride on the first bytes of the message
+                std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+                iovec iov{const_cast<char *>(rest.data()), rest.size()};
+                msghdr msg{};
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control.data();
+                msg.msg_controllen = control.size();
+                cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = SOL_SOCKET;
+                cmsg->cmsg_type = SCM_RIGHTS;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+                std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+                ssize_t sent;
+                do {
+                    sent = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+                } while (sent < 0 && errno == EINTR);
+                if (sent <= 0) {
+                    return false;
+                }
+                rest.remove_prefix(static_cast<size_t>(sent));
+            }
+            while (!rest.empty()) {
+                ssize_t sent = ::send(fd_, rest.data(), rest.size(), MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (sent <= 0) {
+                    return false;
+                }
+                rest.remove_prefix(static_cast<size_t>(sent));
+            }
+            return true;
+        }
+
+        /**
+         * @brief Read the next message, keeping descriptors that come with it.
+         * @param timeout Longest wait, zero for none
+         * @param running Reading gives up when it turns false
+         * @return Message, nullopt on timeout, close or garbage
+         */
+        std::optional<nlohmann::json> receive(std::chrono::milliseconds timeout, const std::atomic<bool> &running) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (true) {
+                if (auto end = pending_.find('\n'); end != std::string::npos) {
+                    auto message = nlohmann::json::parse(std::string_view(pending_).substr(0, end), nullptr, false);
+                    pending_.erase(0, end + 1);
+                    if (message.is_discarded() || !message.is_object()) {
+                        return std::nullopt;
+                    }
+                    return message;
+                }
+                if (!running.load(std::memory_order_relaxed) ||
+                    (timeout.count() > 0 && std::chrono::steady_clock::now() >= deadline)) {
+                    return std::nullopt;
+                }
+
+                pollfd readable{fd_, POLLIN, 0};
+                int ready = ::poll(&readable, 1, static_cast<int>(kPollInterval.count()));
+                if (ready < 0 && errno != EINTR) {
+                    return std::nullopt;
+                }
+                if (ready <= 0) {
+                    continue;
+                }
+
+                char buffer[65536];
+                std::vector<char> control(CMSG_SPACE(sizeof(int) * kMaxListeners));
+                iovec iov{buffer, sizeof(buffer)};
+                msghdr msg{};
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control.data();
+                msg.msg_controllen = control.size();
+                ssize_t received = ::recvmsg(fd_, &msg, kReceiveFlags);
+                if (received < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (received <= 0) {
+                    return std::nullopt;
+                }
+                for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                        size_t first = fds_.size();
+                        fds_.resize(first + count);
+                        std::memcpy(fds_.data() + first, CMSG_DATA(cmsg), sizeof(int) * count);
+                    }
+                }
+                pending_.append(buffer, static_cast<size_t>(received));
+            }
+        }
+
+        /**
+         * @brief Descriptors received so far, handed to the caller.
+         */
+        std::vector<int> take_fds() { return std::exchange(fds_, {}); }
+
+    private:
+        int fd_;
+        std::string pending_;
+        std::vector<int> fds_;
+    };
+
+    namespace {
+        nlohmann::json session_message(const cache::SessionExport &session) {
+            nlohmann::json events = nlohmann::json::array();
+            for (const auto &[event_id, data]: session.events) {
+                events.push_back({event_id, data});
+            }
+            return {{"type", "session"}, {"state", session.state.to_json()}, {"events", std::move(events)}};
+        }
+
+        std::optional<sockaddr_un> socket_address(const std::string &path) {
+            sockaddr_un address{};
+            if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+                return std::nullopt;
+            }
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, path.data(), path.size());
+            return address;
+        }
+    }// namespace
+
+    bool HotRestart::take_over(const HotRestartOptions &options) {
+        options_ = options;
+        auto address = socket_address(options_.socket_path);
+        if (!address) {
+            if (!options_.socket_path.empty()) {
+                MCP_WARN("Hot restart disabled: invalid socket path {}", options_.socket_path);
+                options_.socket_path.clear();
+            }
+            return false;
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&*address), sizeof(*address)) != 0) {
+            ::close(fd);
+            MCP_DEBUG("No server to take over on {}", options_.socket_path);
+            return false;
+        }
+
+        auto channel = std::make_unique<Channel>(fd);
+        std::atomic<bool> waiting{true};
+        if (!channel->send({{"type", "hello"}, {"pid", ::getpid()}})) {
+            MCP_WARN("Hot restart: handoff socket {} closed, starting on our own", options_.socket_path);
+            return false;
+        }
+        auto listeners = channel->receive(kHandshakeTimeout, waiting);
+        auto fds = channel->take_fds();
+        if (!listeners || listeners->value("type", "") != "listeners" || !listeners->contains("keys") ||
+            !(*listeners)["keys"].is_array() || (*listeners)["keys"].size() != fds.size()) {
+            for (int received: fds) {
+                ::close(received);
+            }
+            MCP_WARN("Hot restart: no listeners received on {}, starting on our own", options_.socket_path);
+            return false;
+        }
+
+        std::lock_guard lock(mutex_);
+        for (size_t i = 0; i < fds.size(); ++i) {
+            inherited_[(*listeners)["keys"][i].get<std::string>()].push_back(fds[i]);
+        }
+        predecessor_ = std::move(channel);
+        MCP_INFO("Hot restart: took over {} listening sockets from process {}", fds.size(), listeners->value("pid", 0));
+        return true;
+    }
+
+    std::optional<int> HotRestart::inherit(const std::string &key) {
+        std::lock_guard lock(mutex_);
+        auto it = inherited_.find(key);
+        if (it == inherited_.end() || it->second.empty()) {
+            return std::nullopt;
+        }
+        int fd = it->second.back();
+        it->second.pop_back();
+        return fd;
+    }
+
+    void HotRestart::share(const std::string &key, int fd) {
+        std::lock_guard lock(mutex_);
+        shared_.emplace_back(key, fd);
+    }
+
+    void HotRestart::unshare(int fd) {
+        std::lock_guard lock(mutex_);
+        std::erase_if(shared_, [fd](const auto &entry) { return entry.second == fd; });
+    }
+
+    void HotRestart::start(std::function<void()> drain) {
+        if (options_.socket_path.empty()) {
+            return;
+        }
+        drain_ = std::move(drain);
+        {
+            // Sockets of listeners this process no longer has, e.g. after a config change
+            std::lock_guard lock(mutex_);
+            for (auto &[key, fds]: inherited_) {
+                for (int fd: fds) {
+                    MCP_WARN("Hot restart: closing inherited socket {} that no transport adopted", key);
+                    ::close(fd);
+                }
+            }
+            inherited_.clear();
+        }
+
+        running_ = true;
+        thread_ = std::thread([this]() {
+            if (predecessor_) {
+                import_sessions(*predecessor_);
+                predecessor_.reset();
+            }
+            if (open_listener()) {
+                serve();
+            }
+        });
+    }
+
+    void HotRestart::import_sessions(Channel &channel) {
+        // The previous process serves the tools until this one has them all registered
+        while (running_ && !core::StartupTimeline::instance().ready()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        if (!channel.send({{"type", "ready"}})) {
+            MCP_WARN("Hot restart: previous process went away before its sessions were handed over");
+            return;
+        }
+
+        auto *cache = cache::McpCache::GetInstance();
+        size_t imported = 0;
+        while (auto message = channel.receive(std::chrono::milliseconds(0), running_)) {
+            auto type = message->value("type", "");
+            if (type == "done") {
+                MCP_INFO("Hot restart: previous process has drained, {} sessions handed over", imported);
+                return;
+            }
+            if (type != "session") {
+                continue;
+            }
+            try {
+                cache::SessionExport session;
+                session.state = cache::SessionState::from_json(message->at("state"));
+                for (const auto &event: message->at("events")) {
+                    session.events.emplace_back(event.at(0).get<int>(), event.at(1).get<std::string>());
+                }
+                if (cache->ImportSession(session)) {
+                    ++imported;
+                }
+            } catch (const std::exception &e) {
+                MCP_WARN("Hot restart: skipping a malformed session: {}", e.what());
+            }
+        }
+        MCP_WARN("Hot restart: previous process went away after handing over {} sessions", imported);
+    }
+
+    bool HotRestart::open_listener() {
+        auto address = socket_address(options_.socket_path);
+        listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener_ < 0) {
+            MCP_ERROR("Hot restart: cannot create socket: {}", std::strerror(errno));
+            return false;
+        }
+        // The path may still point at the process taken over, which does not need it any more
+        ::unlink(options_.socket_path.c_str());
+        // Whoever connects gets our listening sockets and sessions, so only our own user may
+        if (::bind(listener_, reinterpret_cast<const sockaddr *>(&*address), sizeof(*address)) != 0 ||
+            ::chmod(options_.socket_path.c_str(), 0600) != 0 || ::listen(listener_, 1) != 0) {
+            MCP_ERROR("Hot restart: cannot listen on {}: {}", options_.socket_path, std::strerror(errno));
+            ::close(listener_);
+            listener_ = -1;
+            return false;
+        }
+        MCP_INFO("Hot restart: a new process started with hot_restart_socket={} takes over", options_.socket_path);
+        return true;
+    }
+
+    void HotRestart::serve() {
+        while (running_) {
+            pollfd readable{listener_, POLLIN, 0};
+            if (::poll(&readable, 1, static_cast<int>(kPollInterval.count())) <= 0) {
+                continue;
+            }
+            int fd = ::accept(listener_, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            if (!same_user(fd)) {
+                MCP_WARN("Hot restart: ignoring a connection from another user");
+                ::close(fd);
+                continue;
+            }
+            Channel channel(fd);
+            if (hand_off(channel)) {
+                return;
+            }
+        }
+    }
+
+    bool HotRestart::hand_off(Channel &channel) {
+        auto hello = channel.receive(kHandshakeTimeout, running_);
+        if (!hello || hello->value("type", "") != "hello") {
+            MCP_WARN("Hot restart: ignoring a connection that did not say hello");
+            return false;
+        }
+        auto pid = hello->value("pid", 0);
+        MCP_INFO("Hot restart: process {} is taking over", pid);
+
+        // The successor opens the persistence directory next, only one process may write it
+        auto *cache = cache::McpCache::GetInstance();
+        cache->DetachBackend();
+
+        nlohmann::json keys = nlohmann::json::array();
+        std::vector<int> fds;
+        {
+            std::lock_guard lock(mutex_);
+            for (const auto &[key, fd]: shared_) {
+                keys.push_back(key);
+                fds.push_back(fd);
+            }
+        }
+        if (fds.size() > kMaxListeners) {
+            MCP_ERROR("Hot restart: {} listening sockets are more than the {} a handoff carries", fds.size(), kMaxListeners);
+            return false;
+        }
+        nlohmann::json listeners = {{"type", "listeners"}, {"pid", ::getpid()}, {"keys", std::move(keys)}};
+        if (!channel.send(listeners, fds)) {
+            MCP_ERROR("Hot restart: sending the listening sockets to process {} failed, cache persistence stays off", pid);
+            return false;
+        }
+
+        auto ready = channel.receive(options_.ready_timeout, running_);
+        if (!ready || ready->value("type", "") != "ready") {
+            MCP_ERROR("Hot restart: process {} did not start, serving on without cache persistence", pid);
+            return false;
+        }
+
+        handed_over_ = true;
+        auto sessions = cache->ExportSessions();
+        for (const auto &session: sessions) {
+            channel.send(session_message(session));
+        }
+        MCP_INFO("Hot restart: process {} is serving, {} sessions handed over, draining", pid, sessions.size());
+        {
+            std::lock_guard lock(mutex_);
+            successor_ = &channel;
+        }
+        drain_();
+        {
+            std::lock_guard lock(mutex_);
+            successor_ = nullptr;
+        }
+        channel.send({{"type", "done"}});
+        return true;
+    }
+
+    void HotRestart::hand_over(const std::string &session_id) {
+        std::lock_guard lock(mutex_);
+        if (!successor_) {
+            return;
+        }
+        if (auto session = cache::McpCache::GetInstance()->ExportSession(session_id)) {
+            successor_->send(session_message(*session));
+        }
+    }
+
+    void HotRestart::stop() {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (listener_ >= 0) {
+            ::close(listener_);
+            listener_ = -1;
+            // After a handoff the path names the successor's socket
+            if (!handed_over_) {
+                ::unlink(options_.socket_path.c_str());
+            }
+        }
+    }
+#else
+    class HotRestart::Channel {};
+
+    bool HotRestart::take_over(const HotRestartOptions &options) {
+        options_ = options;
+        if (!options_.socket_path.empty()) {
+            MCP_WARN("Hot restart is not supported on this platform");
+            options_.socket_path.clear();
+        }
+        return false;
+    }
+
+    std::optional<int> HotRestart::inherit(const std::string &) {
+        return std::nullopt;
+    }
+
+    void HotRestart::share(const std::string &, int) {}
+    void HotRestart::unshare(int) {}
+    void HotRestart::start(std::function<void()>) {}
+    void HotRestart::hand_over(const std::string &) {}
+    void HotRestart::stop() {}
+#endif
+
+}// namespace mcp::transport
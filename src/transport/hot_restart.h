@@ -0,0 +1,139 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Hot restart, normally taken from the [server] config section.
+     */
+    struct HotRestartOptions {
+        std::string socket_path;                        ///< Unix socket the handoff runs over, empty = hot restart off
+        std::chrono::milliseconds ready_timeout{60000};///< Longest the running server waits for its successor to start serving
+
+        /**
+         * @brief Set the process-wide options. Call before take_over().
+         * @param options New options
+         */
+        static void configure(const HotRestartOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const HotRestartOptions &current();
+    };
+
+    /**
+     * @brief Upgrades without refused connections: a new process takes the listening sockets
+     *        and the reconnect cache of the running one over.
+     *
+     * The running server listens on socket_path. A new process started with the same path
+     * connects to it before it opens any listener and receives the listening sockets with
+     * SCM_RIGHTS, each named by its endpoint; the transports adopt them instead of binding. Both
+     * processes now accept from the same sockets, so a connection is never refused. Once the new
+     * process is built it reports ready, is sent every cached session and the old process drains:
+     * each stream the drain ends has its session sent again with its latest events, so the client
+     * resumes it on the new process with Last-Event-ID. The old process exits after the drain and
+     * the new one listens on socket_path for the next upgrade.
+     *
+     * Only one process writes the cache persistence directory: the old one flushes and detaches
+     * its backend before it hands the sockets over. POSIX only.
+     */
+    class HotRestart {
+    public:
+        static HotRestart &instance();
+
+        /**
+         * @brief Take over from the server listening on the handoff socket, if one does.
+         * Call before any transport or the cache backend is created.
+         * @param options Handoff socket
+         * @return true if listening sockets were received
+         */
+        bool take_over(const HotRestartOptions &options = HotRestartOptions::current());
+
+        /**
+         * @brief Claim a listening socket received from the previous process.
+         * @param key Endpoint, from tcp_key() or unix_key()
+         * @return Descriptor now owned by the caller, nullopt if none is left for the endpoint
+         */
+        std::optional<int> inherit(const std::string &key);
+
+        /**
+         * @brief Offer a listening socket to the next process. The socket stays owned by the caller.
+         * @param key Endpoint, from tcp_key() or unix_key()
+         * @param fd Listening descriptor
+         */
+        void share(const std::string &key, int fd);
+
+        /**
+         * @brief Withdraw a socket before it is closed.
+         * @param fd Descriptor given to share()
+         */
+        void unshare(int fd);
+
+        /**
+         * @brief Finish a takeover and serve the handoff socket. Call once the transports are started.
+         * @param drain Drains the server, called on the handoff thread when a successor is ready
+         */
+        void start(std::function<void()> drain);
+
+        /**
+         * @brief Send a session with its latest events to the successor; does nothing unless a
+         *        handoff is in progress. Called as a drain ends a stream.
+         * @param session_id Session identifier
+         */
+        void hand_over(const std::string &session_id);
+
+        /**
+         * @brief Whether a successor has taken over; the shared socket files then belong to it.
+         */
+        bool handed_over() const noexcept { return handed_over_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Stop serving the handoff socket; waits until a handoff in progress has finished.
+         */
+        void stop();
+
+        static std::string tcp_key(const asio::ip::tcp::endpoint &endpoint);
+        static std::string unix_key(const std::string &path);
+
+    private:
+        class Channel;
+
+        HotRestart() = default;
+
+        void serve();
+        bool hand_off(Channel &channel);
+        void import_sessions(Channel &channel);
+        bool open_listener();
+
+        HotRestartOptions options_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> handed_over_{false};
+        std::function<void()> drain_;
+        int listener_ = -1;
+        std::thread thread_;
+
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::vector<int>> inherited_;///< Received and not yet claimed; mutex_
+        std::vector<std::pair<std::string, int>> shared_;            ///< Listening sockets offered to a successor; mutex_
+        std::unique_ptr<Channel> predecessor_;                        ///< Connection to the process taken over, until its sessions are in
+        Channel *successor_ = nullptr;                                ///< Connection to the process taking over, while draining; mutex_
+    };
+
+}// namespace mcp::transport
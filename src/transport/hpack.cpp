@@ -0,0 +1,446 @@
+#include "hpack.h"
+#include <algorithm>
+#include <array>
+
+namespace mcp::transport::hpack {
+
+    namespace {
+        struct StaticEntry {
+            std::string_view name;
+            std::string_view value;
+        };
+
+        // RFC 7541 appendix A, index 1 is the first entry
+        constexpr std::array<StaticEntry, 61> kStaticTable = {{
+            {":authority", ""},
+            {":method", "GET"},
+            {":method", "POST"},
+            {":path", "/"},
+            {":path", "/index.html"},
+            {":scheme", "http"},
+            {":scheme", "https"},
+            {":status", "200"},
+            {":status", "204"},
+            {":status", "206"},
+            {":status", "304"},
+            {":status", "400"},
+            {":status", "404"},
+            {":status", "500"},
+            {"accept-charset", ""},
+            {"accept-encoding", "gzip, deflate"},
+            {"accept-language", ""},
+            {"accept-ranges", ""},
+            {"accept", ""},
+            {"access-control-allow-origin", ""},
+            {"age", ""},
+            {"allow", ""},
+            {"authorization", ""},
+            {"cache-control", ""},
+            {"content-disposition", ""},
+            {"content-encoding", ""},
+            {"content-language", ""},
+            {"content-length", ""},
+            {"content-location", ""},
+            {"content-range", ""},
+            {"content-type", ""},
+            {"cookie", ""},
+            {"date", ""},
+            {"etag", ""},
+            {"expect", ""},
+            {"expires", ""},
+            {"from", ""},
+            {"host", ""},
+            {"if-match", ""},
+            {"if-modified-since", ""},
+            {"if-none-match", ""},
+            {"if-range", ""},
+            {"if-unmodified-since", ""},
+            {"last-modified", ""},
+            {"link", ""},
+            {"location", ""},
+            {"max-forwards", ""},
+            {"proxy-authenticate", ""},
+            {"proxy-authorization", ""},
+            {"range", ""},
+            {"referer", ""},
+            {"refresh", ""},
+            {"retry-after", ""},
+            {"server", ""},
+            {"set-cookie", ""},
+            {"strict-transport-security", ""},
+            {"transfer-encoding", ""},
+            {"user-agent", ""},
+            {"vary", ""},
+            {"via", ""},
+            {"www-authenticate", ""},
+        }};
+
+        struct HuffmanCode {
+            uint32_t code;
+            uint8_t bits;
+        };
+
+        // RFC 7541 appendix B, by symbol; EOS (256) is 30 one bits
+        constexpr std::array<HuffmanCode, 256> kHuffmanCodes = {{
+            {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+            {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+            {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+            {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+            {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+            {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+            {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+            {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+            {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+            {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+            {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+            {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+            {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+            {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+            {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+            {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+            {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+            {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+            {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+            {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+            {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+            {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+            {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+            {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+            {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+            {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+            {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+            {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+            {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+            {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+            {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+            {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+            {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+            {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+            {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+            {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+            {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+            {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+            {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+            {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+            {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+            {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+            {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+            {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+            {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+            {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+            {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+            {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+            {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+            {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+            {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+            {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+            {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+            {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+            {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+            {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+            {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+            {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+            {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+            {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+            {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+            {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+            {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+            {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+        }};
+
+        /**
+         * @brief Binary decoding tree of the Huffman code, built once.
+         */
+        struct HuffmanTree {
+            struct Node {
+                int16_t child[2] = {-1, -1};
+                int16_t symbol = -1;
+            };
+            std::vector<Node> nodes;
+
+            HuffmanTree() {
+                nodes.reserve(512);
+                nodes.emplace_back();
+                for (int symbol = 0; symbol < 256; ++symbol) {
+                    add(kHuffmanCodes[symbol].code, kHuffmanCodes[symbol].bits, static_cast<int16_t>(symbol));
+                }
+                add(0x3fffffff, 30, 256);
+            }
+
+            void add(uint32_t code, int bits, int16_t symbol) {
+                size_t node = 0;
+                for (int bit = bits - 1; bit >= 0; --bit) {
+                    int branch = (code >> bit) & 1;
+                    if (nodes[node].child[branch] < 0) {
+                        nodes[node].child[branch] = static_cast<int16_t>(nodes.size());
+                        nodes.emplace_back();
+                    }
+                    node = static_cast<size_t>(nodes[node].child[branch]);
+                }
+                nodes[node].symbol = symbol;
+            }
+        };
+
+        const HuffmanTree &huffman_tree() {
+            static const HuffmanTree tree;
+            return tree;
+        }
+
+        size_t entry_size(std::string_view name, std::string_view value) {
+            return name.size() + value.size() + DynamicTable::kEntryOverhead;
+        }
+
+        /**
+         * @brief Decode an integer with an N-bit prefix (RFC 7541 section 5.1).
+         */
+        bool decode_integer(std::string_view data, size_t &pos, int prefix_bits, uint64_t &value) {
+            if (pos >= data.size()) {
+                return false;
+            }
+            uint64_t limit = (1u << prefix_bits) - 1;
+            value = static_cast<uint8_t>(data[pos++]) & limit;
+            if (value < limit) {
+                return true;
+            }
+            for (int shift = 0; shift <= 56; shift += 7) {
+                if (pos >= data.size()) {
+                    return false;
+                }
+                uint8_t byte = static_cast<uint8_t>(data[pos++]);
+                value += static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;// longer than any sane length
+        }
+
+        bool decode_string(std::string_view data, size_t &pos, std::string &out) {
+            if (pos >= data.size()) {
+                return false;
+            }
+            bool huffman = (static_cast<uint8_t>(data[pos]) & 0x80) != 0;
+            uint64_t length = 0;
+            if (!decode_integer(data, pos, 7, length) || length > data.size() - pos) {
+                return false;
+            }
+            std::string_view raw = data.substr(pos, static_cast<size_t>(length));
+            pos += static_cast<size_t>(length);
+            out.clear();
+            if (huffman) {
+                return huffman_decode(raw, out);
+            }
+            out.assign(raw);
+            return true;
+        }
+
+        void encode_integer(uint64_t value, int prefix_bits, uint8_t first_byte_flags, std::string &out) {
+            uint64_t limit = (1u << prefix_bits) - 1;
+            if (value < limit) {
+                out.push_back(static_cast<char>(first_byte_flags | value));
+                return;
+            }
+            out.push_back(static_cast<char>(first_byte_flags | limit));
+            value -= limit;
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        void encode_string(std::string_view value, std::string &out) {
+            encode_integer(value.size(), 7, 0, out);
+            out.append(value);
+        }
+
+        /**
+         * @brief Fields whose value changes with every response are not worth a table slot.
+         */
+        bool worth_indexing(std::string_view name) {
+            return name != "content-length" && name != "date" && name != "etag" &&
+                   name != "last-modified" && name != "set-cookie" && name != "location";
+        }
+    }// namespace
+
+    void DynamicTable::insert(std::string name, std::string value) {
+        size_t size = entry_size(name, value);
+        if (size > max_size_) {
+            // An entry larger than the table empties it (RFC 7541 section 4.4)
+            entries_.clear();
+            size_ = 0;
+            return;
+        }
+        evict_to(max_size_ - size);
+        size_ += size;
+        entries_.emplace_front(std::move(name), std::move(value));
+    }
+
+    void DynamicTable::set_max_size(size_t max_size) {
+        max_size_ = max_size;
+        evict_to(max_size);
+    }
+
+    void DynamicTable::evict_to(size_t limit) {
+        while (size_ > limit && !entries_.empty()) {
+            size_ -= entry_size(entries_.back().first, entries_.back().second);
+            entries_.pop_back();
+        }
+    }
+
+    bool Decoder::lookup(uint64_t index, HeaderField &field) const {
+        if (index == 0) {
+            return false;
+        }
+        if (index <= kStaticTable.size()) {
+            field.first.assign(kStaticTable[index - 1].name);
+            field.second.assign(kStaticTable[index - 1].value);
+            return true;
+        }
+        index -= kStaticTable.size() + 1;
+        if (index >= table_.count()) {
+            return false;
+        }
+        field = table_.at(static_cast<size_t>(index));
+        return true;
+    }
+
+    bool Decoder::decode(std::string_view block, std::vector<HeaderField> &fields) {
+        size_t pos = 0;
+        size_t list_size = 0;
+        bool field_seen = false;
+        while (pos < block.size()) {
+            uint8_t byte = static_cast<uint8_t>(block[pos]);
+            HeaderField field;
+            uint64_t index = 0;
+
+            if (byte & 0x80) {
+                // Indexed header field
+                if (!decode_integer(block, pos, 7, index) || !lookup(index, field)) {
+                    return false;
+                }
+            } else if ((byte & 0xe0) == 0x20) {
+                // Dynamic table size update, only allowed before the first field
+                if (field_seen || !decode_integer(block, pos, 5, index) || index > max_table_size_) {
+                    return false;
+                }
+                table_.set_max_size(static_cast<size_t>(index));
+                continue;
+            } else {
+                // Literal, with incremental indexing (01), without indexing (0000) or never indexed (0001)
+                bool incremental = (byte & 0xc0) == 0x40;
+                if (!decode_integer(block, pos, incremental ? 6 : 4, index)) {
+                    return false;
+                }
+                if (index != 0) {
+                    if (!lookup(index, field)) {
+                        return false;
+                    }
+                } else if (!decode_string(block, pos, field.first)) {
+                    return false;
+                }
+                if (!decode_string(block, pos, field.second)) {
+                    return false;
+                }
+                if (incremental) {
+                    table_.insert(field.first, field.second);
+                }
+            }
+
+            field_seen = true;
+            list_size += entry_size(field.first, field.second);
+            if (list_size > max_header_list_size_) {
+                return false;
+            }
+            fields.push_back(std::move(field));
+        }
+        return true;
+    }
+
+    void Encoder::set_peer_max_table_size(size_t size) {
+        size_t limit = std::min<size_t>(size, 4096);
+        if (limit != table_.max_size()) {
+            table_.set_max_size(limit);
+            pending_table_size_ = limit;
+        }
+    }
+
+    void Encoder::encode(std::string_view name, std::string_view value, std::string &out) {
+        if (pending_table_size_ != SIZE_MAX) {
+            encode_integer(pending_table_size_, 5, 0x20, out);
+            pending_table_size_ = SIZE_MAX;
+        }
+
+        size_t name_index = 0;
+        for (size_t i = 0; i < kStaticTable.size(); ++i) {
+            if (kStaticTable[i].name == name) {
+                if (kStaticTable[i].value == value) {
+                    encode_integer(i + 1, 7, 0x80, out);
+                    return;
+                }
+                if (name_index == 0) {
+                    name_index = i + 1;
+                }
+            }
+        }
+        for (size_t i = 0; i < table_.count(); ++i) {
+            const auto &entry = table_.at(i);
+            if (entry.first == name) {
+                if (entry.second == value) {
+                    encode_integer(kStaticTable.size() + 1 + i, 7, 0x80, out);
+                    return;
+                }
+                if (name_index == 0) {
+                    name_index = kStaticTable.size() + 1 + i;
+                }
+            }
+        }
+
+        bool index = worth_indexing(name) && entry_size(name, value) <= table_.max_size();
+        if (index) {
+            encode_integer(name_index, 6, 0x40, out);
+        } else {
+            encode_integer(name_index, 4, 0x00, out);
+        }
+        if (name_index == 0) {
+            encode_string(name, out);
+        }
+        encode_string(value, out);
+        if (index) {
+            table_.insert(std::string(name), std::string(value));
+        }
+    }
+
+    bool huffman_decode(std::string_view data, std::string &out) {
+        const auto &tree = huffman_tree();
+        size_t node = 0;
+        int pending_bits = 0;  // bits read since the last symbol
+        bool pending_ones = true;// those bits are all ones (valid padding)
+        for (char c: data) {
+            uint8_t byte = static_cast<uint8_t>(c);
+            for (int bit = 7; bit >= 0; --bit) {
+                int branch = (byte >> bit) & 1;
+                int16_t next = tree.nodes[node].child[branch];
+                if (next < 0) {
+                    return false;
+                }
+                node = static_cast<size_t>(next);
+                ++pending_bits;
+                pending_ones = pending_ones && branch == 1;
+                int16_t symbol = tree.nodes[node].symbol;
+                if (symbol >= 0) {
+                    if (symbol == 256) {
+                        return false;// EOS must not appear in the data
+                    }
+                    out.push_back(static_cast<char>(symbol));
+                    node = 0;
+                    pending_bits = 0;
+                    pending_ones = true;
+                }
+            }
+        }
+        // At most 7 bits of padding, taken from the most significant bits of EOS
+        return pending_bits <= 7 && pending_ones;
+    }
+
+}// namespace mcp::transport::hpack
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mcp::transport::hpack {
+
+    using HeaderField = std::pair<std::string, std::string>;///< Name (lower case) and value
+
+    /**
+     * @brief Dynamic table of one direction of an HTTP/2 connection (RFC 7541 section 2.3.2).
+     * New entries are inserted at the front; entries are evicted from the back to stay within
+     * the size limit, counting name + value + 32 bytes per entry.
+     */
+    class DynamicTable {
+    public:
+        static constexpr size_t kEntryOverhead = 32;
+
+        explicit DynamicTable(size_t max_size = 4096) : max_size_(max_size) {}
+
+        void insert(std::string name, std::string value);
+        void set_max_size(size_t max_size);
+
+        size_t max_size() const { return max_size_; }
+        size_t size() const { return size_; }
+        size_t count() const { return entries_.size(); }
+
+        /**
+         * @brief Entry by position, 0 is the most recent one.
+         */
+        const HeaderField &at(size_t index) const { return entries_[index]; }
+
+    private:
+        void evict_to(size_t limit);
+
+        std::deque<HeaderField> entries_;
+        size_t size_ = 0;
+        size_t max_size_;
+    };
+
+    /**
+     * @brief Decodes the header blocks a client sends on one connection.
+     */
+    class Decoder {
+    public:
+        /**
+         * @param max_table_size SETTINGS_HEADER_TABLE_SIZE announced to the peer
+         * @param max_header_list_size Decoded bytes (name + value + 32 per field) accepted per block
+         */
+        explicit Decoder(size_t max_table_size = 4096, size_t max_header_list_size = 64 * 1024)
+            : table_(max_table_size), max_table_size_(max_table_size), max_header_list_size_(max_header_list_size) {}
+
+        /**
+         * @brief Decode one complete header block.
+         * @param block HEADERS payload plus all CONTINUATION payloads, without padding or priority
+         * @param fields Decoded fields are appended here
+         * @return False on a compression error, which is fatal for the connection
+         */
+        bool decode(std::string_view block, std::vector<HeaderField> &fields);
+
+    private:
+        bool lookup(uint64_t index, HeaderField &field) const;
+
+        DynamicTable table_;
+        size_t max_table_size_;
+        size_t max_header_list_size_;
+    };
+
+    /**
+     * @brief Encodes the response header blocks sent on one connection.
+     *
+     * Fields found in the static or dynamic table go out as a single index. Other fields are
+     * sent as literals and, unless they change with every response (content-length, date),
+     * added to the dynamic table, so headers repeated across the responses of a connection
+     * (content-type, server, mcp-session-id) shrink to one or two bytes after the first one.
+     * Strings are not Huffman coded.
+     */
+    class Encoder {
+    public:
+        explicit Encoder(size_t max_table_size = 4096) : table_(max_table_size) {}
+
+        /**
+         * @brief Apply the SETTINGS_HEADER_TABLE_SIZE of the peer; the change is announced
+         *        at the start of the next header block.
+         */
+        void set_peer_max_table_size(size_t size);
+
+        /**
+         * @brief Append the encoding of a field to a header block.
+         * @param name Field name, lower case
+         * @param value Field value
+         * @param out Header block being built
+         */
+        void encode(std::string_view name, std::string_view value, std::string &out);
+
+    private:
+        DynamicTable table_;
+        size_t pending_table_size_ = SIZE_MAX;///< Size update to announce, SIZE_MAX if none
+    };
+
+    /**
+     * @brief Decode a Huffman coded string (RFC 7541 appendix B).
+     * @return False if the data is not a valid Huffman code
+     */
+    bool huffman_decode(std::string_view data, std::string &out);
+
+}// namespace mcp::transport::hpack
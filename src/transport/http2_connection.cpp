@@ -0,0 +1,790 @@
+#include "http2_connection.h"
+#include "core/frame_pool.hpp"
+#include "core/logger.h"
+#include "http_handler.h"
+#include <algorithm>
+#include <cstring>
+#include <openssl/ssl.h>
+
+namespace mcp::transport {
+
+    namespace {
+        Http2Options &options_storage() {
+            static Http2Options options;
+            return options;
+        }
+
+        constexpr std::string_view kClientPreface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+        constexpr size_t kFrameHeaderSize = 9;
+        constexpr size_t kMaxFrameSize = 16384;             ///< SETTINGS_MAX_FRAME_SIZE we accept, the default
+        constexpr size_t kMaxHeaderListSize = 64 * 1024;    ///< Same bound as HttpRequestParser::kMaxHeaderBytes
+        constexpr size_t kMaxRequestBody = 64 * 1024 * 1024;///< Larger request bodies reset the stream
+        constexpr int64_t kMaxWindow = 0x7fffffff;
+
+        enum FrameType : uint8_t {
+            kData = 0x0,
+            kHeaders = 0x1,
+            kPriority = 0x2,
+            kRstStream = 0x3,
+            kSettings = 0x4,
+            kPushPromise = 0x5,
+            kPing = 0x6,
+            kGoaway = 0x7,
+            kWindowUpdate = 0x8,
+            kContinuation = 0x9,
+        };
+
+        enum FrameFlag : uint8_t {
+            kEndStream = 0x1,
+            kAck = 0x1,
+            kEndHeaders = 0x4,
+            kPadded = 0x8,
+            kPriorityFlag = 0x20,
+        };
+
+        enum ErrorCode : uint32_t {
+            kNoError = 0x0,
+            kProtocolError = 0x1,
+            kInternalError = 0x2,
+            kFlowControlError = 0x3,
+            kStreamClosed = 0x5,
+            kFrameSizeError = 0x6,
+            kRefusedStream = 0x7,
+            kCancel = 0x8,
+            kCompressionError = 0x9,
+            kEnhanceYourCalm = 0xb,
+        };
+
+        enum Setting : uint16_t {
+            kHeaderTableSize = 0x1,
+            kEnablePush = 0x2,
+            kMaxConcurrentStreams = 0x3,
+            kInitialWindowSize = 0x4,
+            kMaxFrameSizeSetting = 0x5,
+            kMaxHeaderListSizeSetting = 0x6,
+        };
+
+        void put_u16(std::string &out, uint16_t value) {
+            out.push_back(static_cast<char>(value >> 8));
+            out.push_back(static_cast<char>(value));
+        }
+
+        void put_u32(std::string &out, uint32_t value) {
+            put_u16(out, static_cast<uint16_t>(value >> 16));
+            put_u16(out, static_cast<uint16_t>(value));
+        }
+
+        uint32_t get_u32(const char *data) {
+            auto *bytes = reinterpret_cast<const unsigned char *>(data);
+            return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+        }
+
+        void put_frame_header(std::string &out, size_t length, uint8_t type, uint8_t flags, uint32_t stream_id) {
+            out.push_back(static_cast<char>(length >> 16));
+            out.push_back(static_cast<char>(length >> 8));
+            out.push_back(static_cast<char>(length));
+            out.push_back(static_cast<char>(type));
+            out.push_back(static_cast<char>(flags));
+            put_u32(out, stream_id & 0x7fffffff);
+        }
+
+        void put_setting(std::string &out, uint16_t id, uint32_t value) {
+            put_u16(out, id);
+            put_u32(out, value);
+        }
+
+        /**
+         * @brief Strip the padding of a DATA or HEADERS payload.
+         * @return False if the padding is longer than the payload
+         */
+        bool strip_padding(uint8_t flags, std::string_view &payload) {
+            if (!(flags & kPadded)) {
+                return true;
+            }
+            if (payload.empty()) {
+                return false;
+            }
+            size_t padding = static_cast<unsigned char>(payload.front());
+            payload.remove_prefix(1);
+            if (padding > payload.size()) {
+                return false;
+            }
+            payload.remove_suffix(padding);
+            return true;
+        }
+
+        /**
+         * @brief HTTP/1.1 spelling of a lower case HTTP/2 field name.
+         * Handlers and routers look some headers up by their usual spelling, so words are
+         * capitalized, except for the names whose usual spelling isn't plain title case.
+         */
+        std::string canonical_header_name(std::string_view name) {
+            if (name == "x-api-key") {
+                return "X-API-Key";
+            }
+            if (name == "last-event-id") {
+                return "Last-Event-ID";
+            }
+            std::string canonical(name);
+            bool word_start = true;
+            for (char &c: canonical) {
+                if (word_start && c >= 'a' && c <= 'z') {
+                    c = static_cast<char>(c - 'a' + 'A');
+                }
+                word_start = c == '-';
+            }
+            return canonical;
+        }
+
+        int select_protocol(SSL *, const unsigned char **out, unsigned char *out_length,
+                            const unsigned char *client, unsigned int client_length, void *) {
+            // Server preference order
+            static const unsigned char kProtocols[] = "\x02h2\x08http/1.1";
+            unsigned char *selected = nullptr;
+            if (SSL_select_next_proto(&selected, out_length, kProtocols, sizeof(kProtocols) - 1,
+                                      client, client_length) != OPENSSL_NPN_NEGOTIATED) {
+                return SSL_TLSEXT_ERR_NOACK;
+            }
+            *out = selected;
+            return SSL_TLSEXT_ERR_OK;
+        }
+    }// namespace
+
+    void Http2Options::configure(const Http2Options &options) {
+        options_storage() = options;
+    }
+
+    const Http2Options &Http2Options::current() {
+        return options_storage();
+    }
+
+    void Http2Options::apply(asio::ssl::context &context) const {
+        if (!enabled) {
+            return;
+        }
+        SSL_CTX_set_alpn_select_cb(context.native_handle(), &select_protocol, nullptr);
+        MCP_INFO("HTTP/2 enabled on the HTTPS listener: {} streams per connection, {} byte windows",
+                 max_concurrent_streams, initial_window_size);
+    }
+
+    Http2Connection::Http2Connection(std::shared_ptr<Session> transport, const Http2Options &options)
+        : transport_(std::move(transport)),
+          options_(options),
+          decoder_(4096, kMaxHeaderListSize),
+          window_timer_(transport_->get_executor(), asio::steady_timer::time_point::max()) {
+        options_.initial_window_size = static_cast<uint32_t>(std::clamp<int64_t>(options_.initial_window_size, 65535, kMaxWindow));
+    }
+
+    /**
+     * @brief Exchange the prefaces, then read and handle frames until the connection ends.
+     * Frames are handled one after the other without suspending; requests run on their own.
+     */
+    asio::awaitable<void> Http2Connection::run(HttpHandler *handler) {
+        auto self = shared_from_this();
+
+        // Our settings, then open the connection window as wide as a stream's
+        std::string preface;
+        put_frame_header(preface, 18, kSettings, 0, 0);
+        put_setting(preface, kMaxConcurrentStreams, options_.max_concurrent_streams);
+        put_setting(preface, kInitialWindowSize, options_.initial_window_size);
+        put_setting(preface, kMaxHeaderListSizeSetting, static_cast<uint32_t>(kMaxHeaderListSize));
+        if (options_.initial_window_size > 65535) {
+            put_frame_header(preface, 4, kWindowUpdate, 0, 0);
+            put_u32(preface, options_.initial_window_size - 65535);
+        }
+        transport_->post_write(std::move(preface));
+
+        std::vector<char> buffer(2 * (kFrameHeaderSize + kMaxFrameSize));
+        size_t begin = 0;
+        size_t end = 0;
+        bool preface_received = false;
+        uint32_t error = kNoError;
+        try {
+            while (!closed_ && error == kNoError) {
+                size_t n = co_await transport_->read_some(asio::buffer(buffer.data() + end, buffer.size() - end));
+                if (n == 0) {
+                    break;
+                }
+                end += n;
+
+                if (!preface_received) {
+                    size_t compared = std::min(end, kClientPreface.size());
+                    if (std::memcmp(buffer.data(), kClientPreface.data(), compared) != 0) {
+                        error = kProtocolError;
+                        break;
+                    }
+                    if (end < kClientPreface.size()) {
+                        continue;
+                    }
+                    begin = kClientPreface.size();
+                    preface_received = true;
+                }
+
+                while (error == kNoError && end - begin >= kFrameHeaderSize) {
+                    const auto *bytes = reinterpret_cast<const unsigned char *>(buffer.data() + begin);
+                    FrameHeader frame;
+                    frame.length = (uint32_t(bytes[0]) << 16) | (uint32_t(bytes[1]) << 8) | uint32_t(bytes[2]);
+                    frame.type = bytes[3];
+                    frame.flags = bytes[4];
+                    frame.stream_id = get_u32(buffer.data() + begin + 5) & 0x7fffffff;
+                    if (frame.length > kMaxFrameSize) {
+                        error = kFrameSizeError;
+                        break;
+                    }
+                    if (end - begin < kFrameHeaderSize + frame.length) {
+                        break;// Wait for the rest of the frame
+                    }
+                    error = process_frame(frame, std::string_view(buffer.data() + begin + kFrameHeaderSize, frame.length), handler);
+                    begin += kFrameHeaderSize + frame.length;
+                }
+
+                // Move the partial frame to the front, the buffer always fits a whole one
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+            }
+        } catch (const std::exception &e) {
+            if (!closed_) {
+                MCP_DEBUG("HTTP/2 connection ended (Session: {}): {}", transport_->get_session_id(), e.what());
+            }
+        }
+
+        if (error != kNoError && !transport_->is_closed()) {
+            MCP_WARN("HTTP/2 connection error {} (Session: {})", error, transport_->get_session_id());
+            std::string goaway;
+            put_frame_header(goaway, 8, kGoaway, 0, 0);
+            put_u32(goaway, last_stream_id_);
+            put_u32(goaway, error);
+            co_await transport_->write(goaway);
+        }
+        shutdown();
+    }
+
+    uint32_t Http2Connection::process_frame(const FrameHeader &frame, std::string_view payload, HttpHandler *handler) {
+        // A header block must not be interleaved with anything else
+        if (header_stream_id_ != 0 && (frame.type != kContinuation || frame.stream_id != header_stream_id_)) {
+            return kProtocolError;
+        }
+
+        switch (frame.type) {
+            case kData:
+                return process_data(frame, payload, handler);
+            case kHeaders:
+                return process_headers(frame, payload, handler);
+            case kContinuation:
+                if (header_stream_id_ == 0) {
+                    return kProtocolError;
+                }
+                if (header_block_.size() + payload.size() > kMaxHeaderListSize) {
+                    return kEnhanceYourCalm;
+                }
+                header_block_.append(payload);
+                return (frame.flags & kEndHeaders) ? process_header_block(handler) : kNoError;
+            case kPriority:
+                if (frame.stream_id == 0) {
+                    return kProtocolError;
+                }
+                return payload.size() == 5 ? kNoError : kFrameSizeError;// Priorities are not used
+            case kRstStream: {
+                if (frame.stream_id == 0 || frame.stream_id > last_stream_id_) {
+                    return kProtocolError;
+                }
+                if (payload.size() != 4) {
+                    return kFrameSizeError;
+                }
+                auto it = streams_.find(frame.stream_id);
+                if (it != streams_.end()) {
+                    MCP_DEBUG("HTTP/2 stream {} reset by the client (code {})", frame.stream_id, get_u32(payload.data()));
+                    auto stream = it->second;
+                    stream->interrupt();
+                    release(frame.stream_id);
+                }
+                return kNoError;
+            }
+            case kSettings:
+                return process_settings(frame, payload);
+            case kPushPromise:
+                return kProtocolError;// Clients never push
+            case kPing:
+                if (frame.stream_id != 0) {
+                    return kProtocolError;
+                }
+                if (payload.size() != 8) {
+                    return kFrameSizeError;
+                }
+                if (!(frame.flags & kAck)) {
+                    send_frame(kPing, kAck, 0, payload);
+                }
+                return kNoError;
+            case kGoaway:
+                // Streams the client already opened are still answered; it opens no new ones
+                MCP_DEBUG("HTTP/2 GOAWAY from the client (Session: {})", transport_->get_session_id());
+                return frame.stream_id == 0 ? kNoError : kProtocolError;
+            case kWindowUpdate:
+                return process_window_update(frame, payload);
+            default:
+                return kNoError;// Unknown frame types are ignored
+        }
+    }
+
+    uint32_t Http2Connection::process_headers(const FrameHeader &frame, std::string_view payload, HttpHandler *handler) {
+        if (frame.stream_id == 0 || !strip_padding(frame.flags, payload)) {
+            return kProtocolError;
+        }
+        if (frame.flags & kPriorityFlag) {
+            if (payload.size() < 5) {
+                return kFrameSizeError;
+            }
+            payload.remove_prefix(5);
+        }
+
+        header_block_.assign(payload.data(), payload.size());
+        header_stream_id_ = frame.stream_id;
+        header_end_stream_ = (frame.flags & kEndStream) != 0;
+        return (frame.flags & kEndHeaders) ? process_header_block(handler) : kNoError;
+    }
+
+    /**
+     * @brief Decode a complete header block, then open the stream or end its request.
+     * The block is decoded even for a stream that is refused, to keep the HPACK state in sync.
+     */
+    uint32_t Http2Connection::process_header_block(HttpHandler *handler) {
+        uint32_t stream_id = header_stream_id_;
+        header_stream_id_ = 0;
+
+        std::vector<hpack::HeaderField> fields;
+        bool decoded = decoder_.decode(header_block_, fields);
+        header_block_.clear();
+        if (!decoded) {
+            return kCompressionError;
+        }
+
+        auto it = streams_.find(stream_id);
+        if (it != streams_.end()) {
+            // Trailers after a request body: they end the request, their fields are not used
+            auto stream = it->second;
+            if (stream->request_complete_ || !header_end_stream_) {
+                return kProtocolError;
+            }
+            stream->request_complete_ = true;
+            dispatch(stream, handler);
+            return kNoError;
+        }
+
+        if (stream_id % 2 == 0) {
+            return kProtocolError;// Client streams are odd
+        }
+        if (stream_id <= last_stream_id_) {
+            // A stream we refused, reset or finished: its trailers may still be on the way, and
+            // they end the stream, not the connection (RFC 9113 section 5.1)
+            send_reset(stream_id, kStreamClosed);
+            return kNoError;
+        }
+        last_stream_id_ = stream_id;
+        if (streams_.size() >= options_.max_concurrent_streams) {
+            send_reset(stream_id, kRefusedStream);
+            return kNoError;
+        }
+
+        auto stream = std::make_shared<Http2Stream>(shared_from_this(), stream_id, peer_initial_window_);
+        stream->request_fields_ = std::move(fields);
+        streams_.emplace(stream_id, stream);
+        if (header_end_stream_) {
+            stream->request_complete_ = true;
+            dispatch(stream, handler);
+        }
+        return kNoError;
+    }
+
+    uint32_t Http2Connection::process_data(const FrameHeader &frame, std::string_view payload, HttpHandler *handler) {
+        if (frame.stream_id == 0 || frame.stream_id > last_stream_id_) {
+            return kProtocolError;
+        }
+        if (!strip_padding(frame.flags, payload)) {
+            return kProtocolError;
+        }
+        // Padding counts against flow control too; the connection window is refilled right away
+        if (frame.length > 0) {
+            send_window_update(0, frame.length);
+        }
+
+        auto it = streams_.find(frame.stream_id);
+        if (it == streams_.end()) {
+            return kNoError;// Reset or already answered, the data is not needed anymore
+        }
+        auto stream = it->second;
+        if (stream->request_complete_) {
+            send_reset(frame.stream_id, kStreamClosed);
+            stream->interrupt();
+            release(frame.stream_id);
+            return kNoError;
+        }
+        if (stream->request_body_.size() + payload.size() > kMaxRequestBody) {
+            MCP_WARN("HTTP/2 request body on stream {} exceeds {} bytes", frame.stream_id, kMaxRequestBody);
+            send_reset(frame.stream_id, kEnhanceYourCalm);
+            stream->interrupt();
+            release(frame.stream_id);
+            return kNoError;
+        }
+
+        stream->request_body_.append(payload);
+        if (frame.flags & kEndStream) {
+            stream->request_complete_ = true;
+            dispatch(stream, handler);
+        } else if (frame.length > 0) {
+            send_window_update(frame.stream_id, frame.length);
+        }
+        return kNoError;
+    }
+
+    uint32_t Http2Connection::process_settings(const FrameHeader &frame, std::string_view payload) {
+        if (frame.stream_id != 0) {
+            return kProtocolError;
+        }
+        if (frame.flags & kAck) {
+            return payload.empty() ? kNoError : kFrameSizeError;
+        }
+        if (payload.size() % 6 != 0) {
+            return kFrameSizeError;
+        }
+
+        for (size_t offset = 0; offset < payload.size(); offset += 6) {
+            auto id = static_cast<uint16_t>((uint16_t(static_cast<unsigned char>(payload[offset])) << 8) |
+                                            static_cast<unsigned char>(payload[offset + 1]));
+            uint32_t value = get_u32(payload.data() + offset + 2);
+            switch (id) {
+                case kHeaderTableSize:
+                    encoder_.set_peer_max_table_size(value);
+                    break;
+                case kEnablePush:
+                    if (value > 1) {
+                        return kProtocolError;
+                    }
+                    break;// Nothing is pushed either way
+                case kInitialWindowSize: {
+                    if (value > kMaxWindow) {
+                        return kFlowControlError;
+                    }
+                    // Applies to the windows of open streams as a delta
+                    int64_t delta = int64_t(value) - peer_initial_window_;
+                    for (auto &[stream_id, stream]: streams_) {
+                        stream->send_window_ += delta;
+                    }
+                    peer_initial_window_ = value;
+                    break;
+                }
+                case kMaxFrameSizeSetting:
+                    if (value < 16384 || value > 16777215) {
+                        return kProtocolError;
+                    }
+                    peer_max_frame_size_ = value;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        send_frame(kSettings, kAck, 0, {});
+        window_timer_.cancel();
+        return kNoError;
+    }
+
+    uint32_t Http2Connection::process_window_update(const FrameHeader &frame, std::string_view payload) {
+        if (payload.size() != 4) {
+            return kFrameSizeError;
+        }
+        int64_t increment = get_u32(payload.data()) & 0x7fffffff;
+
+        if (frame.stream_id == 0) {
+            if (increment == 0) {
+                return kProtocolError;
+            }
+            send_window_ += increment;
+            if (send_window_ > kMaxWindow) {
+                return kFlowControlError;
+            }
+        } else {
+            auto it = streams_.find(frame.stream_id);
+            if (it == streams_.end()) {
+                return kNoError;
+            }
+            auto stream = it->second;
+            stream->send_window_ += increment;
+            if (increment == 0 || stream->send_window_ > kMaxWindow) {
+                send_reset(frame.stream_id, increment == 0 ? kProtocolError : kFlowControlError);
+                stream->interrupt();
+                release(frame.stream_id);
+                return kNoError;
+            }
+        }
+        window_timer_.cancel();
+        return kNoError;
+    }
+
+    void Http2Connection::dispatch(const std::shared_ptr<Http2Stream> &stream, HttpHandler *handler) {
+        asio::co_spawn(transport_->get_executor(), [stream, handler]() { return stream->start(handler); }, asio::detached);
+    }
+
+    void Http2Connection::release(uint32_t stream_id) {
+        streams_.erase(stream_id);
+    }
+
+    void Http2Connection::send_frame(uint8_t type, uint8_t flags, uint32_t stream_id, std::string_view payload) {
+        if (closed_) {
+            return;
+        }
+        std::string frame;
+        frame.reserve(kFrameHeaderSize + payload.size());
+        put_frame_header(frame, payload.size(), type, flags, stream_id);
+        frame.append(payload);
+        transport_->post_write(std::move(frame));
+    }
+
+    /**
+     * @brief Encode a header block and send it as HEADERS plus as many CONTINUATION frames as needed.
+     * The frames are posted as one write, nothing may come between them.
+     */
+    void Http2Connection::send_headers(uint32_t stream_id, const std::vector<hpack::HeaderField> &fields, bool end_stream) {
+        if (closed_) {
+            return;
+        }
+        std::string block;
+        for (const auto &[name, value]: fields) {
+            encoder_.encode(name, value, block);
+        }
+
+        std::string frames;
+        frames.reserve(block.size() + kFrameHeaderSize);
+        size_t offset = 0;
+        bool first = true;
+        do {
+            size_t length = std::min(block.size() - offset, peer_max_frame_size_);
+            bool last = offset + length == block.size();
+            uint8_t flags = (last ? kEndHeaders : 0) | (first && end_stream ? kEndStream : 0);
+            put_frame_header(frames, length, first ? kHeaders : kContinuation, flags, stream_id);
+            frames.append(block, offset, length);
+            offset += length;
+            first = false;
+        } while (offset < block.size());
+        transport_->post_write(std::move(frames));
+    }
+
+    void Http2Connection::send_reset(uint32_t stream_id, uint32_t error_code) {
+        std::string payload;
+        put_u32(payload, error_code);
+        send_frame(kRstStream, 0, stream_id, payload);
+    }
+
+    void Http2Connection::send_window_update(uint32_t stream_id, uint32_t increment) {
+        std::string payload;
+        put_u32(payload, increment);
+        send_frame(kWindowUpdate, 0, stream_id, payload);
+    }
+
+    asio::awaitable<void> Http2Connection::wait_for_window() {
+        asio::error_code ec;
+        co_await window_timer_.async_wait(core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+    }
+
+    /**
+     * @brief End every stream; handlers still running see their stream closed.
+     */
+    void Http2Connection::shutdown() {
+        if (closed_) {
+            return;
+        }
+        closed_ = true;
+        auto streams = std::move(streams_);
+        streams_.clear();
+        for (auto &[stream_id, stream]: streams) {
+            stream->interrupt();
+        }
+        window_timer_.cancel();
+    }
+
+    Http2Stream::Http2Stream(std::shared_ptr<Http2Connection> connection, uint32_t stream_id, int64_t send_window)
+        : connection_(std::move(connection)),
+          stream_id_(stream_id),
+          send_window_(send_window),
+          disconnect_timer_(connection_->transport().get_executor(), asio::steady_timer::time_point::max()) {
+        // Each stream is its own session: streaming tool state is keyed by session id
+        session_id_ = connection_->transport().get_session_id() + "-" + std::to_string(stream_id_);
+    }
+
+    /**
+     * @brief Serve the request of the stream, then end the stream.
+     * The request is presented as HTTP/1.1: pseudo-headers become the request line and Host.
+     */
+    asio::awaitable<void> Http2Stream::start(HttpHandler *handler) {
+        auto self = shared_from_this();
+
+        std::string_view method;
+        std::string_view path;
+        std::string_view authority;
+        std::vector<hpack::HeaderField> headers;
+        headers.reserve(request_fields_.size() + 1);
+        bool malformed = false;
+        bool has_host = false;
+        size_t request_size = request_body_.size();
+        for (const auto &[name, value]: request_fields_) {
+            request_size += name.size() + value.size() + 4;
+            if (!name.empty() && name.front() == ':') {
+                if (!headers.empty()) {
+                    malformed = true;// Pseudo-headers come first
+                } else if (name == ":method") {
+                    method = value;
+                } else if (name == ":path") {
+                    path = value;
+                } else if (name == ":authority") {
+                    authority = value;
+                } else if (name != ":scheme") {
+                    malformed = true;
+                }
+                continue;
+            }
+            has_host = has_host || name == "host";
+            headers.emplace_back(canonical_header_name(name), value);
+        }
+        if (!authority.empty() && !has_host) {
+            headers.emplace_back("Host", std::string(authority));
+        }
+        if (method.empty() || path.empty() || headers.size() > HttpRequestView::kMaxHeaders) {
+            malformed = true;
+        }
+
+        HttpRequestView view;
+        view.method = method;
+        view.target = path;
+        view.version = "HTTP/2";
+        for (const auto &[name, value]: headers) {
+            if (view.header_count == HttpRequestView::kMaxHeaders) {
+                break;
+            }
+            view.headers[view.header_count++] = HttpHeaderView{name, value};
+        }
+        view.body = request_body_;
+
+        try {
+            co_await handler->handle_request(self, malformed ? nullptr : &view, request_size);
+            co_await flush_pending_writes();
+        } catch (const std::exception &e) {
+            MCP_WARN("HTTP/2 stream {} failed (Session: {}): {}", stream_id_, session_id_, e.what());
+        }
+
+        close();
+    }
+
+    /**
+     * @brief End the stream: a response without length ends here, an unfinished one is reset.
+     */
+    void Http2Stream::close() {
+        if (closed_) {
+            return;
+        }
+        closed_ = true;
+
+        if (!reset_ && !connection_->is_closed()) {
+            if (response_.until_close()) {
+                connection_->send_frame(kData, kEndStream, stream_id_, {});
+            } else if (!response_.done()) {
+                connection_->send_reset(stream_id_, response_.started() ? kCancel : kInternalError);
+            } else if (!request_complete_) {
+                // Answered before the body arrived, the client can stop sending it
+                connection_->send_reset(stream_id_, kNoError);
+            }
+        }
+        reset_ = true;
+        disconnect_timer_.cancel();
+        if (!released_) {
+            released_ = true;
+            connection_->release(stream_id_);
+        }
+    }
+
+    bool Http2Stream::is_closed() const {
+        return closed_ || reset_ || connection_->is_closed();
+    }
+
+    asio::awaitable<void> Http2Stream::wait_for_disconnect() {
+        if (is_closed()) {
+            co_return;
+        }
+        asio::error_code ec;
+        co_await disconnect_timer_.async_wait(core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+    }
+
+    void Http2Stream::interrupt() {
+        reset_ = true;
+        released_ = true;// The connection already dropped the stream
+        disconnect_timer_.cancel();
+        connection_->window_timer_.cancel();
+    }
+
+    void Http2Stream::fail(const char *reason) {
+        MCP_WARN("HTTP/2 stream {} reset (Session: {}): {}", stream_id_, session_id_, reason);
+        connection_->send_reset(stream_id_, kInternalError);
+        reset_ = true;
+        disconnect_timer_.cancel();
+    }
+
+    asio::awaitable<void> Http2Stream::write_now(std::span<const asio::const_buffer> buffers) {
+        for (const auto &buffer: buffers) {
+            if (is_closed()) {
+                co_return;
+            }
+            co_await translate(std::string_view(static_cast<const char *>(buffer.data()), buffer.size()));
+        }
+    }
+
+    /**
+     * @brief Turn the HTTP/1.1 response the handler writes into HEADERS and DATA frames.
+     */
+    asio::awaitable<void> Http2Stream::translate(std::string_view data) {
+        while (!is_closed()) {
+            auto part = response_.next(data);
+            if (part == HttpResponseDecoder::Part::NeedMore) {
+                break;
+            }
+            if (part == HttpResponseDecoder::Part::Error) {
+                fail(response_.error());
+                break;
+            }
+            if (part == HttpResponseDecoder::Part::Head) {
+                std::vector<hpack::HeaderField> fields;
+                fields.reserve(response_.fields().size() + 1);
+                fields.emplace_back(":status", std::to_string(response_.status()));
+                fields.insert(fields.end(), response_.fields().begin(), response_.fields().end());
+                connection_->send_headers(stream_id_, fields, response_.done());
+                continue;
+            }
+            co_await send_data(response_.body(), response_.done());
+        }
+    }
+
+    /**
+     * @brief Send body data as DATA frames, waiting for window whenever the client's runs out.
+     */
+    asio::awaitable<void> Http2Stream::send_data(std::string_view data, bool end_stream) {
+        auto &connection = *connection_;
+        if (data.empty()) {
+            if (end_stream) {
+                connection.send_frame(kData, kEndStream, stream_id_, {});
+            }
+            co_return;
+        }
+        while (!data.empty() && !is_closed()) {
+            int64_t window = std::min(send_window_, connection.send_window_);
+            if (window <= 0) {
+                co_await connection.wait_for_window();
+                continue;
+            }
+            size_t n = std::min({data.size(), static_cast<size_t>(window), connection.peer_max_frame_size_});
+            bool last = end_stream && n == data.size();
+            connection.send_frame(kData, last ? kEndStream : 0, stream_id_, data.substr(0, n));
+            send_window_ -= static_cast<int64_t>(n);
+            connection.send_window_ -= static_cast<int64_t>(n);
+            data.remove_prefix(n);
+        }
+    }
+
+}// namespace mcp::transport
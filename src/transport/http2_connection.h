@@ -0,0 +1,189 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "hpack.h"
+#include "http_response_decoder.h"
+#include "session.h"
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp::transport {
+    class HttpHandler;
+    class Http2Stream;
+}// namespace mcp::transport
+
+namespace mcp::transport {
+
+    /**
+     * @brief HTTP/2 settings of the HTTPS listener.
+     * Configured once at startup from the [server] config section, before the HTTPS
+     * transport is created. HTTP/2 is only offered through ALPN, there is no cleartext h2c.
+     */
+    struct Http2Options {
+        bool enabled = false;                   ///< Offer "h2" in the TLS handshake
+        uint32_t max_concurrent_streams = 100;  ///< Requests a client may have in flight per connection
+        uint32_t initial_window_size = 1 << 20;///< Receive window announced per stream and for the connection
+
+        /**
+         * @brief Set the process-wide options. Call before starting the HTTPS transport.
+         * @param options New options
+         */
+        static void configure(const Http2Options &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const Http2Options &current();
+
+        /**
+         * @brief Install the ALPN callback on a server context: "h2" when enabled, else "http/1.1".
+         * Does nothing if HTTP/2 is disabled, clients then negotiate nothing and speak HTTP/1.1.
+         * @param context Server context, before the first handshake
+         */
+        void apply(asio::ssl::context &context) const;
+    };
+
+    /**
+     * @brief Server side of one HTTP/2 connection (RFC 9113) on top of a TLS session.
+     *
+     * The connection reads frames from the session and turns every request stream into an
+     * Http2Stream, a Session that the HttpHandler serves exactly like an HTTP/1.1 connection
+     * carrying one request. Streams are handled concurrently, so one slow tool call no longer
+     * holds up the other requests of the client. All frames go out through the session's
+     * outbound queue, which keeps them in order and the HPACK encoder state consistent.
+     * Everything runs on the session's executor.
+     */
+    class Http2Connection : public std::enable_shared_from_this<Http2Connection> {
+    public:
+        /**
+         * @param transport Session the connection runs on, read through Session::read_some()
+         * @param options HTTP/2 settings
+         */
+        explicit Http2Connection(std::shared_ptr<Session> transport, const Http2Options &options = Http2Options::current());
+
+        /**
+         * @brief Serve the connection until the client or an error ends it.
+         * The client preface must not have been read yet.
+         * @param handler HTTP handler for the requests
+         */
+        asio::awaitable<void> run(HttpHandler *handler);
+
+        bool is_closed() const { return closed_; }
+        Session &transport() const { return *transport_; }
+
+    private:
+        friend class Http2Stream;
+
+        struct FrameHeader {
+            uint32_t length = 0;
+            uint8_t type = 0;
+            uint8_t flags = 0;
+            uint32_t stream_id = 0;
+        };
+
+        /**
+         * @brief Handle one frame.
+         * @return 0, or the error code that ends the connection
+         */
+        uint32_t process_frame(const FrameHeader &frame, std::string_view payload, HttpHandler *handler);
+        uint32_t process_headers(const FrameHeader &frame, std::string_view payload, HttpHandler *handler);
+        uint32_t process_header_block(HttpHandler *handler);
+        uint32_t process_data(const FrameHeader &frame, std::string_view payload, HttpHandler *handler);
+        uint32_t process_settings(const FrameHeader &frame, std::string_view payload);
+        uint32_t process_window_update(const FrameHeader &frame, std::string_view payload);
+
+        void dispatch(const std::shared_ptr<Http2Stream> &stream, HttpHandler *handler);
+        void release(uint32_t stream_id);
+
+        void send_frame(uint8_t type, uint8_t flags, uint32_t stream_id, std::string_view payload);
+        void send_headers(uint32_t stream_id, const std::vector<hpack::HeaderField> &fields, bool end_stream);
+        void send_reset(uint32_t stream_id, uint32_t error_code);
+        void send_window_update(uint32_t stream_id, uint32_t increment);
+
+        asio::awaitable<void> wait_for_window();///< Until a WINDOW_UPDATE, SETTINGS or shutdown
+        void shutdown();
+
+        std::shared_ptr<Session> transport_;
+        Http2Options options_;
+        hpack::Decoder decoder_;
+        hpack::Encoder encoder_;
+
+        std::unordered_map<uint32_t, std::shared_ptr<Http2Stream>> streams_;///< Streams not finished in both directions
+        uint32_t last_stream_id_ = 0;                                         ///< Highest stream id the client opened
+
+        // Header block spread over HEADERS and CONTINUATION frames
+        std::string header_block_;
+        uint32_t header_stream_id_ = 0;///< Stream of the block being received, 0 if none
+        bool header_end_stream_ = false;
+
+        int64_t send_window_ = 65535;           ///< Connection-level window for DATA we send
+        int64_t peer_initial_window_ = 65535;   ///< SETTINGS_INITIAL_WINDOW_SIZE of the client
+        size_t peer_max_frame_size_ = 16384;    ///< SETTINGS_MAX_FRAME_SIZE of the client
+        asio::steady_timer window_timer_;       ///< Cancelled whenever send windows grow
+        bool closed_ = false;
+    };
+
+    /**
+     * @brief One request of an HTTP/2 connection, served through the regular Session interface.
+     *
+     * The handler writes an HTTP/1.1 response; the stream decodes it with HttpResponseDecoder
+     * and sends its head as a HEADERS frame and its body as DATA frames within the client's
+     * flow-control windows. Closing the
+     * stream ends or resets it, never the connection.
+     */
+    class Http2Stream : public Session {
+    public:
+        Http2Stream(std::shared_ptr<Http2Connection> connection, uint32_t stream_id, int64_t send_window);
+
+        asio::awaitable<void> start(HttpHandler *handler) override;
+        void close() override;
+        bool is_closed() const override;
+        asio::any_io_executor get_executor() override { return connection_->transport().get_executor(); }
+        asio::awaitable<void> wait_for_disconnect() override;
+        const std::string &get_session_id() const override { return session_id_; }
+        bool peer_authenticated() const override { return connection_->transport().peer_authenticated(); }
+
+        // Server notifications belong to the connection: a GET on one stream carries them for all
+        void set_notification_stream(const std::shared_ptr<SseSendQueue> &queue) override {
+            connection_->transport().set_notification_stream(queue);
+        }
+        std::shared_ptr<SseSendQueue> notification_stream() const override { return connection_->transport().notification_stream(); }
+
+    protected:
+        asio::awaitable<void> write_now(std::span<const asio::const_buffer> buffers) override;
+
+    private:
+        friend class Http2Connection;
+
+        asio::awaitable<void> translate(std::string_view data);///< Feed response bytes written by the handler
+        asio::awaitable<void> send_data(std::string_view data, bool end_stream);
+        void fail(const char *reason);///< Reset the stream after a response it cannot translate
+        void interrupt();             ///< The client reset the stream or the connection ended
+
+        std::shared_ptr<Http2Connection> connection_;
+        uint32_t stream_id_;
+        int64_t send_window_;               ///< Stream-level window for DATA we send
+        asio::steady_timer disconnect_timer_;///< Cancelled when the stream ends
+
+        // Request
+        std::vector<hpack::HeaderField> request_fields_;
+        std::string request_body_;
+        bool request_complete_ = false;
+
+        // Response
+        HttpResponseDecoder response_;
+        bool reset_ = false;             ///< No more frames may be sent on the stream
+        bool released_ = false;          ///< Removed from the connection
+    };
+
+}// namespace mcp::transport
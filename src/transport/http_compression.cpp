@@ -0,0 +1,538 @@
+#include "http_compression.h"
+#include "core/logger.h"
+#include "core/tool_thread_pool.hpp"
+#include "http_parser.h"
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+// miniz would otherwise #define zlib names such as compress
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+#if defined(MCP_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace mcp::transport {
+
+    namespace {
+        // Magic, deflate, no flags, no modification time, no extra flags, unknown OS
+        constexpr std::string_view kGzipHeader("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+
+        CompressionOptions &options_storage() {
+            static CompressionOptions options;
+            return options;
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+            return text;
+        }
+
+        /**
+         * @brief q-value of one Accept-Encoding entry's parameters, 1 if it has none.
+         */
+        double parse_q(std::string_view params) {
+            while (!params.empty()) {
+                size_t semicolon = params.find(';');
+                std::string_view param = trim(params.substr(0, semicolon));
+                params = semicolon == std::string_view::npos ? std::string_view() : params.substr(semicolon + 1);
+                if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                    double q = 0;
+                    auto result = std::from_chars(param.data() + 2, param.data() + param.size(), q);
+                    return result.ec == std::errc() ? std::clamp(q, 0.0, 1.0) : 0.0;
+                }
+            }
+            return 1.0;
+        }
+
+        void append_le32(std::string &out, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out += static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+        }
+
+        uint32_t read_le32(std::string_view data) {
+            uint32_t value = 0;
+            for (int i = 3; i >= 0; --i) {
+                value = (value << 8) | static_cast<unsigned char>(data[static_cast<size_t>(i)]);
+            }
+            return value;
+        }
+
+        /**
+         * @brief Size of a gzip member's header including its optional fields (RFC 1952).
+         * @return 0 if data does not start with a valid header
+         */
+        size_t gzip_header_size(std::string_view data) {
+            if (data.size() < kGzipHeader.size() || data.substr(0, 3) != kGzipHeader.substr(0, 3)) {
+                return 0;
+            }
+            auto flags = static_cast<unsigned char>(data[3]);
+            size_t pos = kGzipHeader.size();
+            if (flags & 0x04) {// FEXTRA
+                if (pos + 2 > data.size()) {
+                    return 0;
+                }
+                pos += 2 + (static_cast<unsigned char>(data[pos]) | (static_cast<size_t>(static_cast<unsigned char>(data[pos + 1])) << 8));
+            }
+            for (unsigned char field: {0x08, 0x10}) {// FNAME, FCOMMENT: zero terminated
+                if ((flags & field) && pos < data.size()) {
+                    size_t end = data.find('\0', pos);
+                    pos = end == std::string_view::npos ? data.size() + 1 : end + 1;
+                }
+            }
+            if (flags & 0x02) {// FHCRC
+                pos += 2;
+            }
+            return pos <= data.size() ? pos : 0;
+        }
+
+        /**
+         * @brief Grow out for the next piece of decompressed data, never beyond max_size.
+         * @return false if out already holds max_size bytes
+         */
+        bool grow_output(std::string &out, size_t max_size) {
+            if (out.size() >= max_size) {
+                return false;
+            }
+            out.resize(std::min(max_size, std::max<size_t>(out.size() * 2, 64 * 1024)));
+            return true;
+        }
+
+        /**
+         * @brief Inflate a zlib or raw deflate stream into out.
+         * @param consumed Bytes of data the stream took up
+         */
+        DecodeResult inflate(std::string_view data, bool zlib, size_t max_size, std::string &out, size_t &consumed) {
+            auto decompressor = std::make_unique<tinfl_decompressor>();
+            tinfl_init(decompressor.get());
+            mz_uint32 flags = TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF | (zlib ? TINFL_FLAG_PARSE_ZLIB_HEADER : 0);
+
+            size_t in_pos = 0;
+            size_t out_pos = 0;
+            for (;;) {
+                if (out_pos == out.size() && !grow_output(out, max_size)) {
+                    return DecodeResult::TooLarge;
+                }
+                size_t in_size = data.size() - in_pos;
+                size_t out_size = out.size() - out_pos;
+                auto *start = reinterpret_cast<mz_uint8 *>(out.data());
+                tinfl_status status = tinfl_decompress(decompressor.get(), reinterpret_cast<const mz_uint8 *>(data.data()) + in_pos, &in_size,
+                                                       start, start + out_pos, &out_size, flags);
+                in_pos += in_size;
+                out_pos += out_size;
+                if (status == TINFL_STATUS_DONE) {
+                    break;
+                }
+                if (status != TINFL_STATUS_HAS_MORE_OUTPUT) {
+                    return DecodeResult::Invalid;// corrupt, or truncated (needs more input)
+                }
+            }
+            out.resize(out_pos);
+            consumed = in_pos;
+            return DecodeResult::Ok;
+        }
+
+#if defined(MCP_HAVE_ZSTD)
+        DecodeResult decompress_zstd(std::string_view data, size_t max_size, std::string &out) {
+            std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx *)> context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+            if (!context) {
+                return DecodeResult::Invalid;
+            }
+            ZSTD_inBuffer input{data.data(), data.size(), 0};
+            size_t out_pos = 0;
+            for (;;) {
+                if (out_pos == out.size() && !grow_output(out, max_size)) {
+                    return DecodeResult::TooLarge;
+                }
+                ZSTD_outBuffer output{out.data(), out.size(), out_pos};
+                size_t remaining = ZSTD_decompressStream(context.get(), &output, &input);
+                out_pos = output.pos;
+                if (ZSTD_isError(remaining)) {
+                    return DecodeResult::Invalid;
+                }
+                // All input taken and the decoder had room left: done, unless a frame is unfinished
+                if (input.pos == input.size && output.pos < output.size) {
+                    if (remaining != 0) {
+                        return DecodeResult::Invalid;
+                    }
+                    break;
+                }
+            }
+            out.resize(out_pos);
+            return DecodeResult::Ok;
+        }
+#endif
+
+    }// namespace
+
+    void CompressionOptions::configure(const CompressionOptions &options) {
+        options_storage() = options;
+    }
+
+    const CompressionOptions &CompressionOptions::current() {
+        return options_storage();
+    }
+
+    ContentEncoding negotiate_encoding(std::string_view accept_encoding) {
+        // q-values of the listed codings, -1 for codings that are not listed
+        double gzip = -1, deflate = -1, zstd = -1, any = -1;
+        while (!accept_encoding.empty()) {
+            size_t comma = accept_encoding.find(',');
+            std::string_view item = accept_encoding.substr(0, comma);
+            accept_encoding = comma == std::string_view::npos ? std::string_view() : accept_encoding.substr(comma + 1);
+
+            size_t semicolon = item.find(';');
+            std::string_view name = trim(item.substr(0, semicolon));
+            double q = semicolon == std::string_view::npos ? 1.0 : parse_q(item.substr(semicolon + 1));
+            if (iequals(name, "gzip") || iequals(name, "x-gzip")) {
+                gzip = q;
+            } else if (iequals(name, "deflate")) {
+                deflate = q;
+            } else if (iequals(name, "zstd")) {
+                zstd = q;
+            } else if (name == "*") {
+                any = q;
+            }
+        }
+
+        ContentEncoding best = ContentEncoding::Identity;
+        double best_q = 0;
+        auto consider = [&](ContentEncoding encoding, double q) {
+            q = q >= 0 ? q : any;
+            if (q > best_q) {
+                best = encoding;
+                best_q = q;
+            }
+        };
+#if defined(MCP_HAVE_ZSTD)
+        consider(ContentEncoding::Zstd, zstd);
+#else
+        (void) zstd;
+#endif
+        consider(ContentEncoding::Gzip, gzip);
+        consider(ContentEncoding::Deflate, deflate);
+        return best;
+    }
+
+    ContentEncoding response_encoding(const HeaderMap &request_headers, size_t body_size) {
+        const auto &options = CompressionOptions::current();
+        if (!options.enabled || body_size < options.min_size) {
+            return ContentEncoding::Identity;
+        }
+        return negotiate_encoding(request_headers.get("Accept-Encoding"));
+    }
+
+    ContentEncoding stream_encoding(const HeaderMap &request_headers) {
+        const auto &options = CompressionOptions::current();
+        if (!options.enabled || !options.streaming) {
+            return ContentEncoding::Identity;
+        }
+        return negotiate_encoding(request_headers.get("Accept-Encoding"));
+    }
+
+    std::string_view encoding_name(ContentEncoding encoding) {
+        switch (encoding) {
+            case ContentEncoding::Gzip:
+                return "gzip";
+            case ContentEncoding::Deflate:
+                return "deflate";
+            case ContentEncoding::Zstd:
+                return "zstd";
+            case ContentEncoding::Identity:
+                break;
+        }
+        return "identity";
+    }
+
+    std::string encoding_header(ContentEncoding encoding) {
+        if (encoding == ContentEncoding::Identity) {
+            return {};
+        }
+        std::string header = "Content-Encoding: ";
+        header += encoding_name(encoding);
+        header += "\r\nVary: Accept-Encoding\r\n";
+        return header;
+    }
+
+    std::string compress(std::string_view data, ContentEncoding encoding, int level) {
+        if (encoding == ContentEncoding::Identity) {
+            return std::string(data);
+        }
+#if defined(MCP_HAVE_ZSTD)
+        if (encoding == ContentEncoding::Zstd) {
+            std::string out(ZSTD_compressBound(data.size()), '\0');
+            size_t size = ZSTD_compress(out.data(), out.size(), data.data(), data.size(), level);
+            if (ZSTD_isError(size)) {
+                throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(size));
+            }
+            out.resize(size);
+            return out;
+        }
+#endif
+        StreamCompressor compressor(encoding, level);
+        std::string out = compressor.compress(data, false);
+        out += compressor.finish();
+        return out;
+    }
+
+    asio::awaitable<void> compress_response(std::string &header, std::string &body, ContentEncoding encoding) {
+        if (encoding != ContentEncoding::Identity) {
+            const auto &options = CompressionOptions::current();
+            std::string compressed;
+            try {
+                if (body.size() >= options.offload_size) {
+                    compressed = co_await asio::co_spawn(
+                            core::ToolThreadPool::instance().executor(),
+                            [&body, encoding, level = options.level]() -> asio::awaitable<std::string> {
+                                co_return compress(body, encoding, level);
+                            },
+                            asio::use_awaitable);
+                } else {
+                    compressed = compress(body, encoding, options.level);
+                }
+            } catch (const std::exception &e) {
+                MCP_WARN("Sending response uncompressed: {}", e.what());
+                compressed.clear();
+            }
+            if (!compressed.empty() && compressed.size() < body.size()) {
+                body = std::move(compressed);
+                header += encoding_header(encoding);
+            }
+        }
+        header += "Content-Length: ";
+        header += std::to_string(body.size());
+        header += "\r\n\r\n";
+    }
+
+    std::optional<ContentEncoding> parse_content_encoding(std::string_view content_encoding) {
+        std::string_view name = trim(content_encoding);
+        if (name.empty() || iequals(name, "identity")) {
+            return ContentEncoding::Identity;
+        }
+        if (iequals(name, "gzip") || iequals(name, "x-gzip")) {
+            return ContentEncoding::Gzip;
+        }
+        if (iequals(name, "deflate")) {
+            return ContentEncoding::Deflate;
+        }
+#if defined(MCP_HAVE_ZSTD)
+        if (iequals(name, "zstd")) {
+            return ContentEncoding::Zstd;
+        }
+#endif
+        return std::nullopt;
+    }
+
+    DecodeResult decompress(std::string_view data, ContentEncoding encoding, size_t max_size, std::string &out) {
+        out.clear();
+        if (max_size == 0) {
+            max_size = std::numeric_limits<size_t>::max();
+        }
+        switch (encoding) {
+            case ContentEncoding::Identity:
+                if (data.size() > max_size) {
+                    return DecodeResult::TooLarge;
+                }
+                out.assign(data);
+                return DecodeResult::Ok;
+            case ContentEncoding::Gzip: {
+                size_t header = gzip_header_size(data);
+                if (header == 0) {
+                    return DecodeResult::Invalid;
+                }
+                size_t consumed = 0;
+                auto result = inflate(data.substr(header), false, max_size, out, consumed);
+                if (result != DecodeResult::Ok) {
+                    return result;
+                }
+                std::string_view trailer = data.substr(header + consumed);
+                mz_ulong crc = mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char *>(out.data()), out.size());
+                if (trailer.size() < 8 || read_le32(trailer) != static_cast<uint32_t>(crc) ||
+                    read_le32(trailer.substr(4)) != static_cast<uint32_t>(out.size())) {
+                    return DecodeResult::Invalid;
+                }
+                return DecodeResult::Ok;
+            }
+            case ContentEncoding::Deflate: {
+                // "deflate" should be zlib, but some clients send a raw stream
+                bool zlib = data.size() >= 2 && (static_cast<unsigned char>(data[0]) & 0x0f) == 8 &&
+                            ((static_cast<unsigned char>(data[0]) << 8) | static_cast<unsigned char>(data[1])) % 31 == 0;
+                size_t consumed = 0;
+                return inflate(data, zlib, max_size, out, consumed);
+            }
+            case ContentEncoding::Zstd:
+#if defined(MCP_HAVE_ZSTD)
+                return decompress_zstd(data, max_size, out);
+#else
+                break;
+#endif
+        }
+        return DecodeResult::Invalid;
+    }
+
+    asio::awaitable<DecodeResult> decompress_request(std::string_view data, ContentEncoding encoding, std::string &out) {
+        const auto &options = CompressionOptions::current();
+        if (data.size() < options.offload_size) {
+            co_return decompress(data, encoding, options.max_decoded_size, out);
+        }
+        co_return co_await asio::co_spawn(
+                core::ToolThreadPool::instance().executor(),
+                [data, encoding, &out, max_size = options.max_decoded_size]() -> asio::awaitable<DecodeResult> {
+                    co_return decompress(data, encoding, max_size, out);
+                },
+                asio::use_awaitable);
+    }
+
+    struct StreamCompressor::State {
+        std::unique_ptr<tdefl_compressor> deflate;
+        mz_ulong crc = MZ_CRC32_INIT;///< gzip trailer: CRC-32 and size of the uncompressed data
+        uint32_t size = 0;
+        bool started = false;///< gzip header written
+#if defined(MCP_HAVE_ZSTD)
+        ZSTD_CCtx *zstd = nullptr;
+
+        ~State() { ZSTD_freeCCtx(zstd); }
+#endif
+
+        /**
+         * @brief Run the deflater over data, appending its output to out.
+         */
+        void run_deflate(std::string_view data, tdefl_flush flush, std::string &out) {
+            const char *next = data.data();
+            size_t left = data.size();
+            for (;;) {
+                size_t used = out.size();
+                size_t available = std::max<size_t>(left / 2, 4096);
+                out.resize(used + available);
+                size_t in_size = left;
+                size_t out_size = available;
+                tdefl_status status = tdefl_compress(deflate.get(), next, &in_size, out.data() + used, &out_size, flush);
+                next += in_size;
+                left -= in_size;
+                out.resize(used + out_size);
+                if (status == TDEFL_STATUS_DONE) {
+                    break;
+                }
+                if (status != TDEFL_STATUS_OKAY) {
+                    throw std::runtime_error("deflate compression failed");
+                }
+                // Without a flush all input taken is enough; a flush is complete once the output has room left
+                if (left == 0 && flush != TDEFL_FINISH && (flush == TDEFL_NO_FLUSH || out_size < available)) {
+                    break;
+                }
+            }
+        }
+
+#if defined(MCP_HAVE_ZSTD)
+        void run_zstd(std::string_view data, ZSTD_EndDirective mode, std::string &out) {
+            ZSTD_inBuffer input{data.data(), data.size(), 0};
+            for (;;) {
+                size_t used = out.size();
+                out.resize(used + ZSTD_CStreamOutSize());
+                ZSTD_outBuffer output{out.data() + used, out.size() - used, 0};
+                size_t remaining = ZSTD_compressStream2(zstd, &output, &input, mode);
+                out.resize(used + output.pos);
+                if (ZSTD_isError(remaining)) {
+                    throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(remaining));
+                }
+                bool done = mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+                if (done) {
+                    break;
+                }
+            }
+        }
+#endif
+    };
+
+    StreamCompressor::StreamCompressor(ContentEncoding encoding, int level)
+        : encoding_(encoding),
+          state_(std::make_unique<State>()) {
+        level = std::clamp(level, 1, 9);
+        switch (encoding) {
+            case ContentEncoding::Gzip:
+            case ContentEncoding::Deflate: {
+                // A negative window size makes a raw deflate stream, gzip has its own header and trailer
+                int window_bits = encoding == ContentEncoding::Gzip ? -MZ_DEFAULT_WINDOW_BITS : MZ_DEFAULT_WINDOW_BITS;
+                state_->deflate = std::make_unique<tdefl_compressor>();
+                mz_uint flags = tdefl_create_comp_flags_from_zip_params(level, window_bits, MZ_DEFAULT_STRATEGY);
+                if (tdefl_init(state_->deflate.get(), nullptr, nullptr, static_cast<int>(flags)) != TDEFL_STATUS_OKAY) {
+                    throw std::runtime_error("deflate initialization failed");
+                }
+                break;
+            }
+            case ContentEncoding::Zstd:
+#if defined(MCP_HAVE_ZSTD)
+                state_->zstd = ZSTD_createCCtx();
+                if (!state_->zstd) {
+                    throw std::runtime_error("zstd initialization failed");
+                }
+                ZSTD_CCtx_setParameter(state_->zstd, ZSTD_c_compressionLevel, level);
+                break;
+#else
+                throw std::runtime_error("zstd is not supported by this build");
+#endif
+            case ContentEncoding::Identity:
+                break;
+        }
+    }
+
+    StreamCompressor::~StreamCompressor() = default;
+
+    std::string StreamCompressor::compress(std::string_view data, bool flush) {
+        std::string out;
+        switch (encoding_) {
+            case ContentEncoding::Gzip:
+                if (!state_->started) {
+                    out.assign(kGzipHeader);
+                    state_->started = true;
+                }
+                state_->crc = mz_crc32(state_->crc, reinterpret_cast<const unsigned char *>(data.data()), data.size());
+                state_->size += static_cast<uint32_t>(data.size());
+                [[fallthrough]];
+            case ContentEncoding::Deflate:
+                state_->run_deflate(data, flush ? TDEFL_SYNC_FLUSH : TDEFL_NO_FLUSH, out);
+                break;
+            case ContentEncoding::Zstd:
+#if defined(MCP_HAVE_ZSTD)
+                state_->run_zstd(data, flush ? ZSTD_e_flush : ZSTD_e_continue, out);
+#endif
+                break;
+            case ContentEncoding::Identity:
+                out.assign(data);
+                break;
+        }
+        return out;
+    }
+
+    std::string StreamCompressor::finish() {
+        std::string out;
+        switch (encoding_) {
+            case ContentEncoding::Gzip:
+                if (!state_->started) {
+                    out.assign(kGzipHeader);
+                    state_->started = true;
+                }
+                state_->run_deflate({}, TDEFL_FINISH, out);
+                append_le32(out, static_cast<uint32_t>(state_->crc));
+                append_le32(out, state_->size);
+                break;
+            case ContentEncoding::Deflate:
+                state_->run_deflate({}, TDEFL_FINISH, out);
+                break;
+            case ContentEncoding::Zstd:
+#if defined(MCP_HAVE_ZSTD)
+                state_->run_zstd({}, ZSTD_e_end, out);
+#endif
+                break;
+            case ContentEncoding::Identity:
+                break;
+        }
+        return out;
+    }
+
+}// namespace mcp::transport
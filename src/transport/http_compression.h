@@ -0,0 +1,182 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "header_map.h"
+#include <asio.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Content codings of a message body.
+     */
+    enum class ContentEncoding {
+        Identity,///< Sent as it is
+        Gzip,
+        Deflate,///< zlib format, which is what HTTP calls "deflate"
+        Zstd,   ///< Only offered when built with zstd (MCP_HAVE_ZSTD)
+    };
+
+    /**
+     * @brief Response compression settings, normally taken from the [server] config section.
+     */
+    struct CompressionOptions {
+        bool enabled = false;                      ///< Compress responses for clients that send Accept-Encoding
+        size_t min_size = 1024;                    ///< Smaller bodies go out as they are
+        int level = 6;                             ///< 1 (fastest) to 9 (smallest), used as the zstd level as well
+        size_t offload_size = 64 * 1024;           ///< Bodies at least this large are (de)compressed on the tool pool, not the io thread
+        bool streaming = true;                     ///< Compress event streams and chunked resource reads while they are sent
+        bool decode_requests = true;               ///< Accept request bodies with Content-Encoding
+        size_t max_decoded_size = 16 * 1024 * 1024;///< Largest decompressed request body, larger ones are rejected with 413
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const CompressionOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const CompressionOptions &current();
+    };
+
+    /**
+     * @brief Pick the coding of an Accept-Encoding header value.
+     * The coding with the highest q-value wins; ties go to zstd, then gzip, then deflate.
+     * @param accept_encoding Header value, such as "gzip, deflate;q=0.5"
+     * @return Coding to use, Identity if none is both accepted and supported
+     */
+    ContentEncoding negotiate_encoding(std::string_view accept_encoding);
+
+    /**
+     * @brief Coding of a response with a body of known size.
+     * @param request_headers Headers of the request being answered
+     * @param body_size Size of the uncompressed body
+     * @return Identity if compression is disabled, the body is below min_size or the client accepts no coding
+     */
+    ContentEncoding response_encoding(const HeaderMap &request_headers, size_t body_size);
+
+    /**
+     * @brief Coding of a response that is written as it is produced (event streams, chunked bodies).
+     * @param request_headers Headers of the request being answered
+     * @return Identity if compression or streaming compression is disabled
+     */
+    ContentEncoding stream_encoding(const HeaderMap &request_headers);
+
+    /**
+     * @brief Token of a coding in Content-Encoding, such as "gzip".
+     */
+    std::string_view encoding_name(ContentEncoding encoding);
+
+    /**
+     * @brief Header lines announcing a coding, empty for Identity.
+     * @return "Content-Encoding: <coding>\r\nVary: Accept-Encoding\r\n"
+     */
+    std::string encoding_header(ContentEncoding encoding);
+
+    /**
+     * @brief Outcome of decompressing a request body.
+     */
+    enum class DecodeResult {
+        Ok,
+        TooLarge,///< The decompressed body would exceed the limit
+        Invalid, ///< Corrupt or truncated data
+    };
+
+    /**
+     * @brief Coding named by a request's Content-Encoding header.
+     * @param content_encoding Header value, such as "gzip"; empty or "identity" for none
+     * @return Coding, std::nullopt if it is one this server can't decode (or a list of several)
+     */
+    std::optional<ContentEncoding> parse_content_encoding(std::string_view content_encoding);
+
+    /**
+     * @brief Decompress a request body.
+     * The output grows as it is inflated and never beyond max_size, so a small body that would
+     * expand without bound (a decompression bomb) is stopped at the limit.
+     * @param data Compressed body
+     * @param encoding Coding of the body; for deflate both zlib and raw streams are accepted
+     * @param max_size Largest decompressed size, 0 for no limit
+     * @param out Decompressed body
+     */
+    DecodeResult decompress(std::string_view data, ContentEncoding encoding, size_t max_size, std::string &out);
+
+    /**
+     * @brief Decompress a request body up to max_decoded_size.
+     * Bodies of at least offload_size are decompressed on the tool pool, the caller is resumed
+     * on its own executor.
+     * @param data Compressed body, valid until the awaitable completes
+     * @param encoding Coding from parse_content_encoding()
+     * @param out Decompressed body
+     */
+    asio::awaitable<DecodeResult> decompress_request(std::string_view data, ContentEncoding encoding, std::string &out);
+
+    /**
+     * @brief Compress a whole body.
+     * @throws std::runtime_error If the coding is not supported by this build
+     */
+    std::string compress(std::string_view data, ContentEncoding encoding, int level);
+
+    /**
+     * @brief Compress a response body and finish its header.
+     *
+     * Bodies of at least offload_size are compressed on the tool pool, the caller is resumed on
+     * its own executor. Content-Encoding, Vary and Content-Length are appended to the header,
+     * followed by the blank line. A body that does not get smaller is sent as it is.
+     * @param header Header block without Content-Length and the final blank line
+     * @param body Body, replaced by its compressed form
+     * @param encoding Coding from response_encoding()
+     */
+    asio::awaitable<void> compress_response(std::string &header, std::string &body, ContentEncoding encoding);
+
+    /**
+     * @brief Compresses a body that is sent piece by piece.
+     *
+     * Every compress() call ends with a flush, so the client can decode everything it has
+     * received so far: an event is readable as soon as it arrives. finish() writes the end of
+     * the stream.
+     */
+    class StreamCompressor {
+    public:
+        /**
+         * @throws std::runtime_error If the coding is not supported by this build
+         */
+        StreamCompressor(ContentEncoding encoding, int level);
+        ~StreamCompressor();
+
+        StreamCompressor(const StreamCompressor &) = delete;
+        StreamCompressor &operator=(const StreamCompressor &) = delete;
+
+        /**
+         * @brief Compress the next piece of the body.
+         * @param data Uncompressed data
+         * @param flush Make everything so far decodable; pass false for all but the last piece of a batch
+         * @return Compressed data, possibly empty when flush is false
+         */
+        std::string compress(std::string_view data, bool flush = true);
+
+        /**
+         * @brief End the stream.
+         * @return The last compressed bytes, with the coding's trailer
+         */
+        std::string finish();
+
+        ContentEncoding encoding() const { return encoding_; }
+
+    private:
+        struct State;
+
+        ContentEncoding encoding_;
+        std::unique_ptr<State> state_;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,56 @@
+#include "http_framer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace mcp::transport {
+
+    asio::mutable_buffer HttpRequestFramer::prepare(size_t min_size) {
+        // Size the read for the rest of a body whose length is already known
+        min_size = std::max(min_size, std::min(parser_.bytes_missing(), kMaxReadAhead));
+
+        size_t capacity = buffer_.size();
+        if (capacity - end_ < min_size) {
+            size_t pending = end_ - begin_;
+            if (begin_ > 0 && capacity - pending >= min_size) {
+                // Enough room once consumed bytes are dropped; the parser works on
+                // offsets relative to begin_, so moving the data keeps its state valid
+                std::memmove(buffer_.data(), buffer_.data() + begin_, pending);
+            } else {
+                auto grown = PooledBuffer::acquire(std::max(capacity * 2, pending + min_size));
+                if (pending > 0) {
+                    std::memcpy(grown.data(), buffer_.data() + begin_, pending);
+                }
+                buffer_ = std::move(grown);// The old buffer goes back to the pool
+            }
+            begin_ = 0;
+            end_ = pending;
+        }
+        return asio::buffer(buffer_.data() + end_, buffer_.size() - end_);
+    }
+
+    HttpRequestParser::Status HttpRequestFramer::next() {
+        if (begin_ == end_) {
+            return HttpRequestParser::Status::Incomplete;
+        }
+        return parser_.parse(buffer_.data() + begin_, end_ - begin_);
+    }
+
+    void HttpRequestFramer::consume() noexcept {
+        begin_ = std::min(begin_ + parser_.message_size(), end_);
+        if (begin_ == end_) {
+            // Nothing pipelined behind this request, rewind and give the buffer back
+            begin_ = 0;
+            end_ = 0;
+            buffer_.reset();
+        }
+        parser_.reset();
+    }
+
+    void HttpRequestFramer::discard() noexcept {
+        begin_ = 0;
+        end_ = 0;
+        buffer_.reset();
+        parser_.reset();
+    }
+
+}// namespace mcp::transport
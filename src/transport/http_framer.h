@@ -0,0 +1,131 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "http_parser.h"
+#include "read_buffer_pool.h"
+#include <asio.hpp>
+#include <cstddef>
+#include <string>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Splits the byte stream of a connection into HTTP requests.
+     *
+     * Owns the connection read buffer and keeps a read cursor into it. Requests are
+     * framed and parsed in a single pass by HttpRequestParser, and the resulting view
+     * (headers and body) points straight into the buffer, so the session can hand it
+     * to HttpHandler without copying. Consumed bytes are only compacted away when the
+     * buffer runs out of tail space, which keeps pipelined traffic linear in cost.
+     *
+     * The buffer is borrowed from the PooledBuffer pool and handed back as soon as all
+     * received bytes are consumed, so idle connections hold no read memory. Once the
+     * length of a body is known, reads are sized for the rest of it instead of a fixed chunk.
+     */
+    class HttpRequestFramer {
+    public:
+        static constexpr size_t kReadChunkSize = 4096;     ///< Minimum free space offered per read
+        static constexpr size_t kMaxReadAhead = 1024 * 1024;///< Upper bound for sizing a read after the body length
+
+        /**
+         * @brief Get a writable region at the end of the buffer for the next read.
+         * Invalidates the view returned by request().
+         * @param min_size Minimum number of free bytes required
+         * @return Buffer to read into
+         */
+        asio::mutable_buffer prepare(size_t min_size = kReadChunkSize);
+
+        /**
+         * @brief Mark bytes written into the prepared region as received.
+         * @param n Number of bytes read
+         */
+        void commit(size_t n) noexcept { end_ += n; }
+
+        /**
+         * @brief Try to frame the next request from the buffered data.
+         * @return Complete when request() is ready, Incomplete if more data is needed
+         */
+        HttpRequestParser::Status next();
+
+        /**
+         * @brief Get the framed request. Valid until consume() or prepare() is called.
+         * @return Request view
+         */
+        const HttpRequestView &request() const noexcept { return parser_.request(); }
+
+        /**
+         * @brief Number of bytes the framed request occupied on the wire.
+         * @return Request size in bytes
+         */
+        size_t request_size() const noexcept { return parser_.message_size(); }
+
+        /**
+         * @brief Drop the framed request and advance the read cursor to the next one.
+         * Returns the buffer to the pool when nothing else is buffered.
+         */
+        void consume() noexcept;
+
+        /**
+         * @brief Number of received bytes not yet consumed.
+         * @return Buffered byte count
+         */
+        size_t buffered() const noexcept { return end_ - begin_; }
+
+        /**
+         * @brief Whether the headers of the request being received are complete.
+         * @return true if only (part of) the body is missing
+         */
+        bool headers_complete() const noexcept { return parser_.headers_complete(); }
+
+        /**
+         * @brief Headers and the part of the body received so far of a Content-Length request
+         * whose body is still arriving. Valid until prepare() is called.
+         * @return Request view
+         */
+        const HttpRequestView &partial_request() noexcept {
+            return parser_.partial_request(std::string_view(buffer_.data() + begin_, end_ - begin_));
+        }
+
+        /**
+         * @brief Declared body length of the request being received.
+         */
+        size_t content_length() const noexcept { return parser_.content_length(); }
+
+        /**
+         * @brief Size of the request line and headers of the request being received.
+         */
+        size_t header_size() const noexcept { return parser_.header_size(); }
+
+        /**
+         * @brief Whether the request being received has a chunked body.
+         */
+        bool is_chunked() const noexcept { return parser_.is_chunked(); }
+
+        /**
+         * @brief Body bytes of the request being received that have not arrived yet.
+         */
+        size_t body_missing() const noexcept { return parser_.bytes_missing(); }
+
+        /**
+         * @brief Drop the request being received, after its caller read the rest of its body off
+         * the connection itself. Everything buffered belongs to that request.
+         */
+        void discard() noexcept;
+
+        /**
+         * @brief Copy of the received bytes not yet consumed, for a protocol taking the connection over.
+         * @return Buffered bytes
+         */
+        std::string unconsumed() const { return begin_ == end_ ? std::string() : std::string(buffer_.data() + begin_, end_ - begin_); }
+
+    private:
+        PooledBuffer buffer_;
+        size_t begin_ = 0;///< Read cursor: first byte of the current request
+        size_t end_ = 0;  ///< End of received data
+        HttpRequestParser parser_;
+    };
+
+}// namespace mcp::transport
@@ -1,14 +1,29 @@
 #include "http_handler.h"
+#include "core/io_context_pool.hpp"
 #include "core/logger.h"
+#include "core/startup_timeline.h"
+#include "cluster_quota.h"
+#include "connection_timeouts.h"
+#include "http_compression.h"
+#include "http_framer.h"
+#include "memfd_handoff.h"
 #include "metrics/metrics_manager.h"
 #include "metrics/performance_metrics.h"
+#include "metrics/profiler.h"
 #include "metrics/rate_limiter.h"
-#include "nlohmann/json.hpp"
+#include "notification_broadcast.h"
+#include "protocol/json_rpc.h"
 #include "session.h"
+#include "sse_send_queue.h"
 #include "ssl_session.h"
+#include "tcp_session.h"
+#include "traffic_capture.h"
+#include "websocket.h"
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <charconv>
+#include <future>
 #include <sstream>
 
 
@@ -17,18 +32,238 @@ using asio::use_awaitable;
 
 namespace mcp::transport {
 
+    namespace {
+        MetricsEndpointOptions &metrics_endpoint_storage() {
+            static MetricsEndpointOptions options;
+            return options;
+        }
+
+        DebugEndpointOptions &debug_endpoint_storage() {
+            static DebugEndpointOptions options;
+            return options;
+        }
+
+        AdminEndpointOptions &admin_endpoint_storage() {
+            static AdminEndpointOptions options;
+            return options;
+        }
+
+        // Only HTTP/1 connections can pass the owner's response through byte for byte
+        bool relays_raw_http(Session &session) {
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+            if (dynamic_cast<UnixSession *>(&session)) {
+                return true;
+            }
+#endif
+            return dynamic_cast<TcpSession *>(&session) || dynamic_cast<SslSession *>(&session);
+        }
+
+        // Hop-by-hop headers, and the ones the forwarded request sets itself
+        bool is_forwarding_header(std::string_view name) {
+            return iequals(name, "Connection") || iequals(name, "Keep-Alive") || iequals(name, "Transfer-Encoding") ||
+                   iequals(name, "Content-Length") || iequals(name, "X-Mcp-Forwarded-By");
+        }
+
+        /**
+         * @brief Queue a complete response of a /debug/pprof/ endpoint.
+         * @return Size of the body
+         */
+        size_t queue_debug_response(Session &session, std::string_view status, std::string_view content_type,
+                                    std::string body, std::string_view extra_headers = {}) {
+            size_t size = body.size();
+            std::string header = "HTTP/1.1 ";
+            header += status;
+            header += "\r\nContent-Type: ";
+            header += content_type;
+            header += "\r\nServer: MCPServer++\r\nConnection: keep-alive\r\n";
+            header += extra_headers;
+            header += "Content-Length: ";
+            header += std::to_string(size);
+            header += "\r\n\r\n";
+            session.queue_write(std::move(header), std::move(body));
+            return size;
+        }
+
+        /**
+         * @brief Sessions and requests of every io_context, by pool.
+         */
+        nlohmann::json io_pool_activity() {
+            nlohmann::json pools = nlohmann::json::array();
+            for (const auto &pool: AsioIOServicePool::Snapshot()) {
+                nlohmann::json contexts = nlohmann::json::array();
+                size_t sessions = 0;
+                size_t requests = 0;
+                for (const auto &context: pool.contexts) {
+                    nlohmann::json entry = {{"sessions", context.sessions}, {"requests", context.requests}};
+                    if (pool.lag_probed) {
+                        entry["lag_us"] = context.lag_us;
+                        entry["shed"] = context.shed;
+                    }
+                    if (pool.busy_poll) {
+                        entry["busy_poll_us"] = context.spin_us;
+                    }
+                    contexts.push_back(std::move(entry));
+                    sessions += context.sessions;
+                    requests += context.requests;
+                }
+                pools.push_back({{"name", pool.name}, {"sessions", sessions}, {"requests", requests}, {"io_contexts", std::move(contexts)}});
+            }
+            return pools;
+        }
+
+        /**
+         * @brief Value of a query parameter, empty if the query lacks it.
+         */
+        std::string_view query_parameter(std::string_view query, std::string_view name) {
+            while (!query.empty()) {
+                size_t amp = query.find('&');
+                std::string_view pair = query.substr(0, amp);
+                query = amp == std::string_view::npos ? std::string_view{} : query.substr(amp + 1);
+                size_t eq = pair.find('=');
+                if (pair.substr(0, eq) == name) {
+                    return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+                }
+            }
+            return {};
+        }
+
+        /**
+         * @brief Answer a GET with an event stream that carries the session's server notifications.
+         * It is served until the client goes away, see Session::wait_for_disconnect().
+         */
+        awaitable<void> serve_event_stream(std::shared_ptr<Session> session) {
+            auto encoding = stream_encoding(session->get_headers());
+            std::string header = "HTTP/1.1 200 OK\r\n";
+            header += "Content-Type: text/event-stream\r\n";
+            header += "Cache-Control: no-cache, no-transform\r\n";
+            header += encoding_header(encoding);
+            header += "Connection: keep-alive\r\n";
+            header += "Mcp-Session-Id: " + session->get_session_id() + "\r\n";
+            header += "\r\n";
+            co_await session->write(header);
+            if (session->is_closed()) {
+                co_return;
+            }
+
+            auto queue = SseSendQueue::create(session, SseQueueOptions::current(), encoding);
+            session->set_notification_stream(queue);
+            // The client's channel: its requests on other connections send their server messages here
+            auto channel = NotificationBroadcast::instance().listen(session->get_executor(), queue, session->client_session_id());
+            MCP_DEBUG("Event stream opened - session: {}", session->get_session_id());
+
+            // A drain ends the stream, the client opens it again on another replica
+            auto drain_watch = Drain::instance().watch(session->get_executor(), [weak = std::weak_ptr<Session>(session)]() {
+                if (auto stream = weak.lock()) {
+                    stream->close();
+                }
+            });
+
+            co_await session->wait_for_disconnect();
+
+            MCP_DEBUG("Event stream closed - session: {}", session->get_session_id());
+            session->set_notification_stream(nullptr);
+            channel = {};
+            co_await queue->drain();
+            session->close();
+        }
+
+        /**
+         * @brief Answer a WebSocket upgrade; once the 101 response is written the session hands its
+         *        socket to the WebSocket connection, see Session::set_upgrade().
+         */
+        awaitable<void> accept_websocket(std::shared_ptr<Session> session, const HttpRequestView &view, HttpHandler *handler) {
+            std::string_view key = view.get_header("Sec-WebSocket-Key");
+            if (view.get_header("Sec-WebSocket-Version") != "13") {
+                co_await session->write(std::string("HTTP/1.1 426 Upgrade Required\r\n"
+                                                    "Sec-WebSocket-Version: 13\r\n"
+                                                    "Content-Length: 0\r\n\r\n"));
+                co_return;
+            }
+            if (key.size() != 24) {
+                co_await session->write(std::string("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n"));
+                co_return;
+            }
+
+            auto connection = std::make_shared<WebSocketConnection>(session, view);
+            std::string response = "HTTP/1.1 101 Switching Protocols\r\n";
+            response += "Upgrade: websocket\r\n";
+            response += "Connection: Upgrade\r\n";
+            response += "Sec-WebSocket-Accept: " + websocket_accept_key(key) + "\r\n";
+            if (has_token(view.get_header("Sec-WebSocket-Protocol"), "mcp")) {
+                response += "Sec-WebSocket-Protocol: mcp\r\n";
+            }
+            response += "\r\n";
+            co_await session->write(response);
+            if (session->is_closed()) {
+                co_return;
+            }
+
+            MCP_DEBUG("WebSocket upgrade accepted - session: {}", session->get_session_id());
+            session->set_upgrade([connection, handler](std::string buffered) {
+                return connection->run(handler, std::move(buffered));
+            });
+        }
+    }// namespace
+
+    void MetricsEndpointOptions::configure(const MetricsEndpointOptions &options) {
+        metrics_endpoint_storage() = options;
+    }
+
+    const MetricsEndpointOptions &MetricsEndpointOptions::current() {
+        return metrics_endpoint_storage();
+    }
+
+    void DebugEndpointOptions::configure(const DebugEndpointOptions &options) {
+        debug_endpoint_storage() = options;
+    }
+
+    const DebugEndpointOptions &DebugEndpointOptions::current() {
+        return debug_endpoint_storage();
+    }
+
+    void AdminEndpointOptions::configure(const AdminEndpointOptions &options) {
+        admin_endpoint_storage() = options;
+    }
+
+    const AdminEndpointOptions &AdminEndpointOptions::current() {
+        return admin_endpoint_storage();
+    }
+
     HttpHandler::HttpHandler(MessageCallback on_message, std::shared_ptr<AuthManagerBase> auth_manager)
         : on_message_(std::move(on_message)), auth_manager_(std::move(auth_manager)) {
         metrics_manager_ = mcp::metrics::MetricsManager::getInstance();
         rate_limiter_ = mcp::metrics::RateLimiter::getInstance();
+
+        // Resolve the built-in canned responses once instead of per request
+        auto &canned = CannedResponses::getInstance();
+        accepted_response_ = &canned.get(CannedResponses::kAccepted);
+        bad_request_response_ = &canned.get(CannedResponses::kBadRequest);
+        unauthorized_response_ = &canned.get(CannedResponses::kUnauthorized);
+        not_found_response_ = &canned.get(CannedResponses::kNotFound);
+        method_not_allowed_response_ = &canned.get(CannedResponses::kMethodNotAllowed);
+        too_large_response_ = &canned.get(CannedResponses::kTooLarge);
+        rate_limited_response_ = &canned.get(CannedResponses::kRateLimited);
+        not_allowed_response_ = &canned.get(CannedResponses::kNotAllowed);
+        internal_error_response_ = &canned.get(CannedResponses::kInternalError);
+        overloaded_response_ = &canned.get(CannedResponses::kOverloaded);
+        unsupported_encoding_response_ = &canned.get(CannedResponses::kUnsupportedEncoding);
+        lagging_response_ = &canned.register_response(
+                CannedResponses::kLagging, 503, R"({"error":"Server overloaded, try again later"})", "application/json",
+                "Retry-After: " + std::to_string(OverloadOptions::current().retry_after.count()) + "\r\n");
+
+        // Requests are captured for mcp_replay while the capture is on
+        if (TrafficCapture::instance().enabled()) {
+            set_before_request_callback([](const HttpRequest &request, const std::string &session_id) {
+                TrafficCapture::instance().record(request, session_id);
+            });
+        }
     }
 
-    // Helper function: get value from unordered_map headers
+    // Helper function: get value from parsed headers
     std::string HttpHandler::get_header_value(
-            const std::unordered_map<std::string, std::string> &headers,
+            const HeaderMap &headers,
             const std::string &key) {
-        auto it = headers.find(key);
-        return (it != headers.end()) ? it->second : "";
+        return std::string(headers.get(key));
     }
 
     // Helper function: get value from raw string headers
@@ -52,97 +287,30 @@ namespace mcp::transport {
         return "";
     }
 
-    // Parse HTTP request (unique implementation, remove duplicate definitions)
-    std::optional<HttpRequest> HttpHandler::parse_request(const std::string &raw_request) {
-        HttpRequest req;
-        std::istringstream iss(raw_request);
-        std::string line;
-
-        // Parse request line (method, target, version)
-        if (!std::getline(iss, line)) {
-            return std::nullopt;
-        }
-        // Remove trailing \r character
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        std::istringstream request_line(line);
-        request_line >> req.method >> req.target >> req.version;
-        if (request_line.fail()) {
-            return std::nullopt;
-        }
-
-        // Parse headers
-        while (std::getline(iss, line)) {
-            // Remove trailing \r character
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
-            }
-            // Headers end marker (empty line)
-            if (line.empty()) {
-                break;
-            }
-            size_t colon_pos = line.find(':');
-            if (colon_pos == std::string::npos) {
-                continue;// Invalid header format, skip
-            }
-            std::string key = line.substr(0, colon_pos);
-            std::string value = line.substr(colon_pos + 1);
-            // Trim whitespace from value
-            size_t start = value.find_first_not_of(" ");
-            size_t end = value.find_last_not_of(" ");
-            if (start != std::string::npos && end != std::string::npos) {
-                req.headers[key] = value.substr(start, end - start + 1);
-            }
-        }
-
-        // Parse body (based on Content-Length)
-        if (req.headers.count("Content-Length")) {
-            try {
-                size_t content_len = std::stoull(req.headers["Content-Length"]);
-                // Read remaining request body data
-                char *body_buf = new char[content_len + 1];
-                iss.read(body_buf, content_len);
-                body_buf[content_len] = '\0';
-                req.body = std::string(body_buf, content_len);
-                delete[] body_buf;
-            } catch (...) {
-                return std::nullopt;// Parsing failed
-            }
-        }
-
-        return req;
-    }
-
-    // Clean existing buffer
-    asio::awaitable<void> HttpHandler::discard_existing_buffer(std::shared_ptr<Session> session) {
-        // Check if there is pending data to send, discard if exists
-        if (session->get_socket().available()) {
-            std::array<char, 4096> buffer;
-            while (session->get_socket().available()) {
-                // Asynchronously read and discard data
-                co_await session->get_socket().async_read_some(
-                        asio::buffer(buffer),
-                        use_awaitable);
-            }
-        }
-        co_return;
+    // Describe a request for metrics and rate limiting without copying any of it
+    mcp::metrics::TrackedHttpRequest HttpHandler::describe_request(const HttpRequestView &view, size_t request_size, const Session &session) {
+        mcp::metrics::TrackedHttpRequest tracked;
+        tracked.method = view.method;
+        tracked.target = view.target;
+        tracked.version = view.version;
+        tracked.body = view.body;
+        tracked.header_count = view.header_count;
+        tracked.request_size = request_size;
+        tracked.session_id = session.get_session_id();
+        tracked.headers = &session.get_headers();
+        return tracked;
     }
 
-    // Clean existing buffer for SSL sessions
-    asio::awaitable<void> HttpHandler::discard_existing_buffer(std::shared_ptr<SslSession> session) {
-        // Check if there is pending data to send, discard if exists
-        asio::error_code ec;
-        if (session->get_stream().lowest_layer().available(ec) && !ec) {
-            std::array<char, 4096> buffer;
-            while (session->get_stream().lowest_layer().available(ec) && !ec) {
-                // Asynchronously read and discard data
-                co_await session->get_stream().async_read_some(
-                        asio::buffer(buffer),
-                        use_awaitable);
-            }
+    // Copy the parsed view into a request whose strings live in the caller's arena
+    void HttpHandler::materialize_request(const HttpRequestView &view, HttpRequest &req) {
+        req.method.assign(view.method);
+        req.target.assign(view.target);
+        req.version.assign(view.version);
+        req.headers.reserve(view.header_count);
+        for (size_t i = 0; i < view.header_count; ++i) {
+            req.headers.emplace(view.headers[i].name, view.headers[i].value);
         }
-        co_return;
+        req.body.assign(view.body);
     }
 
     /**
@@ -202,113 +370,87 @@ namespace mcp::transport {
             const std::string &body,
             int status_code,
             bool is_chunked) {
-        // Map status codes to human-readable descriptions
-        std::string status_str;
-        switch (status_code) {
-            case 200:
-                status_str = "OK";
-                break;
-            case 201:
-                status_str = "Created";
-                break;
-            case 202:
-                status_str = "Accepted";
-                break;
-            case 204:
-                status_str = "No Content";
-                break;
-            case 400:
-                status_str = "Bad Request";
-                break;
-            case 401:
-                status_str = "Unauthorized";
-                break;
-            case 403:
-                status_str = "Forbidden";
-                break;
-            case 404:
-                status_str = "Not Found";
-                break;
-            case 405:
-                status_str = "Method Not Allowed";
-                break;
-            case 500:
-                status_str = "Internal Server Error";
-                break;
-            case 501:
-                status_str = "Not Implemented";
-                break;
-            case 503:
-                status_str = "Service Unavailable";
-                break;
-            default:
-                status_str = "Unknown";
-        }
-
-        // Build HTTP response
-        std::ostringstream oss;
-        oss << "HTTP/1.1 " << status_code << " " << status_str << "\r\n";
+        // Connection management based on client request and server policy
+        bool keep_alive = keep_alive_requested(*session);
 
-        // Add standard headers
-        oss << "Content-Type: application/json\r\n";
-        oss << "Server: MCPServer++\r\n";
+        // No body for 202/204 responses
+        bool has_body = status_code != 202 && status_code != 204;
 
-        // Add Content-Length header (except for chunked responses)
-        if (!is_chunked) {
-            oss << "Content-Length: " << body.size() << "\r\n";
-        } else {
-            oss << "Transfer-Encoding: chunked\r\n";
+        // A large body for a local client that asked goes in a sealed memfd, the response only refers to it
+        std::optional<SealedMemfd> memfd;
+        if constexpr (std::is_same_v<SessionType, Session>) {
+            if (!is_chunked && has_body && wants_memfd(*session, body.size())) {
+                memfd = SealedMemfd::create(body);
+            }
         }
 
-        // Connection management based on client request and server policy
-        std::string client_connection = get_header_value(session->get_headers(), "Connection");
-        bool keep_alive = (client_connection.empty() || strcasecmp(client_connection.c_str(), "close") != 0);
-
-        if (!client_connection.empty()) {
-            // Respect client's connection preference if specified
-            keep_alive = (strcasecmp(client_connection.c_str(), "keep-alive") == 0);
-        }
+        // Render the header block; the body is never copied into it
+        std::string header;
+        header.reserve(160);
+        header += "HTTP/1.1 ";
+        header += std::to_string(status_code);
+        header += ' ';
+        header += http_status_text(status_code);
+        header += "\r\nContent-Type: ";
+        header += memfd ? kMemfdContentType : std::string_view("application/json");
+        header += "\r\nServer: MCPServer++\r\n";
 
         // Set connection header and keep-alive parameters
         if (keep_alive) {
-            oss << "Connection: keep-alive\r\n";
-            oss << "Keep-Alive: timeout=300, max=100\r\n";// 5-minute timeout, max 100 requests
+            header += "Connection: keep-alive\r\nKeep-Alive: timeout=300, max=100\r\n";// 5-minute timeout, max 100 requests
         } else {
-            oss << "Connection: close\r\n";
+            header += "Connection: close\r\n";
         }
 
-        // End of headers marker (CRLF)
-        oss << "\r\n";
-
-        // Append response body only for non-202/204 status codes
-        if (status_code != 202 && status_code != 204 && !is_chunked) {
-            oss << body;
+        if (memfd) {
+            // Header block and envelope go in one message, the descriptor attached to its first byte
+            std::string envelope = memfd_envelope(body.size());
+            header += "Content-Length: ";
+            header += std::to_string(envelope.size());
+            header += "\r\n\r\n";
+            header += envelope;
+            FileSlice slice;
+            slice.fd = memfd->fd();
+            slice.bytes = header;
+            slice.pass_descriptor = true;
+            co_await session->write_file({}, slice, {});
+            MCP_DEBUG("Handed a {} byte response over in a memfd (Session: {})", body.size(), session->get_session_id());
+            if (!keep_alive) {
+                session->close();
+            }
+            co_return;
         }
 
-        // Ensure buffer is clean before sending
-        co_await discard_existing_buffer(session);
-
-        // Send the complete response
-        std::string response = oss.str();
-
-        if (is_chunked) {
-            // For chunked responses, we send the headers first
-            co_await session->write(response);
-
-            // Then send the body as a chunk
-            if (!body.empty()) {
-                std::ostringstream chunk_stream;
-                chunk_stream << std::hex << body.size() << "\r\n"
-                             << body << "\r\n";
-                std::string chunk = chunk_stream.str();
-                co_await session->write(chunk);
-            }
+        // Compressed bodies get their Content-Length once their size is known
+        auto encoding = !is_chunked && has_body ? response_encoding(session->get_headers(), body.size()) : ContentEncoding::Identity;
+        std::string compressed;
+        if (encoding != ContentEncoding::Identity) {
+            compressed = body;
+            co_await compress_response(header, compressed, encoding);
+        } else if (!is_chunked) {
+            header += "Content-Length: ";
+            header += std::to_string(has_body ? body.size() : 0);
+            header += "\r\n\r\n";
         } else {
-            // For regular responses, send everything at once
-            if (status_code != 202 && status_code != 204) {
-                response += body;
-            }
-            co_await session->write(response);
+            header += "Transfer-Encoding: chunked\r\n\r\n";
+        }
+        const std::string &payload = encoding != ContentEncoding::Identity ? compressed : body;
+
+
+        // Send header block and body (or first chunk) in a single gather write
+        if (is_chunked && !body.empty()) {
+            ChunkSizeLine size_line(body.size());
+            std::array<asio::const_buffer, 4> buffers = {
+                    asio::buffer(header),
+                    size_line.buffer(),
+                    asio::buffer(body),
+                    asio::buffer("\r\n", 2)};
+            co_await session->write_buffers(buffers);
+        } else if (!is_chunked && has_body && !payload.empty()) {
+            std::array<asio::const_buffer, 2> buffers = {asio::buffer(header), asio::buffer(payload)};
+            co_await session->write_buffers(buffers);
+        } else {
+            co_await session->write(header);
         }
 
         if constexpr (std::is_same_v<SessionType, Session>) {
@@ -328,63 +470,475 @@ namespace mcp::transport {
         co_return;
     }
 
+    // Connection management based on client request and server policy
+    bool HttpHandler::keep_alive_requested(const Session &session) {
+        if (Drain::draining()) {
+            return false;// The next request should reach another replica
+        }
+        std::string client_connection = get_header_value(session.get_headers(), "Connection");
+        if (client_connection.empty()) {
+            return true;// HTTP/1.1 defaults to persistent connections
+        }
+        // Respect client's connection preference if specified
+        return strcasecmp(client_connection.c_str(), "keep-alive") == 0;
+    }
+
+    size_t HttpHandler::queue_metrics_response(Session &session) {
+        std::string body = metrics_manager_->render_prometheus();
+        size_t size = body.size();
+        std::string header = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nServer: MCPServer++\r\n";
+        header += "Connection: keep-alive\r\n";
+
+        // Scrapes ask for gzip, the exposition compresses well
+        auto encoding = response_encoding(session.get_headers(), size);
+        if (encoding != ContentEncoding::Identity) {
+            session.queue_write(std::move(header), std::move(body), encoding);
+            return size;
+        }
+        header += "Content-Length: ";
+        header += std::to_string(size);
+        header += "\r\n\r\n";
+        session.queue_write(std::move(header), std::move(body));
+        return size;
+    }
+
+    size_t HttpHandler::queue_stats_response(Session &session) {
+        const auto &gauges = metrics_manager_->runtime_gauges();
+        auto tcp = gauges.tcp_sessions.load(std::memory_order_relaxed);
+        auto ssl = gauges.ssl_sessions.load(std::memory_order_relaxed);
+        auto unix_sessions = gauges.unix_sessions.load(std::memory_order_relaxed);
+
+        // Session objects only, their read buffers come from the frame pool and are not counted
+        int64_t session_bytes = tcp * static_cast<int64_t>(sizeof(TcpSession)) + ssl * static_cast<int64_t>(sizeof(SslSession));
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        session_bytes += unix_sessions * static_cast<int64_t>(sizeof(UnixSession));
+#endif
+
+        nlohmann::json caches = nlohmann::json::object();
+        int64_t cache_bytes = 0;
+        for (const auto &[name, stats]: metrics_manager_->get_cache_stats()) {
+            caches[name] = {{"entries", stats.entries},
+                            {"resident_bytes", stats.resident_bytes},
+                            {"hit_rate", stats.hit_rate},
+                            {"evictions", stats.evictions},
+                            {"expirations", stats.expirations}};
+            cache_bytes += stats.resident_bytes;
+        }
+        auto process = metrics::process_memory();
+
+        nlohmann::json body = {
+                {"sessions", {{"tcp", tcp}, {"ssl", ssl}, {"unix", unix_sessions}}},
+                {"stream_generators", gauges.stream_generators.load(std::memory_order_relaxed)},
+                {"plugin_calls", gauges.plugin_calls.load(std::memory_order_relaxed)},
+                {"caches", std::move(caches)},
+                {"memory", {{"sessions_bytes", session_bytes},
+                            {"caches_bytes", cache_bytes},
+                            {"rss_bytes", process.rss_bytes},
+                            {"heap_allocated_bytes", process.heap_allocated},
+                            {"heap_resident_bytes", process.heap_resident},
+                            {"allocator", process.allocator}}},
+                {"rate_limiter_sessions", metrics::RateLimiter::getInstance()->tracked_sessions()},
+                {"pools", io_pool_activity()}};
+        if (fair_scheduler_.enabled()) {
+            nlohmann::json tenants = nlohmann::json::array();
+            for (const auto &tenant: fair_scheduler_.stats()) {
+                tenants.push_back({{"tenant", tenant.tenant},
+                                   {"weight", tenant.weight},
+                                   {"slots", tenant.slots},
+                                   {"running", tenant.running},
+                                   {"queued", tenant.queued},
+                                   {"dispatched", tenant.dispatched}});
+            }
+            body["fair_scheduling"] = std::move(tenants);
+        }
+        if (Cluster::instance().enabled()) {
+            nlohmann::json members = nlohmann::json::array();
+            for (const auto &member: Cluster::instance().members()) {
+                members.push_back({{"id", member.id},
+                                   {"address", member.address},
+                                   {"heartbeat", member.heartbeat},
+                                   {"silent_ms", member.silent_ms},
+                                   {"alive", member.alive}});
+            }
+            body["cluster"] = {{"node", Cluster::instance().node_id()}, {"members", std::move(members)}};
+        }
+        if (ClusterQuota::instance().enabled()) {
+            nlohmann::json tenants = nlohmann::json::array();
+            for (const auto &tenant: ClusterQuota::instance().stats()) {
+                tenants.push_back({{"tenant", tenant.tenant},
+                                   {"limit", tenant.limit},
+                                   {"local_rate", tenant.local_rate},
+                                   {"peer_rate", tenant.peer_rate},
+                                   {"allowed_rate", tenant.allowed_rate}});
+            }
+            body["tenant_rate_limits"] = std::move(tenants);
+        }
+        return queue_debug_response(session, "200 OK", "application/json", body.dump());
+    }
+
+    size_t HttpHandler::queue_ready_response(Session &session) {
+        const auto &timeline = core::StartupTimeline::instance();
+        bool draining = Drain::draining();
+        bool ready = timeline.ready() && !draining;
+        nlohmann::json body = {
+                {"ready", ready},
+                {"draining", draining},
+                {"uptime_ms", timeline.uptime().count()},
+                {"startup", timeline.to_json()}};
+        return queue_debug_response(session, ready ? "200 OK" : "503 Service Unavailable", "application/json", body.dump());
+    }
+
+    awaitable<size_t> HttpHandler::serve_debug_request(Session &session, std::string_view target) {
+        size_t question = target.find('?');
+        std::string_view path = target.substr(0, question);
+        std::string_view query = question == std::string_view::npos ? std::string_view{} : target.substr(question + 1);
+
+        if (path == "/debug/pprof/profile") {
+            auto &profiler = metrics::CpuProfiler::instance();
+            if (!metrics::CpuProfiler::supported()) {
+                co_return queue_debug_response(session, "501 Not Implemented", "text/plain", "CPU profiles are not supported on this platform\n");
+            }
+            size_t seconds = 30;
+            std::string_view requested = query_parameter(query, "seconds");
+            if (!requested.empty()) {
+                auto [ptr, ec] = std::from_chars(requested.data(), requested.data() + requested.size(), seconds);
+                if (ec != std::errc() || ptr != requested.data() + requested.size() || seconds == 0) {
+                    co_return queue_debug_response(session, "400 Bad Request", "text/plain", "seconds must be a positive integer\n");
+                }
+            }
+            seconds = std::min(seconds, debug_endpoint_storage().max_profile_seconds);
+            if (!profiler.start()) {
+                co_return queue_debug_response(session, "409 Conflict", "text/plain", "A CPU profile is already running\n");
+            }
+
+            // The io thread keeps serving while the profile runs; the profile is stopped even
+            // if the io_context shuts down first and this coroutine is destroyed
+            struct StopOnExit {
+                bool armed = true;
+                ~StopOnExit() {
+                    if (armed) {
+                        metrics::CpuProfiler::instance().stop();
+                    }
+                }
+            } stop_on_exit;
+            asio::steady_timer timer(co_await asio::this_coro::executor, std::chrono::seconds(seconds));
+            co_await timer.async_wait(use_awaitable);
+            stop_on_exit.armed = false;
+            std::string profile = profiler.stop();
+
+            // pprof expects the protobuf gzipped, as the file itself rather than a content coding
+            co_return queue_debug_response(session, "200 OK", "application/octet-stream", compress(profile, ContentEncoding::Gzip, 6),
+                                           "Content-Disposition: attachment; filename=\"profile.pb.gz\"\r\n");
+        }
+
+        if (path == "/debug/pprof/heap") {
+            std::string error;
+            auto profile = metrics::heap_profile(error);
+            if (!profile) {
+                co_return queue_debug_response(session, "501 Not Implemented", "text/plain", error + "\n");
+            }
+            std::string disposition = "Content-Disposition: attachment; filename=\"heap." + profile->allocator + "\"\r\n";
+            co_return queue_debug_response(session, "200 OK", "application/octet-stream", std::move(profile->data), disposition);
+        }
+
+        if (path == "/debug/pprof/runtime") {
+            nlohmann::json body = {{"pools", io_pool_activity()}, {"cpu_profile_supported", metrics::CpuProfiler::supported()}};
+            co_return queue_debug_response(session, "200 OK", "application/json", body.dump());
+        }
+
+        co_return queue_debug_response(session, "404 Not Found", "text/plain", "Unknown profile, use profile, heap or runtime\n");
+    }
+
+    awaitable<size_t> HttpHandler::serve_admin_request(Session &session, const HttpRequestView &view) {
+        const auto &admin = admin_endpoint_storage();
+        std::string_view presented = view.get_header("X-Admin-Token");
+        if (presented.size() != admin.token.size() || CRYPTO_memcmp(presented.data(), admin.token.data(), presented.size()) != 0) {
+            MCP_WARN("Admin request without a valid X-Admin-Token (Session: {})", session.get_session_id());
+            co_return queue_debug_response(session, "403 Forbidden", "text/plain", "X-Admin-Token is missing or wrong\n");
+        }
+        if (view.method != "GET" && view.method != "POST") {
+            co_return queue_debug_response(session, "405 Method Not Allowed", "text/plain", "Use GET to read the settings, POST to change them\n",
+                                           "Allow: GET, POST\r\n");
+        }
+
+        nlohmann::json changes;
+        if (view.method == "POST") {
+            changes = nlohmann::json::parse(view.body, nullptr, false);
+            if (!changes.is_object()) {
+                co_return queue_debug_response(session, "400 Bad Request", "text/plain", "The body must be a JSON object of settings\n");
+            }
+        }
+        std::string error;
+        auto body = co_await asio::co_spawn(
+                tool_pool_.control_executor(),
+                [&admin, &changes, &error, post = view.method == "POST"]() -> asio::awaitable<nlohmann::json> {
+                    try {
+                        co_return post ? admin.apply(changes) : admin.read();
+                    } catch (const std::invalid_argument &e) {
+                        error = e.what();
+                    }
+                    co_return nlohmann::json();
+                },
+                use_awaitable);
+        if (!error.empty()) {
+            co_return queue_debug_response(session, "400 Bad Request", "text/plain", error + "\n");
+        }
+        if (view.method == "POST") {
+            MCP_INFO("Admin changed settings: {} (Session: {})", changes.dump(), session.get_session_id());
+        }
+        co_return queue_debug_response(session, "200 OK", "application/json", body.dump());
+    }
+
+    template<typename SessionType>
+    asio::awaitable<void> HttpHandler::send_canned_response(std::shared_ptr<SessionType> session, const CannedResponse &response) {
+        bool keep_alive = keep_alive_requested(*session);
+
+        const std::string &rendered = response.render(keep_alive);
+        co_await session->write(rendered);
+        session->finish_trace(response.status_code, rendered.size());
+
+        MCP_DEBUG("Sent canned {} response (Session: {})", response.status_code, session->get_session_id());
+
+        // Close connection only if explicitly requested
+        if (!keep_alive) {
+            session->close();
+        }
+        co_return;
+    }
+
+    template<typename SessionType>
+    asio::awaitable<size_t> HttpHandler::forward_to_owner(std::shared_ptr<SessionType> session, const HttpRequestView &view,
+                                                          const HashRing::Node &owner) {
+        const auto &options = ClusterOptions::current();
+        std::string request;
+        request.reserve(256 + view.body.size());
+        request.append(view.method).append(" ").append(view.target).append(" HTTP/1.1\r\n");
+        for (size_t i = 0; i < view.header_count; ++i) {
+            const auto &header = view.headers[i];
+            if (!is_forwarding_header(header.name)) {
+                request.append(header.name).append(": ").append(header.value).append("\r\n");
+            }
+        }
+        request.append("X-Mcp-Forwarded-By: ").append(Cluster::instance().node_id()).append("\r\n");
+        request.append("Connection: close\r\nContent-Length: ").append(std::to_string(view.body.size())).append("\r\n\r\n");
+        request.append(view.body);
+
+        // The owner answers with Connection: close, so its response ends where its stream does
+        auto executor = session->get_executor();
+        auto upstream = std::make_shared<asio::ip::tcp::socket>(executor);
+        asio::steady_timer deadline(executor, options.forward_timeout);
+        deadline.async_wait([upstream](const asio::error_code &ec) {
+            if (!ec) {
+                asio::error_code ignored;
+                upstream->close(ignored);
+            }
+        });
+
+        size_t relayed = 0;
+        int status = 502;
+        asio::error_code ec;
+        auto colon = owner.address.rfind(':');
+        asio::ip::tcp::resolver resolver(executor);
+        auto endpoints = co_await resolver.async_resolve(owner.address.substr(0, colon), owner.address.substr(colon + 1),
+                                                         asio::redirect_error(use_awaitable, ec));
+        if (!ec) {
+            co_await asio::async_connect(*upstream, endpoints, asio::redirect_error(use_awaitable, ec));
+        }
+        if (!ec) {
+            co_await asio::async_write(*upstream, asio::buffer(request), asio::redirect_error(use_awaitable, ec));
+        }
+
+        std::array<char, 16 * 1024> buffer;
+        while (!ec && !session->is_closed()) {
+            size_t n = co_await upstream->async_read_some(asio::buffer(buffer), asio::redirect_error(use_awaitable, ec));
+            if (n == 0) {
+                continue;
+            }
+            if (relayed == 0) {
+                deadline.cancel();// Streams may stay open for as long as the owner keeps them
+                std::string_view head(buffer.data(), n);
+                if (head.starts_with("HTTP/1.") && head.size() >= 12) {
+                    std::from_chars(head.data() + 9, head.data() + 12, status);
+                }
+            }
+            co_await session->write(std::string(buffer.data(), n));
+            relayed += n;
+        }
+        deadline.cancel();
+        upstream->close(ec);
+
+        if (relayed == 0) {
+            MCP_WARN("Session {} could not be forwarded to cluster node {} at {}", view.get_header("Mcp-Session-Id"), owner.id, owner.address);
+            co_await send_canned_response(session, *lagging_response_);
+            session->close();
+            co_return lagging_response_->body.size();
+        }
+        MCP_DEBUG("Relayed {} bytes from cluster node {} (Session: {})", relayed, owner.id, session->get_session_id());
+        session->finish_trace(status, relayed);
+        session->close();
+        co_return relayed;
+    }
+
     // Main request handling logic
     awaitable<void> HttpHandler::handle_request(
             std::shared_ptr<Session> session,
-            const std::string &raw_request) {
-        return handle_request_impl(session, raw_request);
+            const HttpRequestView *request,
+            size_t request_size) {
+        return handle_request_impl(session, request, request_size);
     }
 
     // Main request handling logic for SSL sessions
     awaitable<void> HttpHandler::handle_request(
             std::shared_ptr<SslSession> session,
-            const std::string &raw_request) {
-        return handle_request_impl(session, raw_request);
+            const HttpRequestView *request,
+            size_t request_size) {
+        return handle_request_impl(session, request, request_size);
+    }
+
+    UploadScan HttpHandler::scan_upload(HttpRequestFramer &framer, StreamedArgument &argument) const {
+        const auto &options = UploadOptions::current();
+        if (options.stream_threshold == 0 || framer.is_chunked() || framer.content_length() < options.stream_threshold) {
+            return UploadScan::Buffered;
+        }
+        const HttpRequestView &view = framer.partial_request();
+        if (view.method != "POST" || (view.target != "/mcp" && view.target != "/tools/call")) {
+            return UploadScan::Buffered;
+        }
+        return find_streamed_argument(view.body, streamed_argument_lookup(), argument);
+    }
+
+    awaitable<bool> HttpHandler::handle_upload(std::shared_ptr<Session> session, HttpRequestFramer &framer,
+                                               StreamedArgument argument, ConnectionDeadline &deadline) {
+        return handle_upload_impl(session, framer, std::move(argument), deadline);
+    }
+
+    awaitable<bool> HttpHandler::handle_upload(std::shared_ptr<SslSession> session, HttpRequestFramer &framer,
+                                               StreamedArgument argument, ConnectionDeadline &deadline) {
+        return handle_upload_impl(session, framer, std::move(argument), deadline);
+    }
+
+    template<typename SessionType>
+    awaitable<bool> HttpHandler::handle_upload_impl(std::shared_ptr<SessionType> session, HttpRequestFramer &framer,
+                                                    StreamedArgument argument, ConnectionDeadline &deadline) {
+        HttpRequestView view = framer.partial_request();
+        const size_t request_size = framer.header_size() + framer.content_length();
+
+        // The rate limiter only sees the body without the streamed value, so its size is checked here
+        const size_t max_size = UploadOptions::current().max_size;
+        if (max_size > 0 && framer.content_length() > max_size) {
+            MCP_WARN("Upload too large - Session: {}, Size: {}, Max: {}", session->get_session_id(), framer.content_length(), max_size);
+            co_await send_canned_response(session, *too_large_response_);
+            co_return false;// The body is not read, the connection cannot carry on
+        }
+
+        // The plugin pulls on its own thread and waits while the read runs on the session's executor.
+        // Once the request is answered, pulls no longer touch the deadline, which is the read loop's
+        auto reading = std::make_shared<bool>(true);
+        UploadStream::Pull pull = [session, reading, &deadline](char *data, size_t size) -> size_t {
+            std::promise<size_t> done;
+            auto result = done.get_future();
+            asio::co_spawn(
+                    session->get_executor(),
+                    [&]() -> awaitable<void> {
+                        size_t n = 0;
+                        try {
+                            if (*reading) {
+                                deadline.enter(ConnectionPhase::Body);
+                            }
+                            n = co_await session->read_some(asio::buffer(data, size));
+                        } catch (const std::exception &) {
+                            // The connection ended, the upload fails
+                        }
+                        if (*reading) {
+                            deadline.enter(ConnectionPhase::Handling);
+                        }
+                        done.set_value(n);
+                    },
+                    asio::detached);
+            return result.get();
+        };
+        auto upload = std::make_shared<UploadStream>(view.body.substr(argument.value_offset), framer.body_missing(),
+                                                     std::move(argument.closers), std::move(pull));
+        view.body = argument.skeleton;
+        MCP_DEBUG("Streaming a {} byte request body into its tool (Session: {})", framer.content_length(), session->get_session_id());
+
+        session->set_upload(upload);
+        co_await handle_request_impl(session, &view, request_size);
+        session->take_upload();// Left if the request was refused before it reached the tool
+        *reading = false;
+        if (!upload->finished()) {
+            // Whatever is left of the body cannot be told apart from the next request
+            co_return false;
+        }
+        framer.discard();
+        co_return true;
     }
 
     template<typename SessionType>
     awaitable<void> HttpHandler::handle_request_impl(
             std::shared_ptr<SessionType> session,
-            const std::string &raw_request) {
+            const HttpRequestView *request,
+            size_t request_size) {
+        auto active = IOServiceActivity::CountRequest();
         // Start performance tracking
-        auto metrics = mcp::metrics::PerformanceTracker::start_tracking(raw_request.size());
-
-        // Parse HTTP request
-        size_t bytes_parsed = 0;// New variable to record parsed bytes
-        auto req_opt = parse_request(raw_request);
-        bool is_valid_request = req_opt.has_value();
-        HttpRequest req;
+        auto metrics = mcp::metrics::PerformanceTracker::start_tracking(request_size);
+
+        // The session already framed and parsed the request; the views point into its read buffer
+        static const HttpRequestView empty_view;
+        bool is_valid_request = request != nullptr;
+        const HttpRequestView &view = is_valid_request ? *request : empty_view;
+        // Request-scoped copies are bump-allocated and released together when the handler returns
+        RequestArena arena;
+        HttpRequest req(arena.resource());
         if (is_valid_request) {
-            req = *req_opt;
-            // Calculate parsed bytes
-            bytes_parsed = req.method.size() + 1 + req.target.size() + 1 + req.version.size() + 2;// Request line length
-            for (const auto &[key, value]: req.headers) {
-                bytes_parsed += key.size() + 2 + value.size() + 2;// Each header length
+            session->set_headers(view);//save headers
+            // Only the AOP callbacks need an owning copy of the request
+            if (before_request_callback_ || after_request_callback_) {
+                materialize_request(view, req);
             }
-            bytes_parsed += 2;                // Empty line ending headers
-            bytes_parsed += req.body.size();  // Body length
-            session->set_headers(req.headers);//save headers
         }
 
-        if (auth_manager_) {
-            if (!auth_manager_->validate(req.headers)) {
+        // Every request is timed while the access log is on; JSON-RPC requests may be sampled for tracing
+        session->start_trace(view.get_header("traceparent"), view.method == "POST");
+        if (auto *trace = session->trace()) {
+            trace->set_request(view.method, view.target, session->get_session_id(), request_size);
+        }
+
+        // Orchestrators probe readiness without credentials
+        const auto &ready_path = MetricsEndpointOptions::current().ready_path;
+        if (is_valid_request && !ready_path.empty() && view.method == "GET" && view.target == ready_path) {
+            queue_ready_response(*session);
+            co_return;
+        }
+
+        // Clients authenticated by their peer credentials need no header check
+        if (auth_manager_ && !session->peer_authenticated()) {
+            static const HeaderMap no_headers;
+            const auto &auth_headers = is_valid_request ? session->get_headers() : no_headers;
+            auto accepted = auth_manager_->validate_fast(auth_headers, session->auth_decision());
+            if (!accepted) {
+                // A token not seen before has its signature checked on the tool pool, not the io thread
+                accepted = co_await asio::co_spawn(
+                        tool_pool_.executor(),
+                        [this, &auth_headers, &session]() -> asio::awaitable<bool> {
+                            co_return auth_manager_->validate(auth_headers, session->auth_decision());
+                        },
+                        asio::use_awaitable);
+            }
+            if (!*accepted) {
                 MCP_WARN("Auth failed: invalid token (Session: {})", session->get_session_id());
-                co_await send_http_response(session, R"({"error":"Unauthorized"})", 401);
+                co_await send_canned_response(session, *unauthorized_response_);
                 session->close();
                 co_return;
             }
             MCP_DEBUG("Auth passed: {} (Session: {})", auth_manager_->type(), session->get_session_id());
         }
 
+        // Metrics and rate limiting only look at this non-owning descriptor
+        const mcp::metrics::TrackedHttpRequest tracked_req = describe_request(view, request_size, *session);
         bool error_occurred = false;
-        std::string error_response = R"({"error":"Internal Server Error"})";
 
         try {
-            // Key: process remaining request body regardless of request validity
-            if (is_valid_request && req.headers.count("Content-Length")) {
-                co_await discard_remaining_request_body(session, req, bytes_parsed);
-            }
-
             // Handle invalid request
             if (!is_valid_request) {
                 // AOP: Before request callback for invalid requests
@@ -393,12 +947,66 @@ namespace mcp::transport {
                     before_request_callback_(empty_req, session->get_session_id());
                 }
 
-                co_await send_http_response_impl(session, R"({"error":"Invalid HTTP request"})", 400);
+                co_await send_canned_response(session, *bad_request_response_);
 
                 // End performance tracking for invalid requests
-                mcp::metrics::PerformanceTracker::end_tracking(metrics, error_response.size());
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, bad_request_response_->body.size());
+                metrics_manager_->report_performance(
+                        tracked_req,
+                        metrics,
+                        session->get_session_id());
+
+                co_return;
+            }
+
+            // Built-in metrics, behind the same authentication as the MCP endpoints
+            const auto &metrics_path = MetricsEndpointOptions::current().path;
+            if (!metrics_path.empty() && view.method == "GET" && view.target == metrics_path) {
+                size_t size = queue_metrics_response(*session);
+
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, size);
                 metrics_manager_->report_performance(
-                        mcp::metrics::TrackedHttpRequest{},
+                        tracked_req,
+                        metrics,
+                        session->get_session_id());
+
+                co_return;
+            }
+
+            const auto &stats_path = MetricsEndpointOptions::current().stats_path;
+            if (!stats_path.empty() && view.method == "GET" && view.target == stats_path) {
+                size_t size = queue_stats_response(*session);
+
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, size);
+                metrics_manager_->report_performance(
+                        tracked_req,
+                        metrics,
+                        session->get_session_id());
+
+                co_return;
+            }
+
+            // Runtime settings, behind the same authentication and the admin token
+            const auto &admin = admin_endpoint_storage();
+            if (!admin.token.empty() && view.target == admin.path) {
+                size_t size = co_await serve_admin_request(*session, view);
+
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, size);
+                metrics_manager_->report_performance(
+                        tracked_req,
+                        metrics,
+                        session->get_session_id());
+
+                co_return;
+            }
+
+            // Profiling endpoints, behind the same authentication
+            if (view.method == "GET" && view.target.starts_with("/debug/pprof/") && debug_endpoint_storage().enabled) {
+                size_t size = co_await serve_debug_request(*session, view.target);
+
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, size);
+                metrics_manager_->report_performance(
+                        tracked_req,
                         metrics,
                         session->get_session_id());
 
@@ -406,9 +1014,9 @@ namespace mcp::transport {
             }
 
             // Validate path - support both /mcp and MCP tool endpoints
-            bool is_valid_path = (req.target == "/mcp") ||
-                                 (req.target == "/tools/list") ||
-                                 (req.target == "/tools/call");
+            bool is_valid_path = (view.target == "/mcp") ||
+                                 (view.target == "/tools/list") ||
+                                 (view.target == "/tools/call");
 
             if (!is_valid_path) {
                 // AOP: Before request callback for invalid path requests
@@ -416,17 +1024,10 @@ namespace mcp::transport {
                     before_request_callback_(req, session->get_session_id());
                 }
 
-                std::string not_found_response = R"({"error":"Not Found"})";
-                co_await send_http_response_impl(session, not_found_response, 404);
+                co_await send_canned_response(session, *not_found_response_);
 
                 // End performance tracking for not found requests
-                mcp::metrics::PerformanceTracker::end_tracking(metrics, not_found_response.size());
-                mcp::metrics::TrackedHttpRequest tracked_req;
-                tracked_req.method = req.method;
-                tracked_req.target = req.target;
-                tracked_req.version = req.version;
-                tracked_req.headers = req.headers;
-                tracked_req.body = req.body;
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, not_found_response_->body.size());
 
                 metrics_manager_->report_performance(
                         tracked_req,
@@ -436,99 +1037,111 @@ namespace mcp::transport {
                 co_return;
             }
 
+            // Sessions another cluster node owns are served there; the owner applies the limits
+            auto &cluster = Cluster::instance();
+            if (cluster.enabled() && relays_raw_http(*session) && !view.has_header("X-Mcp-Forwarded-By") && !is_websocket_upgrade(view)) {
+                std::string_view presented = view.get_header("Mcp-Session-Id");
+                if (auto owner = presented.empty() ? std::nullopt : cluster.remote_owner(presented)) {
+                    size_t size = co_await forward_to_owner(session, view, *owner);
+
+                    mcp::metrics::PerformanceTracker::end_tracking(metrics, size);
+                    metrics_manager_->report_performance(
+                            tracked_req,
+                            metrics,
+                            session->get_session_id());
+
+                    co_return;
+                }
+            }
+
             // AOP: Before request callback
             if (before_request_callback_) {
                 before_request_callback_(req, session->get_session_id());
             }
 
             // Rate limiting check
-            rate_limiter_->report_request_started(session->get_session_id());
-            mcp::metrics::TrackedHttpRequest tracked_req_for_rate_limiting;
-            tracked_req_for_rate_limiting.method = req.method;
-            tracked_req_for_rate_limiting.target = req.target;
-            tracked_req_for_rate_limiting.version = req.version;
-            tracked_req_for_rate_limiting.headers = req.headers;
-            tracked_req_for_rate_limiting.body = req.body;
-
+            mcp::metrics::ActiveRequest active_request(*rate_limiter_, session->get_session_id());
             auto rate_limit_decision = rate_limiter_->check_request_allowed(
-                    tracked_req_for_rate_limiting,
+                    tracked_req,
                     session->get_session_id());
+            // The tenant's share of its cluster-wide limit, checked locally
+            if (rate_limit_decision == mcp::metrics::RateLimitDecision::ALLOW && ClusterQuota::instance().enabled()) {
+                auto tenant = ClusterQuota::tenant_of(session->get_headers(), &session->auth_decision());
+                if (!tenant.empty() && !ClusterQuota::instance().try_acquire(tenant)) {
+                    MCP_DEBUG("Tenant rate limit exceeded - Session: {}", session->get_session_id());
+                    rate_limit_decision = mcp::metrics::RateLimitDecision::RATE_LIMITED;
+                }
+            }
 
             if (rate_limit_decision != mcp::metrics::RateLimitDecision::ALLOW) {
-                std::string rate_limit_response;
-                int status_code = 429;// Too Many Requests
+                const CannedResponse *rate_limit_response = not_allowed_response_;// 429 Too Many Requests
 
                 switch (rate_limit_decision) {
                     case mcp::metrics::RateLimitDecision::RATE_LIMITED:
-                        rate_limit_response = R"({"error":"Rate limit exceeded"})";
+                        rate_limit_response = rate_limited_response_;
                         break;
                     case mcp::metrics::RateLimitDecision::TOO_LARGE:
-                        rate_limit_response = R"({"error":"Request too large"})";
-                        status_code = 413;// Payload Too Large
+                        rate_limit_response = too_large_response_;// 413 Payload Too Large
                         break;
                     default:
-                        rate_limit_response = R"({"error":"Request not allowed"})";
                         break;
                 }
 
-                co_await send_http_response_impl(session, rate_limit_response, status_code);
+                co_await send_canned_response(session, *rate_limit_response);
 
                 // End performance tracking for rate limited requests
-                mcp::metrics::PerformanceTracker::end_tracking(metrics, rate_limit_response.size());
-                mcp::metrics::TrackedHttpRequest tracked_req;
-                tracked_req.method = req.method;
-                tracked_req.target = req.target;
-                tracked_req.version = req.version;
-                tracked_req.headers = req.headers;
-                tracked_req.body = req.body;
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, rate_limit_response->body.size());
 
                 metrics_manager_->report_performance(
                         tracked_req,
                         metrics,
                         session->get_session_id());
 
-                rate_limiter_->report_request_completed(session->get_session_id());
-
                 co_return;
             }
 
             std::string session_id = session->get_session_id();
             MCP_DEBUG("Using session from TCP connection: {}", session_id);
-            MCP_DEBUG("Request method: {}, target: {}", req.method, req.target);
+            MCP_DEBUG("Request method: {}, target: {}", view.method, view.target);
 
             // Handle GET request (SSE connection initialization)
-            if (req.method == "GET") {
-                std::string accept_header = get_header_value(req.headers, "Accept");
+            if (view.method == "GET") {
+                if (WebSocketOptions::current().enabled && view.version == "HTTP/1.1" && is_websocket_upgrade(view)) {
+                    // End performance tracking for upgrades, messages are tracked one by one
+                    mcp::metrics::PerformanceTracker::end_tracking(metrics, 0);
+
+                    metrics_manager_->report_performance(
+                            tracked_req,
+                            metrics,
+                            session->get_session_id());
+
+                    // Long-lived streams are logged when they open
+                    session->finish_trace(101, 0);
+                    co_await accept_websocket(session, view, this);
+                    co_return;
+                }
+
+                std::string accept_header(view.get_header("Accept"));
                 if (accept_header.find("text/event-stream") != std::string::npos) {
                     session->set_accept_header(accept_header);
 
                     // End performance tracking for SSE requests
                     mcp::metrics::PerformanceTracker::end_tracking(metrics, 0);
-                    mcp::metrics::TrackedHttpRequest tracked_req;
-                    tracked_req.method = req.method;
-                    tracked_req.target = req.target;
-                    tracked_req.version = req.version;
-                    tracked_req.headers = req.headers;
-                    tracked_req.body = req.body;
 
                     metrics_manager_->report_performance(
                             tracked_req,
                             metrics,
                             session->get_session_id());
 
-                    co_return;// Wait for business layer to send SSE header
+                    // Resource updates and other notifications go out on this stream
+                    session->finish_trace(200, 0);
+                    co_await serve_event_stream(session);
+                    co_return;
                 } else {
-                    std::string method_not_allowed_response = R"({"error":"Method Not Allowed"})";
-                    co_await send_http_response_impl(session, method_not_allowed_response, 405);
+                    co_await send_canned_response(session, *method_not_allowed_response_);
 
                     // End performance tracking for method not allowed requests
-                    mcp::metrics::PerformanceTracker::end_tracking(metrics, method_not_allowed_response.size());
-                    mcp::metrics::TrackedHttpRequest tracked_req;
-                    tracked_req.method = req.method;
-                    tracked_req.target = req.target;
-                    tracked_req.version = req.version;
-                    tracked_req.headers = req.headers;
-                    tracked_req.body = req.body;
+                    mcp::metrics::PerformanceTracker::end_tracking(metrics, method_not_allowed_response_->body.size());
 
                     metrics_manager_->report_performance(
                             tracked_req,
@@ -539,32 +1152,127 @@ namespace mcp::transport {
                 }
             }
             // Handle POST request (JSON-RPC)
-            else if (req.method == "POST") {
-                std::string accept_header = get_header_value(req.headers, "Accept");
-                session->set_accept_header(accept_header);
+            else if (view.method == "POST") {
+                session->set_accept_header(std::string(view.get_header("Accept")));
+
+                // A compressed body is inflated here, so max_request_size above limits the bytes
+                // on the wire and max_decoded_size what they may expand to
+                std::string_view body = view.body;
+                std::string decoded;
+                if (auto content_encoding = view.get_header("Content-Encoding"); !content_encoding.empty()) {
+                    auto encoding = parse_content_encoding(content_encoding);
+                    const CannedResponse *decode_error = nullptr;
+                    if (!encoding || (*encoding != ContentEncoding::Identity && !CompressionOptions::current().decode_requests)) {
+                        decode_error = unsupported_encoding_response_;// 415 Unsupported Media Type
+                    } else if (*encoding != ContentEncoding::Identity) {
+                        switch (co_await decompress_request(view.body, *encoding, decoded)) {
+                            case DecodeResult::Ok:
+                                body = decoded;
+                                break;
+                            case DecodeResult::TooLarge:
+                                decode_error = too_large_response_;
+                                break;
+                            case DecodeResult::Invalid:
+                                decode_error = bad_request_response_;
+                                break;
+                        }
+                    }
+                    if (decode_error) {
+                        co_await send_canned_response(session, *decode_error);
+
+                        mcp::metrics::PerformanceTracker::end_tracking(metrics, decode_error->body.size());
+                        metrics_manager_->report_performance(
+                                tracked_req,
+                                metrics,
+                                session->get_session_id());
+
+                        co_return;
+                    }
+                }
 
-                // Parse JSON-RPC request to determine if it's a notification (no id)
+                // Scan the JSON-RPC envelope to determine if it's a notification (no id); the body
+                // is only parsed into a DOM once, by the business layer
                 bool is_notification = false;
-                try {
-                    nlohmann::json rpc_request = nlohmann::json::parse(req.body);
-                    is_notification = !rpc_request.contains("id");// Notification has no id
-                } catch (...) {
-                    // Parsing failed, handle as regular request
+                bool is_control = false;
+                std::string tool_name;
+                if (auto envelope = protocol::scan_request_envelope(body)) {
+                    is_notification = !envelope->has_id();// Notification has no id
+                    auto method = protocol::decode_string(envelope->method).value_or("");
+                    if (method == "tools/call") {
+                        tool_name = protocol::decode_string(protocol::find_member(envelope->params, "name")).value_or("");
+                    }
+                    is_control = PriorityOptions::current().is_control(method, tool_name);
+                } else if (auto batch = protocol::scan_batch(body)) {
+                    // A batch of notifications only is not answered either; its tool calls are
+                    // admitted and moved to the tool pool one by one by the business layer
+                    const auto max_size = protocol::BatchOptions::current().max_size;
+                    is_notification = !batch->empty() && (max_size == 0 || batch->size() <= max_size) &&
+                                      std::all_of(batch->begin(), batch->end(), [](std::string_view entry) {
+                                          auto entry_envelope = protocol::scan_request_envelope(entry);
+                                          return entry_envelope && !entry_envelope->has_id();
+                                      });
+                }
+                // Otherwise parsing failed, handle as regular request
+
+                // Shed new work while this io thread is behind; control-plane requests such as
+                // health checks are still answered, they cost next to nothing
+                const auto lag_threshold = OverloadOptions::current().lag_threshold;
+                if (!is_control && lag_threshold.count() > 0 && IOServiceActivity::CurrentLag() > lag_threshold) {
+                    IOServiceActivity::Current()->shed.fetch_add(1, std::memory_order_relaxed);
+                    co_await send_canned_response(session, *lagging_response_);
+
+                    mcp::metrics::PerformanceTracker::end_tracking(metrics, lagging_response_->body.size());
+                    metrics_manager_->report_performance(
+                            tracked_req,
+                            metrics,
+                            session->get_session_id());
+
+                    co_return;
                 }
 
-                // Business layer processes the message
-                // For SslSession, we need to pass a dummy Session shared_ptr to match the callback signature
-                if constexpr (std::is_same_v<SessionType, Session>) {
-                    on_message_(req.body, session, session_id);
+                // Tool calls wait here (without blocking the io thread) while their limits are exhausted
+                // and then, with fair scheduling on, until it is their client's turn on the tool pool
+                AdmissionController::Permit permit;
+                FairScheduler::Turn turn;
+                if (!tool_name.empty() && !is_control && (admission_.enabled() || fair_scheduler_.enabled())) {
+                    bool admitted = true;
+                    if (admission_.enabled()) {
+                        permit = co_await admission_.acquire(tool_name);
+                        admitted = static_cast<bool>(permit);
+                    }
+                    if (admitted && fair_scheduler_.enabled()) {
+                        turn = co_await fair_scheduler_.acquire(fair_scheduler_.tenant_of(*session));
+                        admitted = static_cast<bool>(turn);
+                    }
+                    if (!admitted) {
+                        co_await send_canned_response(session, *overloaded_response_);
+
+                        mcp::metrics::PerformanceTracker::end_tracking(metrics, overloaded_response_->body.size());
+                        metrics_manager_->report_performance(
+                                tracked_req,
+                                metrics,
+                                session->get_session_id());
+
+                        co_return;
+                    }
+                }
+
+                // Business layer processes the message; the response is queued on the session.
+                // Tool calls may block (plugins do network and process I/O), so they run on the
+                // tool pool while this coroutine is suspended, then resume on the session's executor.
+                if (!tool_name.empty()) {
+                    auto executor = is_control ? tool_pool_.control_executor() : tool_pool_.executor();
+                    co_await asio::co_spawn(executor, on_message_(body, session, session_id), asio::use_awaitable);
                 } else {
-                    std::shared_ptr<Session> dummy_session = nullptr;
-                    on_message_(req.body, dummy_session, session_id);
+                    co_await on_message_(body, session, session_id);
                 }
+                turn.release();
+                permit.release();
 
                 // Core fix: send 202 response for notifications
                 if (is_notification) {
                     MCP_DEBUG("Sending 202 Accepted for notification (Session: {})", session->get_session_id());
-                    co_await send_http_response_impl(session, "", 202);// Empty body, 202 status code
+                    co_await send_canned_response(session, *accepted_response_);// Empty body, 202 status code
 
                     // AOP: After request callback for notifications
                     if (after_request_callback_) {
@@ -573,12 +1281,6 @@ namespace mcp::transport {
 
                     // End performance tracking for notifications
                     mcp::metrics::PerformanceTracker::end_tracking(metrics, 0);
-                    mcp::metrics::TrackedHttpRequest tracked_req;
-                    tracked_req.method = req.method;
-                    tracked_req.target = req.target;
-                    tracked_req.version = req.version;
-                    tracked_req.headers = req.headers;
-                    tracked_req.body = req.body;
 
                     metrics_manager_->report_performance(
                             tracked_req,
@@ -589,9 +1291,14 @@ namespace mcp::transport {
                 co_return;
             }
             // Handle DELETE request (end session)
-            else if (req.method == "DELETE") {
+            else if (view.method == "DELETE") {
                 MCP_INFO("Session terminated: {}", session_id);
-                co_await session->write("HTTP/1.1 204 No Content\r\n\r\n");
+                if (view.has_header("Mcp-Session-Id")) {
+                    NotificationBroadcast::instance().end_session(std::string(view.get_header("Mcp-Session-Id")));
+                }
+                static constexpr std::string_view no_content = "HTTP/1.1 204 No Content\r\n\r\n";
+                co_await session->write(std::string(no_content));
+                session->finish_trace(204, no_content.size());
                 session->close();
 
                 // AOP: After request callback for DELETE requests
@@ -601,43 +1308,26 @@ namespace mcp::transport {
 
                 // End performance tracking for DELETE requests
                 mcp::metrics::PerformanceTracker::end_tracking(metrics, 0);
-                mcp::metrics::TrackedHttpRequest tracked_req;
-                tracked_req.method = req.method;
-                tracked_req.target = req.target;
-                tracked_req.version = req.version;
-                tracked_req.headers = req.headers;
-                tracked_req.body = req.body;
 
                 metrics_manager_->report_performance(
                         tracked_req,
                         metrics,
                         session->get_session_id());
 
-                rate_limiter_->report_request_completed(session->get_session_id());
-
                 co_return;
             }
             // Unsupported method
             else {
-                std::string method_not_allowed_response = R"({"error":"Method Not Allowed"})";
-                co_await send_http_response_impl(session, method_not_allowed_response, 405);
+                co_await send_canned_response(session, *method_not_allowed_response_);
 
                 // End performance tracking for unsupported method requests
-                mcp::metrics::PerformanceTracker::end_tracking(metrics, method_not_allowed_response.size());
-                mcp::metrics::TrackedHttpRequest tracked_req;
-                tracked_req.method = req.method;
-                tracked_req.target = req.target;
-                tracked_req.version = req.version;
-                tracked_req.headers = req.headers;
-                tracked_req.body = req.body;
+                mcp::metrics::PerformanceTracker::end_tracking(metrics, method_not_allowed_response_->body.size());
 
                 metrics_manager_->report_performance(
                         tracked_req,
                         metrics,
                         session->get_session_id());
 
-                rate_limiter_->report_request_completed(session->get_session_id());
-
                 co_return;
             }
         } catch (const std::exception &e) {
@@ -652,108 +1342,20 @@ namespace mcp::transport {
             // Report error to metrics manager
             metrics_manager_->report_error(e.what(), session->get_session_id());
 
-            rate_limiter_->report_request_completed(session->get_session_id());
-
             session->close();
         }
 
         if (error_occurred) {
-            co_await send_http_response_impl(session, error_response, 500);
+            co_await send_canned_response(session, *internal_error_response_);
         }
 
         // End performance tracking for successful requests
-        mcp::metrics::PerformanceTracker::end_tracking(metrics, error_response.size());
-        mcp::metrics::TrackedHttpRequest tracked_req;
-        tracked_req.method = req.method;
-        tracked_req.target = req.target;
-        tracked_req.version = req.version;
-        tracked_req.headers = req.headers;
-        tracked_req.body = req.body;
+        mcp::metrics::PerformanceTracker::end_tracking(metrics, internal_error_response_->body.size());
 
         metrics_manager_->report_performance(
                 tracked_req,
                 metrics,
                 session->get_session_id());
-
-        rate_limiter_->report_request_completed(session->get_session_id());
-    }
-
-    // Helper function: fully read and discard remaining request body (avoid buffer residue)
-    asio::awaitable<void> HttpHandler::discard_remaining_request_body(std::shared_ptr<Session> session, const HttpRequest &request, [[maybe_unused]] size_t already_read) {
-        try {
-            auto it = request.headers.find("Content-Length");
-            if (it == request.headers.end()) {
-                co_return;
-            }
-
-            size_t content_len = std::stoull(it->second);
-
-            // Calculate already read body length
-            size_t already_read_body = request.body.size();
-
-            // Key: add underflow protection to avoid negative numbers (unsigned underflow)
-            if (already_read_body >= content_len) {
-                co_return;
-            }
-
-            size_t remaining = content_len - already_read_body;
-            if (remaining <= 0) {
-                co_return;
-            }
-
-            // Continue reading logic...
-            // Loop to read and discard remaining data
-            std::array<char, 4096> buf;
-            while (remaining > 0) {
-                size_t to_read = std::min(remaining, buf.size());
-                size_t n = co_await session->get_socket().async_read_some(
-                        asio::buffer(buf, to_read),
-                        use_awaitable);
-                remaining -= n;
-            }
-        } catch (const std::exception &e) {
-            MCP_WARN("Failed to discard remaining request body: {}", e.what());
-        }
-        co_return;
-    }
-
-    // Helper function: fully read and discard remaining request body for SSL sessions (avoid buffer residue)
-    asio::awaitable<void> HttpHandler::discard_remaining_request_body(std::shared_ptr<SslSession> session, const HttpRequest &request, [[maybe_unused]] size_t already_read) {
-        try {
-            auto it = request.headers.find("Content-Length");
-            if (it == request.headers.end()) {
-                co_return;
-            }
-
-            size_t content_len = std::stoull(it->second);
-
-            // Calculate already read body length
-            size_t already_read_body = request.body.size();
-
-            // Key: add underflow protection to avoid negative numbers (unsigned underflow)
-            if (already_read_body >= content_len) {
-                co_return;
-            }
-
-            size_t remaining = content_len - already_read_body;
-            if (remaining <= 0) {
-                co_return;
-            }
-
-            // Continue reading logic...
-            // Loop to read and discard remaining data
-            std::array<char, 4096> buf;
-            while (remaining > 0) {
-                size_t to_read = std::min(remaining, buf.size());
-                size_t n = co_await session->get_stream().async_read_some(
-                        asio::buffer(buf, to_read),
-                        use_awaitable);
-                remaining -= n;
-            }
-        } catch (const std::exception &e) {
-            MCP_WARN("Failed to discard remaining request body: {}", e.what());
-        }
-        co_return;
     }
 
     // Case-insensitive string comparison
@@ -823,10 +1425,12 @@ namespace mcp::transport {
             throw std::runtime_error("Session is not in streaming mode");
         }
 
-        std::ostringstream oss;
-        oss << std::hex << chunk.size() << "\r\n"
-            << chunk << "\r\n";
-        co_await session->write(oss.str());
+        ChunkSizeLine size_line(chunk.size());
+        std::array<asio::const_buffer, 3> buffers = {
+                size_line.buffer(),
+                asio::buffer(chunk),
+                asio::buffer("\r\n", 2)};
+        co_await session->write_buffers(buffers);
         co_return;
     }
 
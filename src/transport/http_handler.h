@@ -5,13 +5,23 @@
 #endif
 
 #include "Auth/AuthManager.hpp"
+#include "admission_controller.h"
+#include "canned_responses.h"
+#include "cluster.h"
+#include "core/tool_thread_pool.hpp"
+#include "fair_scheduler.h"
+#include "http_parser.h"
 #include "metrics/rate_limiter.h"
+#include "protocol/json_extern.h"
+#include "request_arena.h"
 #include "session.h"
 #include "ssl_session.h"
 #include "transport_types.h"
+#include "upload_stream.h"
 #include <asio.hpp>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -34,16 +44,93 @@ namespace mcp::transport {
     // Forward declarations
     class Session;
     class SslSession;
+    class HttpRequestFramer;
+    class ConnectionDeadline;
+
+    /**
+     * @brief Built-in Prometheus endpoint, normally taken from the [server] config section.
+     */
+    struct MetricsEndpointOptions {
+        std::string path = "/metrics";///< GET path of the exposition, empty to disable it
+        std::string stats_path;       ///< GET path of the JSON runtime statistics, such as "/admin/stats"; empty to disable them
+        std::string ready_path = "/readyz";///< GET path of the readiness probe, answered without authentication; empty to disable it
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const MetricsEndpointOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const MetricsEndpointOptions &current();
+    };
+
+    /**
+     * @brief Profiling endpoints under /debug/pprof/, normally taken from the [server] config section.
+     * They sit behind the same authentication as the MCP endpoints, see HttpHandler::serve_debug_request().
+     */
+    struct DebugEndpointOptions {
+        bool enabled = false;           ///< Serve /debug/pprof/profile, /debug/pprof/heap and /debug/pprof/runtime
+        size_t max_profile_seconds = 60;///< Longest CPU profile a request may ask for
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const DebugEndpointOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const DebugEndpointOptions &current();
+    };
+
+    /**
+     * @brief Endpoint that reads and changes settings while the server runs, normally taken from
+     *        the [server] config section. Its requests need the admin token on top of the
+     *        authentication of the MCP endpoints, see HttpHandler::serve_admin_request().
+     */
+    struct AdminEndpointOptions {
+        std::string path = "/admin/config";///< Path of the endpoint
+        std::string token;                 ///< Expected in X-Admin-Token, empty to disable the endpoint
+        std::function<nlohmann::json()> read;///< Effective settings, answered to a GET
+        /// Apply the settings of a POST body and return the effective ones; throws std::invalid_argument for a bad one
+        std::function<nlohmann::json(const nlohmann::json &)> apply;
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const AdminEndpointOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const AdminEndpointOptions &current();
+    };
 
     /**
      * @brief HTTP request structure for parsing incoming requests.
+     * Strings are allocated from the memory resource passed at construction, normally the
+     * RequestArena of the request being handled, so they must not outlive that request. Headers are
+     * kept like the session's, in a HeaderMap.
      */
     struct HttpRequest {
-        std::string method;                                  ///< HTTP method (GET, POST, etc.)
-        std::string target;                                  ///< Request target/URL
-        std::string version;                                 ///< HTTP version
-        std::unordered_map<std::string, std::string> headers;///< HTTP headers
-        std::string body;                                    ///< Request body
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+
+        explicit HttpRequest(allocator_type alloc = {})
+            : method(alloc), target(alloc), version(alloc), body(alloc) {}
+
+        std::pmr::string method;                                        ///< HTTP method (GET, POST, etc.)
+        std::pmr::string target;                                        ///< Request target/URL
+        std::pmr::string version;                                       ///< HTTP version
+        HeaderMap headers;                                              ///< HTTP headers
+        std::pmr::string body;                                          ///< Request body
     };
 
     /**
@@ -79,16 +166,46 @@ namespace mcp::transport {
         /**
          * @brief Process an HTTP request from a regular session.
          * @param session Active session
-         * @param raw_request Raw HTTP request string
+         * @param request Request framed by the session, nullptr if it was malformed
+         * @param request_size Size of the request on the wire
          */
-        asio::awaitable<void> handle_request(std::shared_ptr<Session> session, const std::string &raw_request);
+        asio::awaitable<void> handle_request(std::shared_ptr<Session> session, const HttpRequestView *request, size_t request_size);
 
         /**
          * @brief Process an HTTP request from an SSL session.
          * @param session Active SSL session
-         * @param raw_request Raw HTTP request string
+         * @param request Request framed by the session, nullptr if it was malformed
+         * @param request_size Size of the request on the wire
+         */
+        asio::awaitable<void> handle_request(std::shared_ptr<SslSession> session, const HttpRequestView *request, size_t request_size);
+
+        /**
+         * @brief Decide whether the request a session is receiving is an upload to stream into its plugin.
+         * Called by the read loops once the headers are in, and again as the body arrives while the
+         * answer is NeedMore.
+         * @param framer Framer of the session, holding an incomplete request
+         * @param argument Set when Streamed is returned
+         */
+        UploadScan scan_upload(HttpRequestFramer &framer, StreamedArgument &argument) const;
+
+        /**
+         * @brief Process a tools/call request whose streamed argument is still arriving.
+         * The request is handled with the argument's value left empty while its plugin pulls the value
+         * off the connection, see UploadStream. The request is then dropped from the framer.
+         * @param session Active session
+         * @param framer Framer of the session, for which scan_upload() returned Streamed
+         * @param argument Streamed argument found by scan_upload()
+         * @param deadline Deadline of the session's read loop, moved to the body phase while pulling
+         * @return true if the whole body was read, so the connection can carry on with the next request
          */
-        asio::awaitable<void> handle_request(std::shared_ptr<SslSession> session, const std::string &raw_request);
+        asio::awaitable<bool> handle_upload(std::shared_ptr<Session> session, HttpRequestFramer &framer,
+                                            StreamedArgument argument, ConnectionDeadline &deadline);
+
+        /**
+         * @brief Process a tools/call request whose streamed argument is still arriving, on an SSL session.
+         */
+        asio::awaitable<bool> handle_upload(std::shared_ptr<SslSession> session, HttpRequestFramer &framer,
+                                            StreamedArgument argument, ConnectionDeadline &deadline);
 
         /**
          * @brief Send an HTTP response to a regular session.
@@ -177,11 +294,28 @@ namespace mcp::transport {
         std::shared_ptr<AuthManagerBase> auth_manager_;
         std::shared_ptr<mcp::metrics::MetricsManager> metrics_manager_;
         std::shared_ptr<mcp::metrics::RateLimiter> rate_limiter_;
+        AdmissionController &admission_ = AdmissionController::getInstance();
+        FairScheduler &fair_scheduler_ = FairScheduler::getInstance();
+        mcp::core::ToolThreadPool &tool_pool_ = mcp::core::ToolThreadPool::instance();
 
         std::function<void(const HttpRequest &, const std::string &)> before_request_callback_;
         std::function<void(const HttpRequest &, const std::string &, int, const std::string &)> after_request_callback_;
         std::function<void(const std::string &, const std::string &)> on_error_callback_;
 
+        // Built-in canned responses, resolved once at construction
+        const CannedResponse *accepted_response_ = nullptr;
+        const CannedResponse *bad_request_response_ = nullptr;
+        const CannedResponse *unauthorized_response_ = nullptr;
+        const CannedResponse *not_found_response_ = nullptr;
+        const CannedResponse *method_not_allowed_response_ = nullptr;
+        const CannedResponse *too_large_response_ = nullptr;
+        const CannedResponse *rate_limited_response_ = nullptr;
+        const CannedResponse *not_allowed_response_ = nullptr;
+        const CannedResponse *internal_error_response_ = nullptr;
+        const CannedResponse *overloaded_response_ = nullptr;
+        const CannedResponse *lagging_response_ = nullptr;
+        const CannedResponse *unsupported_encoding_response_ = nullptr;
+
         /**
          * @brief Apply flow control policies to an incoming request.
          * @param session Active session
@@ -199,11 +333,20 @@ namespace mcp::transport {
         bool apply_flow_control(std::shared_ptr<SslSession> session, const HttpRequest &req);
 
         /**
-         * @brief Parse raw HTTP request into structured data.
-         * @param raw_request Raw HTTP request string
-         * @return Optional HttpRequest structure
+         * @brief Copy a parsed request view into an HttpRequest.
+         * @param view Parsed request view
+         * @param req Request to fill, usually allocated from a RequestArena
+         */
+        static void materialize_request(const HttpRequestView &view, HttpRequest &req);
+
+        /**
+         * @brief Build the non-owning request descriptor used by metrics and rate limiting.
+         * @param view Parsed request view
+         * @param request_size Bytes the request occupied on the wire
+         * @param session Session the request arrived on
+         * @return Descriptor pointing into view and session; valid while the request is handled
          */
-        std::optional<HttpRequest> parse_request(const std::string &raw_request);
+        static mcp::metrics::TrackedHttpRequest describe_request(const HttpRequestView &view, size_t request_size, const Session &session);
 
         /**
          * @brief Get header value from headers map (case-insensitive).
@@ -211,7 +354,7 @@ namespace mcp::transport {
          * @param key Header key to find
          * @return Header value or empty string
          */
-        static std::string get_header_value(const std::unordered_map<std::string, std::string> &headers, const std::string &key);
+        static std::string get_header_value(const HeaderMap &headers, const std::string &key);
 
         /**
          * @brief Get header value from raw headers string (case-insensitive).
@@ -222,50 +365,100 @@ namespace mcp::transport {
         static std::string get_header_value(const std::string &headers_str, const std::string &key);
 
         /**
-         * @brief Discard existing buffer data for a regular session.
+         * @brief Send HTTP response implementation (template method).
          * @param session Active session
+         * @param body Response body
+         * @param status_code HTTP status code
+         * @param is_chunked Whether to use chunked transfer encoding
          */
-        asio::awaitable<void> discard_existing_buffer(std::shared_ptr<Session> session);
+        template<typename SessionType>
+        asio::awaitable<void> send_http_response_impl(std::shared_ptr<SessionType> session, const std::string &body, int status_code, bool is_chunked = false);
 
         /**
-         * @brief Discard existing buffer data for an SSL session.
-         * @param session Active SSL session
+         * @brief Decide whether the connection stays open after the response.
+         * @param session Active session (its stored request headers are inspected)
+         * @return true for keep-alive, false if the client asked to close
          */
-        asio::awaitable<void> discard_existing_buffer(std::shared_ptr<SslSession> session);
+        static bool keep_alive_requested(const Session &session);
 
         /**
-         * @brief Discard remaining request body data for a regular session.
+         * @brief Queue the built-in metrics as a Prometheus text response.
          * @param session Active session
-         * @param req HTTP request structure
-         * @param already_read Number of bytes already read
+         * @return Size of the exposition in bytes
          */
-        asio::awaitable<void> discard_remaining_request_body(std::shared_ptr<Session> session, const HttpRequest &req, size_t already_read);
+        size_t queue_metrics_response(Session &session);
 
         /**
-         * @brief Discard remaining request body data for an SSL session.
-         * @param session Active SSL session
-         * @param req HTTP request structure
-         * @param already_read Number of bytes already read
+         * @brief Queue the runtime statistics as a JSON response: live sessions, kept streams,
+         *        running plugin calls, cache sizes and the activity of every io_context.
+         * Everything is read from counters their owners keep up to date, nothing is walked.
+         * @param session Active session
+         * @return Size of the body in bytes
          */
-        asio::awaitable<void> discard_remaining_request_body(std::shared_ptr<SslSession> session, const HttpRequest &req, size_t already_read);
+        size_t queue_stats_response(Session &session);
 
         /**
-         * @brief Send HTTP response implementation (template method).
+         * @brief Queue the readiness probe answer: 200 once the tools are registered, 503 before
+         * that and while draining, with the startup timeline as the body.
          * @param session Active session
-         * @param body Response body
-         * @param status_code HTTP status code
-         * @param is_chunked Whether to use chunked transfer encoding
+         * @return Size of the body in bytes
+         */
+        size_t queue_ready_response(Session &session);
+
+        /**
+         * @brief Answer a GET under /debug/pprof/ and queue the response.
+         * profile?seconds=N takes a CPU profile for N seconds (30 by default) while the session
+         * waits on a timer, heap asks the linked allocator for a heap profile and runtime lists
+         * the sessions and requests of every io_context.
+         * @param session Active session
+         * @param target Request target, with its query
+         * @return Size of the response body in bytes
+         */
+        asio::awaitable<size_t> serve_debug_request(Session &session, std::string_view target);
+
+        /**
+         * @brief Answer a request to the admin endpoint and queue the response.
+         * GET reports the effective settings, POST takes a JSON object of "section.key" settings
+         * and applies them all or, if one is unknown or invalid, none. A missing or wrong
+         * X-Admin-Token is answered with 403. Settings are applied on a control-plane thread,
+         * since resizing a pool starts and joins threads.
+         * @param session Active session
+         * @param view The request
+         * @return Size of the response body in bytes
+         */
+        asio::awaitable<size_t> serve_admin_request(Session &session, const HttpRequestView &view);
+
+        /**
+         * @brief Send a pre-serialized response (template method).
+         * @param session Active session
+         * @param response Canned response to send
          */
         template<typename SessionType>
-        asio::awaitable<void> send_http_response_impl(std::shared_ptr<SessionType> session, const std::string &body, int status_code, bool is_chunked = false);
+        asio::awaitable<void> send_canned_response(std::shared_ptr<SessionType> session, const CannedResponse &response);
+
+        /**
+         * @brief Pass a request to the cluster node owning its session and relay the answer (template method).
+         * The connection is closed afterwards; a 503 is sent if the owner cannot be reached.
+         * @param session Active session
+         * @param view Request as received
+         * @param owner Node owning the session
+         * @return Bytes relayed to the client
+         */
+        template<typename SessionType>
+        asio::awaitable<size_t> forward_to_owner(std::shared_ptr<SessionType> session, const HttpRequestView &view, const HashRing::Node &owner);
 
         /**
          * @brief Handle request implementation (template method).
          * @param session Active session
-         * @param raw_request Raw HTTP request string
+         * @param request Parsed request, nullptr if it was malformed
+         * @param request_size Size of the request on the wire
          */
         template<typename SessionType>
-        asio::awaitable<void> handle_request_impl(std::shared_ptr<SessionType> session, const std::string &raw_request);
+        asio::awaitable<void> handle_request_impl(std::shared_ptr<SessionType> session, const HttpRequestView *request, size_t request_size);
+
+        template<typename SessionType>
+        asio::awaitable<bool> handle_upload_impl(std::shared_ptr<SessionType> session, HttpRequestFramer &framer,
+                                                 StreamedArgument argument, ConnectionDeadline &deadline);
 
         /**
          * @brief Set the maximum allowed request size.
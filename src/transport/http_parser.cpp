@@ -0,0 +1,353 @@
+#include "http_parser.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace mcp::transport {
+
+    namespace {
+        constexpr bool is_ows(char c) noexcept {
+            return c == ' ' || c == '\t';
+        }
+
+        constexpr bool is_token_char(char c) noexcept {
+            // RFC 9110 tchar, without the rarely used punctuation
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '-' || c == '_' || c == '.' || c == '!' || c == '#' || c == '$' ||
+                   c == '%' || c == '&' || c == '\'' || c == '*' || c == '+' || c == '^' ||
+                   c == '`' || c == '|' || c == '~';
+        }
+
+        constexpr size_t kMaxChunkLineBytes = 1024;///< Chunk size line including extensions
+
+        std::string_view trim_ows(std::string_view text) noexcept {
+            while (!text.empty() && is_ows(text.front())) text.remove_prefix(1);
+            while (!text.empty() && is_ows(text.back())) text.remove_suffix(1);
+            return text;
+        }
+    }// namespace
+
+    std::string_view HttpRequestView::get_header(std::string_view name) const noexcept {
+        for (size_t i = 0; i < header_count; ++i) {
+            if (iequals(headers[i].name, name)) {
+                return headers[i].value;
+            }
+        }
+        return {};
+    }
+
+    bool HttpRequestView::has_header(std::string_view name) const noexcept {
+        for (size_t i = 0; i < header_count; ++i) {
+            if (iequals(headers[i].name, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void HttpRequestParser::reset() noexcept {
+        state_ = State::RequestLine;
+        cursor_ = 0;
+        head_size_ = 0;
+        content_length_ = 0;
+        message_size_ = 0;
+        chunk_remaining_ = 0;
+        received_ = 0;
+        chunked_ = false;
+        method_ = {};
+        target_ = {};
+        version_ = {};
+        header_count_ = 0;
+        request_ = HttpRequestView{};
+    }
+
+    HttpRequestParser::Status HttpRequestParser::parse(std::string_view data) {
+        // The buffer is never written to unless writable_ is set, so casting away const is safe
+        writable_ = false;
+        return parse_impl(const_cast<char *>(data.data()), data.size());
+    }
+
+    HttpRequestParser::Status HttpRequestParser::parse(char *data, size_t size) {
+        writable_ = true;
+        return parse_impl(data, size);
+    }
+
+    size_t HttpRequestParser::bytes_missing() const noexcept {
+        if (state_ == State::Body) {
+            return head_size_ + content_length_ - std::min(received_, head_size_ + content_length_);
+        }
+        if (state_ == State::ChunkData) {
+            return chunk_remaining_ + 2;// Chunk data plus its CRLF
+        }
+        return 0;
+    }
+
+    HttpRequestParser::Status HttpRequestParser::parse_impl(char *buffer, size_t size) {
+        std::string_view data(buffer, size);
+        received_ = size;
+        while (state_ == State::RequestLine || state_ == State::Headers) {
+            size_t line_end = data.find('\n', cursor_);
+            if (line_end == std::string_view::npos) {
+                if (data.size() > kMaxHeaderBytes) {
+                    state_ = State::Error;
+                    return Status::Error;
+                }
+                return Status::Incomplete;
+            }
+            if (line_end >= kMaxHeaderBytes) {
+                state_ = State::Error;
+                return Status::Error;
+            }
+
+            size_t line_start = cursor_;
+            std::string_view line = data.substr(line_start, line_end - line_start);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            cursor_ = line_end + 1;
+
+            if (state_ == State::RequestLine) {
+                // Tolerate empty lines before the request line (RFC 9112 section 2.2)
+                if (line.empty()) {
+                    continue;
+                }
+                if (!parse_request_line(line, line_start)) {
+                    state_ = State::Error;
+                    return Status::Error;
+                }
+                state_ = State::Headers;
+            } else if (line.empty()) {
+                head_size_ = cursor_;
+                if (!finish_headers(data) || (chunked_ && !writable_)) {
+                    state_ = State::Error;
+                    return Status::Error;
+                }
+                state_ = chunked_ ? State::ChunkSize : State::Body;
+            } else if (!parse_header_line(line, line_start)) {
+                state_ = State::Error;
+                return Status::Error;
+            }
+        }
+
+        if (state_ == State::Body) {
+            if (data.size() - head_size_ < content_length_) {
+                return Status::Incomplete;
+            }
+            message_size_ = head_size_ + content_length_;
+            state_ = State::Complete;
+        } else if (state_ == State::ChunkSize || state_ == State::ChunkData || state_ == State::Trailers) {
+            Status status = parse_chunked(buffer, size);
+            if (status != Status::Complete) {
+                return status;
+            }
+        }
+
+        if (state_ == State::Complete) {
+            bind_views(data);
+            return Status::Complete;
+        }
+        return Status::Error;
+    }
+
+    HttpRequestParser::Status HttpRequestParser::parse_chunked(char *buffer, size_t size) {
+        std::string_view data(buffer, size);
+        while (true) {
+            if (state_ == State::ChunkSize || state_ == State::Trailers) {
+                size_t line_end = data.find('\n', cursor_);
+                if (line_end == std::string_view::npos) {
+                    if (size - cursor_ > kMaxChunkLineBytes) {
+                        state_ = State::Error;
+                        return Status::Error;
+                    }
+                    return Status::Incomplete;
+                }
+
+                std::string_view line = data.substr(cursor_, line_end - cursor_);
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                cursor_ = line_end + 1;
+
+                if (state_ == State::Trailers) {
+                    // Trailer fields are skipped; an empty line terminates the message
+                    if (line.empty()) {
+                        message_size_ = cursor_;
+                        state_ = State::Complete;
+                        return Status::Complete;
+                    }
+                    continue;
+                }
+
+                // Drop chunk extensions, they carry nothing we use
+                std::string_view size_text = trim_ows(line.substr(0, line.find(';')));
+                size_t chunk_size = 0;
+                auto [ptr, ec] = std::from_chars(size_text.data(), size_text.data() + size_text.size(), chunk_size, 16);
+                if (size_text.empty() || ec != std::errc() || ptr != size_text.data() + size_text.size()) {
+                    state_ = State::Error;
+                    return Status::Error;
+                }
+
+                if (chunk_size == 0) {
+                    state_ = State::Trailers;
+                } else {
+                    chunk_remaining_ = chunk_size;
+                    state_ = State::ChunkData;
+                }
+                continue;
+            }
+
+            // ChunkData: move whatever arrived down to the end of the decoded body
+            size_t n = std::min(size - cursor_, chunk_remaining_);
+            if (n > 0) {
+                size_t body_end = head_size_ + content_length_;
+                if (body_end != cursor_) {
+                    std::memmove(buffer + body_end, buffer + cursor_, n);
+                }
+                content_length_ += n;
+                cursor_ += n;
+                chunk_remaining_ -= n;
+            }
+            if (chunk_remaining_ > 0 || size - cursor_ < 2) {
+                return Status::Incomplete;
+            }
+            if (buffer[cursor_] != '\r' || buffer[cursor_ + 1] != '\n') {
+                state_ = State::Error;
+                return Status::Error;
+            }
+            cursor_ += 2;
+            state_ = State::ChunkSize;
+        }
+    }
+
+    bool HttpRequestParser::parse_request_line(std::string_view line, size_t offset) {
+        size_t first_space = line.find(' ');
+        if (first_space == std::string_view::npos || first_space == 0) {
+            return false;
+        }
+        size_t second_space = line.find(' ', first_space + 1);
+        if (second_space == std::string_view::npos || second_space == first_space + 1) {
+            return false;
+        }
+
+        std::string_view method = line.substr(0, first_space);
+        std::string_view version = line.substr(second_space + 1);
+        if (version.substr(0, 5) != "HTTP/") {
+            return false;
+        }
+        for (char c: method) {
+            if (!is_token_char(c)) {
+                return false;
+            }
+        }
+
+        method_ = {offset, first_space};
+        target_ = {offset + first_space + 1, second_space - first_space - 1};
+        version_ = {offset + second_space + 1, version.size()};
+        return true;
+    }
+
+    bool HttpRequestParser::parse_header_line(std::string_view line, size_t offset) {
+        // Obsolete line folding is not supported; ignore continuation lines
+        if (is_ows(line.front())) {
+            return true;
+        }
+
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            return true;// Invalid header format, skip
+        }
+        if (colon == 0) {
+            return false;
+        }
+        for (size_t i = 0; i < colon; ++i) {
+            if (!is_token_char(line[i])) {
+                return false;
+            }
+        }
+
+        if (header_count_ >= HttpRequestView::kMaxHeaders) {
+            return false;
+        }
+
+        size_t value_start = colon + 1;
+        size_t value_end = line.size();
+        while (value_start < value_end && is_ows(line[value_start])) ++value_start;
+        while (value_end > value_start && is_ows(line[value_end - 1])) --value_end;
+
+        header_spans_[header_count_++] = {
+                Span{offset, colon},
+                Span{offset + value_start, value_end - value_start}};
+        return true;
+    }
+
+    bool HttpRequestParser::finish_headers(std::string_view data) {
+        content_length_ = 0;
+        chunked_ = false;
+        bool seen_length = false;
+        bool seen_encoding = false;
+        for (size_t i = 0; i < header_count_; ++i) {
+            const auto &[name, value] = header_spans_[i];
+            std::string_view header_name = data.substr(name.offset, name.length);
+
+            if (iequals(header_name, "Transfer-Encoding")) {
+                // Only "chunked" as the final coding is understood (RFC 9112 section 6.3)
+                std::string_view codings = data.substr(value.offset, value.length);
+                size_t comma = codings.rfind(',');
+                std::string_view last = trim_ows(comma == std::string_view::npos ? codings : codings.substr(comma + 1));
+                if (!iequals(last, "chunked")) {
+                    return false;
+                }
+                chunked_ = true;
+                seen_encoding = true;
+                continue;
+            }
+
+            if (!iequals(header_name, "Content-Length")) {
+                continue;
+            }
+
+            std::string_view text = data.substr(value.offset, value.length);
+            size_t length = 0;
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), length);
+            if (ec != std::errc() || ptr != text.data() + text.size() || text.empty()) {
+                return false;
+            }
+            // Conflicting Content-Length headers are a request smuggling vector
+            if (seen_length && length != content_length_) {
+                return false;
+            }
+            content_length_ = length;
+            seen_length = true;
+        }
+
+        // Content-Length together with Transfer-Encoding is another smuggling vector
+        if (seen_encoding && seen_length) {
+            return false;
+        }
+        if (chunked_) {
+            content_length_ = 0;// Counts decoded bytes from here on
+        }
+        return true;
+    }
+
+    const HttpRequestView &HttpRequestParser::partial_request(std::string_view data) noexcept {
+        bind_views(data);
+        size_t received = data.size() > head_size_ ? data.size() - head_size_ : 0;
+        request_.body = data.substr(std::min(head_size_, data.size()), std::min(received, content_length_));
+        return request_;
+    }
+
+    void HttpRequestParser::bind_views(std::string_view data) {
+        request_.method = data.substr(method_.offset, method_.length);
+        request_.target = data.substr(target_.offset, target_.length);
+        request_.version = data.substr(version_.offset, version_.length);
+        request_.header_count = header_count_;
+        for (size_t i = 0; i < header_count_; ++i) {
+            const auto &[name, value] = header_spans_[i];
+            request_.headers[i] = {data.substr(name.offset, name.length),
+                                   data.substr(value.offset, value.length)};
+        }
+        request_.body = data.substr(head_size_, content_length_);
+    }
+
+}// namespace mcp::transport
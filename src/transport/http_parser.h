@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Case-insensitive ASCII comparison, used for header names and tokens.
+     * @param a First string
+     * @param b Second string
+     * @return true if both strings are equal ignoring ASCII case
+     */
+    inline bool iequals(std::string_view a, std::string_view b) noexcept {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            char ca = a[i];
+            char cb = b[i];
+            if (ca >= 'A' && ca <= 'Z') ca = static_cast<char>(ca - 'A' + 'a');
+            if (cb >= 'A' && cb <= 'Z') cb = static_cast<char>(cb - 'A' + 'a');
+            if (ca != cb) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Non-owning view of a single HTTP header.
+     */
+    struct HttpHeaderView {
+        std::string_view name; ///< Header name as sent by the client
+        std::string_view value;///< Header value with surrounding whitespace trimmed
+    };
+
+    /**
+     * @brief Non-owning view of a parsed HTTP request.
+     * All views point into the buffer that was handed to HttpRequestParser::parse()
+     * and are only valid as long as that buffer is alive and unmodified.
+     */
+    struct HttpRequestView {
+        static constexpr size_t kMaxHeaders = 64;///< Maximum number of headers accepted per request
+
+        std::string_view method; ///< HTTP method (GET, POST, etc.)
+        std::string_view target; ///< Request target/URL
+        std::string_view version;///< HTTP version
+        std::array<HttpHeaderView, kMaxHeaders> headers{};
+        size_t header_count = 0;///< Number of valid entries in headers
+        std::string_view body;  ///< Request body
+
+        /**
+         * @brief Find a header value (case-insensitive).
+         * @param name Header name
+         * @return Header value or an empty view if the header is absent
+         */
+        std::string_view get_header(std::string_view name) const noexcept;
+
+        /**
+         * @brief Check whether a header is present (case-insensitive).
+         * @param name Header name
+         * @return true if the header is present
+         */
+        bool has_header(std::string_view name) const noexcept;
+    };
+
+    /**
+     * @brief Resumable HTTP/1.1 request parser working directly on the session read buffer.
+     *
+     * The parser never copies or allocates: it records offsets while scanning and binds
+     * string_views once the request is complete. parse() may be called repeatedly with the
+     * same (growing) buffer; scanning resumes where the previous call stopped, so the buffer
+     * may be reallocated between calls as long as the already received bytes are unchanged.
+     *
+     * Chunked request bodies are decoded in place: chunk data is moved down over the chunk
+     * framing so that the body ends up contiguous right after the headers. This needs a
+     * writable buffer, so only the char* overload accepts chunked requests.
+     */
+    class HttpRequestParser {
+    public:
+        /**
+         * @brief Result of a parse step.
+         */
+        enum class Status {
+            Incomplete,///< More data is required
+            Complete,  ///< A full request (headers and body) is available
+            Error      ///< The data is not a valid HTTP request
+        };
+
+        static constexpr size_t kMaxHeaderBytes = 64 * 1024;///< Upper bound for request line plus headers
+
+        /**
+         * @brief Parse (or continue parsing) a request from a read-only buffer.
+         * Chunked requests are rejected since they cannot be decoded in place.
+         * @param data Buffer starting at the first byte of the request
+         * @return Parse status
+         */
+        Status parse(std::string_view data);
+
+        /**
+         * @brief Parse (or continue parsing) a request, decoding chunked bodies in place.
+         * @param data Buffer starting at the first byte of the request
+         * @param size Number of valid bytes in the buffer
+         * @return Parse status
+         */
+        Status parse(char *data, size_t size);
+
+        /**
+         * @brief Get the parsed request. Only meaningful after parse() returned Complete.
+         * @return Request view
+         */
+        const HttpRequestView &request() const noexcept { return request_; }
+
+        /**
+         * @brief Bind the views of a Content-Length request whose body is still arriving.
+         * The body view holds the part received so far. Only meaningful while headers_complete()
+         * and the request is not chunked; valid until the buffer changes.
+         * @param data Buffer passed to the last parse() call
+         * @return Request view
+         */
+        const HttpRequestView &partial_request(std::string_view data) noexcept;
+
+        /**
+         * @brief Size of the request line and headers, including the terminating empty line.
+         * @return Header block size in bytes
+         */
+        size_t header_size() const noexcept { return head_size_; }
+
+        /**
+         * @brief Whether the request line and headers have been parsed, possibly with the body still incomplete.
+         * @return true once the headers are complete
+         */
+        bool headers_complete() const noexcept { return head_size_ > 0; }
+
+        /**
+         * @brief Body length (Content-Length, or the decoded size of a chunked body).
+         * @return Body length in bytes
+         */
+        size_t content_length() const noexcept { return content_length_; }
+
+        /**
+         * @brief Total number of bytes the complete request occupied on the wire.
+         * @return Header size plus (encoded) body size
+         */
+        size_t message_size() const noexcept { return message_size_; }
+
+        /**
+         * @brief Bytes still missing after an Incomplete result, as far as the framing tells.
+         * Known for Content-Length bodies and inside a chunk; 0 while headers are parsed.
+         * @return Number of bytes the next reads should at least provide
+         */
+        size_t bytes_missing() const noexcept;
+
+        /**
+         * @brief Whether the request uses chunked transfer encoding.
+         * @return true for chunked requests
+         */
+        bool is_chunked() const noexcept { return chunked_; }
+
+        /**
+         * @brief Reset the parser so it can be reused for the next request.
+         */
+        void reset() noexcept;
+
+    private:
+        enum class State {
+            RequestLine,
+            Headers,
+            Body,
+            ChunkSize,
+            ChunkData,
+            Trailers,
+            Complete,
+            Error
+        };
+
+        struct Span {
+            size_t offset;
+            size_t length;
+        };
+
+        Status parse_impl(char *data, size_t size);
+        Status parse_chunked(char *data, size_t size);
+        bool parse_request_line(std::string_view line, size_t offset);
+        bool parse_header_line(std::string_view line, size_t offset);
+        bool finish_headers(std::string_view data);
+        void bind_views(std::string_view data);
+
+        State state_ = State::RequestLine;
+        size_t cursor_ = 0;        ///< First byte not yet scanned
+        size_t head_size_ = 0;     ///< Size of request line plus headers
+        size_t content_length_ = 0;///< Declared or decoded body length
+        size_t message_size_ = 0;  ///< Bytes consumed by the complete request
+        size_t chunk_remaining_ = 0;///< Bytes left in the current chunk
+        size_t received_ = 0;      ///< Size of the buffer seen by the last parse() call
+        bool chunked_ = false;     ///< Transfer-Encoding: chunked
+        bool writable_ = false;    ///< Buffer may be modified (chunked decoding)
+
+        Span method_{};
+        Span target_{};
+        Span version_{};
+        std::array<std::pair<Span, Span>, HttpRequestView::kMaxHeaders> header_spans_{};
+        size_t header_count_ = 0;
+
+        HttpRequestView request_;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,189 @@
+#include "http_response_decoder.h"
+#include <algorithm>
+#include <charconv>
+
+namespace mcp::transport {
+
+    namespace {
+        constexpr size_t kMaxHeadSize = 64 * 1024;
+        constexpr size_t kMaxChunkLine = 1024;
+
+        std::string to_lower(std::string_view text) {
+            std::string lower(text);
+            for (char &c: lower) {
+                if (c >= 'A' && c <= 'Z') {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+            return lower;
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+            return text;
+        }
+    }// namespace
+
+    std::string_view HttpResponseDecoder::field(std::string_view name) const {
+        for (const auto &[field_name, value]: fields_) {
+            if (field_name == name) {
+                return value;
+            }
+        }
+        return {};
+    }
+
+    HttpResponseDecoder::Part HttpResponseDecoder::fail(const char *reason) {
+        state_ = State::Failed;
+        error_ = reason;
+        return Part::Error;
+    }
+
+    HttpResponseDecoder::Part HttpResponseDecoder::next(std::string_view &data) {
+        while (!data.empty() || state_ == State::Failed) {
+            switch (state_) {
+                case State::Head: {
+                    size_t scan_from = line_.size() >= 3 ? line_.size() - 3 : 0;
+                    size_t taken = std::min(data.size(), kMaxHeadSize - line_.size());
+                    line_.append(data.data(), taken);
+                    size_t end = line_.find("\r\n\r\n", scan_from);
+                    if (end == std::string::npos) {
+                        if (line_.size() >= kMaxHeadSize) {
+                            return fail("response head too large");
+                        }
+                        data.remove_prefix(taken);
+                        break;
+                    }
+                    data.remove_prefix(end + 4 - (line_.size() - taken));
+                    line_.resize(end);
+                    bool valid = parse_head(line_);
+                    line_.clear();
+                    if (!valid) {
+                        return fail("malformed response head");
+                    }
+                    return Part::Head;
+                }
+                case State::Length:
+                case State::ChunkData: {
+                    size_t n = static_cast<size_t>(std::min<uint64_t>(remaining_, data.size()));
+                    body_ = data.substr(0, n);
+                    data.remove_prefix(n);
+                    remaining_ -= n;
+                    if (remaining_ == 0) {
+                        state_ = state_ == State::Length ? State::Done : State::ChunkEnd;
+                    }
+                    return Part::Body;
+                }
+                case State::ChunkSize:
+                case State::ChunkEnd:
+                case State::Trailers: {
+                    size_t newline = data.find('\n');
+                    if (newline == std::string_view::npos) {
+                        line_.append(data);
+                        data = {};
+                        if (line_.size() > kMaxChunkLine) {
+                            return fail("chunk line too long");
+                        }
+                        break;
+                    }
+                    line_.append(data.substr(0, newline));
+                    data.remove_prefix(newline + 1);
+                    std::string_view line = trim(line_);
+
+                    if (state_ == State::ChunkEnd) {
+                        state_ = State::ChunkSize;// The line after chunk data is empty
+                    } else if (state_ == State::ChunkSize) {
+                        uint64_t size = 0;
+                        auto result = std::from_chars(line.data(), line.data() + line.size(), size, 16);
+                        if (result.ec != std::errc() || result.ptr == line.data()) {
+                            return fail("malformed chunk size");
+                        }
+                        remaining_ = size;
+                        state_ = size == 0 ? State::Trailers : State::ChunkData;
+                    } else if (line.empty()) {
+                        line_.clear();
+                        state_ = State::Done;
+                        body_ = {};
+                        return Part::Body;
+                    }
+                    line_.clear();
+                    break;
+                }
+                case State::UntilClose:
+                    body_ = data;
+                    data = {};
+                    return Part::Body;
+                case State::Done:
+                    data = {};
+                    break;
+                case State::Failed:
+                    return Part::Error;
+            }
+        }
+        return Part::NeedMore;
+    }
+
+    /**
+     * @brief Parse a response head and pick the body framing.
+     * @param head Status line and header lines, without the empty line
+     */
+    bool HttpResponseDecoder::parse_head(std::string_view head) {
+        size_t line_end = head.find("\r\n");
+        std::string_view status_line = head.substr(0, line_end);
+        size_t space = status_line.find(' ');
+        if (space == std::string_view::npos || status_line.size() < space + 4) {
+            return false;
+        }
+        std::string_view status = status_line.substr(space + 1, 3);
+        auto parsed = std::from_chars(status.data(), status.data() + status.size(), status_);
+        if (parsed.ec != std::errc() || status_ < 100 || status_ > 599) {
+            return false;
+        }
+
+        fields_.clear();
+        bool chunked = false;
+        bool has_length = false;
+        uint64_t content_length = 0;
+        std::string_view rest = line_end == std::string_view::npos ? std::string_view() : head.substr(line_end + 2);
+        while (!rest.empty()) {
+            size_t next = rest.find("\r\n");
+            std::string_view line = rest.substr(0, next);
+            rest = next == std::string_view::npos ? std::string_view() : rest.substr(next + 2);
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            std::string name = to_lower(trim(line.substr(0, colon)));
+            std::string_view value = trim(line.substr(colon + 1));
+
+            if (name == "transfer-encoding") {
+                chunked = to_lower(value).find("chunked") != std::string::npos;
+                continue;
+            }
+            if (name == "connection" || name == "keep-alive" || name == "proxy-connection" || name == "upgrade") {
+                continue;
+            }
+            if (name == "content-length") {
+                auto result = std::from_chars(value.data(), value.data() + value.size(), content_length);
+                has_length = result.ec == std::errc();
+            }
+            fields_.emplace_back(std::move(name), std::string(value));
+        }
+
+        if (status_ < 200) {
+            state_ = State::Head;// Informational, the final head follows
+        } else if (status_ == 204 || status_ == 304 || (has_length && !chunked && content_length == 0)) {
+            state_ = State::Done;
+        } else if (chunked) {
+            state_ = State::ChunkSize;
+        } else if (has_length) {
+            state_ = State::Length;
+            remaining_ = content_length;
+        } else {
+            state_ = State::UntilClose;
+        }
+        return true;
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Incremental decoder of the HTTP/1.1 responses HttpHandler writes to a session.
+     *
+     * Sessions that carry requests over another protocol (HTTP/2 streams, WebSocket messages)
+     * feed it whatever the handler writes, in pieces of any size, and forward the parts: the
+     * head, then the body without its Content-Length or chunked framing. Connection-specific
+     * header fields are dropped from the head, trailer fields are dropped entirely.
+     */
+    class HttpResponseDecoder {
+    public:
+        using Field = std::pair<std::string, std::string>;///< Lower case name and value
+
+        enum class Part {
+            NeedMore,///< All data was consumed, feed more
+            Head,    ///< status() and fields() describe a response head
+            Body,    ///< body() holds the next piece of the body, it may be empty at the end
+            Error    ///< The data is not a valid response, see error()
+        };
+
+        /**
+         * @brief Decode the next part.
+         * @param data Data written by the handler; the decoded part is removed from its front
+         * @return The part decoded, NeedMore once data is empty
+         */
+        Part next(std::string_view &data);
+
+        int status() const { return status_; }
+        const std::vector<Field> &fields() const { return fields_; }
+        std::string_view body() const { return body_; }///< Points into the data passed to next()
+        const char *error() const { return error_; }
+
+        /**
+         * @brief Value of a head field, empty if absent.
+         * @param name Lower case name
+         */
+        std::string_view field(std::string_view name) const;
+
+        bool started() const { return state_ != State::Head; } ///< A final head was decoded
+        bool done() const { return state_ == State::Done; }    ///< The response is complete
+        bool until_close() const { return state_ == State::UntilClose; }///< The body ends when the session closes
+
+    private:
+        enum class State {
+            Head,      ///< Waiting for the status line and headers
+            Length,    ///< Body with Content-Length, remaining_ bytes to go
+            ChunkSize, ///< Chunked body, waiting for a chunk size line
+            ChunkData, ///< Chunked body, remaining_ bytes of chunk data to go
+            ChunkEnd,  ///< Chunked body, waiting for the CRLF after the chunk data
+            Trailers,  ///< Chunked body, waiting for the empty line after the last chunk
+            UntilClose,///< Body without length
+            Done,      ///< Response complete, anything written afterwards is dropped
+            Failed
+        };
+
+        Part fail(const char *reason);
+        bool parse_head(std::string_view head);
+
+        State state_ = State::Head;
+        std::string line_;///< Head received so far, or a partial chunk line
+        uint64_t remaining_ = 0;
+        int status_ = 0;
+        std::vector<Field> fields_;
+        std::string_view body_;
+        const char *error_ = nullptr;
+    };
+
+}// namespace mcp::transport
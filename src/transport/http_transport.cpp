@@ -4,6 +4,7 @@
 #include "core/logger.h"
 #include "http_handler.h"
 #include "session.h"
+#include "slab_allocator.h"
 #include "tcp_session.h"
 
 
@@ -16,9 +17,10 @@ namespace mcp::transport {
      * @param address IP address to bind to
      * @param port Port number to listen on
      * @param auth_manager Authentication manager
+     * @param reuse_port Run one SO_REUSEPORT acceptor per pool io_context
      */
-    HttpTransport::HttpTransport(const std::string &address, unsigned short port, std::shared_ptr<AuthManagerBase> auth_manager)
-        : BaseTransport(address, port),
+    HttpTransport::HttpTransport(const std::string &address, unsigned short port, std::shared_ptr<AuthManagerBase> auth_manager, bool reuse_port)
+        : BaseTransport(address, port, reuse_port),
           is_running_(false),
           auth_manager_(auth_manager) {
         MCP_INFO("HTTP Transport initialized on {}:{}", address, port);
@@ -46,36 +48,22 @@ namespace mcp::transport {
         handler_ = std::make_unique<HttpHandler>(std::move(on_message), auth_manager_);
         is_running_ = true;
         MCP_INFO("Streamable HTTP Transport started on {}:{}",
-                 acceptor_.local_endpoint().address().to_string(),
-                 acceptor_.local_endpoint().port());
+                 endpoint_.address().to_string(),
+                 endpoint_.port());
 
-        // Launch acceptor loop to handle incoming connections
-        asio::co_spawn(get_io_context(), [this]() -> asio::awaitable<void> {
-            try {
-                while (is_running_) {
-                    // Accept new TCP connection
-                    auto socket = co_await acceptor_.async_accept(use_awaitable);
-                    MCP_DEBUG("HTTP client connected from {}:{}", 
-                              socket.remote_endpoint().address().to_string(), 
-                              socket.remote_endpoint().port());
-
-                    // Get IO context from thread pool
-                    auto& session_io_context = AsioIOServicePool::GetInstance()->GetIOService();
-                    
-                    // Create TCP session for the connection
-                    auto session = std::make_shared<TcpSession>(std::move(socket));
-                    
-                    // Launch session handler in thread pool context
-                    asio::co_spawn(session_io_context, 
-                        [session, handler = handler_.get()]() -> asio::awaitable<void> {
-                            co_await session->start(handler);
-                            co_return;
-                        }, 
-                        asio::detached);
-                }
-            } catch (const std::exception& e) {
-                MCP_ERROR("Error accepting HTTP connections: {}", e.what());
-            } }, asio::detached);
+        if (reuse_port_) {
+            // Every pool context accepts on its own socket; sessions never change threads
+            open_pool_acceptors(*AsioIOServicePool::GetInstance());
+            accept_counters_ = metrics::MetricsManager::getInstance()->register_accept_counters("http", pool_acceptors_.size());
+            for (size_t i = 0; i < pool_acceptors_.size(); ++i) {
+                auto &[context, acceptor] = pool_acceptors_[i];
+                asio::co_spawn(*context, accept_loop(*acceptor, context, i), asio::detached);
+            }
+        } else {
+            // Launch acceptor loop to handle incoming connections
+            accept_counters_ = metrics::MetricsManager::getInstance()->register_accept_counters("http", 1);
+            asio::co_spawn(get_io_context(), accept_loop(acceptor_, nullptr, 0), asio::detached);
+        }
 
         // Run IO context in dedicated thread
         std::thread([this]() {
@@ -89,6 +77,39 @@ namespace mcp::transport {
         return true;
     }
 
+    /**
+     * @brief Accept connections on one acceptor and start a session for each.
+     * @param acceptor Acceptor to accept on
+     * @param session_context Context to run the sessions on, nullptr to pick one from the pool
+     * @param index Accept loop index for the accept counters
+     */
+    asio::awaitable<void> HttpTransport::accept_loop(asio::ip::tcp::acceptor &acceptor, asio::io_context *session_context, size_t index) {
+        try {
+            while (is_running_) {
+                // Get IO context from thread pool unless this acceptor owns one
+                auto &session_io_context = session_context ? *session_context : AsioIOServicePool::GetInstance()->GetIOService();
+
+                // Accept new TCP connection, bound to the session context so its I/O runs there
+                auto socket = co_await acceptor.async_accept(session_io_context, use_awaitable);
+                accept_counters_->increment(index);
+                MCP_DEBUG("HTTP client connected from {}:{}",
+                          socket.remote_endpoint().address().to_string(),
+                          socket.remote_endpoint().port());
+
+                // Launch session handler in the session context. The session is created there
+                // as well, so its slab block is taken from and returned to that thread's free list.
+                asio::co_spawn(session_io_context, [socket = std::move(socket), handler = handler_.get()]() mutable -> asio::awaitable<void> {
+                        auto session = std::allocate_shared<TcpSession>(SlabAllocator<TcpSession>{}, std::move(socket));
+                        co_await session->start(handler);
+                        co_return; }, asio::detached);
+            }
+        } catch (const std::exception &e) {
+            if (is_running_) {
+                MCP_ERROR("Error accepting HTTP connections: {}", e.what());
+            }
+        }
+    }
+
     /**
      * @brief Legacy acceptor method (not used).
      */
@@ -100,10 +121,17 @@ namespace mcp::transport {
      * @brief Stop the HTTP transport and clean up resources.
      */
     void HttpTransport::stop() {
-        is_running_ = false;
-        acceptor_.close();
+        stop_accepting();
         work_guard_.reset();
         get_io_context().stop();
     }
 
+    /**
+     * @brief Close the acceptors; the accept loops end without reporting an error.
+     */
+    void HttpTransport::stop_accepting() {
+        is_running_ = false;
+        close_acceptors();
+    }
+
 }// namespace mcp::transport
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "base_transport.h"
 #include "transport_types.h"
 #include <asio.hpp>
+#include <atomic>
 #include <memory>
 
 namespace mcp::transport {
@@ -18,7 +19,8 @@ namespace mcp::transport {
      */
     class HttpTransport : public BaseTransport {
     public:
-        explicit HttpTransport(const std::string &address, unsigned short port, std::shared_ptr<AuthManagerBase> auth_manager = nullptr);
+        explicit HttpTransport(const std::string &address, unsigned short port, std::shared_ptr<AuthManagerBase> auth_manager = nullptr,
+                               bool reuse_port = false);
         ~HttpTransport() override;
 
         /**
@@ -33,9 +35,15 @@ namespace mcp::transport {
          */
         void stop() override;
 
+        /**
+         * @brief Stop accepting HTTP connections, for a drain; see Drain.
+         */
+        void stop_accepting() override;
+
     private:
+        asio::awaitable<void> accept_loop(asio::ip::tcp::acceptor &acceptor, asio::io_context *session_context, size_t index);///< Accept loop of one acceptor
         asio::awaitable<void> do_accept();             // Legacy placeholder, not used
-        bool is_running_ = false;                      ///< Transport running flag
+        std::atomic<bool> is_running_ = false;         ///< Transport running flag
         std::shared_ptr<AuthManagerBase> auth_manager_;///< Authentication manager
     };
 
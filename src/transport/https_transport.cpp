@@ -3,8 +3,11 @@
 #include "core/executable_path.h"
 #include "core/io_context_pool.hpp"
 #include "core/logger.h"
+#include "http2_connection.h"
 #include "http_handler.h"
+#include "slab_allocator.h"
 #include "ssl_session.h"
+#include "tls_options.h"
 #include <asio/ssl/context.hpp>
 #include <filesystem>
 #include <fstream>
@@ -20,14 +23,16 @@ namespace mcp::transport {
      * @param cert_file Path to SSL certificate file
      * @param private_key_file Path to SSL private key file
      * @param auth_manager Authentication manager
+     * @param reuse_port Run one SO_REUSEPORT acceptor per TLS pool io_context
      */
     HttpsTransport::HttpsTransport(const std::string &address, unsigned short port,
                                    const std::string &cert_file, const std::string &private_key_file, const std::string &dh_params_file,
-                                   std::shared_ptr<AuthManagerBase> auth_manager)
-        : BaseTransport(address, port),
-          ssl_context_(asio::ssl::context::tlsv12_server),// Explicit TLS server mode
+                                   std::shared_ptr<AuthManagerBase> auth_manager, bool reuse_port)
+        : BaseTransport(address, port, reuse_port),
+          ssl_context_(asio::ssl::context::tls_server),// TLS 1.2 and 1.3, older versions are disabled below
           is_running_(false),
-          auth_manager_(auth_manager) {
+          auth_manager_(auth_manager),
+          handshake_counters_(metrics::MetricsManager::getInstance()->register_tls_handshake_counters("https")) {
 
         // Resolve certificate paths relative to executable directory
         std::filesystem::path executable_dir(mcp::core::getExecutableDirectory());
@@ -60,8 +65,13 @@ namespace mcp::transport {
                 asio::ssl::context::no_tlsv1 |
                 asio::ssl::context::no_tlsv1_1 |
                 asio::ssl::context::single_dh_use);
+        SSL_CTX_set_min_proto_version(ssl_context_.native_handle(), TLS1_2_VERSION);
         ssl_context_.set_verify_mode(asio::ssl::verify_none);
         ssl_context_.use_tmp_dh_file(dh_params_file_absolute);
+        // Reconnecting clients resume their session instead of a full handshake
+        TlsOptions::current().apply(ssl_context_);
+        // Clients that offer h2 in ALPN get HTTP/2 when it is enabled
+        Http2Options::current().apply(ssl_context_);
         // Load and validate certificates
         load_certificates(cert_file_absolute, private_key_file_absolute);
 
@@ -138,11 +148,22 @@ namespace mcp::transport {
         is_running_ = true;
 
         MCP_INFO("Streamable HTTPS Transport started on {}:{}",
-                 acceptor_.local_endpoint().address().to_string(),
-                 acceptor_.local_endpoint().port());
+                 endpoint_.address().to_string(),
+                 endpoint_.port());
 
-        // Launch main accept loop
-        asio::co_spawn(get_io_context(), accept_loop(), asio::detached);
+        if (reuse_port_) {
+            // Every TLS pool context accepts on its own socket; sessions never change threads
+            open_pool_acceptors(*AsioIOServicePool::GetTlsInstance());
+            accept_counters_ = metrics::MetricsManager::getInstance()->register_accept_counters("https", pool_acceptors_.size());
+            for (size_t i = 0; i < pool_acceptors_.size(); ++i) {
+                auto &[context, acceptor] = pool_acceptors_[i];
+                asio::co_spawn(*context, accept_loop(*acceptor, context, i), asio::detached);
+            }
+        } else {
+            // Launch main accept loop
+            accept_counters_ = metrics::MetricsManager::getInstance()->register_accept_counters("https", 1);
+            asio::co_spawn(get_io_context(), accept_loop(acceptor_, nullptr, 0), asio::detached);
+        }
 
         // Run IO context in dedicated thread
         std::thread([this]() {
@@ -158,13 +179,22 @@ namespace mcp::transport {
 
     /**
      * @brief Main loop for accepting and handling HTTPS connections.
+     * @param acceptor Acceptor to accept on
+     * @param session_context Context to run the sessions on, nullptr to pick one from the TLS pool
+     * @param index Accept loop index for the accept counters
      */
-    asio::awaitable<void> HttpsTransport::accept_loop() {
+    asio::awaitable<void> HttpsTransport::accept_loop(asio::ip::tcp::acceptor &acceptor, asio::io_context *session_context, size_t index) {
+        auto handshake_pool = AsioIOServicePool::GetHandshakeInstance();
+        bool offload_handshakes = handshake_pool != AsioIOServicePool::GetTlsInstance();
         try {
             while (is_running_) {
-                // Accept new TCP connection
-                asio::ip::tcp::socket raw_socket(get_io_context());
-                co_await acceptor_.async_accept(raw_socket, asio::use_awaitable);
+                // Accept new TCP connection, bound to a pool context so its I/O and handshake run there.
+                // With a handshake pool the socket starts out there and moves once the handshake is done.
+                auto &session_io_context = session_context ? *session_context : AsioIOServicePool::GetTlsInstance()->GetIOService();
+                asio::ip::tcp::socket raw_socket(offload_handshakes ? handshake_pool->GetIOService() : session_io_context);
+                co_await acceptor.async_accept(raw_socket, asio::use_awaitable);
+                accept_counters_->increment(index);
+                auto accepted = std::chrono::steady_clock::now();
 
                 // Validate socket state
                 if (!raw_socket.is_open()) {
@@ -184,36 +214,83 @@ namespace mcp::transport {
                     MCP_WARN("Failed to get remote endpoint: {}", e.what());
                 }
 
-                // Transfer socket ownership
-                auto session_socket = std::make_unique<asio::ip::tcp::socket>(std::move(raw_socket));
-                if (!session_socket->is_open()) {
-                    MCP_ERROR("Socket ownership transfer failed (client: {}:{})", client_addr, client_port);
-                    continue;
-                }
-
-                // Create SSL session with socket and SSL context
-                auto session = std::make_shared<SslSession>(
-                        std::move(*session_socket),// Transfer socket ownership
-                        ssl_context_);
-                (void) session_socket.release();// Prevent double destruction
-
-                // Final socket validation
-                if (!session->get_stream().lowest_layer().is_open()) {
-                    MCP_ERROR("Socket became invalid after session creation (client: {}:{})", client_addr, client_port);
+                if (offload_handshakes) {
+                    handshake_counters_->queued.fetch_add(1, std::memory_order_relaxed);
+                    auto executor = raw_socket.get_executor();
+                    asio::co_spawn(executor, handshake_and_serve(std::move(raw_socket), session_io_context, accepted), asio::detached);
                     continue;
                 }
 
-                // Launch session handler in thread pool
+                // Launch session handler in thread pool. The session is created on its own io
+                // thread so its slab block is taken from and returned to that thread's free list.
                 asio::co_spawn(
-                        AsioIOServicePool::GetInstance()->GetIOService(),
-                        [session, handler = handler_.get()]() -> asio::awaitable<void> {
+                        session_io_context,
+                        [&ssl_context = ssl_context_, socket = std::move(raw_socket), client_addr = std::move(client_addr), client_port,
+                         handler = handler_.get(), handshake_counters = handshake_counters_.get()]() mutable -> asio::awaitable<void> {
+                            auto session = std::allocate_shared<SslSession>(
+                                    SlabAllocator<SslSession>{}, std::move(socket), ssl_context, handshake_counters);
+
+                            if (!session->get_stream().lowest_layer().is_open()) {
+                                MCP_ERROR("Socket became invalid after session creation (client: {}:{})", client_addr, client_port);
+                                co_return;
+                            }
                             co_await session->start(handler);
                         },
                         asio::detached);
             }
         } catch (const std::exception &e) {
-            MCP_ERROR("Accept loop exception: {}", e.what());
+            if (is_running_) {
+                MCP_ERROR("Accept loop exception: {}", e.what());
+            }
+        }
+    }
+
+    /**
+     * @brief Handshake a connection on the handshake pool, then serve it on its session context.
+     * @param socket Accepted socket, bound to a handshake pool context
+     * @param session_context Context the established session runs on
+     * @param accepted When the connection was accepted
+     */
+    asio::awaitable<void> HttpsTransport::handshake_and_serve(asio::ip::tcp::socket socket, asio::io_context &session_context,
+                                                              std::chrono::steady_clock::time_point accepted) {
+        auto ssl = co_await SslSession::handshake(socket, ssl_context_, handshake_counters_.get(), accepted);
+        handshake_counters_->queued.fetch_sub(1, std::memory_order_relaxed);
+        if (!ssl) {
+            co_return;
+        }
+
+        // Move the connection to its session context: the descriptor is released here and adopted there
+        asio::error_code ec;
+        auto protocol = socket.local_endpoint(ec).protocol();
+        asio::ip::tcp::socket::native_handle_type fd{};
+        if (!ec) {
+            fd = socket.release(ec);
         }
+        if (ec) {
+            // Platforms that cannot release a socket (Windows before 8.1) serve it where the handshake ran
+            MCP_DEBUG("Serving HTTPS session on the handshake pool: {}", ec.message());
+            auto session = std::allocate_shared<SslSession>(
+                    SlabAllocator<SslSession>{}, std::move(socket), std::move(ssl), handshake_counters_.get());
+            co_await session->start(handler_.get());
+            co_return;
+        }
+
+        asio::co_spawn(
+                session_context,
+                [&session_context, protocol, fd, ssl = std::move(ssl), handshake_counters = handshake_counters_.get(),
+                 handler = handler_.get()]() mutable -> asio::awaitable<void> {
+                    asio::ip::tcp::socket socket(session_context);
+                    asio::error_code ec;
+                    socket.assign(protocol, fd, ec);
+                    if (ec) {
+                        MCP_ERROR("Failed to adopt the socket of a TLS handshake: {}", ec.message());
+                        co_return;
+                    }
+                    auto session = std::allocate_shared<SslSession>(
+                            SlabAllocator<SslSession>{}, std::move(socket), std::move(ssl), handshake_counters);
+                    co_await session->start(handler);
+                },
+                asio::detached);
     }
 
     /**
@@ -227,10 +304,17 @@ namespace mcp::transport {
      * @brief Stop the HTTPS transport and clean up resources.
      */
     void HttpsTransport::stop() {
-        is_running_ = false;
-        acceptor_.close();
+        stop_accepting();
         work_guard_.reset();
         get_io_context().stop();
     }
 
+    /**
+     * @brief Close the acceptors; the accept loops end without reporting an error.
+     */
+    void HttpsTransport::stop_accepting() {
+        is_running_ = false;
+        close_acceptors();
+    }
+
 }// namespace mcp::transport
\ No newline at end of file
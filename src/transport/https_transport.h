@@ -9,6 +9,8 @@
 #include "transport_types.h"
 #include <asio.hpp>
 #include <asio/ssl.hpp>
+#include <atomic>
+#include <chrono>
 namespace mcp::transport {
 
     /**
@@ -19,7 +21,7 @@ namespace mcp::transport {
     public:
         explicit HttpsTransport(const std::string &address, unsigned short port,
                                 const std::string &cert_file, const std::string &private_key_file, const std::string &dh_params_file,
-                                std::shared_ptr<AuthManagerBase> auth_manager = nullptr);
+                                std::shared_ptr<AuthManagerBase> auth_manager = nullptr, bool reuse_port = false);
         ~HttpsTransport() override;
 
         /**
@@ -34,14 +36,22 @@ namespace mcp::transport {
          */
         void stop() override;
 
+        /**
+         * @brief Stop accepting HTTPS connections, for a drain; see Drain.
+         */
+        void stop_accepting() override;
+
     private:
-        asio::awaitable<void> accept_loop();                                              ///< Main loop for accepting connections
+        asio::awaitable<void> accept_loop(asio::ip::tcp::acceptor &acceptor, asio::io_context *session_context, size_t index);///< Main loop for accepting connections
+        asio::awaitable<void> handshake_and_serve(asio::ip::tcp::socket socket, asio::io_context &session_context,
+                                                  std::chrono::steady_clock::time_point accepted);///< Offloaded handshake, then the session
         void load_certificates(const std::string &cert_file, const std::string &key_file);///< Load SSL certificates
 
         asio::awaitable<void> do_accept();             // Legacy placeholder, not used
         asio::ssl::context ssl_context_;               ///< SSL context with security configuration
-        bool is_running_ = false;                      ///< Transport running flag
+        std::atomic<bool> is_running_ = false;         ///< Transport running flag
         std::shared_ptr<AuthManagerBase> auth_manager_;///< Authentication manager
+        std::shared_ptr<metrics::TlsHandshakeCounters> handshake_counters_;///< Full and resumed handshakes
     };
 
 }// namespace mcp::transport
\ No newline at end of file
@@ -1,7 +1,14 @@
 #include "mcp_cache.h"
-#include "LRUCache.hpp"
+#include "cache_backend.h"
+#include "core/housekeeping.h"
 #include "core/logger.h"
+#include "metrics/metrics_manager.h"
+#include "sse_event_ring.h"
 #include <algorithm>
+#include <bit>
+#include <charconv>
+#include <functional>
+#include <unordered_map>
 
 
 namespace mcp::cache {
@@ -11,7 +18,7 @@ namespace mcp::cache {
     ////////////////////////////////////////////////////////////////////////////////
 
     nlohmann::json SessionState::to_json() const {
-        return {
+        nlohmann::json j = {
                 {"session_id", session_id},
                 {"tool_name", tool_name},
                 {"last_event_id", last_event_id},
@@ -19,6 +26,11 @@ namespace mcp::cache {
                 {"last_update", std::chrono::duration_cast<std::chrono::seconds>(
                                         last_update.time_since_epoch())
                                         .count()}};
+        if (!checkpoint.empty()) {
+            j["checkpoint"] = checkpoint;
+            j["checkpoint_event_id"] = checkpoint_event_id;
+        }
+        return j;
     }
 
     SessionState SessionState::from_json(const nlohmann::json &j) {
@@ -29,9 +41,109 @@ namespace mcp::cache {
         state.is_active = j["is_active"];
         state.last_update = std::chrono::system_clock::time_point(
                 std::chrono::seconds(j["last_update"]));
+        state.checkpoint = j.value("checkpoint", "");
+        state.checkpoint_event_id = j.value("checkpoint_event_id", 0);
         return state;
     }
 
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Options
+    ////////////////////////////////////////////////////////////////////////////////
+
+    std::unordered_map<std::string, std::chrono::seconds> McpCacheOptions::parse_tool_ttls(std::string_view text) {
+        std::unordered_map<std::string, std::chrono::seconds> ttls;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+            while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+            if (item.empty()) {
+                continue;
+            }
+
+            size_t equals = item.find('=');
+            long long seconds = 0;
+            std::string_view name = item.substr(0, equals);
+            std::string_view number = equals == std::string_view::npos ? std::string_view{} : item.substr(equals + 1);
+            while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+            while (!number.empty() && number.front() == ' ') number.remove_prefix(1);
+            auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), seconds);
+            if (name.empty() || number.empty() || ec != std::errc() || ptr != number.data() + number.size() || seconds < 0) {
+                MCP_WARN("Ignoring invalid cache TTL entry '{}'", item);
+                continue;
+            }
+            ttls[std::string(name)] = std::chrono::seconds(seconds);
+        }
+        return ttls;
+    }
+
+    StreamStateCommit McpCacheOptions::parse_stream_state_commit(std::string_view text) {
+        if (text == "batch") {
+            return StreamStateCommit::Batch;
+        }
+        if (text == "end") {
+            return StreamStateCommit::End;
+        }
+        if (text != "interval") {
+            MCP_WARN("Unknown stream_state_commit '{}', using interval", text);
+        }
+        return StreamStateCommit::Interval;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Shard layout
+    ////////////////////////////////////////////////////////////////////////////////
+
+    namespace {
+        using steady_clock = std::chrono::steady_clock;
+
+        constexpr size_t kMaxAutoShards = 64;               ///< Upper bound when derived from the core count
+        constexpr std::chrono::seconds kCleanupInterval{30};///< Period of the background cleanup
+    }// namespace
+
+    /// Everything cached for one session
+    struct McpCache::SessionSlot {
+        std::atomic<std::shared_ptr<const SessionState>> state;///< Published state, null until one is saved
+        std::atomic<steady_clock::rep> expires_at{0};          ///< Slot expiry, refreshed on every write
+        std::atomic<int> newest_event{0};                      ///< Highest event cached, ahead of a state written behind
+        SseEventRing events;                                   ///< Cached event frames; shard mutex
+        steady_clock::time_point touched;                      ///< Last write, for eviction; shard mutex
+        std::chrono::seconds ttl;                              ///< Lifetime after a write, per tool; shard mutex
+        size_t bytes = 0;                                      ///< Size charged to the shard; shard mutex
+
+        SessionSlot(size_t max_events, std::chrono::seconds ttl) : events(max_events), ttl(ttl) {}
+
+        /// Cache an event frame; shard mutex
+        void put(int event_id, std::string_view data) {
+            events.put(event_id, data);
+            if (event_id > newest_event.load(std::memory_order_relaxed)) {
+                newest_event.store(event_id, std::memory_order_relaxed);
+            }
+        }
+
+        void refresh(steady_clock::time_point now) {
+            expires_at.store((now + ttl).time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+        bool expired(steady_clock::time_point now) const {
+            return expires_at.load(std::memory_order_relaxed) <= now.time_since_epoch().count();
+        }
+    };
+
+    /// One lock stripe of the cache
+    struct McpCache::Shard {
+        using SlotMap = std::unordered_map<std::string, std::shared_ptr<SessionSlot>>;
+
+        std::mutex mtx;                                   ///< Guards slots and all slot writes
+        SlotMap slots;                                    ///< Sessions of this shard
+        size_t bytes = 0;                                 ///< Sum of the slot sizes
+        std::atomic<std::shared_ptr<const SlotMap>> index;///< Copy of slots for lock free readers, replaced on insert/erase
+
+        void publish() { index.store(std::make_shared<const SlotMap>(slots), std::memory_order_release); }
+    };
+
     ////////////////////////////////////////////////////////////////////////////////
     /// McpCache instance acquisition and initialization
     ////////////////////////////////////////////////////////////////////////////////
@@ -42,52 +154,296 @@ namespace mcp::cache {
         return &instance;
     }
 
+    McpCache::~McpCache() {
+        StopCleanup();
+    }
+
+    void McpCache::SetBackend(std::shared_ptr<CacheBackend> backend) {
+        backend_ = std::move(backend);
+    }
+
     // Initialize cache configuration
-    void McpCache::Init(size_t max_session_count, size_t max_data_per_session, std::chrono::seconds ttl) {
-        std::lock_guard<std::mutex> lock(mtx_);
+    void McpCache::Init(size_t max_session_count, size_t max_data_per_session, std::chrono::seconds ttl, size_t shard_count) {
+        McpCacheOptions options;
+        options.max_sessions = max_session_count;
+        options.max_data_per_session = max_data_per_session;
+        options.ttl = ttl;
+        options.shard_count = shard_count;
+        Init(options);
+    }
+
+    void McpCache::Init(const McpCacheOptions &options) {
         // Allow re-initialization to support testing
-        if (is_initialized_) {
-            if (session_cache_) session_cache_->StopCleanupThread();
-            if (data_cache_) data_cache_->StopCleanupThread();
-            if (event_list_cache_) event_list_cache_->StopCleanupThread();
+        StopCleanup();
+        is_initialized_ = false;
+
+        max_session_count_ = std::max<size_t>(options.max_sessions, 1);
+        max_data_per_session_ = options.max_data_per_session;
+        ttl_ = options.ttl;
+        tool_ttls_ = options.tool_ttls;
+        size_t shard_count = options.shard_count;
+
+        // More shards than sessions would leave most of them empty
+        if (shard_count == 0) {
+            shard_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()) * 2, kMaxAutoShards);
+        }
+        shard_count = std::bit_floor(std::min(shard_count, max_session_count_.load()));
+
+        shards_.clear();
+        shards_.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i) {
+            auto shard = std::make_unique<Shard>();
+            shard->publish();
+            shards_.push_back(std::move(shard));
         }
+        session_count_ = 0;
+        shard_budget_ = ShardBudget(options.max_bytes, shard_count);
 
-        // Initialize underlying LRU cache
-        max_session_count_ = max_session_count;
-        max_data_per_session_ = max_data_per_session;
-        ttl_ = ttl;
+        counters_ = metrics::MetricsManager::getInstance()->register_cache_counters("mcp_cache");
+        counters_->resident_bytes = 0;
+        counters_->entries = 0;
 
-        // Session cache capacity: max_session_count
-        session_cache_ = std::make_unique<CacheType>(max_session_count, 10, ttl);
-        // Data cache capacity: max_session_count * max_data_per_session (with redundancy)
-        data_cache_ = std::make_unique<CacheType>(max_session_count * max_data_per_session * 2, 10, ttl);
-        // Event list cache capacity: max_session_count
-        event_list_cache_ = std::make_unique<CacheType>(max_session_count, 10, ttl);
+        if (backend_) {
+            Restore();
+            Compact();
+        }
 
-        // Start automatic cleanup thread (runs every 30 seconds)
-        session_cache_->StartCleanupThread(std::chrono::seconds(30));
-        data_cache_->StartCleanupThread(std::chrono::seconds(30));
-        event_list_cache_->StartCleanupThread(std::chrono::seconds(30));
+        // One cleanup of all shards every 30 seconds, on the housekeeping thread
+        cleanup_task_ = core::Housekeeping::instance().every(kCleanupInterval, [this]() {
+            CleanupExpiredData();
+            if (backend_ && backend_->NeedsCompaction()) {
+                Compact();
+            }
+        });
 
         is_initialized_ = true;
-        MCP_INFO("McpCache initialized (max sessions: {}, max data per session: {}, ttl: {}s)",
-                 max_session_count, max_data_per_session, ttl.count());
+        MCP_INFO("McpCache initialized (max sessions: {}, max data per session: {}, ttl: {}s, shards: {}, max bytes: {}, tool ttls: {})",
+                 options.max_sessions, options.max_data_per_session, options.ttl.count(), shard_count, options.max_bytes, tool_ttls_.size());
+    }
+
+    size_t McpCache::ShardBudget(size_t max_bytes, size_t shard_count) {
+        size_t budget = max_bytes / shard_count;
+        return max_bytes != 0 && budget == 0 ? 1 : budget;
+    }
+
+    void McpCache::SetLimits(const McpCacheOptions &options) {
+        if (shards_.empty()) {
+            return;
+        }
+        max_session_count_.store(std::max<size_t>(options.max_sessions, 1), std::memory_order_relaxed);
+        max_data_per_session_.store(options.max_data_per_session, std::memory_order_relaxed);
+        shard_budget_.store(ShardBudget(options.max_bytes, shards_.size()), std::memory_order_relaxed);
+        MCP_INFO("McpCache limits changed (max sessions: {}, max data per session: {}, max bytes: {})",
+                 options.max_sessions, options.max_data_per_session, options.max_bytes);
+    }
+
+    void McpCache::StopCleanup() {
+        core::Housekeeping::instance().cancel(std::exchange(cleanup_task_, 0));
     }
 
     ////////////////////////////////////////////////////////////////////////////////
-    /// Cache key generation methods
+    /// Cache key generation and shard helpers
     ////////////////////////////////////////////////////////////////////////////////
 
-    std::string McpCache::GetSessionKey(const std::string &session_id) const {
-        return "session:" + session_id;
+    McpCache::Shard &McpCache::GetShard(const std::string &session_id) const {
+        return *shards_[std::hash<std::string>{}(session_id) & (shards_.size() - 1)];
+    }
+
+    McpCache::SessionSlot &McpCache::AcquireSlot(Shard &shard, const std::string &session_id) {
+        auto now = steady_clock::now();
+        auto it = shard.slots.find(session_id);
+        if (it == shard.slots.end() || it->second->expired(now)) {
+            if (it != shard.slots.end()) {
+                counters_->expirations.fetch_add(1, std::memory_order_relaxed);
+                EraseSlot(shard, session_id);
+            }
+            // Over the limit: make room in this shard, the other shards are not touched
+            if (session_count_.load(std::memory_order_relaxed) >= max_session_count_.load(std::memory_order_relaxed) && !shard.slots.empty()) {
+                auto oldest = std::min_element(shard.slots.begin(), shard.slots.end(), [](const auto &a, const auto &b) {
+                    return a.second->touched < b.second->touched;
+                });
+                MCP_DEBUG("Evicting session cache - session: {}", oldest->first);
+                counters_->evictions.fetch_add(1, std::memory_order_relaxed);
+                EraseSlot(shard, std::string(oldest->first));
+            }
+            it = shard.slots.emplace(session_id, std::make_shared<SessionSlot>(max_data_per_session_.load(std::memory_order_relaxed), ttl_)).first;
+            session_count_.fetch_add(1, std::memory_order_relaxed);
+            counters_->entries.fetch_add(1, std::memory_order_relaxed);
+            shard.publish();
+        }
+
+        auto &slot = *it->second;
+        slot.touched = now;
+        slot.refresh(now);
+        return slot;
+    }
+
+    std::chrono::seconds McpCache::TtlFor(const std::string &tool_name) const {
+        auto it = tool_ttls_.find(tool_name);
+        return it != tool_ttls_.end() ? it->second : ttl_;
+    }
+
+    void McpCache::Account(Shard &shard, SessionSlot &slot, const std::string &session_id) {
+        size_t bytes = sizeof(SessionSlot) + session_id.size() + slot.events.bytes();
+        if (auto state = slot.state.load(std::memory_order_relaxed)) {
+            bytes += sizeof(SessionState) + state->session_id.size() + state->tool_name.size();
+        }
+        shard.bytes += bytes - slot.bytes;
+        counters_->resident_bytes.fetch_add(static_cast<int64_t>(bytes) - static_cast<int64_t>(slot.bytes), std::memory_order_relaxed);
+        slot.bytes = bytes;
+    }
+
+    void McpCache::EnforceBudget(Shard &shard, SessionSlot &keep) {
+        const size_t shard_budget = shard_budget_.load(std::memory_order_relaxed);
+        if (shard_budget == 0) {
+            return;
+        }
+
+        auto now = steady_clock::now();
+        while (shard.bytes > shard_budget) {
+            // Byte-weighted LRU: a large idle session goes before a small one idle for as long
+            const std::string *victim = nullptr;
+            double worst = -1;
+            for (const auto &[session_id, slot]: shard.slots) {
+                if (slot.get() == &keep) {
+                    continue;
+                }
+                auto idle = std::chrono::duration<double>(now - slot->touched).count() + 1e-3;
+                double score = idle * static_cast<double>(slot->bytes);
+                if (score > worst) {
+                    worst = score;
+                    victim = &session_id;
+                }
+            }
+
+            if (victim) {
+                MCP_DEBUG("Evicting session cache over byte budget - session: {}", *victim);
+                counters_->evictions.fetch_add(1, std::memory_order_relaxed);
+                EraseSlot(shard, std::string(*victim));
+                continue;
+            }
+
+            // Only the session being written is left, give up its oldest events but keep the newest
+            if (keep.events.size() <= 1) {
+                break;
+            }
+            auto it = std::find_if(shard.slots.begin(), shard.slots.end(), [&](const auto &entry) { return entry.second.get() == &keep; });
+            while (keep.events.size() > 1 && keep.events.bytes() + (shard.bytes - keep.bytes) > shard_budget) {
+                keep.events.drop_oldest();
+            }
+            Account(shard, keep, it->first);
+        }
     }
 
-    std::string McpCache::GetDataKey(const std::string &session_id, int event_id) const {
-        return "data:" + session_id + ":" + std::to_string(event_id);
+    McpCache::SessionSlot *McpCache::FindLiveSlot(Shard &shard, const std::string &session_id) {
+        auto it = shard.slots.find(session_id);
+        if (it == shard.slots.end()) {
+            return nullptr;
+        }
+        if (it->second->expired(steady_clock::now())) {
+            counters_->expirations.fetch_add(1, std::memory_order_relaxed);
+            EraseSlot(shard, session_id);
+            return nullptr;
+        }
+        return it->second.get();
     }
 
-    std::string McpCache::GetEventListKey(const std::string &session_id) const {
-        return "event_list:" + session_id;
+    void McpCache::EraseSlot(Shard &shard, const std::string &session_id) {
+        auto it = shard.slots.find(session_id);
+        if (it == shard.slots.end()) {
+            return;
+        }
+        shard.bytes -= it->second->bytes;
+        counters_->resident_bytes.fetch_sub(static_cast<int64_t>(it->second->bytes), std::memory_order_relaxed);
+        counters_->entries.fetch_sub(1, std::memory_order_relaxed);
+        shard.slots.erase(it);
+        session_count_.fetch_sub(1, std::memory_order_relaxed);
+        shard.publish();
+        if (backend_) {
+            backend_->RemoveSession(session_id);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Persistence
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void McpCache::Restore() {
+        // Replay without writing back, every record is already stored
+        auto backend = std::move(backend_);
+        size_t records = 0;
+
+        CacheReplay replay;
+        replay.state = [this, &records](const SessionState &state) {
+            auto &shard = GetShard(state.session_id);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto &slot = AcquireSlot(shard, state.session_id);
+            slot.ttl = TtlFor(state.tool_name);
+            slot.state.store(std::make_shared<const SessionState>(state), std::memory_order_release);
+            Account(shard, slot, state.session_id);
+            EnforceBudget(shard, slot);
+            ++records;
+        };
+        replay.event = [this, &records](const std::string &session_id, int event_id, std::string_view data) {
+            auto &shard = GetShard(session_id);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto &slot = AcquireSlot(shard, session_id);
+            slot.put(event_id, data);
+            Account(shard, slot, session_id);
+            EnforceBudget(shard, slot);
+            ++records;
+        };
+        replay.remove = [this, &records](const std::string &session_id) {
+            auto &shard = GetShard(session_id);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            EraseSlot(shard, session_id);
+            ++records;
+        };
+        backend->Load(replay);
+
+        // The TTL counts from the last update of the session, not from the restart
+        auto now = steady_clock::now();
+        auto wall_now = std::chrono::system_clock::now();
+        for (auto &shard: shards_) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            std::vector<std::string> stale;
+            for (const auto &[session_id, slot]: shard->slots) {
+                auto state = slot->state.load(std::memory_order_acquire);
+                auto remaining = state ? state->last_update + slot->ttl - wall_now : std::chrono::system_clock::duration::zero();
+                if (remaining <= std::chrono::system_clock::duration::zero()) {
+                    stale.push_back(session_id);
+                    continue;
+                }
+                slot->expires_at.store((now + std::chrono::duration_cast<steady_clock::duration>(remaining)).time_since_epoch().count(),
+                                       std::memory_order_relaxed);
+            }
+            for (const auto &session_id: stale) {
+                EraseSlot(*shard, session_id);
+            }
+        }
+
+        backend_ = std::move(backend);
+        MCP_INFO("McpCache restored {} sessions from {} records", session_count_.load(std::memory_order_relaxed), records);
+    }
+
+    void McpCache::Compact() {
+        // Writes racing with the rewrite land after BeginSnapshot and survive it
+        backend_->BeginSnapshot();
+        auto now = steady_clock::now();
+        for (auto &shard: shards_) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            for (const auto &[session_id, slot]: shard->slots) {
+                auto state = slot->state.load(std::memory_order_acquire);
+                if (!state || slot->expired(now)) {
+                    continue;
+                }
+                slot->events.for_each([&](int event_id, std::string_view data) {
+                    backend_->AppendEvent(session_id, event_id, data);
+                });
+                backend_->SaveState(*state);
+            }
+        }
+        backend_->EndSnapshot();
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -100,11 +456,18 @@ namespace mcp::cache {
             return false;
         }
 
-        std::lock_guard<std::mutex> lock(mtx_);
+        auto &shard = GetShard(state.session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
         try {
-            std::string key = GetSessionKey(state.session_id);
-            std::string value = state.to_json().dump();
-            session_cache_->Put(key, value, ttl_);
+            auto &slot = AcquireSlot(shard, state.session_id);
+            slot.ttl = TtlFor(state.tool_name);
+            slot.refresh(steady_clock::now());
+            slot.state.store(std::make_shared<const SessionState>(state), std::memory_order_release);
+            if (backend_) {
+                backend_->SaveState(state);
+            }
+            Account(shard, slot, state.session_id);
+            EnforceBudget(shard, slot);
             MCP_DEBUG("Saved session state - session: {}", state.session_id);
             return true;
         } catch (const std::exception &e) {
@@ -119,33 +482,81 @@ namespace mcp::cache {
             return std::nullopt;
         }
 
-        std::lock_guard<std::mutex> lock(mtx_);
-        try {
-            std::string key = GetSessionKey(session_id);
-            auto value_opt = session_cache_->Get(key);
-            if (!value_opt.has_value()) {
-                MCP_DEBUG("No session state found - session: {}", session_id);
-                return std::nullopt;
-            }
+        // No lock: the index and the state are immutable snapshots, replaced by writers
+        auto index = GetShard(session_id).index.load(std::memory_order_acquire);
+        auto it = index->find(session_id);
+        if (it == index->end() || it->second->expired(steady_clock::now())) {
+            MCP_DEBUG("No session state found - session: {}", session_id);
+            counters_->misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
 
-            return SessionState::from_json(nlohmann::json::parse(value_opt.value()));
-        } catch (const std::exception &e) {
-            MCP_ERROR("GetSessionState failed: {}", e.what());
+        auto state = it->second->state.load(std::memory_order_acquire);
+        if (!state) {
+            MCP_DEBUG("No session state found - session: {}", session_id);
+            counters_->misses.fetch_add(1, std::memory_order_relaxed);
             return std::nullopt;
         }
+        counters_->hits.fetch_add(1, std::memory_order_relaxed);
+        // A running stream may not have committed the events it cached yet
+        SessionState result = *state;
+        result.last_event_id = std::max(result.last_event_id, it->second->newest_event.load(std::memory_order_relaxed));
+        return result;
     }
 
     bool McpCache::UpdateSessionState(const std::string &session_id, int event_id) {
-        auto state_opt = GetSessionState(session_id);
-        if (!state_opt.has_value()) {
+        if (!IsInitialized()) {
+            MCP_ERROR("McpCache not initialized - UpdateSessionState failed");
+            return false;
+        }
+
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.slots.find(session_id);
+        std::shared_ptr<const SessionState> current;
+        if (it != shard.slots.end() && !it->second->expired(steady_clock::now())) {
+            current = it->second->state.load(std::memory_order_acquire);
+        }
+        if (!current) {
             MCP_WARN("UpdateSessionState failed: session not found - {}", session_id);
             return false;
         }
 
-        SessionState state = state_opt.value();
-        state.last_event_id = event_id;
-        state.last_update = std::chrono::system_clock::now();
-        return SaveSessionState(state);
+        auto state = std::make_shared<SessionState>(*current);
+        state->last_event_id = event_id;
+        state->last_update = std::chrono::system_clock::now();
+        if (backend_) {
+            backend_->SaveState(*state);
+        }
+        AcquireSlot(shard, session_id).state.store(std::move(state), std::memory_order_release);
+        return true;
+    }
+
+    bool McpCache::SaveStreamCheckpoint(const std::string &session_id, int event_id, std::string checkpoint) {
+        if (!IsInitialized()) {
+            MCP_ERROR("McpCache not initialized - SaveStreamCheckpoint failed");
+            return false;
+        }
+
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.slots.find(session_id);
+        std::shared_ptr<const SessionState> current;
+        if (it != shard.slots.end() && !it->second->expired(steady_clock::now())) {
+            current = it->second->state.load(std::memory_order_acquire);
+        }
+        if (!current) {
+            return false;
+        }
+
+        auto state = std::make_shared<SessionState>(*current);
+        state->checkpoint = std::move(checkpoint);
+        state->checkpoint_event_id = event_id;
+        if (backend_) {
+            backend_->SaveState(*state);
+        }
+        it->second->state.store(std::move(state), std::memory_order_release);
+        return true;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -158,38 +569,130 @@ namespace mcp::cache {
             return false;
         }
 
-        std::lock_guard<std::mutex> lock(mtx_);
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
         try {
-            // 1. Store data using event_id as key
-            std::string data_key = GetDataKey(session_id, event_id);
-            data_cache_->Put(data_key, data.dump(), ttl_);
-
-            // 2. Update event ID list for this session
-            std::string list_key = GetEventListKey(session_id);
-            std::vector<int> event_list;
-
-            // Read existing event list if available
-            auto list_opt = event_list_cache_->Get(list_key);
-            if (list_opt.has_value()) {
-                event_list = nlohmann::json::parse(list_opt.value()).get<std::vector<int>>();
+            // Store the rendered frame in the session's ring, the oldest event makes room when it is full
+            auto dumped = data.dump();
+            auto &slot = AcquireSlot(shard, session_id);
+            slot.put(event_id, dumped);
+            if (backend_) {
+                backend_->AppendEvent(session_id, event_id, dumped);
             }
+            Account(shard, slot, session_id);
+            EnforceBudget(shard, slot);
+
+            MCP_DEBUG("Cached stream data - session: {}, event: {}", session_id, event_id);
+            return true;
+        } catch (const std::exception &e) {
+            MCP_ERROR("CacheStreamData failed: {}", e.what());
+            return false;
+        }
+    }
+
+    bool McpCache::CacheStreamEvents(const std::string &session_id,
+                                     const std::vector<std::pair<int, std::string>> &events) {
+        if (!IsInitialized()) {
+            MCP_ERROR("McpCache not initialized - CacheStreamEvents failed");
+            return false;
+        }
+        if (events.empty()) {
+            return true;
+        }
 
-            // Add new event_id with deduplication
-            if (std::find(event_list.begin(), event_list.end(), event_id) == event_list.end()) {
-                event_list.push_back(event_id);
-                // Limit list length to max_data_per_session_
-                if (event_list.size() > max_data_per_session_) {
-                    event_list.erase(event_list.begin(),
-                                     event_list.begin() + (event_list.size() - max_data_per_session_));
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        try {
+            auto &slot = AcquireSlot(shard, session_id);
+            for (const auto &[event_id, data]: events) {
+                slot.put(event_id, data);
+                if (backend_) {
+                    backend_->AppendEvent(session_id, event_id, data);
                 }
-                // Save updated event list
-                event_list_cache_->Put(list_key, nlohmann::json(event_list).dump(), ttl_);
             }
+            Account(shard, slot, session_id);
+            EnforceBudget(shard, slot);
+            return true;
+        } catch (const std::exception &e) {
+            MCP_ERROR("CacheStreamEvents failed: {}", e.what());
+            return false;
+        }
+    }
 
-            MCP_DEBUG("Cached stream data - session: {}, event: {}", session_id, event_id);
+    bool McpCache::CommitStreamState(const std::string &session_id, int last_event_id,
+                                     std::string checkpoint, int checkpoint_event_id) {
+        if (!IsInitialized()) {
+            MCP_ERROR("McpCache not initialized - CommitStreamState failed");
+            return false;
+        }
+
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.slots.find(session_id);
+        std::shared_ptr<const SessionState> current;
+        if (it != shard.slots.end() && !it->second->expired(steady_clock::now())) {
+            current = it->second->state.load(std::memory_order_acquire);
+        }
+        if (!current) {
+            return false;// Cleaned up meanwhile, a commit must not bring it back
+        }
+
+        auto state = std::make_shared<SessionState>(*current);
+        state->last_event_id = std::max(state->last_event_id, last_event_id);
+        state->last_update = std::chrono::system_clock::now();
+        if (!checkpoint.empty()) {
+            state->checkpoint = std::move(checkpoint);
+            state->checkpoint_event_id = checkpoint_event_id;
+        }
+        if (backend_) {
+            backend_->SaveState(*state);
+        }
+        it->second->state.store(std::move(state), std::memory_order_release);
+        return true;
+    }
+
+    bool McpCache::CacheStreamBatch(const std::string &session_id,
+                                    const std::vector<std::pair<int, std::string>> &events) {
+        if (!IsInitialized()) {
+            MCP_ERROR("McpCache not initialized - CacheStreamBatch failed");
+            return false;
+        }
+        if (events.empty()) {
+            return true;
+        }
+
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        try {
+            // 1. Append each event's rendered frame to the session's ring
+            auto &slot = AcquireSlot(shard, session_id);
+            for (const auto &[event_id, data]: events) {
+                slot.put(event_id, data);
+                if (backend_) {
+                    backend_->AppendEvent(session_id, event_id, data);
+                }
+            }
+
+            // 2. Record the last event of the batch as sent
+            auto current = slot.state.load(std::memory_order_acquire);
+            auto state = current ? std::make_shared<SessionState>(*current) : std::make_shared<SessionState>();
+            if (!current) {
+                state->session_id = session_id;
+            }
+            state->last_event_id = events.back().first;
+            state->last_update = std::chrono::system_clock::now();
+            if (backend_) {
+                backend_->SaveState(*state);
+            }
+            slot.state.store(std::move(state), std::memory_order_release);
+            Account(shard, slot, session_id);
+            EnforceBudget(shard, slot);
+
+            MCP_DEBUG("Cached stream batch - session: {}, events: {}-{}",
+                      session_id, events.front().first, events.back().first);
             return true;
         } catch (const std::exception &e) {
-            MCP_ERROR("CacheStreamData failed: {}", e.what());
+            MCP_ERROR("CacheStreamBatch failed: {}", e.what());
             return false;
         }
     }
@@ -203,37 +706,21 @@ namespace mcp::cache {
             return result;
         }
 
-        std::lock_guard<std::mutex> lock(mtx_);
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
         try {
-            // 1. Clean up expired data first
-            CleanupExpiredData();
-
-            // 2. Get event list for this session
-            std::string list_key = GetEventListKey(session_id);
-            auto list_opt = event_list_cache_->Get(list_key);
-            if (!list_opt.has_value()) {
+            // 1. Get the session's events, dropping them if they have expired
+            auto *slot = FindLiveSlot(shard, session_id);
+            if (!slot) {
                 MCP_DEBUG("No event list found - session: {}", session_id);
+                counters_->misses.fetch_add(1, std::memory_order_relaxed);
                 return result;
             }
+            counters_->hits.fetch_add(1, std::memory_order_relaxed);
 
-            // 3. Filter events newer than last received event
-            std::vector<int> event_list = nlohmann::json::parse(list_opt.value()).get<std::vector<int>>();
-            std::vector<int> target_events;
-
-            for (int event: event_list) {
-                if (event > last_event_id) {
-                    target_events.push_back(event);
-                }
-            }
-            std::sort(target_events.begin(), target_events.end());
-
-            // 4. Retrieve cached data for target events
-            for (int event: target_events) {
-                std::string data_key = GetDataKey(session_id, event);
-                auto data_opt = data_cache_->Get(data_key);
-                if (data_opt.has_value()) {
-                    result.push_back(nlohmann::json::parse(data_opt.value()));
-                }
+            // 2. The ring is ordered by event ID, take everything after the last received event
+            for (auto data: slot->events.data_after(last_event_id)) {
+                result.push_back(nlohmann::json::parse(data));
             }
 
             MCP_DEBUG("Found {} reconnect data items - session: {}", result.size(), session_id);
@@ -244,6 +731,27 @@ namespace mcp::cache {
         }
     }
 
+    std::vector<std::string> McpCache::GetReconnectFrames(const std::string &session_id, int last_event_id) {
+        if (!IsInitialized()) {
+            MCP_ERROR("McpCache not initialized - GetReconnectFrames failed");
+            return {};
+        }
+
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto *slot = FindLiveSlot(shard, session_id);
+        if (!slot) {
+            MCP_DEBUG("No event list found - session: {}", session_id);
+            counters_->misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        counters_->hits.fetch_add(1, std::memory_order_relaxed);
+
+        auto frames = slot->events.frames_after(last_event_id);
+        MCP_DEBUG("Found {} reconnect frames - session: {}", frames.size(), session_id);
+        return frames;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     /// Session cleanup operations
     ////////////////////////////////////////////////////////////////////////////////
@@ -254,25 +762,11 @@ namespace mcp::cache {
             return false;
         }
 
-        std::lock_guard<std::mutex> lock(mtx_);
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
         try {
-            // 1. Delete session state
-            std::string session_key = GetSessionKey(session_id);
-            session_cache_->Remove(session_key);
-
-            // 2. Delete event list and associated data
-            std::string list_key = GetEventListKey(session_id);
-            auto list_opt = event_list_cache_->Get(list_key);
-            event_list_cache_->Remove(list_key);
-
-            // 3. Delete all cached data for this session
-            if (list_opt.has_value()) {
-                std::vector<int> event_list = nlohmann::json::parse(list_opt.value()).get<std::vector<int>>();
-                for (int event: event_list) {
-                    std::string data_key = GetDataKey(session_id, event);
-                    data_cache_->Remove(data_key);
-                }
-            }
+            // Deletes the session state, its event list and all cached data for this session
+            EraseSlot(shard, session_id);
 
             MCP_DEBUG("Cleaned up session cache - session: {}", session_id);
             return true;
@@ -289,15 +783,144 @@ namespace mcp::cache {
     void McpCache::CleanupExpiredData() {
         if (!IsInitialized()) return;
 
-        // Manually trigger LRU cache expiration cleanup
-        session_cache_->CleanUpExpiredItems();
-        data_cache_->CleanUpExpiredItems();
-        event_list_cache_->CleanUpExpiredItems();
+        size_t event_count = 0;
+        auto now = steady_clock::now();
+        for (auto &shard: shards_) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            std::vector<std::string> expired;
+            for (const auto &[session_id, slot]: shard->slots) {
+                if (slot->expired(now)) {
+                    expired.push_back(session_id);
+                }
+            }
+            counters_->expirations.fetch_add(expired.size(), std::memory_order_relaxed);
+            for (const auto &session_id: expired) {
+                EraseSlot(*shard, session_id);
+            }
+            for (const auto &[session_id, slot]: shard->slots) {
+                event_count += slot->events.size();
+            }
+        }
+
+        MCP_DEBUG("McpCache cleanup completed - sessions: {}, events: {}, bytes: {}, shards: {}",
+                  session_count_.load(std::memory_order_relaxed), event_count,
+                  counters_->resident_bytes.load(std::memory_order_relaxed), shards_.size());
+    }
+
+    void McpCache::Flush() {
+        if (backend_) {
+            backend_->Flush();
+        }
+    }
+
+    void McpCache::DetachBackend() {
+        // Compaction uses the backend outside the shard locks, every other writer under them
+        StopCleanup();
+        std::shared_ptr<CacheBackend> backend;
+        {
+            std::vector<std::unique_lock<std::mutex>> locks;
+            locks.reserve(shards_.size());
+            for (auto &shard: shards_) {
+                locks.emplace_back(shard->mtx);
+            }
+            backend = std::move(backend_);
+        }
+        if (backend) {
+            backend->Flush();
+            MCP_INFO("Cache persistence detached, sessions stay in memory");
+        }
+    }
+
+    std::optional<SessionExport> McpCache::ExportSession(const std::string &session_id) {
+        if (!IsInitialized()) {
+            return std::nullopt;
+        }
 
-        MCP_DEBUG("McpCache cleanup completed - sessions: {}, data: {}, event_lists: {}",
-                  session_cache_->Size(),
-                  data_cache_->Size(),
-                  event_list_cache_->Size());
+        auto &shard = GetShard(session_id);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.slots.find(session_id);
+        if (it == shard.slots.end() || it->second->expired(steady_clock::now())) {
+            return std::nullopt;
+        }
+        auto state = it->second->state.load(std::memory_order_acquire);
+        if (!state) {
+            return std::nullopt;
+        }
+        SessionExport session{*state, {}};
+        it->second->events.for_each([&](int event_id, std::string_view data) {
+            session.events.emplace_back(event_id, std::string(data));
+        });
+        return session;
+    }
+
+    std::vector<SessionExport> McpCache::ExportSessions() {
+        std::vector<SessionExport> sessions;
+        if (!IsInitialized()) {
+            return sessions;
+        }
+
+        auto now = steady_clock::now();
+        for (auto &shard: shards_) {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            for (const auto &[session_id, slot]: shard->slots) {
+                auto state = slot->state.load(std::memory_order_acquire);
+                if (!state || slot->expired(now)) {
+                    continue;
+                }
+                auto &session = sessions.emplace_back(SessionExport{*state, {}});
+                slot->events.for_each([&](int event_id, std::string_view data) {
+                    session.events.emplace_back(event_id, std::string(data));
+                });
+            }
+        }
+        return sessions;
+    }
+
+    bool McpCache::ImportSession(const SessionExport &session) {
+        // The state is saved last, CacheStreamBatch() moves last_event_id to the final event
+        return CleanupSession(session.state.session_id) &&
+               CacheStreamBatch(session.state.session_id, session.events) &&
+               SaveSessionState(session.state);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Write-behind state of running streams
+    ////////////////////////////////////////////////////////////////////////////////
+
+    StreamStateWriter::StreamStateWriter(std::string session_id, const McpCacheOptions &options)
+        : session_id_(std::move(session_id)),
+          mode_(options.stream_state_commit),
+          interval_(options.stream_state_commit_interval),
+          next_commit_(std::chrono::steady_clock::now() + interval_) {
+    }
+
+    StreamStateWriter::~StreamStateWriter() {
+        commit();
+    }
+
+    void StreamStateWriter::sent(int last_event_id) {
+        last_event_id_ = last_event_id;
+        dirty_ = true;
+        if (mode_ == StreamStateCommit::Batch ||
+            (mode_ == StreamStateCommit::Interval && std::chrono::steady_clock::now() >= next_commit_)) {
+            commit();
+        }
+    }
+
+    void StreamStateWriter::checkpoint(int event_id, std::string checkpoint) {
+        checkpoint_ = std::move(checkpoint);
+        checkpoint_event_id_ = event_id;
+        dirty_ = true;
+    }
+
+    void StreamStateWriter::commit() {
+        if (!dirty_) {
+            return;
+        }
+        McpCache::GetInstance()->CommitStreamState(session_id_, last_event_id_, std::move(checkpoint_), checkpoint_event_id_);
+        checkpoint_.clear();
+        dirty_ = false;
+        next_commit_ = std::chrono::steady_clock::now() + interval_;
     }
 
-}// namespace mcp::cache
\ No newline at end of file
+}// namespace mcp::cache
@@ -1,20 +1,24 @@
 #pragma once
 #include "nlohmann/json.hpp"
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-// Forward declaration of LRUCache
-namespace Astra::datastructures {
-    template<typename Key, typename Value>
-    class LRUCache;
+namespace mcp::metrics {
+    struct CacheCounters;
 }
 
 namespace mcp::cache {
 
+    class CacheBackend;
+
     /**
      * @brief Session state structure for recording key information before disconnection
      * 
@@ -27,6 +31,8 @@ namespace mcp::cache {
         int last_event_id = 0;                            ///< Last sent event ID
         bool is_active = true;                            ///< Session active status
         std::chrono::system_clock::time_point last_update;///< Last update timestamp
+        std::string checkpoint;                           ///< Generator checkpoint, base64; empty if the stream cannot be resumed from one
+        int checkpoint_event_id = 0;                      ///< Last event the checkpoint includes
 
         /**
          * @brief Serialize to JSON for local storage
@@ -43,11 +49,84 @@ namespace mcp::cache {
     };
 
     /**
-     * @brief Core cache class based on LRUCache implementation
+     * @brief A session with its cached events, as handed from one process to the next on hot restart
+     */
+    struct SessionExport {
+        SessionState state;                              ///< Session state
+        std::vector<std::pair<int, std::string>> events;///< Event identifiers with their compact JSON data, in event order
+    };
+
+    /**
+     * @brief When a running stream's session state (last event, checkpoint) reaches the cache,
+     *        see StreamStateWriter. Events are cached with every batch whatever the mode.
+     */
+    enum class StreamStateCommit {
+        Batch,   ///< With every batch, as durable as the events
+        Interval,///< At most every stream_state_commit_interval, and when the stream ends
+        End      ///< When the stream ends, a crash loses the checkpoint of a running stream
+    };
+
+    /**
+     * @brief McpCache limits, normally taken from the [cache] section.
+     */
+    struct McpCacheOptions {
+        size_t max_sessions = 1000;                                     ///< Sessions kept, see McpCache::Init
+        size_t max_data_per_session = 500;                              ///< Events kept per session
+        std::chrono::seconds ttl = std::chrono::hours(24);              ///< Lifetime of a session after its last write
+        size_t shard_count = 0;                                         ///< Lock stripes, 0 = derived from the core count
+        size_t max_bytes = 0;                                           ///< Memory budget of all sessions, 0 = unlimited
+        std::unordered_map<std::string, std::chrono::seconds> tool_ttls;///< Tool name -> TTL overriding ttl
+        StreamStateCommit stream_state_commit = StreamStateCommit::Interval;///< See StreamStateWriter
+        std::chrono::milliseconds stream_state_commit_interval{1000};      ///< Used by StreamStateCommit::Interval
+
+        static const McpCacheOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options the cache is initialized with. Call once at startup.
+         * @param options Options
+         */
+        static void configure(McpCacheOptions options) { storage() = std::move(options); }
+
+        /**
+         * @brief Parse a TTL list such as "search=300,read_file=86400", in seconds.
+         * @param text TTL list, empty for none
+         * @return Tool name mapped to its TTL; 0 keeps nothing for reconnects
+         */
+        static std::unordered_map<std::string, std::chrono::seconds> parse_tool_ttls(std::string_view text);
+
+        /**
+         * @brief Parse a commit mode name: "batch", "interval" or "end".
+         * @param text Mode name
+         * @return Mode, Interval for unknown names
+         */
+        static StreamStateCommit parse_stream_state_commit(std::string_view text);
+
+    private:
+        static McpCacheOptions &storage() {
+            static McpCacheOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Core cache class keeping the recent events of each stream session
      * 
      * Provides local caching support for disconnection and reconnection 
      * data recovery, enabling seamless user experience even when network 
      * interruptions occur.
+     *
+     * Sessions are spread over shards by a hash of their id, each shard with its own
+     * lock, so streams of different sessions rarely contend. Session states are
+     * published for lookups without taking any lock. Events are kept per session in a
+     * ring of max_data_per_session rendered SSE frames, see SseEventRing.
+     *
+     * Every session is charged for the bytes it holds. With a byte budget, each shard
+     * keeps its share of it by evicting the session with the largest idle time times
+     * size, or, for a single huge session, its oldest events. Hit rate, evictions and
+     * resident bytes are counted in MetricsManager as "mcp_cache".
+     *
+     * With a CacheBackend set, every write is also queued to the backend and Init()
+     * restores what it holds, so streams can be resumed after a restart.
      */
     class McpCache {
     public:
@@ -57,15 +136,39 @@ namespace mcp::cache {
          */
         static McpCache *GetInstance();
 
+        /**
+         * @brief Persist the cache through a backend. Must be called before Init(), which
+         *        restores the sessions the backend holds.
+         * @param backend Durable store, nullptr keeps the cache in memory only
+         */
+        void SetBackend(std::shared_ptr<CacheBackend> backend);
+
         /**
          * @brief Initialize cache (set capacity and expiration time)
-         * @param max_session_count Maximum number of sessions
+         * @param max_session_count Maximum number of sessions; sessions are evicted within their
+         *        own shard, so up to shard_count - 1 more may be held
          * @param max_data_per_session Maximum data items per session
          * @param ttl Time to live for cached items
+         * @param shard_count Number of shards, 0 = derived from the hardware concurrency
          */
         void Init(size_t max_session_count = 1000,
                   size_t max_data_per_session = 500,
-                  std::chrono::seconds ttl = std::chrono::hours(24));
+                  std::chrono::seconds ttl = std::chrono::hours(24),
+                  size_t shard_count = 0);
+
+        /**
+         * @brief Initialize cache with all options
+         * @param options Limits, TTLs and memory budget
+         */
+        void Init(const McpCacheOptions &options);
+
+        /**
+         * @brief Change the limits of an initialized cache, e.g. on a config reload.
+         * The session and byte limits apply from the next write; the event limit applies to
+         * sessions created from then on. The shard count and TTLs stay as Init() set them.
+         * @param options Limits; only max_sessions, max_data_per_session and max_bytes are used
+         */
+        void SetLimits(const McpCacheOptions &options);
 
         /**
          * @brief Save session state (called before disconnection)
@@ -75,7 +178,7 @@ namespace mcp::cache {
         bool SaveSessionState(const SessionState &state);
 
         /**
-         * @brief Get session state (called during reconnection)
+         * @brief Get session state (called during reconnection). Lock free.
          * @param session_id Session identifier
          * @return Optional containing session state if found
          */
@@ -89,6 +192,16 @@ namespace mcp::cache {
          */
         bool UpdateSessionState(const std::string &session_id, int event_id);
 
+        /**
+         * @brief Record where a stream's generator can be restored from, see stream_restore.
+         * Kept with the session state, so a backend carries it over a restart or to another node.
+         * @param session_id Session identifier
+         * @param event_id Last event the checkpoint includes
+         * @param checkpoint Generator checkpoint, base64
+         * @return true if successful, false if the session has no state
+         */
+        bool SaveStreamCheckpoint(const std::string &session_id, int event_id, std::string checkpoint);
+
         /**
          * @brief Cache streaming data (synchronously cached during real-time sending)
          * @param session_id Session identifier
@@ -98,6 +211,41 @@ namespace mcp::cache {
          */
         bool CacheStreamData(const std::string &session_id, int event_id, const nlohmann::json &data);
 
+        /**
+         * @brief Cache a batch of stream events without touching the session state
+         *
+         * For streams that commit their state with CommitStreamState(); GetSessionState()
+         * still reports the newest cached event as the last one sent.
+         * @param session_id Session identifier
+         * @param events Event identifiers with their compact JSON data, in event order
+         * @return true if successful, false otherwise
+         */
+        bool CacheStreamEvents(const std::string &session_id,
+                               const std::vector<std::pair<int, std::string>> &events);
+
+        /**
+         * @brief Commit the state a running stream kept to itself, with one state write
+         * @param session_id Session identifier
+         * @param last_event_id Last event sent
+         * @param checkpoint Generator checkpoint, base64; empty keeps the saved one
+         * @param checkpoint_event_id Last event the checkpoint includes
+         * @return true if successful, false if the session has no state, e.g. it was cleaned up
+         */
+        bool CommitStreamState(const std::string &session_id, int last_event_id,
+                               std::string checkpoint = {}, int checkpoint_event_id = 0);
+
+        /**
+         * @brief Cache a batch of stream events and record the last one as sent
+         * 
+         * Takes the lock once and updates the event list and session state once for the
+         * whole batch. The events are stored as given, without being parsed.
+         * @param session_id Session identifier
+         * @param events Event identifiers with their compact JSON data, in event order
+         * @return true if successful, false otherwise
+         */
+        bool CacheStreamBatch(const std::string &session_id,
+                              const std::vector<std::pair<int, std::string>> &events);
+
         /**
          * @brief Get reconnection data (called during recovery after disconnection)
          * @param session_id Session identifier
@@ -108,6 +256,14 @@ namespace mcp::cache {
                 const std::string &session_id,
                 int last_event_id);
 
+        /**
+         * @brief Get the rendered SSE frames to replay on reconnection
+         * @param session_id Session identifier
+         * @param last_event_id Last received event identifier from client
+         * @return Complete "event: message" frames in event order, ready to be written as they are
+         */
+        std::vector<std::string> GetReconnectFrames(const std::string &session_id, int last_event_id);
+
         /**
          * @brief Clean up session cache (called when session ends normally)
          * @param session_id Session identifier
@@ -120,6 +276,37 @@ namespace mcp::cache {
          */
         void CleanupExpiredData();
 
+        /**
+         * @brief Wait until the backend has persisted every write made so far, e.g. before the
+         *        process stops with streams that are resumed elsewhere; returns at once without a backend
+         */
+        void Flush();
+
+        /**
+         * @brief Flush the backend and stop using it; later writes stay in memory. For a process
+         *        whose successor is about to open the same persistence directory
+         */
+        void DetachBackend();
+
+        /**
+         * @brief Copy out a live session with its cached events
+         * @param session_id Session identifier
+         * @return The session, nullopt if it has no saved state or has expired
+         */
+        std::optional<SessionExport> ExportSession(const std::string &session_id);
+
+        /**
+         * @brief Copy out every live session with its cached events, taking one shard lock at a time
+         */
+        std::vector<SessionExport> ExportSessions();
+
+        /**
+         * @brief Replace a session with one exported by another process
+         * @param session Exported session
+         * @return true if successful, false otherwise
+         */
+        bool ImportSession(const SessionExport &session);
+
         /**
          * @brief Check if cache is successfully initialized
          * @return true if initialized, false otherwise
@@ -127,42 +314,147 @@ namespace mcp::cache {
         bool IsInitialized() const { return is_initialized_; }
 
     private:
+        struct SessionSlot;
+        struct Shard;
+
         McpCache() = default;///< Prevent external instantiation
-        ~McpCache() = default;
+        ~McpCache();
 
         /**
-         * @brief Generate cache key for session state
+         * @brief Pick the shard of a session
          * @param session_id Session identifier
-         * @return Generated cache key
+         * @return Shard owning the session
          */
-        std::string GetSessionKey(const std::string &session_id) const;
+        Shard &GetShard(const std::string &session_id) const;
 
         /**
-         * @brief Generate data cache key using event ID
+         * @brief Find or create the slot of a session, evicting the least recently written
+         *        session of the shard once max_session_count_ is reached
+         * @param shard Shard of the session, its mutex held
          * @param session_id Session identifier
-         * @param event_id Event identifier
-         * @return Generated cache key
+         * @return Slot of the session
          */
-        std::string GetDataKey(const std::string &session_id, int event_id) const;
+        SessionSlot &AcquireSlot(Shard &shard, const std::string &session_id);
 
         /**
-         * @brief Generate event list cache key
+         * @brief Find the slot of a session, dropping it if it has expired
+         * @param shard Shard of the session, its mutex held
          * @param session_id Session identifier
-         * @return Generated cache key
+         * @return Slot of the session, nullptr if there is none
+         */
+        SessionSlot *FindLiveSlot(Shard &shard, const std::string &session_id);
+
+        /**
+         * @brief Lifetime of a session of a tool
+         * @param tool_name Tool name, may be empty
+         * @return TTL override of the tool, or the default TTL
+         */
+        std::chrono::seconds TtlFor(const std::string &tool_name) const;
+
+        /**
+         * @brief Recharge the shard for the current size of a slot
+         * @param shard Shard of the session, its mutex held
+         * @param slot Slot that changed
+         * @param session_id Session identifier
+         */
+        void Account(Shard &shard, SessionSlot &slot, const std::string &session_id);
+
+        /**
+         * @brief Evict until the shard is within its share of the byte budget
+         * @param shard Shard of the session, its mutex held
+         * @param keep Slot just written, only trimmed once no other session is left
+         */
+        void EnforceBudget(Shard &shard, SessionSlot &keep);
+
+        /**
+         * @brief Drop a session slot and its cached data
+         * @param shard Shard of the session, its mutex held
+         * @param session_id Session identifier
+         */
+        void EraseSlot(Shard &shard, const std::string &session_id);
+
+        /**
+         * @brief Rebuild the shards from the backend, keeping sessions whose TTL has not run out
+         */
+        void Restore();
+
+        /**
+         * @brief Rewrite the live sessions to the backend so it can drop older records
+         */
+        void Compact();
+
+        /**
+         * @brief Stop the periodic cleanup if it is scheduled; a cleanup in progress is finished first
+         */
+        void StopCleanup();
+
+        /**
+         * @brief One shard's share of a byte budget, 0 only if the budget is 0
+         */
+        static size_t ShardBudget(size_t max_bytes, size_t shard_count);
+
+        bool is_initialized_ = false;                                    ///< Initialization status
+        std::chrono::seconds ttl_;                                       ///< Default expiration time
+        std::atomic<size_t> max_session_count_{1000};                    ///< Maximum number of sessions, see SetLimits()
+        std::atomic<size_t> max_data_per_session_{500};                  ///< Maximum data items per new session
+        std::atomic<size_t> shard_budget_{0};                            ///< Byte budget of each shard, 0 = unlimited
+        std::unordered_map<std::string, std::chrono::seconds> tool_ttls_;///< Tool name -> TTL overriding ttl_
+        std::shared_ptr<metrics::CacheCounters> counters_;               ///< Hit rate, evictions and resident bytes
+        std::atomic<size_t> session_count_{0};                           ///< Sessions over all shards
+        std::vector<std::unique_ptr<Shard>> shards_;                     ///< Power-of-two number of shards
+        std::shared_ptr<CacheBackend> backend_;                          ///< Durable store, may be null
+
+        uint64_t cleanup_task_ = 0;///< core::Housekeeping task running CleanupExpiredData(), 0 if none
+    };
+
+    /**
+     * @brief Session state of a running stream, kept by its consumer and written behind.
+     *
+     * Writing the state is a copy of it and, with a backend, a serialized record; the stream
+     * records its progress here instead, and the writer commits it to the cache according to
+     * McpCacheOptions::stream_state_commit. Commit before anything reads the state on another
+     * path, such as a hot restart handover; the destructor commits what is left. Not thread safe,
+     * owned by the stream's coroutine.
+     */
+    class StreamStateWriter {
+    public:
+        /**
+         * @param session_id Session of the stream
+         * @param options Commit mode and interval
          */
-        std::string GetEventListKey(const std::string &session_id) const;
+        explicit StreamStateWriter(std::string session_id, const McpCacheOptions &options = McpCacheOptions::current());
+        ~StreamStateWriter();
+
+        StreamStateWriter(const StreamStateWriter &) = delete;
+        StreamStateWriter &operator=(const StreamStateWriter &) = delete;
 
-        std::mutex mtx_;             ///< Thread safety mutex
-        bool is_initialized_ = false;///< Initialization status
-        std::chrono::seconds ttl_;   ///< Default expiration time
-        size_t max_session_count_;   ///< Maximum number of sessions
-        size_t max_data_per_session_;///< Maximum data items per session
+        /**
+         * @brief Record a batch as sent; commits if the mode says so.
+         * @param last_event_id Last event of the batch
+         */
+        void sent(int last_event_id);
 
-        /// Underlying cache storage: key is string, value is JSON string
-        using CacheType = Astra::datastructures::LRUCache<std::string, std::string>;
-        std::unique_ptr<CacheType> session_cache_;   ///< Stores session states
-        std::unique_ptr<CacheType> data_cache_;      ///< Stores streaming data
-        std::unique_ptr<CacheType> event_list_cache_;///< Stores event ID lists per session
+        /**
+         * @brief Record the generator's checkpoint after an event; committed with the next commit.
+         * @param event_id Last event the checkpoint includes
+         * @param checkpoint Checkpoint, base64
+         */
+        void checkpoint(int event_id, std::string checkpoint);
+
+        /**
+         * @brief Write what was recorded since the last commit, if anything.
+         */
+        void commit();
+
+    private:
+        std::string session_id_;
+        StreamStateCommit mode_;
+        std::chrono::milliseconds interval_;
+        std::chrono::steady_clock::time_point next_commit_;
+        int last_event_id_ = 0;
+        std::string checkpoint_;
+        int checkpoint_event_id_ = 0;
+        bool dirty_ = false;
     };
 
 }// namespace mcp::cache
\ No newline at end of file
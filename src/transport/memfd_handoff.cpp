@@ -0,0 +1,77 @@
+#include "memfd_handoff.h"
+#include "core/logger.h"
+#include "session.h"
+#include <atomic>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace mcp::transport {
+
+    bool wants_memfd(const Session &session, size_t size) {
+        size_t min_size = MemfdHandoffOptions::current().min_size;
+        return min_size != 0 && size >= min_size && session.can_pass_descriptors() &&
+               session.get_headers().contains(kAcceptMemfdHeader);
+    }
+
+    std::string memfd_envelope(size_t size) {
+        std::string envelope = R"({"memfd":{"size":)";
+        envelope += std::to_string(size);
+        envelope += R"(,"contentType":"application/json"}})";
+        return envelope;
+    }
+
+    SealedMemfd &SealedMemfd::operator=(SealedMemfd &&other) noexcept {
+        if (this != &other) {
+            this->~SealedMemfd();
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+
+    SealedMemfd::~SealedMemfd() {
+#if defined(__linux__)
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    std::optional<SealedMemfd> SealedMemfd::create([[maybe_unused]] std::string_view bytes) {
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+        static std::atomic<bool> warned{false};
+        int fd = ::memfd_create("mcp-response", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) {
+            if (!warned.exchange(true, std::memory_order_relaxed)) {
+                MCP_WARN("memfd_create failed ({}), large responses are sent over the socket", errno);
+            }
+            return std::nullopt;
+        }
+        SealedMemfd memfd(fd);
+        size_t written = 0;
+        while (written < bytes.size()) {
+            ssize_t n = ::write(fd, bytes.data() + written, bytes.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                MCP_WARN("Writing a response into a memfd failed ({})", errno);
+                return std::nullopt;
+            }
+            written += static_cast<size_t>(n);
+        }
+        if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+            MCP_WARN("Sealing a response memfd failed ({})", errno);
+            return std::nullopt;
+        }
+        return memfd;
+#else
+        return std::nullopt;
+#endif
+    }
+
+}// namespace mcp::transport
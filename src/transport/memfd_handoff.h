@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace mcp::transport {
+
+    class Session;
+
+    /**
+     * @brief Handing large responses to local clients in a sealed memfd, normally taken from the [server] config section.
+     */
+    struct MemfdHandoffOptions {
+        size_t min_size = 1024 * 1024;///< Responses of at least this many bytes are handed over, 0 = never
+
+        static const MemfdHandoffOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         */
+        static void configure(const MemfdHandoffOptions &options) { storage() = options; }
+
+    private:
+        static MemfdHandoffOptions &storage() {
+            static MemfdHandoffOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Request header a client on a Unix domain socket sends to take large responses as a memfd.
+     */
+    inline constexpr std::string_view kAcceptMemfdHeader = "X-MCP-Accept-Memfd";
+
+    /**
+     * @brief Whether a response body goes to the client in a memfd: the session can pass
+     *        descriptors, the client sent kAcceptMemfdHeader and the body is large enough.
+     * @param session Session of the request
+     * @param size Response body size
+     */
+    bool wants_memfd(const Session &session, size_t size);
+
+    /**
+     * @brief Content type of a response handed over in a memfd.
+     */
+    inline constexpr std::string_view kMemfdContentType = "application/vnd.mcp.memfd+json";
+
+    /**
+     * @brief Body of a response handed over in a memfd: {"memfd":{"size":N,"contentType":"application/json"}}.
+     * @param size Bytes in the memfd
+     */
+    std::string memfd_envelope(size_t size);
+
+    /**
+     * @brief Anonymous in-memory file holding a response, sealed so neither side can change
+     *        or resize it once it was handed over. Linux only. Closes its descriptor on destruction;
+     *        the client's copy of it, received over the socket, keeps the memory alive.
+     */
+    class SealedMemfd {
+    public:
+        /**
+         * @brief Copy bytes into a new memfd and seal it.
+         * @return The memfd, std::nullopt where memfds are not available or creating it failed
+         */
+        static std::optional<SealedMemfd> create(std::string_view bytes);
+
+        SealedMemfd(SealedMemfd &&other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+        SealedMemfd &operator=(SealedMemfd &&other) noexcept;
+        SealedMemfd(const SealedMemfd &) = delete;
+        SealedMemfd &operator=(const SealedMemfd &) = delete;
+        ~SealedMemfd();
+
+        int fd() const { return fd_; }
+
+    private:
+        explicit SealedMemfd(int fd) : fd_(fd) {}
+        int fd_ = -1;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,149 @@
+#include "notification_broadcast.h"
+#include "core/logger.h"
+#include "stdio_transport.h"
+#include <algorithm>
+
+namespace mcp::transport {
+
+    NotificationBroadcast::Registration &NotificationBroadcast::Registration::operator=(Registration &&other) noexcept {
+        if (this != &other) {
+            if (id_ != 0) {
+                NotificationBroadcast::instance().remove(id_);
+            }
+            id_ = std::exchange(other.id_, 0);
+        }
+        return *this;
+    }
+
+    NotificationBroadcast::Registration::~Registration() {
+        if (id_ != 0) {
+            NotificationBroadcast::instance().remove(id_);
+        }
+    }
+
+    NotificationBroadcast &NotificationBroadcast::instance() {
+        static NotificationBroadcast broadcast;
+        return broadcast;
+    }
+
+    std::shared_ptr<const std::string> NotificationBroadcast::encode(const nlohmann::json &notification) {
+        return std::make_shared<const std::string>(notification.dump());
+    }
+
+    SseSendQueue::SharedFrame NotificationBroadcast::sse_frame(const std::vector<std::shared_ptr<const std::string>> &messages) {
+        static const auto prefix = std::make_shared<const std::string>("event: message\ndata: ");
+        static const auto terminator = std::make_shared<const std::string>("\n\n");
+        SseSendQueue::SharedFrame frame;
+        frame.reserve(messages.size() * 3);
+        for (const auto &message: messages) {
+            frame.push_back(prefix);
+            frame.push_back(message);
+            frame.push_back(terminator);
+        }
+        return frame;
+    }
+
+    NotificationBroadcast::Registration NotificationBroadcast::listen(asio::any_io_executor executor, std::weak_ptr<SseSendQueue> queue,
+                                                                      const std::string &client_session) {
+        std::lock_guard lock(mutex_);
+        uint64_t id = next_id_++;
+        listeners_[id] = {{std::move(executor), std::move(queue)}, client_session};
+        if (!client_session.empty()) {
+            channels_[client_session] = id;
+        }
+        return Registration(id);
+    }
+
+    std::optional<NotificationBroadcast::Channel> NotificationBroadcast::channel(const std::string &client_session) const {
+        std::lock_guard lock(mutex_);
+        auto it = channels_.find(client_session);
+        if (it == channels_.end()) {
+            return std::nullopt;
+        }
+        return listeners_.at(it->second);
+    }
+
+    bool NotificationBroadcast::send(const std::string &client_session, const std::vector<std::shared_ptr<const std::string>> &messages) {
+        auto target = channel(client_session);
+        if (!target) {
+            return false;
+        }
+        asio::post(target->executor, [queue = std::move(target->queue), frame = sse_frame(messages)]() mutable {
+            if (auto stream = queue.lock()) {
+                stream->push_shared(std::move(frame));
+            }
+        });
+        return true;
+    }
+
+    size_t NotificationBroadcast::broadcast(const std::shared_ptr<const std::string> &message) {
+        if (auto *stdio = StdioTransport::active()) {
+            stdio->write(*message);
+        }
+
+        // One post per executor, few groups: there are as many executors as io threads
+        std::vector<std::pair<asio::any_io_executor, std::vector<std::weak_ptr<SseSendQueue>>>> groups;
+        size_t count = 0;
+        {
+            std::lock_guard lock(mutex_);
+            for (const auto &[id, listener]: listeners_) {
+                auto group = std::find_if(groups.begin(), groups.end(),
+                                          [&listener](const auto &other) { return other.first == listener.executor; });
+                if (group == groups.end()) {
+                    group = groups.insert(groups.end(), {listener.executor, {}});
+                }
+                group->second.push_back(listener.queue);
+            }
+            count = listeners_.size();
+        }
+
+        auto frame = std::make_shared<const SseSendQueue::SharedFrame>(sse_frame({message}));
+        for (auto &[executor, queues]: groups) {
+            asio::post(executor, [frame, queues = std::move(queues)]() {
+                for (const auto &weak: queues) {
+                    if (auto queue = weak.lock()) {
+                        queue->push_shared(*frame);
+                    }
+                }
+            });
+        }
+        MCP_DEBUG("Broadcast notification to {} event streams", count);
+        return count;
+    }
+
+    size_t NotificationBroadcast::listeners() const {
+        std::lock_guard lock(mutex_);
+        return listeners_.size();
+    }
+
+    void NotificationBroadcast::on_session_end(SessionEndHandler handler) {
+        std::lock_guard lock(mutex_);
+        session_end_handlers_.push_back(std::move(handler));
+    }
+
+    void NotificationBroadcast::end_session(const std::string &client_session) {
+        std::vector<SessionEndHandler> handlers;
+        {
+            std::lock_guard lock(mutex_);
+            handlers = session_end_handlers_;
+        }
+        for (const auto &handler: handlers) {
+            handler(client_session);
+        }
+    }
+
+    void NotificationBroadcast::remove(uint64_t id) {
+        std::lock_guard lock(mutex_);
+        auto it = listeners_.find(id);
+        if (it == listeners_.end()) {
+            return;
+        }
+        // Unless a newer stream of the client has taken over
+        auto channel = channels_.find(it->second.client_session);
+        if (channel != channels_.end() && channel->second == id) {
+            channels_.erase(channel);
+        }
+        listeners_.erase(it);
+    }
+
+}// namespace mcp::transport
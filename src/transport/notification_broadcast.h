@@ -0,0 +1,153 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "sse_send_queue.h"
+#include <asio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief The event streams clients open with GET, and the server-initiated messages sent on them.
+     *
+     * Each stream is the channel of one client session, named by the Mcp-Session-Id the client
+     * sends on the GET, so requests that client posts on other connections reach it with send():
+     * progress, resource updates and the events of streaming calls, which then need no
+     * connection and SSE response of their own.
+     *
+     * broadcast() goes to every stream, for notifications such as list_changed. It is serialized
+     * once into an immutable string, and every stream's queue gets a pointer to it: the SSE
+     * framing around it is shared as well, so a fan-out to thousands of sessions costs one dump
+     * and a pointer push per session. Streams are grouped by executor and each group is handed
+     * over with one post. Stdio, the one client without a session, gets the same string as a
+     * line of its own.
+     */
+    class NotificationBroadcast {
+    public:
+        /**
+         * @brief Keeps an event stream on the broadcast list; removes it on destruction.
+         */
+        class Registration {
+        public:
+            Registration() = default;
+            Registration(Registration &&other) noexcept : id_(std::exchange(other.id_, 0)) {}
+            Registration &operator=(Registration &&other) noexcept;
+            ~Registration();
+
+        private:
+            friend class NotificationBroadcast;
+            explicit Registration(uint64_t id) : id_(id) {}
+            uint64_t id_ = 0;
+        };
+
+        /**
+         * @brief Event stream of one client session.
+         */
+        struct Channel {
+            asio::any_io_executor executor;///< The stream's queue is only used here
+            std::weak_ptr<SseSendQueue> queue;
+        };
+
+        /**
+         * @brief Told the client session ended by end_session(), e.g. to drop what it subscribed to.
+         */
+        using SessionEndHandler = std::function<void(const std::string &client_session)>;
+
+        static NotificationBroadcast &instance();
+
+        /**
+         * @brief Serialize a notification once, for broadcast() or the frames of sse_frame().
+         * @param notification JSON-RPC notification
+         * @return Serialized notification
+         */
+        static std::shared_ptr<const std::string> encode(const nlohmann::json &notification);
+
+        /**
+         * @brief SSE frame of serialized notifications. The event prefix and terminator are shared
+         *        constants, nothing is copied.
+         * @param messages Serialized notifications, one event each
+         * @return Frame for SseSendQueue::push_shared()
+         */
+        static SseSendQueue::SharedFrame sse_frame(const std::vector<std::shared_ptr<const std::string>> &messages);
+
+        /**
+         * @brief Have the notifications of broadcast() sent down an event stream.
+         * @param executor Executor of the stream's session
+         * @param queue Send queue of the stream
+         * @param client_session Client session the stream is the channel of, empty for none. A
+         *        later stream of the same client takes over, the client has reconnected
+         * @return Registration, destroy it when the stream ends
+         */
+        Registration listen(asio::any_io_executor executor, std::weak_ptr<SseSendQueue> queue,
+                            const std::string &client_session = {});
+
+        /**
+         * @brief Event stream a client session has open.
+         * @param client_session Client session
+         * @return Channel, std::nullopt if the client has none
+         */
+        std::optional<Channel> channel(const std::string &client_session) const;
+
+        /**
+         * @brief Send messages on the event stream of one client session, as one frame.
+         * @param client_session Client session
+         * @param messages Serialized messages, see encode()
+         * @return false if the client has no event stream open
+         */
+        bool send(const std::string &client_session, const std::vector<std::shared_ptr<const std::string>> &messages);
+
+        /**
+         * @brief Send a notification to every open event stream, and to the stdio client.
+         * Never blocks on a stream, queues are filled on their own executors.
+         * @param message Serialized notification, see encode()
+         * @return Event streams the notification was handed to
+         */
+        size_t broadcast(const std::shared_ptr<const std::string> &message);
+
+        /**
+         * @brief Event streams listening.
+         */
+        size_t listeners() const;
+
+        /**
+         * @brief Have a handler called whenever a client session ends. Call at startup.
+         * @param handler Called on the thread that ends the session
+         */
+        void on_session_end(SessionEndHandler handler);
+
+        /**
+         * @brief Report that a client ended its session, e.g. with DELETE.
+         * @param client_session Client session
+         */
+        void end_session(const std::string &client_session);
+
+    private:
+        struct Listener : Channel {
+            std::string client_session;
+        };
+
+        NotificationBroadcast() = default;
+
+        void remove(uint64_t id);
+
+        mutable std::mutex mutex_;
+        std::unordered_map<uint64_t, Listener> listeners_;
+        std::unordered_map<std::string, uint64_t> channels_;///< Client session -> its listener
+        std::vector<SessionEndHandler> session_end_handlers_;
+        uint64_t next_id_ = 1;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,125 @@
+#include "page_memory.h"
+#include "core/logger.h"
+#include <atomic>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mcp::transport {
+
+    namespace {
+#if defined(__linux__)
+        constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+        // From <numaif.h>, so the server needs no libnuma
+        constexpr int kMpolPreferred = 1;
+        constexpr int kMpolInterleave = 3;
+        constexpr unsigned long kMpolFMemsAllowed = 1 << 2;
+        constexpr unsigned long kMaxNodes = 1024;
+        constexpr unsigned long kMaskWords = kMaxNodes / (8 * sizeof(unsigned long));
+
+        size_t round_up(size_t size, size_t unit) {
+            return (size + unit - 1) / unit * unit;
+        }
+
+        size_t mapped_size(size_t size) {
+            bool huge = PageMemoryOptions::current().huge_pages != PageMemoryOptions::HugePages::Off;
+            return round_up(size, huge ? kHugePageSize : static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+        }
+
+        // Warn once per kind of failure, a pool asks for regions again and again
+        void warn_once(std::atomic<bool> &warned, const char *what) {
+            if (!warned.exchange(true, std::memory_order_relaxed)) {
+                MCP_WARN("Page memory: {}", what);
+            }
+        }
+
+        void place(void *region, size_t size, PagePlacement placement) {
+            static std::atomic<bool> warned{false};
+            unsigned long mask[kMaskWords] = {};
+            int mode;
+            if (placement == PagePlacement::Local) {
+                unsigned cpu = 0;
+                unsigned node = 0;
+                if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= kMaxNodes) {
+                    warn_once(warned, "cannot tell the NUMA node of the io thread, pools are not bound");
+                    return;
+                }
+                mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+                mode = kMpolPreferred;
+            } else {
+                if (syscall(SYS_get_mempolicy, nullptr, mask, kMaxNodes, nullptr, kMpolFMemsAllowed) != 0) {
+                    warn_once(warned, "cannot read the allowed NUMA nodes, caches are not interleaved");
+                    return;
+                }
+                mode = kMpolInterleave;
+            }
+            // Preferred rather than bound: a full node falls back to another instead of failing the fault
+            if (syscall(SYS_mbind, region, size, mode, mask, kMaxNodes, 0) != 0) {
+                warn_once(warned, "mbind failed, pools keep the default NUMA policy");
+            }
+        }
+#endif
+    }// namespace
+
+    PageMemoryOptions::HugePages PageMemoryOptions::parse_huge_pages(std::string_view text) {
+        if (text == "transparent") {
+            return HugePages::Transparent;
+        }
+        if (text == "explicit") {
+            return HugePages::Explicit;
+        }
+        return HugePages::Off;
+    }
+
+    bool pages_enabled() noexcept {
+        static const bool enabled = PageMemoryOptions::current().enabled();
+        return enabled;
+    }
+
+    void *allocate_pages(size_t size, [[maybe_unused]] PagePlacement placement) {
+#if defined(__linux__)
+        const auto &options = PageMemoryOptions::current();
+        size_t length = mapped_size(size);
+        void *region = MAP_FAILED;
+        if (options.huge_pages == PageMemoryOptions::HugePages::Explicit) {
+            region = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (region == MAP_FAILED) {
+                static std::atomic<bool> warned{false};
+                warn_once(warned, "no reserved huge pages left (vm.nr_hugepages), using transparent ones");
+            }
+        }
+        if (region == MAP_FAILED) {
+            region = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (region == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            if (options.huge_pages != PageMemoryOptions::HugePages::Off) {
+                madvise(region, length, MADV_HUGEPAGE);
+            }
+        }
+        if (options.numa) {
+            place(region, length, placement);
+        }
+        return region;
+#else
+        return ::operator new(size);
+#endif
+    }
+
+    void free_pages(void *region, size_t size) noexcept {
+        if (!region) {
+            return;
+        }
+#if defined(__linux__)
+        munmap(region, mapped_size(size));
+#else
+        ::operator delete(region);
+#endif
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string_view>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Where the large, long-lived pools get their memory: the read buffer pools and the
+     *        slot tables of the LRU caches. Configured once at startup from the [server] section,
+     *        before any transport or cache is created; see pages_enabled().
+     */
+    struct PageMemoryOptions {
+        enum class HugePages {
+            Off,        ///< Normal pages from the heap
+            Transparent,///< Page-aligned mappings advised with MADV_HUGEPAGE
+            Explicit,   ///< MAP_HUGETLB from the reserved pool, transparent ones when it is empty
+        };
+
+        HugePages huge_pages = HugePages::Off;
+        bool numa = false;///< Buffer pools on the node of the io thread using them, shared caches interleaved over all nodes
+
+        /**
+         * @brief Whether pools are placed at all; when not, they use the heap as before.
+         */
+        bool enabled() const { return huge_pages != HugePages::Off || numa; }
+
+        /**
+         * @brief Parse "off", "transparent" or "explicit"; anything else is off.
+         */
+        static HugePages parse_huge_pages(std::string_view text);
+
+        static void configure(const PageMemoryOptions &options) { storage() = options; }
+        static const PageMemoryOptions &current() { return storage(); }
+
+    private:
+        static PageMemoryOptions &storage() {
+            static PageMemoryOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief How the pages of a region are spread over NUMA nodes when PageMemoryOptions::numa is on.
+     */
+    enum class PagePlacement {
+        Local,      ///< Node of the calling thread, for memory one io thread owns
+        Interleaved,///< Every allowed node in turn, for memory all threads share
+    };
+
+    /**
+     * @brief Map a region for a pool, placed according to PageMemoryOptions.
+     * Linux only; elsewhere, and when the options are off, it comes from operator new.
+     * @param size Bytes, rounded up to whole pages (huge pages with huge_pages on)
+     * @return Region, at least page aligned; throws std::bad_alloc if none can be had
+     */
+    void *allocate_pages(size_t size, PagePlacement placement);
+
+    /**
+     * @brief Release a region of allocate_pages() with the size it was asked for.
+     */
+    void free_pages(void *region, size_t size) noexcept;
+
+    /**
+     * @brief PageMemoryOptions::current().enabled() as it was at the first call, so memory allocated
+     *        from the heap is never released as pages, or the reverse, if the options change later.
+     */
+    bool pages_enabled() noexcept;
+
+    /**
+     * @brief Allocator for big arrays of pool memory, such as a cache's slot table.
+     * Arrays of at least kMinBytes come from allocate_pages() while the options are on; smaller
+     * ones, and every array while they are off, from operator new. The choice depends on the size
+     * alone, so deallocate takes the same path as allocate did.
+     */
+    template<typename T, PagePlacement Placement = PagePlacement::Interleaved>
+    class PageAllocator {
+    public:
+        using value_type = T;
+        static constexpr size_t kMinBytes = 256 * 1024;
+
+        template<typename U>
+        struct rebind {
+            using other = PageAllocator<U, Placement>;
+        };
+
+        PageAllocator() noexcept = default;
+        template<typename U>
+        PageAllocator(const PageAllocator<U, Placement> &) noexcept {}
+
+        T *allocate(size_t n) {
+            if (paged(n)) {
+                return static_cast<T *>(allocate_pages(n * sizeof(T), Placement));
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+
+        void deallocate(T *p, size_t n) noexcept {
+            if (paged(n)) {
+                free_pages(p, n * sizeof(T));
+                return;
+            }
+            ::operator delete(p, std::align_val_t(alignof(T)));
+        }
+
+        template<typename U>
+        bool operator==(const PageAllocator<U, Placement> &) const noexcept { return true; }
+
+    private:
+        static bool paged(size_t n) { return n * sizeof(T) >= kMinBytes && pages_enabled(); }
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,97 @@
+#include "read_buffer_pool.h"
+#include "page_memory.h"
+#include <vector>
+
+namespace mcp::transport {
+
+    struct FreeLists {
+        static constexpr size_t kRegionSize = 2 * 1024 * 1024;///< A huge page, and twice the largest class
+
+        std::array<std::vector<PooledBuffer::Data>, PooledBuffer::kSizeClasses.size()> lists;
+        char *region = nullptr;///< Rest of the page region buffers are carved from
+        size_t region_left = 0;
+
+        // Carve a buffer of a size class; the classes are powers of two, so every one is aligned to its size
+        PooledBuffer::Data carve(size_t size) {
+            if (region_left < size) {
+                // The tail of the old region is too small for this class, it stays unused
+                region = static_cast<char *>(allocate_pages(kRegionSize, PagePlacement::Local));
+                region_left = kRegionSize;
+            }
+            char *data = region;
+            region += size;
+            region_left -= size;
+            return PooledBuffer::Data(data, PooledBuffer::Release{true});
+        }
+    };
+
+    namespace {
+        FreeLists &free_lists() {
+            thread_local FreeLists lists;
+            return lists;
+        }
+
+        size_t size_class_of(size_t size) {
+            for (size_t i = 0; i < PooledBuffer::kSizeClasses.size(); ++i) {
+                if (size <= PooledBuffer::kSizeClasses[i]) {
+                    return i;
+                }
+            }
+            return PooledBuffer::kSizeClasses.size();
+        }
+    }// namespace
+
+    PooledBuffer::PooledBuffer(PooledBuffer &&other) noexcept
+        : data_(std::move(other.data_)), size_(other.size_) {
+        other.size_ = 0;
+    }
+
+    PooledBuffer &PooledBuffer::operator=(PooledBuffer &&other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = std::move(other.data_);
+            size_ = other.size_;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    PooledBuffer PooledBuffer::acquire(size_t min_size) {
+        size_t index = size_class_of(min_size);
+        if (index == kSizeClasses.size()) {
+            // Oversized, not pooled
+            return PooledBuffer(Data(new char[min_size], Release{}), min_size);
+        }
+
+        auto &list = free_lists().lists[index];
+        if (!list.empty()) {
+            auto data = std::move(list.back());
+            list.pop_back();
+            return PooledBuffer(std::move(data), kSizeClasses[index]);
+        }
+        if (pages_enabled()) {
+            return PooledBuffer(free_lists().carve(kSizeClasses[index]), kSizeClasses[index]);
+        }
+        return PooledBuffer(Data(new char[kSizeClasses[index]], Release{}), kSizeClasses[index]);
+    }
+
+    void PooledBuffer::reset() noexcept {
+        if (!data_) {
+            return;
+        }
+        size_t index = size_class_of(size_);
+        if (index < kSizeClasses.size() && kSizeClasses[index] == size_) {
+            auto &list = free_lists().lists[index];
+            if (list.size() < kMaxCachedPerClass || data_.get_deleter().carved) {
+                try {
+                    list.push_back(std::move(data_));
+                } catch (...) {
+                    // Could not grow the free list, just free the buffer
+                }
+            }
+        }
+        data_.reset();
+        size_ = 0;
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Deleter of PooledBuffer storage: frees heap buffers only, carved ones belong to their region.
+     */
+    struct BufferRelease {
+        bool carved = false;
+        void operator()(char *data) const noexcept {
+            if (!carved) {
+                delete[] data;
+            }
+        }
+    };
+
+    /**
+     * @brief Read buffer borrowed from a thread-local, size-class based pool.
+     *
+     * Buffers are handed out in a few fixed size classes and go back to the pool of the
+     * releasing thread when the handle is reset or destroyed, so a connection only pays
+     * for read memory while it actually has unprocessed input. Requests larger than the
+     * biggest class get a dedicated allocation that is freed on release.
+     *
+     * With PageMemoryOptions on, pooled buffers are carved from page regions placed for the thread
+     * that first takes them instead. Those are never freed: they always go back to a free list,
+     * however long it gets, so the pool keeps the memory of its busiest moment.
+     */
+    class PooledBuffer {
+    public:
+        static constexpr std::array<size_t, 5> kSizeClasses = {4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024};
+        static constexpr size_t kMaxCachedPerClass = 64;///< Free buffers kept per class and thread
+
+        PooledBuffer() = default;
+        PooledBuffer(PooledBuffer &&other) noexcept;
+        PooledBuffer &operator=(PooledBuffer &&other) noexcept;
+        PooledBuffer(const PooledBuffer &) = delete;
+        PooledBuffer &operator=(const PooledBuffer &) = delete;
+        ~PooledBuffer() { reset(); }
+
+        /**
+         * @brief Borrow a buffer of at least min_size bytes. Contents are uninitialized.
+         * @param min_size Minimum capacity
+         * @return Buffer handle
+         */
+        static PooledBuffer acquire(size_t min_size);
+
+        /**
+         * @brief Return the buffer to the pool; the handle becomes empty.
+         */
+        void reset() noexcept;
+
+        char *data() const noexcept { return data_.get(); }
+        size_t size() const noexcept { return size_; }
+        explicit operator bool() const noexcept { return data_ != nullptr; }
+
+    private:
+        using Release = BufferRelease;
+        using Data = std::unique_ptr<char[], Release>;
+        friend struct FreeLists;
+
+        PooledBuffer(Data data, size_t size) noexcept
+            : data_(std::move(data)), size_(size) {}
+
+        Data data_;
+        size_t size_ = 0;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "read_buffer_pool.h"
+#include <memory_resource>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Bump allocator for objects that live exactly as long as one request.
+     *
+     * The first block is borrowed from the thread's PooledBuffer pool, so the common case
+     * costs no malloc at all; larger requests spill into heap blocks. Everything is freed
+     * at once when the arena goes out of scope after the response has been sent.
+     */
+    class RequestArena {
+    public:
+        static constexpr size_t kInitialSize = 16 * 1024;///< Size of the pooled first block
+
+        RequestArena()
+            : buffer_(PooledBuffer::acquire(kInitialSize)),
+              resource_(buffer_.data(), buffer_.size(), std::pmr::new_delete_resource()) {}
+
+        RequestArena(const RequestArena &) = delete;
+        RequestArena &operator=(const RequestArena &) = delete;
+
+        /**
+         * @brief Memory resource to construct request-scoped objects with.
+         * @return Arena resource
+         */
+        std::pmr::memory_resource *resource() noexcept { return &resource_; }
+
+    private:
+        PooledBuffer buffer_;                        ///< Pooled first block, returned after resource_ is gone
+        std::pmr::monotonic_buffer_resource resource_;///< Bump allocator over buffer_
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,414 @@
+#include "segment_log_backend.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace mcp::cache {
+
+    namespace {
+        constexpr uint8_t kRecordState = 1; ///< payload: state JSON
+        constexpr uint8_t kRecordEvent = 2; ///< payload: session id, event id, data
+        constexpr uint8_t kRecordRemove = 3;///< payload: session id
+        constexpr size_t kHeaderBytes = 8;  ///< u32 payload length, u32 checksum
+
+        constexpr std::string_view kSegmentPrefix = "cache-";
+        constexpr std::string_view kSegmentSuffix = ".log";
+
+        uint32_t checksum(std::string_view bytes) {
+            // FNV-1a, enough to tell a torn write from a complete record
+            uint32_t hash = 2166136261u;
+            for (unsigned char c: bytes) {
+                hash = (hash ^ c) * 16777619u;
+            }
+            return hash;
+        }
+
+        void put_u32(std::string &out, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+            }
+        }
+
+        void put_string(std::string &out, std::string_view value) {
+            put_u32(out, static_cast<uint32_t>(value.size()));
+            out.append(value);
+        }
+
+        /// Reads the fields of one payload, failing on anything that runs past its end
+        struct Reader {
+            std::string_view bytes;
+            bool ok = true;
+
+            uint32_t u32() {
+                if (bytes.size() < 4) {
+                    ok = false;
+                    return 0;
+                }
+                uint32_t value = 0;
+                for (int i = 0; i < 4; ++i) {
+                    value |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+                }
+                bytes.remove_prefix(4);
+                return value;
+            }
+
+            std::string_view string() {
+                uint32_t size = u32();
+                if (!ok || bytes.size() < size) {
+                    ok = false;
+                    return {};
+                }
+                auto value = bytes.substr(0, size);
+                bytes.remove_prefix(size);
+                return value;
+            }
+        };
+
+        /// Whole contents of a segment, mapped where the platform allows it
+        class SegmentView {
+        public:
+            explicit SegmentView(const std::filesystem::path &path) {
+#if !defined(_WIN32)
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) return;
+                struct stat st {};
+                if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void *data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data != MAP_FAILED) {
+                        data_ = data;
+                        size_ = static_cast<size_t>(st.st_size);
+                    }
+                }
+                ::close(fd);
+#else
+                std::ifstream in(path, std::ios::binary);
+                buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+#endif
+            }
+
+            ~SegmentView() {
+#if !defined(_WIN32)
+                if (data_) ::munmap(data_, size_);
+#endif
+            }
+
+            SegmentView(const SegmentView &) = delete;
+            SegmentView &operator=(const SegmentView &) = delete;
+
+            std::string_view bytes() const {
+#if !defined(_WIN32)
+                return data_ ? std::string_view(static_cast<const char *>(data_), size_) : std::string_view();
+#else
+                return buffer_;
+#endif
+            }
+
+        private:
+#if !defined(_WIN32)
+            void *data_ = nullptr;
+            size_t size_ = 0;
+#else
+            std::string buffer_;
+#endif
+        };
+    }// namespace
+
+    SegmentLogBackend::SegmentLogBackend(SegmentLogOptions options) : options_(std::move(options)) {
+        std::error_code ec;
+        std::filesystem::create_directories(options_.directory, ec);
+        if (ec) {
+            throw std::runtime_error("Cannot create cache directory " + options_.directory + ": " + ec.message());
+        }
+
+        // Pick up the segments of earlier runs, oldest first
+        size_t total = 0;
+        for (const auto &entry: std::filesystem::directory_iterator(options_.directory)) {
+            std::string name = entry.path().filename().string();
+            if (!entry.is_regular_file() || !name.starts_with(kSegmentPrefix) || !name.ends_with(kSegmentSuffix)) {
+                continue;
+            }
+            std::string digits = name.substr(kSegmentPrefix.size(), name.size() - kSegmentPrefix.size() - kSegmentSuffix.size());
+            if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                continue;
+            }
+            segments_.push_back(std::stoull(digits));
+            total += entry.file_size();
+        }
+        std::sort(segments_.begin(), segments_.end());
+        total_bytes_ = total;
+        snapshot_bytes_ = total;
+
+        // Earlier segments may end in a torn record, so never append to them
+        OpenSegment();
+        writer_ = std::thread([this]() { Run(); });
+        MCP_INFO("Cache segment log opened in {} ({} segments, {} bytes)", options_.directory, segments_.size() - 1, total);
+    }
+
+    SegmentLogBackend::~SegmentLogBackend() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+
+    std::filesystem::path SegmentLogBackend::SegmentPath(uint64_t sequence) const {
+        std::string digits = std::to_string(sequence);
+        digits.insert(0, digits.size() < 10 ? 10 - digits.size() : 0, '0');
+        return std::filesystem::path(options_.directory) / (std::string(kSegmentPrefix) + digits + std::string(kSegmentSuffix));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Record queueing, called with McpCache shard locks held
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void SegmentLogBackend::SaveState(const SessionState &state) {
+        std::string payload;
+        put_string(payload, state.to_json().dump());
+        Enqueue(kRecordState, payload);
+    }
+
+    void SegmentLogBackend::AppendEvent(const std::string &session_id, int event_id, std::string_view data) {
+        std::string payload;
+        payload.reserve(12 + session_id.size() + data.size());
+        put_string(payload, session_id);
+        put_u32(payload, static_cast<uint32_t>(event_id));
+        put_string(payload, data);
+        Enqueue(kRecordEvent, payload);
+    }
+
+    void SegmentLogBackend::RemoveSession(const std::string &session_id) {
+        std::string payload;
+        put_string(payload, session_id);
+        Enqueue(kRecordRemove, payload);
+    }
+
+    void SegmentLogBackend::Enqueue(uint8_t type, const std::string &payload) {
+        std::string record;
+        record.reserve(kHeaderBytes + 1 + payload.size());
+        std::string body(1, static_cast<char>(type));
+        body.append(payload);
+        put_u32(record, static_cast<uint32_t>(body.size()));
+        put_u32(record, checksum(body));
+        record.append(body);
+
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty() || queue_.back().action != Pending::Action::Write) {
+                queue_.emplace_back();
+                ++enqueued_;
+            }
+            queue_.back().bytes.append(record);
+            queued_bytes_ += record.size();
+            wake = queued_bytes_ >= options_.flush_bytes;
+        }
+        if (wake) {
+            work_cv_.notify_one();
+        }
+    }
+
+    void SegmentLogBackend::BeginSnapshot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Pending{Pending::Action::BeginSnapshot, {}});
+        ++enqueued_;
+        work_cv_.notify_one();
+    }
+
+    void SegmentLogBackend::EndSnapshot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Pending{Pending::Action::EndSnapshot, {}});
+        ++enqueued_;
+        work_cv_.notify_one();
+    }
+
+    void SegmentLogBackend::Flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t target = enqueued_;
+        flush_requested_ = true;
+        work_cv_.notify_one();
+        idle_cv_.wait(lock, [this, target] { return written_ >= target; });
+    }
+
+    bool SegmentLogBackend::NeedsCompaction() const {
+        size_t total = total_bytes_.load(std::memory_order_relaxed);
+        return total > std::max(options_.compact_min_bytes, 2 * snapshot_bytes_.load(std::memory_order_relaxed));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Writer thread
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void SegmentLogBackend::Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            work_cv_.wait_for(lock, options_.flush_interval, [this] {
+                return stopping_ || flush_requested_ || queued_bytes_ >= options_.flush_bytes;
+            });
+
+            std::deque<Pending> work;
+            work.swap(queue_);
+            queued_bytes_ = 0;
+            flush_requested_ = false;
+            bool stopping = stopping_;
+            lock.unlock();
+
+            for (auto &pending: work) {
+                switch (pending.action) {
+                    case Pending::Action::Write:
+                        Write(pending.bytes);
+                        break;
+                    case Pending::Action::BeginSnapshot:
+                        obsolete_ = segments_;
+                        OpenSegment();
+                        break;
+                    case Pending::Action::EndSnapshot:
+                        for (uint64_t sequence: obsolete_) {
+                            std::error_code ec;
+                            auto path = SegmentPath(sequence);
+                            auto size = std::filesystem::file_size(path, ec);
+                            if (!ec && std::filesystem::remove(path, ec)) {
+                                total_bytes_ -= size;
+                            }
+                            segments_.erase(std::remove(segments_.begin(), segments_.end(), sequence), segments_.end());
+                        }
+                        obsolete_.clear();
+                        snapshot_bytes_ = total_bytes_.load();
+                        MCP_INFO("Cache segment log compacted to {} bytes", snapshot_bytes_.load());
+                        break;
+                }
+            }
+            if (file_) {
+                std::fflush(file_);
+            }
+
+            lock.lock();
+            written_ += work.size();
+            idle_cv_.notify_all();
+            if (stopping && queue_.empty()) {
+                break;
+            }
+        }
+    }
+
+    void SegmentLogBackend::Write(const std::string &bytes) {
+        if (!file_) {
+            return;
+        }
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+            MCP_ERROR("Failed to write {} bytes to the cache segment log", bytes.size());
+            return;
+        }
+        file_bytes_ += bytes.size();
+        total_bytes_ += bytes.size();
+        if (file_bytes_ >= options_.segment_bytes) {
+            OpenSegment();
+        }
+    }
+
+    void SegmentLogBackend::OpenSegment() {
+        if (file_) {
+            std::fclose(file_);
+        }
+        uint64_t sequence = segments_.empty() ? 1 : segments_.back() + 1;
+        auto path = SegmentPath(sequence);
+        file_ = std::fopen(path.string().c_str(), "wb");
+        file_bytes_ = 0;
+        if (!file_) {
+            MCP_ERROR("Failed to create cache segment {}", path.string());
+            return;
+        }
+        segments_.push_back(sequence);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Replay
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void SegmentLogBackend::Load(const CacheReplay &replay) {
+        // Everything but the segment this run writes to
+        std::vector<uint64_t> segments;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            segments.assign(segments_.begin(), segments_.end() - (segments_.empty() ? 0 : 1));
+        }
+        for (uint64_t sequence: segments) {
+            ReplaySegment(SegmentPath(sequence), replay);
+        }
+    }
+
+    void SegmentLogBackend::ReplaySegment(const std::filesystem::path &path, const CacheReplay &replay) {
+        SegmentView view(path);
+        std::string_view bytes = view.bytes();
+        size_t records = 0;
+
+        while (!bytes.empty()) {
+            Reader header{bytes};
+            uint32_t size = header.u32();
+            uint32_t sum = header.u32();
+            if (!header.ok || header.bytes.size() < size || size == 0) {
+                MCP_WARN("Cache segment {} ends in an incomplete record, ignoring its last {} bytes", path.string(), bytes.size());
+                break;
+            }
+            std::string_view body = header.bytes.substr(0, size);
+            if (checksum(body) != sum) {
+                MCP_WARN("Cache segment {} has a corrupt record, ignoring its last {} bytes", path.string(), bytes.size());
+                break;
+            }
+            bytes.remove_prefix(kHeaderBytes + size);
+
+            Reader reader{body.substr(1)};
+            try {
+                switch (static_cast<uint8_t>(body[0])) {
+                    case kRecordState: {
+                        auto json = reader.string();
+                        if (reader.ok && replay.state) {
+                            replay.state(SessionState::from_json(nlohmann::json::parse(json)));
+                        }
+                        break;
+                    }
+                    case kRecordEvent: {
+                        std::string session_id(reader.string());
+                        auto event_id = static_cast<int>(reader.u32());
+                        auto data = reader.string();
+                        if (reader.ok && replay.event) {
+                            replay.event(session_id, event_id, data);
+                        }
+                        break;
+                    }
+                    case kRecordRemove: {
+                        std::string session_id(reader.string());
+                        if (reader.ok && replay.remove) {
+                            replay.remove(session_id);
+                        }
+                        break;
+                    }
+                    default:
+                        break;// Written by a newer version, skip it
+                }
+            } catch (const std::exception &e) {
+                MCP_WARN("Skipping unreadable record in cache segment {}: {}", path.string(), e.what());
+            }
+            ++records;
+        }
+        MCP_DEBUG("Replayed {} records from cache segment {}", records, path.string());
+    }
+
+}// namespace mcp::cache
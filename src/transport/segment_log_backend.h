@@ -0,0 +1,105 @@
+#pragma once
+#include "cache_backend.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mcp::cache {
+
+    /**
+     * @brief Settings of a SegmentLogBackend.
+     */
+    struct SegmentLogOptions {
+        std::string directory = "cache";             ///< Directory holding the segment files
+        size_t segment_bytes = 64 * 1024 * 1024;     ///< A new segment is started past this size
+        size_t compact_min_bytes = 256 * 1024 * 1024;///< Never compact a log smaller than this
+        std::chrono::milliseconds flush_interval{50};///< Longest time a record waits in memory
+        size_t flush_bytes = 1024 * 1024;            ///< Queued bytes that trigger an early write
+    };
+
+    /**
+     * @brief CacheBackend writing an append-only log of segment files on local disk.
+     *
+     * Records are queued in memory and written by a background thread, at least every
+     * flush_interval. Each record carries its length and a checksum, so a segment cut short by
+     * a crash replays up to its last complete record. Segments are read back through mmap where
+     * available. Compaction writes the live data into a fresh segment and deletes the older ones.
+     */
+    class SegmentLogBackend : public CacheBackend {
+    public:
+        /**
+         * @brief Open or create the log in options.directory and start the writer thread.
+         * @param options Log options
+         * @throws std::runtime_error if the directory or a new segment cannot be created
+         */
+        explicit SegmentLogBackend(SegmentLogOptions options);
+        ~SegmentLogBackend() override;
+
+        SegmentLogBackend(const SegmentLogBackend &) = delete;
+        SegmentLogBackend &operator=(const SegmentLogBackend &) = delete;
+
+        void SaveState(const SessionState &state) override;
+        void AppendEvent(const std::string &session_id, int event_id, std::string_view data) override;
+        void RemoveSession(const std::string &session_id) override;
+        void Load(const CacheReplay &replay) override;
+        bool NeedsCompaction() const override;
+        void BeginSnapshot() override;
+        void EndSnapshot() override;
+        void Flush() override;
+
+    private:
+        /// Work for the writer thread, handled in queue order
+        struct Pending {
+            enum class Action {
+                Write,        ///< Append bytes to the current segment
+                BeginSnapshot,///< Start a new segment, the ones before it become obsolete
+                EndSnapshot,  ///< Delete the segments made obsolete by the last BeginSnapshot
+            };
+            Action action = Action::Write;
+            std::string bytes;
+        };
+
+        /**
+         * @brief Queue one encoded record.
+         * @param type Record type
+         * @param payload Record payload
+         */
+        void Enqueue(uint8_t type, const std::string &payload);
+
+        void Run();
+        void Write(const std::string &bytes);
+        void OpenSegment();
+        void ReplaySegment(const std::filesystem::path &path, const CacheReplay &replay);
+        std::filesystem::path SegmentPath(uint64_t sequence) const;
+
+        SegmentLogOptions options_;
+
+        std::mutex mutex_;               ///< Guards the queue and the flags below
+        std::condition_variable work_cv_;///< Wakes the writer
+        std::condition_variable idle_cv_;///< Signals that the queue was written
+        std::deque<Pending> queue_;
+        size_t queued_bytes_ = 0;
+        uint64_t enqueued_ = 0;       ///< Queue entries ever added
+        uint64_t written_ = 0;        ///< Queue entries handled by the writer
+        bool flush_requested_ = false;///< Flush() waits for the queue to be written
+        bool stopping_ = false;
+
+        // Writer thread only, apart from the atomics
+        std::vector<uint64_t> segments_;       ///< Sequence numbers of the segment files, oldest first
+        std::vector<uint64_t> obsolete_;       ///< Segments to delete once the snapshot is complete
+        std::FILE *file_ = nullptr;            ///< Current segment
+        size_t file_bytes_ = 0;                ///< Size of the current segment
+        std::atomic<size_t> total_bytes_{0};   ///< Size of all segments
+        std::atomic<size_t> snapshot_bytes_{0};///< Size of the log right after the last compaction
+        std::thread writer_;
+    };
+
+}// namespace mcp::cache
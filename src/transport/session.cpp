@@ -0,0 +1,130 @@
+#include "session.h"
+#include "core/frame_pool.hpp"
+#include <system_error>
+
+namespace mcp::transport {
+
+    std::string Session::client_session_id() const {
+        auto presented = headers_.get("Mcp-Session-Id");
+        return presented.empty() ? get_session_id() : std::string(presented);
+    }
+
+    asio::awaitable<void> Session::write(const std::string &message) {
+        asio::const_buffer buffer = asio::buffer(message);
+        co_await write_buffers(std::span<const asio::const_buffer>(&buffer, 1));
+    }
+
+    asio::awaitable<void> Session::write_buffers(std::span<const asio::const_buffer> buffers) {
+        if (!writing_) {
+            // Nothing in flight: write right away, then send what queued up meanwhile
+            writing_ = true;
+            co_await write_now(buffers);
+            co_await drain_outbound();
+            co_return;
+        }
+
+        asio::steady_timer done(get_executor(), asio::steady_timer::time_point::max());
+        auto &entry = outbound_.emplace_back();
+        entry.buffers = buffers;
+        entry.done = &done;
+        asio::error_code ec;
+        co_await done.async_wait(core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+    }
+
+    asio::awaitable<void> Session::write_file(std::span<const asio::const_buffer> head, const FileSlice &file,
+                                              std::span<const asio::const_buffer> tail) {
+        if (!writing_) {
+            writing_ = true;
+            co_await write_file_parts(head, file, tail);
+            co_await drain_outbound();
+            co_return;
+        }
+
+        asio::steady_timer done(get_executor(), asio::steady_timer::time_point::max());
+        auto &entry = outbound_.emplace_back();
+        entry.buffers = head;
+        entry.file = &file;
+        entry.tail = tail;
+        entry.done = &done;
+        asio::error_code ec;
+        co_await done.async_wait(core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+    }
+
+    asio::awaitable<void> Session::write_file_now(const FileSlice &file) {
+        asio::const_buffer buffer = asio::buffer(file.bytes);
+        co_await write_now(std::span<const asio::const_buffer>(&buffer, 1));
+    }
+
+    asio::awaitable<void> Session::write_file_parts(std::span<const asio::const_buffer> head, const FileSlice &file,
+                                                    std::span<const asio::const_buffer> tail) {
+        if (!head.empty() && !is_closed()) {
+            co_await write_now(head);
+        }
+        if (!file.bytes.empty() && !is_closed()) {
+            co_await write_file_now(file);
+        }
+        if (!tail.empty() && !is_closed()) {
+            co_await write_now(tail);
+        }
+    }
+
+    asio::awaitable<size_t> Session::read_some(asio::mutable_buffer) {
+        throw std::system_error(std::make_error_code(std::errc::operation_not_supported));
+    }
+
+    void Session::post_write(std::string data, bool close_after) {
+        asio::post(get_executor(), asio::bind_allocator(core::FrameAllocator<void>(), [self = shared_from_this(), data = std::move(data), close_after]() mutable {
+            auto &entry = self->outbound_.emplace_back();
+            entry.owned = std::move(data);
+            entry.owned_buffer = asio::buffer(entry.owned);
+            entry.buffers = std::span<const asio::const_buffer>(&entry.owned_buffer, 1);
+            entry.close_after = close_after;
+            if (!self->writing_) {
+                self->writing_ = true;
+                asio::co_spawn(self->get_executor(), [self]() { return self->drain_outbound(); }, asio::detached);
+            }
+        }));
+    }
+
+    asio::awaitable<void> Session::drain_outbound() {
+        // Entries are only popped here, so references to them stay valid across the write
+        auto self = shared_from_this();
+        while (!outbound_.empty()) {
+            // Take everything queued, up to the first entry that closes the session or sends a file
+            gathered_.clear();
+            size_t count = 0;
+            bool close_after = false;
+            const OutboundEntry *file_entry = nullptr;
+            for (const auto &entry: outbound_) {
+                gathered_.insert(gathered_.end(), entry.buffers.begin(), entry.buffers.end());
+                ++count;
+                if (entry.file) {
+                    file_entry = &entry;
+                    break;
+                }
+                if (entry.close_after) {
+                    close_after = true;
+                    break;
+                }
+            }
+
+            if (file_entry) {
+                // The buffers before the range go out with the file entry's head
+                co_await write_file_parts(gathered_, *file_entry->file, file_entry->tail);
+            } else if (!is_closed()) {
+                co_await write_now(gathered_);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (outbound_.front().done) {
+                    outbound_.front().done->cancel();
+                }
+                outbound_.pop_front();
+            }
+            if (close_after) {
+                close();
+            }
+        }
+        writing_ = false;
+    }
+
+}// namespace mcp::transport
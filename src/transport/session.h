@@ -1,21 +1,66 @@
 #pragma once
 
-#include <unordered_map>
 #if defined(_WIN32) && !defined(_WIN32_WINNT)
 #define _WIN32_WINNT 0x0601
 #endif
 
+#include "Auth/AuthManager.hpp"
+#include "drain.h"
+#include "header_map.h"
+#include "http_compression.h"
+#include "http_parser.h"
+#include "memfd_handoff.h"
+#include "metrics/request_trace.h"
 #include "transport_types.h"
+#include <array>
 #include <asio.hpp>
+#include <charconv>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 
 namespace mcp::transport {
     class HttpHandler;
+    class SseSendQueue;
+    class UploadStream;
 }// namespace mcp::transport
 
 namespace mcp::transport {
 
+    /**
+     * @brief Buffer holding the size line of an HTTP chunk ("<hex size>\r\n").
+     */
+    struct ChunkSizeLine {
+        std::array<char, 20> data;///< Up to 16 hex digits plus CRLF
+        size_t size = 0;          ///< Number of valid bytes in data
+
+        explicit ChunkSizeLine(size_t chunk_size) {
+            auto result = std::to_chars(data.data(), data.data() + 16, chunk_size, 16);
+            size = static_cast<size_t>(result.ptr - data.data());
+            data[size++] = '\r';
+            data[size++] = '\n';
+        }
+
+        asio::const_buffer buffer() const { return asio::buffer(data.data(), size); }
+    };
+
+    /**
+     * @brief A range of an open file, sent to the client as it is.
+     */
+    struct FileSlice {
+        int fd = -1;           ///< Descriptor to send the range from, -1 if there is none
+        uint64_t offset = 0;   ///< Offset of the range in the file
+        std::string_view bytes;///< The range in memory, for sessions that cannot send from a descriptor
+        bool pass_descriptor = false;///< Send bytes with fd itself attached (SCM_RIGHTS), see Session::can_pass_descriptors()
+    };
+
     /**
      * @brief Base class for managing single TCP sessions.
      * Handles IO operations only, no business logic.
@@ -31,17 +76,168 @@ namespace mcp::transport {
 
         /**
          * @brief Send data to the client.
+         * Use from the session's executor; see write_buffers().
          * @param message The message to send
          */
-        virtual asio::awaitable<void> write(const std::string &message) = 0;
+        asio::awaitable<void> write(const std::string &message);
+
+        /**
+         * @brief Send several buffers to the client as one gather write.
+         * Use from the session's executor. Writes never overlap on the socket: if one is in flight,
+         * this joins the session's outbound queue and completes once its turn has been written.
+         * The buffers must stay valid until the returned awaitable completes.
+         * @param buffers Buffers to send, in order
+         */
+        asio::awaitable<void> write_buffers(std::span<const asio::const_buffer> buffers);
+
+        /**
+         * @brief Send buffers, a range of a file and more buffers, in order, like write_buffers().
+         * Plain sockets send the range straight from the file's page cache with sendfile(2) where the
+         * platform has it; other sessions write file.bytes. The buffers and the file must stay valid
+         * until the returned awaitable completes.
+         * @param head Buffers sent before the range
+         * @param file Range to send
+         * @param tail Buffers sent after the range
+         */
+        asio::awaitable<void> write_file(std::span<const asio::const_buffer> head, const FileSlice &file,
+                                         std::span<const asio::const_buffer> tail);
+
+        /**
+         * @brief Send data from any thread without waiting for it.
+         * The data is appended to the outbound queue on the session's executor, after everything
+         * posted or being written before it; whatever queues up while a write is in flight goes
+         * out with the next gather write.
+         * @param data Data to send
+         * @param close_after Close the session once the data has been written
+         */
+        void post_write(std::string data, bool close_after = false);
+
+        /**
+         * @brief Queue a response to be sent after the current request has been handled.
+         * Never suspends, so it can be called from synchronous callbacks. The session's
+         * read loop sends queued responses in order before dispatching the next request.
+         * @param header Response header block
+         * @param body Response body (may be empty)
+         */
+        void queue_write(std::string header, std::string body = {}) {
+            pending_writes_.push_back({std::move(header), std::move(body), ContentEncoding::Identity});
+        }
+
+        /**
+         * @brief Queue a response whose body is compressed when it is sent, see compress_response().
+         * @param header Response header block without Content-Length and the final blank line
+         * @param body Uncompressed response body
+         * @param encoding Coding from response_encoding()
+         */
+        void queue_write(std::string header, std::string body, ContentEncoding encoding) {
+            pending_writes_.push_back({std::move(header), std::move(body), encoding});
+        }
+
+        /**
+         * @brief Queue a response handed over in a memfd, see wants_memfd().
+         * @param header Complete response header block
+         * @param envelope Body referring to the memfd, see memfd_envelope()
+         * @param memfd The memfd, attached to the first byte of the response
+         */
+        void queue_write(std::string header, std::string envelope, SealedMemfd memfd) {
+            pending_writes_.push_back({std::move(header), std::move(envelope), ContentEncoding::Identity, std::move(memfd)});
+        }
+
+        /**
+         * @brief Send all queued responses, in the order they were queued.
+         */
+        asio::awaitable<void> flush_pending_writes() {
+            auto write_started = trace_ ? metrics::RequestTrace::clock::now() : metrics::RequestTrace::clock::time_point{};
+            int status = 0;
+            size_t written = 0;
+            // A draining server answers and closes, so the client sends its next request elsewhere
+            const bool closing = Drain::draining();
+            while (!pending_writes_.empty() && !is_closed()) {
+                auto [header, body, encoding, memfd] = std::move(pending_writes_.front());
+                pending_writes_.pop_front();
+                if (closing) {
+                    Drain::close_connection(header);
+                }
+                if (encoding != ContentEncoding::Identity) {
+                    co_await compress_response(header, body, encoding);
+                }
+                if (status == 0) {
+                    status = response_status(header);
+                }
+                written += header.size() + body.size();
+                if (memfd) {
+                    // One message, so the descriptor arrives with the header block that explains it
+                    header += body;
+                    FileSlice slice;
+                    slice.fd = memfd->fd();
+                    slice.bytes = header;
+                    slice.pass_descriptor = true;
+                    co_await write_file({}, slice, {});
+                    continue;
+                }
+                std::array<asio::const_buffer, 2> buffers = {asio::buffer(header), asio::buffer(body)};
+                co_await write_buffers(std::span<const asio::const_buffer>(buffers.data(), body.empty() ? 1 : 2));
+            }
+            pending_writes_.clear();
+            if (trace_ && status != 0) {
+                // The response of the traced request has been written, its trace is complete
+                trace_->lap(metrics::RequestStage::Write, write_started);
+                finish_trace(status, written);
+            }
+            if (closing && status != 0) {
+                close();
+            }
+            co_return;
+        }
+
+        /**
+         * @brief Status code of a response header block, 0 if it does not start with a status line.
+         */
+        static int response_status(std::string_view header) {
+            // "HTTP/1.1 200 OK"
+            int status = 0;
+            if (header.size() >= 12 && header.starts_with("HTTP/")) {
+                auto space = header.find(' ');
+                if (space != std::string_view::npos && space + 4 <= header.size()) {
+                    std::from_chars(header.data() + space + 1, header.data() + space + 4, status);
+                }
+            }
+            return status;
+        }
+
+        /**
+         * @brief Trace the stages of the request being handled if it is sampled.
+         * The trace is reported by flush_pending_writes(), once the response has been written.
+         * @param traceparent traceparent header of the request, empty if it has none
+         * @param rpc The request may carry a JSON-RPC message, see RequestTrace::sample()
+         */
+        void start_trace(std::string_view traceparent, bool rpc = true) { trace_ = metrics::RequestTrace::sample(traceparent, rpc); }
+
+        /**
+         * @brief Report the trace of the request being handled, for a response written directly
+         *        rather than queued; does nothing if it has none.
+         * @param status HTTP status of the response
+         * @param bytes Bytes written
+         */
+        void finish_trace(int status, size_t bytes) {
+            if (auto trace = std::move(trace_)) {
+                trace->set_response(status, bytes);
+                trace->report();
+            }
+        }
+
+        /**
+         * @brief Trace of the request being handled, nullptr if it is not sampled.
+         */
+        metrics::RequestTrace *trace() const { return trace_.get(); }
 
         /**
          * @brief Send data to the client in a streaming fashion.
          * @param message The message to send
          * @param flush Whether to flush the data immediately
          */
-        virtual asio::awaitable<void> stream_write(const std::string &message, [[maybe_unused]] bool flush = true) {
-            // Default implementation just calls regular write
+        asio::awaitable<void> stream_write(const std::string &message, [[maybe_unused]] bool flush = true) {
+            // Every write is flushed, a stream write is a regular write
             co_await write(message);
             co_return;
         }
@@ -51,11 +247,6 @@ namespace mcp::transport {
          */
         virtual void close() = 0;
 
-        /**
-         * @brief Clear the session buffer.
-         */
-        virtual void clear_buffer() = 0;
-
         /**
          * @brief Check if the session is closed.
          */
@@ -74,19 +265,97 @@ namespace mcp::transport {
         bool is_streaming() const { return is_streaming_; }
 
         /**
-         * @brief Get the underlying socket (implemented by subclasses).
+         * @brief Get the executor the session's I/O runs on (implemented by subclasses).
+         * The session is only used from this executor.
          */
-        virtual asio::ip::tcp::socket &get_socket() = 0;
+        virtual asio::any_io_executor get_executor() = 0;
+
+        /**
+         * @brief Wait until the client goes away, for responses that never end on their own.
+         * Clients send nothing while they hold such a response, so sessions that own a socket
+         * wait for it to become readable, which means the client has closed it.
+         */
+        virtual asio::awaitable<void> wait_for_disconnect() = 0;
+
+        /**
+         * @brief Read from the connection, for protocols that take it over from the HTTP/1.1 loop.
+         * Sessions that don't own a connection throw operation_not_supported.
+         * @param buffer Buffer to read into
+         * @return Number of bytes read; throws once the connection ends
+         */
+        virtual asio::awaitable<size_t> read_some(asio::mutable_buffer buffer);
+
+        /**
+         * @brief Takes over the connection after an upgrade, given the bytes the HTTP/1.1
+         *        loop had already received beyond the upgrade request.
+         */
+        using UpgradeHandler = std::function<asio::awaitable<void>(std::string buffered)>;
+
+        /**
+         * @brief Hand the connection to another protocol once the current response is sent.
+         * The read loop runs the handler instead of reading the next request.
+         */
+        void set_upgrade(UpgradeHandler upgrade) { upgrade_ = std::move(upgrade); }
+        UpgradeHandler take_upgrade() { return std::exchange(upgrade_, nullptr); }
+
+        /**
+         * @brief Set the streamed argument of the request being handled, whose body is still arriving.
+         * The tools/call it belongs to takes it for its plugin; see HttpHandler::handle_upload().
+         */
+        void set_upload(std::shared_ptr<UploadStream> upload) { upload_ = std::move(upload); }
+        std::shared_ptr<UploadStream> take_upload() { return std::exchange(upload_, nullptr); }
+
+        /**
+         * @brief Whether the client was authenticated by its peer credentials (SO_PEERCRED on a Unix
+         *        domain socket); the auth manager's header check is skipped for such sessions.
+         */
+        virtual bool peer_authenticated() const { return peer_authenticated_; }
+        void set_peer_authenticated(bool authenticated) { peer_authenticated_ = authenticated; }
+
+        /**
+         * @brief Whether write_file() can hand a descriptor to the client (FileSlice::pass_descriptor),
+         *        which takes a Unix domain socket on Linux.
+         */
+        virtual bool can_pass_descriptors() const { return false; }
+
+        /**
+         * @brief Credential accepted on this connection, so keep-alive requests presenting it again
+         *        are not hashed and looked up each time.
+         */
+        AuthDecision &auth_decision() { return auth_decision_; }
+        const AuthDecision &auth_decision() const { return auth_decision_; }
 
         void set_accept_header(const std::string &header) { accept_header_ = header; }
         const std::string &get_accept_header() const { return accept_header_; }
 
-        virtual std::array<char, 8192> &get_buffer() = 0;
-
         virtual const std::string &get_session_id() const = 0;
 
-        void set_headers(const std::unordered_map<std::string, std::string> &headers) { headers_ = headers; }
-        const std::unordered_map<std::string, std::string> &get_headers() const { return headers_; }
+        /**
+         * @brief Session the client names with its Mcp-Session-Id header, this session's id if it
+         *        sends none. The requests and the event stream of one client share it across connections.
+         */
+        std::string client_session_id() const;
+
+        /**
+         * @brief Set the queue of the event stream a GET opened on this session, nullptr once it ends.
+         * Use from the session's executor only.
+         */
+        virtual void set_notification_stream(const std::shared_ptr<SseSendQueue> &queue) { notification_stream_ = queue; }
+
+        /**
+         * @brief Queue of the session's open event stream, where server notifications are sent.
+         * @return Queue, nullptr if no stream is open
+         */
+        virtual std::shared_ptr<SseSendQueue> notification_stream() const { return notification_stream_.lock(); }
+
+        void set_headers(const HeaderMap &headers) { headers_ = headers; }
+        void set_headers(const HttpRequestView &request) {
+            headers_.clear();// Keeps the entries' strings for the next request on this connection
+            for (size_t i = 0; i < request.header_count; ++i) {
+                headers_.emplace(request.headers[i].name, request.headers[i].value);
+            }
+        }
+        const HeaderMap &get_headers() const { return headers_; }
 
     protected:
         /**
@@ -94,12 +363,72 @@ namespace mcp::transport {
          */
         Session() = default;
 
+        /**
+         * @brief Write buffers to the socket. Only called by the outbound queue, one write at a time.
+         * Errors are handled by closing the session.
+         * @param buffers Buffers to send, in order
+         */
+        virtual asio::awaitable<void> write_now(std::span<const asio::const_buffer> buffers) = 0;
+
+        /**
+         * @brief Write a range of a file to the socket, like write_now(). Writes file.bytes by default.
+         * @param file Range to send
+         */
+        virtual asio::awaitable<void> write_file_now(const FileSlice &file);
+
+        /**
+         * @brief Response queued by queue_write().
+         */
+        struct PendingWrite {
+            std::string header;
+            std::string body;
+            ContentEncoding encoding;///< Identity if the header is complete
+            std::optional<SealedMemfd> memfd{};///< Passed with the response, body is then its envelope
+        };
+
         std::string session_id_;                              ///< Unique session identifier
-        std::array<char, 8192> buffer_;                       ///< Buffer for reading data
-        std::unordered_map<std::string, std::string> headers_;///< HTTP headers
+        HeaderMap headers_;                                   ///< HTTP headers
         std::string accept_header_;                           ///< Accept header value
+        AuthDecision auth_decision_;                          ///< See auth_decision()
+        std::deque<PendingWrite> pending_writes_;             ///< Responses queued by queue_write()
+        std::weak_ptr<SseSendQueue> notification_stream_;               ///< Held by the GET that opened it
+        UpgradeHandler upgrade_;                                        ///< Set by an upgrade response, see set_upgrade()
+        std::shared_ptr<UploadStream> upload_;                          ///< See set_upload()
+        std::unique_ptr<metrics::RequestTrace> trace_;                  ///< Set by start_trace()
         bool is_streaming_ = false;
+        bool peer_authenticated_ = false;
         bool closed_ = false;
+
+    private:
+        /**
+         * @brief Data waiting for the write in flight, in the order it was queued.
+         */
+        struct OutboundEntry {
+            std::span<const asio::const_buffer> buffers;///< Caller's buffers, or owned_buffer
+            std::string owned;                          ///< Data of post_write()
+            asio::const_buffer owned_buffer;
+            asio::steady_timer *done = nullptr;///< Cancelled once written, nullptr for post_write()
+            const FileSlice *file = nullptr;    ///< Range of write_file(), sent after buffers
+            std::span<const asio::const_buffer> tail;///< Sent after file
+            bool close_after = false;
+        };
+
+        /**
+         * @brief Write the head, range and tail of a write_file() as the only writer.
+         */
+        asio::awaitable<void> write_file_parts(std::span<const asio::const_buffer> head, const FileSlice &file,
+                                               std::span<const asio::const_buffer> tail);
+
+        /**
+         * @brief Write whatever has queued up, batch by batch, until the queue is empty.
+         * Runs as the only writer of the session.
+         */
+        asio::awaitable<void> drain_outbound();
+
+        // Touched only on the session's executor; its io_context runs on one thread, so no lock
+        std::deque<OutboundEntry> outbound_;       ///< Entries wait here while writing_ is set
+        std::vector<asio::const_buffer> gathered_;///< Buffers of the batch in flight, reused
+        bool writing_ = false;                      ///< A write is in flight, new writes queue up
     };
 
 }// namespace mcp::transport
\ No newline at end of file
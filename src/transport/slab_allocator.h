@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Allocator that recycles fixed-size blocks through a thread-local free list.
+     *
+     * Meant for objects created and destroyed at a high rate on the io threads, such as
+     * sessions (use it with std::allocate_shared, which rebinds it to the control block
+     * type). Each rebound type gets its own free list per thread. A block freed on another
+     * thread than it was allocated on simply joins that thread's list.
+     */
+    template<typename T>
+    class SlabAllocator {
+    public:
+        using value_type = T;
+
+        static constexpr size_t kMaxCachedBlocks = 1024;///< Free blocks kept per thread
+
+        SlabAllocator() noexcept = default;
+        template<typename U>
+        SlabAllocator(const SlabAllocator<U> &) noexcept {}
+
+        T *allocate(size_t n) {
+            if (n == 1) {
+                auto &blocks = free_blocks();
+                if (!blocks.empty()) {
+                    void *block = blocks.back();
+                    blocks.pop_back();
+                    return static_cast<T *>(block);
+                }
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+
+        void deallocate(T *p, size_t n) noexcept {
+            if (n == 1) {
+                auto &blocks = free_blocks();
+                if (blocks.size() < kMaxCachedBlocks) {
+                    try {
+                        blocks.push_back(p);
+                        return;
+                    } catch (...) {
+                        // Fall through and free the block
+                    }
+                }
+            }
+            ::operator delete(p, std::align_val_t(alignof(T)));
+        }
+
+        template<typename U>
+        bool operator==(const SlabAllocator<U> &) const noexcept { return true; }
+
+    private:
+        struct FreeList {
+            std::vector<void *> blocks;
+            ~FreeList() {
+                for (void *block: blocks) {
+                    ::operator delete(block, std::align_val_t(alignof(T)));
+                }
+            }
+        };
+
+        static std::vector<void *> &free_blocks() {
+            thread_local FreeList list;
+            return list.blocks;
+        }
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,164 @@
+#include "socket_options.h"
+#include "core/logger.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace mcp::transport {
+
+    namespace {
+        SocketOptions &options_storage() {
+            static SocketOptions options;
+            return options;
+        }
+
+#if defined(TCP_QUICKACK)
+        using tcp_quickack_option = asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK>;
+#endif
+#if defined(TCP_FASTOPEN)
+        using tcp_fastopen_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_FASTOPEN>;
+#endif
+#if defined(SO_BUSY_POLL)
+        using busy_poll_option = asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>;
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+        using tcp_notsent_lowat_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT>;
+#endif
+#if defined(TCP_USER_TIMEOUT)
+        using tcp_user_timeout_option = asio::detail::socket_option::integer<IPPROTO_TCP, TCP_USER_TIMEOUT>;
+#endif
+
+        template<typename Socket, typename Option>
+        void set_option(Socket &socket, const Option &option, const char *name) {
+            asio::error_code ec;
+            socket.set_option(option, ec);
+            if (ec) {
+                MCP_WARN("Failed to set socket option {}: {}", name, ec.message());
+            }
+        }
+    }// namespace
+
+    void SocketOptions::configure(const SocketOptions &options) {
+        options_storage() = options;
+    }
+
+    const SocketOptions &SocketOptions::current() {
+        return options_storage();
+    }
+
+    void SocketOptions::apply_listener(asio::ip::tcp::acceptor &acceptor) const {
+        if (send_buffer_size > 0) {
+            set_option(acceptor, asio::socket_base::send_buffer_size(send_buffer_size), "SO_SNDBUF");
+        }
+        if (receive_buffer_size > 0) {
+            set_option(acceptor, asio::socket_base::receive_buffer_size(receive_buffer_size), "SO_RCVBUF");
+        }
+        if (tcp_fastopen > 0) {
+#if defined(TCP_FASTOPEN)
+            set_option(acceptor, tcp_fastopen_option(tcp_fastopen), "TCP_FASTOPEN");
+#else
+            MCP_WARN("TCP_FASTOPEN is not supported on this platform");
+#endif
+        }
+        if (!tcp_congestion.empty()) {
+#if defined(TCP_CONGESTION)
+            // A string option asio has no type for; accepted sockets take it over from the listener
+            if (::setsockopt(acceptor.native_handle(), IPPROTO_TCP, TCP_CONGESTION, tcp_congestion.data(),
+                             static_cast<socklen_t>(tcp_congestion.size())) != 0) {
+                MCP_WARN("Failed to set TCP congestion control {}: {} (see net.ipv4.tcp_allowed_congestion_control)",
+                         tcp_congestion, std::error_code(errno, std::generic_category()).message());
+            }
+#else
+            MCP_WARN("TCP_CONGESTION is not supported on this platform");
+#endif
+        }
+    }
+
+    void SocketOptions::apply(asio::ip::tcp::socket &socket) const {
+        set_option(socket, asio::ip::tcp::no_delay(tcp_nodelay), "TCP_NODELAY");
+        if (keep_alive) {
+            set_option(socket, asio::socket_base::keep_alive(true), "SO_KEEPALIVE");
+        }
+        if (send_buffer_size > 0) {
+            set_option(socket, asio::socket_base::send_buffer_size(send_buffer_size), "SO_SNDBUF");
+        }
+        if (receive_buffer_size > 0) {
+            set_option(socket, asio::socket_base::receive_buffer_size(receive_buffer_size), "SO_RCVBUF");
+        }
+        if (busy_poll_us > 0) {
+#if defined(SO_BUSY_POLL)
+            // Raising it above net.core.busy_read needs CAP_NET_ADMIN; say so once, not per connection
+            asio::error_code ec;
+            socket.set_option(busy_poll_option(busy_poll_us), ec);
+            static std::atomic<bool> warned{false};
+            if (ec && !warned.exchange(true)) {
+                MCP_WARN("Failed to set socket option SO_BUSY_POLL: {} (needs CAP_NET_ADMIN above net.core.busy_read)", ec.message());
+            }
+#else
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true)) {
+                MCP_WARN("SO_BUSY_POLL is not supported on this platform");
+            }
+#endif
+        }
+#if defined(TCP_QUICKACK)
+        // The kernel may drop back to delayed ACKs later; this covers the first exchange
+        if (tcp_quickack) {
+            set_option(socket, tcp_quickack_option(true), "TCP_QUICKACK");
+        }
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+        // Keeps the send queue short, so data written later (another HTTP/2 stream, an SSE
+        // event) is not stuck behind a large response waiting out retransmissions
+        if (tcp_notsent_lowat > 0) {
+            set_option(socket, tcp_notsent_lowat_option(tcp_notsent_lowat), "TCP_NOTSENT_LOWAT");
+        }
+#endif
+#if defined(TCP_USER_TIMEOUT)
+        // A peer that moved to another network never acknowledges again; close it so the
+        // client's reconnect takes over instead of retransmissions going on for minutes
+        if (tcp_user_timeout_ms > 0) {
+            set_option(socket, tcp_user_timeout_option(tcp_user_timeout_ms), "TCP_USER_TIMEOUT");
+        }
+#endif
+    }
+
+    int SocketOptions::backlog() const {
+        return listen_backlog > 0 ? listen_backlog : static_cast<int>(asio::socket_base::max_listen_connections);
+    }
+
+    std::string SocketOptions::describe(asio::ip::tcp::acceptor &acceptor) const {
+        asio::error_code ec;
+        asio::socket_base::send_buffer_size sndbuf;
+        asio::socket_base::receive_buffer_size rcvbuf;
+        acceptor.get_option(sndbuf, ec);
+        acceptor.get_option(rcvbuf, ec);
+
+        bool quickack = tcp_quickack;
+        int fastopen = tcp_fastopen;
+        std::string congestion = "default";
+#if !defined(TCP_QUICKACK)
+        quickack = false;
+#endif
+#if !defined(TCP_FASTOPEN)
+        fastopen = 0;
+#endif
+#if defined(TCP_CONGESTION)
+        char name[16] = {};
+        socklen_t name_size = sizeof(name);
+        if (::getsockopt(acceptor.native_handle(), IPPROTO_TCP, TCP_CONGESTION, name, &name_size) == 0) {
+            congestion.assign(name, strnlen(name, name_size));
+        }
+#endif
+        return "TCP_NODELAY=" + std::to_string(tcp_nodelay) +
+               " TCP_QUICKACK=" + std::to_string(quickack) +
+               " SO_KEEPALIVE=" + std::to_string(keep_alive) +
+               " SO_SNDBUF=" + std::to_string(sndbuf.value()) +
+               " SO_RCVBUF=" + std::to_string(rcvbuf.value()) +
+               " backlog=" + std::to_string(backlog()) +
+               " TCP_FASTOPEN=" + std::to_string(fastopen) +
+               " TCP_CONGESTION=" + congestion;
+    }
+
+}// namespace mcp::transport
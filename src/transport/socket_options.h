@@ -0,0 +1,71 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <string>
+
+namespace mcp::transport {
+
+    /**
+     * @brief TCP tuning applied to listeners and accepted sockets.
+     * Configured once at startup from the [transport] config section, before any
+     * transport is created; listeners and sessions read it when they are constructed.
+     */
+    struct SocketOptions {
+        bool tcp_nodelay = true;     ///< Disable Nagle's algorithm
+        bool tcp_quickack = false;   ///< Send ACKs immediately (Linux only)
+        bool keep_alive = false;     ///< Enable SO_KEEPALIVE probes
+        int send_buffer_size = 0;    ///< SO_SNDBUF in bytes, 0 = OS default
+        int receive_buffer_size = 0; ///< SO_RCVBUF in bytes, 0 = OS default
+        int listen_backlog = 0;      ///< Listen backlog, 0 = SOMAXCONN
+        int tcp_fastopen = 0;        ///< TCP_FASTOPEN queue length on listeners, 0 = disabled
+        int busy_poll_us = 0;        ///< SO_BUSY_POLL of accepted sockets in microseconds (Linux only), 0 = OS default
+        std::string tcp_congestion;  ///< TCP_CONGESTION of listeners, inherited by accepted sockets (Linux only), empty = OS default
+        int tcp_notsent_lowat = 0;   ///< TCP_NOTSENT_LOWAT of accepted sockets in bytes (Linux, macOS), 0 = OS default
+        int tcp_user_timeout_ms = 0; ///< TCP_USER_TIMEOUT of accepted sockets (Linux only), 0 = OS default
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const SocketOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const SocketOptions &current();
+
+        /**
+         * @brief Apply the options to an open, not yet listening acceptor.
+         * Buffer sizes set here are inherited by accepted sockets.
+         * @param acceptor Acceptor to configure
+         */
+        void apply_listener(asio::ip::tcp::acceptor &acceptor) const;
+
+        /**
+         * @brief Apply the per-connection options to an accepted socket.
+         * Failures are logged and otherwise ignored.
+         * @param socket Connected socket
+         */
+        void apply(asio::ip::tcp::socket &socket) const;
+
+        /**
+         * @brief Listen backlog to pass to listen().
+         * @return Configured backlog or SOMAXCONN
+         */
+        int backlog() const;
+
+        /**
+         * @brief Describe the options actually in effect on a listener.
+         * Buffer sizes are read back from the socket since the kernel may adjust them.
+         * @param acceptor Listening acceptor
+         * @return Human-readable summary
+         */
+        std::string describe(asio::ip::tcp::acceptor &acceptor) const;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,155 @@
+#include "sse_event_ring.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace mcp::cache {
+
+    namespace {
+        constexpr std::string_view kFrameHead = "event: message\nid: ";
+        constexpr std::string_view kDataHead = "\ndata: ";
+        constexpr std::string_view kFrameTail = "\n\n";
+    }// namespace
+
+    std::string SseEventRing::render(int event_id, std::string_view data) {
+        std::string id = std::to_string(event_id);
+        std::string frame;
+        frame.reserve(kFrameHead.size() + id.size() + kDataHead.size() + data.size() + kFrameTail.size());
+        frame.append(kFrameHead).append(id).append(kDataHead).append(data).append(kFrameTail);
+        return frame;
+    }
+
+    void SseEventRing::put(int event_id, std::string_view data) {
+        if (capacity_ == 0) {
+            return;
+        }
+
+        Entry entry;
+        entry.event_id = event_id;
+        entry.frame = render(event_id, data);
+        entry.data_offset = entry.frame.size() - kFrameTail.size() - data.size();
+        bytes_ += entry.frame.size();
+
+        // Common case: the newest event so far
+        if (entries_.empty() || event_id > at(entries_.size() - 1).event_id) {
+            if (entries_.size() < capacity_) {
+                entries_.push_back(std::move(entry));
+            } else {
+                bytes_ -= entries_[head_].frame.size();
+                entries_[head_] = std::move(entry);
+                head_ = (head_ + 1) % entries_.size();
+            }
+            return;
+        }
+
+        std::size_t index = lower_bound(event_id);
+        if (index < entries_.size() && at(index).event_id == event_id) {
+            bytes_ -= at(index).frame.size();
+            at(index) = std::move(entry);
+        } else if (index > 0 || entries_.size() < capacity_) {
+            insert_ordered(index, std::move(entry));
+        } else {
+            // Older than everything in a full ring, it would be dropped right away
+            bytes_ -= entry.frame.size();
+        }
+    }
+
+    std::size_t SseEventRing::drop_oldest() {
+        if (entries_.empty()) {
+            return 0;
+        }
+        // Straighten the ring so later appends land after the newest event again
+        std::rotate(entries_.begin(), entries_.begin() + static_cast<std::ptrdiff_t>(head_), entries_.end());
+        head_ = 0;
+        std::size_t freed = entries_.front().frame.size();
+        entries_.erase(entries_.begin());
+        bytes_ -= freed;
+        return freed;
+    }
+
+    std::size_t SseEventRing::lower_bound(int event_id) const {
+        std::size_t size = entries_.size();
+        if (size == 0) {
+            return 0;
+        }
+
+        // Event IDs are usually consecutive, then the index follows from the oldest ID
+        long long offset = static_cast<long long>(event_id) - at(0).event_id;
+        if (offset <= 0) {
+            return 0;
+        }
+        if (static_cast<std::size_t>(offset) < size && at(static_cast<std::size_t>(offset)).event_id == event_id) {
+            return static_cast<std::size_t>(offset);
+        }
+
+        std::size_t low = 0, high = size;
+        while (low < high) {
+            std::size_t mid = low + (high - low) / 2;
+            if (at(mid).event_id < event_id) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    void SseEventRing::insert_ordered(std::size_t index, Entry entry) {
+        std::vector<Entry> ordered;
+        ordered.reserve(std::min(entries_.size() + 1, capacity_));
+        bool full = entries_.size() == capacity_;
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            if (i == index) {
+                ordered.push_back(std::move(entry));
+            }
+            // A full ring gives up its oldest event
+            if (!(full && i == 0)) {
+                ordered.push_back(std::move(at(i)));
+            } else {
+                bytes_ -= at(i).frame.size();
+            }
+        }
+        if (index == entries_.size()) {
+            ordered.push_back(std::move(entry));
+        }
+        entries_ = std::move(ordered);
+        head_ = 0;
+    }
+
+    std::vector<std::string> SseEventRing::frames_after(int last_event_id) const {
+        std::vector<std::string> frames;
+        if (last_event_id == std::numeric_limits<int>::max()) {
+            return frames;
+        }
+        std::size_t first = lower_bound(last_event_id + 1);
+        frames.reserve(entries_.size() - first);
+        for (std::size_t i = first; i < entries_.size(); ++i) {
+            frames.push_back(at(i).frame);
+        }
+        return frames;
+    }
+
+    void SseEventRing::for_each(const std::function<void(int, std::string_view)> &visit) const {
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            const auto &entry = at(i);
+            visit(entry.event_id, std::string_view(entry.frame).substr(entry.data_offset,
+                                                                       entry.frame.size() - kFrameTail.size() - entry.data_offset));
+        }
+    }
+
+    std::vector<std::string_view> SseEventRing::data_after(int last_event_id) const {
+        std::vector<std::string_view> data;
+        if (last_event_id == std::numeric_limits<int>::max()) {
+            return data;
+        }
+        std::size_t first = lower_bound(last_event_id + 1);
+        data.reserve(entries_.size() - first);
+        for (std::size_t i = first; i < entries_.size(); ++i) {
+            const auto &entry = at(i);
+            data.emplace_back(std::string_view(entry.frame).substr(entry.data_offset,
+                                                                   entry.frame.size() - kFrameTail.size() - entry.data_offset));
+        }
+        return data;
+    }
+
+}// namespace mcp::cache
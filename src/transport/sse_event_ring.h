@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp::cache {
+
+    /**
+     * @brief Fixed-capacity ring of rendered SSE message frames of one session, ordered by event ID.
+     *
+     * Each frame is stored exactly as it goes out on the wire, so a reconnect replays a
+     * contiguous range of the ring without rendering anything. Appending an event newer than
+     * all stored ones is O(1); once the ring is full the oldest event is overwritten.
+     * Not thread safe.
+     */
+    class SseEventRing {
+    public:
+        /**
+         * @param capacity Maximum number of events kept, 0 keeps none
+         */
+        explicit SseEventRing(std::size_t capacity) : capacity_(capacity) {}
+
+        /**
+         * @brief Store an event, replacing the frame of an event with the same ID.
+         * @param event_id Event identifier
+         * @param data Compact single-line JSON of the event
+         */
+        void put(int event_id, std::string_view data);
+
+        /**
+         * @brief Frames of the events newer than last_event_id, oldest first.
+         * @param last_event_id Last event the client received
+         * @return Frames, each a complete "event: message" block
+         */
+        std::vector<std::string> frames_after(int last_event_id) const;
+
+        /**
+         * @brief Data of the events newer than last_event_id, oldest first.
+         * @param last_event_id Last event the client received
+         * @return Event data as stored by put()
+         */
+        std::vector<std::string_view> data_after(int last_event_id) const;
+
+        /**
+         * @brief Visit every stored event, oldest first.
+         * @param visit Called with the event ID and the data as stored by put()
+         */
+        void for_each(const std::function<void(int, std::string_view)> &visit) const;
+
+        /**
+         * @brief Drop the oldest event, to give memory back under pressure. O(n).
+         * @return Bytes freed, 0 if the ring was empty
+         */
+        std::size_t drop_oldest();
+
+        std::size_t size() const { return entries_.size(); }
+        bool empty() const { return entries_.empty(); }
+        std::size_t bytes() const { return bytes_; }///< Total size of the stored frames
+
+        /**
+         * @brief Render the SSE frame of a message event.
+         * @param event_id Event identifier
+         * @param data Compact single-line JSON of the event
+         * @return "event: message\nid: <id>\ndata: <data>\n\n"
+         */
+        static std::string render(int event_id, std::string_view data);
+
+    private:
+        struct Entry {
+            int event_id = 0;
+            std::string frame;          ///< Rendered frame
+            std::size_t data_offset = 0;///< Start of the data within frame
+        };
+
+        const Entry &at(std::size_t index) const { return entries_[(head_ + index) % entries_.size()]; }
+        Entry &at(std::size_t index) { return entries_[(head_ + index) % entries_.size()]; }
+
+        /**
+         * @brief Logical index of the first event with an ID not below event_id.
+         * @param event_id Event identifier
+         * @return Index in 0..size(), size() if every stored event is older
+         */
+        std::size_t lower_bound(int event_id) const;
+
+        /**
+         * @brief Put an event that belongs before newer stored events, keeping the order. O(n).
+         */
+        void insert_ordered(std::size_t index, Entry entry);
+
+        std::size_t capacity_;
+        std::vector<Entry> entries_;///< Grows to capacity_, then used as a ring
+        std::size_t head_ = 0;      ///< Physical index of the oldest event
+        std::size_t bytes_ = 0;     ///< Sum of the frame sizes
+    };
+
+}// namespace mcp::cache
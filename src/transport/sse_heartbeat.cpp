@@ -0,0 +1,89 @@
+#include "sse_heartbeat.h"
+#include "sse_send_queue.h"
+#include <algorithm>
+
+namespace mcp::transport {
+
+    namespace {
+        /// Floor of the sweep period, so a tiny interval does not make the timer spin
+        constexpr std::chrono::steady_clock::duration kMinPeriod = std::chrono::milliseconds(250);
+    }// namespace
+
+    asio::execution_context::id SseHeartbeat::id;
+
+    SseHeartbeat::SseHeartbeat(asio::execution_context &context)
+        : asio::execution_context::service(context) {
+    }
+
+    SseHeartbeat &SseHeartbeat::of(const asio::any_io_executor &executor) {
+        auto &heartbeat = asio::use_service<SseHeartbeat>(asio::query(executor, asio::execution::context));
+        if (!heartbeat.timer_) {
+            heartbeat.timer_.emplace(executor);
+        }
+        return heartbeat;
+    }
+
+    void SseHeartbeat::watch(const std::shared_ptr<SseSendQueue> &queue, std::chrono::milliseconds interval,
+                             std::chrono::milliseconds jitter) {
+        if (interval.count() <= 0 || !timer_) {
+            return;
+        }
+        // Streams opened together should not all send their comment in the same sweep
+        std::chrono::milliseconds delay{0};
+        if (jitter.count() > 0) {
+            delay = std::chrono::milliseconds(std::uniform_int_distribution<int64_t>(0, jitter.count())(random_));
+        }
+        streams_.push_back({queue, interval + delay});
+        period_ = std::min<std::chrono::steady_clock::duration>(period_, std::max(kMinPeriod, std::chrono::steady_clock::duration(interval) / kSweepsPerInterval));
+
+        if (!sweeping_) {
+            sweeping_ = true;
+            wait();
+        }
+    }
+
+    /**
+     * @brief Send a comment to each stream silent for its idle limit, and drop the streams
+     *        whose writer has stopped.
+     */
+    void SseHeartbeat::sweep() {
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < streams_.size();) {
+            auto queue = streams_[i].queue.lock();
+            if (!queue || queue->stopped()) {
+                streams_[i] = std::move(streams_.back());
+                streams_.pop_back();
+                continue;
+            }
+            if (now - queue->last_activity() >= streams_[i].idle_limit && queue->push_heartbeat()) {
+                ++sent_;
+            }
+            ++i;
+        }
+
+        if (streams_.empty()) {
+            sweeping_ = false;// Started again by the next watch()
+            period_ = std::chrono::steady_clock::duration::max();
+            return;
+        }
+        wait();
+    }
+
+    void SseHeartbeat::wait() {
+        timer_->expires_after(period_);
+        timer_->async_wait([this](const asio::error_code &ec) {
+            if (ec) {
+                sweeping_ = false;
+                return;
+            }
+            sweep();
+        });
+    }
+
+    void SseHeartbeat::shutdown() {
+        streams_.clear();
+        timer_.reset();
+        sweeping_ = false;
+    }
+
+}// namespace mcp::transport
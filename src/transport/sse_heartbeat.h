@@ -0,0 +1,81 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace mcp::transport {
+
+    class SseSendQueue;
+
+    /**
+     * @brief Keep-alive comments for the idle SSE streams of one io_context.
+     *
+     * Proxies and load balancers close a stream that stays silent for too long, and the client
+     * then reconnects and has its events replayed. A stream that wrote nothing for the heartbeat
+     * interval, plus a jitter fixed per stream, gets a ":\n\n" comment, which clients ignore.
+     * One steady_timer per io_context sweeps all of its streams a few times per interval and
+     * only runs while it has streams; a stream that wrote recently costs one comparison per
+     * sweep. Used from the io_context's thread only.
+     */
+    class SseHeartbeat : public asio::execution_context::service {
+    public:
+        static constexpr int kSweepsPerInterval = 4;///< Heartbeats are late by up to interval / kSweepsPerInterval
+
+        static asio::execution_context::id id;
+
+        explicit SseHeartbeat(asio::execution_context &context);
+
+        /**
+         * @brief Heartbeat of the io_context an executor belongs to, created on first use.
+         * @param executor Executor of a stream's session
+         */
+        static SseHeartbeat &of(const asio::any_io_executor &executor);
+
+        /**
+         * @brief Keep a stream alive until its writer stops.
+         * @param queue Send queue of the stream
+         * @param interval Silence after which a comment is sent
+         * @param jitter Upper bound of the random delay added to the interval of this stream
+         */
+        void watch(const std::shared_ptr<SseSendQueue> &queue, std::chrono::milliseconds interval,
+                   std::chrono::milliseconds jitter);
+
+        /**
+         * @brief Streams watched.
+         */
+        std::size_t size() const { return streams_.size(); }
+
+        /**
+         * @brief Comments sent so far.
+         */
+        uint64_t sent() const { return sent_; }
+
+    private:
+        struct Stream {
+            std::weak_ptr<SseSendQueue> queue;
+            std::chrono::steady_clock::duration idle_limit;///< Interval plus this stream's jitter
+        };
+
+        void shutdown() override;
+        void sweep();
+        void wait();
+
+        std::vector<Stream> streams_;
+        std::optional<asio::steady_timer> timer_;
+        std::chrono::steady_clock::duration period_ = std::chrono::steady_clock::duration::max();///< Shortest interval / kSweepsPerInterval
+        std::minstd_rand random_{std::random_device{}()};
+        uint64_t sent_ = 0;
+        bool sweeping_ = false;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,247 @@
+#include "sse_send_queue.h"
+#include "core/logger.h"
+#include "session.h"
+#include "sse_heartbeat.h"
+#include <utility>
+
+namespace mcp::transport {
+
+    namespace {
+        SseQueueOptions &options_storage() {
+            static SseQueueOptions options;
+            return options;
+        }
+    }// namespace
+
+    SlowConsumerPolicy SseQueueOptions::parse_policy(std::string_view text) {
+        if (text == "block") {
+            return SlowConsumerPolicy::Block;
+        }
+        if (text == "drop_oldest") {
+            return SlowConsumerPolicy::DropOldest;
+        }
+        if (text == "disconnect") {
+            return SlowConsumerPolicy::Disconnect;
+        }
+        MCP_WARN("Unknown slow consumer policy '{}', using block", text);
+        return SlowConsumerPolicy::Block;
+    }
+
+    void SseQueueOptions::configure(const SseQueueOptions &options) {
+        options_storage() = options;
+    }
+
+    const SseQueueOptions &SseQueueOptions::current() {
+        return options_storage();
+    }
+
+    SseSendQueue::SseSendQueue(std::shared_ptr<Session> session, const SseQueueOptions &options, ContentEncoding encoding)
+        : session_(std::move(session)),
+          options_(options),
+          executor_(session_->get_executor()),
+          writer_timer_(executor_),
+          space_timer_(executor_),
+          done_timer_(executor_) {
+        if (encoding != ContentEncoding::Identity) {
+            compressor_ = std::make_unique<StreamCompressor>(encoding, CompressionOptions::current().level);
+        }
+    }
+
+    std::shared_ptr<SseSendQueue> SseSendQueue::create(std::shared_ptr<Session> session, const SseQueueOptions &options,
+                                                       ContentEncoding encoding) {
+        std::shared_ptr<SseSendQueue> queue(new SseSendQueue(std::move(session), options, encoding));
+        asio::co_spawn(queue->executor_, [queue]() { return queue->run_writer(); }, asio::detached);
+        if (options.heartbeat_interval.count() > 0) {
+            SseHeartbeat::of(queue->executor_).watch(queue, options.heartbeat_interval, options.heartbeat_jitter);
+        }
+        return queue;
+    }
+
+    void SseSendQueue::push_head(std::string header) {
+        size_t bytes = header.size();
+        Frame pieces;
+        pieces.push_back(std::move(header));
+        entries_.push_back({std::move(pieces), bytes, true});
+        queued_bytes_ += bytes;
+        last_activity_ = std::chrono::steady_clock::now();
+        wake(writer_timer_);
+    }
+
+    bool SseSendQueue::push_heartbeat() {
+        if (queued_bytes_ > 0 || stopped() || session_->is_closed()) {
+            return false;
+        }
+        Frame pieces;
+        pieces.emplace_back(":\n\n");
+        entries_.push_back({std::move(pieces), 3});
+        queued_bytes_ += 3;
+        last_activity_ = std::chrono::steady_clock::now();
+        wake(writer_timer_);
+        return true;
+    }
+
+    asio::awaitable<void> SseSendQueue::wait(asio::steady_timer &timer) {
+        timer.expires_at(asio::steady_timer::time_point::max());
+        asio::error_code ec;
+        co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+    }
+
+    asio::awaitable<bool> SseSendQueue::push(Frame frame) {
+        if (writer_done_ || session_->is_closed()) {
+            co_return false;
+        }
+
+        size_t bytes = 0;
+        for (const auto &piece: frame) {
+            bytes += piece.size();
+        }
+
+        // A frame larger than the whole limit still goes out if nothing is queued
+        if (queued_bytes_ > 0 && queued_bytes_ + bytes > options_.high_watermark) {
+            switch (options_.policy) {
+                case SlowConsumerPolicy::Block:
+                    MCP_DEBUG("Send queue full, pausing stream - session: {}, queued: {} bytes",
+                              session_->get_session_id(), queued_bytes_);
+                    while (!writer_done_ && queued_bytes_ > options_.low_watermark) {
+                        co_await wait(space_timer_);
+                    }
+                    if (writer_done_) {
+                        co_return false;
+                    }
+                    break;
+                case SlowConsumerPolicy::DropOldest:
+                case SlowConsumerPolicy::Disconnect:
+                    if (!make_room(bytes)) {
+                        co_return false;
+                    }
+                    break;
+            }
+        }
+
+        entries_.push_back({std::move(frame), bytes});
+        queued_bytes_ += bytes;
+        last_activity_ = std::chrono::steady_clock::now();
+        wake(writer_timer_);
+
+        // The generator call that follows may block this thread, let the writer start first
+        co_await asio::post(executor_, asio::use_awaitable);
+        co_return !writer_done_;
+    }
+
+    bool SseSendQueue::push_shared(SharedFrame frame) {
+        if (writer_done_ || session_->is_closed()) {
+            return false;
+        }
+
+        size_t bytes = 0;
+        for (const auto &piece: frame) {
+            bytes += piece->size();
+        }
+        if (queued_bytes_ > 0 && queued_bytes_ + bytes > options_.high_watermark &&
+            options_.policy != SlowConsumerPolicy::Block && !make_room(bytes)) {
+            return false;
+        }
+
+        entries_.push_back({{}, bytes, false, std::move(frame)});
+        queued_bytes_ += bytes;
+        last_activity_ = std::chrono::steady_clock::now();
+        wake(writer_timer_);
+        return true;
+    }
+
+    bool SseSendQueue::make_room(size_t bytes) {
+        if (options_.policy == SlowConsumerPolicy::Disconnect) {
+            MCP_WARN("Slow stream client, disconnecting - session: {}, queued: {} bytes",
+                     session_->get_session_id(), queued_bytes_);
+            session_->close();
+            wake(writer_timer_);
+            return false;
+        }
+        uint64_t dropped = 0;
+        while (!entries_.empty() && queued_bytes_ + bytes > options_.low_watermark) {
+            queued_bytes_ -= entries_.front().bytes;
+            entries_.pop_front();
+            ++dropped;
+        }
+        dropped_frames_ += dropped;
+        MCP_WARN("Slow stream client, dropped {} queued frames - session: {}",
+                 dropped, session_->get_session_id());
+        return true;
+    }
+
+    asio::awaitable<void> SseSendQueue::drain() {
+        stopping_ = true;
+        wake(writer_timer_);
+        while (!writer_done_) {
+            co_await wait(done_timer_);
+        }
+    }
+
+    asio::awaitable<void> SseSendQueue::run_writer() {
+        std::vector<Entry> writing;
+        std::vector<asio::const_buffer> buffers;
+        std::deque<std::string> compressed;// Output of the compressor for the batch in flight
+
+        while (!session_->is_closed()) {
+            if (entries_.empty()) {
+                if (stopping_) {
+                    break;
+                }
+                co_await wait(writer_timer_);
+                continue;
+            }
+
+            // Everything queued so far goes out in one write, a slow client gets its backlog at once
+            writing.clear();
+            buffers.clear();
+            size_t bytes = 0;
+            while (!entries_.empty()) {
+                bytes += entries_.front().bytes;
+                writing.push_back(std::move(entries_.front()));
+                entries_.pop_front();
+            }
+            compressed.clear();
+            for (size_t i = 0; i < writing.size(); ++i) {
+                const auto &entry = writing[i];
+                if (!compressor_ || entry.head) {
+                    for (const auto &piece: entry.pieces) {
+                        buffers.push_back(asio::buffer(piece));
+                    }
+                    for (const auto &piece: entry.shared) {
+                        buffers.push_back(asio::buffer(*piece));
+                    }
+                    continue;
+                }
+                // One flush per batch: the last piece before a head entry or the end of the batch
+                bool last = i + 1 == writing.size() || writing[i + 1].head;
+                size_t count = entry.pieces.size() + entry.shared.size();
+                for (size_t j = 0; j < count; ++j) {
+                    const std::string &piece = j < entry.pieces.size() ? entry.pieces[j] : *entry.shared[j - entry.pieces.size()];
+                    std::string out = compressor_->compress(piece, last && j + 1 == count);
+                    if (!out.empty()) {
+                        buffers.push_back(asio::buffer(compressed.emplace_back(std::move(out))));
+                    }
+                }
+            }
+
+            co_await session_->write_buffers(buffers);
+
+            queued_bytes_ -= bytes;
+            last_activity_ = std::chrono::steady_clock::now();
+            if (queued_bytes_ <= options_.low_watermark) {
+                wake(space_timer_);
+            }
+        }
+
+        if (compressor_ && !session_->is_closed()) {
+            co_await session_->write(compressor_->finish());
+        }
+
+        entries_.clear();
+        queued_bytes_ = 0;
+        writer_done_ = true;
+        wake(space_timer_);
+        wake(done_timer_);
+    }
+
+}// namespace mcp::transport
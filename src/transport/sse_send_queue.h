@@ -0,0 +1,174 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "http_compression.h"
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp::transport {
+
+    class Session;
+
+    /**
+     * @brief What a stream does when its client reads slower than the generator produces.
+     */
+    enum class SlowConsumerPolicy {
+        Block,     ///< Stop pulling from the generator until the queue has drained to the low watermark
+        DropOldest,///< Discard the oldest queued events down to the low watermark; they stay in the reconnect cache
+        Disconnect,///< Close the session, the client can reconnect with Last-Event-ID
+    };
+
+    /**
+     * @brief Limits of the per-stream send queue, normally taken from the [server] config section.
+     */
+    struct SseQueueOptions {
+        size_t high_watermark = 1024 * 1024;                  ///< Queued bytes at which the policy applies
+        size_t low_watermark = 256 * 1024;                    ///< Queued bytes a blocked or dropping stream goes back to
+        SlowConsumerPolicy policy = SlowConsumerPolicy::Block;///< Applied when the high watermark is reached
+        std::chrono::milliseconds heartbeat_interval{15000};  ///< Silence after which a keep-alive comment is sent, 0 = none
+        std::chrono::milliseconds heartbeat_jitter{2000};     ///< Random delay of up to this much added per stream, see SseHeartbeat
+
+        /**
+         * @brief Parse a policy name: "block", "drop_oldest" or "disconnect".
+         * @param text Policy name
+         * @return Policy, Block for unknown names
+         */
+        static SlowConsumerPolicy parse_policy(std::string_view text);
+
+        /**
+         * @brief Set the process-wide options. Call before starting any transport.
+         * @param options New options
+         */
+        static void configure(const SseQueueOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const SseQueueOptions &current();
+    };
+
+    /**
+     * @brief Bounded queue between a stream generator and its SSE session.
+     *
+     * The producer pushes frames and goes back to the generator while a writer coroutine sends
+     * whatever has queued up with one gather write. Queued bytes, including the write in flight,
+     * are bounded by the high watermark according to the slow consumer policy.
+     * With a content coding, the frames are compressed as one stream, flushed after every write
+     * so that each batch of events is decodable on arrival; drain() ends the stream.
+     * All members must be used from the session's executor.
+     */
+    class SseSendQueue : public std::enable_shared_from_this<SseSendQueue> {
+    public:
+        using Frame = std::vector<std::string>;///< Pieces sent back to back
+        using SharedFrame = std::vector<std::shared_ptr<const std::string>>;///< Pieces shared with other queues, never copied
+
+        /**
+         * @brief Create a queue and start its writer on the session's executor.
+         * @param session Session to write to
+         * @param options Queue limits
+         * @param encoding Coding of the frames, announced by the response header
+         * @return Queue
+         */
+        static std::shared_ptr<SseSendQueue> create(std::shared_ptr<Session> session,
+                                                    const SseQueueOptions &options = SseQueueOptions::current(),
+                                                    ContentEncoding encoding = ContentEncoding::Identity);
+
+        /**
+         * @brief Queue the response header, sent as it is ahead of every frame pushed later.
+         * @param header Header block
+         */
+        void push_head(std::string header);
+
+        /**
+         * @brief Queue a frame for sending.
+         * Under the Block policy this waits while the queue is above its low watermark.
+         * Always yields once so the writer can make progress between generator calls.
+         * @param frame Frame to send
+         * @return false if the session is closed or was disconnected by the policy
+         */
+        asio::awaitable<bool> push(Frame frame);
+
+        /**
+         * @brief Queue a frame whose pieces other queues send too, see NotificationBroadcast.
+         * Never waits: under the Block policy a full queue takes the frame anyway, notifications
+         * are small and no generator produces them.
+         * @param frame Frame to send
+         * @return false if the session is closed or was disconnected by the policy
+         */
+        bool push_shared(SharedFrame frame);
+
+        /**
+         * @brief Send everything still queued and stop the writer.
+         */
+        asio::awaitable<void> drain();
+
+        /**
+         * @brief Queue a keep-alive comment, unless something is queued or being written already,
+         *        or the writer has stopped. See SseHeartbeat.
+         * @return Whether the comment was queued
+         */
+        bool push_heartbeat();
+
+        /**
+         * @brief When the stream last queued or finished writing something.
+         */
+        std::chrono::steady_clock::time_point last_activity() const { return last_activity_; }
+
+        /**
+         * @brief Whether drain() was called or the writer has exited.
+         */
+        bool stopped() const { return stopping_ || writer_done_; }
+
+        size_t queued_bytes() const { return queued_bytes_; }
+        uint64_t dropped_frames() const { return dropped_frames_; }
+
+    private:
+        struct Entry {
+            Frame pieces;
+            size_t bytes = 0;
+            bool head = false;///< Sent uncompressed, see push_head()
+            SharedFrame shared{};///< Sent after pieces, see push_shared()
+        };
+
+        SseSendQueue(std::shared_ptr<Session> session, const SseQueueOptions &options, ContentEncoding encoding);
+
+        asio::awaitable<void> run_writer();
+
+        /**
+         * @brief Apply the slow consumer policy to a frame that does not fit, except Block.
+         * @return false if the session was disconnected
+         */
+        bool make_room(size_t bytes);
+
+        /**
+         * @brief Suspend until the timer is cancelled by wake().
+         */
+        static asio::awaitable<void> wait(asio::steady_timer &timer);
+        static void wake(asio::steady_timer &timer) { timer.cancel(); }
+
+        std::shared_ptr<Session> session_;
+        SseQueueOptions options_;
+        asio::any_io_executor executor_;
+        std::deque<Entry> entries_;
+        std::unique_ptr<StreamCompressor> compressor_;///< nullptr without a content coding
+        size_t queued_bytes_ = 0;      ///< Bytes in entries_ plus the write in flight
+        uint64_t dropped_frames_ = 0;  ///< Frames discarded by the DropOldest policy
+        std::chrono::steady_clock::time_point last_activity_ = std::chrono::steady_clock::now();
+        bool stopping_ = false;        ///< Set by drain(), the writer exits once entries_ is empty
+        bool writer_done_ = false;     ///< The writer has exited, nothing more will be sent
+        asio::steady_timer writer_timer_;///< Wakes the writer when a frame is queued
+        asio::steady_timer space_timer_; ///< Wakes a blocked producer when the queue has drained
+        asio::steady_timer done_timer_;  ///< Wakes drain() when the writer exits
+    };
+
+}// namespace mcp::transport
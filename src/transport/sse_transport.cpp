@@ -35,9 +35,7 @@ namespace mcp::transport {
                 {"method", "error"},
                 {"params", {{"message", message}}}};
         std::string sse_error = "event: error\n" + error_event.dump() + "\n\n";
-        asio::co_spawn(session->get_socket().get_executor(), [session, sse_error]() -> asio::awaitable<void> {
-                co_await session->write(sse_error);
-                co_return; }, asio::detached);
+        session->post_write(std::move(sse_error));
     }
 
     void SSETransport::handle_request(const std::string &json_message,
@@ -55,10 +53,17 @@ namespace mcp::transport {
                 std::string tool_name = params.value("name", "");
                 auto args = params.value("arguments", nlohmann::json{});
 
-                auto tool_info = registry_->get_tool_info(tool_name);
-                if (!tool_info) {
+                auto tool = registry_->get_tool(tool_name);
+                if (!tool) {
                     throw std::runtime_error("Tool not found: " + tool_name);
                 }
+                const auto *tool_info = &tool->metadata;
+                if (tool->arguments_validator) {
+                    if (auto violation = tool->arguments_validator->validate(args.is_null() ? nlohmann::json::object() : args)) {
+                        send_error_event(session, "Invalid arguments for tool " + tool_name + ": arguments" + violation->path + " " + violation->message);
+                        return;
+                    }
+                }
 
                 if (tool_info->is_streaming) {
                     MCP_INFO("Handling streaming tool: {}", tool_name);
@@ -71,9 +76,7 @@ namespace mcp::transport {
                     }
                     sse_header += "\r\n";
 
-                    asio::co_spawn(session->get_socket().get_executor(), [session, sse_header]() -> asio::awaitable<void> {
-                            co_await session->write(sse_header);
-                            co_return; }, asio::detached);
+                    session->post_write(std::move(sse_header));
                     {
                         std::lock_guard<std::mutex> lock(sessions_mutex_);
                         active_sse_sessions_[session_id] = session;
@@ -91,7 +94,7 @@ namespace mcp::transport {
                         return;
                     }
 
-                    asio::co_spawn(session->get_socket().get_executor(), [session, session_id, generator, stream_next, stream_free, this]() -> asio::awaitable<void> {
+                    asio::co_spawn(session->get_executor(), [session, session_id, generator, stream_next, stream_free, this]() -> asio::awaitable<void> {
                             MCP_INFO("Starting stream consumer for session: {}", session_id);
                             const char *result_json = nullptr;
                             int status = 0;
@@ -134,7 +137,7 @@ namespace mcp::transport {
             }
         } catch (const std::exception &e) {
             MCP_ERROR("Error handling SSE request: {}", e.what());
-            asio::post(session->get_socket().get_executor(),
+            asio::post(session->get_executor(),
                        [this, session, msg = std::string(e.what())]() {
                            send_error_event(session, "Request handling error: " + msg);
                        });
@@ -1,18 +1,80 @@
 #include "ssl_session.h"
+#include "cluster.h"
+#include "connection_timeouts.h"
+#include "core/frame_pool.hpp"
+#include "core/io_context_pool.hpp"
 #include "core/logger.h"
+#include "http2_connection.h"
+#include "http_framer.h"
 #include "http_handler.h"
-#include "utils/session_id.h"
+#include "metrics/metrics_manager.h"
+#include "socket_options.h"
 #include <asio/ssl/error.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 
 namespace mcp::transport {
+    namespace {
+        /**
+         * @brief Protocol settings every server-side SSL object gets before its handshake.
+         */
+        void configure_server_ssl(SSL *ssl) {
+            SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+            SSL_set_options(ssl, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
+            SSL_set_verify(ssl, SSL_VERIFY_NONE, nullptr);// Server mode doesn't require client certificates
+        }
+
+        /**
+         * @brief Count a finished handshake.
+         * @return True if the handshake resumed an earlier session
+         */
+        bool record_handshake(metrics::TlsHandshakeCounters *counters, SSL *ssl, std::chrono::steady_clock::time_point started) {
+            bool resumed = SSL_session_reused(ssl) == 1;
+            if (counters) {
+                (resumed ? counters->resumed : counters->full).fetch_add(1, std::memory_order_relaxed);
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+                counters->record_latency(static_cast<uint64_t>(elapsed.count()));
+            }
+            return resumed;
+        }
+
+        /**
+         * @brief Timeout counters shared by the HTTPS sessions.
+         */
+        metrics::ConnectionTimeoutCounters *timeout_counters() {
+            static const auto counters = metrics::MetricsManager::getInstance()->register_connection_timeout_counters("https");
+            return counters.get();
+        }
+    }// namespace
+
     /**
      * @brief Construct an SslSession with a socket and SSL context.
      * @param socket TCP socket to wrap with SSL
      * @param ssl_context SSL context with certificate configuration
+     * @param handshake_counters Handshake counters of the listener, nullptr to not count
+     */
+    SslSession::SslSession(asio::ip::tcp::socket socket, asio::ssl::context &ssl_context,
+                           metrics::TlsHandshakeCounters *handshake_counters)
+        : ssl_stream_(std::move(socket), ssl_context), handshake_counters_(handshake_counters) {
+        configure_server_ssl(ssl_stream_.native_handle());
+        setup();
+    }
+
+    /**
+     * @brief Construct an SslSession whose handshake already ran, see handshake().
+     * @param socket TCP socket the handshake ran on, may belong to another io_context than before
+     * @param ssl SSL object with the finished handshake
+     * @param handshake_counters Handshake counters of the listener, nullptr to not count
      */
-    SslSession::SslSession(asio::ip::tcp::socket socket, asio::ssl::context &ssl_context)
-        : ssl_stream_(std::move(socket), ssl_context) {
-        session_id_ = utils::generate_session_id();// Generate unique session ID
+    SslSession::SslSession(asio::ip::tcp::socket socket, SslHandle ssl,
+                           metrics::TlsHandshakeCounters *handshake_counters)
+        : ssl_stream_(std::move(socket), ssl.release()), handshake_counters_(handshake_counters) {
+        setup();
+    }
+
+    void SslSession::setup() {
+        session_id_ = Cluster::instance().mint_session_id();// Owned by this node in cluster mode
 
         // Validate socket state after construction
         if (!ssl_stream_.lowest_layer().is_open()) {
@@ -20,17 +82,73 @@ namespace mcp::transport {
             throw std::runtime_error("Invalid socket passed to SslSession");
         }
 
-        // Configure SSL security options
-        SSL *ssl = ssl_stream_.native_handle();
-        SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
-        SSL_set_options(ssl, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
-
-        // Server mode doesn't require client certificates
-        ssl_stream_.set_verify_mode(asio::ssl::verify_none);
+        SocketOptions::current().apply(ssl_stream_.next_layer());
 
         MCP_DEBUG("Created new SSL session with ID: {}", session_id_);
     }
 
+    /**
+     * @brief Run a server handshake directly on an accepted socket, without a session.
+     *
+     * OpenSSL reads the socket itself here and, with read-ahead off, stops at the last
+     * handshake record: anything the client sent afterwards is still in the kernel when the
+     * socket moves on, so the SSL object can be handed to a session on any io_context.
+     * @param socket Accepted socket, its executor runs the handshake
+     * @param ssl_context SSL context with certificate configuration
+     * @param handshake_counters Handshake counters of the listener, nullptr to not count
+     * @param accepted When the connection was accepted, for the handshake latency
+     * @return SSL object with the finished handshake, nullptr if it failed
+     */
+    asio::awaitable<SslSession::SslHandle> SslSession::handshake(asio::ip::tcp::socket &socket, asio::ssl::context &ssl_context,
+                                                                 metrics::TlsHandshakeCounters *handshake_counters,
+                                                                 std::chrono::steady_clock::time_point accepted) {
+        asio::error_code ec;
+        socket.native_non_blocking(true, ec);// OpenSSL does the socket reads and writes itself
+        SslHandle ssl(SSL_new(ssl_context.native_handle()));
+        if (ec || !ssl || SSL_set_fd(ssl.get(), static_cast<int>(socket.native_handle())) != 1) {
+            MCP_WARN("Failed to prepare TLS handshake: {}", ec ? ec.message() : std::string("SSL object setup failed"));
+            if (handshake_counters) {
+                handshake_counters->failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            co_return nullptr;
+        }
+        configure_server_ssl(ssl.get());
+        SSL_set_accept_state(ssl.get());
+        SocketOptions::current().apply(socket);
+
+        while (true) {
+            ERR_clear_error();
+            int rc = SSL_do_handshake(ssl.get());
+            if (rc == 1) {
+                break;
+            }
+            int error = SSL_get_error(ssl.get(), rc);
+            if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+                co_await socket.async_wait(error == SSL_ERROR_WANT_READ ? asio::ip::tcp::socket::wait_read : asio::ip::tcp::socket::wait_write,
+                                           core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+                if (!ec) {
+                    continue;
+                }
+            }
+
+            if (handshake_counters) {
+                handshake_counters->failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            char err_buf[256] = "connection closed";
+            if (unsigned long openssl_err = ERR_get_error()) {
+                ERR_error_string_n(openssl_err, err_buf, sizeof(err_buf));
+            } else if (ec) {
+                std::snprintf(err_buf, sizeof(err_buf), "%s", ec.message().c_str());
+            }
+            MCP_DEBUG("TLS handshake failed: {}", err_buf);
+            co_return nullptr;
+        }
+
+        bool resumed = record_handshake(handshake_counters, ssl.get(), accepted);
+        MCP_DEBUG("TLS handshake finished on the handshake pool ({})", resumed ? "resumed" : "full");
+        co_return ssl;
+    }
+
     /**
      * @brief Start the SSL session, perform handshake, and begin reading requests.
      * @param handler HTTP handler for processing requests
@@ -43,57 +161,107 @@ namespace mcp::transport {
             co_return;
         }
 
+        auto active = IOServiceActivity::CountSession();
         try {
-            MCP_DEBUG("Initiating SSL handshake for session: {}", session_id_);
+            // Connections that stall in the handshake or while sending a request, or idle
+            // too long between requests, are closed by their io_context's timer wheel; the
+            // handshake counts against the header timeout of the first request
+            ConnectionDeadline deadline(ssl_stream_.get_executor(), timeout_counters(), [this]() {
+                MCP_DEBUG("Closing stalled connection (Session: {})", session_id_);
+                close();
+            });
+            deadline.enter(ConnectionPhase::Header);
+
+            // Sessions built from handshake() start with the handshake done
+            if (!SSL_is_init_finished(ssl_stream_.native_handle())) {
+                MCP_DEBUG("Initiating SSL handshake for session: {}", session_id_);
+
+                // Perform SSL/TLS handshake in server mode
+                auto started = std::chrono::steady_clock::now();
+                asio::error_code handshake_ec;
+                co_await ssl_stream_.async_handshake(asio::ssl::stream_base::server, asio::redirect_error(asio::use_awaitable, handshake_ec));
+                if (handshake_ec) {
+                    if (handshake_counters_) {
+                        handshake_counters_->failed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    throw std::system_error(handshake_ec);
+                }
+                bool resumed = record_handshake(handshake_counters_, ssl_stream_.native_handle(), started);
+                MCP_DEBUG("SSL handshake successful for session: {} ({})", session_id_, resumed ? "resumed" : "full");
+            }
 
-            // Perform SSL/TLS handshake in server mode
-            co_await ssl_stream_.async_handshake(asio::ssl::stream_base::server, asio::use_awaitable);
-            MCP_DEBUG("SSL handshake successful for session: {}", session_id_);
+            // Clients that negotiated h2 get the HTTP/2 framing layer instead of the HTTP/1.1 loop
+            const unsigned char *protocol = nullptr;
+            unsigned int protocol_length = 0;
+            SSL_get0_alpn_selected(ssl_stream_.native_handle(), &protocol, &protocol_length);
+            if (protocol_length == 2 && std::memcmp(protocol, "h2", 2) == 0) {
+                deadline.enter(ConnectionPhase::Handling);
+                auto connection = std::make_shared<Http2Connection>(shared_from_this());
+                co_await connection->run(handler);
+                close();
+                co_return;
+            }
 
-            std::string request_buffer;
             // Read and process requests
+            HttpRequestFramer framer;
+            bool first_request = true;
+            UploadScan upload = UploadScan::NeedMore;
             while (!closed_ && ssl_stream_.lowest_layer().is_open()) {
-                auto n = co_await ssl_stream_.async_read_some(asio::buffer(buffer_), asio::use_awaitable);
-                if (n == 0) break;// Connection closed gracefully
-
-                // Append new data to request buffer
-                request_buffer.append(buffer_.data(), n);
-
-                // Check for complete HTTP requests
-                while (!request_buffer.empty()) {
-                    size_t header_end = request_buffer.find("\r\n\r\n");
-                    if (header_end == std::string::npos) {
-                        break;// Incomplete headers - wait for more data
-                    }
+                deadline.enter(read_phase(framer.buffered(), framer.headers_complete(), first_request));
 
-                    // Parse Content-Length header
-                    size_t content_length = 0;
-                    size_t content_length_pos = request_buffer.find("Content-Length:");
-                    if (content_length_pos != std::string::npos && content_length_pos < header_end) {
-                        size_t value_start = content_length_pos + 16;// After "Content-Length:"
-                        size_t value_end = request_buffer.find_first_of("\r\n", value_start);
-                        if (value_end != std::string::npos) {
-                            std::string length_str = request_buffer.substr(value_start, value_end - value_start);
-                            length_str.erase(0, length_str.find_first_not_of(" \t"));
-                            length_str.erase(length_str.find_last_not_of(" \t") + 1);
-                            try {
-                                content_length = std::stoull(length_str);
-                            } catch (...) {
-                                content_length = 0;// Handle invalid length
+                // Unlike TcpSession, an idle connection does not wait on the raw socket first:
+                // records the client pipelined may already sit in the stream's engine, where
+                // neither SSL_pending nor the socket sees them, and only a read finds them
+                auto n = co_await ssl_stream_.async_read_some(framer.prepare(), core::pooled(asio::use_awaitable));
+                if (n == 0) break;// Connection closed gracefully
+                framer.commit(n);
+
+                // Dispatch every complete request that is buffered
+                bool malformed = false;
+                bool upgraded = false;
+                while (true) {
+                    auto status = framer.next();
+                    if (status == HttpRequestParser::Status::Incomplete) {
+                        // A large tools/call body may go to its plugin while it arrives
+                        if (upload == UploadScan::NeedMore && framer.headers_complete()) {
+                            StreamedArgument argument;
+                            upload = handler->scan_upload(framer, argument);
+                            if (upload == UploadScan::Streamed) {
+                                deadline.enter(ConnectionPhase::Handling);
+                                first_request = false;
+                                bool finished = co_await handler->handle_upload(shared_from_this(), framer, std::move(argument), deadline);
+                                co_await flush_pending_writes();
+                                upload = UploadScan::NeedMore;
+                                malformed = !finished;// Framing is lost with the rest of the body unread
                             }
                         }
+                        break;// Wait for more data
                     }
-
-                    // Check if request is complete
-                    size_t total_required = header_end + 4 + content_length;// +4 for "\r\n\r\n"
-                    if (request_buffer.length() >= total_required) {
-                        std::string complete_request = request_buffer.substr(0, total_required);
-                        co_await handler->handle_request(shared_from_this(), complete_request);
-                        request_buffer.erase(0, total_required);// Remove processed data
-                    } else {
-                        break;// Incomplete request - wait for more data
+                    // Answering takes as long as it takes, the client is not the one stalling
+                    deadline.enter(ConnectionPhase::Handling);
+                    first_request = false;
+                    if (status == HttpRequestParser::Status::Error) {
+                        // Framing is lost, answer once and drop the connection
+                        co_await handler->handle_request(shared_from_this(), nullptr, framer.buffered());
+                        malformed = true;
+                        break;
+                    }
+                    co_await handler->handle_request(shared_from_this(), &framer.request(), framer.request_size());
+                    framer.consume();
+                    upload = UploadScan::NeedMore;
+
+                    // Answer before the next pipelined request so responses keep request order
+                    co_await flush_pending_writes();
+
+                    if (auto upgrade = take_upgrade()) {
+                        // The connection speaks another protocol from here on
+                        std::string buffered = framer.unconsumed();
+                        co_await upgrade(std::move(buffered));
+                        upgraded = true;
+                        break;
                     }
                 }
+                if (malformed || upgraded) break;
             }
         } catch (const std::exception &e) {
             if (!closed_) {
@@ -105,67 +273,76 @@ namespace mcp::transport {
         co_return;
     }
 
+    /**
+     * @brief Read decrypted bytes, for a protocol that took the connection over.
+     * @param buffer Buffer to read into
+     */
+    asio::awaitable<size_t> SslSession::read_some(asio::mutable_buffer buffer) {
+        return ssl_stream_.async_read_some(buffer, core::pooled(asio::use_awaitable));
+    }
+
+    /**
+     * @brief Wait for the socket to become readable: the client closed it, or sent a close_notify.
+     */
+    asio::awaitable<void> SslSession::wait_for_disconnect() {
+        asio::error_code ec;
+        co_await ssl_stream_.lowest_layer().async_wait(asio::ip::tcp::socket::wait_read, core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+    }
+
     /**
      * @brief Write encrypted data to the SSL stream.
-     * @param message Data to send to client
+     * Buffers are cut into full TLS records: small buffers are packed together, data that
+     * fills whole records is encrypted straight from the caller's buffer, and a last buffer
+     * is never copied.
+     * @param buffers Data to send to client, in order
      */
-    asio::awaitable<void> SslSession::write(const std::string &message) {
+    asio::awaitable<void> SslSession::write_now(std::span<const asio::const_buffer> buffers) {
         if (closed_ || !ssl_stream_.lowest_layer().is_open()) {
             MCP_DEBUG("Attempted write to closed SSL session (ID: {})", session_id_);
             co_return;
         }
 
-        try {
-            // Clear any pending data in the socket buffer to prevent BIO buffer issues
-            std::array<char, 8192> discard_buf;
-            asio::error_code ec;
-            while (ssl_stream_.lowest_layer().available(ec) > 0 && !ec) {
-                ssl_stream_.next_layer().read_some(asio::buffer(discard_buf), ec);
-            }
-
-            // Check for errors after draining
-            if (ec && ec != asio::error::would_block) {
-                MCP_WARN("Error draining socket buffer (session ID: {}): {}", session_id_, ec.message());
-                close();
-                co_return;
-            }
+        constexpr size_t record_size = SSL3_RT_MAX_PLAIN_LENGTH;// 16 KB of plaintext per record
+        size_t total_bytes = asio::buffer_size(buffers);
+        std::string record;// packs small buffers, never grows past one record
 
-            // Send encrypted message
-            size_t total_bytes_written = 0;
-            const size_t max_chunk_size = 4096;// Limit chunk size to prevent buffer issues
-
-            // Send message in chunks if it's large
-            while (total_bytes_written < message.size()) {
-                size_t chunk_size = std::min(max_chunk_size, message.size() - total_bytes_written);
-                std::string chunk = message.substr(total_bytes_written, chunk_size);
-
-                //asio::error_code ec;
-                size_t bytes_written = co_await asio::async_write(ssl_stream_, asio::buffer(chunk), asio::redirect_error(asio::use_awaitable, ec));
-
-                if (ec) {
-                    if (!closed_) {
-                        MCP_WARN("Failed to write to SSL socket (session ID: {}): {} ({})", session_id_, ec.message(), ec.value());
-                        unsigned long openssl_err = ERR_get_error();
-                        if (openssl_err != 0) {
-                            char err_buf[256];
-                            ERR_error_string_n(openssl_err, err_buf, sizeof(err_buf));
-                            MCP_WARN("OpenSSL error details (session ID: {}): {}", session_id_, err_buf);
+        try {
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                const char *data = static_cast<const char *>(buffers[i].data());
+                size_t size = buffers[i].size();
+                bool last = i + 1 == buffers.size();
+
+                while (size > 0) {
+                    if (record.empty() && (last || size >= record_size)) {
+                        size_t direct = last ? size : size - size % record_size;
+                        if (!co_await write_records(asio::buffer(data, direct))) {
+                            co_return;
                         }
+                        data += direct;
+                        size -= direct;
+                        continue;
                     }
-                    close();
-                    co_return;
-                }
 
-                if (bytes_written != chunk_size) {
-                    MCP_WARN("Incomplete write to SSL socket (session ID: {}): expected {}, wrote {}", session_id_, chunk_size, bytes_written);
-                    close();
-                    co_return;
+                    if (record.empty()) {
+                        record.reserve(std::min(record_size, total_bytes));
+                    }
+                    size_t n = std::min(size, record_size - record.size());
+                    record.append(data, n);
+                    data += n;
+                    size -= n;
+                    if (record.size() == record_size) {
+                        if (!co_await write_records(asio::buffer(record))) {
+                            co_return;
+                        }
+                        record.clear();
+                    }
                 }
-
-                total_bytes_written += chunk_size;
+            }
+            if (!record.empty() && !co_await write_records(asio::buffer(record))) {
+                co_return;
             }
 
-            MCP_DEBUG("Successfully wrote {} bytes to SSL session (ID: {})", message.size(), session_id_);
+            MCP_DEBUG("Successfully wrote {} bytes to SSL session (ID: {})", total_bytes, session_id_);
         } catch (const std::exception &e) {
             if (!closed_) {
                 unsigned long openssl_err = ERR_get_error();
@@ -184,68 +361,34 @@ namespace mcp::transport {
     }
 
     /**
-     * @brief Stream write encrypted data to the SSL stream.
-     * @param message Data to send to client
-     * @param flush Whether to flush the data immediately
+     * @brief Encrypt and send one contiguous buffer, as few records as its size allows.
+     * @param buffer Plaintext to send
+     * @return False if the write failed, the session is closed then
      */
-    asio::awaitable<void> SslSession::stream_write(const std::string &message, [[maybe_unused]] bool flush) {
-        if (closed_ || !ssl_stream_.lowest_layer().is_open()) {
-            MCP_DEBUG("Attempted stream write to closed SSL session (ID: {})", session_id_);
-            co_return;
-        }
-
-        try {
-            // Send encrypted message without clearing the buffer to allow streaming
-            size_t total_bytes_written = 0;
-            const size_t max_chunk_size = 4096;// Limit chunk size to prevent buffer issues
-
-            // Send message in chunks if it's large
-            while (total_bytes_written < message.size()) {
-                size_t chunk_size = std::min(max_chunk_size, message.size() - total_bytes_written);
-                std::string chunk = message.substr(total_bytes_written, chunk_size);
-
-                asio::error_code ec;
-                size_t bytes_written = co_await asio::async_write(ssl_stream_, asio::buffer(chunk), asio::redirect_error(asio::use_awaitable, ec));
-
-                if (ec) {
-                    if (!closed_) {
-                        MCP_WARN("Failed to stream write to SSL socket (session ID: {}): {} ({})", session_id_, ec.message(), ec.value());
-                        unsigned long openssl_err = ERR_get_error();
-                        if (openssl_err != 0) {
-                            char err_buf[256];
-                            ERR_error_string_n(openssl_err, err_buf, sizeof(err_buf));
-                            MCP_WARN("OpenSSL error details (session ID: {}): {}", session_id_, err_buf);
-                        }
-                    }
-                    close();
-                    co_return;
-                }
-
-                if (bytes_written != chunk_size) {
-                    MCP_WARN("Incomplete stream write to SSL socket (session ID: {}): expected {}, wrote {}", session_id_, chunk_size, bytes_written);
-                    close();
-                    co_return;
-                }
-
-                total_bytes_written += chunk_size;
-            }
+    asio::awaitable<bool> SslSession::write_records(asio::const_buffer buffer) {
+        asio::error_code ec;
+        size_t bytes_written = co_await asio::async_write(ssl_stream_, buffer, core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
 
-            MCP_DEBUG("Successfully stream wrote {} bytes to SSL session (ID: {})", message.size(), session_id_);
-        } catch (const std::exception &e) {
+        if (ec) {
             if (!closed_) {
+                MCP_WARN("Failed to write to SSL socket (session ID: {}): {} ({})", session_id_, ec.message(), ec.value());
                 unsigned long openssl_err = ERR_get_error();
                 if (openssl_err != 0) {
                     char err_buf[256];
                     ERR_error_string_n(openssl_err, err_buf, sizeof(err_buf));
-                    MCP_ERROR("Failed to stream write to SSL socket (session ID: {}): {} (OpenSSL error: {})",
-                              session_id_, e.what(), err_buf);
-                } else {
-                    MCP_ERROR("Failed to stream write to SSL socket (session ID: {}): {}", session_id_, e.what());
+                    MCP_WARN("OpenSSL error details (session ID: {}): {}", session_id_, err_buf);
                 }
             }
             close();
+            co_return false;
         }
-        co_return;
+
+        if (bytes_written != buffer.size()) {
+            MCP_WARN("Incomplete write to SSL socket (session ID: {}): expected {}, wrote {}", session_id_, buffer.size(), bytes_written);
+            close();
+            co_return false;
+        }
+        co_return true;
     }
 
     /**
@@ -281,14 +424,7 @@ namespace mcp::transport {
             MCP_DEBUG("Socket cancel error (session ID: {}): {}", session_id_, ec.message());
         }
 
-        // 3. Read remaining data
-        std::array<char, 8192> discard_buf;
-        ec.clear();
-        while (ssl_stream_.lowest_layer().available(ec) > 0 && !ec) {
-            ssl_stream_.next_layer().read_some(asio::buffer(discard_buf), ec);
-        }
-
-        // 4. Shutdown and close underlying socket
+        // 3. Shutdown and close underlying socket
         (void) ssl_stream_.lowest_layer().shutdown(asio::ip::tcp::socket::shutdown_both, ec);
         if (ec && ec != asio::error::not_connected) {
             MCP_DEBUG("Socket shutdown error (session ID: {}): {}", session_id_, ec.message());
@@ -299,19 +435,9 @@ namespace mcp::transport {
             MCP_DEBUG("Socket close error (session ID: {}): {}", session_id_, ec.message());
         }
 
-        // Clear buffer for security
-        std::fill(buffer_.begin(), buffer_.end(), static_cast<char>(0));
-
         MCP_DEBUG("SSL session (ID: {}) closed successfully", session_id_);
     }
 
-    /**
-     * @brief Clear the read buffer.
-     */
-    void SslSession::clear_buffer() {
-        std::fill(buffer_.begin(), buffer_.end(), static_cast<char>(0));
-    }
-
     /**
      * @brief Check if the session is closed.
      * @return True if closed, false otherwise
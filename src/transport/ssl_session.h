@@ -5,10 +5,13 @@
 #define _WIN32_WINNT 0x0601
 #endif
 
+#include "metrics/metrics_manager.h"
 #include "session.h"
 #include "transport_types.h"
 #include <asio.hpp>
 #include <asio/ssl.hpp>
+#include <chrono>
+#include <memory>
 
 
 namespace mcp::transport {
@@ -23,16 +26,23 @@ namespace mcp::transport {
      */
     class SslSession : public Session {
     public:
-        explicit SslSession(asio::ip::tcp::socket socket, asio::ssl::context &ssl_context);
+        struct SslFree {
+            void operator()(SSL *ssl) const { SSL_free(ssl); }
+        };
+        using SslHandle = std::unique_ptr<SSL, SslFree>;///< Owned OpenSSL connection object
+
+        explicit SslSession(asio::ip::tcp::socket socket, asio::ssl::context &ssl_context,
+                            metrics::TlsHandshakeCounters *handshake_counters = nullptr);
+        SslSession(asio::ip::tcp::socket socket, SslHandle ssl, metrics::TlsHandshakeCounters *handshake_counters = nullptr);
         ~SslSession() = default;
 
         asio::awaitable<void> start(HttpHandler *handler) override;
-        asio::awaitable<void> write(const std::string &message) override;
-        asio::awaitable<void> stream_write(const std::string &message, bool flush = true) override;
         void close() override;
-        void clear_buffer() override;
         bool is_closed() const override;
-        asio::ip::tcp::socket &get_socket() override { return ssl_stream_.next_layer(); }
+        asio::awaitable<size_t> read_some(asio::mutable_buffer buffer) override;
+        asio::any_io_executor get_executor() override { return ssl_stream_.get_executor(); }
+        asio::awaitable<void> wait_for_disconnect() override;
+        asio::ip::tcp::socket &get_socket() { return ssl_stream_.next_layer(); }
 
         /**
          * @brief Get the underlying SSL stream.
@@ -40,11 +50,31 @@ namespace mcp::transport {
          */
         asio::ssl::stream<asio::ip::tcp::socket> &get_stream();
 
-        std::array<char, 8192> &get_buffer() override { return buffer_; }
         const std::string &get_session_id() const override { return session_id_; }
 
+        /**
+         * @brief Run the server handshake of an accepted socket on the socket's own executor,
+         *        so that the session can be created on another io_context afterwards.
+         * @param socket Accepted socket
+         * @param ssl_context SSL context with certificate configuration
+         * @param handshake_counters Handshake counters of the listener, nullptr to not count
+         * @param accepted When the connection was accepted
+         * @return SSL object to construct the session with, nullptr if the handshake failed
+         */
+        static asio::awaitable<SslHandle> handshake(asio::ip::tcp::socket &socket, asio::ssl::context &ssl_context,
+                                                    metrics::TlsHandshakeCounters *handshake_counters,
+                                                    std::chrono::steady_clock::time_point accepted);
+
+    protected:
+        asio::awaitable<void> write_now(std::span<const asio::const_buffer> buffers) override;
+
     private:
+        void setup();///< Common part of the constructors
+        asio::awaitable<bool> write_records(asio::const_buffer buffer);///< Write one buffer, false if the session failed
+
+        metrics::GaugeHold live_{metrics::MetricsManager::getInstance()->runtime_gauges().ssl_sessions};///< Counts the session while it exists
         asio::ssl::stream<asio::ip::tcp::socket> ssl_stream_;///< SSL-wrapped socket
+        metrics::TlsHandshakeCounters *handshake_counters_;  ///< Full and resumed handshakes of the listener, may be nullptr
     };
 
 }// namespace mcp::transport
\ No newline at end of file
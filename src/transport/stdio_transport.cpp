@@ -3,40 +3,316 @@
 #include "business/tool_registry.h"
 #include "core/logger.h"
 #include "protocol/json_rpc.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <sstream>
-#include <thread>
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace mcp::transport {
 
-    StdioTransport::StdioTransport(std::shared_ptr<mcp::business::ToolRegistry> registry)
-        : registry_(std::move(registry)) {
+    namespace {
+        StdioOptions &options_storage() {
+            static StdioOptions options;
+            return options;
+        }
+
+        std::atomic<StdioTransport *> active_transport{nullptr};
+    }// namespace
+
+    void StdioOptions::configure(const StdioOptions &options) {
+        options_storage() = options;
+    }
+
+    const StdioOptions &StdioOptions::current() {
+        return options_storage();
+    }
+
+    StdioTransport::StdioTransport(std::shared_ptr<mcp::business::ToolRegistry> registry, const StdioOptions &options)
+        : registry_(std::move(registry)),
+          options_(options) {
+        options_.read_buffer_size = std::max<size_t>(options_.read_buffer_size, 4096);
+        options_.max_in_flight = std::max<size_t>(options_.max_in_flight, 1);
+    }
+
+    StdioTransport::~StdioTransport() {
+        close();
+    }
+
+    StdioTransport *StdioTransport::active() {
+        return active_transport.load(std::memory_order_acquire);
     }
 
     bool StdioTransport::open(MessageCallback on_message) {
-        MCP_INFO("STDIO Transport started, waiting for input...");
-        std::thread([this, cb = std::move(on_message)]() {
+        if (running_) {
+            return false;
+        }
+        on_message_ = std::move(on_message);
+        input_.resize(options_.read_buffer_size);
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+        try {
+            // asio switches the descriptors to non-blocking mode; close() restores the flags
+            input_flags_ = ::fcntl(STDIN_FILENO, F_GETFL);
+            output_flags_ = ::fcntl(STDOUT_FILENO, F_GETFL);
+            input_descriptor_.assign(::dup(STDIN_FILENO));
+            output_descriptor_.assign(::dup(STDOUT_FILENO));
+            output_descriptor_.non_blocking(true);
+        } catch (const std::exception &e) {
+            MCP_ERROR("Failed to open stdin/stdout: {}", e.what());
+            return false;
+        }
+        running_ = true;
+        asio::co_spawn(io_context_, read_loop(), asio::detached);
+#else
+        running_ = true;
+        reader_ = std::thread([this]() {
             std::string line;
             while (running_ && std::getline(std::cin, line)) {
-                if (!line.empty()) {
-                    MCP_DEBUG("Received raw message: {}", line);
-                    cb(line);
+                line += '\n';
+                asio::post(io_context_, [this, line = std::move(line)]() { append_input(line.data(), line.size()); });
+            }
+            asio::post(io_context_, [this]() { end_input(); });
+        });
+#endif
+        active_transport.store(this, std::memory_order_release);
+
+        thread_ = std::thread([this]() {
+            try {
+                io_context_.run();
+            } catch (const std::exception &e) {
+                MCP_ERROR("Error in STDIO io_context: {}", e.what());
+            }
+        });
+        MCP_INFO("STDIO Transport started, waiting for input...");
+        return true;
+    }
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+    /**
+     * @brief Read stdin in large chunks straight into the line buffer.
+     * Reading pauses while max_in_flight messages are being handled.
+     */
+    asio::awaitable<void> StdioTransport::read_loop() {
+        try {
+            while (running_) {
+                if (scan_lines()) {
+                    slot_timer_.expires_at(asio::steady_timer::time_point::max());
+                    asio::error_code ec;
+                    co_await slot_timer_.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+                    continue;
+                }
+
+                // A line longer than the free space grows the buffer
+                size_t min_free = options_.read_buffer_size / 2;
+                if (input_begin_ > 0 && input_.size() - input_end_ < min_free) {
+                    std::memmove(input_.data(), input_.data() + input_begin_, input_end_ - input_begin_);
+                    input_end_ -= input_begin_;
+                    input_scanned_ -= input_begin_;
+                    input_begin_ = 0;
+                }
+                if (input_.size() - input_end_ < min_free) {
+                    input_.resize(input_.size() * 2);
                 }
+
+                size_t n = co_await input_descriptor_.async_read_some(
+                        asio::buffer(input_.data() + input_end_, input_.size() - input_end_), asio::use_awaitable);
+                input_end_ += n;
             }
-        }).detach();
-        running_ = true;
+        } catch (const std::system_error &e) {
+            if (e.code() != asio::error::eof && running_) {
+                MCP_ERROR("Failed to read stdin: {}", e.what());
+            }
+        }
+        end_input();
+    }
+#else
+    asio::awaitable<void> StdioTransport::read_loop() {
+        co_return;// stdin is read by reader_
+    }
+#endif
+
+    void StdioTransport::append_input(const char *data, size_t size) {
+        if (input_begin_ > 0 && input_.size() - input_end_ < size) {
+            std::memmove(input_.data(), input_.data() + input_begin_, input_end_ - input_begin_);
+            input_end_ -= input_begin_;
+            input_scanned_ -= input_begin_;
+            input_begin_ = 0;
+        }
+        if (input_.size() - input_end_ < size) {
+            input_.resize(std::max(input_.size() * 2, input_end_ + size));
+        }
+        std::memcpy(input_.data() + input_end_, data, size);
+        input_end_ += size;
+        scan_lines();
+    }
+
+    void StdioTransport::end_input() {
+        MCP_INFO("STDIO input closed");
+        input_closed_ = true;
+        scan_lines();
+    }
+
+    /**
+     * @brief Dispatch the complete lines that are buffered, as long as max_in_flight allows.
+     * @return True if dispatching stopped because max_in_flight messages are being handled
+     */
+    bool StdioTransport::scan_lines() {
+        while (in_flight_ < options_.max_in_flight) {
+            const void *newline = std::memchr(input_.data() + input_scanned_, '\n', input_end_ - input_scanned_);
+            size_t end;
+            if (newline) {
+                end = static_cast<size_t>(static_cast<const char *>(newline) - input_.data());
+            } else if (input_closed_ && input_begin_ < input_end_) {
+                end = input_end_;// Last line, without a newline
+            } else {
+                input_scanned_ = input_end_;
+                return false;
+            }
+
+            std::string_view line(input_.data() + input_begin_, end - input_begin_);
+            input_begin_ = std::min(end + 1, input_end_);
+            input_scanned_ = input_begin_;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (!line.empty()) {
+                MCP_DEBUG("Received raw message: {}", line);
+                dispatch(std::string(line));
+            }
+        }
         return true;
     }
 
+    void StdioTransport::dispatch(std::string line) {
+        uint64_t sequence = next_sequence_++;
+        ++in_flight_;
+        asio::co_spawn(io_context_, [this, sequence, line = std::move(line)]() -> asio::awaitable<void> {
+            std::string reply;
+            try {
+                reply = co_await on_message_(line);
+            } catch (const std::exception &e) {
+                MCP_ERROR("STDIO message failed: {}", e.what());
+                reply = protocol::make_error(protocol::error_code::INTERNAL_ERROR, e.what(), nlohmann::json(nullptr));
+            }
+            complete(sequence, std::move(reply));
+        }, asio::detached);
+    }
+
+    /**
+     * @brief Record the answer of a message; answers are written in the order the messages arrived.
+     * @param sequence Sequence number of the message
+     * @param reply Answer, empty for none
+     */
+    void StdioTransport::complete(uint64_t sequence, std::string reply) {
+        --in_flight_;
+        slot_timer_.cancel();
+
+        if (sequence != next_output_) {
+            held_.emplace(sequence, std::move(reply));
+        } else {
+            queue_output(reply);
+            ++next_output_;
+            for (auto it = held_.begin(); it != held_.end() && it->first == next_output_; it = held_.erase(it)) {
+                queue_output(it->second);
+                ++next_output_;
+            }
+        }
+        scan_lines();
+    }
+
     bool StdioTransport::write(const std::string &message) {
-        // Key: use std::flush or std::endl to force flushing
-        std::cout << message << std::endl;// endl will automatically flush
-        // std::cout << message << std::flush; // Or explicit flush
+        if (!running_) {
+            return false;
+        }
+        asio::post(io_context_, [this, message]() { queue_output(message); });
         return true;
     }
 
+    void StdioTransport::queue_output(std::string_view message) {
+        if (message.empty()) {
+            return;
+        }
+        output_.append(message);
+        output_ += '\n';
+        if (!write_pending_) {
+            write_pending_ = true;
+            asio::co_spawn(io_context_, write_loop(), asio::detached);
+        }
+    }
+
+    /**
+     * @brief Write the queued answers; what queues up during a write goes out with the next one.
+     * Bytes are written here and only the wait for stdout to drain is asynchronous, so written_
+     * always counts what went out, even when close() stops the loop halfway.
+     */
+    asio::awaitable<void> StdioTransport::write_loop() {
+        while (!output_.empty()) {
+            writing_.clear();
+            written_ = 0;
+            std::swap(writing_, output_);
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+            while (written_ < writing_.size()) {
+                asio::error_code ec;
+                written_ += output_descriptor_.write_some(asio::buffer(writing_.data() + written_, writing_.size() - written_), ec);
+                if (ec == asio::error::would_block || ec == asio::error::try_again) {
+                    co_await output_descriptor_.async_wait(asio::posix::stream_descriptor::wait_write,
+                                                           asio::redirect_error(asio::use_awaitable, ec));
+                }
+                if (ec) {
+                    MCP_ERROR("Failed to write to stdout: {}", ec.message());
+                    written_ = writing_.size();
+                    output_.clear();
+                }
+            }
+#else
+            std::cout.write(writing_.data(), static_cast<std::streamsize>(writing_.size()));
+            std::cout.flush();
+#endif
+        }
+        write_pending_ = false;
+        co_return;
+    }
+
     void StdioTransport::close() {
-        running_ = false;
+        if (!running_.exchange(false)) {
+            return;
+        }
+        StdioTransport *expected = this;
+        active_transport.compare_exchange_strong(expected, nullptr);
+
+        work_guard_.reset();
+        io_context_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+        // Answers still queued are written out blocking, after the rest of the write stopped halfway
+        asio::error_code ec;
+        if (written_ < writing_.size() || !output_.empty()) {
+            output_descriptor_.non_blocking(false, ec);
+            asio::write(output_descriptor_, asio::buffer(writing_.data() + written_, writing_.size() - written_), ec);
+            asio::write(output_descriptor_, asio::buffer(output_), ec);
+        }
+        input_descriptor_.close(ec);
+        output_descriptor_.close(ec);
+
+        // The descriptors share their open file with stdin and stdout, leave those as they were
+        if (input_flags_ != -1) {
+            ::fcntl(STDIN_FILENO, F_SETFL, input_flags_);
+        }
+        if (output_flags_ != -1) {
+            ::fcntl(STDOUT_FILENO, F_SETFL, output_flags_);
+        }
+#else
+        if (reader_.joinable()) {
+            reader_.detach();// Blocked in getline until stdin closes
+        }
+#endif
     }
 
-}// namespace mcp::transport
\ No newline at end of file
+}// namespace mcp::transport
@@ -1,8 +1,21 @@
 // src/transport/stdio_transport.h
 #pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 // Forward declarations
 namespace mcp::business {
@@ -11,17 +24,111 @@ namespace mcp::business {
 
 namespace mcp::transport {
 
+    /**
+     * @brief Settings of the stdio transport.
+     * Configured once at startup from the [server] config section, before the transport opens.
+     */
+    struct StdioOptions {
+        size_t read_buffer_size = 64 * 1024;///< Bytes read from stdin at once; longer lines grow the buffer
+        size_t max_in_flight = 64;          ///< Messages handled at once, reading pauses beyond; 1 handles them one by one
+
+        /**
+         * @brief Set the process-wide options. Call before opening the transport.
+         * @param options New options
+         */
+        static void configure(const StdioOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const StdioOptions &current();
+    };
+
+    /**
+     * @brief Newline-delimited JSON-RPC over stdin and stdout.
+     *
+     * Runs on its own io_context and thread. On POSIX systems stdin and stdout are driven by
+     * asio as non-blocking descriptors; elsewhere a blocking thread reads stdin. Input is read
+     * in large chunks and split into lines with memchr. Messages are handled concurrently, up
+     * to StdioOptions::max_in_flight, but their answers are written in the order the messages
+     * arrived. Answers that complete while a write is in flight are sent together with the
+     * next write, so stdout is written once per batch instead of flushed per message.
+     */
     class StdioTransport {
     public:
-        explicit StdioTransport(std::shared_ptr<mcp::business::ToolRegistry> registry = nullptr);
-        using MessageCallback = std::function<void(const std::string &)>;
+        /**
+         * @brief Handles one message.
+         * The message stays valid until the returned awaitable completes.
+         * @return Answer to write, empty for none
+         */
+        using MessageCallback = std::function<asio::awaitable<std::string>(std::string_view message)>;
+
+        explicit StdioTransport(std::shared_ptr<mcp::business::ToolRegistry> registry = nullptr,
+                                const StdioOptions &options = StdioOptions::current());
+        ~StdioTransport();
+
+        StdioTransport(const StdioTransport &) = delete;
+        StdioTransport &operator=(const StdioTransport &) = delete;
+
         bool open(MessageCallback on_message);
         void close();
+
+        /**
+         * @brief Write a message that answers no request, such as a notification. Thread-safe.
+         * It goes out after the answers already written, ahead of those still pending.
+         */
         bool write(const std::string &message);
 
+        /**
+         * @brief The open stdio transport, for messages sent outside of a request (notifications).
+         * @return Transport, nullptr if none is open
+         */
+        static StdioTransport *active();
+
     private:
-        bool running_ = false;
+        asio::awaitable<void> read_loop();
+        bool scan_lines();                                  ///< Dispatch buffered lines, true if stopped at max_in_flight
+        void append_input(const char *data, size_t size);   ///< Add bytes read from stdin to input_
+        void end_input();                                   ///< Stdin closed, dispatch a last unterminated line
+        void dispatch(std::string line);                    ///< Start handling a message
+        void complete(uint64_t sequence, std::string reply);///< Release answers in arrival order
+        void queue_output(std::string_view message);
+        asio::awaitable<void> write_loop();
+
+        std::atomic<bool> running_ = false;
         std::shared_ptr<mcp::business::ToolRegistry> registry_;
+        StdioOptions options_;
+        MessageCallback on_message_;
+
+        asio::io_context io_context_;
+        asio::executor_work_guard<asio::io_context::executor_type> work_guard_{asio::make_work_guard(io_context_)};
+        std::thread thread_;
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+        asio::posix::stream_descriptor input_descriptor_{io_context_};
+        asio::posix::stream_descriptor output_descriptor_{io_context_};
+        int input_flags_ = -1; ///< fcntl flags of stdin before it was made non-blocking
+        int output_flags_ = -1;///< fcntl flags of stdout before it was made non-blocking
+#else
+        std::thread reader_;///< Blocking reads of stdin, handed to io_context_
+#endif
+
+        std::vector<char> input_;///< Bytes read but not yet split into lines
+        size_t input_begin_ = 0;
+        size_t input_end_ = 0;
+        size_t input_scanned_ = 0;///< input_[input_begin_, input_scanned_) holds no newline
+        bool input_closed_ = false;///< Stdin reached end of file
+
+        uint64_t next_sequence_ = 0;            ///< Sequence number of the next message read
+        uint64_t next_output_ = 0;              ///< Sequence number of the next answer to write
+        std::map<uint64_t, std::string> held_;  ///< Answers waiting for an earlier one
+        size_t in_flight_ = 0;                  ///< Messages being handled
+        asio::steady_timer slot_timer_{io_context_};///< Cancelled when a message is done
+
+        std::string output_; ///< Answers waiting for the write in flight
+        std::string writing_;///< Answers being written
+        size_t written_ = 0; ///< Bytes of writing_ already written
+        bool write_pending_ = false;
     };
 
-}// namespace mcp::transport
\ No newline at end of file
+}// namespace mcp::transport
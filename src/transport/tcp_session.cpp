@@ -1,72 +1,137 @@
 #include "tcp_session.h"
+#include "cluster.h"
+#include "connection_timeouts.h"
+#include "core/frame_pool.hpp"
+#include "core/io_context_pool.hpp"
 #include "core/logger.h"
+#include "http_framer.h"
 #include "http_handler.h"
-#include "utils/session_id.h"
+#include "metrics/metrics_manager.h"
+#include "socket_options.h"
+#include <type_traits>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#endif
 
 
 using asio::use_awaitable;
 
 namespace mcp::transport {
 
-    TcpSession::TcpSession(asio::ip::tcp::socket socket)
-        : socket_(std::move(socket)) {
-        session_id_ = utils::generate_session_id();// Generate ID from base class helper
+    namespace {
+        /**
+         * @brief Timeout counters shared by the sessions of a listener.
+         */
+        template<typename Protocol>
+        metrics::ConnectionTimeoutCounters *timeout_counters() {
+            static const auto counters = metrics::MetricsManager::getInstance()->register_connection_timeout_counters(
+                    std::is_same_v<Protocol, asio::ip::tcp> ? "http" : "unix");
+            return counters.get();
+        }
+
+        /**
+         * @brief Live session gauge of a protocol.
+         */
+        template<typename Protocol>
+        std::atomic<int64_t> &live_sessions() {
+            auto &gauges = metrics::MetricsManager::getInstance()->runtime_gauges();
+            return std::is_same_v<Protocol, asio::ip::tcp> ? gauges.tcp_sessions : gauges.unix_sessions;
+        }
+    }// namespace
+
+    template<typename Protocol>
+    StreamSession<Protocol>::StreamSession(socket_type socket)
+        : live_(live_sessions<Protocol>()), socket_(std::move(socket)) {
+        session_id_ = Cluster::instance().mint_session_id();// Owned by this node in cluster mode
+        if constexpr (std::is_same_v<Protocol, asio::ip::tcp>) {
+            SocketOptions::current().apply(socket_);// TCP_NODELAY and buffer sizes mean nothing locally
+        }
     }
 
     /**
-     * @brief Start the TCP session and begin reading requests.
+     * @brief Start the session and begin reading requests.
      * @param handler HTTP handler for processing requests
      */
-    asio::awaitable<void> TcpSession::start(HttpHandler *handler) {
+    template<typename Protocol>
+    asio::awaitable<void> StreamSession<Protocol>::start(HttpHandler *handler) {
+        auto active = IOServiceActivity::CountSession();
         try {
-            std::string request_buffer;
+            HttpRequestFramer framer;
+            // Connections that stall while sending a request, or idle too long between
+            // requests, are closed by their io_context's timer wheel
+            ConnectionDeadline deadline(socket_.get_executor(), timeout_counters<Protocol>(), [this]() {
+                MCP_DEBUG("Closing stalled connection (Session: {})", session_id_);
+                close();
+            });
+            bool first_request = true;
+            UploadScan upload = UploadScan::NeedMore;
             while (socket_.is_open()) {
-                // Read data from socket
-                auto n = co_await socket_.async_read_some(asio::buffer(buffer_), use_awaitable);
-                if (n == 0) break;// Connection closed gracefully
+                deadline.enter(read_phase(framer.buffered(), framer.headers_complete(), first_request));
 
-                // Append new data to request buffer
-                request_buffer.append(buffer_.data(), n);
+                // An idle connection waits for readability without holding a read buffer
+                if (framer.buffered() == 0) {
+                    co_await socket_.async_wait(socket_type::wait_read, core::pooled(use_awaitable));
+                }
 
-                // Check for complete HTTP requests
-                while (!request_buffer.empty()) {
-                    size_t header_end = request_buffer.find("\r\n\r\n");
-                    if (header_end == std::string::npos) {
-                        break;// Incomplete headers - wait for more data
-                    }
+                // Read directly into the framer's buffer
+                auto n = co_await socket_.async_read_some(framer.prepare(), core::pooled(use_awaitable));
+                if (n == 0) break;// Connection closed gracefully
+                framer.commit(n);
 
-                    // Parse Content-Length header
-                    size_t content_length = 0;
-                    size_t content_length_pos = request_buffer.find("Content-Length:");
-                    if (content_length_pos != std::string::npos && content_length_pos < header_end) {
-                        size_t value_start = content_length_pos + 16;// After "Content-Length:"
-                        size_t value_end = request_buffer.find_first_of("\r\n", value_start);
-                        if (value_end != std::string::npos) {
-                            std::string length_str = request_buffer.substr(value_start, value_end - value_start);
-                            length_str.erase(0, length_str.find_first_not_of(" \t"));
-                            length_str.erase(length_str.find_last_not_of(" \t") + 1);
-                            try {
-                                content_length = std::stoull(length_str);
-                            } catch (...) {
-                                content_length = 0;// Handle invalid length
+                // Dispatch every complete request that is buffered
+                bool malformed = false;
+                bool upgraded = false;
+                while (true) {
+                    auto status = framer.next();
+                    if (status == HttpRequestParser::Status::Incomplete) {
+                        // A large tools/call body may go to its plugin while it arrives
+                        if (upload == UploadScan::NeedMore && framer.headers_complete()) {
+                            StreamedArgument argument;
+                            upload = handler->scan_upload(framer, argument);
+                            if (upload == UploadScan::Streamed) {
+                                deadline.enter(ConnectionPhase::Handling);
+                                first_request = false;
+                                bool finished = co_await handler->handle_upload(shared_from_this(), framer, std::move(argument), deadline);
+                                co_await flush_pending_writes();
+                                upload = UploadScan::NeedMore;
+                                malformed = !finished;// Framing is lost with the rest of the body unread
                             }
                         }
+                        break;// Wait for more data
                     }
+                    // Answering takes as long as it takes, the client is not the one stalling
+                    deadline.enter(ConnectionPhase::Handling);
+                    first_request = false;
+                    if (status == HttpRequestParser::Status::Error) {
+                        // Framing is lost, answer once and drop the connection
+                        co_await handler->handle_request(shared_from_this(), nullptr, framer.buffered());
+                        malformed = true;
+                        break;
+                    }
+                    co_await handler->handle_request(shared_from_this(), &framer.request(), framer.request_size());
+                    framer.consume();
+                    upload = UploadScan::NeedMore;
+
+                    // Answer before the next pipelined request so responses keep request order
+                    co_await flush_pending_writes();
 
-                    // Check if request is complete
-                    size_t total_required = header_end + 4 + content_length;// +4 for "\r\n\r\n"
-                    if (request_buffer.length() >= total_required) {
-                        std::string complete_request = request_buffer.substr(0, total_required);
-                        co_await handler->handle_request(shared_from_this(), complete_request);
-                        request_buffer.erase(0, total_required);// Remove processed data
-                    } else {
-                        break;// Incomplete request - wait for more data
+                    if (auto upgrade = take_upgrade()) {
+                        // The connection speaks another protocol from here on
+                        std::string buffered = framer.unconsumed();
+                        co_await upgrade(std::move(buffered));
+                        upgraded = true;
+                        break;
                     }
                 }
+                if (malformed || upgraded) break;
             }
         } catch (const std::exception &e) {
             if (!closed_) {
-                MCP_WARN("TCP Session read error: {}", e.what());
+                MCP_WARN("Stream session read error: {}", e.what());
             }
         }
         close();// Ensure session is closed
@@ -74,87 +139,150 @@ namespace mcp::transport {
     }
 
     /**
-     * @brief Write data to the TCP socket.
-     * @param message Data to send to client
+     * @brief Read from the socket, for a protocol that took the connection over.
+     * @param buffer Buffer to read into
+     */
+    template<typename Protocol>
+    asio::awaitable<size_t> StreamSession<Protocol>::read_some(asio::mutable_buffer buffer) {
+        return socket_.async_read_some(buffer, core::pooled(use_awaitable));
+    }
+
+    /**
+     * @brief Wait for the socket to become readable, which means the client closed it.
      */
-    asio::awaitable<void> TcpSession::write(const std::string &message) {
+    template<typename Protocol>
+    asio::awaitable<void> StreamSession<Protocol>::wait_for_disconnect() {
+        asio::error_code ec;
+        co_await socket_.async_wait(socket_type::wait_read, core::pooled(asio::redirect_error(use_awaitable, ec)));
+    }
+
+    /**
+     * @brief Write several buffers to the socket with a single gather write.
+     * @param buffers Buffers to send, in order
+     */
+    template<typename Protocol>
+    asio::awaitable<void> StreamSession<Protocol>::write_now(std::span<const asio::const_buffer> buffers) {
         if (!socket_.is_open()) {
             co_return;
         }
         try {
-            // Clear any pending data in the socket buffer
-            std::array<char, 8192> discard_buf;
-            asio::error_code ec;
-            while (socket_.available(ec) > 0 && !ec) {
-                socket_.read_some(asio::buffer(discard_buf), ec);
-            }
-
-            // Send the message
-            co_await asio::async_write(socket_, asio::buffer(message), use_awaitable);
+            // Pending input is left alone, it may hold the next pipelined request
+            co_await asio::async_write(socket_, buffers, core::pooled(use_awaitable));
         } catch (const std::exception &e) {
-            MCP_ERROR("Failed to write to TCP socket: {}", e.what());
+            MCP_ERROR("Failed to write to socket: {}", e.what());
             close();
         }
         co_return;
     }
 
+#if defined(__linux__)
     /**
-     * @brief Stream write data to the TCP socket.
-     * @param message Data to send to client
-     * @param flush Whether to flush the data immediately
+     * @brief Send a range of a file with sendfile(2), so its bytes go from the page cache to the socket
+     * without passing through user space. Falls back to the mapped bytes where the file cannot be sent
+     * from its descriptor. On a Unix domain socket a slice with pass_descriptor sends its bytes with the
+     * descriptor itself attached instead.
+     * @param file Range to send
      */
-    asio::awaitable<void> TcpSession::stream_write(const std::string &message, bool flush) {
+    template<typename Protocol>
+    asio::awaitable<void> StreamSession<Protocol>::write_file_now(const FileSlice &file) {
+        if (file.fd < 0) {
+            co_await Session::write_file_now(file);
+            co_return;
+        }
         if (!socket_.is_open()) {
             co_return;
         }
-        try {
-            // Send the message without clearing the buffer to allow streaming
-            co_await asio::async_write(socket_, asio::buffer(message), use_awaitable);
+        if (file.pass_descriptor && can_pass_descriptors()) {
+            try {
+                // The descriptor travels with the first byte sent; the rest goes out as usual
+                socket_.native_non_blocking(true);
+                alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+                iovec iov{const_cast<char *>(file.bytes.data()), file.bytes.size()};
+                msghdr message{};
+                message.msg_iov = &iov;
+                message.msg_iovlen = 1;
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+                cmsghdr *header = CMSG_FIRSTHDR(&message);
+                header->cmsg_level = SOL_SOCKET;
+                header->cmsg_type = SCM_RIGHTS;
+                header->cmsg_len = CMSG_LEN(sizeof(int));
+                std::memcpy(CMSG_DATA(header), &file.fd, sizeof(int));
 
-            // If flush is requested, ensure data is sent immediately
-            if (flush) {
-                // The async_write operation already flushes, so no additional action needed
+                ssize_t sent;
+                while ((sent = ::sendmsg(socket_.native_handle(), &message, MSG_NOSIGNAL)) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        throw std::system_error(errno, std::generic_category(), "sendmsg");
+                    }
+                    co_await socket_.async_wait(socket_type::wait_write, core::pooled(use_awaitable));
+                }
+                if (static_cast<size_t>(sent) < file.bytes.size()) {
+                    asio::const_buffer rest = asio::buffer(file.bytes.substr(static_cast<size_t>(sent)));
+                    co_await write_now(std::span<const asio::const_buffer>(&rest, 1));
+                }
+            } catch (const std::exception &e) {
+                MCP_ERROR("Failed to pass a descriptor over the socket: {}", e.what());
+                close();
+            }
+            co_return;
+        }
+        try {
+            // sendfile() on the non-blocking socket, waiting for room whenever the send buffer is full
+            socket_.native_non_blocking(true);
+            off_t offset = static_cast<off_t>(file.offset);
+            size_t left = file.bytes.size();
+            while (left > 0) {
+                ssize_t sent = ::sendfile(socket_.native_handle(), file.fd, &offset, left);
+                if (sent > 0) {
+                    left -= static_cast<size_t>(sent);
+                    continue;
+                }
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    co_await socket_.async_wait(socket_type::wait_write, core::pooled(use_awaitable));
+                    continue;
+                }
+                if (sent < 0 && (errno == EINVAL || errno == ENOSYS) && left == file.bytes.size()) {
+                    co_await Session::write_file_now(file);// A file system sendfile() does not support
+                    co_return;
+                }
+                // Nothing sent: the file got shorter than the range announced in the chunk
+                throw std::system_error(sent < 0 ? errno : EIO, std::generic_category(), "sendfile");
             }
         } catch (const std::exception &e) {
-            MCP_ERROR("Failed to stream write to TCP socket: {}", e.what());
+            MCP_ERROR("Failed to send file to socket: {}", e.what());
             close();
         }
-        co_return;
     }
+#endif
 
     /**
      * @brief Write a chunk of data as part of a streaming response.
      * @param chunk Data chunk to send to client
      */
-    asio::awaitable<void> TcpSession::write_chunk(const std::string &chunk) {
+    template<typename Protocol>
+    asio::awaitable<void> StreamSession<Protocol>::write_chunk(const std::string &chunk) {
         if (!socket_.is_open()) {
             co_return;
         }
-        try {
-            if (!streaming_) {
-                MCP_ERROR("Session is not in streaming mode");
-                co_return;
-            }
-
-            // For HTTP chunked transfer encoding, we need to send the chunk size followed by CRLF,
-            // then the chunk data followed by CRLF
-            std::ostringstream chunk_header;
-            chunk_header << std::hex << chunk.size() << "\r\n";
-
-            // Send chunk header
-            co_await asio::async_write(socket_, asio::buffer(chunk_header.str()), use_awaitable);
-
-            // Send chunk data
-            if (!chunk.empty()) {
-                co_await asio::async_write(socket_, asio::buffer(chunk), use_awaitable);
-            }
-
-            // Send trailing CRLF
-            co_await asio::async_write(socket_, asio::buffer("\r\n"), use_awaitable);
-        } catch (const std::exception &e) {
-            MCP_ERROR("Failed to write chunk to TCP socket: {}", e.what());
-            close();
+        if (!streaming_) {
+            MCP_ERROR("Session is not in streaming mode");
+            co_return;
         }
+
+        // For HTTP chunked transfer encoding, we need to send the chunk size followed by CRLF,
+        // then the chunk data followed by CRLF; all three go out in one gather write
+        ChunkSizeLine size_line(chunk.size());
+        std::array<asio::const_buffer, 3> buffers = {
+                size_line.buffer(),
+                asio::buffer(chunk),
+                asio::buffer("\r\n", 2)};
+        co_await write_buffers(buffers);
         co_return;
     }
 
@@ -162,32 +290,31 @@ namespace mcp::transport {
      * @brief Start a streaming response by sending appropriate headers.
      * @param content_type The content type for the streaming response
      */
-    asio::awaitable<void> TcpSession::start_streaming(const std::string &content_type) {
+    template<typename Protocol>
+    asio::awaitable<void> StreamSession<Protocol>::start_streaming(const std::string &content_type) {
         if (!socket_.is_open()) {
             co_return;
         }
-        try {
-            // Send HTTP response headers for chunked transfer
-            std::ostringstream headers;
-            headers << "HTTP/1.1 200 OK\r\n";
-            headers << "Content-Type: " << content_type << "\r\n";
-            headers << "Transfer-Encoding: chunked\r\n";
-            headers << "Connection: keep-alive\r\n";
-            headers << "\r\n";
-
-            co_await asio::async_write(socket_, asio::buffer(headers.str()), use_awaitable);
+        // Send HTTP response headers for chunked transfer
+        std::ostringstream headers;
+        headers << "HTTP/1.1 200 OK\r\n";
+        headers << "Content-Type: " << content_type << "\r\n";
+        headers << "Transfer-Encoding: chunked\r\n";
+        headers << "Connection: keep-alive\r\n";
+        headers << "\r\n";
+
+        co_await write(headers.str());
+        if (!is_closed()) {
             streaming_ = true;
-        } catch (const std::exception &e) {
-            MCP_ERROR("Failed to start streaming: {}", e.what());
-            close();
         }
         co_return;
     }
 
     /**
-     * @brief Close the TCP session and release resources.
+     * @brief Close the session and release resources.
      */
-    void TcpSession::close() {
+    template<typename Protocol>
+    void StreamSession<Protocol>::close() {
         if (!closed_ && socket_.is_open()) {
             // If in streaming mode, send the final chunk (0-length chunk)
             if (streaming_) {
@@ -200,36 +327,27 @@ namespace mcp::transport {
             // Cancel pending operations
             socket_.cancel(ec);
 
-            // Read remaining data
-            std::array<char, 8192> discard_buf;
-            while (socket_.available(ec) > 0 && !ec) {
-                socket_.read_some(asio::buffer(discard_buf), ec);
-            }
-
             // Shutdown and close socket
-            socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            socket_.shutdown(socket_type::shutdown_both, ec);
             socket_.close(ec);
 
-            // Clear buffer for security
-            std::fill(buffer_.begin(), buffer_.end(), static_cast<char>(0));
             closed_ = true;
             streaming_ = false;
         }
     }
 
-    /**
-     * @brief Clear the read buffer.
-     */
-    void TcpSession::clear_buffer() {
-        std::fill(buffer_.begin(), buffer_.end(), static_cast<char>(0));
-    }
-
     /**
      * @brief Check if the session is closed.
      * @return True if closed, false otherwise
      */
-    bool TcpSession::is_closed() const {
+    template<typename Protocol>
+    bool StreamSession<Protocol>::is_closed() const {
         return closed_ || !socket_.is_open();
     }
 
+    template class StreamSession<asio::ip::tcp>;
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+    template class StreamSession<asio::local::stream_protocol>;
+#endif
+
 }// namespace mcp::transport
\ No newline at end of file
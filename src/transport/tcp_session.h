@@ -1,34 +1,57 @@
 #pragma once
 
+#include "metrics/metrics_manager.h"
 #include "session.h"
+#include <type_traits>
 
 namespace mcp::transport {
 
     /**
-     * @brief Regular TCP session implementation for HTTP connections.
+     * @brief Plain stream session for HTTP connections, over TCP or a Unix domain socket.
+     * @tparam Protocol Stream protocol of the socket (asio::ip::tcp, asio::local::stream_protocol)
      */
-    class TcpSession : public Session {
+    template<typename Protocol>
+    class StreamSession : public Session {
     public:
-        explicit TcpSession(asio::ip::tcp::socket socket);
-        ~TcpSession() = default;
+        using socket_type = typename Protocol::socket;
+
+        explicit StreamSession(socket_type socket);
+        ~StreamSession() = default;
 
         asio::awaitable<void> start(HttpHandler *handler) override;
-        asio::awaitable<void> write(const std::string &message) override;
-        asio::awaitable<void> stream_write(const std::string &message, bool flush = true) override;
 
         asio::awaitable<void> write_chunk(const std::string &chunk);
         asio::awaitable<void> start_streaming(const std::string &content_type = "application/json");
 
         void close() override;
-        void clear_buffer() override;
         bool is_closed() const override;
-        asio::ip::tcp::socket &get_socket() override { return socket_; }
-        std::array<char, 8192> &get_buffer() override { return buffer_; }
+        asio::awaitable<size_t> read_some(asio::mutable_buffer buffer) override;
+        asio::any_io_executor get_executor() override { return socket_.get_executor(); }
+        asio::awaitable<void> wait_for_disconnect() override;
+        socket_type &get_socket() { return socket_; }
         const std::string &get_session_id() const override { return session_id_; }
+#if defined(__linux__) && defined(ASIO_HAS_LOCAL_SOCKETS)
+        bool can_pass_descriptors() const override { return std::is_same_v<Protocol, asio::local::stream_protocol>; }
+#endif
+
+    protected:
+        asio::awaitable<void> write_now(std::span<const asio::const_buffer> buffers) override;
+#if defined(__linux__)
+        asio::awaitable<void> write_file_now(const FileSlice &file) override;
+#endif
 
     private:
-        asio::ip::tcp::socket socket_;///< Underlying TCP socket
-        bool streaming_ = false;      ///< Flag indicating if session is in streaming mode
+        metrics::GaugeHold live_;///< Counts the session in RuntimeGauges while it exists
+        socket_type socket_;     ///< Underlying socket
+        bool streaming_ = false; ///< Flag indicating if session is in streaming mode
     };
 
+    using TcpSession = StreamSession<asio::ip::tcp>;///< Regular TCP session for HTTP connections
+    extern template class StreamSession<asio::ip::tcp>;
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+    using UnixSession = StreamSession<asio::local::stream_protocol>;///< HTTP over a Unix domain socket
+    extern template class StreamSession<asio::local::stream_protocol>;
+#endif
+
 }// namespace mcp::transport
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "tenants.h"
+#include "Auth/AuthManager.hpp"
+#include "admission_controller.h"
+#include "core/logger.h"
+#include <unordered_set>
+
+namespace mcp::transport {
+
+    namespace {
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+            while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+            return text;
+        }
+    }// namespace
+
+    std::unordered_map<std::string, std::string> TenantOptions::parse_credentials(std::string_view text) {
+        std::unordered_map<std::string, std::string> credentials;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = trim(text.substr(0, comma));
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+            if (item.empty()) {
+                continue;
+            }
+
+            size_t equals = item.find('=');
+            std::string_view name = trim(item.substr(0, equals));
+            if (equals == std::string_view::npos || name.empty()) {
+                MCP_WARN("Ignoring invalid tenant entry '{}'", item);
+                continue;
+            }
+            std::string_view keys = item.substr(equals + 1);
+            while (!keys.empty()) {
+                size_t bar = keys.find('|');
+                std::string_view key = trim(keys.substr(0, bar));
+                keys = bar == std::string_view::npos ? std::string_view{} : keys.substr(bar + 1);
+                if (key.empty()) {
+                    continue;
+                }
+                auto [it, inserted] = credentials.emplace(key, name);
+                if (!inserted && it->second != name) {
+                    MCP_WARN("A credential is listed for tenants '{}' and '{}', it stays with '{}'", it->second, name, it->second);
+                }
+            }
+        }
+        return credentials;
+    }
+
+    std::unordered_map<std::string, size_t> TenantOptions::parse_limits(std::string_view text) {
+        // Same "name=number" list as the tool limits
+        return AdmissionOptions::parse_tool_limits(text);
+    }
+
+    Tenants &Tenants::instance() {
+        static Tenants tenants;
+        return tenants;
+    }
+
+    Tenants::Tenants() : options_(std::make_shared<const TenantOptions>()) {}
+
+    void Tenants::configure(const TenantOptions &options) {
+        options_.store(std::make_shared<const TenantOptions>(options), std::memory_order_release);
+        if (!options.credentials.empty()) {
+            std::unordered_set<std::string_view> names;
+            for (const auto &[credential, name]: options.credentials) {
+                names.insert(name);
+            }
+            MCP_INFO("{} named tenants with {} credentials", names.size(), options.credentials.size());
+        }
+    }
+
+    std::string Tenants::name_of(const HeaderMap &headers, const AuthDecision *decision) const {
+        auto options = this->options();
+        if (options->credentials.empty()) {
+            return {};
+        }
+        auto lookup = [&](std::string_view credential) -> const std::string * {
+            if (credential.empty()) {
+                return nullptr;
+            }
+            auto it = options->credentials.find(std::string(credential));
+            return it != options->credentials.end() ? &it->second : nullptr;
+        };
+        // The credential the connection was authenticated with is what the auth manager checked
+        if (decision && decision->manager) {
+            if (auto name = lookup(decision->credential)) {
+                return *name;
+            }
+        }
+        if (auto name = lookup(headers.get("X-API-Key"))) {
+            return *name;
+        }
+        if (auto name = lookup(bearer_token(headers))) {
+            return *name;
+        }
+        return {};
+    }
+
+}// namespace mcp::transport
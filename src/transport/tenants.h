@@ -0,0 +1,76 @@
+#pragma once
+
+#include "header_map.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct AuthDecision;
+
+namespace mcp::transport {
+
+    /**
+     * @brief Named tenants, normally taken from the [concurrency] config section. What each one
+     *        gets is set with the options of the fair scheduler and of the tenant rate limit.
+     */
+    struct TenantOptions {
+        std::unordered_map<std::string, std::string> credentials;///< API key or bearer token -> tenant name
+
+        bool operator==(const TenantOptions &) const = default;
+
+        /**
+         * @brief Parse a tenant list such as "batch=key-1|key-2,ide=key-3".
+         * @param text Tenant list, empty for none
+         * @return Each credential mapped to the name of its tenant
+         */
+        static std::unordered_map<std::string, std::string> parse_credentials(std::string_view text);
+
+        /**
+         * @brief Parse a per-tenant number list such as "batch=2,ide=8".
+         * @param text Number list, empty for none
+         * @return Tenant name mapped to its number
+         */
+        static std::unordered_map<std::string, size_t> parse_limits(std::string_view text);
+    };
+
+    /**
+     * @brief The named tenants requests belong to.
+     *
+     * By default every API key, token or session is a tenant of its own. Credentials listed here
+     * are grouped under a name instead, so all the keys of a team or a product share one weight
+     * and one cap in the fair scheduler and one rate limit over the cluster, and are reported
+     * together. A request belongs to the tenant of the credential its connection was
+     * authenticated with, or, without authentication, of the X-API-Key or bearer token it carries.
+     * Usage per named tenant is counted in MetricsManager's tenant counters.
+     */
+    class Tenants {
+    public:
+        static Tenants &instance();
+
+        /**
+         * @brief Set the tenants, at startup or on a config reload.
+         */
+        void configure(const TenantOptions &options);
+
+        /**
+         * @brief The options in effect; a snapshot that stays valid across reloads.
+         */
+        std::shared_ptr<const TenantOptions> options() const { return options_.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Name of the tenant a request belongs to.
+         * @param headers Request headers
+         * @param decision Credential accepted on the connection, if any
+         * @return Tenant name, empty if the credential is not listed
+         */
+        std::string name_of(const HeaderMap &headers, const AuthDecision *decision) const;
+
+    private:
+        Tenants();
+
+        std::atomic<std::shared_ptr<const TenantOptions>> options_;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,199 @@
+#include "tls_options.h"
+#include "core/logger.h"
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <stdexcept>
+
+namespace mcp::transport {
+
+    namespace {
+        TlsOptions &options_storage() {
+            static TlsOptions options;
+            return options;
+        }
+
+        constexpr unsigned char kSessionIdContext[] = "mcp-https";
+
+        /**
+         * @brief One session ticket key: the name sent in the ticket, AES-256 and HMAC-SHA256 keys.
+         */
+        struct TicketKey {
+            std::array<unsigned char, 16> name{};
+            std::array<unsigned char, 32> aes{};
+            std::array<unsigned char, 32> hmac{};
+
+            static TicketKey generate() {
+                TicketKey key;
+                if (RAND_bytes(key.name.data(), key.name.size()) != 1 ||
+                    RAND_bytes(key.aes.data(), key.aes.size()) != 1 ||
+                    RAND_bytes(key.hmac.data(), key.hmac.size()) != 1) {
+                    throw std::runtime_error("Failed to generate a TLS session ticket key");
+                }
+                return key;
+            }
+
+            void cleanse() {
+                OPENSSL_cleanse(aes.data(), aes.size());
+                OPENSSL_cleanse(hmac.data(), hmac.size());
+            }
+        };
+
+        /**
+         * @brief Current and previous ticket key of a context.
+         * New tickets use the current key; tickets of the previous key are still accepted and
+         * renewed. Keys are rotated lazily by the first handshake after the interval ran out.
+         */
+        class TicketKeyRing {
+        public:
+            explicit TicketKeyRing(std::chrono::seconds rotation)
+                : rotation_(rotation), current_(TicketKey::generate()), rotated_at_(std::chrono::steady_clock::now()) {}
+
+            ~TicketKeyRing() {
+                current_.cleanse();
+                previous_.cleanse();
+            }
+
+            TicketKey encryption_key() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto now = std::chrono::steady_clock::now();
+                if (now - rotated_at_ >= rotation_) {
+                    previous_.cleanse();
+                    previous_ = current_;
+                    has_previous_ = true;
+                    current_ = TicketKey::generate();
+                    rotated_at_ = now;
+                    MCP_DEBUG("Rotated TLS session ticket key");
+                }
+                return current_;
+            }
+
+            /**
+             * @brief Find the key a ticket was encrypted with.
+             * @return 1 for the current key, 2 for the previous one (renew the ticket), 0 if unknown
+             */
+            int decryption_key(const unsigned char *name, TicketKey &key) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (std::memcmp(name, current_.name.data(), current_.name.size()) == 0) {
+                    key = current_;
+                    return 1;
+                }
+                if (has_previous_ && std::memcmp(name, previous_.name.data(), previous_.name.size()) == 0) {
+                    key = previous_;
+                    return 2;
+                }
+                return 0;
+            }
+
+        private:
+            std::mutex mutex_;
+            std::chrono::seconds rotation_;
+            TicketKey current_;
+            TicketKey previous_;
+            bool has_previous_ = false;
+            std::chrono::steady_clock::time_point rotated_at_;
+        };
+
+        void free_key_ring(void *, void *ring, CRYPTO_EX_DATA *, int, long, void *) {
+            delete static_cast<TicketKeyRing *>(ring);
+        }
+
+        int key_ring_index() {
+            // Owned by the context: the ring is deleted together with it
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, &free_key_ring);
+            return index;
+        }
+
+        bool set_hmac_key(EVP_MAC_CTX *hmac_ctx, TicketKey &key) {
+            char digest[] = "SHA256";
+            OSSL_PARAM params[] = {
+                    OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, key.hmac.data(), key.hmac.size()),
+                    OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+                    OSSL_PARAM_construct_end()};
+            return EVP_MAC_CTX_set_params(hmac_ctx, params) == 1;
+        }
+
+        int ticket_key_callback(SSL *ssl, unsigned char *key_name, unsigned char *iv,
+                                EVP_CIPHER_CTX *cipher_ctx, EVP_MAC_CTX *hmac_ctx, int encrypt) {
+            auto *ring = static_cast<TicketKeyRing *>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), key_ring_index()));
+            if (!ring) {
+                return 0;
+            }
+
+            TicketKey key;
+            int result = 1;
+            try {
+                if (encrypt) {
+                    key = ring->encryption_key();
+                    if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) != 1) {
+                        return -1;
+                    }
+                    std::memcpy(key_name, key.name.data(), key.name.size());
+                    if (EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key.aes.data(), iv) != 1) {
+                        result = -1;
+                    }
+                } else {
+                    result = ring->decryption_key(key_name, key);
+                    if (result != 0 && EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key.aes.data(), iv) != 1) {
+                        result = -1;
+                    }
+                }
+                if (result > 0 && !set_hmac_key(hmac_ctx, key)) {
+                    result = -1;
+                }
+            } catch (const std::exception &e) {
+                MCP_ERROR("TLS session ticket key unavailable: {}", e.what());
+                result = -1;
+            }
+            key.cleanse();
+            return result;
+        }
+    }// namespace
+
+    void TlsOptions::configure(const TlsOptions &options) {
+        options_storage() = options;
+    }
+
+    const TlsOptions &TlsOptions::current() {
+        return options_storage();
+    }
+
+    void TlsOptions::apply(asio::ssl::context &context) const {
+        SSL_CTX *ctx = context.native_handle();
+
+        SSL_CTX_set_session_id_context(ctx, kSessionIdContext, sizeof(kSessionIdContext) - 1);
+        if (session_timeout_s > 0) {
+            SSL_CTX_set_timeout(ctx, session_timeout_s);
+        }
+        if (session_cache_size > 0) {
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(ctx, static_cast<long>(session_cache_size));
+        } else {
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        }
+
+        if (ticket_rotation_s > 0) {
+            SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+            SSL_CTX_set_ex_data(ctx, key_ring_index(), new TicketKeyRing(std::chrono::seconds(ticket_rotation_s)));
+            SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, &ticket_key_callback);
+            SSL_CTX_set_num_tickets(ctx, 1);// one reconnect per connection is the common case
+        } else {
+            // TLS 1.3 still hands out tickets, they only refer to the session cache then
+            SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+            SSL_CTX_set_num_tickets(ctx, session_cache_size > 0 ? 1 : 0);
+        }
+
+        // Replayable early data must never reach a tool call
+        SSL_CTX_set_max_early_data(ctx, 0);
+        SSL_CTX_set_recv_max_early_data(ctx, 0);
+
+        MCP_INFO("TLS session resumption: cache {} sessions, tickets {}, lifetime {}s",
+                 session_cache_size, ticket_rotation_s > 0 ? "rotated every " + std::to_string(ticket_rotation_s) + "s" : std::string("off"),
+                 session_timeout_s);
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,51 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+#include <cstddef>
+
+namespace mcp::transport {
+
+    /**
+     * @brief TLS session resumption settings of the HTTPS listener.
+     * Configured once at startup from the [server] config section, before the HTTPS
+     * transport is created; the transport applies them to its SSL context.
+     *
+     * Resumed handshakes skip the certificate signature and key exchange, which is most
+     * of the CPU cost of a TLS connection. Both mechanisms are enabled: a server-side
+     * session cache (TLS 1.2 session IDs, stateful TLS 1.3 tickets when tickets are off)
+     * and session tickets encrypted with keys that rotate in memory. A ticket stays valid
+     * for one rotation after its key was replaced, and is renewed when it is used then.
+     * TLS 1.3 early data (0-RTT) is always rejected: every MCP request is a POST that may
+     * run a tool, and early data can be replayed by anyone who captured it.
+     */
+    struct TlsOptions {
+        size_t session_cache_size = 20480;///< Sessions kept in the server-side cache, 0 = no cache
+        long session_timeout_s = 7200;    ///< Lifetime of cached sessions and tickets in seconds
+        long ticket_rotation_s = 3600;    ///< Seconds a ticket key encrypts new tickets, 0 = no tickets
+
+        /**
+         * @brief Set the process-wide options. Call before starting the HTTPS transport.
+         * @param options New options
+         */
+        static void configure(const TlsOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const TlsOptions &current();
+
+        /**
+         * @brief Enable session caching and ticket key rotation on a server context.
+         * The ticket keys live as long as the context does.
+         * @param context Server context, before the first handshake
+         */
+        void apply(asio::ssl::context &context) const;
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,274 @@
+#include "traffic_capture.h"
+#include "core/logger.h"
+#include "http_handler.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace mcp::transport {
+
+    namespace {
+        constexpr size_t kWriteBatch = 64;                        ///< Queued requests that wake the writer early
+        constexpr std::chrono::milliseconds kFlushInterval{200}; ///< Longest time a request waits to be written
+        constexpr uint32_t kMaxRecord = 256 * 1024 * 1024;       ///< Larger sizes mean a damaged file
+
+        void put_u32(std::string &out, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out += static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+        }
+
+        void put_u64(std::string &out, uint64_t value) {
+            for (int i = 0; i < 8; ++i) {
+                out += static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+        }
+
+        void put_string(std::string &out, std::string_view value) {
+            put_u32(out, static_cast<uint32_t>(value.size()));
+            out += value;
+        }
+
+        uint64_t get_uint(std::string_view &in, size_t bytes) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+            }
+            in.remove_prefix(bytes);
+            return value;
+        }
+
+        bool get_string(std::string_view &in, std::string &value) {
+            if (in.size() < 4) {
+                return false;
+            }
+            size_t size = get_uint(in, 4);
+            if (in.size() < size) {
+                return false;
+            }
+            value.assign(in.substr(0, size));
+            in.remove_prefix(size);
+            return true;
+        }
+
+        bool equals_ignoring_case(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                       return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+                   });
+        }
+
+        void redact(nlohmann::json &value, const std::vector<std::string> &fields) {
+            if (value.is_object()) {
+                for (auto it = value.begin(); it != value.end(); ++it) {
+                    bool secret = std::any_of(fields.begin(), fields.end(), [&](const std::string &field) { return equals_ignoring_case(it.key(), field); });
+                    if (secret) {
+                        *it = "[redacted]";
+                    } else {
+                        redact(*it, fields);
+                    }
+                }
+            } else if (value.is_array()) {
+                for (auto &element: value) {
+                    redact(element, fields);
+                }
+            }
+        }
+
+        /**
+         * @brief Blank the redacted members of a JSON body; other bodies are kept as they are.
+         */
+        void redact_body(std::string &body, const std::vector<std::string> &fields) {
+            if (fields.empty() || body.empty()) {
+                return;
+            }
+            auto json = nlohmann::json::parse(body, nullptr, false);
+            if (json.is_discarded()) {
+                return;
+            }
+            redact(json, fields);
+            body = json.dump();
+        }
+    }// namespace
+
+    std::vector<std::string> TrafficCaptureOptions::parse_fields(std::string_view text) {
+        std::vector<std::string> fields;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view field = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+            while (!field.empty() && std::isspace(static_cast<unsigned char>(field.front()))) {
+                field.remove_prefix(1);
+            }
+            while (!field.empty() && std::isspace(static_cast<unsigned char>(field.back()))) {
+                field.remove_suffix(1);
+            }
+            if (!field.empty()) {
+                fields.emplace_back(field);
+            }
+        }
+        return fields;
+    }
+
+    void encode_captured_request(const CapturedRequest &request, std::string &out) {
+        size_t start = out.size();
+        put_u32(out, 0);
+        put_u64(out, request.offset_us);
+        put_string(out, request.connection);
+        put_string(out, request.method);
+        put_string(out, request.target);
+        put_string(out, request.mcp_session_id);
+        put_string(out, request.body);
+        // The size counts what follows it
+        auto size = static_cast<uint32_t>(out.size() - start - 4);
+        for (int i = 0; i < 4; ++i) {
+            out[start + static_cast<size_t>(i)] = static_cast<char>((size >> (8 * i)) & 0xff);
+        }
+    }
+
+    CaptureReader::CaptureReader(const std::string &path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) {
+            throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        }
+        char magic[kCaptureMagic.size()];
+        if (std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic) || std::string_view(magic, sizeof(magic)) != kCaptureMagic) {
+            std::fclose(file_);
+            throw std::runtime_error(path + " is not a traffic capture");
+        }
+    }
+
+    CaptureReader::~CaptureReader() {
+        std::fclose(file_);
+    }
+
+    bool CaptureReader::next(CapturedRequest &request) {
+        char size_bytes[4];
+        if (std::fread(size_bytes, 1, sizeof(size_bytes), file_) != sizeof(size_bytes)) {
+            return false;
+        }
+        std::string_view size_view(size_bytes, sizeof(size_bytes));
+        auto size = static_cast<uint32_t>(get_uint(size_view, 4));
+        if (size < 8 || size > kMaxRecord) {
+            return false;
+        }
+        record_.resize(size);
+        if (std::fread(record_.data(), 1, size, file_) != size) {
+            return false;
+        }
+        std::string_view in = record_;
+        request.offset_us = get_uint(in, 8);
+        return get_string(in, request.connection) && get_string(in, request.method) && get_string(in, request.target) &&
+               get_string(in, request.mcp_session_id) && get_string(in, request.body);
+    }
+
+    TrafficCapture &TrafficCapture::instance() {
+        static TrafficCapture capture;
+        return capture;
+    }
+
+    TrafficCapture::~TrafficCapture() {
+        shutdown();
+    }
+
+    void TrafficCapture::start() {
+        const auto &options = TrafficCaptureOptions::current();
+        if (options.path.empty() || thread_.joinable()) {
+            return;
+        }
+        file_ = std::fopen(options.path.c_str(), "wb");
+        if (!file_ || std::fwrite(kCaptureMagic.data(), 1, kCaptureMagic.size(), file_) != kCaptureMagic.size()) {
+            MCP_WARN("Traffic capture disabled: cannot write {}: {}", options.path, std::strerror(errno));
+            if (file_) {
+                std::fclose(file_);
+                file_ = nullptr;
+            }
+            return;
+        }
+
+        stopping_ = false;
+        started_ = std::chrono::steady_clock::now();
+        enabled_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread([this]() { run(); });
+        MCP_INFO("Capturing requests to {} ({} fields redacted)", options.path, options.redact.size());
+    }
+
+    void TrafficCapture::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            stopping_ = true;
+        }
+        enabled_.store(false, std::memory_order_relaxed);
+        wake_.notify_one();
+        thread_.join();
+        std::fclose(file_);
+        file_ = nullptr;
+        MCP_INFO("Traffic capture closed: {} requests written, {} dropped", written(), dropped());
+    }
+
+    void TrafficCapture::record(const HttpRequest &request, const std::string &session_id) {
+        if (!enabled() || request.method.empty()) {
+            return;
+        }
+        CapturedRequest captured;
+        captured.offset_us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started_).count());
+        captured.connection = session_id;
+        captured.method = request.method;
+        captured.target = request.target;
+        captured.mcp_session_id = request.headers.get("Mcp-Session-Id");
+        captured.body = request.body;
+
+        bool batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.size() >= TrafficCaptureOptions::current().max_queue) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            queue_.push_back(std::move(captured));
+            batch = queue_.size() == kWriteBatch;
+        }
+        if (batch) {
+            wake_.notify_one();
+        }
+    }
+
+    void TrafficCapture::run() {
+        const auto &fields = TrafficCaptureOptions::current().redact;
+        std::vector<CapturedRequest> batch;
+        std::string bytes;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait_for(lock, kFlushInterval, [&]() { return stopping_ || queue_.size() >= kWriteBatch; });
+            if (queue_.empty()) {
+                if (stopping_) {
+                    return;
+                }
+                continue;
+            }
+            batch.swap(queue_);
+
+            // Redacted, encoded and written without the lock, requests keep queueing meanwhile
+            lock.unlock();
+            bytes.clear();
+            for (auto &request: batch) {
+                redact_body(request.body, fields);
+                encode_captured_request(request, bytes);
+            }
+            if (std::fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size() || std::fflush(file_) != 0) {
+                dropped_.fetch_add(batch.size(), std::memory_order_relaxed);
+            } else {
+                written_.fetch_add(batch.size(), std::memory_order_relaxed);
+            }
+            batch.clear();
+            lock.lock();
+        }
+    }
+
+}// namespace mcp::transport
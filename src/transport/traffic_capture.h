@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace mcp::transport {
+
+    struct HttpRequest;
+
+    /**
+     * @brief Capture of the requests served, for replaying them later with mcp_replay; normally
+     *        taken from the [server] config section.
+     */
+    struct TrafficCaptureOptions {
+        std::string path;                ///< File the capture is written to, empty = capture off
+        std::vector<std::string> redact; ///< JSON member names whose values are blanked, at any depth, compared without case
+        size_t max_queue = 4096;         ///< Requests waiting for the writer; more are dropped
+
+        /**
+         * @brief Parse a comma separated list of member names such as "password,token".
+         */
+        static std::vector<std::string> parse_fields(std::string_view text);
+
+        static const TrafficCaptureOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before any transport is created.
+         */
+        static void configure(const TrafficCaptureOptions &options) { storage() = options; }
+
+    private:
+        static TrafficCaptureOptions &storage() {
+            static TrafficCaptureOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief One request as it is stored in a capture file.
+     */
+    struct CapturedRequest {
+        uint64_t offset_us = 0;    ///< Arrival, in microseconds since the capture started
+        std::string connection;    ///< Transport session the request came on
+        std::string method;        ///< HTTP method
+        std::string target;        ///< Request target
+        std::string mcp_session_id;///< Mcp-Session-Id header, empty if it had none
+        std::string body;          ///< Body, redacted
+    };
+
+    /**
+     * @brief Magic number a capture file starts with.
+     */
+    inline constexpr std::string_view kCaptureMagic = "MCPCAP01";
+
+    /**
+     * @brief Append one request to a capture: its size as 4 bytes, the offset as 8 and each string
+     *        with a 4 byte length in front, all little endian.
+     */
+    void encode_captured_request(const CapturedRequest &request, std::string &out);
+
+    /**
+     * @brief Reads a capture file written by TrafficCapture, request by request.
+     */
+    class CaptureReader {
+    public:
+        /**
+         * @brief Open a capture file.
+         * @throws std::runtime_error if it cannot be opened or is not a capture
+         */
+        explicit CaptureReader(const std::string &path);
+        ~CaptureReader();
+        CaptureReader(const CaptureReader &) = delete;
+        CaptureReader &operator=(const CaptureReader &) = delete;
+
+        /**
+         * @brief Read the next request.
+         * @return false at the end of the file, or at a request cut short by a crash
+         */
+        bool next(CapturedRequest &request);
+
+    private:
+        std::FILE *file_ = nullptr;
+        std::string record_;
+    };
+
+    /**
+     * @brief Records the requests HttpHandler serves into a compact binary capture file.
+     *
+     * Installed as the before-request callback of every HttpHandler while the capture is on. A
+     * request is copied into a queue and nothing else on the io thread; the writer thread blanks
+     * the redacted members of JSON bodies, encodes the requests and appends them to the file.
+     * Credentials never reach the capture: of the headers, only Mcp-Session-Id is kept. When the
+     * disk can't keep up the queue is bounded and further requests are dropped and counted, so a
+     * capture may have gaps but never slows the server down.
+     */
+    class TrafficCapture {
+    public:
+        static TrafficCapture &instance();
+
+        /**
+         * @brief Open the configured file and start the writer; does nothing if the path is empty.
+         */
+        void start();
+
+        /**
+         * @brief Write what is queued, stop the writer thread and close the file.
+         */
+        void shutdown();
+
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Queue a request; dropped if the capture is off or its queue is full.
+         * @param request Request as the handler materialized it
+         * @param session_id Transport session it came on
+         */
+        void record(const HttpRequest &request, const std::string &session_id);
+
+        uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        TrafficCapture() = default;
+        ~TrafficCapture();
+
+        void run();
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::vector<CapturedRequest> queue_;
+        std::thread thread_;
+        std::FILE *file_ = nullptr;
+        bool stopping_ = false;
+        std::chrono::steady_clock::time_point started_;
+        std::atomic<bool> enabled_{false};
+        std::atomic<uint64_t> written_{0};
+        std::atomic<uint64_t> dropped_{0};
+    };
+
+}// namespace mcp::transport
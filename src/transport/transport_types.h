@@ -4,9 +4,10 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace mcp::transport {
-    // global callback type for handling messages
-    using MessageCallback = std::function<void(const std::string &, std::shared_ptr<class Session>, const std::string &)>;
+    // global callback type for handling messages; the message view and the session stay valid until the returned awaitable completes
+    using MessageCallback = std::function<asio::awaitable<void>(std::string_view, const std::shared_ptr<class Session> &, const std::string &)>;
 
 }// namespace mcp::transport
\ No newline at end of file
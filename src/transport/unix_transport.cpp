@@ -0,0 +1,251 @@
+#include "unix_transport.h"
+#include "core/io_context_pool.hpp"
+#include "core/logger.h"
+#include "hot_restart.h"
+#include "session.h"
+#include "slab_allocator.h"
+#include "tcp_session.h"
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+using asio::use_awaitable;
+
+namespace mcp::transport {
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+    namespace {
+        /**
+         * @brief User id of the process on the other end of a connection.
+         * @return The id, std::nullopt if the platform can't tell
+         */
+        std::optional<uint32_t> peer_uid([[maybe_unused]] asio::local::stream_protocol::socket &socket) {
+#if defined(SO_PEERCRED)
+            struct ucred credentials{};
+            socklen_t size = sizeof(credentials);
+            if (::getsockopt(socket.native_handle(), SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0) {
+                return static_cast<uint32_t>(credentials.uid);
+            }
+#elif !defined(_WIN32)
+            uid_t uid = 0;
+            gid_t gid = 0;
+            if (::getpeereid(socket.native_handle(), &uid, &gid) == 0) {
+                return static_cast<uint32_t>(uid);
+            }
+#endif
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Remove a socket file left behind by a previous run, so that bind() succeeds.
+         * Anything that is not a socket is left alone and makes bind() fail instead.
+         */
+        void remove_stale_socket([[maybe_unused]] const std::string &path) {
+#if !defined(_WIN32)
+            struct stat status{};
+            if (::lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+                ::unlink(path.c_str());
+            }
+#endif
+        }
+    }// namespace
+#endif
+
+    std::vector<uint32_t> UnixSocketAuth::parse_uids(std::string_view text) {
+        std::vector<uint32_t> uids;
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+            while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+            if (item.empty()) {
+                continue;
+            }
+            uint32_t uid = 0;
+            auto result = std::from_chars(item.data(), item.data() + item.size(), uid);
+            if (result.ec != std::errc() || result.ptr != item.data() + item.size()) {
+                MCP_WARN("Ignoring invalid user id '{}' in unix_socket_allowed_uids", item);
+                continue;
+            }
+            uids.push_back(uid);
+        }
+        return uids;
+    }
+
+    /**
+     * @brief Construct the transport and bind the socket.
+     * @param path Socket path, '@' followed by a name for the abstract namespace
+     * @param auth_manager Authentication manager
+     * @param peer_auth Peer credential authentication
+     */
+    UnixTransport::UnixTransport(const std::string &path, std::shared_ptr<AuthManagerBase> auth_manager, UnixSocketAuth peer_auth)
+        : path_(path),
+          auth_manager_(std::move(auth_manager)),
+          peer_auth_(std::move(peer_auth))
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+          ,
+          acceptor_(io_context_)
+#endif
+    {
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        if (path_.empty()) {
+            throw std::invalid_argument("Unix socket path is empty");
+        }
+#if !defined(_WIN32)
+        if (peer_auth_.enabled && peer_auth_.allowed_uids.empty()) {
+            peer_auth_.allowed_uids.push_back(static_cast<uint32_t>(::geteuid()));
+        }
+#endif
+
+        std::string address = path_;
+        bool abstract = address.front() == '@';
+        auto &hot_restart = HotRestart::instance();
+        if (auto fd = hot_restart.inherit(HotRestart::unix_key(path_))) {
+            // The socket file is the one the previous process bound, it must stay
+            acceptor_.assign(asio::local::stream_protocol(), *fd);
+            owns_file_ = !abstract;
+            MCP_INFO("Took over Unix socket {}{}", path_, peer_auth_.enabled ? " with peer credential authentication" : "");
+        } else {
+            if (abstract) {
+                address.front() = '\0';// Linux abstract namespace: no file, no permissions
+            } else {
+                remove_stale_socket(address);
+            }
+
+            asio::local::stream_protocol::endpoint endpoint(address);
+            acceptor_.open(endpoint.protocol());
+            acceptor_.bind(endpoint);
+            owns_file_ = !abstract;
+            acceptor_.listen(asio::socket_base::max_listen_connections);
+            MCP_INFO("Listening on Unix socket {}{}", path_, peer_auth_.enabled ? " with peer credential authentication" : "");
+        }
+        hot_restart.share(HotRestart::unix_key(path_), acceptor_.native_handle());
+#else
+        throw std::runtime_error("Unix domain sockets are not supported on this platform");
+#endif
+    }
+
+    /**
+     * @brief Destructor - stops the transport.
+     */
+    UnixTransport::~UnixTransport() {
+        stop();
+    }
+
+    /**
+     * @brief Start accepting connections and processing requests.
+     * @param on_message Message processing callback
+     * @return True if successful
+     */
+    bool UnixTransport::start(MessageCallback on_message) {
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        handler_ = std::make_unique<HttpHandler>(std::move(on_message), auth_manager_);
+        is_running_ = true;
+        accept_counters_ = metrics::MetricsManager::getInstance()->register_accept_counters("unix", 1);
+        asio::co_spawn(io_context_, accept_loop(), asio::detached);
+
+        // Run IO context in dedicated thread
+        std::thread([this]() {
+            try {
+                io_context_.run();
+            } catch (const std::exception &e) {
+                MCP_ERROR("Error in Unix socket io_context: {}", e.what());
+            }
+        }).detach();
+        return true;
+#else
+        (void) on_message;
+        return false;
+#endif
+    }
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+    /**
+     * @brief Accept connections and start a session for each on a pool thread.
+     */
+    asio::awaitable<void> UnixTransport::accept_loop() {
+        try {
+            while (is_running_) {
+                auto &session_io_context = AsioIOServicePool::GetInstance()->GetIOService();
+                auto socket = co_await acceptor_.async_accept(session_io_context, use_awaitable);
+                accept_counters_->increment(0);
+
+                bool authenticated = false;
+                if (peer_auth_.enabled) {
+                    if (!authorize(socket)) {
+                        asio::error_code ec;
+                        socket.close(ec);
+                        continue;
+                    }
+                    authenticated = true;
+                }
+
+                asio::co_spawn(session_io_context, [socket = std::move(socket), authenticated, handler = handler_.get()]() mutable -> asio::awaitable<void> {
+                        auto session = std::allocate_shared<UnixSession>(SlabAllocator<UnixSession>{}, std::move(socket));
+                        session->set_peer_authenticated(authenticated);
+                        co_await session->start(handler);
+                        co_return; }, asio::detached);
+            }
+        } catch (const std::exception &e) {
+            if (is_running_) {
+                MCP_ERROR("Error accepting Unix socket connections: {}", e.what());
+            }
+        }
+    }
+
+    bool UnixTransport::authorize(asio::local::stream_protocol::socket &socket) const {
+        auto uid = peer_uid(socket);
+        if (!uid) {
+            MCP_WARN("Unix socket connection rejected: peer credentials unavailable");
+            return false;
+        }
+        if (std::find(peer_auth_.allowed_uids.begin(), peer_auth_.allowed_uids.end(), *uid) == peer_auth_.allowed_uids.end()) {
+            MCP_WARN("Unix socket connection rejected: uid {} is not allowed", *uid);
+            return false;
+        }
+        MCP_DEBUG("Unix socket client connected, uid {}", *uid);
+        return true;
+    }
+#endif
+
+    /**
+     * @brief Stop the transport and clean up resources.
+     */
+    void UnixTransport::stop() {
+        stop_accepting();
+        work_guard_.reset();
+        io_context_.stop();
+    }
+
+    /**
+     * @brief Close the listener and remove the socket file.
+     */
+    void UnixTransport::stop_accepting() {
+        is_running_ = false;
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        asio::error_code ec;
+        if (acceptor_.is_open()) {
+            HotRestart::instance().unshare(acceptor_.native_handle());
+            acceptor_.close(ec);
+        }
+#endif
+#if !defined(_WIN32)
+        // After a hot restart the file is the successor's listener
+        if (owns_file_ && !HotRestart::instance().handed_over()) {
+            ::unlink(path_.c_str());
+            owns_file_ = false;
+        }
+#endif
+    }
+
+}// namespace mcp::transport
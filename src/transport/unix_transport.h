@@ -0,0 +1,95 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "Auth/AuthManager.hpp"
+#include "http_handler.h"
+#include "metrics/metrics_manager.h"
+#include "transport_types.h"
+#include <asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Peer credential authentication of a Unix domain socket listener.
+     */
+    struct UnixSocketAuth {
+        bool enabled = false;              ///< Authenticate clients by SO_PEERCRED instead of the auth manager's headers
+        std::vector<uint32_t> allowed_uids;///< Users that may connect, empty for the server's own user
+
+        /**
+         * @brief Parse a comma separated list of user ids such as "1000,1001".
+         * @param text User id list, empty for none
+         * @return User ids; entries that are not numbers are skipped with a warning
+         */
+        static std::vector<uint32_t> parse_uids(std::string_view text);
+    };
+
+    /**
+     * @brief HTTP transport on a Unix domain socket, for clients on the same host.
+     *
+     * Connections are served by UnixSession, the same stream session as HttpTransport's TCP
+     * connections, on the same IO pool. A path starting with '@' names a socket in the Linux
+     * abstract namespace, which has no file and goes away with the listener.
+     *
+     * With peer authentication the kernel's credentials of the connecting process decide:
+     * connections of other users are closed right away, the others skip the auth manager's
+     * header check.
+     */
+    class UnixTransport {
+    public:
+        /**
+         * @param path Socket path, or '@' followed by an abstract socket name
+         * @param auth_manager Authentication manager, for clients without peer authentication
+         * @param peer_auth Peer credential authentication
+         */
+        UnixTransport(const std::string &path, std::shared_ptr<AuthManagerBase> auth_manager = nullptr, UnixSocketAuth peer_auth = {});
+        ~UnixTransport();
+
+        /**
+         * @brief Start accepting connections.
+         * @param on_message Callback for processing received messages
+         * @return True if startup successful
+         */
+        bool start(MessageCallback on_message);
+
+        /**
+         * @brief Stop accepting connections and remove the socket file.
+         */
+        void stop();
+
+        /**
+         * @brief Close the listener and remove the socket file, for a drain; accepted connections are served on.
+         */
+        void stop_accepting();
+
+    private:
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        asio::awaitable<void> accept_loop();
+        bool authorize(asio::local::stream_protocol::socket &socket) const;///< Check the peer credentials of a connection
+#endif
+
+        std::string path_;                             ///< Configured path, '@' for the abstract namespace
+        std::shared_ptr<AuthManagerBase> auth_manager_;///< Authentication manager
+        UnixSocketAuth peer_auth_;
+        std::atomic<bool> is_running_ = false;///< Transport running flag
+        bool owns_file_ = false;              ///< A socket file was created and is removed on stop()
+
+        asio::io_context io_context_;///< Runs the accept loop
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        asio::local::stream_protocol::acceptor acceptor_;
+#endif
+        std::shared_ptr<metrics::AcceptCounters> accept_counters_;
+        std::unique_ptr<HttpHandler> handler_;
+        asio::executor_work_guard<asio::io_context::executor_type> work_guard_{asio::make_work_guard(io_context_)};
+    };
+
+}// namespace mcp::transport
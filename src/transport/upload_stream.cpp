@@ -0,0 +1,390 @@
+#include "upload_stream.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace mcp::transport {
+
+    namespace {
+        thread_local UploadStream *current_upload = nullptr;
+
+        StreamedArgumentLookup &lookup_storage() {
+            static StreamedArgumentLookup lookup;
+            return lookup;
+        }
+
+        bool is_space(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        /**
+         * @brief Offset of the closing quote of the string starting at start, npos if it is not in data.
+         */
+        size_t string_end(std::string_view data, size_t start) {
+            size_t end = start;
+            while (end < data.size() && data[end] != '"') {
+                end += data[end] == '\\' ? 2 : 1;
+            }
+            return end < data.size() ? end : std::string_view::npos;
+        }
+
+        int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        /**
+         * @brief Code unit of the four hex digits at p, -1 if they are not.
+         */
+        long hex4(const char *p) {
+            long value = 0;
+            for (int i = 0; i < 4; ++i) {
+                int digit = hex_value(p[i]);
+                if (digit < 0) {
+                    return -1;
+                }
+                value = value * 16 + digit;
+            }
+            return value;
+        }
+
+        size_t encode_utf8(unsigned long cp, char *out) {
+            if (cp < 0x80) {
+                out[0] = static_cast<char>(cp);
+                return 1;
+            }
+            if (cp < 0x800) {
+                out[0] = static_cast<char>(0xC0 | (cp >> 6));
+                out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+                return 2;
+            }
+            if (cp < 0x10000) {
+                out[0] = static_cast<char>(0xE0 | (cp >> 12));
+                out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+                return 3;
+            }
+            out[0] = static_cast<char>(0xF0 | (cp >> 18));
+            out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 4;
+        }
+    }// namespace
+
+    void set_streamed_argument_lookup(StreamedArgumentLookup lookup) {
+        lookup_storage() = std::move(lookup);
+    }
+
+    const StreamedArgumentLookup &streamed_argument_lookup() {
+        return lookup_storage();
+    }
+
+    UploadScan find_streamed_argument(std::string_view body, const StreamedArgumentLookup &argument_of, StreamedArgument &found) {
+        if (!argument_of) {
+            return UploadScan::Buffered;
+        }
+        // Running out of the part looked at decides nothing until it is all there
+        std::string_view data = body.substr(0, kUploadScanLimit);
+        const UploadScan undecided = body.size() > kUploadScanLimit ? UploadScan::Buffered : UploadScan::NeedMore;
+
+        struct Level {
+            bool object;
+            std::string_view key;
+        };
+        std::vector<Level> stack;
+        std::string_view method;
+        std::string_view tool;
+        std::string argument;
+        bool has_id = false;
+        bool looked_up = false;
+        bool expect_key = false;
+
+        size_t pos = 0;
+        while (true) {
+            while (pos < data.size() && is_space(data[pos])) ++pos;
+            if (pos == data.size()) {
+                return undecided;
+            }
+            char c = data[pos];
+            if (stack.empty() && c != '{') {
+                return UploadScan::Buffered;// A batch, or not JSON-RPC
+            }
+            switch (c) {
+                case '{':
+                    stack.push_back({true, {}});
+                    expect_key = true;
+                    ++pos;
+                    break;
+                case '[':
+                    stack.push_back({false, {}});
+                    expect_key = false;
+                    ++pos;
+                    break;
+                case '}':
+                case ']':
+                    stack.pop_back();
+                    if (stack.empty()) {
+                        return UploadScan::Buffered;// The whole request is here
+                    }
+                    expect_key = false;
+                    ++pos;
+                    break;
+                case ',':
+                    expect_key = stack.back().object;
+                    ++pos;
+                    break;
+                case ':':
+                    expect_key = false;
+                    ++pos;
+                    break;
+                case '"': {
+                    size_t start = pos + 1;
+                    size_t end = string_end(data, start);
+                    if (expect_key) {
+                        if (end == std::string_view::npos) {
+                            return undecided;
+                        }
+                        stack.back().key = data.substr(start, end - start);
+                        pos = end + 1;
+                        break;
+                    }
+                    size_t depth = stack.size();
+                    if (depth == 3 && stack[0].key == "params" && stack[1].object && stack[1].key == "arguments" && stack[2].object) {
+                        // Arguments that come before what they need to be streamed are not streamed
+                        if (!has_id || method != "tools/call" || tool.empty()) {
+                            return UploadScan::Buffered;
+                        }
+                        if (!looked_up) {
+                            argument = argument_of(tool);
+                            looked_up = true;
+                        }
+                        if (argument.empty()) {
+                            return UploadScan::Buffered;
+                        }
+                        if (stack[2].key == argument) {
+                            // A value that ended already leaves nothing to stream
+                            if (string_end(body, start) != std::string_view::npos) {
+                                return UploadScan::Buffered;
+                            }
+                            found.value_offset = start;
+                            found.closers.clear();
+                            for (auto level = stack.rbegin(); level != stack.rend(); ++level) {
+                                found.closers.push_back(level->object ? '}' : ']');
+                            }
+                            found.skeleton.assign(body.substr(0, start));
+                            found.skeleton.push_back('"');
+                            found.skeleton += found.closers;
+                            return UploadScan::Streamed;
+                        }
+                    }
+                    if (end == std::string_view::npos) {
+                        return undecided;
+                    }
+                    std::string_view value = data.substr(start, end - start);
+                    if (depth == 1 && stack[0].key == "method") {
+                        method = value;
+                    } else if (depth == 1 && stack[0].key == "id") {
+                        has_id = true;
+                    } else if (depth == 2 && stack[0].key == "params" && stack[1].object && stack[1].key == "name") {
+                        tool = value;
+                    }
+                    pos = end + 1;
+                    break;
+                }
+                default: {
+                    // Numbers and literals run up to the next delimiter
+                    size_t end = data.find_first_of(",}] \t\r\n", pos);
+                    if (end == std::string_view::npos) {
+                        return undecided;
+                    }
+                    if (stack.size() == 1 && stack[0].key == "id") {
+                        has_id = data.substr(pos, end - pos) != "null";
+                    }
+                    pos = end;
+                    break;
+                }
+            }
+        }
+    }
+
+    UploadStream::UploadStream(std::string_view received, size_t missing, std::string closers, Pull pull)
+        : raw_(received), missing_(missing), closers_(std::move(closers)), pull_(std::move(pull)) {}
+
+    long long UploadStream::read(char *buffer, size_t size) {
+        size_t out = 0;
+        while (out < size) {
+            if (pending_size_ > 0) {
+                size_t n = std::min(pending_size_, size - out);
+                std::memcpy(buffer + out, pending_, n);
+                std::memmove(pending_, pending_ + n, pending_size_ - n);
+                pending_size_ -= n;
+                out += n;
+                continue;
+            }
+            State state = state_.load(std::memory_order_relaxed);
+            if (state == State::Failed) {
+                return -1;
+            }
+            if (state == State::Done) {
+                break;
+            }
+            if (raw_pos_ == raw_.size() && !fill(1)) {
+                // The body ended inside the value; what was read still counts, the next read fails
+                fail();
+                return out > 0 ? static_cast<long long>(out) : -1;
+            }
+
+            // Copy the run of plain bytes
+            const char *run = raw_.data() + raw_pos_;
+            size_t limit = std::min(raw_.size() - raw_pos_, size - out);
+            size_t n = 0;
+            while (n < limit && run[n] != '"' && run[n] != '\\' && static_cast<unsigned char>(run[n]) >= 0x20) {
+                ++n;
+            }
+            std::memcpy(buffer + out, run, n);
+            out += n;
+            raw_pos_ += n;
+            if (n == limit) {
+                continue;
+            }
+
+            char c = raw_[raw_pos_];
+            if (c == '"') {
+                ++raw_pos_;
+                state_.store(State::Tail, std::memory_order_relaxed);
+                if (!finish_tail()) {
+                    return -1;
+                }
+                break;
+            }
+            if (c != '\\' || !fill(2)) {
+                return fail();// Control characters must be escaped
+            }
+
+            char decoded[4];
+            size_t length = 1;
+            size_t consumed = 2;
+            switch (raw_[raw_pos_ + 1]) {
+                case '"': decoded[0] = '"'; break;
+                case '\\': decoded[0] = '\\'; break;
+                case '/': decoded[0] = '/'; break;
+                case 'b': decoded[0] = '\b'; break;
+                case 'f': decoded[0] = '\f'; break;
+                case 'n': decoded[0] = '\n'; break;
+                case 'r': decoded[0] = '\r'; break;
+                case 't': decoded[0] = '\t'; break;
+                case 'u': {
+                    if (!fill(6)) {
+                        return fail();
+                    }
+                    long unit = hex4(raw_.data() + raw_pos_ + 2);
+                    consumed = 6;
+                    if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF)) {
+                        return fail();
+                    }
+                    unsigned long cp = static_cast<unsigned long>(unit);
+                    if (unit >= 0xD800 && unit <= 0xDBFF) {
+                        // A high surrogate only makes sense with its low one
+                        if (!fill(12) || raw_[raw_pos_ + 6] != '\\' || raw_[raw_pos_ + 7] != 'u') {
+                            return fail();
+                        }
+                        long low = hex4(raw_.data() + raw_pos_ + 8);
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            return fail();
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (static_cast<unsigned long>(low) - 0xDC00);
+                        consumed = 12;
+                    }
+                    length = encode_utf8(cp, decoded);
+                    break;
+                }
+                default:
+                    return fail();
+            }
+            raw_pos_ += consumed;
+            size_t fits = std::min(length, size - out);
+            std::memcpy(buffer + out, decoded, fits);
+            out += fits;
+            std::memcpy(pending_, decoded + fits, length - fits);
+            pending_size_ = length - fits;
+        }
+        return static_cast<long long>(out);
+    }
+
+    bool UploadStream::finished() const {
+        return state_.load(std::memory_order_acquire) == State::Done;
+    }
+
+    bool UploadStream::finish_tail() {
+        while (true) {
+            for (; raw_pos_ < raw_.size(); ++raw_pos_) {
+                char c = raw_[raw_pos_];
+                if (is_space(c)) {
+                    continue;
+                }
+                if (closed_ == closers_.size() || c != closers_[closed_]) {
+                    fail();// More members after the streamed argument
+                    return false;
+                }
+                ++closed_;
+            }
+            if (missing_ == 0) {
+                break;
+            }
+            if (!fill(1)) {
+                fail();
+                return false;
+            }
+        }
+        if (closed_ != closers_.size()) {
+            fail();
+            return false;
+        }
+        state_.store(State::Done, std::memory_order_release);
+        return true;
+    }
+
+    bool UploadStream::fill(size_t need) {
+        if (raw_.size() - raw_pos_ >= need) {
+            return true;
+        }
+        raw_.erase(0, raw_pos_);
+        raw_pos_ = 0;
+        while (raw_.size() < need) {
+            if (missing_ == 0) {
+                return false;
+            }
+            size_t have = raw_.size();
+            size_t n = std::min(kReadSize, missing_);
+            raw_.resize(have + n);
+            size_t got = pull_(raw_.data() + have, n);
+            raw_.resize(have + got);
+            if (got == 0) {
+                return false;
+            }
+            missing_ -= got;
+        }
+        return true;
+    }
+
+    long long UploadStream::fail() {
+        state_.store(State::Failed, std::memory_order_release);
+        return -1;
+    }
+
+    UploadStream *UploadStream::current() {
+        return current_upload;
+    }
+
+    UploadStream::Scope::Scope(UploadStream *upload) : previous_(current_upload) {
+        current_upload = upload;
+    }
+
+    UploadStream::Scope::~Scope() {
+        current_upload = previous_;
+    }
+
+}// namespace mcp::transport
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace mcp::transport {
+
+    /**
+     * @brief Settings of streamed uploads, normally taken from the [transport] section.
+     */
+    struct UploadOptions {
+        size_t stream_threshold = 16 * 1024 * 1024;///< Bodies from this size on may be streamed into their plugin, 0 = never
+        size_t max_size = 256 * 1024 * 1024;       ///< Largest body streamed, 0 = no limit; max_request_size only sees the rest
+
+        static const UploadOptions &current() { return storage(); }
+
+        /**
+         * @brief Set the options. Call once at startup, before requests are served.
+         * @param options Options
+         */
+        static void configure(UploadOptions options) { storage() = options; }
+
+    private:
+        static UploadOptions &storage() {
+            static UploadOptions options;
+            return options;
+        }
+    };
+
+    /**
+     * @brief Name of the string argument a tool takes as a stream, empty if it takes none.
+     */
+    using StreamedArgumentLookup = std::function<std::string(std::string_view tool)>;
+
+    /**
+     * @brief Set the lookup of streamed arguments. Call once at startup, before requests are served;
+     * without one no upload is streamed.
+     */
+    void set_streamed_argument_lookup(StreamedArgumentLookup lookup);
+
+    /**
+     * @brief Lookup set by set_streamed_argument_lookup(), empty if none is.
+     */
+    const StreamedArgumentLookup &streamed_argument_lookup();
+
+    /**
+     * @brief Where the streamed argument of a tools/call body starts.
+     */
+    struct StreamedArgument {
+        size_t value_offset = 0;///< Body offset of the first byte after the value's opening quote
+        std::string closers;    ///< Closing brackets of the containers open at the value, innermost first
+        std::string skeleton;   ///< The body with the value left empty and the containers closed
+    };
+
+    /**
+     * @brief Outcome of looking for a streamed argument in the start of a body.
+     */
+    enum class UploadScan {
+        Streamed,///< Found, the rest of the body can be streamed
+        NeedMore,///< Not decided yet, look again once more of the body arrived
+        Buffered ///< Not an upload to stream, buffer the body as usual
+    };
+
+    inline constexpr size_t kUploadScanLimit = 64 * 1024;///< Body bytes the streamed argument must start within
+
+    /**
+     * @brief Look for the streamed argument of a tools/call request in the part of its body received so far.
+     *
+     * The request is streamed when its id, method and params.name all come before the argument, the
+     * argument is a string and its value is not complete in the part received. It must be the last
+     * member of arguments, params and the request: what follows the value is only checked once it
+     * arrived, by UploadStream. Only the first kUploadScanLimit bytes are looked at.
+     * @param body Body received so far
+     * @param argument_of Name of the streamed argument of a tool, empty if it has none
+     * @param found Set when Streamed is returned
+     */
+    UploadScan find_streamed_argument(std::string_view body, const StreamedArgumentLookup &argument_of, StreamedArgument &found);
+
+    /**
+     * @brief The value of a streamed argument, unescaped, pulled off the connection as the plugin reads it.
+     *
+     * Holds at most one read of the body at a time, so an upload of any size takes bounded memory. After
+     * the value's closing quote the rest of the body is read too and must only close the containers left
+     * open, otherwise the upload failed. read() is called by one thread at a time, the plugin's; pull
+     * blocks that thread until the connection delivered more bytes.
+     */
+    class UploadStream {
+    public:
+        /**
+         * @brief Read up to size more bytes of the body into data, blocking; 0 once the connection failed.
+         */
+        using Pull = std::function<size_t(char *data, size_t size)>;
+
+        static constexpr size_t kReadSize = 64 * 1024;///< Body bytes pulled at a time
+
+        /**
+         * @param received Body bytes already received after the value's opening quote
+         * @param missing Body bytes that have not arrived yet
+         * @param closers StreamedArgument::closers
+         * @param pull Reads the rest of the body
+         */
+        UploadStream(std::string_view received, size_t missing, std::string closers, Pull pull);
+
+        UploadStream(const UploadStream &) = delete;
+        UploadStream &operator=(const UploadStream &) = delete;
+
+        /**
+         * @brief Read the next bytes of the value.
+         * @return Number of bytes read, 0 at the end of the value, -1 if the upload failed
+         */
+        long long read(char *buffer, size_t size);
+
+        /**
+         * @brief Whether the whole body was read and well-formed, so the connection can carry on.
+         */
+        bool finished() const;
+
+        /**
+         * @brief Upload of the tool call running on this thread, see Scope.
+         * @return Upload, or nullptr if the call has none
+         */
+        static UploadStream *current();
+
+        /**
+         * @brief Makes an upload current() on this thread while a synchronous call runs into a plugin.
+         */
+        class Scope {
+        public:
+            explicit Scope(UploadStream *upload);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            UploadStream *previous_;
+        };
+
+    private:
+        enum class State {
+            Value,
+            Tail,
+            Done,
+            Failed
+        };
+
+        /**
+         * @brief Check what follows the value, up to the end of the body.
+         * @return false if it does more than close the containers left open
+         */
+        bool finish_tail();
+
+        /**
+         * @brief Make at least need unread bytes available, pulling more of the body.
+         * @return false if the body ends or the connection failed before
+         */
+        bool fill(size_t need);
+
+        long long fail();
+
+        std::string raw_;   ///< Body bytes pulled and not yet decoded, from raw_pos_ on
+        size_t raw_pos_ = 0;
+        size_t missing_;    ///< Body bytes not pulled yet
+        std::string closers_;
+        size_t closed_ = 0; ///< Closers seen in the tail
+        char pending_[4];   ///< Decoded bytes of an escape that did not fit the caller's buffer
+        size_t pending_size_ = 0;
+        std::atomic<State> state_{State::Value};
+        Pull pull_;
+    };
+
+}// namespace mcp::transport
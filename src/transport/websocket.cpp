@@ -0,0 +1,524 @@
+#include "websocket.h"
+#include "core/frame_pool.hpp"
+#include "core/logger.h"
+#include "http_handler.h"
+#include "protocol/json_rpc.h"
+#include "utils/utf8.h"
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <openssl/evp.h>
+
+namespace mcp::transport {
+
+    namespace {
+        WebSocketOptions &options_storage() {
+            static WebSocketOptions options;
+            return options;
+        }
+
+        constexpr std::string_view kAcceptGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        constexpr size_t kMaxFrameHeader = 14;
+        constexpr size_t kReadChunkSize = 16 * 1024;
+
+        enum Opcode : uint8_t {
+            kContinuation = 0x0,
+            kText = 0x1,
+            kBinary = 0x2,
+            kClose = 0x8,
+            kPing = 0x9,
+            kPong = 0xa,
+        };
+
+        enum CloseCode : uint16_t {
+            kNormalClosure = 1000,
+            kProtocolError = 1002,
+            kInvalidPayload = 1007,
+            kMessageTooBig = 1009,
+        };
+
+        bool valid_close_code(uint16_t code) {
+            return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1014) || (code >= 3000 && code <= 4999);
+        }
+
+        std::string close_payload(uint16_t code) {
+            std::string payload;
+            payload.push_back(static_cast<char>(code >> 8));
+            payload.push_back(static_cast<char>(code));
+            return payload;
+        }
+
+        void put_frame_header(std::string &out, uint8_t opcode, size_t length) {
+            out.push_back(static_cast<char>(0x80 | opcode));// FIN, server frames are never masked
+            if (length < 126) {
+                out.push_back(static_cast<char>(length));
+            } else if (length <= 0xffff) {
+                out.push_back(static_cast<char>(126));
+                out.push_back(static_cast<char>(length >> 8));
+                out.push_back(static_cast<char>(length));
+            } else {
+                out.push_back(static_cast<char>(127));
+                for (int shift = 56; shift >= 0; shift -= 8) {
+                    out.push_back(static_cast<char>(static_cast<uint64_t>(length) >> shift));
+                }
+            }
+        }
+    }// namespace
+
+    void WebSocketOptions::configure(const WebSocketOptions &options) {
+        options_storage() = options;
+    }
+
+    const WebSocketOptions &WebSocketOptions::current() {
+        return options_storage();
+    }
+
+    bool has_token(std::string_view value, std::string_view token) {
+        while (!value.empty()) {
+            size_t comma = value.find(',');
+            std::string_view item = value.substr(0, comma);
+            while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+            while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+            if (iequals(item, token)) {
+                return true;
+            }
+            value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+        }
+        return false;
+    }
+
+    bool is_websocket_upgrade(const HttpRequestView &request) {
+        return request.method == "GET" && has_token(request.get_header("Upgrade"), "websocket") &&
+               has_token(request.get_header("Connection"), "upgrade");
+    }
+
+    std::string websocket_accept_key(std::string_view key) {
+        std::string input(key);
+        input += kAcceptGuid;
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_size = 0;
+        if (EVP_Digest(input.data(), input.size(), digest, &digest_size, EVP_sha1(), nullptr) != 1) {
+            throw std::runtime_error("SHA-1 digest failed");
+        }
+        std::string encoded(4 * ((digest_size + 2) / 3), '\0');
+        int length = EVP_EncodeBlock(reinterpret_cast<unsigned char *>(encoded.data()), digest, static_cast<int>(digest_size));
+        encoded.resize(static_cast<size_t>(length));
+        return encoded;
+    }
+
+    WebSocketConnection::WebSocketConnection(std::shared_ptr<Session> transport, const HttpRequestView &request,
+                                             const WebSocketOptions &options)
+        : transport_(std::move(transport)),
+          options_(options),
+          target_(request.target),
+          slot_timer_(transport_->get_executor(), asio::steady_timer::time_point::max()) {
+        options_.max_in_flight = std::max<size_t>(options_.max_in_flight, 1);
+
+        // Messages carry the upgrade's headers (auth, session), not its WebSocket handshake
+        for (size_t i = 0; i < request.header_count; ++i) {
+            std::string_view name = request.headers[i].name;
+            if (iequals(name, "Upgrade") || iequals(name, "Connection") || iequals(name, "Content-Length") ||
+                iequals(name, "Content-Type") || iequals(name, "Accept") || iequals(name, "Transfer-Encoding") ||
+                (name.size() > 14 && iequals(name.substr(0, 14), "Sec-WebSocket-"))) {
+                continue;
+            }
+            headers_.emplace_back(std::string(name), std::string(request.headers[i].value));
+        }
+    }
+
+    /**
+     * @brief Open the notification stream, then read and handle frames until the connection ends.
+     */
+    asio::awaitable<void> WebSocketConnection::run(HttpHandler *handler, std::string buffered) {
+        auto self = shared_from_this();
+        MCP_DEBUG("WebSocket connection opened (Session: {}, endpoint: {})", transport_->get_session_id(), target_);
+        dispatch({}, true, handler);
+
+        std::vector<char> buffer(std::max(kReadChunkSize, buffered.size()));
+        std::memcpy(buffer.data(), buffered.data(), buffered.size());
+        size_t begin = 0;
+        size_t end = buffered.size();
+        uint16_t close_code = 0;
+        bool close_received = false;
+        try {
+            while (!closed_ && close_code == 0) {
+                while (close_code == 0 && end - begin >= 2) {
+                    const auto *bytes = reinterpret_cast<const unsigned char *>(buffer.data() + begin);
+                    bool fin = (bytes[0] & 0x80) != 0;
+                    uint8_t opcode = bytes[0] & 0x0f;
+                    bool masked = (bytes[1] & 0x80) != 0;
+                    uint64_t length = bytes[1] & 0x7f;
+                    size_t header = 2 + (length == 126 ? 2 : length == 127 ? 8 : 0) + (masked ? 4 : 0);
+                    if (end - begin < header) {
+                        break;
+                    }
+                    if (length >= 126) {
+                        size_t size_bytes = length == 126 ? 2 : 8;
+                        length = 0;
+                        for (size_t i = 0; i < size_bytes; ++i) {
+                            length = (length << 8) | bytes[2 + i];
+                        }
+                    }
+                    if ((bytes[0] & 0x70) != 0 || !masked) {
+                        close_code = kProtocolError;// No extension was negotiated, and clients must mask
+                        break;
+                    }
+                    if (length > options_.max_message_size) {
+                        close_code = kMessageTooBig;
+                        break;
+                    }
+                    if (end - begin < header + length) {
+                        if (buffer.size() - begin < header + length) {
+                            // Make room for the whole frame
+                            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                            end -= begin;
+                            begin = 0;
+                            buffer.resize(std::max(buffer.size(), static_cast<size_t>(header + length)));
+                        }
+                        break;
+                    }
+
+                    char *payload = buffer.data() + begin + header;
+                    const unsigned char *mask = bytes + header - 4;
+                    for (size_t i = 0; i < length; ++i) {
+                        payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+                    }
+                    begin += header + static_cast<size_t>(length);
+                    if (opcode == kClose) {
+                        close_received = true;
+                        uint16_t code = kNormalClosure;
+                        if (length >= 2) {
+                            code = static_cast<uint16_t>((static_cast<unsigned char>(payload[0]) << 8) | static_cast<unsigned char>(payload[1]));
+                        }
+                        bool valid = fin && length != 1 && length <= 125 && valid_close_code(code);
+                        close_code = valid ? code : static_cast<uint16_t>(kProtocolError);
+                        break;
+                    }
+                    close_code = process_frame(fin, opcode, std::string_view(payload, static_cast<size_t>(length)), handler);
+
+                    // Stop reading while the connection has as many messages in flight as allowed
+                    while (in_flight_ >= options_.max_in_flight && !closed_) {
+                        asio::error_code ec;
+                        co_await slot_timer_.async_wait(core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+                    }
+                }
+                if (close_code != 0 || closed_) {
+                    break;
+                }
+
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+                if (buffer.size() - end < kReadChunkSize / 4) {
+                    buffer.resize(buffer.size() + kReadChunkSize);
+                }
+                size_t n = co_await transport_->read_some(asio::buffer(buffer.data() + end, buffer.size() - end));
+                if (n == 0) {
+                    break;
+                }
+                end += n;
+            }
+        } catch (const std::exception &e) {
+            if (!closed_) {
+                MCP_DEBUG("WebSocket connection ended (Session: {}): {}", transport_->get_session_id(), e.what());
+            }
+        }
+
+        if (close_code != 0 && !transport_->is_closed()) {
+            if (!close_received) {
+                MCP_WARN("Closing WebSocket connection with code {} (Session: {})", close_code, transport_->get_session_id());
+            }
+            std::string frame;
+            std::string payload = close_payload(close_code);
+            put_frame_header(frame, kClose, payload.size());
+            frame += payload;
+            co_await transport_->write(frame);
+        }
+        shutdown();
+        MCP_DEBUG("WebSocket connection closed (Session: {})", transport_->get_session_id());
+    }
+
+    uint16_t WebSocketConnection::process_frame(bool fin, uint8_t opcode, std::string_view payload, HttpHandler *handler) {
+        if (opcode >= kClose) {
+            if (!fin || payload.size() > 125) {
+                return kProtocolError;// Control frames are never fragmented
+            }
+            if (opcode == kPing) {
+                send_frame(kPong, payload);
+                return 0;
+            }
+            return opcode == kPong ? 0 : kProtocolError;
+        }
+
+        if (opcode == kContinuation) {
+            if (message_opcode_ == 0) {
+                return kProtocolError;
+            }
+            if (message_.size() + payload.size() > options_.max_message_size) {
+                return kMessageTooBig;
+            }
+            message_.append(payload);
+        } else if (opcode == kText || opcode == kBinary) {
+            if (message_opcode_ != 0) {
+                return kProtocolError;// The previous message is not finished
+            }
+            message_opcode_ = opcode;
+            message_.assign(payload);
+        } else {
+            return kProtocolError;
+        }
+
+        if (fin) {
+            if (message_opcode_ == kText && !utils::utf8_valid(message_)) {
+                return kInvalidPayload;// RFC 6455 section 8.1
+            }
+            dispatch(std::move(message_), false, handler);
+            message_.clear();
+            message_opcode_ = 0;
+        }
+        return 0;
+    }
+
+    void WebSocketConnection::dispatch(std::string body, bool notifications, HttpHandler *handler) {
+        uint64_t id = next_message_id_++;
+        auto message = std::make_shared<WebSocketMessage>(shared_from_this(), id, std::move(body), notifications);
+        messages_.emplace(id, message);
+        if (!notifications) {
+            ++in_flight_;
+        }
+        asio::co_spawn(transport_->get_executor(), [message, handler]() { return message->start(handler); }, asio::detached);
+    }
+
+    void WebSocketConnection::message_done(uint64_t id) {
+        auto it = messages_.find(id);
+        if (it == messages_.end()) {
+            return;
+        }
+        if (!it->second->notifications_) {
+            --in_flight_;
+        }
+        messages_.erase(it);
+        slot_timer_.cancel();
+    }
+
+    void WebSocketConnection::send_frame(uint8_t opcode, std::string_view payload) {
+        if (closed_) {
+            return;
+        }
+        std::string frame;
+        frame.reserve(kMaxFrameHeader + payload.size());
+        put_frame_header(frame, opcode, payload.size());
+        frame.append(payload);
+        transport_->post_write(std::move(frame));
+    }
+
+    /**
+     * @brief End every message; handlers still running see their session closed.
+     */
+    void WebSocketConnection::shutdown() {
+        if (closed_) {
+            return;
+        }
+        closed_ = true;
+        auto messages = std::move(messages_);
+        messages_.clear();
+        for (auto &[id, message]: messages) {
+            message->interrupt();
+        }
+        slot_timer_.cancel();
+    }
+
+    WebSocketMessage::WebSocketMessage(std::shared_ptr<WebSocketConnection> connection, uint64_t id, std::string body, bool notifications)
+        : connection_(std::move(connection)),
+          id_(id),
+          request_body_(std::move(body)),
+          notifications_(notifications),
+          disconnect_timer_(connection_->transport().get_executor(), asio::steady_timer::time_point::max()) {
+        // Each message is its own session: streaming tool state is keyed by session id
+        session_id_ = connection_->transport().get_session_id() + "-" + std::to_string(id_);
+    }
+
+    /**
+     * @brief Serve the message as a POST to the upgrade's endpoint (a GET for the notification stream).
+     */
+    asio::awaitable<void> WebSocketMessage::start(HttpHandler *handler) {
+        auto self = shared_from_this();
+
+        HttpRequestView view;
+        view.method = notifications_ ? "GET" : "POST";
+        view.target = connection_->target_;
+        view.version = "HTTP/1.1";
+        for (const auto &[name, value]: connection_->headers_) {
+            if (view.header_count + 2 >= HttpRequestView::kMaxHeaders) {
+                break;
+            }
+            if (iequals(name, "Accept-Encoding") || iequals(name, "Content-Encoding")) {
+                continue;// Messages carry their bodies themselves, neither is content-coded
+            }
+            view.headers[view.header_count++] = HttpHeaderView{name, value};
+        }
+        if (notifications_) {
+            view.headers[view.header_count++] = HttpHeaderView{"Accept", "text/event-stream"};
+        } else {
+            view.headers[view.header_count++] = HttpHeaderView{"Content-Type", "application/json"};
+            view.headers[view.header_count++] = HttpHeaderView{"Accept", "application/json, text/event-stream"};
+        }
+        view.body = request_body_;
+
+        try {
+            co_await handler->handle_request(self, &view, request_body_.size());
+            co_await flush_pending_writes();
+        } catch (const std::exception &e) {
+            MCP_WARN("WebSocket message failed (Session: {}): {}", session_id_, e.what());
+        }
+
+        close();
+    }
+
+    /**
+     * @brief End the message; events of a stream that ends here are flushed first.
+     */
+    void WebSocketMessage::close() {
+        if (closed_) {
+            return;
+        }
+        if (!connection_->is_closed() && response_.until_close()) {
+            finish();
+        }
+        closed_ = true;
+        disconnect_timer_.cancel();
+        connection_->message_done(id_);
+    }
+
+    bool WebSocketMessage::is_closed() const {
+        return closed_ || connection_->is_closed();
+    }
+
+    asio::awaitable<void> WebSocketMessage::wait_for_disconnect() {
+        if (is_closed()) {
+            co_return;
+        }
+        asio::error_code ec;
+        co_await disconnect_timer_.async_wait(core::pooled(asio::redirect_error(asio::use_awaitable, ec)));
+    }
+
+    void WebSocketMessage::interrupt() {
+        disconnect_timer_.cancel();
+    }
+
+    asio::awaitable<void> WebSocketMessage::write_now(std::span<const asio::const_buffer> buffers) {
+        for (const auto &buffer: buffers) {
+            if (is_closed()) {
+                break;
+            }
+            translate(std::string_view(static_cast<const char *>(buffer.data()), buffer.size()));
+        }
+        co_return;
+    }
+
+    void WebSocketMessage::translate(std::string_view data) {
+        while (!finished_) {
+            auto part = response_.next(data);
+            if (part == HttpResponseDecoder::Part::NeedMore) {
+                break;
+            }
+            if (part == HttpResponseDecoder::Part::Error) {
+                MCP_WARN("Dropping WebSocket response (Session: {}): {}", session_id_, response_.error());
+                finished_ = true;
+                break;
+            }
+            if (part == HttpResponseDecoder::Part::Head) {
+                event_stream_ = response_.field("content-type").find("text/event-stream") != std::string_view::npos;
+            } else {
+                body_.append(response_.body());
+                if (event_stream_) {
+                    send_events(false);
+                }
+            }
+            if (response_.done()) {
+                finish();
+            }
+        }
+    }
+
+    /**
+     * @brief Send every complete event of an event stream as one text message with its data.
+     * @param flush Send a last event that is not terminated by an empty line as well
+     */
+    void WebSocketMessage::send_events(bool flush) {
+        size_t begin = 0;
+        while (begin < body_.size()) {
+            size_t end = body_.find("\n\n", begin);
+            if (end == std::string::npos) {
+                if (!flush) {
+                    break;
+                }
+                end = body_.size();
+            }
+
+            std::string data;
+            bool has_data = false;
+            std::string_view event(body_.data() + begin, end - begin);
+            while (!event.empty()) {
+                size_t newline = event.find('\n');
+                std::string_view line = event.substr(0, newline);
+                event = newline == std::string_view::npos ? std::string_view() : event.substr(newline + 1);
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                if (line.substr(0, 5) != "data:") {
+                    continue;// Event names, ids and comments have no WebSocket counterpart
+                }
+                line.remove_prefix(5);
+                if (!line.empty() && line.front() == ' ') {
+                    line.remove_prefix(1);
+                }
+                if (has_data) {
+                    data += '\n';
+                }
+                data.append(line);
+                has_data = true;
+            }
+            if (has_data) {
+                connection_->send_text(data);
+            }
+            begin = std::min(end + 2, body_.size());
+        }
+        body_.erase(0, begin);
+    }
+
+    /**
+     * @brief Send the response: a 2xx body as is, anything else as a JSON-RPC error.
+     */
+    void WebSocketMessage::finish() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        if (event_stream_) {
+            send_events(true);
+            return;
+        }
+
+        int status = response_.status();
+        if (status >= 200 && status < 300) {
+            if (!body_.empty()) {
+                connection_->send_text(body_);
+            }
+        } else {
+            // Rejected by the handler (rate limit, size, auth): the client still gets an answer
+            std::string message = "HTTP " + std::to_string(status);
+            auto body = nlohmann::json::parse(body_, nullptr, false);
+            if (body.is_object() && body.contains("error") && body["error"].is_string()) {
+                message += ": " + body["error"].get<std::string>();
+            }
+            nlohmann::json error = {{"jsonrpc", "2.0"}, {"id", nullptr}, {"error", {{"code", -32000}, {"message", message}}}};
+            if (auto envelope = protocol::scan_request_envelope(request_body_); envelope && envelope->has_id()) {
+                error["id"] = nlohmann::json::parse(envelope->id, nullptr, false);
+            }
+            connection_->send_text(error.dump());
+        }
+        body_.clear();
+    }
+
+}// namespace mcp::transport
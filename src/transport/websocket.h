@@ -0,0 +1,178 @@
+#pragma once
+
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "http_parser.h"
+#include "http_response_decoder.h"
+#include "session.h"
+#include <asio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mcp::transport {
+    class HttpHandler;
+    class WebSocketMessage;
+}// namespace mcp::transport
+
+namespace mcp::transport {
+
+    /**
+     * @brief WebSocket settings of the HTTP and HTTPS listeners.
+     * Configured once at startup from the [server] config section, before the transports start.
+     */
+    struct WebSocketOptions {
+        bool enabled = false;                      ///< Accept WebSocket upgrades on the MCP endpoints
+        size_t max_message_size = 16 * 1024 * 1024;///< Larger messages close the connection (1009)
+        size_t max_in_flight = 32;                 ///< Messages handled at once per connection, reading pauses beyond
+
+        /**
+         * @brief Set the process-wide options. Call before starting the transports.
+         * @param options New options
+         */
+        static void configure(const WebSocketOptions &options);
+
+        /**
+         * @brief Get the process-wide options.
+         * @return Current options
+         */
+        static const WebSocketOptions &current();
+    };
+
+    /**
+     * @brief Check whether a comma separated header value holds a token (case-insensitive).
+     * @param value Header value, e.g. of Connection or Sec-WebSocket-Protocol
+     * @param token Token to look for
+     */
+    bool has_token(std::string_view value, std::string_view token);
+
+    /**
+     * @brief Check whether a request asks to be upgraded to WebSocket (Upgrade: websocket).
+     * @param request HTTP/1.1 request
+     */
+    bool is_websocket_upgrade(const HttpRequestView &request);
+
+    /**
+     * @brief Sec-WebSocket-Accept value for a client's Sec-WebSocket-Key (RFC 6455 section 4.2.2).
+     * @param key Sec-WebSocket-Key of the upgrade request
+     */
+    std::string websocket_accept_key(std::string_view key);
+
+    /**
+     * @brief Server side of a WebSocket connection (RFC 6455) carrying MCP messages.
+     *
+     * Every text or binary message is one JSON-RPC message, or batch. It is handed to the
+     * HttpHandler as a POST to the upgrade's endpoint, with the headers of the upgrade
+     * request, through a WebSocketMessage session. The response is sent back as one text
+     * message; the events of a streaming response (SSE) become one text message each. A GET
+     * opened along with the connection carries the server notifications of the session the
+     * same way. Messages are handled concurrently, up to WebSocketOptions::max_in_flight.
+     * All frames go out through the upgraded session's outbound queue, on its executor.
+     *
+     * permessage-deflate is not negotiated; clients send and receive uncompressed frames.
+     */
+    class WebSocketConnection : public std::enable_shared_from_this<WebSocketConnection> {
+    public:
+        /**
+         * @param transport Session that was upgraded, read through Session::read_some()
+         * @param request Upgrade request, copied
+         * @param options WebSocket settings
+         */
+        WebSocketConnection(std::shared_ptr<Session> transport, const HttpRequestView &request,
+                            const WebSocketOptions &options = WebSocketOptions::current());
+
+        /**
+         * @brief Serve the connection until the client closes it or an error ends it.
+         * @param handler HTTP handler for the messages
+         * @param buffered Bytes received after the upgrade request
+         */
+        asio::awaitable<void> run(HttpHandler *handler, std::string buffered);
+
+        bool is_closed() const { return closed_; }
+        Session &transport() const { return *transport_; }
+
+    private:
+        friend class WebSocketMessage;
+
+        /**
+         * @brief Handle one frame; the payload is already unmasked.
+         * @return 0, or the close code that ends the connection
+         */
+        uint16_t process_frame(bool fin, uint8_t opcode, std::string_view payload, HttpHandler *handler);
+
+        void dispatch(std::string body, bool notifications, HttpHandler *handler);
+        void message_done(uint64_t id);
+
+        void send_frame(uint8_t opcode, std::string_view payload);
+        void send_text(std::string_view text) { send_frame(0x1, text); }
+        void shutdown();
+
+        std::shared_ptr<Session> transport_;
+        WebSocketOptions options_;
+        std::string target_;                                    ///< Endpoint of the upgrade, messages are posted to it
+        std::vector<std::pair<std::string, std::string>> headers_;///< Headers passed along with every message
+
+        std::string message_;        ///< Fragments of the message being received
+        uint8_t message_opcode_ = 0;///< Opcode of its first frame, 0 if none is being received
+
+        std::unordered_map<uint64_t, std::shared_ptr<WebSocketMessage>> messages_;///< Messages being handled
+        uint64_t next_message_id_ = 0;
+        size_t in_flight_ = 0;           ///< Client messages being handled, the notification stream not counted
+        asio::steady_timer slot_timer_;  ///< Cancelled when a message is done
+        bool closed_ = false;
+    };
+
+    /**
+     * @brief One message of a WebSocket connection, served through the regular Session interface.
+     * The handler writes an HTTP/1.1 response, which is decoded with HttpResponseDecoder and
+     * sent back as text messages. Closing the message session never closes the connection.
+     */
+    class WebSocketMessage : public Session {
+    public:
+        WebSocketMessage(std::shared_ptr<WebSocketConnection> connection, uint64_t id, std::string body, bool notifications);
+
+        asio::awaitable<void> start(HttpHandler *handler) override;
+        void close() override;
+        bool is_closed() const override;
+        asio::any_io_executor get_executor() override { return connection_->transport().get_executor(); }
+        asio::awaitable<void> wait_for_disconnect() override;
+        const std::string &get_session_id() const override { return session_id_; }
+        bool peer_authenticated() const override { return connection_->transport().peer_authenticated(); }
+
+        // Server notifications belong to the connection, like on the upgraded session
+        void set_notification_stream(const std::shared_ptr<SseSendQueue> &queue) override {
+            connection_->transport().set_notification_stream(queue);
+        }
+        std::shared_ptr<SseSendQueue> notification_stream() const override { return connection_->transport().notification_stream(); }
+
+    protected:
+        asio::awaitable<void> write_now(std::span<const asio::const_buffer> buffers) override;
+
+    private:
+        friend class WebSocketConnection;
+
+        void translate(std::string_view data);///< Feed response bytes written by the handler
+        void send_events(bool flush);         ///< Send the complete events buffered in body_
+        void finish();                        ///< The response is complete
+        void interrupt();                     ///< The connection ended
+
+        std::shared_ptr<WebSocketConnection> connection_;
+        uint64_t id_;
+        std::string request_body_;
+        bool notifications_;///< The GET that carries the connection's server notifications
+
+        HttpResponseDecoder response_;
+        std::string body_;        ///< Response body, or event stream data not sent yet
+        bool event_stream_ = false;
+        bool finished_ = false;
+        asio::steady_timer disconnect_timer_;///< Cancelled when the connection ends
+    };
+
+}// namespace mcp::transport
@@ -0,0 +1,64 @@
+#include "utils/base64.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+using namespace mcp::utils;
+
+TEST(Base64Test, EncodesRfc4648Vectors) {
+    EXPECT_EQ(base64_encode(""), "");
+    EXPECT_EQ(base64_encode("f"), "Zg==");
+    EXPECT_EQ(base64_encode("fo"), "Zm8=");
+    EXPECT_EQ(base64_encode("foo"), "Zm9v");
+    EXPECT_EQ(base64_encode("foob"), "Zm9vYg==");
+    EXPECT_EQ(base64_encode("fooba"), "Zm9vYmE=");
+    EXPECT_EQ(base64_encode("foobar"), "Zm9vYmFy");
+    EXPECT_EQ(base64_encode(std::string("\xfb\xff\xbf", 3)), "+/+/");
+}
+
+TEST(Base64Test, DecodesWithAndWithoutPadding) {
+    EXPECT_EQ(base64_decode("Zm9vYmE="), "fooba");
+    EXPECT_EQ(base64_decode("Zm9vYmE"), "fooba");
+    EXPECT_EQ(base64_decode("Zg=="), "f");
+    EXPECT_EQ(base64_decode("Zg"), "f");
+    EXPECT_EQ(base64_decode(""), "");
+}
+
+TEST(Base64Test, RejectsInvalidInput) {
+    EXPECT_FALSE(base64_decode("Zm9v!mFy").has_value());
+    EXPECT_FALSE(base64_decode("Zm9v YmFy").has_value());
+    EXPECT_FALSE(base64_decode("Zm9vY").has_value());
+    EXPECT_FALSE(base64_decode("Zg=a").has_value());
+    EXPECT_FALSE(base64_decode("Z===").has_value());
+    // An error far into a long input, past what the vector paths take at once
+    std::string text = base64_encode(std::string(600, 'a'));
+    text[500] = '-';
+    EXPECT_FALSE(base64_decode(text).has_value());
+}
+
+// Test that every length and byte value round-trips, whichever code path the CPU picked
+TEST(Base64Test, RoundTripsAllLengths) {
+    std::mt19937 random(7);
+    for (size_t size = 0; size < 300; ++size) {
+        std::string bytes(size, '\0');
+        for (auto &byte: bytes) {
+            byte = static_cast<char>(random());
+        }
+        auto text = base64_encode(bytes);
+        ASSERT_EQ(text.size(), base64_encoded_size(size));
+        EXPECT_EQ(base64_decode(text), bytes) << "size " << size << " with " << base64_implementation();
+    }
+}
+
+// Test that encoding in pieces of a multiple of 3 bytes gives the text of encoding at once
+TEST(Base64Test, EncodesInPieces) {
+    std::string bytes(1000, '\0');
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<char>(i * 31);
+    }
+    std::string pieces;
+    for (size_t at = 0; at < bytes.size(); at += 96) {
+        base64_append(pieces, std::string_view(bytes).substr(at, 96));
+    }
+    EXPECT_EQ(pieces, base64_encode(bytes));
+}
@@ -0,0 +1,92 @@
+#include "core/frame_pool.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+
+using namespace mcp::core;
+
+namespace {
+    // Counts every heap allocation of the test binary
+    std::atomic<uint64_t> heap_allocations{0};
+}// namespace
+
+void *operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+    // The asynchronous steps of one request on a session: wait for input, read, hand over, write
+    template<typename Token>
+    asio::awaitable<void> handle_request(Token token) {
+        auto executor = co_await asio::this_coro::executor;
+        asio::steady_timer readable(executor, asio::steady_timer::time_point::min());
+        co_await readable.async_wait(token);
+        co_await asio::post(executor, token);
+        asio::steady_timer written(executor, asio::steady_timer::time_point::min());
+        co_await written.async_wait(token);
+    }
+
+    template<typename Token>
+    double allocations_per_request(Token token, int requests) {
+        asio::io_context io;
+        uint64_t before = 0;
+        uint64_t after = 0;
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            for (int i = 0; i < 16; ++i) {
+                co_await handle_request(token);// warm up the per-thread caches
+            }
+            before = heap_allocations.load();
+            for (int i = 0; i < requests; ++i) {
+                co_await handle_request(token);
+            }
+            after = heap_allocations.load(); }, asio::detached);
+        io.run();
+        return static_cast<double>(after - before) / requests;
+    }
+}// namespace
+
+// Test that a freed block is handed out again for a request of the same size class
+TEST(FramePoolTest, ReusesFreedBlocks) {
+    void *first = FramePool::allocate(100);
+    FramePool::deallocate(first, 100);
+
+    uint64_t pooled = FramePool::stats().pooled;
+    void *second = FramePool::allocate(120);// same 128-byte class
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(FramePool::stats().pooled, pooled + 1);
+    FramePool::deallocate(second, 120);
+}
+
+// Test that blocks above the largest size class are not cached
+TEST(FramePoolTest, LargeBlocksGoToTheHeap) {
+    uint64_t heap = FramePool::stats().heap;
+    void *block = FramePool::allocate(FramePool::kMaxBlockSize + 1);
+    EXPECT_EQ(FramePool::stats().heap, heap + 1);
+    FramePool::deallocate(block, FramePool::kMaxBlockSize + 1);
+
+    void *again = FramePool::allocate(FramePool::kMaxBlockSize + 1);
+    EXPECT_EQ(FramePool::stats().heap, heap + 2);
+    FramePool::deallocate(again, FramePool::kMaxBlockSize + 1);
+}
+
+// Test that the pooled token does not allocate more per request than the token it wraps;
+// benchmarks/frame_pool_benchmark.cc reports the numbers
+TEST(FramePoolTest, PooledTokenAllocatesLessPerRequest) {
+    constexpr int kRequests = 10000;
+    double plain = allocations_per_request(asio::use_awaitable, kRequests);
+    double recycled = allocations_per_request(pooled(asio::use_awaitable), kRequests);
+    EXPECT_LE(recycled, plain);
+}
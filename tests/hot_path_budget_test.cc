@@ -0,0 +1,69 @@
+#include "support/hot_path_harness.h"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+
+using namespace mcp::harness;
+
+namespace {
+    constexpr uint64_t kRuns = 1000;
+
+    // Upper bounds of heap allocations per request, about 1.5 times what libstdc++ needs today.
+    // Lower one when a change saves allocations, so the saving cannot be lost unnoticed
+    constexpr double kPingAllocations = 24;
+    constexpr double kToolsListAllocations = 24;
+    constexpr double kEchoCallAllocations = 110;
+    constexpr double kStreamEventAllocations = 24;
+
+    HotPathCost measure_and_report(HotPaths &paths, void (HotPaths::*flow)(), const std::string &name) {
+        HotPathCost cost = paths.measure(flow, kRuns);
+        std::cout << name << ": " << cost.allocations << " allocations, " << cost.allocated_bytes << " bytes";
+        if (cost.instructions) {
+            std::cout << ", " << *cost.instructions << " instructions";
+        }
+        if (cost.cache_misses) {
+            std::cout << ", " << *cost.cache_misses << " cache misses";
+        }
+        if (cost.branch_misses) {
+            std::cout << ", " << *cost.branch_misses << " branch misses";
+        }
+        std::cout << " per request" << std::endl;
+        return cost;
+    }
+}// namespace
+
+class HotPathBudgetTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+#if defined(_MSC_VER)
+        // The budgets are kept for libstdc++ and libc++; MSVC's debug containers allocate more
+        GTEST_SKIP() << "Allocation budgets are not kept for MSVC";
+#endif
+    }
+
+    HotPaths paths;
+};
+
+TEST_F(HotPathBudgetTest, Ping) {
+    auto cost = measure_and_report(paths, &HotPaths::ping, "ping");
+    EXPECT_NE(paths.last_response().find("\"result\":{}"), std::string::npos);
+    EXPECT_LE(cost.allocations, kPingAllocations);
+}
+
+TEST_F(HotPathBudgetTest, ToolsList) {
+    auto cost = measure_and_report(paths, &HotPaths::tools_list, "tools/list");
+    EXPECT_NE(paths.last_response().find("\"echo\""), std::string::npos);
+    EXPECT_LE(cost.allocations, kToolsListAllocations);
+}
+
+TEST_F(HotPathBudgetTest, EchoCall) {
+    auto cost = measure_and_report(paths, &HotPaths::echo_call, "tools/call echo");
+    EXPECT_NE(paths.last_response().find("hello world"), std::string::npos);
+    EXPECT_LE(cost.allocations, kEchoCallAllocations);
+}
+
+TEST_F(HotPathBudgetTest, StreamEvent) {
+    auto cost = measure_and_report(paths, &HotPaths::stream_event, "stream event");
+    EXPECT_EQ(paths.last_response().rfind("event: message\nid: ", 0), 0u);
+    EXPECT_LE(cost.allocations, kStreamEventAllocations);
+}
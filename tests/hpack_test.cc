@@ -0,0 +1,144 @@
+#include "transport/hpack.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mcp::transport::hpack;
+
+namespace {
+    // Bytes of a hex dump as the RFC prints it, spaces ignored
+    std::string unhex(std::string_view hex) {
+        std::string bytes;
+        int high = -1;
+        for (char c: hex) {
+            int nibble = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (nibble < 0) {
+                continue;
+            }
+            if (high < 0) {
+                high = nibble;
+            } else {
+                bytes.push_back(static_cast<char>(high << 4 | nibble));
+                high = -1;
+            }
+        }
+        return bytes;
+    }
+
+    std::vector<HeaderField> decode(Decoder &decoder, std::string_view hex) {
+        std::vector<HeaderField> fields;
+        EXPECT_TRUE(decoder.decode(unhex(hex), fields)) << hex;
+        return fields;
+    }
+
+    const std::vector<HeaderField> kRequest1 = {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"}};
+    const std::vector<HeaderField> kRequest2 = {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"}, {"cache-control", "no-cache"}};
+    const std::vector<HeaderField> kRequest3 = {{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"}, {":authority", "www.example.com"}, {"custom-key", "custom-value"}};
+
+    const std::vector<HeaderField> kResponse1 = {{":status", "302"}, {"cache-control", "private"}, {"date", "Mon, 21 Oct 2013 20:13:21 GMT"}, {"location", "https://www.example.com"}};
+    const std::vector<HeaderField> kResponse2 = {{":status", "307"}, {"cache-control", "private"}, {"date", "Mon, 21 Oct 2013 20:13:21 GMT"}, {"location", "https://www.example.com"}};
+    const std::vector<HeaderField> kResponse3 = {{":status", "200"}, {"cache-control", "private"}, {"date", "Mon, 21 Oct 2013 20:13:22 GMT"}, {"location", "https://www.example.com"}, {"content-encoding", "gzip"}, {"set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1"}};
+}// namespace
+
+// RFC 7541 C.2: single literal and indexed fields
+TEST(HpackTest, DecodesFieldRepresentations) {
+    Decoder decoder;
+    EXPECT_EQ(decode(decoder, "400a 6375 7374 6f6d 2d6b 6579 0d63 7573 746f 6d2d 6865 6164 6572"),
+              (std::vector<HeaderField>{{"custom-key", "custom-header"}}));
+    // Indexed into the dynamic table by the block before
+    EXPECT_EQ(decode(decoder, "be"), (std::vector<HeaderField>{{"custom-key", "custom-header"}}));
+
+    Decoder without_indexing;
+    EXPECT_EQ(decode(without_indexing, "040c 2f73 616d 706c 652f 7061 7468"), (std::vector<HeaderField>{{":path", "/sample/path"}}));
+    std::vector<HeaderField> fields;
+    EXPECT_FALSE(without_indexing.decode(unhex("be"), fields));// Nothing was added to the table
+
+    Decoder never_indexed;
+    EXPECT_EQ(decode(never_indexed, "1008 7061 7373 776f 7264 0673 6563 7265 74"), (std::vector<HeaderField>{{"password", "secret"}}));
+    EXPECT_FALSE(never_indexed.decode(unhex("be"), fields));
+
+    Decoder indexed;
+    EXPECT_EQ(decode(indexed, "82"), (std::vector<HeaderField>{{":method", "GET"}}));
+}
+
+// RFC 7541 C.3: requests sharing a dynamic table, without Huffman coding
+TEST(HpackTest, DecodesRequests) {
+    Decoder decoder;
+    EXPECT_EQ(decode(decoder, "8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d"), kRequest1);
+    EXPECT_EQ(decode(decoder, "8286 84be 5808 6e6f 2d63 6163 6865"), kRequest2);
+    EXPECT_EQ(decode(decoder, "8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65"), kRequest3);
+}
+
+// RFC 7541 C.4: the same requests with Huffman coding
+TEST(HpackTest, DecodesHuffmanRequests) {
+    Decoder decoder;
+    EXPECT_EQ(decode(decoder, "8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff"), kRequest1);
+    EXPECT_EQ(decode(decoder, "8286 84be 5886 a8eb 1064 9cbf"), kRequest2);
+    EXPECT_EQ(decode(decoder, "8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf"), kRequest3);
+}
+
+// RFC 7541 C.5: responses in a 256 byte table, the third one evicting entries
+TEST(HpackTest, DecodesResponsesWithEviction) {
+    Decoder decoder(256);
+    EXPECT_EQ(decode(decoder, "4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3120 474d "
+                              "546e 1768 7474 7073 3a2f 2f77 7777 2e65 7861 6d70 6c65 2e63 6f6d"),
+              kResponse1);
+    EXPECT_EQ(decode(decoder, "4803 3330 37c1 c0bf"), kResponse2);
+    EXPECT_EQ(decode(decoder, "88c1 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133 2032 303a 3133 3a32 3220 474d 54c0 5a04 677a 6970 7738 666f "
+                              "6f3d 4153 444a 4b48 514b 425a 584f 5157 454f 5049 5541 5851 5745 4f49 553b 206d 6178 2d61 6765 3d33 3630 303b "
+                              "2076 6572 7369 6f6e 3d31"),
+              kResponse3);
+}
+
+// RFC 7541 C.6: the same responses with Huffman coding
+TEST(HpackTest, DecodesHuffmanResponsesWithEviction) {
+    Decoder decoder(256);
+    EXPECT_EQ(decode(decoder, "4882 6402 5885 aec3 771a 4b61 96d0 7abe 9410 54d4 44a8 2005 9504 0b81 66e0 82a6 2d1b ff6e 919d 29ad 1718 63c7 "
+                              "8f0b 97c8 e9ae 82ae 43d3"),
+              kResponse1);
+    EXPECT_EQ(decode(decoder, "4883 640e ffc1 c0bf"), kResponse2);
+    EXPECT_EQ(decode(decoder, "88c1 6196 d07a be94 1054 d444 a820 0595 040b 8166 e084 a62d 1bff c05a 839b d9ab 77ad 94e7 821d d7f2 e6c7 b335 "
+                              "dfdf cd5b 3960 d5af 2708 7f36 72c1 ab27 0fb5 291f 9587 3160 65c0 03ed 4ee5 b106 3d50 07"),
+              kResponse3);
+}
+
+// Test that invalid Huffman codes, including padding that is not all ones or too long, are rejected
+TEST(HpackTest, RejectsInvalidHuffman) {
+    std::string out;
+    EXPECT_TRUE(huffman_decode(unhex("f1e3 c2e5 f23a 6ba0 ab90 f4ff"), out));
+    EXPECT_EQ(out, "www.example.com");
+    out.clear();
+    EXPECT_FALSE(huffman_decode(unhex("f1e3 c2e5 f23a 6ba0 ab90 f4fe"), out));// padding with a zero bit
+    out.clear();
+    EXPECT_FALSE(huffman_decode(unhex("f1e3 c2e5 f23a 6ba0 ab90 f4ff ff"), out));// more than 7 bits of padding
+}
+
+// Test that what the encoder writes decodes back, and repeated fields shrink to table indexes
+TEST(HpackTest, EncoderRoundTrips) {
+    const std::vector<HeaderField> response = {{":status", "200"}, {"content-type", "application/json"}, {"server", "MCPServer++"},
+                                               {"mcp-session-id", "4f1c2e0a-8d7b-4c55-9a63-2b1f0e9d7c11"}, {"content-length", "1234"}};
+    Encoder encoder;
+    Decoder decoder;
+    for (int round = 0; round < 3; ++round) {
+        std::string block;
+        for (const auto &[name, value]: response) {
+            encoder.encode(name, value, block);
+        }
+        std::vector<HeaderField> fields;
+        ASSERT_TRUE(decoder.decode(block, fields));
+        EXPECT_EQ(fields, response);
+        if (round > 0) {
+            // One byte per indexed field; content-length is never indexed, its literal takes 7 bytes
+            EXPECT_EQ(block.size(), 4u + 7) << "round " << round;
+        }
+    }
+
+    // A smaller table announced by the peer is applied at the start of the next block
+    encoder.set_peer_max_table_size(0);
+    std::string block;
+    encoder.encode("custom-key", "custom-value", block);
+    EXPECT_EQ(static_cast<unsigned char>(block[0]), 0x20);// dynamic table size update to 0
+    std::vector<HeaderField> fields;
+    ASSERT_TRUE(decoder.decode(block, fields));
+    EXPECT_EQ(fields, (std::vector<HeaderField>{{"custom-key", "custom-value"}}));
+}
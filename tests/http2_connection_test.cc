@@ -0,0 +1,208 @@
+#include "transport/hpack.h"
+#include "transport/http2_connection.h"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mcp::transport;
+
+namespace {
+    constexpr uint8_t kData = 0x0, kHeaders = 0x1, kRstStream = 0x3, kSettings = 0x4, kPing = 0x6, kGoaway = 0x7,
+                      kWindowUpdate = 0x8, kContinuation = 0x9;
+    constexpr uint8_t kEndStream = 0x1, kAck = 0x1, kEndHeaders = 0x4, kPadded = 0x8;
+
+    // Session replaying what a client sent and recording what the connection writes back
+    class ScriptedSession : public Session {
+    public:
+        ScriptedSession(asio::io_context &io, std::string input) : io_(io), input_(std::move(input)) {}
+
+        asio::awaitable<void> start(HttpHandler *) override { co_return; }
+        void close() override { closed_ = true; }
+        bool is_closed() const override { return closed_; }
+        asio::any_io_executor get_executor() override { return io_.get_executor(); }
+        asio::awaitable<void> wait_for_disconnect() override { co_return; }
+        const std::string &get_session_id() const override { return id_; }
+
+        // Everything the client sent, then the end of the connection
+        asio::awaitable<size_t> read_some(asio::mutable_buffer buffer) override {
+            size_t n = std::min(buffer.size(), input_.size() - offset_);
+            std::memcpy(buffer.data(), input_.data() + offset_, n);
+            offset_ += n;
+            co_return n;
+        }
+
+        std::string output;
+
+    protected:
+        asio::awaitable<void> write_now(std::span<const asio::const_buffer> buffers) override {
+            for (const auto &buffer: buffers) {
+                output.append(static_cast<const char *>(buffer.data()), buffer.size());
+            }
+            co_return;
+        }
+
+    private:
+        asio::io_context &io_;
+        std::string input_;
+        size_t offset_ = 0;
+        std::string id_ = "h2-test";
+        bool closed_ = false;
+    };
+
+    struct Frame {
+        uint8_t type;
+        uint8_t flags;
+        uint32_t stream_id;
+        std::string payload;
+
+        uint32_t u32() const {
+            auto *bytes = reinterpret_cast<const unsigned char *>(payload.data());
+            return (uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 | uint32_t(bytes[3])) & 0x7fffffff;
+        }
+    };
+
+    void put_u32(std::string &out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(value >> shift));
+        }
+    }
+
+    std::string frame(uint8_t type, uint8_t flags, uint32_t stream_id, std::string_view payload) {
+        std::string out;
+        out.push_back(static_cast<char>(payload.size() >> 16));
+        out.push_back(static_cast<char>(payload.size() >> 8));
+        out.push_back(static_cast<char>(payload.size()));
+        out.push_back(static_cast<char>(type));
+        out.push_back(static_cast<char>(flags));
+        put_u32(out, stream_id);
+        out.append(payload);
+        return out;
+    }
+
+    std::string u32_payload(uint32_t value) {
+        std::string out;
+        put_u32(out, value);
+        return out;
+    }
+
+    // Header block of a POST request
+    std::string request_block() {
+        hpack::Encoder encoder;
+        std::string block;
+        for (auto [name, value]: {std::pair{":method", "POST"}, {":scheme", "https"}, {":path", "/mcp"}, {":authority", "localhost"}}) {
+            encoder.encode(name, value, block);
+        }
+        return block;
+    }
+
+    // Serve a connection over what the client sent and parse the frames it answered with
+    std::vector<Frame> serve(std::string client_frames, Http2Options options = {}) {
+        asio::io_context io;
+        std::string input = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n" + frame(kSettings, 0, 0, {}) + client_frames;
+        auto session = std::make_shared<ScriptedSession>(io, std::move(input));
+        options.enabled = true;
+        auto connection = std::make_shared<Http2Connection>(session, options);
+        asio::co_spawn(io, connection->run(nullptr), asio::detached);
+        io.run();
+
+        std::vector<Frame> frames;
+        std::string_view out = session->output;
+        while (out.size() >= 9) {
+            auto *bytes = reinterpret_cast<const unsigned char *>(out.data());
+            size_t length = size_t(bytes[0]) << 16 | size_t(bytes[1]) << 8 | bytes[2];
+            Frame parsed{bytes[3], bytes[4], (uint32_t(bytes[5]) << 24 | uint32_t(bytes[6]) << 16 | uint32_t(bytes[7]) << 8 | bytes[8]) & 0x7fffffff,
+                         std::string(out.substr(9, length))};
+            frames.push_back(std::move(parsed));
+            out.remove_prefix(9 + length);
+        }
+        EXPECT_TRUE(out.empty()) << "truncated frame";
+        return frames;
+    }
+
+    const Frame *find(const std::vector<Frame> &frames, uint8_t type, uint32_t stream_id, size_t skip = 0) {
+        for (const auto &frame: frames) {
+            if (frame.type == type && frame.stream_id == stream_id && skip-- == 0) {
+                return &frame;
+            }
+        }
+        return nullptr;
+    }
+}// namespace
+
+// Test that padding is stripped and still counts against both flow control windows
+TEST(Http2ConnectionTest, PaddingCountsAgainstFlowControl) {
+    std::string headers = std::string(1, '\x03') + request_block() + std::string(3, '\0');
+    std::string data = std::string(1, '\x0a') + "hello" + std::string(10, '\0');
+    auto frames = serve(frame(kHeaders, kEndHeaders | kPadded, 1, headers) + frame(kData, kPadded, 1, data));
+
+    EXPECT_EQ(find(frames, kGoaway, 0), nullptr);
+    const Frame *connection_update = find(frames, kWindowUpdate, 0, 1);// the first one opens the connection window
+    ASSERT_NE(connection_update, nullptr);
+    EXPECT_EQ(connection_update->u32(), data.size());
+    const Frame *stream_update = find(frames, kWindowUpdate, 1);
+    ASSERT_NE(stream_update, nullptr);
+    EXPECT_EQ(stream_update->u32(), data.size());
+}
+
+// Test that padding longer than the frame is a connection error
+TEST(Http2ConnectionTest, RejectsPaddingLongerThanPayload) {
+    auto frames = serve(frame(kHeaders, kEndHeaders, 1, request_block()) + frame(kData, kPadded, 1, std::string(1, '\x14') + "hello"));
+    const Frame *goaway = find(frames, kGoaway, 0);
+    ASSERT_NE(goaway, nullptr);
+    EXPECT_EQ(goaway->payload.substr(4), u32_payload(0x1));// PROTOCOL_ERROR
+}
+
+// Test that a header block split over HEADERS and CONTINUATION opens the stream
+TEST(Http2ConnectionTest, JoinsContinuationFrames) {
+    std::string block = request_block();
+    std::string first = block.substr(0, block.size() / 2);
+    std::string rest = block.substr(block.size() / 2);
+    auto frames = serve(frame(kHeaders, 0, 1, first) + frame(kContinuation, kEndHeaders, 1, rest) + frame(kData, 0, 1, "abcd"));
+
+    EXPECT_EQ(find(frames, kGoaway, 0), nullptr);
+    const Frame *stream_update = find(frames, kWindowUpdate, 1);
+    ASSERT_NE(stream_update, nullptr);// the DATA reached an open stream
+    EXPECT_EQ(stream_update->u32(), 4u);
+}
+
+// Test that any other frame inside a header block is a connection error
+TEST(Http2ConnectionTest, RejectsFramesInsideHeaderBlock) {
+    auto frames = serve(frame(kHeaders, 0, 1, request_block()) + frame(kPing, 0, 0, std::string(8, '\0')));
+    const Frame *goaway = find(frames, kGoaway, 0);
+    ASSERT_NE(goaway, nullptr);
+    EXPECT_EQ(goaway->payload.substr(4), u32_payload(0x1));// PROTOCOL_ERROR
+    EXPECT_EQ(find(frames, kPing, 0), nullptr);
+}
+
+// Test that a connection window growing past 2^31-1 is a flow control error
+TEST(Http2ConnectionTest, RejectsWindowOverflow) {
+    auto frames = serve(frame(kWindowUpdate, 0, 0, u32_payload(0x7fffffff)));
+    const Frame *goaway = find(frames, kGoaway, 0);
+    ASSERT_NE(goaway, nullptr);
+    EXPECT_EQ(goaway->payload.substr(4), u32_payload(0x3));// FLOW_CONTROL_ERROR
+}
+
+// Test that trailers of a refused stream only reset that stream, the connection stays up
+TEST(Http2ConnectionTest, IgnoresTrailersOfRefusedStream) {
+    Http2Options options;
+    options.max_concurrent_streams = 1;
+    auto frames = serve(frame(kHeaders, kEndHeaders, 1, request_block()) +
+                                frame(kHeaders, kEndHeaders, 3, request_block()) +
+                                frame(kHeaders, kEndHeaders | kEndStream, 3, request_block()) +
+                                frame(kPing, 0, 0, "pingpong"),
+                        options);
+
+    EXPECT_EQ(find(frames, kGoaway, 0), nullptr);
+    const Frame *refused = find(frames, kRstStream, 3);
+    ASSERT_NE(refused, nullptr);
+    EXPECT_EQ(refused->u32(), 0x7u);// REFUSED_STREAM
+    const Frame *closed = find(frames, kRstStream, 3, 1);
+    ASSERT_NE(closed, nullptr);
+    EXPECT_EQ(closed->u32(), 0x5u);// STREAM_CLOSED
+    const Frame *pong = find(frames, kPing, 0);
+    ASSERT_NE(pong, nullptr);
+    EXPECT_EQ(pong->flags, kAck);
+    EXPECT_EQ(pong->payload, "pingpong");
+}
@@ -0,0 +1,187 @@
+#include "transport/header_map.h"
+#include "transport/http_framer.h"
+#include "transport/http_parser.h"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mcp::transport;
+
+// Test parsing a complete request delivered in one piece
+TEST(HttpRequestParserTest, ParsesCompleteRequest) {
+    const std::string raw = "POST /mcp HTTP/1.1\r\n"
+                            "Host: localhost\r\n"
+                            "content-length: 14\r\n"
+                            "Accept:  text/event-stream \r\n"
+                            "\r\n"
+                      "{\"id\":1,\"a\":2}";
+
+    HttpRequestParser parser;
+    ASSERT_EQ(parser.parse(raw), HttpRequestParser::Status::Complete);
+
+    const auto &req = parser.request();
+    EXPECT_EQ(req.method, "POST");
+    EXPECT_EQ(req.target, "/mcp");
+    EXPECT_EQ(req.version, "HTTP/1.1");
+    EXPECT_EQ(req.header_count, 3u);
+    EXPECT_EQ(req.get_header("Content-Length"), "14");
+    EXPECT_EQ(req.get_header("ACCEPT"), "text/event-stream");
+    EXPECT_TRUE(req.has_header("host"));
+    EXPECT_FALSE(req.has_header("X-API-Key"));
+    EXPECT_EQ(req.body, "{\"id\":1,\"a\":2}");
+    EXPECT_EQ(parser.message_size(), raw.size());
+
+    // Views point into the caller's buffer, nothing is copied
+    EXPECT_EQ(req.body.data(), raw.data() + parser.header_size());
+}
+
+// Test resuming a request that arrives byte by byte
+TEST(HttpRequestParserTest, ResumesAcrossPartialReads) {
+    const std::string raw = "POST /tools/call HTTP/1.1\r\n"
+                            "Content-Length: 2\r\n"
+                            "\r\n"
+                            "{}";
+
+    HttpRequestParser parser;
+    std::string buffer;
+    for (size_t i = 0; i + 1 < raw.size(); ++i) {
+        buffer.push_back(raw[i]);
+        ASSERT_EQ(parser.parse(buffer), HttpRequestParser::Status::Incomplete) << "at byte " << i;
+    }
+    buffer.push_back(raw.back());
+    ASSERT_EQ(parser.parse(buffer), HttpRequestParser::Status::Complete);
+    EXPECT_EQ(parser.request().target, "/tools/call");
+    EXPECT_EQ(parser.request().body, "{}");
+}
+
+// Test that trailing pipelined bytes are not part of the request
+TEST(HttpRequestParserTest, StopsAtMessageBoundary) {
+    const std::string raw = "GET /mcp HTTP/1.1\r\n\r\nGET /mcp HTTP/1.1\r\n\r\n";
+
+    HttpRequestParser parser;
+    ASSERT_EQ(parser.parse(raw), HttpRequestParser::Status::Complete);
+    EXPECT_EQ(parser.message_size(), raw.size() / 2);
+    EXPECT_TRUE(parser.request().body.empty());
+
+    size_t consumed = parser.message_size();
+    parser.reset();
+    ASSERT_EQ(parser.parse(std::string_view(raw).substr(consumed)), HttpRequestParser::Status::Complete);
+    EXPECT_EQ(parser.message_size(), raw.size() - consumed);
+}
+
+// Test rejection of malformed input
+TEST(HttpRequestParserTest, RejectsMalformedRequests) {
+    HttpRequestParser parser;
+    EXPECT_EQ(parser.parse("GARBAGE\r\n\r\n"), HttpRequestParser::Status::Error);
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("POST /mcp HTTP/1.1\r\nContent-Length: abc\r\n\r\n"), HttpRequestParser::Status::Error);
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("POST /mcp HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"),
+              HttpRequestParser::Status::Error);
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("POST /mcp FTP/1.0\r\n\r\n"), HttpRequestParser::Status::Error);
+}
+
+// Test in-place decoding of a chunked body split across reads
+TEST(HttpRequestParserTest, DecodesChunkedBodyInPlace) {
+    std::string raw = "POST /mcp HTTP/1.1\r\n"
+                      "Transfer-Encoding: chunked\r\n"
+                      "\r\n"
+                      "4;ext=1\r\n{\"id\r\n"
+                      "6\r\n\":7}  \r\n"
+                      "0\r\n"
+                      "X-Trailer: ignored\r\n"
+                      "\r\n";
+
+    HttpRequestParser parser;
+    EXPECT_EQ(parser.parse(std::string_view(raw)), HttpRequestParser::Status::Error);
+
+    parser.reset();
+    std::string buffer = raw.substr(0, 50);
+    ASSERT_EQ(parser.parse(buffer.data(), buffer.size()), HttpRequestParser::Status::Incomplete);
+    buffer += raw.substr(50);
+    ASSERT_EQ(parser.parse(buffer.data(), buffer.size()), HttpRequestParser::Status::Complete);
+    EXPECT_TRUE(parser.is_chunked());
+    EXPECT_EQ(parser.request().body, "{\"id\":7}  ");
+    EXPECT_EQ(parser.content_length(), 10u);
+    EXPECT_EQ(parser.message_size(), raw.size());
+}
+
+// Test framing of pipelined requests that arrive in arbitrary fragments
+TEST(HttpRequestFramerTest, FramesPipelinedRequests) {
+    const std::string wire = "POST /mcp HTTP/1.1\r\nContent-Length: 7\r\n\r\n{\"a\":1}"
+                             "POST /mcp HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n{}\r\n0\r\n\r\n"
+                             "GET /mcp HTTP/1.1\r\nAccept: text/event-stream\r\n\r\n";
+
+    HttpRequestFramer framer;
+    std::vector<std::string> bodies;
+    std::vector<std::string> methods;
+    for (size_t offset = 0; offset < wire.size(); offset += 5) {
+        size_t n = std::min<size_t>(5, wire.size() - offset);
+        auto buffer = framer.prepare();
+        ASSERT_GE(buffer.size(), n);
+        std::memcpy(buffer.data(), wire.data() + offset, n);
+        framer.commit(n);
+
+        while (framer.next() == HttpRequestParser::Status::Complete) {
+            methods.emplace_back(framer.request().method);
+            bodies.emplace_back(framer.request().body);
+            framer.consume();
+        }
+    }
+
+    ASSERT_EQ(methods.size(), 3u);
+    EXPECT_EQ(methods[2], "GET");
+    EXPECT_EQ(bodies[0], "{\"a\":1}");
+    EXPECT_EQ(bodies[1], "{}");
+    EXPECT_TRUE(bodies[2].empty());
+    EXPECT_EQ(framer.buffered(), 0u);
+}
+
+// Test that the framer sizes reads for a known body and releases its buffer when idle
+TEST(HttpRequestFramerTest, SizesReadsForKnownBodyLength) {
+    const std::string head = "POST /mcp HTTP/1.1\r\nContent-Length: 200000\r\n\r\n";
+
+    HttpRequestFramer framer;
+    auto buffer = framer.prepare();
+    ASSERT_GE(buffer.size(), head.size());
+    std::memcpy(buffer.data(), head.data(), head.size());
+    framer.commit(head.size());
+    ASSERT_EQ(framer.next(), HttpRequestParser::Status::Incomplete);
+
+    // The rest of the body fits in a single read
+    buffer = framer.prepare();
+    ASSERT_GE(buffer.size(), 200000u);
+    std::memset(buffer.data(), 'x', 200000);
+    framer.commit(200000);
+    ASSERT_EQ(framer.next(), HttpRequestParser::Status::Complete);
+    EXPECT_EQ(framer.request().body.size(), 200000u);
+
+    framer.consume();
+    EXPECT_EQ(framer.buffered(), 0u);
+}
+
+// Header lookups ignore case, and clearing keeps the storage for the next request
+TEST(HeaderMapTest, CaseInsensitiveLookup) {
+    HeaderMap headers;
+    headers.emplace("content-length", "14");
+    headers.emplace("X-API-Key", "secret");
+    headers.emplace("x-api-key", "ignored");
+
+    EXPECT_EQ(headers.size(), 2u);
+    EXPECT_EQ(headers.get("Content-Length"), "14");
+    EXPECT_EQ(headers.at("X-Api-Key"), "secret");
+    EXPECT_EQ(headers.find("Authorization"), headers.end());
+    EXPECT_TRUE(headers.get("[").empty());
+
+    headers.clear();
+    EXPECT_TRUE(headers.empty());
+    EXPECT_FALSE(headers.contains("content-length"));
+    headers.emplace("Accept", "text/event-stream");
+    EXPECT_EQ(headers.get("accept"), "text/event-stream");
+}
@@ -0,0 +1,131 @@
+#include "business/idempotency_cache.h"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using mcp::business::IdempotencyCache;
+using mcp::protocol::Response;
+namespace error_code = mcp::protocol::error_code;
+
+namespace {
+    // Runs one request through the cache on its own io_context
+    Response call_once(const std::string &scope, const std::string &key, const std::string &tool, const nlohmann::json &args,
+                       const nlohmann::json &id, const IdempotencyCache::Call &call) {
+        asio::io_context io;
+        Response response;
+        std::function<asio::awaitable<void>()> request = [&]() -> asio::awaitable<void> {
+            response = co_await IdempotencyCache::instance().call(scope, key, tool, args, id, call);
+        };
+        asio::co_spawn(io, request, asio::detached);
+        io.run();
+        return response;
+    }
+
+    // Call that counts its runs and answers with the sum of its arguments
+    IdempotencyCache::Call counting_call(int &runs, bool fail = false) {
+        return [&runs, fail]() -> asio::awaitable<Response> {
+            ++runs;
+            if (fail) {
+                co_return Response{mcp::protocol::Error{error_code::INTERNAL_ERROR, "tool failed"}, nullptr};
+            }
+            co_return Response{nlohmann::json{{"sum", 3}}, nullptr};
+        };
+    }
+
+    // The result a response carries, whether spliced or not
+    nlohmann::json result_of(const Response &response) {
+        return response.raw_result ? nlohmann::json::parse(*response.raw_result) : response.result;
+    }
+}// namespace
+
+// Test that a retry after the call finished is answered from the kept result
+TEST(IdempotencyCacheTest, ReplaysTheKeptResult) {
+    int runs = 0;
+    nlohmann::json args = {{"a", 1}, {"b", 2}};
+    auto first = call_once("replay", "key-1", "add", args, 1, counting_call(runs));
+    auto retry = call_once("replay", "key-1", "add", args, 2, counting_call(runs));
+
+    EXPECT_EQ(runs, 1);
+    EXPECT_FALSE(retry.error.has_value());
+    EXPECT_EQ(retry.id, 2);
+    EXPECT_EQ(result_of(retry), result_of(first));
+
+    // Keys belong to their scope, another caller with the same key runs the tool
+    call_once("other scope", "key-1", "add", args, 3, counting_call(runs));
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(IdempotencyCacheTest, FailedCallsRunAgain) {
+    int runs = 0;
+    auto first = call_once("failures", "key-1", "add", nlohmann::json::object(), 1, counting_call(runs, true));
+    ASSERT_TRUE(first.error.has_value());
+    auto retry = call_once("failures", "key-1", "add", nlohmann::json::object(), 2, counting_call(runs));
+    EXPECT_EQ(runs, 2);
+    EXPECT_FALSE(retry.error.has_value());
+}
+
+// Test that retries arriving while the first call runs wait for it instead of running the tool again
+TEST(IdempotencyCacheTest, JoinsTheCallInFlight) {
+    asio::io_context io;
+    int runs = 0;
+    IdempotencyCache::Call slow = [&runs]() -> asio::awaitable<Response> {
+        ++runs;
+        asio::steady_timer timer(co_await asio::this_coro::executor, std::chrono::milliseconds(50));
+        co_await timer.async_wait(asio::use_awaitable);
+        co_return Response{nlohmann::json{{"sum", 3}}, nullptr};
+    };
+
+    std::vector<Response> responses(3);
+    const std::string scope = "in flight", key = "key-1", tool = "add";
+    const nlohmann::json args = {{"a", 1}};
+    for (int i = 0; i < 3; ++i) {
+        std::function<asio::awaitable<void>()> request = [&, i]() -> asio::awaitable<void> {
+            responses[i] = co_await IdempotencyCache::instance().call(scope, key, tool, args, i, slow);
+        };
+        asio::co_spawn(io, request, asio::detached);
+    }
+    io.run();
+
+    EXPECT_EQ(runs, 1);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_FALSE(responses[i].error.has_value());
+        EXPECT_EQ(responses[i].id, i);
+        EXPECT_EQ(result_of(responses[i]), (nlohmann::json{{"sum", 3}}));
+    }
+}
+
+// Test that a key reused for another tool or other arguments is refused with -32602
+TEST(IdempotencyCacheTest, RefusesAKeyReusedForAnotherCall) {
+    int runs = 0;
+    call_once("mismatch", "key-1", "add", {{"a", 1}}, 1, counting_call(runs));
+
+    auto other_args = call_once("mismatch", "key-1", "add", {{"a", 2}}, 2, counting_call(runs));
+    ASSERT_TRUE(other_args.error.has_value());
+    EXPECT_EQ(other_args.error->code, error_code::INVALID_PARAMS);
+    EXPECT_EQ(other_args.id, 2);
+
+    auto other_tool = call_once("mismatch", "key-1", "subtract", {{"a", 1}}, 3, counting_call(runs));
+    ASSERT_TRUE(other_tool.error.has_value());
+    EXPECT_EQ(other_tool.error->code, error_code::INVALID_PARAMS);
+    EXPECT_EQ(runs, 1);
+
+    // Objects compare by content, not by the order of their keys
+    call_once("mismatch", "key-2", "add", {{"a", 1}, {"b", 2}}, 4, counting_call(runs));
+    auto same = call_once("mismatch", "key-2", "add", nlohmann::json::parse(R"({"b":2,"a":1})"), 5, counting_call(runs));
+    EXPECT_FALSE(same.error.has_value());
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(IdempotencyCacheTest, TakesTheKeyFromTheHeaderOrMeta) {
+    mcp::transport::HeaderMap headers{{"Idempotency-Key", "from-header"}};
+    nlohmann::json params = {{"_meta", {{"idempotencyKey", "from-meta"}}}};
+    EXPECT_EQ(IdempotencyCache::key_of(params, &headers), "from-header");
+    EXPECT_EQ(IdempotencyCache::key_of(params, nullptr), "from-meta");
+    EXPECT_EQ(IdempotencyCache::key_of(nlohmann::json::object(), nullptr), "");
+
+    nlohmann::json long_key = {{"_meta", {{"idempotencyKey", std::string(256, 'k')}}}};
+    EXPECT_EQ(IdempotencyCache::key_of(long_key, nullptr), "");
+}
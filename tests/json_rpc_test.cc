@@ -0,0 +1,222 @@
+#include "protocol/json_rpc.h"
+#include "utils/utf8.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mcp::protocol;
+
+// Test that the envelope members are located as raw spans of the message
+TEST(RequestEnvelopeTest, LocatesMembers) {
+    const std::string text = R"( {"jsonrpc":"2.0", "id" : 7,"method":"tools/call","params":{"name":"echo","arguments":{"text":"}"}}} )";
+
+    auto envelope = scan_request_envelope(text);
+    ASSERT_TRUE(envelope.has_value());
+    EXPECT_EQ(envelope->jsonrpc, "\"2.0\"");
+    EXPECT_EQ(envelope->method, "\"tools/call\"");
+    EXPECT_EQ(envelope->id, "7");
+    EXPECT_EQ(envelope->params, R"({"name":"echo","arguments":{"text":"}"}})");
+    EXPECT_TRUE(envelope->has_id());
+    EXPECT_EQ(envelope->params.data(), text.data() + text.find("{\"name\""));
+
+    EXPECT_EQ(find_member(envelope->params, "name"), "\"echo\"");
+    EXPECT_EQ(find_member(envelope->params, "arguments"), R"({"text":"}"})");
+    EXPECT_TRUE(find_member(envelope->params, "missing").empty());
+}
+
+// Test that a message without id is a notification
+TEST(RequestEnvelopeTest, NotificationHasNoId) {
+    auto envelope = scan_request_envelope(R"({"jsonrpc":"2.0","method":"notifications/initialized"})");
+    ASSERT_TRUE(envelope.has_value());
+    EXPECT_FALSE(envelope->has_id());
+    EXPECT_TRUE(envelope->params.empty());
+
+    // An explicit null id is still an id
+    envelope = scan_request_envelope(R"({"jsonrpc":"2.0","method":"ping","id":null})");
+    ASSERT_TRUE(envelope.has_value());
+    EXPECT_EQ(envelope->id, "null");
+}
+
+// Test that malformed JSON and non-objects are rejected
+TEST(RequestEnvelopeTest, RejectsMalformedText) {
+    const char *bad[] = {
+            "", "[]", "\"x\"", "{", "{\"a\":}", "{\"a\":1,}", "{\"a\" 1}", "{\"a\":01}", "{\"a\":1.}",
+            "{\"a\":-}", "{\"a\":tru}", "{\"a\":\"\\x\"}", "{\"a\":\"\\u12\"}", "{\"a\":[1,]}",
+            "{\"a\":1} x", "{\"a\":\"line\nbreak\"}", "{1:2}"};
+    for (const char *text: bad) {
+        EXPECT_FALSE(scan_request_envelope(text).has_value()) << text;
+    }
+    EXPECT_TRUE(scan_request_envelope(R"({"a":[-0.5e+3,true,false,null,{"b":[]},"\u00e9\n"]})").has_value());
+}
+
+// Test that later duplicates win, as with a full parse
+TEST(RequestEnvelopeTest, LaterDuplicateWins) {
+    auto envelope = scan_request_envelope(R"({"method":"a","method":"b"})");
+    ASSERT_TRUE(envelope.has_value());
+    EXPECT_EQ(decode_string(envelope->method), "b");
+}
+
+// Test decoding raw strings with and without escapes
+TEST(RequestEnvelopeTest, DecodesStrings) {
+    EXPECT_EQ(decode_string("\"plain\""), "plain");
+    EXPECT_EQ(decode_string(R"("tab\tquote\" \u00e9")"), "tab\tquote\" \xc3\xa9");
+    EXPECT_FALSE(decode_string("42").has_value());
+    EXPECT_FALSE(decode_string("").has_value());
+}
+
+// Test that parse_request gives the same results and errors through the envelope path
+TEST(ParseRequestTest, ParsesThroughEnvelope) {
+    auto [request, error] = parse_request(R"({"jsonrpc":"2.0","id":"a","method":"tools/call","params":{"name":"echo"}})");
+    ASSERT_TRUE(request.has_value());
+    EXPECT_FALSE(error.has_value());
+    EXPECT_EQ(request->method, "tools/call");
+    EXPECT_EQ(request->id, nlohmann::json("a"));
+    EXPECT_EQ(request->params["name"], "echo");
+
+    auto [no_params, no_params_error] = parse_request(R"({"jsonrpc":"2.0","method":"ping"})");
+    ASSERT_TRUE(no_params.has_value());
+    EXPECT_FALSE(no_params->id.has_value());
+    EXPECT_TRUE(no_params->params.is_null());
+
+    EXPECT_EQ(parse_request("{\"jsonrpc\":").second->code, error_code::PARSE_ERROR);
+    EXPECT_EQ(parse_request("[1]").second->code, error_code::INVALID_REQUEST);
+    EXPECT_EQ(parse_request(R"({"jsonrpc":"1.0","method":"x","id":3})").second->id, nlohmann::json(3));
+    EXPECT_EQ(parse_request(R"({"jsonrpc":"2.0","method":5})").second->code, error_code::INVALID_REQUEST);
+    EXPECT_EQ(parse_request(R"({"jsonrpc":"2.0","method":"x","id":[1]})").second->code, error_code::INVALID_REQUEST);
+
+    // Invalid UTF-8 anywhere is a parse error, as with the full parser
+    const char *invalid[] = {
+            "{\"jsonrpc\":\"2.0\",\"method\":\"x\",\"params\":\"\xff\"}",
+            "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/\xc3\"}",
+            "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\",\"\xed\xa0\x80\":1}",
+            "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\",\"extra\":[\"\xc0\xaf\"]}",
+            "{\"jsonrpc\":\"2.0\",\"id\":\"\xf5\x80\x80\x80\",\"method\":\"ping\"}"};
+    for (const char *text: invalid) {
+        auto [invalid_request, invalid_error] = parse_request(text);
+        EXPECT_FALSE(invalid_request.has_value()) << text;
+        ASSERT_TRUE(invalid_error.has_value()) << text;
+        EXPECT_EQ(invalid_error->code, error_code::PARSE_ERROR) << text;
+    }
+}
+
+// Test that the scanner and decode_string reject invalid UTF-8 in strings and keys
+TEST(RequestEnvelopeTest, RejectsInvalidUtf8) {
+    EXPECT_FALSE(scan_request_envelope("{\"method\":\"\xff\"}").has_value());
+    EXPECT_FALSE(scan_request_envelope("{\"\xe2\x82\":1}").has_value());
+    EXPECT_FALSE(scan_request_envelope("{\"skipped\":{\"a\":\"\x80\"}}").has_value());
+    EXPECT_TRUE(scan_request_envelope("{\"method\":\"\xe2\x82\xac\xf0\x9f\x98\x80\"}").has_value());
+    EXPECT_FALSE(decode_string("\"\xff\"").has_value());
+    EXPECT_FALSE(decode_string("\"\\n\xff\"").has_value());
+}
+
+// Test that a batch is split into the raw texts of its entries
+TEST(RequestEnvelopeTest, SplitsBatch) {
+    const std::string text = R"( [{"jsonrpc":"2.0","id":1,"method":"ping"}, 5 ,{"jsonrpc":"2.0","method":"a","params":["]"]}] )";
+
+    auto batch = scan_batch(text);
+    ASSERT_TRUE(batch.has_value());
+    ASSERT_EQ(batch->size(), 3u);
+    EXPECT_EQ((*batch)[0], R"({"jsonrpc":"2.0","id":1,"method":"ping"})");
+    EXPECT_EQ((*batch)[1], "5");
+    EXPECT_EQ((*batch)[2], R"({"jsonrpc":"2.0","method":"a","params":["]"]})");
+    EXPECT_TRUE(scan_request_envelope((*batch)[0])->has_id());
+
+    ASSERT_TRUE(scan_batch(" [ ] ").has_value());
+    EXPECT_TRUE(scan_batch("[]")->empty());
+    EXPECT_FALSE(scan_batch(R"({"jsonrpc":"2.0"})").has_value());
+    EXPECT_FALSE(scan_batch("[{},]").has_value());
+    EXPECT_FALSE(scan_batch("[{}] x").has_value());
+}
+
+// Test that the response writer produces what serializing the JSON DOM did
+TEST(ResponseWriterTest, MatchesDomSerialization) {
+    auto dom_response = [](const nlohmann::json &id, const nlohmann::json &result) {
+        return nlohmann::json{{"jsonrpc", "2.0"}, {"id", id}, {"result", result}}.dump();
+    };
+    auto dom_error = [](const nlohmann::json &id, int code, const std::string &message, const nlohmann::json *data) {
+        nlohmann::json error{{"code", code}, {"message", message}};
+        if (data) {
+            error["data"] = *data;
+        }
+        return nlohmann::json{{"jsonrpc", "2.0"}, {"id", id}, {"error", error}}.dump();
+    };
+
+    nlohmann::json result{{"content", {{{"type", "text"}, {"text", "a\"b\\c\n\x01 \xc3\xa9"}}}}};
+    EXPECT_EQ(make_response(Response{result, 7}), dom_response(7, result));
+    EXPECT_EQ(make_response(Response{result, "req-1"}), dom_response("req-1", result));
+
+    nlohmann::json data{{"details", 12}};
+    const std::string message = "Tool \"x\"\tnot found\x1f";
+    EXPECT_EQ(make_response(Response{Error{-32601, message}, 3}), dom_error(3, -32601, message, nullptr));
+    EXPECT_EQ(make_error(-32700, "Parse error: \xc3\xa9", nlohmann::json(nullptr), data),
+              dom_error(nullptr, -32700, "Parse error: \xc3\xa9", &data));
+    EXPECT_EQ(make_error(-32600, "Invalid"), dom_error(nullptr, -32600, "Invalid", nullptr));
+
+    // Pre-serialized results are spliced in; an error still wins over them
+    Response spliced;
+    spliced.id = 1;
+    spliced.raw_result = std::make_shared<const std::string>(R"({"tools":[]})");
+    EXPECT_EQ(make_response(spliced), R"({"id":1,"jsonrpc":"2.0","result":{"tools":[]}})");
+    spliced.error = Error{-32603, "failed"};
+    EXPECT_EQ(make_response(spliced), dom_error(1, -32603, "failed", nullptr));
+
+    std::string buffer = "[";
+    write_response(buffer, Response{nlohmann::json::object(), 2});
+    EXPECT_EQ(buffer, R"([{"id":2,"jsonrpc":"2.0","result":{}})");
+}
+// Test that a value serialized a piece at a time is the text dump() produces
+TEST(JsonPieceWriterTest, MatchesDump) {
+    std::string long_text(5000, 'x');
+    for (size_t i = 0; i < long_text.size(); i += 7) {
+        long_text.replace(i, 2, "\xc3\xa9");// a two-byte sequence every few bytes, some on a piece boundary
+    }
+    long_text += "\"\n";
+    nlohmann::json value{{"content", {{{"type", "text"}, {"text", long_text}}, {{"type", "json"}, {"data", {1, 2.5, nullptr, true, "\x01"}}}}},
+                         {"empty", nlohmann::json::object()},
+                         {"list", nlohmann::json::array()},
+                         {"n", -3}};
+
+    for (size_t max_bytes: {1, 17, 100, 4096, 1 << 20}) {
+        JsonPieceWriter writer(value);
+        std::string text;
+        size_t pieces = 0;
+        bool more = true;
+        while (more) {
+            size_t before = text.size();
+            more = writer.next(text, max_bytes);
+            ++pieces;
+            EXPECT_GT(text.size(), before);
+        }
+        EXPECT_EQ(text, value.dump()) << "max_bytes " << max_bytes;
+        if (max_bytes == 100) {
+            EXPECT_GE(pieces, text.size() / 200);// the long string is sliced, not written whole
+        }
+    }
+
+    JsonPieceWriter scalar(nlohmann::json(42));
+    std::string text;
+    EXPECT_FALSE(scalar.next(text, 1));
+    EXPECT_EQ(text, "42");
+}
+
+// Test that a piece never ends inside a 4-byte sequence, wherever the piece boundary falls in it
+TEST(JsonPieceWriterTest, KeepsFourByteSequencesWhole) {
+    const size_t chunk = 1024;// the smallest result_stream_chunk
+    for (size_t shift = 0; shift < 4; ++shift) {
+        // The emoji starts up to three bytes before the first piece boundary inside the string
+        std::string long_text(chunk - std::string_view(R"({"text":")").size() - shift, 'x');
+        long_text += "\xf0\x9f\x98\x80";
+        long_text += std::string(3000, 'y');
+        long_text += "\xf0\xa0\x80\x80";// CJK Extension B
+        nlohmann::json value{{"text", long_text}};
+
+        JsonPieceWriter writer(value);
+        std::string text;
+        bool more = true;
+        while (more) {
+            size_t before = text.size();
+            more = writer.next(text, chunk);
+            EXPECT_TRUE(mcp::utils::utf8_valid(std::string_view(text).substr(before))) << "shift " << shift;
+        }
+        EXPECT_EQ(text, value.dump()) << "shift " << shift;
+    }
+}
@@ -0,0 +1,104 @@
+#include "transport/LRUCache.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using Astra::datastructures::LRUCache;
+using Astra::datastructures::MemoryBudget;
+
+TEST(LRUCacheTest, EvictsTheLeastRecentlyUsed) {
+    LRUCache<std::string, int> cache(3);
+    cache.Put("a", 1);
+    cache.Put("b", 2);
+    cache.Put("c", 3);
+    EXPECT_EQ(cache.Get("a"), 1);// a is now the most recently used
+    cache.Put("d", 4);
+
+    EXPECT_FALSE(cache.Contains("b"));
+    EXPECT_EQ(cache.Size(), 3u);
+    EXPECT_EQ(cache.GetKeys(), (std::vector<std::string>{"d", "a", "c"}));
+
+    cache.Put("c", 30);// Replacing a value makes it the most recent too
+    EXPECT_EQ(cache.GetKeys(), (std::vector<std::string>{"c", "d", "a"}));
+    EXPECT_EQ(cache.Get("c"), 30);
+
+    cache.setCacheCapacity(1);
+    EXPECT_EQ(cache.GetKeys(), (std::vector<std::string>{"c"}));
+}
+
+TEST(LRUCacheTest, RemovesAndClears) {
+    LRUCache<int, int> cache(16);
+    cache.BatchPut({1, 2, 3}, {10, 20, 30});
+    EXPECT_TRUE(cache.Remove(2));
+    EXPECT_FALSE(cache.Remove(2));
+    EXPECT_EQ(cache.BatchGet({1, 2, 3}), (std::vector<std::optional<int>>{10, std::nullopt, 30}));
+    EXPECT_EQ(cache.BatchRemove({1, 3, 4}), 2u);
+    EXPECT_EQ(cache.Size(), 0u);
+
+    cache.Put(5, 50);
+    cache.Clear();
+    EXPECT_FALSE(cache.Get(5).has_value());
+}
+
+// Test that the open-addressing table finds every entry after growing and after deletions
+// shifted later entries of a probe run back
+TEST(LRUCacheTest, KeepsEntriesAcrossGrowthAndDeletion) {
+    LRUCache<int, int> cache(100000);
+    for (int i = 0; i < 20000; ++i) {
+        cache.Put(i, i * 2);
+    }
+    for (int i = 0; i < 20000; i += 2) {
+        ASSERT_TRUE(cache.Remove(i));
+    }
+    EXPECT_EQ(cache.Size(), 10000u);
+    for (int i = 0; i < 20000; ++i) {
+        auto value = cache.Get(i);
+        if (i % 2 == 0) {
+            ASSERT_FALSE(value.has_value()) << i;
+        } else {
+            ASSERT_EQ(value, i * 2) << i;
+        }
+    }
+}
+
+TEST(LRUCacheTest, ExpiresEntries) {
+    LRUCache<std::string, int> cache(16, 100, std::chrono::seconds(60));
+    cache.Put("short", 1, std::chrono::seconds(1));
+    cache.Put("default", 2);
+    EXPECT_TRUE(cache.GetExpiryTime("default").has_value());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_FALSE(cache.HasKey("short"));
+    EXPECT_TRUE(cache.HasKey("default"));
+    cache.CleanUpExpiredItems();
+    EXPECT_EQ(cache.Size(), 1u);
+    EXPECT_FALSE(cache.Get("short").has_value());
+}
+
+// Test that a budgeted cache evicts to stay within its bytes, the heap of long strings included
+TEST(LRUCacheTest, StaysWithinItsMemoryBudget) {
+    LRUCache<std::string, std::string> cache(MemoryBudget{64 * 1024});
+    std::string value(4000, 'v');
+    for (int i = 0; i < 100; ++i) {
+        cache.Put("key" + std::to_string(i), value);
+        ASSERT_LE(cache.MemoryUsage(), 64u * 1024);
+    }
+    EXPECT_LT(cache.Size(), 16u);
+    EXPECT_TRUE(cache.Contains("key99"));
+    EXPECT_FALSE(cache.Contains("key0"));
+
+    cache.setByteBudget(16 * 1024);
+    EXPECT_LE(cache.MemoryUsage(), 16u * 1024);
+    EXPECT_TRUE(cache.Contains("key99"));
+}
+
+TEST(LRUCacheTest, CountsHotKeys) {
+    LRUCache<int, int> cache(16, 3);
+    cache.Put(1, 1);
+    cache.Get(1);
+    cache.Get(1);
+    EXPECT_FALSE(cache.IsHotKey(1));
+    cache.Get(1);
+    EXPECT_TRUE(cache.IsHotKey(1));
+}
@@ -1,6 +1,10 @@
 #include "core/logger.h"
+#include "metrics/metrics_manager.h"
 #include "nlohmann/json.hpp"
 #include "transport/mcp_cache.h"
+#include "transport/segment_log_backend.h"
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
@@ -394,4 +398,307 @@ TEST_F(McpCacheTest, EdgeCases) {
     }
 
     EXPECT_TRUE(mcp::cache::McpCache::GetInstance()->CleanupSession(empty_session_id));
-}
\ No newline at end of file
+}
+// Test caching a batch of serialized events
+TEST_F(McpCacheTest, StreamBatchCache) {
+    const std::string session_id = "batch_session";
+
+    SessionState state;
+    state.session_id = session_id;
+    state.tool_name = "batch_tool";
+    state.last_event_id = 0;
+    state.last_update = std::chrono::system_clock::now();
+    ASSERT_TRUE(cache->SaveSessionState(state));
+
+    std::vector<std::pair<int, std::string>> batch;
+    for (int i = 1; i <= 4; ++i) {
+        batch.emplace_back(i, generate_stream_data(i).dump());
+    }
+    ASSERT_TRUE(cache->CacheStreamBatch(session_id, batch));
+    ASSERT_TRUE(cache->CacheStreamBatch(session_id, {{5, generate_stream_data(5).dump()}}));
+
+    // The last event of the latest batch is recorded, the rest of the state is kept
+    auto restored_state = cache->GetSessionState(session_id);
+    ASSERT_TRUE(restored_state.has_value());
+    EXPECT_EQ(restored_state->last_event_id, 5);
+    EXPECT_EQ(restored_state->tool_name, "batch_tool");
+
+    auto reconnect_data = cache->GetReconnectData(session_id, 2);
+    ASSERT_EQ(reconnect_data.size(), 3);
+    for (size_t i = 0; i < reconnect_data.size(); ++i) {
+        EXPECT_EQ(reconnect_data[i]["result"]["event_id"].get<int>(), static_cast<int>(i) + 3);
+    }
+
+    // An empty batch changes nothing
+    EXPECT_TRUE(cache->CacheStreamBatch(session_id, {}));
+    EXPECT_EQ(cache->GetSessionState(session_id)->last_event_id, 5);
+}
+
+// Test that the session limit holds over all shards
+TEST_F(McpCacheTest, ShardedSessionLimit) {
+    auto count_sessions = [this](size_t shard_count) {
+        cache->Init(4, 20, std::chrono::seconds(3600), shard_count);
+        for (int i = 0; i < 16; ++i) {
+            SessionState state;
+            state.session_id = "shard_session_" + std::to_string(i);
+            state.tool_name = "shard_tool";
+            state.last_update = std::chrono::system_clock::now();
+            EXPECT_TRUE(cache->SaveSessionState(state));
+            EXPECT_TRUE(cache->CacheStreamData(state.session_id, 1, generate_stream_data(1)));
+        }
+
+        // The newest session is never the one evicted
+        EXPECT_TRUE(cache->GetSessionState("shard_session_15").has_value());
+        EXPECT_EQ(cache->GetReconnectData("shard_session_15", 0).size(), 1);
+
+        size_t present = 0;
+        for (int i = 0; i < 16; ++i) {
+            present += cache->GetSessionState("shard_session_" + std::to_string(i)).has_value() ? 1 : 0;
+        }
+        return present;
+    };
+
+    // Exact with one shard; an empty shard may admit one session over the limit
+    EXPECT_EQ(count_sessions(1), 4);
+    EXPECT_LE(count_sessions(4), 4 + 3);
+}
+
+// Test the rendered frames replayed on reconnection
+TEST_F(McpCacheTest, ReconnectFramesRing) {
+    cache->Init(10, 4, std::chrono::seconds(3600));
+    const std::string session_id = "ring_session";
+
+    std::vector<std::pair<int, std::string>> batch;
+    for (int i = 1; i <= 6; ++i) {
+        batch.emplace_back(i, json{{"n", i}}.dump());
+    }
+    ASSERT_TRUE(cache->CacheStreamBatch(session_id, batch));
+
+    // Only the newest 4 events fit, each frame is ready to be sent as is
+    auto frames = cache->GetReconnectFrames(session_id, 0);
+    ASSERT_EQ(frames.size(), 4);
+    EXPECT_EQ(frames[0], "event: message\nid: 3\ndata: {\"n\":3}\n\n");
+    EXPECT_EQ(frames[3], "event: message\nid: 6\ndata: {\"n\":6}\n\n");
+
+    frames = cache->GetReconnectFrames(session_id, 4);
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_EQ(frames[0], "event: message\nid: 5\ndata: {\"n\":5}\n\n");
+    EXPECT_TRUE(cache->GetReconnectFrames(session_id, 6).empty());
+
+    // An event arriving out of order keeps the ring sorted, a repeated one replaces the old frame
+    ASSERT_TRUE(cache->CacheStreamData(session_id, 8, json{{"n", 8}}));
+    ASSERT_TRUE(cache->CacheStreamData(session_id, 7, json{{"n", 7}}));
+    ASSERT_TRUE(cache->CacheStreamData(session_id, 8, json{{"n", 80}}));
+    auto data = cache->GetReconnectData(session_id, 0);
+    ASSERT_EQ(data.size(), 4);
+    EXPECT_EQ(data[0]["n"], 5);
+    EXPECT_EQ(data[2]["n"], 7);
+    EXPECT_EQ(data[3]["n"], 80);
+
+    EXPECT_TRUE(cache->CleanupSession(session_id));
+    EXPECT_TRUE(cache->GetReconnectFrames(session_id, 0).empty());
+}
+
+// Test that sessions survive a restart through the segment log
+TEST_F(McpCacheTest, SegmentLogRestore) {
+    auto dir = std::filesystem::temp_directory_path() / "mcp_cache_segment_test";
+    std::filesystem::remove_all(dir);
+    SegmentLogOptions options;
+    options.directory = dir.string();
+
+    // SetUp() started the cleanup thread, which uses the backend; it is stopped before the backend changes
+    cache->DetachBackend();
+    cache->SetBackend(std::make_shared<SegmentLogBackend>(options));
+    cache->Init(10, 20, std::chrono::seconds(3600), 1);
+
+    SessionState state;
+    state.session_id = "persisted_session";
+    state.tool_name = "persist_tool";
+    state.last_update = std::chrono::system_clock::now();
+    ASSERT_TRUE(cache->SaveSessionState(state));
+    for (int i = 1; i <= 5; ++i) {
+        ASSERT_TRUE(cache->CacheStreamData(state.session_id, i, generate_stream_data(i)));
+    }
+    ASSERT_TRUE(cache->UpdateSessionState(state.session_id, 5));
+
+    SessionState dropped = state;
+    dropped.session_id = "dropped_session";
+    ASSERT_TRUE(cache->SaveSessionState(dropped));
+    ASSERT_TRUE(cache->CleanupSession(dropped.session_id));
+
+    // "Restart": the old backend writes out its queue when it is detached
+    cache->DetachBackend();
+    cache->SetBackend(std::make_shared<SegmentLogBackend>(options));
+    cache->Init(10, 20, std::chrono::seconds(3600), 1);
+
+    auto restored = cache->GetSessionState(state.session_id);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->tool_name, "persist_tool");
+    EXPECT_EQ(restored->last_event_id, 5);
+    EXPECT_FALSE(cache->GetSessionState(dropped.session_id).has_value());
+
+    auto data = cache->GetReconnectData(state.session_id, 2);
+    ASSERT_EQ(data.size(), 3);
+    EXPECT_EQ(data[0]["result"]["event_id"], 3);
+    EXPECT_EQ(data[2]["result"]["event_id"], 5);
+
+    // A torn record at the end of a segment is ignored
+    cache->DetachBackend();
+    for (const auto &entry: std::filesystem::directory_iterator(dir)) {
+        std::ofstream(entry.path(), std::ios::binary | std::ios::app) << "\x40\x00";
+    }
+    cache->SetBackend(std::make_shared<SegmentLogBackend>(options));
+    cache->Init(10, 20, std::chrono::seconds(3600), 1);
+    EXPECT_EQ(cache->GetReconnectData(state.session_id, 0).size(), 5);
+
+    cache->DetachBackend();
+    cache->Init(10, 20, std::chrono::seconds(3600));
+    std::filesystem::remove_all(dir);
+}
+
+// Test the byte budget, per-tool TTLs and the cache counters
+TEST_F(McpCacheTest, ByteBudgetAndCounters) {
+    McpCacheOptions options;
+    options.max_sessions = 100;
+    options.max_data_per_session = 100;
+    options.shard_count = 1;
+    options.max_bytes = 64 * 1024;
+    options.tool_ttls = McpCacheOptions::parse_tool_ttls("uncached_tool=0, bad_entry, search = 300");
+    ASSERT_EQ(options.tool_ttls.size(), 2);
+    EXPECT_EQ(options.tool_ttls["search"], std::chrono::seconds(300));
+    cache->Init(options);
+
+    auto stats = [] { return mcp::metrics::MetricsManager::getInstance()->get_cache_stats()["mcp_cache"]; };
+    auto before = stats();
+    EXPECT_EQ(before.resident_bytes, 0);
+
+    // 4 KiB events: 16 sessions x 4 events would need 256 KiB
+    std::string chunk(4096, 'x');
+    for (int session = 0; session < 16; ++session) {
+        std::string id = "budget_session_" + std::to_string(session);
+        for (int i = 1; i <= 4; ++i) {
+            ASSERT_TRUE(cache->CacheStreamData(id, i, json{{"chunk", chunk}}));
+        }
+        EXPECT_LE(stats().resident_bytes, static_cast<int64_t>(options.max_bytes));
+    }
+    auto after = stats();
+    EXPECT_GT(after.evictions, before.evictions);
+    EXPECT_GT(after.resident_bytes, 0);
+    EXPECT_EQ(cache->GetReconnectFrames("budget_session_15", 0).size(), 4);
+    EXPECT_TRUE(cache->GetReconnectFrames("budget_session_0", 0).empty());
+
+    // A single session larger than the budget keeps its newest events
+    for (int i = 1; i <= 40; ++i) {
+        ASSERT_TRUE(cache->CacheStreamData("huge_session", i, json{{"chunk", chunk}}));
+    }
+    auto frames = cache->GetReconnectFrames("huge_session", 0);
+    ASSERT_FALSE(frames.empty());
+    EXPECT_LT(frames.size(), 40);
+    EXPECT_NE(frames.back().find("id: 40\n"), std::string::npos);
+    EXPECT_LE(stats().resident_bytes, static_cast<int64_t>(options.max_bytes));
+
+    // TTL overrides follow the tool of the session
+    SessionState state;
+    state.session_id = "uncached_session";
+    state.tool_name = "uncached_tool";
+    state.last_update = std::chrono::system_clock::now();
+    ASSERT_TRUE(cache->SaveSessionState(state));
+    EXPECT_FALSE(cache->GetSessionState(state.session_id).has_value());
+    state.session_id = "search_session";
+    state.tool_name = "search";
+    ASSERT_TRUE(cache->SaveSessionState(state));
+    EXPECT_TRUE(cache->GetSessionState(state.session_id).has_value());
+
+    after = stats();
+    EXPECT_GT(after.hits, before.hits);
+    EXPECT_GT(after.misses, before.misses);
+    EXPECT_GT(after.hit_rate, 0);
+    EXPECT_LT(after.hit_rate, 1);
+}
+
+// Test that a stream checkpoint stays with the session state, over a restart too
+TEST_F(McpCacheTest, StreamCheckpointRestore) {
+    auto dir = std::filesystem::temp_directory_path() / "mcp_cache_checkpoint_test";
+    std::filesystem::remove_all(dir);
+    SegmentLogOptions options;
+    options.directory = dir.string();
+
+    // SetUp() started the cleanup thread, which uses the backend; it is stopped before the backend changes
+    cache->DetachBackend();
+    cache->SetBackend(std::make_shared<SegmentLogBackend>(options));
+    cache->Init(10, 20, std::chrono::seconds(3600), 1);
+
+    EXPECT_FALSE(cache->SaveStreamCheckpoint("no_such_session", 1, "b2Zmc2V0"));
+
+    SessionState state;
+    state.session_id = "checkpoint_session";
+    state.tool_name = "checkpoint_tool";
+    state.last_update = std::chrono::system_clock::now();
+    ASSERT_TRUE(cache->SaveSessionState(state));
+    ASSERT_TRUE(cache->CacheStreamBatch(state.session_id, {{1, "{\"n\":1}"}, {2, "{\"n\":2}"}}));
+    ASSERT_TRUE(cache->SaveStreamCheckpoint(state.session_id, 2, "b2Zmc2V0PTI="));
+
+    // A later batch keeps the checkpoint until the next one is saved
+    ASSERT_TRUE(cache->CacheStreamBatch(state.session_id, {{3, "{\"n\":3}"}}));
+    auto current = cache->GetSessionState(state.session_id);
+    ASSERT_TRUE(current.has_value());
+    EXPECT_EQ(current->last_event_id, 3);
+    EXPECT_EQ(current->checkpoint, "b2Zmc2V0PTI=");
+    EXPECT_EQ(current->checkpoint_event_id, 2);
+
+    cache->DetachBackend();
+    cache->SetBackend(std::make_shared<SegmentLogBackend>(options));
+    cache->Init(10, 20, std::chrono::seconds(3600), 1);
+
+    auto restored = cache->GetSessionState(state.session_id);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->checkpoint, "b2Zmc2V0PTI=");
+    EXPECT_EQ(restored->checkpoint_event_id, 2);
+
+    // States written before checkpoints existed have none
+    auto old_state = SessionState::from_json(json{{"session_id", "old"}, {"tool_name", "t"}, {"last_event_id", 4}, {"is_active", true}, {"last_update", 0}});
+    EXPECT_TRUE(old_state.checkpoint.empty());
+    EXPECT_FALSE(SessionState{}.to_json().contains("checkpoint"));
+
+    cache->DetachBackend();
+    cache->Init(10, 20, std::chrono::seconds(3600));
+    std::filesystem::remove_all(dir);
+}
+
+// Test stream state committed behind the cached events
+TEST_F(McpCacheTest, StreamStateWriteBehind) {
+    SessionState state;
+    state.session_id = "write_behind_session";
+    state.tool_name = "write_behind_tool";
+    state.last_update = std::chrono::system_clock::now();
+    ASSERT_TRUE(cache->SaveSessionState(state));
+
+    McpCacheOptions options;
+    options.stream_state_commit = StreamStateCommit::End;
+    {
+        StreamStateWriter writer(state.session_id, options);
+        ASSERT_TRUE(cache->CacheStreamEvents(state.session_id, {{1, "{\"n\":1}"}, {2, "{\"n\":2}"}}));
+        writer.checkpoint(2, "b2Zmc2V0PTI=");
+        writer.sent(2);
+
+        // Not committed yet, but the newest event is reported already
+        auto current = cache->GetSessionState(state.session_id);
+        ASSERT_TRUE(current.has_value());
+        EXPECT_EQ(current->last_event_id, 2);
+        EXPECT_TRUE(current->checkpoint.empty());
+    }
+    auto committed = cache->GetSessionState(state.session_id);
+    ASSERT_TRUE(committed.has_value());
+    EXPECT_EQ(committed->last_event_id, 2);
+    EXPECT_EQ(committed->checkpoint, "b2Zmc2V0PTI=");
+    EXPECT_EQ(committed->checkpoint_event_id, 2);
+    EXPECT_EQ(cache->GetReconnectFrames(state.session_id, 0).size(), 2u);
+
+    // A commit after the session was cleaned up does not bring it back
+    cache->CleanupSession(state.session_id);
+    EXPECT_FALSE(cache->CommitStreamState(state.session_id, 3));
+    EXPECT_FALSE(cache->GetSessionState(state.session_id).has_value());
+
+    EXPECT_EQ(McpCacheOptions::parse_stream_state_commit("batch"), StreamStateCommit::Batch);
+    EXPECT_EQ(McpCacheOptions::parse_stream_state_commit("end"), StreamStateCommit::End);
+}
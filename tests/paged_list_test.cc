@@ -0,0 +1,79 @@
+#include "core/paged_list.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+using namespace mcp::core;
+
+namespace {
+    PagedList make_list(std::vector<std::string> names, uint64_t version, bool sorted) {
+        PagedList list;
+        list.version = version;
+        list.sorted = sorted;
+        list.array = "tools";
+        for (auto &name: names) {
+            list.entries.push_back(nlohmann::json{{"name", name}}.dump());
+            list.keys.push_back(std::move(name));
+        }
+        return list;
+    }
+
+    std::vector<std::string> names_of(const nlohmann::json &page) {
+        std::vector<std::string> names;
+        for (const auto &entry: page["tools"]) {
+            names.push_back(entry["name"]);
+        }
+        return names;
+    }
+}// namespace
+
+TEST(PagedListTest, WalksTheListPageByPage) {
+    auto list = make_list({"a", "b", "c", "d", "e"}, 1, true);
+
+    auto first = nlohmann::json::parse(*list.page("", 2));
+    EXPECT_EQ(names_of(first), (std::vector<std::string>{"a", "b"}));
+    auto second = nlohmann::json::parse(*list.page(first["nextCursor"].get<std::string>(), 2));
+    EXPECT_EQ(names_of(second), (std::vector<std::string>{"c", "d"}));
+    auto last = nlohmann::json::parse(*list.page(second["nextCursor"].get<std::string>(), 2));
+    EXPECT_EQ(names_of(last), (std::vector<std::string>{"e"}));
+    EXPECT_FALSE(last.contains("nextCursor"));
+}
+
+TEST(PagedListTest, SortedListResumesAfterTheLastKeyWhenItChanged) {
+    auto before = make_list({"a", "b", "c", "d"}, 1, true);
+    std::string cursor = nlohmann::json::parse(*before.page("", 2))["nextCursor"];
+
+    // "b" removed and "aa" added before the cursor: the client still gets c and d next
+    auto after = make_list({"a", "aa", "c", "d"}, 2, true);
+    EXPECT_EQ(names_of(nlohmann::json::parse(*after.page(cursor, 2))), (std::vector<std::string>{"c", "d"}));
+}
+
+TEST(PagedListTest, UnsortedListFindsTheLastKeyOrRejectsTheCursor) {
+    auto before = make_list({"x", "y", "z"}, 1, false);
+    std::string cursor = nlohmann::json::parse(*before.page("", 1))["nextCursor"];
+
+    auto appended = make_list({"x", "y", "z", "w"}, 2, false);
+    EXPECT_EQ(names_of(nlohmann::json::parse(*appended.page(cursor, 1))), (std::vector<std::string>{"y"}));
+
+    auto removed = make_list({"y", "z"}, 3, false);
+    EXPECT_FALSE(removed.page(cursor, 1).has_value());
+}
+
+TEST(PagedListTest, RejectsMalformedCursors) {
+    auto list = make_list({"a", "b"}, 1, true);
+    EXPECT_FALSE(list.page("nonsense", 1).has_value());
+    EXPECT_FALSE(list.page("1.0.a", 1).has_value());
+    EXPECT_FALSE(list.page("1.x.a", 1).has_value());
+}
+
+TEST(PagedListTest, HeadOnEveryPageTailOnTheFirst) {
+    auto list = make_list({"a", "b"}, 1, true);
+    list.head = R"("_meta":{"etag":"e"})";
+    list.first_page_tail = R"("resourceTemplates":[])";
+
+    auto first = nlohmann::json::parse(*list.page("", 1));
+    EXPECT_EQ(first["_meta"]["etag"], "e");
+    EXPECT_TRUE(first.contains("resourceTemplates"));
+    auto second = nlohmann::json::parse(*list.page(first["nextCursor"].get<std::string>(), 1));
+    EXPECT_EQ(second["_meta"]["etag"], "e");
+    EXPECT_FALSE(second.contains("resourceTemplates"));
+}
@@ -0,0 +1,130 @@
+#include "business/schema_validator.h"
+#include "business/tool_registry.h"
+#include "routers/tools_call.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using mcp::business::SchemaValidator;
+using json = nlohmann::json;
+
+namespace {
+    // Message of the first violation, "" if the value is valid
+    std::string violation(const json &schema, const json &value) {
+        auto found = SchemaValidator::compile(schema)->validate(value);
+        return found ? found->path + ": " + found->message : "";
+    }
+}// namespace
+
+TEST(SchemaValidatorTest, ChecksTypes) {
+    json schema = {{"type", "object"}, {"properties", {{"count", {{"type", "integer"}}}, {"ratio", {{"type", "number"}}}}}};
+    EXPECT_EQ(violation(schema, {{"count", 3}, {"ratio", 3}}), "");
+    EXPECT_EQ(violation(schema, {{"count", 3.0}}), "");
+    EXPECT_EQ(violation(schema, {{"count", 3.5}}), "/count: expected integer, got number");
+    EXPECT_EQ(violation(schema, json::array()), ": expected object, got array");
+    EXPECT_TRUE(SchemaValidator::compile(json::object())->trivial());
+}
+
+TEST(SchemaValidatorTest, ChecksRequiredAndEnum) {
+    json schema = {{"type", "object"},
+                   {"required", {"mode"}},
+                   {"properties", {{"mode", {{"enum", {"fast", "safe"}}}}}}};
+    EXPECT_EQ(violation(schema, {{"mode", "safe"}}), "");
+    EXPECT_EQ(violation(schema, json::object()), ": missing required property 'mode'");
+    EXPECT_EQ(violation(schema, {{"mode", "slow"}}), "/mode: must be one of [\"fast\",\"safe\"]");
+}
+
+TEST(SchemaValidatorTest, ChecksBounds) {
+    json schema = {{"type", "array"},
+                   {"maxItems", 2},
+                   {"items", {{"type", "number"}, {"minimum", 0}, {"exclusiveMaximum", 10}}}};
+    EXPECT_EQ(violation(schema, {0, 9.5}), "");
+    EXPECT_EQ(violation(schema, {-1}), "/0: must be >= 0");
+    EXPECT_EQ(violation(schema, {1, 10}), "/1: must be < 10");
+    EXPECT_EQ(violation(schema, {1, 2, 3}), ": must have at most 2 items");
+
+    json text = {{"type", "string"}, {"minLength", 2}, {"maxLength", 3}};
+    EXPECT_EQ(violation(text, "\xc3\xa9\xc3\xa9"), "");// Lengths count code points
+    EXPECT_EQ(violation(text, "a"), ": must be at least 2 characters long");
+    EXPECT_EQ(violation(text, "abcd"), ": must be at most 3 characters long");
+}
+
+TEST(SchemaValidatorTest, ChecksPatterns) {
+    json schema = {{"type", "object"},
+                   {"properties", {{"name", {{"type", "string"}, {"pattern", "^[a-z]+$"}}}}},
+                   {"patternProperties", {{"^x-", {{"type", "integer"}}}}}};
+    EXPECT_EQ(violation(schema, {{"name", "abc"}, {"x-limit", 1}}), "");
+    EXPECT_EQ(violation(schema, {{"name", "ABC"}}), "/name: does not match the pattern '^[a-z]+$'");
+    EXPECT_EQ(violation(schema, {{"x-limit", "1"}}), "/x-limit: expected integer, got string");
+}
+
+// Test that long strings fail a pattern instead of being matched, which could overflow the stack
+TEST(SchemaValidatorTest, LongStringsFailPatterns) {
+    json schema = {{"type", "object"},
+                   {"properties", {{"name", {{"type", "string"}, {"pattern", "^[a-z]+$"}}}}},
+                   {"patternProperties", {{"a+", true}}}};
+    std::string name(4096, 'a');
+    EXPECT_EQ(violation(schema, {{"name", name}}), "");
+
+    std::string long_name(100 * 1024, 'a');
+    auto found = SchemaValidator::compile(schema)->validate({{"name", long_name}});
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->path, "/name");
+    EXPECT_NE(found->message.find("longer than the 4096 bytes"), std::string::npos);
+
+    found = SchemaValidator::compile(schema)->validate({{long_name, 1}});
+    ASSERT_TRUE(found.has_value());
+    EXPECT_NE(found->message.find("longer than the 4096 bytes"), std::string::npos);
+}
+
+TEST(SchemaValidatorTest, FollowsLocalRefs) {
+    json schema = {{"definitions", {{"port", {{"type", "integer"}, {"minimum", 1}}}}},
+                   {"type", "object"},
+                   {"properties", {{"port", {{"$ref", "#/definitions/port"}}}}}};
+    EXPECT_EQ(violation(schema, {{"port", 80}}), "");
+    EXPECT_EQ(violation(schema, {{"port", 0}}), "/port: must be >= 1");
+
+    // A recursive schema is fine as long as every round descends into the value
+    json tree = {{"type", "object"}, {"properties", {{"children", {{"type", "array"}, {"items", {{"$ref", "#"}}}}}}}};
+    EXPECT_EQ(violation(tree, {{"children", {{{"children", json::array()}}}}}), "");
+    EXPECT_EQ(violation(tree, {{"children", {1}}}), "/children/0: expected object, got integer");
+}
+
+// Test that a $ref cycle on the same value is not checked instead of recursing forever
+TEST(SchemaValidatorTest, CyclicRefsAreNotChecked) {
+    json schema = json::parse(R"({"definitions":{"a":{"$ref":"#/definitions/a"}},"$ref":"#/definitions/a"})");
+    EXPECT_EQ(violation(schema, 1), "");
+
+    json mutual = json::parse(R"({"definitions":{"a":{"allOf":[{"$ref":"#/definitions/b"}]},"b":{"anyOf":[{"$ref":"#/definitions/a"}]}},
+                                 "type":"string","$ref":"#/definitions/a"})");
+    EXPECT_EQ(violation(mutual, "text"), "");
+    EXPECT_EQ(violation(mutual, 1), ": expected string, got integer");
+}
+
+TEST(SchemaValidatorTest, SkipsNonLocalRefs) {
+    json schema = {{"type", "object"}, {"properties", {{"config", {{"$ref", "https://example.com/config.json"}}}}}};
+    EXPECT_EQ(violation(schema, {{"config", 1}}), "");
+    EXPECT_EQ(violation(schema, 1), ": expected object, got integer");
+}
+
+// Test that a violation answers tools/call with INVALID_TOOL_INPUT and the path of the value
+TEST(SchemaValidatorTest, ViolationsAreInvalidToolInput) {
+    mcp::business::RegisteredTool tool;
+    tool.metadata.name = "resize";
+    tool.arguments_validator = SchemaValidator::compile(
+            {{"type", "object"}, {"required", {"width"}}, {"properties", {{"width", {{"type", "integer"}}}}}});
+
+    EXPECT_FALSE(mcp::routers::check_tool_arguments(tool, {{"width", 10}}).has_value());
+
+    auto error = mcp::routers::check_tool_arguments(tool, {{"width", "wide"}});
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(error->code, mcp::protocol::error_code::INVALID_TOOL_INPUT);
+    EXPECT_EQ(error->message, "Invalid arguments for tool resize: arguments/width expected integer, got string");
+    ASSERT_TRUE(error->data.has_value());
+    EXPECT_EQ(*error->data, json({{"path", "/width"}}));
+
+    // Absent arguments are checked as an empty object
+    error = mcp::routers::check_tool_arguments(tool, nullptr);
+    ASSERT_TRUE(error.has_value());
+    EXPECT_EQ(error->message, "Invalid arguments for tool resize: arguments missing required property 'width'");
+}
@@ -0,0 +1,136 @@
+#include "core/single_flight.hpp"
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using mcp::core::SingleFlight;
+
+namespace {
+    // Producer that counts its runs and takes a while, so calls started meanwhile find it in flight
+    SingleFlight<std::string>::Producer slow_producer(int &runs, std::string result, bool fail = false) {
+        return [&runs, result, fail]() -> asio::awaitable<std::string> {
+            ++runs;
+            asio::steady_timer timer(co_await asio::this_coro::executor, std::chrono::milliseconds(50));
+            co_await timer.async_wait(asio::use_awaitable);
+            if (fail) {
+                throw std::runtime_error("producer failed");
+            }
+            co_return result;
+        };
+    }
+}// namespace
+
+TEST(SingleFlightTest, ConcurrentCallsShareOneRun) {
+    asio::io_context io;
+    SingleFlight<std::string> flights;
+    int runs = 0;
+    int shared_count = 0;
+    std::vector<std::string> results;
+    for (int i = 0; i < 5; ++i) {
+        std::function<asio::awaitable<void>()> call = [&]() -> asio::awaitable<void> {
+            bool shared = false;
+            results.push_back(co_await flights.run("key", slow_producer(runs, "value"), &shared));
+            shared_count += shared ? 1 : 0;
+        };
+        asio::co_spawn(io, call, asio::detached);
+    }
+    io.run();
+
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(shared_count, 4);
+    EXPECT_EQ(results, std::vector<std::string>(5, "value"));
+    EXPECT_EQ(flights.in_flight(), 0u);
+}
+
+TEST(SingleFlightTest, KeysRunSeparately) {
+    asio::io_context io;
+    SingleFlight<std::string> flights;
+    int runs = 0;
+    std::vector<std::string> results;
+    for (const char *key: {"a", "b"}) {
+        std::function<asio::awaitable<void>()> call = [&, key]() -> asio::awaitable<void> {
+            results.push_back(co_await flights.run(key, slow_producer(runs, key)));
+        };
+        asio::co_spawn(io, call, asio::detached);
+    }
+    io.run();
+    EXPECT_EQ(runs, 2);
+    EXPECT_EQ(results, (std::vector<std::string>{"a", "b"}));
+}
+
+// Test that the leader's exception reaches every caller and nothing is kept afterwards
+TEST(SingleFlightTest, SharesTheLeadersException) {
+    asio::io_context io;
+    SingleFlight<std::string> flights;
+    int runs = 0;
+    int failures = 0;
+    for (int i = 0; i < 3; ++i) {
+        std::function<asio::awaitable<void>()> call = [&]() -> asio::awaitable<void> {
+            try {
+                co_await flights.run("key", slow_producer(runs, "value", true));
+            } catch (const std::runtime_error &e) {
+                EXPECT_STREQ(e.what(), "producer failed");
+                ++failures;
+            }
+        };
+        asio::co_spawn(io, call, asio::detached);
+    }
+    io.run();
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(failures, 3);
+
+    // The next call for the key runs again
+    io.restart();
+    std::string result;
+    std::function<asio::awaitable<void>()> retry = [&]() -> asio::awaitable<void> {
+        result = co_await flights.run("key", slow_producer(runs, "second"));
+    };
+    asio::co_spawn(io, retry, asio::detached);
+    io.run();
+    EXPECT_EQ(runs, 2);
+    EXPECT_EQ(result, "second");
+}
+
+// Test that callers on other threads than the leader are woken up
+TEST(SingleFlightTest, WaitersOnOtherThreadsAreWoken) {
+    asio::io_context io;
+    auto work = asio::make_work_guard(io);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&io]() { io.run(); });
+    }
+
+    SingleFlight<std::string> flights;
+    std::atomic<int> runs{0};
+    std::atomic<int> answered{0};
+    std::function<asio::awaitable<std::string>()> produce = [&runs]() -> asio::awaitable<std::string> {
+        ++runs;
+        asio::steady_timer timer(co_await asio::this_coro::executor, std::chrono::milliseconds(100));
+        co_await timer.async_wait(asio::use_awaitable);
+        co_return "value";
+    };
+    for (int i = 0; i < 50; ++i) {
+        std::function<asio::awaitable<void>()> call = [&]() -> asio::awaitable<void> {
+            EXPECT_EQ(co_await flights.run("key", produce), "value");
+            ++answered;
+        };
+        asio::co_spawn(io, call, asio::detached);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (answered < 50 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(answered, 50);
+    EXPECT_EQ(runs, 1);
+    io.stop();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,36 @@
+#include "core/snapshot.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+
+using mcp::core::Snapshot;
+
+TEST(SnapshotTest, PublishReplacesTheValue) {
+    Snapshot<int> cell(1);
+    EXPECT_EQ(cell.get(), 1);
+    EXPECT_EQ(cell.version(), 1u);
+    cell.publish(2);
+    EXPECT_EQ(cell.get(), 2);
+    EXPECT_EQ(cell.version(), 2u);
+}
+
+// Test that replaced versions are freed once their grace period is over, not kept forever
+TEST(SnapshotTest, FreesReplacedVersions) {
+    auto first = std::make_shared<int>(1);
+    std::weak_ptr<int> watch = first;
+    Snapshot<std::shared_ptr<int>> cell(std::move(first), std::chrono::hours(1));
+
+    // Within the grace period a reference from get() stays valid
+    const auto &held = cell.get();
+    cell.publish(std::make_shared<int>(2));
+    EXPECT_FALSE(watch.expired());
+    EXPECT_EQ(*held, 1);
+
+    Snapshot<std::shared_ptr<int>> quick(std::make_shared<int>(1), std::chrono::seconds(0));
+    std::weak_ptr<int> replaced = quick.get();
+    for (int i = 0; i < 1000; ++i) {
+        quick.publish(std::make_shared<int>(i));
+    }
+    EXPECT_TRUE(replaced.expired());
+    EXPECT_EQ(*quick.get(), 999);
+}
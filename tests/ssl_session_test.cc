@@ -0,0 +1,174 @@
+#include "transport/http_handler.h"
+#include "transport/ssl_session.h"
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+
+using namespace mcp::transport;
+
+namespace {
+
+    // Server context with a throwaway self-signed P-256 certificate
+    void use_self_signed_certificate(asio::ssl::context &context) {
+        EVP_PKEY *key = EVP_EC_gen("P-256");
+        X509 *certificate = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_get_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_get_notAfter(certificate), 60 * 60);
+        X509_set_pubkey(certificate, key);
+        X509_NAME *name = X509_get_subject_name(certificate);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+        X509_sign(certificate, key, EVP_sha256());
+        SSL_CTX_use_certificate(context.native_handle(), certificate);
+        SSL_CTX_use_PrivateKey(context.native_handle(), key);
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+    }
+
+    // TLS client whose records only reach the socket when flush() is called
+    class BufferedTlsClient {
+    public:
+        BufferedTlsClient(asio::ip::tcp::socket &socket) : socket_(socket), context_(SSL_CTX_new(TLS_client_method())) {
+            ssl_ = SSL_new(context_);
+            in_ = BIO_new(BIO_s_mem());
+            out_ = BIO_new(BIO_s_mem());
+            SSL_set_bio(ssl_, in_, out_);
+            SSL_set_connect_state(ssl_);
+        }
+
+        ~BufferedTlsClient() {
+            SSL_free(ssl_);
+            SSL_CTX_free(context_);
+        }
+
+        bool handshake() {
+            while (true) {
+                int result = SSL_do_handshake(ssl_);
+                flush();
+                if (result == 1) {
+                    return true;
+                }
+                if (SSL_get_error(ssl_, result) != SSL_ERROR_WANT_READ || !receive()) {
+                    return false;
+                }
+            }
+        }
+
+        // Encrypt into the memory BIO; every call is a record of its own
+        void write(const std::string &data) { SSL_write(ssl_, data.data(), static_cast<int>(data.size())); }
+
+        // Send everything encrypted so far in one write
+        void flush() {
+            std::string pending;
+            char buffer[16384];
+            int n;
+            while ((n = BIO_read(out_, buffer, sizeof(buffer))) > 0) {
+                pending.append(buffer, static_cast<size_t>(n));
+            }
+            if (!pending.empty()) {
+                asio::write(socket_, asio::buffer(pending));
+            }
+        }
+
+        // Decrypted data, empty once the socket timed out or closed
+        std::string read() {
+            char buffer[16384];
+            while (true) {
+                int n = SSL_read(ssl_, buffer, sizeof(buffer));
+                if (n > 0) {
+                    return std::string(buffer, static_cast<size_t>(n));
+                }
+                if (SSL_get_error(ssl_, n) != SSL_ERROR_WANT_READ || !receive()) {
+                    return {};
+                }
+            }
+        }
+
+    private:
+        bool receive() {
+            char buffer[16384];
+            asio::error_code ec;
+            size_t n = socket_.read_some(asio::buffer(buffer), ec);
+            if (ec) {
+                return false;
+            }
+            BIO_write(in_, buffer, static_cast<int>(n));
+            return true;
+        }
+
+        asio::ip::tcp::socket &socket_;
+        SSL_CTX *context_;
+        SSL *ssl_ = nullptr;
+        BIO *in_ = nullptr;
+        BIO *out_ = nullptr;
+    };
+
+    size_t count_of(const std::string &text, const std::string &needle) {
+        size_t count = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+
+}// namespace
+
+// Test that two requests arriving as two TLS records in one segment are both answered
+TEST(SslSessionTest, AnswersPipelinedRecords) {
+    asio::io_context io;
+    asio::ssl::context server_context(asio::ssl::context::tls_server);
+    use_self_signed_certificate(server_context);
+    HttpHandler handler([](std::string_view, const std::shared_ptr<Session> &, const std::string &) -> asio::awaitable<void> { co_return; });
+
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    std::shared_ptr<SslSession> session;
+    acceptor.async_accept([&](const asio::error_code &ec, asio::ip::tcp::socket socket) {
+        ASSERT_FALSE(ec);
+        session = std::make_shared<SslSession>(std::move(socket), server_context);
+        asio::co_spawn(io, session->start(&handler), asio::detached);
+    });
+    std::thread server([&io]() { io.run(); });
+
+    asio::io_context client_io;
+    asio::ip::tcp::socket socket(client_io);
+    socket.connect(acceptor.local_endpoint());
+    socket.set_option(asio::ip::tcp::no_delay(true));
+    timeval timeout{5, 0};
+    setsockopt(socket.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    BufferedTlsClient client(socket);
+    ASSERT_TRUE(client.handshake());
+    const std::string request = "GET /readyz HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    client.write(request);
+    client.write(request);
+    client.flush();
+
+    std::string received;
+    while (count_of(received, "HTTP/1.1 ") < 2) {
+        std::string more = client.read();
+        if (more.empty()) {
+            break;
+        }
+        received += more;
+    }
+    EXPECT_EQ(count_of(received, "HTTP/1.1 "), 2u) << received;
+
+    socket.close();
+    asio::post(io, [&]() {
+        if (session) {
+            session->close();
+        }
+    });
+    io.stop();
+    server.join();
+}
@@ -0,0 +1,240 @@
+// tests/support/hot_path_harness.cc
+#include "hot_path_harness.h"
+#include "metrics/metrics_manager.h"
+#include "protocol/json_rpc.h"
+#include "protocol/tool.h"
+#include "routers/tool_list.hpp"
+#include "routers/tools_call.hpp"
+#include "transport/mcp_cache.h"
+#include "transport/sse_send_queue.h"
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Allocations of the measuring thread; plain thread_locals, so operator new may use them
+    thread_local bool counting = false;
+    thread_local uint64_t allocation_count = 0;
+    thread_local uint64_t allocation_bytes = 0;
+
+    void *counted_malloc(std::size_t size) {
+        if (counting) {
+            ++allocation_count;
+            allocation_bytes += size;
+        }
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}// namespace
+
+// Replacing the plain forms is enough: the library's defaults for the others call these.
+// Over-aligned allocations keep their default implementation and are not counted
+void *operator new(std::size_t size) {
+    if (void *p = counted_malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return counted_malloc(size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return counted_malloc(size);
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+
+namespace mcp::harness {
+
+    namespace {
+#if defined(__linux__)
+        int open_counter(uint64_t config, int group_fd) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = config;
+            attr.disabled = group_fd < 0 ? 1 : 0;// Members follow their leader
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+        }
+#endif
+
+        const char *const kPing = R"({"jsonrpc":"2.0","id":1,"method":"ping"})";
+        const char *const kToolsList = R"({"jsonrpc":"2.0","id":2,"method":"tools/list"})";
+        const char *const kEchoCall = R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"echo","arguments":{"text":"hello world"}}})";
+        const char *const kStreamEvent = R"({"result":{"content":[{"type":"text","text":"chunk of a streamed answer"}]}})";
+
+        // Runs a flow measures over before counting, so caches and buffers are warm
+        constexpr uint64_t kWarmupRuns = 16;
+    }// namespace
+
+    HotPathCounters::HotPathCounters() {
+#if defined(__linux__)
+        group_fd_ = open_counter(PERF_COUNT_HW_INSTRUCTIONS, -1);
+        if (group_fd_ >= 0) {
+            cache_fd_ = open_counter(PERF_COUNT_HW_CACHE_MISSES, group_fd_);
+            branch_fd_ = open_counter(PERF_COUNT_HW_BRANCH_MISSES, group_fd_);
+        }
+#endif
+    }
+
+    HotPathCounters::~HotPathCounters() {
+#if defined(__linux__)
+        for (int fd: {branch_fd_, cache_fd_, group_fd_}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    void HotPathCounters::start() {
+        allocations_ = allocation_count;
+        allocated_bytes_ = allocation_bytes;
+        counting = true;
+#if defined(__linux__)
+        if (group_fd_ >= 0) {
+            ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    HotPathCost HotPathCounters::stop(uint64_t iterations) {
+        HotPathCost cost;
+#if defined(__linux__)
+        if (group_fd_ >= 0) {
+            ioctl(group_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+        counting = false;
+        const double runs = iterations > 0 ? static_cast<double>(iterations) : 1.0;
+        cost.allocations = static_cast<double>(allocation_count - allocations_) / runs;
+        cost.allocated_bytes = static_cast<double>(allocation_bytes - allocated_bytes_) / runs;
+
+#if defined(__linux__)
+        // PERF_FORMAT_GROUP: the number of counters, then their values in the order they were opened
+        uint64_t values[4] = {};
+        if (group_fd_ >= 0 && read(group_fd_, values, sizeof(values)) > 0) {
+            std::size_t next = 1;
+            cost.instructions = static_cast<double>(values[next++]) / runs;
+            if (cache_fd_ >= 0) {
+                cost.cache_misses = static_cast<double>(values[next++]) / runs;
+            }
+            if (branch_fd_ >= 0) {
+                cost.branch_misses = static_cast<double>(values[next++]) / runs;
+            }
+        }
+#endif
+        return cost;
+    }
+
+    HotPaths::HotPaths() : registry_(std::make_shared<business::ToolRegistry>()), stream_session_("hot_path_stream") {
+        // Registered the way the server registers its built-in echo tool
+        registry_->register_builtin(protocol::make_echo_tool(), [](const nlohmann::json &args) -> nlohmann::json {
+            return args.value("text", "no text provided");
+        });
+        cache::McpCache::GetInstance()->Init(cache::McpCacheOptions::current());
+    }
+
+    HotPaths::~HotPaths() {
+        cache::McpCache::GetInstance()->CleanupSession(stream_session_);
+    }
+
+    void HotPaths::ping() {
+        // What the ping handler of RequestHandler answers
+        auto [request, error] = protocol::parse_request(kPing);
+        protocol::Response response;
+        response.id = request->id.value_or(nullptr);
+        response.result = nlohmann::json::object();
+        response_ = protocol::make_response(response);
+    }
+
+    void HotPaths::tools_list() {
+        // Requests without a transport session, as stdio routes them
+        static const std::shared_ptr<transport::Session> no_session;
+        static const std::string no_session_id;
+        auto [request, error] = protocol::parse_request(kToolsList);
+        business::RequestContext ctx{registry_, no_session, no_session_id, *metrics::MetricsManager::getInstance()};
+        response_ = protocol::make_response(routers::handle_tools_list(*request, ctx));
+    }
+
+    void HotPaths::echo_call() {
+        // handle_tools_call up to the point where it runs a synchronous tool
+        auto [request, error] = protocol::parse_request(kEchoCall);
+        static const nlohmann::json no_arguments;
+        const auto &params = request->params;
+        std::string tool_name = params.value("name", "");
+        auto arguments = params.find("arguments");
+        const nlohmann::json &args = arguments != params.end() ? *arguments : no_arguments;
+        auto tool = registry_->get_tool(tool_name);
+        protocol::Response response;
+        if (auto invalid = routers::check_tool_arguments(*tool, args)) {
+            response.id = request->id.value_or(nullptr);
+            response.error = std::move(*invalid);
+        } else {
+            response = routers::run_tool_call(*request, registry_, tool_name, args);
+        }
+        response_ = protocol::make_response(response);
+    }
+
+    void HotPaths::stream_event() {
+        // One event as the stream consumer of handle_tools_call caches and frames it
+        std::vector<std::pair<int, std::string>> batch;
+        if (auto data = routers::stream_event_data(kStreamEvent)) {
+            batch.emplace_back(++event_id_, std::move(*data));
+        }
+        cache::McpCache::GetInstance()->CacheStreamBatch(stream_session_, batch);
+
+        transport::SseSendQueue::Frame frame;
+        frame.reserve(batch.size() * 2 + 1);
+        for (auto &[id, data]: batch) {
+            frame.push_back((frame.empty() ? "" : "\n\n") + std::string("event: message\nid: ") + std::to_string(id) + "\ndata: ");
+            frame.push_back(std::move(data));
+        }
+        response_.clear();
+        for (const auto &piece: frame) {
+            response_ += piece;
+        }
+    }
+
+    HotPathCost HotPaths::measure(void (HotPaths::*flow)(), uint64_t iterations) {
+        for (uint64_t i = 0; i < kWarmupRuns; ++i) {
+            (this->*flow)();
+        }
+        counters_.start();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            (this->*flow)();
+        }
+        return counters_.stop(iterations);
+    }
+
+}// namespace mcp::harness
@@ -0,0 +1,96 @@
+// tests/support/hot_path_harness.h
+#pragma once
+
+#include "business/tool_registry.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace mcp::harness {
+
+    /**
+     * @brief Average cost of one run of a hot path.
+     *
+     * Allocations are counted by the replaced global operator new on the measuring thread only,
+     * so work handed to other threads is not included. Hardware counters come from
+     * perf_event_open and are missing where it is unavailable, e.g. outside Linux or with
+     * kernel.perf_event_paranoid above 2.
+     */
+    struct HotPathCost {
+        double allocations = 0;
+        double allocated_bytes = 0;
+        std::optional<double> instructions;
+        std::optional<double> cache_misses;
+        std::optional<double> branch_misses;
+    };
+
+    /**
+     * @brief Counts allocations and, where available, instructions, cache misses and branch
+     *        misses of the calling thread between start() and stop().
+     */
+    class HotPathCounters {
+    public:
+        HotPathCounters();
+        ~HotPathCounters();
+        HotPathCounters(const HotPathCounters &) = delete;
+        HotPathCounters &operator=(const HotPathCounters &) = delete;
+
+        /**
+         * @brief Whether perf_event_open gave us the hardware counters.
+         */
+        bool hardware_available() const { return group_fd_ >= 0; }
+
+        void start();
+
+        /**
+         * @brief Stop counting.
+         * @param iterations Runs between start() and stop() to average over
+         */
+        HotPathCost stop(uint64_t iterations);
+
+    private:
+        int group_fd_ = -1;///< Instructions, the leader of the group
+        int cache_fd_ = -1;
+        int branch_fd_ = -1;
+        uint64_t allocations_ = 0;
+        uint64_t allocated_bytes_ = 0;
+    };
+
+    /**
+     * @brief The request flows the allocation and instruction budgets are kept for.
+     *
+     * Each flow runs what the server runs for one request of its kind, from the raw message to
+     * the serialized answer, without a transport: ping, tools/list, a tools/call of the built-in
+     * echo tool, and one event of a stream as the tools/call stream consumer caches and frames it.
+     */
+    class HotPaths {
+    public:
+        HotPaths();
+        ~HotPaths();
+
+        void ping();
+        void tools_list();
+        void echo_call();
+        void stream_event();
+
+        /**
+         * @brief Run a flow iterations times after a warmup and return its average cost.
+         * @param flow One of the member functions above
+         */
+        HotPathCost measure(void (HotPaths::*flow)(), uint64_t iterations);
+
+        /**
+         * @brief Answer of the last run, to check that a flow did what it should.
+         */
+        const std::string &last_response() const { return response_; }
+
+    private:
+        std::shared_ptr<business::ToolRegistry> registry_;
+        HotPathCounters counters_;
+        std::string stream_session_;
+        int event_id_ = 0;
+        std::string response_;
+    };
+
+}// namespace mcp::harness
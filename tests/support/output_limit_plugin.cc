@@ -0,0 +1,67 @@
+// tests/support/output_limit_plugin.cc
+// Plugin of tool_output_test. Its tools answer {"size": n} with a text result of n bytes or more.
+// Built with OUTPUT_LIMIT_PLUGIN_V2 it writes through the ABI v2 output arena, otherwise it
+// returns a whole string from the v1 call_tool.
+#include "core/mcpserver_api.h"
+#include "mcp_plugin.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace {
+    std::string result_of(const char *args_json) {
+        size_t size = nlohmann::json::parse(args_json).value("size", size_t{0});
+        return nlohmann::json{{"content", {{{"type", "text"}, {"text", std::string(size, 'x')}}}}}.dump();
+    }
+}// namespace
+
+#ifdef OUTPUT_LIMIT_PLUGIN_V2
+static ToolInfo tools[] = {
+        {"emit_v2", "Write the result in pieces", "{}", false},
+        {"reserve_v2", "Reserve room for the whole result at once", "{}", false}};
+
+extern "C" MCP_API int mcp_plugin_abi_version() {
+    return MCP_PLUGIN_ABI_VERSION;
+}
+
+extern "C" MCP_API int call_tool_v2(const char *name, MCPBuffer args_json, MCPOutput *output, MCPError *error) {
+    std::string result = result_of(std::string(args_json.data, args_json.size).c_str());
+    bool written;
+    if (std::strcmp(name, "reserve_v2") == 0) {
+        char *room = output->reserve(output->context, result.size());
+        written = room != nullptr;
+        if (written) {
+            std::memcpy(room, result.data(), result.size());
+            output->commit(output->context, result.size());
+        }
+    } else {
+        written = true;
+        for (size_t at = 0; written && at < result.size(); at += 256) {
+            written = output->write(output->context, result.data() + at, std::min<size_t>(256, result.size() - at));
+        }
+    }
+    if (!written) {
+        error->code = -32603;
+        error->message = "Out of memory";
+        return 1;
+    }
+    return 0;
+}
+#else
+static ToolInfo tools[] = {{"emit_v1", "Return the whole result", "{}", false}};
+#endif
+
+extern "C" MCP_API const char *call_tool(const char *, const char *args_json, MCPError *) {
+    return strdup(result_of(args_json).c_str());
+}
+
+extern "C" MCP_API void free_result(const char *result) {
+    std::free(const_cast<char *>(result));
+}
+
+extern "C" MCP_API ToolInfo *get_tools(int *count) {
+    *count = static_cast<int>(sizeof(tools) / sizeof(tools[0]));
+    return tools;
+}
@@ -0,0 +1,73 @@
+#include "business/tool_deadline.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace mcp;
+
+// Test that a call returning at once is answered at once, however long its deadline is
+TEST(ToolDeadlineTest, FastCallIsNotHeldUntilTheDeadline) {
+    // Waiters on several threads, as on the io pool, so a lost or racing cancel would show
+    asio::io_context io;
+    auto work = asio::make_work_guard(io);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&io]() { io.run(); });
+    }
+
+    constexpr int kCalls = 200;
+    std::atomic<int> answered{0};
+    std::promise<void> all_answered;
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCalls; ++i) {
+        std::function<asio::awaitable<protocol::Response>()> call = []() -> asio::awaitable<protocol::Response> {
+            co_return protocol::Response(nlohmann::json{{"ok", true}}, nullptr);
+        };
+        std::function<asio::awaitable<void>()> request = [&, call, i]() -> asio::awaitable<void> {
+            auto response = co_await business::run_with_deadline("fast", std::chrono::minutes(1), call, nullptr, nlohmann::json(i));
+            EXPECT_FALSE(response.error.has_value());
+            EXPECT_EQ(response.id, nlohmann::json(i));
+            EXPECT_EQ(response.result, (nlohmann::json{{"ok", true}}));
+            if (answered.fetch_add(1) + 1 == kCalls) {
+                all_answered.set_value();
+            }
+        };
+        asio::co_spawn(io, request, asio::detached);
+    }
+
+    auto status = all_answered.get_future().wait_for(std::chrono::seconds(10));
+    EXPECT_EQ(status, std::future_status::ready) << answered.load() << " of " << kCalls << " calls answered";
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(10));
+
+    io.stop();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
+
+// Test that a call still running at its deadline is answered with a timeout and cancelled
+TEST(ToolDeadlineTest, SlowCallTimesOut) {
+    asio::io_context io;
+    auto gate = std::make_shared<std::promise<void>>();
+    auto released = gate->get_future().share();
+    std::function<asio::awaitable<protocol::Response>()> call = [released]() -> asio::awaitable<protocol::Response> {
+        released.wait();
+        co_return protocol::Response(nlohmann::json{{"ok", true}}, nullptr);
+    };
+
+    std::optional<protocol::Response> response;
+    std::function<asio::awaitable<void>()> request = [&]() -> asio::awaitable<void> {
+        response = co_await business::run_with_deadline("slow", std::chrono::milliseconds(50), call, nullptr, nlohmann::json(1));
+    };
+    asio::co_spawn(io, request, asio::detached);
+    io.run();
+    gate->set_value();
+
+    ASSERT_TRUE(response.has_value());
+    ASSERT_TRUE(response->error.has_value());
+    EXPECT_EQ(response->error->code, protocol::error_code::TIMEOUT);
+    EXPECT_EQ(response->id, nlohmann::json(1));
+}
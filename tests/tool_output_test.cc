@@ -0,0 +1,113 @@
+#include "business/plugin_manager.h"
+#include "business/tool_output.h"
+#include "metrics/rate_limiter.h"
+#include "protocol/json_rpc.h"
+#include "routers/tools_call.hpp"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace mcp;
+
+namespace {
+    // Sets max_response_size for one test and restores the configuration after it
+    class OutputLimitTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            saved_ = metrics::RateLimiter::getInstance()->get_config();
+            auto config = saved_;
+            config.max_response_size = 1000;
+            metrics::RateLimiter::getInstance()->set_config(config);
+        }
+        void TearDown() override { metrics::RateLimiter::getInstance()->set_config(saved_); }
+
+    private:
+        metrics::RateLimitConfig saved_;
+    };
+}// namespace
+
+TEST(OutputArenaTest, WritesAndReservesUpToTheLimit) {
+    std::string buffer;
+    business::OutputArena arena{buffer, 0, 10};
+    EXPECT_TRUE(business::OutputArena::write(&arena, "12345", 5));
+    char *room = business::OutputArena::reserve(&arena, 5);
+    ASSERT_NE(room, nullptr);
+    std::memcpy(room, "67890", 5);
+    business::OutputArena::commit(&arena, 5);
+    arena.finish();
+    EXPECT_EQ(buffer, "1234567890");
+    EXPECT_FALSE(arena.exceeded);
+}
+
+// Test that a write or reserve past the limit fails and marks the arena, so the call is answered with an error
+TEST(OutputArenaTest, RefusesToGoPastTheLimit) {
+    std::string buffer;
+    business::OutputArena arena{buffer, 0, 10};
+    EXPECT_TRUE(business::OutputArena::write(&arena, "12345678", 8));
+    EXPECT_FALSE(business::OutputArena::write(&arena, "123", 3));
+    EXPECT_TRUE(arena.exceeded);
+    EXPECT_EQ(arena.committed, 8u);
+
+    // Once exceeded, even what would still fit is refused
+    EXPECT_FALSE(business::OutputArena::write(&arena, "1", 1));
+
+    std::string reserved;
+    business::OutputArena reserving{reserved, 0, 10};
+    EXPECT_EQ(business::OutputArena::reserve(&reserving, 11), nullptr);
+    EXPECT_TRUE(reserving.exceeded);
+    EXPECT_TRUE(reserved.empty());
+
+    std::string unlimited;
+    business::OutputArena open{unlimited, 0, 0};
+    EXPECT_TRUE(business::OutputArena::write(&open, std::string(100000, 'x').data(), 100000));
+    EXPECT_FALSE(open.exceeded);
+}
+
+TEST_F(OutputLimitTest, V2ResultPastTheLimitIsAnError) {
+    business::PluginManager plugins;
+    ASSERT_TRUE(plugins.load_plugin(OUTPUT_LIMIT_PLUGIN_V2));
+
+    auto output = plugins.invoke_tool("emit_v2", {{"size", 100}});
+    EXPECT_EQ(output.error_code, 0);
+    EXPECT_NE(output.json.find(std::string(100, 'x')), std::string::npos);
+
+    for (const char *tool: {"emit_v2", "reserve_v2"}) {
+        output = plugins.invoke_tool(tool, {{"size", 5000}});
+        EXPECT_EQ(output.error_code, protocol::error_code::RESPONSE_TOO_LARGE) << tool;
+        EXPECT_NE(output.error_message.find("1000 bytes"), std::string::npos) << tool;
+        EXPECT_TRUE(output.json.empty()) << tool;
+    }
+}
+
+// Test that a v1 result over the limit is answered with an error instead of being copied
+TEST_F(OutputLimitTest, V1ResultPastTheLimitIsNotCopied) {
+    business::PluginManager plugins;
+    ASSERT_TRUE(plugins.load_plugin(OUTPUT_LIMIT_PLUGIN_V1));
+
+    auto output = plugins.invoke_tool("emit_v1", {{"size", 100}});
+    EXPECT_EQ(output.error_code, 0);
+    EXPECT_NE(output.json.find(std::string(100, 'x')), std::string::npos);
+
+    output = plugins.invoke_tool("emit_v1", {{"size", 5000}});
+    EXPECT_EQ(output.error_code, protocol::error_code::RESPONSE_TOO_LARGE);
+    EXPECT_TRUE(output.json.empty());
+}
+
+// Test that a stream event over the limit is turned into the -32007 error event that ends its stream
+TEST_F(OutputLimitTest, OversizedStreamEventEndsTheStream) {
+    std::string fits = R"({"n":")" + std::string(900, 'x') + R"("})";
+    EXPECT_FALSE(routers::oversized_event(fits.c_str(), "numbers").has_value());
+
+    std::string oversized = R"({"n":")" + std::string(5000, 'x') + R"("})";
+    auto data = routers::oversized_event(oversized.c_str(), "numbers");
+    ASSERT_TRUE(data.has_value());
+    auto event = nlohmann::json::parse(*data);
+    EXPECT_EQ(event["code"], protocol::error_code::RESPONSE_TOO_LARGE);
+    EXPECT_EQ(event["message"], "Stream event exceeds the maximum response size of 1000 bytes");
+
+    auto config = metrics::RateLimiter::getInstance()->get_config();
+    config.max_response_size = 0;
+    metrics::RateLimiter::getInstance()->set_config(config);
+    EXPECT_FALSE(routers::oversized_event(oversized.c_str(), "numbers").has_value());
+}
@@ -0,0 +1,129 @@
+#include "business/tool_result_cache.h"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using mcp::business::ToolResultCache;
+using mcp::protocol::Response;
+
+namespace {
+    // The process-wide cache, with "add" and "fail" memoized
+    ToolResultCache &cache() {
+        static bool configured = [] {
+            mcp::business::ToolResultCacheOptions options;
+            options.tools = {{"add", std::chrono::seconds(60)}, {"fail", std::chrono::seconds(60)}};
+            options.max_result_bytes = 1024;
+            ToolResultCache::configure(options);
+            return true;
+        }();
+        (void) configured;
+        return ToolResultCache::instance();
+    }
+
+    Response call_once(const std::string &tool, const nlohmann::json &args, uint64_t version, const nlohmann::json &id,
+                       const ToolResultCache::Call &call) {
+        asio::io_context io;
+        Response response;
+        std::function<asio::awaitable<void>()> request = [&]() -> asio::awaitable<void> {
+            response = co_await cache().call(tool, args, version, id, call);
+        };
+        asio::co_spawn(io, request, asio::detached);
+        io.run();
+        return response;
+    }
+
+    nlohmann::json result_of(const Response &response) {
+        return response.raw_result ? nlohmann::json::parse(*response.raw_result) : response.result;
+    }
+}// namespace
+
+TEST(ToolResultCacheTest, MemoizesConfiguredTools) {
+    EXPECT_TRUE(cache().enabled_for("add"));
+    EXPECT_FALSE(cache().enabled_for("delete_file"));
+
+    int runs = 0;
+    ToolResultCache::Call add = [&runs]() {
+        ++runs;
+        return Response{nlohmann::json{{"sum", 3}}, nullptr};
+    };
+    auto first = call_once("add", {{"a", 1}, {"b", 2}}, 1, 1, add);
+    auto second = call_once("add", nlohmann::json::parse(R"({"b":2,"a":1})"), 1, 2, add);
+
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(second.id, 2);
+    EXPECT_EQ(result_of(second), result_of(first));
+
+    // Other arguments, or a reloaded registry, run the tool again
+    call_once("add", {{"a", 1}}, 1, 3, add);
+    call_once("add", {{"a", 1}, {"b", 2}}, 2, 4, add);
+    EXPECT_EQ(runs, 3);
+}
+
+TEST(ToolResultCacheTest, DoesNotKeepErrorsOrLargeResults) {
+    int runs = 0;
+    ToolResultCache::Call fail = [&runs]() {
+        ++runs;
+        return Response{mcp::protocol::Error{mcp::protocol::error_code::INTERNAL_ERROR, "tool failed"}, nullptr};
+    };
+    auto failed = call_once("fail", nlohmann::json::object(), 1, 1, fail);
+    ASSERT_TRUE(failed.error.has_value());
+    EXPECT_EQ(failed.error->id, 1);
+    call_once("fail", nlohmann::json::object(), 1, 2, fail);
+    EXPECT_EQ(runs, 2);
+
+    ToolResultCache::Call large = [&runs]() {
+        ++runs;
+        return Response{nlohmann::json{{"text", std::string(2048, 'x')}}, nullptr};
+    };
+    call_once("add", {{"large", true}}, 1, 3, large);
+    call_once("add", {{"large", true}}, 1, 4, large);
+    EXPECT_EQ(runs, 4);
+}
+
+// Test that identical calls arriving while one runs share its result
+TEST(ToolResultCacheTest, SharesTheCallInFlight) {
+    asio::io_context io;
+    auto work = asio::make_work_guard(io);
+    std::thread second_thread([&io]() { io.run(); });
+
+    int runs = 0;
+    std::promise<void> joined;
+    auto joined_future = joined.get_future().share();
+    ToolResultCache::Call slow = [&runs, joined_future]() {
+        ++runs;
+        // Held until the second call has started, so it finds this one in flight
+        joined_future.wait_for(std::chrono::seconds(5));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return Response{nlohmann::json{{"sum", 7}}, nullptr};
+    };
+
+    const std::string tool = "add";
+    const nlohmann::json args = {{"a", 7}};
+    std::promise<Response> first_done;
+    std::promise<Response> second_done;
+    std::function<asio::awaitable<void>()> first = [&]() -> asio::awaitable<void> {
+        first_done.set_value(co_await cache().call(tool, args, 1, 1, slow));
+    };
+    std::function<asio::awaitable<void>()> second = [&]() -> asio::awaitable<void> {
+        joined.set_value();
+        second_done.set_value(co_await cache().call(tool, args, 1, 2, slow));
+    };
+    asio::co_spawn(io, first, asio::detached);
+    asio::co_spawn(io, second, asio::detached);
+    io.run_one();// One of the two threads runs each call
+
+    auto first_response = first_done.get_future().get();
+    auto second_response = second_done.get_future().get();
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(first_response.id, 1);
+    EXPECT_EQ(second_response.id, 2);
+    EXPECT_EQ(result_of(second_response), (nlohmann::json{{"sum", 7}}));
+
+    work.reset();
+    io.stop();
+    second_thread.join();
+}
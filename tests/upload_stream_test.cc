@@ -0,0 +1,89 @@
+#include "transport/upload_stream.h"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mcp::transport;
+
+namespace {
+    std::string content_argument(std::string_view tool) {
+        return tool == "write_file" ? "content" : "";
+    }
+
+    /**
+     * @brief Upload of the body from offset on, the rest delivered a few bytes per pull.
+     */
+    UploadStream make_upload(const std::string &body, size_t value_offset, size_t received, std::string closers, size_t &pulled) {
+        pulled = value_offset + received;
+        return UploadStream(std::string_view(body).substr(value_offset, received), body.size() - pulled, std::move(closers),
+                            [&body, &pulled](char *data, size_t size) {
+                                size_t n = std::min({size, body.size() - pulled, size_t{7}});
+                                std::memcpy(data, body.data() + pulled, n);
+                                pulled += n;
+                                return n;
+                            });
+    }
+
+    /**
+     * @brief Read an upload to its end in reads of size bytes.
+     */
+    long long read_all(UploadStream &upload, std::string &out, size_t size) {
+        std::string buffer(size, '\0');
+        while (true) {
+            long long n = upload.read(buffer.data(), buffer.size());
+            if (n <= 0) {
+                return n;
+            }
+            out.append(buffer.data(), static_cast<size_t>(n));
+        }
+    }
+}// namespace
+
+TEST(UploadStreamTest, FindsTheStreamedArgument) {
+    const std::string prefix = R"({"jsonrpc":"2.0","id":7,"method":"tools/call","params":{"name":"write_file","arguments":{"path":"/tmp/x","content":"abc)";
+    StreamedArgument found;
+    ASSERT_EQ(find_streamed_argument(prefix, content_argument, found), UploadScan::Streamed);
+    EXPECT_EQ(prefix.substr(found.value_offset), "abc");
+    EXPECT_EQ(found.closers, "}}}");
+    EXPECT_TRUE(found.skeleton.ends_with(R"("path":"/tmp/x","content":""}}})"));
+
+    // Undecided while the argument has not started, not streamed when it is not last or other tools
+    EXPECT_EQ(find_streamed_argument(prefix.substr(0, 60), content_argument, found), UploadScan::NeedMore);
+    EXPECT_EQ(find_streamed_argument(prefix + R"(","path":"x"}}})", content_argument, found), UploadScan::Buffered);
+    const std::string other = R"({"id":1,"method":"tools/call","params":{"name":"read_file","arguments":{"content":"abc)";
+    EXPECT_EQ(find_streamed_argument(other, content_argument, found), UploadScan::Buffered);
+    const std::string id_last = R"({"method":"tools/call","params":{"name":"write_file","arguments":{"content":"abc)";
+    EXPECT_EQ(find_streamed_argument(id_last, content_argument, found), UploadScan::Buffered);
+}
+
+TEST(UploadStreamTest, UnescapesAcrossPulls) {
+    const std::string body = R"({"id":1,"content":"line\none \"q\" é😀 end"} )";
+    size_t offset = body.find("line");
+    for (size_t received: {size_t{0}, size_t{3}, size_t{11}}) {
+        for (size_t size: {size_t{1}, size_t{2}, size_t{64}}) {
+            size_t pulled = 0;
+            auto upload = make_upload(body, offset, received, "}", pulled);
+            std::string out;
+            EXPECT_EQ(read_all(upload, out, size), 0);
+            EXPECT_EQ(out, "line\none \"q\" \xC3\xA9\xF0\x9F\x98\x80 end");
+            EXPECT_TRUE(upload.finished());
+            EXPECT_EQ(pulled, body.size());
+        }
+    }
+}
+
+TEST(UploadStreamTest, FailsOnMembersAfterTheValueOrATruncatedBody) {
+    const std::string trailing = R"({"content":"abc","more":1})";
+    size_t pulled = 0;
+    auto upload = make_upload(trailing, 12, 0, "}", pulled);
+    std::string out;
+    EXPECT_EQ(read_all(upload, out, 16), -1);
+    EXPECT_FALSE(upload.finished());
+
+    const std::string truncated = R"({"content":"abc)";
+    auto cut = make_upload(truncated, 12, 0, "}", pulled);
+    out.clear();
+    EXPECT_EQ(read_all(cut, out, 16), -1);
+    EXPECT_EQ(out, "abc");
+}
@@ -0,0 +1,80 @@
+#include "Resources/uri_template.h"
+#include <gtest/gtest.h>
+
+using mcp::resources::UriTemplateMatcher;
+
+// Test that a literal after a variable wins over the variable consuming it
+TEST(UriTemplateTest, LiteralSuffixBeatsGreedyVariable) {
+    UriTemplateMatcher matcher;
+    ASSERT_TRUE(matcher.add("file:///{name}.txt", 0));
+    ASSERT_TRUE(matcher.add("file:///{name}", 1));
+
+    auto match = matcher.match("file:///a.txt");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->id, 0u);
+    EXPECT_EQ(match->variables["name"], "a");
+
+    match = matcher.match("file:///a.md");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->id, 1u);
+    EXPECT_EQ(match->variables["name"], "a.md");
+
+    // The order the templates were added in does not change it
+    UriTemplateMatcher reversed;
+    ASSERT_TRUE(reversed.add("file:///{name}", 0));
+    ASSERT_TRUE(reversed.add("file:///{name}.txt", 1));
+    match = reversed.match("file:///a.txt");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->id, 1u);
+    EXPECT_EQ(match->variables["name"], "a");
+}
+
+TEST(UriTemplateTest, DecodesPercentEncodedValues) {
+    UriTemplateMatcher matcher;
+    ASSERT_TRUE(matcher.add("notes://{title}", 0));
+    ASSERT_TRUE(matcher.add("file://{+path}", 1));
+
+    auto match = matcher.match("notes://hello%20world%2");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->variables["title"], "hello world%2");
+
+    // Reserved expansion is taken as it is
+    match = matcher.match("file:///tmp/a%20b");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->id, 1u);
+    EXPECT_EQ(match->variables["path"], "/tmp/a%20b");
+
+    // Without '+', a variable does not match reserved characters
+    EXPECT_FALSE(matcher.match("notes://a/b").has_value());
+}
+
+TEST(UriTemplateTest, MatchesSeveralVariables) {
+    UriTemplateMatcher matcher;
+    ASSERT_TRUE(matcher.add("db://{schema}/{table}/rows{/id}", 0));
+    ASSERT_TRUE(matcher.add("db://{schema}/{table}{.format}", 1));
+
+    auto match = matcher.match("db://public/users/rows/42");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->id, 0u);
+    EXPECT_EQ(match->variables["schema"], "public");
+    EXPECT_EQ(match->variables["table"], "users");
+    EXPECT_EQ(match->variables["id"], "42");
+
+    match = matcher.match("db://public/users.json");
+    ASSERT_TRUE(match.has_value());
+    EXPECT_EQ(match->id, 1u);
+    EXPECT_EQ(match->variables["table"], "users");
+    EXPECT_EQ(match->variables["format"], "json");
+
+    // Variables match at least one character
+    EXPECT_FALSE(matcher.match("db:///users/rows/42").has_value());
+}
+
+TEST(UriTemplateTest, RejectsUnsupportedExpressions) {
+    UriTemplateMatcher matcher;
+    EXPECT_FALSE(matcher.add("search{?q}", 0));
+    EXPECT_FALSE(matcher.add("list/{a,b}", 1));
+    EXPECT_FALSE(matcher.add("broken/{name", 2));
+    EXPECT_EQ(matcher.size(), 0u);
+    EXPECT_FALSE(matcher.match("search?q=x").has_value());
+}
@@ -0,0 +1,96 @@
+#include "utils/utf8.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+
+using namespace mcp::utils;
+
+namespace {
+    // What the vector paths are held to: dump() accepts exactly the valid UTF-8
+    bool dump_accepts(const std::string &text) {
+        try {
+            (void) nlohmann::json(text).dump();
+            return true;
+        } catch (const nlohmann::json::type_error &) {
+            return false;
+        }
+    }
+}// namespace
+
+// Test that malformed sequences are rejected wherever they sit in a block
+TEST(Utf8Test, ValidatesSequences) {
+    const char *valid[] = {"", "ascii", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf", "\xef\xbf\xbf"};
+    const char *invalid[] = {"\x80", "\xc0\xaf", "\xc3", "\xe0\x80\xaf", "\xed\xa0\x80", "\xe2\x82", "\xf0\x80\x80\x80",
+                             "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xff", "\xc3\xa9\xa9"};
+    for (size_t prefix: {0, 1, 13, 29, 30, 31, 32, 63, 70}) {
+        std::string pad(prefix, 'x');
+        for (const char *text: valid) {
+            EXPECT_TRUE(utf8_valid(pad + text)) << prefix;
+            EXPECT_TRUE(utf8_valid(pad + text + pad)) << prefix;
+        }
+        for (const char *text: invalid) {
+            EXPECT_FALSE(utf8_valid(pad + text)) << prefix << " " << utf8_implementation();
+            EXPECT_FALSE(utf8_valid(pad + text + pad)) << prefix << " " << utf8_implementation();
+        }
+    }
+    EXPECT_TRUE(utf8_valid(std::string("a\0b", 3)));
+}
+
+// Test validation and escaping against dump() on random text
+TEST(Utf8Test, MatchesDump) {
+    const char *pieces[] = {"a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\"", "\\", "\n", "\x01", "\x7f", "/",
+                            "\xed\xa0\x80", "\xc0\xaf", "\x80", "\xe2\x82", "\xff"};
+    std::mt19937 rng(7);
+    for (int round = 0; round < 20000; ++round) {
+        std::string text;
+        size_t count = rng() % 48;
+        for (size_t i = 0; i < count; ++i) {
+            // Mostly well-formed pieces, so that valid text is common
+            text += pieces[rng() % (rng() % 8 == 0 ? std::size(pieces) : 10)];
+        }
+        bool valid = dump_accepts(text);
+        ASSERT_EQ(utf8_valid(text), valid) << "length " << text.size();
+        if (valid) {
+            std::string out = "\"";
+            json_escape_append(out, text);
+            out += '"';
+            ASSERT_EQ(out, nlohmann::json(text).dump());
+        }
+    }
+}
+
+// Test that the scan stops at the first byte that needs escaping
+TEST(Utf8Test, ScansToFirstEscape) {
+    std::string text(100, 'a');
+    EXPECT_EQ(json_escape_scan(text), text.size());
+    for (size_t at: {0, 31, 32, 33, 64, 99}) {
+        for (char c: {'"', '\\', '\x1f', '\0'}) {
+            std::string marked = text;
+            marked[at] = c;
+            EXPECT_EQ(json_escape_scan(marked), at);
+        }
+    }
+}
+
+// Test that a cut, such as the end of a resource window, moves back to the lead byte of any sequence
+TEST(Utf8Test, CutsBeforeSequences) {
+    const char *sequences[] = {"\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf0\xa0\x80\x80"};
+    for (const char *sequence: sequences) {
+        std::string text = std::string(10, 'x') + sequence + "yy";
+        size_t length = std::strlen(sequence);
+        for (size_t cut = 10; cut <= 10 + length; ++cut) {
+            size_t expected = cut == 10 + length ? cut : 10;
+            EXPECT_EQ(utf8_cut(text, cut), expected) << length << " bytes, cut at " << cut;
+            EXPECT_TRUE(utf8_valid(std::string_view(text).substr(0, utf8_cut(text, cut))));
+            // A window starting at 4 ends on the same boundary
+            EXPECT_EQ(utf8_cut(text, cut, 4), expected);
+        }
+    }
+
+    // The cut stays above the floor, so a window that is one sequence long still moves forward
+    std::string emoji = "\xf0\x9f\x98\x80rest";
+    EXPECT_EQ(utf8_cut(emoji, 2, 0), 2u);
+    EXPECT_EQ(utf8_cut(emoji, 100), 100u);
+}
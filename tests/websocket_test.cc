@@ -0,0 +1,19 @@
+#include "transport/websocket.h"
+#include <gtest/gtest.h>
+
+using mcp::transport::has_token;
+using mcp::transport::websocket_accept_key;
+
+TEST(WebSocketTest, MatchesWholeTokens) {
+    EXPECT_TRUE(has_token("mcp", "mcp"));
+    EXPECT_TRUE(has_token("chat, mcp", "mcp"));
+    EXPECT_TRUE(has_token("keep-alive,\tUpgrade", "upgrade"));
+    EXPECT_FALSE(has_token("notmcp", "mcp"));
+    EXPECT_FALSE(has_token("mcp2, chat", "mcp"));
+    EXPECT_FALSE(has_token("", "mcp"));
+}
+
+TEST(WebSocketTest, AcceptKeyMatchesRfcExample) {
+    // RFC 6455 section 1.3
+    EXPECT_EQ(websocket_accept_key("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxQhW4Wyq6fUbcCJyHE=");
+}
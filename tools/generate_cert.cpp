@@ -9,6 +9,7 @@ extern "C" {
 #endif
 
 #include <openssl/bn.h>
+#include <openssl/ec.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/pem.h>
@@ -40,6 +41,7 @@ struct Config {
     std::string ca_key_file = "ca.key";
     std::string dh_file = "dh2048.pem";
     int bits = 2048;
+    std::string key_type = "rsa";// rsa or ecdsa (P-256)
     int ca_days = 3650;// CA validity longer
     int server_days = 365;
     std::string country = "US";
@@ -63,7 +65,8 @@ void show_usage(const char *program_name) {
     std::cout << "  --install-trust      Install CA to system trust store (Windows/Linux)\n";
     std::cout << "  --dns DNS            Add DNS SAN (e.g., --dns localhost --dns 127.0.0.1)\n";
     std::cout << "  --ip IP              Add IP SAN (e.g., --ip 127.0.0.1)\n";
-    std::cout << "  -CN, --common-name   Common Name (default: localhost)\n\n";
+    std::cout << "  -CN, --common-name   Common Name (default: localhost)\n";
+    std::cout << "  --key-type TYPE      Key type of CA and server: rsa or ecdsa (P-256) (default: rsa)\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " --install-trust\n";
     std::cout << "  " << program_name << " --dns myserver.com --ip 192.168.1.100\n";
@@ -121,6 +124,10 @@ Config parse_args(int argc, char *argv[]) {
         } else if (arg == "-CN" || arg == "--common-name") {
             if (++i >= argc) throw std::runtime_error("--common-name requires arg");
             cfg.common_name = argv[i];
+        } else if (arg == "--key-type") {
+            if (++i >= argc) throw std::runtime_error("--key-type requires arg");
+            cfg.key_type = argv[i];
+            if (cfg.key_type != "rsa" && cfg.key_type != "ecdsa") throw std::runtime_error("--key-type must be rsa or ecdsa");
         } else {
             throw std::runtime_error("Unknown arg: " + arg);
         }
@@ -148,6 +155,26 @@ EVP_PKEY *generate_rsa_key(int bits) {
     return pkey;
 }
 
+EVP_PKEY *generate_ec_key() {
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    if (!ctx || EVP_PKEY_keygen_init(ctx) <= 0 || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, NID_X9_62_prime256v1) <= 0) {
+        ERR_print_errors_fp(stderr);
+        EVP_PKEY_CTX_free(ctx);
+        return nullptr;
+    }
+    EVP_PKEY *pkey = nullptr;
+    if (EVP_PKEY_keygen(ctx, &pkey) <= 0) {
+        ERR_print_errors_fp(stderr);
+        pkey = nullptr;
+    }
+    EVP_PKEY_CTX_free(ctx);
+    return pkey;
+}
+
+EVP_PKEY *generate_key(const Config &cfg) {
+    return cfg.key_type == "ecdsa" ? generate_ec_key() : generate_rsa_key(cfg.bits);
+}
+
 X509_EXTENSION *create_san_extension(const Config &cfg) {
     std::string san_str;
     for (size_t i = 0; i < cfg.dns_names.size(); ++i) san_str += (i ? "," : "") + std::string("DNS:") + cfg.dns_names[i];
@@ -367,7 +394,7 @@ int main(int argc, char *argv[]) {
 
         // 1. Generate CA
         show_progress("Generating CA key...", 1, 5);
-        EVP_PKEY *ca_pkey = generate_rsa_key(cfg.bits);
+        EVP_PKEY *ca_pkey = generate_key(cfg);
         if (!ca_pkey) {
             std::cerr << "\n× Failed to generate CA key\n";
             return 1;
@@ -385,7 +412,7 @@ int main(int argc, char *argv[]) {
 
         // 2. Generate Server Cert
         show_progress("Generating server key...", 3, 5);
-        EVP_PKEY *server_pkey = generate_rsa_key(cfg.bits);
+        EVP_PKEY *server_pkey = generate_key(cfg);
         if (!server_pkey) {
             std::cerr << "\n× Failed to generate server key\n";
             X509_free(ca_x509);
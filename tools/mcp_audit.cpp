@@ -0,0 +1,155 @@
+/*
+ * @Description: MCP audit log reader (mcp_audit)
+ *               Prints the tool calls recorded in the segments of the server's audit log, as
+ *               text or as JSON lines, oldest segment first.
+ */
+#include "args.hxx"
+#include "metrics/audit_log.h"
+#include <nlohmann/json.hpp>
+
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mcp {
+    namespace apps {
+
+        struct AuditConfig {
+            std::vector<std::string> paths;
+            std::string tool;   ///< Only calls of this tool, empty = all
+            bool json = false;
+            bool errors = false;///< Only failed calls
+        };
+
+        std::string format_time(uint64_t unix_ns) {
+            std::time_t seconds = static_cast<std::time_t>(unix_ns / 1000000000);
+            std::tm tm{};
+#if defined(_WIN32)
+            gmtime_s(&tm, &seconds);
+#else
+            gmtime_r(&seconds, &tm);
+#endif
+            char text[32];
+            std::snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d.%03uZ", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                          tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<unsigned>(unix_ns / 1000000 % 1000));
+            return text;
+        }
+
+        std::string format_hash(uint64_t hash) {
+            char text[17];
+            std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+            return text;
+        }
+
+        /**
+         * @brief Segment files of the given paths; a directory stands for its segments, in order.
+         */
+        std::vector<std::filesystem::path> segment_files(const std::vector<std::string> &paths) {
+            std::vector<std::filesystem::path> files;
+            for (const auto &path: paths) {
+                if (!std::filesystem::is_directory(path)) {
+                    files.emplace_back(path);
+                    continue;
+                }
+                std::vector<std::filesystem::path> segments;
+                for (const auto &entry: std::filesystem::directory_iterator(path)) {
+                    std::string name = entry.path().filename().string();
+                    if (entry.is_regular_file() && name.starts_with("audit-") && name.ends_with(".log")) {
+                        segments.push_back(entry.path());
+                    }
+                }
+                // Sequence numbers are zero-padded, names sort in the order they were written
+                std::sort(segments.begin(), segments.end());
+                files.insert(files.end(), segments.begin(), segments.end());
+            }
+            return files;
+        }
+
+        void print(const metrics::AuditRecord &record, bool json) {
+            if (json) {
+                nlohmann::json line{{"time", format_time(record.unix_ns)},
+                                    {"tool", record.tool},
+                                    {"status", record.status},
+                                    {"duration_us", record.duration_us},
+                                    {"args_hash", format_hash(record.args_hash)},
+                                    {"caller", record.caller},
+                                    {"session", record.session}};
+                std::cout << line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+                return;
+            }
+            std::cout << format_time(record.unix_ns) << ' ' << record.tool << " status=" << record.status
+                      << " duration_us=" << record.duration_us << " args=" << format_hash(record.args_hash)
+                      << " caller=" << (record.caller.empty() ? "-" : record.caller)
+                      << " session=" << (record.session.empty() ? "-" : record.session) << '\n';
+        }
+
+        std::optional<AuditConfig> parse_arguments(int argc, char *argv[]) {
+            args::ArgumentParser parser("MCP audit log reader",
+                                        "Prints the tool calls recorded in audit segments, or in every segment of a directory.");
+            parser.Prog(argv[0]);
+            args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+            args::PositionalList<std::string> paths(parser, "PATH", "Segment file or audit_log_dir", args::Options::Required);
+            args::ValueFlag<std::string> tool(parser, "NAME", "Only calls of this tool", {'t', "tool"});
+            args::Flag errors(parser, "errors", "Only calls answered with an error", {'e', "errors"});
+            args::Flag json(parser, "json", "Print JSON lines", {"json"});
+
+            try {
+                parser.ParseCLI(argc, argv);
+            } catch (const args::Help &) {
+                std::cout << parser;
+                return std::nullopt;
+            } catch (const args::Error &e) {
+                std::cerr << "Error parsing command line: " << e.what() << std::endl;
+                std::cerr << parser;
+                return std::nullopt;
+            }
+
+            AuditConfig config;
+            config.paths = args::get(paths);
+            config.tool = args::get(tool);
+            config.errors = errors;
+            config.json = json;
+            return config;
+        }
+
+        int run(const AuditConfig &config) {
+            int status = 0;
+            for (const auto &file: segment_files(config.paths)) {
+                try {
+                    metrics::AuditSegmentReader reader(file.string());
+                    metrics::AuditRecord record;
+                    while (reader.next(record)) {
+                        if ((!config.tool.empty() && record.tool != config.tool) || (config.errors && record.status == 0)) {
+                            continue;
+                        }
+                        print(record, config.json);
+                    }
+                    if (reader.damaged()) {
+                        std::cerr << "Warning: " << file.string() << " ends in a damaged record" << std::endl;
+                        status = 2;
+                    }
+                } catch (const std::exception &e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                    status = 1;
+                }
+            }
+            return status;
+        }
+
+    }// namespace apps
+}// namespace mcp
+
+int main(int argc, char *argv[]) {
+    auto config = mcp::apps::parse_arguments(argc, argv);
+    if (!config) {
+        return 1;
+    }
+    return mcp::apps::run(*config);
+}
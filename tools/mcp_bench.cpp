@@ -0,0 +1,2001 @@
+/*
+ * @Description: MCP load generator (mcp_bench)
+ *               Drives tools/call, tools/list and streaming tool calls over Streamable HTTP
+ *               at a fixed rate and reports latency percentiles; or, with --reconnect, drops
+ *               streams at random and checks that Last-Event-ID resumes them intact; or, with
+ *               --tls-mode, measures TLS handshakes per second or bulk throughput over HTTPS; or,
+ *               with --soak, measures the server's memory per connection, stream and cached
+ *               event and watches it for growth over hours.
+ */
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "args.hxx"
+#include "transport/http_response_decoder.h"
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+#include <nlohmann/json.hpp>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+// STL
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace mcp {
+    namespace apps {
+
+        using Clock = std::chrono::steady_clock;
+
+        enum class Workload { Call,
+                              List,
+                              Stream };
+        constexpr std::array<const char *, 3> kWorkloadNames = {"tools/call", "tools/list", "stream"};
+
+        enum class TlsMode { Off,
+                             Handshake,///< New connections with full handshakes
+                             Resume,   ///< New connections resuming the session of the previous one
+                             Bulk };   ///< Stream tool calls back to back on kept-alive connections
+        constexpr std::array<const char *, 4> kTlsModeNames = {"off", "handshake", "resume", "bulk"};
+
+        // Answered without authentication or session, see MetricsEndpointOptions::ready_path
+        constexpr const char *kReadyPath = "/readyz";
+
+        struct BenchConfig {
+            std::string host;
+            std::string port;
+            std::string path;
+            std::string token;
+            size_t connections = 16;
+            size_t threads = 1;
+            double rate = 1000;///< Requests per second over all connections
+            std::chrono::milliseconds duration{10000};
+            std::chrono::milliseconds warmup{2000};
+            std::chrono::milliseconds timeout{30000};
+            std::array<unsigned, 3> mix{100, 0, 0};///< Weight of each workload
+            std::string call_params;               ///< params of the tools/call workload, serialized
+            std::string stream_params;             ///< params of the streaming workload, serialized
+            std::string json_path;                 ///< Write the report here too, empty = no
+            bool reconnect = false;                ///< Run the reconnect scenario instead of the load
+            std::chrono::milliseconds disconnect_after{500};///< Mean time to a dropped stream connection, 0 = never
+            std::string stats_path = "/admin/stats";        ///< Stats endpoint of the server, empty = not read
+            std::chrono::milliseconds settle{0};            ///< Wait before the server is read a last time
+            std::shared_ptr<asio::ssl::context> tls;        ///< Set for https:// URLs
+            bool verify = false;                            ///< Check the server certificate and name against --ca
+            TlsMode tls_mode = TlsMode::Off;                ///< Run a TLS scenario instead of the load
+            bool soak = false;                              ///< Run the soak scenario instead of the load
+            size_t idle = 1000;                             ///< Idle keep-alive connections of the soak
+            size_t streams = 100;                           ///< Streams the soak keeps open
+            size_t cached_events = 10000;                   ///< Events the soak waits to see in the reconnect cache
+            std::chrono::milliseconds sample_interval{10000};///< Between two soak samples of the server
+        };
+
+        /**
+         * @brief Log-linear histogram of microsecond values in the manner of HdrHistogram.
+         *
+         * Every power of two is split into 1024 buckets, so a recorded value is off by at most
+         * 0.1%. Values above about 19 hours are clamped.
+         */
+        class LatencyHistogram {
+        public:
+            LatencyHistogram() : counts_(static_cast<size_t>(kMaxExponent + 2) << (kSubBits - 1)) {}
+
+            void record(std::chrono::nanoseconds value) {
+                auto us = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(value).count());
+                uint64_t clamped = std::min<uint64_t>(static_cast<uint64_t>(us), kMaxValue);
+                ++counts_[index_of(clamped)];
+                ++total_;
+                max_ = std::max(max_, clamped);
+            }
+
+            void merge(const LatencyHistogram &other) {
+                for (size_t i = 0; i < counts_.size(); ++i) {
+                    counts_[i] += other.counts_[i];
+                }
+                total_ += other.total_;
+                max_ = std::max(max_, other.max_);
+            }
+
+            uint64_t count() const { return total_; }
+            uint64_t max() const { return max_; }
+
+            /**
+             * @brief Highest value of the bucket holding the given percentile.
+             * @param percentile 0 to 100
+             */
+            uint64_t percentile(double percentile) const {
+                if (total_ == 0) {
+                    return 0;
+                }
+                auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total_)));
+                rank = std::clamp<uint64_t>(rank, 1, total_);
+                uint64_t seen = 0;
+                for (size_t i = 0; i < counts_.size(); ++i) {
+                    seen += counts_[i];
+                    if (seen >= rank) {
+                        return std::min(highest_of(i), max_);
+                    }
+                }
+                return max_;
+            }
+
+        private:
+            static constexpr int kSubBits = 11;
+            static constexpr int kMaxExponent = 36 - kSubBits;
+            static constexpr uint64_t kMaxValue = (uint64_t{1} << 36) - 1;
+
+            static size_t index_of(uint64_t value) {
+                int exponent = std::max(0, static_cast<int>(std::bit_width(value)) - kSubBits);
+                uint64_t sub = value >> exponent;
+                return exponent == 0 ? static_cast<size_t>(sub) : (static_cast<size_t>(exponent) << (kSubBits - 1)) + static_cast<size_t>(sub);
+            }
+
+            static uint64_t highest_of(size_t index) {
+                if (index < (size_t{1} << kSubBits)) {
+                    return index;
+                }
+                int exponent = static_cast<int>(index >> (kSubBits - 1)) - 1;
+                uint64_t sub = index - (static_cast<size_t>(exponent) << (kSubBits - 1));
+                return ((sub + 1) << exponent) - 1;
+            }
+
+            std::vector<uint64_t> counts_;
+            uint64_t total_ = 0;
+            uint64_t max_ = 0;
+        };
+
+        struct WorkloadStats {
+            LatencyHistogram latency;    ///< Intended send to end of the response
+            LatencyHistogram first_event;///< Intended send to the first complete event of an event stream
+            uint64_t errors = 0;
+
+            void merge(const WorkloadStats &other) {
+                latency.merge(other.latency);
+                first_event.merge(other.first_event);
+                errors += other.errors;
+            }
+        };
+
+        /**
+         * @brief Measurements of one IO thread; merged once every thread has stopped.
+         */
+        struct BenchStats {
+            std::array<WorkloadStats, 3> workloads;
+            LatencyHistogram send_lag;///< Intended to actual send; high values mean too few connections
+            uint64_t session_errors = 0;
+            std::string first_error;
+
+            void note_error(const std::string &message) {
+                if (first_error.empty()) {
+                    first_error = message;
+                }
+            }
+
+            void merge(const BenchStats &other) {
+                for (size_t i = 0; i < workloads.size(); ++i) {
+                    workloads[i].merge(other.workloads[i]);
+                }
+                send_lag.merge(other.send_lag);
+                session_errors += other.session_errors;
+                if (first_error.empty()) {
+                    first_error = other.first_error;
+                }
+            }
+        };
+
+        /**
+         * @brief Counts of the reconnect scenario on one IO thread; merged once every thread has stopped.
+         */
+        struct ReconnectStats {
+            LatencyHistogram first_event;///< Stream request sent to its first event
+            LatencyHistogram replay;     ///< Reconnect sent to the first event it brings
+            uint64_t streams = 0;        ///< Streams that reached their complete event
+            uint64_t failed = 0;         ///< Streams given up on, see first_error
+            uint64_t disconnects = 0;    ///< Connections dropped by the client
+            uint64_t server_closes = 0;  ///< Streams the server ended without a complete event
+            uint64_t events = 0;         ///< Message events received, duplicates included
+            uint64_t duplicates = 0;     ///< Events received again after a reconnect
+            uint64_t missed = 0;         ///< Event IDs skipped
+            std::string first_error;
+
+            void note_error(const std::string &message) {
+                if (first_error.empty()) {
+                    first_error = message;
+                }
+            }
+
+            void merge(const ReconnectStats &other) {
+                first_event.merge(other.first_event);
+                replay.merge(other.replay);
+                streams += other.streams;
+                failed += other.failed;
+                disconnects += other.disconnects;
+                server_closes += other.server_closes;
+                events += other.events;
+                duplicates += other.duplicates;
+                missed += other.missed;
+                if (first_error.empty()) {
+                    first_error = other.first_error;
+                }
+            }
+        };
+
+        /**
+         * @brief Counts of a TLS scenario on one IO thread; merged once every thread has stopped.
+         */
+        struct TlsStats {
+            LatencyHistogram handshake;///< TCP connect and TLS handshake of a new connection
+            LatencyHistogram request;  ///< Send to end of the response of a bulk request
+            uint64_t resumed = 0;      ///< Handshakes that resumed a session
+            uint64_t bytes = 0;        ///< Response body bytes of bulk requests
+            uint64_t errors = 0;
+            std::string first_error;
+
+            void note_error(const std::string &message) {
+                if (first_error.empty()) {
+                    first_error = message;
+                }
+            }
+
+            void merge(const TlsStats &other) {
+                handshake.merge(other.handshake);
+                request.merge(other.request);
+                resumed += other.resumed;
+                bytes += other.bytes;
+                errors += other.errors;
+                if (first_error.empty()) {
+                    first_error = other.first_error;
+                }
+            }
+        };
+
+        /**
+         * @brief Reconnect state of the server, from its stats endpoint.
+         */
+        struct ServerSnapshot {
+            int64_t generators = -1; ///< Generators kept for reconnection, -1 if unknown
+            int64_t cache_bytes = -1;///< Resident bytes of the reconnect cache, -1 if unknown
+            int64_t cache_entries = -1;
+            int64_t connections = -1;     ///< Open TCP and TLS sessions
+            int64_t rss_bytes = -1;       ///< Resident set size of the server process
+            int64_t heap_allocated = -1;  ///< Bytes its allocator handed out and not freed
+            int64_t limiter_sessions = -1;///< Sessions with a rate limiter bucket
+
+            static ServerSnapshot parse(const std::string &body) {
+                ServerSnapshot snapshot;
+                auto stats = nlohmann::json::parse(body, nullptr, false);
+                if (!stats.is_object()) {
+                    return snapshot;
+                }
+                snapshot.generators = stats.value("stream_generators", int64_t{-1});
+                if (auto caches = stats.find("caches"); caches != stats.end() && caches->contains("mcp_cache")) {
+                    const auto &cache = (*caches)["mcp_cache"];
+                    snapshot.cache_bytes = cache.value("resident_bytes", int64_t{-1});
+                    snapshot.cache_entries = cache.value("entries", int64_t{-1});
+                }
+                if (auto sessions = stats.find("sessions"); sessions != stats.end() && sessions->is_object()) {
+                    snapshot.connections = sessions->value("tcp", int64_t{0}) + sessions->value("ssl", int64_t{0});
+                }
+                if (auto memory = stats.find("memory"); memory != stats.end() && memory->is_object()) {
+                    snapshot.rss_bytes = memory->value("rss_bytes", int64_t{-1});
+                    snapshot.heap_allocated = memory->value("heap_allocated_bytes", int64_t{-1});
+                }
+                snapshot.limiter_sessions = stats.value("rate_limiter_sessions", int64_t{-1});
+                return snapshot;
+            }
+
+            bool known() const { return generators >= 0; }
+
+            nlohmann::json to_json() const {
+                return {{"stream_generators", generators},
+                        {"cache_bytes", cache_bytes},
+                        {"cache_entries", cache_entries},
+                        {"connections", connections},
+                        {"rss_bytes", rss_bytes},
+                        {"heap_allocated_bytes", heap_allocated},
+                        {"rate_limiter_sessions", limiter_sessions}};
+            }
+        };
+
+        /**
+         * @brief Keep-alive HTTP/1.1 connection to the MCP endpoint.
+         */
+        class McpClient {
+        public:
+            McpClient(asio::io_context &io, const BenchConfig &config)
+                : io_(io), config_(config), socket_(io), watchdog_(io) {
+                host_ = "Host: " + config.host + ":" + config.port + "\r\n";
+                if (!config.token.empty()) {
+                    host_ += "Authorization: Bearer " + config.token + "\r\n";
+                }
+                head_ = "POST " + config.path + " HTTP/1.1\r\n" + host_;
+                head_ += "Content-Type: application/json\r\n";
+                head_ += "Accept: application/json, text/event-stream\r\n";
+            }
+
+            /**
+             * @brief Initialize an MCP session; later requests carry its Mcp-Session-Id.
+             */
+            asio::awaitable<void> open_session() {
+                nlohmann::json initialize = {{"jsonrpc", "2.0"},
+                                             {"id", next_id_++},
+                                             {"method", "initialize"},
+                                             {"params",
+                                              {{"protocolVersion", "2025-03-26"},
+                                               {"capabilities", nlohmann::json::object()},
+                                               {"clientInfo", {{"name", "mcp_bench"}, {"version", "1.0"}}}}}};
+                Reply reply = co_await exchange(initialize.dump());
+                if (reply.status / 100 != 2 || reply.rpc_error) {
+                    throw std::runtime_error("answered with HTTP " + std::to_string(reply.status));
+                }
+                session_id_ = reply.session_id;
+                co_await exchange(R"({"jsonrpc":"2.0","method":"notifications/initialized"})");
+            }
+
+            /**
+             * @brief GET a path of the server, e.g. its stats endpoint.
+             * @return Body of a 200 response
+             */
+            asio::awaitable<std::string> fetch(const std::string &path) {
+                std::string body;
+                int status = co_await get(path, body);
+                if (status != 200) {
+                    throw std::runtime_error("HTTP " + std::to_string(status));
+                }
+                co_return body;
+            }
+
+            void close() {
+                asio::error_code ignored;
+                socket().close(ignored);
+            }
+
+        protected:
+            struct Reply {
+                int status = 0;
+                bool rpc_error = false;
+                std::string session_id;
+                std::optional<Clock::time_point> first_event;
+                size_t body_bytes = 0;
+            };
+
+            /**
+             * @brief GET a path of the server.
+             * @param body Receives the response body
+             * @return HTTP status
+             */
+            asio::awaitable<int> get(const std::string &path, std::string &body) {
+                std::string head = "GET " + path + " HTTP/1.1\r\n" + host_ + "\r\n";
+                arm_watchdog();
+                std::exception_ptr failure;
+                int status = 0;
+                try {
+                    if (!socket().is_open()) {
+                        co_await connect();
+                    }
+                    co_await write(asio::buffer(head));
+                    bool received = false;
+                    status = co_await read_response(
+                            received, [](const transport::HttpResponseDecoder &) {}, [&](std::string_view piece) { body.append(piece); });
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+                watchdog_.cancel();
+                if (failure) {
+                    close();
+                    std::rethrow_exception(failure);
+                }
+                co_return status;
+            }
+
+            /**
+             * @brief POST a body and read the whole response; a kept-alive connection the server
+             *        has closed meanwhile is replaced once.
+             */
+            asio::awaitable<Reply> exchange(const std::string &body) {
+                std::string head = head_;
+                if (!session_id_.empty()) {
+                    head += "Mcp-Session-Id: " + session_id_ + "\r\n";
+                }
+                head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+                std::array<asio::const_buffer, 2> request{asio::buffer(head), asio::buffer(body)};
+
+                for (int attempt = 0;; ++attempt) {
+                    bool reused = socket().is_open();
+                    bool received = false;
+                    arm_watchdog();
+                    std::exception_ptr failure;
+                    try {
+                        if (!reused) {
+                            co_await connect();
+                        }
+                        co_await write(request);
+                        Reply reply = co_await read_reply(received);
+                        watchdog_.cancel();
+                        co_return reply;
+                    } catch (...) {
+                        failure = std::current_exception();
+                    }
+                    watchdog_.cancel();
+                    close();
+                    if (timed_out_) {
+                        timed_out_ = false;
+                        throw std::runtime_error("timed out");
+                    }
+                    if (!reused || received || attempt > 0) {
+                        std::rethrow_exception(failure);
+                    }
+                }
+            }
+
+            asio::awaitable<void> connect() {
+                if (endpoints_.empty()) {
+                    asio::ip::tcp::resolver resolver(io_);
+                    for (const auto &entry: co_await resolver.async_resolve(config_.host, config_.port, asio::use_awaitable)) {
+                        endpoints_.push_back(entry.endpoint());
+                    }
+                }
+                // A TLS stream cannot be reused, the next connection gets a new one
+                tls_.reset();
+                co_await asio::async_connect(socket_, endpoints_, asio::use_awaitable);
+                socket_.set_option(asio::ip::tcp::no_delay(true));
+                if (!config_.tls) {
+                    co_return;
+                }
+                tls_ = std::make_unique<asio::ssl::stream<asio::ip::tcp::socket>>(std::move(socket_), *config_.tls);
+                SSL *ssl = tls_->native_handle();
+                asio::error_code not_ip;
+                asio::ip::make_address(config_.host, not_ip);
+                if (not_ip) {
+                    SSL_set_tlsext_host_name(ssl, config_.host.c_str());
+                }
+                if (config_.verify) {
+                    if (not_ip) {
+                        SSL_set1_host(ssl, config_.host.c_str());
+                    } else {
+                        X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), config_.host.c_str());
+                    }
+                }
+                if (tls_session_) {
+                    SSL_set_session(ssl, tls_session_.get());
+                }
+                co_await tls_->async_handshake(asio::ssl::stream_base::client, asio::use_awaitable);
+            }
+
+            // The TCP socket of the connection, under its TLS stream for https
+            asio::ip::tcp::socket &socket() { return tls_ ? tls_->next_layer() : socket_; }
+
+            template<typename Buffers>
+            asio::awaitable<void> write(const Buffers &buffers) {
+                if (tls_) {
+                    co_await asio::async_write(*tls_, buffers, asio::use_awaitable);
+                } else {
+                    co_await asio::async_write(socket_, buffers, asio::use_awaitable);
+                }
+            }
+
+            asio::awaitable<size_t> read_some(asio::error_code &ec) {
+                if (!tls_) {
+                    co_return co_await socket_.async_read_some(asio::buffer(buffer_), asio::redirect_error(asio::use_awaitable, ec));
+                }
+                size_t n = co_await tls_->async_read_some(asio::buffer(buffer_), asio::redirect_error(asio::use_awaitable, ec));
+                // A server closing without close_notify ends the response the same as a plain close
+                if (ec == asio::ssl::error::stream_truncated) {
+                    ec = asio::error::eof;
+                }
+                co_return n;
+            }
+
+            /**
+             * @brief Read one response, handing its head and each piece of its body over as they arrive.
+             * @param received Set once anything was read
+             * @return HTTP status
+             */
+            template<typename OnHead, typename OnBody>
+            asio::awaitable<int> read_response(bool &received, OnHead on_head, OnBody on_body) {
+                transport::HttpResponseDecoder decoder;
+                std::string_view pending;
+                while (!decoder.done()) {
+                    if (pending.empty()) {
+                        asio::error_code ec;
+                        size_t n = co_await read_some(ec);
+                        if (ec == asio::error::eof && decoder.until_close()) {
+                            close();
+                            break;
+                        }
+                        if (ec) {
+                            throw std::runtime_error(ec == asio::error::eof ? "connection closed by the server" : ec.message());
+                        }
+                        received = true;
+                        pending = std::string_view(buffer_.data(), n);
+                    }
+                    switch (decoder.next(pending)) {
+                        case transport::HttpResponseDecoder::Part::Head:
+                            on_head(decoder);
+                            break;
+                        case transport::HttpResponseDecoder::Part::Body:
+                            on_body(decoder.body());
+                            break;
+                        case transport::HttpResponseDecoder::Part::Error:
+                            throw std::runtime_error(decoder.error());
+                        case transport::HttpResponseDecoder::Part::NeedMore:
+                            break;
+                    }
+                }
+                co_return decoder.status();
+            }
+
+            asio::awaitable<Reply> read_reply(bool &received) {
+                Reply reply;
+                bool event_stream = false;
+                std::string payload;
+                reply.status = co_await read_response(
+                        received,
+                        [&](const transport::HttpResponseDecoder &decoder) {
+                            event_stream = decoder.field("content-type").starts_with("text/event-stream");
+                            if (auto id = decoder.field("mcp-session-id"); !id.empty()) {
+                                reply.session_id = id;
+                            }
+                        },
+                        [&](std::string_view piece) {
+                            payload.append(piece);
+                            if (event_stream && !reply.first_event && has_complete_event(payload)) {
+                                reply.first_event = Clock::now();
+                            }
+                        });
+                reply.body_bytes = payload.size();
+                // JSON-RPC errors are serialized with sorted keys: {"error":{"code":...
+                reply.rpc_error = payload.find(R"("error":{"code")") != std::string::npos;
+                co_return reply;
+            }
+
+            // An event carrying data has arrived when a blank line follows its first data field
+            static bool has_complete_event(std::string_view payload) {
+                size_t data = payload.find("data:");
+                return data != std::string_view::npos &&
+                       (payload.find("\n\n", data) != std::string_view::npos || payload.find("\r\n\r\n", data) != std::string_view::npos);
+            }
+
+            void arm_watchdog() {
+                watchdog_.expires_after(config_.timeout);
+                watchdog_.async_wait([this](const asio::error_code &ec) {
+                    if (!ec) {
+                        timed_out_ = true;
+                        close();
+                    }
+                });
+            }
+
+            asio::io_context &io_;
+            const BenchConfig &config_;
+            asio::ip::tcp::socket socket_;
+            std::unique_ptr<asio::ssl::stream<asio::ip::tcp::socket>> tls_;///< Over socket_ for https, which it then holds
+            std::shared_ptr<SSL_SESSION> tls_session_;                     ///< Offered for resumption by the next handshake
+            asio::steady_timer watchdog_;
+            bool timed_out_ = false;
+            std::vector<asio::ip::tcp::endpoint> endpoints_;///< Resolved once
+            std::array<char, 16 * 1024> buffer_{};
+            std::string host_;///< Host and Authorization header lines
+            std::string head_;///< Head of a POST without session and length
+            std::string session_id_;
+            int64_t next_id_ = 1;
+        };
+
+        /**
+         * @brief One keep-alive connection with its own MCP session, sending on a fixed schedule.
+         *
+         * Requests are due every interval whether or not the previous one has been answered, and
+         * latency is taken from the time a request was due, not from the time it was sent. A
+         * server that stalls therefore shows its stall in every request scheduled meanwhile,
+         * instead of hiding it by slowing the load down (coordinated omission). Only one request
+         * is in flight per connection; use enough connections that the send lag stays low.
+         */
+        class BenchConnection : public McpClient {
+        public:
+            BenchConnection(asio::io_context &io, const BenchConfig &config, BenchStats &stats, size_t index)
+                : McpClient(io, config), stats_(stats), random_(static_cast<uint32_t>(index) * 7919u + 17u) {
+                interval_ = std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(static_cast<double>(config.connections) / config.rate));
+                // Spread the connections over one interval so their requests do not arrive in bursts
+                offset_ = interval_ * static_cast<Clock::rep>(index) / static_cast<Clock::rep>(config.connections);
+            }
+
+            asio::awaitable<void> run(Clock::time_point start) {
+                Clock::time_point measure_from = start + config_.warmup;
+                Clock::time_point end = measure_from + config_.duration;
+                try {
+                    co_await open_session();
+                } catch (const std::exception &e) {
+                    ++stats_.session_errors;
+                    stats_.note_error(std::string("initialize: ") + e.what());
+                    co_return;
+                }
+
+                asio::steady_timer timer(io_);
+                Clock::time_point due = start + offset_;
+                while (due < end) {
+                    if (Clock::now() < due) {
+                        timer.expires_at(due);
+                        co_await timer.async_wait(asio::use_awaitable);
+                    }
+                    Clock::time_point intended = due;
+                    due += interval_;
+                    bool measured = intended >= measure_from;
+                    Workload workload = pick();
+                    WorkloadStats &workload_stats = stats_.workloads[static_cast<size_t>(workload)];
+                    if (measured) {
+                        stats_.send_lag.record(Clock::now() - intended);
+                    }
+
+                    try {
+                        Reply reply = co_await exchange(request_body(workload));
+                        if (reply.status == 404 && !session_id_.empty()) {
+                            // The session is gone, e.g. the server restarted; the next request opens a new one
+                            session_id_.clear();
+                            co_await open_session();
+                            throw std::runtime_error("session expired");
+                        }
+                        if (!measured) {
+                            continue;
+                        }
+                        workload_stats.latency.record(Clock::now() - intended);
+                        if (reply.first_event) {
+                            workload_stats.first_event.record(*reply.first_event - intended);
+                        }
+                        if (reply.status / 100 != 2 || reply.rpc_error) {
+                            ++workload_stats.errors;
+                            stats_.note_error(std::string(kWorkloadNames[static_cast<size_t>(workload)]) + ": " +
+                                              (reply.rpc_error ? "JSON-RPC error" : "HTTP " + std::to_string(reply.status)));
+                        }
+                    } catch (const std::exception &e) {
+                        close();
+                        if (measured) {
+                            ++workload_stats.errors;
+                            stats_.note_error(std::string(kWorkloadNames[static_cast<size_t>(workload)]) + ": " + e.what());
+                        }
+                    }
+                }
+                close();
+            }
+
+        private:
+            Workload pick() {
+                unsigned total = config_.mix[0] + config_.mix[1] + config_.mix[2];
+                unsigned roll = std::uniform_int_distribution<unsigned>(0, total - 1)(random_);
+                for (size_t i = 0; i < config_.mix.size(); ++i) {
+                    if (roll < config_.mix[i]) {
+                        return static_cast<Workload>(i);
+                    }
+                    roll -= config_.mix[i];
+                }
+                return Workload::Call;
+            }
+
+            std::string request_body(Workload workload) {
+                std::string body = R"({"jsonrpc":"2.0","id":)" + std::to_string(next_id_++);
+                switch (workload) {
+                    case Workload::Call:
+                        body += R"(,"method":"tools/call","params":)" + config_.call_params + "}";
+                        break;
+                    case Workload::List:
+                        body += R"(,"method":"tools/list","params":{}})";
+                        break;
+                    case Workload::Stream:
+                        body += R"(,"method":"tools/call","params":)" + config_.stream_params + "}";
+                        break;
+                }
+                return body;
+            }
+
+            BenchStats &stats_;
+            std::mt19937 random_;
+            Clock::duration interval_{};
+            Clock::duration offset_{};
+        };
+
+        /**
+         * @brief Runs streaming tool calls one after another and drops the connection at random
+         *        times, resuming the stream each time with Last-Event-ID.
+         *
+         * Every event ID of a stream is checked: an ID at or below the highest one received is a
+         * duplicate, a gap counts the IDs missed. Replay latency is the time from sending a
+         * reconnect to the first event it brings, replayed from the cache or new.
+         */
+        class ReconnectStream : public McpClient {
+        public:
+            ReconnectStream(asio::io_context &io, const BenchConfig &config, ReconnectStats &stats, size_t index)
+                : McpClient(io, config), stats_(stats), disconnect_timer_(io), random_(static_cast<uint32_t>(index) * 7919u + 17u) {}
+
+            asio::awaitable<void> run(Clock::time_point end) {
+                asio::steady_timer pause(io_);
+                while (Clock::now() < end) {
+                    bool failed = false;
+                    try {
+                        co_await run_stream(end);
+                        ++stats_.streams;
+                    } catch (const std::exception &e) {
+                        ++stats_.failed;
+                        stats_.note_error(e.what());
+                        failed = true;
+                    }
+                    if (failed) {
+                        close();
+                        // Keep a server that refuses streams from being flooded with retries
+                        pause.expires_after(std::chrono::milliseconds(100));
+                        co_await pause.async_wait(asio::use_awaitable);
+                    }
+                }
+                close();
+            }
+
+        private:
+            static constexpr int kMaxReconnects = 1000;
+
+            struct StreamState {
+                std::string session_id;///< Of the stream, from its response head
+                int64_t last_id = 0;   ///< Highest event ID received
+                bool complete = false;
+                bool resumed = false;  ///< A reconnect waits for its first event
+                bool first = true;     ///< No event received yet
+                Clock::time_point sent;///< When the current request was sent
+                std::string pending;   ///< Event stream text not split into events yet
+            };
+
+            asio::awaitable<void> run_stream(Clock::time_point end) {
+                close();
+                session_id_.clear();
+                co_await open_session();
+                std::string body = R"({"jsonrpc":"2.0","id":)" + std::to_string(next_id_++) +
+                                   R"(,"method":"tools/call","params":)" + config_.stream_params + "}";
+
+                StreamState stream;
+                for (int attempt = 0; !stream.complete; ++attempt) {
+                    if (attempt > kMaxReconnects) {
+                        throw std::runtime_error("stream not complete after " + std::to_string(kMaxReconnects) + " reconnects");
+                    }
+                    std::string head = head_ + "Mcp-Session-Id: " + (stream.session_id.empty() ? session_id_ : stream.session_id) + "\r\n";
+                    if (attempt > 0) {
+                        head += "Last-Event-ID: " + std::to_string(stream.last_id) + "\r\n";
+                    }
+                    head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+                    std::array<asio::const_buffer, 2> request{asio::buffer(head), asio::buffer(body)};
+
+                    dropped_ = false;
+                    std::exception_ptr failure;
+                    try {
+                        if (!socket().is_open()) {
+                            co_await connect();
+                        }
+                        stream.resumed = attempt > 0;
+                        stream.sent = Clock::now();
+                        stream.pending.clear();
+                        co_await write(request);
+                        // The last streams of the run are left to complete
+                        if (Clock::now() < end && config_.disconnect_after.count() > 0) {
+                            arm_disconnect();
+                        }
+                        arm_watchdog();
+                        bool received = false;
+                        int status = co_await read_response(
+                                received,
+                                [&](const transport::HttpResponseDecoder &decoder) {
+                                    if (auto id = decoder.field("mcp-session-id"); !id.empty()) {
+                                        stream.session_id = id;
+                                    }
+                                },
+                                [&](std::string_view piece) {
+                                    // The timeout bounds the pause between events
+                                    arm_watchdog();
+                                    on_events(stream, piece);
+                                });
+                        if (status != 200) {
+                            throw std::runtime_error("stream answered with HTTP " + std::to_string(status));
+                        }
+                    } catch (...) {
+                        failure = std::current_exception();
+                    }
+                    disconnect_timer_.cancel();
+                    watchdog_.cancel();
+                    close();
+                    if (timed_out_) {
+                        timed_out_ = false;
+                        throw std::runtime_error("stream timed out");
+                    }
+                    if (failure && !dropped_) {
+                        std::rethrow_exception(failure);
+                    }
+                    if (stream.complete) {
+                        break;
+                    }
+                    if (dropped_) {
+                        ++stats_.disconnects;
+                    } else {
+                        ++stats_.server_closes;
+                    }
+                }
+            }
+
+            void on_events(StreamState &stream, std::string_view piece) {
+                for (char c: piece) {
+                    if (c != '\r') {
+                        stream.pending.push_back(c);
+                    }
+                }
+                size_t end;
+                while ((end = stream.pending.find("\n\n")) != std::string::npos) {
+                    std::string_view event(stream.pending.data(), end);
+                    std::string_view type = "message";
+                    std::string_view data;
+                    std::optional<int64_t> id;
+                    while (!event.empty()) {
+                        size_t newline = event.find('\n');
+                        std::string_view line = event.substr(0, newline);
+                        event = newline == std::string_view::npos ? std::string_view{} : event.substr(newline + 1);
+                        // Error events carry their data on an indented line
+                        while (line.starts_with(' ')) {
+                            line.remove_prefix(1);
+                        }
+                        auto value = [&](size_t skip) {
+                            std::string_view rest = line.substr(skip);
+                            return rest.starts_with(' ') ? rest.substr(1) : rest;
+                        };
+                        if (line.starts_with("event:")) {
+                            type = value(6);
+                        } else if (line.starts_with("id:")) {
+                            int64_t parsed = 0;
+                            std::string_view text = value(3);
+                            if (std::from_chars(text.data(), text.data() + text.size(), parsed).ec == std::errc{}) {
+                                id = parsed;
+                            }
+                        } else if (line.starts_with("data:")) {
+                            data = value(5);
+                        }
+                    }
+                    if (type == "error") {
+                        throw std::runtime_error("error event: " + std::string(data));
+                    }
+                    if (id && (type == "message" || type == "complete")) {
+                        record(stream, *id, type == "complete");
+                    }
+                    stream.pending.erase(0, end + 2);
+                }
+            }
+
+            void record(StreamState &stream, int64_t id, bool complete) {
+                auto now = Clock::now();
+                if (stream.resumed) {
+                    stats_.replay.record(now - stream.sent);
+                    stream.resumed = false;
+                } else if (stream.first) {
+                    stats_.first_event.record(now - stream.sent);
+                }
+                stream.first = false;
+                if (!complete) {
+                    ++stats_.events;
+                }
+                if (id <= stream.last_id) {
+                    ++stats_.duplicates;
+                } else {
+                    stats_.missed += static_cast<uint64_t>(id - stream.last_id - 1);
+                    stream.last_id = id;
+                }
+                stream.complete = complete;
+            }
+
+            // Drop the connection after an exponentially distributed time, with a reset like a crashed client
+            void arm_disconnect() {
+                double mean = std::chrono::duration<double, std::milli>(config_.disconnect_after).count();
+                std::chrono::duration<double, std::milli> after(std::exponential_distribution<double>(1.0 / mean)(random_));
+                disconnect_timer_.expires_after(std::chrono::duration_cast<Clock::duration>(after));
+                disconnect_timer_.async_wait([this](const asio::error_code &ec) {
+                    if (!ec && socket().is_open()) {
+                        dropped_ = true;
+                        asio::error_code ignored;
+                        socket().set_option(asio::socket_base::linger(true, 0), ignored);
+                        close();
+                    }
+                });
+            }
+
+            ReconnectStats &stats_;
+            asio::steady_timer disconnect_timer_;
+            bool dropped_ = false;///< The connection was dropped on purpose
+            std::mt19937 random_;
+        };
+
+        /**
+         * @brief One client of a TLS scenario, sending its next request as soon as the last is done.
+         *
+         * In the handshake modes every round opens a new connection, GETs the readiness probe
+         * and closes it again. The GET is what brings a TLS 1.3 session ticket, which the server
+         * sends after the handshake; the resume mode offers it to the next handshake. In the bulk
+         * mode the connection opens an MCP session and calls the stream tool back to back.
+         */
+        class TlsClient : public McpClient {
+        public:
+            TlsClient(asio::io_context &io, const BenchConfig &config, TlsStats &stats) : McpClient(io, config), stats_(stats) {}
+
+            asio::awaitable<void> run(Clock::time_point measure_from, Clock::time_point end) {
+                if (config_.tls_mode == TlsMode::Bulk) {
+                    co_await bulk(measure_from, end);
+                } else {
+                    co_await handshakes(measure_from, end);
+                }
+                close();
+            }
+
+        private:
+            asio::awaitable<void> handshakes(Clock::time_point measure_from, Clock::time_point end) {
+                while (Clock::now() < end) {
+                    Clock::time_point started = Clock::now();
+                    bool measured = started >= measure_from;
+                    std::exception_ptr failure;
+                    try {
+                        arm_watchdog();
+                        co_await connect();
+                        watchdog_.cancel();
+                        Clock::duration took = Clock::now() - started;
+                        bool resumed = SSL_session_reused(tls_->native_handle()) == 1;
+                        std::string body;
+                        co_await get(kReadyPath, body);
+                        if (config_.tls_mode == TlsMode::Resume) {
+                            tls_session_.reset(SSL_get1_session(tls_->native_handle()), SSL_SESSION_free);
+                        }
+                        // Marks the session as cleanly shut down, else OpenSSL stops offering it;
+                        // the close_notify itself is not sent
+                        SSL_shutdown(tls_->native_handle());
+                        close();
+                        if (measured) {
+                            stats_.handshake.record(took);
+                            stats_.resumed += resumed ? 1 : 0;
+                        }
+                    } catch (...) {
+                        failure = std::current_exception();
+                    }
+                    if (failure) {
+                        watchdog_.cancel();
+                        close();
+                        timed_out_ = false;
+                        tls_session_.reset();
+                        if (measured) {
+                            ++stats_.errors;
+                            try {
+                                std::rethrow_exception(failure);
+                            } catch (const std::exception &e) {
+                                stats_.note_error(std::string("handshake: ") + e.what());
+                            }
+                        }
+                    }
+                }
+            }
+
+            asio::awaitable<void> bulk(Clock::time_point measure_from, Clock::time_point end) {
+                try {
+                    co_await open_session();
+                } catch (const std::exception &e) {
+                    ++stats_.errors;
+                    stats_.note_error(std::string("initialize: ") + e.what());
+                    co_return;
+                }
+                std::string params = R"(,"method":"tools/call","params":)" + config_.stream_params + "}";
+                while (Clock::now() < end) {
+                    Clock::time_point sent = Clock::now();
+                    bool measured = sent >= measure_from;
+                    try {
+                        Reply reply = co_await exchange(R"({"jsonrpc":"2.0","id":)" + std::to_string(next_id_++) + params);
+                        if (!measured) {
+                            continue;
+                        }
+                        stats_.request.record(Clock::now() - sent);
+                        stats_.bytes += reply.body_bytes;
+                        if (reply.status / 100 != 2 || reply.rpc_error) {
+                            ++stats_.errors;
+                            stats_.note_error(reply.rpc_error ? "JSON-RPC error" : "HTTP " + std::to_string(reply.status));
+                        }
+                    } catch (const std::exception &e) {
+                        close();
+                        if (measured) {
+                            ++stats_.errors;
+                            stats_.note_error(e.what());
+                        }
+                    }
+                }
+            }
+
+            TlsStats &stats_;
+        };
+
+        /**
+         * @brief Progress of the soak clients, shared by all IO threads and read by the main thread.
+         */
+        struct SoakCounters {
+            std::atomic<int64_t> idle{0};     ///< Idle connections open
+            std::atomic<int64_t> streams{0};  ///< Streams open
+            std::atomic<uint64_t> completed{0};///< Streams the server ended
+            std::atomic<uint64_t> errors{0};
+            std::mutex mutex;
+            std::string first_error;
+
+            void note_error(const std::string &message) {
+                errors.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (first_error.empty()) {
+                    first_error = message;
+                }
+            }
+        };
+
+        /**
+         * @brief A client of the soak, running until stop() is posted to its IO thread.
+         */
+        class SoakClient : public McpClient {
+        public:
+            SoakClient(asio::io_context &io, const BenchConfig &config, SoakCounters &counters)
+                : McpClient(io, config), counters_(counters), pause_(io) {}
+            virtual ~SoakClient() = default;
+
+            virtual asio::awaitable<void> run() = 0;
+
+            void stop() {
+                stopped_ = true;
+                pause_.cancel();
+                close();
+            }
+
+        protected:
+            asio::awaitable<void> pause(Clock::duration duration) {
+                pause_.expires_after(duration);
+                asio::error_code ignored;
+                co_await pause_.async_wait(asio::redirect_error(asio::use_awaitable, ignored));
+            }
+
+            SoakCounters &counters_;
+            asio::steady_timer pause_;
+            bool stopped_ = false;
+        };
+
+        /**
+         * @brief A keep-alive connection that only GETs the readiness probe once per sample
+         *        interval, so the server's keepalive_timeout_ms does not close it.
+         */
+        class IdleConnection : public SoakClient {
+        public:
+            using SoakClient::SoakClient;
+
+            asio::awaitable<void> run() override {
+                bool open = false;
+                while (!stopped_) {
+                    try {
+                        std::string body;
+                        co_await get(kReadyPath, body);
+                        if (!open) {
+                            open = true;
+                            counters_.idle.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    } catch (const std::exception &e) {
+                        if (open) {
+                            open = false;
+                            counters_.idle.fetch_sub(1, std::memory_order_relaxed);
+                        }
+                        timed_out_ = false;
+                        if (!stopped_) {
+                            counters_.note_error(std::string("idle connection: ") + e.what());
+                        }
+                    }
+                    co_await pause(config_.sample_interval);
+                }
+                if (open) {
+                    counters_.idle.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        /**
+         * @brief Calls the stream tool and reads its events; a stream the server ends is
+         *        followed by a new one, on a new connection with a session of its own.
+         *
+         * The sessions, generators and rate limiter buckets of ended streams are left for the
+         * server to expire, which is what the soak watches for growth.
+         */
+        class SoakStream : public SoakClient {
+        public:
+            using SoakClient::SoakClient;
+
+            asio::awaitable<void> run() override {
+                std::string body = R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":)" + config_.stream_params + "}";
+                while (!stopped_) {
+                    bool open = false;
+                    std::exception_ptr failure;
+                    try {
+                        close();
+                        session_id_.clear();
+                        co_await open_session();
+                        std::string head = head_ + "Mcp-Session-Id: " + session_id_ + "\r\n";
+                        head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+                        std::array<asio::const_buffer, 2> request{asio::buffer(head), asio::buffer(body)};
+                        co_await write(request);
+                        arm_watchdog();
+                        bool received = false;
+                        int status = co_await read_response(
+                                received,
+                                [&](const transport::HttpResponseDecoder &) {
+                                    open = true;
+                                    counters_.streams.fetch_add(1, std::memory_order_relaxed);
+                                },
+                                [&](std::string_view) { arm_watchdog(); });
+                        watchdog_.cancel();
+                        if (status / 100 != 2) {
+                            throw std::runtime_error("HTTP " + std::to_string(status));
+                        }
+                        counters_.completed.fetch_add(1, std::memory_order_relaxed);
+                    } catch (...) {
+                        failure = std::current_exception();
+                    }
+                    if (open) {
+                        counters_.streams.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    if (failure) {
+                        watchdog_.cancel();
+                        close();
+                        timed_out_ = false;
+                        if (!stopped_) {
+                            try {
+                                std::rethrow_exception(failure);
+                            } catch (const std::exception &e) {
+                                counters_.note_error(std::string("stream: ") + e.what());
+                            }
+                            co_await pause(std::chrono::seconds(1));
+                        }
+                    }
+                }
+            }
+        };
+
+        // http:// and https:// endpoints; https gets its TLS context in parse_arguments()
+        bool parse_url(std::string_view url, BenchConfig &config, bool &https) {
+            https = url.starts_with("https://");
+            std::string_view scheme = https ? "https://" : "http://";
+            if (!url.starts_with(scheme)) {
+                return false;
+            }
+            url.remove_prefix(scheme.size());
+            size_t slash = url.find('/');
+            std::string_view authority = url.substr(0, slash);
+            config.path = slash == std::string_view::npos ? "/mcp" : std::string(url.substr(slash));
+            size_t colon = authority.rfind(':');
+            if (colon == std::string_view::npos || authority.find(']', colon) != std::string_view::npos) {
+                config.host = authority;
+                config.port = https ? "443" : "80";
+            } else {
+                config.host = authority.substr(0, colon);
+                config.port = authority.substr(colon + 1);
+            }
+            if (config.host.size() >= 2 && config.host.front() == '[' && config.host.back() == ']') {
+                config.host = config.host.substr(1, config.host.size() - 2);
+            }
+            return !config.host.empty() && !config.port.empty();
+        }
+
+        // "call=80,list=10,stream=10"
+        bool parse_mix(std::string_view text, std::array<unsigned, 3> &mix) {
+            mix = {0, 0, 0};
+            while (!text.empty()) {
+                size_t comma = text.find(',');
+                std::string_view item = text.substr(0, comma);
+                text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+                size_t equals = item.find('=');
+                if (equals == std::string_view::npos) {
+                    return false;
+                }
+                std::string_view name = item.substr(0, equals);
+                unsigned weight = 0;
+                try {
+                    weight = static_cast<unsigned>(std::stoul(std::string(item.substr(equals + 1))));
+                } catch (const std::exception &) {
+                    return false;
+                }
+                if (name == "call") {
+                    mix[0] = weight;
+                } else if (name == "list") {
+                    mix[1] = weight;
+                } else if (name == "stream") {
+                    mix[2] = weight;
+                } else {
+                    return false;
+                }
+            }
+            return mix[0] + mix[1] + mix[2] > 0;
+        }
+
+        std::string format_ms(uint64_t us) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(3) << static_cast<double>(us) / 1000.0;
+            return out.str();
+        }
+
+        constexpr std::array<double, 6> kPercentiles = {50, 90, 99, 99.9, 99.99, 100};
+
+        nlohmann::json histogram_json(const LatencyHistogram &histogram) {
+            nlohmann::json json = {{"count", histogram.count()}};
+            for (double percentile: kPercentiles) {
+                std::ostringstream key;
+                key << "p" << percentile;
+                json[percentile == 100 ? std::string("max") : key.str()] = histogram.percentile(percentile);
+            }
+            return json;
+        }
+
+        void print_row(const std::string &name, const LatencyHistogram &histogram, const std::string &extra) {
+            std::cout << std::left << std::setw(24) << name << std::right << std::setw(10) << histogram.count();
+            for (double percentile: kPercentiles) {
+                std::cout << std::setw(11) << format_ms(histogram.percentile(percentile));
+            }
+            std::cout << "  " << extra << std::endl;
+        }
+
+        /**
+         * @brief Print the percentiles and write the JSON report.
+         * @param elapsed Time from the end of the warmup until the last response, the base of the achieved rate
+         */
+        void report(const BenchConfig &config, const BenchStats &stats, Clock::duration elapsed) {
+            double seconds = std::max(std::chrono::duration<double>(elapsed).count(), std::chrono::duration<double>(config.duration).count());
+            uint64_t completed = 0;
+            for (const auto &workload: stats.workloads) {
+                completed += workload.latency.count();
+            }
+
+            std::cout << std::endl
+                      << "Latency in ms from the time each request was due:" << std::endl;
+            std::cout << std::left << std::setw(24) << "" << std::right << std::setw(10) << "requests";
+            for (const char *label: {"p50", "p90", "p99", "p99.9", "p99.99", "max"}) {
+                std::cout << std::setw(11) << label;
+            }
+            std::cout << std::endl;
+
+            nlohmann::json json = {{"mode", "load"},
+                                   {"target_rate", config.rate},
+                                   {"achieved_rate", static_cast<double>(completed) / seconds},
+                                   {"connections", config.connections},
+                                   {"duration_s", seconds},
+                                   {"session_errors", stats.session_errors},
+                                   {"send_lag_us", histogram_json(stats.send_lag)},
+                                   {"workloads", nlohmann::json::object()}};
+            for (size_t i = 0; i < stats.workloads.size(); ++i) {
+                const auto &workload = stats.workloads[i];
+                if (config.mix[i] == 0) {
+                    continue;
+                }
+                print_row(kWorkloadNames[i], workload.latency, std::to_string(workload.errors) + " errors");
+                if (workload.first_event.count() > 0) {
+                    print_row(std::string(kWorkloadNames[i]) + " first event", workload.first_event, "");
+                }
+                json["workloads"][kWorkloadNames[i]] = {{"errors", workload.errors},
+                                                        {"latency_us", histogram_json(workload.latency)},
+                                                        {"first_event_us", histogram_json(workload.first_event)}};
+            }
+            print_row("send lag", stats.send_lag, "");
+
+            std::cout << std::endl
+                      << "Requests/s: " << std::fixed << std::setprecision(1) << static_cast<double>(completed) / seconds
+                      << " of " << config.rate << " targeted" << std::endl;
+            if (stats.session_errors > 0) {
+                std::cout << "Connections without a session: " << stats.session_errors << std::endl;
+            }
+            if (!stats.first_error.empty()) {
+                std::cout << "First error: " << stats.first_error << std::endl;
+            }
+            if (stats.send_lag.percentile(99) > 1000) {
+                std::cout << "Warning: p99 send lag above 1 ms, requests waited for a free connection; "
+                             "add connections so latency reflects the server alone"
+                          << std::endl;
+            }
+
+            if (!config.json_path.empty()) {
+                std::ofstream out(config.json_path);
+                out << json.dump(2) << std::endl;
+                if (!out) {
+                    std::cerr << "Error: cannot write " << config.json_path << std::endl;
+                }
+            }
+        }
+
+        /**
+         * @brief Read the stats endpoint once; unknown values if it is off or unreachable.
+         */
+        ServerSnapshot take_snapshot(const BenchConfig &config) {
+            if (config.stats_path.empty()) {
+                return {};
+            }
+            asio::io_context io(1);
+            McpClient client(io, config);
+            ServerSnapshot snapshot;
+            asio::co_spawn(
+                    io, [&]() -> asio::awaitable<void> { snapshot = ServerSnapshot::parse(co_await client.fetch(config.stats_path)); },
+                    [](std::exception_ptr) {});
+            io.run();
+            return snapshot;
+        }
+
+        void report_reconnect(const BenchConfig &config, const ReconnectStats &stats, const ServerSnapshot &before,
+                              const ServerSnapshot &peak, const ServerSnapshot &after, const ServerSnapshot &settled) {
+            std::cout << std::endl
+                      << "Latency in ms:" << std::endl;
+            std::cout << std::left << std::setw(24) << "" << std::right << std::setw(10) << "events";
+            for (const char *label: {"p50", "p90", "p99", "p99.9", "p99.99", "max"}) {
+                std::cout << std::setw(11) << label;
+            }
+            std::cout << std::endl;
+            print_row("first event", stats.first_event, "");
+            print_row("replay after reconnect", stats.replay, "");
+
+            std::cout << std::endl
+                      << "Streams completed: " << stats.streams << ", failed: " << stats.failed << std::endl
+                      << "Reconnects: " << stats.disconnects << " after a client disconnect, "
+                      << stats.server_closes << " after the server ended a stream early" << std::endl
+                      << "Events: " << stats.events << ", duplicates: " << stats.duplicates << ", missed: " << stats.missed << std::endl;
+            if (!stats.first_error.empty()) {
+                std::cout << "First error: " << stats.first_error << std::endl;
+            }
+
+            auto print_snapshot = [](const char *label, const ServerSnapshot &snapshot) {
+                std::cout << std::left << std::setw(24) << label << std::right << std::setw(12) << snapshot.generators
+                          << std::setw(14) << snapshot.cache_entries << std::setw(16) << snapshot.cache_bytes << std::endl;
+            };
+            if (before.known()) {
+                std::cout << std::endl
+                          << std::left << std::setw(24) << "Server" << std::right << std::setw(12) << "generators"
+                          << std::setw(14) << "cache entries" << std::setw(16) << "cache bytes" << std::endl;
+                print_snapshot("before", before);
+                print_snapshot("peak", peak);
+                print_snapshot("after", after);
+                if (config.settle.count() > 0) {
+                    print_snapshot("after settling", settled);
+                }
+                const ServerSnapshot &last = config.settle.count() > 0 ? settled : after;
+                if (last.known() && last.generators > before.generators) {
+                    std::cout << "Warning: " << last.generators - before.generators
+                              << " generators more than before the run; they are freed once their session expires, "
+                                 "use --settle to wait past the session TTL"
+                              << std::endl;
+                }
+            } else if (!config.stats_path.empty()) {
+                std::cout << "Server stats unavailable at " << config.stats_path << " (admin_stats_endpoint off?)" << std::endl;
+            }
+
+            if (!config.json_path.empty()) {
+                nlohmann::json json = {{"mode", "reconnect"},
+                                       {"streams", config.connections},
+                                       {"duration_s", std::chrono::duration<double>(config.duration).count()},
+                                       {"disconnect_after_ms", config.disconnect_after.count()},
+                                       {"completed", stats.streams},
+                                       {"failed", stats.failed},
+                                       {"disconnects", stats.disconnects},
+                                       {"server_closes", stats.server_closes},
+                                       {"events", stats.events},
+                                       {"duplicates", stats.duplicates},
+                                       {"missed", stats.missed},
+                                       {"first_event_us", histogram_json(stats.first_event)},
+                                       {"replay_us", histogram_json(stats.replay)},
+                                       {"server", {{"before", before.to_json()}, {"peak", peak.to_json()}, {"after", after.to_json()}, {"settled", settled.to_json()}}}};
+                std::ofstream out(config.json_path);
+                out << json.dump(2) << std::endl;
+                if (!out) {
+                    std::cerr << "Error: cannot write " << config.json_path << std::endl;
+                }
+            }
+        }
+
+        /**
+         * @brief Keep CONNECTIONS streams running with random disconnects for the duration, then
+         *        let the last ones complete.
+         */
+        int run_reconnect(const BenchConfig &config) {
+            std::cout << "mcp_bench: " << config.connections << " concurrent streams, disconnects every "
+                      << config.disconnect_after.count() << " ms on average, to " << config.host << ":" << config.port << config.path << std::endl;
+
+            ServerSnapshot before = take_snapshot(config);
+            std::vector<std::unique_ptr<asio::io_context>> contexts;
+            std::vector<ReconnectStats> stats(config.threads);
+            std::vector<std::unique_ptr<ReconnectStream>> streams;
+            for (size_t i = 0; i < config.threads; ++i) {
+                contexts.push_back(std::make_unique<asio::io_context>(1));
+            }
+            Clock::time_point end = Clock::now() + config.duration;
+            for (size_t i = 0; i < config.connections; ++i) {
+                size_t thread = i % config.threads;
+                streams.push_back(std::make_unique<ReconnectStream>(*contexts[thread], config, stats[thread], i));
+                asio::co_spawn(*contexts[thread], streams.back()->run(end), [&stats, thread](std::exception_ptr error) {
+                    if (!error) {
+                        return;
+                    }
+                    try {
+                        std::rethrow_exception(error);
+                    } catch (const std::exception &e) {
+                        stats[thread].note_error(e.what());
+                    }
+                });
+            }
+
+            std::atomic<size_t> running{contexts.size()};
+            std::vector<std::thread> workers;
+            for (auto &context: contexts) {
+                workers.emplace_back([&context, &running] {
+                    context->run();
+                    running.fetch_sub(1, std::memory_order_relaxed);
+                });
+            }
+            // The peak is sampled once a second while the streams run
+            ServerSnapshot peak = before;
+            while (before.known() && running.load(std::memory_order_relaxed) > 0) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                ServerSnapshot now = take_snapshot(config);
+                peak.generators = std::max(peak.generators, now.generators);
+                peak.cache_entries = std::max(peak.cache_entries, now.cache_entries);
+                peak.cache_bytes = std::max(peak.cache_bytes, now.cache_bytes);
+            }
+            for (auto &worker: workers) {
+                worker.join();
+            }
+
+            ServerSnapshot after = take_snapshot(config);
+            ServerSnapshot settled = after;
+            if (config.settle.count() > 0 && before.known()) {
+                std::this_thread::sleep_for(config.settle);
+                settled = take_snapshot(config);
+            }
+
+            ReconnectStats total;
+            for (const auto &thread_stats: stats) {
+                total.merge(thread_stats);
+            }
+            report_reconnect(config, total, before, peak, after, settled);
+            return 0;
+        }
+
+        /**
+         * @brief Print the TLS scenario and write its JSON report.
+         * @param threads Stats of each IO thread
+         */
+        void report_tls(const BenchConfig &config, const std::vector<TlsStats> &threads) {
+            TlsStats stats;
+            for (const auto &thread_stats: threads) {
+                stats.merge(thread_stats);
+            }
+            double seconds = std::chrono::duration<double>(config.duration).count();
+            bool bulk = config.tls_mode == TlsMode::Bulk;
+            const LatencyHistogram &latency = bulk ? stats.request : stats.handshake;
+
+            std::cout << std::endl
+                      << "Latency in ms:" << std::endl;
+            std::cout << std::left << std::setw(24) << "" << std::right << std::setw(10) << (bulk ? "requests" : "handshakes");
+            for (const char *label: {"p50", "p90", "p99", "p99.9", "p99.99", "max"}) {
+                std::cout << std::setw(11) << label;
+            }
+            std::cout << std::endl;
+            print_row(bulk ? "stream request" : "connect and handshake", latency, std::to_string(stats.errors) + " errors");
+            std::cout << std::endl;
+
+            nlohmann::json json = {{"mode", "tls"},
+                                   {"tls_mode", kTlsModeNames[static_cast<size_t>(config.tls_mode)]},
+                                   {"connections", config.connections},
+                                   {"threads", config.threads},
+                                   {"duration_s", seconds},
+                                   {"errors", stats.errors}};
+            if (bulk) {
+                double rate = static_cast<double>(stats.bytes) / seconds;
+                std::cout << "Bytes/s: " << std::fixed << std::setprecision(0) << rate << " (" << std::setprecision(1)
+                          << rate / (1024 * 1024) << " MiB/s), requests/s: " << static_cast<double>(latency.count()) / seconds << std::endl;
+                nlohmann::json per_thread = nlohmann::json::array();
+                for (size_t i = 0; i < threads.size(); ++i) {
+                    double thread_rate = static_cast<double>(threads[i].bytes) / seconds;
+                    std::cout << "  thread " << i << ": " << std::setprecision(1) << thread_rate / (1024 * 1024) << " MiB/s" << std::endl;
+                    per_thread.push_back(thread_rate);
+                }
+                json["bytes"] = stats.bytes;
+                json["bytes_per_second"] = rate;
+                json["bytes_per_second_per_thread"] = std::move(per_thread);
+                json["latency_us"] = histogram_json(stats.request);
+            } else {
+                double ratio = latency.count() > 0 ? static_cast<double>(stats.resumed) / static_cast<double>(latency.count()) : 0.0;
+                std::cout << "Handshakes/s: " << std::fixed << std::setprecision(1) << static_cast<double>(latency.count()) / seconds
+                          << ", resumed: " << stats.resumed << " (" << ratio * 100 << "%)" << std::endl;
+                if (config.tls_mode == TlsMode::Resume && ratio < 0.9 && latency.count() > 0) {
+                    std::cout << "Warning: fewer than 90% of the handshakes resumed; is session resumption enabled on the server?" << std::endl;
+                }
+                json["handshakes_per_second"] = static_cast<double>(latency.count()) / seconds;
+                json["resumed"] = stats.resumed;
+                json["handshake_us"] = histogram_json(stats.handshake);
+            }
+            if (!stats.first_error.empty()) {
+                std::cout << "First error: " << stats.first_error << std::endl;
+            }
+
+            if (!config.json_path.empty()) {
+                std::ofstream out(config.json_path);
+                out << json.dump(2) << std::endl;
+                if (!out) {
+                    std::cerr << "Error: cannot write " << config.json_path << std::endl;
+                }
+            }
+        }
+
+        /**
+         * @brief Run CONNECTIONS TLS clients closed-loop for the warmup and duration.
+         */
+        int run_tls(const BenchConfig &config) {
+            std::cout << "mcp_bench: " << kTlsModeNames[static_cast<size_t>(config.tls_mode)] << " over " << config.connections
+                      << " connections, " << config.threads << " threads, to " << config.host << ":" << config.port << config.path << std::endl;
+
+            std::vector<std::unique_ptr<asio::io_context>> contexts;
+            std::vector<TlsStats> stats(config.threads);
+            std::vector<std::unique_ptr<TlsClient>> clients;
+            for (size_t i = 0; i < config.threads; ++i) {
+                contexts.push_back(std::make_unique<asio::io_context>(1));
+            }
+            Clock::time_point measure_from = Clock::now() + config.warmup;
+            Clock::time_point end = measure_from + config.duration;
+            for (size_t i = 0; i < config.connections; ++i) {
+                size_t thread = i % config.threads;
+                clients.push_back(std::make_unique<TlsClient>(*contexts[thread], config, stats[thread]));
+                asio::co_spawn(*contexts[thread], clients.back()->run(measure_from, end), [&stats, thread](std::exception_ptr error) {
+                    if (!error) {
+                        return;
+                    }
+                    try {
+                        std::rethrow_exception(error);
+                    } catch (const std::exception &e) {
+                        stats[thread].note_error(e.what());
+                    }
+                });
+            }
+
+            std::vector<std::thread> workers;
+            for (auto &context: contexts) {
+                workers.emplace_back([&context] { context->run(); });
+            }
+            for (auto &worker: workers) {
+                worker.join();
+            }
+            report_tls(config, stats);
+            return 0;
+        }
+
+        /**
+         * @brief Trend of one server value over the soak samples.
+         */
+        struct SoakTrend {
+            int64_t first = -1;
+            int64_t last = -1;
+            double per_hour = 0;///< Least-squares slope
+            bool growing = false;///< Every sample of the last quarter above every one of the first
+        };
+
+        SoakTrend trend_of(const std::vector<std::pair<double, ServerSnapshot>> &samples, int64_t ServerSnapshot::*value) {
+            std::vector<std::pair<double, double>> points;
+            for (const auto &[seconds, snapshot]: samples) {
+                if (snapshot.*value >= 0) {
+                    points.emplace_back(seconds, static_cast<double>(snapshot.*value));
+                }
+            }
+            SoakTrend trend;
+            if (points.empty()) {
+                return trend;
+            }
+            trend.first = static_cast<int64_t>(points.front().second);
+            trend.last = static_cast<int64_t>(points.back().second);
+            double mean_t = 0, mean_v = 0;
+            for (const auto &[t, v]: points) {
+                mean_t += t;
+                mean_v += v;
+            }
+            mean_t /= static_cast<double>(points.size());
+            mean_v /= static_cast<double>(points.size());
+            double covariance = 0, variance = 0;
+            for (const auto &[t, v]: points) {
+                covariance += (t - mean_t) * (v - mean_v);
+                variance += (t - mean_t) * (t - mean_t);
+            }
+            trend.per_hour = variance > 0 ? covariance / variance * 3600.0 : 0.0;
+            // Too few samples to tell growth from noise
+            size_t quarter = points.size() / 4;
+            if (quarter >= 2) {
+                double first_max = 0, last_min = points.back().second;
+                for (size_t i = 0; i < quarter; ++i) {
+                    first_max = std::max(first_max, points[i].second);
+                    last_min = std::min(last_min, points[points.size() - 1 - i].second);
+                }
+                trend.growing = last_min > first_max;
+            }
+            return trend;
+        }
+
+        /**
+         * @brief Measure the memory of idle connections, open streams and cached events, then
+         *        sample the server for the duration and report what kept growing.
+         */
+        int run_soak(const BenchConfig &config) {
+            std::cout << "mcp_bench: soak of " << config.idle << " idle connections, " << config.streams << " streams and "
+                      << config.cached_events << " cached events for " << config.duration.count() / 1000 << " s, to "
+                      << config.host << ":" << config.port << config.path << std::endl;
+
+            ServerSnapshot before = take_snapshot(config);
+            if (before.rss_bytes < 0) {
+                std::cerr << "Error: no memory figures at " << config.stats_path
+                          << "; the soak needs admin_stats_endpoint=1 on a Linux server" << std::endl;
+                return 1;
+            }
+
+            std::vector<std::unique_ptr<asio::io_context>> contexts;
+            std::vector<asio::executor_work_guard<asio::io_context::executor_type>> guards;
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < config.threads; ++i) {
+                contexts.push_back(std::make_unique<asio::io_context>(1));
+                guards.push_back(asio::make_work_guard(*contexts.back()));
+            }
+            for (auto &context: contexts) {
+                workers.emplace_back([&context] { context->run(); });
+            }
+
+            SoakCounters counters;
+            std::vector<std::pair<SoakClient *, asio::io_context *>> running;
+            std::vector<std::unique_ptr<SoakClient>> clients;
+            auto start = [&](auto make) {
+                auto &context = *contexts[clients.size() % contexts.size()];
+                clients.push_back(make(context));
+                running.emplace_back(clients.back().get(), &context);
+                asio::co_spawn(context, clients.back()->run(), [&counters](std::exception_ptr error) {
+                    if (!error) {
+                        return;
+                    }
+                    try {
+                        std::rethrow_exception(error);
+                    } catch (const std::exception &e) {
+                        counters.note_error(e.what());
+                    }
+                });
+            };
+            auto wait_for = [](auto done, std::chrono::seconds limit) {
+                Clock::time_point give_up = Clock::now() + limit;
+                while (!done() && Clock::now() < give_up) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            };
+            auto per = [](int64_t bytes, int64_t count) { return count > 0 ? static_cast<double>(bytes) / static_cast<double>(count) : 0.0; };
+
+            // 1. Idle connections
+            for (size_t i = 0; i < config.idle; ++i) {
+                start([&config, &counters](asio::io_context &io) { return std::make_unique<IdleConnection>(io, config, counters); });
+            }
+            wait_for([&] { return counters.idle.load() >= static_cast<int64_t>(config.idle); }, std::chrono::seconds(60));
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            ServerSnapshot idle = take_snapshot(config);
+            int64_t idle_open = counters.idle.load();
+
+            // 2. Open streams; the events they cache meanwhile are taken out with the cache's own estimate
+            for (size_t i = 0; i < config.streams; ++i) {
+                start([&config, &counters](asio::io_context &io) { return std::make_unique<SoakStream>(io, config, counters); });
+            }
+            wait_for([&] { return counters.streams.load() >= static_cast<int64_t>(config.streams); }, std::chrono::seconds(60));
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            ServerSnapshot streamed = take_snapshot(config);
+            int64_t streams_open = counters.streams.load();
+
+            // 3. Cached events, produced by the streams; given up on once the cache stops growing
+            ServerSnapshot cached = streamed;
+            Clock::time_point grew = Clock::now();
+            while (cached.cache_entries - streamed.cache_entries < static_cast<int64_t>(config.cached_events) &&
+                   Clock::now() - grew < std::chrono::seconds(20)) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                ServerSnapshot now = take_snapshot(config);
+                if (now.cache_entries > cached.cache_entries) {
+                    grew = Clock::now();
+                }
+                cached = now;
+            }
+            int64_t events = cached.cache_entries - streamed.cache_entries;
+
+            double idle_bytes = per(idle.rss_bytes - before.rss_bytes, idle_open);
+            double stream_bytes = per((streamed.rss_bytes - idle.rss_bytes) - (streamed.cache_bytes - idle.cache_bytes), streams_open);
+            double event_bytes = per(cached.rss_bytes - streamed.rss_bytes, events);
+            double event_estimate = per(cached.cache_bytes - streamed.cache_bytes, events);
+            std::cout << std::endl
+                      << std::fixed << std::setprecision(0)
+                      << "Resident bytes per idle connection: " << idle_bytes << " (" << idle_open << " open)" << std::endl
+                      << "Resident bytes per open stream:     " << stream_bytes << " (" << streams_open << " open)" << std::endl
+                      << "Resident bytes per cached event:    " << event_bytes << " (" << events << " cached, "
+                      << event_estimate << " by the cache's own count)" << std::endl;
+            if (events < static_cast<int64_t>(config.cached_events)) {
+                std::cout << "Warning: the cache stopped at " << events << " new events; raise max_events_per_session, "
+                             "--streams or the events of --stream-arguments"
+                          << std::endl;
+            }
+
+            // 4. Hold everything open and sample
+            std::cout << std::endl
+                      << std::right << std::setw(10) << "seconds" << std::setw(14) << "rss" << std::setw(14) << "heap"
+                      << std::setw(12) << "generators" << std::setw(12) << "limiter" << std::setw(12) << "cached"
+                      << std::setw(12) << "connections" << std::endl;
+            std::vector<std::pair<double, ServerSnapshot>> samples;
+            Clock::time_point hold = Clock::now();
+            Clock::time_point end = hold + config.duration;
+            while (true) {
+                ServerSnapshot now = take_snapshot(config);
+                double seconds = std::chrono::duration<double>(Clock::now() - hold).count();
+                samples.emplace_back(seconds, now);
+                std::cout << std::setw(10) << seconds << std::setw(14) << now.rss_bytes << std::setw(14) << now.heap_allocated
+                          << std::setw(12) << now.generators << std::setw(12) << now.limiter_sessions << std::setw(12)
+                          << now.cache_entries << std::setw(12) << now.connections << std::endl;
+                if (Clock::now() + config.sample_interval > end) {
+                    break;
+                }
+                std::this_thread::sleep_for(config.sample_interval);
+            }
+
+            for (auto &[client, context]: running) {
+                asio::post(*context, [client = client] { client->stop(); });
+            }
+            guards.clear();
+            for (auto &worker: workers) {
+                worker.join();
+            }
+
+            constexpr std::array<std::pair<const char *, int64_t ServerSnapshot::*>, 6> kSeries = {{
+                    {"rss_bytes", &ServerSnapshot::rss_bytes},
+                    {"heap_allocated_bytes", &ServerSnapshot::heap_allocated},
+                    {"stream_generators", &ServerSnapshot::generators},
+                    {"rate_limiter_sessions", &ServerSnapshot::limiter_sessions},
+                    {"cache_entries", &ServerSnapshot::cache_entries},
+                    {"connections", &ServerSnapshot::connections},
+            }};
+            std::cout << std::endl
+                      << std::left << std::setw(24) << "" << std::right << std::setw(14) << "first" << std::setw(14) << "last"
+                      << std::setw(14) << "per hour" << std::endl;
+            nlohmann::json trends = nlohmann::json::object();
+            std::vector<std::string> growing;
+            for (const auto &[name, member]: kSeries) {
+                SoakTrend trend = trend_of(samples, member);
+                std::cout << std::left << std::setw(24) << name << std::right << std::setw(14) << trend.first << std::setw(14)
+                          << trend.last << std::setw(14) << trend.per_hour << (trend.growing ? "  growing" : "") << std::endl;
+                trends[name] = {{"first", trend.first}, {"last", trend.last}, {"per_hour", trend.per_hour}, {"growing", trend.growing}};
+                if (trend.growing) {
+                    growing.emplace_back(name);
+                }
+            }
+            std::cout << std::endl
+                      << "Streams completed: " << counters.completed.load() << ", errors: " << counters.errors.load() << std::endl;
+            if (!counters.first_error.empty()) {
+                std::cout << "First error: " << counters.first_error << std::endl;
+            }
+            if (!growing.empty()) {
+                std::cout << "Warning: still growing at the end:";
+                for (const auto &name: growing) {
+                    std::cout << " " << name;
+                }
+                std::cout << "; sessions of ended streams are freed once they expire, so growth that lasts "
+                             "well past the session TTL is a leak"
+                          << std::endl;
+            }
+
+            if (!config.json_path.empty()) {
+                nlohmann::json series = nlohmann::json::array();
+                for (const auto &[seconds, snapshot]: samples) {
+                    nlohmann::json sample = snapshot.to_json();
+                    sample["seconds"] = seconds;
+                    series.push_back(std::move(sample));
+                }
+                nlohmann::json json = {{"mode", "soak"},
+                                       {"duration_s", std::chrono::duration<double>(config.duration).count()},
+                                       {"idle_connections", idle_open},
+                                       {"streams", streams_open},
+                                       {"cached_events", events},
+                                       {"bytes_per_idle_connection", idle_bytes},
+                                       {"bytes_per_stream", stream_bytes},
+                                       {"bytes_per_cached_event", event_bytes},
+                                       {"cache_bytes_per_event", event_estimate},
+                                       {"streams_completed", counters.completed.load()},
+                                       {"errors", counters.errors.load()},
+                                       {"server", {{"before", before.to_json()}, {"idle", idle.to_json()}, {"streamed", streamed.to_json()}, {"cached", cached.to_json()}}},
+                                       {"trends", std::move(trends)},
+                                       {"samples", std::move(series)}};
+                std::ofstream out(config.json_path);
+                out << json.dump(2) << std::endl;
+                if (!out) {
+                    std::cerr << "Error: cannot write " << config.json_path << std::endl;
+                }
+            }
+            return 0;
+        }
+
+        std::optional<BenchConfig> parse_arguments(int argc, char *argv[]) {
+            args::ArgumentParser parser("MCP load generator",
+                                        "Opens CONNECTIONS sessions and sends RATE requests per second over them, "
+                                        "whether or not earlier requests were answered.");
+            parser.Prog(argv[0]);
+            args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+            args::Positional<std::string> url(parser, "URL", "Streamable HTTP endpoint, e.g. http://127.0.0.1:6666/mcp or https://127.0.0.1:6667/mcp", args::Options::Required);
+            args::ValueFlag<size_t> connections(parser, "N", "Connections, each with its own session (default: 16)", {'c', "connections"}, 16);
+            args::ValueFlag<size_t> threads(parser, "N", "IO threads (default: 1)", {'t', "threads"}, 1);
+            args::ValueFlag<double> rate(parser, "RATE", "Requests per second over all connections (default: 1000)", {'r', "rate"}, 1000);
+            args::ValueFlag<double> duration(parser, "SECONDS", "Measured run time (default: 10)", {'d', "duration"}, 10);
+            args::ValueFlag<double> warmup(parser, "SECONDS", "Unmeasured run time before it (default: 2)", {"warmup"}, 2);
+            args::ValueFlag<double> timeout(parser, "SECONDS", "Longest a request, or a pause in a stream, may take (default: 30)", {"timeout"}, 30);
+            args::ValueFlag<std::string> mix(parser, "MIX", "Workload weights (default: call=100)", {'m', "mix"}, "call=100");
+            args::ValueFlag<std::string> tool(parser, "NAME", "Tool of the call workload (default: echo)", {"tool"}, "echo");
+            args::ValueFlag<std::string> arguments(parser, "JSON", "Its arguments (default: {\"text\":\"hello\"})", {"arguments"}, R"({"text":"hello"})");
+            args::ValueFlag<std::string> stream_tool(parser, "NAME", "Tool of the stream workload (default: example_stream)", {"stream-tool"}, "example_stream");
+            args::ValueFlag<std::string> stream_arguments(parser, "JSON", "Its arguments (default: {})", {"stream-arguments"}, "{}");
+            args::ValueFlag<std::string> token(parser, "TOKEN", "Bearer token", {"token"});
+            args::ValueFlag<std::string> json_path(parser, "PATH", "Also write the report as JSON", {"json"});
+            args::Flag reconnect(parser, "reconnect", "Keep CONNECTIONS streams of the stream tool running, drop them at random and resume them with Last-Event-ID", {"reconnect"});
+            args::ValueFlag<double> disconnect(parser, "MS", "Mean time to a dropped stream connection (default: 500, 0 = never)", {"disconnect-ms"}, 500);
+            args::ValueFlag<std::string> stats_path(parser, "PATH", "Stats endpoint read by --reconnect (default: /admin/stats, empty = none)", {"stats-path"}, "/admin/stats");
+            args::ValueFlag<double> settle(parser, "SECONDS", "Wait before --reconnect reads the server a last time (default: 0)", {"settle"}, 0);
+            args::ValueFlag<std::string> ca(parser, "FILE", "CA certificate to verify an https server with (default: not verified)", {"ca"});
+            args::Flag soak(parser, "soak", "Measure the server's memory per idle connection, open stream and cached event, then sample it for the duration", {"soak"});
+            args::ValueFlag<size_t> idle(parser, "N", "Idle keep-alive connections of --soak (default: 1000)", {"idle"}, 1000);
+            args::ValueFlag<size_t> streams(parser, "N", "Streams of the stream tool --soak keeps open (default: 100)", {"streams"}, 100);
+            args::ValueFlag<size_t> cached_events(parser, "N", "Events --soak waits to see cached (default: 10000)", {"cached-events"}, 10000);
+            args::ValueFlag<double> sample_interval(parser, "SECONDS", "Between two --soak samples of the server (default: 10)", {"sample-interval"}, 10);
+            args::ValueFlag<std::string> tls_mode(parser, "MODE", "Over https, measure handshake, resume or bulk as fast as the server allows instead of the load", {"tls-mode"});
+
+            try {
+                parser.ParseCLI(argc, argv);
+            } catch (const args::Help &) {
+                std::cout << parser;
+                return std::nullopt;
+            } catch (const args::Error &e) {
+                std::cerr << "Error parsing command line: " << e.what() << std::endl;
+                std::cerr << parser;
+                return std::nullopt;
+            }
+
+            BenchConfig config;
+            bool https = false;
+            if (!parse_url(args::get(url), config, https)) {
+                std::cerr << "Error: URL must be http[s]://host[:port][/path]" << std::endl;
+                return std::nullopt;
+            }
+            if (https) {
+                config.tls = std::make_shared<asio::ssl::context>(asio::ssl::context::tls_client);
+                config.verify = static_cast<bool>(ca);
+                try {
+                    if (config.verify) {
+                        config.tls->load_verify_file(args::get(ca));
+                        config.tls->set_verify_mode(asio::ssl::verify_peer);
+                    } else {
+                        config.tls->set_verify_mode(asio::ssl::verify_none);
+                    }
+                } catch (const std::exception &e) {
+                    std::cerr << "Error: cannot load " << args::get(ca) << ": " << e.what() << std::endl;
+                    return std::nullopt;
+                }
+            }
+            if (tls_mode) {
+                auto mode = std::find(kTlsModeNames.begin() + 1, kTlsModeNames.end(), args::get(tls_mode));
+                if (mode == kTlsModeNames.end()) {
+                    std::cerr << "Error: --tls-mode must be handshake, resume or bulk" << std::endl;
+                    return std::nullopt;
+                }
+                if (!https) {
+                    std::cerr << "Error: --tls-mode needs an https:// URL" << std::endl;
+                    return std::nullopt;
+                }
+                config.tls_mode = static_cast<TlsMode>(mode - kTlsModeNames.begin());
+            }
+            if (!parse_mix(args::get(mix), config.mix)) {
+                std::cerr << "Error: mix must look like call=80,list=10,stream=10" << std::endl;
+                return std::nullopt;
+            }
+            config.connections = std::max<size_t>(1, args::get(connections));
+            config.threads = std::clamp<size_t>(args::get(threads), 1, config.connections);
+            config.rate = args::get(rate);
+            if (config.rate <= 0) {
+                std::cerr << "Error: rate must be positive" << std::endl;
+                return std::nullopt;
+            }
+            auto to_ms = [](double seconds) { return std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000)); };
+            config.duration = std::max(to_ms(args::get(duration)), std::chrono::milliseconds(1));
+            config.warmup = std::max(to_ms(args::get(warmup)), std::chrono::milliseconds(0));
+            config.timeout = std::max(to_ms(args::get(timeout)), std::chrono::milliseconds(1));
+            config.token = args::get(token);
+            config.json_path = args::get(json_path);
+            config.reconnect = args::get(reconnect);
+            config.disconnect_after = std::chrono::milliseconds(static_cast<int64_t>(std::max(args::get(disconnect), 0.0)));
+            config.stats_path = args::get(stats_path);
+            config.settle = std::max(to_ms(args::get(settle)), std::chrono::milliseconds(0));
+            config.soak = args::get(soak);
+            config.idle = args::get(idle);
+            config.streams = args::get(streams);
+            config.cached_events = args::get(cached_events);
+            config.sample_interval = std::max(to_ms(args::get(sample_interval)), std::chrono::milliseconds(100));
+
+            auto call_arguments = nlohmann::json::parse(args::get(arguments), nullptr, false);
+            auto streamed_arguments = nlohmann::json::parse(args::get(stream_arguments), nullptr, false);
+            if (!call_arguments.is_object() || !streamed_arguments.is_object()) {
+                std::cerr << "Error: tool arguments must be JSON objects" << std::endl;
+                return std::nullopt;
+            }
+            config.call_params = nlohmann::json{{"name", args::get(tool)}, {"arguments", call_arguments}}.dump();
+            config.stream_params = nlohmann::json{{"name", args::get(stream_tool)}, {"arguments", streamed_arguments}}.dump();
+            return config;
+        }
+
+        int run(const BenchConfig &config) {
+            std::cout << "mcp_bench: " << config.connections << " connections, " << config.threads << " threads, "
+                      << config.rate << " requests/s to " << config.host << ":" << config.port << config.path << std::endl;
+
+            std::vector<std::unique_ptr<asio::io_context>> contexts;
+            std::vector<BenchStats> stats(config.threads);
+            std::vector<std::unique_ptr<BenchConnection>> connections;
+            for (size_t i = 0; i < config.threads; ++i) {
+                contexts.push_back(std::make_unique<asio::io_context>(1));
+            }
+
+            // Sessions are opened during the warmup, which the schedule starts with
+            Clock::time_point start = Clock::now() + std::chrono::milliseconds(100);
+            for (size_t i = 0; i < config.connections; ++i) {
+                size_t thread = i % config.threads;
+                connections.push_back(std::make_unique<BenchConnection>(*contexts[thread], config, stats[thread], i));
+                asio::co_spawn(*contexts[thread], connections.back()->run(start), [&stats, thread](std::exception_ptr error) {
+                    if (!error) {
+                        return;
+                    }
+                    try {
+                        std::rethrow_exception(error);
+                    } catch (const std::exception &e) {
+                        stats[thread].note_error(e.what());
+                    }
+                });
+            }
+
+            std::vector<std::thread> workers;
+            for (auto &context: contexts) {
+                workers.emplace_back([&context] { context->run(); });
+            }
+            for (auto &worker: workers) {
+                worker.join();
+            }
+
+            BenchStats total;
+            for (const auto &thread_stats: stats) {
+                total.merge(thread_stats);
+            }
+            report(config, total, Clock::now() - (start + config.warmup));
+            return 0;
+        }
+
+    }// namespace apps
+}// namespace mcp
+
+int main(int argc, char *argv[]) {
+    auto config = mcp::apps::parse_arguments(argc, argv);
+    if (!config) {
+        return 1;
+    }
+    if (config->reconnect) {
+        return mcp::apps::run_reconnect(*config);
+    }
+    if (config->soak) {
+        return mcp::apps::run_soak(*config);
+    }
+    return config->tls_mode != mcp::apps::TlsMode::Off ? mcp::apps::run_tls(*config) : mcp::apps::run(*config);
+}
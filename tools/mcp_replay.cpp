@@ -0,0 +1,489 @@
+/*
+ * @Description: MCP traffic replay (mcp_replay)
+ *               Sends the requests of a capture written by the server's traffic capture to a
+ *               server again, with their original timing at 1x or scaled by --speed, one
+ *               connection per captured connection, and reports how the server answered.
+ */
+#if defined(_WIN32) && !defined(_WIN32_WINNT)
+#define _WIN32_WINNT 0x0601
+#endif
+
+#include "args.hxx"
+#include "transport/http_response_decoder.h"
+#include "transport/traffic_capture.h"
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+
+// STL
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mcp {
+    namespace apps {
+
+        using Clock = std::chrono::steady_clock;
+
+        struct ReplayConfig {
+            std::string capture;
+            std::string host;
+            std::string port;
+            std::string token;
+            double speed = 1;///< Captured time is divided by this
+            std::chrono::milliseconds timeout{30000};
+            std::string json_path;///< Write the report here too, empty = no
+        };
+
+        struct ReplayStats {
+            uint64_t sent = 0;
+            uint64_t failed = 0;    ///< No response: connection errors and timeouts
+            uint64_t rpc_errors = 0;///< JSON-RPC error responses
+            uint64_t sessions_opened = 0;///< Sessions the replay had to open itself
+            std::map<int, uint64_t> statuses;
+            std::vector<uint64_t> latency_us;///< From the time a request was sent
+            std::vector<uint64_t> lag_us;    ///< From the time a request was due to the time it was sent
+            std::string first_error;
+
+            void note_error(const std::string &error) {
+                ++failed;
+                if (first_error.empty()) {
+                    first_error = error;
+                }
+            }
+        };
+
+        /**
+         * @brief Replayed sessions standing in for captured ones.
+         *
+         * A captured Mcp-Session-Id seen for the first time is bound to the session the replay of
+         * its connection opened last (by replaying an initialize) and did not bind yet, or else to a
+         * session the replay opens for it; all later requests carrying it are sent with that one.
+         */
+        struct SessionMap {
+            std::unordered_map<std::string, std::string> replayed;
+        };
+
+        /**
+         * @brief One captured connection, replayed on its own keep-alive connection in capture order.
+         *
+         * Each request is sent when it is due, but only once the previous request of the connection
+         * has been answered, as it was captured; a late request shows up as lag rather than being
+         * sent early on a second connection.
+         */
+        class ReplayConnection {
+        public:
+            ReplayConnection(asio::io_context &io, const ReplayConfig &config, ReplayStats &stats, SessionMap &sessions,
+                             std::vector<transport::CapturedRequest> requests)
+                : io_(io), config_(config), stats_(stats), sessions_(sessions), requests_(std::move(requests)),
+                  socket_(io), timer_(io), watchdog_(io) {
+                host_ = "Host: " + config.host + ":" + config.port + "\r\n";
+                if (!config.token.empty()) {
+                    host_ += "Authorization: Bearer " + config.token + "\r\n";
+                }
+            }
+
+            asio::awaitable<void> run(Clock::time_point start) {
+                for (auto &request: requests_) {
+                    auto due = start + std::chrono::duration_cast<Clock::duration>(
+                                               std::chrono::duration<double, std::micro>(static_cast<double>(request.offset_us) / config_.speed));
+                    timer_.expires_at(due);
+                    asio::error_code ignored;
+                    co_await timer_.async_wait(asio::redirect_error(asio::use_awaitable, ignored));
+
+                    try {
+                        std::string session_id;
+                        if (!request.mcp_session_id.empty()) {
+                            session_id = co_await replayed_session(request.target, request.mcp_session_id);
+                        }
+                        auto sent = Clock::now();
+                        stats_.lag_us.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sent - due).count()));
+                        ++stats_.sent;
+                        Reply reply = co_await exchange(request.method, request.target, session_id, request.body);
+                        stats_.latency_us.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sent).count()));
+                        ++stats_.statuses[reply.status];
+                        stats_.rpc_errors += reply.rpc_error ? 1 : 0;
+                        if (!reply.session_id.empty() && reply.session_id != session_id && is_initialize(request.body)) {
+                            opened_ = reply.session_id;
+                        }
+                    } catch (const std::exception &e) {
+                        stats_.note_error(e.what());
+                    }
+                }
+                close();
+            }
+
+        private:
+            struct Reply {
+                int status = 0;
+                bool rpc_error = false;
+                std::string session_id;
+            };
+
+            static bool is_initialize(std::string_view body) {
+                auto json = nlohmann::json::parse(body, nullptr, false);
+                return json.is_object() && json.value("method", "") == "initialize";
+            }
+
+            /**
+             * @brief The session to send instead of a captured one, opened if there is none yet.
+             */
+            asio::awaitable<std::string> replayed_session(const std::string &target, const std::string &captured) {
+                if (auto it = sessions_.replayed.find(captured); it != sessions_.replayed.end()) {
+                    co_return it->second;
+                }
+                std::string session_id = std::exchange(opened_, {});
+                if (session_id.empty()) {
+                    // Captured after its initialize, or the initialize went through another connection
+                    nlohmann::json initialize = {{"jsonrpc", "2.0"},
+                                                 {"id", 0},
+                                                 {"method", "initialize"},
+                                                 {"params",
+                                                  {{"protocolVersion", "2025-03-26"},
+                                                   {"capabilities", nlohmann::json::object()},
+                                                   {"clientInfo", {{"name", "mcp_replay"}, {"version", "1.0"}}}}}};
+                    Reply reply = co_await exchange("POST", target, {}, initialize.dump());
+                    if (reply.status / 100 != 2 || reply.session_id.empty()) {
+                        throw std::runtime_error("could not open a session, HTTP " + std::to_string(reply.status));
+                    }
+                    session_id = reply.session_id;
+                    co_await exchange("POST", target, session_id, R"({"jsonrpc":"2.0","method":"notifications/initialized"})");
+                    ++stats_.sessions_opened;
+                }
+                sessions_.replayed.emplace(captured, session_id);
+                co_return session_id;
+            }
+
+            /**
+             * @brief Send a request and read the whole response; a kept-alive connection the server
+             *        has closed meanwhile is replaced once.
+             */
+            asio::awaitable<Reply> exchange(const std::string &method, const std::string &target, const std::string &session_id,
+                                            const std::string &body) {
+                std::string head = method + " " + target + " HTTP/1.1\r\n" + host_;
+                head += "Content-Type: application/json\r\nAccept: application/json, text/event-stream\r\n";
+                if (!session_id.empty()) {
+                    head += "Mcp-Session-Id: " + session_id + "\r\n";
+                }
+                head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+                std::array<asio::const_buffer, 2> request{asio::buffer(head), asio::buffer(body)};
+
+                for (int attempt = 0;; ++attempt) {
+                    bool reused = socket_.is_open();
+                    bool received = false;
+                    arm_watchdog();
+                    std::exception_ptr failure;
+                    try {
+                        if (!reused) {
+                            co_await connect();
+                        }
+                        co_await asio::async_write(socket_, request, asio::use_awaitable);
+                        Reply reply = co_await read_reply(received);
+                        watchdog_.cancel();
+                        co_return reply;
+                    } catch (...) {
+                        failure = std::current_exception();
+                    }
+                    watchdog_.cancel();
+                    close();
+                    if (timed_out_) {
+                        timed_out_ = false;
+                        throw std::runtime_error("timed out");
+                    }
+                    if (!reused || received || attempt > 0) {
+                        std::rethrow_exception(failure);
+                    }
+                }
+            }
+
+            asio::awaitable<void> connect() {
+                asio::ip::tcp::resolver resolver(io_);
+                auto endpoints = co_await resolver.async_resolve(config_.host, config_.port, asio::use_awaitable);
+                co_await asio::async_connect(socket_, endpoints, asio::use_awaitable);
+                socket_.set_option(asio::ip::tcp::no_delay(true));
+            }
+
+            asio::awaitable<Reply> read_reply(bool &received) {
+                Reply reply;
+                std::string payload;
+                transport::HttpResponseDecoder decoder;
+                std::string_view pending;
+                while (!decoder.done()) {
+                    if (pending.empty()) {
+                        asio::error_code ec;
+                        size_t n = co_await socket_.async_read_some(asio::buffer(buffer_), asio::redirect_error(asio::use_awaitable, ec));
+                        if (ec == asio::error::eof && decoder.until_close()) {
+                            close();
+                            break;
+                        }
+                        if (ec) {
+                            throw std::runtime_error(ec == asio::error::eof ? "connection closed by the server" : ec.message());
+                        }
+                        received = true;
+                        pending = std::string_view(buffer_.data(), n);
+                    }
+                    switch (decoder.next(pending)) {
+                        case transport::HttpResponseDecoder::Part::Head:
+                            if (auto id = decoder.field("mcp-session-id"); !id.empty()) {
+                                reply.session_id = id;
+                            }
+                            break;
+                        case transport::HttpResponseDecoder::Part::Body:
+                            payload.append(decoder.body());
+                            break;
+                        case transport::HttpResponseDecoder::Part::Error:
+                            throw std::runtime_error(decoder.error());
+                        case transport::HttpResponseDecoder::Part::NeedMore:
+                            break;
+                    }
+                }
+                reply.status = decoder.status();
+                // JSON-RPC errors are serialized with sorted keys: {"error":{"code":...
+                reply.rpc_error = payload.find(R"("error":{"code")") != std::string::npos;
+                co_return reply;
+            }
+
+            void arm_watchdog() {
+                watchdog_.expires_after(config_.timeout);
+                watchdog_.async_wait([this](const asio::error_code &ec) {
+                    if (!ec) {
+                        timed_out_ = true;
+                        close();
+                    }
+                });
+            }
+
+            void close() {
+                asio::error_code ignored;
+                socket_.close(ignored);
+            }
+
+            asio::io_context &io_;
+            const ReplayConfig &config_;
+            ReplayStats &stats_;
+            SessionMap &sessions_;
+            std::vector<transport::CapturedRequest> requests_;
+            asio::ip::tcp::socket socket_;
+            asio::steady_timer timer_;
+            asio::steady_timer watchdog_;
+            bool timed_out_ = false;
+            std::array<char, 16 * 1024> buffer_{};
+            std::string host_;  ///< Host and Authorization header lines
+            std::string opened_;///< Session opened by a replayed initialize, not bound to a captured one yet
+        };
+
+        // Only plain http:// endpoints; the path of each request comes from the capture
+        bool parse_url(std::string_view url, ReplayConfig &config) {
+            constexpr std::string_view scheme = "http://";
+            if (!url.starts_with(scheme)) {
+                return false;
+            }
+            url.remove_prefix(scheme.size());
+            std::string_view authority = url.substr(0, url.find('/'));
+            size_t colon = authority.rfind(':');
+            if (colon == std::string_view::npos || authority.find(']', colon) != std::string_view::npos) {
+                config.host = authority;
+                config.port = "80";
+            } else {
+                config.host = authority.substr(0, colon);
+                config.port = authority.substr(colon + 1);
+            }
+            if (config.host.size() >= 2 && config.host.front() == '[' && config.host.back() == ']') {
+                config.host = config.host.substr(1, config.host.size() - 2);
+            }
+            return !config.host.empty() && !config.port.empty();
+        }
+
+        uint64_t percentile(std::vector<uint64_t> &values, double percent) {
+            if (values.empty()) {
+                return 0;
+            }
+            size_t rank = std::min(values.size() - 1, static_cast<size_t>(percent / 100.0 * static_cast<double>(values.size())));
+            std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+            return values[rank];
+        }
+
+        std::string format_ms(uint64_t us) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(3) << static_cast<double>(us) / 1000.0;
+            return out.str();
+        }
+
+        void report(const ReplayConfig &config, ReplayStats &stats, size_t skipped, Clock::duration elapsed) {
+            double seconds = std::max(std::chrono::duration<double>(elapsed).count(), 1e-3);
+            nlohmann::json json = {{"capture", config.capture},
+                                   {"speed", config.speed},
+                                   {"sent", stats.sent},
+                                   {"failed", stats.failed},
+                                   {"rpc_errors", stats.rpc_errors},
+                                   {"skipped", skipped},
+                                   {"sessions_opened", stats.sessions_opened},
+                                   {"duration_s", seconds},
+                                   {"statuses", nlohmann::json::object()}};
+
+            std::cout << std::endl
+                      << "Replayed " << stats.sent << " requests in " << std::fixed << std::setprecision(1) << seconds << " s ("
+                      << static_cast<double>(stats.sent) / seconds << "/s)" << std::endl;
+            for (const auto &[status, count]: stats.statuses) {
+                std::cout << "  HTTP " << status << ": " << count << std::endl;
+                json["statuses"][std::to_string(status)] = count;
+            }
+            std::cout << "JSON-RPC errors: " << stats.rpc_errors << ", no response: " << stats.failed << std::endl;
+            if (skipped > 0) {
+                std::cout << "Event stream GETs not replayed: " << skipped << std::endl;
+            }
+            if (stats.sessions_opened > 0) {
+                std::cout << "Sessions opened for captured ones without their initialize: " << stats.sessions_opened << std::endl;
+            }
+
+            std::cout << std::endl
+                      << std::left << std::setw(12) << "ms" << std::right;
+            for (const char *label: {"p50", "p90", "p99", "p99.9", "max"}) {
+                std::cout << std::setw(11) << label;
+            }
+            std::cout << std::endl;
+            for (auto [name, values]: {std::pair<const char *, std::vector<uint64_t> *>{"latency", &stats.latency_us}, {"send lag", &stats.lag_us}}) {
+                std::cout << std::left << std::setw(12) << name << std::right;
+                nlohmann::json row = {{"count", values->size()}};
+                for (double percent: {50.0, 90.0, 99.0, 99.9, 100.0}) {
+                    uint64_t value = percentile(*values, percent);
+                    std::cout << std::setw(11) << format_ms(value);
+                    std::ostringstream key;
+                    key << "p" << percent;
+                    row[key.str()] = value;
+                }
+                std::cout << std::endl;
+                json[std::string(name) == "latency" ? "latency_us" : "send_lag_us"] = row;
+            }
+
+            if (!stats.first_error.empty()) {
+                std::cout << "First error: " << stats.first_error << std::endl;
+            }
+            if (percentile(stats.lag_us, 99) > 10000) {
+                std::cout << "Warning: p99 send lag above 10 ms, the server answered slower than the capture's pace at this speed" << std::endl;
+            }
+
+            if (!config.json_path.empty()) {
+                std::ofstream out(config.json_path);
+                out << json.dump(2) << std::endl;
+                if (!out) {
+                    std::cerr << "Error: cannot write " << config.json_path << std::endl;
+                }
+            }
+        }
+
+        std::optional<ReplayConfig> parse_arguments(int argc, char *argv[]) {
+            args::ArgumentParser parser("MCP traffic replay",
+                                        "Sends the requests of CAPTURE to the server at URL with their captured timing.");
+            parser.Prog(argv[0]);
+            args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+            args::Positional<std::string> capture(parser, "CAPTURE", "Capture file written with capture_path", args::Options::Required);
+            args::Positional<std::string> url(parser, "URL", "Server, e.g. http://127.0.0.1:6666", args::Options::Required);
+            args::ValueFlag<double> speed(parser, "N", "Replay N times as fast as captured (default: 1)", {'s', "speed"}, 1);
+            args::ValueFlag<double> timeout(parser, "SECONDS", "Longest a request may take (default: 30)", {"timeout"}, 30);
+            args::ValueFlag<std::string> token(parser, "TOKEN", "Bearer token; captures hold no credentials", {"token"});
+            args::ValueFlag<std::string> json_path(parser, "PATH", "Also write the report as JSON", {"json"});
+
+            try {
+                parser.ParseCLI(argc, argv);
+            } catch (const args::Help &) {
+                std::cout << parser;
+                return std::nullopt;
+            } catch (const args::Error &e) {
+                std::cerr << "Error parsing command line: " << e.what() << std::endl;
+                std::cerr << parser;
+                return std::nullopt;
+            }
+
+            ReplayConfig config;
+            config.capture = args::get(capture);
+            if (!parse_url(args::get(url), config)) {
+                std::cerr << "Error: URL must be http://host[:port]" << std::endl;
+                return std::nullopt;
+            }
+            config.speed = args::get(speed);
+            if (config.speed <= 0) {
+                std::cerr << "Error: speed must be positive" << std::endl;
+                return std::nullopt;
+            }
+            config.timeout = std::max(std::chrono::milliseconds(static_cast<int64_t>(args::get(timeout) * 1000)), std::chrono::milliseconds(1));
+            config.token = args::get(token);
+            config.json_path = args::get(json_path);
+            return config;
+        }
+
+        int run(const ReplayConfig &config) {
+            // Requests grouped by the connection they came on, in capture order
+            std::vector<std::vector<transport::CapturedRequest>> lanes;
+            size_t skipped = 0;
+            size_t total = 0;
+            try {
+                std::unordered_map<std::string, size_t> lane_of;
+                transport::CaptureReader reader(config.capture);
+                transport::CapturedRequest request;
+                while (reader.next(request)) {
+                    // An event stream stays open for as long as its session; replaying it would block the connection
+                    if (request.method == "GET") {
+                        ++skipped;
+                        continue;
+                    }
+                    auto [it, added] = lane_of.try_emplace(request.connection, lanes.size());
+                    if (added) {
+                        lanes.emplace_back();
+                    }
+                    lanes[it->second].push_back(std::move(request));
+                    ++total;
+                }
+            } catch (const std::exception &e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+            std::cout << "mcp_replay: " << total << " requests on " << lanes.size() << " connections at " << config.speed
+                      << "x to " << config.host << ":" << config.port << std::endl;
+
+            asio::io_context io(1);
+            ReplayStats stats;
+            SessionMap sessions;
+            std::vector<std::unique_ptr<ReplayConnection>> connections;
+            Clock::time_point start = Clock::now() + std::chrono::milliseconds(100);
+            for (auto &lane: lanes) {
+                connections.push_back(std::make_unique<ReplayConnection>(io, config, stats, sessions, std::move(lane)));
+                asio::co_spawn(io, connections.back()->run(start), [&stats](std::exception_ptr error) {
+                    if (!error) {
+                        return;
+                    }
+                    try {
+                        std::rethrow_exception(error);
+                    } catch (const std::exception &e) {
+                        stats.note_error(e.what());
+                    }
+                });
+            }
+            io.run();
+
+            report(config, stats, skipped, Clock::now() - start);
+            return stats.failed == 0 ? 0 : 2;
+        }
+
+    }// namespace apps
+}// namespace mcp
+
+int main(int argc, char *argv[]) {
+    auto config = mcp::apps::parse_arguments(argc, argv);
+    if (!config) {
+        return 1;
+    }
+    return mcp::apps::run(*config);
+}
@@ -5,6 +5,8 @@
  *               Following CommandLineConfig best practices
  */
 #include "args.hxx"
+#include "business/plugin_manager.h"
+#include "business/plugin_manifest.h"
 #include "config/config.hpp"
 #include "core/logger.h"
 #include "plugins/pluginhub/pluginhub.hpp"
@@ -18,6 +20,7 @@
 #include <mutex>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
 
 namespace fs = std::filesystem;
@@ -45,6 +48,16 @@ namespace mcp {
                 return plugin_id_;
             }
 
+            std::vector<std::string> getPluginIds() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return plugin_ids_;
+            }
+
+            size_t getJobs() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return jobs_;
+            }
+
             std::string getConfigPath() const {
                 std::lock_guard<std::mutex> lock(mutex_);
                 return config_path_;
@@ -60,10 +73,15 @@ namespace mcp {
                 return python_plugin_;
             }
 
+            std::string getPluginDir() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return plugin_dir_;
+            }
+
         private:
             bool parseArguments(int argc, char *argv[]) {
                 args::ArgumentParser parser("MCP Plugin Management Tool",
-                                            "plugin_ctl <command> [options]\nCommands: create, download, install, enable, disable, uninstall, list, status");
+                                            "plugin_ctl <command> [options]\nCommands: create, download, install, enable, disable, uninstall, list, status, manifest");
                 parser.Prog(argv[0]);
 
                 // Global options
@@ -81,15 +99,18 @@ namespace mcp {
                 args::Command list_cmd(parser, "list", "List plugins");
                 args::Command status_cmd(parser, "status", "Show hub status");
                 args::Command build_cmd(parser, "build", "Build Python plugin to DLL");
+                args::Command manifest_cmd(parser, "manifest", "Write the tool manifest used for lazy plugin loading");
 
                 // Subcommand arguments
                 args::Positional<std::string> create_id(create_cmd, "PLUGIN_ID", "Name of plugin to create");
                 args::Positional<std::string> download_id(download_cmd, "PLUGIN_ID", "ID of plugin to download");
-                args::Positional<std::string> install_id(install_cmd, "PLUGIN_ID", "ID of plugin to install");
+                args::PositionalList<std::string> install_ids(install_cmd, "PLUGIN_ID", "IDs of plugins to install");
+                args::ValueFlag<size_t> install_jobs(install_cmd, "N", "Plugins downloaded and extracted at once (default: download_jobs)", {'j', "jobs"}, 0);
                 args::Positional<std::string> enable_id(enable_cmd, "PLUGIN_ID", "ID of plugin to enable");
                 args::Positional<std::string> disable_id(disable_cmd, "PLUGIN_ID", "ID of plugin to disable");
                 args::Positional<std::string> uninstall_id(uninstall_cmd, "PLUGIN_ID", "ID of plugin to uninstall");
                 args::Positional<std::string> build_id(build_cmd, "PLUGIN_ID", "ID of Python plugin to build");
+                args::Positional<std::string> manifest_dir(manifest_cmd, "DIR", "Plugin directory (default: plugin enable dir)");
                 args::Flag list_remote(list_cmd, "remote", "List remote plugins", {"remote"});
                 args::Flag python_flag(create_cmd, "python", "Create Python plugin template instead of C++", {'p', "python"});
 
@@ -120,7 +141,9 @@ namespace mcp {
                     plugin_id_ = args::get(download_id);
                 } else if (install_cmd) {
                     command_ = "install";
-                    plugin_id_ = args::get(install_id);
+                    plugin_ids_ = args::get(install_ids);
+                    plugin_id_ = plugin_ids_.empty() ? std::string{} : plugin_ids_.front();
+                    jobs_ = args::get(install_jobs);
                 } else if (enable_cmd) {
                     command_ = "enable";
                     plugin_id_ = args::get(enable_id);
@@ -138,6 +161,9 @@ namespace mcp {
                     list_remote_ = args::get(list_remote);
                 } else if (status_cmd) {
                     command_ = "status";
+                } else if (manifest_cmd) {
+                    command_ = "manifest";
+                    plugin_dir_ = args::get(manifest_dir);
                 } else {
                     std::cerr << "Error: No command specified" << std::endl;
                     std::cerr << parser;
@@ -164,7 +190,10 @@ namespace mcp {
             mutable std::mutex mutex_;
             std::string command_;
             std::string plugin_id_;
+            std::vector<std::string> plugin_ids_;///< All plugins of a multi-plugin install
+            size_t jobs_ = 0;
             std::string config_path_;
+            std::string plugin_dir_;
             bool list_remote_ = false;
             bool python_plugin_ = false;
         };
@@ -172,13 +201,14 @@ namespace mcp {
         // Command handler function declarations
         void handle_create(const std::string &plugin_id, bool is_python);
         void handle_download(const std::string &plugin_id);
-        void handle_install(const std::string &plugin_id);
+        void handle_install(const std::vector<std::string> &plugin_ids, size_t jobs);
         void handle_enable(const std::string &plugin_id);
         void handle_disable(const std::string &plugin_id);
         void handle_uninstall(const std::string &plugin_id);
         void handle_list(bool remote);
         void handle_status();
         void handle_build(const std::string &plugin_id);
+        void handle_manifest(const std::string &directory);
 
         // Global configuration
         config::PluginHubConfig g_hub_config;
@@ -228,7 +258,7 @@ namespace mcp {
                         std::ofstream ofs(plugin_file);
                         ofs << "# Plugin: " << plugin_id << "\n";
                         ofs << "# This is a template for your Python plugin implementation using the new MCP SDK.\n\n";
-                        ofs << "from mcp_sdk import tool, string_param, get_tools, call_tool\n\n";
+                        ofs << "from mcp_sdk import tool, string_param, get_tools, call_tool, call_tool_object, start_stream\n\n";
                         ofs << "# Example of a standard tool\n";
                         ofs << "@tool(\n";
                         ofs << "    name=\"" << plugin_id << "\",\n";
@@ -594,6 +624,50 @@ namespace mcp {
             }
         }
 
+        void handle_manifest(const std::string &directory) {
+            fs::path plugins_dir = directory.empty() ? fs::path(g_hub_config.plugin_enable_dir) : fs::path(directory);
+            if (!fs::is_directory(plugins_dir)) {
+                std::cerr << "❌ Plugin directory does not exist: " << plugins_dir << std::endl;
+                return;
+            }
+
+            // Load each plugin once to read its tools, then unload it again
+            business::PluginManager manager;
+            std::vector<business::PluginManifestEntry> entries;
+            for (const auto &file: manager.find_plugin_files(plugins_dir.string())) {
+                fs::path plugin_path(file);
+                std::string plugin_name = plugin_path.filename().string();
+                if (!manager.load_plugin(file)) {
+                    std::cerr << "❌ Failed to load plugin '" << plugin_name << "', it stays eagerly loaded" << std::endl;
+                    continue;
+                }
+
+                business::PluginManifestEntry entry;
+                entry.file = plugin_name;
+                entry.size = fs::file_size(plugin_path);
+                entry.hash = business::PluginManifest::hash_file(plugin_path);
+                for (const auto &tool: manager.get_tools_from_plugin(file)) {
+                    if (tool.name) {
+                        entry.tools.push_back({tool.name,
+                                               tool.description ? tool.description : "",
+                                               tool.parameters ? tool.parameters : "",
+                                               tool.is_streaming});
+                    }
+                }
+                manager.unload_plugin(plugin_name);
+
+                std::cout << "  - " << plugin_name << " (" << entry.tools.size() << " tools)" << std::endl;
+                entries.push_back(std::move(entry));
+            }
+
+            if (business::PluginManifest::save(plugins_dir, entries)) {
+                std::cout << "✅ Wrote manifest for " << entries.size() << " plugins to '"
+                          << (plugins_dir / business::PluginManifest::kFileName).string() << "'" << std::endl;
+            } else {
+                std::cerr << "❌ Failed to write manifest in '" << plugins_dir.string() << "'" << std::endl;
+            }
+        }
+
         void handle_download(const std::string &plugin_id) {
             auto &hub = plugins::PluginHub::getInstance();
 
@@ -606,22 +680,25 @@ namespace mcp {
             }
         }
 
-        void handle_install(const std::string &plugin_id) {
+        void handle_install(const std::vector<std::string> &plugin_ids, size_t jobs) {
             auto &hub = plugins::PluginHub::getInstance();
-            fs::path zip_path = fs::path(g_hub_config.plugin_install_dir) / (plugin_id + ".zip");
 
-            if (!fs::exists(zip_path)) {
-                std::cout << "Archive not found, downloading..." << std::endl;
-                if (!hub.download(plugin_id)) {
-                    std::cerr << "❌ Failed to download plugin '" << plugin_id << "'" << std::endl;
-                    return;
+            // Archives come from the plugin cache when they are there, from the server otherwise
+            if (plugin_ids.size() == 1) {
+                const std::string &plugin_id = plugin_ids.front();
+                if (hub.install(plugin_id)) {
+                    std::cout << "✅ Plugin '" << plugin_id << "' installed successfully" << std::endl;
+                } else {
+                    std::cerr << "❌ Failed to install plugin '" << plugin_id << "'" << std::endl;
                 }
+                return;
             }
 
-            if (hub.install(plugin_id)) {
-                std::cout << "✅ Plugin '" << plugin_id << "' installed successfully" << std::endl;
+            size_t installed = hub.install(plugin_ids, jobs);
+            if (installed == plugin_ids.size()) {
+                std::cout << "✅ Installed " << installed << " plugins" << std::endl;
             } else {
-                std::cerr << "❌ Failed to install plugin '" << plugin_id << "'" << std::endl;
+                std::cerr << "❌ Installed " << installed << " of " << plugin_ids.size() << " plugins" << std::endl;
             }
         }
 
@@ -681,6 +758,8 @@ namespace mcp {
             std::cout << "Server port:              " << g_hub_config.plugin_server_port << "\n";
             std::cout << "Download route:           " << g_hub_config.download_route << "\n";
             std::cout << "Latest fetch route:       " << g_hub_config.latest_fetch_route << "\n";
+            std::cout << "Cache dir:                " << g_hub_config.plugin_cache_dir << "\n";
+            std::cout << "Download jobs:            " << g_hub_config.download_jobs << "\n";
         }
 
 
@@ -707,13 +786,14 @@ int main(int argc, char *argv[]) {
         const std::unordered_map<std::string, std::function<void()>> command_handlers = {
                 {"create", [&]() { handle_create(cli_config.getPluginId(), cli_config.isPythonPlugin()); }},
                 {"download", [&]() { handle_download(cli_config.getPluginId()); }},
-                {"install", [&]() { handle_install(cli_config.getPluginId()); }},
+                {"install", [&]() { handle_install(cli_config.getPluginIds(), cli_config.getJobs()); }},
                 {"enable", [&]() { handle_enable(cli_config.getPluginId()); }},
                 {"disable", [&]() { handle_disable(cli_config.getPluginId()); }},
                 {"uninstall", [&]() { handle_uninstall(cli_config.getPluginId()); }},
                 {"list", [&]() { handle_list(cli_config.isRemoteList()); }},
                 {"status", []() { handle_status(); }},
-                {"build", [&]() { handle_build(cli_config.getPluginId()); }}};
+                {"build", [&]() { handle_build(cli_config.getPluginId()); }},
+                {"manifest", [&]() { handle_manifest(cli_config.getPluginDir()); }}};
 
         auto it = command_handlers.find(command);
         if (it != command_handlers.end()) {
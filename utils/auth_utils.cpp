@@ -1,4 +1,5 @@
 #include "auth_utils.h"
+#include "config/config.hpp"
 #include "core/executable_path.h"
 #include "core/logger.h"
 #include <filesystem>
@@ -53,5 +54,21 @@ namespace mcp {
             return keys;
         }
 
+        AuthKeysObserver::AuthKeysObserver(std::shared_ptr<AuthManagerBase> auth_manager)
+            : auth_manager_(std::move(auth_manager)) {}
+
+        void AuthKeysObserver::onConfigReloaded(const mcp::config::GlobalConfig &newConfig) {
+            if (!newConfig.server.enable_auth) {
+                return;
+            }
+            auto keys = load_auth_keys_from_file(newConfig.server.auth_env_file);
+            if (keys.empty()) {
+                MCP_WARN("No auth keys loaded from {}, keeping the current keys", newConfig.server.auth_env_file);
+                return;
+            }
+            auth_manager_->set_keys(keys);
+            MCP_INFO("Reloaded {} auth keys", keys.size());
+        }
+
     }// namespace utils
 }// namespace mcp
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Auth/AuthManager.hpp"
+#include "config/config_observer.hpp"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -14,5 +17,20 @@ namespace mcp {
         */
         std::vector<std::string> load_auth_keys_from_file(const std::string &env_file_path);
 
+        /**
+        * @brief Reloads the auth keys file into an auth manager whenever the configuration is reloaded
+        *
+        * The new keys replace the old ones without stopping requests; an empty or missing file
+        * keeps the keys already loaded. The auth type cannot change without a restart.
+        */
+        class AuthKeysObserver : public mcp::config::ConfigObserver {
+        public:
+            explicit AuthKeysObserver(std::shared_ptr<AuthManagerBase> auth_manager);
+            void onConfigReloaded(const mcp::config::GlobalConfig &newConfig) override;
+
+        private:
+            std::shared_ptr<AuthManagerBase> auth_manager_;
+        };
+
     }// namespace utils
 }// namespace mcp
\ No newline at end of file
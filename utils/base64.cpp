@@ -0,0 +1,276 @@
+#include "base64.h"
+#include <array>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MCP_BASE64_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define MCP_BASE64_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace mcp::utils {
+
+    namespace {
+        constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        constexpr uint8_t kInvalid = 0xff;
+
+        /// ASCII -> 6-bit value, kInvalid for characters outside the alphabet
+        constexpr std::array<uint8_t, 256> make_decode_table() {
+            std::array<uint8_t, 256> table{};
+            for (auto &value: table) {
+                value = kInvalid;
+            }
+            for (uint8_t i = 0; i < 64; ++i) {
+                table[static_cast<unsigned char>(kAlphabet[i])] = i;
+            }
+            return table;
+        }
+        constexpr auto kDecodeTable = make_decode_table();
+
+        using EncodeFunc = std::size_t (*)(const unsigned char *, std::size_t, char *);
+        using DecodeFunc = std::optional<std::size_t> (*)(const unsigned char *, std::size_t, unsigned char *);
+
+        std::size_t encode_scalar(const unsigned char *src, std::size_t size, char *dst) {
+            char *start = dst;
+            std::size_t i = 0;
+            for (; i + 3 <= size; i += 3) {
+                uint32_t word = (uint32_t{src[i]} << 16) | (uint32_t{src[i + 1]} << 8) | src[i + 2];
+                *dst++ = kAlphabet[(word >> 18) & 0x3f];
+                *dst++ = kAlphabet[(word >> 12) & 0x3f];
+                *dst++ = kAlphabet[(word >> 6) & 0x3f];
+                *dst++ = kAlphabet[word & 0x3f];
+            }
+            if (i < size) {
+                uint32_t word = uint32_t{src[i]} << 16;
+                if (i + 1 < size) {
+                    word |= uint32_t{src[i + 1]} << 8;
+                }
+                *dst++ = kAlphabet[(word >> 18) & 0x3f];
+                *dst++ = kAlphabet[(word >> 12) & 0x3f];
+                *dst++ = i + 1 < size ? kAlphabet[(word >> 6) & 0x3f] : '=';
+                *dst++ = '=';
+            }
+            return static_cast<std::size_t>(dst - start);
+        }
+
+        std::optional<std::size_t> decode_scalar(const unsigned char *src, std::size_t size, unsigned char *dst) {
+            // Up to two '=' at the very end, the rest must be in the alphabet
+            std::size_t padding = 0;
+            while (padding < 2 && size > 0 && src[size - 1] == '=') {
+                --size;
+                ++padding;
+            }
+            if (size % 4 == 1 || (padding > 0 && (size + padding) % 4 != 0)) {
+                return std::nullopt;
+            }
+
+            unsigned char *start = dst;
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                uint32_t a = kDecodeTable[src[i]], b = kDecodeTable[src[i + 1]];
+                uint32_t c = kDecodeTable[src[i + 2]], d = kDecodeTable[src[i + 3]];
+                if ((a | b | c | d) & 0x80) {
+                    return std::nullopt;
+                }
+                uint32_t word = (a << 18) | (b << 12) | (c << 6) | d;
+                *dst++ = static_cast<unsigned char>(word >> 16);
+                *dst++ = static_cast<unsigned char>(word >> 8);
+                *dst++ = static_cast<unsigned char>(word);
+            }
+            if (i < size) {
+                uint32_t a = kDecodeTable[src[i]], b = kDecodeTable[src[i + 1]];
+                uint32_t c = i + 2 < size ? kDecodeTable[src[i + 2]] : 0;
+                if ((a | b | c) & 0x80) {
+                    return std::nullopt;
+                }
+                uint32_t word = (a << 18) | (b << 12) | (c << 6);
+                *dst++ = static_cast<unsigned char>(word >> 16);
+                if (i + 2 < size) {
+                    *dst++ = static_cast<unsigned char>(word >> 8);
+                }
+            }
+            return static_cast<std::size_t>(dst - start);
+        }
+
+#if defined(MCP_BASE64_AVX2)
+        // Bit tricks after W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding using AVX2 Instructions"
+
+        __attribute__((target("avx2"))) std::size_t encode_avx2(const unsigned char *src, std::size_t size, char *dst) {
+            const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                     1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+            const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                       '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                       'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                       '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            char *start = dst;
+            std::size_t i = 0;
+            // 24 bytes in, 32 characters out; the second 16-byte load reads 4 bytes past the block
+            for (; i + 28 <= size; i += 24) {
+                __m256i in = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 12)), 1);
+                in = _mm256_shuffle_epi8(in, shuffle);
+
+                // Spread the four 6-bit fields of every 3 bytes over the 4 bytes of a dword
+                __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+                __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+                __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                __m256i indices = _mm256_or_si256(t1, t3);
+
+                // Map 0..63 to the alphabet through the offset of its range
+                __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+                __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, range), indices);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), out);
+                dst += 32;
+            }
+            dst += encode_scalar(src + i, size - i, dst);
+            return static_cast<std::size_t>(dst - start);
+        }
+
+        __attribute__((target("avx2"))) std::optional<std::size_t> decode_avx2(const unsigned char *src, std::size_t size, unsigned char *dst) {
+            const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                                    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+            const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i pack_shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+            unsigned char *start = dst;
+            std::size_t i = 0;
+            // 32 characters in, 24 bytes out; each store writes 32 bytes, and the final quartet
+            // with its padding is always left to the scalar tail
+            for (; i + 48 <= size; i += 32) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+                __m256i lo_nibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+                __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+                __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+                if (!_mm256_testz_si256(lo, hi)) {
+                    return std::nullopt;
+                }
+                __m256i eq_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+                __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_slash, hi_nibbles));
+                __m256i values = _mm256_add_epi8(in, roll);
+
+                // Join four 6-bit values into 3 bytes per dword, then close the gaps
+                __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+                merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+                merged = _mm256_shuffle_epi8(merged, pack_shuffle);
+                merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), merged);
+                dst += 24;
+            }
+            auto tail = decode_scalar(src + i, size - i, dst);
+            if (!tail) {
+                return std::nullopt;
+            }
+            return static_cast<std::size_t>(dst - start) + *tail;
+        }
+#endif
+
+#if defined(MCP_BASE64_NEON)
+        std::size_t encode_neon(const unsigned char *src, std::size_t size, char *dst) {
+            const uint8x16x4_t table = vld1q_u8_x4(reinterpret_cast<const uint8_t *>(kAlphabet));
+            const uint8x16_t mask = vdupq_n_u8(0x3f);
+            char *start = dst;
+            std::size_t i = 0;
+            // 48 bytes in, deinterleaved into byte 0, 1 and 2 of each triple; 64 characters out
+            for (; i + 48 <= size; i += 48) {
+                uint8x16x3_t in = vld3q_u8(src + i);
+                uint8x16x4_t indices;
+                indices.val[0] = vshrq_n_u8(in.val[0], 2);
+                indices.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[1], 4), vshlq_n_u8(in.val[0], 4)), mask);
+                indices.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[2], 6), vshlq_n_u8(in.val[1], 2)), mask);
+                indices.val[3] = vandq_u8(in.val[2], mask);
+
+                uint8x16x4_t out;
+                for (int k = 0; k < 4; ++k) {
+                    out.val[k] = vqtbl4q_u8(table, indices.val[k]);
+                }
+                vst4q_u8(reinterpret_cast<uint8_t *>(dst), out);
+                dst += 64;
+            }
+            dst += encode_scalar(src + i, size - i, dst);
+            return static_cast<std::size_t>(dst - start);
+        }
+
+        std::optional<std::size_t> decode_neon(const unsigned char *src, std::size_t size, unsigned char *dst) {
+            const uint8x16x4_t table_lo = vld1q_u8_x4(kDecodeTable.data());
+            const uint8x16x4_t table_hi = vld1q_u8_x4(kDecodeTable.data() + 64);
+            const uint8x16_t offset = vdupq_n_u8(64);
+            unsigned char *start = dst;
+            std::size_t i = 0;
+            // 64 characters in, 48 bytes out; the final quartet is left to the scalar tail
+            for (; i + 68 <= size; i += 64) {
+                uint8x16x4_t in = vld4q_u8(src + i);
+                uint8x16_t error = vdupq_n_u8(0);
+                for (int k = 0; k < 4; ++k) {
+                    // Characters 0..63 come from the first table, 64..127 from the second
+                    uint8x16_t value = vqtbl4q_u8(table_lo, in.val[k]);
+                    value = vqtbx4q_u8(value, table_hi, vsubq_u8(in.val[k], offset));
+                    error = vorrq_u8(error, vorrq_u8(value, in.val[k]));
+                    in.val[k] = value;
+                }
+                if (vmaxvq_u8(error) & 0x80) {
+                    return std::nullopt;
+                }
+
+                uint8x16x3_t out;
+                out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2), vshrq_n_u8(in.val[1], 4));
+                out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4), vshrq_n_u8(in.val[2], 2));
+                out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6), in.val[3]);
+                vst3q_u8(dst, out);
+                dst += 48;
+            }
+            auto tail = decode_scalar(src + i, size - i, dst);
+            if (!tail) {
+                return std::nullopt;
+            }
+            return static_cast<std::size_t>(dst - start) + *tail;
+        }
+#endif
+
+        struct Codec {
+            EncodeFunc encode = encode_scalar;
+            DecodeFunc decode = decode_scalar;
+            const char *name = "scalar";
+        };
+
+        /// Picked once, from what the CPU running the process supports
+        const Codec &codec() {
+            static const Codec codec = [] {
+                Codec selected;
+#if defined(MCP_BASE64_AVX2)
+                if (__builtin_cpu_supports("avx2")) {
+                    selected = {encode_avx2, decode_avx2, "avx2"};
+                }
+#elif defined(MCP_BASE64_NEON)
+                selected = {encode_neon, decode_neon, "neon"};
+#endif
+                return selected;
+            }();
+            return codec;
+        }
+    }// namespace
+
+    std::size_t base64_encode(const char *data, std::size_t size, char *out) {
+        return codec().encode(reinterpret_cast<const unsigned char *>(data), size, out);
+    }
+
+    std::optional<std::size_t> base64_decode(const char *data, std::size_t size, char *out) {
+        return codec().decode(reinterpret_cast<const unsigned char *>(data), size, reinterpret_cast<unsigned char *>(out));
+    }
+
+    const char *base64_implementation() {
+        return codec().name;
+    }
+
+}// namespace mcp::utils
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace mcp::utils {
+
+    /**
+     * @brief Number of characters base64 turns a number of bytes into, padding included.
+     */
+    constexpr std::size_t base64_encoded_size(std::size_t bytes) { return (bytes + 2) / 3 * 4; }
+
+    /**
+     * @brief Upper bound of the bytes a number of base64 characters decodes to.
+     */
+    constexpr std::size_t base64_decoded_max_size(std::size_t chars) { return (chars + 3) / 4 * 3; }
+
+    /**
+     * @brief Encode bytes as base64 (RFC 4648, padded).
+     * Uses AVX2 or NEON where the CPU has it; the output is the same on every path. Encoding a long
+     * input piece by piece gives the same text as encoding it at once, as long as every piece but
+     * the last is a multiple of 3 bytes long.
+     * @param data Bytes to encode
+     * @param size Number of bytes
+     * @param out Receives base64_encoded_size(size) characters
+     * @return Number of characters written
+     */
+    std::size_t base64_encode(const char *data, std::size_t size, char *out);
+
+    /**
+     * @brief Decode base64 (RFC 4648), with or without padding. Whitespace is not accepted.
+     * @param data Characters to decode
+     * @param size Number of characters
+     * @param out Receives up to base64_decoded_max_size(size) bytes
+     * @return Number of bytes written, or std::nullopt if the input is not valid base64
+     */
+    std::optional<std::size_t> base64_decode(const char *data, std::size_t size, char *out);
+
+    /**
+     * @brief Name of the code path picked for this CPU: "avx2", "neon" or "scalar".
+     */
+    const char *base64_implementation();
+
+    /**
+     * @brief Append the base64 encoding of some bytes to a string.
+     */
+    inline void base64_append(std::string &out, std::string_view bytes) {
+        std::size_t start = out.size();
+        out.resize(start + base64_encoded_size(bytes.size()));
+        base64_encode(bytes.data(), bytes.size(), out.data() + start);
+    }
+
+    inline std::string base64_encode(std::string_view bytes) {
+        std::string out;
+        base64_append(out, bytes);
+        return out;
+    }
+
+    inline std::optional<std::string> base64_decode(std::string_view text) {
+        std::string out(base64_decoded_max_size(text.size()), '\0');
+        auto size = base64_decode(text.data(), text.size(), out.data());
+        if (!size) {
+            return std::nullopt;
+        }
+        out.resize(*size);
+        return out;
+    }
+
+}// namespace mcp::utils
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "content_hash.h"
+#include <cstdio>
+#include <cstring>
+
+namespace mcp::utils {
+
+    namespace {
+        constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+        constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+        uint64_t rotl(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+        // Little endian reads, like the reference implementation on every platform
+        uint64_t read64(const unsigned char *p) {
+            uint64_t value = 0;
+            for (int i = 7; i >= 0; --i) {
+                value = (value << 8) | p[i];
+            }
+            return value;
+        }
+
+        uint32_t read32(const unsigned char *p) {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        uint64_t round(uint64_t acc, uint64_t input) {
+            acc += input * kPrime2;
+            return rotl(acc, 31) * kPrime1;
+        }
+
+        uint64_t merge_round(uint64_t acc, uint64_t value) {
+            acc ^= round(0, value);
+            return acc * kPrime1 + kPrime4;
+        }
+    }// namespace
+
+    uint64_t content_hash(std::string_view bytes) {
+        const auto *p = reinterpret_cast<const unsigned char *>(bytes.data());
+        const auto *end = p + bytes.size();
+        uint64_t h;
+
+        if (bytes.size() >= 32) {
+            // Four independent lanes of 8 bytes, so the CPU can run them in parallel
+            uint64_t v1 = kPrime1 + kPrime2;
+            uint64_t v2 = kPrime2;
+            uint64_t v3 = 0;
+            uint64_t v4 = 0 - kPrime1;
+            const auto *limit = end - 32;
+            do {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge_round(h, v1);
+            h = merge_round(h, v2);
+            h = merge_round(h, v3);
+            h = merge_round(h, v4);
+        } else {
+            h = kPrime5;
+        }
+        h += static_cast<uint64_t>(bytes.size());
+
+        for (; p + 8 <= end; p += 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * kPrime1 + kPrime4;
+        }
+        if (p + 4 <= end) {
+            h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+            h = rotl(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            h ^= *p * kPrime5;
+            h = rotl(h, 11) * kPrime1;
+        }
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    std::string content_etag(std::string_view bytes) {
+        char etag[24];
+        std::snprintf(etag, sizeof(etag), "\"%016llx\"", static_cast<unsigned long long>(content_hash(bytes)));
+        return etag;
+    }
+
+    bool etag_matches(std::string_view if_none_match, std::string_view etag) {
+        if (etag.empty()) {
+            return false;
+        }
+        while (!if_none_match.empty()) {
+            size_t comma = if_none_match.find(',');
+            std::string_view tag = if_none_match.substr(0, comma);
+            if_none_match = comma == std::string_view::npos ? std::string_view{} : if_none_match.substr(comma + 1);
+            while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) tag.remove_prefix(1);
+            while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) tag.remove_suffix(1);
+            if (tag.starts_with("W/")) {
+                tag.remove_prefix(2);
+            }
+            if (tag == "*" || tag == etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+}// namespace mcp::utils
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mcp::utils {
+
+    /**
+     * @brief 64-bit hash of some bytes, XXH64 with seed 0: fast on large inputs (about as fast as
+     *        memory can be read) and well spread, but not cryptographic.
+     */
+    uint64_t content_hash(std::string_view bytes);
+
+    /**
+     * @brief A strong HTTP entity tag of some bytes: content_hash() as 16 hex digits, in quotes.
+     */
+    std::string content_etag(std::string_view bytes);
+
+    /**
+     * @brief Whether an If-None-Match header value, a list of entity tags or "*", lists an entity tag.
+     * Weak tags (W/"...") match as well, as If-None-Match compares them weakly.
+     */
+    bool etag_matches(std::string_view if_none_match, std::string_view etag);
+
+}// namespace mcp::utils
@@ -1,22 +1,124 @@
 #pragma once
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <random>
-#include <sstream>
 #include <string>
+#include <string_view>
 
 namespace mcp::utils {
 
-    inline std::string generate_session_id() noexcept {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<uint64_t> dist;
+    /**
+     * @brief Session identifier: 32 lowercase hex digits (128 random bits), stored inline.
+     */
+    class SessionId {
+    public:
+        static constexpr std::size_t kLength = 32;
 
-        uint64_t part1 = dist(gen);
-        uint64_t part2 = dist(gen);
+        std::string_view view() const { return {chars_.data(), kLength}; }
+        std::string str() const { return std::string(view()); }
 
-        std::stringstream ss;
-        ss << std::hex << std::setw(16) << std::setfill('0') << part1
-           << std::hex << std::setw(16) << std::setfill('0') << part2;
-        return ss.str();
+        bool operator==(const SessionId &) const = default;
+
+    private:
+        friend SessionId generate_session_id() noexcept;
+        std::array<char, kLength> chars_{};
+    };
+
+    namespace detail {
+
+        /**
+         * @brief ChaCha20 keystream (RFC 8439) used as a random generator, one per thread.
+         * Keyed once from std::random_device, so creating an ID never touches the OS; each
+         * 64-byte block covers four IDs.
+         */
+        class ChaChaRandom {
+        public:
+            ChaChaRandom() {
+                std::random_device device;
+                state_ = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};// "expand 32-byte k"
+                for (std::size_t i = 4; i < 16; ++i) {
+                    state_[i] = device();// Key, then a random start for the counter and nonce
+                }
+            }
+
+            void fill(uint8_t *out, std::size_t size) {
+                while (size > 0) {
+                    if (used_ == block_.size()) {
+                        refill();
+                    }
+                    std::size_t take = std::min(size, block_.size() - used_);
+                    for (std::size_t i = 0; i < take; ++i) {
+                        out[i] = block_[used_ + i];
+                    }
+                    used_ += take;
+                    out += take;
+                    size -= take;
+                }
+            }
+
+        private:
+            static constexpr uint32_t rotl(uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); }
+
+            static void quarter_round(std::array<uint32_t, 16> &x, int a, int b, int c, int d) {
+                x[a] += x[b];
+                x[d] = rotl(x[d] ^ x[a], 16);
+                x[c] += x[d];
+                x[b] = rotl(x[b] ^ x[c], 12);
+                x[a] += x[b];
+                x[d] = rotl(x[d] ^ x[a], 8);
+                x[c] += x[d];
+                x[b] = rotl(x[b] ^ x[c], 7);
+            }
+
+            void refill() {
+                std::array<uint32_t, 16> x = state_;
+                for (int round = 0; round < 10; ++round) {
+                    quarter_round(x, 0, 4, 8, 12);
+                    quarter_round(x, 1, 5, 9, 13);
+                    quarter_round(x, 2, 6, 10, 14);
+                    quarter_round(x, 3, 7, 11, 15);
+                    quarter_round(x, 0, 5, 10, 15);
+                    quarter_round(x, 1, 6, 11, 12);
+                    quarter_round(x, 2, 7, 8, 13);
+                    quarter_round(x, 3, 4, 9, 14);
+                }
+                for (std::size_t i = 0; i < 16; ++i) {
+                    uint32_t word = x[i] + state_[i];
+                    for (std::size_t byte = 0; byte < 4; ++byte) {
+                        block_[4 * i + byte] = static_cast<uint8_t>(word >> (8 * byte));
+                    }
+                }
+                // 64-bit block counter in words 12 and 13
+                if (++state_[12] == 0) {
+                    ++state_[13];
+                }
+                used_ = 0;
+            }
+
+            std::array<uint32_t, 16> state_{};
+            std::array<uint8_t, 64> block_{};
+            std::size_t used_ = 64;
+        };
+
+        inline ChaChaRandom &thread_random() {
+            thread_local ChaChaRandom random;
+            return random;
+        }
+
+    }// namespace detail
+
+    inline SessionId generate_session_id() noexcept {
+        static constexpr char kHex[] = "0123456789abcdef";
+        uint8_t bytes[SessionId::kLength / 2];
+        detail::thread_random().fill(bytes, sizeof(bytes));
+
+        SessionId id;
+        for (std::size_t i = 0; i < sizeof(bytes); ++i) {
+            id.chars_[2 * i] = kHex[bytes[i] >> 4];
+            id.chars_[2 * i + 1] = kHex[bytes[i] & 0x0f];
+        }
+        return id;
     }
-}// namespace mcp::utils
\ No newline at end of file
+}// namespace mcp::utils
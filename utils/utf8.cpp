@@ -0,0 +1,342 @@
+#include "utf8.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MCP_UTF8_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define MCP_UTF8_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace mcp::utils {
+
+    namespace {
+        using ValidFunc = bool (*)(const unsigned char *, std::size_t);
+        using ScanFunc = std::size_t (*)(const unsigned char *, std::size_t);
+
+        bool needs_escape(unsigned char c) {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+
+        bool valid_scalar(const unsigned char *p, std::size_t size) {
+            const unsigned char *end = p + size;
+            while (p < end) {
+                // Eight ASCII bytes at a time
+                if (end - p >= 8) {
+                    uint64_t word;
+                    std::memcpy(&word, p, 8);
+                    if ((word & 0x8080808080808080ull) == 0) {
+                        p += 8;
+                        continue;
+                    }
+                }
+                unsigned char c = *p;
+                if (c < 0x80) {
+                    ++p;
+                    continue;
+                }
+                // Lead byte: length of the sequence and the range its second byte must be in
+                std::size_t length;
+                unsigned char low = 0x80, high = 0xbf;
+                if (c >= 0xc2 && c <= 0xdf) {
+                    length = 2;
+                } else if (c >= 0xe0 && c <= 0xef) {
+                    length = 3;
+                    if (c == 0xe0) low = 0xa0; // overlong
+                    if (c == 0xed) high = 0x9f;// surrogates
+                } else if (c >= 0xf0 && c <= 0xf4) {
+                    length = 4;
+                    if (c == 0xf0) low = 0x90; // overlong
+                    if (c == 0xf4) high = 0x8f;// above U+10FFFF
+                } else {
+                    return false;
+                }
+                if (static_cast<std::size_t>(end - p) < length || p[1] < low || p[1] > high) {
+                    return false;
+                }
+                for (std::size_t i = 2; i < length; ++i) {
+                    if ((p[i] & 0xc0) != 0x80) {
+                        return false;
+                    }
+                }
+                p += length;
+            }
+            return true;
+        }
+
+        std::size_t scan_scalar(const unsigned char *p, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i) {
+                if (needs_escape(p[i])) {
+                    return i;
+                }
+            }
+            return size;
+        }
+
+        // The vector validators classify every byte by its high nibble, the low nibble of the byte
+        // before and the high nibble of the byte before that, then check that three- and four-byte
+        // sequences have their continuations (Keiser and Lemire, "Validating UTF-8 In Less Than One
+        // Instruction Per Byte", 2021). Error bits of the nibble tables:
+        constexpr uint8_t kTooShort = 1 << 0;  // lead byte followed by a lead byte or ASCII
+        constexpr uint8_t kTooLong = 1 << 1;   // ASCII followed by a continuation
+        constexpr uint8_t kOverlong3 = 1 << 2; // 11100000 100_____
+        constexpr uint8_t kTooLarge = 1 << 3;  // 11110100 1001____ and above
+        constexpr uint8_t kSurrogate = 1 << 4; // 11101101 101_____
+        constexpr uint8_t kOverlong2 = 1 << 5; // 1100000_ 10______
+        constexpr uint8_t kTooLarge1000 = 1 << 6;// 11110101+ 1000____
+        constexpr uint8_t kOverlong4 = 1 << 6;   // 11110000 1000____
+        constexpr uint8_t kTwoConts = 1 << 7;    // continuation followed by a continuation
+        constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+        // By the high nibble of the previous byte
+        constexpr uint8_t kByte1High[16] = {
+                kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+                kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+                kTooShort | kOverlong2,
+                kTooShort,
+                kTooShort | kOverlong3 | kSurrogate,
+                kTooShort | kTooLarge | kTooLarge1000 | kOverlong4};
+        // By the low nibble of the previous byte
+        constexpr uint8_t kByte1Low[16] = {
+                kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+                kCarry | kOverlong2,
+                kCarry,
+                kCarry,
+                kCarry | kTooLarge,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+                kCarry | kTooLarge | kTooLarge1000,
+                kCarry | kTooLarge | kTooLarge1000};
+        // By the high nibble of the byte itself
+        constexpr uint8_t kByte2High[16] = {
+                kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+                kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+                kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+                kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+                kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+                kTooShort, kTooShort, kTooShort, kTooShort};
+
+#if defined(MCP_UTF8_AVX2)
+        __attribute__((target("avx2"))) __m256i table256(const uint8_t (&table)[16]) {
+            return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table)));
+        }
+
+        __attribute__((target("avx2"))) __m256i high_nibbles(__m256i v) {
+            return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+        }
+
+        /**
+         * @brief Validation state carried from one 32-byte block to the next.
+         */
+        struct Avx2Validator {
+            __m256i error;
+            __m256i previous;  // Last block
+            __m256i incomplete;// Last block ends inside a sequence
+
+            __attribute__((target("avx2"))) void check(__m256i input) {
+                if (_mm256_movemask_epi8(input) == 0) {
+                    error = _mm256_or_si256(error, incomplete);
+                    previous = input;
+                    return;
+                }
+                __m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+                __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+                __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+                __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+
+                __m256i special = _mm256_and_si256(
+                        _mm256_and_si256(_mm256_shuffle_epi8(table256(kByte1High), high_nibbles(prev1)),
+                                         _mm256_shuffle_epi8(table256(kByte1Low), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)))),
+                        _mm256_shuffle_epi8(table256(kByte2High), high_nibbles(input)));
+                // Third and fourth bytes of a sequence must be continuations, seen as 0x80 in special
+                __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80))),
+                                                 _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80))));
+                __m256i must23_80 = _mm256_and_si256(must23, _mm256_set1_epi8(static_cast<char>(0x80)));
+                error = _mm256_or_si256(error, _mm256_xor_si256(must23_80, special));
+
+                // A lead byte in the last three positions that its sequence does not fit after
+                const __m256i max = _mm256_setr_epi8(
+                        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                        static_cast<char>(0xf0 - 1), static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1));
+                incomplete = _mm256_subs_epu8(input, max);
+                previous = input;
+            }
+        };
+
+        __attribute__((target("avx2"))) bool valid_avx2(const unsigned char *p, std::size_t size) {
+            Avx2Validator validator{_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+            std::size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                validator.check(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));
+            }
+            if (i < size) {
+                // The rest padded with NULs, which are ASCII
+                alignas(32) unsigned char tail[32] = {};
+                std::memcpy(tail, p + i, size - i);
+                validator.check(_mm256_load_si256(reinterpret_cast<const __m256i *>(tail)));
+            }
+            __m256i error = _mm256_or_si256(validator.error, validator.incomplete);
+            return _mm256_testz_si256(error, error) != 0;
+        }
+
+        __attribute__((target("avx2"))) std::size_t scan_avx2(const unsigned char *p, std::size_t size) {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i control = _mm256_set1_epi8(0x1f);
+            std::size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+                __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                               _mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+                if (mask != 0) {
+                    return i + static_cast<std::size_t>(__builtin_ctz(mask));
+                }
+            }
+            return i + scan_scalar(p + i, size - i);
+        }
+#elif defined(MCP_UTF8_NEON)
+        bool valid_neon(const unsigned char *p, std::size_t size) {
+            const uint8x16_t byte1_high = vld1q_u8(kByte1High);
+            const uint8x16_t byte1_low = vld1q_u8(kByte1Low);
+            const uint8x16_t byte2_high = vld1q_u8(kByte2High);
+            const uint8_t max_bytes[16] = {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1};
+            const uint8x16_t max = vld1q_u8(max_bytes);
+            uint8x16_t error = vdupq_n_u8(0);
+            uint8x16_t previous = vdupq_n_u8(0);
+            uint8x16_t incomplete = vdupq_n_u8(0);
+
+            auto check = [&](uint8x16_t input) {
+                if (vmaxvq_u8(input) < 0x80) {
+                    error = vorrq_u8(error, incomplete);
+                    previous = input;
+                    return;
+                }
+                uint8x16_t prev1 = vextq_u8(previous, input, 15);
+                uint8x16_t prev2 = vextq_u8(previous, input, 14);
+                uint8x16_t prev3 = vextq_u8(previous, input, 13);
+                uint8x16_t special = vandq_u8(vandq_u8(vqtbl1q_u8(byte1_high, vshrq_n_u8(prev1, 4)),
+                                                       vqtbl1q_u8(byte1_low, vandq_u8(prev1, vdupq_n_u8(0x0f)))),
+                                              vqtbl1q_u8(byte2_high, vshrq_n_u8(input, 4)));
+                uint8x16_t must23 = vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80)), vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80)));
+                error = vorrq_u8(error, veorq_u8(vandq_u8(must23, vdupq_n_u8(0x80)), special));
+                incomplete = vqsubq_u8(input, max);
+                previous = input;
+            };
+
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                check(vld1q_u8(p + i));
+            }
+            if (i < size) {
+                uint8_t tail[16] = {};
+                std::memcpy(tail, p + i, size - i);
+                check(vld1q_u8(tail));
+            }
+            return vmaxvq_u8(vorrq_u8(error, incomplete)) == 0;
+        }
+
+        std::size_t scan_neon(const unsigned char *p, std::size_t size) {
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t backslash = vdupq_n_u8('\\');
+            const uint8x16_t control = vdupq_n_u8(0x1f);
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                uint8x16_t v = vld1q_u8(p + i);
+                uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcleq_u8(v, control));
+                // Four bits per byte
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+                if (mask != 0) {
+                    return i + static_cast<std::size_t>(__builtin_ctzll(mask)) / 4;
+                }
+            }
+            return i + scan_scalar(p + i, size - i);
+        }
+#endif
+
+        struct Implementation {
+            ValidFunc valid = valid_scalar;
+            ScanFunc scan = scan_scalar;
+            const char *name = "scalar";
+        };
+
+        /// Picked once, from what the CPU running the process supports
+        const Implementation &implementation() {
+            static const Implementation implementation = [] {
+                Implementation selected;
+#if defined(MCP_UTF8_AVX2)
+                if (__builtin_cpu_supports("avx2")) {
+                    selected = {valid_avx2, scan_avx2, "avx2"};
+                }
+#elif defined(MCP_UTF8_NEON)
+                selected = {valid_neon, scan_neon, "neon"};
+#endif
+                return selected;
+            }();
+            return implementation;
+        }
+    }// namespace
+
+    bool utf8_valid(const char *data, std::size_t size) {
+        return implementation().valid(reinterpret_cast<const unsigned char *>(data), size);
+    }
+
+    std::size_t json_escape_scan(std::string_view text) {
+        return implementation().scan(reinterpret_cast<const unsigned char *>(text.data()), text.size());
+    }
+
+    void json_escape_append(std::string &out, std::string_view text) {
+        static constexpr char kHex[] = "0123456789abcdef";
+        while (!text.empty()) {
+            std::size_t run = json_escape_scan(text);
+            out.append(text.data(), run);
+            if (run == text.size()) {
+                return;
+            }
+            char c = text[run];
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\b':
+                    out += "\\b";
+                    break;
+                case '\f':
+                    out += "\\f";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    out += "\\u00";
+                    out += kHex[(c >> 4) & 0xf];
+                    out += kHex[c & 0xf];
+            }
+            text.remove_prefix(run + 1);
+        }
+    }
+
+    const char *utf8_implementation() {
+        return implementation().name;
+    }
+
+}// namespace mcp::utils
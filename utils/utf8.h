@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace mcp::utils {
+
+    /**
+     * @brief Whether bytes are well-formed UTF-8: no overlong forms, surrogates or code points above
+     * U+10FFFF, and no sequence cut off at the end. NUL bytes are valid.
+     * Checks 32 or 16 bytes at a time with AVX2 or NEON where the CPU has them; runs of ASCII are
+     * skipped a block at a time on every path.
+     * @param data Bytes to check
+     * @param size Number of bytes
+     */
+    bool utf8_valid(const char *data, std::size_t size);
+
+    inline bool utf8_valid(std::string_view text) { return utf8_valid(text.data(), text.size()); }
+
+    /**
+     * @brief Move a cut in UTF-8 text back to the lead byte of the sequence it falls in, so that
+     * text.substr(0, cut) does not end mid-character. Looks back at most 3 bytes, as far as a
+     * 4-byte sequence continues; a cut at or past the end is kept.
+     * @param text Text being cut
+     * @param cut Offset of the first byte after the cut
+     * @param floor The cut stays above it, so a piece starting there keeps at least one byte
+     */
+    inline std::size_t utf8_cut(std::string_view text, std::size_t cut, std::size_t floor = 0) {
+        if (cut >= text.size()) {
+            return cut;
+        }
+        for (std::size_t back = 0; back < 4 && cut - back > floor; ++back) {
+            if ((static_cast<unsigned char>(text[cut - back]) & 0xc0) != 0x80) {
+                return cut - back;
+            }
+        }
+        return cut;
+    }
+
+    /**
+     * @brief Append text to a JSON string being written, escaped the way nlohmann::json::dump()
+     * escapes it: '"', '\\' and control characters, with \\u00XX for those without a short form.
+     * Other bytes are copied as they are, so the text must be valid UTF-8 (see utf8_valid()).
+     * Runs that need no escaping are found a block at a time with AVX2 or NEON.
+     * @param out String to append to
+     * @param text Text to escape, without quotes
+     */
+    void json_escape_append(std::string &out, std::string_view text);
+
+    /**
+     * @brief Offset of the first byte of text that json_escape_append() would escape, or text.size().
+     */
+    std::size_t json_escape_scan(std::string_view text);
+
+    /**
+     * @brief Name of the code path picked for this CPU: "avx2", "neon" or "scalar".
+     */
+    const char *utf8_implementation();
+
+}// namespace mcp::utils
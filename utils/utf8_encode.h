@@ -1,41 +1,10 @@
 #pragma once
 
+#include "utf8.h"
 #include <string>
 
-inline bool is_valid_utf8(const std::string &str) {
-    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(str.c_str());
-    while (*bytes) {
-        if ((*bytes & 0x80) == 0x00) {
-            // 1-byte (ASCII)
-            bytes += 1;
-        } else if ((*bytes & 0xE0) == 0xC0) {
-            // 2-byte
-            if ((bytes[1] & 0xC0) == 0x80) {
-                bytes += 2;
-            } else {
-                return false;
-            }
-        } else if ((*bytes & 0xF0) == 0xE0) {
-            // 3-byte
-            if ((bytes[1] & 0xC0) == 0x80 && (bytes[2] & 0xC0) == 0x80) {
-                bytes += 3;
-            } else {
-                return false;
-            }
-        } else if ((*bytes & 0xF8) == 0xF0) {
-            // 4-byte
-            if ((bytes[1] & 0xC0) == 0x80 &&
-                (bytes[2] & 0xC0) == 0x80 &&
-                (bytes[3] & 0xC0) == 0x80) {
-                bytes += 4;
-            } else {
-                return false;
-            }
-        } else {
-            return false;
-        }
-    }
-    return true;
+inline bool is_valid_utf8(std::string_view str) {
+    return mcp::utils::utf8_valid(str);
 }
 
 #ifdef _WIN32